@@ -123,6 +123,9 @@ if(PORTAUDIO_API)
 	check_lib(PORTAUDIO portaudio portaudio.h pa_linux_alsa.h)
 endif()
 check_lib(SOUNDTOUCH SoundTouch SoundTouch.h PATH_SUFFIXES soundtouch)
+if(ZSTD_API)
+	check_lib(ZSTD libzstd zstd.h)
+endif()
 check_lib(SAMPLERATE samplerate samplerate.h)
 
 if(SDL2_API)
@@ -246,8 +246,27 @@ extern void Munmap(uptr base, size_t size);
 
 extern void MemProtect(void *baseaddr, size_t size, const PageProtectionMode &mode);
 
+// Asks for the whole huge pages of a block of memory (of any allocation) to be backed by huge
+// pages, to save TLB misses and page faults on large buffers.  No-op where unsupported.
+extern void HintHugePages(void *base, size_t size);
+
+// Commits reserved memory like MmapCommitPtr, but backs its whole huge pages with explicitly
+// allocated ones.  Those can only be protected as a whole, so this is only for memory which
+// never is a page at a time.  Returns false, leaving the memory reserved, when the host has
+// no huge pages to spare (or doesn't support them), the caller falls back to MmapCommitPtr.
+extern bool MmapCommitHugePtr(void *base, size_t size, const PageProtectionMode &mode);
+
 extern void Munmap(void *base, size_t size);
 
+// Creates an anonymous shared memory object, which can be mapped at several places of the
+// address space at once.  Returns -1 if the platform doesn't support it or on failure.
+extern sptr CreateSharedMemory(const char *name, size_t size);
+extern void DestroySharedMemory(sptr handle);
+
+// Maps a view of a shared memory object over reserved (or committed) memory at base.  The
+// view is removed again with MmapResetPtr.
+extern bool MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode);
+
 template <uint size>
 void MemProtectStatic(u8 (&arr)[size], const PageProtectionMode &mode)
 {
@@ -23,6 +23,33 @@ extern u8 memcmp_mmx(const void *src1, const void *src2, int cmpsize);
 #define memcmp_mmx memcmp
 #endif
 
+// Copies and fills with non-temporal stores, which go around the caches instead of evicting
+// the working set of the other threads.  They're fenced, so the data is visible to other
+// threads like after a memcpy.
+extern void memcpy_nt(void *dest, const void *src, size_t size);
+extern void memset_nt(void *dest, u8 value, size_t size);
+
+// For large buffers which won't be read again soon (savestates, snapshots, memory resets):
+// streamed from MemcpyStreamThreshold bytes on, plain memcpy/memset below.
+// (tests/ctest/x86emitter/memcpy_bench.cpp measures where streaming starts to pay off)
+static const size_t MemcpyStreamThreshold = 1024 * 1024;
+
+static __fi void memcpy_stream(void *dest, const void *src, size_t size)
+{
+    if (size < MemcpyStreamThreshold)
+        memcpy(dest, src, size);
+    else
+        memcpy_nt(dest, src, size);
+}
+
+static __fi void memset_stream(void *dest, u8 value, size_t size)
+{
+    if (size < MemcpyStreamThreshold)
+        memset(dest, value, size);
+    else
+        memset_nt(dest, value, size);
+}
+
 // This method can clear any object-like entity -- which is anything that is not a pointer.
 // Structures, static arrays, etc.  No need to include sizeof() crap, this does it automatically
 // for you!
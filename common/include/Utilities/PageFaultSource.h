@@ -31,10 +31,12 @@
 struct PageFaultInfo
 {
     uptr addr;
+    uptr pc; // host instruction that faulted, 0 when the platform can't tell
 
-    PageFaultInfo(uptr address)
+    PageFaultInfo(uptr address, uptr code = 0)
     {
         addr = address;
+        pc = code;
     }
 };
 
@@ -182,6 +184,16 @@ public:
     const VirtualMemoryManagerPtr& GetAllocator() { return m_allocator; }
 };
 
+// How the committed memory of a reserve is backed by huge pages.  Explicit huge pages can
+// only be protected as a whole, so reserves which are protected a page at a time only get
+// transparent ones, which the kernel splits where needed.
+enum HugePageMode
+{
+    HugePages_None,
+    HugePages_Transparent,
+    HugePages_Explicit, // falls back to transparent ones when the host has none to spare
+};
+
 // --------------------------------------------------------------------------------------
 //  VirtualMemoryReserve
 // --------------------------------------------------------------------------------------
@@ -212,6 +224,9 @@ protected:
     // Protection mode to be applied to committed blocks.
     PageProtectionMode m_prot_mode;
 
+    // Huge page backing of committed blocks, applied at the next commit.
+    HugePageMode m_huge_pages;
+
     // Controls write access to the entire reserve.  When true (the default), the reserve
     // operates normally.  When set to false, all committed blocks are re-protected with
     // write disabled, and accesses to uncommitted blocks (read or write) will cause a GPF
@@ -268,6 +283,7 @@ public:
     const u8 *GetPtrEnd() const { return (u8 *)m_baseptr + (m_pages_reserved * __pagesize); }
 
     VirtualMemoryReserve &SetPageAccessOnCommit(const PageProtectionMode &mode);
+    VirtualMemoryReserve &SetHugePages(HugePageMode mode);
 
     operator void *() { return m_baseptr; }
     operator const void *() const { return m_baseptr; }
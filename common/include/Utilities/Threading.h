@@ -18,6 +18,8 @@
 #include <semaphore.h>
 #include <errno.h> // EBUSY
 #include <pthread.h>
+#include <atomic>
+#include <vector>
 
 #ifdef __APPLE__
 #include <mach/semaphore.h>
@@ -97,6 +99,40 @@ extern u64 GetThreadTicksPerSecond();
 // Yields the current thread and provides cancellation points if the thread is managed by
 // pxThread.  Unmanaged threads use standard Sleep.
 extern void pxYield(int ms);
+
+enum ThreadRole
+{
+    ThreadRole_EE,
+    ThreadRole_GS,
+    ThreadRole_VU,
+    ThreadRole_Count
+};
+
+// --------------------------------------------------------------------------------------
+//  ThreadAffinityPlan
+// --------------------------------------------------------------------------------------
+// Placement of the emulator threads inside the L3 domain with the most physical cores:
+// the EE, MTGS and MTVU threads get a physical core each and the SW rasterizer workers
+// share the remaining cores of the domain, SMT siblings last.  The plan is left invalid
+// (and nothing gets pinned) when the domain has fewer physical cores than roles.
+struct ThreadAffinityPlan
+{
+    bool valid;
+    int l3;
+    int cores;
+    int role[ThreadRole_Count];
+    std::vector<int> workers;
+
+    int GetWorker(int index) const;
+    wxString ToString() const;
+};
+
+// Built from GetCpuTopology() and logged on first use.
+extern const ThreadAffinityPlan &GetThreadAffinityPlan();
+
+// Pins the calling thread according to the plan, does nothing when the plan is invalid.
+extern void ApplyThreadAffinity(ThreadRole role);
+extern void ApplyWorkerAffinity(int index);
 }
 
 namespace Exception
@@ -177,6 +213,27 @@ extern void DisableHiresScheduler();
 // sleeps the current thread for the given number of milliseconds.
 extern void Sleep(int ms);
 
+// sleeps the current thread until GetCPUTicks() reaches ticks, using the most precise timer
+// the OS has.  Wakeups can still be late by the timer slack, callers needing better spin the rest.
+extern void SleepUntil(u64 ticks);
+
+// A logical processor the process is allowed to run on, with the physical core, package
+// and L3 cache it belongs to.  Ids are only meaningful for comparison against each other.
+struct CpuLogicalProcessor
+{
+    int cpu;
+    int core;
+    int package;
+    int l3; // -1 when the OS doesn't report a shared L3
+};
+
+// Returns the logical processors available to the process, empty when the topology
+// can't be queried on this platform.
+extern std::vector<CpuLogicalProcessor> GetCpuTopology();
+
+// Restricts the calling thread to the given logical processor.
+extern bool SetCurrentThreadAffinity(int cpu);
+
 // pthread Cond is an evil api that is not suited for Pcsx2 needs.
 // Let's not use it. Use mutexes and semaphores instead to create waits. (Air)
 #if 0
@@ -259,6 +316,47 @@ public:
     bool Wait(const wxTimeSpan &timeout);
 };
 
+// --------------------------------------------------------------------------------------
+//  LightweightSemaphore
+// --------------------------------------------------------------------------------------
+// Semaphore for the hand-offs between the emulator threads (EE, MTGS, MTVU).  Posting and
+// taking an available count are a single atomic op, and a waiter spins for a little while
+// before it blocks on the count itself with the OS address wait (futex on Linux,
+// WaitOnAddress on Windows, ulock on macOS).  Post only enters the kernel when a thread is
+// actually blocked.
+//
+// The spin length adapts: it grows while spinning catches the posts and shrinks while the
+// waiter ends up blocking anyway.  Blocking waits test for thread cancellation every
+// cancel_interval ms, as the address waits aren't cancellation points.  There is no GUI
+// yielding, so don't wait on it from the main thread.
+//
+class LightweightSemaphore
+{
+protected:
+    std::atomic<s32> m_count;
+    std::atomic<s32> m_waiters;
+    std::atomic<s32> m_spin; // only a hint, shared by all the waiters
+
+public:
+    static const int cancel_interval = 100;
+
+    LightweightSemaphore();
+    virtual ~LightweightSemaphore() = default;
+
+    void Reset();
+    void Post();
+    void Post(int multiple);
+
+    bool TryWait();
+    void WaitWithoutYield();
+    bool WaitWithoutYield(const wxTimeSpan &timeout);
+    int Count();
+
+protected:
+    bool Spin();
+    bool BlockingWait(s64 timeout_ms);
+};
+
 class Mutex
 {
 protected:
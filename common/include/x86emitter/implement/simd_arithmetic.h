@@ -313,4 +313,22 @@ struct xImplSimd_Round
     const xImplSimd_DestRegImmSSE SD;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// Fused multiply-add, in the 231 form: dest = (src1 * src2) + dest
+// (FMA3 only! check x86caps.hasFMA)
+struct xImplSimd_FMA
+{
+    u8 Opcode;
+
+    // [FMA3] Multiplies the low single-precision values of src1 and src2, and adds the
+    // product to the low value of dest with a single rounding (or subtracts it from
+    // dest, for xVFNMADD231).
+    void SS(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2) const;
+    void SS(const xRegisterSSE &to, const xRegisterSSE &from1, const xIndirectVoid &from2) const;
+
+    // [FMA3] Same as SS, on the low double-precision values.
+    void SD(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2) const;
+    void SD(const xRegisterSSE &to, const xRegisterSSE &from1, const xIndirectVoid &from2) const;
+};
+
 } // End namespace x86Emitter
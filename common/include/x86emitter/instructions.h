@@ -592,6 +592,22 @@ extern const xImplSimd_PMultAdd xPMADD;
 extern const xImplSimd_HorizAdd xHADD;
 extern const xImplSimd_DotProduct xDP;
 extern const xImplSimd_Round xROUND;
+extern const xImplSimd_FMA xVFMADD231;
+extern const xImplSimd_FMA xVFNMADD231;
+
+// ------------------------------------------------------------------------
+// [AVX2] 256-bit forms, the registers are passed as xRegisterSSE::YMM()
+// (check x86caps.hasAVX2, and emit xVZEROUPPER before going back to SSE code)
+
+extern void xVMOVUPS(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVMOVUPS(const xIndirectVoid &to, const xRegisterSSE &from);
+extern void xVPMOVSXBD(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVPMOVZXBD(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVPMOVSXWD(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVPMOVZXWD(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVPADDD(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2);
+extern void xVBROADCASTI128(const xRegisterSSE &to, const xIndirectVoid &from);
+extern void xVZEROUPPER();
 
 extern const xImplSimd_PShuffle xPSHUF;
 extern const SimdImpl_PUnpack xPUNPCK;
@@ -33,6 +33,8 @@ extern void EmitSibMagic(const xRegisterBase &reg1, const void *src, int extraRI
 extern void EmitSibMagic(const xRegisterBase &reg1, const xIndirectVoid &sib, int extraRIPOffset = 0);
 
 extern void EmitRex(uint regfield, const void *address);
+
+extern void xRelaxRewind(const void *ptr);
 extern void EmitRex(uint regfield, const xIndirectVoid &info);
 extern void EmitRex(uint reg1, const xRegisterBase &reg2);
 extern void EmitRex(const xRegisterBase &reg1, const xRegisterBase &reg2);
@@ -124,7 +126,7 @@ __emitinline void xOpWriteC5(u8 prefix, u8 opcode, const T1 &param1, const T2 &p
 {
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
 
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
+    const xRegisterBase &reg = param1.IsReg() ? param1 : param2;
 
 #ifdef __M_X86_64
     u8 nR = reg.IsExtended() ? 0x00 : 0x80;
@@ -153,7 +155,7 @@ __emitinline void xOpWriteC4(u8 prefix, u8 mb_prefix, u8 opcode, const T1 &param
     pxAssert(prefix == 0 || prefix == 0x66 || prefix == 0xF3 || prefix == 0xF2);
     pxAssert(mb_prefix == 0x0F || mb_prefix == 0x38 || mb_prefix == 0x3A);
 
-    const xRegisterInt &reg = param1.IsReg() ? param1 : param2;
+    const xRegisterBase &reg = param1.IsReg() ? param1 : param2;
 
 #ifdef __M_X86_64
     u8 nR = reg.IsExtended() ? 0x00 : 0x80;
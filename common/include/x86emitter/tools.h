@@ -95,6 +95,9 @@ public:
             u32 hasBMI1 : 1;
             u32 hasBMI2 : 1;
             u32 hasFMA : 1;
+            u32 hasAVX512F : 1;
+            u32 hasAVX512BW : 1;
+            u32 hasAVX512VL : 1;
 
             // AMD-specific CPU Features
             u32 hasAMD64BitArchitecture : 1;
@@ -188,10 +188,44 @@ extern void xSetPtr(void *ptr);
 extern void xAlignPtr(uint bytes);
 extern void xAdvancePtr(uint bytes);
 extern void xAlignCallTarget();
+extern void xAlignJumpTarget(uint bytes, uint maxpadding = 15);
 
 extern u8 *xGetPtr();
 extern u8 *xGetAlignedCallTarget();
 
+// --------------------------------------------------------------------------------------
+//  Branch relaxation
+// --------------------------------------------------------------------------------------
+// Between xRelaxBegin and xRelaxEnd the emitter logs every pc-relative field it writes, and
+// xRelaxEnd shortens the xForwardJump32's whose target ended up in rel8 range, moving the
+// rest of the code down (and fixing up every other field).  Hence, within a region:
+//  * forward jumps must all have their targets set before xRelaxEnd,
+//  * pointers into the region saved for later (patch sites, ...) go through xRelaxMap,
+//  * the code must not hold its own address as an immediate, or rely on its alignment,
+//  * the emit pointer may only be set back within the region (to discard code).
+//
+enum xRelaxKind
+{
+    xRelax_Rel8,   // any rel8 jump
+    xRelax_Rel32,  // rel32 of a jump or call, or a rip-relative displacement
+    xRelax_Jump32, // jmp rel32 of a forward jump, may be shortened
+    xRelax_Jcc32,  // jcc rel32 of a forward jump, may be shortened
+};
+
+extern __tls_emit bool x86Relax;
+extern void xRelaxLog(xRelaxKind kind, const void *field, const void *end);
+
+// The field is the displacement, end the address it is relative to.
+static __fi void xRelaxNote(xRelaxKind kind, const void *field, const void *end)
+{
+    if (x86Relax)
+        xRelaxLog(kind, field, end);
+}
+
+extern void xRelaxBegin();
+extern uint xRelaxEnd();
+extern u8 *xRelaxMap(const void *ptr);
+
 extern JccComparisonType xInvertCond(JccComparisonType src);
 
 class xAddressVoid;
@@ -458,6 +492,14 @@ public:
     bool operator==(const xRegisterSSE &src) const { return this->Id == src.Id; }
     bool operator!=(const xRegisterSSE &src) const { return this->Id != src.Id; }
 
+    // The 256-bit (ymm) view of this register, for the VEX encoded AVX2 instructions.
+    xRegisterSSE YMM() const
+    {
+        xRegisterSSE ymm(*this);
+        ymm._operandSize = 32;
+        return ymm;
+    }
+
     static const inline xRegisterSSE &GetInstance(uint id);
 };
 
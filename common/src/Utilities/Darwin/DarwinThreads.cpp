@@ -25,6 +25,7 @@
 #include <mach/mach_init.h>
 #include <mach/thread_act.h>
 #include <mach/mach_port.h>
+#include <mach/mach_time.h>
 
 // Note: assuming multicore is safer because it forces the interlocked routines to use
 // the LOCK prefix.  The prefix works on single core CPUs fine (but is slow), but not
@@ -35,6 +36,13 @@ __forceinline void Threading::Sleep(int ms)
     usleep(1000 * ms);
 }
 
+void Threading::SleepUntil(u64 ticks)
+{
+    // GetCPUTicks() is mach_absolute_time()
+    if (ticks > GetCPUTicks())
+        mach_wait_until(ticks);
+}
+
 // For use in spin/wait loops, acts as a hint to Intel CPUs and should, in theory
 // improve performance and reduce cpu power consumption.
 __forceinline void Threading::SpinWait()
@@ -125,6 +133,17 @@ void Threading::pxThread::_platform_specific_OnCleanupInThread()
     mach_port_deallocate(mach_task_self(), (thread_port_t)m_native_id);
 }
 
+// macOS only offers affinity tags as scheduling hints, threads are left floating
+std::vector<Threading::CpuLogicalProcessor> Threading::GetCpuTopology()
+{
+    return std::vector<CpuLogicalProcessor>();
+}
+
+bool Threading::SetCurrentThreadAffinity(int cpu)
+{
+    return false;
+}
+
 // name can be up to 16 bytes
 void Threading::SetNameOfCurrentThread(const char *name)
 {
@@ -0,0 +1,250 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include "Threading.h"
+#include "ThreadingInternal.h"
+
+#if defined(_WIN32)
+#include "RedtapeWindows.h"
+#elif defined(__APPLE__)
+#include <cstdint>
+#elif defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+// --------------------------------------------------------------------------------------
+//  Address waits
+// --------------------------------------------------------------------------------------
+// Blocks while *addr == expected, for at most timeout_ms.  Spurious returns are fine, the
+// callers recheck the count.
+
+#if defined(_WIN32)
+
+// WaitOnAddress needs Windows 8, so it is looked up at runtime and older systems poll.
+typedef BOOL(WINAPI* WaitOnAddressFP)(volatile VOID* Address, PVOID CompareAddress, SIZE_T AddressSize, DWORD dwMilliseconds);
+typedef VOID(WINAPI* WakeByAddressFP)(PVOID Address);
+
+static WaitOnAddressFP pWaitOnAddress = NULL;
+static WakeByAddressFP pWakeByAddressSingle = NULL;
+static WakeByAddressFP pWakeByAddressAll = NULL;
+
+static bool LoadAddressWait()
+{
+    static const bool loaded = [] {
+        HMODULE synch = GetModuleHandleW(L"api-ms-win-core-synch-l1-2-0.dll");
+        if (!synch)
+            synch = LoadLibraryW(L"api-ms-win-core-synch-l1-2-0.dll");
+        if (!synch)
+            return false;
+
+        pWaitOnAddress = (WaitOnAddressFP)GetProcAddress(synch, "WaitOnAddress");
+        pWakeByAddressSingle = (WakeByAddressFP)GetProcAddress(synch, "WakeByAddressSingle");
+        pWakeByAddressAll = (WakeByAddressFP)GetProcAddress(synch, "WakeByAddressAll");
+        return pWaitOnAddress && pWakeByAddressSingle && pWakeByAddressAll;
+    }();
+    return loaded;
+}
+
+static void AddressWait(std::atomic<s32>* addr, s32 expected, int timeout_ms)
+{
+    if (LoadAddressWait())
+        pWaitOnAddress(addr, &expected, sizeof(s32), timeout_ms);
+    else
+        Sleep(1);
+}
+
+static void AddressWake(std::atomic<s32>* addr, int count)
+{
+    if (!LoadAddressWait())
+        return;
+
+    if (count == 1)
+        pWakeByAddressSingle(addr);
+    else
+        pWakeByAddressAll(addr);
+}
+
+#elif defined(__APPLE__)
+
+// Private but stable libSystem API, it is what libc++ builds std::atomic::wait on.
+extern "C" int __ulock_wait(uint32_t operation, void* addr, uint64_t value, uint32_t timeout_us);
+extern "C" int __ulock_wake(uint32_t operation, void* addr, uint64_t wake_value);
+
+static const uint32_t UL_COMPARE_AND_WAIT = 1;
+static const uint32_t ULF_WAKE_ALL = 0x00000100;
+static const uint32_t ULF_NO_ERRNO = 0x01000000;
+
+static void AddressWait(std::atomic<s32>* addr, s32 expected, int timeout_ms)
+{
+    __ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, addr, (u32)expected, timeout_ms * 1000);
+}
+
+static void AddressWake(std::atomic<s32>* addr, int count)
+{
+    __ulock_wake(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO | (count == 1 ? 0 : ULF_WAKE_ALL), addr, 0);
+}
+
+#elif defined(__linux__)
+
+static void AddressWait(std::atomic<s32>* addr, s32 expected, int timeout_ms)
+{
+    const timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000};
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, &timeout, NULL, 0);
+}
+
+static void AddressWake(std::atomic<s32>* addr, int count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+#else
+
+// No address wait on the other unixes, the waiters poll the count.
+static void AddressWait(std::atomic<s32>* addr, s32 expected, int timeout_ms)
+{
+    usleep(std::min(timeout_ms, 1) * 1000);
+}
+
+static void AddressWake(std::atomic<s32>* addr, int count)
+{
+}
+
+#endif
+
+static const s32 MinSpin = 16;
+static const s32 MaxSpin = 1024;
+
+// --------------------------------------------------------------------------------------
+//  LightweightSemaphore Implementation
+// --------------------------------------------------------------------------------------
+
+Threading::LightweightSemaphore::LightweightSemaphore()
+    : m_count(0)
+    , m_waiters(0)
+    , m_spin(128)
+{
+}
+
+void Threading::LightweightSemaphore::Reset()
+{
+    m_count.store(0);
+}
+
+void Threading::LightweightSemaphore::Post()
+{
+    m_count.fetch_add(1);
+    if (m_waiters.load() > 0)
+        AddressWake(&m_count, 1);
+}
+
+void Threading::LightweightSemaphore::Post(int multiple)
+{
+    m_count.fetch_add(multiple);
+    if (m_waiters.load() > 0)
+        AddressWake(&m_count, multiple);
+}
+
+bool Threading::LightweightSemaphore::TryWait()
+{
+    s32 count = m_count.load();
+    while (count > 0)
+    {
+        if (m_count.compare_exchange_weak(count, count - 1))
+            return true;
+    }
+    return false;
+}
+
+// Spins for the current spin length, and adapts it to whether that caught the post.
+bool Threading::LightweightSemaphore::Spin()
+{
+    const s32 spin = m_spin.load(std::memory_order_relaxed);
+    for (s32 i = 0; i < spin; i++)
+    {
+        Threading::SpinWait();
+        if (TryWait())
+        {
+            m_spin.store(std::min(spin * 2, MaxSpin), std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    m_spin.store(std::max(spin / 2, MinSpin), std::memory_order_relaxed);
+    return false;
+}
+
+// Waits on the count in slices of at most cancel_interval, testing for cancellation in
+// between.  A negative timeout waits forever.
+bool Threading::LightweightSemaphore::BlockingWait(s64 timeout_ms)
+{
+    // Cancellation unwinds through here on Linux, so the waiter count is kept by a scope.
+    struct ScopedWaiter
+    {
+        std::atomic<s32>& waiters;
+        ScopedWaiter(std::atomic<s32>& w) : waiters(w) { waiters.fetch_add(1); }
+        ~ScopedWaiter() { waiters.fetch_sub(1); }
+    } waiter(m_waiters);
+
+    const u64 start = GetCPUTicks();
+    const u64 freq = GetTickFrequency();
+
+    while (!TryWait())
+    {
+        pthread_testcancel();
+
+        int slice = cancel_interval;
+        if (timeout_ms >= 0)
+        {
+            const s64 elapsed = (s64)((GetCPUTicks() - start) * 1000 / freq);
+            if (elapsed >= timeout_ms)
+                return false;
+            slice = (int)std::min<s64>(slice, timeout_ms - elapsed);
+        }
+
+        AddressWait(&m_count, 0, slice);
+    }
+
+    return true;
+}
+
+void Threading::LightweightSemaphore::WaitWithoutYield()
+{
+    if (TryWait() || Spin())
+        return;
+
+    BlockingWait(-1);
+}
+
+bool Threading::LightweightSemaphore::WaitWithoutYield(const wxTimeSpan &timeout)
+{
+    if (TryWait() || Spin())
+        return true;
+
+    return BlockingWait(timeout.GetMilliseconds().GetValue());
+}
+
+int Threading::LightweightSemaphore::Count()
+{
+    return m_count.load();
+}
@@ -22,6 +22,8 @@
 #include <sys/mman.h>
 #include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <ucontext.h>
 #include <unistd.h>
 
 // Apple uses the MAP_ANON define instead of MAP_ANONYMOUS, but they mean
@@ -34,8 +36,25 @@ extern void SignalExit(int sig);
 
 static const uptr m_pagemask = getpagesize() - 1;
 
+// Returns the address of the instruction that faulted, or 0 if we don't know how to get
+// it on this platform.
+static uptr GetFaultingInstruction(void *context)
+{
+    ucontext_t *uc = (ucontext_t *)context;
+#if defined(__APPLE__) && defined(__x86_64__)
+    return (uptr)uc->uc_mcontext->__ss.__rip;
+#elif defined(__FreeBSD__) && defined(__x86_64__)
+    return (uptr)uc->uc_mcontext.mc_rip;
+#elif defined(__linux__) && defined(__x86_64__)
+    return (uptr)uc->uc_mcontext.gregs[REG_RIP];
+#else
+    (void)uc;
+    return 0;
+#endif
+}
+
 // Linux implementation of SIGSEGV handler.  Bind it using sigaction().
-static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
+static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *context)
 {
     // [TODO] : Add a thread ID filter to the Linux Signal handler here.
     // Rationale: On windows, the __try/__except model allows per-thread specific behavior
@@ -59,7 +78,7 @@ static void SysPageFaultSignalFilter(int signal, siginfo_t *siginfo, void *)
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
 
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask));
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)siginfo->si_addr & ~m_pagemask, GetFaultingInstruction(context)));
 
     // resumes execution right where we left off (re-executes instruction that
     // caused the SIGSEGV).
@@ -226,3 +245,104 @@ void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &
                                baseaddr, (uptr)baseaddr + size, WX_STR(mode.ToString())));
     }
 }
+
+void HostSys::HintHugePages(void *base, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    static const uptr HugePageSize = 0x200000;
+
+    const uptr start = ((uptr)base + HugePageSize - 1) & ~(HugePageSize - 1);
+    const uptr end = ((uptr)base + size) & ~(HugePageSize - 1);
+    if (end > start)
+        madvise((void *)start, end - start, MADV_HUGEPAGE);
+#endif
+}
+
+bool HostSys::MmapCommitHugePtr(void *base, size_t size, const PageProtectionMode &mode)
+{
+#ifdef MAP_HUGETLB
+    static const uptr HugePageSize = 0x200000;
+
+    const uptr start = ((uptr)base + HugePageSize - 1) & ~(HugePageSize - 1);
+    const uptr end = ((uptr)base + size) & ~(HugePageSize - 1);
+    if (end <= start || mode.IsNone())
+        return false;
+
+    uint lnxmode = 0;
+
+    if (mode.CanWrite())
+        lnxmode |= PROT_WRITE;
+    if (mode.CanRead())
+        lnxmode |= PROT_READ;
+    if (mode.CanExecute())
+        lnxmode |= PROT_EXEC | PROT_READ;
+
+    // The huge pages are taken from the pool when mapping, so running out fails here rather
+    // than with a SIGBUS on first access
+    void *result = mmap((void *)start, end - start, lnxmode, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+    if (result != (void *)start) {
+        // A failed fixed mapping may have dropped the reserve already, so map it back
+        MmapResetPtr((void *)start, end - start);
+        return false;
+    }
+
+    // The unaligned head and tail get normal pages
+    if (start > (uptr)base && !MmapCommitPtr(base, start - (uptr)base, mode))
+        return false;
+    if ((uptr)base + size > end && !MmapCommitPtr((void *)end, (uptr)base + size - end, mode))
+        return false;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+sptr HostSys::CreateSharedMemory(const char *name, size_t size)
+{
+    PageSizeAssertionTest(size);
+
+#if defined(__linux__)
+    const int fd = memfd_create(name, 0);
+#else
+    // No memfd, so create a named object and unlink it right away, the descriptor
+    // keeps it alive.
+    char path[64];
+    snprintf(path, sizeof(path), "/%s.%d", name, (int)getpid());
+    const int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        shm_unlink(path);
+#endif
+    if (fd < 0)
+        return -1;
+
+    if (ftruncate(fd, size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void HostSys::DestroySharedMemory(sptr handle)
+{
+    if (handle >= 0)
+        close((int)handle);
+}
+
+bool HostSys::MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode)
+{
+    PageSizeAssertionTest(size);
+
+    uint lnxmode = 0;
+
+    if (mode.CanWrite())
+        lnxmode |= PROT_WRITE;
+    if (mode.CanRead())
+        lnxmode |= PROT_READ;
+    if (mode.CanExecute())
+        lnxmode |= PROT_EXEC | PROT_READ;
+
+    void *result = mmap(base, size, lnxmode, MAP_SHARED | MAP_FIXED, (int)handle, offset);
+    return result == base;
+}
@@ -16,9 +16,12 @@
 
 #include "../PrecompiledHeader.h"
 #include "PersistentThread.h"
+#include <errno.h>
+#include <time.h>
 #include <unistd.h>
 #if defined(__linux__)
 #include <sys/prctl.h>
+#include <sched.h>
 #elif defined(__unix__)
 #include <pthread_np.h>
 #endif
@@ -42,6 +45,24 @@ __forceinline void Threading::Sleep(int ms)
     usleep(1000 * ms);
 }
 
+void Threading::SleepUntil(u64 ticks)
+{
+    const s64 remaining = (s64)(ticks - GetCPUTicks());
+    if (remaining <= 0)
+        return;
+
+    // GetCPUTicks() follows the wall clock, the deadline is moved to the monotonic one so
+    // clock adjustments don't stretch the sleep.
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const s64 ns = deadline.tv_nsec + remaining * (1000000000 / (s64)GetTickFrequency());
+    deadline.tv_sec += ns / 1000000000;
+    deadline.tv_nsec = ns % 1000000000;
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+        ;
+}
+
 // For use in spin/wait loops,  Acts as a hint to Intel CPUs and should, in theory
 // improve performance and reduce cpu power consumption.
 __forceinline void Threading::SpinWait()
@@ -118,6 +139,80 @@ void Threading::pxThread::_platform_specific_OnCleanupInThread()
     // Cleanup handles here, which were opened above.
 }
 
+#if defined(__linux__)
+// Reads the leading integer of a sysfs file, which is also the lowest cpu of a cpu list
+static int read_sysfs_int(const char *fmt, int cpu, int index = 0)
+{
+    char path[128];
+    snprintf(path, sizeof(path), fmt, cpu, index);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+
+    int value = -1;
+    if (fscanf(fp, "%d", &value) != 1)
+        value = -1;
+
+    fclose(fp);
+    return value;
+}
+#endif
+
+std::vector<Threading::CpuLogicalProcessor> Threading::GetCpuTopology()
+{
+    std::vector<CpuLogicalProcessor> cpus;
+
+#if defined(__linux__)
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask))
+        return cpus;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &mask))
+            continue;
+
+        CpuLogicalProcessor p;
+        p.cpu = cpu;
+        p.core = read_sysfs_int("/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        p.package = std::max(read_sysfs_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu), 0);
+        p.l3 = -1;
+
+        // The L3 is identified by the lowest cpu sharing it, cache/indexN/id isn't
+        // available on older kernels.
+        for (int index = 0; index < 8; index++) {
+            int level = read_sysfs_int("/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+            if (level < 0)
+                break;
+            if (level == 3) {
+                p.l3 = read_sysfs_int("/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+                break;
+            }
+        }
+
+        cpus.push_back(p);
+    }
+#endif
+
+    return cpus;
+}
+
+bool Threading::SetCurrentThreadAffinity(int cpu)
+{
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+    return false;
+#endif
+}
+
 void Threading::SetNameOfCurrentThread(const char *name)
 {
 #if defined(__linux__)
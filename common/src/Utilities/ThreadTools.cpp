@@ -25,6 +25,8 @@
 #include "ThreadingInternal.h"
 #include "EventSource.inl"
 
+#include <map>
+
 using namespace Threading;
 
 template class EventSource<EventListener_Thread>;
@@ -133,6 +135,125 @@ void Threading::pxYield(int ms)
         Sleep(ms);
 }
 
+// --------------------------------------------------------------------------------------
+//  ThreadAffinityPlan Implementations
+// --------------------------------------------------------------------------------------
+static ThreadAffinityPlan BuildThreadAffinityPlan()
+{
+    ThreadAffinityPlan plan;
+
+    plan.valid = false;
+    plan.l3 = -1;
+    plan.cores = 0;
+
+    for (int &cpu : plan.role)
+        cpu = -1;
+
+    // l3 domain -> physical core -> logical cpus, processors without a reported L3
+    // are grouped by package instead.  Core ids are only unique within a package.
+
+    std::map<int, std::map<s64, std::vector<int>>> domains;
+
+    for (const CpuLogicalProcessor &p : GetCpuTopology()) {
+        int l3 = p.l3 >= 0 ? p.l3 : -1 - p.package;
+        s64 core = p.core >= 0 ? ((s64)p.package << 32) | p.core : -1 - (s64)p.cpu;
+
+        domains[l3][core].push_back(p.cpu);
+    }
+
+    const std::map<s64, std::vector<int>> *cores = NULL;
+
+    for (const auto &domain : domains) {
+        if (!cores || domain.second.size() > cores->size()) {
+            plan.l3 = domain.first;
+            cores = &domain.second;
+        }
+    }
+
+    if (!cores || cores->size() < ThreadRole_Count)
+        return plan;
+
+    plan.valid = true;
+    plan.cores = (int)cores->size();
+
+    int index = 0;
+    size_t smt = 0;
+
+    for (const auto &core : *cores) {
+        if (index < ThreadRole_Count)
+            plan.role[index] = core.second[0];
+        else
+            plan.workers.push_back(core.second[0]);
+
+        smt = std::max(smt, core.second.size());
+        index++;
+    }
+
+    // Siblings of the EE/GS/VU cores are left alone, the workers would only steal
+    // execution units from the threads that the whole frame waits for.
+
+    for (size_t i = 1; i < smt; i++) {
+        index = 0;
+
+        for (const auto &core : *cores) {
+            if (index++ >= ThreadRole_Count && i < core.second.size())
+                plan.workers.push_back(core.second[i]);
+        }
+    }
+
+    return plan;
+}
+
+int Threading::ThreadAffinityPlan::GetWorker(int index) const
+{
+    return valid && !workers.empty() ? workers[index % workers.size()] : -1;
+}
+
+wxString Threading::ThreadAffinityPlan::ToString() const
+{
+    if (!valid)
+        return L"Thread placement: not enough physical cores in one L3 domain, threads are left floating";
+
+    wxString list;
+
+    for (int cpu : workers)
+        list += wxsFormat(list.IsEmpty() ? L"%d" : L",%d", cpu);
+
+    if (list.IsEmpty())
+        list = L"none";
+
+    return wxsFormat(L"Thread placement: L3 domain %d (%d cores), EE=cpu%d GS=cpu%d VU=cpu%d SW workers=%s",
+                     l3, cores, role[ThreadRole_EE], role[ThreadRole_GS], role[ThreadRole_VU],
+                     WX_STR(list));
+}
+
+const ThreadAffinityPlan &Threading::GetThreadAffinityPlan()
+{
+    static const ThreadAffinityPlan plan = [] {
+        ThreadAffinityPlan p = BuildThreadAffinityPlan();
+        Console.WriteLn(L"%s", WX_STR(p.ToString()));
+        return p;
+    }();
+
+    return plan;
+}
+
+void Threading::ApplyThreadAffinity(ThreadRole role)
+{
+    const ThreadAffinityPlan &plan = GetThreadAffinityPlan();
+
+    if (plan.valid && !SetCurrentThreadAffinity(plan.role[role]))
+        Console.Warning("Thread placement: could not pin thread to cpu%d", plan.role[role]);
+}
+
+void Threading::ApplyWorkerAffinity(int index)
+{
+    int cpu = GetThreadAffinityPlan().GetWorker(index);
+
+    if (cpu >= 0 && !SetCurrentThreadAffinity(cpu))
+        Console.Warning("Thread placement: could not pin worker to cpu%d", cpu);
+}
+
 // (intended for internal use only)
 // Returns true if the Wait is recursive, or false if the Wait is safe and should be
 // handled via normal yielding methods.
@@ -224,6 +224,7 @@ VirtualMemoryReserve::VirtualMemoryReserve(const wxString &name, size_t size)
     m_pages_reserved = 0;
     m_baseptr = nullptr;
     m_prot_mode = PageAccess_None();
+    m_huge_pages = HugePages_None;
     m_allow_writes = true;
 }
 
@@ -233,6 +234,12 @@ VirtualMemoryReserve &VirtualMemoryReserve::SetPageAccessOnCommit(const PageProt
     return *this;
 }
 
+VirtualMemoryReserve &VirtualMemoryReserve::SetHugePages(HugePageMode mode)
+{
+    m_huge_pages = mode;
+    return *this;
+}
+
 size_t VirtualMemoryReserve::GetSize(size_t requestedSize)
 {
     if (!requestedSize)
@@ -313,7 +320,16 @@ bool VirtualMemoryReserve::Commit()
         return true;
 
     m_pages_commited = m_pages_reserved;
-    return HostSys::MmapCommitPtr(m_baseptr, m_pages_reserved * __pagesize, m_prot_mode);
+    const size_t size = m_pages_reserved * __pagesize;
+
+    if (m_huge_pages == HugePages_Explicit && HostSys::MmapCommitHugePtr(m_baseptr, size, m_prot_mode))
+        return true;
+    if (!HostSys::MmapCommitPtr(m_baseptr, size, m_prot_mode))
+        return false;
+
+    if (m_huge_pages != HugePages_None)
+        HostSys::HintHugePages(m_baseptr, size);
+    return true;
 }
 
 void VirtualMemoryReserve::AllowModification()
@@ -28,7 +28,12 @@ static long DoSysPageFaultExceptionFilter(EXCEPTION_POINTERS *eps)
     // Source_PageFault is a global variable with its own state information
     // so for now we lock this exception code unless someone can fix this better...
     Threading::ScopedLock lock(PageFault_Mutex);
-    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1]));
+    #ifdef _WIN64
+    const uptr pc = (uptr)eps->ContextRecord->Rip;
+#else
+    const uptr pc = (uptr)eps->ContextRecord->Eip;
+#endif
+    Source_PageFault->Dispatch(PageFaultInfo((uptr)eps->ExceptionRecord->ExceptionInformation[1], pc));
     return Source_PageFault->WasHandled() ? EXCEPTION_CONTINUE_EXECUTION : EXCEPTION_CONTINUE_SEARCH;
 }
 
@@ -151,3 +156,32 @@ void HostSys::MemProtect(void *baseaddr, size_t size, const PageProtectionMode &
         pxFailDev(apiError.FormatDiagnosticMessage());
     }
 }
+
+// Mapping a view over memory that is already reserved needs the placeholder API of recent
+// Windows 10 builds, which isn't used yet.  Callers fall back to private memory.
+void HostSys::HintHugePages(void *base, size_t size)
+{
+    // Large pages need the SeLockMemoryPrivilege and a dedicated VirtualAlloc, which heap
+    // blocks can't get after the fact.
+}
+
+// MEM_LARGE_PAGES memory has to be allocated reserved and committed in one go, so it can't
+// replace part of the reserve of the VirtualMemoryManager either, without placeholders.
+bool HostSys::MmapCommitHugePtr(void *base, size_t size, const PageProtectionMode &mode)
+{
+    return false;
+}
+
+sptr HostSys::CreateSharedMemory(const char *name, size_t size)
+{
+    return -1;
+}
+
+void HostSys::DestroySharedMemory(sptr handle)
+{
+}
+
+bool HostSys::MapSharedMemory(sptr handle, size_t offset, void *base, size_t size, const PageProtectionMode &mode)
+{
+    return false;
+}
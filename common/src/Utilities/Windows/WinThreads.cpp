@@ -29,6 +29,38 @@ __fi void Threading::Sleep(int ms)
     ::Sleep(ms);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void Threading::SleepUntil(u64 ticks)
+{
+    const s64 remaining = (s64)(ticks - GetCPUTicks());
+    if (remaining <= 0)
+        return;
+
+    // High resolution timers need Windows 10 1803, older versions get a regular one that
+    // is as precise as timeBeginPeriod allows.
+    static thread_local HANDLE timer = [] {
+        HANDLE t = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!t)
+            t = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        return t;
+    }();
+
+    if (!timer)
+    {
+        ::Sleep((DWORD)(remaining * 1000 / (s64)GetTickFrequency()));
+        return;
+    }
+
+    // Negative due times are relative, in 100ns units
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)(remaining * 10000000 / (s64)GetTickFrequency());
+    if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE))
+        WaitForSingleObject(timer, INFINITE);
+}
+
 // For use in spin/wait loops,  Acts as a hint to Intel CPUs and should, in theory
 // improve performance and reduce cpu power consumption.
 __fi void Threading::SpinWait()
@@ -103,6 +135,76 @@ void Threading::pxThread::_platform_specific_OnCleanupInThread()
     CloseHandle((HANDLE)m_native_handle);
 }
 
+// Only processor group 0 is considered, which covers every system with up to 64 logical cpus.
+std::vector<Threading::CpuLogicalProcessor> Threading::GetCpuTopology()
+{
+    std::vector<CpuLogicalProcessor> cpus;
+
+    DWORD_PTR process_mask, system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        return cpus;
+
+    DWORD size = 0;
+    GetLogicalProcessorInformation(NULL, &size);
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+        return cpus;
+
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!GetLogicalProcessorInformation(info.data(), &size))
+        return cpus;
+
+    const int count = sizeof(DWORD_PTR) * 8;
+
+    int core[count], package[count], l3[count];
+    int cores = 0, packages = 0, caches = 0;
+
+    for (int i = 0; i < count; i++)
+        core[i] = package[i] = l3[i] = -1;
+
+    for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION &r : info) {
+        int *id = NULL, value = 0;
+
+        if (r.Relationship == RelationProcessorCore) {
+            id = core;
+            value = cores++;
+        } else if (r.Relationship == RelationProcessorPackage) {
+            id = package;
+            value = packages++;
+        } else if (r.Relationship == RelationCache && r.Cache.Level == 3) {
+            id = l3;
+            value = caches++;
+        }
+
+        if (id)
+            for (int i = 0; i < count; i++)
+                if (r.ProcessorMask & ((DWORD_PTR)1 << i))
+                    id[i] = value;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!(process_mask & ((DWORD_PTR)1 << i)))
+            continue;
+
+        CpuLogicalProcessor p;
+        p.cpu = i;
+        p.core = core[i];
+        p.package = std::max(package[i], 0);
+        p.l3 = l3[i];
+
+        cpus.push_back(p);
+    }
+
+    return cpus;
+}
+
+bool Threading::SetCurrentThreadAffinity(int cpu)
+{
+    if (cpu < 0 || cpu >= (int)sizeof(DWORD_PTR) * 8)
+        return false;
+
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+}
+
 void Threading::SetNameOfCurrentThread(const char *name)
 {
 // This feature needs Windows headers and MSVC's SEH support:
@@ -9,7 +9,7 @@
 
 // Inline assembly syntax for use with Visual C++
 
-#if defined(_MSC_VER)
+#if defined(_MSC_VER) && !defined(_M_X86_64)
 
 // mmx mem-compare implementation, size has to be a multiple of 8
 // returns 0 is equal, nonzero value if not equal
@@ -186,3 +186,76 @@ End:
 }
 
 #endif
+
+// --------------------------------------------------------------------------------------
+//  memcpy_nt / memset_nt
+// --------------------------------------------------------------------------------------
+// The destination is brought to a cache line boundary with a plain copy, so every line is
+// written whole by the streaming stores and can leave the write-combining buffers at once.
+// AVX builds use 32 byte stores, the others SSE2 ones.
+
+#include <algorithm>
+#include <immintrin.h>
+
+void memcpy_nt(void *dest, const void *src, size_t size)
+{
+    u8 *d = (u8 *)dest;
+    const u8 *s = (const u8 *)src;
+
+    const size_t head = std::min<size_t>(-(uptr)d & 63, size);
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, d += 64, s += 64) {
+#ifdef __AVX__
+        const __m256i a = _mm256_loadu_si256((const __m256i *)s);
+        const __m256i b = _mm256_loadu_si256((const __m256i *)(s + 32));
+        _mm256_stream_si256((__m256i *)d, a);
+        _mm256_stream_si256((__m256i *)(d + 32), b);
+#else
+        const __m128i a = _mm_loadu_si128((const __m128i *)s);
+        const __m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+        const __m128i e = _mm_loadu_si128((const __m128i *)(s + 48));
+        _mm_stream_si128((__m128i *)d, a);
+        _mm_stream_si128((__m128i *)(d + 16), b);
+        _mm_stream_si128((__m128i *)(d + 32), c);
+        _mm_stream_si128((__m128i *)(d + 48), e);
+#endif
+    }
+
+    // streaming stores aren't ordered with the other stores
+    _mm_sfence();
+    memcpy(d, s, size);
+}
+
+void memset_nt(void *dest, u8 value, size_t size)
+{
+    u8 *d = (u8 *)dest;
+
+    const size_t head = std::min<size_t>(-(uptr)d & 63, size);
+    memset(d, value, head);
+    d += head;
+    size -= head;
+
+#ifdef __AVX__
+    const __m256i v = _mm256_set1_epi8((char)value);
+    for (; size >= 64; size -= 64, d += 64) {
+        _mm256_stream_si256((__m256i *)d, v);
+        _mm256_stream_si256((__m256i *)(d + 32), v);
+    }
+#else
+    const __m128i v = _mm_set1_epi8((char)value);
+    for (; size >= 64; size -= 64, d += 64) {
+        _mm_stream_si128((__m128i *)d, v);
+        _mm_stream_si128((__m128i *)(d + 16), v);
+        _mm_stream_si128((__m128i *)(d + 32), v);
+        _mm_stream_si128((__m128i *)(d + 48), v);
+    }
+#endif
+
+    _mm_sfence();
+    memset(d, value, size);
+}
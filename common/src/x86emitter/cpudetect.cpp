@@ -23,6 +23,7 @@
 
 #define cpuid __cpuid
 #define cpuidex __cpuidex
+#define xgetbv _xgetbv
 
 #else
 
@@ -38,6 +39,13 @@ static __inline__ __attribute__((always_inline)) void cpuid(int CPUInfo[], const
     __cpuid(InfoType, CPUInfo[0], CPUInfo[1], CPUInfo[2], CPUInfo[3]);
 }
 
+static __inline__ __attribute__((always_inline)) u64 xgetbv(const u32 index)
+{
+    u32 eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return ((u64)edx << 32) | eax;
+}
+
 #endif
 
 using namespace x86Emitter;
@@ -319,6 +327,15 @@ void x86capabilities::Identify()
         hasAVX = (Flags2 >> 28) & 1; //avx
         hasFMA = (Flags2 >> 12) & 1; //fma
         hasAVX2 = (SEFlag >> 5) & 1; //avx2
+
+        // Unlike AVX, the OS support of the AVX-512 state (opmask, upper ZMM and
+        // ZMM16-31) isn't a given, XCR0 must enable it
+        if ((xgetbv(0) & 0xe6) == 0xe6)
+        {
+            hasAVX512F = (SEFlag >> 16) & 1; //avx512f
+            hasAVX512BW = (SEFlag >> 30) & 1; //avx512bw
+            hasAVX512VL = (SEFlag >> 31) & 1; //avx512vl
+        }
     }
 
     hasBMI1 = (SEFlag >> 3) & 1;
@@ -31,6 +31,9 @@
 #include "PrecompiledHeader.h"
 #include "internal.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace x86Emitter
 {
 
@@ -141,6 +144,7 @@ __emitinline s32 *xJcc32(JccComparisonType comparison, s32 displacement)
         xWrite8(0x80 | comparison);
     }
     xWrite<s32>(displacement);
+    xRelaxNote(xRelax_Rel32, xGetPtr() - 4, xGetPtr());
 
     return ((s32 *)xGetPtr()) - 1;
 }
@@ -153,6 +157,7 @@ __emitinline s8 *xJcc8(JccComparisonType comparison, s8 displacement)
 {
     xWrite8((comparison == Jcc_Unconditional) ? 0xeb : (0x70 | comparison));
     xWrite<s8>(displacement);
+    xRelaxNote(xRelax_Rel8, xGetPtr() - 1, xGetPtr());
     return (s8 *)xGetPtr() - 1;
 }
 
@@ -219,6 +224,16 @@ xForwardJumpBase::xForwardJumpBase(uint opsize, JccComparisonType cctype)
     }
 
     xAdvancePtr(opsize);
+
+    if (!x86Relax)
+        return;
+
+    // The target is only known once set, so it's logged with a zero displacement
+    if (opsize == 1)
+        BasePtr[-1] = 0;
+    else
+        *(s32 *)(BasePtr - 4) = 0;
+    xRelaxLog((opsize == 1) ? xRelax_Rel8 : (cctype == Jcc_Unconditional) ? xRelax_Jump32 : xRelax_Jcc32, BasePtr - opsize, BasePtr);
 }
 
 void xForwardJumpBase::_setTarget(uint opsize) const
@@ -235,6 +250,176 @@ void xForwardJumpBase::_setTarget(uint opsize) const
     }
 }
 
+// --------------------------------------------------------------------------------------
+//  Branch relaxation
+// --------------------------------------------------------------------------------------
+struct xRelaxField
+{
+    u8 *field;
+    u8 *end;
+    xRelaxKind kind;
+    u8 *target;
+    bool shorten;
+};
+
+__tls_emit bool x86Relax = false;
+
+static __tls_emit u8 *s_relax_start = NULL;
+static __tls_emit u8 *s_relax_end = NULL;
+static __tls_emit std::vector<xRelaxField> *s_relax_fields = NULL;
+
+// Ends of the shortened jumps of the last region, with the bytes cut up to there
+static __tls_emit std::vector<std::pair<u8 *, uint>> *s_relax_cuts = NULL;
+
+static uint xRelaxCutBefore(const u8 *ptr)
+{
+    const std::vector<std::pair<u8 *, uint>> &cuts = *s_relax_cuts;
+    auto it = std::upper_bound(cuts.begin(), cuts.end(), ptr,
+                               [](const u8 *p, const std::pair<u8 *, uint> &cut) { return p < cut.first; });
+    return (it == cuts.begin()) ? 0 : (it - 1)->second;
+}
+
+static bool xRelaxInside(const u8 *ptr)
+{
+    return ptr >= s_relax_start && ptr <= s_relax_end;
+}
+
+static void xRelaxPlan()
+{
+    std::vector<std::pair<u8 *, uint>> &cuts = *s_relax_cuts;
+
+    // Start by shortening everything that could be, and give up the jumps that don't fit
+    // until nothing changes (removing a cut only ever makes the others longer).
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        cuts.clear();
+        uint cut = 0;
+        for (const xRelaxField &f : *s_relax_fields) {
+            if (f.shorten) {
+                cut += (f.kind == xRelax_Jcc32) ? 4 : 3;
+                cuts.push_back(std::make_pair(f.end, cut));
+            }
+        }
+
+        for (xRelaxField &f : *s_relax_fields) {
+            if (f.shorten && !is_s8((f.target - xRelaxCutBefore(f.target)) - (f.end - xRelaxCutBefore(f.end)))) {
+                f.shorten = false;
+                changed = true;
+            }
+        }
+    }
+}
+
+void xRelaxLog(xRelaxKind kind, const void *field, const void *end)
+{
+    xRelaxField f = {(u8 *)field, (u8 *)end, kind, NULL, false};
+    s_relax_fields->push_back(f);
+}
+
+// The code past ptr is emitted again, drop its fields.
+void xRelaxRewind(const void *ptr)
+{
+    while (!s_relax_fields->empty() && s_relax_fields->back().field >= (u8 *)ptr)
+        s_relax_fields->pop_back();
+}
+
+void xRelaxBegin()
+{
+    pxAssert(!x86Relax);
+
+    if (!s_relax_fields) {
+        s_relax_fields = new std::vector<xRelaxField>();
+        s_relax_cuts = new std::vector<std::pair<u8 *, uint>>();
+    }
+
+    s_relax_fields->clear();
+    s_relax_cuts->clear();
+    s_relax_start = x86Ptr;
+    s_relax_end = x86Ptr;
+    x86Relax = true;
+}
+
+// Returns the number of bytes saved, x86Ptr is moved back accordingly.
+uint xRelaxEnd()
+{
+    pxAssert(x86Relax);
+    x86Relax = false;
+    s_relax_end = x86Ptr;
+
+    std::vector<xRelaxField> &fields = *s_relax_fields;
+
+    // In address order, the last one wins if a field got emitted over
+    std::stable_sort(fields.begin(), fields.end(), [](const xRelaxField &a, const xRelaxField &b) { return a.field < b.field; });
+    size_t count = 0;
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (i + 1 < fields.size() && fields[i + 1].field == fields[i].field)
+            continue;
+        fields[count++] = fields[i];
+    }
+    fields.resize(count);
+
+    for (xRelaxField &f : fields) {
+        f.target = f.end + ((f.kind == xRelax_Rel8) ? *(s8 *)f.field : *(s32 *)f.field);
+        f.shorten = (f.kind == xRelax_Jump32 || f.kind == xRelax_Jcc32) && xRelaxInside(f.target);
+    }
+
+    xRelaxPlan();
+
+    if (s_relax_cuts->empty())
+        return 0;
+
+    // New displacements, relative to the new addresses
+    std::vector<sptr> disp(fields.size());
+    for (size_t i = 0; i < fields.size(); i++) {
+        const xRelaxField &f = fields[i];
+        u8 *target = xRelaxInside(f.target) ? xRelaxMap(f.target) : f.target;
+        disp[i] = target - xRelaxMap(f.end);
+    }
+
+    // Compact the code, the opcodes of the shortened jumps are still in place when reached
+    u8 *dst = s_relax_start;
+    u8 *src = s_relax_start;
+    for (const xRelaxField &f : fields) {
+        if (!f.shorten)
+            continue;
+
+        u8 *op = f.field - ((f.kind == xRelax_Jcc32) ? 2 : 1);
+        u8 opcode = (f.kind == xRelax_Jcc32) ? (0x70 | (f.field[-1] & 0x0f)) : 0xeb;
+
+        memmove(dst, src, op - src);
+        dst += op - src;
+        dst[0] = opcode;
+        dst += 2;
+        src = f.end;
+    }
+    memmove(dst, src, s_relax_end - src);
+    x86Ptr = dst + (s_relax_end - src);
+
+    for (size_t i = 0; i < fields.size(); i++) {
+        const xRelaxField &f = fields[i];
+        if (f.shorten || f.kind == xRelax_Rel8) {
+            pxAssert(is_s8(disp[i]));
+            *(s8 *)(xRelaxMap(f.end) - 1) = (s8)disp[i];
+        } else {
+            pxAssertDev(disp[i] == (s32)disp[i], "Relaxed displacement out of range");
+            *(s32 *)xRelaxMap(f.field) = (s32)disp[i];
+        }
+    }
+
+    return (uint)(s_relax_end - x86Ptr);
+}
+
+// Maps an address of the code of the last region to where it is after xRelaxEnd.
+u8 *xRelaxMap(const void *ptr)
+{
+    if (!s_relax_cuts || !xRelaxInside((u8 *)ptr))
+        return (u8 *)ptr;
+
+    return (u8 *)ptr - xRelaxCutBefore((u8 *)ptr);
+}
+
 // returns the inverted conditional type for this Jcc condition.  Ie, JNS will become JS.
 __fi JccComparisonType xInvertCond(JccComparisonType src)
 {
@@ -62,11 +62,13 @@ emitterT u8 *J8Rel(int cc, int to)
 {
     xWrite8(cc);
     xWrite8(to);
+    xRelaxNote(xRelax_Rel8, x86Ptr - 1, x86Ptr);
     return (u8 *)(x86Ptr - 1);
 }
 
 emitterT u16 *J16Rel(int cc, u32 to)
 {
+    pxAssertMsg(!x86Relax, "rel16 jumps can't be relaxed");
     xWrite16(0x0F66);
     xWrite8(cc);
     xWrite16(to);
@@ -78,13 +80,14 @@ emitterT u32 *J32Rel(int cc, u32 to)
     xWrite8(0x0F);
     xWrite8(cc);
     xWrite32(to);
+    xRelaxNote(xRelax_Rel32, x86Ptr - 4, x86Ptr);
     return (u32 *)(x86Ptr - 4);
 }
 
 ////////////////////////////////////////////////////
 emitterT void x86SetPtr(u8 *ptr)
 {
-    x86Ptr = ptr;
+    xSetPtr(ptr);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -159,6 +162,7 @@ emitterT u8 *JMP8(u8 to)
 {
     xWrite8(0xEB);
     xWrite8(to);
+    xRelaxNote(xRelax_Rel8, x86Ptr - 1, x86Ptr);
     return x86Ptr - 1;
 }
 
@@ -168,6 +172,7 @@ emitterT u32 *JMP32(uptr to)
     assert((sptr)to <= 0x7fffffff && (sptr)to >= -0x7fffffff);
     xWrite8(0xE9);
     xWrite32(to);
+    xRelaxNote(xRelax_Rel32, x86Ptr - 4, x86Ptr);
     return (u32 *)(x86Ptr - 4);
 }
 
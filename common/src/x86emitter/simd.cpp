@@ -338,6 +338,44 @@ const xImplSimd_Round xROUND =
         {0x66, 0x0b3a}, // SD
 };
 
+void xImplSimd_FMA::SS(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2) const { xOpWriteC4(0x66, 0x38, Opcode, to, from1, from2, 0); }
+void xImplSimd_FMA::SS(const xRegisterSSE &to, const xRegisterSSE &from1, const xIndirectVoid &from2) const { xOpWriteC4(0x66, 0x38, Opcode, to, from1, from2, 0); }
+
+void xImplSimd_FMA::SD(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2) const { xOpWriteC4(0x66, 0x38, Opcode, to, from1, from2, 1); }
+void xImplSimd_FMA::SD(const xRegisterSSE &to, const xRegisterSSE &from1, const xIndirectVoid &from2) const { xOpWriteC4(0x66, 0x38, Opcode, to, from1, from2, 1); }
+
+const xImplSimd_FMA xVFMADD231 = {0xb9};
+const xImplSimd_FMA xVFNMADD231 = {0xbd};
+
+// =====================================================================================================
+//  AVX2 256-bit Instructions
+// =====================================================================================================
+
+void xVMOVUPS(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC5(0x00, 0x10, to, xmm0, from); }
+void xVMOVUPS(const xIndirectVoid &to, const xRegisterSSE &from) { xOpWriteC5(0x00, 0x11, from, xmm0, to); }
+
+void xVPMOVSXBD(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x21, to, xmm0, from); }
+void xVPMOVZXBD(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x31, to, xmm0, from); }
+void xVPMOVSXWD(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x23, to, xmm0, from); }
+void xVPMOVZXWD(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x33, to, xmm0, from); }
+
+void xVPADDD(const xRegisterSSE &to, const xRegisterSSE &from1, const xRegisterSSE &from2)
+{
+    if (from2.IsExtended())
+        xOpWriteC4(0x66, 0x0F, 0xFE, to, from1, from2);
+    else
+        xOpWriteC5(0x66, 0xFE, to, from1, from2);
+}
+
+void xVBROADCASTI128(const xRegisterSSE &to, const xIndirectVoid &from) { xOpWriteC4(0x66, 0x38, 0x5A, to, xmm0, from, 0); }
+
+void xVZEROUPPER()
+{
+    xWrite8(0xC5);
+    xWrite8(0xF8);
+    xWrite8(0x77);
+}
+
 // =====================================================================================================
 //  SIMD Comparison Instructions
 // =====================================================================================================
@@ -303,6 +303,7 @@ void EmitSibMagic(uint regfield, const void *address, int extraRIPOffset)
     if (ripRelative == (s32)ripRelative) {
         ModRM(0, regfield, ModRm_UseDisp32);
         displacement = ripRelative;
+        xRelaxNote(xRelax_Rel32, x86Ptr, x86Ptr + sizeof(s32) + extraRIPOffset);
     } else {
         pxAssertDev(displacement == (s32)displacement, "SIB target is too far away, needs an indirect register");
         ModRM(0, regfield, ModRm_UseSib);
@@ -526,6 +527,8 @@ void EmitRexImplicitlyWide(const xIndirectVoid &sib)
 // a need to change the storage class system for the x86Ptr 'under the hood.'
 __emitinline void xSetPtr(void *ptr)
 {
+    if (x86Relax)
+        xRelaxRewind(ptr);
     x86Ptr = (u8 *)ptr;
 }
 
@@ -562,6 +565,34 @@ __emitinline void xAlignCallTarget()
     }
 }
 
+// Aligns a jump target that code may also fall through into (a loop head), with the
+// long NOPs.  Nothing is padded if the alignment would take more than maxpadding bytes.
+__emitinline void xAlignJumpTarget(uint bytes, uint maxpadding)
+{
+    static const u8 nops[9][9] = {
+        {0x90},
+        {0x66, 0x90},
+        {0x0f, 0x1f, 0x00},
+        {0x0f, 0x1f, 0x40, 0x00},
+        {0x0f, 0x1f, 0x44, 0x00, 0x00},
+        {0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00},
+        {0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00},
+        {0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+        {0x66, 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+    };
+
+    uint padding = (uint)(-(sptr)x86Ptr & (bytes - 1));
+    if (padding > maxpadding)
+        return;
+
+    while (padding) {
+        uint len = std::min<uint>(padding, 9);
+        memcpy(x86Ptr, nops[len - 1], len);
+        x86Ptr += len;
+        padding -= len;
+    }
+}
+
 __emitinline u8 *xGetAlignedCallTarget()
 {
     xAlignCallTarget();
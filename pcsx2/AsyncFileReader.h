@@ -23,7 +23,12 @@
 #elif defined(__POSIX__)
 #	include <aio.h>
 #endif
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class AsyncFileReader
 {
@@ -53,6 +58,14 @@ public:
 	virtual void SetBlockSize(uint bytes) {}
 	virtual void SetDataOffset(int bytes) {}
 
+	// Readers that have the image in memory return it here instead of reading it, the
+	// data stays valid until Close. Returns null when the sectors have to be read.
+	virtual const u8* GetMappedSectors(uint sector, uint count) { return nullptr; }
+
+	// Tells the reader that the sectors are about to be read in order, so that it can
+	// start fetching them ahead of the requests. Readers without readahead ignore it.
+	virtual void PrefetchHint(uint sector, uint count) {}
+
 	uint GetBlockSize() const { return m_blocksize; }
 
 	const wxString& GetFilename() const
@@ -76,6 +89,17 @@ class FlatFileReader : public AsyncFileReader
 #elif defined(__linux__)
 	int m_fd; // FIXME don't know if overlap as an equivalent on linux
 	io_context_t m_aio_context;
+
+	// Mapping of the whole image, reads are copies from the page cache (aio when null)
+	u8* m_mapping;
+	u64 m_mappingSize;
+	int m_mappedResult;
+	u64 m_lastReadEnd;
+	u64 m_willNeedEnd;
+	uint m_sequentialReads;
+	bool m_adviseSequential;
+
+	const u8* MapRead(u64 offset, u32 bytes);
 #elif defined(__POSIX__)
 	int m_fd; // TODO OSX don't know if overlap as an equivalent on OSX
 	struct aiocb m_aiocb;
@@ -102,6 +126,11 @@ public:
 
 	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
 	virtual void SetDataOffset(int bytes) { m_dataoffset = bytes; }
+
+#ifdef __linux__
+	virtual const u8* GetMappedSectors(uint sector, uint count);
+	virtual void PrefetchHint(uint sector, uint count);
+#endif
 };
 
 class MultipartFileReader : public AsyncFileReader
@@ -152,12 +181,14 @@ class BlockdumpFileReader : public AsyncFileReader
 	u32 m_blocks;
 	s32 m_blockofs;
 
-	// index table
-	std::unique_ptr<u32[]> m_dtable;
-	int m_dtablesize;
+	// index table: lsn -> position of the block in the dump
+	std::unordered_map<u32, u32> m_dtable;
 
 	int m_lresult;
 
+	bool LoadIndex(wxFileOffset dumpLength);
+	void ScanIndex(std::vector<u32>& lsns, u32 count);
+
 public:
 	BlockdumpFileReader(void);
 	virtual ~BlockdumpFileReader(void);
@@ -176,5 +207,59 @@ public:
 
 	static bool DetectBlockdump(AsyncFileReader* reader);
 
+	// Saves the lsn of each block of the dump next to it, so that opening it doesn't
+	// have to read the whole dump. Returns false if the index couldn't be written.
+	static bool WriteIndex(const wxString& dumpName, u32 blocksize, const std::vector<u32>& lsns);
+
 	int GetBlockOffset() { return m_blockofs; }
 };
+
+// Copies the image to memory from a background thread, as the wrapped reader delivers it
+// (so decompressed), up to a memory limit. The loaded sectors are served from memory and
+// the others by the wrapped reader, which the wrapper owns.
+class PreloadingFileReader : public AsyncFileReader
+{
+	DeclareNoncopyableObject( PreloadingFileReader );
+
+	static const uint LoadUnit = 256; // sectors read at once by the thread
+
+	AsyncFileReader* m_reader;
+	std::unique_ptr<u8[]> m_data;
+	uint m_sectors;              // sectors to load
+	std::atomic<uint> m_loaded;  // sectors loaded so far, from the first one
+
+	std::thread m_thread;
+	std::atomic<bool> m_quit;
+	std::mutex m_readerMutex;    // taken by the thread, and by reads of the wrapped reader
+	std::unique_lock<std::mutex> m_readLock; // from BeginRead to FinishRead
+
+	int m_result;
+	bool m_fromMemory;
+
+	// Percentage loaded by the preload in progress, -1 without one
+	static std::atomic<int> s_progress;
+
+	void LoadThread();
+	bool IsLoaded(uint sector, uint count) const;
+
+public:
+	PreloadingFileReader(AsyncFileReader* reader, u64 limitBytes);
+	virtual ~PreloadingFileReader(void);
+
+	virtual bool Open(const wxString& fileName);
+
+	virtual int ReadSync(void* pBuffer, uint sector, uint count);
+
+	virtual void BeginRead(void* pBuffer, uint sector, uint count);
+	virtual int FinishRead(void);
+	virtual void CancelRead(void);
+
+	virtual void Close(void);
+
+	virtual uint GetBlockCount(void) const;
+
+	virtual const u8* GetMappedSectors(uint sector, uint count);
+	virtual void PrefetchHint(uint sector, uint count);
+
+	static int GetProgress() { return s_progress.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,239 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PrecompiledHeader.h"
+#include "AsyncLog.h"
+#include "DebugTools/Debug.h"
+#include "Utilities/PersistentThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AsyncLog
+{
+	// Each entry is a u32 header followed by its text, the header holds the length in bytes
+	static const u32 NewlineFlag = 1u << 31;
+	static const u32 WideFlag = 1u << 30;
+	static const u32 LengthMask = WideFlag - 1;
+
+	static const std::chrono::milliseconds WriterInterval(5);
+
+	struct ThreadRing
+	{
+		std::unique_ptr<u8[]> data{new u8[Capacity]};
+		std::atomic<u32> written{0};
+		std::atomic<u32> read{0};
+		std::atomic<u32> dropped{0};
+		std::atomic<bool> alive{true};
+	};
+
+	// Only taken when a thread writes its first text, and by the writer side
+	static std::mutex s_lock;
+	static std::condition_variable s_wake;
+
+	struct WriterState
+	{
+		std::vector<std::unique_ptr<ThreadRing>> rings;
+		std::vector<char> scratch;
+		std::thread thread;
+		bool quit = false;
+
+		~WriterState()
+		{
+			if (!thread.joinable())
+				return;
+			{
+				std::lock_guard<std::mutex> lock(s_lock);
+				quit = true;
+			}
+			s_wake.notify_one();
+			thread.join();
+		}
+	};
+	static WriterState s_writer;
+
+	// The ring outlives its thread so its text still gets written, the writer frees it
+	struct ThreadRingOwner
+	{
+		ThreadRing* ring = nullptr;
+
+		~ThreadRingOwner()
+		{
+			if (ring)
+				ring->alive.store(false, std::memory_order_release);
+		}
+	};
+	static thread_local ThreadRingOwner s_owner;
+
+	static void Copy(u8* ring, u32 pos, const void* src, u32 size)
+	{
+		const u32 offset = pos & (Capacity - 1);
+		const u32 first = std::min(size, Capacity - offset);
+		memcpy(ring + offset, src, first);
+		memcpy(ring, static_cast<const u8*>(src) + first, size - first);
+	}
+
+	static void CopyOut(const u8* ring, u32 pos, void* dest, u32 size)
+	{
+		const u32 offset = pos & (Capacity - 1);
+		const u32 first = std::min(size, Capacity - offset);
+		memcpy(dest, ring + offset, first);
+		memcpy(static_cast<u8*>(dest) + first, ring, size - first);
+	}
+
+	// Writes out everything queued, called with s_lock held
+	static void Drain()
+	{
+		FILE* fp = emuLog;
+		bool wrote = false;
+
+		for (const auto& ring : s_writer.rings)
+		{
+			const u32 dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped && fp)
+			{
+				fprintf(fp, "(%u log lines dropped)\n", dropped);
+				wrote = true;
+			}
+
+			u32 pos = ring->read.load(std::memory_order_relaxed);
+			const u32 end = ring->written.load(std::memory_order_acquire);
+			while (pos != end)
+			{
+				u32 header;
+				CopyOut(ring->data.get(), pos, &header, sizeof(header));
+				const u32 length = header & LengthMask;
+				s_writer.scratch.resize(length + 1);
+				CopyOut(ring->data.get(), pos + sizeof(header), s_writer.scratch.data(), length);
+				s_writer.scratch[length] = 0;
+				pos += sizeof(header) + length;
+
+				if (!fp)
+					continue;
+				if (header & WideFlag)
+				{
+					px_fputs(fp, wxString(reinterpret_cast<const wxChar*>(s_writer.scratch.data()), length / sizeof(wxChar)).ToUTF8());
+#ifdef _WIN32
+					if (header & NewlineFlag)
+						fputs("\r\n", fp);
+#else
+					if (header & NewlineFlag)
+						fputc('\n', fp);
+#endif
+				}
+				else
+				{
+					fputs(s_writer.scratch.data(), fp);
+					if (header & NewlineFlag)
+						fputc('\n', fp);
+				}
+				wrote = true;
+			}
+			ring->read.store(pos, std::memory_order_release);
+		}
+
+		if (wrote)
+			fflush(fp);
+
+		// Nothing gets queued into the ring of a finished thread anymore
+		s_writer.rings.erase(std::remove_if(s_writer.rings.begin(), s_writer.rings.end(),
+								 [](const std::unique_ptr<ThreadRing>& ring) {
+									 return !ring->alive.load(std::memory_order_acquire) &&
+											ring->read.load(std::memory_order_relaxed) == ring->written.load(std::memory_order_acquire);
+								 }),
+			s_writer.rings.end());
+	}
+
+	static void WriterThread()
+	{
+		Threading::SetNameOfCurrentThread("Log Writer");
+
+		std::unique_lock<std::mutex> lock(s_lock);
+		while (!s_writer.quit)
+		{
+			Drain();
+			s_wake.wait_for(lock, WriterInterval);
+		}
+		Drain();
+	}
+
+	static ThreadRing* NewRing()
+	{
+		std::unique_ptr<ThreadRing> ring(new ThreadRing);
+
+		std::lock_guard<std::mutex> lock(s_lock);
+		if (!s_writer.thread.joinable())
+			s_writer.thread = std::thread(WriterThread);
+		s_owner.ring = ring.get();
+		s_writer.rings.push_back(std::move(ring));
+		return s_owner.ring;
+	}
+
+	static void Push(u32 header, const void* text, u32 length)
+	{
+		ThreadRing* ring = s_owner.ring ? s_owner.ring : NewRing();
+
+		const u32 size = sizeof(header) + length;
+		const u32 pos = ring->written.load(std::memory_order_relaxed);
+		if (size > Capacity - (pos - ring->read.load(std::memory_order_acquire)))
+		{
+			ring->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		Copy(ring->data.get(), pos, &header, sizeof(header));
+		Copy(ring->data.get(), pos + sizeof(header), text, length);
+		ring->written.store(pos + size, std::memory_order_release);
+	}
+
+	void Write(const char* text, size_t length, bool newline)
+	{
+		if (emuLog == NULL)
+			return;
+
+		const u32 size = static_cast<u32>(std::min<size_t>(length, Capacity / 2));
+		Push(size | (newline ? NewlineFlag : 0), text, size);
+	}
+
+	void Write(const wxString& text, bool newline)
+	{
+		if (emuLog == NULL)
+			return;
+
+		const u32 size = static_cast<u32>(std::min<size_t>(text.length(), Capacity / 2 / sizeof(wxChar)) * sizeof(wxChar));
+		Push(size | WideFlag | (newline ? NewlineFlag : 0), text.wc_str(), size);
+	}
+
+	void Flush()
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+		Drain();
+	}
+
+	void CloseFile()
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+		Drain();
+		if (emuLog != NULL)
+		{
+			fclose(emuLog);
+			emuLog = NULL;
+		}
+	}
+} // namespace AsyncLog
@@ -0,0 +1,39 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Asynchronous sink for the log file (emuLog).
+//
+// Every thread queues its text into a ring of its own without taking a lock, and a writer
+// thread does the file I/O and flushing in batches, so logging threads don't stall on the
+// disk.  Lines of different threads are written in batches per thread, so they may end up
+// slightly out of order in the file.  Text which doesn't fit into its thread's ring is
+// dropped and counted, and the writer notes how many lines went missing.
+namespace AsyncLog
+{
+	static const uint Capacity = 1 << 18; // bytes per thread
+
+	// Queues ASCII/UTF-8 text, the newline is added by the writer
+	extern void Write(const char* text, size_t length, bool newline);
+	// Queues console text, which is converted to UTF-8 on the writer thread
+	extern void Write(const wxString& text, bool newline);
+
+	__fi void WriteLn(const char* text) { Write(text, strlen(text), true); }
+
+	// Writes everything queued so far to the file
+	extern void Flush();
+	// Flushes and closes emuLog, which must not be closed any other way
+	extern void CloseFile();
+} // namespace AsyncLog
@@ -28,6 +28,107 @@ enum isoFlags
 
 static const uint BlockDumpHeaderSize = 16;
 
+// Sidecar index: magic, version, block size, block count, dump length, then the lsn of each block
+static const char BlockDumpIndexMagic[4] = {'B', 'D', 'I', 'X'};
+static const u32 BlockDumpIndexVersion = 1;
+static const uint BlockDumpIndexHeaderSize = 24;
+
+static wxString IndexFileName(const wxString& dumpName)
+{
+	return dumpName + L".idx";
+}
+
+bool BlockdumpFileReader::WriteIndex(const wxString& dumpName, u32 blocksize, const std::vector<u32>& lsns)
+{
+	const u32 count = lsns.size();
+	const u64 dumpLength = BlockDumpHeaderSize + (u64)count * (blocksize + 4);
+
+	wxFileOutputStream out(IndexFileName(dumpName));
+	if (!out.IsOk())
+		return false;
+
+	out.Write(BlockDumpIndexMagic, sizeof(BlockDumpIndexMagic));
+	out.Write(&BlockDumpIndexVersion, sizeof(BlockDumpIndexVersion));
+	out.Write(&blocksize, sizeof(blocksize));
+	out.Write(&count, sizeof(count));
+	out.Write(&dumpLength, sizeof(dumpLength));
+	if (count)
+		out.Write(lsns.data(), count * sizeof(u32));
+
+	return out.GetLastError() == wxSTREAM_NO_ERROR && out.Close();
+}
+
+bool BlockdumpFileReader::LoadIndex(wxFileOffset dumpLength)
+{
+	const wxString indexName = IndexFileName(m_filename);
+	if (!wxFileExists(indexName))
+		return false;
+
+	wxFileInputStream in(indexName);
+	if (!in.IsOk())
+		return false;
+
+	char magic[4];
+	u32 version = 0, blocksize = 0, count = 0;
+	u64 length = 0;
+	in.Read(magic, sizeof(magic));
+	in.Read(&version, sizeof(version));
+	in.Read(&blocksize, sizeof(blocksize));
+	in.Read(&count, sizeof(count));
+	in.Read(&length, sizeof(length));
+
+	// Stale if the dump was rewritten or extended since
+	if (in.LastRead() != sizeof(length) || memcmp(magic, BlockDumpIndexMagic, sizeof(magic)) != 0 ||
+		version != BlockDumpIndexVersion || blocksize != m_blocksize || length != (u64)dumpLength ||
+		in.GetLength() != BlockDumpIndexHeaderSize + (wxFileOffset)count * sizeof(u32))
+		return false;
+
+	std::vector<u32> lsns(count);
+	if (count)
+	{
+		in.Read(lsns.data(), count * sizeof(u32));
+		if (in.LastRead() != count * sizeof(u32))
+			return false;
+	}
+
+	for (u32 i = 0; i < count; i++)
+		m_dtable.emplace(lsns[i], i);
+
+	return true;
+}
+
+void BlockdumpFileReader::ScanIndex(std::vector<u32>& lsns, u32 count)
+{
+	lsns.resize(count);
+
+	m_file->SeekI(BlockDumpHeaderSize);
+
+	u32 bs = 1024 * 1024;
+	u32 off = 0;
+	u32 has = 0;
+	u32 i = 0;
+
+	std::unique_ptr<u8[]> buffer(new u8[bs]);
+	do
+	{
+		m_file->Read(buffer.get(), bs);
+		has = m_file->LastRead();
+
+		while (i < count && off < has)
+		{
+			lsns[i++] = *reinterpret_cast<u32*>(buffer.get() + off);
+			off += 4;
+			off += m_blocksize;
+		}
+
+		off -= has;
+
+	} while (has == bs);
+
+	for (i = 0; i < count; i++)
+		m_dtable.emplace(lsns[i], i);
+}
+
 bool BlockdumpFileReader::DetectBlockdump(AsyncFileReader* reader)
 {
 	uint oldbs = reader->GetBlockSize();
@@ -49,7 +150,6 @@ BlockdumpFileReader::BlockdumpFileReader(void)
 	: m_file(NULL)
 	, m_blocks(0)
 	, m_blockofs(0)
-	, m_dtablesize(0)
 	, m_lresult(0)
 {
 }
@@ -81,36 +181,19 @@ bool BlockdumpFileReader::Open(const wxString& fileName)
 	m_file->Read(&m_blockofs, sizeof(m_blockofs));
 
 	wxFileOffset flen = m_file->GetLength();
-	static const wxFileOffset datalen = flen - BlockDumpHeaderSize;
+	const wxFileOffset datalen = flen - BlockDumpHeaderSize;
 
 	pxAssert((datalen % (m_blocksize + 4)) == 0);
 
-	m_dtablesize = datalen / (m_blocksize + 4);
-	m_dtable = std::unique_ptr<u32[]>(new u32[m_dtablesize]);
-
-	m_file->SeekI(BlockDumpHeaderSize);
-
-	u32 bs = 1024 * 1024;
-	u32 off = 0;
-	u32 has = 0;
-	int i = 0;
-
-	std::unique_ptr<u8[]> buffer(new u8[bs]);
-	do
-	{
-		m_file->Read(buffer.get(), bs);
-		has = m_file->LastRead();
-
-		while (i < m_dtablesize && off < has)
-		{
-			m_dtable[i++] = *reinterpret_cast<u32*>(buffer.get() + off);
-			off += 4;
-			off += m_blocksize;
-		}
-
-		off -= has;
+	m_dtable.clear();
+	if (LoadIndex(flen))
+		return true;
 
-	} while (has == bs);
+	// No usable index: read the lsn of every block, and save them for the next time
+	std::vector<u32> lsns;
+	ScanIndex(lsns, datalen / (m_blocksize + 4));
+	if (!WriteIndex(m_filename, m_blocksize, lsns))
+		Console.Warning(L"Blockdump: unable to write the index %s", WX_STR(IndexFileName(m_filename)));
 
 	return true;
 }
@@ -122,35 +205,28 @@ int BlockdumpFileReader::ReadSync(void* pBuffer, uint lsn, uint count)
 
 	while (count > 0)
 	{
-		bool ok = false;
-		for (int i = 0; i < m_dtablesize; ++i)
+		auto block = m_dtable.find(lsn);
+		if (block == m_dtable.end())
 		{
-			if (m_dtable[i] != lsn)
-				continue;
+			Console.WriteLn("Block %u not found in dump", lsn);
+			return -1;
+		}
+
+		const wxFileOffset i = block->second;
 
-				// We store the LSN (u32) along with each block inside of blockdumps, so the
-				// seek position ends up being based on (m_blocksize + 4) instead of just m_blocksize.
+		// We store the LSN (u32) along with each block inside of blockdumps, so the
+		// seek position ends up being based on (m_blocksize + 4) instead of just m_blocksize.
 
 #ifdef PCSX2_DEBUG
-			u32 check_lsn;
-			m_file->SeekI(BlockDumpHeaderSize + (i * (m_blocksize + 4)));
-			m_file->Read(&check_lsn, sizeof(check_lsn));
-			pxAssert(check_lsn == lsn);
+		u32 check_lsn;
+		m_file->SeekI(BlockDumpHeaderSize + (i * (m_blocksize + 4)));
+		m_file->Read(&check_lsn, sizeof(check_lsn));
+		pxAssert(check_lsn == lsn);
 #else
-			m_file->SeekI(BlockDumpHeaderSize + (i * (m_blocksize + 4)) + 4);
+		m_file->SeekI(BlockDumpHeaderSize + (i * (m_blocksize + 4)) + 4);
 #endif
 
-			m_file->Read(dst, m_blocksize);
-
-			ok = true;
-			break;
-		}
-
-		if (!ok)
-		{
-			Console.WriteLn("Block %u not found in dump", lsn);
-			return -1;
-		}
+		m_file->Read(dst, m_blocksize);
 
 		count--;
 		lsn++;
@@ -181,6 +257,7 @@ void BlockdumpFileReader::Close(void)
 		delete m_file;
 		m_file = NULL;
 	}
+	m_dtable.clear();
 }
 
 uint BlockdumpFileReader::GetBlockCount(void) const
@@ -16,17 +16,30 @@
 #include "PrecompiledHeader.h"
 #include "CDVDdiscReader.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <limits>
+#include <list>
 #include <queue>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 const u32 sectors_per_read = 16;
 
 static_assert(sectors_per_read > 1 && !(sectors_per_read & (sectors_per_read - 1)),
 			  "sectors_per_read must by a power of 2");
 
+// Most blocks read from the drive in one command. Adjacent requests and the
+// readahead are read together, the drive is mostly seek and command latency.
+const u32 max_blocks_per_read = 8;
+
+// Readahead, in blocks: small after a seek, doubled by each request that lands in
+// it, so that sequential reads keep the drive streaming
+const u32 min_prefetch_blocks = 2;
+const u32 max_prefetch_blocks = 128;
+
 struct SectorInfo
 {
 	u32 lsn;
@@ -45,6 +58,9 @@ static std::queue<u32> s_request_queue;
 static std::mutex s_cache_lock;
 
 static std::atomic<bool> cdvd_is_open;
+// Last block requested that the cache already had, so that the readahead follows
+// the reads it serves
+static std::atomic<u32> s_cache_hit_lsn;
 
 //bits: 12 would use 1<<12 entries, or 4096*16 sectors ~ 128MB
 #define CACHE_SIZE 12
@@ -52,27 +68,44 @@ static std::atomic<bool> cdvd_is_open;
 const u32 CacheSize = 1U << CACHE_SIZE;
 SectorInfo Cache[CacheSize];
 
-u32 cdvdSectorHash(u32 lsn)
-{
-	u32 t = 0;
-
-	int i = 32;
-	u32 m = CacheSize - 1;
-
-	while (i >= 0)
-	{
-		t ^= lsn & m;
-		lsn >>= CACHE_SIZE;
-		i -= CACHE_SIZE;
-	}
+// The cache evicts the least recently used block: block lsn -> cache entry, and the
+// entries in use, most recently used first
+static std::unordered_map<u32, u32> s_cache_entries;
+static std::list<u32> s_cache_lru;
+static std::list<u32>::iterator s_cache_lru_pos[CacheSize];
 
-	return t & m;
+static void cdvdCacheTouch(u32 entry)
+{
+	s_cache_lru.splice(s_cache_lru.begin(), s_cache_lru, s_cache_lru_pos[entry]);
 }
 
 void cdvdCacheUpdate(u32 lsn, u8* data)
 {
 	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
+	u32 entry;
+
+	auto it = s_cache_entries.find(lsn);
+	if (it != s_cache_entries.end())
+	{
+		entry = it->second;
+		cdvdCacheTouch(entry);
+	}
+	else
+	{
+		if (s_cache_lru.size() < CacheSize)
+		{
+			entry = s_cache_lru.size();
+			s_cache_lru.push_front(entry);
+			s_cache_lru_pos[entry] = s_cache_lru.begin();
+		}
+		else
+		{
+			entry = s_cache_lru.back();
+			s_cache_entries.erase(Cache[entry].lsn);
+			cdvdCacheTouch(entry);
+		}
+		s_cache_entries[lsn] = entry;
+	}
 
 	memcpy(Cache[entry].data, data, 2352 * sectors_per_read);
 	Cache[entry].lsn = lsn;
@@ -81,19 +114,19 @@ void cdvdCacheUpdate(u32 lsn, u8* data)
 bool cdvdCacheCheck(u32 lsn)
 {
 	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
 
-	return Cache[entry].lsn == lsn;
+	return s_cache_entries.count(lsn) != 0;
 }
 
 bool cdvdCacheFetch(u32 lsn, u8* data)
 {
 	std::lock_guard<std::mutex> guard(s_cache_lock);
-	u32 entry = cdvdSectorHash(lsn);
 
-	if (Cache[entry].lsn == lsn)
+	auto it = s_cache_entries.find(lsn);
+	if (it != s_cache_entries.end())
 	{
-		memcpy(data, Cache[entry].data, 2352 * sectors_per_read);
+		cdvdCacheTouch(it->second);
+		memcpy(data, Cache[it->second].data, 2352 * sectors_per_read);
 		return true;
 	}
 	//printf("NOT IN CACHE\n");
@@ -103,12 +136,38 @@ bool cdvdCacheFetch(u32 lsn, u8* data)
 void cdvdCacheReset()
 {
 	std::lock_guard<std::mutex> guard(s_cache_lock);
+	s_cache_entries.clear();
+	s_cache_lru.clear();
 	for (u32 i = 0; i < CacheSize; i++)
 	{
 		Cache[i].lsn = std::numeric_limits<u32>::max();
 	}
 }
 
+// Reads `blocks` consecutive cache blocks in one go, to data, and adds them to the cache
+bool cdvdReadBlocksOfSectors(u32 sector, u32 blocks, u8* data)
+{
+	u32 count = std::min(sectors_per_read * blocks, src->GetSectorCount() - sector);
+	const s32 media = src->GetMediaType();
+	const u32 sector_size = media >= 0 ? 2048 : 2352;
+
+	bool ok = false;
+	for (int tries = 0; tries < 2 && !ok; ++tries)
+	{
+		if (media >= 0)
+			ok = src->ReadSectors2048(sector, count, data);
+		else
+			ok = src->ReadSectors2352(sector, count, data);
+	}
+	if (!ok)
+		return false;
+
+	for (u32 n = 0; n * sectors_per_read < count; n++)
+		cdvdCacheUpdate(sector + n * sectors_per_read, data + n * sectors_per_read * sector_size);
+
+	return true;
+}
+
 bool cdvdReadBlockOfSectors(u32 sector, u8* data)
 {
 	u32 count = std::min(sectors_per_read, src->GetSectorCount() - sector);
@@ -174,10 +233,54 @@ bool cdvdUpdateDiscStatus()
 	return !ready;
 }
 
+// Blocks of the readahead that are still to read after `lsn`, up to `blocks`, clipped to the disc
+static u32 cdvdPrefetchCount(u32 lsn, u32 blocks)
+{
+	if (lsn >= src->GetSectorCount())
+		return 0;
+
+	u32 remaining = src->GetSectorCount() - lsn;
+	return std::min((remaining + sectors_per_read - 1) / sectors_per_read, blocks);
+}
+
+// Reads the uncached blocks of `lsns` (sorted block lsns), adjacent ones in one command.
+// Returns false if a read failed.
+static bool cdvdReadBlocks(const std::vector<u32>& lsns, u8* buffer)
+{
+	bool ok = true;
+
+	for (size_t i = 0; i < lsns.size();)
+	{
+		if (cdvdCacheCheck(lsns[i]))
+		{
+			i++;
+			continue;
+		}
+
+		u32 blocks = 1;
+		while (i + blocks < lsns.size() && blocks < max_blocks_per_read &&
+			   lsns[i + blocks] == lsns[i] + blocks * sectors_per_read && !cdvdCacheCheck(lsns[i + blocks]))
+			blocks++;
+
+		if (!cdvdReadBlocksOfSectors(lsns[i], blocks, buffer))
+			ok = false;
+
+		i += blocks;
+	}
+
+	return ok;
+}
+
 void cdvdThread()
 {
-	u8 buffer[2352 * sectors_per_read];
+	// A batch of blocks. The cache always copies whole 2352 byte sectors, even from
+	// 2048 byte reads, so the last block also needs that much space.
+	std::vector<u8> buffer(2352 * sectors_per_read * (max_blocks_per_read + 1));
+	std::vector<u32> requests;
+	u32 prefetch_lsn = 0;
 	u32 prefetches_left = 0;
+	u32 prefetch_blocks = min_prefetch_blocks;
+	u32 last_request_lsn = std::numeric_limits<u32>::max();
 
 	printf(" * CDVD: IO thread started...\n");
 	std::unique_lock<std::mutex> guard(s_notify_lock);
@@ -199,63 +302,72 @@ void cdvdThread()
 		if (!cdvd_is_open)
 			break;
 
-		// Read request
-		bool handling_request = false;
-		u32 request_lsn;
-
+		// Take all the pending requests, so that the drive serves them in one sweep
+		requests.clear();
 		{
 			std::lock_guard<std::mutex> request_guard(s_request_lock);
-			if (!s_request_queue.empty())
+			while (!s_request_queue.empty())
 			{
-				request_lsn = s_request_queue.front();
+				requests.push_back(s_request_queue.front());
 				s_request_queue.pop();
-				handling_request = true;
 			}
 		}
 
-		if (!handling_request)
+		const u32 hit_lsn = s_cache_hit_lsn.exchange(std::numeric_limits<u32>::max());
+
+		if (!requests.empty() || (hit_lsn != std::numeric_limits<u32>::max() && hit_lsn > last_request_lsn))
 		{
-			if (prefetches_left == 0)
-				continue;
+			std::sort(requests.begin(), requests.end());
+			requests.erase(std::unique(requests.begin(), requests.end()), requests.end());
+
+			// A request in the readahead of the previous one continues a sequential
+			// read: read further ahead. Anything else is a seek.
+			const u32 first = requests.empty() ? hit_lsn : requests.front();
+			if (last_request_lsn != std::numeric_limits<u32>::max() && first > last_request_lsn &&
+				first - last_request_lsn <= prefetch_blocks * sectors_per_read)
+				prefetch_blocks = std::min(prefetch_blocks * 2, max_prefetch_blocks);
+			else
+				prefetch_blocks = min_prefetch_blocks;
 
-			--prefetches_left;
+			const bool ok = cdvdReadBlocks(requests, buffer.data());
+
+			last_request_lsn = requests.empty() ? hit_lsn : requests.back();
+			if (!requests.empty())
+				g_last_sector_block_lsn = last_request_lsn;
 
-			u32 next_prefetch_lsn = g_last_sector_block_lsn + sectors_per_read;
-			request_lsn = next_prefetch_lsn;
+			// If the read fails, further reads are likely to fail too.
+			prefetch_lsn = last_request_lsn + sectors_per_read;
+			prefetches_left = ok ? cdvdPrefetchCount(prefetch_lsn, prefetch_blocks) : 0;
+			continue;
 		}
 
-		// Handle request
-		if (!cdvdCacheCheck(request_lsn))
+		if (prefetches_left == 0)
+			continue;
+
+		// Prefetch the next uncached blocks, a batch at a time to stay responsive to requests
+		while (prefetches_left > 0 && cdvdCacheCheck(prefetch_lsn))
 		{
-			if (cdvdReadBlockOfSectors(request_lsn, buffer))
-			{
-				cdvdCacheUpdate(request_lsn, buffer);
-			}
-			else
-			{
-				// If the read fails, further reads are likely to fail too.
-				prefetches_left = 0;
-				continue;
-			}
+			prefetch_lsn += sectors_per_read;
+			--prefetches_left;
 		}
 
-		g_last_sector_block_lsn = request_lsn;
-
-		if (!handling_request)
+		if (prefetches_left == 0)
 			continue;
 
-		// Prefetch
-		u32 next_prefetch_lsn = g_last_sector_block_lsn + sectors_per_read;
-		if (next_prefetch_lsn >= src->GetSectorCount())
+		u32 blocks = 1;
+		while (blocks < std::min(prefetches_left, max_blocks_per_read) &&
+			   !cdvdCacheCheck(prefetch_lsn + blocks * sectors_per_read))
+			blocks++;
+
+		if (!cdvdReadBlocksOfSectors(prefetch_lsn, blocks, buffer.data()))
 		{
 			prefetches_left = 0;
+			continue;
 		}
-		else
-		{
-			const u32 max_prefetches = 16;
-			u32 remaining = src->GetSectorCount() - next_prefetch_lsn;
-			prefetches_left = std::min((remaining + sectors_per_read - 1) / sectors_per_read, max_prefetches);
-		}
+
+		g_last_sector_block_lsn = prefetch_lsn + (blocks - 1) * sectors_per_read;
+		prefetch_lsn += blocks * sectors_per_read;
+		prefetches_left -= blocks;
 	}
 	printf(" * CDVD: IO thread finished.\n");
 }
@@ -277,6 +389,7 @@ bool cdvdStartThread()
 	}
 
 	cdvdCacheReset();
+	s_cache_hit_lsn = std::numeric_limits<u32>::max();
 
 	return true;
 }
@@ -298,7 +411,11 @@ void cdvdRequestSector(u32 sector, s32 mode)
 	sector &= ~(sectors_per_read - 1);
 
 	if (cdvdCacheCheck(sector))
+	{
+		s_cache_hit_lsn = sector;
+		s_notify_cv.notify_one();
 		return;
+	}
 
 	{
 		std::lock_guard<std::mutex> guard(s_request_lock);
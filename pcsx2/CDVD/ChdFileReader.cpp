@@ -17,6 +17,7 @@
 #include "ChdFileReader.h"
 
 #include "CDVD/CompressedFileReaderUtils.h"
+#include "Config.h"
 
 #include <wx/dir.h>
 
@@ -36,7 +37,6 @@ bool ChdFileReader::Open2(const wxString& fileName)
 	m_filename = fileName;
 
 	chd_file* child = NULL;
-	chd_file* parent = NULL;
 	chd_header header;
 	chd_header parent_header;
 
@@ -91,20 +91,9 @@ bool ChdFileReader::Open2(const wxString& fileName)
 		return false;
 	}
 
-	for (int d = chd_depth - 1; d >= 0; d--)
-	{
-		parent = child;
-		child = NULL;
-		error = chd_open(chds[d].c_str(), CHD_OPEN_READ, parent, &child);
-		if (error != CHDERR_NONE)
-		{
-			Console.Error(L"CDVD: chd_open return error: %s", chd_error_string(error));
-			if (parent)
-				chd_close(parent);
-			return false;
-		}
-	}
-	ChdFile = child;
+	ChdFile = OpenChain(chds, chd_depth, child);
+	if (ChdFile == NULL)
+		return false;
 	if (chd_read_header(chds[0].c_str(), &header) != CHDERR_NONE)
 	{
 		Console.Error(L"CDVD: chd_open chd_read_header error: %s: %s", chd_error_string(error), WX_STR(chds[0]));
@@ -117,9 +106,54 @@ bool ChdFileReader::Open2(const wxString& fileName)
 	// The rest of PCSX2 likes to use 2448 byte buffers, which can't fit that so trim blocks instead
 	m_internalBlockSize = header.unitbytes;
 
+	if (EmuConfig.CdvdChdCacheMB)
+		m_hunkCache = std::make_unique<ChunksCache>(EmuConfig.CdvdChdCacheMB, hunk_size);
+
+	// Each worker decompresses from its own chain of handles
+	const u32 workers = StartWorkers();
+	for (u32 i = 0; i < workers; i++)
+	{
+		chd_file* file = OpenChain(chds, chd_depth, NULL);
+		if (file == NULL)
+			return false;
+		m_workerFiles.push_back(file);
+	}
+
 	return true;
 }
 
+// Opens the files of chds from the parent at depth (already open when deepest isn't null)
+// up to chds[0], and returns the handle of chds[0].
+chd_file* ChdFileReader::OpenChain(const wxString* chds, int depth, chd_file* deepest)
+{
+	chd_file* child = deepest;
+	chd_error error;
+	if (child == NULL)
+	{
+		error = chd_open(chds[depth].c_str(), CHD_OPEN_READ, NULL, &child);
+		if (error != CHDERR_NONE)
+		{
+			Console.Error(L"CDVD: chd_open return error: %s", chd_error_string(error));
+			return NULL;
+		}
+	}
+
+	for (int d = depth - 1; d >= 0; d--)
+	{
+		chd_file* parent = child;
+		child = NULL;
+		error = chd_open(chds[d].c_str(), CHD_OPEN_READ, parent, &child);
+		if (error != CHDERR_NONE)
+		{
+			Console.Error(L"CDVD: chd_open return error: %s", chd_error_string(error));
+			if (parent)
+				chd_close(parent);
+			return NULL;
+		}
+	}
+	return child;
+}
+
 ThreadedFileReader::Chunk ChdFileReader::ChunkForOffset(u64 offset)
 {
 	Chunk chunk = {0};
@@ -141,18 +175,65 @@ int ChdFileReader::ReadChunk(void *dst, s64 chunkID)
 	if (chunkID < 0)
 		return -1;
 
-	chd_error error = chd_read(ChdFile, chunkID, dst);
-	if (error != CHDERR_NONE)
+	return ReadChunks(dst, chunkID, 1);
+}
+
+// Hunks found in the cache are copied, the others are decompressed by the workers, then cached.
+int ChdFileReader::ReadChunks(void* dst, s64 chunkID, u32 count)
+{
+	if (chunkID < 0)
+		return -1;
+
+	m_missing.clear();
+	for (u32 i = 0; i < count; i++)
+	{
+		u8* hunk = static_cast<u8*>(dst) + (size_t)i * hunk_size;
+		if (!m_hunkCache || m_hunkCache->Read(hunk, (chunkID + i) * hunk_size, hunk_size) != static_cast<int>(hunk_size))
+			m_missing.push_back(i);
+	}
+
+	m_missingResults.assign(m_missing.size(), 0);
+	RunWorkers(m_missing.size(), [&](u32 worker, u32 index) {
+		const u32 i = m_missing[index];
+		chd_file* file = worker ? m_workerFiles[worker - 1] : ChdFile;
+		chd_error error = chd_read(file, chunkID + i, static_cast<u8*>(dst) + (size_t)i * hunk_size);
+		if (error != CHDERR_NONE)
+		{
+			Console.Error(L"CDVD: chd_read returned error: %s", chd_error_string(error));
+			return;
+		}
+		m_missingResults[index] = hunk_size;
+	});
+
+	// Up to the first hunk that failed
+	u32 good = count;
+	for (size_t index = 0; index < m_missing.size(); index++)
 	{
-		Console.Error(L"CDVD: chd_read returned error: %s", chd_error_string(error));
-		return 0;
+		if (m_missingResults[index] == 0)
+		{
+			good = m_missing[index];
+			break;
+		}
+		if (m_hunkCache)
+		{
+			const u32 i = m_missing[index];
+			void* copy = malloc(hunk_size);
+			memcpy(copy, static_cast<u8*>(dst) + (size_t)i * hunk_size, hunk_size);
+			m_hunkCache->Take(copy, (chunkID + i) * hunk_size, hunk_size, hunk_size);
+		}
 	}
 
-	return hunk_size;
+	return good * hunk_size;
 }
 
 void ChdFileReader::Close2()
 {
+	StopWorkers();
+	for (chd_file* file : m_workerFiles)
+		chd_close(file);
+	m_workerFiles.clear();
+	m_hunkCache.reset();
+
 	if (ChdFile != NULL)
 	{
 		chd_close(ChdFile);
@@ -15,8 +15,12 @@
 
 #pragma once
 #include "ThreadedFileReader.h"
+#include "ChunksCache.h"
 #include "libchdr/chd.h"
 
+#include <memory>
+#include <vector>
+
 class ChdFileReader : public ThreadedFileReader
 {
 	DeclareNoncopyableObject(ChdFileReader);
@@ -29,13 +33,24 @@ public:
 
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void *dst, s64 blockID) override;
+	int ReadChunks(void* dst, s64 chunkID, u32 count) override;
 
 	void Close2(void) override;
 	uint GetBlockCount(void) const override;
 	ChdFileReader(void);
 
 private:
+	static chd_file* OpenChain(const wxString* chds, int depth, chd_file* deepest);
+
 	chd_file* ChdFile;
 	u64 file_size;
 	u32 hunk_size;
+
+	// Handles of the workers of ReadChunks (worker 0 uses ChdFile), libchdr handles
+	// can't decompress from several threads
+	std::vector<chd_file*> m_workerFiles;
+	// Decompressed hunks, only touched by the read thread
+	std::unique_ptr<ChunksCache> m_hunkCache;
+	std::vector<u32> m_missing;
+	std::vector<int> m_missingResults;
 };
@@ -15,6 +15,7 @@
 
 #include "PrecompiledHeader.h"
 #include "ChunksCache.h"
+#include "DebugTools/Debug.h"
 
 void ChunksCache::SetLimit(uint megabytes)
 {
@@ -22,21 +23,70 @@ void ChunksCache::SetLimit(uint megabytes)
 	MatchLimit();
 }
 
+void ChunksCache::Clear()
+{
+	if (m_hits || m_misses)
+		CDVD_LOG("Chunks cache: %llu hits, %llu misses, %llu evictions",
+			(unsigned long long)m_hits, (unsigned long long)m_misses, (unsigned long long)m_evictions);
+
+	MatchLimit(true);
+	m_hits = m_misses = m_evictions = 0;
+}
+
+// Inserts as the most recently used entry
+void ChunksCache::Link(CacheEntry* e)
+{
+	e->newer = nullptr;
+	e->older = m_mru;
+	if (m_mru)
+		m_mru->newer = e;
+	else
+		m_lru = e;
+	m_mru = e;
+}
+
+void ChunksCache::Unlink(CacheEntry* e)
+{
+	if (e->newer)
+		e->newer->older = e->older;
+	else
+		m_mru = e->older;
+
+	if (e->older)
+		e->older->newer = e->newer;
+	else
+		m_lru = e->newer;
+}
+
+void ChunksCache::Remove(CacheEntry* e)
+{
+	Unlink(e);
+	m_entries.erase(e->offset / m_chunkSize);
+	m_size -= e->size;
+	delete e;
+}
+
 void ChunksCache::MatchLimit(bool removeAll)
 {
-	std::list<CacheEntry*>::reverse_iterator rit;
-	while (!m_entries.empty() && (removeAll || m_size > m_limit))
+	while (m_lru && (removeAll || m_size > m_limit))
 	{
-		rit = m_entries.rbegin();
-		m_size -= (*rit)->size;
-		delete (*rit);
-		m_entries.pop_back();
+		if (!removeAll)
+			m_evictions++;
+		Remove(m_lru);
 	}
 }
 
 void ChunksCache::Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage)
 {
-	m_entries.push_front(new CacheEntry(pMallocedSrc, offset, length, coverage));
+	pxAssert(offset % m_chunkSize == 0 && coverage <= (int)m_chunkSize);
+
+	auto it = m_entries.find(offset / m_chunkSize);
+	if (it != m_entries.end())
+		Remove(it->second);
+
+	CacheEntry* e = new CacheEntry(pMallocedSrc, offset, length, coverage);
+	m_entries.emplace(offset / m_chunkSize, e);
+	Link(e);
 	m_size += length;
 	MatchLimit();
 }
@@ -44,15 +94,22 @@ void ChunksCache::Take(void* pMallocedSrc, PX_off_t offset, int length, int cove
 // By design, succeed only if the entire request is in a single cached chunk
 int ChunksCache::Read(void* pDest, PX_off_t offset, int length)
 {
-	for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+	auto it = m_entries.find(offset / m_chunkSize);
+	if (it != m_entries.end())
 	{
-		CacheEntry* e = *it;
-		if (e && offset >= e->offset && (offset + length) <= (e->offset + e->coverage))
+		CacheEntry* e = it->second;
+		if ((offset + length) <= (e->offset + e->coverage))
 		{
-			if (it != m_entries.begin())
-				m_entries.splice(m_entries.begin(), m_entries, it); // Move to top (MRU)
+			if (e != m_mru)
+			{
+				// Move to top (MRU)
+				Unlink(e);
+				Link(e);
+			}
+			m_hits++;
 			return CopyAvailable(e->data, e->offset, e->size, pDest, offset, length);
 		}
 	}
+	m_misses++;
 	return -1;
 }
@@ -17,18 +17,27 @@
 
 #include "zlib_indexed.h"
 
+#include <unordered_map>
+
 #define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
 
+// Cache of extracted chunks, in LRU order. The chunks start at multiples of chunkSize and
+// don't cross the next multiple, they're found by their index in a hash map.
 class ChunksCache
 {
 public:
-	ChunksCache(uint initialLimitMb)
-		: m_entries(0)
+	ChunksCache(uint initialLimitMb, uint chunkSize)
+		: m_chunkSize(chunkSize)
+		, m_mru(nullptr)
+		, m_lru(nullptr)
 		, m_size(0)
-		, m_limit(initialLimitMb * 1024 * 1024){};
+		, m_limit(initialLimitMb * 1024 * 1024)
+		, m_hits(0)
+		, m_misses(0)
+		, m_evictions(0){};
 	~ChunksCache() { Clear(); };
 	void SetLimit(uint megabytes);
-	void Clear() { MatchLimit(true); };
+	void Clear();
 
 	void Take(void* pMallocedSrc, PX_off_t offset, int length, int coverage);
 	int Read(void* pDest, PX_off_t offset, int length);
@@ -49,7 +58,9 @@ private:
 			: data(pMallocedSrc)
 			, offset(offset)
 			, coverage(coverage)
-			, size(length){};
+			, size(length)
+			, newer(nullptr)
+			, older(nullptr){};
 
 		~CacheEntry()
 		{
@@ -61,12 +72,27 @@ private:
 		PX_off_t offset;
 		int coverage;
 		int size;
+
+		// LRU list links
+		CacheEntry* newer;
+		CacheEntry* older;
 	};
 
-	std::list<CacheEntry*> m_entries;
+	void Link(CacheEntry* e);
+	void Unlink(CacheEntry* e);
+	void Remove(CacheEntry* e);
 	void MatchLimit(bool removeAll = false);
+
+	uint m_chunkSize;
+	std::unordered_map<PX_off_t, CacheEntry*> m_entries; // by chunk index
+	CacheEntry* m_mru;
+	CacheEntry* m_lru;
 	PX_off_t m_size;
 	PX_off_t m_limit;
+
+	u64 m_hits;
+	u64 m_misses;
+	u64 m_evictions;
 };
 
 #undef CLAMP
@@ -19,6 +19,9 @@
 #include "ChdFileReader.h"
 #include "CsoFileReader.h"
 #include "GzippedFileReader.h"
+#ifdef PCSX2_ZSTD
+#include "ZstdFileReader.h"
+#endif
 
 // CompressedFileReader factory.
 AsyncFileReader* CompressedFileReader::GetNewReader(const wxString& fileName)
@@ -35,6 +38,12 @@ AsyncFileReader* CompressedFileReader::GetNewReader(const wxString& fileName)
 	{
 		return new CsoFileReader();
 	}
+#ifdef PCSX2_ZSTD
+	if (ZstdFileReader::CanHandle(fileName))
+	{
+		return new ZstdFileReader();
+	}
+#endif
 	// This is the one which will fail on open.
 	return NULL;
 }
@@ -24,8 +24,11 @@
 #include <zlib/zlib.h>
 #endif
 
-// Implementation of CSO compressed ISO reading, based on:
+#include <algorithm>
+
+// Implementation of CSO and ZSO compressed ISO reading, based on:
 // https://github.com/unknownbrackets/maxcso/blob/master/README_CSO.md
+// https://github.com/unknownbrackets/maxcso/blob/master/README_ZSO.md
 struct CsoHeader
 {
 	u8 magic[4];
@@ -39,10 +42,83 @@ struct CsoHeader
 
 static const u32 CSO_READ_BUFFER_SIZE = 256 * 1024;
 
+// Decodes a raw LZ4 block (the ZSO frames have no LZ4 frame header).
+// The block ends when the output is full, the input may have alignment padding after it.
+// Returns the bytes decoded, or -1 if the block is invalid.
+static int LZ4DecompressBlock(const u8* src, u32 srcSize, u8* dst, u32 dstSize)
+{
+	const u8* ip = src;
+	const u8* const iend = src + srcSize;
+	u8* op = dst;
+	u8* const oend = dst + dstSize;
+
+	auto readLength = [&](u32& length) {
+		if (length != 15)
+			return true;
+		u8 b;
+		do
+		{
+			if (ip >= iend)
+				return false;
+			b = *ip++;
+			length += b;
+		} while (b == 255);
+		return true;
+	};
+
+	while (op < oend)
+	{
+		if (ip >= iend)
+			return -1;
+		const u8 token = *ip++;
+
+		// Literals
+		u32 length = token >> 4;
+		if (!readLength(length) || length > (u32)(iend - ip) || length > (u32)(oend - op))
+			return -1;
+		memcpy(op, ip, length);
+		op += length;
+		ip += length;
+
+		if (op == oend)
+			break;
+
+		// Match
+		if (iend - ip < 2)
+			return -1;
+		const u32 offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (u32)(op - dst))
+			return -1;
+
+		length = token & 15;
+		if (!readLength(length))
+			return -1;
+		length += 4;
+		if (length > (u32)(oend - op))
+			return -1;
+
+		const u8* match = op - offset;
+		if (offset >= length)
+		{
+			memcpy(op, match, length);
+			op += length;
+		}
+		else
+		{
+			// Overlapping copy, repeats the last `offset` bytes
+			while (length--)
+				*op++ = *match++;
+		}
+	}
+
+	return op - dst;
+}
+
 bool CsoFileReader::CanHandle(const wxString& fileName)
 {
 	bool supported = false;
-	if (wxFileName::FileExists(fileName) && fileName.Lower().EndsWith(L".cso"))
+	if (wxFileName::FileExists(fileName) && (fileName.Lower().EndsWith(L".cso") || fileName.Lower().EndsWith(L".zso")))
 	{
 		FILE* fp = PX_fopen_rb(fileName);
 		CsoHeader hdr;
@@ -60,14 +136,14 @@ bool CsoFileReader::CanHandle(const wxString& fileName)
 
 bool CsoFileReader::ValidateHeader(const CsoHeader& hdr)
 {
-	if (hdr.magic[0] != 'C' || hdr.magic[1] != 'I' || hdr.magic[2] != 'S' || hdr.magic[3] != 'O')
+	if ((hdr.magic[0] != 'C' && hdr.magic[0] != 'Z') || hdr.magic[1] != 'I' || hdr.magic[2] != 'S' || hdr.magic[3] != 'O')
 	{
 		// Invalid magic, definitely a bad file.
 		return false;
 	}
 	if (hdr.ver > 1)
 	{
-		Console.Error(L"Only CSOv1 files are supported.");
+		Console.Error(L"Only CSOv1 and ZSOv1 files are supported.");
 		return false;
 	}
 	if ((hdr.frame_size & (hdr.frame_size - 1)) != 0)
@@ -133,6 +209,7 @@ bool CsoFileReader::ReadFileHeader()
 	// This is the index alignment (index values need shifting by this amount.)
 	m_indexShift = hdr.align;
 	m_totalSize = hdr.total_bytes;
+	m_lz4 = hdr.magic[0] == 'Z';
 
 	return true;
 }
@@ -160,14 +237,38 @@ bool CsoFileReader::InitializeBuffers()
 		return false;
 	}
 
-	m_z_stream = new z_stream;
-	m_z_stream->zalloc = Z_NULL;
-	m_z_stream->zfree = Z_NULL;
-	m_z_stream->opaque = Z_NULL;
-	if (inflateInit2(m_z_stream, -15) != Z_OK)
+	if (!m_lz4)
 	{
-		Console.Error("Unable to initialize zlib for CSO decompression.");
-		return false;
+		m_z_stream = new z_stream;
+		m_z_stream->zalloc = Z_NULL;
+		m_z_stream->zfree = Z_NULL;
+		m_z_stream->opaque = Z_NULL;
+		if (inflateInit2(m_z_stream, -15) != Z_OK)
+		{
+			delete m_z_stream;
+			m_z_stream = NULL;
+			Console.Error("Unable to initialize zlib for CSO decompression.");
+			return false;
+		}
+	}
+
+	const u32 workers = StartWorkers();
+	if (!m_lz4)
+	{
+		for (u32 i = 0; i < workers; i++)
+		{
+			z_stream* z = new z_stream;
+			z->zalloc = Z_NULL;
+			z->zfree = Z_NULL;
+			z->opaque = Z_NULL;
+			if (inflateInit2(z, -15) != Z_OK)
+			{
+				delete z;
+				Console.Error("Unable to initialize zlib for CSO decompression.");
+				return false;
+			}
+			m_worker_z_streams.push_back(z);
+		}
 	}
 
 	return true;
@@ -175,6 +276,8 @@ bool CsoFileReader::InitializeBuffers()
 
 void CsoFileReader::Close2()
 {
+	StopWorkers();
+
 	m_filename.Empty();
 
 	if (m_src)
@@ -185,8 +288,15 @@ void CsoFileReader::Close2()
 	if (m_z_stream)
 	{
 		inflateEnd(m_z_stream);
+		delete m_z_stream;
 		m_z_stream = NULL;
 	}
+	for (z_stream* z : m_worker_z_streams)
+	{
+		inflateEnd(z);
+		delete z;
+	}
+	m_worker_z_streams.clear();
 
 	if (m_readBuffer)
 	{
@@ -253,18 +363,89 @@ int CsoFileReader::ReadChunk(void *dst, s64 chunkID)
 		// This is because the index positions must be aligned.
 		const u32 readRawBytes = fread(m_readBuffer, 1, frameRawSize, m_src);
 
-		m_z_stream->next_in = m_readBuffer;
-		m_z_stream->avail_in = readRawBytes;
-		m_z_stream->next_out = static_cast<Bytef*>(dst);
-		m_z_stream->avail_out = m_frameSize;
+		return DecompressFrame(m_z_stream, dst, frame, m_readBuffer, readRawBytes);
+	}
+}
+
+int CsoFileReader::DecompressFrame(z_stream* z, void* dst, u32 frame, const u8* src, u32 srcSize)
+{
+	if (m_index[frame] & 0x80000000)
+	{
+		// Not compressed
+		const u32 size = std::min(srcSize, m_frameSize);
+		memcpy(dst, src, size);
+		return size;
+	}
 
-		int status = inflate(m_z_stream, Z_FINISH);
-		bool success = status == Z_STREAM_END && m_z_stream->total_out == m_frameSize;
+	if (m_lz4)
+	{
+		if (LZ4DecompressBlock(src, srcSize, static_cast<u8*>(dst), m_frameSize) != static_cast<int>(m_frameSize))
+		{
+			Console.Error("Unable to decompress ZSO frame using lz4.");
+			return 0;
+		}
+		return m_frameSize;
+	}
 
-		if (!success)
-			Console.Error("Unable to decompress CSO frame using zlib.");
-		inflateReset(m_z_stream);
+	z->next_in = const_cast<Bytef*>(src);
+	z->avail_in = srcSize;
+	z->next_out = static_cast<Bytef*>(dst);
+	z->avail_out = m_frameSize;
 
-		return success ? m_frameSize : 0;
+	int status = inflate(z, Z_FINISH);
+	bool success = status == Z_STREAM_END && z->total_out == m_frameSize;
+
+	if (!success)
+		Console.Error("Unable to decompress CSO frame using zlib.");
+	inflateReset(z);
+
+	return success ? m_frameSize : 0;
+}
+
+// The raw data of consecutive frames is contiguous in the file: ReadChunks reads it at
+// once, then each frame is decompressed by one of the workers to its place in `dst`.
+int CsoFileReader::ReadChunks(void* dst, s64 chunkID, u32 count)
+{
+	if (WorkerCount() == 0 || count < 2 || chunkID < 0)
+		return ThreadedFileReader::ReadChunks(dst, chunkID, count);
+
+	const u32 first = chunkID;
+	const u64 rawPos = (u64)(m_index[first] & 0x7FFFFFFF) << m_indexShift;
+	const u64 rawEnd = (u64)(m_index[first + count] & 0x7FFFFFFF) << m_indexShift;
+
+	// An uncompressed last frame may read past its index (see ReadChunk)
+	m_batchRaw.resize(rawEnd - rawPos + m_frameSize);
+	if (PX_fseeko(m_src, rawPos, SEEK_SET) != 0)
+	{
+		Console.Error("Unable to seek to CSO data.");
+		return 0;
+	}
+	m_batchRaw.resize(fread(m_batchRaw.data(), 1, m_batchRaw.size(), m_src));
+	m_batchResults.assign(count, 0);
+
+	const u32 rawSize = m_batchRaw.size();
+	RunWorkers(count, [&](u32 worker, u32 i) {
+		const u32 frame = first + i;
+		const u64 pos = ((u64)(m_index[frame + 0] & 0x7FFFFFFF) << m_indexShift) - rawPos;
+		const u64 end = ((u64)(m_index[frame + 1] & 0x7FFFFFFF) << m_indexShift) - rawPos;
+
+		// Uncompressed frames take the frame size, whatever their index says (see ReadChunk)
+		u32 srcSize = pos < rawSize ? rawSize - pos : 0;
+		if (!(m_index[frame] & 0x80000000))
+			srcSize = std::min<u64>(srcSize, end - pos);
+
+		z_stream* z = worker ? m_worker_z_streams[worker - 1] : m_z_stream;
+		m_batchResults[i] = DecompressFrame(z, static_cast<u8*>(dst) + (size_t)i * m_frameSize, frame,
+			m_batchRaw.data() + std::min<u64>(pos, rawSize), srcSize);
+	});
+
+	// Up to the first frame that failed
+	int total = 0;
+	for (int size : m_batchResults)
+	{
+		total += size;
+		if (size != static_cast<int>(m_frameSize))
+			break;
 	}
+	return total;
 }
@@ -27,6 +27,8 @@
 #include "ThreadedFileReader.h"
 #include "ChunksCache.h"
 
+#include <vector>
+
 struct CsoHeader;
 typedef struct z_stream_s z_stream;
 
@@ -46,6 +48,7 @@ public:
 		, m_totalSize(0)
 		, m_src(0)
 		, m_z_stream(0)
+		, m_lz4(false)
 	{
 		m_blocksize = 2048;
 	};
@@ -57,6 +60,7 @@ public:
 
 	Chunk ChunkForOffset(u64 offset) override;
 	int ReadChunk(void *dst, s64 chunkID) override;
+	int ReadChunks(void* dst, s64 chunkID, u32 count) override;
 
 	void Close2(void) override;
 
@@ -69,9 +73,9 @@ private:
 	static bool ValidateHeader(const CsoHeader& hdr);
 	bool ReadFileHeader();
 	bool InitializeBuffers();
-	int ReadFromFrame(u8* dest, u64 pos, int maxBytes);
-	bool DecompressFrame(Bytef* dst, u32 frame, u32 readBufferSize);
-	bool DecompressFrame(u32 frame, u32 readBufferSize);
+	// Decompresses the frame from its raw data, returns the frame size or 0 on failure
+	int DecompressFrame(z_stream* z, void* dst, u32 frame, const u8* src, u32 srcSize);
+
 
 	u32 m_frameSize;
 	u8 m_frameShift;
@@ -82,4 +86,12 @@ private:
 	// The actual source cso file handle.
 	FILE* m_src;
 	z_stream* m_z_stream;
+	// ZSO: the frames are LZ4 blocks instead of deflate streams
+	bool m_lz4;
+
+	// The zlib streams of the workers of ReadChunks (worker 0 uses m_z_stream)
+	std::vector<z_stream*> m_worker_z_streams;
+	// Raw data and results of the frames of a ReadChunks call
+	std::vector<u8> m_batchRaw;
+	std::vector<int> m_batchResults;
 };
@@ -22,6 +22,9 @@
 #include "GzippedFileReader.h"
 #include "zlib_indexed.h"
 
+#include <algorithm>
+#include <chrono>
+
 #define CLAMP(val, minval, maxval) (std::min(maxval, std::max(minval, val)))
 
 static s64 fsize(const wxString& filename)
@@ -188,12 +191,79 @@ static wxString iso2indexname(const wxString& isoname)
 	return ApplyTemplate(L"gzip index", appRoot, g_Conf->GzipIsoIndexTemplate, isoname, false);
 }
 
+// The uncompressed size is only known once the whole file is scanned. Until then, the gzip
+// trailer has it modulo 4 GB: take the first candidate past the volume size of the ISO9660
+// descriptor at sector 16 (which dual layer images exceed by less than 4 GB), or past the
+// compressed size when there's no descriptor.
+static PX_off_t EstimateUncompressedSize(FILE* in)
+{
+	PX_fseeko(in, 0, SEEK_END);
+	const PX_off_t compressed = PX_ftello(in);
+
+	unsigned char trailer[4] = {0};
+	PX_fseeko(in, -4, SEEK_END);
+	if (fread(trailer, 1, 4, in) != 4)
+		return 0;
+	const PX_off_t modSize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((PX_off_t)trailer[3] << 24);
+
+	// Sector 16 of 2048 byte images, and of 2352 byte mode 1 and mode 2 images
+	static const int sectorSizes[] = {2048, 2352, 2352};
+	static const int dataOffsets[] = {0, 16, 24};
+	std::vector<unsigned char> head(16 * 2352 + 24 + 2048);
+	std::vector<unsigned char> input(CHUNK);
+
+	z_stream strm = {};
+	if (inflateInit2(&strm, 47) != Z_OK)
+		return 0;
+	PX_fseeko(in, 0, SEEK_SET);
+	strm.next_out = head.data();
+	strm.avail_out = head.size();
+	int ret = Z_OK;
+	while (strm.avail_out != 0 && ret == Z_OK)
+	{
+		if (strm.avail_in == 0)
+		{
+			strm.avail_in = fread(input.data(), 1, input.size(), in);
+			strm.next_in = input.data();
+			if (strm.avail_in == 0)
+				break;
+		}
+		ret = inflate(&strm, Z_NO_FLUSH);
+	}
+	const int got = head.size() - strm.avail_out;
+	inflateEnd(&strm);
+
+	PX_off_t lower = compressed - compressed / 8192 - 1024; // deflate doesn't expand data more
+	for (int i = 0; i < 3; i++)
+	{
+		const int pvd = 16 * sectorSizes[i] + dataOffsets[i];
+		if (pvd + 84 <= got && memcmp(&head[pvd], "\1CD001", 6) == 0)
+		{
+			const u32 volumeSize = head[pvd + 80] | (head[pvd + 81] << 8) | (head[pvd + 82] << 16) | ((u32)head[pvd + 83] << 24);
+			lower = (PX_off_t)volumeSize * sectorSizes[i] - 1024 * 1024;
+			break;
+		}
+	}
+
+	PX_off_t size = modSize;
+	while (size < lower)
+		size += 0x100000000LL;
+	return size;
+}
+
 GzippedFileReader::GzippedFileReader(void)
 	: mBytesRead(0)
 	, m_pIndex(0)
 	, m_zstates(0)
+	, m_zstatesCount(0)
+	, m_span(GZFILE_SPAN_DEFAULT)
 	, m_src(0)
-	, m_cache(GZFILE_CACHE_SIZE_MB)
+	, m_builtIndex(0)
+	, m_indexResult(0)
+	, m_indexDone(false)
+	, m_indexQuit(false)
+	, m_sizeEstimate(0)
+	, m_cache(GZFILE_CACHE_SIZE_MB, GZFILE_READ_CHUNK_SIZE)
 {
 	m_blocksize = 2048;
 	AsyncPrefetchReset();
@@ -205,13 +275,15 @@ void GzippedFileReader::InitZstates()
 	{
 		delete[] m_zstates;
 		m_zstates = 0;
+		m_zstatesCount = 0;
 	}
-	if (!m_pIndex)
+	if (!m_pIndex && !m_indexThread.joinable())
 		return;
 
 	// having another extra element helps avoiding logic for last (so 2+ instead of 1+)
-	int size = 2 + m_pIndex->uncompressed_size / m_pIndex->span;
-	m_zstates = new Czstate[size]();
+	PX_off_t size = m_pIndex ? m_pIndex->uncompressed_size : m_sizeEstimate;
+	m_zstatesCount = 2 + size / m_span;
+	m_zstates = new Czstate[m_zstatesCount]();
 }
 
 #ifndef _WIN32
@@ -303,7 +375,7 @@ bool GzippedFileReader::CanHandle(const wxString& fileName)
 
 bool GzippedFileReader::OkIndex()
 {
-	if (m_pIndex)
+	if (m_pIndex || m_indexThread.joinable())
 		return true;
 
 	// Try to read index from disk
@@ -321,36 +393,128 @@ bool GzippedFileReader::OkIndex()
 			Console.Warning(L"It will work fine, but if you want to generate a new index with default intervals, delete this index file.");
 			Console.Warning(L"(smaller intervals mean bigger index file and quicker but more frequent decompressions)");
 		}
+		m_span = m_pIndex->span;
 		InitZstates();
 		return true;
 	}
 
-	// No valid index file. Generate an index
-	Console.Warning(L"This may take a while (but only once). Scanning compressed file to generate a quick access index...");
+	// No valid index file. Generate one in the background, reads use it while it's built
+	Console.WriteLn(L"Scanning compressed file to generate a quick access index in the background...");
 
-	Access* index;
-	FILE* infile = PX_fopen_rb(m_filename);
-	int len = build_index(infile, GZFILE_SPAN_DEFAULT, &index);
-	printf("\n"); // build_index prints progress without \n's
-	fclose(infile);
+	m_span = GZFILE_SPAN_DEFAULT;
+	m_sizeEstimate = EstimateUncompressedSize(m_src);
+	m_indexThread = std::thread(&GzippedFileReader::BuildIndex, this, m_filename, indexfile);
+	InitZstates();
+	return true;
+}
 
-	if (len >= 0)
+void GzippedFileReader::BuildIndex(wxString fileName, wxString indexfile)
+{
+	Access* index = 0;
+	FILE* infile = PX_fopen_rb(fileName);
+	int len = infile ? build_index(infile, GZFILE_SPAN_DEFAULT, &index, OnIndexProgress, this) : Z_ERRNO;
+	if (infile)
+		fclose(infile);
+
+	if (len > 0)
+		WriteIndexToFile(index, indexfile);
+	else if (len != BUILD_INDEX_ABORTED)
+		Console.Error(L"ERROR (%d): index could not be generated for file '%s'", len, WX_STR(fileName));
+
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	m_builtIndex = len > 0 ? index : 0;
+	m_indexResult = len;
+	m_indexDone = true;
+}
+
+// Publishes each access point as it's added, and stops the build when the file is closed
+int GzippedFileReader::OnIndexProgress(void* opaque, Access* index, int added, PX_off_t totout)
+{
+	GzippedFileReader* reader = (GzippedFileReader*)opaque;
+	if (added)
 	{
-		m_pIndex = index;
-		WriteIndexToFile((Access*)m_pIndex, indexfile);
+		Point* point = (Point*)malloc(sizeof(Point));
+		memcpy(point, &index->list[index->have - 1], sizeof(Point));
+
+		std::lock_guard<std::mutex> lock(reader->m_indexMutex);
+		reader->m_indexPoints.push_back(point);
 	}
-	else
-	{
-		Console.Error(L"ERROR (%d): index could not be generated for file '%s'", len, WX_STR(m_filename));
-		free_index(index);
-		InitZstates();
+	return reader->m_indexQuit.load(std::memory_order_relaxed);
+}
+
+// Takes over the index once the background build is done. Returns whether reads can go on.
+bool GzippedFileReader::UpdateIndex()
+{
+	if (m_pIndex)
+		return true;
+	if (!m_indexThread.joinable())
 		return false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_indexMutex);
+		if (!m_indexDone)
+			return true;
 	}
 
-	InitZstates();
+	m_indexThread.join();
+	for (Point* point : m_indexPoints)
+		free(point);
+	m_indexPoints.clear();
+
+	if (m_indexResult <= 0)
+		return false;
+
+	m_pIndex = m_builtIndex;
+	m_builtIndex = 0;
+	if (m_pIndex->uncompressed_size != m_sizeEstimate)
+		Console.Warning(L"Warning: The size of the gzip image was misestimated, please reopen it: '%s'", WX_STR(m_filename));
+	if (2 + m_pIndex->uncompressed_size / m_span > m_zstatesCount)
+		InitZstates();
 	return true;
 }
 
+// The published access point at or before offset, as an index for extract()
+Access* GzippedFileReader::PartialIndexFor(PX_off_t offset)
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	if (m_indexPoints.empty())
+		return 0;
+
+	auto it = std::upper_bound(m_indexPoints.begin(), m_indexPoints.end(), offset,
+		[](PX_off_t out, const Point* point) { return out < point->out; });
+	if (it != m_indexPoints.begin())
+		--it;
+	memcpy(&m_partialPoint, *it, sizeof(Point));
+
+	m_partialIndex.have = 1;
+	m_partialIndex.size = 1;
+	m_partialIndex.list = &m_partialPoint;
+	m_partialIndex.span = m_span;
+	m_partialIndex.uncompressed_size = m_sizeEstimate;
+	return &m_partialIndex;
+}
+
+void GzippedFileReader::StopIndexBuild()
+{
+	if (m_indexThread.joinable())
+	{
+		m_indexQuit = true;
+		m_indexThread.join();
+	}
+	m_indexQuit = false;
+
+	for (Point* point : m_indexPoints)
+		free(point);
+	m_indexPoints.clear();
+	if (m_builtIndex)
+	{
+		free_index(m_builtIndex);
+		m_builtIndex = 0;
+	}
+	m_indexDone = false;
+	m_indexResult = 0;
+}
+
 bool GzippedFileReader::Open(const wxString& fileName)
 {
 	Close();
@@ -395,7 +559,7 @@ int GzippedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 // If we have a valid and adequate zstate for this span, use it, else, use the index
 PX_off_t GzippedFileReader::GetOptimalExtractionStart(PX_off_t offset)
 {
-	int span = m_pIndex->span;
+	int span = m_span;
 	Czstate& cstate = m_zstates[offset / span];
 	PX_off_t stateOffset = cstate.state.isValid ? cstate.state.out_offset : 0;
 	if (stateOffset && stateOffset <= offset)
@@ -411,7 +575,7 @@ PX_off_t GzippedFileReader::GetOptimalExtractionStart(PX_off_t offset)
 
 int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRead)
 {
-	if (!OkIndex())
+	if (!UpdateIndex())
 		return -1;
 
 	// Without all the caching, chunking and states, this would be enough:
@@ -443,12 +607,24 @@ int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRea
 	PTT s = NOW();
 	PX_off_t extractOffset = GetOptimalExtractionStart(offset); // guaranteed in GZFILE_READ_CHUNK_SIZE boundaries
 	int size = offset + maxInChunk - extractOffset;
+
+	// While the index is built, start from the closest access point it has so far. The first
+	// one comes right after the gzip header.
+	Access* index = m_pIndex ? m_pIndex : PartialIndexFor(extractOffset);
+	while (!index)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (!UpdateIndex())
+			return -1;
+		index = m_pIndex ? m_pIndex : PartialIndexFor(extractOffset);
+	}
+
 	unsigned char* extracted = (unsigned char*)malloc(size);
 
-	int span = m_pIndex->span;
+	int span = m_span;
 	int spanix = extractOffset / span;
 	AsyncPrefetchCancel();
-	res = extract(m_src, m_pIndex, extractOffset, extracted, size, &(m_zstates[spanix].state));
+	res = extract(m_src, index, extractOffset, extracted, size, &(m_zstates[spanix].state));
 	if (res < 0)
 	{
 		free(extracted);
@@ -501,6 +677,7 @@ int GzippedFileReader::_ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRea
 
 void GzippedFileReader::Close()
 {
+	StopIndexBuild();
 	m_filename.Empty();
 	if (m_pIndex)
 	{
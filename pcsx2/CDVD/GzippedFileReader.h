@@ -21,6 +21,11 @@ typedef struct zstate Zstate;
 #include "ChunksCache.h"
 #include "zlib_indexed.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #define GZFILE_SPAN_DEFAULT (1048576L * 4)  /* distance between direct access points when creating a new index */
 #define GZFILE_READ_CHUNK_SIZE (256 * 1024) /* zlib extraction chunks size (at 0-based boundaries) */
 #define GZFILE_CACHE_SIZE_MB 200            /* cache size for extracted data. must be at least GZFILE_READ_CHUNK_SIZE (in MB)*/
@@ -49,7 +54,7 @@ public:
 	{
 		// type and formula copied from FlatFileReader
 		// FIXME? : Shouldn't it be uint and (size - m_dataoffset) / m_blocksize ?
-		return (int)((m_pIndex ? m_pIndex->uncompressed_size : 0) / m_blocksize);
+		return (int)((m_pIndex ? m_pIndex->uncompressed_size : m_sizeEstimate) / m_blocksize);
 	};
 
 	virtual void SetBlockSize(uint bytes) { m_blocksize = bytes; }
@@ -75,11 +80,33 @@ private:
 	int _ReadSync(void* pBuffer, PX_off_t offset, uint bytesToRead);
 	void InitZstates();
 
+	// Background index build
+	void BuildIndex(wxString fileName, wxString indexfile);
+	static int OnIndexProgress(void* opaque, Access* index, int added, PX_off_t totout);
+	bool UpdateIndex();
+	Access* PartialIndexFor(PX_off_t offset);
+	void StopIndexBuild();
+
 	int mBytesRead;   // Temp sync read result when simulating async read
 	Access* m_pIndex; // Quick access index
 	Czstate* m_zstates;
+	int m_zstatesCount;
+	s32 m_span;
 	FILE* m_src;
 
+	// While the index is built, reads start from the access points published so far.
+	// GetBlockCount uses an estimate of the size until the index is done.
+	std::thread m_indexThread;
+	std::mutex m_indexMutex;
+	std::vector<Point*> m_indexPoints; // published access points (under m_indexMutex)
+	Access* m_builtIndex;              // the index once done (under m_indexMutex)
+	int m_indexResult;
+	bool m_indexDone;
+	std::atomic<bool> m_indexQuit;
+	PX_off_t m_sizeEstimate;
+	Access m_partialIndex; // one of the published points, for extract()
+	Point m_partialPoint;
+
 	ChunksCache m_cache;
 
 #ifdef _WIN32
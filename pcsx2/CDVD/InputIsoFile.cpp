@@ -17,9 +17,19 @@
 #include "PrecompiledHeader.h"
 #include "IopCommon.h"
 #include "IsoFileFormats.h"
+#include "IsoFS/IsoFS.h"
+#include "Timeline.h"
 
 #include <errno.h>
 
+// Files smaller than this are read in a few requests anyway, and aren't prefetched
+static const u32 MinPrefetchBytes = 512 * 1024;
+// Larger files are only prefetched up to this size from their start
+static const u32 MaxPrefetchBytes = 16 * 1024 * 1024;
+// Limits of the filesystem walk, so that it can't slow down the disc opening
+static const int MaxDirectoryDepth = 8;
+static const uint MaxDirectories = 1024;
+
 static const char* nameFromType(int type)
 {
 	switch (type)
@@ -82,6 +92,19 @@ void InputIsoFile::BeginRead2(uint lsn)
 		m_read_count = std::min(ReadUnit, m_blocks - m_read_lsn);
 	}
 
+	// Reads starting a large file usually go on through the whole file
+	if (!m_fileExtents.empty())
+	{
+		auto extent = m_fileExtents.find(m_read_lsn);
+		if (extent != m_fileExtents.end())
+			m_reader->PrefetchHint(m_read_lsn, std::min(extent->second, m_blocks - m_read_lsn));
+	}
+
+	// Mapped images are copied straight to the destination by FinishRead3
+	m_read_mapped = m_reader->GetMappedSectors(m_read_lsn, m_read_count);
+	if (m_read_mapped)
+		return;
+
 	m_reader->BeginRead(m_readbuffer, m_read_lsn, m_read_count);
 	m_read_inprogress = true;
 }
@@ -101,6 +124,7 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 
 	if (m_read_inprogress)
 	{
+		TIMELINE_SCOPE("CDVD read");
 		ret = m_reader->FinishRead();
 		m_read_inprogress = false;
 
@@ -148,7 +172,8 @@ int InputIsoFile::FinishRead3(u8* dst, uint mode)
 	length = end - _offset;
 
 	uint read_offset = (m_current_lsn - m_read_lsn) * m_blocksize;
-	memcpy(dst + diff, m_readbuffer + ndiff + read_offset, length);
+	const u8* src = m_read_mapped ? m_read_mapped : m_readbuffer;
+	memcpy(dst + diff, src + ndiff + read_offset, length);
 
 	if (m_type == ISOTYPE_CD && diff >= 12)
 	{
@@ -184,7 +209,9 @@ void InputIsoFile::_init()
 	ReadUnit = 0;
 	m_current_lsn = -1;
 	m_read_lsn = -1;
+	m_read_mapped = nullptr;
 	m_reader = NULL;
+	m_fileExtents.clear();
 }
 
 // Tests the specified filename to see if it is a supported ISO type.  This function typically
@@ -270,6 +297,13 @@ bool InputIsoFile::Open(const wxString& srcfile, bool testOnly)
 
 	m_blocks = m_reader->GetBlockCount();
 
+	if (EmuConfig.CdvdPrefetchFiles && !isBlockdump)
+		FindFileExtents();
+
+	// Blockdumps only read one sector at a time
+	if (EmuConfig.CdvdPreloadMB && !isBlockdump)
+		m_reader = new PreloadingFileReader(m_reader, (u64)EmuConfig.CdvdPreloadMB << 20);
+
 	Console.WriteLn(Color_StrongBlue, L"isoFile open ok: %s", WX_STR(m_filename));
 
 	ConsoleIndentScope indent;
@@ -297,6 +331,71 @@ bool InputIsoFile::IsOpened() const
 	return m_reader != NULL;
 }
 
+// Reads the disc filesystem through the image being opened
+class InputIsoSectorSource : public SectorSource
+{
+	InputIsoFile& m_iso;
+
+public:
+	InputIsoSectorSource(InputIsoFile& iso)
+		: m_iso(iso)
+	{
+	}
+
+	virtual int getNumSectors() { return m_iso.GetBlockCount(); }
+
+	virtual bool readSector(unsigned char* buffer, int lba)
+	{
+		u8 data[CD_FRAMESIZE_RAW];
+		if ((uint)lba >= m_iso.GetBlockCount() || m_iso.ReadSync(data, lba) < 0)
+			return false;
+
+		memcpy(buffer, data + 24, 2048);
+		return true;
+	}
+};
+
+static void AddFileExtents(std::unordered_map<u32, u32>& extents, const IsoDirectory& dir, u32 blocks, int depth, uint& directories)
+{
+	for (const IsoFileDescriptor& entry : dir.files)
+	{
+		if (entry.lba >= blocks || entry.name == L"." || entry.name == L"..")
+			continue;
+
+		if (entry.IsFile())
+		{
+			if (entry.size >= MinPrefetchBytes)
+				extents[entry.lba] = (std::min(entry.size, MaxPrefetchBytes) + 2047) / 2048;
+		}
+		else if (depth < MaxDirectoryDepth && directories < MaxDirectories)
+		{
+			directories++;
+			AddFileExtents(extents, IsoDirectory(dir.GetReader(), entry), blocks, depth + 1, directories);
+		}
+	}
+}
+
+void InputIsoFile::FindFileExtents()
+{
+	InputIsoSectorSource source(*this);
+	uint directories = 0;
+
+	try
+	{
+		IsoDirectory root(source);
+		AddFileExtents(m_fileExtents, root, m_blocks, 0, directories);
+	}
+	catch (Exception::BaseException& ex)
+	{
+		// Not an ISO9660 filesystem, the reads just aren't prefetched
+		DevCon.Warning(L"isoFile: no file extents for the prefetch: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		m_fileExtents.clear();
+		return;
+	}
+
+	DevCon.WriteLn("isoFile: %zu files to prefetch (%u directories)", m_fileExtents.size(), directories);
+}
+
 bool InputIsoFile::tryIsoType(u32 _size, s32 _offset, s32 _blockofs)
 {
 	static u8 buf[2456];
@@ -19,7 +19,13 @@
 #include "wx/wfstream.h"
 #include "AsyncFileReader.h"
 #include "CompressedFileReader.h"
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 enum isoType
 {
@@ -63,8 +69,12 @@ protected:
 	bool m_read_inprogress;
 	uint m_read_lsn;
 	uint m_read_count;
+	const u8* m_read_mapped; // the read sectors when the reader has them in memory
 	u8 m_readbuffer[MaxReadUnit * CD_FRAMESIZE_RAW];
 
+	// first sector -> sectors to prefetch, for the large files of the disc filesystem
+	std::unordered_map<u32, u32> m_fileExtents;
+
 public:
 	InputIsoFile();
 	virtual ~InputIsoFile();
@@ -95,6 +105,7 @@ protected:
 
 	bool tryIsoType(u32 _size, s32 _offset, s32 _blockofs);
 	void FindParts();
+	void FindFileExtents();
 };
 
 class OutputIsoFile
@@ -115,9 +126,26 @@ protected:
 
 	// dtable is used when reading blockdumps
 	std::vector<u32> m_dtable;
+	// lsns in m_dtable, to skip the blocks already dumped
+	std::unordered_set<u32> m_dumped;
 
 	std::unique_ptr<wxFileOutputStream> m_outstream;
 
+	// Sectors are written by a background thread, in batches of consecutive sectors,
+	// so that the emulation doesn't wait for the disk
+	struct WriteBatch
+	{
+		wxFileOffset offset; // -1 to append to the file
+		std::vector<u8> data;
+	};
+	WriteBatch m_batch; // being filled by WriteSector
+	std::deque<WriteBatch> m_queue;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCond;
+	std::thread m_writer;
+	bool m_writerQuit;
+	ScopedExcept m_writeError; // from the writer thread, thrown again by the following writes
+
 public:
 	OutputIsoFile();
 	virtual ~OutputIsoFile();
@@ -142,6 +170,11 @@ protected:
 
 	void WriteBuffer(const void* src, size_t size);
 
+	void WriterThread();
+	void WriteToStream(const void* src, size_t size);
+	void QueueBatch();
+	void StopWriter();
+
 	template <typename T>
 	void WriteValue(const T& data)
 	{
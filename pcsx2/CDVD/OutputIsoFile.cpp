@@ -20,6 +20,11 @@
 
 #include <errno.h>
 
+// Batches are queued when they reach this size, or when the sectors stop being consecutive
+static const size_t MaxBatchBytes = 1024 * 1024;
+// Sectors waiting to be written; the emulation only waits if the disk is this far behind
+static const size_t MaxQueuedBatches = 16;
+
 void pxStream_OpenCheck(const wxStreamBase& stream, const wxString& fname, const wxString& mode)
 {
 	if (stream.IsOk())
@@ -48,6 +53,10 @@ void OutputIsoFile::_init()
 	m_blockofs = 0;
 	m_blocksize = 0;
 	m_blocks = 0;
+
+	m_batch.offset = -1;
+	m_batch.data.clear();
+	m_writerQuit = false;
 }
 
 void OutputIsoFile::Create(const wxString& filename, int version)
@@ -63,6 +72,9 @@ void OutputIsoFile::Create(const wxString& filename, int version)
 	m_outstream = std::make_unique<wxFileOutputStream>(m_filename);
 	pxStream_OpenCheck(*m_outstream, m_filename, L"writing");
 
+	m_writeError.reset();
+	m_writer = std::thread(&OutputIsoFile::WriterThread, this);
+
 	Console.WriteLn("isoFile create ok: %s ", WX_STR(m_filename));
 }
 
@@ -91,7 +103,7 @@ void OutputIsoFile::WriteSector(const u8* src, uint lsn)
 	if (m_version == 2)
 	{
 		// Find and ignore blocks that have already been dumped:
-		if (std::any_of(std::begin(m_dtable), std::end(m_dtable), [=](const u32 entry) { return entry == lsn; }))
+		if (!m_dumped.insert(lsn).second)
 			return;
 
 		m_dtable.push_back(lsn);
@@ -102,7 +114,12 @@ void OutputIsoFile::WriteSector(const u8* src, uint lsn)
 	{
 		wxFileOffset ofs = (wxFileOffset)lsn * m_blocksize + m_offset;
 
-		m_outstream->SeekO(ofs);
+		// Start a new batch where the sector goes, unless it follows the previous one
+		if (m_batch.offset < 0 || m_batch.offset + (wxFileOffset)m_batch.data.size() != ofs)
+		{
+			QueueBatch();
+			m_batch.offset = ofs;
+		}
 	}
 
 	WriteBuffer(src + m_blockofs, m_blocksize);
@@ -110,12 +127,123 @@ void OutputIsoFile::WriteSector(const u8* src, uint lsn)
 
 void OutputIsoFile::Close()
 {
+	if (m_writer.joinable())
+	{
+		try
+		{
+			QueueBatch();
+		}
+		catch (Exception::BaseException&)
+		{
+		}
+		StopWriter();
+
+		if (m_writeError)
+			Console.Error(L"isoFile: the dump is incomplete: %s", WX_STR(m_writeError->FormatDiagnosticMessage()));
+	}
+
+	// Blockdumps get their index right away, instead of a scan of the dump on its first open
+	if (m_version == 2 && m_outstream && !m_writeError && !m_dtable.empty())
+	{
+		if (!BlockdumpFileReader::WriteIndex(m_filename, m_blocksize, m_dtable))
+			Console.Warning(L"isoFile: unable to write the blockdump index for %s", WX_STR(m_filename));
+	}
+
+	m_outstream.reset();
 	m_dtable.clear();
+	m_dumped.clear();
 
 	_init();
 }
 
 void OutputIsoFile::WriteBuffer(const void* src, size_t size)
+{
+	const u8* bytes = static_cast<const u8*>(src);
+	m_batch.data.insert(m_batch.data.end(), bytes, bytes + size);
+
+	if (m_batch.data.size() >= MaxBatchBytes)
+	{
+		const bool append = m_batch.offset < 0;
+		const wxFileOffset next = m_batch.offset + m_batch.data.size();
+		QueueBatch();
+		if (!append)
+			m_batch.offset = next;
+	}
+}
+
+void OutputIsoFile::QueueBatch()
+{
+	if (m_batch.data.empty())
+		return;
+
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+	m_queueCond.wait(lock, [this]() { return m_queue.size() < MaxQueuedBatches || m_writeError; });
+
+	if (m_writeError)
+	{
+		m_batch.data.clear();
+		m_writeError->Rethrow();
+	}
+
+	m_queue.push_back(std::move(m_batch));
+	m_batch.offset = -1;
+	m_batch.data.clear();
+	m_queueCond.notify_all();
+}
+
+void OutputIsoFile::StopWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_writerQuit = true;
+	}
+	m_queueCond.notify_all();
+	m_writer.join();
+	m_writerQuit = false;
+}
+
+void OutputIsoFile::WriterThread()
+{
+	std::unique_lock<std::mutex> lock(m_queueMutex);
+
+	while (true)
+	{
+		m_queueCond.wait(lock, [this]() { return !m_queue.empty() || m_writerQuit; });
+		if (m_queue.empty())
+			break;
+
+		WriteBatch batch = std::move(m_queue.front());
+		m_queue.pop_front();
+		const bool failed = !!m_writeError;
+		lock.unlock();
+		m_queueCond.notify_all();
+
+		// After an error, the remaining sectors are dropped
+		ScopedExcept error;
+		if (!failed)
+		{
+			try
+			{
+				if (batch.offset >= 0)
+					m_outstream->SeekO(batch.offset);
+				WriteToStream(batch.data.data(), batch.data.size());
+			}
+			catch (Exception::BaseException& ex)
+			{
+				error.reset(ex.Clone());
+			}
+		}
+
+		lock.lock();
+		if (error)
+		{
+			m_writeError = std::move(error);
+			m_queueCond.notify_all();
+		}
+	}
+}
+
+void OutputIsoFile::WriteToStream(const void* src, size_t size)
 {
 	m_outstream->Write(src, size);
 	if (m_outstream->GetLastError() == wxSTREAM_WRITE_ERROR)
@@ -132,7 +260,8 @@ void OutputIsoFile::WriteBuffer(const void* src, size_t size)
 
 bool OutputIsoFile::IsOpened() const
 {
-	return m_outstream && m_outstream->IsOk();
+	// The stream belongs to the writer thread once created, its errors come back as exceptions
+	return m_outstream != nullptr;
 }
 
 u32 OutputIsoFile::GetBlockSize() const
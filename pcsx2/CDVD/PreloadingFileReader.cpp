@@ -0,0 +1,202 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "Utilities/PersistentThread.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+std::atomic<int> PreloadingFileReader::s_progress{-1};
+
+PreloadingFileReader::PreloadingFileReader(AsyncFileReader* reader, u64 limitBytes)
+	: m_reader(reader)
+	, m_sectors(0)
+	, m_loaded(0)
+	, m_quit(false)
+	, m_result(0)
+	, m_fromMemory(false)
+{
+	m_filename = reader->GetFilename();
+	m_blocksize = reader->GetBlockSize();
+
+	m_sectors = std::min<u64>(reader->GetBlockCount(), limitBytes / m_blocksize);
+	if (m_sectors == 0)
+		return;
+
+	m_data.reset(new (std::nothrow) u8[(size_t)m_sectors * m_blocksize]);
+	if (!m_data)
+	{
+		Console.Warning("isoFile: Not enough memory to preload %u MB of the image.", (u32)(((u64)m_sectors * m_blocksize) >> 20));
+		m_sectors = 0;
+		return;
+	}
+
+	s_progress = 0;
+	m_thread = std::thread(&PreloadingFileReader::LoadThread, this);
+}
+
+PreloadingFileReader::~PreloadingFileReader(void)
+{
+	Close();
+	delete m_reader;
+}
+
+void PreloadingFileReader::LoadThread()
+{
+	Threading::SetNameOfCurrentThread("ISO Preload");
+
+	// Leave the disk to the emulator's own reads
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#elif defined(__linux__)
+	const int IOPRIO_WHO_PROCESS = 1, IOPRIO_CLASS_IDLE = 3, IOPRIO_CLASS_SHIFT = 13;
+	syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#elif defined(__APPLE__)
+	setiopolicy_np(IOPOL_TYPE_DISK, IOPOL_SCOPE_THREAD, IOPOL_THROTTLE);
+#endif
+
+	const u64 start = GetCPUTicks();
+	uint sector = 0;
+	while (sector < m_sectors && !m_quit.load(std::memory_order_relaxed))
+	{
+		const uint count = std::min(LoadUnit, m_sectors - sector);
+		int result;
+		{
+			std::lock_guard<std::mutex> lock(m_readerMutex);
+			result = m_reader->ReadSync(m_data.get() + (size_t)sector * m_blocksize, sector, count);
+		}
+		if (result < 0)
+		{
+			Console.Warning("isoFile: Preload stopped by a read error at sector %u.", sector);
+			break;
+		}
+
+		sector += count;
+		m_loaded.store(sector, std::memory_order_release);
+		s_progress.store((int)((u64)sector * 100 / m_sectors), std::memory_order_relaxed);
+	}
+
+	if (sector == m_sectors)
+		Console.WriteLn(Color_StrongBlue, "isoFile: Preloaded %u MB of the image in %.1f s.",
+			(u32)(((u64)m_sectors * m_blocksize) >> 20), (double)(GetCPUTicks() - start) / GetTickFrequency());
+
+	s_progress = -1;
+
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#endif
+}
+
+bool PreloadingFileReader::IsLoaded(uint sector, uint count) const
+{
+	return (u64)sector + count <= m_loaded.load(std::memory_order_acquire);
+}
+
+const u8* PreloadingFileReader::GetMappedSectors(uint sector, uint count)
+{
+	return IsLoaded(sector, count) ? m_data.get() + (size_t)sector * m_blocksize : nullptr;
+}
+
+void PreloadingFileReader::PrefetchHint(uint sector, uint count)
+{
+	if (IsLoaded(sector, count))
+		return;
+
+	// Only a hint: skip it rather than wait while the reader is busy
+	std::unique_lock<std::mutex> lock(m_readerMutex, std::try_to_lock);
+	if (lock.owns_lock())
+		m_reader->PrefetchHint(sector, count);
+}
+
+bool PreloadingFileReader::Open(const wxString& fileName)
+{
+	// The wrapped reader is already open
+	return true;
+}
+
+int PreloadingFileReader::ReadSync(void* pBuffer, uint sector, uint count)
+{
+	if (IsLoaded(sector, count))
+	{
+		memcpy(pBuffer, m_data.get() + (size_t)sector * m_blocksize, (size_t)count * m_blocksize);
+		return count * m_blocksize;
+	}
+
+	std::lock_guard<std::mutex> lock(m_readerMutex);
+	return m_reader->ReadSync(pBuffer, sector, count);
+}
+
+void PreloadingFileReader::BeginRead(void* pBuffer, uint sector, uint count)
+{
+	m_fromMemory = IsLoaded(sector, count);
+	if (m_fromMemory)
+	{
+		memcpy(pBuffer, m_data.get() + (size_t)sector * m_blocksize, (size_t)count * m_blocksize);
+		m_result = count * m_blocksize;
+		return;
+	}
+
+	// The preload thread waits until the read is finished
+	m_readLock = std::unique_lock<std::mutex>(m_readerMutex);
+	m_reader->BeginRead(pBuffer, sector, count);
+}
+
+int PreloadingFileReader::FinishRead(void)
+{
+	if (m_fromMemory)
+		return m_result;
+
+	int result = m_reader->FinishRead();
+	if (m_readLock.owns_lock())
+		m_readLock.unlock();
+	return result;
+}
+
+void PreloadingFileReader::CancelRead(void)
+{
+	if (!m_readLock.owns_lock())
+		return;
+
+	m_reader->CancelRead();
+	m_readLock.unlock();
+}
+
+void PreloadingFileReader::Close(void)
+{
+	if (m_thread.joinable())
+	{
+		m_quit = true;
+		m_thread.join();
+	}
+	CancelRead();
+
+	m_reader->Close();
+	m_data.reset();
+	m_sectors = 0;
+	m_loaded = 0;
+	s_progress = -1;
+}
+
+uint PreloadingFileReader::GetBlockCount(void) const
+{
+	return m_reader->GetBlockCount();
+}
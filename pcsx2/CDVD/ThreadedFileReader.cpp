@@ -15,10 +15,13 @@
 
 #include "PrecompiledHeader.h"
 #include "ThreadedFileReader.h"
+#include "Timeline.h"
 
 // Make sure buffer size is bigger than the cutoff where PCSX2 emulates a seek
 // If buffers are smaller than that, we can't keep up with linear reads
 static constexpr u32 MINIMUM_SIZE = 128 * 1024;
+// Chunks of readahead given to ReadChunks at once
+static constexpr u32 MAXIMUM_CHUNKS_PER_READ = 64;
 
 ThreadedFileReader::ThreadedFileReader()
 {
@@ -27,6 +30,7 @@ ThreadedFileReader::ThreadedFileReader()
 
 ThreadedFileReader::~ThreadedFileReader()
 {
+	StopWorkers();
 	m_quit = true;
 	(void)std::lock_guard<std::mutex>{m_mtx};
 	m_condition.notify_one();
@@ -72,6 +76,7 @@ void ThreadedFileReader::Loop()
 
 		u64 requestOffset = m_requestOffset;
 		u32 requestSize = m_requestSize;
+		u32 readaheadDepth = m_readaheadDepth;
 		void* ptr = m_requestPtr.load(std::memory_order_relaxed);
 
 		m_running = true;
@@ -93,7 +98,7 @@ void ThreadedFileReader::Loop()
 			Chunk chunk = ChunkForOffset(requestOffset + requestSize);
 			if (chunk.chunkID >= 0)
 			{
-				int buffersFilled = 0;
+				u32 buffersFilled = 0;
 				Buffer* buf = GetBlockPtr(chunk);
 				// Cancel readahead if a new request comes in
 				while (buf && !m_requestPtr.load(std::memory_order_acquire))
@@ -105,13 +110,24 @@ void ThreadedFileReader::Loop()
 					if (buf->offset + bufsize != chunk.offset || chunk.length + bufsize > buf->cap)
 					{
 						buffersFilled++;
-						if (buffersFilled >= 2)
+						if (buffersFilled > readaheadDepth)
 							break;
 						buf = GetBlockPtr(chunk);
 					}
 					else
 					{
-						int amt = ReadChunk(static_cast<char*>(buf->ptr) + bufsize, chunk.chunkID);
+						// Read all of the following chunks that fit in the buffer at once
+						u32 count = 1;
+						u32 length = chunk.length;
+						while (count < MAXIMUM_CHUNKS_PER_READ)
+						{
+							Chunk next = ChunkForOffset(chunk.offset + length);
+							if (next.chunkID != chunk.chunkID + count || next.offset != chunk.offset + length || length + next.length + bufsize > buf->cap)
+								break;
+							count++;
+							length += next.length;
+						}
+						int amt = ReadChunks(static_cast<char*>(buf->ptr) + bufsize, chunk.chunkID, count);
 						if (amt <= 0)
 							break;
 						buf->size.store(bufsize + amt, std::memory_order_release);
@@ -132,6 +148,105 @@ void ThreadedFileReader::Loop()
 	}
 }
 
+int ThreadedFileReader::ReadChunks(void* dst, s64 chunkID, u32 count)
+{
+	int total = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		int amt = ReadChunk(static_cast<char*>(dst) + total, chunkID + i);
+		if (amt <= 0)
+			break;
+		total += amt;
+	}
+	return total;
+}
+
+u32 ThreadedFileReader::StartWorkers()
+{
+	// Leave the cores to the emulator threads, a few workers are enough to stay ahead of
+	// the emulated drive
+	const u32 count = std::min(std::thread::hardware_concurrency() / 4, 3u);
+
+	for (u32 i = 0; i < count; i++)
+		m_workers.emplace_back(&ThreadedFileReader::WorkerLoop, this, i + 1, m_workerBatch.id);
+
+	return count;
+}
+
+void ThreadedFileReader::StopWorkers()
+{
+	if (m_workers.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_workerMutex);
+		m_workerQuit = true;
+	}
+	m_workerStart.notify_all();
+
+	for (std::thread& worker : m_workers)
+		worker.join();
+
+	m_workers.clear();
+	m_workerQuit = false;
+}
+
+void ThreadedFileReader::WorkerLoop(u32 worker, u32 seen)
+{
+	Threading::SetNameOfCurrentThread("ISO Decompress Worker");
+
+	std::unique_lock<std::mutex> lock(m_workerMutex);
+
+	while (true)
+	{
+		// The thread may only get to run after the next batch was started
+		m_workerStart.wait(lock, [&] { return m_workerQuit || m_workerBatch.id != seen; });
+		if (m_workerQuit)
+			return;
+		seen = m_workerBatch.id;
+
+		lock.unlock();
+		RunWorkerBatch(worker);
+		lock.lock();
+
+		if (--m_workerBatch.running == 0)
+			m_workerDone.notify_one();
+	}
+}
+
+void ThreadedFileReader::RunWorkerBatch(u32 worker)
+{
+	const std::function<void(u32, u32)>& job = *m_workerBatch.job;
+
+	for (u32 i; (i = m_workerBatch.next.fetch_add(1, std::memory_order_relaxed)) < m_workerBatch.count;)
+		job(worker, i);
+}
+
+void ThreadedFileReader::RunWorkers(u32 count, const std::function<void(u32, u32)>& job)
+{
+	if (m_workers.empty())
+	{
+		for (u32 i = 0; i < count; i++)
+			job(0, i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_workerMutex);
+		m_workerBatch.job = &job;
+		m_workerBatch.count = count;
+		m_workerBatch.next.store(0, std::memory_order_relaxed);
+		m_workerBatch.running = static_cast<u32>(m_workers.size());
+		m_workerBatch.id++;
+	}
+	m_workerStart.notify_all();
+
+	RunWorkerBatch(0);
+
+	std::unique_lock<std::mutex> lock(m_workerMutex);
+	m_workerDone.wait(lock, [this] { return m_workerBatch.running == 0; });
+}
+
 ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 {
 	for (int i = 0; i < static_cast<int>(ArraySize(m_buffer)); i++)
@@ -174,6 +289,7 @@ ThreadedFileReader::Buffer* ThreadedFileReader::GetBlockPtr(const Chunk& block)
 
 bool ThreadedFileReader::Decompress(void* target, u64 begin, u32 size)
 {
+	TIMELINE_SCOPE("CDVD decompress");
 	char* write = static_cast<char*>(target);
 	u32 remaining = size;
 	u64 off = begin;
@@ -213,7 +329,6 @@ bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, co
 	// Run through twice so that if m_buffer[1] contains the first half and m_buffer[0] contains the second half it still works
 	m_amtRead = 0;
 	u64 end = 0;
-	bool allDone = false;
 	for (int i = 0; i < static_cast<int>(ArraySize(m_buffer) * 2); i++)
 	{
 		Buffer& buf = m_buffer[i % ArraySize(m_buffer)];
@@ -232,11 +347,37 @@ bool ThreadedFileReader::TryCachedRead(void*& buffer, u64& offset, u32& size, co
 			if (size == 0)
 				end = buf.offset + bufsize;
 		}
-		// Do buffers contain the current and next block?
-		if (end > 0 && buf.offset == end)
-			allDone = true;
 	}
-	return allDone;
+	if (end == 0)
+		return false;
+
+	// Do buffers contain the current block and the readahead after it?
+	u32 ahead = 0;
+	for (int i = 0; i < static_cast<int>(ArraySize(m_buffer)) && ahead < m_readaheadDepth; i++)
+	{
+		Buffer& buf = m_buffer[i];
+		u32 bufsize = buf.size.load(std::memory_order_acquire);
+		if (bufsize && buf.offset == end)
+		{
+			end += bufsize;
+			ahead++;
+			i = -1; // the next block may be in any buffer
+		}
+	}
+	return ahead >= m_readaheadDepth;
+}
+
+void ThreadedFileReader::UpdateReadahead(u64 offset, u32 size, const std::lock_guard<std::mutex>&)
+{
+	// Streams read the file in order, one request after the other: read further ahead
+	// while they go on, so that the decompression stays ahead of them
+	if (offset >= m_hintStart && offset < m_hintEnd)
+		m_readaheadDepth = ArraySize(m_buffer) - 1;
+	else if (offset == m_lastRequestEnd)
+		m_readaheadDepth = std::min<u32>(m_readaheadDepth + 1, ArraySize(m_buffer) - 1);
+	else
+		m_readaheadDepth = 1;
+	m_lastRequestEnd = offset + size;
 }
 
 bool ThreadedFileReader::Open(const wxString& fileName)
@@ -252,6 +393,7 @@ int ThreadedFileReader::ReadSync(void* pBuffer, uint sector, uint count)
 	u32 size = count * blocksize;
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
+		UpdateReadahead(offset, size, l);
 		if (TryCachedRead(pBuffer, offset, size, l))
 			return m_amtRead;
 
@@ -301,6 +443,7 @@ void ThreadedFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 	u32 size = count * blocksize;
 	{
 		std::lock_guard<std::mutex> l(m_mtx);
+		UpdateReadahead(offset, size, l);
 		if (TryCachedRead(pBuffer, offset, size, l))
 			return;
 		if (size == 0)
@@ -358,3 +501,11 @@ void ThreadedFileReader::SetDataOffset(int bytes)
 {
 	m_dataoffset = bytes;
 }
+
+void ThreadedFileReader::PrefetchHint(uint sector, uint count)
+{
+	u32 blocksize = InternalBlockSize();
+	std::lock_guard<std::mutex> l(m_mtx);
+	m_hintStart = (u64)sector * (u64)blocksize + m_dataoffset;
+	m_hintEnd = m_hintStart + (u64)count * blocksize;
+}
@@ -22,6 +22,8 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <functional>
+#include <vector>
 
 /// A file reader for use with compressed formats
 /// Calls decompression code on a separate thread to make a synchronous decompression API async
@@ -46,11 +48,27 @@ protected:
 	virtual Chunk ChunkForOffset(u64 offset) = 0;
 	/// Synchronously read the given block into `dst`
 	virtual int ReadChunk(void* dst, s64 chunkID) = 0;
+	/// Synchronously read `count` consecutive blocks, contiguous in the file, into `dst`
+	/// Returns the bytes read, up to the first block that failed
+	/// Override to read the blocks of readahead in parallel, the default reads them one by one
+	virtual int ReadChunks(void* dst, s64 chunkID, u32 count);
 	/// AsyncFileReader open but ThreadedFileReader needs prep work first
 	virtual bool Open2(const wxString& fileName) = 0;
 	/// AsyncFileReader close but ThreadedFileReader needs prep work first
 	virtual void Close2(void) = 0;
 
+	/// Start the workers of RunWorkers (none on machines with few cores)
+	/// Returns the number of workers, the per worker state of the reader should be ready
+	/// for them beforehand
+	u32 StartWorkers();
+	/// Stop the workers, call from Close2
+	void StopWorkers();
+	u32 WorkerCount() const { return static_cast<u32>(m_workers.size()); }
+	/// Call `job(worker, index)` for each index below `count`, on the calling thread
+	/// (worker 0) and on the workers (1 to WorkerCount()), and wait until all are done
+	/// Use from ReadChunks to decompress its blocks in parallel
+	void RunWorkers(u32 count, const std::function<void(u32, u32)>& job);
+
 	ThreadedFileReader();
 	~ThreadedFileReader();
 
@@ -74,9 +92,17 @@ private:
 		std::atomic<u32> size{0};
 		u32 cap = 0;
 	};
-	/// 2 buffers for readahead (current block, next block)
-	Buffer m_buffer[2];
+	/// Buffers for readahead (current block, next blocks), used round robin
+	Buffer m_buffer[8];
 	u32 m_nextBuffer = 0;
+	/// Number of buffers to read ahead past the current block
+	/// Grows while the reads are sequential, back to 1 on a seek
+	u32 m_readaheadDepth = 1;
+	/// End of the last request, in (internal block) bytes, to detect sequential reads
+	u64 m_lastRequestEnd = 0;
+	/// Range given to PrefetchHint, in (internal block) bytes, read ahead at full depth
+	u64 m_hintStart = 0;
+	u64 m_hintEnd = 0;
 
 	std::thread m_readThread;
 	std::mutex m_mtx;
@@ -87,6 +113,27 @@ private:
 	/// View while holding `m_mtx`.  If false, you may touch decompression functions from other threads
 	bool m_running = false;
 
+	struct WorkerBatch
+	{
+		const std::function<void(u32, u32)>* job = nullptr;
+		u32 count = 0;
+		std::atomic<u32> next{0};
+		/// Workers still running the batch (under m_workerMutex)
+		u32 running = 0;
+		u32 id = 0;
+	};
+	WorkerBatch m_workerBatch;
+	std::vector<std::thread> m_workers;
+	std::mutex m_workerMutex;
+	std::condition_variable m_workerStart;
+	std::condition_variable m_workerDone;
+	bool m_workerQuit = false;
+
+	/// Main loop of the workers, `seen` is the last batch when the worker was started
+	void WorkerLoop(u32 worker, u32 seen);
+	/// Run the indices of the current batch until there are none left
+	void RunWorkerBatch(u32 worker);
+
 	/// Get the internal block size
 	u32 InternalBlockSize() const { return m_internalBlockSize ? m_internalBlockSize : m_blocksize; }
 	/// memcpy from internal to external blocks
@@ -107,6 +154,8 @@ private:
 	/// Adjusts pointer, offset, and size if successful
 	/// Returns true if no additional reads are necessary
 	bool TryCachedRead(void*& buffer, u64& offset, u32& size, const std::lock_guard<std::mutex>&);
+	/// Adjust the readahead depth to the access pattern of a new request
+	void UpdateReadahead(u64 offset, u32 size, const std::lock_guard<std::mutex>&);
 
 public:
 	bool Open(const wxString& fileName) final override;
@@ -117,4 +166,5 @@ public:
 	void Close(void) final override;
 	void SetBlockSize(uint bytes) final override;
 	void SetDataOffset(int bytes) final override;
+	void PrefetchHint(uint sector, uint count) final override;
 };
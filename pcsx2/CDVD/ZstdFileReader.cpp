@@ -0,0 +1,279 @@
+/*  PCSX2 - PS2 Emulator for PCs
+*  Copyright (C) 2002-2021  PCSX2 Dev Team
+*
+*  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+*  of the GNU Lesser General Public License as published by the Free Software Found-
+*  ation, either version 3 of the License, or (at your option) any later version.
+*
+*  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*  PURPOSE.  See the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along with PCSX2.
+*  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "PrecompiledHeader.h"
+#include "AsyncFileReader.h"
+#include "CompressedFileReaderUtils.h"
+#include "ZstdFileReader.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+
+// Seekable format, from the zstd sources:
+// https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+// The seek table is a skippable frame at the end of the file, with an entry per frame
+// (compressed size, decompressed size, optional checksum) and a footer.
+static const u32 ZSTD_SEEKABLE_MAGIC = 0x8F92EAB1;
+static const u32 ZSTD_SEEKTABLE_FRAME_MAGIC = 0x184D2A5E;
+static const u32 ZSTD_SEEKTABLE_FOOTER_SIZE = 9;
+// Larger frames would make the readahead buffers huge
+static const u32 ZSTD_MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+static u32 ReadLE32(const u8* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((u32)p[3] << 24);
+}
+
+// Reads the footer of the seek table, returns the number of frames or -1 if it has none
+static s64 ReadSeekTableFooter(FILE* fp, bool& checksums)
+{
+	u8 footer[ZSTD_SEEKTABLE_FOOTER_SIZE];
+	if (PX_fseeko(fp, -(s64)sizeof(footer), SEEK_END) != 0 || fread(footer, 1, sizeof(footer), fp) != sizeof(footer))
+		return -1;
+
+	// The reserved bits of the descriptor must be 0
+	const u8 descriptor = footer[4];
+	if (ReadLE32(footer + 5) != ZSTD_SEEKABLE_MAGIC || (descriptor & 0x7C) != 0)
+		return -1;
+
+	checksums = (descriptor & 0x80) != 0;
+	return ReadLE32(footer);
+}
+
+bool ZstdFileReader::CanHandle(const wxString& fileName)
+{
+	bool supported = false;
+	if (wxFileName::FileExists(fileName) && fileName.Lower().EndsWith(L".zst"))
+	{
+		FILE* fp = PX_fopen_rb(fileName);
+		if (fp)
+		{
+			bool checksums;
+			supported = ReadSeekTableFooter(fp, checksums) > 0;
+			fclose(fp);
+		}
+	}
+	return supported;
+}
+
+bool ZstdFileReader::Open2(const wxString& fileName)
+{
+	Close2();
+
+	m_filename = fileName;
+	m_src = PX_fopen_rb(m_filename);
+
+	bool success = false;
+	if (m_src && ReadSeekTable())
+	{
+		success = true;
+
+		const u32 workers = StartWorkers();
+		for (u32 i = 0; i <= workers; i++)
+		{
+			ZSTD_DCtx* ctx = ZSTD_createDCtx();
+			if (!ctx)
+			{
+				Console.Error("Unable to initialize zstd decompression.");
+				success = false;
+				break;
+			}
+			m_contexts.push_back(ctx);
+		}
+	}
+
+	if (!success)
+	{
+		Close2();
+		return false;
+	}
+	return true;
+}
+
+bool ZstdFileReader::ReadSeekTable()
+{
+	bool checksums;
+	const s64 frames = ReadSeekTableFooter(m_src, checksums);
+	if (frames <= 0)
+	{
+		Console.Error("Not a seekable zstd image.");
+		return false;
+	}
+
+	const u32 entrySize = checksums ? 12 : 8;
+	const s64 tableSize = 8 + frames * entrySize + ZSTD_SEEKTABLE_FOOTER_SIZE;
+	PX_fseeko(m_src, 0, SEEK_END);
+	const s64 fileSize = PX_ftello(m_src);
+	if (tableSize > fileSize)
+	{
+		Console.Error("Corrupt zstd seek table.");
+		return false;
+	}
+
+	std::vector<u8> table(tableSize);
+	if (PX_fseeko(m_src, fileSize - tableSize, SEEK_SET) != 0 || fread(table.data(), 1, table.size(), m_src) != table.size())
+	{
+		Console.Error("Unable to read the zstd seek table.");
+		return false;
+	}
+	if (ReadLE32(&table[0]) != ZSTD_SEEKTABLE_FRAME_MAGIC || ReadLE32(&table[4]) != tableSize - 8)
+	{
+		Console.Error("Corrupt zstd seek table.");
+		return false;
+	}
+
+	m_compressedOffsets.resize(frames + 1);
+	m_offsets.resize(frames + 1);
+	m_compressedOffsets[0] = 0;
+	m_offsets[0] = 0;
+	m_frameSize = ReadLE32(&table[8 + 4]);
+
+	u32 maxCompressed = 0;
+	for (s64 i = 0; i < frames; i++)
+	{
+		const u8* entry = &table[8 + i * entrySize];
+		const u32 compressed = ReadLE32(entry);
+		const u32 decompressed = ReadLE32(entry + 4);
+		if (decompressed == 0 || decompressed > ZSTD_MAX_FRAME_SIZE)
+		{
+			Console.Error("Unsupported zstd frame size: %u bytes.", decompressed);
+			return false;
+		}
+		if (i + 1 < frames && decompressed != m_frameSize)
+			m_frameSize = 0;
+
+		maxCompressed = std::max(maxCompressed, compressed);
+		m_compressedOffsets[i + 1] = m_compressedOffsets[i] + compressed;
+		m_offsets[i + 1] = m_offsets[i] + decompressed;
+	}
+
+	if ((s64)m_compressedOffsets[frames] > fileSize - tableSize)
+	{
+		Console.Error("Corrupt zstd seek table.");
+		return false;
+	}
+
+	m_totalSize = m_offsets[frames];
+	m_readBuffer.resize(maxCompressed);
+	return true;
+}
+
+ThreadedFileReader::Chunk ZstdFileReader::ChunkForOffset(u64 offset)
+{
+	Chunk chunk = {0};
+	if (offset >= m_totalSize)
+	{
+		chunk.chunkID = -1;
+		return chunk;
+	}
+
+	// Fixed size frames are found directly, the others by their start
+	if (m_frameSize)
+		chunk.chunkID = offset / m_frameSize;
+	else
+		chunk.chunkID = std::upper_bound(m_offsets.begin(), m_offsets.end(), offset) - m_offsets.begin() - 1;
+
+	chunk.offset = m_offsets[chunk.chunkID];
+	chunk.length = static_cast<u32>(m_offsets[chunk.chunkID + 1] - chunk.offset);
+	return chunk;
+}
+
+int ZstdFileReader::DecompressFrame(ZSTD_DCtx* ctx, void* dst, u32 frame, const u8* src)
+{
+	const size_t size = m_offsets[frame + 1] - m_offsets[frame];
+	const size_t compressed = m_compressedOffsets[frame + 1] - m_compressedOffsets[frame];
+
+	const size_t result = ZSTD_decompressDCtx(ctx, dst, size, src, compressed);
+	if (ZSTD_isError(result) || result != size)
+	{
+		Console.Error("Unable to decompress zstd frame %u: %s", frame,
+			ZSTD_isError(result) ? ZSTD_getErrorName(result) : "unexpected size");
+		return 0;
+	}
+	return static_cast<int>(size);
+}
+
+int ZstdFileReader::ReadChunk(void* dst, s64 chunkID)
+{
+	if (chunkID < 0 || chunkID >= (s64)m_offsets.size() - 1)
+		return -1;
+
+	const u64 pos = m_compressedOffsets[chunkID];
+	const size_t compressed = m_compressedOffsets[chunkID + 1] - pos;
+	if (PX_fseeko(m_src, pos, SEEK_SET) != 0 || fread(m_readBuffer.data(), 1, compressed, m_src) != compressed)
+	{
+		Console.Error("Unable to read zstd data.");
+		return 0;
+	}
+
+	return DecompressFrame(m_contexts[0], dst, chunkID, m_readBuffer.data());
+}
+
+// The frames of a read are contiguous in the file: they're read at once, then each frame
+// is decompressed by one of the workers to its place in `dst`.
+int ZstdFileReader::ReadChunks(void* dst, s64 chunkID, u32 count)
+{
+	if (WorkerCount() == 0 || count < 2 || chunkID < 0 || chunkID + count >= m_offsets.size())
+		return ThreadedFileReader::ReadChunks(dst, chunkID, count);
+
+	const u32 first = chunkID;
+	const u64 pos = m_compressedOffsets[first];
+	const size_t compressed = m_compressedOffsets[first + count] - pos;
+	if (m_readBuffer.size() < compressed)
+		m_readBuffer.resize(compressed);
+	if (PX_fseeko(m_src, pos, SEEK_SET) != 0 || fread(m_readBuffer.data(), 1, compressed, m_src) != compressed)
+	{
+		Console.Error("Unable to read zstd data.");
+		return 0;
+	}
+
+	m_batchResults.assign(count, 0);
+	RunWorkers(count, [&](u32 worker, u32 i) {
+		const u32 frame = first + i;
+		m_batchResults[i] = DecompressFrame(m_contexts[worker], static_cast<u8*>(dst) + (m_offsets[frame] - m_offsets[first]),
+			frame, m_readBuffer.data() + (m_compressedOffsets[frame] - pos));
+	});
+
+	// Up to the first frame that failed
+	int total = 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		total += m_batchResults[i];
+		if (m_batchResults[i] != static_cast<int>(m_offsets[first + i + 1] - m_offsets[first + i]))
+			break;
+	}
+	return total;
+}
+
+void ZstdFileReader::Close2()
+{
+	StopWorkers();
+	for (ZSTD_DCtx* ctx : m_contexts)
+		ZSTD_freeDCtx(ctx);
+	m_contexts.clear();
+
+	if (m_src)
+	{
+		fclose(m_src);
+		m_src = 0;
+	}
+
+	m_compressedOffsets.clear();
+	m_offsets.clear();
+	m_readBuffer.clear();
+	m_totalSize = 0;
+	m_frameSize = 0;
+}
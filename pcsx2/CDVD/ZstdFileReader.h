@@ -0,0 +1,74 @@
+/*  PCSX2 - PS2 Emulator for PCs
+*  Copyright (C) 2002-2021  PCSX2 Dev Team
+*
+*  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+*  of the GNU Lesser General Public License as published by the Free Software Found-
+*  ation, either version 3 of the License, or (at your option) any later version.
+*
+*  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+*  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+*  PURPOSE.  See the GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along with PCSX2.
+*  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ThreadedFileReader.h"
+
+#include <vector>
+
+typedef struct ZSTD_DCtx_s ZSTD_DCtx;
+
+// Images in the zstd seekable format: independent zstd frames, normally of a fixed size,
+// followed by a seek table of the compressed and decompressed size of each frame.
+class ZstdFileReader : public ThreadedFileReader
+{
+	DeclareNoncopyableObject(ZstdFileReader);
+
+public:
+	ZstdFileReader(void)
+		: m_frameSize(0)
+		, m_totalSize(0)
+		, m_src(0)
+	{
+		m_blocksize = 2048;
+	};
+
+	~ZstdFileReader(void) { Close(); };
+
+	static bool CanHandle(const wxString& fileName);
+	bool Open2(const wxString& fileName) override;
+
+	Chunk ChunkForOffset(u64 offset) override;
+	int ReadChunk(void* dst, s64 chunkID) override;
+	int ReadChunks(void* dst, s64 chunkID, u32 count) override;
+
+	void Close2(void) override;
+
+	uint GetBlockCount(void) const override
+	{
+		return (m_totalSize - m_dataoffset) / m_blocksize;
+	};
+
+private:
+	bool ReadSeekTable();
+	// Decompresses the frame from its compressed data, returns the frame size or 0 on failure
+	int DecompressFrame(ZSTD_DCtx* ctx, void* dst, u32 frame, const u8* src);
+
+	// Decompressed size of all the frames but the last, 0 if they vary
+	u32 m_frameSize;
+	u64 m_totalSize;
+	FILE* m_src;
+
+	// Start of each frame in the file and in the image, plus the ends of the last frame
+	std::vector<u64> m_compressedOffsets;
+	std::vector<u64> m_offsets;
+
+	// Decompression contexts of the read thread (0) and the workers of ReadChunks
+	std::vector<ZSTD_DCtx*> m_contexts;
+	// Compressed data and results of the frames of a read
+	std::vector<u8> m_readBuffer;
+	std::vector<int> m_batchResults;
+};
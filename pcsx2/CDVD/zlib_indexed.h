@@ -49,6 +49,7 @@ Comments) 1950 to 1952 in the files http://tools.ietf.org/html/rfc1950
       (Thanks to Mark Adler for suggesting the approach)
   - build_index(...) - added progress prints
   - CHUNK changed from 16k to 512k
+  - build_index(...) - optional progress callback, to use and cancel an index while it's built
  */
 
 /* Illustrate the use of Z_BLOCK, inflatePrime(), and inflateSetDictionary()
@@ -216,6 +217,13 @@ local struct access* addpoint(struct access* index, int bits,
 	return index;
 }
 
+/* Optional callback of build_index(), called after each access point is added (added is 1)
+   and after each CHUNK of input (added is 0), with the uncompressed offset reached so far.
+   A nonzero return stops the build, which then returns BUILD_INDEX_ABORTED. */
+typedef int (*build_progress)(void* opaque, struct access* index, int added, PX_off_t totout);
+
+#define BUILD_INDEX_ABORTED (-100)
+
 /* Make one entire pass through the compressed stream and build an index, with
    access points about every span bytes of uncompressed output -- span is
    chosen to balance the speed of random access against the memory requirements
@@ -224,7 +232,8 @@ local struct access* addpoint(struct access* index, int bits,
    returns the number of access points on success (>= 1), Z_MEM_ERROR for out
    of memory, Z_DATA_ERROR for an error in the input file, or Z_ERRNO for a
    file read error.  On success, *built points to the resulting index. */
-local int build_index(FILE* in, PX_off_t span, struct access** built)
+local int build_index(FILE* in, PX_off_t span, struct access** built,
+					  build_progress progress = nullptr, void* opaque = nullptr)
 {
 	int ret;
 	PX_off_t totin, totout, totPrinted; /* our own total counters to avoid 4GB limit */
@@ -310,9 +319,22 @@ local int build_index(FILE* in, PX_off_t span, struct access** built)
 					goto build_index_error;
 				}
 				last = totout;
+				if (progress && progress(opaque, index, 1, totout))
+				{
+					ret = BUILD_INDEX_ABORTED;
+					goto build_index_error;
+				}
 			}
 		} while (strm.avail_in != 0);
-		if (totin / (50 * 1024 * 1024) != totPrinted / (50 * 1024 * 1024))
+		if (progress)
+		{
+			if (progress(opaque, index, 0, totout))
+			{
+				ret = BUILD_INDEX_ABORTED;
+				goto build_index_error;
+			}
+		}
+		else if (totin / (50 * 1024 * 1024) != totPrinted / (50 * 1024 * 1024))
 		{
 			printf("%dMB ", (int)(totin / (1024 * 1024)));
 			totPrinted = totin;
@@ -17,6 +17,7 @@
 #include "PrecompiledHeader.h"
 #include "Common.h"
 #include "COP0.h"
+#include "Cache.h"
 
 u32 s_iLastCOP0Cycle = 0;
 u32 s_iLastPERFCycle[2] = { 0, 0 };
@@ -330,6 +331,7 @@ void WriteTLB(int i)
 	tlb[i].S = cpuRegs.CP0.n.EntryLo0&0x80000000;
 
 	MapTLB(i);
+	cacheUpdatePages();
 }
 
 namespace R5900 {
@@ -359,12 +361,14 @@ void TLBWI() {
 			cpuRegs.CP0.n.Index,    cpuRegs.CP0.n.PageMask, cpuRegs.CP0.n.EntryHi,
 			cpuRegs.CP0.n.EntryLo0, cpuRegs.CP0.n.EntryLo1);
 
+	vtlb_BeginRemap();
 	UnmapTLB(j);
 	tlb[j].PageMask = cpuRegs.CP0.n.PageMask;
 	tlb[j].EntryHi = cpuRegs.CP0.n.EntryHi;
 	tlb[j].EntryLo0 = cpuRegs.CP0.n.EntryLo0;
 	tlb[j].EntryLo1 = cpuRegs.CP0.n.EntryLo1;
 	WriteTLB(j);
+	vtlb_EndRemap();
 }
 
 void TLBWR() {
@@ -378,12 +382,14 @@ DevCon.Warning("COP0_TLBWR %d:%x,%x,%x,%x\n",
 
 	//if (j > 48) return;
 
+	vtlb_BeginRemap();
 	UnmapTLB(j);
 	tlb[j].PageMask = cpuRegs.CP0.n.PageMask;
 	tlb[j].EntryHi = cpuRegs.CP0.n.EntryHi;
 	tlb[j].EntryLo0 = cpuRegs.CP0.n.EntryLo0;
 	tlb[j].EntryLo1 = cpuRegs.CP0.n.EntryLo1;
 	WriteTLB(j);
+	vtlb_EndRemap();
 }
 
 void TLBP() {
@@ -161,11 +161,50 @@ namespace
 
 	static Cache cache;
 
+	static_assert(sizeof(CacheSet) == CACHE_SET_SIZE && offsetof(CacheSet, data) == CACHE_SET_DATA, "Recompiler cache lookups need updating");
+	static_assert(CacheTag::VALID_FLAG == CACHE_TAG_VALID && CacheTag::DIRTY_FLAG == CACHE_TAG_DIRTY, "Recompiler cache lookups need updating");
+
+	// Page ranges currently set in cachePages
+	static std::vector<std::pair<u32, u32>> cachePageRanges;
+
+}
+
+u8 cachePages[VTLB_VMAP_ITEMS];
+
+u8* cacheSets()
+{
+	return reinterpret_cast<u8*>(cache.sets);
+}
+
+// Marks the pages of the TLB entries in cached mode, to be called whenever the TLB is
+// written.  The entries cover [PFN, PFN + PageMask], rounded out to whole pages.
+void cacheUpdatePages()
+{
+	for (const auto& range : cachePageRanges)
+		memset(&cachePages[range.first], 0, range.second - range.first);
+	cachePageRanges.clear();
+
+	auto mark = [](u32 pfn, u32 mask)
+	{
+		const u32 start = pfn >> VTLB_PAGE_BITS;
+		const u32 end = std::min<u64>((u64)pfn + mask, 0xFFFFFFFFull) / VTLB_PAGE_SIZE + 1;
+		memset(&cachePages[start], 1, end - start);
+		cachePageRanges.emplace_back(start, end);
+	};
+
+	for (int i = 1; i < 48; i++)
+	{
+		if (((tlb[i].EntryLo1 & 0x38) >> 3) == 0x3)
+			mark(tlb[i].PFN1, tlb[i].PageMask);
+		if (((tlb[i].EntryLo0 & 0x38) >> 3) == 0x3)
+			mark(tlb[i].PFN0, tlb[i].PageMask);
+	}
 }
 
 void resetCache()
 {
 	memzero(cache);
+	cacheUpdatePages();
 }
 
 static bool findInCache(const CacheSet& set, uptr ppf, int* way)
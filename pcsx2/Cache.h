@@ -18,6 +18,19 @@
 
 #include "Common.h"
 
+// Layout of the cache sets, for the lookups inlined by the EE recompiler
+static const u32 CACHE_SET_SIZE = 192;			// two tags, then two 64 byte lines
+static const u32 CACHE_SET_DATA = 64;
+static const uptr CACHE_TAG_VALID = 0x20;
+static const uptr CACHE_TAG_DIRTY = 0x40;
+static const uptr CACHE_TAG_MATCH = ~(uptr)0xFFF | CACHE_TAG_VALID;
+
+// Non-zero for the virtual pages mapped by a TLB entry in cached mode
+extern u8 cachePages[];
+
+extern u8* cacheSets();
+void cacheUpdatePages();
+
 void resetCache();
 void writeCache8(u32 mem, u8 value);
 void writeCache16(u32 mem, u16 value);
@@ -54,6 +54,7 @@ enum SpeedhackId
 
 	Speedhack_mvuFlag = SpeedhackId_FIRST,
 	Speedhack_InstantVU1,
+	Speedhack_WaitLoop,
 
 	SpeedhackId_COUNT
 };
@@ -189,10 +190,10 @@ struct Pcsx2Config
 		BITFIELD32()
 			bool
 				Enabled:1,			// universal toggle for the profiler.
-				RecBlocks_EE:1,		// Enables per-block profiling for the EE recompiler [unimplemented]
+				RecBlocks_EE:1,		// Enables per-block profiling for the EE recompiler
 				RecBlocks_IOP:1,	// Enables per-block profiling for the IOP recompiler [unimplemented]
-				RecBlocks_VU0:1,	// Enables per-block profiling for the VU0 recompiler [unimplemented]
-				RecBlocks_VU1:1;	// Enables per-block profiling for the VU1 recompiler [unimplemented]
+				RecBlocks_VU0:1,	// Enables per-microprogram profiling for the VU0 recompiler
+				RecBlocks_VU1:1;	// Enables per-microprogram profiling for the VU1 recompiler
 		BITFIELD_END
 
 		// Default is Disabled, with all recs enabled underneath.
@@ -229,14 +230,20 @@ struct Pcsx2Config
 			bool
 				fpuOverflow		:1,
 				fpuExtraOverflow:1,
-				fpuFullMode		:1;
+				fpuFullMode		:1,
+				fpuFusedMAdd	:1;
 
 			bool
 				StackFrameChecks:1,
 				PreBlockCheckEE	:1,
 				PreBlockCheckIOP:1;
 			bool
-				EnableEECache   :1;
+				EnableEECache   :1,
+				EnableFastmem	:1,
+				SpeculateEE		:1,
+				LazySmcEE		:1,
+				RelaxEE			:1,
+				vuProgCache		:1;
 		BITFIELD_END
 
 		RecompilerOptions();
@@ -287,9 +294,22 @@ struct Pcsx2Config
 		bool	SynchronousMTGS;
 
 		int		VsyncQueueSize;
+		int		RingBufferSizeFactor; // MTGS ring of 1<<factor qwords, see RingBufferSizeFactorMin/Max
+
+		// microseconds the EE spins on the MTGS before falling back to a kernel wait (0
+		// disables spinning), and the longest the MTGS is left unsignalled while the EE
+		// batches up packets.
+		int		SpinWaitBudget;
+		int		EventLatency;
+
+		// traces input to present latency into the OSD, and per frame into the log, see InputLatency.h
+		bool		InputLatencyTrace;
+		bool		InputLatencyLog;
 
 		bool		FrameLimitEnable;
+		bool		LateLatch; // the limiter delays the start of a frame, see frameLimit()
 		bool		FrameSkipEnable;
+		bool		FrameSkipAdaptive; // skip only while the GS thread holds back the EE, FramesToDraw/Skip are unused
 		VsyncMode	VsyncEnable;
 
 		int		FramesToDraw;	// number of consecutive frames (fields) to render
@@ -309,9 +329,16 @@ struct Pcsx2Config
 			return
 				OpEqu( SynchronousMTGS )		&&
 				OpEqu( VsyncQueueSize )			&&
+				OpEqu( RingBufferSizeFactor )	&&
+				OpEqu( SpinWaitBudget )			&&
+				OpEqu( EventLatency )			&&
+				OpEqu( InputLatencyTrace )		&&
+				OpEqu( InputLatencyLog )		&&
 				
 				OpEqu( FrameSkipEnable )		&&
+				OpEqu( FrameSkipAdaptive )		&&
 				OpEqu( FrameLimitEnable )		&&
+				OpEqu( LateLatch )				&&
 				OpEqu( VsyncEnable )			&&
 
 				OpEqu( LimitScalar )			&&
@@ -383,7 +410,11 @@ struct Pcsx2Config
 				WaitLoop		:1,		// enables constant loop detection and fast-forwarding
 				vuFlagHack		:1,		// microVU specific flag hack
 				vuThread		:1,		// Enable Threaded VU1
-				vu1Instant		:1;		// Enable Instant VU1 (Without MTVU only)
+				vu1Instant		:1,		// Enable Instant VU1 (Without MTVU only)
+				threadPinning	:1,		// Pin EE/GS/VU and SW rasterizer threads to cores of one L3 domain
+				IopHLE			:1,		// Run the hot IOP library routines (sysclib memcpy/memset...) natively
+				vu0Thread		:1,		// Run VU0 micro programs on their own thread (experimental)
+				ipuThread		:1;		// Run the IPU commands on their own thread (experimental)
 		BITFIELD_END
 
 		s8	EECycleRate;		// EE cycle rate selector (1.0, 1.5, 2.0)
@@ -441,6 +472,7 @@ struct Pcsx2Config
 			CdvdVerboseReads	:1,		// enables cdvd read activity verbosely dumped to the console
 			CdvdDumpBlocks		:1,		// enables cdvd block dumping
 			CdvdShareWrite		:1,		// allows the iso to be modified while it's loaded
+			CdvdPrefetchFiles	:1,		// reads ahead the whole extent of large files when a game starts reading one
 			EnablePatches		:1,		// enables patch detection and application
 			EnableCheats		:1,		// enables cheat detection and application
 			EnableIPC		    :1,		// enables inter-process communication 
@@ -450,7 +482,19 @@ struct Pcsx2Config
 #endif
 		// when enabled uses BOOT2 injection, skipping sony bios splashes
 			UseBOOT2Injection	:1,
+		// fast boots restore the machine saved when the BIOS started EELOAD, when there is one
+			UseBootSnapshot		:1,
 			BackupSavestate		:1,
+		// saves store the EE memory pages written since a base state, kept in a separate file
+			IncrementalSavestates :1,
+		// saves copy the EE memory as the VM writes it, rather than with the VM paused
+			CopyOnWriteSavestates :1,
+		// keeps snapshots of the last few seconds in memory, to step back through
+			EnableRewind		:1,
+		// emulates frames ahead of the shown one and rolls back, to hide the game's input lag
+			EnableRunAhead		:1,
+		// backs the guest memory and the recompiler caches with huge pages where the host has them
+			UseHugePages		:1,
 		// enables simulated ejection of memory cards when loading savestates
 			McdEnableEjection	:1,
 			McdFolderAutoManage	:1,
@@ -474,6 +518,14 @@ struct Pcsx2Config
 
 	wxFileName			BiosFilename;
 
+	u32					CdvdChdCacheMB;	// decompressed CHD hunks kept in memory
+	u32					CdvdPreloadMB;	// image preloaded to memory, 0 disables the preload
+
+	u32					RewindFrames;		// vsyncs between rewind snapshots
+	u32					RewindSnapshots;	// rewind snapshots kept in memory
+	u32					RunAheadFrames;		// frames emulated ahead of the shown one
+	u32					RecordingKeyframeFrames; // frames between input recording keyframes, 0 disables them
+
 	Pcsx2Config();
 	void LoadSave( IniInterface& ini );
 
@@ -494,7 +546,13 @@ struct Pcsx2Config
 			OpEqu( Gamefixes )	&&
 			OpEqu( Profiler )	&&
 			OpEqu( Trace )		&&
-			OpEqu( BiosFilename );
+			OpEqu( BiosFilename ) &&
+			OpEqu( CdvdChdCacheMB ) &&
+			OpEqu( CdvdPreloadMB ) &&
+			OpEqu( RewindFrames ) &&
+			OpEqu( RewindSnapshots ) &&
+			OpEqu( RunAheadFrames ) &&
+			OpEqu( RecordingKeyframeFrames );
 	}
 
 	bool operator !=( const Pcsx2Config& right ) const
@@ -518,6 +576,8 @@ TraceLogFilters&				SetTraceConfig();
 // ------------ CPU / Recompiler Options ---------------
 
 #define THREAD_VU1					(EmuConfig.Cpu.Recompiler.EnableVU1 && EmuConfig.Speedhacks.vuThread)
+#define THREAD_VU0					(EmuConfig.Cpu.Recompiler.EnableEE && EmuConfig.Cpu.Recompiler.EnableVU0 && EmuConfig.Speedhacks.vu0Thread)
+#define THREAD_IPU					(EmuConfig.Speedhacks.ipuThread)
 #define INSTANT_VU1					(EmuConfig.Speedhacks.vu1Instant)
 #define CHECK_EEREC					(EmuConfig.Cpu.Recompiler.EnableEE && GetCpuProviders().IsRecAvailable_EE())
 #define CHECK_CACHE					(EmuConfig.Cpu.Recompiler.EnableEECache)
@@ -547,6 +607,7 @@ TraceLogFilters&				SetTraceConfig();
 #define CHECK_FPU_EXTRA_OVERFLOW	(EmuConfig.Cpu.Recompiler.fpuExtraOverflow) // If enabled, Operands are checked for infinities before being used in the FPU recs
 #define CHECK_FPU_EXTRA_FLAGS		1	// Always enabled now // Sets D/I flags on FPU instructions
 #define CHECK_FPU_FULL				(EmuConfig.Cpu.Recompiler.fpuFullMode)
+#define CHECK_FPU_FUSED_MADD		(EmuConfig.Cpu.Recompiler.fpuFusedMAdd) // If enabled, MADD/MSUB skip the product rounding when the FPU isn't clamped
 
 //------------ EE Recompiler defines - Comment to disable a recompiler ---------------
 
@@ -20,6 +20,7 @@
 #include <cmath>
 
 #include "App.h"
+#include "GSFrame.h"
 #include "Common.h"
 #include "R3000A.h"
 #include "Counters.h"
@@ -180,6 +181,28 @@ void rcntInit()
 static s64 m_iTicks=0;
 static u64 m_iStart=0;
 
+// How early the limiter wakes up from its sleep to spin off the rest, follows the worst
+// wakeup lateness the OS timer has shown lately.
+static s64 m_iSleepMargin = 0;
+
+// Frame pacing stats, gathered by the EE thread and reported by the MTGS thread
+static u64 m_iLastFrameEnd = 0;
+static u32 s_pacing_frames = 0;
+static double s_pacing_sum = 0;
+static double s_pacing_sumsq = 0;
+static double s_pacing_maxdev = 0;
+static u32 s_pacing_missed = 0;
+static std::atomic<float> s_pacing_mean{0};
+static std::atomic<float> s_pacing_stddev{0};
+static std::atomic<float> s_pacing_worst{0};
+static std::atomic<u32> s_pacing_missed_total{0};
+
+// Late latch, see frameLateLatchLead()
+static u64 m_iFrameBegin = 0;	// when the EE started emulating the current frame
+static s64 m_iLatchCost = 0;	// average EE emulation plus GS time of a frame
+static s64 m_iLatchDev = 0;		// and its average deviation
+static u64 m_iLastVblank = 0;
+
 struct vSyncTimingInfo
 {
 	Fixed100 Framerate;		// frames per second (8 bit fixed)
@@ -418,6 +441,51 @@ u32 UpdateVSyncRate()
 void frameLimitReset()
 {
 	m_iStart = GetCPUTicks();
+	m_iLastFrameEnd = 0;
+	m_iFrameBegin = 0;
+}
+
+// Records the time between the ends of consecutive limited frames, and publishes the
+// mean, standard deviation and worst deviation from the target once a second or so.
+static void frameLimitRecordPacing(u64 end, bool missed)
+{
+	const u64 last = m_iLastFrameEnd;
+	m_iLastFrameEnd = end;
+	if (last == 0)
+		return;
+
+	const double ms = (double)(s64)(end - last) * 1000.0 / GetTickFrequency();
+	const double target = (double)m_iTicks * 1000.0 / GetTickFrequency();
+	s_pacing_sum += ms;
+	s_pacing_sumsq += ms * ms;
+	s_pacing_maxdev = std::max(s_pacing_maxdev, std::abs(ms - target));
+	s_pacing_missed += missed;
+
+	if (++s_pacing_frames < 64)
+		return;
+
+	const double mean = s_pacing_sum / s_pacing_frames;
+	s_pacing_mean.store((float)mean, std::memory_order_relaxed);
+	s_pacing_stddev.store((float)std::sqrt(std::max(0.0, s_pacing_sumsq / s_pacing_frames - mean * mean)), std::memory_order_relaxed);
+	s_pacing_worst.store((float)s_pacing_maxdev, std::memory_order_relaxed);
+	s_pacing_missed_total.fetch_add(s_pacing_missed, std::memory_order_relaxed);
+
+	s_pacing_frames = 0;
+	s_pacing_sum = s_pacing_sumsq = s_pacing_maxdev = 0;
+	s_pacing_missed = 0;
+}
+
+void frameLimitReportPacing()
+{
+	if (!EmuConfig.GS.FrameLimitEnable)
+		return;
+
+	char value[96];
+	snprintf(value, sizeof(value), "%.2f ms, stddev %.3f ms, worst %.3f ms off, %u missed",
+		s_pacing_mean.load(std::memory_order_relaxed), s_pacing_stddev.load(std::memory_order_relaxed),
+		s_pacing_worst.load(std::memory_order_relaxed), s_pacing_missed_total.load(std::memory_order_relaxed));
+
+	GSosdMonitor("Frame pacing", value, 0xffffffff);
 }
 
 // Convenience function to update UI thread and set patches. 
@@ -427,13 +495,59 @@ static __fi void frameLimitUpdateCore()
 	Cpu->CheckExecutionState();
 }
 
+static __fi bool frameLateLatchEnabled()
+{
+	// Run-ahead changes what the vsyncs are while the limiter runs, keep their usual order
+	return EmuConfig.GS.LateLatch && !EmuConfig.EnableRunAhead;
+}
+
+// Late latch: the frame goes to the GS as soon as the EE is done with it, and the start of
+// the next one is held back instead, so that the game reads the pads as late as possible and
+// its frame is still ready to flip just before the present target. m_iStart is the present
+// target of the frame just posted; the targets follow the display vblank when the flips wait
+// for it, and the limiter's own cadence otherwise.
+//
+// Returns how long before the next present target the next frame has to start.
+static s64 frameLateLatchLead(u64 now)
+{
+	const SysMtgsThread& mtgs = GetMTGS();
+	const s64 freq = GetTickFrequency();
+
+	if (m_iFrameBegin != 0)
+	{
+		const s64 cost = (s64)(now - m_iFrameBegin) + (s64)mtgs.m_PresentTail.load(std::memory_order_relaxed) * freq / 1000000;
+		m_iLatchDev += (std::abs(cost - m_iLatchCost) - m_iLatchDev) / 8;
+		m_iLatchCost += (cost - m_iLatchCost) / 8;
+	}
+
+	// Steer the targets towards the vblank, slowly since a flip returns a little after it.
+	// Turbo and slow motion don't run at the display rate, there's nothing to follow.
+	const u64 vblank = mtgs.m_LastVblank.load(std::memory_order_relaxed);
+	if (vblank != m_iLastVblank && g_LimiterMode == Limit_Nominal)
+	{
+		m_iLastVblank = vblank;
+
+		s64 phase = (s64)(vblank - m_iStart) % m_iTicks;
+		if (phase >= m_iTicks / 2)
+			phase -= m_iTicks;
+		else if (phase < -m_iTicks / 2)
+			phase += m_iTicks;
+		m_iStart += phase / 8;
+	}
+
+	// A millisecond and twice the usual variation of safety
+	const s64 lead = m_iLatchCost + 2 * m_iLatchDev + freq / 1000;
+	return std::min(std::max(lead, (s64)0), m_iTicks);
+}
+
 // Framelimiter - Measures the delta time between calls and stalls until a
 // certain amount of time passes if such time hasn't passed yet.
 // See the GS FrameSkip function for details on why this is here and not in the GS.
 static __fi void frameLimit()
 {
 	// Framelimiter off in settings? Framelimiter go brrr.
-	if (!EmuConfig.GS.FrameLimitEnable)
+	// Frames run ahead aren't limited either: the shown frame already paces them.
+	if (!EmuConfig.GS.FrameLimitEnable || g_LimiterMode == Limit_Throughput || GetCoreThread().IsRunAheadFrame())
 	{
 		frameLimitUpdateCore();
 		return;
@@ -441,6 +555,12 @@ static __fi void frameLimit()
 
 	u64 uExpectedEnd	= m_iStart + m_iTicks;	// Compute when we would expect this frame to end, assuming everything goes perfectly perfect. 
 	u64 iEnd			= GetCPUTicks();		// The current tick we actually stopped on.
+
+	// Late latch waits for the start of the next frame instead
+	const bool lateLatch = frameLateLatchEnabled();
+	if (lateLatch)
+		uExpectedEnd -= frameLateLatchLead(iEnd);
+
 	s64 sDeltaTime		= iEnd - uExpectedEnd;	// The diff between when we stopped and when we expected to.
 
 	// If frame ran too long...
@@ -448,6 +568,8 @@ static __fi void frameLimit()
 	{
 		// ... Fudge the next frame start over a bit. Prevents fast forward zoomies.
 		m_iStart += (sDeltaTime / m_iTicks) * m_iTicks;
+		m_iFrameBegin = iEnd;
+		frameLimitRecordPacing(iEnd, true);
 		frameLimitUpdateCore();
 		return;
 	}
@@ -455,23 +577,42 @@ static __fi void frameLimit()
 	// Conversion of delta from CPU ticks (microseconds) to milliseconds
 	s32 msec = (int) ((sDeltaTime * -1000) / (s64) GetTickFrequency());
 	
-	// If any integer value of milliseconds exists, sleep it off.
-	// Prior comments suggested that 1-2 ms sleeps were inaccurate on some OSes;
-	// further testing suggests instead that this was utter bullshit. 
-	if (msec > 1)
+	// Compile ahead in the slack first, leaving the last 2ms to the sleep and spin.
+	if (msec > 2)
+		Cpu->Speculate(uExpectedEnd - GetTickFrequency() * 2 / 1000);
+
+	// Sleep on the high resolution timer until just before the deadline. The margin tracks
+	// how late the timer has woken us recently, decaying slowly so one bad wakeup doesn't
+	// cost spinning forever, and stays within 50us..2ms.
+	const s64 minMargin = GetTickFrequency() / 20000;
+	const s64 maxMargin = GetTickFrequency() / 500;
+	if (m_iSleepMargin == 0)
+		m_iSleepMargin = maxMargin / 2;
+
+	const u64 uWakeTarget = uExpectedEnd - m_iSleepMargin;
+	if ((s64)(uWakeTarget - GetCPUTicks()) > 0)
 	{
-		Threading::Sleep(msec - 1);
+		Threading::SleepUntil(uWakeTarget);
+
+		const s64 late = (s64)(GetCPUTicks() - uWakeTarget);
+		m_iSleepMargin = std::max(m_iSleepMargin - m_iSleepMargin / 64, late + late / 4);
+		m_iSleepMargin = std::min(std::max(m_iSleepMargin, minMargin), maxMargin);
 	}
-	
-	// Conversion to milliseconds loses some precision; after sleeping off whole milliseconds,
-	// spin the thread without sleeping until we finally reach our expected end time.
+
+	// Spin off whatever the sleep left until we finally reach our expected end time.
 	while (GetCPUTicks() < uExpectedEnd)
 	{
-		// SKREEEEEEEE
+		Threading::SpinWait();
 	}
 
+	m_iFrameBegin = GetCPUTicks();
+	frameLimitRecordPacing(m_iFrameBegin, sDeltaTime > 0);
+
 	// Finally, set our next frame start to when this one ends
-	m_iStart = uExpectedEnd;
+	if (lateLatch)
+		m_iStart += m_iTicks;
+	else
+		m_iStart = uExpectedEnd;
 	frameLimitUpdateCore();
 }
 
@@ -486,8 +627,17 @@ static __fi void VSyncStart(u32 sCycle)
 	}
 #endif
 
-	frameLimit(); // limit FPS
-	gsPostVsyncStart(); // MUST be after framelimit; doing so before causes funk with frame times!
+	if (frameLateLatchEnabled())
+	{
+		// The frame is done, only the start of the next one is held back
+		gsPostVsyncStart();
+		frameLimit();
+	}
+	else
+	{
+		frameLimit(); // limit FPS
+		gsPostVsyncStart(); // MUST be after framelimit; doing so before causes funk with frame times!
+	}
 
 	if(EmuConfig.Trace.Enabled && EmuConfig.Trace.EE.m_EnableAll)
 		SysTrace.EE.Counters.Write( "    ================  EE COUNTER VSYNC START (frame: %d)  ================", g_FrameCount );
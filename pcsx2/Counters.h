@@ -143,4 +143,5 @@ template< uint page > extern u16 rcntRead32( u32 mem );		// returns u16 by desig
 
 extern u32 UpdateVSyncRate();
 extern void frameLimitReset();
+extern void frameLimitReportPacing();
 
@@ -21,7 +21,6 @@
 #include <mutex>
 #include <condition_variable>
 #include "ghc/filesystem.h"
-#include <fstream>
 
 #include "DEV9/SimpleQueue.h"
 
@@ -35,7 +34,11 @@ public:
 private:
 	const bool lba48Supported = false;
 
-	std::fstream hddImage;
+#ifdef _WIN32
+	HANDLE hddImage = INVALID_HANDLE_VALUE;
+#else
+	int hddImage = -1;
+#endif
 	u64 hddImageSize;
 
 	int pioMode;
@@ -122,6 +125,9 @@ private:
 	std::atomic_bool ioClose{false};
 	bool ioWrite;
 	bool ioRead;
+	//Flush the OS cache once the write queue is empty
+	bool ioFlush = false;
+	bool flushIssued = false;
 	void (ATA::*waitingCmd)() = nullptr;
 	//Write Buffer(s)
 
@@ -200,9 +206,14 @@ private:
 	void ClearHOB();
 
 	//Transfer
+	bool HDD_IsOpen();
+	bool IO_ReadImage(u64 offset, u8* data, u32 length);
+	bool IO_WriteImage(u64 offset, const u8* data, u32 length);
+
 	void IO_Thread();
 	void IO_Read();
 	bool IO_Write();
+	void IO_Flush();
 	void HDD_ReadAsync(void (ATA::*drqCMD)());
 	void HDD_ReadSync(void (ATA::*drqCMD)());
 	bool HDD_CanAssessOrSetError();
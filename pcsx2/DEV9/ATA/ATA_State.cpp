@@ -15,6 +15,12 @@
 
 #include "PrecompiledHeader.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 #include "ATA.h"
 #include "DEV9/DEV9.h"
 #include "HddCreate.h"
@@ -44,17 +50,39 @@ int ATA::Open(ghc::filesystem::path hddPath)
 		if (hddCreator.errored)
 			return -1;
 	}
-	hddImage = ghc::filesystem::fstream(hddPath, std::ios::in | std::ios::out | std::ios::binary);
+#ifdef _WIN32
+	hddImage = CreateFileW(hddPath.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hddImage == INVALID_HANDLE_VALUE)
+	{
+		Console.Error("DEV9: ATA: Failed to open HDD image");
+		return -1;
+	}
+
+	//Store HddImage size for later check
+	LARGE_INTEGER size;
+	GetFileSizeEx(hddImage, &size);
+	hddImageSize = size.QuadPart;
+#else
+	hddImage = open(hddPath.c_str(), O_RDWR | O_CLOEXEC);
+	if (hddImage == -1)
+	{
+		Console.Error("DEV9: ATA: Failed to open HDD image");
+		return -1;
+	}
 
 	//Store HddImage size for later check
-	hddImage.seekg(0, std::ios::end);
-	hddImageSize = hddImage.tellg();
+	struct stat st;
+	fstat(hddImage, &st);
+	hddImageSize = st.st_size;
+#endif
 
 	{
 		std::lock_guard ioSignallock(ioMutex);
 		ioRead = false;
 		ioWrite = false;
+		ioFlush = false;
 	}
+	flushIssued = false;
 
 	ioThread = std::thread(&ATA::IO_Thread, this);
 	ioRunning = true;
@@ -87,8 +115,16 @@ void ATA::Close()
 	}
 
 	//Close File Handle
-	if (hddImage.is_open())
-		hddImage.close();
+	if (HDD_IsOpen())
+	{
+#ifdef _WIN32
+		CloseHandle(hddImage);
+		hddImage = INVALID_HANDLE_VALUE;
+#else
+		close(hddImage);
+		hddImage = -1;
+#endif
+	}
 
 	delete[] readBuffer;
 	readBuffer = nullptr;
@@ -281,7 +317,7 @@ void ATA::Write16(u32 addr, u16 value)
 
 void ATA::Async(uint cycles)
 {
-	if (!hddImage.is_open())
+	if (!HDD_IsOpen())
 		return;
 
 	if ((regStatus & (ATA_STAT_BUSY | ATA_STAT_DRQ)) == 0 ||
@@ -289,7 +325,7 @@ void ATA::Async(uint cycles)
 	{
 		{
 			std::lock_guard ioSignallock(ioMutex);
-			if (ioRead || ioWrite)
+			if (ioRead || ioWrite || ioFlush)
 				//IO Running
 				return;
 		}
@@ -311,10 +347,20 @@ void ATA::Async(uint cycles)
 			}
 			ioReady.notify_all();
 		}
+		else if (awaitFlush && !flushIssued) //Queue written, now flush the OS cache
+		{
+			flushIssued = true;
+			{
+				std::lock_guard ioSignallock(ioMutex);
+				ioFlush = true;
+			}
+			ioReady.notify_all();
+		}
 		else if (awaitFlush) //Fire IRQ on flush completion?
 		{
 			//Log_Info("Flush done, raise IRQ");
 			awaitFlush = false;
+			flushIssued = false;
 			PostCmdNoData();
 		}
 	}
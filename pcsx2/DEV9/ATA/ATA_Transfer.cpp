@@ -15,9 +15,75 @@
 
 #include "PrecompiledHeader.h"
 
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#endif
+
 #include "ATA.h"
 #include "DEV9/DEV9.h"
 
+bool ATA::HDD_IsOpen()
+{
+#ifdef _WIN32
+	return hddImage != INVALID_HANDLE_VALUE;
+#else
+	return hddImage != -1;
+#endif
+}
+
+//Positional reads/writes, so there is no shared file position to seek,
+//and data goes straight to the OS cache without a stream buffer inbetween
+bool ATA::IO_ReadImage(u64 offset, u8* data, u32 length)
+{
+	while (length > 0)
+	{
+#ifdef _WIN32
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD done = 0;
+		if (!ReadFile(hddImage, data, length, &done, &overlapped) || done == 0)
+			return false;
+#else
+		const ssize_t done = pread(hddImage, data, length, offset);
+		if (done < 0 && errno == EINTR)
+			continue;
+		if (done <= 0)
+			return false;
+#endif
+		data += done;
+		offset += done;
+		length -= done;
+	}
+	return true;
+}
+
+bool ATA::IO_WriteImage(u64 offset, const u8* data, u32 length)
+{
+	while (length > 0)
+	{
+#ifdef _WIN32
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD done = 0;
+		if (!WriteFile(hddImage, data, length, &done, &overlapped) || done == 0)
+			return false;
+#else
+		const ssize_t done = pwrite(hddImage, data, length, offset);
+		if (done < 0 && errno == EINTR)
+			continue;
+		if (done <= 0)
+			return false;
+#endif
+		data += done;
+		offset += done;
+		length -= done;
+	}
+	return true;
+}
+
 void ATA::IO_Thread()
 {
 	std::unique_lock ioWaitHandle(ioMutex);
@@ -30,7 +96,7 @@ void ATA::IO_Thread()
 		ioThreadIdle_bool = true;
 		ioThreadIdle_cv.notify_all();
 
-		ioReady.wait(ioWaitHandle, [&] { return ioRead | ioWrite; });
+		ioReady.wait(ioWaitHandle, [&] { return ioRead | ioWrite | ioFlush; });
 		ioThreadIdle_bool = false;
 
 		int ioType = -1;
@@ -38,10 +104,12 @@ void ATA::IO_Thread()
 			ioType = 0;
 		else if (ioWrite)
 			ioType = 1;
+		else if (ioFlush)
+			ioType = 2;
 
 		ioWaitHandle.unlock();
 
-		//Read or Write
+		//Read, Write or Flush
 		if (ioType == 0)
 			IO_Read();
 		else if (ioType == 1)
@@ -58,6 +126,8 @@ void ATA::IO_Thread()
 				}
 			}
 		}
+		else if (ioType == 2)
+			IO_Flush();
 	}
 }
 
@@ -73,14 +143,12 @@ void ATA::IO_Read()
 	}
 
 	const u64 pos = lba * 512;
-	hddImage.seekg(pos, std::ios::beg);
-	if (hddImage.fail())
+	if (!IO_ReadImage(pos, readBuffer, nsector * 512))
 	{
 		Console.Error("DEV9: ATA: File read error");
 		pxAssert(false);
 		abort();
 	}
-	hddImage.read((char*)readBuffer, (u64)nsector * 512);
 	{
 		std::lock_guard ioSignallock(ioMutex);
 		ioRead = false;
@@ -97,19 +165,32 @@ bool ATA::IO_Write()
 		return false;
 	}
 
-	hddImage.seekp(entry.sector * 512, std::ios::beg);
-	hddImage.write((char*)entry.data, entry.length);
-	if (hddImage.fail())
+	if (!IO_WriteImage(entry.sector * 512, entry.data, entry.length))
 	{
 		Console.Error("DEV9: ATA: File write error");
 		pxAssert(false);
 		abort();
 	}
-	hddImage.flush();
 	delete[] entry.data;
 	return true;
 }
 
+void ATA::IO_Flush()
+{
+#ifdef _WIN32
+	const bool flushed = FlushFileBuffers(hddImage);
+#elif defined(__linux__)
+	const bool flushed = fdatasync(hddImage) == 0;
+#else
+	const bool flushed = fsync(hddImage) == 0;
+#endif
+	if (!flushed)
+		Console.Error("DEV9: ATA: File flush error");
+
+	std::lock_guard ioSignallock(ioMutex);
+	ioFlush = false;
+}
+
 void ATA::HDD_ReadAsync(void (ATA::*drqCMD)())
 {
 	nsectorLeft = 0;
@@ -16,6 +16,9 @@
 #include "PrecompiledHeader.h"
 
 #include <fstream>
+#ifdef _WIN32
+#include <winioctl.h>
+#endif
 #include "HddCreate.h"
 
 void HddCreate::Start()
@@ -72,9 +75,6 @@ void HddCreate::Start()
 
 void HddCreate::WriteImage(ghc::filesystem::path hddPath, int reqSizeMiB)
 {
-	constexpr int buffsize = 4 * 1024;
-	u8 buff[buffsize] = {0}; //4kb
-
 	if (ghc::filesystem::exists(hddPath))
 	{
 		SetError();
@@ -89,53 +89,31 @@ void HddCreate::WriteImage(ghc::filesystem::path hddPath, int reqSizeMiB)
 		return;
 	}
 
-	//Size file
-	newImage.seekp(((u64)reqSizeMiB) * 1024 * 1024 - 1, std::ios::beg);
-	const char zero = 0;
-	newImage.write(&zero, 1);
+	newImage.close();
 
-	if (newImage.fail())
+#ifdef _WIN32
+	//Without the sparse flag, NTFS zero fills the file up to wherever the guest first writes
+	HANDLE hFile = CreateFileW(hddPath.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile != INVALID_HANDLE_VALUE)
+	{
+		DWORD bytesReturned;
+		if (!DeviceIoControl(hFile, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &bytesReturned, nullptr))
+			Console.Warning("DEV9: Failed to mark HDD file as sparse");
+		CloseHandle(hFile);
+	}
+#endif
+
+	//Size file, unwritten space reads as zero and isn't allocated until written
+	std::error_code ec;
+	ghc::filesystem::resize_file(hddPath, ((u64)reqSizeMiB) * 1024 * 1024, ec);
+	if (ec)
 	{
-		newImage.close();
 		ghc::filesystem::remove(filePath);
 		SetError();
 		return;
 	}
 
-	lastUpdate = std::chrono::steady_clock::now();
-
-	newImage.seekp(0, std::ios::beg);
-
-	for (int iMiB = 0; iMiB < reqSizeMiB; iMiB++)
-	{
-		for (int i4kb = 0; i4kb < 256; i4kb++)
-		{
-			newImage.write((char*)buff, buffsize);
-			if (newImage.fail())
-			{
-				newImage.close();
-				ghc::filesystem::remove(filePath);
-				SetError();
-				return;
-			}
-		}
-
-		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate).count() >= 100 || (iMiB + 1) == neededSize)
-		{
-			lastUpdate = now;
-			SetFileProgress(iMiB + 1);
-		}
-		if (canceled.load())
-		{
-			newImage.close();
-			ghc::filesystem::remove(filePath);
-			SetError();
-			return;
-		}
-	}
-	newImage.flush();
-	newImage.close();
+	SetFileProgress(reqSizeMiB);
 }
 
 void HddCreate::SetFileProgress(int currentSize)
@@ -44,6 +44,7 @@
 
 void rx_process(NetPacket* pk);
 bool rx_fifo_can_rx();
+int rx_fifo_free_frames();
 
 #define ETH_DEF "eth0"
 #ifdef _WIN32
@@ -52,6 +53,8 @@ bool rx_fifo_can_rx();
 #define HDD_DEF "DEV9hdd.raw"
 #endif
 
+#define RX_INTR_DELAY_DEF 50
+
 #define HDD_MIN_GB 40
 #define HDD_MAX_GB 120
 
@@ -78,6 +81,9 @@ struct Config
 
 	int hddEnable;
 	int ethEnable;
+
+	//How long RXEND may be held back to cover further frames, in microseconds, 0 raises it for every poll with new frames
+	int RxIntrDelay = RX_INTR_DELAY_DEF;
 };
 
 EXTERN Config config;
@@ -42,9 +42,9 @@ namespace InternalServers
 	}
 
 #ifdef _WIN32
-	void DHCP_Server::Init(PIP_ADAPTER_ADDRESSES adapter)
+	void DHCP_Server::Init(PIP_ADAPTER_ADDRESSES adapter, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #elif defined(__POSIX__)
-	void DHCP_Server::Init(ifaddrs* adapter)
+	void DHCP_Server::Init(ifaddrs* adapter, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #endif
 	{
 		ps2IP = config.PS2IP;
@@ -64,6 +64,13 @@ namespace InternalServers
 		else
 			gateway = config.Gateway;
 
+		if (ipOverride.integer != 0)
+			ps2IP = ipOverride;
+		if (netmaskOverride.integer != 0)
+			netmask = netmaskOverride;
+		if (gatewayOverride.integer != 0)
+			gateway = gatewayOverride;
+
 		if (!config.AutoDNS1)
 			dns1 = config.DNS1;
 
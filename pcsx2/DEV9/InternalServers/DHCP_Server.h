@@ -52,10 +52,11 @@ namespace InternalServers
 	public:
 		DHCP_Server(std::function<void()> receivedcallback);
 
+		//Non zero overrides replace the configured/auto detected values
 #ifdef _WIN32
-		void Init(PIP_ADAPTER_ADDRESSES adapter);
+		void Init(PIP_ADAPTER_ADDRESSES adapter, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
 #elif defined(__POSIX__)
-		void Init(ifaddrs* adapter);
+		void Init(ifaddrs* adapter, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
 #endif
 
 		PacketReader::IP::UDP::UDP_Packet* Recv();
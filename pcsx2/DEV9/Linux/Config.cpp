@@ -104,6 +104,10 @@ void SaveConf()
 	sprintf(buff, "%d", config.hddEnable);
 	xmlNewChild(root_node, NULL, BAD_CAST "hddEnable",
 				BAD_CAST buff);
+
+	sprintf(buff, "%d", config.RxIntrDelay);
+	xmlNewChild(root_node, NULL, BAD_CAST "RxIntrDelay",
+				BAD_CAST buff);
 	/*
      * Dumping document to stdio or file
      */
@@ -135,6 +139,7 @@ void LoadConf()
 
 	memset(&config, 0, sizeof(config));
 	config.EthApi = NetApi::PCAP_Switched;
+	config.RxIntrDelay = RX_INTR_DELAY_DEF;
 
 	// Read the files
 	xmlDoc* doc = NULL;
@@ -216,6 +221,10 @@ void LoadConf()
 			{
 				config.hddEnable = atoi((const char*)xmlNodeGetContent(cur_node));
 			}
+			if (0 == strcmp((const char*)cur_node->name, "RxIntrDelay"))
+			{
+				config.RxIntrDelay = atoi((const char*)xmlNodeGetContent(cur_node));
+			}
 		}
 	}
 
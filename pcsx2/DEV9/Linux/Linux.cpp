@@ -34,6 +34,7 @@
 #include "DEV9/DEV9.h"
 #include "pcap.h"
 #include "DEV9/pcap_io.h"
+#include "DEV9/sockets.h"
 #include "DEV9/net.h"
 #include "DEV9/PacketReader/IP/IP_Address.h"
 #include "AppCoreThread.h"
@@ -152,6 +153,8 @@ void OnInitDialog()
 	gtk_combo_box_text_append_text((GtkComboBoxText*)gtk_builder_get_object(builder, "IDC_BAYTYPE"), "PC Card");
 
 	adapters = PCAPAdapter::GetAdapters();
+	std::vector<AdapterEntry> socketAdapters = SocketAdapter::GetAdapters();
+	adapters.insert(adapters.end(), socketAdapters.begin(), socketAdapters.end());
 
 	for (size_t i = 0; i < adapters.size(); i++)
 	{
@@ -0,0 +1,289 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include "PacketRing.h"
+
+// 32 blocks of 128KB, which the kernel hands over once full or after RxBlockTimeout
+static const u32 RxBlockSize = 1 << 17;
+static const u32 RxBlockCount = 32;
+static const u32 RxBlockTimeout = 1; // ms
+// 256 frames, each large enough for a full ethernet frame plus the packet header
+static const u32 TxBlockSize = 1 << 16;
+static const u32 TxBlockCount = 8;
+static const u32 FrameSize = 2048;
+
+PacketRing::~PacketRing()
+{
+	Close();
+}
+
+bool PacketRing::Open(const char* adapter, bool promiscuous, const void* filter, unsigned short filterLength)
+{
+	const unsigned int ifindex = if_nametoindex(adapter);
+	if (ifindex == 0)
+	{
+		Console.Error("DEV9: Packet ring: Unknown adapter %s", adapter);
+		return false;
+	}
+
+	// protocol 0 doesn't receive anything until the socket is bound below, so no unfiltered packets end up in the ring
+	m_fd = socket(AF_PACKET, SOCK_RAW, 0);
+	if (m_fd < 0)
+	{
+		Console.Error("DEV9: Packet ring: Failed to open socket: %s", strerror(errno));
+		return false;
+	}
+
+	int version = TPACKET_V3;
+	if (setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0)
+	{
+		Console.Error("DEV9: Packet ring: TPACKET_V3 not supported: %s", strerror(errno));
+		Close();
+		return false;
+	}
+
+	m_rxReq.tp_block_size = RxBlockSize;
+	m_rxReq.tp_block_nr = RxBlockCount;
+	m_rxReq.tp_frame_size = FrameSize;
+	m_rxReq.tp_frame_nr = (RxBlockSize / FrameSize) * RxBlockCount;
+	m_rxReq.tp_retire_blk_tov = RxBlockTimeout;
+	if (setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &m_rxReq, sizeof(m_rxReq)) != 0)
+	{
+		Console.Error("DEV9: Packet ring: Failed to set up rx ring: %s", strerror(errno));
+		Close();
+		return false;
+	}
+
+	// tx rings need TPACKET_V3 support for them, which only newer kernels have
+	m_txReq.tp_block_size = TxBlockSize;
+	m_txReq.tp_block_nr = TxBlockCount;
+	m_txReq.tp_frame_size = FrameSize;
+	m_txReq.tp_frame_nr = (TxBlockSize / FrameSize) * TxBlockCount;
+	if (setsockopt(m_fd, SOL_PACKET, PACKET_TX_RING, &m_txReq, sizeof(m_txReq)) != 0)
+	{
+		DevCon.Warning("DEV9: Packet ring: No tx ring, sending through the socket: %s", strerror(errno));
+		m_txReq = {};
+	}
+
+	const size_t rxSize = static_cast<size_t>(m_rxReq.tp_block_size) * m_rxReq.tp_block_nr;
+	const size_t txSize = static_cast<size_t>(m_txReq.tp_block_size) * m_txReq.tp_block_nr;
+	m_mapSize = rxSize + txSize;
+	void* map = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (map == MAP_FAILED)
+	{
+		Console.Error("DEV9: Packet ring: Failed to map rings: %s", strerror(errno));
+		m_mapSize = 0;
+		Close();
+		return false;
+	}
+	m_map = static_cast<u8*>(map);
+	m_txRing = txSize ? m_map + rxSize : nullptr;
+
+	if (filter != nullptr)
+	{
+		sock_fprog prog;
+		prog.len = filterLength;
+		prog.filter = static_cast<sock_filter*>(const_cast<void*>(filter));
+		if (setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) != 0)
+		{
+			Console.Error("DEV9: Packet ring: Failed to attach filter: %s", strerror(errno));
+			Close();
+			return false;
+		}
+	}
+
+	if (promiscuous)
+	{
+		packet_mreq mreq = {};
+		mreq.mr_ifindex = ifindex;
+		mreq.mr_type = PACKET_MR_PROMISC;
+		if (setsockopt(m_fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0)
+			Console.Warning("DEV9: Packet ring: Failed to enable promiscuous mode: %s", strerror(errno));
+	}
+
+	sockaddr_ll addr = {};
+	addr.sll_family = AF_PACKET;
+	addr.sll_protocol = htons(ETH_P_ALL);
+	addr.sll_ifindex = ifindex;
+	if (bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+	{
+		Console.Error("DEV9: Packet ring: Failed to bind to %s: %s", adapter, strerror(errno));
+		Close();
+		return false;
+	}
+
+	m_statsTime = std::chrono::steady_clock::now();
+	return true;
+}
+
+void PacketRing::Close()
+{
+	if (m_map)
+		munmap(m_map, m_mapSize);
+	if (m_fd >= 0)
+		close(m_fd);
+
+	m_fd = -1;
+	m_map = nullptr;
+	m_mapSize = 0;
+	m_rxBlock = 0;
+	m_rxCurrent = nullptr;
+	m_rxNext = nullptr;
+	m_rxRemaining = 0;
+	m_txRing = nullptr;
+	m_txFrame = 0;
+}
+
+int PacketRing::Recv(void* buffer, int maxLength, int timeoutMs)
+{
+	UpdateStats();
+
+	if (m_rxRemaining == 0)
+	{
+		tpacket_block_desc* block = reinterpret_cast<tpacket_block_desc*>(m_map + m_rxBlock * m_rxReq.tp_block_size);
+		if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+		{
+			pollfd pfd = {m_fd, POLLIN | POLLERR, 0};
+			poll(&pfd, 1, timeoutMs);
+			if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0)
+				return -1;
+		}
+
+		m_rxCurrent = block;
+		m_rxRemaining = block->hdr.bh1.num_pkts;
+		m_rxNext = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<u8*>(block) + block->hdr.bh1.offset_to_first_pkt);
+		if (m_rxRemaining == 0)
+		{
+			ReleaseBlock();
+			return -1;
+		}
+	}
+
+	tpacket3_hdr* hdr = m_rxNext;
+	m_rxNext = reinterpret_cast<tpacket3_hdr*>(reinterpret_cast<u8*>(hdr) + hdr->tp_next_offset);
+	m_rxRemaining--;
+
+	const int length = hdr->tp_snaplen;
+	const bool fits = length <= maxLength;
+	if (fits)
+		memcpy(buffer, reinterpret_cast<u8*>(hdr) + hdr->tp_mac, length);
+
+	// the whole block goes back to the kernel once its last frame has been read
+	if (m_rxRemaining == 0)
+		ReleaseBlock();
+
+	if (!fits)
+	{
+		m_dropCount++;
+		return -1;
+	}
+
+	m_rxCount++;
+	return length;
+}
+
+bool PacketRing::Send(const void* buffer, int length)
+{
+	if (m_txRing == nullptr)
+	{
+		if (send(m_fd, buffer, length, 0) != length)
+		{
+			m_dropCount++;
+			return false;
+		}
+		m_txCount++;
+		return true;
+	}
+
+	const u32 framesPerBlock = m_txReq.tp_block_size / m_txReq.tp_frame_size;
+	u8* frame = m_txRing + (m_txFrame / framesPerBlock) * m_txReq.tp_block_size + (m_txFrame % framesPerBlock) * m_txReq.tp_frame_size;
+	tpacket3_hdr* hdr = reinterpret_cast<tpacket3_hdr*>(frame);
+	const u32 dataOffset = TPACKET3_HDRLEN - sizeof(sockaddr_ll);
+
+	const u32 status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+	if (status == TP_STATUS_WRONG_FORMAT)
+		Console.Error("DEV9: Packet ring: Kernel rejected a sent frame");
+	else if (status != TP_STATUS_AVAILABLE)
+	{
+		// the kernel is still busy with all frames in the ring
+		m_dropCount++;
+		return false;
+	}
+
+	if (static_cast<u32>(length) > m_txReq.tp_frame_size - dataOffset)
+	{
+		m_dropCount++;
+		return false;
+	}
+
+	memcpy(frame + dataOffset, buffer, length);
+	hdr->tp_len = length;
+	hdr->tp_snaplen = length;
+	hdr->tp_next_offset = 0;
+	__atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+	m_txFrame = (m_txFrame + 1) % m_txReq.tp_frame_nr;
+
+	// kick off sending of all queued frames without waiting for it to finish
+	if (send(m_fd, nullptr, 0, MSG_DONTWAIT) < 0 && errno != EAGAIN && errno != ENOBUFS)
+		DevCon.Warning("DEV9: Packet ring: send() failed: %s", strerror(errno));
+
+	m_txCount++;
+	return true;
+}
+
+void PacketRing::ReleaseBlock()
+{
+	__atomic_store_n(&m_rxCurrent->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+	m_rxCurrent = nullptr;
+	m_rxNext = nullptr;
+	m_rxBlock = (m_rxBlock + 1) % m_rxReq.tp_block_nr;
+}
+
+void PacketRing::UpdateStats()
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (now - m_statsTime < std::chrono::seconds(1))
+		return;
+	m_statsTime = now;
+
+	// reading the statistics resets them
+	tpacket_stats_v3 stats = {};
+	socklen_t statsSize = sizeof(stats);
+	if (getsockopt(m_fd, SOL_PACKET, PACKET_STATISTICS, &stats, &statsSize) == 0)
+		m_dropCount += stats.tp_drops;
+
+	const u32 tx = m_txCount.exchange(0);
+	const u32 drops = m_dropCount.exchange(0);
+	if (m_rxCount || tx || drops)
+		DevCon.WriteLn("DEV9: Packet ring: rx %u tx %u drop %u per second", m_rxCount, tx, drops);
+	m_rxCount = 0;
+}
+
+#endif
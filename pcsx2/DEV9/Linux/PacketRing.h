@@ -0,0 +1,73 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#ifdef __linux__
+
+#include <atomic>
+#include <chrono>
+#include <linux/if_packet.h>
+
+// Raw AF_PACKET socket with TPACKET_V3 rx and tx rings mapped into our address space.
+// Received frames are consumed straight out of the ring a block at a time, and sent
+// frames are placed into the tx ring, which saves the per packet trip through pcap.
+class PacketRing
+{
+public:
+	PacketRing() = default;
+	~PacketRing();
+
+	PacketRing(const PacketRing&) = delete;
+	PacketRing& operator=(const PacketRing&) = delete;
+
+	// filter is optional and must consist of filterLength classic BPF instructions, as produced by pcap_compile().
+	// returns false if the socket or the rx ring couldn't be set up, the tx ring is optional
+	bool Open(const char* adapter, bool promiscuous, const void* filter, unsigned short filterLength);
+	void Close();
+
+	// copies the next received frame into buffer, waiting up to timeoutMs for one to arrive.
+	// returns the frame length, or -1 if none arrived or it didn't fit into maxLength
+	int Recv(void* buffer, int maxLength, int timeoutMs);
+	// returns false if the frame couldn't be queued
+	bool Send(const void* buffer, int length);
+
+private:
+	void ReleaseBlock();
+	void UpdateStats();
+
+	int m_fd = -1;
+	u8* m_map = nullptr;
+	size_t m_mapSize = 0;
+
+	tpacket_req3 m_rxReq = {};
+	u32 m_rxBlock = 0;
+	// the block currently being read, and the next frame in it
+	tpacket_block_desc* m_rxCurrent = nullptr;
+	tpacket3_hdr* m_rxNext = nullptr;
+	u32 m_rxRemaining = 0;
+
+	tpacket_req3 m_txReq = {};
+	u8* m_txRing = nullptr;
+	u32 m_txFrame = 0;
+
+	// per second counters, reported to the dev console
+	u32 m_rxCount = 0;
+	std::atomic<u32> m_txCount{0};
+	std::atomic<u32> m_dropCount{0};
+	std::chrono::steady_clock::time_point m_statsTime;
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <atomic>
+
+#include "net.h"
+
+//Preallocated ring of packet slots, for handing frames from one thread to another without locking or allocating.
+//Frames are built and read in place, and any number of slots can be published or released at once.
+//Only one thread may produce and one thread may consume at any time.
+template <size_t Size>
+class PacketQueue
+{
+	static_assert((Size & (Size - 1)) == 0, "PacketQueue size must be a power of 2");
+
+private:
+	NetPacket slots[Size];
+
+	//Only ever increase, the slot is the index modulo Size
+	alignas(64) std::atomic<size_t> writeIndex{0};
+	alignas(64) std::atomic<size_t> readIndex{0};
+
+public:
+	//Used by the producer thread
+	size_t WriteAvailable() const
+	{
+		return Size - (writeIndex.load(std::memory_order_relaxed) - readIndex.load(std::memory_order_acquire));
+	}
+	//Slot index places past the write position, index must be less than WriteAvailable()
+	NetPacket* WriteSlot(size_t index = 0)
+	{
+		return &slots[(writeIndex.load(std::memory_order_relaxed) + index) & (Size - 1)];
+	}
+	//Makes the next count slots visible to the consumer
+	void Push(size_t count = 1)
+	{
+		writeIndex.store(writeIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	//Used by the consumer thread
+	size_t ReadAvailable() const
+	{
+		return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed);
+	}
+	//Slot index places past the read position, index must be less than ReadAvailable()
+	NetPacket* ReadSlot(size_t index = 0)
+	{
+		return &slots[(readIndex.load(std::memory_order_relaxed) + index) & (Size - 1)];
+	}
+	//Hands the next count slots back to the producer
+	void Pop(size_t count = 1)
+	{
+		readIndex.store(readIndex.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+};
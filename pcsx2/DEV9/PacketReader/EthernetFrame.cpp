@@ -58,4 +58,12 @@ namespace PacketReader
 		//
 		payload->WriteBytes((u8*)pkt->buffer, &counter);
 	}
+
+	int EthernetFrameView::WriteHeader(u8* buffer, const u8* destinationMAC, const u8* sourceMAC, u16 protocol)
+	{
+		memcpy(buffer, destinationMAC, 6);
+		memcpy(&buffer[6], sourceMAC, 6);
+		NetLib::PokeUInt16(&buffer[12], protocol);
+		return headerLength;
+	}
 } // namespace PacketReader
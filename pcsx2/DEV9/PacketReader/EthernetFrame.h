@@ -17,6 +17,7 @@
 
 #include "DEV9/net.h"
 #include "Payload.h"
+#include "NetLib.h"
 
 namespace PacketReader
 {
@@ -52,4 +53,39 @@ namespace PacketReader
 
 		void WritePacket(NetPacket* pkt);
 	};
+
+	//Reads the header straight out of the packet buffer, without copying or allocating
+	class EthernetFrameView
+	{
+	public:
+		static const int headerLength = 14;
+
+	private:
+		u8* data;
+		int length;
+
+	public:
+		EthernetFrameView(u8* buffer, int bufferSize)
+			: data{buffer}
+			, length{bufferSize}
+		{
+		}
+		EthernetFrameView(NetPacket* pkt)
+			: data{(u8*)pkt->buffer}
+			, length{pkt->size}
+		{
+		}
+
+		bool IsValid() const { return length >= headerLength; }
+
+		u8* GetDestinationMAC() { return data; }
+		u8* GetSourceMAC() { return &data[6]; }
+		u16 GetProtocol() const { return NetLib::PeekUInt16(&data[12]); }
+
+		u8* GetPayload() { return &data[headerLength]; }
+		int GetPayloadLength() const { return length - headerLength; }
+
+		//Returns the header length, the payload goes after it
+		static int WriteHeader(u8* buffer, const u8* destinationMAC, const u8* sourceMAC, u16 protocol);
+	};
 } // namespace PacketReader
@@ -305,4 +305,64 @@ namespace PacketReader::IP
 		sum = sum & 0xFFFF;
 		return (u16)sum;
 	}
+
+	bool IP_PacketView::IsValid() const
+	{
+		if (length < minHeaderLength || (data[0] >> 4) != 4)
+			return false;
+
+		const int headerLength = GetHeaderLength();
+		const int totalLength = GetTotalLength();
+		return headerLength >= minHeaderLength && headerLength <= totalLength && totalLength <= length;
+	}
+
+	bool IP_PacketView::VerifyChecksum() const
+	{
+		return ChecksumFinish(ChecksumAdd(0, data, GetHeaderLength())) == 0;
+	}
+
+	int IP_PacketView::WriteHeader(u8* buffer, u8 protocol, IP_Address srcIP, IP_Address dstIP, int payloadLength, u8 timeToLive)
+	{
+		buffer[0] = (4 << 4) | (minHeaderLength >> 2);
+		buffer[1] = 0; //DSCP/ECN
+		NetLib::PokeUInt16(&buffer[2], (u16)(minHeaderLength + payloadLength));
+		NetLib::PokeUInt32(&buffer[4], 0); //ID & fragment flags
+		buffer[8] = timeToLive;
+		buffer[9] = protocol;
+		NetLib::PokeUInt16(&buffer[10], 0);
+		memcpy(&buffer[12], &srcIP, 4);
+		memcpy(&buffer[16], &dstIP, 4);
+		NetLib::PokeUInt16(&buffer[10], ChecksumFinish(ChecksumAdd(0, buffer, minHeaderLength)));
+		return minHeaderLength;
+	}
+
+	u32 IP_PacketView::ChecksumAdd(u32 sum, const u8* buffer, int length)
+	{
+		int i = 0;
+		for (; i + 1 < length; i += 2)
+			sum += ((u32)buffer[i] << 8) | buffer[i + 1];
+		if (i < length)
+			sum += (u32)buffer[i] << 8;
+
+		//Fold now, so long buffers can't overflow the running sum
+		return (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	u16 IP_PacketView::ChecksumFinish(u32 sum)
+	{
+		while (sum >> 16)
+			sum = (sum & 0xFFFF) + (sum >> 16);
+		return (u16)~sum;
+	}
+
+	u32 IP_PacketView::PseudoHeaderSum(IP_Address srcIP, IP_Address dstIP, u8 protocol, int length)
+	{
+		u8 pseudoHeader[12];
+		memcpy(&pseudoHeader[0], &srcIP, 4);
+		memcpy(&pseudoHeader[4], &dstIP, 4);
+		pseudoHeader[8] = 0;
+		pseudoHeader[9] = protocol;
+		NetLib::PokeUInt16(&pseudoHeader[10], (u16)length);
+		return ChecksumAdd(0, pseudoHeader, sizeof(pseudoHeader));
+	}
 } // namespace PacketReader::IP
@@ -16,6 +16,7 @@
 #pragma once
 #include <vector>
 
+#include "DEV9/PacketReader/NetLib.h"
 #include "DEV9/PacketReader/Payload.h"
 #include "IP_Address.h"
 #include "IP_Options.h"
@@ -137,4 +138,60 @@ namespace PacketReader::IP
 		void ReComputeHeaderLen();
 		void CalculateChecksum();
 	};
+
+	//Reads the header straight out of the packet buffer, without copying or allocating
+	//Only IsValid() may be called before IsValid() returned true
+	class IP_PacketView
+	{
+	public:
+		static const int minHeaderLength = 20;
+
+	private:
+		u8* data;
+		int length;
+
+	public:
+		IP_PacketView(u8* buffer, int bufferSize)
+			: data{buffer}
+			, length{bufferSize}
+		{
+		}
+
+		//Checks the version, and that the header and total lengths fit the buffer
+		bool IsValid() const;
+
+		int GetHeaderLength() const { return (data[0] & 0xF) << 2; }
+		int GetTotalLength() const { return NetLib::PeekUInt16(&data[2]); }
+		bool GetMoreFragments() const { return (data[6] & (1 << 5)) != 0; }
+		u16 GetFragmentOffset() const { return NetLib::PeekUInt16(&data[6]) & 0x1FFF; }
+		u8 GetTimeToLive() const { return data[8]; }
+		u8 GetProtocol() const { return data[9]; }
+		IP_Address GetSourceIP() const
+		{
+			IP_Address ip;
+			memcpy(&ip, &data[12], 4);
+			return ip;
+		}
+		IP_Address GetDestinationIP() const
+		{
+			IP_Address ip;
+			memcpy(&ip, &data[16], 4);
+			return ip;
+		}
+
+		//Excludes any padding after the packet in the buffer
+		u8* GetPayload() { return &data[GetHeaderLength()]; }
+		int GetPayloadLength() const { return GetTotalLength() - GetHeaderLength(); }
+
+		bool VerifyChecksum() const;
+
+		//Writes a header without options and returns its length, the payload goes after it
+		static int WriteHeader(u8* buffer, u8 protocol, IP_Address srcIP, IP_Address dstIP, int payloadLength, u8 timeToLive = 64);
+
+		//Ones' complement sum, a running sum can be carried over buffers, all but the last one must have an even length
+		static u32 ChecksumAdd(u32 sum, const u8* buffer, int length);
+		static u16 ChecksumFinish(u32 sum);
+		//Start of the TCP and UDP checksums
+		static u32 PseudoHeaderSum(IP_Address srcIP, IP_Address dstIP, u8 protocol, int length);
+	};
 } // namespace PacketReader::IP
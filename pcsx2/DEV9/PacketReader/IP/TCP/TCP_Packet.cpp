@@ -0,0 +1,305 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#include "TCP_Packet.h"
+#include "DEV9/PacketReader/NetLib.h"
+
+namespace PacketReader::IP::TCP
+{
+	bool TCP_Packet::GetFIN()
+	{
+		return (flags & 1) != 0;
+	}
+	void TCP_Packet::SetFIN(bool value)
+	{
+		flags = (flags & ~1) | (value << 0);
+	}
+
+	bool TCP_Packet::GetSYN()
+	{
+		return (flags & (1 << 1)) != 0;
+	}
+	void TCP_Packet::SetSYN(bool value)
+	{
+		flags = (flags & ~(1 << 1)) | (value << 1);
+	}
+
+	bool TCP_Packet::GetRST()
+	{
+		return (flags & (1 << 2)) != 0;
+	}
+	void TCP_Packet::SetRST(bool value)
+	{
+		flags = (flags & ~(1 << 2)) | (value << 2);
+	}
+
+	bool TCP_Packet::GetPSH()
+	{
+		return (flags & (1 << 3)) != 0;
+	}
+	void TCP_Packet::SetPSH(bool value)
+	{
+		flags = (flags & ~(1 << 3)) | (value << 3);
+	}
+
+	bool TCP_Packet::GetACK()
+	{
+		return (flags & (1 << 4)) != 0;
+	}
+	void TCP_Packet::SetACK(bool value)
+	{
+		flags = (flags & ~(1 << 4)) | (value << 4);
+	}
+
+	bool TCP_Packet::GetURG()
+	{
+		return (flags & (1 << 5)) != 0;
+	}
+	void TCP_Packet::SetURG(bool value)
+	{
+		flags = (flags & ~(1 << 5)) | (value << 5);
+	}
+
+	TCP_Packet::TCP_Packet(Payload* data)
+		: payload{data}
+	{
+	}
+	TCP_Packet::TCP_Packet(u8* buffer, int bufferSize)
+	{
+		int offset = 0;
+		//Bits 0-31
+		NetLib::ReadUInt16(buffer, &offset, &sourcePort);
+		NetLib::ReadUInt16(buffer, &offset, &destinationPort);
+
+		//Bits 32-95
+		NetLib::ReadUInt32(buffer, &offset, &sequenceNumber);
+		NetLib::ReadUInt32(buffer, &offset, &acknowledgementNumber);
+
+		//Bits 96-127
+		u8 dataOffset;
+		NetLib::ReadByte08(buffer, &offset, &dataOffset);
+		headerLength = (dataOffset >> 4) << 2;
+		NetLib::ReadByte08(buffer, &offset, &flags);
+		NetLib::ReadUInt16(buffer, &offset, &windowSize);
+
+		//Bits 128-159
+		NetLib::ReadUInt16(buffer, &offset, &checksum);
+		NetLib::ReadUInt16(buffer, &offset, &urgentPointer);
+
+		if (headerLength < 20 || headerLength > bufferSize)
+		{
+			Console.Error("DEV9: TCP_Packet: Unexpected Header Length");
+			headerLength = std::clamp(headerLength, 20, bufferSize);
+		}
+
+		//Options
+		while (offset < headerLength)
+		{
+			const u8 kind = buffer[offset];
+			if (kind == 0) //End
+				break;
+			if (kind == 1) //NOP
+			{
+				offset++;
+				continue;
+			}
+			if (offset + 1 >= headerLength)
+				break;
+
+			const u8 len = buffer[offset + 1];
+			if (len < 2 || offset + len > headerLength)
+				break;
+
+			if (kind == 2 && len == 4) //MSS
+			{
+				int mssOffset = offset + 2;
+				NetLib::ReadUInt16(buffer, &mssOffset, &maxSegmentSize);
+			}
+			offset += len;
+		}
+		offset = headerLength;
+
+		//Bits 160+
+		payload = std::make_unique<PayloadPtr>(&buffer[offset], bufferSize - offset);
+		//AllDone
+	}
+
+	Payload* TCP_Packet::GetPayload()
+	{
+		return payload.get();
+	}
+
+	int TCP_Packet::GetLength()
+	{
+		ReComputeHeaderLen();
+		return headerLength + payload->GetLength();
+	}
+
+	void TCP_Packet::WriteBytes(u8* buffer, int* offset)
+	{
+		ReComputeHeaderLen();
+
+		NetLib::WriteUInt16(buffer, offset, sourcePort);
+		NetLib::WriteUInt16(buffer, offset, destinationPort);
+		NetLib::WriteUInt32(buffer, offset, sequenceNumber);
+		NetLib::WriteUInt32(buffer, offset, acknowledgementNumber);
+		NetLib::WriteByte08(buffer, offset, (headerLength >> 2) << 4);
+		NetLib::WriteByte08(buffer, offset, flags);
+		NetLib::WriteUInt16(buffer, offset, windowSize);
+		NetLib::WriteUInt16(buffer, offset, checksum);
+		NetLib::WriteUInt16(buffer, offset, urgentPointer);
+
+		if (maxSegmentSize != 0)
+		{
+			NetLib::WriteByte08(buffer, offset, 2);
+			NetLib::WriteByte08(buffer, offset, 4);
+			NetLib::WriteUInt16(buffer, offset, maxSegmentSize);
+		}
+
+		payload->WriteBytes(buffer, offset);
+	}
+
+	u8 TCP_Packet::GetProtocol()
+	{
+		return (u8)protocol;
+	}
+
+	void TCP_Packet::ReComputeHeaderLen()
+	{
+		headerLength = 20 + (maxSegmentSize != 0 ? 4 : 0);
+	}
+
+	void TCP_Packet::CalculateChecksum(IP_Address srcIP, IP_Address dstIP)
+	{
+		int pHeaderLen = (12) + GetLength();
+		if ((pHeaderLen & 1) != 0)
+			pHeaderLen += 1;
+
+		u8* headerSegment = new u8[pHeaderLen];
+		int counter = 0;
+
+		NetLib::WriteByteArray(headerSegment, &counter, 4, (u8*)&srcIP);
+		NetLib::WriteByteArray(headerSegment, &counter, 4, (u8*)&dstIP);
+		NetLib::WriteByte08(headerSegment, &counter, 0);
+		NetLib::WriteByte08(headerSegment, &counter, (u8)protocol);
+		NetLib::WriteUInt16(headerSegment, &counter, GetLength());
+
+		//Pseudo Header added
+		//Rest of data is normal Header+data (with zerored checksum feild)
+		checksum = 0;
+		WriteBytes(headerSegment, &counter);
+
+		//Zero alignment byte
+		if (counter != pHeaderLen)
+			NetLib::WriteByte08(headerSegment, &counter, 0);
+
+		checksum = IP_Packet::InternetChecksum(headerSegment, pHeaderLen);
+		delete[] headerSegment;
+	}
+	bool TCP_Packet::VerifyChecksum(IP_Address srcIP, IP_Address dstIP)
+	{
+		int pHeaderLen = (12) + GetLength();
+		if ((pHeaderLen & 1) != 0)
+			pHeaderLen += 1;
+
+		u8* headerSegment = new u8[pHeaderLen];
+		int counter = 0;
+
+		NetLib::WriteByteArray(headerSegment, &counter, 4, (u8*)&srcIP);
+		NetLib::WriteByteArray(headerSegment, &counter, 4, (u8*)&dstIP);
+		NetLib::WriteByte08(headerSegment, &counter, 0);
+		NetLib::WriteByte08(headerSegment, &counter, (u8)protocol);
+		NetLib::WriteUInt16(headerSegment, &counter, GetLength());
+
+		//Pseudo Header added
+		//Rest of data is normal Header+data
+		WriteBytes(headerSegment, &counter);
+
+		//Zero alignment byte
+		if (counter != pHeaderLen)
+			NetLib::WriteByte08(headerSegment, &counter, 0);
+
+		u16 csumCal = IP_Packet::InternetChecksum(headerSegment, pHeaderLen);
+		delete[] headerSegment;
+
+		return (csumCal == 0);
+	}
+
+	bool TCP_PacketView::IsValid() const
+	{
+		if (length < minHeaderLength)
+			return false;
+
+		const int headerLength = GetHeaderLength();
+		return headerLength >= minHeaderLength && headerLength <= length;
+	}
+
+	u16 TCP_PacketView::GetMaxSegmentSize() const
+	{
+		const int headerLength = GetHeaderLength();
+		int offset = minHeaderLength;
+		while (offset < headerLength)
+		{
+			const u8 kind = data[offset];
+			if (kind == 0) //End
+				break;
+			if (kind == 1) //NOP
+			{
+				offset++;
+				continue;
+			}
+			if (offset + 1 >= headerLength)
+				break;
+
+			const u8 len = data[offset + 1];
+			if (len < 2 || offset + len > headerLength)
+				break;
+
+			if (kind == 2 && len == 4) //MSS
+				return NetLib::PeekUInt16(&data[offset + 2]);
+			offset += len;
+		}
+		return 0;
+	}
+
+	int TCP_PacketView::WriteHeader(u8* buffer, u16 srcPort, u16 dstPort, u32 sequenceNumber, u32 acknowledgementNumber, u8 flags, u16 windowSize,
+		u16 maxSegmentSize, IP_Address srcIP, IP_Address dstIP, int payloadLength)
+	{
+		const int headerLength = GetHeaderLength(maxSegmentSize);
+		NetLib::PokeUInt16(&buffer[0], srcPort);
+		NetLib::PokeUInt16(&buffer[2], dstPort);
+		NetLib::PokeUInt32(&buffer[4], sequenceNumber);
+		NetLib::PokeUInt32(&buffer[8], acknowledgementNumber);
+		buffer[12] = (headerLength >> 2) << 4;
+		buffer[13] = flags;
+		NetLib::PokeUInt16(&buffer[14], windowSize);
+		NetLib::PokeUInt16(&buffer[16], 0);
+		NetLib::PokeUInt16(&buffer[18], 0); //Urgent pointer
+		if (maxSegmentSize != 0)
+		{
+			buffer[20] = 2;
+			buffer[21] = 4;
+			NetLib::PokeUInt16(&buffer[22], maxSegmentSize);
+		}
+
+		const int tcpLength = headerLength + payloadLength;
+		u32 sum = IP_PacketView::PseudoHeaderSum(srcIP, dstIP, (u8)IP_Type::TCP, tcpLength);
+		sum = IP_PacketView::ChecksumAdd(sum, buffer, tcpLength);
+		NetLib::PokeUInt16(&buffer[16], IP_PacketView::ChecksumFinish(sum));
+		return headerLength;
+	}
+} // namespace PacketReader::IP::TCP
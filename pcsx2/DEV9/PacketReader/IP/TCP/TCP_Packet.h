@@ -0,0 +1,120 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "DEV9/PacketReader/IP/IP_Packet.h"
+
+namespace PacketReader::IP::TCP
+{
+	class TCP_Packet : public IP_Payload
+	{
+	public:
+		u16 sourcePort;
+		u16 destinationPort;
+		u32 sequenceNumber;
+		u32 acknowledgementNumber;
+		u16 windowSize;
+		u16 urgentPointer = 0;
+		//Only the MSS option is kept, 0 if not present
+		u16 maxSegmentSize = 0;
+
+	private:
+		int headerLength = 20;
+		u8 flags = 0;
+		u16 checksum;
+
+		const static IP_Type protocol = IP_Type::TCP;
+
+		std::unique_ptr<Payload> payload;
+
+	public:
+		bool GetFIN();
+		void SetFIN(bool value);
+		bool GetSYN();
+		void SetSYN(bool value);
+		bool GetRST();
+		void SetRST(bool value);
+		bool GetPSH();
+		void SetPSH(bool value);
+		bool GetACK();
+		void SetACK(bool value);
+		bool GetURG();
+		void SetURG(bool value);
+
+		//Takes ownership of payload
+		TCP_Packet(Payload* data);
+		TCP_Packet(u8* buffer, int bufferSize);
+
+		Payload* GetPayload();
+
+		virtual int GetLength();
+		virtual void WriteBytes(u8* buffer, int* offset);
+
+		virtual u8 GetProtocol();
+
+		virtual bool VerifyChecksum(IP_Address srcIP, IP_Address dstIP);
+		virtual void CalculateChecksum(IP_Address srcIP, IP_Address dstIP);
+
+	private:
+		void ReComputeHeaderLen();
+	};
+
+	//Reads the header straight out of the packet buffer, without copying or allocating
+	//Only IsValid() may be called before IsValid() returned true
+	class TCP_PacketView
+	{
+	public:
+		static const int minHeaderLength = 20;
+
+	private:
+		u8* data;
+		int length;
+
+	public:
+		//bufferSize has to be the segment length, as TCP has no length field of its own
+		TCP_PacketView(u8* buffer, int bufferSize)
+			: data{buffer}
+			, length{bufferSize}
+		{
+		}
+
+		//Checks the header length fits the buffer
+		bool IsValid() const;
+
+		u16 GetSourcePort() const { return NetLib::PeekUInt16(&data[0]); }
+		u16 GetDestinationPort() const { return NetLib::PeekUInt16(&data[2]); }
+		u32 GetSequenceNumber() const { return NetLib::PeekUInt32(&data[4]); }
+		u32 GetAcknowledgementNumber() const { return NetLib::PeekUInt32(&data[8]); }
+		int GetHeaderLength() const { return (data[12] >> 4) << 2; }
+		u8 GetFlags() const { return data[13]; }
+		bool GetFIN() const { return (data[13] & 1) != 0; }
+		bool GetSYN() const { return (data[13] & (1 << 1)) != 0; }
+		bool GetRST() const { return (data[13] & (1 << 2)) != 0; }
+		bool GetPSH() const { return (data[13] & (1 << 3)) != 0; }
+		bool GetACK() const { return (data[13] & (1 << 4)) != 0; }
+		u16 GetWindowSize() const { return NetLib::PeekUInt16(&data[14]); }
+		//Walks the options, 0 if there is no MSS option
+		u16 GetMaxSegmentSize() const;
+
+		u8* GetPayload() { return &data[GetHeaderLength()]; }
+		int GetPayloadLength() const { return length - GetHeaderLength(); }
+
+		//Returns the header length, 24 with a MSS option or 20 without
+		static int GetHeaderLength(u16 maxSegmentSize) { return minHeaderLength + (maxSegmentSize != 0 ? 4 : 0); }
+		//The payload has to be in place after the header, as the checksum covers it
+		static int WriteHeader(u8* buffer, u16 srcPort, u16 dstPort, u32 sequenceNumber, u32 acknowledgementNumber, u8 flags, u16 windowSize,
+			u16 maxSegmentSize, IP_Address srcIP, IP_Address dstIP, int payloadLength);
+	};
+} // namespace PacketReader::IP::TCP
@@ -127,4 +127,29 @@ namespace PacketReader::IP::UDP
 
 		return (csumCal == 0);
 	}
+
+	bool UDP_PacketView::IsValid() const
+	{
+		if (length < headerLength)
+			return false;
+
+		const int udpLength = NetLib::PeekUInt16(&data[4]);
+		return udpLength >= headerLength && udpLength <= length;
+	}
+
+	int UDP_PacketView::WriteHeader(u8* buffer, u16 srcPort, u16 dstPort, IP_Address srcIP, IP_Address dstIP, int payloadLength)
+	{
+		const int udpLength = headerLength + payloadLength;
+		NetLib::PokeUInt16(&buffer[0], srcPort);
+		NetLib::PokeUInt16(&buffer[2], dstPort);
+		NetLib::PokeUInt16(&buffer[4], (u16)udpLength);
+		NetLib::PokeUInt16(&buffer[6], 0);
+
+		u32 sum = IP_PacketView::PseudoHeaderSum(srcIP, dstIP, (u8)IP_Type::UDP, udpLength);
+		sum = IP_PacketView::ChecksumAdd(sum, buffer, udpLength);
+		const u16 checksum = IP_PacketView::ChecksumFinish(sum);
+		//Zero means no checksum was computed
+		NetLib::PokeUInt16(&buffer[6], checksum == 0 ? 0xFFFF : checksum);
+		return headerLength;
+	}
 } // namespace PacketReader::IP::UDP
@@ -48,4 +48,35 @@ namespace PacketReader::IP::UDP
 		virtual bool VerifyChecksum(IP_Address srcIP, IP_Address dstIP);
 		virtual void CalculateChecksum(IP_Address srcIP, IP_Address dstIP);
 	};
+
+	//Reads the header straight out of the packet buffer, without copying or allocating
+	//Only IsValid() may be called before IsValid() returned true
+	class UDP_PacketView
+	{
+	public:
+		static const int headerLength = 8;
+
+	private:
+		u8* data;
+		int length;
+
+	public:
+		UDP_PacketView(u8* buffer, int bufferSize)
+			: data{buffer}
+			, length{bufferSize}
+		{
+		}
+
+		//Checks the length field fits the buffer
+		bool IsValid() const;
+
+		u16 GetSourcePort() const { return NetLib::PeekUInt16(&data[0]); }
+		u16 GetDestinationPort() const { return NetLib::PeekUInt16(&data[2]); }
+
+		u8* GetPayload() { return &data[headerLength]; }
+		int GetPayloadLength() const { return NetLib::PeekUInt16(&data[4]) - headerLength; }
+
+		//The payload has to be in place after the header, as the checksum covers it
+		static int WriteHeader(u8* buffer, u16 srcPort, u16 dstPort, IP_Address srcIP, IP_Address dstIP, int payloadLength);
+	};
 } // namespace PacketReader::IP::UDP
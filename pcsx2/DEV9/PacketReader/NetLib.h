@@ -28,4 +28,26 @@ namespace PacketReader::NetLib
 	void ReadUInt32(u8* data, int* index, u32* value);
 
 	void ReadByteArray(u8* data, int* index, int length, u8* value);
+
+	//Fixed position access in network byte order, for the views that work on packets in place
+	inline u16 PeekUInt16(const u8* data)
+	{
+		return (u16)((data[0] << 8) | data[1]);
+	}
+	inline u32 PeekUInt32(const u8* data)
+	{
+		return ((u32)data[0] << 24) | ((u32)data[1] << 16) | ((u32)data[2] << 8) | data[3];
+	}
+	inline void PokeUInt16(u8* data, u16 value)
+	{
+		data[0] = (u8)(value >> 8);
+		data[1] = (u8)value;
+	}
+	inline void PokeUInt32(u8* data, u32 value)
+	{
+		data[0] = (u8)(value >> 24);
+		data[1] = (u8)(value >> 16);
+		data[2] = (u8)(value >> 8);
+		data[3] = (u8)value;
+	}
 } // namespace PacketReader::NetLib
@@ -55,4 +55,31 @@ namespace PacketReader
 			*offset += length;
 		}
 	};
+
+	//Bytes owned by class
+	class PayloadData : public Payload
+	{
+	public:
+		std::unique_ptr<u8[]> data;
+
+	private:
+		int length;
+
+	public:
+		PayloadData(int len)
+		{
+			length = len;
+			if (len != 0)
+				data = std::make_unique<u8[]>(len);
+		}
+		virtual int GetLength()
+		{
+			return length;
+		}
+		virtual void WriteBytes(u8* buffer, int* offset)
+		{
+			memcpy(&buffer[*offset], data.get(), length);
+			*offset += length;
+		}
+	};
 } // namespace PacketReader
@@ -81,6 +81,8 @@ void SaveConf()
 
 	WritePrivateProfileInt(L"DEV9", L"ethEnable", config.ethEnable, file.c_str());
 	WritePrivateProfileInt(L"DEV9", L"hddEnable", config.hddEnable, file.c_str());
+
+	WritePrivateProfileInt(L"DEV9", L"RxIntrDelay", config.RxIntrDelay, file.c_str());
 }
 
 void LoadConf()
@@ -123,4 +125,6 @@ void LoadConf()
 
 	config.ethEnable = GetPrivateProfileInt(L"DEV9", L"ethEnable", config.ethEnable, file.c_str());
 	config.hddEnable = GetPrivateProfileInt(L"DEV9", L"hddEnable", config.hddEnable, file.c_str());
+
+	config.RxIntrDelay = GetPrivateProfileInt(L"DEV9", L"RxIntrDelay", RX_INTR_DELAY_DEF, file.c_str());
 }
@@ -27,6 +27,8 @@
 #include "Win32/tap.h"
 #endif
 #include "pcap_io.h"
+#include "sockets.h"
+#include "PacketQueue.h"
 
 #include "PacketReader/EthernetFrame.h"
 #include "PacketReader/IP/IP_Packet.h"
@@ -39,31 +41,98 @@ std::mutex rx_mutex;
 
 volatile bool RxRunning = false;
 //rx thread
+//Frames the rx thread pulls from the adapter before handing them to the guest under a single lock
+static NetPacket rx_batch[8];
 void NetRxThread()
 {
-	NetPacket tmp;
 	while (RxRunning)
 	{
-		while (rx_fifo_can_rx() && nif->recv(&tmp))
+		//Only receive as many frames as there are free RXBDs for, so none have to be dropped
+		const int space = std::min(rx_fifo_free_frames(), static_cast<int>(std::size(rx_batch)));
+		int count = 0;
+		while (count < space && nif->recv(&rx_batch[count]))
+			count++;
+
+		if (count != 0)
 		{
 			std::lock_guard rx_lock(rx_mutex);
-			//Check if we can still rx
-			if (rx_fifo_can_rx())
-				rx_process(&tmp);
-			else
-				Console.Error("DEV9: rx_fifo_can_rx() false after nif->recv(), dropping");
+			for (int i = 0; i < count; i++)
+			{
+				//Check if we can still rx
+				if (rx_fifo_can_rx())
+					rx_process(&rx_batch[i]);
+				else
+					Console.Error("DEV9: rx_fifo_can_rx() false after nif->recv(), dropping");
+			}
 		}
 
+		//A full batch means more frames are likely waiting
+		if (count != 0 && count == space)
+			continue;
+
 		using namespace std::chrono_literals;
 		std::this_thread::sleep_for(1ms);
 	}
 }
 
+//Frames are handed to the tx thread, so slow sends don't hold up the emulation
+PacketQueue<128> tx_queue;
+//Frames put in tx_queue but not yet pushed, only touched by the tx_put() caller
+size_t tx_staged = 0;
+std::thread tx_thread;
+
+std::mutex tx_mutex;
+std::condition_variable tx_cv;
+
+volatile bool TxRunning = false;
+//tx thread
+void NetTxThread()
+{
+	while (true)
+	{
+		{
+			std::unique_lock tx_lock(tx_mutex);
+			tx_cv.wait(tx_lock, [] { return !TxRunning || tx_queue.ReadAvailable() != 0; });
+			if (!TxRunning)
+				break;
+		}
+
+		const size_t count = tx_queue.ReadAvailable();
+		for (size_t i = 0; i < count; i++)
+			nif->send(tx_queue.ReadSlot(i));
+		tx_queue.Pop(count);
+	}
+}
+
 void tx_put(NetPacket* pkt)
 {
-	if (nif != nullptr)
-		nif->send(pkt);
-	//pkt must be copied if its not processed by here, since it can be allocated on the callers stack
+	if (nif == nullptr || !TxRunning)
+		return;
+
+	//pkt must be copied, since it can be allocated on the callers stack
+	if (tx_staged >= tx_queue.WriteAvailable())
+	{
+		Console.Error("DEV9: tx queue full, dropping");
+		return;
+	}
+
+	NetPacket* slot = tx_queue.WriteSlot(tx_staged++);
+	slot->size = pkt->size;
+	memcpy(slot->buffer, pkt->buffer, pkt->size);
+}
+
+void tx_flush()
+{
+	if (tx_staged == 0)
+		return;
+
+	tx_queue.Push(tx_staged);
+	tx_staged = 0;
+
+	{
+		std::lock_guard tx_lock(tx_mutex);
+	}
+	tx_cv.notify_one();
 }
 
 NetAdapter* GetNetAdapter()
@@ -81,6 +150,9 @@ NetAdapter* GetNetAdapter()
 		case NetApi::PCAP_Switched:
 			na = static_cast<NetAdapter*>(new PCAPAdapter());
 			break;
+		case NetApi::Sockets:
+			na = static_cast<NetAdapter*>(new SocketAdapter());
+			break;
 		default:
 			return 0;
 	}
@@ -106,8 +178,10 @@ void InitNet()
 
 	nif = na;
 	RxRunning = true;
+	TxRunning = true;
 
 	rx_thread = std::thread(NetRxThread);
+	tx_thread = std::thread(NetTxThread);
 
 #ifdef _WIN32
 	SetThreadPriority(rx_thread.native_handle(), THREAD_PRIORITY_HIGHEST);
@@ -151,6 +225,17 @@ void TermNet()
 {
 	if (RxRunning)
 	{
+		{
+			std::lock_guard tx_lock(tx_mutex);
+			TxRunning = false;
+		}
+		tx_cv.notify_one();
+		tx_thread.join();
+
+		//Drop anything that didn't get sent
+		tx_queue.Pop(tx_queue.ReadAvailable());
+		tx_staged = 0;
+
 		RxRunning = false;
 		nif->close();
 		Console.WriteLn("DEV9: Waiting for RX-net thread to terminate..");
@@ -172,6 +257,8 @@ const char* NetApiToString(NetApi api)
 			return "PCAP (Switched)";
 		case NetApi::TAP:
 			return "TAP";
+		case NetApi::Sockets:
+			return "Sockets";
 		default:
 			return "UNK";
 	}
@@ -187,6 +274,8 @@ const wchar_t* NetApiToWstring(NetApi api)
 			return L"PCAP (Switched)";
 		case NetApi::TAP:
 			return L"TAP";
+		case NetApi::Sockets:
+			return L"Sockets";
 		default:
 			return L"UNK";
 	}
@@ -268,16 +357,17 @@ bool NetAdapter::VerifyPkt(NetPacket* pkt, int read_size)
 }
 
 #ifdef _WIN32
-void NetAdapter::InitInternalServer(PIP_ADAPTER_ADDRESSES adapter)
+void NetAdapter::InitInternalServer(PIP_ADAPTER_ADDRESSES adapter, bool dhcpForceEnable, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #elif defined(__POSIX__)
-void NetAdapter::InitInternalServer(ifaddrs* adapter)
+void NetAdapter::InitInternalServer(ifaddrs* adapter, bool dhcpForceEnable, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #endif
 {
 	if (adapter == nullptr)
 		Console.Error("DEV9: InitInternalServer() got nullptr for adapter");
 
-	if (config.InterceptDHCP)
-		dhcpServer.Init(adapter);
+	dhcpForced = dhcpForceEnable;
+	if (config.InterceptDHCP || dhcpForced)
+		dhcpServer.Init(adapter, ipOverride, netmaskOverride, gatewayOverride);
 
 	if (blocks())
 	{
@@ -287,16 +377,17 @@ void NetAdapter::InitInternalServer(ifaddrs* adapter)
 }
 
 #ifdef _WIN32
-void NetAdapter::ReloadInternalServer(PIP_ADAPTER_ADDRESSES adapter)
+void NetAdapter::ReloadInternalServer(PIP_ADAPTER_ADDRESSES adapter, bool dhcpForceEnable, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #elif defined(__POSIX__)
-void NetAdapter::ReloadInternalServer(ifaddrs* adapter)
+void NetAdapter::ReloadInternalServer(ifaddrs* adapter, bool dhcpForceEnable, IP_Address ipOverride, IP_Address netmaskOverride, IP_Address gatewayOverride)
 #endif
 {
 	if (adapter == nullptr)
 		Console.Error("DEV9: ReloadInternalServer() got nullptr for adapter");
 
-	if (config.InterceptDHCP)
-		dhcpServer.Init(adapter);
+	dhcpForced = dhcpForceEnable;
+	if (config.InterceptDHCP || dhcpForced)
+		dhcpServer.Init(adapter, ipOverride, netmaskOverride, gatewayOverride);
 }
 
 bool NetAdapter::InternalServerRecv(NetPacket* pkt)
@@ -319,26 +410,29 @@ bool NetAdapter::InternalServerRecv(NetPacket* pkt)
 
 bool NetAdapter::InternalServerSend(NetPacket* pkt)
 {
-	EthernetFrame frame(pkt);
-	if (frame.protocol == (u16)EtherType::IPv4)
+	//Every sent packet passes through here, so only headers are looked at until it's known to be for us
+	EthernetFrameView frame(pkt);
+	if (frame.IsValid() && frame.GetProtocol() == (u16)EtherType::IPv4)
 	{
-		PayloadPtr* payload = static_cast<PayloadPtr*>(frame.GetPayload());
-		IP_Packet ippkt(payload->data, payload->GetLength());
+		IP_PacketView ippkt(frame.GetPayload(), frame.GetPayloadLength());
+		if (!ippkt.IsValid())
+			return false;
 
-		if (ippkt.protocol == (u16)IP_Type::UDP)
+		if (ippkt.GetProtocol() == (u8)IP_Type::UDP)
 		{
-			IP_PayloadPtr* ipPayload = static_cast<IP_PayloadPtr*>(ippkt.GetPayload());
-			UDP_Packet udppkt(ipPayload->data, ipPayload->GetLength());
-
-			if (udppkt.destinationPort == 67)
+			UDP_PacketView udpView(ippkt.GetPayload(), ippkt.GetPayloadLength());
+			if (udpView.IsValid() && udpView.GetDestinationPort() == 67)
 			{
 				//Send DHCP
-				if (config.InterceptDHCP)
+				if (config.InterceptDHCP || dhcpForced)
+				{
+					UDP_Packet udppkt(ippkt.GetPayload(), ippkt.GetPayloadLength());
 					return dhcpServer.Send(&udppkt);
+				}
 			}
 		}
 
-		if (ippkt.destinationIP == internalIP)
+		if (ippkt.GetDestinationIP() == internalIP)
 		{
 			return true;
 		}
@@ -62,6 +62,7 @@ enum struct NetApi : int
 	PCAP_Bridged = 1,
 	PCAP_Switched = 2,
 	TAP = 3,
+	Sockets = 4,
 };
 
 struct AdapterEntry
@@ -95,6 +96,8 @@ private:
 	bool internalRxHasData = false;
 
 	InternalServers::DHCP_Server dhcpServer = InternalServers::DHCP_Server([&] { InternalSignalReceived(); });
+	//Serve DHCP regardless of config.InterceptDHCP
+	bool dhcpForced = false;
 
 public:
 	NetAdapter();
@@ -110,12 +113,13 @@ protected:
 	void SetMACAddress(u8* mac);
 	bool VerifyPkt(NetPacket* pkt, int read_size);
 
+	//Overrides are passed on to DHCP_Server::Init()
 #ifdef _WIN32
-	void InitInternalServer(PIP_ADAPTER_ADDRESSES adapter);
-	void ReloadInternalServer(PIP_ADAPTER_ADDRESSES adapter);
+	void InitInternalServer(PIP_ADAPTER_ADDRESSES adapter, bool dhcpForceEnable = false, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
+	void ReloadInternalServer(PIP_ADAPTER_ADDRESSES adapter, bool dhcpForceEnable = false, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
 #elif defined(__POSIX__)
-	void InitInternalServer(ifaddrs* adapter);
-	void ReloadInternalServer(ifaddrs* adapter);
+	void InitInternalServer(ifaddrs* adapter, bool dhcpForceEnable = false, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
+	void ReloadInternalServer(ifaddrs* adapter, bool dhcpForceEnable = false, PacketReader::IP::IP_Address ipOverride = {0}, PacketReader::IP::IP_Address netmaskOverride = {0}, PacketReader::IP::IP_Address gatewayOverride = {0});
 #endif
 
 private:
@@ -126,7 +130,9 @@ private:
 	void InternalServerThread();
 };
 
+//Frames are sent once tx_flush() is called
 void tx_put(NetPacket* ptr);
+void tx_flush();
 void InitNet();
 void ReconfigureLiveNet(Config* oldConfig);
 void TermNet();
@@ -25,6 +25,8 @@
 #elif defined(__linux__)
 #include <sys/ioctl.h>
 #include <net/if.h>
+#include <sys/time.h>
+#include "Linux/PacketRing.h"
 #elif defined(__POSIX__)
 #include <sys/types.h>
 #include <ifaddrs.h>
@@ -43,6 +45,11 @@ pcap_t* adhandle;
 pcap_dumper_t* dump_pcap = nullptr;
 char errbuf[PCAP_ERRBUF_SIZE];
 
+#ifdef __linux__
+// when set, packets are received and sent through this instead of adhandle
+std::unique_ptr<PacketRing> packet_ring;
+#endif
+
 int pcap_io_running = 0;
 bool pcap_io_switched;
 
@@ -199,6 +206,8 @@ int pcap_io_init(char* adapter, bool switched, mac_address virtual_mac)
 		Console.Error("DEV9: Unable to open the adapter. %s is not supported by pcap", adapter);
 		return -1;
 	}
+	fp.bf_insns = nullptr;
+	fp.bf_len = 0;
 	if (switched)
 	{
 		char virtual_mac_str[18];
@@ -235,6 +244,24 @@ int pcap_io_init(char* adapter, bool switched, mac_address virtual_mac)
 			return -1;
 	}
 
+#ifdef __linux__
+	// Rather than going through pcap for every packet, use our own packet ring with the same filter.
+	// The pcap handle is then replaced by a dead one, which is still good for dumping packets.
+	packet_ring = std::make_unique<PacketRing>();
+	if (packet_ring->Open(adapter, switched, fp.bf_insns, fp.bf_len))
+	{
+		pcap_close(adhandle);
+		adhandle = pcap_open_dead(DLT_EN10MB, 65536);
+		Console.WriteLn("DEV9: Using packet ring.");
+	}
+	else
+	{
+		packet_ring.reset();
+		Console.Warning("DEV9: Packet ring unavailable, using pcap.");
+	}
+	pcap_freecode(&fp);
+#endif
+
 #ifdef DEBUG
 	const std::string plfile(s_strLogPath + "/pkt_log.pcap");
 	dump_pcap = pcap_dump_open(adhandle, plfile.c_str());
@@ -285,6 +312,11 @@ int pcap_io_send(void* packet, int plen)
 		pcap_dump((u_char*)dump_pcap, &ph, (u_char*)packet);
 	}
 
+#ifdef __linux__
+	if (packet_ring)
+		return packet_ring->Send(packet, plen) ? 0 : -1;
+#endif
+
 	return pcap_sendpacket(adhandle, (u_char*)packet, plen);
 }
 
@@ -296,13 +328,34 @@ int pcap_io_recv(void* packet, int max_len)
 	if (pcap_io_running <= 0)
 		return -1;
 
+	bool received = false;
+#ifdef __linux__
+	if (packet_ring)
+	{
+		static struct pcap_pkthdr ring_header;
+		const int len = packet_ring->Recv(packet, max_len, 1);
+		if (len > 0)
+		{
+			gettimeofday(&ring_header.ts, NULL);
+			ring_header.caplen = len;
+			ring_header.len = len;
+			header = &ring_header;
+			received = true;
+		}
+	}
+	else
+#endif
 	if ((pcap_next_ex(adhandle, &header, &pkt_data1)) > 0)
 	{
 		if (header->len > max_len)
 			return -1;
 
 		memcpy(packet, pkt_data1, header->len);
+		received = true;
+	}
 
+	if (received)
+	{
 		if (!pcap_io_switched)
 		{
 			{
@@ -337,6 +390,9 @@ int pcap_io_recv(void* packet, int max_len)
 
 void pcap_io_close()
 {
+#ifdef __linux__
+	packet_ring.reset();
+#endif
 	if (dump_pcap)
 		pcap_dump_close(dump_pcap);
 	if (adhandle)
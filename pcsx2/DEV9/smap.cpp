@@ -29,12 +29,16 @@
 #include <stdarg.h>
 #include <mutex>
 
+#include "IopCommon.h"
 #include "smap.h"
 #include "net.h"
 #include "pcap_io.h"
 
 bool has_link = true;
 volatile bool fireIntR = false;
+//Cycle at which the currently held back RXEND was first seen pending
+static bool rxIntrHeld = false;
+static u32 rxIntrStart = 0;
 std::mutex frame_counter_mutex;
 std::mutex reset_mutex;
 /*
@@ -65,12 +69,19 @@ void test()
 
 //this can return a false positive, but its not problem since it may say it cant recv while it can (no harm done, just delay on packets)
 bool rx_fifo_can_rx()
+{
+	return rx_fifo_free_frames() > 0;
+}
+
+//Number of full sized frames that fit into both the free RXBDs and the fifo
+int rx_fifo_free_frames()
 {
 	//check if RX is on & stuff like that here
 
 	//Check if there is space on RXBD
-	if (dev9Ru8(SMAP_R_RXFIFO_FRAME_CNT) == 64)
-		return false;
+	const int bds = 64 - dev9Ru8(SMAP_R_RXFIFO_FRAME_CNT);
+	if (bds <= 0)
+		return 0;
 
 	//Check if there is space on fifo
 	int rd_ptr = dev9Ru32(SMAP_R_RXFIFO_RD_PTR);
@@ -81,11 +92,7 @@ bool rx_fifo_can_rx()
 	if (space == 0)
 		space = sizeof(dev9.rxfifo);
 
-	if (space < 1514)
-		return false;
-
-	//we can recv a packet !
-	return true;
+	return std::min(bds, space / 1514);
 }
 
 void rx_process(NetPacket* pk)
@@ -230,6 +237,7 @@ void tx_process()
 		//decrease frame count -- this is not thread safe
 		dev9Ru8(SMAP_R_TXFIFO_FRAME_CNT)--;
 	}
+	tx_flush();
 
 	//spams// emu_printf("processed %u frames, %u count, cnt = %u\n",fc,dev9Ru8(SMAP_R_TXFIFO_FRAME_CNT),cnt);
 	//if some error/early exit signal TXDNV
@@ -862,6 +870,20 @@ void smap_async(u32 cycles)
 {
 	if (fireIntR)
 	{
+		//Hold RXEND back for a short while so a burst of frames is handled by the guest in one go,
+		//unless the RXBDs/fifo are full, as no more frames would arrive until the guest empties them
+		const u32 window = static_cast<u32>(PSXCLK * config.RxIntrDelay / 1000000);
+		if (window != 0 && rx_fifo_can_rx())
+		{
+			if (!rxIntrHeld)
+			{
+				rxIntrHeld = true;
+				rxIntrStart = psxRegs.cycle;
+			}
+			if (psxRegs.cycle - rxIntrStart < window)
+				return;
+		}
+		rxIntrHeld = false;
 		fireIntR = false;
 		//Is this used to signal each individual packet, or just when there are packets in the RX fifo?
 		//I think it just signals when there are packets in the RX fifo
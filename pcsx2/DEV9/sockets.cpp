@@ -0,0 +1,934 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <iphlpapi.h>
+#elif defined(__POSIX__)
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#endif
+
+#include "sockets.h"
+#include "DEV9.h"
+
+#include "PacketReader/EthernetFrame.h"
+#include "PacketReader/NetLib.h"
+#include "PacketReader/IP/TCP/TCP_Packet.h"
+#include "PacketReader/IP/UDP/UDP_Packet.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace PacketReader;
+using namespace PacketReader::IP;
+using namespace PacketReader::IP::TCP;
+using namespace PacketReader::IP::UDP;
+
+static const u32 EventRead = 1 << 0;
+static const u32 EventWrite = 1 << 1;
+static const u32 EventError = 1 << 2;
+
+static const u8 TCP_FIN = 1 << 0;
+static const u8 TCP_SYN = 1 << 1;
+static const u8 TCP_RST = 1 << 2;
+static const u8 TCP_PSH = 1 << 3;
+static const u8 TCP_ACK = 1 << 4;
+
+//Largest payloads that fit into a 1500 byte frame without fragmenting
+static const u16 MaxTCPSegment = 1460;
+static const int MaxUDPPayload = 1472;
+
+//Queue slots kept for ACKs and other replies, host data is only read while more are free
+static const size_t ControlFrameReserve = 16;
+static const auto UDPTimeout = std::chrono::seconds(120);
+
+//The guest lives alone on the internal subnet, behind internalIP
+static const IP_Address SocketNetmask{255, 255, 255, 0};
+static const IP_Address SocketDefaultIP{192, 0, 2, 100};
+
+#ifdef _WIN32
+static const SOCKET InvalidSocket = INVALID_SOCKET;
+
+static void CloseSocket(SOCKET fd)
+{
+	closesocket(fd);
+}
+static bool SetNonBlocking(SOCKET fd)
+{
+	u_long on = 1;
+	return ioctlsocket(fd, FIONBIO, &on) == 0;
+}
+static bool LastErrorWouldBlock()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+static bool LastErrorConnectPending()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+static int LastError()
+{
+	return WSAGetLastError();
+}
+
+//Pick whichever adapter has the default gateway, so the guest gets the same DNS servers as the host
+static bool SocketGetWin32Adapter(PIP_ADAPTER_ADDRESSES adapter, std::unique_ptr<IP_ADAPTER_ADDRESSES[]>* buffer)
+{
+	int neededSize = 128;
+	std::unique_ptr<IP_ADAPTER_ADDRESSES[]> AdapterInfo = std::make_unique<IP_ADAPTER_ADDRESSES[]>(neededSize);
+	ULONG dwBufLen = sizeof(IP_ADAPTER_ADDRESSES) * neededSize;
+
+	DWORD dwStatus = GetAdaptersAddresses(
+		AF_UNSPEC,
+		GAA_FLAG_INCLUDE_PREFIX | GAA_FLAG_INCLUDE_GATEWAYS,
+		NULL,
+		AdapterInfo.get(),
+		&dwBufLen);
+
+	if (dwStatus == ERROR_BUFFER_OVERFLOW)
+	{
+		neededSize = dwBufLen / sizeof(IP_ADAPTER_ADDRESSES) + 1;
+		AdapterInfo = std::make_unique<IP_ADAPTER_ADDRESSES[]>(neededSize);
+		dwBufLen = sizeof(IP_ADAPTER_ADDRESSES) * neededSize;
+
+		dwStatus = GetAdaptersAddresses(
+			AF_UNSPEC,
+			GAA_FLAG_INCLUDE_PREFIX | GAA_FLAG_INCLUDE_GATEWAYS,
+			NULL,
+			AdapterInfo.get(),
+			&dwBufLen);
+	}
+	if (dwStatus != ERROR_SUCCESS)
+		return false;
+
+	for (PIP_ADAPTER_ADDRESSES pAdapterInfo = AdapterInfo.get(); pAdapterInfo != nullptr; pAdapterInfo = pAdapterInfo->Next)
+	{
+		if (pAdapterInfo->OperStatus == IfOperStatusUp &&
+			pAdapterInfo->IfType != IF_TYPE_SOFTWARE_LOOPBACK &&
+			pAdapterInfo->FirstGatewayAddress != nullptr)
+		{
+			*adapter = *pAdapterInfo;
+			buffer->swap(AdapterInfo);
+			return true;
+		}
+	}
+	return false;
+}
+#elif defined(__POSIX__)
+static const int InvalidSocket = -1;
+
+static void CloseSocket(int fd)
+{
+	close(fd);
+}
+static bool SetNonBlocking(int fd)
+{
+	const int flags = fcntl(fd, F_GETFL, 0);
+	return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+static bool LastErrorWouldBlock()
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+static bool LastErrorConnectPending()
+{
+	return errno == EINPROGRESS;
+}
+static int LastError()
+{
+	return errno;
+}
+
+//DNS is system wide here, so any running IPv4 adapter will do
+static bool SocketGetIfAdapter(ifaddrs* adapter, ifaddrs** buffer)
+{
+	ifaddrs* adapterInfo;
+	if (getifaddrs(&adapterInfo))
+		return false;
+
+	for (ifaddrs* pAdapter = adapterInfo; pAdapter != nullptr; pAdapter = pAdapter->ifa_next)
+	{
+		if (pAdapter->ifa_addr != nullptr && pAdapter->ifa_addr->sa_family == AF_INET &&
+			(pAdapter->ifa_flags & IFF_UP) && !(pAdapter->ifa_flags & IFF_LOOPBACK))
+		{
+			*adapter = *pAdapter;
+			*buffer = adapterInfo;
+			return true;
+		}
+	}
+
+	freeifaddrs(adapterInfo);
+	return false;
+}
+#endif
+
+SocketAdapter::SocketAdapter()
+	: NetAdapter()
+{
+	if (config.ethEnable == 0)
+		return;
+
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+	{
+		Console.Error("DEV9: Sockets: WSAStartup failed");
+		return;
+	}
+#elif defined(__linux__)
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0)
+	{
+		Console.Error("DEV9: Sockets: Failed to create epoll instance: %s", strerror(errno));
+		return;
+	}
+#endif
+
+	InitDHCP(false);
+
+	lastTimeoutCheck = std::chrono::steady_clock::now();
+	initialised = true;
+	Console.WriteLn("DEV9: Sockets: Guest IP %u.%u.%u.%u",
+		ps2IP.bytes[0], ps2IP.bytes[1], ps2IP.bytes[2], ps2IP.bytes[3]);
+}
+
+void SocketAdapter::InitDHCP(bool reload)
+{
+	//The guest can only reach the host through us, so DHCP is always served,
+	//handing out an address on the internal subnet with us as the gateway
+	IP_Address ip = config.PS2IP;
+	if (ip.bytes[0] != internalIP.bytes[0] || ip.bytes[1] != internalIP.bytes[1] || ip.bytes[2] != internalIP.bytes[2] ||
+		ip == internalIP || ip.bytes[3] == 0 || ip.bytes[3] == 255)
+		ip = SocketDefaultIP;
+
+	{
+		std::lock_guard lock(sessionMutex);
+		ps2IP = ip;
+	}
+
+#ifdef _WIN32
+	IP_ADAPTER_ADDRESSES adapter;
+	std::unique_ptr<IP_ADAPTER_ADDRESSES[]> buffer;
+	PIP_ADAPTER_ADDRESSES pAdapter = SocketGetWin32Adapter(&adapter, &buffer) ? &adapter : nullptr;
+
+	if (reload)
+		ReloadInternalServer(pAdapter, true, ip, SocketNetmask, internalIP);
+	else
+		InitInternalServer(pAdapter, true, ip, SocketNetmask, internalIP);
+#elif defined(__POSIX__)
+	ifaddrs adapter;
+	ifaddrs* buffer = nullptr;
+	ifaddrs* pAdapter = SocketGetIfAdapter(&adapter, &buffer) ? &adapter : nullptr;
+
+	if (reload)
+		ReloadInternalServer(pAdapter, true, ip, SocketNetmask, internalIP);
+	else
+		InitInternalServer(pAdapter, true, ip, SocketNetmask, internalIP);
+
+	if (buffer != nullptr)
+		freeifaddrs(buffer);
+#endif
+}
+
+bool SocketAdapter::blocks()
+{
+	//recv() only checks for ready sockets, the rx thread does the waiting
+	return false;
+}
+
+bool SocketAdapter::isInitialised()
+{
+	return initialised;
+}
+
+bool SocketAdapter::recv(NetPacket* pkt)
+{
+	if (NetAdapter::recv(pkt))
+		return true;
+
+	PollSockets();
+
+	{
+		std::lock_guard lock(sessionMutex);
+		ReapSessions();
+	}
+
+	//This is the only consumer, so no lock is needed
+	if (rxQueue.ReadAvailable() == 0)
+		return false;
+
+	NetPacket* front = rxQueue.ReadSlot();
+	pkt->size = front->size;
+	memcpy(pkt->buffer, front->buffer, front->size);
+	rxQueue.Pop();
+	return true;
+}
+
+bool SocketAdapter::send(NetPacket* pkt)
+{
+	if (NetAdapter::send(pkt))
+		return true;
+
+	//Parsed in place, nothing is copied until it reaches a host socket
+	EthernetFrameView frame(pkt);
+	if (!frame.IsValid())
+		return true;
+
+	std::lock_guard lock(sessionMutex);
+	if (frame.GetProtocol() == (u16)EtherType::ARP)
+		SendARP(frame.GetPayload(), frame.GetPayloadLength());
+	else if (frame.GetProtocol() == (u16)EtherType::IPv4)
+	{
+		IP_PacketView ippkt(frame.GetPayload(), frame.GetPayloadLength());
+		if (!ippkt.IsValid())
+			return true;
+
+		//Reassembly isn't supported
+		if (ippkt.GetMoreFragments() || ippkt.GetFragmentOffset() != 0)
+			return true;
+
+		const IP_Address srcIP = ippkt.GetSourceIP();
+		if (srcIP.integer != 0)
+			ps2IP = srcIP;
+
+		if (ippkt.GetProtocol() == (u8)IP_Type::UDP)
+		{
+			UDP_PacketView udppkt(ippkt.GetPayload(), ippkt.GetPayloadLength());
+			if (udppkt.IsValid())
+				SendUDP(ippkt.GetDestinationIP(), &udppkt);
+		}
+		else if (ippkt.GetProtocol() == (u8)IP_Type::TCP)
+		{
+			TCP_PacketView tcppkt(ippkt.GetPayload(), ippkt.GetPayloadLength());
+			if (tcppkt.IsValid())
+				SendTCP(ippkt.GetDestinationIP(), &tcppkt);
+		}
+	}
+	return true;
+}
+
+void SocketAdapter::reloadSettings()
+{
+	InitDHCP(true);
+}
+
+SocketAdapter::~SocketAdapter()
+{
+	for (auto& session : udpSessions)
+		CloseSocket(session.second->fd);
+	for (auto& session : tcpSessions)
+		CloseSocket(session.second->fd);
+	udpSessions.clear();
+	tcpSessions.clear();
+
+#ifdef _WIN32
+	if (initialised)
+		WSACleanup();
+#elif defined(__linux__)
+	if (epollFd >= 0)
+		::close(epollFd);
+#endif
+}
+
+std::vector<AdapterEntry> SocketAdapter::GetAdapters()
+{
+	std::vector<AdapterEntry> nic;
+
+	AdapterEntry entry;
+	entry.type = NetApi::Sockets;
+#ifdef _WIN32
+	entry.name = L"Auto";
+	entry.guid = L"Auto";
+#else
+	entry.name = "Auto";
+	entry.guid = "Auto";
+#endif
+	nic.push_back(entry);
+
+	return nic;
+}
+
+//Answer every ARP request, as everything but the guest is reached through us
+void SocketAdapter::SendARP(u8* data, int length)
+{
+	if (length < 28)
+		return;
+
+	const u16 op = (data[6] << 8) | data[7];
+	IP_Address senderIP;
+	IP_Address targetIP;
+	memcpy(&senderIP, &data[14], 4);
+	memcpy(&targetIP, &data[24], 4);
+
+	//Don't answer probes or announcements, the guest would think its address is in use
+	if (op != 1 || senderIP.integer == 0 || senderIP == targetIP || targetIP == ps2IP)
+		return;
+
+	u8* reply = BeginFrame((u16)EtherType::ARP);
+	if (reply == nullptr)
+		return;
+
+	int offset = 0;
+	NetLib::WriteUInt16(reply, &offset, 1); //Ethernet
+	NetLib::WriteUInt16(reply, &offset, (u16)EtherType::IPv4);
+	NetLib::WriteByte08(reply, &offset, 6);
+	NetLib::WriteByte08(reply, &offset, 4);
+	NetLib::WriteUInt16(reply, &offset, 2); //Reply
+	NetLib::WriteByteArray(reply, &offset, 6, (u8*)internalMAC);
+	NetLib::WriteByteArray(reply, &offset, 4, (u8*)&targetIP);
+	NetLib::WriteByteArray(reply, &offset, 6, &data[8]);
+	NetLib::WriteByteArray(reply, &offset, 4, (u8*)&senderIP);
+
+	CommitFrame(offset);
+}
+
+void SocketAdapter::SendUDP(IP_Address destIP, UDP_PacketView* udp)
+{
+	const u16 sourcePort = udp->GetSourcePort();
+	Session* session;
+	auto it = udpSessions.find(sourcePort);
+	if (it != udpSessions.end() && !it->second->closing)
+		session = it->second.get();
+	else
+	{
+		//The previous session on this port is still waiting to be reaped
+		if (it != udpSessions.end())
+			return;
+
+		const auto fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (fd == InvalidSocket)
+		{
+			Console.Error("DEV9: Sockets: Failed to create UDP socket: %d", LastError());
+			return;
+		}
+		SetNonBlocking(fd);
+
+		int on = 1;
+		setsockopt(fd, SOL_SOCKET, SO_BROADCAST, (const char*)&on, sizeof(on));
+
+		//Keep the guest's port where we can, some games expect replies from peers to arrive on it
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(sourcePort);
+		if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+		{
+			DevCon.WriteLn("DEV9: Sockets: UDP port %u in use, using any port", sourcePort);
+			addr.sin_port = 0;
+			bind(fd, (sockaddr*)&addr, sizeof(addr));
+		}
+
+		session = new Session();
+		session->type = IP_Type::UDP;
+		session->fd = fd;
+		session->guestPort = sourcePort;
+		udpSessions[sourcePort].reset(session);
+		AddSession(session);
+	}
+	session->lastActivity = std::chrono::steady_clock::now();
+
+	sockaddr_in dest = {};
+	dest.sin_family = AF_INET;
+	dest.sin_port = htons(udp->GetDestinationPort());
+	const IP_Address subnetBroadcast{ps2IP.bytes[0], ps2IP.bytes[1], ps2IP.bytes[2], 255};
+	if (destIP == IP_Address{255, 255, 255, 255} || destIP == subnetBroadcast)
+		dest.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+	else
+		memcpy(&dest.sin_addr, &destIP, 4);
+
+	if (sendto(session->fd, (const char*)udp->GetPayload(), udp->GetPayloadLength(), 0, (sockaddr*)&dest, sizeof(dest)) < 0 && !LastErrorWouldBlock())
+		DevCon.WriteLn("DEV9: Sockets: UDP sendto failed: %d", LastError());
+}
+
+void SocketAdapter::SendTCP(IP_Address destIP, TCP_PacketView* tcp)
+{
+	const u16 sourcePort = tcp->GetSourcePort();
+	const u16 destinationPort = tcp->GetDestinationPort();
+	const u64 key = ((u64)sourcePort << 48) | ((u64)destIP.integer << 16) | destinationPort;
+	auto it = tcpSessions.find(key);
+	if (it == tcpSessions.end())
+	{
+		if (tcp->GetRST())
+			return;
+		if (!tcp->GetSYN() || tcp->GetACK())
+		{
+			QueueReset(destIP, tcp);
+			return;
+		}
+
+		const auto fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (fd == InvalidSocket)
+		{
+			Console.Error("DEV9: Sockets: Failed to create TCP socket: %d", LastError());
+			QueueReset(destIP, tcp);
+			return;
+		}
+		SetNonBlocking(fd);
+
+		//The guest does its own segmenting, don't delay it further
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+#ifdef SO_NOSIGPIPE
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&on, sizeof(on));
+#endif
+
+		sockaddr_in dest = {};
+		dest.sin_family = AF_INET;
+		dest.sin_port = htons(destinationPort);
+		memcpy(&dest.sin_addr, &destIP, 4);
+		if (connect(fd, (sockaddr*)&dest, sizeof(dest)) != 0 && !LastErrorConnectPending())
+		{
+			DevCon.WriteLn("DEV9: Sockets: TCP connect failed: %d", LastError());
+			CloseSocket(fd);
+			QueueReset(destIP, tcp);
+			return;
+		}
+
+		Session* session = new Session();
+		session->type = IP_Type::TCP;
+		session->fd = fd;
+		session->guestPort = sourcePort;
+		session->hostIP = destIP;
+		session->hostPort = destinationPort;
+		session->lastActivity = std::chrono::steady_clock::now();
+		session->guestSeq = tcp->GetSequenceNumber() + 1;
+		session->hostSeq = (u32)session->lastActivity.time_since_epoch().count();
+		session->guestAck = session->hostSeq;
+		session->guestWindow = tcp->GetWindowSize();
+		const u16 mss = tcp->GetMaxSegmentSize();
+		if (mss != 0)
+			session->mss = std::min(mss, MaxTCPSegment);
+		tcpSessions[key].reset(session);
+		//The SYN-ACK goes out once the host connection is up
+		AddSession(session);
+		return;
+	}
+
+	Session* session = it->second.get();
+	if (session->closing)
+		return;
+	if (tcp->GetRST())
+	{
+		CloseSession(session);
+		return;
+	}
+	//Retransmitted SYN, the SYN-ACK is still coming
+	if (tcp->GetSYN() || session->state != TCP_State::Established)
+		return;
+
+	session->lastActivity = std::chrono::steady_clock::now();
+	if (tcp->GetACK())
+	{
+		const u32 ack = tcp->GetAcknowledgementNumber();
+		if ((s32)(ack - session->guestAck) > 0)
+			session->guestAck = ack;
+		session->guestWindow = tcp->GetWindowSize();
+	}
+
+	u8* data = tcp->GetPayload();
+	int length = tcp->GetPayloadLength();
+	if (length > 0 || tcp->GetFIN())
+	{
+		//Skip anything we already have, and only accept the segment we're waiting for
+		const s32 skip = (s32)(session->guestSeq - tcp->GetSequenceNumber());
+		if (session->guestFin || skip < 0 || skip > length)
+		{
+			QueueTCP(session, TCP_ACK, nullptr, 0);
+			UpdateEvents(session);
+			return;
+		}
+		data += skip;
+		length -= skip;
+
+		//Only acknowledge what the host socket took, the guest resends the rest
+		int sent = 0;
+		if (length > 0)
+		{
+			sent = ::send(session->fd, (const char*)data, length, MSG_NOSIGNAL);
+			if (sent < 0)
+			{
+				if (!LastErrorWouldBlock())
+				{
+					QueueTCP(session, TCP_RST | TCP_ACK, nullptr, 0);
+					CloseSession(session);
+					return;
+				}
+				sent = 0;
+			}
+		}
+		session->guestSeq += sent;
+
+		if (tcp->GetFIN() && sent == length)
+		{
+			session->guestSeq++;
+			session->guestFin = true;
+#ifdef _WIN32
+			shutdown(session->fd, SD_SEND);
+#else
+			shutdown(session->fd, SHUT_WR);
+#endif
+		}
+		QueueTCP(session, TCP_ACK, nullptr, 0);
+	}
+
+	if (session->guestFin && session->hostFin && session->guestAck == session->hostSeq)
+		CloseSession(session);
+	else
+		UpdateEvents(session);
+}
+
+void SocketAdapter::PollSockets()
+{
+	{
+		std::lock_guard lock(sessionMutex);
+		if (rxQueue.WriteAvailable() <= ControlFrameReserve)
+			return;
+	}
+
+	//Sessions are only freed by ReapSessions() on this thread, so they stay valid while waiting unlocked
+#ifdef __linux__
+	epoll_event events[64];
+	const int count = epoll_wait(epollFd, events, (int)std::size(events), 0);
+	if (count <= 0)
+		return;
+
+	std::lock_guard lock(sessionMutex);
+	for (int i = 0; i < count; i++)
+	{
+		u32 flags = 0;
+		if (events[i].events & EPOLLIN)
+			flags |= EventRead;
+		if (events[i].events & EPOLLOUT)
+			flags |= EventWrite;
+		if (events[i].events & (EPOLLERR | EPOLLHUP))
+			flags |= EventError;
+
+		Session* session = static_cast<Session*>(events[i].data.ptr);
+		if (!session->closing)
+			HandleEvent(session, flags);
+	}
+#else
+	std::vector<pollfd> fds;
+	std::vector<Session*> polled;
+	{
+		std::lock_guard lock(sessionMutex);
+		auto add = [&](Session* session) {
+			if (session->closing || session->events == 0)
+				return;
+
+			pollfd pfd = {};
+			pfd.fd = session->fd;
+			pfd.events = ((session->events & EventRead) ? POLLIN : 0) | ((session->events & EventWrite) ? POLLOUT : 0);
+			fds.push_back(pfd);
+			polled.push_back(session);
+		};
+		for (auto& session : udpSessions)
+			add(session.second.get());
+		for (auto& session : tcpSessions)
+			add(session.second.get());
+	}
+	if (fds.empty())
+		return;
+
+#ifdef _WIN32
+	const int count = WSAPoll(fds.data(), (ULONG)fds.size(), 0);
+#else
+	const int count = poll(fds.data(), fds.size(), 0);
+#endif
+	if (count <= 0)
+		return;
+
+	std::lock_guard lock(sessionMutex);
+	for (size_t i = 0; i < fds.size(); i++)
+	{
+		if (fds[i].revents == 0 || polled[i]->closing)
+			continue;
+
+		u32 flags = 0;
+		if (fds[i].revents & POLLIN)
+			flags |= EventRead;
+		if (fds[i].revents & POLLOUT)
+			flags |= EventWrite;
+		if (fds[i].revents & (POLLERR | POLLHUP))
+			flags |= EventError;
+		HandleEvent(polled[i], flags);
+	}
+#endif
+}
+
+void SocketAdapter::HandleEvent(Session* session, u32 events)
+{
+	if (session->type == IP_Type::UDP)
+		ReceiveUDP(session);
+	else if (session->state == TCP_State::Connecting)
+	{
+		if (events & (EventWrite | EventError))
+			ConnectTCP(session);
+	}
+	else if (session->state == TCP_State::Established)
+		ReceiveTCP(session);
+}
+
+void SocketAdapter::ReceiveUDP(Session* session)
+{
+	while (rxQueue.WriteAvailable() > ControlFrameReserve)
+	{
+		//Read straight into the next frame, the headers are filled in around it
+		u8* segment = BeginIP();
+		u8* buffer = &segment[UDP_PacketView::headerLength];
+
+		sockaddr_in from = {};
+		socklen_t fromLength = sizeof(from);
+		const int length = recvfrom(session->fd, (char*)buffer, MaxUDPPayload + 1, 0, (sockaddr*)&from, &fromLength);
+		//Errors here are either no more data, or leftovers from an ICMP reply to an earlier send
+		if (length < 0)
+			break;
+		//Would need fragmenting
+		if (length > MaxUDPPayload)
+			continue;
+
+		IP_Address srcIP;
+		memcpy(&srcIP, &from.sin_addr, 4);
+		UDP_PacketView::WriteHeader(segment, ntohs(from.sin_port), session->guestPort, srcIP, ps2IP, length);
+		CommitIP((u8)IP_Type::UDP, srcIP, UDP_PacketView::headerLength + length);
+		session->lastActivity = std::chrono::steady_clock::now();
+	}
+}
+
+void SocketAdapter::ReceiveTCP(Session* session)
+{
+	while (!session->hostFin)
+	{
+		//Stay within what the guest has room for
+		const s32 window = (s32)(session->guestAck + session->guestWindow - session->hostSeq);
+		if (window <= 0 || rxQueue.WriteAvailable() <= ControlFrameReserve)
+			break;
+
+		//Read straight into the next frame, QueueTCP() fills in the headers around it
+		u8* buffer = &BeginIP()[TCP_PacketView::minHeaderLength];
+
+		const int length = ::recv(session->fd, (char*)buffer, std::min<int>(window, session->mss), 0);
+		if (length > 0)
+		{
+			QueueTCP(session, TCP_PSH | TCP_ACK, buffer, length);
+			session->hostSeq += length;
+			session->lastActivity = std::chrono::steady_clock::now();
+		}
+		else if (length == 0)
+		{
+			QueueTCP(session, TCP_FIN | TCP_ACK, nullptr, 0);
+			session->hostSeq++;
+			session->hostFin = true;
+		}
+		else
+		{
+			if (!LastErrorWouldBlock())
+			{
+				QueueTCP(session, TCP_RST | TCP_ACK, nullptr, 0);
+				CloseSession(session);
+				return;
+			}
+			break;
+		}
+	}
+	UpdateEvents(session);
+}
+
+void SocketAdapter::ConnectTCP(Session* session)
+{
+	int error = 0;
+	socklen_t errorLength = sizeof(error);
+	if (getsockopt(session->fd, SOL_SOCKET, SO_ERROR, (char*)&error, &errorLength) != 0 || error != 0)
+	{
+		DevCon.WriteLn("DEV9: Sockets: TCP connect to %u.%u.%u.%u:%u failed: %d",
+			session->hostIP.bytes[0], session->hostIP.bytes[1], session->hostIP.bytes[2], session->hostIP.bytes[3], session->hostPort, error);
+		QueueTCP(session, TCP_RST | TCP_ACK, nullptr, 0);
+		CloseSession(session);
+		return;
+	}
+
+	QueueTCP(session, TCP_SYN | TCP_ACK, nullptr, 0);
+	session->hostSeq++;
+	session->state = TCP_State::Established;
+	UpdateEvents(session);
+}
+
+//Replies are built in place in the next free rx slot, the returned pointer is where the frame payload goes
+//Returns nullptr if the queue is full
+u8* SocketAdapter::BeginFrame(u16 protocol)
+{
+	if (rxQueue.WriteAvailable() == 0)
+	{
+		DevCon.Warning("DEV9: Sockets: rx queue full, dropping frame");
+		return nullptr;
+	}
+
+	u8* buffer = (u8*)rxQueue.WriteSlot()->buffer;
+	return &buffer[EthernetFrameView::WriteHeader(buffer, ps2MAC, internalMAC, protocol)];
+}
+
+void SocketAdapter::CommitFrame(int payloadLength)
+{
+	rxQueue.WriteSlot()->size = EthernetFrameView::headerLength + payloadLength;
+	rxQueue.Push();
+}
+
+//Returns where the IP payload goes, see BeginFrame()
+u8* SocketAdapter::BeginIP()
+{
+	u8* packet = BeginFrame((u16)EtherType::IPv4);
+	if (packet == nullptr)
+		return nullptr;
+	return &packet[IP_PacketView::minHeaderLength];
+}
+
+//Adds the IP header in front of the payload written after BeginIP(), and queues the frame
+void SocketAdapter::CommitIP(u8 protocol, IP_Address srcIP, int payloadLength)
+{
+	u8* packet = (u8*)rxQueue.WriteSlot()->buffer + EthernetFrameView::headerLength;
+	const int headerLength = IP_PacketView::WriteHeader(packet, protocol, srcIP, ps2IP, payloadLength);
+	CommitFrame(headerLength + payloadLength);
+}
+
+void SocketAdapter::QueueTCP(Session* session, u8 flags, const u8* data, int length)
+{
+	u8* segment = BeginIP();
+	if (segment == nullptr)
+		return;
+
+	const u16 mss = (flags & TCP_SYN) ? MaxTCPSegment : 0;
+	const int headerLength = TCP_PacketView::GetHeaderLength(mss);
+	//ReceiveTCP() reads the data into place already
+	if (length != 0 && data != &segment[headerLength])
+		memcpy(&segment[headerLength], data, length);
+
+	TCP_PacketView::WriteHeader(segment, session->hostPort, session->guestPort, session->hostSeq, session->guestSeq,
+		flags, UINT16_MAX, mss, session->hostIP, ps2IP, length);
+	CommitIP((u8)IP_Type::TCP, session->hostIP, headerLength + length);
+}
+
+//Reply to a segment that doesn't belong to any session
+void SocketAdapter::QueueReset(IP_Address srcIP, TCP_PacketView* tcp)
+{
+	u8* segment = BeginIP();
+	if (segment == nullptr)
+		return;
+
+	u8 flags = TCP_RST;
+	u32 sequenceNumber = 0;
+	u32 acknowledgementNumber = 0;
+	if (tcp->GetACK())
+		sequenceNumber = tcp->GetAcknowledgementNumber();
+	else
+	{
+		acknowledgementNumber = tcp->GetSequenceNumber() + tcp->GetPayloadLength() + (tcp->GetSYN() ? 1 : 0) + (tcp->GetFIN() ? 1 : 0);
+		flags |= TCP_ACK;
+	}
+
+	TCP_PacketView::WriteHeader(segment, tcp->GetDestinationPort(), tcp->GetSourcePort(), sequenceNumber, acknowledgementNumber,
+		flags, 0, 0, srcIP, ps2IP, 0);
+	CommitIP((u8)IP_Type::TCP, srcIP, TCP_PacketView::minHeaderLength);
+}
+
+void SocketAdapter::AddSession(Session* session)
+{
+	session->events = 0;
+	UpdateEvents(session);
+}
+
+void SocketAdapter::UpdateEvents(Session* session)
+{
+	u32 events = 0;
+	if (session->closing)
+		events = 0;
+	else if (session->type == IP_Type::UDP)
+		events = EventRead;
+	else if (session->state == TCP_State::Connecting)
+		events = EventWrite;
+	else if (session->state == TCP_State::Established && !session->hostFin &&
+			 (s32)(session->guestAck + session->guestWindow - session->hostSeq) > 0)
+		events = EventRead;
+
+	if (events == session->events)
+		return;
+
+#ifdef __linux__
+	//Sockets with nothing to wait for are taken out entirely, so a hung up socket doesn't keep reporting
+	if (events == 0)
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, session->fd, nullptr);
+	else
+	{
+		epoll_event ev = {};
+		ev.events = ((events & EventRead) ? EPOLLIN : 0) | ((events & EventWrite) ? EPOLLOUT : 0);
+		ev.data.ptr = session;
+		epoll_ctl(epollFd, session->events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, session->fd, &ev);
+	}
+#endif
+	session->events = events;
+}
+
+void SocketAdapter::CloseSession(Session* session)
+{
+	session->state = TCP_State::Closed;
+	session->closing = true;
+	UpdateEvents(session);
+}
+
+void SocketAdapter::ReapSessions()
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (now - lastTimeoutCheck >= std::chrono::seconds(1))
+	{
+		lastTimeoutCheck = now;
+		for (auto& session : udpSessions)
+		{
+			if (now - session.second->lastActivity > UDPTimeout)
+				CloseSession(session.second.get());
+		}
+	}
+
+	auto reap = [](auto& sessions) {
+		for (auto it = sessions.begin(); it != sessions.end();)
+		{
+			if (it->second->closing)
+			{
+				CloseSocket(it->second->fd);
+				it = sessions.erase(it);
+			}
+			else
+				++it;
+		}
+	};
+	reap(udpSessions);
+	reap(tcpSessions);
+}
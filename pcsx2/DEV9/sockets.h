@@ -0,0 +1,134 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#endif
+
+#include "net.h"
+#include "PacketQueue.h"
+#include "PacketReader/IP/IP_Packet.h"
+
+namespace PacketReader::IP::UDP
+{
+	class UDP_PacketView;
+}
+namespace PacketReader::IP::TCP
+{
+	class TCP_PacketView;
+}
+
+// User-space NAT, the guest's TCP and UDP flows are terminated here and
+// replayed through ordinary host sockets, so no driver or elevated rights are needed.
+// ICMP and anything that isn't TCP/UDP over IPv4 is dropped.
+class SocketAdapter : public NetAdapter
+{
+#ifdef _WIN32
+	using Socket = SOCKET;
+#else
+	using Socket = int;
+#endif
+
+	enum struct TCP_State
+	{
+		Connecting,
+		Established,
+		Closed,
+	};
+
+	struct Session
+	{
+		PacketReader::IP::IP_Type type;
+		Socket fd;
+		u16 guestPort;
+		PacketReader::IP::IP_Address hostIP{0};
+		u16 hostPort = 0;
+
+		//Events currently being waited on
+		u32 events = 0;
+		//Removed by the receive thread, so it can safely wait on the socket without holding the lock
+		bool closing = false;
+		std::chrono::steady_clock::time_point lastActivity;
+
+		//TCP only
+		TCP_State state = TCP_State::Connecting;
+		u32 guestSeq = 0; //Next sequence number expected from the guest
+		u32 hostSeq = 0; //Next sequence number we send
+		u32 guestAck = 0; //Highest sequence number acknowledged by the guest
+		u16 guestWindow = 0;
+		u16 mss = 536;
+		bool guestFin = false;
+		bool hostFin = false;
+	};
+
+	std::mutex sessionMutex;
+	std::unordered_map<u16, std::unique_ptr<Session>> udpSessions;
+	//Key is guest port, host IP and host port
+	std::unordered_map<u64, std::unique_ptr<Session>> tcpSessions;
+	//Filled under sessionMutex from both send() and recv(), emptied by recv()
+	PacketQueue<256> rxQueue;
+
+	PacketReader::IP::IP_Address ps2IP{0};
+
+	std::chrono::steady_clock::time_point lastTimeoutCheck;
+	bool initialised = false;
+#ifdef __linux__
+	int epollFd = -1;
+#endif
+
+public:
+	SocketAdapter();
+	virtual bool blocks();
+	virtual bool isInitialised();
+	//gets a packet.rv :true success
+	virtual bool recv(NetPacket* pkt);
+	//sends the packet and deletes it when done (if successful).rv :true success
+	virtual bool send(NetPacket* pkt);
+	virtual void reloadSettings();
+	virtual ~SocketAdapter();
+	static std::vector<AdapterEntry> GetAdapters();
+
+private:
+	void InitDHCP(bool reload);
+
+	void SendARP(u8* data, int length);
+	void SendUDP(PacketReader::IP::IP_Address destIP, PacketReader::IP::UDP::UDP_PacketView* udp);
+	void SendTCP(PacketReader::IP::IP_Address destIP, PacketReader::IP::TCP::TCP_PacketView* tcp);
+
+	void PollSockets();
+	void HandleEvent(Session* session, u32 events);
+	void ReceiveUDP(Session* session);
+	void ReceiveTCP(Session* session);
+	void ConnectTCP(Session* session);
+
+	u8* BeginFrame(u16 protocol);
+	void CommitFrame(int payloadLength);
+	u8* BeginIP();
+	void CommitIP(u8 protocol, PacketReader::IP::IP_Address srcIP, int payloadLength);
+	void QueueTCP(Session* session, u8 flags, const u8* data, int length);
+	void QueueReset(PacketReader::IP::IP_Address srcIP, PacketReader::IP::TCP::TCP_PacketView* tcp);
+
+	void AddSession(Session* session);
+	void UpdateEvents(Session* session);
+	void CloseSession(Session* session);
+	void ReapSessions();
+};
@@ -20,6 +20,7 @@
 #include <cstdio>
 #include "R5900.h"
 #include "System.h"
+#include "vtlb.h"
 
 std::vector<BreakPoint> CBreakPoints::breakPoints_;
 u32 CBreakPoints::breakSkipFirstAtEE_ = 0;
@@ -268,6 +269,11 @@ void CBreakPoints::ChangeBreakPointAddCond(BreakPointCpu cpu, u32 addr, const Br
 	{
 		breakPoints_[bp].hasCond = true;
 		breakPoints_[bp].cond = cond;
+
+		// the condition is evaluated on every hit, so only resolve it once
+		BreakPointCond& bpCond = breakPoints_[bp].cond;
+		if (!bpCond.debug || !bpCond.debug->compileExpression(bpCond.expression, bpCond.compiled))
+			bpCond.compiled.clear();
 		Update();
 	}
 }
@@ -411,6 +417,73 @@ const std::vector<BreakPoint> CBreakPoints::GetBreakpoints()
 #include "App.h"
 #include "Debugger/DisassemblyDialog.h"
 
+// An EE address can be reached through the kernel segments and the uncached mirrors as well,
+// standardizeBreakpointAddressEE tells which of these lead to the same memory.
+static const u32 memcheckMirrors[] = {0, 0x20000000, 0x30000000, 0x80000000, 0xA0000000, 0xB0000000};
+
+// Hands the pages of the EE memchecks to the vtlb, so that only accesses to them leave
+// the recompiled code.
+void CBreakPoints::UpdateMemWatches()
+{
+	vtlb_ClearWatches();
+	vtlb_SetWatchCallback(MemWatchHit);
+
+	for (const MemCheck& check : memChecks_)
+	{
+		if (check.cpu != BREAKPOINT_EE || check.result == 0)
+			continue;
+
+		const u32 start = standardizeBreakpointAddressEE(check.start);
+		const u32 end = std::max(standardizeBreakpointAddressEE(check.end), start + 1);
+
+		for (u32 mirror : memcheckMirrors)
+		{
+			if (standardizeBreakpointAddressEE(start | mirror) == start)
+				vtlb_Watch(start | mirror, end - start);
+		}
+	}
+}
+
+void __fastcall CBreakPoints::MemWatchHit(u32 addr, u32 size, bool write)
+{
+	// The interpreter checks the memory instructions itself, and other threads (like the
+	// debugger reading memory) aren't the game accessing it.
+	if (Cpu != &recCpu || !GetCoreThread().IsSelf())
+		return;
+
+	const u32 start = standardizeBreakpointAddressEE(addr);
+	const u32 end = start + size;
+	bool hit = false;
+
+	for (MemCheck& check : memChecks_)
+	{
+		if (check.cpu != BREAKPOINT_EE || (check.cond & (write ? MEMCHECK_WRITE : MEMCHECK_READ)) == 0)
+			continue;
+
+		// logic: memAddress < bpEnd && bpStart < memAddress+memSize
+		const u32 checkStart = standardizeBreakpointAddressEE(check.start);
+		const u32 checkEnd = std::max(standardizeBreakpointAddressEE(check.end), checkStart + 1);
+		if (start >= checkEnd || checkStart >= end)
+			continue;
+
+		++check.numHits;
+		if (check.result & MEMCHECK_LOG)
+			DevCon.WriteLn("Hit %s breakpoint @0x%x", write ? "store" : "load", addr);
+		if (check.result & MEMCHECK_BREAK)
+			hit = true;
+	}
+
+	if (!hit)
+		return;
+
+	// The access is done and the pc isn't flushed in the middle of a block, so the
+	// recompiler stops at the end of the block doing it.
+	SetBreakpointTriggered(true);
+	GetCoreThread().PauseSelfDebug();
+	eeMemcheckBreak = true;
+	cpuSetNextEventDelta(0);
+}
+
 void CBreakPoints::Update(BreakPointCpu cpu, u32 addr)
 {
 	bool resume = false;
@@ -420,6 +493,10 @@ void CBreakPoints::Update(BreakPointCpu cpu, u32 addr)
 		resume = true;
 	}
 
+	// the recompiled code has to see the new watches
+	if (cpu & BREAKPOINT_EE)
+		UpdateMemWatches();
+
 //	if (addr != 0)
 //		Cpu->Clear(addr-4,8);
 //	else
@@ -26,6 +26,8 @@ struct BreakPointCond
 {
 	DebugInterface *debug;
 	PostfixExpression expression;
+	// filled in by CBreakPoints, Evaluate uses the postfix expression if it couldn't be compiled
+	CompiledExpression compiled;
 	char expressionString[128];
 
 	BreakPointCond() : debug(NULL)
@@ -36,6 +38,12 @@ struct BreakPointCond
 	u32 Evaluate()
 	{
 		u64 result;
+		if (!compiled.empty())
+		{
+			if (!debug->evaluateExpression(compiled,result) || result == 0) return 0;
+			return 1;
+		}
+
 		if (!debug->parseExpression(expression,result) || result == 0) return 0;
 		return 1;
 	}
@@ -109,7 +117,8 @@ struct MemCheck
 
 // BreakPoints cannot overlap, only one is allowed per address.
 // MemChecks can overlap, as long as their ends are different.
-// WARNING: MemChecks are not used in the interpreter or HLE currently.
+// EE MemChecks hit by recompiled code are found through the vtlb, which watches their pages
+// (see vtlb_Watch), the interpreters and the IOP recompiler check each memory instruction.
 class CBreakPoints
 {
 public:
@@ -155,6 +164,9 @@ private:
 	// Finds exactly, not using a range check.
 	static size_t FindMemCheck(BreakPointCpu cpu, u32 start, u32 end);
 
+	static void UpdateMemWatches();
+	static void __fastcall MemWatchHit(u32 addr, u32 size, bool write);
+
 	static std::vector<BreakPoint> breakPoints_;
 	static u32 breakSkipFirstAtEE_;
 	static u64 breakSkipFirstTicksEE_;
@@ -27,6 +27,7 @@
 #include "R3000A.h"
 #include "IopMem.h"
 #include "SymbolMap.h"
+#include "DisassemblyManager.h"
 
 extern AppCoreThread CoreThread;
 
@@ -116,6 +117,14 @@ public:
 		}
 		return EXPR_TYPE_UINT;
 	}
+
+	virtual const void* getReferencePointer(u64 referenceIndex, int& size)
+	{
+		// same numbering as getRegister, pc hi and lo follow the GPRs
+		if (referenceIndex < 32 || referenceIndex == REF_INDEX_PC || referenceIndex == REF_INDEX_HI || referenceIndex == REF_INDEX_LO)
+			return cpu->getRegisterPointer(0, referenceIndex, size);
+		return NULL;
+	}
 	
 	virtual bool getMemoryValue(u32 address, int size, u64& dest, char* error)
 	{
@@ -228,6 +237,18 @@ bool DebugInterface::parseExpression(PostfixExpression& exp, u64& dest)
 	return parsePostfixExpression(exp,&funcs,dest);
 }
 
+bool DebugInterface::compileExpression(const PostfixExpression& exp, CompiledExpression& dest)
+{
+	MipsExpressionFunctions funcs(this);
+	return compilePostfixExpression(exp,&funcs,dest);
+}
+
+bool DebugInterface::evaluateExpression(const CompiledExpression& exp, u64& dest)
+{
+	MipsExpressionFunctions funcs(this);
+	return evaluateCompiledExpression(exp,&funcs,dest);
+}
+
 
 //
 // R5900DebugInterface
@@ -291,6 +312,7 @@ void R5900DebugInterface::write8(u32 address, u8 value)
 		return;
 
 	memWrite8(address,value);
+	DisassemblyManager::clearPageHashes();
 }
 
 void R5900DebugInterface::write32(u32 address, u32 value)
@@ -299,6 +321,7 @@ void R5900DebugInterface::write32(u32 address, u32 value)
 		return;
 
 	memWrite32(address,value);
+	DisassemblyManager::clearPageHashes();
 }
 
 
@@ -481,6 +504,26 @@ u128 R5900DebugInterface::getRegister(int cat, int num)
 	return result;
 }
 
+const void* R5900DebugInterface::getRegisterPointer(int cat, int num, int& size)
+{
+	if (cat != EECAT_GPR)
+		return NULL;
+
+	size = 8;
+	switch (num)
+	{
+	case 32:	// pc
+		size = 4;
+		return &cpuRegs.pc;
+	case 33:	// hi
+		return &cpuRegs.HI.UD[0];
+	case 34:	// lo
+		return &cpuRegs.LO.UD[0];
+	default:
+		return &cpuRegs.GPR.r[num].UD[0];
+	}
+}
+
 wxString R5900DebugInterface::getRegisterString(int cat, int num)
 {
 	switch (cat)
@@ -639,6 +682,16 @@ bool R5900DebugInterface::isValidAddress(u32 addr)
 	return false;
 }
 
+const u8* R5900DebugInterface::getPagePointer(u32 address)
+{
+	address &= ~0xFFF;
+	if (!isValidAddress(address))
+		return NULL;
+
+	// handler pages, including memcheck watches, have to go through memRead
+	return (const u8*)vtlb_GetVirtPtr(address);
+}
+
 u32 R5900DebugInterface::getCycles()
 {
 	return cpuRegs.cycle;
@@ -691,6 +744,7 @@ void R3000DebugInterface::write8(u32 address, u8 value)
 		return;
 
 	iopMemWrite8(address,value);
+	DisassemblyManager::clearPageHashes();
 }
 
 void R3000DebugInterface::write32(u32 address, u32 value)
@@ -699,6 +753,7 @@ void R3000DebugInterface::write32(u32 address, u32 value)
 		return;
 
 	iopMemWrite32(address,value);
+	DisassemblyManager::clearPageHashes();
 }
 
 int R3000DebugInterface::getRegisterCategoryCount()
@@ -801,6 +856,25 @@ u128 R3000DebugInterface::getRegister(int cat, int num)
 	return u128::From32(value);
 }
 
+const void* R3000DebugInterface::getRegisterPointer(int cat, int num, int& size)
+{
+	if (cat != IOPCAT_GPR)
+		return NULL;
+
+	size = 4;
+	switch (num)
+	{
+	case 32:	// pc
+		return &psxRegs.pc;
+	case 33:	// hi
+		return &psxRegs.GPR.n.hi;
+	case 34:	// lo
+		return &psxRegs.GPR.n.lo;
+	default:
+		return &psxRegs.GPR.r[num];
+	}
+}
+
 wxString R3000DebugInterface::getRegisterString(int cat, int num)
 {
 	switch (cat)
@@ -879,6 +953,15 @@ bool R3000DebugInterface::isValidAddress(u32 addr)
 	return !(addr & 0x40000000) && vtlb_GetPhyPtr(addr & 0x1FFFFFFF) != NULL;
 }
 
+const u8* R3000DebugInterface::getPagePointer(u32 address)
+{
+	address &= ~0xFFF;
+	if (!isValidAddress(address))
+		return NULL;
+
+	return iopVirtMemR<u8>(address);
+}
+
 u32 R3000DebugInterface::getCycles()
 {
 	return psxRegs.cycle;
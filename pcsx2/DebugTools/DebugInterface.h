@@ -47,6 +47,8 @@ public:
 	virtual RegisterType getRegisterType(int cat) = 0;
 	virtual const char* getRegisterName(int cat, int num) = 0;
 	virtual u128 getRegister(int cat, int num) = 0;
+	// points to the low 32 or 64 bits of a GPR (including pc, hi and lo), or is NULL for other registers
+	virtual const void* getRegisterPointer(int cat, int num, int& size) = 0;
 	virtual wxString getRegisterString(int cat, int num) = 0;
 	virtual u128 getHI() = 0;
 	virtual u128 getLO() = 0;
@@ -56,11 +58,15 @@ public:
 	
 	virtual std::string disasm(u32 address, bool simplify) = 0;
 	virtual bool isValidAddress(u32 address) = 0;
+	// points to the start of the 4 KB page holding address if it's plain memory, or is NULL if it has to go through read32
+	virtual const u8* getPagePointer(u32 address) = 0;
 	virtual u32 getCycles() = 0;
 	virtual BreakPointCpu getCpuType() = 0;
 	
 	bool initExpression(const char* exp, PostfixExpression& dest);
 	bool parseExpression(PostfixExpression& exp, u64& dest);
+	bool compileExpression(const PostfixExpression& exp, CompiledExpression& dest);
+	bool evaluateExpression(const CompiledExpression& exp, u64& dest);
 	bool isAlive();
 	bool isCpuPaused();
 	void pauseCpu();
@@ -87,6 +93,7 @@ public:
 	virtual RegisterType getRegisterType(int cat);
 	virtual const char* getRegisterName(int cat, int num);
 	virtual u128 getRegister(int cat, int num);
+	virtual const void* getRegisterPointer(int cat, int num, int& size);
 	virtual wxString getRegisterString(int cat, int num);
 	virtual u128 getHI();
 	virtual u128 getLO();
@@ -96,6 +103,7 @@ public:
 
 	virtual std::string disasm(u32 address, bool simplify);
 	virtual bool isValidAddress(u32 address);
+	virtual const u8* getPagePointer(u32 address);
 	virtual u32 getCycles();
 	virtual BreakPointCpu getCpuType();
 };
@@ -120,6 +128,7 @@ public:
 	virtual RegisterType getRegisterType(int cat);
 	virtual const char* getRegisterName(int cat, int num);
 	virtual u128 getRegister(int cat, int num);
+	virtual const void* getRegisterPointer(int cat, int num, int& size);
 	virtual wxString getRegisterString(int cat, int num);
 	virtual u128 getHI();
 	virtual u128 getLO();
@@ -129,6 +138,7 @@ public:
 
 	virtual std::string disasm(u32 address, bool simplify);
 	virtual bool isValidAddress(u32 address);
+	virtual const u8* getPagePointer(u32 address);
 	virtual u32 getCycles();
 	virtual BreakPointCpu getCpuType();
 };
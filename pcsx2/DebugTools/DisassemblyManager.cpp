@@ -18,6 +18,7 @@
 #include <string>
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 
 #include "DisassemblyManager.h"
 #include "Memory.h"
@@ -31,18 +32,75 @@ bool isInInterval(u32 start, u32 size, u32 value)
 	return start <= value && value <= (start+size-1);
 }
 
-static u32 computeHash(u32 address, u32 size)
+struct PageHash
 {
-	u32 end = address+size;
-	u32 hash = 0xBACD7814;
-	while (address < end)
+	u64 hash;
+	u32 cycles;
+};
+
+// Content hashes of plain memory pages, valid until the owning cpu runs again.  Every repaint
+// rechecks all visible entries, so while the cpu is paused this doesn't read memory at all,
+// and while it's running each page is hashed once per repaint instead of once per entry.
+static std::unordered_map<u64,PageHash> pageHashes;
+
+static u64 hashWord(u64 hash, u32 word)
+{
+	return (hash ^ word) * 0x100000001B3ULL;
+}
+
+static u64 computePageHash(DebugInterface* cpu, u32 page, u32 start, u64 end)
+{
+	const u8* ptr = cpu->getPagePointer(page);
+	u64 hash = 0xCBF29CE484222325ULL;
+
+	// hardware pages may have read side effects, so only the requested part is read and nothing is cached
+	if (ptr == NULL)
+	{
+		for (u64 address = start; address < end; address += 4)
+			hash = hashWord(hash,cpu->read32((u32)address));
+		return hash;
+	}
+
+	const u64 key = ((u64)cpu->getCpuType() << 32) | page;
+	const u32 cycles = cpu->getCycles();
+	auto it = pageHashes.find(key);
+	if (it != pageHashes.end() && it->second.cycles == cycles)
+		return it->second.hash;
+
+	for (u32 offset = 0; offset < 0x1000; offset += 4)
 	{
-		hash += memRead32(address);
-		address += 4;
+		u32 word;
+		memcpy(&word,ptr+offset,4);
+		hash = hashWord(hash,word);
 	}
+
+	pageHashes[key] = {hash,cycles};
 	return hash;
 }
 
+static u32 computeHash(DebugInterface* cpu, u32 address, u32 size)
+{
+	u64 hash = 0xBACD7814;
+	if (size == 0)
+		return (u32)hash;
+
+	const u32 last = address+size-1;
+	for (u32 page = address & ~0xFFF; ; page += 0x1000)
+	{
+		const u32 start = std::max(page,address & ~3);
+		const u64 end = std::min<u64>((u64)page+0x1000,(u64)last+1);
+		hash = hash*31 + computePageHash(cpu,page,start,end);
+		if (page == (last & ~0xFFF))
+			break;
+	}
+	return (u32)(hash ^ (hash >> 32));
+}
+
+void DisassemblyManager::clearPageHashes()
+{
+	pageHashes.clear();
+}
+
 
 void parseDisasm(const char* disasm, char* opcode, char* arguments, bool insertSymbols)
 {
@@ -343,18 +401,19 @@ void DisassemblyManager::clear()
 		delete it->second;
 	}
 	entries.clear();
+	clearPageHashes();
 }
 
 DisassemblyFunction::DisassemblyFunction(DebugInterface* _cpu, u32 _address, u32 _size): address(_address), size(_size)
 {
 	cpu = _cpu;
-	hash = computeHash(address,size);
+	hash = computeHash(cpu,address,size);
 	load();
 }
 
 void DisassemblyFunction::recheck()
 {
-	u32 newHash = computeHash(address,size);
+	u32 newHash = computeHash(cpu,address,size);
 	if (hash != newHash)
 	{
 		hash = newHash;
@@ -816,13 +875,13 @@ bool DisassemblyMacro::disassemble(u32 address, DisassemblyLineInfo& dest, bool
 DisassemblyData::DisassemblyData(DebugInterface* _cpu, u32 _address, u32 _size, DataType _type): address(_address), size(_size), type(_type)
 {
 	cpu = _cpu;
-	hash = computeHash(address,size);
+	hash = computeHash(cpu,address,size);
 	createLines();
 }
 
 void DisassemblyData::recheck()
 {
-	u32 newHash = computeHash(address,size);
+	u32 newHash = computeHash(cpu,address,size);
 	if (newHash != hash)
 	{
 		hash = newHash;
@@ -206,6 +206,8 @@ public:
 	u32 getNthNextAddress(u32 address, int n = 1);
 
 	static int getMaxParamChars() { return maxParamChars; };
+	// forgets the cached page hashes, needed when memory changes without the cpu running
+	static void clearPageHashes();
 private:
 	DisassemblyEntry* getEntry(u32 address);
 	std::map<u32,DisassemblyEntry*> entries;
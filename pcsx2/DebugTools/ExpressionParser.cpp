@@ -590,6 +590,229 @@ bool parsePostfixExpression(PostfixExpression& exp, IExpressionFunctions* funcs,
 	return true;
 }
 
+// operations of a compiled expression besides the ExpressionOpcodeType ones
+enum
+{
+	EXCOMP_CONST = EXOP_COUNT,	// value
+	EXCOMP_LOAD32,				// *(u32*)ptr
+	EXCOMP_LOAD64,				// *(u64*)ptr
+	EXCOMP_REF,					// getReferenceValue(value)
+	EXCOMP_MEM,					// memory at the address on the stack, size bytes
+	EXCOMP_MEMSIZE				// memory with the size on the stack
+};
+
+bool compilePostfixExpression(const PostfixExpression& exp, IExpressionFunctions* funcs, CompiledExpression& dest)
+{
+	dest.clear();
+
+	u32 depth = 0;
+	bool useFloat = false;
+
+	for (size_t num = 0; num < exp.size(); num++)
+	{
+		CompiledExpression::Op op = {};
+
+		switch (exp[num].first)
+		{
+		case EXCOMM_CONST:
+		case EXCOMM_CONST_FLOAT:
+			useFloat = useFloat || exp[num].first == EXCOMM_CONST_FLOAT;
+			op.type = EXCOMP_CONST;
+			op.value = exp[num].second;
+			depth++;
+			break;
+		case EXCOMM_REF:
+		{
+			useFloat = useFloat || funcs->getReferenceType(exp[num].second) == EXPR_TYPE_FLOAT;
+
+			int size = 0;
+			op.ptr = funcs->getReferencePointer(exp[num].second, size);
+			if (op.ptr && (size == 4 || size == 8))
+				op.type = size == 4 ? EXCOMP_LOAD32 : EXCOMP_LOAD64;
+			else
+			{
+				op.type = EXCOMP_REF;
+				op.value = exp[num].second;
+				op.ptr = NULL;
+			}
+			depth++;
+			break;
+		}
+		case EXCOMM_OP:
+		{
+			const u64 opcode = exp[num].second;
+			if (opcode >= EXOP_COUNT || depth < ExpressionOpcodes[opcode].args)
+				return false;
+			depth -= ExpressionOpcodes[opcode].args;
+
+			op.type = (u16)opcode;
+			switch (opcode)
+			{
+			case EXOP_MEMSIZE:
+				if (num + 1 >= exp.size() || exp[++num].second != EXOP_MEM)
+					return false;
+
+				// a constant size is the usual case, fold it into the access
+				if (!dest.empty() && dest.ops.back().type == EXCOMP_CONST)
+				{
+					const u64 size = dest.ops.back().value;
+					if (size != 1 && size != 2 && size != 4 && size != 8)
+						return false;
+
+					dest.ops.pop_back();
+					op.type = EXCOMP_MEM;
+					op.size = (u8)size;
+				}
+				else
+					op.type = EXCOMP_MEMSIZE;
+				break;
+			case EXOP_MEM:
+				op.type = EXCOMP_MEM;
+				op.size = 4;
+				break;
+			case EXOP_TERTIF:
+				return false;
+			case EXOP_TERTELSE:
+				if (num + 1 >= exp.size() || exp[++num].second != EXOP_TERTIF)
+					return false;
+				break;
+			default:
+				// brackets leave the stack alone
+				if (ExpressionOpcodes[opcode].args == 0)
+					continue;
+				break;
+			}
+
+			// unary plus drops its argument, like parsePostfixExpression does
+			if (opcode != EXOP_SIGNPLUS)
+				depth++;
+			op.useFloat = useFloat;
+			break;
+		}
+		default:
+			return false;
+		}
+
+		if (depth > CompiledExpression::MaxStack)
+			return false;
+
+		dest.ops.push_back(op);
+	}
+
+	if (depth != 1)
+	{
+		dest.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool evaluateCompiledExpression(const CompiledExpression& exp, IExpressionFunctions* funcs, u64& dest)
+{
+	u64 stack[CompiledExpression::MaxStack];
+	u32 sp = 0;
+
+	for (const CompiledExpression::Op& op : exp.ops)
+	{
+		// named like the arguments of parsePostfixExpression, arg0 is the top of the stack
+		const u64 arg0 = sp >= 1 ? stack[sp - 1] : 0;
+		const u64 arg1 = sp >= 2 ? stack[sp - 2] : 0;
+
+		switch (op.type)
+		{
+		case EXCOMP_CONST:
+			stack[sp++] = op.value;
+			break;
+		case EXCOMP_LOAD32:
+			stack[sp++] = *(const u32*)op.ptr;
+			break;
+		case EXCOMP_LOAD64:
+			stack[sp++] = *(const u64*)op.ptr;
+			break;
+		case EXCOMP_REF:
+			stack[sp++] = funcs->getReferenceValue(op.value);
+			break;
+		case EXCOMP_MEM:
+			if (!funcs->getMemoryValue(arg0, op.size, stack[sp - 1], expressionError))
+				return false;
+			break;
+		case EXCOMP_MEMSIZE:
+			sp--;
+			if (!funcs->getMemoryValue(arg1, arg0, stack[sp - 1], expressionError))
+				return false;
+			break;
+		case EXOP_SIGNPLUS:
+			sp--;
+			break;
+		case EXOP_SIGNMINUS:
+			stack[sp - 1] = op.useFloat ? (u64)(0.0 - (float)arg0) : 0 - arg0;
+			break;
+		case EXOP_BITNOT:
+			stack[sp - 1] = ~arg0;
+			break;
+		case EXOP_LOGNOT:
+			stack[sp - 1] = !arg0;
+			break;
+		case EXOP_TERTELSE:
+			sp -= 2;
+			stack[sp - 1] = stack[sp - 1] ? arg1 : arg0;
+			break;
+		default:
+		{
+			const float fArg0 = arg0;
+			const float fArg1 = arg1;
+			u64 result;
+
+			switch (op.type)
+			{
+			case EXOP_MUL:			result = op.useFloat ? (u64)(fArg1 * fArg0) : arg1 * arg0; break;
+			case EXOP_DIV:
+				if (arg0 == 0)
+				{
+					sprintf(expressionError,"Division by zero");
+					return false;
+				}
+				result = op.useFloat ? (u64)(fArg1 / fArg0) : arg1 / arg0;
+				break;
+			case EXOP_MOD:
+				if (arg0 == 0)
+				{
+					sprintf(expressionError,"Modulo by zero");
+					return false;
+				}
+				result = arg1 % arg0;
+				break;
+			case EXOP_ADD:			result = op.useFloat ? (u64)(fArg1 + fArg0) : arg1 + arg0; break;
+			case EXOP_SUB:			result = op.useFloat ? (u64)(fArg1 - fArg0) : arg1 - arg0; break;
+			case EXOP_SHL:			result = arg1 << arg0; break;
+			case EXOP_SHR:			result = arg1 >> arg0; break;
+			case EXOP_GREATEREQUAL:	result = op.useFloat ? fArg1 >= fArg0 : arg1 >= arg0; break;
+			case EXOP_GREATER:		result = op.useFloat ? fArg1 > fArg0 : arg1 > arg0; break;
+			case EXOP_LOWEREQUAL:	result = op.useFloat ? fArg1 <= fArg0 : arg1 <= arg0; break;
+			case EXOP_LOWER:		result = op.useFloat ? fArg1 < fArg0 : arg1 < arg0; break;
+			case EXOP_EQUAL:		result = arg1 == arg0; break;
+			case EXOP_NOTEQUAL:		result = arg1 != arg0; break;
+			case EXOP_BITAND:		result = arg1 & arg0; break;
+			case EXOP_XOR:			result = arg1 ^ arg0; break;
+			case EXOP_BITOR:		result = arg1 | arg0; break;
+			case EXOP_LOGAND:		result = arg1 && arg0; break;
+			case EXOP_LOGOR:		result = arg1 || arg0; break;
+			default:
+				return false;
+			}
+
+			stack[--sp - 1] = result;
+			break;
+		}
+		}
+	}
+
+	if (sp != 1) return false;
+	dest = stack[0];
+	return true;
+}
+
 bool parseExpression(char* exp, IExpressionFunctions* funcs, u64& dest)
 {
 	PostfixExpression postfix;
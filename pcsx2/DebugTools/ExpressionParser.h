@@ -34,10 +34,36 @@ public:
 	virtual bool parseSymbol(char* str, u64& symbolValue) = 0;
 	virtual u64 getReferenceValue(u64 referenceIndex) = 0;
 	virtual ExpressionType getReferenceType(u64 referenceIndex) = 0;
+	// returns a pointer to the value of the reference (4 or 8 bytes), or NULL if it has to be read with getReferenceValue
+	virtual const void* getReferencePointer(u64 referenceIndex, int& size) = 0;
 	virtual bool getMemoryValue(u32 address, int size, u64& dest, char* error) = 0;
 };
 
+// A postfix expression flattened for repeated evaluation: references are resolved to
+// pointers where possible, and the float mode and memory access size of each operation
+// are known up front.  Evaluates to the same result as parsePostfixExpression.
+struct CompiledExpression
+{
+	static const u32 MaxStack = 32;
+
+	struct Op
+	{
+		u16 type;
+		u8 size;
+		bool useFloat;
+		u64 value;
+		const void* ptr;
+	};
+
+	std::vector<Op> ops;
+
+	bool empty() const { return ops.empty(); }
+	void clear() { ops.clear(); }
+};
+
 bool initPostfixExpression(const char* infix, IExpressionFunctions* funcs, PostfixExpression& dest);
 bool parsePostfixExpression(PostfixExpression& exp, IExpressionFunctions* funcs, u64& dest);
+bool compilePostfixExpression(const PostfixExpression& exp, IExpressionFunctions* funcs, CompiledExpression& dest);
+bool evaluateCompiledExpression(const CompiledExpression& exp, IExpressionFunctions* funcs, u64& dest);
 bool parseExpression(const char* exp, IExpressionFunctions* funcs, u64& dest);
 const char* getExpressionError();
@@ -15,6 +15,10 @@
 
 #include "PrecompiledHeader.h"
 #include "MIPSAnalyst.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
 #include "Debug.h"
 #include "DebugInterface.h"
 #include "SymbolMap.h"
@@ -39,9 +43,174 @@ static std::vector<MIPSAnalyst::AnalyzedFunction> functions;
 
 namespace MIPSAnalyst
 {
-	u32 GetJumpTarget(u32 addr)
+	// How far past its end address a scan reads in practice: branches reach 128 KB ahead,
+	// and jumpback scans look up to MAX_FUNC_SIZE + MAX_AHEAD_SCAN past the furthest branch.
+	static const u32 MAX_AHEAD_SCAN = 0x1000;
+	// Maybe a bit high... just to make sure we don't get confused by recursive tail recursion.
+	static const u32 MAX_FUNC_SIZE = 0x20000;
+	static const u32 SCAN_REACH = 0x20000 + MAX_FUNC_SIZE + MAX_AHEAD_SCAN + 0x1000;
+	static const u32 SCAN_CHUNK_SIZE = 0x10000;
+
+	// Code and function symbols around the scanned range, copied on the calling thread so the
+	// scan workers neither go through the vtlb nor take the symbol map lock for every opcode.
+	class ScanSnapshot
+	{
+	public:
+		void Load(u32 startAddr, u32 endAddr);
+
+		// returns false if addr isn't plain memory inside the snapshot and has to be read live
+		bool Read32(u32 addr, u32& value) const
+		{
+			const u64 offset = (u64)addr - base;
+			if (addr < base || offset >= code.size() * 4 || live[offset >> 12])
+				return false;
+
+			value = (addr & 3) ? 0xFFFFFFFF : code[offset >> 2];
+			return true;
+		}
+
+		bool GetFunction(u32 addr, u32& start, u32& size) const
+		{
+			auto it = std::upper_bound(symbols.begin(), symbols.end(), addr, [](u32 value, const Symbol& sym) { return value < sym.start; });
+			if (it == symbols.begin())
+				return false;
+
+			--it;
+			if (addr >= it->end)
+				return false;
+
+			start = it->start;
+			size = it->size;
+			return true;
+		}
+
+		// combined hash of everything a scan of [startAddr, endAddr] that read [firstRead, lastRead]
+		// depends on, or 0 if some of that memory isn't in the snapshot
+		u64 Hash(u32 startAddr, u32 endAddr, u32 firstRead, u32 lastRead) const;
+
+	private:
+		struct Symbol
+		{
+			u32 start;
+			u32 end;
+			u32 size;
+		};
+
+		u32 base = 0;
+		std::vector<u32> code;
+		std::vector<u64> pageHashes;
+		std::vector<bool> live;
+		std::vector<Symbol> symbols;
+	};
+
+	static u64 HashValue(u64 hash, u64 value)
+	{
+		return (hash ^ value) * 0x100000001B3ULL;
+	}
+
+	void ScanSnapshot::Load(u32 startAddr, u32 endAddr)
+	{
+		base = startAddr & ~0xFFF;
+		const u64 limit = std::min<u64>(((u64)endAddr + SCAN_REACH + 0xFFF) & ~0xFFFULL, 0x100000000ULL);
+		const size_t pageCount = (size_t)((limit - base) >> 12);
+
+		code.resize(pageCount * 1024);
+		pageHashes.assign(pageCount, 0);
+		live.assign(pageCount, false);
+
+		for (size_t i = 0; i < pageCount; i++) {
+			const u32 page = base + (u32)(i << 12);
+			u32* dest = &code[i * 1024];
+
+			if (const u8* ptr = r5900Debug.getPagePointer(page)) {
+				memcpy(dest, ptr, 0x1000);
+			} else if (!r5900Debug.isValidAddress(page)) {
+				// what read32 returns for them
+				std::fill(dest, dest + 1024, 0xFFFFFFFF);
+			} else {
+				live[i] = true;
+				continue;
+			}
+
+			u64 hash = 0xCBF29CE484222325ULL;
+			for (int j = 0; j < 1024; j++)
+				hash = HashValue(hash, dest[j]);
+			pageHashes[i] = hash;
+		}
+
+		// same intervals as SymbolMap::GetFunctionStart: each one ends at the next function at the latest
+		symbols.clear();
+		u32 sym = symbolMap.GetFunctionStart(base);
+		if (sym == SymbolMap::INVALID_ADDRESS)
+			sym = symbolMap.GetNextSymbolAddress(base, ST_FUNCTION);
+
+		while (sym != SymbolMap::INVALID_ADDRESS && sym < limit) {
+			const u32 size = symbolMap.GetFunctionSize(sym);
+			const u32 next = symbolMap.GetNextSymbolAddress(sym, ST_FUNCTION);
+
+			u32 end = sym + size;
+			if (end < sym)
+				end = sym;
+			if (next != SymbolMap::INVALID_ADDRESS)
+				end = std::min(end, next);
+
+			symbols.push_back({sym, end, size});
+			sym = next;
+		}
+	}
+
+	u64 ScanSnapshot::Hash(u32 startAddr, u32 endAddr, u32 firstRead, u32 lastRead) const
+	{
+		if (firstRead < base || (u64)lastRead - base >= code.size() * 4)
+			return 0;
+
+		u64 hash = HashValue(HashValue(0xCBF29CE484222325ULL, startAddr), endAddr);
+		for (u32 i = (firstRead - base) >> 12; i <= (lastRead - base) >> 12; i++) {
+			if (live[i])
+				return 0;
+			hash = HashValue(hash, pageHashes[i]);
+		}
+
+		for (const Symbol& sym : symbols) {
+			if (sym.start <= endAddr && sym.end > startAddr)
+				hash = HashValue(HashValue(HashValue(hash, sym.start), sym.end), sym.size);
+		}
+
+		return hash == 0 ? 1 : hash;
+	}
+
+	// Reads code for one scan.  Scans on worker threads can't read live memory, they fail
+	// instead and get redone on the calling thread.
+	struct ScanReader
+	{
+		const ScanSnapshot& code;
+		bool allowLive;
+		bool failed;
+		u32 firstRead;
+		u32 lastRead;
+
+		ScanReader(const ScanSnapshot& _code, bool _allowLive)
+			: code(_code), allowLive(_allowLive), failed(false), firstRead(0xFFFFFFFF), lastRead(0) { }
+
+		u32 Read32(u32 addr)
+		{
+			firstRead = std::min(firstRead, addr);
+			lastRead = std::max(lastRead, addr);
+
+			u32 value;
+			if (code.Read32(addr, value))
+				return value;
+
+			if (!allowLive) {
+				failed = true;
+				return 0xFFFFFFFF;
+			}
+			return r5900Debug.read32(addr);
+		}
+	};
+
+	u32 GetJumpTarget(u32 addr, u32 op)
 	{
-		u32 op = r5900Debug.read32(addr);
 		const R5900::OPCODE& opcode = R5900::GetInstruction(op);
 
 		if ((opcode.flags & IS_BRANCH) && (opcode.flags & BRANCHTYPE_MASK) == BRANCHTYPE_JUMP)
@@ -53,9 +222,8 @@ namespace MIPSAnalyst
 			return INVALIDTARGET;
 	}
 
-	u32 GetBranchTarget(u32 addr)
+	u32 GetBranchTarget(u32 addr, u32 op)
 	{
-		u32 op = r5900Debug.read32(addr);
 		const R5900::OPCODE& opcode = R5900::GetInstruction(op);
 		
 		int branchType = (opcode.flags & BRANCHTYPE_MASK);
@@ -65,9 +233,8 @@ namespace MIPSAnalyst
 			return INVALIDTARGET;
 	}
 	
-	u32 GetBranchTargetNoRA(u32 addr)
+	u32 GetBranchTargetNoRA(u32 addr, u32 op)
 	{
-		u32 op = r5900Debug.read32(addr);
 		const R5900::OPCODE& opcode = R5900::GetInstruction(op);
 		
 		int branchType = (opcode.flags & BRANCHTYPE_MASK);
@@ -82,9 +249,8 @@ namespace MIPSAnalyst
 			return INVALIDTARGET;
 	}
 
-	u32 GetSureBranchTarget(u32 addr)
+	u32 GetSureBranchTarget(u32 addr, u32 op)
 	{
-		u32 op = r5900Debug.read32(addr);
 		const R5900::OPCODE& opcode = R5900::GetInstruction(op);
 		
 		if ((opcode.flags & IS_BRANCH) && (opcode.flags & BRANCHTYPE_MASK) == BRANCHTYPE_BRANCH)
@@ -136,11 +302,7 @@ namespace MIPSAnalyst
 	}
 
 
-	static u32 ScanAheadForJumpback(u32 fromAddr, u32 knownStart, u32 knownEnd) {
-		static const u32 MAX_AHEAD_SCAN = 0x1000;
-		// Maybe a bit high... just to make sure we don't get confused by recursive tail recursion.
-		static const u32 MAX_FUNC_SIZE = 0x20000;
-
+	static u32 ScanAheadForJumpback(ScanReader& reader, u32 fromAddr, u32 knownStart, u32 knownEnd) {
 		if (fromAddr > knownEnd + MAX_FUNC_SIZE) {
 			return INVALIDTARGET;
 		}
@@ -155,10 +317,10 @@ namespace MIPSAnalyst
 		u32 furthestJumpbackAddr = INVALIDTARGET;
 
 		for (u32 ahead = fromAddr; ahead < fromAddr + MAX_AHEAD_SCAN; ahead += 4) {
-			u32 aheadOp = r5900Debug.read32(ahead);
-			u32 target = GetBranchTargetNoRA(ahead);
+			u32 aheadOp = reader.Read32(ahead);
+			u32 target = GetBranchTargetNoRA(ahead, aheadOp);
 			if (target == INVALIDTARGET && ((aheadOp & 0xFC000000) == 0x08000000)) {
-				target = GetJumpTarget(ahead);
+				target = GetJumpTarget(ahead, aheadOp);
 			}
 
 			if (target != INVALIDTARGET) {
@@ -179,10 +341,10 @@ namespace MIPSAnalyst
 
 		if (closestJumpbackAddr != INVALIDTARGET && furthestJumpbackAddr == INVALIDTARGET) {
 			for (u32 behind = closestJumpbackTarget; behind < fromAddr; behind += 4) {
-				u32 behindOp = r5900Debug.read32(behind);
-				u32 target = GetBranchTargetNoRA(behind);
+				u32 behindOp = reader.Read32(behind);
+				u32 target = GetBranchTargetNoRA(behind, behindOp);
 				if (target == INVALIDTARGET && ((behindOp & 0xFC000000) == 0x08000000)) {
-					target = GetJumpTarget(behind);
+					target = GetJumpTarget(behind, behindOp);
 				}
 
 				if (target != INVALIDTARGET) {
@@ -196,7 +358,38 @@ namespace MIPSAnalyst
 		return furthestJumpbackAddr;
 	}
 
-	void ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+	struct ScanResult {
+		u32 startAddr;
+		u32 endAddr;
+		// finished functions, in the order they were found
+		std::vector<AnalyzedFunction> functions;
+		// addresses where a function began from a clean scan state, with the number of functions found before
+		std::vector<std::pair<u32, size_t>> restarts;
+		// the function still open when the scan ran past endAddr
+		AnalyzedFunction last;
+		// set when the scan reached one of the stop addresses instead
+		bool stopped;
+		u32 stopAddr;
+		bool failed;
+		u32 firstRead;
+		u32 lastRead;
+		u64 key;
+	};
+
+	static bool FindRestart(const ScanResult& chunk, u32 addr, size_t& functionCount) {
+		auto it = std::lower_bound(chunk.restarts.begin(), chunk.restarts.end(), std::make_pair(addr, (size_t)0));
+		if (it == chunk.restarts.end() || it->first != addr)
+			return false;
+
+		functionCount = it->second;
+		return true;
+	}
+
+	// Scans [startAddr, endAddr] as if a function began at startAddr.  Once a function ends the scan
+	// state is clean again, so everything found after an address where two scans both restarted is
+	// the same for both of them.  That's what lets chunks be scanned on their own and stitched together:
+	// if chunks isn't NULL, the scan stops at the first restart it shares with a chunk from firstChunk on.
+	static void ScanRange(ScanReader& reader, u32 startAddr, u32 endAddr, const std::vector<ScanResult>* chunks, size_t firstChunk, ScanResult& result) {
 		AnalyzedFunction currentFunction = {startAddr};
 
 		u32 furthestBranch = 0;
@@ -204,19 +397,36 @@ namespace MIPSAnalyst
 		bool end = false;
 		bool isStraightLeaf = true;
 
-		functions.clear();
+		result.startAddr = startAddr;
+		result.endAddr = endAddr;
+		result.stopped = false;
+		result.key = 0;
 
 		u32 addr;
 		for (addr = startAddr; addr <= endAddr; addr += 4) {
+			if (addr == currentFunction.start) {
+				// chunks only record restarts inside their own range
+				if (chunks != NULL) {
+					const size_t chunk = (addr - (*chunks)[0].startAddr) / SCAN_CHUNK_SIZE;
+					size_t functionCount;
+					if (chunk >= firstChunk && chunk < chunks->size() && FindRestart((*chunks)[chunk], addr, functionCount)) {
+						result.stopped = true;
+						result.stopAddr = addr;
+						break;
+					}
+				}
+				result.restarts.push_back(std::make_pair(addr, result.functions.size()));
+			}
+
 			// Use pre-existing symbol map info if available. May be more reliable.
-			SymbolInfo syminfo;
-			if (symbolMap.GetSymbolInfo(&syminfo, addr, ST_FUNCTION)) {
-				addr = syminfo.address + syminfo.size - 4;
+			u32 symStart, symSize;
+			if (reader.code.GetFunction(addr, symStart, symSize)) {
+				addr = symStart + symSize - 4;
 
 				// We still need to insert the func for hashing purposes.
-				currentFunction.start = syminfo.address;
-				currentFunction.end = syminfo.address + syminfo.size - 4;
-				functions.push_back(currentFunction);
+				currentFunction.start = symStart;
+				currentFunction.end = symStart + symSize - 4;
+				result.functions.push_back(currentFunction);
 				currentFunction.start = addr + 4;
 				furthestBranch = 0;
 				looking = false;
@@ -224,16 +434,16 @@ namespace MIPSAnalyst
 				continue;
 			}
 
-			u32 op = r5900Debug.read32(addr);
+			u32 op = reader.Read32(addr);
 
-			u32 target = GetBranchTargetNoRA(addr);
+			u32 target = GetBranchTargetNoRA(addr, op);
 			if (target != INVALIDTARGET) {
 				isStraightLeaf = false;
 				if (target > furthestBranch) {
 					furthestBranch = target;
 				}
 			} else if ((op & 0xFC000000) == 0x08000000) {
-				u32 sureTarget = GetJumpTarget(addr);
+				u32 sureTarget = GetJumpTarget(addr, op);
 				// Check for a tail call.  Might not even have a jr ra.
 				if (sureTarget != INVALIDTARGET && sureTarget < currentFunction.start) {
 					if (furthestBranch > addr) {
@@ -245,7 +455,7 @@ namespace MIPSAnalyst
 				} else if (sureTarget != INVALIDTARGET && sureTarget > addr && sureTarget > furthestBranch) {
 					// A jump later.  Probably tail, but let's check if it jumps back.
 					u32 knownEnd = furthestBranch == 0 ? addr : furthestBranch;
-					u32 jumpback = ScanAheadForJumpback(sureTarget, currentFunction.start, knownEnd);
+					u32 jumpback = ScanAheadForJumpback(reader, sureTarget, currentFunction.start, knownEnd);
 					if (jumpback != INVALIDTARGET && jumpback > addr && jumpback > knownEnd) {
 						furthestBranch = jumpback;
 					} else {
@@ -271,10 +481,10 @@ namespace MIPSAnalyst
 
 			if (looking) {
 				if (addr >= furthestBranch) {
-					u32 sureTarget = GetSureBranchTarget(addr);
+					u32 sureTarget = GetSureBranchTarget(addr, reader.Read32(addr));
 					// Regular j only, jals are to new funcs.
 					if (sureTarget == INVALIDTARGET && ((op & 0xFC000000) == 0x08000000)) {
-						sureTarget = GetJumpTarget(addr);
+						sureTarget = GetJumpTarget(addr, reader.Read32(addr));
 					}
 
 					if (sureTarget != INVALIDTARGET && sureTarget < addr) {
@@ -283,7 +493,7 @@ namespace MIPSAnalyst
 						// Okay, we have a downward jump.  Might be an else or a tail call...
 						// If there's a jump back upward in spitting distance of it, it's an else.
 						u32 knownEnd = furthestBranch == 0 ? addr : furthestBranch;
-						u32 jumpback = ScanAheadForJumpback(sureTarget, currentFunction.start, knownEnd);
+						u32 jumpback = ScanAheadForJumpback(reader, sureTarget, currentFunction.start, knownEnd);
 						if (jumpback != INVALIDTARGET && jumpback > addr && jumpback > knownEnd) {
 							furthestBranch = jumpback;
 						}
@@ -294,12 +504,12 @@ namespace MIPSAnalyst
 			if (end) {
 				// most functions are aligned to 8 or 16 bytes
 				// add the padding to this one
-				while (((addr+8) % 16)  && r5900Debug.read32(addr+8) == 0)
+				while (((addr+8) % 16)  && reader.Read32(addr+8) == 0)
 					addr += 4;
 
 				currentFunction.end = addr + 4;
 				currentFunction.isStraightLeaf = isStraightLeaf;
-				functions.push_back(currentFunction);
+				result.functions.push_back(currentFunction);
 				furthestBranch = 0;
 				addr += 4;
 				looking = false;
@@ -311,7 +521,104 @@ namespace MIPSAnalyst
 		}
 
 		currentFunction.end = addr + 4;
-		functions.push_back(currentFunction);
+		result.last = currentFunction;
+		result.failed = reader.failed;
+		result.firstRead = reader.firstRead;
+		result.lastRead = reader.lastRead;
+	}
+
+	// Chunk results of the previous scan, keyed by chunk start.  A chunk is only scanned again
+	// if a page it read or a function symbol inside it changed.
+	static std::map<u32, ScanResult> scanCache;
+
+	static void ScanChunk(const ScanSnapshot& code, ScanResult& chunk, bool allowLive) {
+		ScanReader reader(code, allowLive);
+		const u32 startAddr = chunk.startAddr, endAddr = chunk.endAddr;
+
+		chunk = ScanResult();
+		ScanRange(reader, startAddr, endAddr, NULL, 0, chunk);
+		if (chunk.firstRead > chunk.lastRead)
+			chunk.firstRead = chunk.lastRead = startAddr;
+		if (!chunk.failed)
+			chunk.key = code.Hash(startAddr, endAddr, chunk.firstRead, chunk.lastRead);
+	}
+
+	void ScanForFunctions(u32 startAddr, u32 endAddr, bool insertSymbols) {
+		ScanSnapshot code;
+		code.Load(startAddr, endAddr);
+
+		std::vector<ScanResult> chunks;
+		for (u64 chunkStart = startAddr; ; chunkStart += SCAN_CHUNK_SIZE) {
+			ScanResult chunk;
+			chunk.startAddr = (u32)chunkStart;
+			chunk.endAddr = (u32)std::min<u64>(chunkStart + SCAN_CHUNK_SIZE - 4, endAddr);
+			chunk.key = 0;
+
+			auto cached = scanCache.find(chunk.startAddr);
+			if (cached != scanCache.end() && cached->second.endAddr == chunk.endAddr && cached->second.key != 0 &&
+				cached->second.key == code.Hash(chunk.startAddr, chunk.endAddr, cached->second.firstRead, cached->second.lastRead))
+				chunk = std::move(cached->second);
+
+			chunks.push_back(std::move(chunk));
+			if (chunkStart + SCAN_CHUNK_SIZE > endAddr)
+				break;
+		}
+
+		std::vector<size_t> pending;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			if (chunks[i].key == 0)
+				pending.push_back(i);
+		}
+
+		const size_t threadCount = std::min<size_t>(std::thread::hardware_concurrency(), pending.size());
+		if (threadCount > 1) {
+			std::atomic<size_t> nextChunk{0};
+			std::vector<std::thread> workers;
+			for (size_t i = 0; i < threadCount; i++) {
+				workers.emplace_back([&]() {
+					for (size_t n; (n = nextChunk.fetch_add(1)) < pending.size();)
+						ScanChunk(code, chunks[pending[n]], false);
+				});
+			}
+			for (std::thread& worker : workers)
+				worker.join();
+		}
+
+		for (size_t i : pending) {
+			if (threadCount <= 1 || chunks[i].failed)
+				ScanChunk(code, chunks[i], true);
+		}
+
+		// Stitch the chunks together.  Each one only knows where its own functions begin, so from
+		// the function left open at the end of a chunk the scan continues on this thread until it
+		// restarts at an address one of the following chunks restarted at as well.
+		functions.clear();
+		functions.insert(functions.end(), chunks[0].functions.begin(), chunks[0].functions.end());
+		size_t current = 0;
+		AnalyzedFunction last = chunks[0].last;
+		while (current + 1 < chunks.size()) {
+			ScanReader reader(code, true);
+			ScanResult bridge;
+			ScanRange(reader, last.start, endAddr, &chunks, current + 1, bridge);
+			functions.insert(functions.end(), bridge.functions.begin(), bridge.functions.end());
+			if (!bridge.stopped) {
+				last = bridge.last;
+				break;
+			}
+
+			size_t functionCount;
+			current = (bridge.stopAddr - startAddr) / SCAN_CHUNK_SIZE;
+			FindRestart(chunks[current], bridge.stopAddr, functionCount);
+			functions.insert(functions.end(), chunks[current].functions.begin() + functionCount, chunks[current].functions.end());
+			last = chunks[current].last;
+		}
+		functions.push_back(last);
+
+		scanCache.clear();
+		for (ScanResult& chunk : chunks) {
+			if (chunk.key != 0)
+				scanCache[chunk.startAddr] = std::move(chunk);
+		}
 
 		for (auto iter = functions.begin(); iter != functions.end(); iter++) {
 			iter->size = iter->end - iter->start + 4;
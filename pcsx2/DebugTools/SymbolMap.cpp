@@ -41,6 +41,62 @@ void SymbolMap::Clear() {
 	activeData.clear();
 	activeModuleEnds.clear();
 	modules.clear();
+	indexDirty = true;
+}
+
+template <typename Map>
+void SymbolMap::SymbolIndex::Build(const Map& symbols) {
+	intervals.clear();
+	intervals.reserve(symbols.size());
+	recentCount = 0;
+
+	for (auto it = symbols.begin(); it != symbols.end(); ++it) {
+		// a size running past the end of the address space never contains anything
+		u32 start = it->first;
+		u32 end = start + it->second.size;
+		if (end < start)
+			end = start;
+
+		auto next = std::next(it);
+		if (next != symbols.end())
+			end = std::min(end, next->first);
+
+		intervals.push_back({start, end});
+	}
+}
+
+u32 SymbolMap::SymbolIndex::Find(u32 address) {
+	for (int i = 0; i < recentCount; i++) {
+		if (recent[i].start <= address && address < recent[i].end) {
+			const SymbolInterval hit = recent[i];
+			std::move_backward(recent, recent + i, recent + i + 1);
+			recent[0] = hit;
+			return hit.start;
+		}
+	}
+
+	auto it = std::upper_bound(intervals.begin(), intervals.end(), address,
+		[](u32 addr, const SymbolInterval& interval) { return addr < interval.start; });
+	if (it == intervals.begin())
+		return INVALID_ADDRESS;
+
+	--it;
+	if (address >= it->end)
+		return INVALID_ADDRESS;
+
+	recentCount = std::min(recentCount + 1, RecentCount);
+	std::move_backward(recent, recent + recentCount - 1, recent + recentCount);
+	recent[0] = *it;
+	return it->start;
+}
+
+void SymbolMap::UpdateIndex() const {
+	if (!indexDirty)
+		return;
+
+	functionIndex.Build(activeFunctions);
+	dataIndex.Build(activeData);
+	indexDirty = false;
 }
 
 
@@ -225,6 +281,25 @@ std::vector<SymbolEntry> SymbolMap::GetAllSymbols(SymbolType symmask) {
 	return result;
 }
 
+void SymbolMap::Symbolize(const u32* addresses, size_t count, SymbolType symmask, u32* starts, std::string* names) const {
+	std::lock_guard<std::recursive_mutex> guard(m_lock);
+	UpdateIndex();
+
+	for (size_t i = 0; i < count; i++) {
+		u32 start = INVALID_ADDRESS;
+		if (symmask & ST_FUNCTION)
+			start = functionIndex.Find(addresses[i]);
+		if (start == INVALID_ADDRESS && (symmask & ST_DATA))
+			start = dataIndex.Find(addresses[i]);
+
+		starts[i] = start;
+		if (names) {
+			const char* name = GetLabelName(start != INVALID_ADDRESS ? start : addresses[i]);
+			names[i] = name ? name : "";
+		}
+	}
+}
+
 void SymbolMap::AddModule(const char *name, u32 address, u32 size) {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
 
@@ -350,6 +425,7 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 		if (active != activeFunctions.end() && active->second.module == moduleIndex) {
 			activeFunctions.erase(active);
 			activeFunctions.insert(std::make_pair(address, existing->second));
+			indexDirty = true;
 		}
 	} else {
 		FunctionEntry func;
@@ -361,6 +437,7 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 
 		if (IsModuleActive(moduleIndex)) {
 			activeFunctions.insert(std::make_pair(address, func));
+			indexDirty = true;
 		}
 	}
 
@@ -369,29 +446,8 @@ void SymbolMap::AddFunction(const char* name, u32 address, u32 size, int moduleI
 
 u32 SymbolMap::GetFunctionStart(u32 address) const {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeFunctions.upper_bound(address);
-	if (it == activeFunctions.end()) {
-		// check last element
-		auto rit = activeFunctions.rbegin();
-		if (rit != activeFunctions.rend()) {
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no function that contains this address
-		return INVALID_ADDRESS;
-	}
-
-	if (it != activeFunctions.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
-
-	return INVALID_ADDRESS;
+	UpdateIndex();
+	return functionIndex.Find(address);
 }
 
 u32 SymbolMap::GetFunctionSize(u32 startAddress) const {
@@ -440,6 +496,7 @@ void SymbolMap::UpdateActiveSymbols() {
 	activeFunctions.clear();
 	activeLabels.clear();
 	activeData.clear();
+	indexDirty = true;
 
 	for (auto it = functions.begin(), end = functions.end(); it != end; ++it) {
 		const auto mod = activeModuleIndexes.find(it->second.module);
@@ -501,6 +558,7 @@ bool SymbolMap::RemoveFunction(u32 startAddress, bool removeName) {
 		functions.erase(it2);
 	}
 	activeFunctions.erase(it);
+	indexDirty = true;
 
 	if (removeName) {
 		auto labelIt = activeLabels.find(startAddress);
@@ -649,6 +707,7 @@ void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 		if (active != activeData.end() && active->second.module == moduleIndex) {
 			activeData.erase(active);
 			activeData.insert(std::make_pair(address, existing->second));
+			indexDirty = true;
 		}
 	} else {
 		DataEntry entry;
@@ -660,38 +719,15 @@ void SymbolMap::AddData(u32 address, u32 size, DataType type, int moduleIndex) {
 		data[symbolKey] = entry;
 		if (IsModuleActive(moduleIndex)) {
 			activeData.insert(std::make_pair(address, entry));
+			indexDirty = true;
 		}
 	}
 }
 
 u32 SymbolMap::GetDataStart(u32 address) const {
 	std::lock_guard<std::recursive_mutex> guard(m_lock);
-	auto it = activeData.upper_bound(address);
-	if (it == activeData.end())
-	{
-		// check last element
-		auto rit = activeData.rbegin();
-
-		if (rit != activeData.rend())
-		{
-			u32 start = rit->first;
-			u32 size = rit->second.size;
-			if (start <= address && start+size > address)
-				return start;
-		}
-		// otherwise there's no data that contains this address
-		return INVALID_ADDRESS;
-	}
-
-	if (it != activeData.begin()) {
-		it--;
-		u32 start = it->first;
-		u32 size = it->second.size;
-		if (start <= address && start+size > address)
-			return start;
-	}
-
-	return INVALID_ADDRESS;
+	UpdateIndex();
+	return dataIndex.Find(address);
 }
 
 u32 SymbolMap::GetDataSize(u32 startAddress) const {
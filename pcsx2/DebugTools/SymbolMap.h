@@ -66,6 +66,10 @@ public:
 	u32 GetNextSymbolAddress(u32 address, SymbolType symmask);
 	std::string GetDescription(unsigned int address) const;
 	std::vector<SymbolEntry> GetAllSymbols(SymbolType symmask);
+	// Looks up many addresses under a single lock.  For each one the start of the symbol (as in
+	// GetSymbolInfo) containing it or INVALID_ADDRESS is stored, and if names isn't NULL the label
+	// of that start, or of the address itself when no symbol contains it.
+	void Symbolize(const u32* addresses, size_t count, SymbolType symmask, u32* starts, std::string* names = NULL) const;
 
 	void AddModule(const char *name, u32 address, u32 size);
 	void UnloadModule(u32 address, u32 size);
@@ -101,6 +105,33 @@ private:
 	const char *GetLabelName(u32 address) const;
 	const char *GetLabelNameRel(u32 relAddress, int moduleIndex) const;
 
+	// The part of a symbol in which it's the closest symbol starting below an address, so
+	// that an address is in at most one of them.
+	struct SymbolInterval {
+		u32 start;
+		u32 end;
+	};
+
+	// Flat, sorted copy of the active functions or data, rebuilt by the first lookup after a
+	// change, with the intervals of the last few hits in front of it.
+	struct SymbolIndex {
+		static const int RecentCount = 4;
+
+		std::vector<SymbolInterval> intervals;
+		SymbolInterval recent[RecentCount];
+		int recentCount = 0;
+
+		template <typename Map>
+		void Build(const Map& symbols);
+		u32 Find(u32 address);
+	};
+
+	void UpdateIndex() const;
+
+	mutable SymbolIndex functionIndex;
+	mutable SymbolIndex dataIndex;
+	mutable bool indexDirty = true;
+
 	struct FunctionEntry {
 		u32 start;
 		u32 size;
@@ -21,6 +21,8 @@
 #include "GS.h"
 #include "Gif_Unit.h"
 #include "Counters.h"
+#include "MTVU.h"
+#include "SPU2/spu2.h"
 #include "GSFrame.h"
 
 using namespace Threading;
@@ -53,11 +55,15 @@ void gsReset()
 	GSIMR.reset();
 }
 
+// Frames shown in the max throughput mode, one in every s_throughput_interval
+static uint s_throughput_interval = 60;
+
 void gsUpdateFrequency(Pcsx2Config& config)
 {
 	switch (g_LimiterMode)
 	{
 	case LimiterModeType::Limit_Nominal:
+	case LimiterModeType::Limit_Throughput: // not limited, but the rate is still the nominal one
 		config.GS.LimitScalar = g_Conf->Framerate.NominalScalar;
 		break;
 	case LimiterModeType::Limit_Slomo:
@@ -69,6 +75,8 @@ void gsUpdateFrequency(Pcsx2Config& config)
 	default:
 		pxAssert("Unknown framelimiter mode!");
 	}
+	s_throughput_interval = std::max(g_Conf->Framerate.ThroughputPresentInterval, 1);
+	SPU2setOutputSuppressed(g_LimiterMode == Limit_Throughput);
 	UpdateVSyncRate();
 }
 
@@ -299,8 +307,18 @@ void __fastcall gsWrite128_generic( u32 mem, const mem128_t* value )
 	CopyQWC(PS2GS_BASE(mem), value);
 }
 
+// CSR and SIGLBLID are kept up to date by the gif unit on the EE thread, so reads never
+// need to wait on the MTGS. Only the SIGNAL/FINISH/LABEL events raised by xgkicks on the
+// MTVU thread may still be in flight, fold those in so polling loops see them right away.
+static __fi void gsReadSync()
+{
+	if (THREAD_VU1)
+		vu1Thread.Get_MTVUChanges();
+}
+
 __fi u8 gsRead8(u32 mem)
 {
+	gsReadSync();
 	GIF_LOG("GS read 8 from %8.8lx  value: %8.8lx", mem, *(u8*)PS2GS_BASE(mem));
 
 	switch (mem & ~0xF)
@@ -314,6 +332,7 @@ __fi u8 gsRead8(u32 mem)
 
 __fi u16 gsRead16(u32 mem)
 {
+	gsReadSync();
 	GIF_LOG("GS read 16 from %8.8lx  value: %8.8lx", mem, *(u16*)PS2GS_BASE(mem));
 	switch (mem & ~0xF)
 	{
@@ -326,6 +345,7 @@ __fi u16 gsRead16(u32 mem)
 
 __fi u32 gsRead32(u32 mem)
 {
+	gsReadSync();
 	GIF_LOG("GS read 32 from %8.8lx  value: %8.8lx", mem, *(u32*)PS2GS_BASE(mem));
 	switch (mem & ~0xF)
 	{
@@ -338,6 +358,7 @@ __fi u32 gsRead32(u32 mem)
 
 __fi u64 gsRead64(u32 mem)
 {
+	gsReadSync();
 	// fixme - PS2GS_BASE(mem+4) = (g_RealGSMem+(mem + 4 & 0x13ff))
 	GIF_LOG("GS read 64 from %8.8lx  value: %8.8lx_%8.8lx", mem, *(u32*)PS2GS_BASE(mem+4), *(u32*)PS2GS_BASE(mem) );
 	switch (mem & ~0xF)
@@ -377,6 +398,91 @@ void gsIrq() {
 //   This function does not regulate frame limiting, meaning it does no stalling. Stalling
 //   functions are performed by the EE, which itself uses thread sleep logic to avoid spin
 //   waiting as much as possible (maximizes CPU resource availability for the GS).
+//
+// Adaptive mode:
+//   Skips only while the GS thread is what keeps the EE from full speed: the EE waits on the
+//   ring or vsync queue while the MTGS thread almost never runs out of work. The share of
+//   skipped frames follows how far drawn frames go over the frame budget, and whole field
+//   pairs are skipped for the double buffering reasons above. When the EE is the bottleneck
+//   the MTGS idles and nothing is skipped, since skipping couldn't help.
+
+struct AdaptiveFrameSkip
+{
+	u64 last_ticks, last_wait, last_idle;
+	float draw_cost;	// ms of MTGS busy time per drawn frame
+	float draw_idle;	// share of a drawn frame the MTGS spent waiting for the EE
+	float ee_wait;		// ms the EE waited on the MTGS per frame
+	float credit;
+	bool active;
+	bool skipping;
+	uint field;
+	uint skipped;
+};
+
+static AdaptiveFrameSkip s_adaptive;
+
+static bool gsAdaptiveFrameSkip()
+{
+	AdaptiveFrameSkip& a = s_adaptive;
+	const SysMtgsThread& mtgs = GetMTGS();
+
+	const u64 now = GetCPUTicks();
+	const u64 wait = mtgs.m_StallTime.load(std::memory_order_relaxed) + mtgs.m_VsyncWaitTime.load(std::memory_order_relaxed);
+	const u64 idle = mtgs.m_IdleTime;
+
+	if (a.last_ticks != 0)
+	{
+		const float interval = std::max((now - a.last_ticks) * 1000.0f / GetTickFrequency(), 0.001f);
+		const float idle_ms = (idle - a.last_idle) / 1000.0f;
+		a.ee_wait += ((wait - a.last_wait) / 1000.0f - a.ee_wait) / 8;
+
+		// skipped frames are cheap and say nothing about what drawing costs
+		if (!a.skipping)
+		{
+			a.draw_cost += (std::max(interval - idle_ms, 0.0f) - a.draw_cost) / 8;
+			a.draw_idle += (std::min(idle_ms / interval, 1.0f) - a.draw_idle) / 8;
+		}
+	}
+	a.last_ticks = now;
+	a.last_wait = wait;
+	a.last_idle = idle;
+
+	const float budget = 1000.0f / (GetVerticalFrequency().ToFloat() * EmuConfig.GS.LimitScalar.ToFloat());
+	if (!EmuConfig.GS.FrameLimitEnable)
+		a.active = false;
+	else if (!a.active)
+		a.active = a.draw_cost > budget && a.ee_wait > budget * 0.1f && a.draw_idle < 0.1f;
+	else
+		a.active = a.draw_cost > budget * 0.9f && a.draw_idle < 0.25f;
+
+	if ((a.field++ & 1) == 0)
+	{
+		a.skipping = false;
+		if (a.active)
+		{
+			// skipping never goes beyond 3 of every 4 pairs
+			a.credit += std::min(std::max(1.0f - budget / a.draw_cost, 0.0f), 0.75f);
+			if (a.credit >= 1.0f)
+			{
+				a.credit -= 1.0f;
+				a.skipping = true;
+			}
+		}
+		else
+			a.credit = 0;
+	}
+	a.skipped += a.skipping;
+
+	if ((a.field & 0x1f) == 0)
+	{
+		char value[96];
+		snprintf(value, sizeof(value), "%u/32 skipped, GS %.1f ms of %.1f ms, EE waited %.1f ms", a.skipped, a.draw_cost, budget, a.ee_wait);
+		GSosdMonitor("Adaptive frameskip", value, 0xffffffff);
+		a.skipped = 0;
+	}
+
+	return a.skipping;
+}
 
 __fi void gsFrameSkip()
 {
@@ -393,8 +499,17 @@ __fi void gsFrameSkip()
 			GSsetFrameSkip( false );
 			isSkipping = false;
 		}
+		s_adaptive = {};
+		return;
+	}
+
+	if( EmuConfig.GS.FrameSkipAdaptive )
+	{
+		isSkipping = gsAdaptiveFrameSkip();
+		GSsetFrameSkip( isSkipping );
 		return;
 	}
+	s_adaptive = {};
 
 	GSsetFrameSkip( isSkipping );
 
@@ -425,7 +540,9 @@ void gsPostVsyncStart()
 {
 	//gifUnit.FlushToMTGS();  // Needed for some (broken?) homebrew game loaders
 	
-	GetMTGS().PostVsyncStart();
+	// The max throughput mode doesn't even merge the frames it doesn't show
+	const bool output = g_LimiterMode != Limit_Throughput || (g_FrameCount % s_throughput_interval) == 0;
+	GetMTGS().PostVsyncStart(!GetCoreThread().IsHiddenFrame() && output, output);
 }
 
 void _gs_ResetFrameskip()
@@ -328,7 +328,7 @@ public:
 	Mutex			m_mtx_RingBufferBusy;  // Is obtained while processing ring-buffer data
 	Mutex			m_mtx_RingBufferBusy2; // This one gets released on semaXGkick waiting...
 	Mutex			m_mtx_WaitGS;
-	Semaphore		m_sem_OnRingReset;
+	LightweightSemaphore m_sem_OnRingReset;
 	Semaphore		m_sem_Vsync;
 
 	// used to keep multiple threads from sending packets to the ringbuffer concurrently.
@@ -338,6 +338,28 @@ public:
 	// Used to delay the sending of events.  Performance is better if the ringbuffer
 	// has more than one command in it when the thread is kicked.
 	int				m_CopyDataTally;
+	u64				m_CopyDataTicks; // when the oldest unsignalled packet was sent
+
+	// Stalls of the EE on a full ring, by duration: <10us, <100us, <1ms, <10ms and longer.
+	// Written by the EE, shown in the GS OSD by the MTGS thread.
+	static const uint StallBuckets = 5;
+	std::atomic<u32>	m_StallCount[StallBuckets];
+	std::atomic<u64>	m_StallTime; // in microseconds
+	uint				m_StallReportFrame;
+
+	// Time the EE spent waiting on a full vsync queue, and the MTGS thread spent waiting
+	// for work, in microseconds. Together with the stalls they feed the adaptive frameskip.
+	std::atomic<u64>	m_VsyncWaitTime;
+	u64					m_IdleTime;
+
+	// Late latch telemetry. The EE stamps every vsync it posts, and the MTGS measures from it
+	// how long the GS takes after the vsync till the frame is ready to flip (an average, in
+	// microseconds), and when the last flip was held back by the display vsync.
+	static const uint VsyncPostSlots = 8;
+	u64					m_VsyncPostTicks[VsyncPostSlots];
+	uint				m_VsyncPostSeq;
+	std::atomic<u32>	m_PresentTail;
+	std::atomic<u64>	m_LastVblank;
 
 	Semaphore			m_sem_OpenDone;
 	std::atomic<bool>	m_Opened;
@@ -374,7 +396,7 @@ public:
 
 	u8* GetDataPacketPtr() const;
 	void SetEvent();
-	void PostVsyncStart();
+	void PostVsyncStart(bool present, bool output);
 
 	bool IsGSOpened() const { return m_Opened; }
 
@@ -391,6 +413,12 @@ protected:
 	void OnCleanupInThread();
 
 	void GenericStall( uint size );
+	void SetEventBatched( uint qwc );
+	void RecordStall( u64 start );
+	void RecordPresent( u32 flags );
+	void ReportStalls();
+	void ReportPackets();
+	void AllocRingBuffer();
 
 	// Used internally by SendSimplePacket type functions
 	void _FinishSimplePacket();
@@ -459,24 +487,27 @@ extern int g_nLeftGSFrames;
 #endif
 
 // Size of the ringbuffer as a power of 2 -- size is a multiple of simd128s.
-// (actual size is 1<<m_RingBufferSizeFactor simd vectors [128-bit values])
+// (actual size is 1<<EmuConfig.GS.RingBufferSizeFactor simd vectors [128-bit values])
 // A value of 19 is a 8meg ring buffer.  18 would be 4 megs, and 20 would be 16 megs.
-// Default was 2mb, but some games with lots of MTGS activity want 8mb to run fast (rama)
-static const uint RingBufferSizeFactor = 19;
+// Default is 8mb, some games with lots of MTGS activity want that to run fast (rama)
+// and games blasting large image transfers may want more.
+static const uint RingBufferSizeFactorMin = 16;
+static const uint RingBufferSizeFactorMax = 21;
+static const uint RingBufferSizeFactorDefault = 19;
 
-// size of the ringbuffer in simd128's.
-static const uint RingBufferSize = 1<<RingBufferSizeFactor;
+// size of the ringbuffer in simd128's, only changes while the MTGS thread is stopped.
+extern uint RingBufferSize;
 
 // Mask to apply to ring buffer indices to wrap the pointer from end to
 // start (the wrapping is what makes it a ringbuffer, yo!)
-static const uint RingBufferMask = RingBufferSize - 1;
+extern uint RingBufferMask;
 
 struct MTGS_BufferedData
 {
-	u128		m_Ring[RingBufferSize];
+	u128*		m_Ring; // reserved for the largest size, committed for RingBufferSize
 	u8			Regs[Ps2MemSize::GSregs];
 
-	MTGS_BufferedData() {}
+	MTGS_BufferedData() : m_Ring(NULL) {}
 
 	u128& operator[]( uint idx )
 	{
@@ -24,6 +24,7 @@
 #include "GSLzma.h"
 
 #include "AppCoreThread.h"
+#include "SharedCache.h"
 #include "Utilities/pxStreams.h"
 
 #ifdef _WIN32
@@ -50,6 +51,7 @@ extern bool RunLinuxDialog();
 
 #endif
 
+#include <chrono>
 #include <fstream>
 
 // do NOT undefine this/put it above includes, as x11 people love to redefine
@@ -111,6 +113,8 @@ void GSshutdown()
 	delete s_gs;
 	s_gs = nullptr;
 
+	GSPng::Shutdown();
+
 	theApp.SetCurrentRendererType(GSRendererType::Undefined);
 
 #ifdef _WIN32
@@ -600,7 +604,7 @@ void GSgifTransfer3(uint8* mem, uint32 size)
 	}
 }
 
-void GSvsync(int field)
+void GSvsync(int field, bool present)
 {
 	try
 	{
@@ -621,7 +625,7 @@ void GSvsync(int field)
 
 #endif
 
-		s_gs->VSync(field);
+		s_gs->VSync(field, present);
 	}
 	catch (GSRecoverableError)
 	{
@@ -846,6 +850,16 @@ void GSsetFrameSkip(int frameskip)
 	s_gs->SetFrameSkip(frameskip);
 }
 
+void GSsetOutputSkip(bool skip)
+{
+	s_gs->SetOutputSkip(skip);
+}
+
+uint64 GSgetPresentTicks()
+{
+	return s_gs->GetPresentTicks();
+}
+
 void GSsetVsync(int vsync)
 {
 	s_vsync = vsync;
@@ -866,6 +880,549 @@ void GSsetExclusive(int enabled)
 	}
 }
 
+struct GSReplayPacket
+{
+	uint8 type, param;
+	uint32 size, addr;
+	std::vector<uint8> buff;
+};
+
+// Loads the state of a dump into the opened GS and reads its packets, at most
+// max_frames vsyncs of them when max_frames > 0. With repack the packets read
+// are also written to an uncompressed <dump>_repack.gs
+static void GSReplayLoad(const char* path, bool repack, uint8* regs, std::list<GSReplayPacket*>& packets, long max_frames = 0)
+{
+	std::string f(path);
+	bool is_xz = (f.size() >= 4) && (f.compare(f.size() - 3, 3, ".xz") == 0);
+	if (is_xz)
+		f.replace(f.end() - 6, f.end(), "_repack.gs");
+	else
+		f.replace(f.end() - 3, f.end(), "_repack.gs");
+
+	std::unique_ptr<GSDumpFile> file(is_xz ? (GSDumpFile*)new GSDumpLzma(path, repack ? f.c_str() : nullptr) : (GSDumpFile*)new GSDumpRaw(path, repack ? f.c_str() : nullptr));
+
+	uint32 crc;
+	file->Read(&crc, 4);
+	GSsetGameCRC(crc, 0);
+
+	freezeData fd;
+	file->Read(&fd.size, 4);
+	fd.data = new char[fd.size];
+	file->Read(fd.data, fd.size);
+
+	GSfreeze(FreezeAction::Load, &fd);
+	delete[] fd.data;
+
+	file->Read(regs, 0x2000);
+
+	long frame_number = 0;
+
+	uint8 type;
+	while (file->Read(&type, 1))
+	{
+		GSReplayPacket* p = new GSReplayPacket();
+
+		p->type = type;
+
+		switch (type)
+		{
+			case 0:
+				file->Read(&p->param, 1);
+				file->Read(&p->size, 4);
+
+				switch (p->param)
+				{
+					case 0:
+						p->buff.resize(0x4000);
+						p->addr = 0x4000 - p->size;
+						file->Read(&p->buff[p->addr], p->size);
+						break;
+					case 1:
+					case 2:
+					case 3:
+						p->buff.resize(p->size);
+						file->Read(&p->buff[0], p->size);
+						break;
+				}
+
+				break;
+
+			case 1:
+				file->Read(&p->param, 1);
+				frame_number++;
+
+				break;
+
+			case 2:
+				file->Read(&p->size, 4);
+
+				break;
+
+			case 3:
+				p->buff.resize(0x2000);
+
+				file->Read(&p->buff[0], 0x2000);
+
+				break;
+		}
+
+		packets.push_back(p);
+
+		if (max_frames > 0 && frame_number > max_frames)
+			break;
+	}
+}
+
+static void GSReplayPlay(GSReplayPacket* p, uint8* regs, std::vector<uint8>& buff)
+{
+	switch (p->type)
+	{
+		case 0:
+
+			switch (p->param)
+			{
+				case 0:
+					GSgifTransfer1(&p->buff[0], p->addr);
+					break;
+				case 1:
+					GSgifTransfer2(&p->buff[0], p->size / 16);
+					break;
+				case 2:
+					GSgifTransfer3(&p->buff[0], p->size / 16);
+					break;
+				case 3:
+					GSgifTransfer(&p->buff[0], p->size / 16);
+					break;
+			}
+
+			break;
+
+		case 1:
+
+			GSvsync(p->param, true);
+
+			break;
+
+		case 2:
+
+			if (buff.size() < p->size)
+				buff.resize(p->size);
+
+			GSreadFIFO2(&buff[0], p->size / 16);
+
+			break;
+
+		case 3:
+
+			memcpy(regs, &p->buff[0], 0x2000);
+
+			break;
+	}
+}
+
+// Counters of the renderer since it was opened, false if there is none. They are
+// written by the MTGS thread, so the values read from another thread may lag a frame
+bool GSgetPerfTotals(GSPerfTotals& totals)
+{
+	if (!s_gs)
+		return false;
+
+	GSPerfMon& pm = s_gs->m_perfmon;
+	totals.frames = (double)pm.GetFrame();
+	totals.draw = pm.GetTotal(GSPerfMon::Draw);
+	totals.prim = pm.GetTotal(GSPerfMon::Prim);
+	totals.swizzle = pm.GetTotal(GSPerfMon::Swizzle);
+	totals.swizzle_ms = pm.GetTotal(GSPerfMon::SwizzleTime);
+	totals.unswizzle = pm.GetTotal(GSPerfMon::Unswizzle);
+	totals.fillrate = pm.GetTotal(GSPerfMon::Fillrate);
+	return true;
+}
+
+static std::string GSJsonString(const char* str)
+{
+	std::string out("\"");
+
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			out += '\\';
+		out += *str;
+	}
+
+	return out + "\"";
+}
+
+// Replays a dump loops times with vsync and presentation disabled and writes the
+// cost of every frame as JSON to json, or stdout when it is empty. The GPU time of
+// a frame is the one of the draw timers resolved at its vsync, they lag a few frames.
+// config is a comma separated list of key=value GS options overridden for the run.
+// Several sets separated by ';' are replayed one after the other, each with a new
+// renderer, to compare them in the same report. i.e.
+// "extrathreads=8,extrathreads_tiles=0;extrathreads=8,extrathreads_tiles=1"
+// Every loop also reports the qwords of the GIF transfers and the time spent in
+// them, the draws they flush included. The null renderer isolates the transfers.
+int GSBenchmark(const char* dump, const char* renderer, int loops, const char* json, const char* config)
+{
+	static const std::pair<const char*, GSRendererType> renderers[] = {
+		{"sw", GSRendererType::OGL_SW},
+		{"ogl", GSRendererType::OGL_HW},
+#ifdef _WIN32
+		{"dx11", GSRendererType::DX1011_HW},
+#endif
+		{"null", GSRendererType::Null},
+	};
+
+	static const std::pair<const char*, GSPerfMon::counter_t> counters[] = {
+		{"cpu_ms", GSPerfMon::Frame},
+		{"gpu_ms", GSPerfMon::GPUTime},
+		{"draw", GSPerfMon::Draw},
+		{"prim", GSPerfMon::Prim},
+		{"swizzle", GSPerfMon::Swizzle},
+		{"swizzle_ms", GSPerfMon::SwizzleTime},
+		{"unswizzle", GSPerfMon::Unswizzle},
+		{"unswizzle_ms", GSPerfMon::UnswizzleTime},
+		{"fillrate", GSPerfMon::Fillrate},
+		{"upload", GSPerfMon::Upload},
+		{"pbo_stall", GSPerfMon::PboStall},
+	};
+
+	GSRendererType type = GSRendererType::Undefined;
+
+	for (const auto& r : renderers)
+	{
+		if (strcmp(renderer, r.first) == 0)
+			type = r.second;
+	}
+
+	if (type == GSRendererType::Undefined)
+	{
+		fprintf(stderr, "GS benchmark: unknown renderer %s\n", renderer);
+		return -1;
+	}
+
+	auto split = [](const std::string& str, char sep) {
+		std::vector<std::string> out;
+		for (size_t pos = 0; pos <= str.size();)
+		{
+			size_t end = str.find(sep, pos);
+			if (end == std::string::npos)
+				end = str.size();
+			out.push_back(str.substr(pos, end - pos));
+			pos = end + 1;
+		}
+		return out;
+	};
+
+	typedef std::vector<std::pair<std::string, std::string>> Options;
+
+	std::vector<std::string> names = split(config, ';');
+	std::vector<Options> sets;
+
+	for (const std::string& set : names)
+	{
+		Options options;
+		for (const std::string& option : split(set, ','))
+		{
+			const size_t eq = option.find('=');
+			if (eq != std::string::npos)
+				options.emplace_back(option.substr(0, eq), option.substr(eq + 1));
+			else if (!option.empty())
+				fprintf(stderr, "GS benchmark: ignore option %s, expected key=value\n", option.c_str());
+		}
+		sets.push_back(options);
+	}
+
+	if (GSinit() != 0)
+		return -1;
+
+	theApp.OverrideConfig("dump", "0");
+	theApp.OverrideConfig("gpu_draw_profiling", type == GSRendererType::OGL_HW || type == GSRendererType::DX1011_HW ? "1" : "0");
+	theApp.OverrideConfig("present", "0");
+	theApp.OverrideConfig("vsync", "0");
+
+	// Values of the options before any set, restored when a later set doesn't override them
+	std::map<std::string, std::string> defaults;
+	for (const Options& options : sets)
+	{
+		for (const auto& option : options)
+			defaults.emplace(option.first, theApp.GetConfigS(option.first.c_str()));
+	}
+
+	typedef std::array<double, countof(counters) + 1> Sample;
+	struct Loop
+	{
+		std::vector<Sample> frames;
+		uint64 gif_qwc = 0; // GIF transfers, their time includes the draws they flush
+		double gif_ms = 0;
+	};
+
+	typedef std::vector<Loop> Run;
+
+	std::vector<Run> runs;
+
+	for (const Options& options : sets)
+	{
+		for (const auto& option : defaults)
+			theApp.OverrideConfig(option.first.c_str(), option.second.c_str());
+		for (const auto& option : options)
+			theApp.OverrideConfig(option.first.c_str(), option.second.c_str());
+
+		std::list<GSReplayPacket*> packets;
+		std::vector<uint8> buff;
+		uint8 regs[0x2000];
+
+		GSsetBaseMem(regs);
+
+		s_vsync = 0;
+
+		void* hWnd = NULL;
+		if (_GSopen(&hWnd, "GS benchmark", type) != 0 || s_gs->m_wnd == NULL)
+		{
+			fprintf(stderr, "GS benchmark: failed to open the renderer\n");
+			GSshutdown();
+			return -1;
+		}
+
+		try
+		{
+			GSReplayLoad(dump, false, regs, packets);
+		}
+		catch (const char*)
+		{
+			for (auto p : packets)
+				delete p;
+
+			GSclose();
+			GSshutdown();
+			return -1;
+		}
+
+		auto sample = [&]() {
+			Sample s;
+			s[0] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			for (size_t i = 0; i < countof(counters); i++)
+				s[i + 1] = s_gs->m_perfmon.GetTotal(counters[i].second);
+			return s;
+		};
+
+		Run run(std::max(loops, 1));
+
+		// Init vsync stuff
+		GSvsync(1, true);
+
+		for (auto& loop : run)
+		{
+			Sample last = sample();
+
+			for (auto p : packets)
+			{
+				if (p->type == 0)
+				{
+					auto start = std::chrono::steady_clock::now();
+
+					GSReplayPlay(p, regs, buff);
+
+					loop.gif_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+					loop.gif_qwc += p->size / 16;
+
+					continue;
+				}
+
+				GSReplayPlay(p, regs, buff);
+
+				if (p->type == 1)
+				{
+					Sample now = sample();
+					Sample delta;
+
+					for (size_t i = 0; i < delta.size(); i++)
+						delta[i] = now[i] - last[i];
+
+					loop.frames.push_back(delta);
+					last = now;
+				}
+			}
+		}
+
+		for (auto p : packets)
+			delete p;
+
+		// The next set gets a new renderer, options such as extrathreads are only read on creation
+		GSclose();
+		delete s_gs;
+		s_gs = NULL;
+
+		runs.push_back(std::move(run));
+	}
+
+	FILE* fp = *json ? px_fopen(json, "w") : stdout;
+
+	if (fp)
+	{
+		fprintf(fp, "{\n\t\"dump\": %s,\n\t\"renderer\": %s,\n\t\"runs\": [\n", GSJsonString(dump).c_str(), GSJsonString(s_renderer_name.c_str()).c_str());
+
+		for (size_t r = 0; r < runs.size(); r++)
+		{
+			fprintf(fp, "\t\t{\n\t\t\t\"config\": %s,\n\t\t\t\"loops\": [\n", GSJsonString(names[r].c_str()).c_str());
+
+			for (size_t l = 0; l < runs[r].size(); l++)
+			{
+				const Loop& loop = runs[r][l];
+				const std::vector<Sample>& frames = loop.frames;
+
+				double wall = 0;
+				for (const auto& f : frames)
+					wall += f[0];
+
+				fprintf(fp, "\t\t\t\t{\n\t\t\t\t\t\"wall_ms\": %.3f,\n", wall);
+				fprintf(fp, "\t\t\t\t\t\"gif_qwords\": %llu,\n\t\t\t\t\t\"gif_ms\": %.3f,\n\t\t\t\t\t\"gif_mqwords_s\": %.3f,\n",
+					(unsigned long long)loop.gif_qwc, loop.gif_ms, loop.gif_ms > 0 ? loop.gif_qwc / loop.gif_ms / 1000 : 0.0);
+				fprintf(fp, "\t\t\t\t\t\"frames\": [\n");
+
+				for (size_t n = 0; n < frames.size(); n++)
+				{
+					const Sample& f = frames[n];
+
+					fprintf(fp, "\t\t\t\t\t\t{\"wall_ms\": %.3f", f[0]);
+					for (size_t i = 0; i < countof(counters); i++)
+						fprintf(fp, ", \"%s\": %.3f", counters[i].first, f[i + 1]);
+					fprintf(fp, "}%s\n", n + 1 < frames.size() ? "," : "");
+				}
+
+				fprintf(fp, "\t\t\t\t\t]\n\t\t\t\t}%s\n", l + 1 < runs[r].size() ? "," : "");
+			}
+
+			fprintf(fp, "\t\t\t]\n\t\t}%s\n", r + 1 < runs.size() ? "," : "");
+		}
+
+		fprintf(fp, "\t]\n}\n");
+
+		if (fp != stdout)
+			fclose(fp);
+	}
+	else
+	{
+		fprintf(stderr, "GS benchmark: failed to open %s\n", json);
+	}
+
+	GSshutdown();
+
+	return fp ? 0 : -1;
+}
+
+// Swizzles (WriteImage) and unswizzles (ReadTexture, and the paletted ReadTexture
+// when the format has one) a 1024x512 rect of every texture format into a scratch
+// GSLocalMemory and writes the GB/s of each as JSON to json, or stdout when it is
+// empty. The GB/s are counted on the GS memory side, width * height * bpp / 8.
+// The GSBlock paths are picked at compile time, compare the AVX2 and SSE4 builds.
+int GSBlockBenchmark(const char* json)
+{
+	static const std::pair<const char*, uint32> formats[] = {
+		{"PSMCT32", PSM_PSMCT32},
+		{"PSMCT24", PSM_PSMCT24},
+		{"PSMCT16", PSM_PSMCT16},
+		{"PSMCT16S", PSM_PSMCT16S},
+		{"PSMT8", PSM_PSMT8},
+		{"PSMT4", PSM_PSMT4},
+		{"PSMT8H", PSM_PSMT8H},
+		{"PSMT4HL", PSM_PSMT4HL},
+		{"PSMT4HH", PSM_PSMT4HH},
+		{"PSMZ32", PSM_PSMZ32},
+		{"PSMZ24", PSM_PSMZ24},
+		{"PSMZ16", PSM_PSMZ16},
+		{"PSMZ16S", PSM_PSMZ16S},
+	};
+
+	static const int w = 1024;
+	static const int h = 512;
+	static const int runs = 16;
+
+	if (GSinit() != 0)
+		return -1;
+
+	std::unique_ptr<GSLocalMemory> mem(new GSLocalMemory());
+
+	std::vector<uint8> src(w * h * 4);
+	uint8* dst = (uint8*)_aligned_malloc(w * h * 4, 32);
+
+	for (size_t i = 0; i < src.size(); i++)
+		src[i] = (uint8)(i * 0x9E3779B9u >> 24);
+
+	// Best of runs, in seconds
+	auto time = [](auto f) {
+		double best = DBL_MAX;
+		for (int i = 0; i < runs; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	};
+
+	FILE* fp = *json ? px_fopen(json, "w") : stdout;
+
+	if (fp)
+	{
+		fprintf(fp, "{\n\t\"sse\": \"0x%x\",\n\t\"width\": %d,\n\t\"height\": %d,\n\t\"formats\": [\n", _M_SSE, w, h);
+
+		for (size_t n = 0; n < countof(formats); n++)
+		{
+			const uint32 psm = formats[n].second;
+			const GSLocalMemory::psm_t& p = GSLocalMemory::m_psm[psm];
+			const double bytes = (double)w * h * p.trbpp / 8;
+
+			GIFRegBITBLTBUF BITBLTBUF = {};
+			GIFRegTRXPOS TRXPOS = {};
+			GIFRegTRXREG TRXREG = {};
+			GIFRegTEXA TEXA = {};
+
+			BITBLTBUF.DBW = w / 64;
+			BITBLTBUF.DPSM = psm;
+			TRXREG.RRW = w;
+			TRXREG.RRH = h;
+
+			const double write = time([&]() {
+				int tx = 0;
+				int ty = 0;
+				(mem.get()->*p.wi)(tx, ty, src.data(), (int)bytes, BITBLTBUF, TRXPOS, TRXREG);
+			});
+
+			const GSOffset* off = mem->GetOffset(0, w / 64, psm);
+			const GSVector4i r(0, 0, w, h);
+
+			const double read = time([&]() { (mem.get()->*p.rtx)(off, r, dst, w * 4, TEXA); });
+
+			fprintf(fp, "\t\t{\"psm\": \"%s\", \"write_gbs\": %.2f, \"read_gbs\": %.2f", formats[n].first, bytes / write / 1e9, bytes / read / 1e9);
+
+			if (p.pal > 0)
+			{
+				const double readP = time([&]() { (mem.get()->*p.rtxP)(off, r, dst, w, TEXA); });
+
+				fprintf(fp, ", \"read_p_gbs\": %.2f", bytes / readP / 1e9);
+			}
+
+			fprintf(fp, "}%s\n", n + 1 < countof(formats) ? "," : "");
+		}
+
+		fprintf(fp, "\t]\n}\n");
+
+		if (fp != stdout)
+			fclose(fp);
+	}
+	else
+	{
+		fprintf(stderr, "GS block benchmark: failed to open %s\n", json);
+	}
+
+	_aligned_free(dst);
+	mem.reset();
+
+	GSshutdown();
+
+	return fp ? 0 : -1;
+}
+
 #if defined(__unix__) || defined(__APPLE__)
 
 inline unsigned long timeGetTime()
@@ -875,6 +1432,13 @@ inline unsigned long timeGetTime()
 	return (unsigned long)(t.tv_sec * 1000 + t.tv_nsec / 1000000);
 }
 
+static uint64 GetReplayTimeNs()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
 // Note
 void GSReplay(char* lpszCmdLine, int renderer)
 {
@@ -896,14 +1460,7 @@ void GSReplay(char* lpszCmdLine, int renderer)
 		return;
 	}
 
-	struct Packet
-	{
-		uint8 type, param;
-		uint32 size, addr;
-		std::vector<uint8> buff;
-	};
-
-	std::list<Packet*> packets;
+	std::list<GSReplayPacket*> packets;
 	std::vector<uint8> buff;
 	uint8 regs[0x2000];
 
@@ -931,145 +1488,42 @@ void GSReplay(char* lpszCmdLine, int renderer)
 	if (s_gs->m_wnd == NULL)
 		return;
 
-	{ // Read .gs content
-		std::string f(lpszCmdLine);
-		bool is_xz = (f.size() >= 4) && (f.compare(f.size() - 3, 3, ".xz") == 0);
-		if (is_xz)
-			f.replace(f.end() - 6, f.end(), "_repack.gs");
-		else
-			f.replace(f.end() - 3, f.end(), "_repack.gs");
-
-		GSDumpFile* file = is_xz ? (GSDumpFile*)new GSDumpLzma(lpszCmdLine, repack_dump ? f.c_str() : nullptr) : (GSDumpFile*)new GSDumpRaw(lpszCmdLine, repack_dump ? f.c_str() : nullptr);
-
-		uint32 crc;
-		file->Read(&crc, 4);
-		GSsetGameCRC(crc, 0);
-
-		freezeData fd;
-		file->Read(&fd.size, 4);
-		fd.data = new char[fd.size];
-		file->Read(fd.data, fd.size);
-
-		GSfreeze(FreezeAction::Load, &fd);
-		delete[] fd.data;
-
-		file->Read(regs, 0x2000);
-
-		uint8 type;
-		while (file->Read(&type, 1))
-		{
-			Packet* p = new Packet();
-
-			p->type = type;
-
-			switch (type)
-			{
-				case 0:
-					file->Read(&p->param, 1);
-					file->Read(&p->size, 4);
-
-					switch (p->param)
-					{
-						case 0:
-							p->buff.resize(0x4000);
-							p->addr = 0x4000 - p->size;
-							file->Read(&p->buff[p->addr], p->size);
-							break;
-						case 1:
-						case 2:
-						case 3:
-							p->buff.resize(p->size);
-							file->Read(&p->buff[0], p->size);
-							break;
-					}
-
-					break;
-
-				case 1:
-					file->Read(&p->param, 1);
-					frame_number++;
-
-					break;
-
-				case 2:
-					file->Read(&p->size, 4);
-
-					break;
-
-				case 3:
-					p->buff.resize(0x2000);
-
-					file->Read(&p->buff[0], 0x2000);
-
-					break;
-			}
-
-			packets.push_back(p);
-
-			if (repack_dump && frame_number > -finished)
-				break;
-		}
-
-		delete file;
-	}
+	// Read .gs content
+	GSReplayLoad(lpszCmdLine, repack_dump, regs, packets, repack_dump ? -finished : 0);
 
 	sleep(2);
 
 
 	frame_number = 0;
 
+	// GIF transfer throughput of the replay, includes the draws the transfers flush
+	uint64 transfer_qwc = 0;
+	uint64 transfer_ns = 0;
+
 	// Init vsync stuff
-	GSvsync(1);
+	GSvsync(1, true);
 
 	while (finished > 0)
 	{
 		for (auto i = packets.begin(); i != packets.end(); i++)
 		{
-			Packet* p = *i;
+			GSReplayPacket* p = *i;
 
-			switch (p->type)
+			if (p->type == 0)
 			{
-				case 0:
-
-					switch (p->param)
-					{
-						case 0:
-							GSgifTransfer1(&p->buff[0], p->addr);
-							break;
-						case 1:
-							GSgifTransfer2(&p->buff[0], p->size / 16);
-							break;
-						case 2:
-							GSgifTransfer3(&p->buff[0], p->size / 16);
-							break;
-						case 3:
-							GSgifTransfer(&p->buff[0], p->size / 16);
-							break;
-					}
+				uint64 start = GetReplayTimeNs();
 
-					break;
+				GSReplayPlay(p, regs, buff);
 
-				case 1:
+				transfer_ns += GetReplayTimeNs() - start;
+				transfer_qwc += p->size / 16;
+			}
+			else
+			{
+				GSReplayPlay(p, regs, buff);
 
-					GSvsync(p->param);
+				if (p->type == 1)
 					frame_number++;
-
-					break;
-
-				case 2:
-
-					if (buff.size() < p->size)
-						buff.resize(p->size);
-
-					GSreadFIFO2(&buff[0], p->size / 16);
-
-					break;
-
-				case 3:
-
-					memcpy(regs, &p->buff[0], 0x2000);
-
-					break;
 			}
 		}
 
@@ -1089,6 +1543,9 @@ void GSReplay(char* lpszCmdLine, int renderer)
 
 	static_cast<GSDeviceOGL*>(s_gs->m_dev)->GenerateProfilerData();
 
+	fprintf(stderr, "GIF transfers: %llu qwords in %.1f ms, %.2f Mqwords/s\n",
+		transfer_qwc, transfer_ns / 1000000.0, transfer_ns ? transfer_qwc * 1000.0 / transfer_ns : 0.0);
+
 #ifdef ENABLE_OGL_DEBUG_MEM_BW
 	unsigned long total_frame_nb = std::max(1l, frame_number) << 10;
 	fprintf(stderr, "memory bandwith. T: %f KB/f. V: %f KB/f. U: %f KB/f\n",
@@ -1362,15 +1819,15 @@ bool GSApp::LoadResource(int id, std::vector<char>& buff, const char* type)
 		case IDR_MERGE_GLSL:
 			path = "/GS/res/glsl/merge.glsl";
 			break;
-		case IDR_SHADEBOOST_GLSL:
-			path = "/GS/res/glsl/shadeboost.glsl";
-			break;
 		case IDR_TFX_VGS_GLSL:
 			path = "/GS/res/glsl/tfx_vgs.glsl";
 			break;
 		case IDR_TFX_FS_GLSL:
 			path = "/GS/res/glsl/tfx_fs.glsl";
 			break;
+		case IDR_VRAM_UNSWIZZLE_GLSL:
+			path = "/GS/res/glsl/vram_unswizzle.glsl";
+			break;
 		case IDR_FONT_ROBOTO:
 			path = "/GS/res/fonts-roboto/Roboto-Regular.ttf";
 			break;
@@ -1608,6 +2065,8 @@ void GSApp::Init()
 	m_default_configuration["accurate_date"]                              = "1";
 	m_default_configuration["accurate_blending_unit"]                     = "1";
 	m_default_configuration["AspectRatio"]                                = "1";
+	m_default_configuration["async_readback"]                             = "0";
+	m_default_configuration["async_shader_compile"]                       = "0";
 	m_default_configuration["autoflush_sw"]                               = "1";
 	m_default_configuration["capture_enabled"]                            = "0";
 	m_default_configuration["capture_out_dir"]                            = "/tmp/GS_Capture";
@@ -1621,18 +2080,26 @@ void GSApp::Init()
 	m_default_configuration["debug_opengl"]                               = "0";
 	m_default_configuration["disable_hw_gl_draw"]                         = "0";
 	m_default_configuration["dithering_ps2"]                              = "2";
+	m_default_configuration["draw_batching"]                              = "0";
 	m_default_configuration["dump"]                                       = "0";
 	m_default_configuration["extrathreads"]                               = "2";
 	m_default_configuration["extrathreads_height"]                        = "4";
+	m_default_configuration["extrathreads_setup"]                         = "0";
+	m_default_configuration["extrathreads_tiles"]                         = "0";
 	m_default_configuration["filter"]                                     = std::to_string(static_cast<int8>(BiFiltering::PS2));
 	m_default_configuration["force_texture_clear"]                        = "0";
 	m_default_configuration["fxaa"]                                       = "0";
+	m_default_configuration["gpu_draw_profiling"]                         = "0";
+	m_default_configuration["gpu_draw_profiling_csv"]                     = "";
+	m_default_configuration["gpu_unswizzle"]                              = "0";
 	m_default_configuration["interlace"]                                  = "7";
+	m_default_configuration["keep_cache_on_load"]                         = "1";
 	m_default_configuration["conservative_framebuffer"]                   = "1";
 	m_default_configuration["linear_present"]                             = "1";
 	m_default_configuration["MaxAnisotropy"]                              = "0";
 	m_default_configuration["mipmap"]                                     = "1";
 	m_default_configuration["mipmap_hw"]                                  = std::to_string(static_cast<int>(HWMipmapLevel::Automatic));
+	m_default_configuration["mipmap_gpu_generate"]                        = "0";
 	m_default_configuration["ModeHeight"]                                 = "480";
 	m_default_configuration["ModeWidth"]                                  = "640";
 	m_default_configuration["NTSC_Saturation"]                            = "1";
@@ -1669,7 +2136,10 @@ void GSApp::Init()
 	m_default_configuration["override_GL_ARB_texture_barrier"]            = "-1";
 	m_default_configuration["paltex"]                                     = "0";
 	m_default_configuration["png_compression_level"]                      = std::to_string(Z_BEST_SPEED);
+	m_default_configuration["png_threads"]                                = "2";
 	m_default_configuration["preload_frame_with_gs_data"]                 = "0";
+	m_default_configuration["present"]                                    = "1";
+	m_default_configuration["present_queue_size"]                         = "2";
 	m_default_configuration["Renderer"]                                   = std::to_string(static_cast<int>(GSRendererType::Default));
 	m_default_configuration["resx"]                                       = "1024";
 	m_default_configuration["resy"]                                       = "1024";
@@ -1679,6 +2149,7 @@ void GSApp::Init()
 	m_default_configuration["saven"]                                      = "0";
 	m_default_configuration["savet"]                                      = "0";
 	m_default_configuration["savez"]                                      = "0";
+	m_default_configuration["shader_cache"]                               = "1";
 	m_default_configuration["ShadeBoost"]                                 = "0";
 	m_default_configuration["ShadeBoost_Brightness"]                      = "50";
 	m_default_configuration["ShadeBoost_Contrast"]                        = "50";
@@ -1686,6 +2157,16 @@ void GSApp::Init()
 	m_default_configuration["shaderfx"]                                   = "0";
 	m_default_configuration["shaderfx_conf"]                              = "shaders/GS_FX_Settings.ini";
 	m_default_configuration["shaderfx_glsl"]                              = "shaders/GS.fx";
+	m_default_configuration["sw_hiz"]                                     = "0";
+	m_default_configuration["sw_jit_prewarm"]                             = "1";
+	m_default_configuration["sw_jit_profile"]                             = "0";
+	m_default_configuration["swizzle_threads"]                            = "0";
+	m_default_configuration["texture_hash_cache"]                         = "0";
+	m_default_configuration["texture_hash_cache_size"]                    = "256";
+	m_default_configuration["texture_replacement_dir"]                    = "";
+	m_default_configuration["texture_unswizzle_threads"]                  = "0";
+	m_default_configuration["threaded_present"]                           = "0";
+	m_default_configuration["threaded_submission"]                        = "0";
 	m_default_configuration["TVShader"]                                   = "0";
 	m_default_configuration["upscale_multiplier"]                         = "1";
 	m_default_configuration["UserHacks"]                                  = "0";
@@ -1707,6 +2188,8 @@ void GSApp::Init()
 	m_default_configuration["UserHacks_TriFilter"]                        = std::to_string(static_cast<int8>(TriFiltering::None));
 	m_default_configuration["UserHacks_WildHack"]                         = "0";
 	m_default_configuration["wrap_gs_mem"]                                = "0";
+	m_default_configuration["vertex_trace_threads"]                       = "0";
+	m_default_configuration["vram_budget"]                                = "0";
 	m_default_configuration["vsync"]                                      = "0";
 	// clang-format on
 }
@@ -1784,8 +2267,24 @@ void GSApp::SetConfigDir()
 	m_ini = GetSettingsFolder().Combine(iniName).GetFullPath();
 }
 
+std::string GSApp::GetCachePath(const char* file)
+{
+	// Caches are rebuilt on demand so the settings folder is good enough, unless a folder is
+	// shared by the instances of the host
+	return std::string(SharedCache::GetPath(fromUTF8(file)).ToUTF8());
+}
+
+void GSApp::OverrideConfig(const char* entry, const char* value)
+{
+	m_override_configuration[entry] = value;
+}
+
 std::string GSApp::GetConfigS(const char* entry)
 {
+	auto over = m_override_configuration.find(entry);
+	if (over != m_override_configuration.end())
+		return over->second;
+
 	char buff[4096] = {0};
 	auto def = m_default_configuration.find(entry);
 
@@ -1809,6 +2308,10 @@ void GSApp::SetConfig(const char* entry, const char* value)
 
 int GSApp::GetConfigI(const char* entry)
 {
+	auto over = m_override_configuration.find(entry);
+	if (over != m_override_configuration.end())
+		return std::stoi(over->second);
+
 	auto def = m_default_configuration.find(entry);
 
 	if (def != m_default_configuration.end())
@@ -369,6 +369,8 @@ enum GIF_REG_COMPLEX
 {
 	GIF_REG_STQRGBAXYZF2 = 0x00,
 	GIF_REG_STQRGBAXYZ2 = 0x01,
+	GIF_REG_RGBAXYZF2 = 0x02,
+	GIF_REG_RGBAXYZ2 = 0x03,
 };
 
 enum GIF_A_D_REG
@@ -1411,7 +1413,9 @@ struct alignas(32) GIFPath
 		TYPE_UNKNOWN,
 		TYPE_ADONLY,
 		TYPE_STQRGBAXYZF2,
-		TYPE_STQRGBAXYZ2
+		TYPE_STQRGBAXYZ2,
+		TYPE_RGBAXYZF2,
+		TYPE_RGBAXYZ2
 	};
 
 	__forceinline void SetTag(const void* mem)
@@ -1452,6 +1456,11 @@ struct alignas(32) GIFPath
 					case 1:
 						break;
 					case 2:
+						// untextured primitives
+						if (regs.u32[0] == 0x00000401)
+							type = TYPE_RGBAXYZF2;
+						if (regs.u32[0] == 0x00000501)
+							type = TYPE_RGBAXYZ2;
 						break;
 					case 3:
 						// many games, TODO: formats mixed with NOPs (xeno2: 040f010f02, 04010f020f, mgs3: 04010f0f02, 0401020f0f, 04010f020f)
@@ -1463,6 +1472,18 @@ struct alignas(32) GIFPath
 						// TODO: common types with UV instead
 						break;
 					case 4:
+						if (regs.u32[0] == 0x04010401)
+						{
+							type = TYPE_RGBAXYZF2;
+							nreg = 2;
+							nloop *= 2;
+						}
+						if (regs.u32[0] == 0x05010501)
+						{
+							type = TYPE_RGBAXYZ2;
+							nreg = 2;
+							nloop *= 2;
+						}
 						break;
 					case 5:
 						break;
@@ -1787,6 +1808,13 @@ int GSinit();
 void GSshutdown();
 void GSclose();
 int _GSopen(void** dsp, const char* title, GSRendererType renderer, int threads);
+int GSBenchmark(const char* dump, const char* renderer, int loops, const char* json, const char* config);
+int GSBlockBenchmark(const char* json);
+struct GSPerfTotals
+{
+	double frames, draw, prim, swizzle, swizzle_ms, unswizzle, fillrate;
+};
+bool GSgetPerfTotals(GSPerfTotals& totals);
 void GSosdLog(const char* utf8, uint32 color);
 void GSosdMonitor(const char* key, const char* value, uint32 color);
 int GSopen2(void** dsp, uint32 flags);
@@ -1802,7 +1830,7 @@ void GSgifTransfer(const uint8* mem, uint32 size);
 void GSgifTransfer1(uint8* mem, uint32 addr);
 void GSgifTransfer2(uint8* mem, uint32 size);
 void GSgifTransfer3(uint8* mem, uint32 size);
-void GSvsync(int field);
+void GSvsync(int field, bool present);
 uint32 GSmakeSnapshot(char* path);
 void GSkeyEvent(GSKeyEventData* e);
 int GSfreeze(FreezeAction mode, freezeData* data);
@@ -1815,6 +1843,8 @@ void GSsetGameCRC(uint32 crc, int options);
 void GSgetLastTag(uint32* tag);
 void GSgetTitleInfo2(char* dest, size_t length);
 void GSsetFrameSkip(int frameskip);
+void GSsetOutputSkip(bool skip); // the next vsyncs are drawn, but neither merged nor presented
+uint64 GSgetPresentTicks(); // GetCPUTicks() the last GSvsync spent presenting, 0 if it didn't
 void GSsetVsync(int vsync);
 void GSsetExclusive(int enabled);
 
@@ -1823,6 +1853,7 @@ class GSApp
 	std::string m_section;
 	std::map<std::string, std::string> m_default_configuration;
 	std::map<std::string, std::string> m_configuration_map;
+	std::map<std::string, std::string> m_override_configuration; // Session only, never saved
 	GSRendererType m_current_renderer_type;
 
 public:
@@ -1854,6 +1885,7 @@ public:
 
 	void SetConfig(const char* entry, const char* value);
 	void SetConfig(const char* entry, int value);
+	void OverrideConfig(const char* entry, const char* value);
 	// Avoid issue with overloading
 	template <typename T>
 	T GetConfigT(const char* entry)
@@ -1868,6 +1900,7 @@ public:
 	GSRendererType GetCurrentRendererType() const;
 
 	void SetConfigDir();
+	std::string GetCachePath(const char* file);
 
 	std::vector<GSSetting> m_gs_renderers;
 	std::vector<GSSetting> m_gs_interlace;
@@ -724,6 +724,60 @@ public:
 	{
 		//printf("ReadBlock4P\n");
 
+#if _M_SSE >= 0x501
+
+		const GSVector4i* s = (const GSVector4i*)src;
+
+		GSVector8i v0, v1, v2, v3;
+
+		GSVector8i mask(0x0f0f0f0f);
+
+		for (int i = 0; i < 2; i++, dst += dstpitch * 8)
+		{
+			// col 0, 2 in the low lane, col 1, 3 in the high lane
+
+			v0 = GSVector8i::load(&s[i * 8 + 0], &s[i * 8 + 4]);
+			v1 = GSVector8i::load(&s[i * 8 + 1], &s[i * 8 + 5]);
+			v2 = GSVector8i::load(&s[i * 8 + 2], &s[i * 8 + 6]);
+			v3 = GSVector8i::load(&s[i * 8 + 3], &s[i * 8 + 7]);
+
+			GSVector8i::sw8(v0, v1, v2, v3);
+			GSVector8i::sw16(v0, v1, v2, v3);
+			GSVector8i::sw8(v0, v2, v1, v3);
+
+			GSVector8i l0 = v0 & mask;
+			GSVector8i l1 = v1 & mask;
+			GSVector8i l2 = v2 & mask;
+			GSVector8i l3 = v3 & mask;
+
+			GSVector8i h0 = v0.andnot(mask) >> 4;
+			GSVector8i h1 = v1.andnot(mask) >> 4;
+			GSVector8i h2 = v2.andnot(mask) >> 4;
+			GSVector8i h3 = v3.andnot(mask) >> 4;
+
+			GSVector8i::storel(&dst[dstpitch * 0 +  0], l0);
+			GSVector8i::storel(&dst[dstpitch * 0 + 16], l1);
+			GSVector8i::storel(&dst[dstpitch * 1 +  0], l2);
+			GSVector8i::storel(&dst[dstpitch * 1 + 16], l3);
+
+			GSVector8i::storel(&dst[dstpitch * 2 +  0], h0.yxwz());
+			GSVector8i::storel(&dst[dstpitch * 2 + 16], h1.yxwz());
+			GSVector8i::storel(&dst[dstpitch * 3 +  0], h2.yxwz());
+			GSVector8i::storel(&dst[dstpitch * 3 + 16], h3.yxwz());
+
+			GSVector8i::storeh(&dst[dstpitch * 4 +  0], l0.yxwz());
+			GSVector8i::storeh(&dst[dstpitch * 4 + 16], l1.yxwz());
+			GSVector8i::storeh(&dst[dstpitch * 5 +  0], l2.yxwz());
+			GSVector8i::storeh(&dst[dstpitch * 5 + 16], l3.yxwz());
+
+			GSVector8i::storeh(&dst[dstpitch * 6 +  0], h0);
+			GSVector8i::storeh(&dst[dstpitch * 6 + 16], h1);
+			GSVector8i::storeh(&dst[dstpitch * 7 +  0], h2);
+			GSVector8i::storeh(&dst[dstpitch * 7 + 16], h3);
+		}
+
+#else
+
 		const GSVector4i* s = (const GSVector4i*)src;
 
 		GSVector4i v0, v1, v2, v3;
@@ -782,6 +836,7 @@ public:
 
 			dst += dstpitch * 2;
 		}
+#endif
 	}
 
 	__forceinline static void ReadBlock8HP(const uint8* RESTRICT src, uint8* RESTRICT dst, int dstpitch)
@@ -1012,6 +1067,43 @@ public:
 		return ((c & m_rxxx) << 3) | ((c & m_xgxx) << 6) | ((c & m_xxbx) << 9) | (AEM ? TA0.blend8(TA1, c.sra16(15)).andnot(c == V::zero()) : TA0.blend(TA1, c.sra16(15)));
 	}
 
+	__forceinline static void Gather32_8(const GSVector4i& v, const uint32* RESTRICT pal, uint8* RESTRICT dst)
+	{
+#if _M_SSE >= 0x501
+
+		GSVector8i* d = (GSVector8i*)dst;
+
+		d[0] = GSVector8i::cast(v).u8to32c().gather32_32(pal);
+		d[1] = GSVector8i::cast(v.zwzw()).u8to32c().gather32_32(pal);
+
+#else
+
+		v.gather32_8<>(pal, (GSVector4i*)dst);
+
+#endif
+	}
+
+	__forceinline static void Gather64_8(const GSVector4i& v, const uint64* RESTRICT pal, uint8* RESTRICT dst)
+	{
+#if _M_SSE >= 0x501
+
+		GSVector8i* d = (GSVector8i*)dst;
+
+		GSVector8i i0 = GSVector8i::cast(v).u8to32c();
+		GSVector8i i1 = GSVector8i::cast(v.zwzw()).u8to32c();
+
+		d[0] = i0.gather64_32<0>(pal);
+		d[1] = i0.gather64_32<1>(pal);
+		d[2] = i1.gather64_32<0>(pal);
+		d[3] = i1.gather64_32<1>(pal);
+
+#else
+
+		v.gather64_8<>(pal, (GSVector4i*)dst);
+
+#endif
+	}
+
 	template <bool AEM>
 	static void ExpandBlock24(const uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const GIFRegTEXA& TEXA)
 	{
@@ -1105,7 +1197,7 @@ public:
 	{
 		for (int j = 0; j < 16; j++, dst += dstpitch)
 		{
-			((const GSVector4i*)src)[j].gather32_8(pal, (GSVector4i*)dst);
+			Gather32_8(((const GSVector4i*)src)[j], pal, dst);
 		}
 	}
 
@@ -1121,7 +1213,7 @@ public:
 	{
 		for (int j = 0; j < 16; j++, dst += dstpitch)
 		{
-			((const GSVector4i*)src)[j].gather64_8(pal, (GSVector4i*)dst);
+			Gather64_8(((const GSVector4i*)src)[j], pal, dst);
 		}
 	}
 
@@ -1135,6 +1227,17 @@ public:
 
 	__forceinline static void ExpandBlock8H_32(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
 	{
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		for (int j = 0; j < 8; j++, dst += dstpitch)
+		{
+			((GSVector8i*)dst)[0] = (s[j] >> 24).gather32_32(pal);
+		}
+
+#else
+
 		for (int j = 0; j < 8; j++, dst += dstpitch)
 		{
 			const GSVector4i* s = (const GSVector4i*)src;
@@ -1142,6 +1245,8 @@ public:
 			((GSVector4i*)dst)[0] = (s[j * 2 + 0] >> 24).gather32_32<>(pal);
 			((GSVector4i*)dst)[1] = (s[j * 2 + 1] >> 24).gather32_32<>(pal);
 		}
+
+#endif
 	}
 
 	__forceinline static void ExpandBlock8H_16(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
@@ -1160,6 +1265,17 @@ public:
 
 	__forceinline static void ExpandBlock4HL_32(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
 	{
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		for (int j = 0; j < 8; j++, dst += dstpitch)
+		{
+			((GSVector8i*)dst)[0] = ((s[j] >> 24) & 0xf).gather32_32(pal);
+		}
+
+#else
+
 		for (int j = 0; j < 8; j++, dst += dstpitch)
 		{
 			const GSVector4i* s = (const GSVector4i*)src;
@@ -1167,6 +1283,8 @@ public:
 			((GSVector4i*)dst)[0] = ((s[j * 2 + 0] >> 24) & 0xf).gather32_32<>(pal);
 			((GSVector4i*)dst)[1] = ((s[j * 2 + 1] >> 24) & 0xf).gather32_32<>(pal);
 		}
+
+#endif
 	}
 
 	__forceinline static void ExpandBlock4HL_16(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
@@ -1184,6 +1302,17 @@ public:
 
 	__forceinline static void ExpandBlock4HH_32(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
 	{
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		for (int j = 0; j < 8; j++, dst += dstpitch)
+		{
+			((GSVector8i*)dst)[0] = (s[j] >> 28).gather32_32(pal);
+		}
+
+#else
+
 		for (int j = 0; j < 8; j++, dst += dstpitch)
 		{
 			const GSVector4i* s = (const GSVector4i*)src;
@@ -1191,6 +1320,8 @@ public:
 			((GSVector4i*)dst)[0] = (s[j * 2 + 0] >> 28).gather32_32<>(pal);
 			((GSVector4i*)dst)[1] = (s[j * 2 + 1] >> 28).gather32_32<>(pal);
 		}
+
+#endif
 	}
 
 	__forceinline static void ExpandBlock4HH_16(uint32* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
@@ -1685,13 +1816,13 @@ public:
 			GSVector4i::sw16(v0, v1, v2, v3);
 			GSVector4i::sw32(v0, v1, v3, v2);
 
-			v0.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v0, pal, dst);
 			dst += dstpitch;
-			v3.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v3, pal, dst);
 			dst += dstpitch;
-			v1.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v1, pal, dst);
 			dst += dstpitch;
-			v2.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v2, pal, dst);
 			dst += dstpitch;
 
 			v2 = s[i * 8 + 4].shuffle8(mask);
@@ -1702,13 +1833,13 @@ public:
 			GSVector4i::sw16(v0, v1, v2, v3);
 			GSVector4i::sw32(v0, v1, v3, v2);
 
-			v0.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v0, pal, dst);
 			dst += dstpitch;
-			v3.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v3, pal, dst);
 			dst += dstpitch;
-			v1.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v1, pal, dst);
 			dst += dstpitch;
-			v2.gather32_8<>(pal, (GSVector4i*)dst);
+			Gather32_8(v2, pal, dst);
 			dst += dstpitch;
 		}
 	}
@@ -1742,13 +1873,13 @@ public:
 
 			GSVector4i::sw16rh(v0, v1, v2, v3);
 
-			v0.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v0, pal, dst);
 			dst += dstpitch;
-			v1.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v1, pal, dst);
 			dst += dstpitch;
-			v2.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v2, pal, dst);
 			dst += dstpitch;
-			v3.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v3, pal, dst);
 			dst += dstpitch;
 
 			v0 = s[i * 8 + 4].xzyw();
@@ -1767,13 +1898,13 @@ public:
 
 			GSVector4i::sw16rl(v0, v1, v2, v3);
 
-			v0.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v0, pal, dst);
 			dst += dstpitch;
-			v1.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v1, pal, dst);
 			dst += dstpitch;
-			v2.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v2, pal, dst);
 			dst += dstpitch;
-			v3.gather64_8<>(pal, (GSVector4i*)dst);
+			Gather64_8(v3, pal, dst);
 			dst += dstpitch;
 		}
 	}
@@ -1784,6 +1915,25 @@ public:
 	{
 		//printf("ReadAndExpandBlock8H_32\n");
 
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		GSVector8i v0, v1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			v0 = s[i * 2 + 0];
+			v1 = s[i * 2 + 1];
+
+			GSVector8i::store<true>(&dst[dstpitch * 0], (v0.upl64(v1).acbd() >> 24).gather32_32(pal));
+			GSVector8i::store<true>(&dst[dstpitch * 1], (v0.uph64(v1).acbd() >> 24).gather32_32(pal));
+
+			dst += dstpitch * 2;
+		}
+
+#else
+
 		const GSVector4i* s = (const GSVector4i*)src;
 
 		GSVector4i v0, v1, v2, v3;
@@ -1807,6 +1957,8 @@ public:
 
 			dst += dstpitch;
 		}
+
+#endif
 	}
 
 	// TODO: ReadAndExpandBlock8H_16
@@ -1814,6 +1966,25 @@ public:
 	__forceinline static void ReadAndExpandBlock4HL_32(const uint8* RESTRICT src, uint8* RESTRICT dst, int dstpitch, const uint32* RESTRICT pal)
 	{
 		//printf("ReadAndExpandBlock4HL_32\n");
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		GSVector8i v0, v1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			v0 = s[i * 2 + 0];
+			v1 = s[i * 2 + 1];
+
+			GSVector8i::store<true>(&dst[dstpitch * 0], ((v0.upl64(v1).acbd() >> 24) & 0xf).gather32_32(pal));
+			GSVector8i::store<true>(&dst[dstpitch * 1], ((v0.uph64(v1).acbd() >> 24) & 0xf).gather32_32(pal));
+
+			dst += dstpitch * 2;
+		}
+
+#else
+
 		const GSVector4i* s = (const GSVector4i*)src;
 
 		GSVector4i v0, v1, v2, v3;
@@ -1837,6 +2008,8 @@ public:
 
 			dst += dstpitch;
 		}
+
+#endif
 	}
 
 	// TODO: ReadAndExpandBlock4HL_16
@@ -1845,6 +2018,25 @@ public:
 	{
 		//printf("ReadAndExpandBlock4HH_32\n");
 
+#if _M_SSE >= 0x501
+
+		const GSVector8i* s = (const GSVector8i*)src;
+
+		GSVector8i v0, v1;
+
+		for (int i = 0; i < 4; i++)
+		{
+			v0 = s[i * 2 + 0];
+			v1 = s[i * 2 + 1];
+
+			GSVector8i::store<true>(&dst[dstpitch * 0], (v0.upl64(v1).acbd() >> 28).gather32_32(pal));
+			GSVector8i::store<true>(&dst[dstpitch * 1], (v0.uph64(v1).acbd() >> 28).gather32_32(pal));
+
+			dst += dstpitch * 2;
+		}
+
+#else
+
 		const GSVector4i* s = (const GSVector4i*)src;
 
 		GSVector4i v0, v1, v2, v3;
@@ -1868,6 +2060,8 @@ public:
 
 			dst += dstpitch;
 		}
+
+#endif
 	}
 
 	// TODO: ReadAndExpandBlock4HH_16
@@ -400,7 +400,7 @@ static IPin* GetFirstPin(IBaseFilter* pBF, PIN_DIRECTION dir)
 //
 
 GSCapture::GSCapture()
-	: m_capturing(false), m_frame(0)
+	: m_capturing(false), m_frame(0), m_dropped(0)
 	, m_out_dir("/tmp/GS_Capture") // FIXME Later add an option
 {
 	m_out_dir = theApp.GetConfigS("capture_out_dir");
@@ -516,6 +516,12 @@ bool GSCapture::BeginCapture(float fps, GSVector2i recommendedResolution, float
 
 	CComQIPtr<IGSSource>(m_src)->DeliverNewSegment();
 
+	m_encoder = std::make_unique<GSJobQueue<std::shared_ptr<Frame>, 8>>([this](std::shared_ptr<Frame>& frame) {
+		CComQIPtr<IGSSource>(m_src)->DeliverFrame(frame->bits.data(), frame->pitch, frame->rgba);
+	});
+
+	m_dropped = 0;
+
 	m_capturing = true;
 	filename = convert_utf16_to_utf8(dlg.m_filename.erase(dlg.m_filename.length() - 3, 3) + L"wav");
 	return true;
@@ -534,6 +540,8 @@ bool GSCapture::BeginCapture(float fps, GSVector2i recommendedResolution, float
 		m_workers.push_back(std::unique_ptr<GSPng::Worker>(new GSPng::Worker(&GSPng::Process)));
 	}
 
+	m_dropped = 0;
+
 	m_capturing = true;
 	filename = m_out_dir + "/audio_recording.wav";
 	return true;
@@ -555,7 +563,19 @@ bool GSCapture::DeliverFrame(const void* bits, int pitch, bool rgba)
 
 	if (m_src)
 	{
-		CComQIPtr<IGSSource>(m_src)->DeliverFrame(bits, pitch, rgba);
+		auto frame = std::make_shared<Frame>();
+
+		frame->bits.assign(static_cast<const uint8*>(bits), static_cast<const uint8*>(bits) + pitch * m_size.y);
+		frame->pitch = pitch;
+		frame->rgba = rgba;
+
+		// Drop the frame rather than stalling the renderer on the encoder
+		if (!m_encoder->TryPush(frame))
+		{
+			m_dropped++;
+
+			return false;
+		}
 
 		return true;
 	}
@@ -564,7 +584,13 @@ bool GSCapture::DeliverFrame(const void* bits, int pitch, bool rgba)
 
 	std::string out_file = m_out_dir + format("/frame.%010d.png", m_frame);
 	//GSPng::Save(GSPng::RGB_PNG, out_file, (uint8*)bits, m_size.x, m_size.y, pitch, m_compression_level);
-	m_workers[m_frame % m_threads]->Push(std::make_shared<GSPng::Transaction>(GSPng::RGB_PNG, out_file, static_cast<const uint8*>(bits), m_size.x, m_size.y, pitch, m_compression_level));
+	if (!m_workers[m_frame % m_threads]->TryPush(std::make_shared<GSPng::Transaction>(GSPng::RGB_PNG, out_file, static_cast<const uint8*>(bits), m_size.x, m_size.y, pitch, m_compression_level)))
+	{
+		// Drop the frame rather than stalling the renderer on the encoders
+		m_dropped++;
+
+		return false;
+	}
 
 	m_frame++;
 
@@ -582,6 +608,9 @@ bool GSCapture::EndCapture()
 
 #ifdef _WIN32
 
+	// Encode the queued frames
+	m_encoder.reset();
+
 	if (m_src)
 	{
 		CComQIPtr<IGSSource>(m_src)->DeliverEOS();
@@ -603,6 +632,9 @@ bool GSCapture::EndCapture()
 
 #endif
 
+	if (m_dropped)
+		printf("GSCapture: %llu frames dropped\n", m_dropped);
+
 	m_capturing = false;
 
 	return true;
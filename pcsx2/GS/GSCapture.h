@@ -28,14 +28,25 @@ class GSCapture
 	bool m_capturing;
 	GSVector2i m_size;
 	uint64 m_frame;
+	uint64 m_dropped;
 	std::string m_out_dir;
 	int m_threads;
 
 #ifdef _WIN32
 
+	struct Frame
+	{
+		std::vector<uint8> bits;
+		int pitch;
+		bool rgba;
+	};
+
 	CComPtr<IGraphBuilder> m_graph;
 	CComPtr<IBaseFilter> m_src;
 
+	// Encodes off the GS thread, full when the encoder falls behind
+	std::unique_ptr<GSJobQueue<std::shared_ptr<Frame>, 8>> m_encoder;
+
 #elif defined(__unix__)
 
 	std::vector<std::unique_ptr<GSPng::Worker>> m_workers;
@@ -49,6 +60,7 @@ public:
 
 	bool BeginCapture(float fps, GSVector2i recommendedResolution, float aspect, std::string& filename);
 	bool DeliverFrame(const void* bits, int pitch, bool rgba);
+	void DropFrame() { m_dropped++; }
 	bool EndCapture();
 
 	bool IsCapturing() { return m_capturing; }
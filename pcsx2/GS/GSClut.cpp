@@ -30,6 +30,16 @@ GSClut::GSClut(GSLocalMemory* mem)
 	m_write.dirty = true;
 	m_read.dirty = true;
 
+	m_palettes = (DecodedPalette*)_aligned_malloc(sizeof(DecodedPalette) * PaletteCacheSize, 32);
+	m_palette = NULL;
+	m_palette_age = 0;
+	m_pal_hash_valid = 0;
+
+	for (int i = 0; i < PaletteCacheSize; i++)
+	{
+		m_palettes[i].age = 0;
+	}
+
 	for (int i = 0; i < 16; i++)
 	{
 		for (int j = 0; j < 64; j++)
@@ -100,6 +110,8 @@ GSClut::GSClut(GSLocalMemory* mem)
 GSClut::~GSClut()
 {
 	vmfree(m_clut, CLUT_ALLOC_SIZE);
+
+	_aligned_free(m_palettes);
 }
 
 void GSClut::Invalidate()
@@ -331,6 +343,65 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 		m_read.dirty = false;
 		m_read.adirty = true;
 
+		// Only the entries the palette is expanded from take part in the lookup, CSA
+		// itself does not, so the same colors loaded into another slot still hit.
+
+		const bool t32 = TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24;
+		const bool t16 = TEX0.CPSM == PSM_PSMCT16 || TEX0.CPSM == PSM_PSMCT16S;
+		const bool i8 = TEX0.PSM == PSM_PSMT8 || TEX0.PSM == PSM_PSMT8H;
+		const bool i4 = TEX0.PSM == PSM_PSMT4 || TEX0.PSM == PSM_PSMT4HL || TEX0.PSM == PSM_PSMT4HH;
+
+		if (!(t32 || t16) || !(i8 || i4))
+		{
+			m_palette = NULL;
+
+			return;
+		}
+
+		alignas(32) uint16 src[512];
+
+		const int n = i8 ? 256 : 16;
+		const uint16* s = m_clut + (t32 ? (TEX0.CSA & 15) << 4 : TEX0.CSA << 4);
+
+		int count = n;
+
+		memcpy(src, s, sizeof(uint16) * n);
+
+		if (t32)
+		{
+			memcpy(&src[n], s + 256, sizeof(uint16) * n);
+
+			count += n;
+		}
+
+		const uint32 key = TEX0.CPSM | (i8 ? 0x100 : 0);
+		const uint32 hash = HashCLUT(src, count);
+
+		if (DecodedPalette* p = LookupPalette(TEXA, key, hash, src, count))
+		{
+			if (p != m_palette)
+			{
+				memcpy(m_buff32, p->buff32, sizeof(p->buff32));
+
+				if (i4)
+				{
+					memcpy(m_buff64, p->buff64, sizeof(p->buff64));
+				}
+
+				m_pal_hash[0] = p->pal_hash[0];
+				m_pal_hash[1] = p->pal_hash[1];
+				m_pal_hash_valid = p->pal_hash_valid;
+
+				m_palette = p;
+			}
+
+			m_read.adirty = p->adirty;
+			m_read.amin = p->amin;
+			m_read.amax = p->amax;
+
+			return;
+		}
+
 		uint16* clut = m_clut;
 
 		if (TEX0.CPSM == PSM_PSMCT32 || TEX0.CPSM == PSM_PSMCT24)
@@ -371,7 +442,131 @@ void GSClut::Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
 					break;
 			}
 		}
+
+		InsertPalette(TEXA, key, hash, src, count, i4);
+	}
+}
+
+GSClut::DecodedPalette* GSClut::LookupPalette(const GIFRegTEXA& TEXA, uint32 key, uint32 hash, const uint16* src, int count)
+{
+	for (int i = 0; i < PaletteCacheSize; i++)
+	{
+		DecodedPalette* p = &m_palettes[i];
+
+		if (p->age != 0 && p->key == key && p->hash == hash && p->TEXA.u64 == TEXA.u64 && memcmp(p->src, src, sizeof(uint16) * count) == 0)
+		{
+			p->age = ++m_palette_age;
+
+			return p;
+		}
+	}
+
+	return NULL;
+}
+
+void GSClut::InsertPalette(const GIFRegTEXA& TEXA, uint32 key, uint32 hash, const uint16* src, int count, bool expand64)
+{
+	DecodedPalette* p = &m_palettes[0];
+
+	for (int i = 1; i < PaletteCacheSize && p->age != 0; i++)
+	{
+		if (m_palettes[i].age < p->age)
+		{
+			p = &m_palettes[i];
+		}
+	}
+
+	memcpy(p->buff32, m_buff32, sizeof(p->buff32));
+
+	if (expand64)
+	{
+		memcpy(p->buff64, m_buff64, sizeof(p->buff64));
+	}
+
+	memcpy(p->src, src, sizeof(uint16) * count);
+
+	p->TEXA = TEXA;
+	p->key = key;
+	p->hash = hash;
+	p->age = ++m_palette_age;
+	p->adirty = true;
+	p->pal_hash_valid = 0;
+
+	m_pal_hash_valid = 0;
+	m_palette = p;
+}
+
+uint32 GSClut::HashCLUT(const uint16* RESTRICT src, int count)
+{
+	ASSERT((count & 3) == 0);
+
+	const uint64* s = (const uint64*)src;
+
+	uint64 h = 0xcbf29ce484222325ull;
+
+	for (int i = 0, j = count >> 2; i < j; i++)
+	{
+		h = (h ^ s[i]) * 0x100000001b3ull;
+	}
+
+	return (uint32)(h ^ (h >> 32));
+}
+
+size_t GSClut::GetPaletteHash(uint16 pal) const
+{
+	ASSERT(pal == 16 || pal == 256);
+
+	const int i = pal == 16 ? 0 : 1;
+
+	if (!(m_pal_hash_valid & (1 << i)))
+	{
+		m_pal_hash[i] = HashPalette(m_buff32, pal);
+		m_pal_hash_valid |= 1 << i;
+
+		if (m_palette)
+		{
+			m_palette->pal_hash[i] = m_pal_hash[i];
+			m_palette->pal_hash_valid |= 1 << i;
+		}
 	}
+
+	return m_pal_hash[i];
+}
+
+// The hashing function is implemented by taking two things into account:
+// 1) The clut can be an array of 16 or 256 uint32 (depending on the pal parameter) and in order to speed up the computation of the hash
+//    the array is hashed in blocks of 16 uint32, so for clut of size 16 uint32 the hashing is computed in one pass and for clut of 256 uint32
+//    it is computed in 16 passes,
+// 2) The clut can contain many 0s, so as a way to increase the spread of hashing values for small changes in the input clut the hashing function
+//    is using addition in combination with logical XOR operator; The addition constants are large prime numbers, which may help in achieving what intended.
+size_t GSClut::HashPalette(const uint32* RESTRICT clut, uint16 pal)
+{
+	ASSERT((pal & 15) == 0);
+
+	size_t clut_hash = 3831179159;
+	for (uint16 i = 0; i < pal; i += 16)
+	{
+		clut_hash = (clut_hash + 1488000301) ^ (clut[i     ] +   33644011);
+		clut_hash = (clut_hash + 3831179159) ^ (clut[i +  1] +   47627467);
+		clut_hash = (clut_hash + 3659574209) ^ (clut[i +  2] +  577038523);
+		clut_hash = (clut_hash +   33644011) ^ (clut[i +  3] + 3491555267);
+
+		clut_hash = (clut_hash +  777771959) ^ (clut[i +  4] + 3301075993);
+		clut_hash = (clut_hash + 4019618579) ^ (clut[i +  5] + 4186992613);
+		clut_hash = (clut_hash + 3465668953) ^ (clut[i +  6] + 3043435883);
+		clut_hash = (clut_hash + 3494478943) ^ (clut[i +  7] + 3441897883);
+
+		clut_hash = (clut_hash + 3432010979) ^ (clut[i +  8] + 2167922789);
+		clut_hash = (clut_hash + 1570862863) ^ (clut[i +  9] + 3401920591);
+		clut_hash = (clut_hash + 1002648679) ^ (clut[i + 10] + 1293530519);
+		clut_hash = (clut_hash +  551381741) ^ (clut[i + 11] + 2539834039);
+
+		clut_hash = (clut_hash + 3768974459) ^ (clut[i + 12] +  169943507);
+		clut_hash = (clut_hash +  862380703) ^ (clut[i + 13] + 2906932549);
+		clut_hash = (clut_hash + 3433082137) ^ (clut[i + 14] + 4234384109);
+		clut_hash = (clut_hash + 2679083843) ^ (clut[i + 15] + 2719605247);
+	}
+	return clut_hash;
 }
 
 void GSClut::GetAlphaMinMax32(int& amin_out, int& amax_out)
@@ -437,6 +632,13 @@ void GSClut::GetAlphaMinMax32(int& amin_out, int& amax_out)
 		}
 	}
 
+	if (m_palette)
+	{
+		m_palette->adirty = false;
+		m_palette->amin = m_read.amin;
+		m_palette->amax = m_read.amax;
+	}
+
 	amin_out = m_read.amin;
 	amax_out = m_read.amax;
 }
@@ -639,6 +841,27 @@ __forceinline void GSClut::ReadCLUT_T16_I4(const uint16* RESTRICT clut, uint32*
 
 void GSClut::ExpandCLUT64_T32_I8(const uint32* RESTRICT src, uint64* RESTRICT dst)
 {
+#if _M_SSE >= 0x501
+
+	// acbd() pre-swaps the middle quadwords so the in-lane unpacks come out in order
+
+	const GSVector8i lo0 = GSVector8i::load<true>(&src[0]).acbd();
+	const GSVector8i lo1 = GSVector8i::load<true>(&src[8]).acbd();
+
+	GSVector8i* d = (GSVector8i*)dst;
+
+	for (int i = 0; i < 16; i++)
+	{
+		const GSVector8i hi = GSVector8i::broadcast32(&src[i]);
+
+		d[i * 4 + 0] = lo0.upl32(hi);
+		d[i * 4 + 1] = lo0.uph32(hi);
+		d[i * 4 + 2] = lo1.upl32(hi);
+		d[i * 4 + 3] = lo1.uph32(hi);
+	}
+
+#else
+
 	GSVector4i* s = (GSVector4i*)src;
 	GSVector4i* d = (GSVector4i*)dst;
 
@@ -651,6 +874,8 @@ void GSClut::ExpandCLUT64_T32_I8(const uint32* RESTRICT src, uint64* RESTRICT ds
 	ExpandCLUT64_T32(s1, s0, s1, s2, s3, &d[32]);
 	ExpandCLUT64_T32(s2, s0, s1, s2, s3, &d[64]);
 	ExpandCLUT64_T32(s3, s0, s1, s2, s3, &d[96]);
+
+#endif
 }
 
 __forceinline void GSClut::ExpandCLUT64_T32(const GSVector4i& hi, const GSVector4i& lo0, const GSVector4i& lo1, const GSVector4i& lo2, const GSVector4i& lo3, GSVector4i* dst)
@@ -733,6 +958,34 @@ void GSClut::Expand16(const uint16* RESTRICT src, uint32* RESTRICT dst, int w, c
 {
 	ASSERT((w & 7) == 0);
 
+#if _M_SSE >= 0x501
+
+	const GSVector8i rm = GSVector8i::broadcast32(m_rm);
+	const GSVector8i gm = GSVector8i::broadcast32(m_gm);
+	const GSVector8i bm = GSVector8i::broadcast32(m_bm);
+
+	const GSVector8i TA0(TEXA.TA0 << 24);
+	const GSVector8i TA1(TEXA.TA1 << 24);
+
+	GSVector8i* d = (GSVector8i*)dst;
+
+	// zero extended, the sign of the color is moved to bit 31 for blend8
+
+	for (int i = 0, j = w >> 3; i < j; i++)
+	{
+		GSVector8i c = GSVector8i::u16to32c(&src[i * 8]);
+		GSVector8i a = TA0.blend8(TA1, c << 16);
+
+		if (TEXA.AEM)
+		{
+			a = a.andnot(c == GSVector8i::zero());
+		}
+
+		d[i] = ((c & rm) << 3) | ((c & gm) << 6) | ((c & bm) << 9) | a;
+	}
+
+#else
+
 	const GSVector4i rm = m_rm;
 	const GSVector4i gm = m_gm;
 	const GSVector4i bm = m_bm;
@@ -767,6 +1020,8 @@ void GSClut::Expand16(const uint16* RESTRICT src, uint32* RESTRICT dst, int w, c
 			d[i * 2 + 1] = ((ch & rm) << 3) | ((ch & gm) << 6) | ((ch & bm) << 9) | TA0.blend8(TA1, ch.sra16(15)).andnot(ch == GSVector4i::zero());
 		}
 	}
+
+#endif
 }
 
 //
@@ -54,6 +54,41 @@ class alignas(32) GSClut : public GSAlignedClass<32>
 		bool IsDirty(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 	} m_read;
 
+	// Decoded palettes, keyed by the CLUT entries they were read from rather than by
+	// CBP/CSA, so switching back to a palette seen before (even in another slot or
+	// after a reload of the same data) only costs a copy.
+
+	static const int PaletteCacheSize = 8;
+
+	struct alignas(32) DecodedPalette
+	{
+		uint32 buff32[256];
+		uint64 buff64[256];
+		uint16 src[512];
+		GIFRegTEXA TEXA;
+		uint32 key;
+		uint32 hash;
+		uint32 age;
+		bool adirty;
+		int amin, amax;
+		size_t pal_hash[2];
+		uint8 pal_hash_valid;
+	};
+
+	DecodedPalette* m_palettes;
+	DecodedPalette* m_palette;
+	uint32 m_palette_age;
+
+	// HashPalette of m_buff32 for 16 and 256 entries, only recomputed after m_buff32 was
+	// decoded again. Bit i of m_pal_hash_valid tells m_pal_hash[i] is up to date.
+
+	mutable size_t m_pal_hash[2];
+	mutable uint8 m_pal_hash_valid;
+
+	DecodedPalette* LookupPalette(const GIFRegTEXA& TEXA, uint32 key, uint32 hash, const uint16* src, int count);
+	void InsertPalette(const GIFRegTEXA& TEXA, uint32 key, uint32 hash, const uint16* src, int count, bool expand64);
+	static uint32 HashCLUT(const uint16* RESTRICT src, int count);
+
 	typedef void (GSClut::*writeCLUT)(const GIFRegTEX0& TEX0, const GIFRegTEXCLUT& TEXCLUT);
 
 	writeCLUT m_wc[2][16][64];
@@ -105,6 +140,10 @@ public:
 	void Read32(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 	void GetAlphaMinMax32(int& amin, int& amax);
 
+	// Hash of the first pal (16 or 256) entries of the decoded palette, call only after Read32
+	size_t GetPaletteHash(uint16 pal) const;
+	static size_t HashPalette(const uint32* RESTRICT clut, uint16 pal);
+
 	uint32 operator[](size_t i) const { return m_buff32[i]; }
 
 	operator const uint32*() const { return m_buff32; }
@@ -111,81 +111,133 @@ void GSDump::AppendRawData(uint8 c)
 // GSDumpXz implementation
 //////////////////////////////////////////////////////////////////////
 
+// Matches the block size of the encoder, so each chunk keeps a thread of lzma busy
+static const size_t s_xz_chunk_size = 16 * 1024 * 1024;
+
 GSDumpXz::GSDumpXz(const std::string& fn, uint32 crc, const freezeData& fd, const GSPrivRegSet* regs)
 	: GSDumpBase(fn + ".gs.xz")
+	, m_out_buff(1024 * 1024)
 {
 	m_strm = LZMA_STREAM_INIT;
-	lzma_ret ret = lzma_easy_encoder(&m_strm, 6 /*level*/, LZMA_CHECK_CRC64);
+	m_in_buff = GetBuffer();
+
+	// Cut the stream into independent blocks, so the player can decompress them in parallel
+	lzma_mt mt;
+	memset(&mt, 0, sizeof(mt));
+	mt.threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+	mt.block_size = s_xz_chunk_size;
+	mt.preset = 6; // level
+	mt.check = LZMA_CHECK_CRC64;
+
+	lzma_ret ret = lzma_stream_encoder_mt(&m_strm, &mt);
 	if (ret != LZMA_OK)
 	{
 		fprintf(stderr, "GSDumpXz: Error initializing LZMA encoder ! (error code %u)\n", ret);
 		return;
 	}
 
+	m_compressor = std::unique_ptr<Compressor>(new Compressor([this](Buffer& buff) { Process(buff); }));
+
 	AddHeader(crc, fd, regs);
 }
 
 GSDumpXz::~GSDumpXz()
 {
-	Flush();
+	if (m_compressor)
+	{
+		Flush();
 
-	// Finish the stream
-	m_strm.avail_in = 0;
-	Compress(LZMA_FINISH, LZMA_STREAM_END);
+		// Joins the thread once the queued chunks are compressed
+		m_compressor.reset();
+
+		// Finish the stream
+		m_strm.avail_in = 0;
+		Compress(LZMA_FINISH, LZMA_STREAM_END);
+	}
 
 	lzma_end(&m_strm);
 }
 
+GSDumpXz::Buffer GSDumpXz::GetBuffer()
+{
+	std::lock_guard<std::mutex> lock(m_free_lock);
+
+	if (m_free_buffs.empty())
+	{
+		Buffer buff = std::make_shared<std::vector<uint8>>();
+		buff->reserve(s_xz_chunk_size);
+		return buff;
+	}
+
+	Buffer buff = std::move(m_free_buffs.back());
+	m_free_buffs.pop_back();
+	return buff;
+}
+
 void GSDumpXz::AppendRawData(const void* data, size_t size)
 {
-	size_t old_size = m_in_buff.size();
-	m_in_buff.resize(old_size + size);
-	memcpy(&m_in_buff[old_size], data, size);
+	const uint8* p = static_cast<const uint8*>(data);
+	m_in_buff->insert(m_in_buff->end(), p, p + size);
 
-	// Enough data was accumulated, time to write/compress it.  If compression
-	// is enabled, it will freeze PCSX2. 1GB should be enough for long dump.
-	//
-	// Note: long dumps are currently not supported so this path won't be executed
-	if (m_in_buff.size() > 1024 * 1024 * 1024)
+	if (m_in_buff->size() >= s_xz_chunk_size)
 		Flush();
 }
 
 void GSDumpXz::AppendRawData(uint8 c)
 {
-	m_in_buff.push_back(c);
+	m_in_buff->push_back(c);
 }
 
 void GSDumpXz::Flush()
 {
-	if (m_in_buff.empty())
+	if (m_in_buff->empty())
+		return;
+
+	if (!m_compressor)
+	{
+		m_in_buff->clear();
 		return;
+	}
+
+	m_compressor->Push(m_in_buff);
+	m_in_buff = GetBuffer();
+}
 
-	m_strm.next_in = m_in_buff.data();
-	m_strm.avail_in = m_in_buff.size();
+// Runs on the compressor thread
+void GSDumpXz::Process(Buffer& buff)
+{
+	m_strm.next_in = buff->data();
+	m_strm.avail_in = buff->size();
 
 	Compress(LZMA_RUN, LZMA_OK);
 
-	m_in_buff.clear();
+	buff->clear();
+
+	std::lock_guard<std::mutex> lock(m_free_lock);
+	m_free_buffs.push_back(std::move(buff));
 }
 
 void GSDumpXz::Compress(lzma_action action, lzma_ret expected_status)
 {
-	std::vector<uint8> out_buff(1024 * 1024);
-	do
+	for (;;)
 	{
-		m_strm.next_out = out_buff.data();
-		m_strm.avail_out = out_buff.size();
+		m_strm.next_out = m_out_buff.data();
+		m_strm.avail_out = m_out_buff.size();
 
 		lzma_ret ret = lzma_code(&m_strm, action);
 
-		if (ret != expected_status)
+		if (ret != LZMA_OK && ret != expected_status)
 		{
 			fprintf(stderr, "GSDumpXz: Error %d\n", (int)ret);
 			return;
 		}
 
-		size_t write_size = out_buff.size() - m_strm.avail_out;
-		Write(out_buff.data(), write_size);
+		size_t write_size = m_out_buff.size() - m_strm.avail_out;
+		Write(m_out_buff.data(), write_size);
 
-	} while (m_strm.avail_out == 0);
+		// The threaded encoder holds back output until blocks are done, keep going
+		// until all of the input is consumed (and for LZMA_FINISH, the stream ended)
+		if (ret == expected_status && m_strm.avail_in == 0 && (action == LZMA_FINISH || m_strm.avail_out != 0))
+			break;
+	}
 }
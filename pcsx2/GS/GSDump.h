@@ -17,6 +17,7 @@
 
 #include "GS.h"
 #include "Renderers/SW/GSVertexSW.h"
+#include "GSThread_CXX11.h"
 #include <lzma.h>
 
 /*
@@ -70,13 +71,27 @@ public:
 	virtual ~GSDump() = default;
 };
 
+// The GS thread only copies the packets into chunks, which are compressed and written by
+// a dedicated thread. The queue is bounded, a GS thread that outruns lzma waits for it.
 class GSDumpXz final : public GSDumpBase
 {
+	using Buffer = std::shared_ptr<std::vector<uint8>>;
+	using Compressor = GSJobQueue<Buffer, 8>;
+
 	lzma_stream m_strm;
 
-	std::vector<uint8> m_in_buff;
+	Buffer m_in_buff;
+	std::vector<uint8> m_out_buff;
+
+	// Chunks given back by the compressor, reused to avoid faulting new memory in
+	std::mutex m_free_lock;
+	std::vector<Buffer> m_free_buffs;
+
+	std::unique_ptr<Compressor> m_compressor;
 
+	Buffer GetBuffer();
 	void Flush();
+	void Process(Buffer& buff);
 	void Compress(lzma_action action, lzma_ret expected_status);
 	void AppendRawData(const void* data, size_t size);
 	void AppendRawData(uint8 c);
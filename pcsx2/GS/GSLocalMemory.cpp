@@ -72,6 +72,10 @@ GSLocalMemory::psm_t GSLocalMemory::m_psm[64];
 
 GSLocalMemory::GSLocalMemory()
 	: m_clut(this)
+	, m_omap(1024)
+	, m_pomap(64)
+	, m_po4map(64)
+	, m_p2tmap(256)
 {
 	m_use_fifo_alloc = theApp.GetConfigB("UserHacks") && theApp.GetConfigB("wrap_gs_mem");
 	switch (theApp.GetCurrentRendererType())
@@ -476,42 +480,43 @@ GSLocalMemory::GSLocalMemory()
 	m_psm[PSM_PSMZ24].depth  = 1;
 	m_psm[PSM_PSMZ16].depth  = 1;
 	m_psm[PSM_PSMZ16S].depth = 1;
+
+	const int threads = std::max(theApp.GetConfigI("swizzle_threads"), 0);
+
+	for (int i = 0; i < threads; i++)
+	{
+		m_swizzle_workers.push_back(std::unique_ptr<GSJobQueue<SwizzleJob, 16>>(new GSJobQueue<SwizzleJob, 16>(
+			[this](SwizzleJob& job) { (this->*job.wb)(job.l, job.r, job.y, job.h, job.src, job.srcpitch, job.BITBLTBUF); })));
+	}
 }
 
 GSLocalMemory::~GSLocalMemory()
 {
+	m_swizzle_workers.clear();
+
 	if (m_use_fifo_alloc)
 		fifo_free(m_vm8, m_vmsize, 4);
 	else
 		vmfree(m_vm8, m_vmsize * 4);
 
-	for (auto& i : m_omap)
-		delete i.second;
-	for (auto& i : m_pomap)
-		_aligned_free(i.second);
-	for (auto& i : m_po4map)
-		_aligned_free(i.second);
-
-	for (auto& i : m_p2tmap)
-	{
-		delete[] i.second;
-	}
+	m_omap.ForEach([](GSOffset* off) { delete off; });
+	m_pomap.ForEach([](GSPixelOffset* off) { _aligned_free(off); });
+	m_po4map.ForEach([](GSPixelOffset4* off) { _aligned_free(off); });
+	m_p2tmap.ForEach([](std::vector<GSVector2i>* p2t) { delete[] p2t; });
 }
 
 GSOffset* GSLocalMemory::GetOffset(uint32 bp, uint32 bw, uint32 psm)
 {
 	uint32 hash = bp | (bw << 14) | (psm << 20);
 
-	auto i = m_omap.find(hash);
-
-	if (i != m_omap.end())
+	if (GSOffset* off = m_omap.Find(hash))
 	{
-		return i->second;
+		return off;
 	}
 
 	GSOffset* off = new GSOffset(bp, bw, psm);
 
-	m_omap[hash] = off;
+	m_omap.Insert(hash, off);
 
 	return off;
 }
@@ -526,18 +531,11 @@ GSPixelOffset* GSLocalMemory::GetPixelOffset(const GIFRegFRAME& FRAME, const GIF
 
 	ASSERT(m_psm[fpsm].trbpp > 8 || m_psm[zpsm].trbpp > 8);
 
-	// "(psm & 0x0f) ^ ((psm & 0xf0) >> 2)" creates 4 bit unique identifiers for render target formats (only)
-
-	uint32 fpsm_hash = (fpsm & 0x0f) ^ ((fpsm & 0x30) >> 2);
-	uint32 zpsm_hash = (zpsm & 0x0f) ^ ((zpsm & 0x30) >> 2);
-
-	uint32 hash = (FRAME.FBP << 0) | (ZBUF.ZBP << 9) | (bw << 18) | (fpsm_hash << 24) | (zpsm_hash << 28);
-
-	auto it = m_pomap.find(hash);
+	uint32 hash = PixelOffsetHash(FRAME, ZBUF);
 
-	if (it != m_pomap.end())
+	if (GSPixelOffset* off = m_pomap.Find(hash))
 	{
-		return it->second;
+		return off;
 	}
 
 	GSPixelOffset* off = (GSPixelOffset*)_aligned_malloc(sizeof(GSPixelOffset), 32);
@@ -567,7 +565,7 @@ GSPixelOffset* GSLocalMemory::GetPixelOffset(const GIFRegFRAME& FRAME, const GIF
 		off->col[i].y = m_psm[zpsm].rowOffset[0][i] << zs;
 	}
 
-	m_pomap[hash] = off;
+	m_pomap.Insert(hash, off);
 
 	return off;
 }
@@ -582,18 +580,11 @@ GSPixelOffset4* GSLocalMemory::GetPixelOffset4(const GIFRegFRAME& FRAME, const G
 
 	ASSERT(m_psm[fpsm].trbpp > 8 || m_psm[zpsm].trbpp > 8);
 
-	// "(psm & 0x0f) ^ ((psm & 0xf0) >> 2)" creates 4 bit unique identifiers for render target formats (only)
+	uint32 hash = PixelOffsetHash(FRAME, ZBUF);
 
-	uint32 fpsm_hash = (fpsm & 0x0f) ^ ((fpsm & 0x30) >> 2);
-	uint32 zpsm_hash = (zpsm & 0x0f) ^ ((zpsm & 0x30) >> 2);
-
-	uint32 hash = (FRAME.FBP << 0) | (ZBUF.ZBP << 9) | (bw << 18) | (fpsm_hash << 24) | (zpsm_hash << 28);
-
-	auto it = m_po4map.find(hash);
-
-	if (it != m_po4map.end())
+	if (GSPixelOffset4* off = m_po4map.Find(hash))
 	{
-		return it->second;
+		return off;
 	}
 
 	GSPixelOffset4* off = (GSPixelOffset4*)_aligned_malloc(sizeof(GSPixelOffset4), 32);
@@ -623,7 +614,7 @@ GSPixelOffset4* GSLocalMemory::GetPixelOffset4(const GIFRegFRAME& FRAME, const G
 		off->col[i].y = m_psm[zpsm].rowOffset[0][i * 4] << zs;
 	}
 
-	m_po4map[hash] = off;
+	m_po4map.Insert(hash, off);
 
 	return off;
 }
@@ -634,11 +625,9 @@ std::vector<GSVector2i>* GSLocalMemory::GetPage2TileMap(const GIFRegTEX0& TEX0)
 {
 	uint64 hash = TEX0.u64 & 0x3ffffffffull; // TBP0 TBW PSM TW TH
 
-	auto it = m_p2tmap.find(hash);
-
-	if (it != m_p2tmap.end())
+	if (std::vector<GSVector2i>* p2t = m_p2tmap.Find(hash))
 	{
-		return it->second;
+		return p2t;
 	}
 
 	GSVector2i bs = m_psm[TEX0.PSM].bs;
@@ -704,7 +693,7 @@ std::vector<GSVector2i>* GSLocalMemory::GetPage2TileMap(const GIFRegTEX0& TEX0)
 		std::sort(p2t[page].begin(), p2t[page].end(), cmp_vec2x);
 	}
 
-	m_p2tmap[hash] = p2t;
+	m_p2tmap.Insert(hash, p2t);
 
 	return p2t;
 }
@@ -767,6 +756,45 @@ void GSLocalMemory::WriteImageBlock(int l, int r, int y, int h, const uint8* src
 	}
 }
 
+void GSLocalMemory::WriteImageBlocks(writeImageBlock wb, int bsy, int l, int r, int y, int h, const uint8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
+{
+	const int workers = static_cast<int>(m_swizzle_workers.size());
+
+	// Small transfers aren't worth the synchronization, FMV frames and streamed textures are
+	if (workers == 0 || h * srcpitch < 256 * 1024)
+	{
+		(this->*wb)(l, r, y, h, src, srcpitch, BITBLTBUF);
+		return;
+	}
+
+	// Each band covers whole block rows, so no two threads write the same block
+	const int rows = h / bsy;
+	const int band = std::max(rows / (workers + 1), 1) * bsy;
+
+	SwizzleJob job;
+	job.wb = wb;
+	job.l = l;
+	job.r = r;
+	job.h = band;
+	job.srcpitch = srcpitch;
+	job.BITBLTBUF = BITBLTBUF;
+
+	int top = y;
+
+	for (int i = 0; i < workers && top + band < y + h; i++, top += band)
+	{
+		job.y = top;
+		job.src = src + (top - y) * srcpitch;
+
+		m_swizzle_workers[i]->Push(job);
+	}
+
+	(this->*wb)(l, r, top, y + h - top, src + (top - y) * srcpitch, srcpitch, BITBLTBUF);
+
+	for (auto& worker : m_swizzle_workers)
+		worker->Wait();
+}
+
 template <int psm, int bsx, int bsy>
 void GSLocalMemory::WriteImageLeftRight(int l, int r, int y, int h, const uint8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF)
 {
@@ -1030,15 +1058,15 @@ void GSLocalMemory::WriteImage(int& tx, int& ty, const uint8* src, int len, GIFR
 
 					if ((addr & 31) == 0 && (srcpitch & 31) == 0)
 					{
-						WriteImageBlock<psm, bsx, bsy, 32>(la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+						WriteImageBlocks(&GSLocalMemory::WriteImageBlock<psm, bsx, bsy, 32>, bsy, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
 					}
 					else if ((addr & 15) == 0 && (srcpitch & 15) == 0)
 					{
-						WriteImageBlock<psm, bsx, bsy, 16>(la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+						WriteImageBlocks(&GSLocalMemory::WriteImageBlock<psm, bsx, bsy, 16>, bsy, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
 					}
 					else
 					{
-						WriteImageBlock<psm, bsx, bsy, 0>(la, ra, ty, h2, s, srcpitch, BITBLTBUF);
+						WriteImageBlocks(&GSLocalMemory::WriteImageBlock<psm, bsx, bsy, 0>, bsy, la, ra, ty, h2, s, srcpitch, BITBLTBUF);
 					}
 
 					s += srcpitch * h2;
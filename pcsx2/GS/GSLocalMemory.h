@@ -20,6 +20,7 @@
 #include "GSVector.h"
 #include "GSBlock.h"
 #include "GSClut.h"
+#include "GSThread_CXX11.h"
 
 class GSOffset : public GSAlignedClass<32>
 {
@@ -73,6 +74,87 @@ struct GSPixelOffset4
 	uint32 fbp, zbp, fpsm, zpsm, bw;
 };
 
+// Open addressed map from the packed offset parameters to the cached offsets.  It only grows
+// (the offsets live as long as the local memory) and probes linearly from a multiplicative
+// hash, so a lookup is usually a single compare in one cache line.
+template <class T>
+class GSOffsetMap
+{
+	struct Entry
+	{
+		uint64 key;
+		T* value; // NULL when the slot is free
+	};
+
+	std::vector<Entry> m_entries;
+	size_t m_mask;
+	size_t m_count;
+
+	__forceinline size_t Slot(uint64 key) const
+	{
+		return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+	}
+
+	void Grow()
+	{
+		std::vector<Entry> entries(m_entries.size() * 2, Entry{0, NULL});
+		entries.swap(m_entries);
+		m_mask = m_entries.size() - 1;
+
+		for (const Entry& e : entries)
+		{
+			if (e.value)
+			{
+				size_t i = Slot(e.key);
+				while (m_entries[i].value)
+					i = (i + 1) & m_mask;
+				m_entries[i] = e;
+			}
+		}
+	}
+
+public:
+	GSOffsetMap(size_t capacity)
+		: m_entries(capacity, Entry{0, NULL}) // capacity must be a power of 2
+		, m_mask(capacity - 1)
+		, m_count(0)
+	{
+	}
+
+	__forceinline T* Find(uint64 key) const
+	{
+		for (size_t i = Slot(key);; i = (i + 1) & m_mask)
+		{
+			const Entry& e = m_entries[i];
+			if (e.key == key && e.value)
+				return e.value;
+			if (!e.value)
+				return NULL;
+		}
+	}
+
+	void Insert(uint64 key, T* value)
+	{
+		if ((m_count + 1) * 2 > m_entries.size())
+			Grow();
+
+		size_t i = Slot(key);
+		while (m_entries[i].value)
+			i = (i + 1) & m_mask;
+
+		m_entries[i] = Entry{key, value};
+		m_count++;
+	}
+
+	template <class Fn>
+	void ForEach(Fn fn) const
+	{
+		for (const Entry& e : m_entries)
+			if (e.value)
+				fn(e.value);
+	}
+};
+
 class GSLocalMemory : public GSAlignedClass<32>
 {
 public:
@@ -89,6 +171,7 @@ public:
 	typedef void (GSLocalMemory::*readImage)(int& tx, int& ty, uint8* dst, int len, GIFRegBITBLTBUF& BITBLTBUF, GIFRegTRXPOS& TRXPOS, GIFRegTRXREG& TRXREG) const;
 	typedef void (GSLocalMemory::*readTexture)(const GSOffset* RESTRICT off, const GSVector4i& r, uint8* dst, int dstpitch, const GIFRegTEXA& TEXA);
 	typedef void (GSLocalMemory::*readTextureBlock)(uint32 bp, uint8* dst, int dstpitch, const GIFRegTEXA& TEXA) const;
+	typedef void (GSLocalMemory::*writeImageBlock)(int l, int r, int y, int h, const uint8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF);
 
 	struct alignas(128) psm_t
 	{
@@ -124,6 +207,20 @@ public:
 protected:
 	bool m_use_fifo_alloc;
 
+	struct SwizzleJob
+	{
+		writeImageBlock wb;
+		int l, r, y, h;
+		const uint8* src;
+		int srcpitch;
+		GIFRegBITBLTBUF BITBLTBUF;
+	};
+
+	// Large transfers are swizzled in bands of block rows, the last band on the calling thread
+	std::vector<std::unique_ptr<GSJobQueue<SwizzleJob, 16>>> m_swizzle_workers;
+
+	void WriteImageBlocks(writeImageBlock wb, int bsy, int l, int r, int y, int h, const uint8* src, int srcpitch, const GIFRegBITBLTBUF& BITBLTBUF);
+
 	static uint32 pageOffset32[32][32][64];
 	static uint32 pageOffset32Z[32][32][64];
 	static uint32 pageOffset16[32][64][64];
@@ -170,10 +267,20 @@ protected:
 
 	//
 
-	std::unordered_map<uint32, GSOffset*> m_omap;
-	std::unordered_map<uint32, GSPixelOffset*> m_pomap;
-	std::unordered_map<uint32, GSPixelOffset4*> m_po4map;
-	std::unordered_map<uint64, std::vector<GSVector2i>*> m_p2tmap;
+	GSOffsetMap<GSOffset> m_omap;
+	GSOffsetMap<GSPixelOffset> m_pomap;
+	GSOffsetMap<GSPixelOffset4> m_po4map;
+	GSOffsetMap<std::vector<GSVector2i>> m_p2tmap;
+
+	static uint32 PixelOffsetHash(const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF)
+	{
+		// "(psm & 0x0f) ^ ((psm & 0xf0) >> 2)" creates 4 bit unique identifiers for render target formats (only)
+
+		uint32 fpsm_hash = (FRAME.PSM & 0x0f) ^ ((FRAME.PSM & 0x30) >> 2);
+		uint32 zpsm_hash = (ZBUF.PSM & 0x0f) ^ ((ZBUF.PSM & 0x30) >> 2);
+
+		return (FRAME.FBP << 0) | (ZBUF.ZBP << 9) | (FRAME.FBW << 18) | (fpsm_hash << 24) | (zpsm_hash << 28);
+	}
 
 public:
 	GSLocalMemory();
@@ -184,6 +291,24 @@ public:
 	GSPixelOffset4* GetPixelOffset4(const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF);
 	std::vector<GSVector2i>* GetPage2TileMap(const GIFRegTEX0& TEX0);
 
+	// Same as above, but return last without a lookup when it is still the right one.  For the
+	// register writes, which mostly set the offsets the context already has.
+
+	__forceinline GSOffset* GetOffset(GSOffset* last, uint32 bp, uint32 bw, uint32 psm)
+	{
+		return last && last->hash == (bp | (bw << 14) | (psm << 20)) ? last : GetOffset(bp, bw, psm);
+	}
+
+	__forceinline GSPixelOffset* GetPixelOffset(GSPixelOffset* last, const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF)
+	{
+		return last && last->hash == PixelOffsetHash(FRAME, ZBUF) ? last : GetPixelOffset(FRAME, ZBUF);
+	}
+
+	__forceinline GSPixelOffset4* GetPixelOffset4(GSPixelOffset4* last, const GIFRegFRAME& FRAME, const GIFRegZBUF& ZBUF)
+	{
+		return last && last->hash == PixelOffsetHash(FRAME, ZBUF) ? last : GetPixelOffset4(FRAME, ZBUF);
+	}
+
 	// address
 
 	static uint32 BlockNumber32(int x, int y, uint32 bp, uint32 bw)
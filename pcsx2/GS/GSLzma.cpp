@@ -16,6 +16,11 @@
 #include "PrecompiledHeader.h"
 #include "GSLzma.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 GSDumpFile::GSDumpFile(char* filename, const char* repack_filename)
 {
 	m_fp = fopen(filename, "rb");
@@ -59,7 +64,18 @@ GSDumpLzma::GSDumpLzma(char* filename, const char* repack_filename)
 
 	memset(&m_strm, 0, sizeof(lzma_stream));
 
+#if LZMA_VERSION >= UINT32_C(50040002)
+	// Multi-block streams (see GSDumpXz) are decompressed by several threads
+	lzma_mt mt;
+	memset(&mt, 0, sizeof(mt));
+	mt.threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+	mt.memlimit_threading = UINT32_MAX;
+	mt.memlimit_stop = UINT32_MAX;
+
+	lzma_ret ret = lzma_stream_decoder_mt(&m_strm, &mt);
+#else
 	lzma_ret ret = lzma_stream_decoder(&m_strm, UINT32_MAX, 0);
+#endif
 
 	if (ret != LZMA_OK)
 	{
@@ -68,58 +84,118 @@ GSDumpLzma::GSDumpLzma(char* filename, const char* repack_filename)
 	}
 
 	m_buff_size = 1024*1024;
-	m_area      = (uint8_t*)_aligned_malloc(m_buff_size, 32);
 	m_inbuf     = (uint8_t*)_aligned_malloc(BUFSIZ, 32);
 	m_avail     = 0;
 	m_start     = 0;
+	m_action    = LZMA_RUN;
+	m_done      = false;
+	m_error     = false;
+	m_exit      = false;
 
 	m_strm.avail_in  = 0;
 	m_strm.next_in   = m_inbuf;
 
-	m_strm.avail_out = m_buff_size;
-	m_strm.next_out  = m_area;
+	m_thread = std::thread(&GSDumpLzma::Decompress, this);
 }
 
 void GSDumpLzma::Decompress()
 {
-	lzma_action action = LZMA_RUN;
+	// Keep at most 64 MB decompressed ahead of the player
+	const size_t max_queued = 64;
 
-	m_strm.next_out  = m_area;
-	m_strm.avail_out = m_buff_size;
+	lzma_ret ret = LZMA_OK;
 
-	// Nothing left in the input buffer. Read data from the file
-	if (m_strm.avail_in == 0 && !feof(m_fp))
+	while (ret == LZMA_OK)
 	{
-		m_strm.next_in   = m_inbuf;
-		m_strm.avail_in  = fread(m_inbuf, 1, BUFSIZ, m_fp);
+		std::vector<uint8_t> chunk(m_buff_size);
 
-		if (ferror(m_fp))
+		m_strm.next_out  = chunk.data();
+		m_strm.avail_out = m_buff_size;
+
+		while (m_strm.avail_out != 0 && ret == LZMA_OK)
 		{
-			fprintf(stderr, "Read error: %s\n", strerror(errno));
-			throw "BAD"; // Just exit the program
+			// Nothing left in the input buffer. Read data from the file
+			// Once the end of the file is reached every later call must finish,
+			// even while the input buffer still holds data
+			if (m_strm.avail_in == 0 && m_action == LZMA_RUN)
+			{
+				m_strm.next_in   = m_inbuf;
+				m_strm.avail_in  = fread(m_inbuf, 1, BUFSIZ, m_fp);
+
+				if (ferror(m_fp))
+				{
+					fprintf(stderr, "Read error: %s\n", strerror(errno));
+					ret = LZMA_DATA_ERROR;
+					break;
+				}
+
+				if (feof(m_fp))
+					m_action = LZMA_FINISH;
+			}
+
+			ret = lzma_code(&m_strm, m_action);
 		}
-	}
-
-	lzma_ret ret = lzma_code(&m_strm, action);
 
-	if (ret != LZMA_OK)
-	{
 		if (ret == LZMA_STREAM_END)
 			fprintf(stderr, "LZMA decoder finished without error\n\n");
-		else
-		{
+		else if (ret != LZMA_OK)
 			fprintf(stderr, "Decoder error: (error code %u)\n", ret);
-			throw "BAD"; // Just exit the program
+
+		chunk.resize(m_buff_size - m_strm.avail_out);
+
+		std::unique_lock<std::mutex> l(m_lock);
+
+		m_cv.wait(l, [&] { return m_exit || m_queue.size() < max_queued; });
+
+		if (m_exit)
+			return;
+
+		if (!chunk.empty())
+			m_queue.push_back(std::move(chunk));
+
+		if (ret != LZMA_OK)
+		{
+			m_done = true;
+			m_error = ret != LZMA_STREAM_END;
 		}
+
+		m_cv.notify_all();
+	}
+}
+
+bool GSDumpLzma::NextChunk()
+{
+	std::unique_lock<std::mutex> l(m_lock);
+
+	m_cv.wait(l, [&] { return m_done || !m_queue.empty(); });
+
+	if (m_queue.empty())
+	{
+		if (m_error)
+			throw "BAD"; // Just exit the program
+
+		return false;
 	}
 
+	m_area = std::move(m_queue.front());
+	m_queue.pop_front();
+
+	m_cv.notify_all();
+
 	m_start = 0;
-	m_avail = m_buff_size - m_strm.avail_out;
+	m_avail = m_area.size();
+
+	return true;
 }
 
 bool GSDumpLzma::IsEof()
 {
-	return feof(m_fp) && m_avail == 0 && m_strm.avail_in == 0;
+	if (m_avail != 0)
+		return false;
+
+	std::lock_guard<std::mutex> l(m_lock);
+
+	return m_done && m_queue.empty();
 }
 
 bool GSDumpLzma::Read(void* ptr, size_t size)
@@ -127,15 +203,15 @@ bool GSDumpLzma::Read(void* ptr, size_t size)
 	size_t off = 0;
 	uint8_t* dst = (uint8_t*)ptr;
 	size_t full_size = size;
-	while (size && !IsEof())
+	while (size)
 	{
-		if (m_avail == 0)
+		if (m_avail == 0 && !NextChunk())
 		{
-			Decompress();
+			break;
 		}
 
 		size_t l = std::min(size, m_avail);
-		memcpy(dst + off, m_area + m_start, l);
+		memcpy(dst + off, m_area.data() + m_start, l);
 		m_avail -= l;
 		size    -= l;
 		m_start += l;
@@ -153,12 +229,18 @@ bool GSDumpLzma::Read(void* ptr, size_t size)
 
 GSDumpLzma::~GSDumpLzma()
 {
+	{
+		std::lock_guard<std::mutex> l(m_lock);
+		m_exit = true;
+		m_cv.notify_all();
+	}
+
+	m_thread.join();
+
 	lzma_end(&m_strm);
 
 	if (m_inbuf)
 		_aligned_free(m_inbuf);
-	if (m_area)
-		_aligned_free(m_area);
 }
 
 /******************************************************************/
@@ -166,20 +248,61 @@ GSDumpLzma::~GSDumpLzma()
 GSDumpRaw::GSDumpRaw(char* filename, const char* repack_filename)
 	: GSDumpFile(filename, repack_filename)
 {
-	m_buff_size = 0;
-	m_area      = nullptr;
-	m_inbuf     = nullptr;
-	m_avail     = 0;
-	m_start     = 0;
+	m_area  = nullptr;
+	m_size  = 0;
+	m_start = 0;
+
+#ifndef _WIN32
+	struct stat st;
+
+	if (fstat(fileno(m_fp), &st) == 0 && st.st_size > 0)
+	{
+		void* area = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(m_fp), 0);
+
+		if (area != MAP_FAILED)
+		{
+			madvise(area, st.st_size, MADV_SEQUENTIAL);
+
+			m_area = (uint8_t*)area;
+			m_size = st.st_size;
+		}
+	}
+#endif
+}
+
+GSDumpRaw::~GSDumpRaw()
+{
+#ifndef _WIN32
+	if (m_area)
+		munmap(m_area, m_size);
+#endif
 }
 
 bool GSDumpRaw::IsEof()
 {
+	if (m_area)
+		return m_start >= m_size;
+
 	return !!feof(m_fp);
 }
 
 bool GSDumpRaw::Read(void* ptr, size_t size)
 {
+	if (m_area)
+	{
+		if (m_size - m_start < size)
+		{
+			m_start = m_size;
+			return false;
+		}
+
+		memcpy(ptr, m_area + m_start, size);
+		m_start += size;
+
+		Repack(ptr, size);
+		return true;
+	}
+
 	size_t ret = fread(ptr, 1, size, m_fp);
 	if (ret != size && ferror(m_fp))
 	{
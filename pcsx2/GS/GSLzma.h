@@ -14,6 +14,11 @@
  */
 
 #include <lzma.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 class GSDumpFile
 {
@@ -37,13 +42,24 @@ class GSDumpLzma : public GSDumpFile
 	lzma_stream m_strm;
 
 	size_t m_buff_size;
-	uint8_t* m_area;
 	uint8_t* m_inbuf;
-
+	lzma_action m_action; // LZMA_FINISH once the file is read to the end
+
+	// Decompressed chunks, produced ahead of the player by m_thread
+	std::thread m_thread;
+	std::mutex m_lock;
+	std::condition_variable m_cv;
+	std::deque<std::vector<uint8_t>> m_queue;
+	bool m_done;
+	bool m_error;
+	bool m_exit;
+
+	std::vector<uint8_t> m_area;
 	size_t m_avail;
 	size_t m_start;
 
 	void Decompress();
+	bool NextChunk();
 
 public:
 	GSDumpLzma(char* filename, const char* repack_filename);
@@ -55,16 +71,14 @@ public:
 
 class GSDumpRaw : public GSDumpFile
 {
-	size_t m_buff_size;
+	// The whole dump is mapped when possible, reads are then copies out of the page cache
 	uint8_t* m_area;
-	uint8_t* m_inbuf;
-
-	size_t m_avail;
+	size_t m_size;
 	size_t m_start;
 
 public:
 	GSDumpRaw(char* filename, const char* repack_filename);
-	virtual ~GSDumpRaw() = default;
+	virtual ~GSDumpRaw();
 
 	bool IsEof() final;
 	bool Read(void* ptr, size_t size) final;
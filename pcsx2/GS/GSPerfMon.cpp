@@ -24,6 +24,8 @@ GSPerfMon::GSPerfMon()
 {
 	memset(m_counters, 0, sizeof(m_counters));
 	memset(m_stats, 0, sizeof(m_stats));
+	memset(m_totals, 0, sizeof(m_totals));
+	memset(m_gauges, 0, sizeof(m_gauges));
 	memset(m_total, 0, sizeof(m_total));
 	memset(m_begin, 0, sizeof(m_begin));
 }
@@ -45,7 +47,10 @@ void GSPerfMon::Put(counter_t c, double val)
 
 		if (m_lastframe != 0)
 		{
-			m_counters[c] += (now - m_lastframe) * 1000 / CLOCKS_PER_SEC;
+			double ms = (now - m_lastframe) * 1000 / CLOCKS_PER_SEC;
+
+			m_counters[c] += ms;
+			m_totals[c] += ms;
 		}
 
 		m_lastframe = now;
@@ -55,6 +60,7 @@ void GSPerfMon::Put(counter_t c, double val)
 	else
 	{
 		m_counters[c] += val;
+		m_totals[c] += val;
 	}
 #endif
 }
@@ -39,12 +39,31 @@ public:
 		Fillrate,
 		Quad,
 		SyncPoint,
+		DrawMerged,
+		StateCall,
+		StateElided,
+		WorkSteal,
+		GPUTime,
+		SwizzleTime, // ms spent writing the host to local transfers, Swizzle / SwizzleTime is the throughput
+		Upload, // vertex and index bytes sent to the gpu by the hw renderers
+		UnswizzleTime, // ms spent decoding the hw texture cache sources, including the wait for the unswizzle workers
+		PboStall, // texture uploads of the ogl renderer that waited for the gpu to release a PBO segment
 		CounterLast,
 	};
 
+	// Instant values, they aren't averaged on the frames
+	enum gauge_t
+	{
+		TextureMemory,
+		TextureMemoryPeak,
+		GaugeLast,
+	};
+
 protected:
 	double m_counters[CounterLast];
 	double m_stats[CounterLast];
+	double m_totals[CounterLast]; // Since the start, never reset
+	double m_gauges[GaugeLast];
 	uint64 m_begin[TimerLast], m_total[TimerLast], m_start[TimerLast];
 	uint64 m_frame;
 	clock_t m_lastframe;
@@ -60,6 +79,9 @@ public:
 
 	void Put(counter_t c, double val = 0);
 	double Get(counter_t c) { return m_stats[c]; }
+	double GetTotal(counter_t c) { return m_totals[c]; }
+	void Set(gauge_t g, double val) { m_gauges[g] = val; }
+	double Get(gauge_t g) { return m_gauges[g]; }
 	void Update();
 
 	void Start(int timer = Main);
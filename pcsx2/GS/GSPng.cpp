@@ -129,8 +129,78 @@ namespace GSPng
 		return SaveFile(filename, fmt, image, row.get(), w, h, pitch, compression);
 	}
 
-	Transaction::Transaction(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression)
-		: m_fmt(fmt), m_file(file), m_w(w), m_h(h), m_pitch(pitch), m_compression(compression)
+	bool Load(const std::string& file, std::vector<uint8>& image, int& w, int& h)
+	{
+		FILE* fp = px_fopen(file, "rb");
+		if (fp == nullptr)
+			return false;
+
+		png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		png_infop info_ptr = nullptr;
+		// Outside of the setjmp scope, libpng errors longjmp over it
+		std::vector<png_bytep> rows;
+
+		bool success;
+		try
+		{
+			if (png_ptr == nullptr)
+				throw GSRecoverableError();
+
+			info_ptr = png_create_info_struct(png_ptr);
+			if (info_ptr == nullptr)
+				throw GSRecoverableError();
+
+			if (setjmp(png_jmpbuf(png_ptr)))
+				throw GSRecoverableError();
+
+			png_init_io(png_ptr, fp);
+			png_read_info(png_ptr, info_ptr);
+
+			w = png_get_image_width(png_ptr, info_ptr);
+			h = png_get_image_height(png_ptr, info_ptr);
+
+			const int type = png_get_color_type(png_ptr, info_ptr);
+
+			// Whatever the source, expand it to 8 bits RGBA
+			png_set_expand(png_ptr);
+			png_set_strip_16(png_ptr);
+			if (type == PNG_COLOR_TYPE_GRAY || type == PNG_COLOR_TYPE_GRAY_ALPHA)
+				png_set_gray_to_rgb(png_ptr);
+			if (!(type & PNG_COLOR_MASK_ALPHA) && !png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+				png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
+			png_set_interlace_handling(png_ptr);
+			png_read_update_info(png_ptr, info_ptr);
+
+			if (png_get_rowbytes(png_ptr, info_ptr) != (size_t)w * 4)
+				throw GSRecoverableError();
+
+			image.resize((size_t)w * h * 4);
+
+			rows.resize(h);
+			for (int y = 0; y < h; y++)
+				rows[y] = &image[(size_t)y * w * 4];
+
+			png_read_image(png_ptr, rows.data());
+			png_read_end(png_ptr, nullptr);
+
+			success = true;
+		}
+		catch (GSRecoverableError&)
+		{
+			fprintf(stderr, "Failed to read image %s\n", file.c_str());
+
+			success = false;
+		}
+
+		if (png_ptr)
+			png_destroy_read_struct(&png_ptr, info_ptr ? &info_ptr : nullptr, nullptr);
+		fclose(fp);
+
+		return success;
+	}
+
+	Transaction::Transaction(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression, bool rb_swapped)
+		: m_fmt(fmt), m_file(file), m_w(w), m_h(h), m_pitch(pitch), m_compression(compression), m_rb_swapped(rb_swapped)
 	{
 		// Note: yes it would be better to use shared pointer
 		m_image = (uint8*)_aligned_malloc(pitch * h, 32);
@@ -146,7 +216,73 @@ namespace GSPng
 
 	void Process(std::shared_ptr<Transaction>& item)
 	{
-		Save(item->m_fmt, item->m_file, item->m_image, item->m_w, item->m_h, item->m_pitch, item->m_compression);
+		Save(item->m_fmt, item->m_file, item->m_image, item->m_w, item->m_h, item->m_pitch, item->m_compression, item->m_rb_swapped);
+	}
+
+	static std::mutex s_pool_lock;
+	static std::vector<std::unique_ptr<Worker>> s_pool;
+	static size_t s_pool_next;
+	static std::atomic<int> s_queued(0);
+	static std::atomic<int> s_dropped(0);
+
+	static void ProcessQueued(std::shared_ptr<Transaction>& item)
+	{
+		Process(item);
+
+		s_queued--;
+	}
+
+	bool SaveAsync(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression, bool rb_swapped)
+	{
+		std::lock_guard<std::mutex> lock(s_pool_lock);
+
+		if (s_pool.empty())
+		{
+			int threads = std::max(theApp.GetConfigI("png_threads"), 1);
+
+			for (int i = 0; i < threads; i++)
+				s_pool.push_back(std::unique_ptr<Worker>(new Worker(&ProcessQueued)));
+		}
+
+		auto item = std::make_shared<Transaction>(fmt, file, image, w, h, pitch, compression, rb_swapped);
+
+		if (item->m_image == nullptr)
+			return false;
+
+		s_queued++;
+
+		// Round robin, the next worker takes it when one is full
+		for (size_t i = 0; i < s_pool.size(); i++)
+		{
+			Worker* worker = s_pool[s_pool_next++ % s_pool.size()].get();
+
+			if (worker->TryPush(item))
+				return true;
+		}
+
+		s_queued--;
+		s_dropped++;
+
+		fprintf(stderr, "PNG encoders are full, %s dropped\n", file.c_str());
+
+		return false;
+	}
+
+	int GetQueued()
+	{
+		return s_queued;
+	}
+
+	int GetDropped()
+	{
+		return s_dropped;
+	}
+
+	void Shutdown()
+	{
+		std::lock_guard<std::mutex> lock(s_pool_lock);
+
+		s_pool.clear();
 	}
 
 } // namespace GSPng
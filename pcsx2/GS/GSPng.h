@@ -42,13 +42,26 @@ namespace GSPng
 		int m_h;
 		int m_pitch;
 		int m_compression;
+		bool m_rb_swapped;
 
-		Transaction(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression);
+		Transaction(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression, bool rb_swapped = false);
 		~Transaction();
 	};
 
 	bool Save(GSPng::Format fmt, const std::string& file, uint8* image, int w, int h, int pitch, int compression, bool rb_swapped = false);
 
+	// Decodes any PNG into tightly packed RGBA8 pixels
+	bool Load(const std::string& file, std::vector<uint8>& image, int& w, int& h);
+
+	// Copies the image and encodes it on the pool of "png_threads" workers. Returns
+	// false when every queue is full and the image was dropped
+	bool SaveAsync(GSPng::Format fmt, const std::string& file, const uint8* image, int w, int h, int pitch, int compression, bool rb_swapped = false);
+	// Images waiting to be encoded, and dropped since the start
+	int GetQueued();
+	int GetDropped();
+	// Encodes the queued images and stops the workers
+	void Shutdown();
+
 	void Process(std::shared_ptr<Transaction>& item);
 
 	using Worker = GSJobQueue<std::shared_ptr<Transaction>, 16>;
@@ -17,6 +17,8 @@
 #include "GSState.h"
 #include "GS.h"
 #include "GSUtil.h"
+#include "Timeline.h"
+#include <chrono>
 
 //#define Offset_ST  // Fixes Persona3 mini map alignment which is off even in software rendering
 
@@ -38,6 +40,8 @@ GSState::GSState()
 	, m_crc(0)
 	, m_options(0)
 	, m_frameskip(0)
+	, m_move_spo(NULL)
+	, m_move_dpo(NULL)
 {
 	// m_nativeres seems to be a hack. Unfortunately it impacts draw call number which make debug painful in the replayer.
 	// Let's keep it disabled to ease debug.
@@ -220,6 +224,8 @@ void GSState::SetFrameSkip(int skip)
 
 		m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZF2] = &GSState::GIFPackedRegHandlerNOP;
 		m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZ2] = &GSState::GIFPackedRegHandlerNOP;
+		m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZF2] = &GSState::GIFPackedRegHandlerNOP;
+		m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZ2] = &GSState::GIFPackedRegHandlerNOP;
 	}
 	else
 	{
@@ -298,7 +304,9 @@ void GSState::ResetHandlers()
 	m_fpGIFRegHandlerXYZ[P][2] = &GSState::GIFRegHandlerXYZ2<P, 0, auto_flush>; \
 	m_fpGIFRegHandlerXYZ[P][3] = &GSState::GIFRegHandlerXYZ2<P, 1, auto_flush>; \
 	m_fpGIFPackedRegHandlerSTQRGBAXYZF2[P] = &GSState::GIFPackedRegHandlerSTQRGBAXYZF2<P, auto_flush>; \
-	m_fpGIFPackedRegHandlerSTQRGBAXYZ2[P] = &GSState::GIFPackedRegHandlerSTQRGBAXYZ2<P, auto_flush>;
+	m_fpGIFPackedRegHandlerSTQRGBAXYZ2[P] = &GSState::GIFPackedRegHandlerSTQRGBAXYZ2<P, auto_flush>; \
+	m_fpGIFPackedRegHandlerRGBAXYZF2[P] = &GSState::GIFPackedRegHandlerRGBAXYZF2<P, auto_flush>; \
+	m_fpGIFPackedRegHandlerRGBAXYZ2[P] = &GSState::GIFPackedRegHandlerRGBAXYZ2<P, auto_flush>;
 
 	if (m_userhacks_auto_flush)
 	{
@@ -378,6 +386,31 @@ void GSState::ResetHandlers()
 	m_fpGIFRegHandlers[GIF_A_D_REG_TRXDIR] = &GSState::GIFRegHandlerTRXDIR;
 	m_fpGIFRegHandlers[GIF_A_D_REG_HWREG] = &GSState::GIFRegHandlerHWREG;
 
+	// The handlers of these only compare the new value to the current state, flush if it
+	// differs and store it. Anything else (vertex kicks, PRIM, TEX0/TEX2 with their clut
+	// loads, transfers, SIGNAL...) may observe or act on the state and ends a run.
+
+	static const uint8 coalesce[] =
+	{
+		GIF_A_D_REG_RGBAQ, GIF_A_D_REG_ST, GIF_A_D_REG_UV, GIF_A_D_REG_FOG,
+		GIF_A_D_REG_CLAMP_1, GIF_A_D_REG_CLAMP_2, GIF_A_D_REG_TEX1_1, GIF_A_D_REG_TEX1_2,
+		GIF_A_D_REG_XYOFFSET_1, GIF_A_D_REG_XYOFFSET_2, GIF_A_D_REG_PRMODECONT, GIF_A_D_REG_TEXCLUT,
+		GIF_A_D_REG_SCANMSK, GIF_A_D_REG_MIPTBP1_1, GIF_A_D_REG_MIPTBP1_2, GIF_A_D_REG_MIPTBP2_1,
+		GIF_A_D_REG_MIPTBP2_2, GIF_A_D_REG_TEXA, GIF_A_D_REG_FOGCOL, GIF_A_D_REG_SCISSOR_1,
+		GIF_A_D_REG_SCISSOR_2, GIF_A_D_REG_ALPHA_1, GIF_A_D_REG_ALPHA_2, GIF_A_D_REG_DIMX,
+		GIF_A_D_REG_DTHE, GIF_A_D_REG_COLCLAMP, GIF_A_D_REG_TEST_1, GIF_A_D_REG_TEST_2,
+		GIF_A_D_REG_PABE, GIF_A_D_REG_FBA_1, GIF_A_D_REG_FBA_2, GIF_A_D_REG_FRAME_1,
+		GIF_A_D_REG_FRAME_2, GIF_A_D_REG_ZBUF_1, GIF_A_D_REG_ZBUF_2, GIF_A_D_REG_BITBLTBUF,
+		GIF_A_D_REG_TRXPOS, GIF_A_D_REG_TRXREG,
+	};
+
+	m_reg_coalesce[0] = m_reg_coalesce[1] = 0;
+
+	for (size_t i = 0; i < countof(coalesce); i++)
+	{
+		m_reg_coalesce[coalesce[i] >> 6] |= 1ull << (coalesce[i] & 63);
+	}
+
 	SetMultithreaded(m_mt);
 }
 
@@ -768,10 +801,102 @@ void GSState::GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uin
 	m_q = r[-3].STQ.Q; // remember the last one, STQ outputs this to the temp Q each time
 }
 
+template <uint32 prim, bool auto_flush>
+void GSState::GIFPackedRegHandlerRGBAXYZF2(const GIFPackedReg* RESTRICT r, uint32 size)
+{
+	ASSERT(size > 0 && size % 2 == 0);
+
+	const GIFPackedReg* RESTRICT r_end = r + size;
+
+	m_v.RGBAQ.Q = m_q; // no STQ in the loop, the temp Q stays the same
+
+	while (r < r_end)
+	{
+		GSVector4i rgba = (GSVector4i::load<false>(&r[0]) & GSVector4i::x000000ff()).ps32().pu16();
+
+		m_v.RGBAQ.u32[0] = (uint32)GSVector4i::store(rgba); // TODO: only store the last one
+
+		GSVector4i xy = GSVector4i::loadl(&r[1].u64[0]);
+		GSVector4i zf = GSVector4i::loadl(&r[1].u64[1]);
+		xy = xy.upl16(xy.srl<4>()).upl32(GSVector4i::load((int)m_v.UV));
+		zf = zf.srl32(4) & GSVector4i::x00ffffff().upl32(GSVector4i::x000000ff());
+
+		m_v.m[1] = xy.upl32(zf); // TODO: only store the last one
+
+		VertexKick<prim, auto_flush>(r[1].XYZF2.Skip());
+
+		r += 2;
+	}
+}
+
+template <uint32 prim, bool auto_flush>
+void GSState::GIFPackedRegHandlerRGBAXYZ2(const GIFPackedReg* RESTRICT r, uint32 size)
+{
+	ASSERT(size > 0 && size % 2 == 0);
+
+	const GIFPackedReg* RESTRICT r_end = r + size;
+
+	m_v.RGBAQ.Q = m_q; // no STQ in the loop, the temp Q stays the same
+
+	while (r < r_end)
+	{
+		GSVector4i rgba = (GSVector4i::load<false>(&r[0]) & GSVector4i::x000000ff()).ps32().pu16();
+
+		m_v.RGBAQ.u32[0] = (uint32)GSVector4i::store(rgba); // TODO: only store the last one
+
+		GSVector4i xy = GSVector4i::loadl(&r[1].u64[0]);
+		GSVector4i z = GSVector4i::loadl(&r[1].u64[1]);
+		GSVector4i xyz = xy.upl16(xy.srl<4>()).upl32(z);
+
+		m_v.m[1] = xyz.upl64(GSVector4i::loadl(&m_v.UV)); // TODO: only store the last one
+
+		VertexKick<prim, auto_flush>(r[1].XYZ2.Skip());
+
+		r += 2;
+	}
+}
+
 void GSState::GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, uint32 size)
 {
 }
 
+// Applies a run of register writes, addr[i] being the register of the data at mem + i * stride.
+// A write of a m_reg_coalesce register is dropped if the same register is written again later
+// in the run with only m_reg_coalesce registers in between (addr is used as scratch for that).
+
+void GSState::ApplyRegs(uint8* RESTRICT addr, const uint8* RESTRICT mem, uint32 stride, uint32 count)
+{
+	uint64 seen[2] = {0, 0};
+
+	for (int i = (int)count - 1; i >= 0; i--)
+	{
+		uint32 a = addr[i];
+		uint64 bit = 1ull << (a & 63);
+
+		if (m_reg_coalesce[a >> 6] & bit)
+		{
+			if (seen[a >> 6] & bit)
+			{
+				addr[i] = 0xff; // overwritten later
+			}
+
+			seen[a >> 6] |= bit;
+		}
+		else
+		{
+			seen[0] = seen[1] = 0;
+		}
+	}
+
+	for (uint32 i = 0; i < count; i++, mem += stride)
+	{
+		if (addr[i] != 0xff)
+		{
+			(this->*m_fpGIFRegHandlers[addr[i]])((const GIFReg*)mem);
+		}
+	}
+}
+
 // GIFRegHandler*
 
 void GSState::GIFRegHandlerNull(const GIFReg* RESTRICT r)
@@ -930,7 +1055,7 @@ void GSState::ApplyTEX0(GIFRegTEX0& TEX0)
 
 	if ((TEX0.u32[0] ^ m_env.CTXT[i].TEX0.u32[0]) & 0x3ffffff) // TBP0 TBW PSM
 	{
-		m_env.CTXT[i].offset.tex = m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
+		m_env.CTXT[i].offset.tex = m_mem.GetOffset(m_env.CTXT[i].offset.tex, TEX0.TBP0, TEX0.TBW, TEX0.PSM);
 	}
 
 	m_env.CTXT[i].TEX0 = (GSVector4i)TEX0;
@@ -1359,10 +1484,10 @@ void GSState::GIFRegHandlerFRAME(const GIFReg* RESTRICT r)
 
 	if ((m_env.CTXT[i].FRAME.u32[0] ^ r->FRAME.u32[0]) & 0x3f3f01ff) // FBP FBW PSM
 	{
-		m_env.CTXT[i].offset.fb = m_mem.GetOffset(r->FRAME.Block(), r->FRAME.FBW, r->FRAME.PSM);
-		m_env.CTXT[i].offset.zb = m_mem.GetOffset(m_env.CTXT[i].ZBUF.Block(), r->FRAME.FBW, m_env.CTXT[i].ZBUF.PSM);
-		m_env.CTXT[i].offset.fzb = m_mem.GetPixelOffset(r->FRAME, m_env.CTXT[i].ZBUF);
-		m_env.CTXT[i].offset.fzb4 = m_mem.GetPixelOffset4(r->FRAME, m_env.CTXT[i].ZBUF);
+		m_env.CTXT[i].offset.fb = m_mem.GetOffset(m_env.CTXT[i].offset.fb, r->FRAME.Block(), r->FRAME.FBW, r->FRAME.PSM);
+		m_env.CTXT[i].offset.zb = m_mem.GetOffset(m_env.CTXT[i].offset.zb, m_env.CTXT[i].ZBUF.Block(), r->FRAME.FBW, m_env.CTXT[i].ZBUF.PSM);
+		m_env.CTXT[i].offset.fzb = m_mem.GetPixelOffset(m_env.CTXT[i].offset.fzb, r->FRAME, m_env.CTXT[i].ZBUF);
+		m_env.CTXT[i].offset.fzb4 = m_mem.GetPixelOffset4(m_env.CTXT[i].offset.fzb4, r->FRAME, m_env.CTXT[i].ZBUF);
 	}
 
 	m_env.CTXT[i].FRAME = (GSVector4i)r->FRAME;
@@ -1423,9 +1548,9 @@ void GSState::GIFRegHandlerZBUF(const GIFReg* RESTRICT r)
 
 	if ((m_env.CTXT[i].ZBUF.u32[0] ^ ZBUF.u32[0]) & 0x3f0001ff) // ZBP PSM
 	{
-		m_env.CTXT[i].offset.zb = m_mem.GetOffset(ZBUF.Block(), m_env.CTXT[i].FRAME.FBW, ZBUF.PSM);
-		m_env.CTXT[i].offset.fzb = m_mem.GetPixelOffset(m_env.CTXT[i].FRAME, ZBUF);
-		m_env.CTXT[i].offset.fzb4 = m_mem.GetPixelOffset4(m_env.CTXT[i].FRAME, ZBUF);
+		m_env.CTXT[i].offset.zb = m_mem.GetOffset(m_env.CTXT[i].offset.zb, ZBUF.Block(), m_env.CTXT[i].FRAME.FBW, ZBUF.PSM);
+		m_env.CTXT[i].offset.fzb = m_mem.GetPixelOffset(m_env.CTXT[i].offset.fzb, m_env.CTXT[i].FRAME, ZBUF);
+		m_env.CTXT[i].offset.fzb4 = m_mem.GetPixelOffset4(m_env.CTXT[i].offset.fzb4, m_env.CTXT[i].FRAME, ZBUF);
 	}
 
 	m_env.CTXT[i].ZBUF = (GSVector4i)ZBUF;
@@ -1563,11 +1688,14 @@ void GSState::FlushWrite()
 
 	GSLocalMemory::writeImage wi = GSLocalMemory::m_psm[m_env.BITBLTBUF.DPSM].wi;
 
+	const auto start = std::chrono::steady_clock::now();
+
 	(m_mem.*wi)(m_tr.x, m_tr.y, &m_tr.buff[m_tr.start], len, m_env.BITBLTBUF, m_env.TRXPOS, m_env.TRXREG);
 
 	m_tr.start += len;
 
 	m_perfmon.Put(GSPerfMon::Swizzle, len);
+	m_perfmon.Put(GSPerfMon::SwizzleTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 
 	//GSVector4i r;
 
@@ -1670,12 +1798,13 @@ void GSState::FlushPrim()
 
 		if (GSLocalMemory::m_psm[m_context->FRAME.PSM].fmt < 3 && GSLocalMemory::m_psm[m_context->ZBUF.PSM].fmt < 3)
 		{
-			m_vt.Update(m_vertex.buff, m_index.buff, m_vertex.tail, m_index.tail, GSUtil::GetPrimClass(PRIM->PRIM));
+			m_vt.Update(m_vertex.buff, m_index.buff, m_vertex.next, m_index.tail, GSUtil::GetPrimClass(PRIM->PRIM));
 
 			m_context->SaveReg();
 
 			try
 			{
+				TIMELINE_SCOPE("GS draw");
 				Draw();
 			}
 			catch (GSRecoverableError&)
@@ -1786,11 +1915,14 @@ void GSState::Write(const uint8* mem, int len)
 
 		InvalidateVideoMem(blit, r);
 
+		const auto start = std::chrono::steady_clock::now();
+
 		(m_mem.*psm.wi)(m_tr.x, m_tr.y, mem, m_tr.total, blit, m_env.TRXPOS, m_env.TRXREG);
 
 		m_tr.start = m_tr.end = m_tr.total;
 
 		m_perfmon.Put(GSPerfMon::Swizzle, len);
+		m_perfmon.Put(GSPerfMon::SwizzleTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 
 		//static int n = 0;
 		//std::string s;
@@ -1944,8 +2076,8 @@ void GSState::Move()
 
 	// TODO: unroll inner loops (width has special size requirement, must be multiples of 1 << n, depending on the format)
 
-	GSOffset* RESTRICT spo = m_mem.GetOffset(m_env.BITBLTBUF.SBP, m_env.BITBLTBUF.SBW, m_env.BITBLTBUF.SPSM);
-	GSOffset* RESTRICT dpo = m_mem.GetOffset(m_env.BITBLTBUF.DBP, m_env.BITBLTBUF.DBW, m_env.BITBLTBUF.DPSM);
+	GSOffset* RESTRICT spo = m_move_spo = m_mem.GetOffset(m_move_spo, m_env.BITBLTBUF.SBP, m_env.BITBLTBUF.SBW, m_env.BITBLTBUF.SPSM);
+	GSOffset* RESTRICT dpo = m_move_dpo = m_mem.GetOffset(m_move_dpo, m_env.BITBLTBUF.DBP, m_env.BITBLTBUF.DBW, m_env.BITBLTBUF.DPSM);
 
 	if (spsm.trbpp == dpsm.trbpp && spsm.trbpp >= 16)
 	{
@@ -2246,10 +2378,19 @@ void GSState::Transfer(const uint8* mem, uint32 size)
 
 								do
 								{
-									(this->*m_fpGIFRegHandlers[((GIFPackedReg*)mem)->A_D.ADDR & 0x7F])(&((GIFPackedReg*)mem)->r);
+									uint8 addr[64];
+									uint32 n = std::min<uint32>(total, countof(addr));
 
-									mem += sizeof(GIFPackedReg);
-								} while (--total > 0);
+									for (uint32 i = 0; i < n; i++)
+									{
+										addr[i] = ((GIFPackedReg*)mem)[i].A_D.ADDR & 0x7F;
+									}
+
+									ApplyRegs(addr, mem, sizeof(GIFPackedReg), n);
+
+									mem += n * sizeof(GIFPackedReg);
+									total -= n;
+								} while (total > 0);
 
 								break;
 
@@ -2269,6 +2410,22 @@ void GSState::Transfer(const uint8* mem, uint32 size)
 
 								break;
 
+							case GIFPath::TYPE_RGBAXYZF2: // untextured vertices
+
+								(this->*m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZF2])((GIFPackedReg*)mem, total);
+
+								mem += total * sizeof(GIFPackedReg);
+
+								break;
+
+							case GIFPath::TYPE_RGBAXYZ2:
+
+								(this->*m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZ2])((GIFPackedReg*)mem, total);
+
+								mem += total * sizeof(GIFPackedReg);
+
+								break;
+
 							default:
 
 								__assume(0);
@@ -2291,24 +2448,35 @@ void GSState::Transfer(const uint8* mem, uint32 size)
 
 				case GIF_FLG_REGLIST:
 
-					// TODO: do it similar to packed operation
-
+				{
 					size *= 2;
 
+					bool more;
+
 					do
 					{
-						(this->*m_fpGIFRegHandlers[path.GetReg() & 0x7F])((GIFReg*)mem);
+						uint8 addr[64];
+						uint32 n = 0;
 
-						mem += sizeof(GIFReg);
-						size--;
-					} while (path.StepReg() && size > 0);
+						do
+						{
+							addr[n++] = path.GetReg() & 0x7F;
+							size--;
+							more = path.StepReg();
+						} while (more && size > 0 && n < countof(addr));
+
+						ApplyRegs(addr, mem, sizeof(GIFReg), n);
+
+						mem += n * sizeof(GIFReg);
+					} while (more && size > 0);
 
 					if (size & 1)
 						mem += sizeof(GIFReg);
 
 					size /= 2;
+				}
 
-					break;
+				break;
 
 				case GIF_FLG_IMAGE2:
 					// hmmm // Fall through here fixes a crash in Wallace and Gromit Project Zoo
@@ -2470,7 +2638,8 @@ int GSState::Freeze(freezeData* fd, bool sizeonly)
 	data += sizeof(GIFReg); // obsolite
 	WriteState(data, &m_tr.x);
 	WriteState(data, &m_tr.y);
-	WriteState(data, m_mem.m_vm8, m_mem.m_vmsize);
+	memcpy_stream(data, m_mem.m_vm8, m_mem.m_vmsize);
+	data += m_mem.m_vmsize;
 
 	for (size_t i = 0; i < countof(m_path); i++)
 	{
@@ -2577,6 +2746,15 @@ int GSState::Defrost(const freezeData* fd)
 	data += sizeof(GIFReg); // obsolite
 	ReadState(&m_tr.x, data);
 	ReadState(&m_tr.y, data);
+
+	m_defrosted_pages.clear();
+	for (uint32 page = 0; page < MAX_PAGES; page++)
+	{
+		if (memcmp(m_mem.m_vm8 + page * PAGE_SIZE, data + page * PAGE_SIZE, PAGE_SIZE) != 0)
+			m_defrosted_pages.push_back(page);
+	}
+	m_defrosted_pages.push_back(GSOffset::EOP);
+
 	ReadState(m_mem.m_vm8, data, m_mem.m_vmsize);
 
 	m_tr.total = 0; // TODO: restore transfer state
@@ -2672,6 +2850,8 @@ void GSState::UpdateVertexKick()
 
 	m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZF2] = m_fpGIFPackedRegHandlerSTQRGBAXYZF2[prim];
 	m_fpGIFPackedRegHandlersC[GIF_REG_STQRGBAXYZ2] = m_fpGIFPackedRegHandlerSTQRGBAXYZ2[prim];
+	m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZF2] = m_fpGIFPackedRegHandlerRGBAXYZF2[prim];
+	m_fpGIFPackedRegHandlersC[GIF_REG_RGBAXYZ2] = m_fpGIFPackedRegHandlerRGBAXYZ2[prim];
 }
 
 void GSState::GrowVertexBuffer()
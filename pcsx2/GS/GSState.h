@@ -66,15 +66,22 @@ class GSState : public GSAlignedClass<32>
 
 	GIFRegHandler m_fpGIFRegHandlers[256];
 	GIFRegHandler m_fpGIFRegHandlerXYZ[8][4];
+	uint64 m_reg_coalesce[2]; // registers of which only the last write of a run needs to be applied
+
+	void ApplyRegs(uint8* RESTRICT addr, const uint8* RESTRICT mem, uint32 stride, uint32 count);
 
 	typedef void (GSState::*GIFPackedRegHandlerC)(const GIFPackedReg* RESTRICT r, uint32 size);
 
-	GIFPackedRegHandlerC m_fpGIFPackedRegHandlersC[2];
+	GIFPackedRegHandlerC m_fpGIFPackedRegHandlersC[4];
 	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerSTQRGBAXYZF2[8];
 	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerSTQRGBAXYZ2[8];
+	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerRGBAXYZF2[8];
+	GIFPackedRegHandlerC m_fpGIFPackedRegHandlerRGBAXYZ2[8];
 
 	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerSTQRGBAXYZF2(const GIFPackedReg* RESTRICT r, uint32 size);
 	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerSTQRGBAXYZ2(const GIFPackedReg* RESTRICT r, uint32 size);
+	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerRGBAXYZF2(const GIFPackedReg* RESTRICT r, uint32 size);
+	template<uint32 prim, bool auto_flush> void GIFPackedRegHandlerRGBAXYZ2(const GIFPackedReg* RESTRICT r, uint32 size);
 	void GIFPackedRegHandlerNOP(const GIFPackedReg* RESTRICT r, uint32 size);
 
 	template<int i> void ApplyTEX0(GIFRegTEX0& TEX0);
@@ -162,6 +169,9 @@ protected:
 	int m_userhacks_skipdraw_offset;
 	bool m_userhacks_auto_flush;
 
+	// Pages of the local memory changed by the last Defrost (EOP terminated)
+	std::vector<uint32> m_defrosted_pages;
+
 	GSVertex m_v;
 	float m_q;
 	GSVector4i m_scissor;
@@ -217,6 +227,8 @@ public:
 	std::unique_ptr<GSDumpBase> m_dump;
 	int m_options;
 	int m_frameskip;
+	GSOffset* m_move_spo; // offsets of the last local to local transfer
+	GSOffset* m_move_dpo;
 	bool m_NTSC_Saturation;
 	bool m_nativeres;
 	int m_mipmap;
@@ -267,7 +279,7 @@ public:
 	void ReadFIFO(uint8* mem, int size);
 	template<int index> void Transfer(const uint8* mem, uint32 size);
 	int Freeze(freezeData* fd, bool sizeonly);
-	int Defrost(const freezeData* fd);
+	virtual int Defrost(const freezeData* fd);
 	void GetLastTag(uint32* tag)
 	{
 		*tag = m_path3hack;
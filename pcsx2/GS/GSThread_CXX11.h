@@ -96,6 +96,20 @@ public:
 		m_notempty.notify_one();
 	}
 
+	// Doesn't wait when the queue is full, the caller decides what to do with the item
+	bool TryPush(const T& item)
+	{
+		if (!m_queue.push(item))
+			return false;
+
+		{
+			std::lock_guard<std::mutex> l(m_lock);
+		}
+		m_notempty.notify_one();
+
+		return true;
+	}
+
 	void Wait()
 	{
 		if (IsEmpty())
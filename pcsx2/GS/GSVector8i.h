@@ -1070,6 +1070,14 @@ public:
 		return GSVector8i(_mm256_i32gather_epi32((const int*)ptr, m, 4));
 	}
 
+	// gathers four qwords, indexed by the dwords of the i-th 128-bit lane
+
+	template <int i>
+	__forceinline GSVector8i gather64_32(const uint64* ptr) const
+	{
+		return GSVector8i(_mm256_i32gather_epi64((const long long*)ptr, extract<i>(), 8));
+	}
+
 	template <class T1, class T2>
 	__forceinline GSVector8i gather32_32(const T1* ptr1, const T2* ptr2) const
 	{
@@ -18,15 +18,17 @@
 #include "GSDevice.h"
 
 GSDevice::GSDevice()
-	: m_wnd()
+	: m_pool_size(0)
+	, m_wnd()
 	, m_vsync(false)
 	, m_rbswapped(false)
 	, m_backbuffer(NULL)
 	, m_merge(NULL)
 	, m_weavebob(NULL)
 	, m_blend(NULL)
-	, m_target_tmp(NULL)
+	, m_target_tmp{NULL, NULL}
 	, m_current(NULL)
+	, m_current_fx(0)
 	, m_frame(0)
 {
 	memset(&m_vertex, 0, sizeof(m_vertex));
@@ -36,14 +38,14 @@ GSDevice::GSDevice()
 
 GSDevice::~GSDevice()
 {
-	for (auto t : m_pool)
-		delete t;
+	ClearPool();
 
 	delete m_backbuffer;
 	delete m_merge;
 	delete m_weavebob;
 	delete m_blend;
-	delete m_target_tmp;
+	delete m_target_tmp[0];
+	delete m_target_tmp[1];
 }
 
 bool GSDevice::Create(const std::shared_ptr<GSWnd>& wnd)
@@ -55,22 +57,21 @@ bool GSDevice::Create(const std::shared_ptr<GSWnd>& wnd)
 
 bool GSDevice::Reset(int w, int h)
 {
-	for (auto t : m_pool)
-		delete t;
-
-	m_pool.clear();
+	ClearPool();
 
 	delete m_backbuffer;
 	delete m_merge;
 	delete m_weavebob;
 	delete m_blend;
-	delete m_target_tmp;
+	delete m_target_tmp[0];
+	delete m_target_tmp[1];
 
 	m_backbuffer = NULL;
 	m_merge = NULL;
 	m_weavebob = NULL;
 	m_blend = NULL;
-	m_target_tmp = NULL;
+	m_target_tmp[0] = NULL;
+	m_target_tmp[1] = NULL;
 
 	m_current = NULL; // current is special, points to other textures, no need to delete
 
@@ -117,18 +118,16 @@ void GSDevice::Present(GSTexture* sTex, GSTexture* dTex, const GSVector4& dRect,
 
 GSTexture* GSDevice::FetchSurface(int type, int w, int h, int format)
 {
-	const GSVector2i size(w, h);
+	auto i = m_pool.find({type, w, h, format});
 
-	for (auto i = m_pool.begin(); i != m_pool.end(); ++i)
+	if (i != m_pool.end() && !i->second.empty())
 	{
-		GSTexture* t = *i;
+		GSTexture* t = i->second.front();
 
-		if (t->GetType() == type && t->GetFormat() == format && t->GetSize() == size)
-		{
-			m_pool.erase(i);
+		i->second.pop_front();
+		m_pool_size--;
 
-			return t;
-		}
+		return t;
 	}
 
 	return CreateSurface(type, w, h, format);
@@ -138,9 +137,9 @@ void GSDevice::PrintMemoryUsage()
 {
 #ifdef ENABLE_OGL_DEBUG
 	uint32 pool = 0;
-	for (auto t : m_pool)
+	for (auto& bucket : m_pool)
 	{
-		if (t)
+		for (auto t : bucket.second)
 			pool += t->GetMemUsage();
 	}
 	GL_PERF("MEM: Surface Pool %dMB", pool >> 20u);
@@ -167,40 +166,77 @@ void GSDevice::Recycle(GSTexture* t)
 #endif
 		t->last_frame_used = m_frame;
 
-		m_pool.push_front(t);
+		m_pool[{t->GetType(), t->GetWidth(), t->GetHeight(), t->GetFormat()}].push_front(t);
+		m_pool_size++;
 
-		//printf("%d\n",m_pool.size());
+		//printf("%d\n",m_pool_size);
 
-		while (m_pool.size() > 300)
+		while (m_pool_size > 300)
 		{
-			delete m_pool.back();
-
-			m_pool.pop_back();
+			DeleteOldestPoolTexture();
 		}
 	}
 }
 
+void GSDevice::DeleteOldestPoolTexture()
+{
+	// Buckets are sorted, so the oldest texture is at the back of one of them
+	auto oldest = m_pool.end();
+
+	for (auto i = m_pool.begin(); i != m_pool.end(); ++i)
+	{
+		if (!i->second.empty() && (oldest == m_pool.end() || i->second.back()->last_frame_used < oldest->second.back()->last_frame_used))
+			oldest = i;
+	}
+
+	if (oldest == m_pool.end())
+		return;
+
+	delete oldest->second.back();
+
+	oldest->second.pop_back();
+	m_pool_size--;
+}
+
+void GSDevice::ClearPool()
+{
+	for (auto& bucket : m_pool)
+	{
+		for (auto t : bucket.second)
+			delete t;
+	}
+
+	m_pool.clear();
+	m_pool_size = 0;
+}
+
 void GSDevice::AgePool()
 {
 	m_frame++;
 
-	while (m_pool.size() > 40 && m_frame - m_pool.back()->last_frame_used > 10)
+	for (auto i = m_pool.begin(); i != m_pool.end() && m_pool_size > 40;)
 	{
-		delete m_pool.back();
+		auto& bucket = i->second;
+
+		while (!bucket.empty() && m_pool_size > 40 && m_frame - bucket.back()->last_frame_used > 10)
+		{
+			delete bucket.back();
 
-		m_pool.pop_back();
+			bucket.pop_back();
+			m_pool_size--;
+		}
+
+		if (bucket.empty())
+			i = m_pool.erase(i);
+		else
+			++i;
 	}
 }
 
 void GSDevice::PurgePool()
 {
 	// OOM emergency. Let's free this useless pool
-	while (!m_pool.empty())
-	{
-		delete m_pool.back();
-
-		m_pool.pop_back();
-	}
+	ClearPool();
 }
 
 GSTexture* GSDevice::CreateSparseRenderTarget(int w, int h, int format)
@@ -277,9 +313,12 @@ void GSDevice::Merge(GSTexture* sTex[3], GSVector4* sRect, GSVector4* dRect, con
 	}
 
 	m_current = m_merge;
+	m_current_fx = 0;
 }
 
-void GSDevice::Interlace(const GSVector2i& ds, int field, int mode, float yoffset)
+// fx is applied by the last pass, so the deinterlaced frame comes out already boosted and
+// with its luma, ready for FXAA
+void GSDevice::Interlace(const GSVector2i& ds, int field, int mode, float yoffset, int fx)
 {
 	ResizeTarget(&m_weavebob, ds.x, ds.y);
 
@@ -287,7 +326,7 @@ void GSDevice::Interlace(const GSVector2i& ds, int field, int mode, float yoffse
 	{
 		// weave first
 
-		DoInterlace(m_merge, m_weavebob, field, false, 0);
+		DoInterlace(m_merge, m_weavebob, field, false, 0, mode == 0 ? fx : 0);
 
 		if (mode == 2)
 		{
@@ -295,7 +334,7 @@ void GSDevice::Interlace(const GSVector2i& ds, int field, int mode, float yoffse
 
 			ResizeTarget(&m_blend, ds.x, ds.y);
 
-			DoInterlace(m_weavebob, m_blend, 2, false, 0);
+			DoInterlace(m_weavebob, m_blend, 2, false, 0, fx);
 
 			m_current = m_blend;
 		}
@@ -303,58 +342,89 @@ void GSDevice::Interlace(const GSVector2i& ds, int field, int mode, float yoffse
 		{
 			m_current = m_weavebob;
 		}
+
+		m_current_fx = fx;
 	}
 	else if (mode == 1) // bob
 	{
-		DoInterlace(m_merge, m_weavebob, 3, true, yoffset * field);
+		DoInterlace(m_merge, m_weavebob, 3, true, yoffset * field, fx);
 
 		m_current = m_weavebob;
+		m_current_fx = fx;
 	}
 	else
 	{
 		m_current = m_merge;
+		m_current_fx = 0;
 	}
 }
 
-void GSDevice::ExternalFX()
+// The post-processing target that m_current isn't, at the size of m_current. The passes
+// read m_current and write there, rather than copying m_current aside and writing it back.
+GSTexture* GSDevice::GetPostTarget()
 {
-	GSVector2i s = m_current->GetSize();
+	GSTexture** t = &m_target_tmp[m_current == m_target_tmp[0] ? 1 : 0];
+
+	return ResizeTarget(t) ? *t : NULL;
+}
+
+void GSDevice::LumaToAlpha()
+{
+	if (m_current_fx & OutputFX_Luma)
+		return;
 
-	if (ResizeTarget(&m_target_tmp))
+	if (GSTexture* t = GetPostTarget())
 	{
+		GSVector2i s = m_current->GetSize();
+
 		GSVector4 sRect(0, 0, 1, 1);
 		GSVector4 dRect(0, 0, s.x, s.y);
 
-		StretchRect(m_current, sRect, m_target_tmp, dRect, ShaderConvert_TRANSPARENCY_FILTER, false);
-		DoExternalFX(m_target_tmp, m_current);
+		StretchRect(m_current, sRect, t, dRect, ShaderConvert_TRANSPARENCY_FILTER, false);
+
+		m_current = t;
+		m_current_fx |= OutputFX_Luma;
 	}
 }
 
-void GSDevice::FXAA()
+void GSDevice::ExternalFX()
 {
-	GSVector2i s = m_current->GetSize();
+	LumaToAlpha();
+
+	GSTexture* t = GetPostTarget();
 
-	if (ResizeTarget(&m_target_tmp))
+	if (t && DoExternalFX(m_current, t))
 	{
-		GSVector4 sRect(0, 0, 1, 1);
-		GSVector4 dRect(0, 0, s.x, s.y);
+		m_current = t;
+		m_current_fx = 0;
+	}
+}
+
+void GSDevice::FXAA()
+{
+	LumaToAlpha();
 
-		StretchRect(m_current, sRect, m_target_tmp, dRect, ShaderConvert_TRANSPARENCY_FILTER, false);
-		DoFXAA(m_target_tmp, m_current);
+	GSTexture* t = GetPostTarget();
+
+	if (t && DoFXAA(m_current, t))
+	{
+		m_current = t;
+		m_current_fx = 0;
 	}
 }
 
-void GSDevice::ShadeBoost()
+// Only runs a pass of its own when there was no interlacing to fold it into
+void GSDevice::ShadeBoost(int fx)
 {
-	GSVector2i s = m_current->GetSize();
+	if (m_current_fx & OutputFX_ShadeBoost)
+		return;
 
-	if (ResizeTarget(&m_target_tmp))
+	if (GSTexture* t = GetPostTarget())
 	{
-		GSVector4 sRect(0, 0, 1, 1);
-		GSVector4 dRect(0, 0, s.x, s.y);
+		DoInterlace(m_current, t, 3, false, 0, fx);
 
-		StretchRect(m_current, sRect, m_target_tmp, dRect, ShaderConvert_COPY, false);
-		DoShadeBoost(m_target_tmp, m_current);
+		m_current = t;
+		m_current_fx = fx;
 	}
 }
 
@@ -47,6 +47,14 @@ enum ShaderConvert
 	ShaderConvert_Count
 };
 
+// Output stages folded into the last pass that writes GSDevice::m_current (the interlace shader)
+enum OutputFX
+{
+	OutputFX_ShadeBoost = 1,
+	OutputFX_Luma       = 2, // luma in alpha, for FXAA and the external shader
+	OutputFX_Count      = 4,
+};
+
 enum ChannelFetch
 {
 	ChannelFetch_NONE  = 0,
@@ -97,15 +105,6 @@ public:
 	FXAAConstantBuffer() { memset(this, 0, sizeof(*this)); }
 };
 
-class ShadeBoostConstantBuffer
-{
-public:
-	GSVector4 rcpFrame;
-	GSVector4 rcpFrameOpt;
-
-	ShadeBoostConstantBuffer() { memset(this, 0, sizeof(*this)); }
-};
-
 #pragma pack(pop)
 
 enum HWBlendFlags
@@ -126,7 +125,27 @@ struct HWBlend
 class GSDevice : public GSAlignedClass<32>
 {
 private:
-	FastList<GSTexture*> m_pool;
+	struct PoolKey
+	{
+		int type, w, h, format;
+
+		bool operator==(const PoolKey& k) const { return type == k.type && w == k.w && h == k.h && format == k.format; }
+	};
+
+	struct PoolKeyHash
+	{
+		std::size_t operator()(const PoolKey& k) const
+		{
+			return std::hash<uint64>()(((uint64)k.type << 60) ^ ((uint64)k.format << 32) ^ ((uint64)k.h << 16) ^ (uint64)k.w);
+		}
+	};
+
+	// Recycled textures, the most recently used is in front of each bucket
+	std::unordered_map<PoolKey, std::deque<GSTexture*>, PoolKeyHash> m_pool;
+	size_t m_pool_size;
+
+	void DeleteOldestPoolTexture();
+	void ClearPool();
 	static std::array<HWBlend, 3*3*3*3 + 1> m_blendMap;
 
 protected:
@@ -152,8 +171,9 @@ protected:
 	GSTexture* m_merge;
 	GSTexture* m_weavebob;
 	GSTexture* m_blend;
-	GSTexture* m_target_tmp;
+	GSTexture* m_target_tmp[2]; // post-processing goes back and forth between these
 	GSTexture* m_current;
+	int m_current_fx; // OutputFX already applied to m_current
 	struct
 	{
 		size_t stride, start, count, limit;
@@ -169,12 +189,14 @@ protected:
 	virtual GSTexture* FetchSurface(int type, int w, int h, int format);
 
 	virtual void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c) = 0;
-	virtual void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset) = 0;
-	virtual void DoFXAA(GSTexture* sTex, GSTexture* dTex) {}
-	virtual void DoShadeBoost(GSTexture* sTex, GSTexture* dTex) {}
-	virtual void DoExternalFX(GSTexture* sTex, GSTexture* dTex) {}
+	virtual void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset, int fx) = 0;
+	virtual bool DoFXAA(GSTexture* sTex, GSTexture* dTex) { return false; }
+	virtual bool DoExternalFX(GSTexture* sTex, GSTexture* dTex) { return false; }
 	virtual uint16 ConvertBlendEnum(uint16 generic) = 0; // Convert blend factors/ops from the generic enum to DX11/OGl specific.
 
+	GSTexture* GetPostTarget();
+	void LumaToAlpha();
+
 public:
 	GSOsdManager m_osd;
 
@@ -204,7 +226,31 @@ public:
 	virtual void DrawIndexedPrimitive() {}
 	virtual void DrawIndexedPrimitive(int offset, int count) {}
 	virtual void EndScene();
+	virtual void FlushBatch() {}
+
+	// Optional GPU copy of the GS local memory. pages is a bitmask of MAX_PAGES bits.
+	// ReadLocalMemoryMirror fills r of t like GSLocalMemory::ReadTexture would,
+	// it returns false when the format isn't supported.
+	virtual bool HasLocalMemoryMirror() { return false; }
+	virtual void InvalidateLocalMemoryMirror(const uint32* pages) {}
+	virtual bool ReadLocalMemoryMirror(GSTexture* t, const GSVector4i& r, int layer, const uint8* vm, const uint32* clut, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, bool palette) { return false; }
+
+	// Optional GPU timestamps around the HW draws. The timings are resolved a
+	// few frames later, BeginDrawTimer returns false when no timer is available.
+	struct DrawTiming
+	{
+		uint64 frame;
+		uint64 shader; // pixel shader selector
+		uint32 rt;     // FBP << 6 | PSM
+		double ms;
+	};
+
+	virtual bool BeginDrawTimer() { return false; }
+	virtual void EndDrawTimer(uint64 frame, uint64 shader, uint32 rt) {}
+	virtual void ResolveDrawTimers(std::vector<DrawTiming>& timings) {}
 
+	// Mip levels of a texture can be rebuilt from its first layer with GSTexture::GenerateMipmap
+	virtual bool HasMipmapGeneration() { return false; }
 	virtual bool HasDepthSparse() { return false; }
 	virtual bool HasColorSparse() { return false; }
 
@@ -235,9 +281,9 @@ public:
 	GSTexture* GetCurrent();
 
 	void Merge(GSTexture* sTex[3], GSVector4* sRect, GSVector4* dRect, const GSVector2i& fs, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c);
-	void Interlace(const GSVector2i& ds, int field, int mode, float yoffset);
+	void Interlace(const GSVector2i& ds, int field, int mode, float yoffset, int fx = 0);
 	void FXAA();
-	void ShadeBoost();
+	void ShadeBoost(int fx);
 	void ExternalFX();
 	virtual void RenderOsd(GSTexture* dt) {};
 
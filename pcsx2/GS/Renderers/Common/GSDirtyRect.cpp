@@ -54,8 +54,79 @@ const GSVector4i GSDirtyRect::GetDirtyRect(const GIFRegTEX0& TEX0) const
 	return r;
 }
 
+bool GSDirtyRect::Merge(const GSDirtyRect& r)
+{
+	if (psm != r.psm)
+		return false;
+
+	// Disjoint rects (adjacent ones are merged)
+	if (r.left > right || r.right < left || r.top > bottom || r.bottom < top)
+		return false;
+
+	GSDirtyRect u = *this;
+	u.Union(r);
+
+	if (u.Area() > Area() + r.Area())
+		return false;
+
+	*this = u;
+	return true;
+}
+
+void GSDirtyRect::Union(const GSDirtyRect& r)
+{
+	left = std::min(left, r.left);
+	top = std::min(top, r.top);
+	right = std::max(right, r.right);
+	bottom = std::max(bottom, r.bottom);
+}
+
 //
 
+bool GSDirtyRectList::Add(const GSDirtyRect& r)
+{
+	for (auto& dirty_rect : *this)
+	{
+		if (dirty_rect.Merge(r))
+			return false;
+	}
+
+	if (size() < MaxRects)
+	{
+		push_back(r);
+		return true;
+	}
+
+	// Too many scattered rects, collapse them to their bounding rect. The
+	// update is done with the union anyway so nothing more is uploaded.
+	GSDirtyRect* bound = nullptr;
+
+	for (auto it = begin(); it != end();)
+	{
+		if (it->GetPSM() != r.GetPSM())
+		{
+			++it;
+		}
+		else if (!bound)
+		{
+			it->Union(r);
+			bound = &*it;
+			++it;
+		}
+		else
+		{
+			bound->Union(*it);
+			it = erase(it);
+		}
+	}
+
+	if (bound)
+		return false;
+
+	push_back(r);
+	return true;
+}
+
 const GSVector4i GSDirtyRectList::GetDirtyRectAndClear(const GIFRegTEX0& TEX0, const GSVector2i& size)
 {
 	if (!empty())
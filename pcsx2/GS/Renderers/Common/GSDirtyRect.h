@@ -30,11 +30,24 @@ public:
 	GSDirtyRect();
 	GSDirtyRect(const GSVector4i& r, uint32 psm);
 	const GSVector4i GetDirtyRect(const GIFRegTEX0& TEX0) const;
+
+	// Grow to cover r when both have the same format and the union doesn't
+	// cover more than the two rects (overlapping or adjacent)
+	bool Merge(const GSDirtyRect& r);
+	void Union(const GSDirtyRect& r);
+	int Area() const { return (right - left) * (bottom - top); }
+	uint32 GetPSM() const { return psm; }
 };
 
+// The list is only consumed as the union of its rects, so rects are merged on
+// insertion to keep it short when a game does many small transfers
 class GSDirtyRectList : public std::vector<GSDirtyRect>
 {
+	static const size_t MaxRects = 16;
+
 public:
 	GSDirtyRectList() {}
+	// Returns false when r was merged in an existing rect
+	bool Add(const GSDirtyRect& r);
 	const GSVector4i GetDirtyRectAndClear(const GIFRegTEX0& TEX0, const GSVector2i& size);
 };
@@ -22,6 +22,12 @@
 
 #include <xbyak/xbyak_util.h>
 
+// Accumulated cost of a function, actual and total are pixels drawn and visited
+struct GSFunctionStats
+{
+	uint64 frames, ticks, actual, total;
+};
+
 template <class KEY, class VALUE>
 class GSFunctionMap
 {
@@ -82,6 +88,12 @@ public:
 		return m_active->f;
 	}
 
+	void GetUsedKeys(std::set<KEY>& keys) const
+	{
+		for (const auto& i : m_map_active)
+			keys.insert(i.first);
+	}
+
 	void UpdateStats(uint64 frame, uint64 ticks, int actual, int total)
 	{
 		if (m_active)
@@ -100,6 +112,32 @@ public:
 		}
 	}
 
+	void GetStats(std::map<KEY, GSFunctionStats>& stats, bool reset)
+	{
+		for (const auto& i : m_map_active)
+		{
+			ActivePtr* p = i.second;
+
+			if (p->frames == 0)
+				continue;
+
+			// The maps of the workers all count the frames, they overlap
+
+			GSFunctionStats& s = stats[i.first];
+
+			s.frames = std::max(s.frames, p->frames);
+			s.ticks += p->ticks;
+			s.actual += p->actual;
+			s.total += p->total;
+
+			if (reset)
+			{
+				p->frame = (uint64)-1;
+				p->frames = p->ticks = p->actual = p->total = 0;
+			}
+		}
+	}
+
 	virtual void PrintStats()
 	{
 		uint64 ttpf = 0;
@@ -252,4 +290,9 @@ public:
 
 		return ret;
 	}
+
+	void Prewarm(KEY key)
+	{
+		GetDefaultFunction(key);
+	}
 };
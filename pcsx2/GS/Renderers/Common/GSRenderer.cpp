@@ -39,6 +39,9 @@ GSRenderer::GSRenderer()
 	m_aspectratio = theApp.GetConfigI("AspectRatio") % s_aspect_ratio_nb;
 	m_shader      = theApp.GetConfigI("TVShader") % s_post_shader_nb;
 	m_vsync       = theApp.GetConfigI("vsync");
+	m_present     = theApp.GetConfigB("present");
+	m_skip_output = false;
+	m_present_ticks = 0;
 	m_aa1         = theApp.GetConfigB("aa1");
 	m_fxaa        = theApp.GetConfigB("fxaa");
 	m_shaderfx    = theApp.GetConfigB("shaderfx");
@@ -53,6 +56,8 @@ GSRenderer::~GSRenderer()
 		m_dev->Reset(1, 1, GSDevice::Windowed);
 	}*/
 
+	DiscardCaptureFrames();
+
 	delete m_dev;
 }
 
@@ -74,6 +79,8 @@ bool GSRenderer::CreateDevice(GSDevice* dev)
 
 void GSRenderer::ResetDevice()
 {
+	DiscardCaptureFrames();
+
 	if (m_dev)
 		m_dev->Reset(1, 1);
 }
@@ -264,25 +271,33 @@ bool GSRenderer::Merge(int field)
 
 		m_dev->Merge(tex, src_hw, dst, fs, m_regs->PMODE, m_regs->EXTBUF, c);
 
+		// Shade boost and the luma for FXAA ride along with the deinterlacing pass
+		int fx = 0;
+
+		if (m_shadeboost)
+			fx |= OutputFX_ShadeBoost;
+		if (m_shaderfx || m_fxaa)
+			fx |= OutputFX_Luma;
+
 		if (m_regs->SMODE2.INT && m_interlace > 0)
 		{
 			if (m_interlace == 7 && m_regs->SMODE2.FFMD) // Auto interlace enabled / Odd frame interlace setting
 			{
 				int field2 = 0;
 				int mode = 2;
-				m_dev->Interlace(ds, field ^ field2, mode, tex[1] ? tex[1]->GetScale().y : tex[0]->GetScale().y);
+				m_dev->Interlace(ds, field ^ field2, mode, tex[1] ? tex[1]->GetScale().y : tex[0]->GetScale().y, fx);
 			}
 			else
 			{
 				int field2 = 1 - ((m_interlace - 1) & 1);
 				int mode = (m_interlace - 1) >> 1;
-				m_dev->Interlace(ds, field ^ field2, mode, tex[1] ? tex[1]->GetScale().y : tex[0]->GetScale().y);
+				m_dev->Interlace(ds, field ^ field2, mode, tex[1] ? tex[1]->GetScale().y : tex[0]->GetScale().y, fx);
 			}
 		}
 
 		if (m_shadeboost)
 		{
-			m_dev->ShadeBoost();
+			m_dev->ShadeBoost(fx);
 		}
 
 		if (m_shaderfx)
@@ -312,14 +327,24 @@ void GSRenderer::SetVSync(int vsync)
 		m_dev->SetVSync(m_vsync);
 }
 
-void GSRenderer::VSync(int field)
+void GSRenderer::VSync(int field, bool present)
 {
 	GSPerfMonAutoTimer pmat(&m_perfmon);
 
 	m_perfmon.Put(GSPerfMon::Frame);
+	m_present_ticks = 0;
 
 	Flush();
 
+	if (m_skip_output)
+	{
+		// Unlike frame skip every draw still happened, only the output of the frame isn't needed
+		m_dev->FlushBatch();
+		m_dev->AgePool();
+
+		return;
+	}
+
 	if (s_dump && s_n >= s_saven)
 	{
 		m_regs->Dump(root_sw + format("%05d_f%lld_gs_reg.txt", s_n, m_perfmon.GetFrame()));
@@ -347,6 +372,31 @@ void GSRenderer::VSync(int field)
 
 		double fps = 1000.0f / m_perfmon.Get(GSPerfMon::Frame);
 
+		if (m_perfmon.Get(GSPerfMon::DrawMerged) > 0)
+		{
+			m_dev->m_osd.Monitor("Merged draws", format("%d/%d", (int)m_perfmon.Get(GSPerfMon::DrawMerged), (int)m_perfmon.Get(GSPerfMon::Draw)).c_str());
+		}
+
+		if (m_perfmon.Get(GSPerfMon::Upload) > 0)
+		{
+			m_dev->m_osd.Monitor("Upload", format("%.1f KB/frame", m_perfmon.Get(GSPerfMon::Upload) / 1024).c_str());
+		}
+
+		if (m_perfmon.Get(GSPerfMon::PboStall) > 0)
+		{
+			m_dev->m_osd.Monitor("PBO stalls", format("%.1f/frame", m_perfmon.Get(GSPerfMon::PboStall)).c_str());
+		}
+
+		if (GSPng::GetQueued() > 0 || GSPng::GetDropped() > 0)
+		{
+			m_dev->m_osd.Monitor("PNG queue", format("%d queued, %d dropped", GSPng::GetQueued(), GSPng::GetDropped()).c_str());
+		}
+
+		if (m_perfmon.Get(GSPerfMon::StateElided) > 0)
+		{
+			m_dev->m_osd.Monitor("State calls", format("%d/%d", (int)m_perfmon.Get(GSPerfMon::StateCall), (int)(m_perfmon.Get(GSPerfMon::StateCall) + m_perfmon.Get(GSPerfMon::StateElided))).c_str());
+		}
+
 		std::string s;
 
 #ifdef GSTITLEINFO_API_FORCE_VERBOSE
@@ -357,10 +407,12 @@ void GSRenderer::VSync(int field)
 		{
 			//GS owns the window's title, be verbose.
 
+			const double swizzle_ms = m_perfmon.Get(GSPerfMon::SwizzleTime);
+
 			std::string s2 = m_regs->SMODE2.INT ? (std::string("Interlaced ") + (m_regs->SMODE2.FFMD ? "(frame)" : "(field)")) : "Progressive";
 
 			s = format(
-				"%lld | %d x %d | %.2f fps (%d%%) | %s - %s | %s | %d S/%d P/%d D | %d%% CPU | %.2f | %.2f",
+				"%lld | %d x %d | %.2f fps (%d%%) | %s - %s | %s | %d S/%d P/%d D | %d%% CPU | %.2f (%.0f MB/s) | %.2f",
 				m_perfmon.GetFrame(), GetInternalResolution().x, GetInternalResolution().y, fps, (int)(100.0 * fps / GetTvRefreshRate()),
 				s2.c_str(),
 				theApp.m_gs_interlace[m_interlace].name.c_str(),
@@ -370,6 +422,7 @@ void GSRenderer::VSync(int field)
 				(int)m_perfmon.Get(GSPerfMon::Draw),
 				m_perfmon.CPU(),
 				m_perfmon.Get(GSPerfMon::Swizzle) / 1024,
+				swizzle_ms > 0 ? m_perfmon.Get(GSPerfMon::Swizzle) / swizzle_ms / 1000 : 0.0,
 				m_perfmon.Get(GSPerfMon::Unswizzle) / 1024);
 
 			double fillrate = m_perfmon.Get(GSPerfMon::Fillrate);
@@ -386,6 +439,34 @@ void GSRenderer::VSync(int field)
 				}
 
 				s += format(" | %d%% CPU", sum);
+
+				double steals = m_perfmon.Get(GSPerfMon::WorkSteal);
+
+				if (steals > 0)
+				{
+					s += format(" | %d stolen D", (int)steals);
+				}
+			}
+
+			double merged = m_perfmon.Get(GSPerfMon::DrawMerged);
+
+			if (merged > 0)
+			{
+				s += format(" | %d merged D", (int)merged);
+			}
+
+			double elided = m_perfmon.Get(GSPerfMon::StateElided);
+
+			if (elided > 0)
+			{
+				s += format(" | %d/%d state calls", (int)m_perfmon.Get(GSPerfMon::StateCall), (int)(m_perfmon.Get(GSPerfMon::StateCall) + elided));
+			}
+
+			double vram = m_perfmon.Get(GSPerfMon::TextureMemory);
+
+			if (vram > 0)
+			{
+				s += format(" | %d/%d MB VRAM", (int)(vram / (1024 * 1024)), (int)(m_perfmon.Get(GSPerfMon::TextureMemoryPeak) / (1024 * 1024)));
 			}
 		}
 		else
@@ -430,6 +511,14 @@ void GSRenderer::VSync(int field)
 		return;
 	}
 
+	if (!m_present || !present)
+	{
+		// Headless replay or hidden run-ahead frame, the merged frame is rendered but never shown
+		m_dev->FlushBatch();
+
+		return;
+	}
+
 	// present
 
 	// This will scale the OSD to the window's size.
@@ -438,7 +527,9 @@ void GSRenderer::VSync(int field)
 	m_dev->m_osd.m_real_size.x = window_size.v[2];
 	m_dev->m_osd.m_real_size.y = window_size.v[3];
 
+	const uint64 present_start = GetCPUTicks();
 	m_dev->Present(m_wnd->GetClientRect().fit(m_aspectratio), m_shader);
+	m_present_ticks = GetCPUTicks() - present_start;
 
 	// snapshot
 
@@ -476,27 +567,59 @@ void GSRenderer::VSync(int field)
 
 	if (m_capture.IsCapturing())
 	{
+		DeliverCaptureFrames(false);
+
 		if (GSTexture* current = m_dev->GetCurrent())
 		{
 			GSVector2i size = m_capture.GetSize();
 
-			if (GSTexture* offscreen = m_dev->CopyOffscreen(current, GSVector4(0, 0, 1, 1), size.x, size.y))
+			if (m_capture_frames.size() >= 3)
+			{
+				// The GPU is that many frames behind, never wait on it
+				m_capture.DropFrame();
+			}
+			else if (GSTexture* offscreen = m_dev->CopyOffscreen(current, GSVector4(0, 0, 1, 1), size.x, size.y))
 			{
-				GSTexture::GSMap m;
+				offscreen->StartDownload();
 
-				if (offscreen->Map(m))
-				{
-					m_capture.DeliverFrame(m.bits, m.pitch, !m_dev->IsRBSwapped());
+				m_capture_frames.push_back(offscreen);
+			}
+		}
+	}
+}
 
-					offscreen->Unmap();
-				}
+void GSRenderer::DeliverCaptureFrames(bool wait)
+{
+	while (!m_capture_frames.empty())
+	{
+		GSTexture* offscreen = m_capture_frames.front();
 
-				m_dev->Recycle(offscreen);
-			}
+		if (!wait && !offscreen->IsDownloadReady())
+			break;
+
+		GSTexture::GSMap m;
+
+		if (offscreen->Map(m))
+		{
+			m_capture.DeliverFrame(m.bits, m.pitch, !m_dev->IsRBSwapped());
+
+			offscreen->Unmap();
 		}
+
+		m_dev->Recycle(offscreen);
+
+		m_capture_frames.pop_front();
 	}
 }
 
+void GSRenderer::DiscardCaptureFrames()
+{
+	for (GSTexture* offscreen : m_capture_frames)
+		m_dev->Recycle(offscreen);
+
+	m_capture_frames.clear();
+}
+
 bool GSRenderer::MakeSnapshot(const std::string& path)
 {
 	if (m_snapshot.empty())
@@ -542,6 +665,9 @@ bool GSRenderer::BeginCapture(std::string& filename)
 
 void GSRenderer::EndCapture()
 {
+	if (m_capture.IsCapturing())
+		DeliverCaptureFrames(true);
+
 	m_capture.EndCapture();
 }
 
@@ -26,7 +26,12 @@ class GSRenderer : public GSState
 	std::string m_snapshot;
 	int m_shader;
 
+	// Output frames being read back for the capture, oldest first
+	std::deque<GSTexture*> m_capture_frames;
+
 	bool Merge(int field);
+	void DeliverCaptureFrames(bool wait);
+	void DiscardCaptureFrames();
 
 	bool m_shift_key;
 	bool m_control_key;
@@ -36,6 +41,9 @@ protected:
 	int m_interlace;
 	int m_aspectratio;
 	int m_vsync;
+	bool m_present;
+	bool m_skip_output; // neither merge nor present the vsyncs, see GSsetOutputSkip
+	uint64 m_present_ticks; // spent in the present of the last vsync, mostly waiting on the display
 	bool m_aa1;
 	bool m_shaderfx;
 	bool m_fxaa;
@@ -56,7 +64,9 @@ public:
 
 	virtual bool CreateDevice(GSDevice* dev);
 	virtual void ResetDevice();
-	virtual void VSync(int field);
+	virtual void VSync(int field, bool present);
+	void SetOutputSkip(bool skip) { m_skip_output = skip; }
+	uint64 GetPresentTicks() const { return m_present_ticks; }
 	virtual bool MakeSnapshot(const std::string& path);
 	virtual void KeyEvent(GSKeyEventData* e);
 	virtual bool CanUpscale() { return false; }
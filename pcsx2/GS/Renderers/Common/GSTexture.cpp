@@ -32,6 +32,16 @@ GSTexture::GSTexture()
 {
 }
 
+bool GSTexture::UpdateBatch(const GSUpload* uploads, int count)
+{
+	bool ok = true;
+
+	for (int i = 0; i < count; i++)
+		ok &= Update(uploads[i].r, uploads[i].data, uploads[i].pitch, uploads[i].layer);
+
+	return ok;
+}
+
 void GSTexture::CommitRegion(const GSVector2i& region)
 {
 	if (!m_sparse)
@@ -35,6 +35,14 @@ public:
 		int pitch;
 	};
 
+	struct GSUpload
+	{
+		GSVector4i r;
+		const void* data;
+		int pitch;
+		int layer;
+	};
+
 	enum
 	{
 		RenderTarget = 1,
@@ -57,8 +65,14 @@ public:
 	}
 
 	virtual bool Update(const GSVector4i& r, const void* data, int pitch, int layer = 0) = 0;
+	// Several rects, possibly of different layers, sent in one go when the backend can stage them together
+	virtual bool UpdateBatch(const GSUpload* uploads, int count);
 	virtual bool Map(GSMap& m, const GSVector4i* r = NULL, int layer = 0) = 0;
 	virtual void Unmap() = 0;
+	// Offscreen only: queue the transfer to the CPU so the next Map doesn't wait on the GPU
+	virtual void StartDownload() {}
+	// Offscreen only: the transfer queued by StartDownload is done, Map won't wait
+	virtual bool IsDownloadReady() { return true; }
 	virtual void GenerateMipmap() {}
 	virtual bool Save(const std::string& fn) = 0;
 	virtual uint32 GetID() { return 0; }
@@ -46,6 +46,16 @@ GSVertexTrace::GSVertexTrace(const GSState* state)
 	InitUpdate(GS_LINE_CLASS);
 	InitUpdate(GS_TRIANGLE_CLASS);
 	InitUpdate(GS_SPRITE_CLASS);
+
+	const int threads = std::max(theApp.GetConfigI("vertex_trace_threads"), 0);
+
+	m_slices.resize(threads);
+
+	for (int i = 0; i < threads; i++)
+	{
+		m_workers.push_back(std::unique_ptr<GSJobQueue<TraceJob, 4>>(new GSJobQueue<TraceJob, 4>(
+			[this](TraceJob& job) { (this->*job.fmm)(job.vertex, job.index, job.begin, job.end, *job.mm); })));
+	}
 }
 
 void GSVertexTrace::Update(const void* vertex, const uint32* index, int v_count, int i_count, GS_PRIM_CLASS primclass)
@@ -57,6 +67,21 @@ void GSVertexTrace::Update(const void* vertex, const uint32* index, int v_count,
 	uint32 fst = m_state->PRIM->FST;
 	uint32 color = !(m_state->PRIM->TME && m_state->m_context->TEX0.TFX == TFX_DECAL && m_state->m_context->TEX0.TCC);
 
+	// Unless flat shading picks the color of the last vertex, lines and triangles trace every
+	// vertex on its own, which is what the point path does with the vectorized loop.
+	if ((primclass == GS_LINE_CLASS || primclass == GS_TRIANGLE_CLASS) && (iip || !color))
+	{
+		// Strips share most of their vertices, and GSState keeps the referenced ones packed
+		// in [0, v_count), so each of them can be visited once. Fans may leave gaps.
+		if (i_count > v_count && m_state->PRIM->PRIM != GS_TRIANGLEFAN)
+		{
+			index = NULL;
+			i_count = v_count;
+		}
+
+		primclass = GS_POINT_CLASS;
+	}
+
 	(this->*m_fmm[m_accurate_stq][color][fst][tme][iip][primclass])(vertex, index, i_count);
 
 	// Potential float overflow detected. Better uses the slower division instead
@@ -155,6 +180,108 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 {
 	const GSDrawingContext* context = m_state->m_context;
 
+	const int n = primclass == GS_POINT_CLASS ? 1 : primclass == GS_TRIANGLE_CLASS ? 3 : 2;
+	const int workers = static_cast<int>(m_workers.size());
+
+	MinMax mm;
+
+	// Below a few thousand primitives the hand-off costs more than it saves
+	if (workers == 0 || count < 16384)
+	{
+		FindMinMaxRange<primclass, iip, tme, fst, color, accurate_stq>(vertex, index, 0, count, mm);
+	}
+	else
+	{
+		// Each slice holds whole primitives, the last one is traced on the calling thread
+		const int slice = count / (workers + 1) / n * n;
+
+		TraceJob job;
+		job.fmm = &GSVertexTrace::FindMinMaxRange<primclass, iip, tme, fst, color, accurate_stq>;
+		job.vertex = vertex;
+		job.index = index;
+
+		for (int i = 0; i < workers; i++)
+		{
+			job.begin = i * slice;
+			job.end = (i + 1) * slice;
+			job.mm = &m_slices[i];
+
+			m_workers[i]->Push(job);
+		}
+
+		FindMinMaxRange<primclass, iip, tme, fst, color, accurate_stq>(vertex, index, workers * slice, count, mm);
+
+		for (int i = 0; i < workers; i++)
+		{
+			m_workers[i]->Wait();
+
+			const MinMax& r = m_slices[i];
+
+			mm.cmin = mm.cmin.min_u8(r.cmin);
+			mm.cmax = mm.cmax.max_u8(r.cmax);
+			mm.pmin = mm.pmin.min_u32(r.pmin);
+			mm.pmax = mm.pmax.max_u32(r.pmax);
+			mm.tmin = mm.tmin.min(r.tmin);
+			mm.tmax = mm.tmax.max(r.tmax);
+		}
+	}
+
+	GSVector4i cmin = mm.cmin;
+	GSVector4i cmax = mm.cmax;
+	GSVector4i pmin = mm.pmin;
+	GSVector4i pmax = mm.pmax;
+	GSVector4 tmin = mm.tmin;
+	GSVector4 tmax = mm.tmax;
+
+	// FIXME/WARNING. A division by 2 is done on the depth. I suspect to avoid
+	// negative value. However it means that we lost the lsb bit. m_eq.z could
+	// be true if depth isn't constant but close enough. It also imply that
+	// pmin.z & 1 == 0 and pax.z & 1 == 0
+
+	pmin = pmin.blend16<0x30>(pmin.srl32(1));
+	pmax = pmax.blend16<0x30>(pmax.srl32(1));
+
+	GSVector4 o(context->XYOFFSET);
+	GSVector4 s(1.0f / 16, 1.0f / 16, 2.0f, 1.0f);
+
+	m_min.p = (GSVector4(pmin) - o) * s;
+	m_max.p = (GSVector4(pmax) - o) * s;
+
+	if (tme)
+	{
+		if (fst)
+		{
+			s = GSVector4(1.0f / 16, 1.0f).xxyy();
+		}
+		else
+		{
+			s = GSVector4(1 << context->TEX0.TW, 1 << context->TEX0.TH, 1, 1);
+		}
+
+		m_min.t = tmin * s;
+		m_max.t = tmax * s;
+	}
+	else
+	{
+		m_min.t = GSVector4::zero();
+		m_max.t = GSVector4::zero();
+	}
+
+	if (color)
+	{
+		m_min.c = cmin.zzzz().u8to32();
+		m_max.c = cmax.zzzz().u8to32();
+	}
+	else
+	{
+		m_min.c = GSVector4i::zero();
+		m_max.c = GSVector4i::zero();
+	}
+}
+
+template <GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color, uint32 accurate_stq>
+void GSVertexTrace::FindMinMaxRange(const void* vertex, const uint32* index, int begin, int end, MinMax& mm)
+{
 	int n = 1;
 
 	switch (primclass)
@@ -181,11 +308,90 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 
 	const GSVertex* RESTRICT v = (GSVertex*)vertex;
 
-	for (int i = 0; i < count; i += n)
+#if _M_SSE >= 0x501
+
+	// Two vertices per register, the low lane takes the first one. Points go by pairs, a sprite
+	// fills a register, the scalar loop below finishes what is left.
+	if (primclass == GS_POINT_CLASS || primclass == GS_SPRITE_CLASS)
+	{
+		GSVector8 tmin8 = GSVector8::cast(tmin).aa();
+		GSVector8 tmax8 = GSVector8::cast(tmax).aa();
+		GSVector8i cmin8 = GSVector8i::xffffffff();
+		GSVector8i cmax8 = GSVector8i::zero();
+		GSVector8i pmin8 = GSVector8i::xffffffff();
+		GSVector8i pmax8 = GSVector8i::zero();
+
+		for (; begin + 2 <= end; begin += 2)
+		{
+			const GSVertex& v0 = v[index ? index[begin + 0] : begin + 0];
+			const GSVertex& v1 = v[index ? index[begin + 1] : begin + 1];
+
+			GSVector8i c = GSVector8i::load(&v0.m[0], &v1.m[0]);
+			GSVector8i xyzf = GSVector8i::load(&v0.m[1], &v1.m[1]);
+
+			if (color)
+			{
+				// Flat sprites take the color of their second vertex
+				GSVector8i cc = primclass == GS_SPRITE_CLASS && !iip ? c.bb() : c;
+
+				cmin8 = cmin8.min_u8(cc);
+				cmax8 = cmax8.max_u8(cc);
+			}
+
+			if (tme)
+			{
+				if (!fst)
+				{
+					GSVector8 stq = GSVector8::cast(c);
+
+					// A sprite is divided by the Q of its second vertex
+					GSVector8 q = primclass == GS_SPRITE_CLASS ? stq.bb().wwww() : stq.wwww();
+
+					if (accurate_stq)
+						stq = (stq.xyww() / q).xyww(q);
+					else
+						stq = (stq.xyww() * q.rcpnr()).xyww(q);
+
+					tmin8 = tmin8.min(stq);
+					tmax8 = tmax8.max(stq);
+				}
+				else
+				{
+					GSVector8 st = GSVector8(xyzf.uph16()).xyxy();
+
+					tmin8 = tmin8.min(st);
+					tmax8 = tmax8.max(st);
+				}
+			}
+
+			GSVector8i xy = xyzf.upl16();
+			GSVector8i z = xyzf.yyyy();
+
+			// The fog of a sprite is the one of its second vertex too
+			GSVector8i p = xy.blend16<0xf0>(z.uph32(primclass == GS_SPRITE_CLASS ? xyzf.bb() : xyzf));
+
+			pmin8 = pmin8.min_u32(p);
+			pmax8 = pmax8.max_u32(p);
+		}
+
+		tmin = tmin8.extract<0>().min(tmin8.extract<1>());
+		tmax = tmax8.extract<0>().max(tmax8.extract<1>());
+		cmin = cmin8.extract<0>().min_u8(cmin8.extract<1>());
+		cmax = cmax8.extract<0>().max_u8(cmax8.extract<1>());
+		pmin = pmin8.extract<0>().min_u32(pmin8.extract<1>());
+		pmax = pmax8.extract<0>().max_u32(pmax8.extract<1>());
+	}
+
+#endif
+
+	for (int i = begin; i < end; i += n)
 	{
 		if (primclass == GS_POINT_CLASS)
 		{
-			GSVector4i c(v[index[i]].m[0]);
+			// index is NULL when the vertices are sequential
+			const GSVertex& vi = v[index ? index[i] : i];
+
+			GSVector4i c(vi.m[0]);
 
 			if (color)
 			{
@@ -211,7 +417,7 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 				}
 				else
 				{
-					GSVector4i uv(v[index[i]].m[1]);
+					GSVector4i uv(vi.m[1]);
 
 					GSVector4 st = GSVector4(uv.uph16()).xyxy();
 
@@ -220,7 +426,7 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 				}
 			}
 
-			GSVector4i xyzf(v[index[i]].m[1]);
+			GSVector4i xyzf(vi.m[1]);
 
 			GSVector4i xy = xyzf.upl16();
 			GSVector4i z = xyzf.yyyy();
@@ -455,50 +661,12 @@ void GSVertexTrace::FindMinMax(const void* vertex, const uint32* index, int coun
 		}
 	}
 
-	// FIXME/WARNING. A division by 2 is done on the depth. I suspect to avoid
-	// negative value. However it means that we lost the lsb bit. m_eq.z could
-	// be true if depth isn't constant but close enough. It also imply that
-	// pmin.z & 1 == 0 and pax.z & 1 == 0
-
-	pmin = pmin.blend16<0x30>(pmin.srl32(1));
-	pmax = pmax.blend16<0x30>(pmax.srl32(1));
-
-	GSVector4 o(context->XYOFFSET);
-	GSVector4 s(1.0f / 16, 1.0f / 16, 2.0f, 1.0f);
-
-	m_min.p = (GSVector4(pmin) - o) * s;
-	m_max.p = (GSVector4(pmax) - o) * s;
-
-	if (tme)
-	{
-		if (fst)
-		{
-			s = GSVector4(1.0f / 16, 1.0f).xxyy();
-		}
-		else
-		{
-			s = GSVector4(1 << context->TEX0.TW, 1 << context->TEX0.TH, 1, 1);
-		}
-
-		m_min.t = tmin * s;
-		m_max.t = tmax * s;
-	}
-	else
-	{
-		m_min.t = GSVector4::zero();
-		m_max.t = GSVector4::zero();
-	}
-
-	if (color)
-	{
-		m_min.c = cmin.zzzz().u8to32();
-		m_max.c = cmax.zzzz().u8to32();
-	}
-	else
-	{
-		m_min.c = GSVector4i::zero();
-		m_max.c = GSVector4i::zero();
-	}
+	mm.cmin = cmin;
+	mm.cmax = cmax;
+	mm.pmin = pmin;
+	mm.pmax = pmax;
+	mm.tmin = tmin;
+	mm.tmax = tmax;
 }
 
 void GSVertexTrace::CorrectDepthTrace(const void* vertex, int count)
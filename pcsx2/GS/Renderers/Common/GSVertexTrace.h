@@ -20,6 +20,7 @@
 #include "GS/Renderers/SW/GSVertexSW.h"
 #include "GS/Renderers/HW/GSVertexHW.h"
 #include "GSFunctionMap.h"
+#include "GS/GSThread_CXX11.h"
 
 class GSState;
 
@@ -45,13 +46,36 @@ protected:
 
 	static const GSVector4 s_minmax;
 
+	struct MinMax
+	{
+		GSVector4i cmin, cmax, pmin, pmax;
+		GSVector4 tmin, tmax;
+	};
+
 	typedef void (GSVertexTrace::*FindMinMaxPtr)(const void* vertex, const uint32* index, int count);
+	typedef void (GSVertexTrace::*FindMinMaxRangePtr)(const void* vertex, const uint32* index, int begin, int end, MinMax& mm);
 
 	FindMinMaxPtr m_fmm[2][2][2][2][2][4];
 
+	struct TraceJob
+	{
+		FindMinMaxRangePtr fmm;
+		const void* vertex;
+		const uint32* index;
+		int begin, end;
+		MinMax* mm;
+	};
+
+	// Large batches are traced in slices, one per worker plus the calling thread
+	std::vector<std::unique_ptr<GSJobQueue<TraceJob, 4>>> m_workers;
+	std::vector<MinMax> m_slices;
+
 	template <GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color, uint32 accurate_stq>
 	void FindMinMax(const void* vertex, const uint32* index, int count);
 
+	template <GS_PRIM_CLASS primclass, uint32 iip, uint32 tme, uint32 fst, uint32 color, uint32 accurate_stq>
+	void FindMinMaxRange(const void* vertex, const uint32* index, int begin, int end, MinMax& mm);
+
 public:
 	GS_PRIM_CLASS m_primclass;
 
@@ -28,6 +28,21 @@ GSDevice11::GSDevice11()
 	FXAA_Compiled = false;
 	ExShader_Compiled = false;
 
+	m_vb_discard = false;
+	m_ib_discard = false;
+	m_ib_stride = sizeof(uint32);
+
+	m_present_seq = 0;
+	m_present_queued = 0;
+	m_present_queue_size = std::max(1, std::min(theApp.GetConfigI("present_queue_size"), 8));
+
+	m_draw_timer.enabled = false;
+	m_draw_timer.open = false;
+	m_draw_timer.frame = 0;
+	m_draw_timer.head = 0;
+	m_draw_timer.tail = 0;
+	memset(m_draw_timer.pending, 0, sizeof(m_draw_timer.pending));
+
 	m_state.topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
 	m_state.bf = -1;
 
@@ -42,6 +57,14 @@ GSDevice11::GSDevice11()
 		m_aniso_filter = 0;
 }
 
+GSDevice11::~GSDevice11()
+{
+	// Drain the pending command lists before the contexts go away
+	if (m_submit)
+		WaitSubmission();
+	m_submit.reset();
+}
+
 bool GSDevice11::SetFeatureLevel(D3D_FEATURE_LEVEL level, bool compat_mode)
 {
 	m_shader.level = level;
@@ -161,6 +184,45 @@ bool GSDevice11::Create(const std::shared_ptr<GSWnd>& wnd)
 			fprintf(stderr, "D3D11: Unable to create D3D11 device (reason %x)\n", result);
 			return false;
 		}
+
+		m_imm = m_ctx;
+	}
+
+	// deferred context
+	if (theApp.GetConfigB("threaded_submission"))
+	{
+		// Without driver support the runtime emulates the command lists, nothing to gain
+		D3D11_FEATURE_DATA_THREADING threading = {};
+		m_dev->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threading, sizeof(threading));
+
+		CComPtr<ID3D11DeviceContext> deferred;
+
+		if (threading.DriverCommandLists && SUCCEEDED(m_dev->CreateDeferredContext(0, &deferred)))
+		{
+			m_ctx = deferred;
+			m_submit = std::make_unique<GSJobQueue<SubmitJob, 16>>([this](SubmitJob& job) { ExecuteSubmit(job); });
+		}
+		else
+		{
+			fprintf(stderr, "D3D11: Driver command lists aren't supported, threaded submission disabled\n");
+		}
+	}
+
+	if (theApp.GetConfigB("gpu_draw_profiling"))
+	{
+		D3D11_QUERY_DESC qd = {};
+		bool ok = true;
+
+		qd.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+		for (auto& q : m_draw_timer.disjoint)
+			ok = ok && SUCCEEDED(m_dev->CreateQuery(&qd, &q));
+
+		qd.Query = D3D11_QUERY_TIMESTAMP;
+		m_draw_timer.pool.resize(1 << 12);
+		for (auto& t : m_draw_timer.pool)
+			ok = ok && SUCCEEDED(m_dev->CreateQuery(&qd, &t.begin)) && SUCCEEDED(m_dev->CreateQuery(&qd, &t.end));
+
+		m_draw_timer.enabled = ok;
 	}
 
 	// swapchain creation
@@ -309,30 +371,24 @@ bool GSDevice11::Create(const std::shared_ptr<GSWnd>& wnd)
 
 	hr = m_dev->CreateBuffer(&bd, NULL, &m_interlace.cb);
 
+	// One set per combination of the output stages folded into the pass (shade boost, luma)
+
 	theApp.LoadResource(IDR_INTERLACE_FX, shader);
-	for (size_t i = 0; i < countof(m_interlace.ps); i++)
+	for (int fx = 0; fx < OutputFX_Count; fx++)
 	{
-		CreateShader(shader, "interlace.fx", nullptr, format("ps_main%d", i).c_str(), sm_model.GetPtr(), &m_interlace.ps[i]);
-	}
-
-	// Shade Boost
-
-	ShaderMacro sm_sboost(m_shader.model);
-
-	sm_sboost.AddMacro("SB_SATURATION", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Saturation"), 100)));
-	sm_sboost.AddMacro("SB_BRIGHTNESS", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Brightness"), 100)));
-	sm_sboost.AddMacro("SB_CONTRAST", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Contrast"), 100)));
-
-	memset(&bd, 0, sizeof(bd));
-
-	bd.ByteWidth = sizeof(ShadeBoostConstantBuffer);
-	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		ShaderMacro sm(m_shader.model);
 
-	hr = m_dev->CreateBuffer(&bd, NULL, &m_shadeboost.cb);
+		sm.AddMacro("PS_SHADEBOOST", !!(fx & OutputFX_ShadeBoost));
+		sm.AddMacro("PS_LUMA", !!(fx & OutputFX_Luma));
+		sm.AddMacro("SB_SATURATION", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Saturation"), 100)));
+		sm.AddMacro("SB_BRIGHTNESS", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Brightness"), 100)));
+		sm.AddMacro("SB_CONTRAST", std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Contrast"), 100)));
 
-	theApp.LoadResource(IDR_SHADEBOOST_FX, shader);
-	CreateShader(shader, "shadeboost.fx", nullptr, "ps_main", sm_sboost.GetPtr(), &m_shadeboost.ps);
+		for (size_t i = 0; i < countof(m_interlace.ps[fx]); i++)
+		{
+			CreateShader(shader, "interlace.fx", nullptr, format("ps_main%d", i).c_str(), sm.GetPtr(), &m_interlace.ps[fx][i]);
+		}
+	}
 
 	// External fx shader
 
@@ -435,6 +491,9 @@ bool GSDevice11::Create(const std::shared_ptr<GSWnd>& wnd)
 
 bool GSDevice11::Reset(int w, int h)
 {
+	// The swap chain can't be resized while the submit thread still uses it
+	WaitSubmission();
+
 	if (!__super::Reset(w, h))
 		return false;
 
@@ -454,7 +513,7 @@ bool GSDevice11::Reset(int w, int h)
 			return false;
 		}
 
-		m_backbuffer = new GSTexture11(backbuffer);
+		m_backbuffer = new GSTexture11(backbuffer, this);
 	}
 
 	return true;
@@ -467,7 +526,150 @@ void GSDevice11::SetVSync(int vsync)
 
 void GSDevice11::Flip()
 {
-	m_swapchain->Present(m_vsync, 0);
+	if (m_submit)
+		Submit(m_vsync);
+	else
+		m_swapchain->Present(m_vsync, 0);
+}
+
+void GSDevice11::Submit(int present)
+{
+	ID3D11CommandList* list = nullptr;
+
+	// Keep the recorded state, m_state still describes it
+	if (FAILED(m_ctx->FinishCommandList(TRUE, &list)))
+		list = nullptr;
+
+	// The first map of a dynamic buffer in a command list must discard it
+	m_vb_discard = true;
+	m_ib_discard = true;
+
+	if (present < 0)
+	{
+		m_submit->Push(SubmitJob{list, present, 0});
+		return;
+	}
+
+	// Don't let the GS run too far ahead of the display
+	{
+		std::unique_lock<std::mutex> l(m_present_lock);
+		m_present_done.wait(l, [this] { return m_present_queued < m_present_queue_size; });
+		m_present_queued++;
+	}
+
+	m_submit->Push(SubmitJob{list, present, ++m_present_seq});
+}
+
+void GSDevice11::ExecuteSubmit(SubmitJob& job)
+{
+	if (job.list)
+	{
+		m_imm->ExecuteCommandList(job.list, FALSE);
+		job.list->Release();
+	}
+
+	if (job.present >= 0)
+	{
+		// A newer frame is already queued, skip this one
+		if (job.seq == m_present_seq)
+			m_swapchain->Present(job.present, 0);
+
+		{
+			std::lock_guard<std::mutex> l(m_present_lock);
+			m_present_queued--;
+		}
+		m_present_done.notify_one();
+	}
+}
+
+void GSDevice11::WaitSubmission()
+{
+	if (!m_submit)
+		return;
+
+	Submit();
+	m_submit->Wait();
+}
+
+bool GSDevice11::BeginDrawTimer()
+{
+	auto& dt = m_draw_timer;
+
+	// Drop the measure when the ring is full, results are read back at the vsync
+	if (!dt.enabled || dt.head - dt.tail >= dt.pool.size())
+		return false;
+
+	if (!dt.open)
+	{
+		// The slot is still used by timers in flight
+		if (dt.pending[dt.frame])
+			return false;
+
+		m_ctx->Begin(dt.disjoint[dt.frame]);
+		dt.open = true;
+	}
+
+	m_ctx->End(dt.pool[dt.head % dt.pool.size()].begin);
+
+	return true;
+}
+
+void GSDevice11::EndDrawTimer(uint64 frame, uint64 shader, uint32 rt)
+{
+	auto& dt = m_draw_timer;
+	DrawTimer& t = dt.pool[dt.head % dt.pool.size()];
+
+	m_ctx->End(t.end);
+
+	t.frame = dt.frame;
+	t.timing.frame = frame;
+	t.timing.shader = shader;
+	t.timing.rt = rt;
+	dt.pending[dt.frame]++;
+	dt.head++;
+}
+
+void GSDevice11::ResolveDrawTimers(std::vector<DrawTiming>& timings)
+{
+	auto& dt = m_draw_timer;
+
+	if (dt.open)
+	{
+		m_ctx->End(dt.disjoint[dt.frame]);
+		dt.open = false;
+		dt.frame = (dt.frame + 1) % countof(dt.disjoint);
+	}
+
+	// GetData is only allowed on the immediate context
+	WaitSubmission();
+
+	// Results are available in order, stop at the first pending one
+	while (dt.tail != dt.head)
+	{
+		DrawTimer& t = dt.pool[dt.tail % dt.pool.size()];
+
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+		UINT64 time_start;
+		UINT64 time_end;
+
+		if (m_imm->GetData(dt.disjoint[t.frame], &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+		if (m_imm->GetData(t.begin, &time_start, sizeof(time_start), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+		if (m_imm->GetData(t.end, &time_end, sizeof(time_end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+			break;
+
+		// The GPU clock changed during the frame, the timestamps are meaningless
+		if (!disjoint.Disjoint)
+		{
+			DrawTiming timing = t.timing;
+			timing.ms = (double)(time_end - time_start) * 1000.0 / (double)disjoint.Frequency;
+			timings.push_back(timing);
+		}
+
+		dt.pending[t.frame]--;
+		dt.tail++;
+	}
 }
 
 void GSDevice11::BeforeDraw()
@@ -621,7 +823,7 @@ GSTexture* GSDevice11::CreateSurface(int type, int w, int h, int format)
 
 	if (SUCCEEDED(hr))
 	{
-		t = new GSTexture11(texture);
+		t = new GSTexture11(texture, this);
 
 		switch (type)
 		{
@@ -886,7 +1088,7 @@ void GSDevice11::DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex,
 	}
 }
 
-void GSDevice11::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset)
+void GSDevice11::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset, int fx)
 {
 	GSVector4 s = GSVector4(dTex->GetSize());
 
@@ -900,7 +1102,7 @@ void GSDevice11::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool
 
 	m_ctx->UpdateSubresource(m_interlace.cb, 0, NULL, &cb, 0, 0);
 
-	StretchRect(sTex, sRect, dTex, dRect, m_interlace.ps[shader], m_interlace.cb, linear);
+	StretchRect(sTex, sRect, dTex, dRect, m_interlace.ps[fx][shader], m_interlace.cb, linear);
 }
 
 //Included an init function for this also. Just to be safe.
@@ -941,7 +1143,7 @@ void GSDevice11::InitExternalFX()
 	}
 }
 
-void GSDevice11::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
+bool GSDevice11::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 {
 	GSVector2i s = dTex->GetSize();
 
@@ -952,6 +1154,9 @@ void GSDevice11::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 
 	InitExternalFX();
 
+	if (!m_shaderfx.ps)
+		return false;
+
 	cb.xyFrame = GSVector2((float)s.x, (float)s.y);
 	cb.rcpFrame = GSVector4(1.0f / (float)s.x, 1.0f / (float)s.y, 0.0f, 0.0f);
 	cb.rcpFrameOpt = GSVector4::zero();
@@ -959,6 +1164,8 @@ void GSDevice11::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 	m_ctx->UpdateSubresource(m_shaderfx.cb, 0, NULL, &cb, 0, 0);
 
 	StretchRect(sTex, sRect, dTex, dRect, m_shaderfx.ps, m_shaderfx.cb, true);
+
+	return true;
 }
 
 // This shouldn't be necessary, we have some bug corrupting memory
@@ -982,7 +1189,7 @@ void GSDevice11::InitFXAA()
 	}
 }
 
-void GSDevice11::DoFXAA(GSTexture* sTex, GSTexture* dTex)
+bool GSDevice11::DoFXAA(GSTexture* sTex, GSTexture* dTex)
 {
 	GSVector2i s = dTex->GetSize();
 
@@ -993,6 +1200,9 @@ void GSDevice11::DoFXAA(GSTexture* sTex, GSTexture* dTex)
 
 	InitFXAA();
 
+	if (!m_fxaa.ps)
+		return false;
+
 	cb.rcpFrame = GSVector4(1.0f / s.x, 1.0f / s.y, 0.0f, 0.0f);
 	cb.rcpFrameOpt = GSVector4::zero();
 
@@ -1002,23 +1212,8 @@ void GSDevice11::DoFXAA(GSTexture* sTex, GSTexture* dTex)
 
 	//sTex->Save("c:\\temp1\\1.bmp");
 	//dTex->Save("c:\\temp1\\2.bmp");
-}
-
-void GSDevice11::DoShadeBoost(GSTexture* sTex, GSTexture* dTex)
-{
-	GSVector2i s = dTex->GetSize();
 
-	GSVector4 sRect(0, 0, 1, 1);
-	GSVector4 dRect(0, 0, s.x, s.y);
-
-	ShadeBoostConstantBuffer cb;
-
-	cb.rcpFrame = GSVector4(1.0f / s.x, 1.0f / s.y, 0.0f, 0.0f);
-	cb.rcpFrameOpt = GSVector4::zero();
-
-	m_ctx->UpdateSubresource(m_shadeboost.cb, 0, NULL, &cb, 0, 0);
-
-	StretchRect(sTex, sRect, dTex, dRect, m_shadeboost.ps, m_shadeboost.cb, true);
+	return true;
 }
 
 void GSDevice11::SetupDATE(GSTexture* rt, GSTexture* ds, const GSVertexPT1* vertices, bool datm)
@@ -1109,9 +1304,10 @@ bool GSDevice11::IAMapVertexBuffer(void** vertex, size_t stride, size_t count)
 
 	D3D11_MAP type = D3D11_MAP_WRITE_NO_OVERWRITE;
 
-	if (m_vertex.start + count > m_vertex.limit || stride != m_vertex.stride)
+	if (m_vertex.start + count > m_vertex.limit || stride != m_vertex.stride || m_vb_discard)
 	{
 		m_vertex.start = 0;
+		m_vb_discard = false;
 
 		type = D3D11_MAP_WRITE_DISCARD;
 	}
@@ -1152,10 +1348,14 @@ void GSDevice11::IASetVertexBuffer(ID3D11Buffer* vb, size_t stride)
 	}
 }
 
-void GSDevice11::IASetIndexBuffer(const void* index, size_t count)
+// The indices are narrowed to 16 bits when they address at most 64K vertices, which halves
+// the upload of the strip and fan heavy draws.  m_index.limit stays in 32-bit indices.
+void GSDevice11::IASetIndexBuffer(const void* index, size_t count, size_t vertices)
 {
 	ASSERT(m_index.count == 0);
 
+	const size_t stride = vertices <= 0x10000 ? sizeof(uint16) : sizeof(uint32);
+
 	if (count > m_index.limit)
 	{
 		m_ib_old = m_ib;
@@ -1186,9 +1386,11 @@ void GSDevice11::IASetIndexBuffer(const void* index, size_t count)
 
 	D3D11_MAP type = D3D11_MAP_WRITE_NO_OVERWRITE;
 
-	if (m_index.start + count > m_index.limit)
+	if (m_index.start + count > m_index.limit || stride != m_ib_stride || m_ib_discard)
 	{
 		m_index.start = 0;
+		m_ib_stride = stride;
+		m_ib_discard = false;
 
 		type = D3D11_MAP_WRITE_DISCARD;
 	}
@@ -1197,23 +1399,35 @@ void GSDevice11::IASetIndexBuffer(const void* index, size_t count)
 
 	if (SUCCEEDED(m_ctx->Map(m_ib, 0, type, 0, &m)))
 	{
-		memcpy((uint8*)m.pData + m_index.start * sizeof(uint32), index, count * sizeof(uint32));
+		if (stride == sizeof(uint32))
+		{
+			memcpy((uint8*)m.pData + m_index.start * sizeof(uint32), index, count * sizeof(uint32));
+		}
+		else
+		{
+			const uint32* RESTRICT src = (const uint32*)index;
+			uint16* RESTRICT dst = (uint16*)m.pData + m_index.start;
+
+			for (size_t i = 0; i < count; i++)
+				dst[i] = (uint16)src[i];
+		}
 
 		m_ctx->Unmap(m_ib, 0);
 	}
 
 	m_index.count = count;
 
-	IASetIndexBuffer(m_ib);
+	IASetIndexBuffer(m_ib, stride == sizeof(uint32) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT);
 }
 
-void GSDevice11::IASetIndexBuffer(ID3D11Buffer* ib)
+void GSDevice11::IASetIndexBuffer(ID3D11Buffer* ib, DXGI_FORMAT format)
 {
-	if (m_state.ib != ib)
+	if (m_state.ib != ib || m_state.ib_format != format)
 	{
 		m_state.ib = ib;
+		m_state.ib_format = format;
 
-		m_ctx->IASetIndexBuffer(ib, DXGI_FORMAT_R32_UINT, 0);
+		m_ctx->IASetIndexBuffer(ib, format, 0);
 	}
 }
 
@@ -18,6 +18,7 @@
 #include "GSTexture11.h"
 #include "GS/GSVector.h"
 #include "GS/Renderers/Common/GSDevice.h"
+#include "GS/GSThread_CXX11.h"
 
 struct GSVertexShader11
 {
@@ -396,10 +397,9 @@ private:
 	GSTexture* FetchSurface(int type, int w, int h, int format);
 
 	void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c) final;
-	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset = 0) final;
-	void DoFXAA(GSTexture* sTex, GSTexture* dTex) final;
-	void DoShadeBoost(GSTexture* sTex, GSTexture* dTex) final;
-	void DoExternalFX(GSTexture* sTex, GSTexture* dTex) final;
+	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset, int fx) final;
+	bool DoFXAA(GSTexture* sTex, GSTexture* dTex) final;
+	bool DoExternalFX(GSTexture* sTex, GSTexture* dTex) final;
 	void InitExternalFX();
 	void InitFXAA(); // Bug workaround! Stack corruption? Heap corruption? No idea
 	void RenderOsd(GSTexture* dt);
@@ -410,7 +410,8 @@ private:
 
 	CComPtr<IDXGIFactory2> m_factory;
 	CComPtr<ID3D11Device> m_dev;
-	CComPtr<ID3D11DeviceContext> m_ctx;
+	CComPtr<ID3D11DeviceContext> m_ctx; // recording context, deferred when threaded_submission is enabled
+	CComPtr<ID3D11DeviceContext> m_imm; // immediate context
 	CComPtr<IDXGISwapChain1> m_swapchain;
 	CComPtr<ID3D11Buffer> m_vb;
 	CComPtr<ID3D11Buffer> m_vb_old;
@@ -422,6 +423,7 @@ private:
 		ID3D11Buffer* vb;
 		size_t vb_stride;
 		ID3D11Buffer* ib;
+		DXGI_FORMAT ib_format;
 		ID3D11InputLayout* layout;
 		D3D11_PRIMITIVE_TOPOLOGY topology;
 		ID3D11VertexShader* vs;
@@ -448,6 +450,52 @@ private:
 
 	CComPtr<ID3D11RasterizerState> m_rs;
 
+	// Threaded submission: the GS thread records on a deferred context and the
+	// command lists are executed then presented by the submit thread
+	struct SubmitJob
+	{
+		ID3D11CommandList* list;
+		int present; // sync interval, -1 when the job doesn't present
+		uint64 seq;  // presented frame number
+	};
+
+	std::unique_ptr<GSJobQueue<SubmitJob, 16>> m_submit;
+	// Mailbox: only the newest queued frame is presented, at most
+	// present_queue_size frames wait for the submit thread
+	std::atomic<uint64> m_present_seq;
+	int m_present_queued; // protected by m_present_lock
+	int m_present_queue_size;
+	std::mutex m_present_lock;
+	std::condition_variable m_present_done;
+	bool m_vb_discard;
+	bool m_ib_discard;
+	size_t m_ib_stride; // sizeof(uint16) or sizeof(uint32), m_index.start counts in it
+
+	void Submit(int present = -1);
+	void ExecuteSubmit(SubmitJob& job);
+
+	// Timestamp pairs around the HW draws, used as a ring. The disjoint query
+	// of the frame gives the frequency of its timestamps.
+	struct DrawTimer
+	{
+		CComPtr<ID3D11Query> begin;
+		CComPtr<ID3D11Query> end;
+		uint32 frame; // slot of the disjoint query
+		DrawTiming timing;
+	};
+
+	struct
+	{
+		bool enabled;
+		bool open; // disjoint query of the current slot was begun
+		uint32 frame;
+		uint32 head; // next timer to begin
+		uint32 tail; // oldest timer not yet resolved
+		CComPtr<ID3D11Query> disjoint[8];
+		uint32 pending[8];
+		std::vector<DrawTimer> pool;
+	} m_draw_timer;
+
 	bool FXAA_Compiled;
 	bool ExShader_Compiled;
 
@@ -472,7 +520,7 @@ private:
 
 	struct
 	{
-		CComPtr<ID3D11PixelShader> ps[4];
+		CComPtr<ID3D11PixelShader> ps[OutputFX_Count][4];
 		CComPtr<ID3D11Buffer> cb;
 	} m_interlace;
 
@@ -488,12 +536,6 @@ private:
 		CComPtr<ID3D11Buffer> cb;
 	} m_fxaa;
 
-	struct
-	{
-		CComPtr<ID3D11PixelShader> ps;
-		CComPtr<ID3D11Buffer> cb;
-	} m_shadeboost;
-
 	struct
 	{
 		CComPtr<ID3D11DepthStencilState> dss;
@@ -528,7 +570,7 @@ protected:
 
 public:
 	GSDevice11();
-	virtual ~GSDevice11() {}
+	virtual ~GSDevice11();
 
 	bool SetFeatureLevel(D3D_FEATURE_LEVEL level, bool compat_mode);
 	void GetFeatureLevel(D3D_FEATURE_LEVEL& level) const { level = m_shader.level; }
@@ -564,8 +606,8 @@ public:
 	bool IAMapVertexBuffer(void** vertex, size_t stride, size_t count);
 	void IAUnmapVertexBuffer();
 	void IASetVertexBuffer(ID3D11Buffer* vb, size_t stride);
-	void IASetIndexBuffer(const void* index, size_t count);
-	void IASetIndexBuffer(ID3D11Buffer* ib);
+	void IASetIndexBuffer(const void* index, size_t count, size_t vertices = SIZE_MAX);
+	void IASetIndexBuffer(ID3D11Buffer* ib, DXGI_FORMAT format);
 	void IASetInputLayout(ID3D11InputLayout* layout);
 	void IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology);
 
@@ -589,6 +631,14 @@ public:
 	void SetupPS(PSSelector sel, const PSConstantBuffer* cb, PSSamplerSelector ssel);
 	void SetupOM(OMDepthStencilSelector dssel, OMBlendSelector bsel, uint8 afix);
 
+	bool BeginDrawTimer() final;
+	void EndDrawTimer(uint64 frame, uint64 shader, uint32 rt) final;
+	void ResolveDrawTimers(std::vector<DrawTiming>& timings) final;
+
+	ID3D11DeviceContext* GetContext() { return m_ctx; }
+	// Executes everything recorded so far, the immediate context is then safe to use
+	void WaitSubmission();
+
 	ID3D11Device* operator->() { return m_dev; }
 	operator ID3D11Device*() { return m_dev; }
 	operator ID3D11DeviceContext*() { return m_ctx; }
@@ -104,8 +104,10 @@ void GSRendererDX11::SetupIA(const float& sx, const float& sy)
 		dev->IAUnmapVertexBuffer();
 	}
 
-	dev->IASetIndexBuffer(m_index.buff, m_index.tail);
+	dev->IASetIndexBuffer(m_index.buff, m_index.tail, m_vertex.next);
 	dev->IASetPrimitiveTopology(t);
+
+	m_perfmon.Put(GSPerfMon::Upload, m_vertex.next * sizeof(GSVertex) + m_index.tail * (m_vertex.next <= 0x10000 ? sizeof(uint16) : sizeof(uint32)));
 }
 
 void GSRendererDX11::EmulateZbuffer()
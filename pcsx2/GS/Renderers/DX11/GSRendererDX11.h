@@ -59,5 +59,7 @@ public:
 
 	void DrawPrims(GSTexture* rt, GSTexture* ds, GSTextureCache::Source* tex) final;
 
+	uint64 GetShaderKey() const final { return m_ps_sel.key; }
+
 	bool CreateDevice(GSDevice* dev);
 };
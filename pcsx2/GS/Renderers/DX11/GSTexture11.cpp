@@ -15,10 +15,11 @@
 
 #include "PrecompiledHeader.h"
 #include "GSTexture11.h"
+#include "GSDevice11.h"
 #include "GS/GSPng.h"
 
-GSTexture11::GSTexture11(ID3D11Texture2D* texture)
-	: m_texture(texture), m_layer(0)
+GSTexture11::GSTexture11(ID3D11Texture2D* texture, GSDevice11* device)
+	: m_device(device), m_texture(texture), m_layer(0)
 {
 	ASSERT(m_texture);
 
@@ -54,7 +55,7 @@ bool GSTexture11::Update(const GSVector4i& r, const void* data, int pitch, int l
 		D3D11_BOX box = {(UINT)r.left, (UINT)r.top, 0U, (UINT)r.right, (UINT)r.bottom, 1U};
 		UINT subresource = layer; // MipSlice + (ArraySlice * MipLevels).
 
-		m_ctx->UpdateSubresource(m_texture, subresource, &box, data, pitch, 0);
+		m_device->GetContext()->UpdateSubresource(m_texture, subresource, &box, data, pitch, 0);
 
 		return true;
 	}
@@ -78,6 +79,9 @@ bool GSTexture11::Map(GSMap& m, const GSVector4i* r, int layer)
 		D3D11_MAPPED_SUBRESOURCE map;
 		UINT subresource = layer;
 
+		// The copy into the staging texture might still be in a command list
+		m_device->WaitSubmission();
+
 		if (SUCCEEDED(m_ctx->Map(m_texture, subresource, D3D11_MAP_READ_WRITE, 0, &map)))
 		{
 			m.bits = (uint8*)map.pData;
@@ -118,7 +122,8 @@ bool GSTexture11::Save(const std::string& fn)
 		return false;
 	}
 
-	m_ctx->CopyResource(res, m_texture);
+	m_device->GetContext()->CopyResource(res, m_texture);
+	m_device->WaitSubmission();
 
 	if (m_desc.BindFlags & D3D11_BIND_DEPTH_STENCIL)
 	{
@@ -191,7 +196,7 @@ bool GSTexture11::Save(const std::string& fn)
 	}
 
 	int compression = theApp.GetConfigI("png_compression_level");
-	bool success = GSPng::Save(format, fn, static_cast<uint8*>(sm.pData), desc.Width, desc.Height, sm.RowPitch, compression);
+	bool success = GSPng::SaveAsync(format, fn, static_cast<uint8*>(sm.pData), desc.Width, desc.Height, sm.RowPitch, compression);
 
 	m_ctx->Unmap(res, 0);
 
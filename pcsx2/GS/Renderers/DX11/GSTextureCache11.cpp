@@ -23,13 +23,8 @@ GSTextureCache11::GSTextureCache11(GSRenderer* r)
 {
 }
 
-void GSTextureCache11::Read(Target* t, const GSVector4i& r)
+GSTexture* GSTextureCache11::CopyTargetOffscreen(Target* t, const GSVector4i& r)
 {
-	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
-	{
-		return;
-	}
-
 	const GIFRegTEX0& TEX0 = t->m_TEX0;
 
 	DXGI_FORMAT format;
@@ -61,7 +56,7 @@ void GSTextureCache11::Read(Target* t, const GSVector4i& r)
 			break;
 
 		default:
-			return;
+			return NULL;
 	}
 
 	// printf("GSRenderTarget::Read %d,%d - %d,%d (%08x)\n", r.left, r.top, r.right, r.bottom, TEX0.TBP0);
@@ -71,42 +66,7 @@ void GSTextureCache11::Read(Target* t, const GSVector4i& r)
 
 	GSVector4 src = GSVector4(r) * GSVector4(t->m_texture->GetScale()).xyxy() / GSVector4(t->m_texture->GetSize()).xyxy();
 
-	if (GSTexture* offscreen = m_renderer->m_dev->CopyOffscreen(t->m_texture, src, w, h, format, ps_shader))
-	{
-		GSTexture::GSMap m;
-
-		if (offscreen->Map(m))
-		{
-			// TODO: block level write
-
-			GSOffset* off = m_renderer->m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
-
-			switch (TEX0.PSM)
-			{
-				case PSM_PSMCT32:
-				case PSM_PSMZ32:
-					m_renderer->m_mem.WritePixel32(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT24:
-				case PSM_PSMZ24:
-					m_renderer->m_mem.WritePixel24(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT16:
-				case PSM_PSMCT16S:
-				case PSM_PSMZ16:
-				case PSM_PSMZ16S:
-					m_renderer->m_mem.WritePixel16(m.bits, m.pitch, off, r);
-					break;
-
-				default:
-					ASSERT(0);
-			}
-
-			offscreen->Unmap();
-		}
-
-		m_renderer->m_dev->Recycle(offscreen);
-	}
+	return m_renderer->m_dev->CopyOffscreen(t->m_texture, src, w, h, format, ps_shader);
 }
 
 void GSTextureCache11::Read(Source* t, const GSVector4i& r)
@@ -31,12 +31,27 @@ GSRendererHW::GSRendererHW(GSTextureCache* tc)
 	, m_userhacks_tcoffset_x(0)
 	, m_userhacks_tcoffset_y(0)
 	, m_channel_shuffle(false)
+	, m_channel_shuffle_sig{}
 	, m_lod(GSVector2i(0, 0))
+	, m_gpu_profiling_csv(nullptr)
 {
 	m_mipmap = theApp.GetConfigI("mipmap_hw");
 	m_upscale_multiplier = theApp.GetConfigI("upscale_multiplier");
 	m_conservative_framebuffer = theApp.GetConfigB("conservative_framebuffer");
 	m_accurate_date = theApp.GetConfigB("accurate_date");
+	m_gpu_profiling = theApp.GetConfigB("gpu_draw_profiling");
+	m_keep_cache_on_load = theApp.GetConfigB("keep_cache_on_load");
+
+	if (m_gpu_profiling)
+	{
+		const std::string csv = theApp.GetConfigS("gpu_draw_profiling_csv");
+		if (!csv.empty())
+		{
+			m_gpu_profiling_csv = fopen(csv.c_str(), "w");
+			if (m_gpu_profiling_csv)
+				fprintf(m_gpu_profiling_csv, "frame,shader,fbp,psm,ms\n");
+		}
+	}
 
 	if (theApp.GetConfigB("UserHacks"))
 	{
@@ -185,6 +200,9 @@ void GSRendererHW::CustomResolutionScaling()
 
 GSRendererHW::~GSRendererHW()
 {
+	if (m_gpu_profiling_csv)
+		fclose(m_gpu_profiling_csv);
+
 	delete m_tc;
 }
 
@@ -277,7 +295,23 @@ void GSRendererHW::Reset()
 	GSRenderer::Reset();
 }
 
-void GSRendererHW::VSync(int field)
+// Savestates of the same scene leave most of the local memory as it was, so only what the
+// cache holds of the pages that changed goes, rather than all of it.
+int GSRendererHW::Defrost(const freezeData* fd)
+{
+	const bool reset = m_reset;
+	const int ret = GSRenderer::Defrost(fd);
+
+	if (ret == 0 && m_keep_cache_on_load && !reset)
+	{
+		m_reset = false;
+		m_tc->InvalidateDefrostedPages(m_defrosted_pages.data());
+	}
+
+	return ret;
+}
+
+void GSRendererHW::VSync(int field, bool present)
 {
 	//Check if the frame buffer width or display width has changed
 	SetScaling();
@@ -289,7 +323,13 @@ void GSRendererHW::VSync(int field)
 		m_reset = false;
 	}
 
-	GSRenderer::VSync(field);
+	// Don't keep draws of the previous frame held back (frame skip doesn't present)
+	m_dev->FlushBatch();
+
+	GSRenderer::VSync(field, present);
+
+	if (m_gpu_profiling)
+		UpdateGPUProfile();
 
 	m_tc->IncAge();
 
@@ -300,6 +340,63 @@ void GSRendererHW::VSync(int field)
 	m_skip_offset = 0;
 }
 
+void GSRendererHW::UpdateGPUProfile()
+{
+	std::vector<GSDevice::DrawTiming> timings;
+	m_dev->ResolveDrawTimers(timings);
+
+	for (const auto& t : timings)
+	{
+		DrawProfile& ps = m_gpu_profile_ps[t.shader];
+		ps.count++;
+		ps.ms += t.ms;
+
+		DrawProfile& rt = m_gpu_profile_rt[t.rt];
+		rt.count++;
+		rt.ms += t.ms;
+
+		m_perfmon.Put(GSPerfMon::GPUTime, t.ms);
+
+		if (m_gpu_profiling_csv)
+			fprintf(m_gpu_profiling_csv, "%lld,%016llx,%05x,%s,%.4f\n", t.frame, t.shader, t.rt >> 6, psm_str(t.rt & 0x3F), t.ms);
+	}
+
+	// Refresh the top list at the rate of the others monitored values
+	if ((m_perfmon.GetFrame() & 0x1f) != 0)
+		return;
+
+	const int top = 5;
+	const double frames = 32.0;
+
+	std::vector<std::pair<uint64, DrawProfile>> ps(m_gpu_profile_ps.begin(), m_gpu_profile_ps.end());
+	std::vector<std::pair<uint32, DrawProfile>> rt(m_gpu_profile_rt.begin(), m_gpu_profile_rt.end());
+
+	auto slower = [](const auto& a, const auto& b) { return a.second.ms > b.second.ms; };
+	std::sort(ps.begin(), ps.end(), slower);
+	std::sort(rt.begin(), rt.end(), slower);
+
+	for (int i = 0; i < top; i++)
+	{
+		std::string value;
+
+		if (i < (int)ps.size())
+			value = format("%016llx %.3f ms (%d draws)", ps[i].first, ps[i].second.ms / frames, (int)(ps[i].second.count / frames));
+		m_dev->m_osd.Monitor(format("GPU PS #%d", i + 1).c_str(), value.c_str());
+
+		value.clear();
+
+		if (i < (int)rt.size())
+			value = format("%05x %s %.3f ms (%d draws)", rt[i].first >> 6, psm_str(rt[i].first & 0x3F), rt[i].second.ms / frames, (int)(rt[i].second.count / frames));
+		m_dev->m_osd.Monitor(format("GPU RT #%d", i + 1).c_str(), value.c_str());
+	}
+
+	m_gpu_profile_ps.clear();
+	m_gpu_profile_rt.clear();
+
+	if (m_gpu_profiling_csv)
+		fflush(m_gpu_profiling_csv);
+}
+
 void GSRendererHW::ResetDevice()
 {
 	m_tc->RemoveAll();
@@ -777,7 +874,10 @@ void GSRendererHW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 {
 	// printf("[%d] InvalidateVideoMem %d,%d - %d,%d %05x (%d)\n", (int)m_perfmon.GetFrame(), r.left, r.top, r.right, r.bottom, (int)BITBLTBUF.DBP, (int)BITBLTBUF.DPSM);
 
-	m_tc->InvalidateVideoMem(m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM), r);
+	GSOffset* off = m_mem.GetOffset(BITBLTBUF.DBP, BITBLTBUF.DBW, BITBLTBUF.DPSM);
+
+	m_tc->InvalidateVideoMem(off, r);
+	m_tc->InvalidateLocalMemoryMirror(off, r);
 }
 
 void GSRendererHW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut)
@@ -1182,6 +1282,19 @@ void GSRendererHW::RoundSpriteOffset()
 	}
 }
 
+GSRendererHW::ShuffleSignature GSRendererHW::GetShuffleSignature() const
+{
+	GIFRegTEX0 TEX0 = m_context->TEX0;
+	TEX0.TBP0 = 0;
+
+	ShuffleSignature sig;
+	sig.TEX0 = TEX0.u64;
+	sig.FRAME = m_context->FRAME.u64;
+	sig.PRIM = PRIM->u32[0];
+	sig.count = m_vertex.next;
+	return sig;
+}
+
 void GSRendererHW::Draw()
 {
 	if (m_dev->IsLost() || IsBadFrame())
@@ -1191,6 +1304,20 @@ void GSRendererHW::Draw()
 	}
 	GL_PUSH("HW Draw %d", s_n);
 
+	// Raw registers, before the TEX0 fix and the alpha test optimization change them
+	const ShuffleSignature shuffle_sig = GetShuffleSignature();
+
+	if (m_channel_shuffle && shuffle_sig == m_channel_shuffle_sig)
+	{
+		// Same decision as the detection below, which the recorded draw already passed
+		const GSVector4 delta_p = m_vt.m_max.p - m_vt.m_min.p;
+		if ((delta_p.x <= 64.0f) && (delta_p.y <= 64.0f))
+		{
+			GL_CACHE("Channel shuffle sequence SKIP");
+			return;
+		}
+	}
+
 	const GSDrawingEnvironment& env = m_env;
 	GSDrawingContext* context = m_context;
 	const GSLocalMemory::psm_t& tex_psm = GSLocalMemory::m_psm[m_context->TEX0.PSM];
@@ -1291,6 +1418,8 @@ void GSRendererHW::Draw()
 		ds_tex = ds->m_texture;
 	}
 
+	m_tc->ScheduleReadbacks(rt);
+
 	m_src = nullptr;
 	m_texture_shuffle = false;
 
@@ -1386,7 +1515,23 @@ void GSRendererHW::Draw()
 		m_src = tex_psm.depth ? m_tc->LookupDepthSource(TEX0, env.TEXA, r) : m_tc->LookupSource(TEX0, env.TEXA, r);
 
 		// Round 2
-		if (IsMipMapActive() && m_mipmap == 2 && !tex_psm.depth)
+		bool gpu_mips = false;
+
+		if (IsMipMapActive() && m_mipmap == 2 && !tex_psm.depth && !m_src->m_palette)
+		{
+			GIFRegTEX0 layers[7];
+			int count = 0;
+
+			for (int layer = m_lod.x; layer <= m_lod.y && count < 7; layer++)
+				layers[count++] = GetTex0Layer(layer);
+
+			gpu_mips = m_tc->MipsFromBase(layers, count, env.TEXA);
+
+			if (gpu_mips)
+				m_src->GenerateLayers();
+		}
+
+		if (IsMipMapActive() && m_mipmap == 2 && !tex_psm.depth && !gpu_mips)
 		{
 			// Upload remaining texture layers
 			const GSVector4 tmin = m_vt.m_min.t;
@@ -1411,6 +1556,8 @@ void GSRendererHW::Draw()
 				m_src->UpdateLayer(MIP_TEX0, r, layer - m_lod.x);
 			}
 
+			m_src->FlushLayers();
+
 			m_vt.m_min.t = tmin;
 			m_vt.m_max.t = tmax;
 		}
@@ -1600,8 +1747,17 @@ void GSRendererHW::Draw()
 
 	//
 
+	const bool gpu_timer = m_gpu_profiling && m_dev->BeginDrawTimer();
+
 	DrawPrims(rt_tex, ds_tex, m_src);
 
+	if (gpu_timer)
+		m_dev->EndDrawTimer(m_perfmon.GetFrame(), GetShaderKey(), (FRAME.Block() << 6) | FRAME.PSM);
+
+	// The backend clears m_channel_shuffle when it can't emulate the effect
+	if (m_channel_shuffle)
+		m_channel_shuffle_sig = shuffle_sig;
+
 	//
 
 	context->TEST = TEST;
@@ -1625,7 +1781,7 @@ void GSRendererHW::Draw()
 	if (fm != 0xffffffff && rt)
 	{
 		//rt->m_valid = rt->m_valid.runion(r);
-		rt->UpdateValidity(m_r);
+		m_tc->UpdateTargetValidity(rt, m_r);
 
 		m_tc->InvalidateVideoMem(context->offset.fb, m_r, false);
 
@@ -1635,7 +1791,7 @@ void GSRendererHW::Draw()
 	if (zm != 0xffffffff && ds)
 	{
 		//ds->m_valid = ds->m_valid.runion(r);
-		ds->UpdateValidity(m_r);
+		m_tc->UpdateTargetValidity(ds, m_r);
 
 		m_tc->InvalidateVideoMem(context->offset.zb, m_r, false);
 
@@ -1815,6 +1971,8 @@ void GSRendererHW::OI_GsMemClear()
 		GL_INS("OI_GsMemClear (%d,%d => %d,%d)", r.x, r.y, r.z, r.w);
 		const int format = GSLocalMemory::m_psm[m_context->FRAME.PSM].fmt;
 
+		m_tc->InvalidateLocalMemoryMirror(off, r);
+
 		// FIXME: loop can likely be optimized with AVX/SSE. Pixels aren't
 		// linear but the value will be done for all pixels of a block.
 		// FIXME: maybe we could limit the write to the top and bottom row page.
@@ -2101,7 +2259,7 @@ bool GSRendererHW::OI_MetalSlug6(GSTexture* rt, GSTexture* ds, GSTextureCache::S
 		}
 	}
 
-	m_vt.Update(m_vertex.buff, m_index.buff, m_vertex.tail, m_index.tail, m_vt.m_primclass);
+	m_vt.Update(m_vertex.buff, m_index.buff, m_vertex.next, m_index.tail, m_vt.m_primclass);
 
 	return true;
 }
@@ -2217,6 +2375,7 @@ bool GSRendererHW::OI_PointListPalette(GSTexture* rt, GSTexture* ds, GSTextureCa
 					m_mem.WritePixel32(i & 7, i >> 3, c, FBP, FBW);
 				}
 
+				m_tc->InvalidateLocalMemoryMirror(m_mem.GetOffset(FBP, FBW, PSM_PSMCT32), GSVector4i(0, 0, 8, 2));
 				m_mem.m_clut.Invalidate();
 
 				return false;
@@ -2237,6 +2396,7 @@ bool GSRendererHW::OI_PointListPalette(GSTexture* rt, GSTexture* ds, GSTextureCa
 					m_mem.WritePixel32(i & 15, i >> 4, c, FBP, FBW);
 				}
 
+				m_tc->InvalidateLocalMemoryMirror(m_mem.GetOffset(FBP, FBW, PSM_PSMCT32), GSVector4i(0, 0, 16, 16));
 				m_mem.m_clut.Invalidate();
 
 				return false;
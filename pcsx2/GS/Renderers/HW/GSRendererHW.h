@@ -27,6 +27,7 @@ private:
 	int m_custom_width;
 	int m_custom_height;
 	bool m_reset;
+	bool m_keep_cache_on_load;
 	int m_upscale_multiplier;
 	int m_userhacks_ts_half_bottom;
 
@@ -161,9 +162,41 @@ protected:
 
 	bool m_channel_shuffle;
 
+	// Registers of the draws of a channel shuffle that was emulated with a single full target
+	// pass. The next draws of the sequence only move to another page, they are dropped before
+	// any other work.
+	struct ShuffleSignature
+	{
+		uint64 TEX0; // TBP0 is masked
+		uint64 FRAME;
+		uint32 PRIM;
+		uint32 count;
+
+		bool operator==(const ShuffleSignature& s) const { return TEX0 == s.TEX0 && FRAME == s.FRAME && PRIM == s.PRIM && count == s.count; }
+	};
+
+	ShuffleSignature m_channel_shuffle_sig;
+	ShuffleSignature GetShuffleSignature() const;
+
 	GSVector2i m_lod; // Min & Max level of detail
 	void CustomResolutionScaling();
 
+	// GPU draw profiling, aggregated per pixel shader and per render target
+	struct DrawProfile
+	{
+		uint32 count;
+		double ms;
+	};
+
+	bool m_gpu_profiling;
+	FILE* m_gpu_profiling_csv;
+	std::unordered_map<uint64, DrawProfile> m_gpu_profile_ps;
+	std::unordered_map<uint32, DrawProfile> m_gpu_profile_rt;
+	void UpdateGPUProfile();
+
+	// Pixel shader selector of the last DrawPrims
+	virtual uint64 GetShaderKey() const { return 0; }
+
 public:
 	GSRendererHW(GSTextureCache* tc);
 	virtual ~GSRendererHW();
@@ -181,7 +214,8 @@ public:
 	void MergeSprite(GSTextureCache::Source* tex);
 
 	void Reset();
-	void VSync(int field);
+	int Defrost(const freezeData* fd);
+	void VSync(int field, bool present);
 	void ResetDevice();
 	GSTexture* GetOutput(int i, int& y_offset);
 	GSTexture* GetFeedbackOutput();
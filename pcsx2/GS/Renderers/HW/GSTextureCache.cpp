@@ -47,16 +47,43 @@ GSTextureCache::GSTextureCache(GSRenderer* r)
 	}
 
 	m_paltex = theApp.GetConfigB("paltex");
+
+	// Mipmap layers are uploaded in the source texture, so it can't be shared
+	m_hash_cache_enabled = theApp.GetConfigB("texture_hash_cache") && theApp.GetConfigI("mipmap_hw") != static_cast<int>(HWMipmapLevel::Full);
+	m_hash_cache_budget = static_cast<uint64>(std::max(theApp.GetConfigI("texture_hash_cache_size"), 0)) * 1024 * 1024;
+	m_hash_cache_memory_usage = 0;
+
+	// Same limitation as the hash cache, the replacements have no mip levels
+	const std::string replacement_dir = theApp.GetConfigS("texture_replacement_dir");
+	if (!replacement_dir.empty() && theApp.GetConfigI("mipmap_hw") != static_cast<int>(HWMipmapLevel::Full))
+		m_replacements = std::unique_ptr<GSTextureReplacements>(new GSTextureReplacements(r->m_dev, replacement_dir));
+
+	m_vram_budget = static_cast<uint64>(std::max(theApp.GetConfigI("vram_budget"), 0)) * 1024 * 1024;
+	m_vram_usage_peak = 0;
+
+	m_async_readback = theApp.GetConfigI("async_readback");
+	m_gpu_mipmap = theApp.GetConfigB("mipmap_gpu_generate");
+	m_readback_last_rt = NULL;
+	m_dirty_stats.added = 0;
+	m_dirty_stats.merged = 0;
 	m_crc_hack_level = theApp.GetConfigT<CRCHackLevel>("crc_hack_level");
 	if (m_crc_hack_level == CRCHackLevel::Automatic)
 		m_crc_hack_level = GSUtil::GetRecommendedCRCHackLevel(theApp.GetCurrentRendererType());
 
-	// In theory 4MB is enough but 9MB is safer for overflow (8MB
-	// isn't enough in custom resolution)
-	// Test: onimusha 3 PAL 60Hz
-	m_temp = (uint8*)_aligned_malloc(9 * 1024 * 1024, 32);
+	m_temp = (uint8*)_aligned_malloc(TEMP_SIZE, 32);
 
-	m_texture_inside_rt_cache.reserve(m_texture_inside_rt_cache_size);
+	m_target_id = 0;
+	m_texture_inside_rt_stats.hits = 0;
+	m_texture_inside_rt_stats.misses = 0;
+
+	GSLocalMemory* mem = &r->m_mem;
+	const int threads = std::max(theApp.GetConfigI("texture_unswizzle_threads"), 0);
+
+	for (int i = 0; i < threads; i++)
+	{
+		m_unswizzle_workers.push_back(std::unique_ptr<UnswizzleWorker>(new UnswizzleWorker(
+			[mem](UnswizzleJob& job) { (mem->*job.rtx)(job.off, job.r, job.dst, job.pitch, job.TEXA); })));
+	}
 }
 
 GSTextureCache::~GSTextureCache()
@@ -65,6 +92,10 @@ GSTextureCache::~GSTextureCache()
 
 	m_texture_inside_rt_cache.clear();
 
+	m_unswizzle_workers.clear();
+
+	m_replacements.reset();
+
 	_aligned_free(m_temp);
 }
 
@@ -78,21 +109,38 @@ void GSTextureCache::RemovePartial()
 			delete t;
 
 		m_dst[type].clear();
+		m_dst_map[type].RemoveAll();
 	}
+
+	m_texture_inside_rt_cache.clear();
 }
 
 void GSTextureCache::RemoveAll()
 {
 	m_src.RemoveAll();
 
+	// The local memory itself could have been reloaded (savestate)
+	InvalidateLocalMemoryMirror(nullptr, GSVector4i::zero());
+
+	for (auto& it : m_hash_cache)
+		m_renderer->m_dev->Recycle(it.second.texture);
+
+	m_hash_cache.clear();
+	m_hash_cache_memory_usage = 0;
+
 	for (int type = 0; type < 2; type++)
 	{
 		for (auto t : m_dst[type])
 			delete t;
 
 		m_dst[type].clear();
+		m_dst_map[type].RemoveAll();
 	}
 
+	m_texture_inside_rt_cache.clear();
+
+	m_readback_last_rt = NULL;
+
 	m_palette_map.Clear();
 }
 
@@ -163,7 +211,7 @@ GSTextureCache::Source* GSTextureCache::LookupDepthSource(const GIFRegTEX0& TEX0
 			TEX0.TBP0, psm_str(psm));
 
 		// Create a shared texture source
-		src = new Source(m_renderer, TEX0, TEXA, m_temp, true);
+		src = new Source(m_renderer, TEX0, TEXA, m_temp, &m_unswizzle_workers, true);
 		src->m_texture = dst->m_texture;
 		src->m_shared_texture = true;
 		src->m_target = true; // So renderer can check if a conversion is required
@@ -224,7 +272,8 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 	if (psm_s.pal > 0)
 		m_renderer->m_mem.m_clut.Read32(TEX0, TEXA);
 
-	const uint32* clut = m_renderer->m_mem.m_clut;
+	// The clut hash is cached by GSClut until the next CLUT load
+	const PaletteKey palette_key = {m_renderer->m_mem.m_clut, psm_s.pal, psm_s.pal > 0 ? m_renderer->m_mem.m_clut.GetPaletteHash(psm_s.pal) : 0};
 
 	Source* src = NULL;
 
@@ -243,7 +292,7 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 			// We request a palette texture (psm_s.pal). If the texture was
 			// converted by the CPU (!s->m_palette), we need to ensure
 			// palette content is the same.
-			if (psm_s.pal > 0 && !s->m_palette && !s->ClutMatch({clut, psm_s.pal}))
+			if (psm_s.pal > 0 && !s->m_palette && !s->ClutMatch(palette_key))
 				continue;
 
 			// We request a 24/16 bit RGBA texture. Alpha expansion was done by
@@ -336,11 +385,14 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 					bool valid_offset_may_exist = true;
 
 					// CACHE SEARCH: <x,y> offset
-					for (auto& el : m_texture_inside_rt_cache)
+					std::vector<TexInsideRtCacheEntry>& cache = m_texture_inside_rt_cache[t->m_id];
+
+					for (auto& el : cache)
 					{
-						if (el.psm == psm && el.bp == bp && el.bp_end == bp_end && el.bw == bw &&
-							el.t_tex0_tbp0 == t->m_TEX0.TBP0 && el.m_end_block == t->m_end_block)
+						if (el.psm == psm && el.bp == bp && el.bp_end == bp_end && el.bw == bw && el.m_end_block == t->m_end_block)
 						{
+							m_texture_inside_rt_stats.hits++;
+
 							if (el.has_valid_offset)
 							{
 								// CACHE HIT: <x,y> offset found
@@ -365,10 +417,18 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 						continue;
 
 					// CACHE MISS
+					m_texture_inside_rt_stats.misses++;
+
+					// Mostly results of older validities of the target
+					if (cache.size() >= m_texture_inside_rt_cache_size)
+					{
+						GL_PERF("TC tex in rt: Size of cache %d too big, clearing it.", cache.size());
+						cache.clear();
+					}
 
 					// SWEEP SEARCH: <x,y> offset
 
-					TexInsideRtCacheEntry entry = {psm, bp, bp_end, bw, t->m_TEX0.TBP0, t->m_end_block, false, 0, 0};
+					TexInsideRtCacheEntry entry = {psm, bp, bp_end, bw, t->m_end_block, false, 0, 0};
 
 					for (int candidate_x_offset = 0; candidate_x_offset < t->m_valid.z; ++candidate_x_offset)
 					{
@@ -385,17 +445,12 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 								y_offset = candidate_y_offset;
 
 								// Add result to cache
-								while (m_texture_inside_rt_cache.size() > m_texture_inside_rt_cache_size)
-								{
-									GL_PERF("TC tex in rt: Size of cache %d too big, clearing it.", m_texture_inside_rt_cache.size());
-									m_texture_inside_rt_cache.clear();
-								}
 								entry.has_valid_offset = true;
 								entry.x_offset = x_offset;
 								entry.y_offset = y_offset;
-								m_texture_inside_rt_cache.emplace_back(entry);
+								cache.emplace_back(entry);
 								GL_CACHE("TC tex in rt: Cached HIT element (size %d), BW: %d, PSM %s, rt 0x%x <%d,%d> + off <%d,%d> -> 0x%x <%d,%d> (END: 0x%x)",
-									m_texture_inside_rt_cache.size(), bw, psm_str(psm), t->m_TEX0.TBP0, t->m_valid.z, t->m_valid.w, x_offset, y_offset, bp, tw, th, bp_end);
+									cache.size(), bw, psm_str(psm), t->m_TEX0.TBP0, t->m_valid.z, t->m_valid.w, x_offset, y_offset, bp, tw, th, bp_end);
 								break;
 							}
 						}
@@ -406,14 +461,9 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 						break;
 
 					// SWEEP MISS: no valid <x,y> offset found
-					while (m_texture_inside_rt_cache.size() > m_texture_inside_rt_cache_size)
-					{
-						GL_PERF("TC tex in rt: Size of cache %d too big, clearing it.", m_texture_inside_rt_cache.size());
-						m_texture_inside_rt_cache.clear();
-					}
 					GL_CACHE("TC tex in rt: Cached MISS element (size %d), BW: %d, PSM %s, rt 0x%x <%d,%d> -/-> 0x%x <%d,%d> (END: 0x%x)",
-						m_texture_inside_rt_cache.size(), bw, psm_str(psm), t->m_TEX0.TBP0, t->m_valid.z, t->m_valid.w, bp, tw, th, bp_end);
-					m_texture_inside_rt_cache.emplace_back(entry);
+						cache.size(), bw, psm_str(psm), t->m_TEX0.TBP0, t->m_valid.z, t->m_valid.w, bp, tw, th, bp_end);
+					cache.emplace_back(entry);
 				}
 			}
 		}
@@ -482,11 +532,16 @@ GSTextureCache::Source* GSTextureCache::LookupSource(const GIFRegTEX0& TEX0, con
 			psm_str(TEX0.PSM));
 	}
 
-	if (src->m_palette && !new_source && !src->ClutMatch({clut, psm_s.pal}))
+	if (src->m_palette && !new_source && !src->ClutMatch(palette_key))
 	{
 		AttachPaletteToSource(src, psm_s.pal, true);
 	}
 
+	if (src->m_replacement_pending)
+	{
+		ReplaceSourceTexture(src);
+	}
+
 	src->Update(r);
 
 	m_src.m_used = true;
@@ -540,6 +595,7 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 			dst = t;
 
 			dst->m_32_bits_fmt |= (psm_s.bpp != 16);
+			SetTargetTBW(dst, TEX0.TBW);
 			dst->m_TEX0 = TEX0;
 
 			break;
@@ -630,7 +686,7 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 			// h is likely smaller than w (true most of the time). Reduce the upload size (speed)
 			max_h = std::min<int>(max_h, TEX0.TBW * 64);
 
-			dst->m_dirty.push_back(GSDirtyRect(GSVector4i(0, 0, TEX0.TBW * 64, max_h), TEX0.PSM));
+			AddDirtyRect(dst, GSDirtyRect(GSVector4i(0, 0, TEX0.TBW * 64, max_h), TEX0.PSM));
 			dst->Update();
 		}
 		else
@@ -650,6 +706,8 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 		dst->m_used = true;
 	}
 
+	dst->m_write_count++;
+
 	return dst;
 }
 
@@ -753,7 +811,7 @@ GSTextureCache::Target* GSTextureCache::LookupTarget(const GIFRegTEX0& TEX0, int
 			// Code is more or less an equivalent of the SW renderer
 			//
 			// Option is hidden and not enabled by default to avoid any regression
-			dst->m_dirty.push_back(GSDirtyRect(GSVector4i(0, 0, TEX0.TBW * 64, real_h), TEX0.PSM));
+			AddDirtyRect(dst, GSDirtyRect(GSVector4i(0, 0, TEX0.TBW * 64, real_h), TEX0.PSM));
 			dst->Update();
 		}
 	}
@@ -788,6 +846,8 @@ void GSTextureCache::InvalidateVideoMemType(int type, uint32 bp)
 				t->m_TEX0.TBP0);
 
 			list.erase(i);
+			m_dst_map[type].Remove(t);
+			InvalidateTextureInsideRt(t);
 			delete t;
 
 			break;
@@ -895,12 +955,16 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 				if (!s->m_target)
 				{
-					if (m_disable_partial_invalidation && s->m_repeating)
+					// Hashed and replaced textures are shared, the data can't be partially refreshed
+					if (s->m_from_hash_cache || s->m_replaced || (m_disable_partial_invalidation && s->m_repeating))
 					{
 						m_src.RemoveAt(s);
 					}
 					else
 					{
+						// The content doesn't match the key of the replacement anymore
+						s->m_replacement_pending = false;
+
 						uint32* RESTRICT valid = s->m_valid;
 
 						// Invalidate data of input texture
@@ -944,12 +1008,11 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 
 	for (int type = 0; type < 2; type++)
 	{
-		auto& list = m_dst[type];
-		for (auto i = list.begin(); i != list.end();)
-		{
-			auto j = i++;
-			Target* t = *j;
+		// Only check the targets located on the written pages (or starting on the page of bp)
+		m_dst_map[type].Lookup(pages, bp, m_dst_lookup);
 
+		for (Target* t : m_dst_lookup)
+		{
 			// GH: (I think) this code is completely broken. Typical issue:
 			// EE write an alpha channel into 32 bits texture
 			// Results: the target is deleted (because HasCompatibleBits is false)
@@ -964,16 +1027,15 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 					GL_CACHE("TC: Dirty Target(%s) %d (0x%x) r(%d,%d,%d,%d)", to_string(type),
 						t->m_texture ? t->m_texture->GetID() : 0,
 						t->m_TEX0.TBP0, r.x, r.y, r.z, r.w);
-					t->m_dirty.push_back(GSDirtyRect(r, psm));
-					t->m_TEX0.TBW = bw;
+					AddDirtyRect(t, GSDirtyRect(r, psm));
+					SetTargetTBW(t, bw);
 				}
 				else
 				{
-					list.erase(j);
 					GL_CACHE("TC: Remove Target(%s) %d (0x%x)", to_string(type),
 						t->m_texture ? t->m_texture->GetID() : 0,
 						t->m_TEX0.TBP0);
-					delete t;
+					RemoveTarget(t);
 					continue;
 				}
 			}
@@ -1004,8 +1066,8 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 								t->m_texture ? t->m_texture->GetID() : 0,
 								t->m_TEX0.TBP0);
 							// TODO: do not add this rect above too
-							t->m_dirty.push_back(GSDirtyRect(GSVector4i(r.left, r.top - y, r.right, r.bottom - y), psm));
-							t->m_TEX0.TBW = bw;
+							AddDirtyRect(t, GSDirtyRect(GSVector4i(r.left, r.top - y, r.right, r.bottom - y), psm));
+							SetTargetTBW(t, bw);
 							continue;
 						}
 					}
@@ -1032,8 +1094,8 @@ void GSTextureCache::InvalidateVideoMem(GSOffset* off, const GSVector4i& rect, b
 							t->m_TEX0.TBP0, t->m_end_block,
 							r.left, r.top + y, r.right, r.bottom + y, bw);
 
-						t->m_dirty.push_back(GSDirtyRect(GSVector4i(r.left, r.top + y, r.right, r.bottom + y), psm));
-						t->m_TEX0.TBW = bw;
+						AddDirtyRect(t, GSDirtyRect(GSVector4i(r.left, r.top + y, r.right, r.bottom + y), psm));
+						SetTargetTBW(t, bw);
 						continue;
 					}
 				}
@@ -1073,7 +1135,8 @@ void GSTextureCache::InvalidateLocalMem(GSOffset* off, const GSVector4i& r)
 	// It works for all the games mentioned below and fixes a couple of other ones as well
 	// (Busen0: Wizardry and Chaos Legion).
 	// Also in a few games the below code ran the Grandia3 case when it shouldn't :p
-	for (auto t : m_dst[RenderTarget])
+	// Note: HasSharedBits requires the same base pointer, so only the targets of the bp page are checked
+	for (auto t : m_dst_map[RenderTarget].m_map[bp >> 5])
 	{
 		if (t->m_TEX0.PSM != PSM_PSMZ32 && t->m_TEX0.PSM != PSM_PSMZ24 && t->m_TEX0.PSM != PSM_PSMZ16 && t->m_TEX0.PSM != PSM_PSMZ16S)
 		{
@@ -1199,6 +1262,8 @@ void GSTextureCache::InvalidateVideoMemSubTarget(GSTextureCache::Target* rt)
 				rt->m_TEX0.TBP0, rt->m_end_block, t->m_TEX0.TBP0, t->m_end_block);
 
 			i = list.erase(i);
+			m_dst_map[RenderTarget].Remove(t);
+			InvalidateTextureInsideRt(t);
 			delete t;
 		}
 		else
@@ -1236,6 +1301,15 @@ void GSTextureCache::IncAge()
 
 	m_src.m_used = false;
 
+	for (auto& it : m_hash_cache)
+	{
+		if (it.second.refcount == 0)
+			it.second.age++;
+	}
+
+	// Drop the textures that weren't reused for a long time, and keep the cache within the budget
+	EvictHashCache(m_hash_cache_budget);
+
 	// Clearing of Rendertargets causes flickering in many scene transitions.
 	// Sigh, this seems to be used to invalidate surfaces. So set a huge maxage to avoid flicker,
 	// but still invalidate surfaces. (Disgaea 2 fmv when booting the game through the BIOS)
@@ -1259,6 +1333,8 @@ void GSTextureCache::IncAge()
 				t->m_32_bits_fmt = false;
 			}
 
+			t->m_readback.age++;
+
 			if (++t->m_age > maxage)
 			{
 				i = list.erase(i);
@@ -1266,6 +1342,8 @@ void GSTextureCache::IncAge()
 					t->m_texture ? t->m_texture->GetID() : 0,
 					t->m_TEX0.TBP0);
 
+				m_dst_map[type].Remove(t);
+				InvalidateTextureInsideRt(t);
 				delete t;
 			}
 			else
@@ -1274,13 +1352,307 @@ void GSTextureCache::IncAge()
 			}
 		}
 	}
+
+	EnforceVRAMBudget();
+}
+
+void GSTextureCache::EnforceVRAMBudget()
+{
+	// The surfaces that weren't used for the longest time are removed first
+	struct LRUEntry
+	{
+		int age;
+		uint32 size;
+		Source* s;
+		Target* t;
+	};
+
+	std::vector<LRUEntry> lru;
+
+	uint64 usage = m_hash_cache_memory_usage + m_palette_map.GetMemUsage();
+
+	if (m_replacements)
+		usage += m_replacements->GetMemUsage();
+
+	// Target textures that sources still point to, through m_from_target or a shared texture
+	std::unordered_map<GSTexture*, uint32> target_refs;
+
+	for (auto s : m_src.m_surfaces)
+	{
+		if (s->m_from_target)
+			target_refs[s->m_from_target]++;
+
+		// Shared textures are accounted on their owner
+		if (s->m_shared_texture)
+			target_refs[s->m_texture]++;
+
+		if (s->m_shared_texture || s->m_from_hash_cache || s->m_replaced || !s->m_texture)
+			continue;
+
+		const uint32 size = s->m_texture->GetMemUsage();
+		usage += size;
+		lru.push_back({s->m_age, size, s, nullptr});
+	}
+
+	for (int type = 0; type < 2; type++)
+	{
+		for (auto t : m_dst[type])
+		{
+			if (!t->m_texture)
+				continue;
+
+			// The cached depth conversion goes with its target
+			uint32 size = t->m_texture->GetMemUsage();
+			if (t->m_convert.texture)
+				size += t->m_convert.texture->GetMemUsage();
+
+			usage += size;
+			lru.push_back({t->m_age, size, nullptr, t});
+		}
+	}
+
+	if (m_vram_budget > 0 && usage > m_vram_budget)
+	{
+		// Unused hashed textures are the cheapest to drop
+		if (m_hash_cache_memory_usage > 0)
+		{
+			const uint64 before = m_hash_cache_memory_usage;
+			EvictHashCache(0);
+			usage -= before - m_hash_cache_memory_usage;
+		}
+
+		std::sort(lru.begin(), lru.end(), [](const LRUEntry& a, const LRUEntry& b) { return a.age > b.age; });
+
+		for (const LRUEntry& e : lru)
+		{
+			// Surfaces of the last frame are still needed, let the driver page them
+			if (usage <= m_vram_budget || e.age <= 1)
+				break;
+
+			if (e.s)
+			{
+				if (e.s->m_from_target)
+					target_refs[e.s->m_from_target]--;
+
+				GL_CACHE("TC: Remove Source due to VRAM budget: %d (age %d)", e.s->m_texture->GetID(), e.age);
+				m_src.RemoveAt(e.s);
+			}
+			else
+			{
+				// Keep the targets that a source still reads from, they go once the source is gone.
+				// Their cached depth conversion can go now, it is only a copy.
+				auto ref = target_refs.find(e.t->m_texture);
+				if (ref != target_refs.end() && ref->second > 0)
+				{
+					if (GSTexture* cTex = e.t->m_convert.texture)
+					{
+						usage -= cTex->GetMemUsage();
+						m_renderer->m_dev->Recycle(cTex);
+						e.t->m_convert.texture = NULL;
+					}
+					continue;
+				}
+
+				GL_CACHE("TC: Remove Target(%s) due to VRAM budget: %d (age %d)", to_string(e.t->m_type), e.t->m_texture->GetID(), e.age);
+				RemoveTarget(e.t);
+			}
+
+			usage -= e.size;
+		}
+	}
+
+	m_vram_usage_peak = std::max(m_vram_usage_peak, usage);
+
+	m_renderer->m_perfmon.Set(GSPerfMon::TextureMemory, static_cast<double>(usage));
+	m_renderer->m_perfmon.Set(GSPerfMon::TextureMemoryPeak, static_cast<double>(m_vram_usage_peak));
+}
+
+uint64 GSTextureCache::HashSourceMemory(const GIFRegTEX0& TEX0) const
+{
+	const GSVector2i& bs = GSLocalMemory::m_psm[TEX0.PSM].bs;
+	const GSOffset* off = m_renderer->m_context->offset.tex;
+	const uint8* vm = m_renderer->m_mem.m_vm8;
+
+	int tw = std::max<int>(1 << TEX0.TW, bs.x);
+	int th = std::max<int>(1 << TEX0.TH, bs.y);
+
+	// FNV-1a, one 64 bits word at a time
+	uint64 hash = 0xcbf29ce484222325ull;
+
+	for (int y = 0; y < th; y += bs.y)
+	{
+		uint32 base = off->block.row[y >> 3u];
+
+		for (int x = 0; x < tw; x += bs.x)
+		{
+			uint32 block = base + off->block.col[x >> 3u];
+
+			// Same rule as Source::Update, blocks outside of the GS memory aren't uploaded
+			if (block < MAX_BLOCKS || m_wrap_gs_mem)
+			{
+				const uint64* RESTRICT data = reinterpret_cast<const uint64*>(&vm[(block % MAX_BLOCKS) << 8]);
+
+				for (int i = 0; i < 256 / 8; i++)
+					hash = (hash ^ data[i]) * 0x100000001b3ull;
+			}
+			else
+			{
+				hash = (hash ^ 0xffffffffffffffffull) * 0x100000001b3ull;
+			}
+		}
+	}
+
+	return hash;
+}
+
+GSTextureCache::HashCacheKey GSTextureCache::GetHashCacheKey(const Source* src) const
+{
+	const GIFRegTEX0& TEX0 = src->m_TEX0;
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[TEX0.PSM];
+
+	GIFRegTEX0 layout;
+	layout.u64 = 0;
+	layout.TBW = TEX0.TBW;
+	layout.PSM = TEX0.PSM;
+	layout.TW = TEX0.TW;
+	layout.TH = TEX0.TH;
+
+	HashCacheKey key;
+	key.TEX0 = layout.u64;
+	key.TEXA = 0;
+	key.hash = HashSourceMemory(TEX0);
+
+	if (psm.pal == 0)
+	{
+		// TEXA is only used to expand 24/16 bits colors
+		if (psm.fmt == 1 || psm.fmt == 2)
+			key.TEXA = src->m_TEXA.u64;
+	}
+	else if (!m_paltex)
+	{
+		// The CLUT is applied on the texture data, it takes the place of TEXA
+		const uint32* clut = (const uint32*)m_renderer->m_mem.m_clut;
+
+		key.TEXA = 0xcbf29ce484222325ull;
+		for (uint16 i = 0; i < psm.pal; i++)
+			key.TEXA = (key.TEXA ^ clut[i]) * 0x100000001b3ull;
+	}
+
+	return key;
+}
+
+void GSTextureCache::AttachHashCacheTexture(Source* src, const HashCacheKey& key)
+{
+	const GIFRegTEX0& TEX0 = src->m_TEX0;
+	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[TEX0.PSM];
+
+	auto it = m_hash_cache.find(key);
+
+	if (it != m_hash_cache.end())
+	{
+		HashCacheEntry& e = it->second;
+
+		GL_CACHE("TC: Hash cache hit: %d (0x%x, %s)", e.texture->GetID(), TEX0.TBP0, psm_str(TEX0.PSM));
+
+		// Same content was already uploaded, drop the new texture
+		m_renderer->m_dev->Recycle(src->m_texture);
+
+		src->m_texture = e.texture;
+		src->m_complete = true;
+		src->m_from_hash_cache = &e;
+
+		e.refcount++;
+		e.age = 0;
+
+		return;
+	}
+
+	const GSVector2i& bs = psm.bs;
+	int tw = std::max<int>(1 << TEX0.TW, bs.x);
+	int th = std::max<int>(1 << TEX0.TH, bs.y);
+
+	// The texture will be reused by other sources, so upload everything now
+	src->Update(GSVector4i(0, 0, tw, th));
+
+	const uint32 size = src->m_texture->GetMemUsage();
+
+	// Make room (if possible) before the insertion, otherwise the cache grows above the budget
+	if (m_hash_cache_memory_usage + size > m_hash_cache_budget)
+		EvictHashCache(m_hash_cache_budget > size ? m_hash_cache_budget - size : 0);
+
+	HashCacheEntry& e = m_hash_cache[key];
+	e.texture = src->m_texture;
+	e.refcount = 1;
+	e.age = 0;
+
+	m_hash_cache_memory_usage += size;
+
+	src->m_from_hash_cache = &e;
+}
+
+void GSTextureCache::ReplaceSourceTexture(Source* src)
+{
+	const HashCacheKey& key = src->m_replacement_key;
+
+	bool pending;
+	GSTexture* t = m_replacements->Lookup({key.TEX0, key.TEXA, key.hash}, pending);
+
+	src->m_replacement_pending = pending;
+
+	if (!t)
+		return;
+
+	GL_CACHE("TC: Replaced: %d (0x%x, %s)", t->GetID(), src->m_TEX0.TBP0, psm_str(src->m_TEX0.PSM));
+
+	if (src->m_from_hash_cache)
+	{
+		src->m_from_hash_cache->refcount--;
+		src->m_from_hash_cache = NULL;
+	}
+	else
+	{
+		m_renderer->m_dev->Recycle(src->m_texture);
+	}
+
+	src->m_texture = t;
+	src->m_complete = true;
+	src->m_replaced = true;
+}
+
+void GSTextureCache::EvictHashCache(uint64 budget)
+{
+	// Unused textures are only kept a couple of seconds
+	const uint32 maxage = 300;
+
+	std::vector<decltype(m_hash_cache)::iterator> unused;
+
+	for (auto it = m_hash_cache.begin(); it != m_hash_cache.end(); ++it)
+	{
+		if (it->second.refcount == 0)
+			unused.push_back(it);
+	}
+
+	// Oldest first
+	std::sort(unused.begin(), unused.end(), [](const auto& a, const auto& b) { return a->second.age > b->second.age; });
+
+	for (auto it : unused)
+	{
+		if (it->second.age <= maxage && m_hash_cache_memory_usage <= budget)
+			break;
+
+		GL_CACHE("TC: Remove hash cache texture: %d (age %d)", it->second.texture->GetID(), it->second.age);
+
+		m_hash_cache_memory_usage -= it->second.texture->GetMemUsage();
+		m_renderer->m_dev->Recycle(it->second.texture);
+		m_hash_cache.erase(it);
+	}
 }
 
 //Fixme: Several issues in here. Not handling depth stencil, pitch conversion doesnt work.
 GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, Target* dst, bool half_right, int x_offset, int y_offset)
 {
 	const GSLocalMemory::psm_t& psm = GSLocalMemory::m_psm[TEX0.PSM];
-	Source* src = new Source(m_renderer, TEX0, TEXA, m_temp);
+	Source* src = new Source(m_renderer, TEX0, TEXA, m_temp, &m_unswizzle_workers);
 
 	int tw = 1 << TEX0.TW;
 	int th = 1 << TEX0.TH;
@@ -1562,7 +1934,49 @@ GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, con
 				sRect.x = sRect.z / 2.0f;
 			}
 
-			m_renderer->m_dev->StretchRect(sTex, sRect, dTex, dRect, shader, linear);
+			if (shader == ShaderConvert_FLOAT32_TO_RGBA8)
+			{
+				// Depth sampled as colour. Games often read the same depth buffer several times
+				// between draws to it, so keep the converted texture on the target and only
+				// pay for a copy while its write count doesn't move.
+				GSTexture* cTex = dst->m_convert.texture;
+				const bool hit = cTex && dst->m_convert.write_count == dst->m_write_count
+					&& cTex->GetWidth() == w && cTex->GetHeight() == h
+					&& dst->m_convert.shader == shader && dst->m_convert.linear == linear
+					&& (dst->m_convert.sRect == sRect).alltrue() && (dst->m_convert.dRect == dRect).alltrue();
+
+				if (hit)
+				{
+					GL_CACHE("TC: reuse depth conversion of target %d", dst->m_id);
+					m_renderer->m_dev->CopyRect(cTex, dTex, GSVector4i(0, 0, w, h));
+				}
+				else
+				{
+					// Convert straight into the source as before, the cached copy is taken from it
+					m_renderer->m_dev->StretchRect(sTex, sRect, dTex, dRect, shader, linear);
+
+					if (cTex && (cTex->GetWidth() != w || cTex->GetHeight() != h))
+					{
+						m_renderer->m_dev->Recycle(cTex);
+						cTex = NULL;
+					}
+					if (!cTex)
+						cTex = m_renderer->m_dev->CreateRenderTarget(w, h);
+
+					m_renderer->m_dev->CopyRect(dTex, cTex, GSVector4i(0, 0, w, h));
+
+					dst->m_convert.texture = cTex;
+					dst->m_convert.sRect = sRect;
+					dst->m_convert.dRect = dRect;
+					dst->m_convert.shader = shader;
+					dst->m_convert.linear = linear;
+					dst->m_convert.write_count = dst->m_write_count;
+				}
+			}
+			else
+			{
+				m_renderer->m_dev->StretchRect(sTex, sRect, dTex, dRect, shader, linear);
+			}
 		}
 
 		if (src->m_texture)
@@ -1616,6 +2030,26 @@ GSTextureCache::Source* GSTextureCache::CreateSource(const GIFRegTEX0& TEX0, con
 				AttachPaletteToSource(src, psm.pal, false);
 			}
 		}
+
+		// Without paltex, the CLUT is already applied on the texture data
+		const bool hash_cache = m_hash_cache_enabled && (psm.pal == 0 || m_paltex);
+		// The replacements are RGBA, they can't stand for the indexes of paltex
+		const bool replace = m_replacements && (psm.pal == 0 || !m_paltex);
+
+		if (hash_cache || replace)
+		{
+			const HashCacheKey key = GetHashCacheKey(src);
+
+			if (hash_cache)
+				AttachHashCacheTexture(src, key);
+
+			// Checked on the lookups, until the loader is done with it
+			if (replace)
+			{
+				src->m_replacement_key = key;
+				src->m_replacement_pending = true;
+			}
+		}
 	}
 
 	ASSERT(src->m_texture);
@@ -1630,6 +2064,7 @@ GSTextureCache::Target* GSTextureCache::CreateTarget(const GIFRegTEX0& TEX0, int
 	ASSERT(type == RenderTarget || type == DepthStencil);
 
 	Target* t = new Target(m_renderer, TEX0, m_temp, m_can_convert_depth);
+	t->m_id = m_target_id++;
 
 	// FIXME: initial data should be unswizzled from local mem in Update() if dirty
 
@@ -1646,11 +2081,340 @@ GSTextureCache::Target* GSTextureCache::CreateTarget(const GIFRegTEX0& TEX0, int
 		t->m_texture = m_renderer->m_dev->CreateSparseDepthStencil(w, h);
 	}
 
-	m_dst[type].push_front(t);
+	t->m_list_index = m_dst[type].InsertFront(t);
+	m_dst_map[type].Add(t);
 
 	return t;
 }
 
+void GSTextureCache::RemoveTarget(Target* t)
+{
+	m_dst[t->m_type].EraseIndex(t->m_list_index);
+	m_dst_map[t->m_type].Remove(t);
+	InvalidateTextureInsideRt(t);
+
+	delete t;
+}
+
+void GSTextureCache::UpdateTargetValidity(Target* t, const GSVector4i& rect)
+{
+	t->UpdateValidity(rect);
+
+	m_dst_map[t->m_type].Update(t);
+}
+
+void GSTextureCache::SetTargetTBW(Target* t, uint32 bw)
+{
+	if (t->m_TEX0.TBW == bw)
+		return;
+
+	// The last valid block, hence the pages of the target map, depend on the width
+	t->m_TEX0.TBW = bw;
+
+	if (t->m_valid.rempty())
+		m_dst_map[t->m_type].Update(t);
+	else
+		UpdateTargetValidity(t, t->m_valid);
+}
+
+void GSTextureCache::Read(Target* t, const GSVector4i& r)
+{
+	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
+		return;
+
+	if (m_async_readback && ReadPending(t, r))
+		return;
+
+	if (GSTexture* offscreen = CopyTargetOffscreen(t, r))
+	{
+		if (m_async_readback)
+			offscreen->StartDownload();
+
+		WriteReadback(t, offscreen, r, r);
+
+		if (m_async_readback)
+		{
+			// Keep the copy, its area will be downloaded again in the background once the target is done
+			if (t->m_readback.texture)
+				m_renderer->m_dev->Recycle(t->m_readback.texture);
+
+			t->m_readback.texture = offscreen;
+			t->m_readback.rect = r;
+			t->m_readback.write_count = t->m_write_count;
+			t->m_readback.age = 0;
+		}
+		else
+		{
+			m_renderer->m_dev->Recycle(offscreen);
+		}
+	}
+}
+
+void GSTextureCache::WriteReadback(Target* t, GSTexture* offscreen, const GSVector4i& offscreen_r, const GSVector4i& r)
+{
+	const GIFRegTEX0& TEX0 = t->m_TEX0;
+
+	GSTexture::GSMap m;
+
+	if (!offscreen->Map(m))
+		return;
+
+	// TODO: block level write
+
+	const int bpp = (GSLocalMemory::m_psm[TEX0.PSM].trbpp == 16) ? 2 : 4;
+	uint8* bits = m.bits + (r.top - offscreen_r.top) * m.pitch + (r.left - offscreen_r.left) * bpp;
+
+	GSOffset* off = m_renderer->m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
+
+	switch (TEX0.PSM)
+	{
+		case PSM_PSMCT32:
+		case PSM_PSMZ32:
+			m_renderer->m_mem.WritePixel32(bits, m.pitch, off, r);
+			break;
+		case PSM_PSMCT24:
+		case PSM_PSMZ24:
+			m_renderer->m_mem.WritePixel24(bits, m.pitch, off, r);
+			break;
+		case PSM_PSMCT16:
+		case PSM_PSMCT16S:
+		case PSM_PSMZ16:
+		case PSM_PSMZ16S:
+			m_renderer->m_mem.WritePixel16(bits, m.pitch, off, r);
+			break;
+
+		default:
+			ASSERT(0);
+	}
+
+	offscreen->Unmap();
+
+	InvalidateLocalMemoryMirror(off, r);
+}
+
+// Tell the device which part of the GPU copy of the local memory is stale.
+// A null offset means the whole memory.
+void GSTextureCache::InvalidateLocalMemoryMirror(GSOffset* off, const GSVector4i& r)
+{
+	GSDevice* dev = m_renderer->m_dev;
+
+	if (!dev->HasLocalMemoryMirror())
+		return;
+
+	alignas(16) uint32 pages[MAX_PAGES / 32];
+
+	if (off)
+		off->GetPagesAsBits(r, pages);
+	else
+		memset(pages, 0xff, sizeof(pages));
+
+	dev->InvalidateLocalMemoryMirror(pages);
+}
+
+// Drops the sources and targets of the pages (EOP terminated), after a savestate reloaded them.
+void GSTextureCache::InvalidateDefrostedPages(const uint32* pages)
+{
+	if (*pages == GSOffset::EOP)
+		return;
+
+	alignas(16) uint32 bits[MAX_PAGES / 32] = {};
+
+	for (const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		bits[*p >> 5] |= 1u << (*p & 31);
+
+		auto& list = m_src.m_map[*p];
+		for (auto i = list.begin(); i != list.end();)
+		{
+			Source* s = *i;
+			++i;
+
+			m_src.RemoveAt(s);
+		}
+	}
+
+	bool removed = false;
+
+	for (int type = 0; type < 2; type++)
+	{
+		m_dst_map[type].Lookup(pages, pages[0] << 5, m_dst_lookup);
+
+		for (Target* t : m_dst_lookup)
+		{
+			GL_CACHE("TC: Remove Target(%s) %d (0x%x) after a savestate load", to_string(type),
+				t->m_texture ? t->m_texture->GetID() : 0,
+				t->m_TEX0.TBP0);
+
+			if (t == m_readback_last_rt)
+				m_readback_last_rt = NULL;
+
+			RemoveTarget(t);
+			removed = true;
+		}
+	}
+
+	// Sources made from a target are only registered in its first page
+	if (removed)
+	{
+		std::vector<Source*> from_targets;
+		for (Source* s : m_src.m_surfaces)
+		{
+			if (s->m_target)
+				from_targets.push_back(s);
+		}
+
+		for (Source* s : from_targets)
+			m_src.RemoveAt(s);
+	}
+
+	GSDevice* dev = m_renderer->m_dev;
+	if (dev->HasLocalMemoryMirror())
+		dev->InvalidateLocalMemoryMirror(bits);
+}
+
+bool GSTextureCache::ReadPending(Target* t, const GSVector4i& r)
+{
+	GSTexture* offscreen = t->m_readback.texture;
+
+	if (!offscreen || !t->m_readback.rect.rintersect(r).eq(r))
+		return false;
+
+	// Nothing was drawn since the copy, otherwise the latency mode accepts the data of the previous frame
+	const bool up_to_date = t->m_readback.write_count == t->m_write_count;
+
+	if (!up_to_date && (m_async_readback < 2 || t->m_readback.age > 1))
+		return false;
+
+	GL_CACHE("TC: Async readback of 0x%x (%d,%d => %d,%d)%s", t->m_TEX0.TBP0, r.x, r.y, r.z, r.w, up_to_date ? "" : " from the previous frame");
+
+	WriteReadback(t, offscreen, t->m_readback.rect, r);
+
+	if (!up_to_date)
+		IssueReadback(t, t->m_readback.rect);
+
+	return true;
+}
+
+void GSTextureCache::IssueReadback(Target* t, const GSVector4i& r)
+{
+	GSTexture* offscreen = CopyTargetOffscreen(t, r);
+
+	if (!offscreen)
+		return;
+
+	offscreen->StartDownload();
+
+	if (t->m_readback.texture)
+		m_renderer->m_dev->Recycle(t->m_readback.texture);
+
+	t->m_readback.texture = offscreen;
+	t->m_readback.rect = r;
+	t->m_readback.write_count = t->m_write_count;
+	t->m_readback.age = 0;
+}
+
+// Targets read back by the EE are likely read again once rendered, so their download
+// starts as soon as the rendering moves to another target.
+bool GSTextureCache::MipsFromBase(const GIFRegTEX0* layers, int count, const GIFRegTEXA& TEXA)
+{
+	if (!m_gpu_mipmap || count < 2 || !m_renderer->m_dev->HasMipmapGeneration())
+		return false;
+
+	GSLocalMemory& mem = m_renderer->m_mem;
+	const GSLocalMemory::readTexel rt = GSLocalMemory::m_psm[layers[0].PSM].rt;
+
+	// The chain is identified by the address and size of its levels, a 4x4 grid of texels
+	// of every level tells whether the content is still the one of the last check
+	uint64 key = 0xcbf29ce484222325ull;
+	uint32 sample = 2166136261u;
+
+	for (int i = 0; i < count; i++)
+	{
+		const GIFRegTEX0& TEX0 = layers[i];
+		const uint64 id = TEX0.TBP0 | (TEX0.TBW << 14) | (TEX0.PSM << 20) | (TEX0.TW << 26) | (static_cast<uint64>(TEX0.TH) << 30);
+		const int w = 1 << TEX0.TW;
+		const int h = 1 << TEX0.TH;
+
+		key = (key ^ id) * 0x100000001b3ull;
+
+		for (int y = 1; y < 8; y += 2)
+		{
+			for (int x = 1; x < 8; x += 2)
+				sample = (sample ^ (mem.*rt)(x * w / 8, y * h / 8, TEX0, TEXA)) * 16777619u;
+		}
+	}
+
+	auto it = m_mip_chains.find(key);
+	if (it != m_mip_chains.end() && it->second.sample == sample)
+		return it->second.derived;
+
+	// Compare an 8x8 grid of each level with the 2x2 average of the level above. Hand made
+	// levels differ by far more than the rounding of the encoder that built the chain.
+	const int tolerance = 8;
+	bool derived = true;
+
+	for (int i = 1; i < count && derived; i++)
+	{
+		const GIFRegTEX0& up = layers[i - 1];
+		const GIFRegTEX0& cur = layers[i];
+		const int uw = 1 << up.TW;
+		const int uh = 1 << up.TH;
+		const int w = 1 << cur.TW;
+		const int h = 1 << cur.TH;
+
+		for (int y = 0; y < 8 && derived; y++)
+		{
+			for (int x = 0; x < 8 && derived; x++)
+			{
+				const int cx = (2 * x + 1) * w / 16;
+				const int cy = (2 * y + 1) * h / 16;
+				const int ux = std::max(std::min(cx * 2, uw - 2), 0);
+				const int uy = std::max(std::min(cy * 2, uh - 2), 0);
+
+				const uint32 texel = (mem.*rt)(cx, cy, cur, TEXA);
+				const uint32 t00 = (mem.*rt)(ux, uy, up, TEXA);
+				const uint32 t10 = (mem.*rt)(ux + 1, uy, up, TEXA);
+				const uint32 t01 = (mem.*rt)(ux, uy + 1, up, TEXA);
+				const uint32 t11 = (mem.*rt)(ux + 1, uy + 1, up, TEXA);
+
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					const int avg = (((t00 >> shift) & 0xff) + ((t10 >> shift) & 0xff) + ((t01 >> shift) & 0xff) + ((t11 >> shift) & 0xff) + 2) >> 2;
+
+					if (std::abs(avg - static_cast<int>((texel >> shift) & 0xff)) > tolerance)
+						derived = false;
+				}
+			}
+		}
+	}
+
+	if (m_mip_chains.size() >= 4096)
+		m_mip_chains.clear();
+
+	m_mip_chains[key] = {sample, derived};
+
+	GL_CACHE("TC: mip chain 0x%x (%d levels) %s", layers[0].TBP0, count, derived ? "built on the GPU" : "decoded");
+
+	return derived;
+}
+
+void GSTextureCache::ScheduleReadbacks(const Target* rt)
+{
+	if (!m_async_readback || rt == m_readback_last_rt)
+		return;
+
+	m_readback_last_rt = rt;
+
+	for (auto t : m_dst[RenderTarget])
+	{
+		if (t != rt && t->m_readback.texture && t->m_readback.write_count != t->m_write_count && t->m_dirty.empty())
+		{
+			GL_CACHE("TC: Start async readback of 0x%x", t->m_TEX0.TBP0);
+			IssueReadback(t, t->m_readback.rect);
+		}
+	}
+}
+
 void GSTextureCache::PrintMemoryUsage()
 {
 #ifdef ENABLE_OGL_DEBUG
@@ -1680,9 +2444,50 @@ void GSTextureCache::PrintMemoryUsage()
 	}
 
 	GL_PERF("MEM: RO Tex %dMB. RW Tex %dMB. Target %dMB. Depth %dMB", tex >> 20u, tex_rt >> 20u, rt >> 20u, dss >> 20u);
+	GL_PERF("Dirty rects: %u added, %u merged on insertion", m_dirty_stats.added, m_dirty_stats.merged);
+	GL_PERF("Texture inside rt: %u hits, %u misses (%u targets cached)", m_texture_inside_rt_stats.hits, m_texture_inside_rt_stats.misses, (uint32)m_texture_inside_rt_cache.size());
+	m_texture_inside_rt_stats.hits = 0;
+	m_texture_inside_rt_stats.misses = 0;
+	m_dirty_stats.added = 0;
+	m_dirty_stats.merged = 0;
 #endif
 }
 
+void GSTextureCache::AddDirtyRect(Target* t, const GSDirtyRect& r)
+{
+	// Drop the offsets of the textures that overlap the written blocks, the others stay valid
+	auto cache = m_texture_inside_rt_cache.find(t->m_id);
+	const GSVector4i d = r.GetDirtyRect(t->m_TEX0);
+
+	if (cache != m_texture_inside_rt_cache.end() && !d.rempty())
+	{
+		const GSLocalMemory::psm_t& psm_s = GSLocalMemory::m_psm[t->m_TEX0.PSM];
+
+		// Whole pages, the blocks of a rect aren't contiguous inside a page
+		const uint32 start = psm_s.bn(d.left, d.top, t->m_TEX0.TBP0, t->m_TEX0.TBW) & ~0x1f;
+		const uint32 end = psm_s.bn(d.right - 1, d.bottom - 1, t->m_TEX0.TBP0, t->m_TEX0.TBW) | 0x1f;
+
+		std::vector<TexInsideRtCacheEntry>& entries = cache->second;
+
+		if (end < start)
+		{
+			// Wraps around the end of the GS memory
+			entries.clear();
+		}
+		else
+		{
+			entries.erase(std::remove_if(entries.begin(), entries.end(), [start, end](const TexInsideRtCacheEntry& e) {
+				return e.bp <= end && e.bp_end >= start;
+			}), entries.end());
+		}
+	}
+
+	m_dirty_stats.added++;
+
+	if (!t->m_dirty.Add(r))
+		m_dirty_stats.merged++;
+}
+
 // GSTextureCache::Surface
 
 GSTextureCache::Surface::Surface(GSRenderer* r, uint8* temp)
@@ -1727,7 +2532,7 @@ bool GSTextureCache::Surface::Overlaps(uint32 bp, uint32 bw, uint32 psm, const G
 
 // GSTextureCache::Source
 
-GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, bool dummy_container)
+GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, UnswizzlePool* unswizzle_workers, bool dummy_container)
 	: Surface(r, temp)
 	, m_palette_obj(nullptr)
 	, m_palette(nullptr)
@@ -1737,6 +2542,11 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 	, m_p2t(NULL)
 	, m_from_target(NULL)
 	, m_from_target_TEX0(TEX0)
+	, m_from_hash_cache(NULL)
+	, m_replacement_pending(false)
+	, m_replaced(false)
+	, m_layer_staging(0)
+	, m_unswizzle_workers(unswizzle_workers)
 {
 	m_TEX0 = TEX0;
 	m_TEXA = TEXA;
@@ -1774,6 +2584,17 @@ GSTextureCache::Source::Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFR
 GSTextureCache::Source::~Source()
 {
 	_aligned_free(m_write.rect);
+
+	// Texture is owned by the hash cache
+	if (m_from_hash_cache)
+	{
+		m_from_hash_cache->refcount--;
+		m_texture = NULL;
+	}
+
+	// Texture is owned by the replacements
+	if (m_replaced)
+		m_texture = NULL;
 }
 
 void GSTextureCache::Source::Update(const GSVector4i& rect, int layer)
@@ -1889,6 +2710,23 @@ void GSTextureCache::Source::UpdateLayer(const GIFRegTEX0& TEX0, const GSVector4
 	m_TEX0 = old_TEX0;
 }
 
+void GSTextureCache::Source::FlushLayers()
+{
+	if (!m_layer_uploads.empty())
+		m_texture->UpdateBatch(m_layer_uploads.data(), static_cast<int>(m_layer_uploads.size()));
+
+	m_layer_uploads.clear();
+	m_layer_staging = 0;
+}
+
+void GSTextureCache::Source::GenerateLayers()
+{
+	// The levels no longer hold the GS data, the next decode of the chain must upload them again
+	memset(&m_layer_TEX0[1], 0, sizeof(m_layer_TEX0) - sizeof(m_layer_TEX0[0]));
+
+	m_texture->GenerateMipmap();
+}
+
 void GSTextureCache::Source::Write(const GSVector4i& r, int layer)
 {
 	m_write.rect[m_write.count++] = r;
@@ -1952,13 +2790,39 @@ void GSTextureCache::Source::Flush(uint32 count, int layer)
 
 	uint8* buff = m_temp;
 
+	GSDevice* dev = m_renderer->m_dev;
+	const bool mirror = dev->HasLocalMemoryMirror();
+
 	for (uint32 i = 0; i < count; i++)
 	{
 		GSVector4i r = m_write.rect[i];
 
+		if (mirror && dev->ReadLocalMemoryMirror(m_texture, r.rintersect(tr), layer, mem.m_vm8, mem.m_clut, m_TEX0, m_TEXA, m_palette != NULL))
+			continue;
+
+		if (layer > 0)
+		{
+			// Mip levels are decoded one after the other into the temp buffer with a tight
+			// pitch, then handed to the texture in one go by FlushLayers
+			const int layer_pitch = r.width() << (m_palette ? 0 : 2);
+			const uint32 size = (layer_pitch * r.height() + 31) & ~31;
+
+			if (m_layer_staging + size > TEMP_SIZE)
+				FlushLayers();
+
+			uint8* staging = m_temp + m_layer_staging;
+
+			ReadTexture(off, rtx, r, staging, layer_pitch);
+
+			m_layer_uploads.push_back({r.rintersect(tr), staging, layer_pitch, layer});
+			m_layer_staging += size;
+
+			continue;
+		}
+
 		if ((r > tr).mask() & 0xff00)
 		{
-			(mem.*rtx)(off, r, buff, pitch, m_TEXA);
+			ReadTexture(off, rtx, r, buff, pitch);
 
 			m_texture->Update(r.rintersect(tr), buff, pitch, layer);
 		}
@@ -1968,13 +2832,13 @@ void GSTextureCache::Source::Flush(uint32 count, int layer)
 
 			if (m_texture->Map(m, &r, layer))
 			{
-				(mem.*rtx)(off, r, m.bits, m.pitch, m_TEXA);
+				ReadTexture(off, rtx, r, m.bits, m.pitch);
 
 				m_texture->Unmap();
 			}
 			else
 			{
-				(mem.*rtx)(off, r, buff, pitch, m_TEXA);
+				ReadTexture(off, rtx, r, buff, pitch);
 
 				m_texture->Update(r, buff, pitch, layer);
 			}
@@ -1990,6 +2854,52 @@ void GSTextureCache::Source::Flush(uint32 count, int layer)
 	m_write.count -= count;
 }
 
+void GSTextureCache::Source::ReadTexture(const GSOffset* off, GSLocalMemory::readTexture rtx, const GSVector4i& r, uint8* dst, int pitch)
+{
+	GSLocalMemory& mem = m_renderer->m_mem;
+
+	const int bh = GSLocalMemory::m_psm[m_TEX0.PSM].bs.y;
+	UnswizzlePool& pool = *m_unswizzle_workers;
+	const int workers = static_cast<int>(pool.size());
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// Small rectangles aren't worth the synchronization
+	if (workers == 0 || r.width() * r.height() < 128 * 128)
+	{
+		(mem.*rtx)(off, r, dst, pitch, m_TEXA);
+	}
+	else
+	{
+		// Split the rectangle in horizontal bands of whole blocks, the last one is decoded on this thread
+		const int rows = r.height() / bh;
+		const int band = std::max(rows / (workers + 1), 1) * bh;
+
+		UnswizzleJob job;
+		job.off = off;
+		job.rtx = rtx;
+		job.pitch = pitch;
+		job.TEXA = m_TEXA;
+
+		int top = r.top;
+
+		for (int i = 0; i < workers && top + band < r.bottom; i++, top += band)
+		{
+			job.r = GSVector4i(r.left, top, r.right, top + band);
+			job.dst = dst + (top - r.top) * pitch;
+
+			pool[i]->Push(job);
+		}
+
+		(mem.*rtx)(off, GSVector4i(r.left, top, r.right, r.bottom), dst + (top - r.top) * pitch, pitch, m_TEXA);
+
+		for (auto& worker : pool)
+			worker->Wait();
+	}
+
+	m_renderer->m_perfmon.Put(GSPerfMon::UnswizzleTime, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
+
 bool GSTextureCache::Source::ClutMatch(PaletteKey palette_key)
 {
 	return PaletteKeyEqual()(palette_key, m_palette_obj->GetPaletteKey());
@@ -2002,12 +2912,39 @@ GSTextureCache::Target::Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* tem
 	, m_type(-1)
 	, m_used(false)
 	, m_depth_supported(depth_supported)
+	, m_list_index(0)
+	, m_first_page(0)
+	, m_page_count(0)
+	, m_map_tbw(0)
+	, m_lookup_id(0)
+	, m_write_count(0)
+	, m_id(0)
 {
 	m_TEX0 = TEX0;
 	m_32_bits_fmt |= (GSLocalMemory::m_psm[TEX0.PSM].trbpp != 16);
 	m_dirty_alpha = GSLocalMemory::m_psm[TEX0.PSM].trbpp != 24;
 
 	m_valid = GSVector4i::zero();
+
+	m_readback.texture = NULL;
+	m_readback.rect = GSVector4i::zero();
+	m_readback.write_count = 0;
+	m_readback.age = 0;
+
+	m_convert.texture = NULL;
+	m_convert.sRect = GSVector4::zero();
+	m_convert.dRect = GSVector4::zero();
+	m_convert.shader = 0;
+	m_convert.linear = false;
+	m_convert.write_count = 0;
+}
+
+GSTextureCache::Target::~Target()
+{
+	if (m_readback.texture)
+		m_renderer->m_dev->Recycle(m_readback.texture);
+	if (m_convert.texture)
+		m_renderer->m_dev->Recycle(m_convert.texture);
 }
 
 void GSTextureCache::Target::Update()
@@ -2034,6 +2971,8 @@ void GSTextureCache::Target::Update()
 	if (r.rempty())
 		return;
 
+	m_write_count++;
+
 	// No handling please
 	if ((m_type == DepthStencil) && !m_depth_supported)
 	{
@@ -2117,6 +3056,91 @@ void GSTextureCache::Target::UpdateValidity(const GSVector4i& rect)
 	// GL_CACHE("UpdateValidity (0x%x->0x%x) from R:%d,%d Valid: %d,%d", m_TEX0.TBP0, m_end_block, rect.z, rect.w, m_valid.z, m_valid.w);
 }
 
+// GSTextureCache::TargetMap
+
+uint32 GSTextureCache::TargetMap::PageCount(const Target* t)
+{
+	if (t->m_valid.rempty())
+		return 1;
+
+	// Take care of the wrap around at the end of the GS memory
+	const uint32 first = t->m_TEX0.TBP0 >> 5;
+	const uint32 last = t->m_end_block >> 5;
+
+	return ((last - first) & (MAX_PAGES - 1)) + 1;
+}
+
+void GSTextureCache::TargetMap::Add(Target* t)
+{
+	t->m_first_page = t->m_TEX0.TBP0 >> 5;
+	t->m_page_count = PageCount(t);
+	t->m_map_tbw = t->m_TEX0.TBW;
+
+	for (uint32 i = 0; i < t->m_page_count; i++)
+	{
+		const uint32 page = (t->m_first_page + i) & (MAX_PAGES - 1);
+
+		t->m_erase_it[page] = m_map[page].InsertFront(t);
+	}
+}
+
+void GSTextureCache::TargetMap::Update(Target* t)
+{
+	// Validity only grows, so the registered pages are only refreshed when the target gets bigger.
+	// A new width moves the end of the target in both directions, register it again.
+	if (t->m_first_page == (t->m_TEX0.TBP0 >> 5) && t->m_map_tbw == t->m_TEX0.TBW && t->m_page_count >= PageCount(t))
+		return;
+
+	Remove(t);
+	Add(t);
+}
+
+void GSTextureCache::TargetMap::Remove(Target* t)
+{
+	for (uint32 i = 0; i < t->m_page_count; i++)
+	{
+		const uint32 page = (t->m_first_page + i) & (MAX_PAGES - 1);
+
+		m_map[page].EraseIndex(t->m_erase_it[page]);
+	}
+
+	t->m_page_count = 0;
+}
+
+void GSTextureCache::TargetMap::RemoveAll()
+{
+	for (size_t i = 0; i < countof(m_map); i++)
+	{
+		m_map[i].clear();
+	}
+}
+
+void GSTextureCache::TargetMap::Lookup(const uint32* pages, uint32 bp, std::vector<Target*>& out)
+{
+	out.clear();
+
+	// A target that spans several pages is stored in all of them
+	const uint32 id = ++m_lookup_id;
+
+	for (Target* t : m_map[bp >> 5])
+	{
+		t->m_lookup_id = id;
+		out.push_back(t);
+	}
+
+	for (const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		for (Target* t : m_map[*p])
+		{
+			if (t->m_lookup_id != id)
+			{
+				t->m_lookup_id = id;
+				out.push_back(t);
+			}
+		}
+	}
+}
+
 // GSTextureCache::SourceMap
 
 void GSTextureCache::SourceMap::Add(Source* s, const GIFRegTEX0& TEX0, GSOffset* off)
@@ -2221,6 +3245,7 @@ void GSTextureCache::AttachPaletteToSource(Source* s, uint16 pal, bool need_gs_t
 
 GSTextureCache::Palette::Palette(const GSRenderer* renderer, uint16 pal, bool need_gs_texture)
 	: m_pal(pal)
+	, m_hash(renderer->m_mem.m_clut.GetPaletteHash(pal))
 	, m_tex_palette(nullptr)
 	, m_renderer(renderer)
 {
@@ -2246,7 +3271,7 @@ GSTexture* GSTextureCache::Palette::GetPaletteGSTexture()
 
 GSTextureCache::PaletteKey GSTextureCache::Palette::GetPaletteKey()
 {
-	return {m_clut, m_pal};
+	return {m_clut, m_pal, m_hash};
 }
 
 void GSTextureCache::Palette::InitializeTexture()
@@ -2263,53 +3288,23 @@ void GSTextureCache::Palette::InitializeTexture()
 	}
 }
 
+std::size_t GSTextureCache::HashCacheKeyHash::operator()(const HashCacheKey& key) const
+{
+	return static_cast<std::size_t>(key.hash ^ (key.TEX0 * 0x9e3779b97f4a7c15ull) ^ (key.TEXA << 1));
+}
+
 // GSTextureCache::PaletteKeyHash
 
-// Hashes the content of the clut.
-// The hashing function is implemented by taking two things into account:
-// 1) The clut can be an array of 16 or 256 uint32 (depending on the pal parameter) and in order to speed up the computation of the hash
-//    the array is hashed in blocks of 16 uint32, so for clut of size 16 uint32 the hashing is computed in one pass and for clut of 256 uint32
-//    it is computed in 16 passes,
-// 2) The clut can contain many 0s, so as a way to increase the spread of hashing values for small changes in the input clut the hashing function
-//    is using addition in combination with logical XOR operator; The addition constants are large prime numbers, which may help in achieving what intended.
 std::size_t GSTextureCache::PaletteKeyHash::operator()(const PaletteKey& key) const
 {
-	uint16 pal = key.pal;
-	const uint32* clut = key.clut;
-
-	ASSERT((pal & 15) == 0);
-
-	size_t clut_hash = 3831179159;
-	for (uint16 i = 0; i < pal; i += 16)
-	{
-		clut_hash = (clut_hash + 1488000301) ^ (clut[i     ] +   33644011);
-		clut_hash = (clut_hash + 3831179159) ^ (clut[i +  1] +   47627467);
-		clut_hash = (clut_hash + 3659574209) ^ (clut[i +  2] +  577038523);
-		clut_hash = (clut_hash +   33644011) ^ (clut[i +  3] + 3491555267);
-
-		clut_hash = (clut_hash +  777771959) ^ (clut[i +  4] + 3301075993);
-		clut_hash = (clut_hash + 4019618579) ^ (clut[i +  5] + 4186992613);
-		clut_hash = (clut_hash + 3465668953) ^ (clut[i +  6] + 3043435883);
-		clut_hash = (clut_hash + 3494478943) ^ (clut[i +  7] + 3441897883);
-
-		clut_hash = (clut_hash + 3432010979) ^ (clut[i +  8] + 2167922789);
-		clut_hash = (clut_hash + 1570862863) ^ (clut[i +  9] + 3401920591);
-		clut_hash = (clut_hash + 1002648679) ^ (clut[i + 10] + 1293530519);
-		clut_hash = (clut_hash +  551381741) ^ (clut[i + 11] + 2539834039);
-
-		clut_hash = (clut_hash + 3768974459) ^ (clut[i + 12] +  169943507);
-		clut_hash = (clut_hash +  862380703) ^ (clut[i + 13] + 2906932549);
-		clut_hash = (clut_hash + 3433082137) ^ (clut[i + 14] + 4234384109);
-		clut_hash = (clut_hash + 2679083843) ^ (clut[i + 15] + 2719605247);
-	}
-	return clut_hash;
+	return key.hash;
 };
 
 // GSTextureCache::PaletteKeyEqual
 
 bool GSTextureCache::PaletteKeyEqual::operator()(const PaletteKey& lhs, const PaletteKey& rhs) const
 {
-	if (lhs.pal != rhs.pal)
+	if (lhs.pal != rhs.pal || lhs.hash != rhs.hash)
 	{
 		return false;
 	}
@@ -2340,7 +3335,7 @@ std::shared_ptr<GSTextureCache::Palette> GSTextureCache::PaletteMap::LookupPalet
 	const uint32* clut = (const uint32*)m_renderer->m_mem.m_clut;
 
 	// Create PaletteKey for searching into map (clut is actually not copied, so do not store this key into the map)
-	PaletteKey palette_key = {clut, pal};
+	PaletteKey palette_key = {clut, pal, m_renderer->m_mem.m_clut.GetPaletteHash(pal)};
 
 	auto it1 = map.find(palette_key);
 
@@ -2402,6 +3397,22 @@ std::shared_ptr<GSTextureCache::Palette> GSTextureCache::PaletteMap::LookupPalet
 	return palette;
 }
 
+uint64 GSTextureCache::PaletteMap::GetMemUsage() const
+{
+	uint64 size = 0;
+
+	for (const auto& map : m_maps)
+	{
+		for (const auto& it : map)
+		{
+			if (GSTexture* t = it.second->GetPaletteGSTexture())
+				size += t->GetMemUsage();
+		}
+	}
+
+	return size;
+}
+
 void GSTextureCache::PaletteMap::Clear()
 {
 	for (auto& map : m_maps)
@@ -18,6 +18,8 @@
 #include "GS/Renderers/Common/GSRenderer.h"
 #include "GS/Renderers/Common/GSFastList.h"
 #include "GS/Renderers/Common/GSDirtyRect.h"
+#include "GSTextureReplacements.h"
+#include "GS/GSThread_CXX11.h"
 
 class GSTextureCache
 {
@@ -28,6 +30,11 @@ public:
 		DepthStencil
 	};
 
+	// In theory 4MB is enough but 9MB is safer for overflow (8MB
+	// isn't enough in custom resolution)
+	// Test: onimusha 3 PAL 60Hz
+	static const uint32 TEMP_SIZE = 9 * 1024 * 1024;
+
 	class Surface : public GSAlignedClass<32>
 	{
 	protected:
@@ -56,6 +63,7 @@ public:
 	{
 		const uint32* clut;
 		uint16 pal;
+		size_t hash; // GSClut::HashPalette of the clut
 	};
 
 	class Palette
@@ -63,6 +71,7 @@ public:
 	private:
 		uint32* m_clut;
 		uint16 m_pal;
+		size_t m_hash;
 		GSTexture* m_tex_palette;
 		const GSRenderer* m_renderer;
 
@@ -97,6 +106,40 @@ public:
 		bool operator()(const PaletteKey& lhs, const PaletteKey& rhs) const;
 	};
 
+	struct HashCacheKey
+	{
+		uint64 TEX0; // TBP0 is masked, identical data can be uploaded at another address
+		uint64 TEXA;
+		uint64 hash;
+
+		bool operator==(const HashCacheKey& e) const { return TEX0 == e.TEX0 && TEXA == e.TEXA && hash == e.hash; }
+	};
+
+	struct HashCacheKeyHash
+	{
+		std::size_t operator()(const HashCacheKey& key) const;
+	};
+
+	struct HashCacheEntry
+	{
+		GSTexture* texture;
+		uint32 refcount;
+		uint32 age;
+	};
+
+	struct UnswizzleJob
+	{
+		const GSOffset* off;
+		GSLocalMemory::readTexture rtx;
+		GSVector4i r;
+		uint8* dst;
+		int pitch;
+		GIFRegTEXA TEXA;
+	};
+
+	using UnswizzleWorker = GSJobQueue<UnswizzleJob, 64>;
+	using UnswizzlePool = std::vector<std::unique_ptr<UnswizzleWorker>>;
+
 	class Source : public Surface
 	{
 		struct
@@ -105,7 +148,14 @@ public:
 			uint32 count;
 		} m_write;
 
+		// Mip level rects decoded into the temp buffer, sent together by FlushLayers
+		std::vector<GSTexture::GSUpload> m_layer_uploads;
+		uint32 m_layer_staging;
+		// Owned by GSTextureCache, decode the local memory into the upload buffer
+		UnswizzlePool* m_unswizzle_workers;
+
 		void Write(const GSVector4i& r, int layer);
+		void ReadTexture(const GSOffset* off, GSLocalMemory::readTexture rtx, const GSVector4i& r, uint8* dst, int pitch);
 		void Flush(uint32 count, int layer);
 
 	public:
@@ -126,13 +176,24 @@ public:
 		// Keep a GSTextureCache::SourceMap::m_map iterator to allow fast erase
 		std::array<uint16, MAX_PAGES> m_erase_it;
 		uint32* m_pages_as_bit;
+		// Texture is owned by GSTextureCache::m_hash_cache, it must not be updated anymore
+		HashCacheEntry* m_from_hash_cache;
+		// Content key of the replacement still loading, the source keeps its texture until then
+		HashCacheKey m_replacement_key;
+		bool m_replacement_pending;
+		// Texture is owned by GSTextureCache::m_replacements
+		bool m_replaced;
 
 	public:
-		Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, bool dummy_container = false);
+		Source(GSRenderer* r, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint8* temp, UnswizzlePool* unswizzle_workers, bool dummy_container = false);
 		virtual ~Source();
 
 		void Update(const GSVector4i& rect, int layer = 0);
 		void UpdateLayer(const GIFRegTEX0& TEX0, const GSVector4i& rect, int layer = 0);
+		// Uploads the rects staged by UpdateLayer, must follow the UpdateLayer calls of a draw
+		void FlushLayers();
+		// Rebuilds the mip levels from the first layer on the GPU instead of decoding them
+		void GenerateLayers();
 
 		bool ClutMatch(PaletteKey palette_key);
 	};
@@ -146,9 +207,41 @@ public:
 		GSVector4i m_valid;
 		bool m_depth_supported;
 		bool m_dirty_alpha;
+		// Position in GSTextureCache::m_dst[m_type]
+		uint16 m_list_index;
+		// Pages registered in GSTextureCache::TargetMap (can be larger than the real area)
+		uint32 m_first_page;
+		uint32 m_page_count;
+		uint32 m_map_tbw;
+		std::array<uint16, MAX_PAGES> m_erase_it;
+		// Avoid to return duplicated targets from TargetMap::Lookup
+		uint32 m_lookup_id;
+		// Bumped each time the target might be written (lookup or memory update)
+		uint32 m_write_count;
+		// Unique identifier of the target, key of the texture inside rt cache
+		uint32 m_id;
+		// Offscreen copy of the last area read back by the EE, downloaded asynchronously
+		struct
+		{
+			GSTexture* texture;
+			GSVector4i rect;
+			uint32 write_count;
+			int age;
+		} m_readback;
+		// Last depth to colour conversion done for a source, reused while the target isn't written
+		struct
+		{
+			GSTexture* texture;
+			GSVector4 sRect;
+			GSVector4 dRect;
+			int shader;
+			bool linear;
+			uint32 write_count;
+		} m_convert;
 
 	public:
 		Target(GSRenderer* r, const GIFRegTEX0& TEX0, uint8* temp, bool depth_supported);
+		virtual ~Target();
 
 		void UpdateValidity(const GSVector4i& rect);
 
@@ -173,6 +266,8 @@ public:
 		std::shared_ptr<Palette> LookupPalette(uint16 pal, bool need_gs_texture);
 
 		void Clear(); // Clears m_maps, thus deletes Palette objects
+
+		uint64 GetMemUsage() const; // Memory of the palette textures
 	};
 
 	class SourceMap
@@ -195,13 +290,38 @@ public:
 		void RemoveAt(Source* s);
 	};
 
+	class TargetMap
+	{
+		uint32 m_lookup_id;
+
+		static uint32 PageCount(const Target* t);
+
+	public:
+		// Targets that overlap each page, filled from [TBP0, m_end_block]
+		std::array<FastList<Target*>, MAX_PAGES> m_map;
+
+		TargetMap()
+			: m_lookup_id(0)
+		{
+		}
+
+		void Add(Target* t);
+		void Update(Target* t);
+		void Remove(Target* t);
+		void RemoveAll();
+
+		// Fill out with the targets that overlap pages (EOP terminated) or start in the page of bp.
+		void Lookup(const uint32* pages, uint32 bp, std::vector<Target*>& out);
+	};
+
+	// Result of the <x,y> offset search of a texture inside a target. Entries
+	// are kept per target until it is invalidated or removed.
 	struct TexInsideRtCacheEntry
 	{
 		uint32 psm;
 		uint32 bp;
 		uint32 bp_end;
 		uint32 bw;
-		uint32 t_tex0_tbp0;
 		uint32 m_end_block;
 		bool has_valid_offset;
 		int x_offset;
@@ -213,6 +333,8 @@ protected:
 	PaletteMap m_palette_map;
 	SourceMap m_src;
 	FastList<Target*> m_dst[2];
+	TargetMap m_dst_map[2];
+	std::vector<Target*> m_dst_lookup;
 	bool m_paltex;
 	bool m_preload_frame;
 	uint8* m_temp;
@@ -222,21 +344,70 @@ protected:
 	static bool m_disable_partial_invalidation;
 	bool m_texture_inside_rt;
 	static bool m_wrap_gs_mem;
+	// Shared by all the sources, workers decode the local memory into the upload buffer
+	UnswizzlePool m_unswizzle_workers;
 	uint8 m_texture_inside_rt_cache_size = 255;
-	std::vector<TexInsideRtCacheEntry> m_texture_inside_rt_cache;
+	std::unordered_map<uint32, std::vector<TexInsideRtCacheEntry>> m_texture_inside_rt_cache;
+	uint32 m_target_id;
+
+	struct
+	{
+		uint32 hits;
+		uint32 misses;
+	} m_texture_inside_rt_stats;
+	std::unordered_map<HashCacheKey, HashCacheEntry, HashCacheKeyHash> m_hash_cache;
+	bool m_hash_cache_enabled;
+	uint64 m_hash_cache_budget;
+	uint64 m_hash_cache_memory_usage;
+	std::unique_ptr<GSTextureReplacements> m_replacements; // NULL when no pack is installed
+	uint64 m_vram_budget; // 0 means unlimited
+	uint64 m_vram_usage_peak;
+	int m_async_readback; // 0: off, 1: exact data, 2: up to one frame late
+	const Target* m_readback_last_rt;
+
+	struct
+	{
+		uint32 added;
+		uint32 merged; // rects absorbed by an existing dirty rect
+	} m_dirty_stats;
+
+	// Verdict of MipsFromBase for a mip chain, valid while the sampled texels don't change
+	struct MipChainEntry
+	{
+		uint32 sample;
+		bool derived;
+	};
+	std::unordered_map<uint64, MipChainEntry> m_mip_chains;
+	bool m_gpu_mipmap;
 
 	virtual Source* CreateSource(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, Target* t = NULL, bool half_right = false, int x_offset = 0, int y_offset = 0);
 	virtual Target* CreateTarget(const GIFRegTEX0& TEX0, int w, int h, int type);
+	void RemoveTarget(Target* t);
+	void AddDirtyRect(Target* t, const GSDirtyRect& r);
+	void InvalidateTextureInsideRt(const Target* t) { m_texture_inside_rt_cache.erase(t->m_id); }
 
 	virtual int Get8bitFormat() = 0;
 
+	uint64 HashSourceMemory(const GIFRegTEX0& TEX0) const;
+	HashCacheKey GetHashCacheKey(const Source* src) const;
+	void AttachHashCacheTexture(Source* src, const HashCacheKey& key);
+	void ReplaceSourceTexture(Source* src);
+	void EvictHashCache(uint64 budget);
+	void EnforceVRAMBudget();
+
+	// Convert the area of the target into an offscreen texture (NULL if the format isn't supported)
+	virtual GSTexture* CopyTargetOffscreen(Target* t, const GSVector4i& r) = 0;
+	void WriteReadback(Target* t, GSTexture* offscreen, const GSVector4i& offscreen_r, const GSVector4i& r);
+	bool ReadPending(Target* t, const GSVector4i& r);
+	void IssueReadback(Target* t, const GSVector4i& r);
+
 	// TODO: virtual void Write(Source* s, const GSVector4i& r) = 0;
 	// TODO: virtual void Write(Target* t, const GSVector4i& r) = 0;
 
 public:
 	GSTextureCache(GSRenderer* r);
 	virtual ~GSTextureCache();
-	virtual void Read(Target* t, const GSVector4i& r) = 0;
+	void Read(Target* t, const GSVector4i& r);
 	virtual void Read(Source* t, const GSVector4i& r) = 0;
 	void RemoveAll();
 	void RemovePartial();
@@ -247,10 +418,20 @@ public:
 	Target* LookupTarget(const GIFRegTEX0& TEX0, int w, int h, int type, bool used, uint32 fbmask = 0);
 	Target* LookupTarget(const GIFRegTEX0& TEX0, int w, int h, int real_h);
 
+	void UpdateTargetValidity(Target* t, const GSVector4i& rect);
+	void SetTargetTBW(Target* t, uint32 bw);
+
+	// True when every level of the chain (layers[0] is the base) is a box filtered copy of
+	// the level above, so the GPU can build them from the base
+	bool MipsFromBase(const GIFRegTEX0* layers, int count, const GIFRegTEXA& TEXA);
+	void ScheduleReadbacks(const Target* rt);
+
 	void InvalidateVideoMemType(int type, uint32 bp);
 	void InvalidateVideoMemSubTarget(GSTextureCache::Target* rt);
 	void InvalidateVideoMem(GSOffset* off, const GSVector4i& r, bool target = true);
 	void InvalidateLocalMem(GSOffset* off, const GSVector4i& r);
+	void InvalidateLocalMemoryMirror(GSOffset* off, const GSVector4i& r);
+	void InvalidateDefrostedPages(const uint32* pages);
 
 	void IncAge();
 	bool UserHacks_HalfPixelOffset;
@@ -0,0 +1,199 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "GSTextureReplacements.h"
+#include "GS/GSPng.h"
+#include "GS/GSUtil.h"
+
+// Header of the decoded images in the cache directory, followed by the RGBA8 pixels
+struct CacheHeader
+{
+	uint32 magic;
+	uint32 w;
+	uint32 h;
+	uint32 reserved;
+	uint64 png_size; // The cached image is stale when the PNG changed
+};
+
+static const uint32 CACHE_MAGIC = 0x54525347; // GSRT
+
+static bool ReadCache(const std::string& file, uint64 png_size, std::vector<uint8>& pixels, int& w, int& h)
+{
+	FILE* fp = px_fopen(file, "rb");
+	if (fp == nullptr)
+		return false;
+
+	CacheHeader header;
+	bool success = fread(&header, sizeof(header), 1, fp) == 1
+		&& header.magic == CACHE_MAGIC
+		&& header.png_size == png_size;
+
+	if (success)
+	{
+		pixels.resize((size_t)header.w * header.h * 4);
+		success = fread(pixels.data(), pixels.size(), 1, fp) == 1;
+		w = header.w;
+		h = header.h;
+	}
+
+	fclose(fp);
+
+	return success;
+}
+
+static void WriteCache(const std::string& file, uint64 png_size, const std::vector<uint8>& pixels, int w, int h)
+{
+	FILE* fp = px_fopen(file, "wb");
+	if (fp == nullptr)
+		return;
+
+	CacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.w = w;
+	header.h = h;
+	header.reserved = 0;
+	header.png_size = png_size;
+
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(pixels.data(), pixels.size(), 1, fp);
+	fclose(fp);
+}
+
+std::size_t GSTextureReplacements::KeyHash::operator()(const Key& key) const
+{
+	return static_cast<std::size_t>(key.hash ^ (key.TEX0 * 0x9e3779b97f4a7c15ull) ^ (key.TEXA << 1));
+}
+
+GSTextureReplacements::GSTextureReplacements(GSDevice* dev, const std::string& dir)
+	: m_dev(dev)
+	, m_dir(dir)
+	, m_memory_usage(0)
+	, m_has_done(false)
+{
+	const std::string cache = m_dir + "/cache";
+#ifdef _WIN32
+	GSmkdir(convert_utf8_to_utf16(cache).c_str());
+#else
+	GSmkdir(cache.c_str());
+#endif
+
+	m_loader = std::unique_ptr<Loader>(new Loader([this](Key& key) { Load(key); }));
+}
+
+GSTextureReplacements::~GSTextureReplacements()
+{
+	m_loader.reset();
+
+	for (auto& it : m_entries)
+	{
+		if (it.second.texture)
+			m_dev->Recycle(it.second.texture);
+	}
+}
+
+std::string GSTextureReplacements::GetName(const Key& key) const
+{
+	char name[64];
+	snprintf(name, sizeof(name), "%016llx-%016llx-%016llx", key.TEX0, key.TEXA, key.hash);
+	return name;
+}
+
+// Runs on the loader thread
+void GSTextureReplacements::Load(const Key& key)
+{
+	Image img;
+	img.key = key;
+	img.w = 0;
+	img.h = 0;
+
+	const std::string name = GetName(key);
+	const std::string png = m_dir + "/" + name + ".png";
+
+	if (FILE* fp = px_fopen(png, "rb"))
+	{
+		fseek(fp, 0, SEEK_END);
+		const uint64 png_size = ftell(fp);
+		fclose(fp);
+
+		const std::string cache = m_dir + "/cache/" + name + ".bin";
+
+		if (!ReadCache(cache, png_size, img.pixels, img.w, img.h))
+		{
+			if (GSPng::Load(png, img.pixels, img.w, img.h))
+				WriteCache(cache, png_size, img.pixels, img.w, img.h);
+			else
+				img.pixels.clear();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_done_lock);
+	m_done.push_back(std::move(img));
+	m_has_done = true;
+}
+
+void GSTextureReplacements::Collect()
+{
+	std::vector<Image> done;
+
+	{
+		std::lock_guard<std::mutex> lock(m_done_lock);
+		done.swap(m_done);
+		m_has_done = false;
+	}
+
+	for (Image& img : done)
+	{
+		Entry& e = m_entries[img.key];
+		e.state = State::Missing;
+
+		if (img.pixels.empty())
+			continue;
+
+		GSTexture* t = m_dev->CreateTexture(img.w, img.h);
+
+		if (t && t->Update(GSVector4i(0, 0, img.w, img.h), img.pixels.data(), img.w * 4))
+		{
+			e.state = State::Ready;
+			e.texture = t;
+			m_memory_usage += t->GetMemUsage();
+		}
+		else if (t)
+		{
+			m_dev->Recycle(t);
+		}
+	}
+}
+
+GSTexture* GSTextureReplacements::Lookup(const Key& key, bool& pending)
+{
+	if (m_has_done)
+		Collect();
+
+	auto it = m_entries.find(key);
+
+	if (it == m_entries.end())
+	{
+		// Asked again on the next lookup when the loader is full
+		if (m_loader->TryPush(key))
+			m_entries[key] = {State::Loading, nullptr};
+
+		pending = true;
+		return nullptr;
+	}
+
+	pending = it->second.state == State::Loading;
+	return it->second.texture;
+}
@@ -0,0 +1,91 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021 PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "GS/Renderers/Common/GSDevice.h"
+#include "GS/GSThread_CXX11.h"
+
+// Replacement textures of a pack, looked up by the content key of the hash cache. The pack
+// is a directory of "<TEX0>-<TEXA>-<hash>.png" files (16 hex digits each). The images are
+// decoded on a loader thread and uploaded on the next lookup, the caller keeps the original
+// texture until then. Decoded images are cached in "<pack>/cache" to skip the PNG decoding
+// on the next runs.
+class GSTextureReplacements
+{
+public:
+	struct Key
+	{
+		uint64 TEX0;
+		uint64 TEXA;
+		uint64 hash;
+
+		bool operator==(const Key& e) const { return TEX0 == e.TEX0 && TEXA == e.TEXA && hash == e.hash; }
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const;
+	};
+
+private:
+	enum class State
+	{
+		Loading,
+		Missing,
+		Ready
+	};
+
+	struct Entry
+	{
+		State state;
+		GSTexture* texture;
+	};
+
+	struct Image
+	{
+		Key key;
+		int w;
+		int h;
+		std::vector<uint8> pixels; // RGBA8, empty when the pack has no replacement
+	};
+
+	using Loader = GSJobQueue<Key, 256>;
+
+	GSDevice* m_dev;
+	std::string m_dir;
+	std::unordered_map<Key, Entry, KeyHash> m_entries;
+	uint64 m_memory_usage;
+
+	std::mutex m_done_lock;
+	std::vector<Image> m_done;
+	std::atomic<bool> m_has_done;
+
+	// Last member, the thread must be joined before the rest goes away
+	std::unique_ptr<Loader> m_loader;
+
+	std::string GetName(const Key& key) const;
+	void Load(const Key& key);
+	void Collect();
+
+public:
+	GSTextureReplacements(GSDevice* dev, const std::string& dir);
+	~GSTextureReplacements();
+
+	// Returns the replacement once it is uploaded. pending is set while it is still loading
+	GSTexture* Lookup(const Key& key, bool& pending);
+
+	uint64 GetMemUsage() const { return m_memory_usage; }
+};
@@ -38,8 +38,9 @@ namespace GLState
 	GLenum stencil_pass;
 
 	GLuint ubo;
+	UBORange ubo_range[24];
 
-	GLuint ps_ss;
+	GLuint ps_ss[2];
 
 	GLuint rt;
 	GLuint ds;
@@ -54,6 +55,11 @@ namespace GLState
 
 	int64 available_vram;
 
+	uint32 submitted;
+	uint32 elided;
+
+	std::function<void()> flush_batch;
+
 	void Clear()
 	{
 		fbo = 0;
@@ -76,8 +82,11 @@ namespace GLState
 		stencil_pass = 0xFFFF; // Note 0 is valid (GL_ZERO)
 
 		ubo = 0;
+		for (size_t i = 0; i < countof(ubo_range); i++)
+			ubo_range[i] = UBORange{0, 0, 0};
 
-		ps_ss = 0;
+		for (size_t i = 0; i < countof(ps_ss); i++)
+			ps_ss[i] = 0;
 
 		rt = 0;
 		ds = 0;
@@ -95,5 +104,8 @@ namespace GLState
 		// Set a max vram limit for texture allocation
 		// (256MB are reserved for PBO/IBO/VBO/UBO buffers)
 		available_vram = (4096u - 256u) * 1024u * 1024u;
+
+		submitted = 0;
+		elided = 0;
 	}
 } // namespace GLState
@@ -17,6 +17,7 @@
 
 #include "GS/GS.h"
 #include "GS/GSVector.h"
+#include <functional>
 
 namespace GLState
 {
@@ -40,8 +41,17 @@ namespace GLState
 	extern GLenum stencil_pass;
 
 	extern GLuint ubo; // uniform buffer object
+	struct UBORange
+	{
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size; // 0 for a whole buffer binding
 
-	extern GLuint ps_ss; // sampler
+		bool operator==(const UBORange& r) const { return buffer == r.buffer && offset == r.offset && size == r.size; }
+	};
+	extern UBORange ubo_range[24]; // indexed uniform buffer bindings
+
+	extern GLuint ps_ss[2]; // sampler per unit
 
 	extern GLuint rt; // render target
 	extern GLuint ds; // Depth-Stencil
@@ -56,5 +66,50 @@ namespace GLState
 
 	extern int64 available_vram;
 
+	// GL state calls issued/skipped since the last drain into GSPerfMon
+	extern uint32 submitted;
+	extern uint32 elided;
+
+	// Update the shadow copy of a state. Return true when the GL call must be issued
+	template <typename T>
+	inline bool Changed(T& shadow, const T& value)
+	{
+		if (shadow == value)
+		{
+			elided++;
+			return false;
+		}
+
+		shadow = value;
+		submitted++;
+		return true;
+	}
+
+	inline bool Changed(GSVector4i& shadow, const GSVector4i& value)
+	{
+		if (shadow.eq(value))
+		{
+			elided++;
+			return false;
+		}
+
+		shadow = value;
+		submitted++;
+		return true;
+	}
+
+	inline bool ChangedUBO(GLuint index, GLuint buffer, GLintptr offset = 0, GLsizeiptr size = 0)
+	{
+		ASSERT(index < countof(ubo_range));
+		return Changed(ubo_range[index], UBORange{buffer, offset, size});
+	}
+
+	extern std::function<void()> flush_batch; // submit the draws the device still holds back
+	inline void FlushBatch()
+	{
+		if (flush_batch)
+			flush_batch();
+	}
+
 	extern void Clear();
 } // namespace GLState
@@ -18,6 +18,7 @@
 #include "GSDeviceOGL.h"
 #include "GLState.h"
 #include "GS/GSUtil.h"
+#include "GS/GSTables.h"
 #include <fstream>
 
 //#define ONLY_LINES
@@ -41,6 +42,11 @@ static const uint32 g_fx_cb_index        = 14;
 static const uint32 g_convert_index      = 15;
 static const uint32 g_vs_cb_index        = 20;
 static const uint32 g_ps_cb_index        = 21;
+static const uint32 g_vram_cb_index      = 23;
+
+// Layout of vram_unswizzle.glsl LUT buffer
+static const uint32 g_vram_lut_column    = 32;
+static const uint32 g_vram_lut_clut      = 32 + 512;
 
 bool  GSDeviceOGL::m_debug_gl_call = false;
 int   GSDeviceOGL::m_shader_inst = 0;
@@ -52,6 +58,7 @@ GSDeviceOGL::GSDeviceOGL()
 	, m_fbo(0)
 	, m_fbo_read(0)
 	, m_va(NULL)
+	, m_base_vertex(0)
 	, m_apitrace(0)
 	, m_palette_ss(0)
 	, m_vs_cb(NULL)
@@ -64,9 +71,27 @@ GSDeviceOGL::GSDeviceOGL()
 	memset(&m_fxaa, 0, sizeof(m_fxaa));
 	memset(&m_shaderfx, 0, sizeof(m_shaderfx));
 	memset(&m_date, 0, sizeof(m_date));
-	memset(&m_shadeboost, 0, sizeof(m_shadeboost));
 	memset(&m_om_dss, 0, sizeof(m_om_dss));
 	memset(&m_profiler, 0, sizeof(m_profiler));
+	memset(&m_batch, 0, sizeof(m_batch));
+	memset(&m_vram_mirror, 0, sizeof(m_vram_mirror));
+	memset(&m_draw_timer, 0, sizeof(m_draw_timer));
+	m_async_ps.ctx = nullptr;
+	m_async_ps.ctx_attached = false;
+	m_async_ps.done_count = 0;
+	m_present.ctx = nullptr;
+	m_present.ctx_attached = false;
+	m_present.fbo = 0;
+	m_present.count = 0;
+	m_present.current = 0;
+	for (int i = 0; i <= MAX_PRESENT_FRAMES; i++)
+	{
+		m_present.frame[i] = nullptr;
+		m_present.ready[i] = 0;
+		m_present.done[i] = 0;
+		m_present.busy[i] = false;
+	}
+	m_present.seq = 0;
 	GLState::Clear();
 
 	m_mipmap = theApp.GetConfigI("mipmap");
@@ -86,10 +111,15 @@ GSDeviceOGL::GSDeviceOGL()
 	m_debug_gl_call = theApp.GetConfigB("debug_opengl");
 
 	m_disable_hw_gl_draw = theApp.GetConfigB("disable_hw_gl_draw");
+
+	m_batch_enabled = theApp.GetConfigB("draw_batching");
 }
 
 GSDeviceOGL::~GSDeviceOGL()
 {
+	// Textures still alive (pool) are released after the device
+	GLState::flush_batch = nullptr;
+
 	if (m_debug_gl_file)
 	{
 		fclose(m_debug_gl_file);
@@ -102,6 +132,9 @@ GSDeviceOGL::~GSDeviceOGL()
 
 	GL_PUSH("GSDeviceOGL destructor");
 
+	// Before the textures, the present thread might still read a frame
+	DestroyPresentThread();
+
 	// Clean vertex buffer state
 	delete m_va;
 
@@ -134,6 +167,16 @@ GSDeviceOGL::~GSDeviceOGL()
 	delete m_ps_cb;
 	glDeleteSamplers(1, &m_palette_ss);
 
+	// Clean m_vram_mirror
+	delete m_vram_mirror.cb;
+	glDeleteBuffers(1, &m_vram_mirror.vm);
+	glDeleteBuffers(1, &m_vram_mirror.lut);
+
+	if (m_draw_timer.enabled)
+		glDeleteQueries(countof(m_draw_timer.query), m_draw_timer.query);
+
+	DestroyAsyncShaderCompiler();
+
 	m_ps.clear();
 
 	glDeleteSamplers(countof(m_ps_ss), m_ps_ss);
@@ -335,6 +378,9 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 
 		m_shader = new GSShaderOGL(theApp.GetConfigB("debug_glsl_shader"));
 
+		if (theApp.GetConfigB("shader_cache"))
+			m_shader->LoadBinaryCache(theApp.GetCachePath("GS_OGL_shader_cache.bin"));
+
 		glGenFramebuffers(1, &m_fbo);
 		// Always write to the first buffer
 		OMSetFBO(m_fbo);
@@ -353,6 +399,12 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 		{
 			glCreateQueries(GL_TIMESTAMP, 1 << 16, m_profiler.timer_query);
 		}
+
+		m_draw_timer.enabled = theApp.GetConfigB("gpu_draw_profiling");
+		if (m_draw_timer.enabled)
+		{
+			glCreateQueries(GL_TIMESTAMP, countof(m_draw_timer.query), m_draw_timer.query);
+		}
 	}
 
 	// ****************************************************************
@@ -375,6 +427,9 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 		m_va = new GSVertexBufferStateOGL(il_convert);
 	}
 
+	// Texture updates and readbacks must see the draws held back by the batch
+	GLState::flush_batch = [this]() { FlushBatch(); };
+
 	// ****************************************************************
 	// Pre Generate the different sampler object
 	// ****************************************************************
@@ -455,20 +510,7 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 
 		theApp.LoadResource(IDR_INTERLACE_GLSL, shader);
 
-		for (size_t i = 0; i < countof(m_interlace.ps); i++)
-		{
-			ps = m_shader->Compile("interlace.glsl", format("ps_main%d", i), GL_FRAGMENT_SHADER, shader.data());
-			std::string pretty_name = "Interlace pipe " + std::to_string(i);
-			m_interlace.ps[i] = m_shader->LinkPipeline(pretty_name, vs, 0, ps);
-		}
-	}
-
-	// ****************************************************************
-	// Shade boost
-	// ****************************************************************
-	{
-		GL_PUSH("GSDeviceOGL::Shadeboost");
-
+		// Shade boost and the luma for FXAA are folded into the pass, one set per combination
 		int ShadeBoost_Contrast = std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Contrast"), 100));
 		int ShadeBoost_Brightness = std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Brightness"), 100));
 		int ShadeBoost_Saturation = std::max(0, std::min(theApp.GetConfigI("ShadeBoost_Saturation"), 100));
@@ -476,10 +518,19 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 			+ format("#define SB_BRIGHTNESS %d.0\n", ShadeBoost_Brightness)
 			+ format("#define SB_CONTRAST %d.0\n", ShadeBoost_Contrast);
 
-		theApp.LoadResource(IDR_SHADEBOOST_GLSL, shader);
+		for (int fx = 0; fx < OutputFX_Count; fx++)
+		{
+			std::string macro = shade_macro
+				+ format("#define PS_SHADEBOOST %d\n", !!(fx & OutputFX_ShadeBoost))
+				+ format("#define PS_LUMA %d\n", !!(fx & OutputFX_Luma));
 
-		ps = m_shader->Compile("shadeboost.glsl", "ps_main", GL_FRAGMENT_SHADER, shader.data(), shade_macro);
-		m_shadeboost.ps = m_shader->LinkPipeline("ShadeBoost pipe", vs, 0, ps);
+			for (size_t i = 0; i < countof(m_interlace.ps[fx]); i++)
+			{
+				ps = m_shader->Compile("interlace.glsl", format("ps_main%d", i), GL_FRAGMENT_SHADER, shader.data(), macro);
+				std::string pretty_name = "Interlace pipe " + std::to_string(fx) + "/" + std::to_string(i);
+				m_interlace.ps[fx][i] = m_shader->LinkPipeline(pretty_name, vs, 0, ps);
+			}
+		}
 	}
 
 	// ****************************************************************
@@ -529,6 +580,15 @@ bool GSDeviceOGL::Create(const std::shared_ptr<GSWnd>& wnd)
 	// ****************************************************************
 	CreateTextureFX();
 
+	if (theApp.GetConfigB("gpu_unswizzle"))
+		CreateLocalMemoryMirror();
+
+	if (theApp.GetConfigB("async_shader_compile"))
+		CreateAsyncShaderCompiler();
+
+	if (theApp.GetConfigB("threaded_present"))
+		CreatePresentThread();
+
 	// ****************************************************************
 	// Pbo Pool allocation
 	// ****************************************************************
@@ -610,6 +670,7 @@ void GSDeviceOGL::CreateTextureFX()
 
 	// warning 1 sampler by image unit. So you cannot reuse m_ps_ss...
 	m_palette_ss = CreateSampler(PSSamplerSelector(0));
+	GLState::ps_ss[1] = m_palette_ss;
 	glBindSampler(1, m_palette_ss);
 
 	// Pre compile the (remaining) Geometry & Vertex Shader
@@ -637,9 +698,20 @@ void GSDeviceOGL::CreateTextureFX()
 
 bool GSDeviceOGL::Reset(int w, int h)
 {
+	// m_backbuffer is one of the frames, GSDevice::Reset releases it
+	DestroyPresentFrames();
+
 	if (!GSDevice::Reset(w, h))
 		return false;
 
+	if (m_present.queue)
+	{
+		// The frames are regular render targets, the present thread copies them in the window
+		CreatePresentFrames(w, h);
+		m_backbuffer = m_present.frame[m_present.current];
+		return true;
+	}
+
 	// Opengl allocate the backbuffer with the window. The render is done in the backbuffer when
 	// there isn't any FBO. Only a dummy texture is created to easily detect when the rendering is done
 	// in the backbuffer
@@ -655,7 +727,12 @@ void GSDeviceOGL::SetVSync(int vsync)
 
 void GSDeviceOGL::Flip()
 {
-	m_wnd->Flip();
+	FlushBatch();
+
+	if (m_present.queue)
+		QueuePresent();
+	else
+		m_wnd->Flip();
 
 	if (GLLoader::in_replayer)
 	{
@@ -664,8 +741,62 @@ void GSDeviceOGL::Flip()
 	}
 }
 
+bool GSDeviceOGL::BeginDrawTimer()
+{
+	// Drop the measure when the ring is full, results are read back at the vsync
+	if (!m_draw_timer.enabled || m_draw_timer.head - m_draw_timer.tail >= countof(m_draw_timer.timing))
+		return false;
+
+	// A batched draw would be submitted outside of the timestamps
+	FlushBatch();
+
+	const uint32 i = m_draw_timer.head % countof(m_draw_timer.timing);
+	glQueryCounter(m_draw_timer.query[2 * i], GL_TIMESTAMP);
+
+	return true;
+}
+
+void GSDeviceOGL::EndDrawTimer(uint64 frame, uint64 shader, uint32 rt)
+{
+	FlushBatch();
+
+	const uint32 i = m_draw_timer.head % countof(m_draw_timer.timing);
+	glQueryCounter(m_draw_timer.query[2 * i + 1], GL_TIMESTAMP);
+
+	m_draw_timer.timing[i].frame = frame;
+	m_draw_timer.timing[i].shader = shader;
+	m_draw_timer.timing[i].rt = rt;
+	m_draw_timer.head++;
+}
+
+void GSDeviceOGL::ResolveDrawTimers(std::vector<DrawTiming>& timings)
+{
+	// Results are available in order, stop at the first pending one
+	while (m_draw_timer.tail != m_draw_timer.head)
+	{
+		const uint32 i = m_draw_timer.tail % countof(m_draw_timer.timing);
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(m_draw_timer.query[2 * i + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		GLuint64 time_start;
+		GLuint64 time_end;
+		glGetQueryObjectui64v(m_draw_timer.query[2 * i], GL_QUERY_RESULT, &time_start);
+		glGetQueryObjectui64v(m_draw_timer.query[2 * i + 1], GL_QUERY_RESULT, &time_end);
+
+		DrawTiming t = m_draw_timer.timing[i];
+		t.ms = (double)(time_end - time_start) * 0.000001;
+		timings.push_back(t);
+
+		m_draw_timer.tail++;
+	}
+}
+
 void GSDeviceOGL::BeforeDraw()
 {
+	FlushBatch();
 }
 
 void GSDeviceOGL::AfterDraw()
@@ -690,7 +821,7 @@ void GSDeviceOGL::DrawIndexedPrimitive()
 {
 	BeforeDraw();
 	if (!m_disable_hw_gl_draw)
-		m_va->DrawIndexedPrimitive();
+		m_va->DrawIndexedPrimitive(m_base_vertex);
 	AfterDraw();
 }
 
@@ -700,10 +831,50 @@ void GSDeviceOGL::DrawIndexedPrimitive(int offset, int count)
 
 	BeforeDraw();
 	if (!m_disable_hw_gl_draw)
-		m_va->DrawIndexedPrimitive(offset, count);
+		m_va->DrawIndexedPrimitive(m_base_vertex, offset, count);
 	AfterDraw();
 }
 
+bool GSDeviceOGL::BatchIndexedPrimitive()
+{
+	if (!m_batch_enabled || m_disable_hw_gl_draw)
+	{
+		DrawIndexedPrimitive();
+		return false;
+	}
+
+	// Any state change since the previous draw already flushed the batch, so
+	// an index range that follows it directly can simply be appended
+	const size_t start = m_va->GetIBStart();
+	const size_t count = m_va->GetIBCount();
+
+	if (m_batch.draws && m_batch.vb_start == (size_t)m_base_vertex && m_batch.ib_start + m_batch.ib_count == start && m_batch.topology == m_va->GetTopology())
+	{
+		m_batch.ib_count += count;
+		m_batch.draws++;
+		return true;
+	}
+
+	FlushBatch();
+
+	m_batch.topology = m_va->GetTopology();
+	m_batch.vb_start = m_base_vertex;
+	m_batch.ib_start = start;
+	m_batch.ib_count = count;
+	m_batch.draws = 1;
+
+	return false;
+}
+
+void GSDeviceOGL::SubmitBatch()
+{
+	GL_PUSH("Batch of %u draws", m_batch.draws);
+
+	m_va->DrawIndexedRange(m_batch.topology, m_batch.vb_start, m_batch.ib_start, m_batch.ib_count);
+
+	m_batch.draws = 0;
+}
+
 void GSDeviceOGL::ClearRenderTarget(GSTexture* t, const GSVector4& c)
 {
 	if (!t)
@@ -722,6 +893,8 @@ void GSDeviceOGL::ClearRenderTarget(GSTexture* t, const GSVector4& c)
 
 	GL_PUSH("Clear RT %d", T->GetID());
 
+	FlushBatch();
+
 	// TODO: check size of scissor before toggling it
 	glDisable(GL_SCISSOR_TEST);
 
@@ -769,6 +942,8 @@ void GSDeviceOGL::ClearDepth(GSTexture* t)
 
 	GL_PUSH("Clear Depth %d", T->GetID());
 
+	FlushBatch();
+
 	if (0 && GLLoader::found_GL_ARB_clear_texture)
 	{
 		// I don't know what the driver does but it creates
@@ -815,6 +990,8 @@ void GSDeviceOGL::ClearStencil(GSTexture* t, uint8 c)
 
 	GL_PUSH("Clear Stencil %d", T->GetID());
 
+	FlushBatch();
+
 	// Keep SCISSOR_TEST enabled on purpose to reduce the size
 	// of clean in DATE (impact big upscaling)
 	OMSetFBO(m_fbo);
@@ -824,6 +1001,151 @@ void GSDeviceOGL::ClearStencil(GSTexture* t, uint8 c)
 	glClearBufferiv(GL_STENCIL, 0, &color);
 }
 
+void GSDeviceOGL::CreateLocalMemoryMirror()
+{
+	if (!GLLoader::found_GL_ARB_compute_shader || !GLLoader::found_GL_ARB_shader_storage_buffer_object || !GLLoader::found_GL_ARB_shader_image_load_store)
+	{
+		fprintf(stderr, "GPU unswizzle requires compute shaders and image load/store, disabled\n");
+		return;
+	}
+
+	GL_PUSH("GSDeviceOGL::VRAMMirror");
+
+	std::vector<char> shader;
+	theApp.LoadResource(IDR_VRAM_UNSWIZZLE_GLSL, shader);
+
+	m_vram_mirror.cs[0] = m_shader->Compile("vram_unswizzle.glsl", "cs_main", GL_COMPUTE_SHADER, shader.data(), "#define PS_INDEX 0\n");
+	m_vram_mirror.cs[1] = m_shader->Compile("vram_unswizzle.glsl", "cs_main", GL_COMPUTE_SHADER, shader.data(), "#define PS_INDEX 1\n");
+
+	m_vram_mirror.cb = new GSUniformBufferOGL("VRAM unswizzle UBO", g_vram_cb_index, sizeof(VRAMUnswizzleConstantBuffer));
+
+	// Both buffers stay bound on their slot, nothing else uses storage buffers
+	glGenBuffers(1, &m_vram_mirror.vm);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vram_mirror.vm);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, VM_SIZE, NULL, GL_DYNAMIC_STORAGE_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_vram_mirror.vm);
+
+	glGenBuffers(1, &m_vram_mirror.lut);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vram_mirror.lut);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, (g_vram_lut_clut + 256) * sizeof(uint32), NULL, GL_DYNAMIC_STORAGE_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_vram_mirror.lut);
+
+	// Nothing was uploaded yet
+	memset(m_vram_mirror.dirty, 0xff, sizeof(m_vram_mirror.dirty));
+	m_vram_mirror.psm = -1;
+
+	m_vram_mirror.enabled = true;
+}
+
+void GSDeviceOGL::InvalidateLocalMemoryMirror(const uint32* pages)
+{
+	for (size_t i = 0; i < countof(m_vram_mirror.dirty); i++)
+		m_vram_mirror.dirty[i] |= pages[i];
+}
+
+bool GSDeviceOGL::ReadLocalMemoryMirror(GSTexture* t, const GSVector4i& r, int layer, const uint8* vm, const uint32* clut, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, bool palette)
+{
+	// Swizzle of each format: bits per pixel, page and block size (log2), tables, read shift/mask
+	struct Layout
+	{
+		uint32 bpp, pw, ph, bw, bh;
+		const uint8* block;
+		const void* column;
+		uint32 shift, mask, mode;
+	};
+
+	enum { Direct = 0, Clut = 1, Alpha24 = 2, Alpha16 = 3 };
+
+	if (!m_vram_mirror.enabled || layer != 0)
+		return false;
+
+	Layout l;
+
+	switch (TEX0.PSM)
+	{
+		case PSM_PSMCT32:  l = {32, 6, 5, 3, 3, &blockTable32[0][0],    columnTable32, 0, 0xffffffff, Direct};  break;
+		case PSM_PSMCT24:  l = {32, 6, 5, 3, 3, &blockTable32[0][0],    columnTable32, 0, 0xffffffff, Alpha24}; break;
+		case PSM_PSMCT16:  l = {16, 6, 6, 4, 3, &blockTable16[0][0],    columnTable16, 0, 0xffff,     Alpha16}; break;
+		case PSM_PSMCT16S: l = {16, 6, 6, 4, 3, &blockTable16S[0][0],   columnTable16, 0, 0xffff,     Alpha16}; break;
+		case PSM_PSMZ32:   l = {32, 6, 5, 3, 3, &blockTable32Z[0][0],   columnTable32, 0, 0xffffffff, Direct};  break;
+		case PSM_PSMZ24:   l = {32, 6, 5, 3, 3, &blockTable32Z[0][0],   columnTable32, 0, 0xffffffff, Alpha24}; break;
+		case PSM_PSMZ16:   l = {16, 6, 6, 4, 3, &blockTable16Z[0][0],   columnTable16, 0, 0xffff,     Alpha16}; break;
+		case PSM_PSMZ16S:  l = {16, 6, 6, 4, 3, &blockTable16SZ[0][0],  columnTable16, 0, 0xffff,     Alpha16}; break;
+		case PSM_PSMT8:    l = { 8, 7, 6, 4, 4, &blockTable8[0][0],     columnTable8,  0, 0xff,       Clut};    break;
+		case PSM_PSMT4:    l = { 4, 7, 7, 5, 4, &blockTable4[0][0],     columnTable4,  0, 0xf,        Clut};    break;
+		case PSM_PSMT8H:   l = {32, 6, 5, 3, 3, &blockTable32[0][0],    columnTable32, 24, 0xff,      Clut};    break;
+		case PSM_PSMT4HL:  l = {32, 6, 5, 3, 3, &blockTable32[0][0],    columnTable32, 24, 0xf,       Clut};    break;
+		case PSM_PSMT4HH:  l = {32, 6, 5, 3, 3, &blockTable32[0][0],    columnTable32, 28, 0xf,       Clut};    break;
+		default:
+			return false;
+	}
+
+	if (palette != (l.mode == Clut))
+		return false;
+
+	GL_PUSH("VRAM unswizzle %s %d,%d => %d,%d", psm_str(TEX0.PSM), r.x, r.y, r.z, r.w);
+
+	FlushBatch();
+
+	// Refresh the modified pages of the copy
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vram_mirror.vm);
+	for (uint32 page = 0; page < MAX_PAGES;)
+	{
+		if ((m_vram_mirror.dirty[page >> 5] & (1u << (page & 31))) == 0)
+		{
+			page++;
+			continue;
+		}
+
+		uint32 first = page;
+		while (page < MAX_PAGES && (m_vram_mirror.dirty[page >> 5] & (1u << (page & 31))))
+			page++;
+
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * PAGE_SIZE, (page - first) * PAGE_SIZE, vm + first * PAGE_SIZE);
+	}
+	memset(m_vram_mirror.dirty, 0, sizeof(m_vram_mirror.dirty));
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_vram_mirror.lut);
+	if (m_vram_mirror.psm != static_cast<int>(TEX0.PSM))
+	{
+		uint32 lut[g_vram_lut_clut];
+		const uint32 blocks = 1 << (l.bw + l.bh);
+
+		for (uint32 i = 0; i < 32; i++)
+			lut[i] = l.block[i];
+		for (uint32 i = 0; i < blocks; i++)
+			lut[g_vram_lut_column + i] = l.bpp == 4 ? static_cast<const uint16*>(l.column)[i] : static_cast<const uint8*>(l.column)[i];
+
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, (g_vram_lut_column + blocks) * sizeof(uint32), lut);
+		m_vram_mirror.psm = TEX0.PSM;
+	}
+
+	if (l.mode == Clut && !palette)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, g_vram_lut_clut * sizeof(uint32), 256 * sizeof(uint32), clut);
+
+	VRAMUnswizzleConstantBuffer cb;
+	cb.Rect = r;
+	cb.Layout = GSVector4i(TEX0.TBP0, l.bpp >= 16 ? TEX0.TBW : TEX0.TBW >> 1, l.bpp, l.bw + l.bh);
+	cb.Geometry = GSVector4i(l.pw, l.ph, l.bw, l.bh);
+	cb.Tables = GSVector4i(0, g_vram_lut_column, l.shift, l.mask);
+	cb.Alpha = GSVector4i(TEXA.TA0, TEXA.TA1, TEXA.AEM, palette ? Direct : l.mode);
+	m_vram_mirror.cb->cache_upload(&cb);
+
+	GSTextureOGL* T = static_cast<GSTextureOGL*>(t);
+	T->CommitRegion(GSVector2i(r.z, r.w));
+	T->WasAttached();
+
+	glBindImageTexture(3, T->GetID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, palette ? GL_R8 : GL_RGBA8);
+
+	m_shader->BindProgram(m_vram_mirror.cs[palette]);
+	glDispatchCompute((r.width() + 7) >> 3, (r.height() + 7) >> 3, 1);
+	m_shader->BindProgram(0);
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+
+	return true;
+}
+
 GLuint GSDeviceOGL::CreateSampler(PSSamplerSelector sel)
 {
 	GL_PUSH("Create Sampler");
@@ -929,6 +1251,8 @@ GSDepthStencilOGL* GSDeviceOGL::CreateDepthStencil(OMDepthStencilSelector dssel)
 
 void GSDeviceOGL::InitPrimDateTexture(GSTexture* rt, const GSVector4i& area)
 {
+	FlushBatch();
+
 	const GSVector2i& rtsize = rt->GetSize();
 
 	// Create a texture to avoid the useless clean@0
@@ -959,6 +1283,7 @@ void GSDeviceOGL::RecycleDateTexture()
 
 void GSDeviceOGL::Barrier(GLbitfield b)
 {
+	FlushBatch();
 	glMemoryBarrier(b);
 }
 
@@ -1028,7 +1353,350 @@ GLuint GSDeviceOGL::CompilePS(PSSelector sel)
 	if (GLLoader::buggy_sso_dual_src)
 		return m_shader->CompileShader("tfx.glsl", "ps_main", GL_FRAGMENT_SHADER, m_shader_tfx_fs.data(), macro);
 	else
-		return m_shader->Compile("tfx.glsl", "ps_main", GL_FRAGMENT_SHADER, m_shader_tfx_fs.data(), macro);
+		return m_shader->Compile("tfx.glsl", "ps_main", GL_FRAGMENT_SHADER, m_shader_tfx_fs.data(), macro, sel.key);
+}
+
+// Impossible selector (free bits are set), used to release the shared context on the worker thread
+static const uint64 s_async_ps_release = ~0ull;
+
+void GSDeviceOGL::CreateAsyncShaderCompiler()
+{
+	// Shaders are linked as a full program on the buggy path, only separate
+	// programs can be compiled ahead.
+	if (GLLoader::buggy_sso_dual_src)
+		return;
+
+	GSWndGL* wnd = dynamic_cast<GSWndGL*>(m_wnd.get());
+	m_async_ps.ctx = wnd ? wnd->CreateSharedContext() : nullptr;
+	if (!m_async_ps.ctx)
+	{
+		fprintf(stderr, "Async shader compilation is disabled (no shared GL context)\n");
+		return;
+	}
+
+	m_async_ps.queue = std::make_unique<GSJobQueue<uint64, 256>>([this](uint64& sel) { CompileAsyncPS(sel); });
+
+	// Recreate the pixel shaders of the previous sessions from the binary cache in
+	// the background so they don't need to be compiled in the middle of a frame.
+	// Without the worker, they are still loaded from the cache on first use.
+	m_async_ps.warm = m_shader->GetCachedSelectors(GL_FRAGMENT_SHADER);
+}
+
+void GSDeviceOGL::DestroyAsyncShaderCompiler()
+{
+	if (!m_async_ps.queue)
+		return;
+
+	m_async_ps.queue->Push(s_async_ps_release);
+	m_async_ps.queue->Wait();
+	m_async_ps.queue.reset();
+
+	static_cast<GSWndGL*>(m_wnd.get())->DestroySharedContext(m_async_ps.ctx);
+	m_async_ps.ctx = nullptr;
+
+	// Programs are owned by m_shader, only the fences remain
+	for (const AsyncPS& ps : m_async_ps.done)
+	{
+		if (ps.fence)
+			glDeleteSync(ps.fence);
+	}
+	m_async_ps.done.clear();
+	m_async_ps.pending.clear();
+	m_async_ps.warm.clear();
+	m_async_ps.done_count = 0;
+}
+
+// Called on the worker thread
+void GSDeviceOGL::CompileAsyncPS(uint64& sel)
+{
+	GSWndGL* wnd = static_cast<GSWndGL*>(m_wnd.get());
+
+	if (sel == s_async_ps_release)
+	{
+		if (m_async_ps.ctx_attached)
+			wnd->DetachSharedContext();
+		m_async_ps.ctx_attached = false;
+		return;
+	}
+
+	if (!m_async_ps.ctx_attached)
+		m_async_ps.ctx_attached = wnd->AttachSharedContext(m_async_ps.ctx);
+
+	AsyncPS result = {sel, 0, 0};
+
+	// On failure the GS thread will compile it synchronously
+	if (m_async_ps.ctx_attached)
+	{
+		PSSelector psel;
+		psel.key = sel;
+
+		result.ps = CompilePS(psel);
+		// The program is only guaranteed to be complete in the other context once the fence is reached
+		result.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+	}
+
+	std::lock_guard<std::mutex> l(m_async_ps.lock);
+	m_async_ps.done.push_back(result);
+	m_async_ps.done_count++;
+}
+
+void GSDeviceOGL::CreatePresentThread()
+{
+	GSWndGL* wnd = dynamic_cast<GSWndGL*>(m_wnd.get());
+	m_present.ctx = wnd ? wnd->CreateSharedContext() : nullptr;
+	if (!m_present.ctx)
+	{
+		fprintf(stderr, "Threaded presentation is disabled (no shared GL context)\n");
+		return;
+	}
+
+	// The GS thread renders in the frames, the surface belongs to the present thread
+	if (!wnd->DetachSurface())
+	{
+		fprintf(stderr, "Threaded presentation is disabled (window surface can't be released)\n");
+		wnd->DestroySharedContext(m_present.ctx);
+		m_present.ctx = nullptr;
+		return;
+	}
+
+	m_present.count = std::max(1, std::min(theApp.GetConfigI("present_queue_size"), MAX_PRESENT_FRAMES)) + 1;
+	m_present.queue = std::make_unique<GSJobQueue<PresentJob, 8>>([this](PresentJob& job) { ExecutePresent(job); });
+}
+
+void GSDeviceOGL::DestroyPresentThread()
+{
+	if (!m_present.queue)
+		return;
+
+	m_present.queue->Push(PresentJob{-1, 0});
+	m_present.queue->Wait();
+	m_present.queue.reset();
+
+	static_cast<GSWndGL*>(m_wnd.get())->DestroySharedContext(m_present.ctx);
+	m_present.ctx = nullptr;
+
+	DestroyPresentFrames();
+}
+
+void GSDeviceOGL::CreatePresentFrames(int w, int h)
+{
+	for (int i = 0; i < m_present.count; i++)
+		m_present.frame[i] = CreateSurface(GSTexture::RenderTarget, w, h, GL_RGBA8);
+
+	m_present.current = 0;
+}
+
+void GSDeviceOGL::DestroyPresentFrames()
+{
+	if (m_present.queue)
+		m_present.queue->Wait();
+
+	for (int i = 0; i <= MAX_PRESENT_FRAMES; i++)
+	{
+		// The current frame is owned by m_backbuffer
+		if (m_present.frame[i] != m_backbuffer)
+			delete m_present.frame[i];
+		m_present.frame[i] = nullptr;
+
+		if (m_present.ready[i])
+			glDeleteSync(m_present.ready[i]);
+		if (m_present.done[i])
+			glDeleteSync(m_present.done[i]);
+		m_present.ready[i] = 0;
+		m_present.done[i] = 0;
+	}
+}
+
+void GSDeviceOGL::QueuePresent()
+{
+	const int i = m_present.current;
+
+	// The present context waits on it before reading the frame
+	m_present.ready[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+
+	{
+		std::lock_guard<std::mutex> l(m_present.lock);
+		m_present.busy[i] = true;
+	}
+	m_present.queue->Push(PresentJob{i, ++m_present.seq});
+
+	// A newer frame makes the present thread skip the older ones, so the GS
+	// thread only waits when present_queue_size frames are queued
+	const int next = (i + 1) % m_present.count;
+	{
+		std::unique_lock<std::mutex> l(m_present.lock);
+		m_present.released.wait(l, [&] { return !m_present.busy[next]; });
+	}
+
+	if (m_present.done[next])
+	{
+		glWaitSync(m_present.done[next], 0, GL_TIMEOUT_IGNORED);
+		glDeleteSync(m_present.done[next]);
+		m_present.done[next] = 0;
+	}
+
+	m_present.current = next;
+	m_backbuffer = m_present.frame[next];
+}
+
+// Called on the present thread
+void GSDeviceOGL::ExecutePresent(PresentJob& job)
+{
+	GSWndGL* wnd = static_cast<GSWndGL*>(m_wnd.get());
+
+	if (job.frame < 0)
+	{
+		if (m_present.ctx_attached)
+		{
+			glDeleteFramebuffers(1, &m_present.fbo);
+			wnd->DetachSharedContext();
+		}
+		m_present.ctx_attached = false;
+		return;
+	}
+
+	if (!m_present.ctx_attached)
+	{
+		m_present.ctx_attached = wnd->AttachPresentContext(m_present.ctx);
+		if (m_present.ctx_attached)
+		{
+			// Framebuffers aren't shared between contexts
+			glGenFramebuffers(1, &m_present.fbo);
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, m_present.fbo);
+			glReadBuffer(GL_COLOR_ATTACHMENT0);
+		}
+		else
+		{
+			fprintf(stderr, "Failed to attach the present context, frames are dropped\n");
+		}
+	}
+
+	const int i = job.frame;
+
+	// Mailbox: skip the frame when a newer one is already queued
+	if (m_present.ctx_attached && job.seq == m_present.seq)
+	{
+		GSTexture* t = m_present.frame[i];
+		const int w = t->GetWidth();
+		const int h = t->GetHeight();
+
+		glWaitSync(m_present.ready[i], 0, GL_TIMEOUT_IGNORED);
+
+		// Unlike the backbuffer the frame isn't rendered y flipped
+		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, static_cast<GSTextureOGL*>(t)->GetID(), 0);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(0, 0, w, h, 0, h, w, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+		m_present.done[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		wnd->Flip();
+	}
+
+	glDeleteSync(m_present.ready[i]);
+	m_present.ready[i] = 0;
+
+	{
+		std::lock_guard<std::mutex> l(m_present.lock);
+		m_present.busy[i] = false;
+	}
+	m_present.released.notify_one();
+}
+
+void GSDeviceOGL::PollAsyncPS()
+{
+	if (m_async_ps.done_count == 0)
+		return;
+
+	std::lock_guard<std::mutex> l(m_async_ps.lock);
+
+	for (auto it = m_async_ps.done.begin(); it != m_async_ps.done.end();)
+	{
+		if (it->fence)
+		{
+			if (glClientWaitSync(it->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				++it;
+				continue;
+			}
+			glDeleteSync(it->fence);
+		}
+
+		if (m_ps.find(it->sel) == m_ps.end())
+		{
+			PSSelector psel;
+			psel.key = it->sel;
+			m_ps[it->sel] = it->ps ? it->ps : CompilePS(psel);
+		}
+
+		m_async_ps.pending.erase(it->sel);
+		it = m_async_ps.done.erase(it);
+		m_async_ps.done_count--;
+	}
+}
+
+// Feed the worker with the cached selectors a few at a time, so the shaders
+// requested by the draws don't wait behind the whole cache
+void GSDeviceOGL::WarmAsyncPS()
+{
+	while (!m_async_ps.warm.empty() && m_async_ps.pending.size() < 4)
+	{
+		const uint64 sel = m_async_ps.warm.back();
+		m_async_ps.warm.pop_back();
+
+		if (m_ps.find(sel) == m_ps.end() && m_async_ps.pending.insert(sel).second)
+			m_async_ps.queue->Push(sel);
+	}
+}
+
+// Queues a missing shader to the worker and returns an already compiled shader of a
+// reduced selector to draw with until PollAsyncPS gets the real one. The reduced
+// selectors drop the effects a frame or two can do without (dithering, fog, bilinear
+// filtering and lod). Returns 0 when there is no such shader, or when the shader only
+// has to be loaded from the binary cache, which is quick enough to be done in place.
+GLuint GSDeviceOGL::GetFallbackPS(const PSSelector& sel)
+{
+	const bool pending = m_async_ps.pending.count(sel.key) != 0;
+
+	if (!pending && m_shader->HasCachedBinary(GL_FRAGMENT_SHADER, sel.key))
+		return 0;
+
+	PSSelector reduced = sel;
+	GLuint ps = 0;
+
+	for (int step = 0; step < 3 && ps == 0; step++)
+	{
+		switch (step)
+		{
+			case 0:
+				reduced.dither = 0;
+				break;
+			case 1:
+				reduced.fog = 0;
+				break;
+			case 2:
+				reduced.ltf = 0;
+				reduced.automatic_lod = 0;
+				reduced.manual_lod = 0;
+				break;
+		}
+
+		if (reduced.key == sel.key)
+			continue;
+
+		auto i = m_ps.find(reduced.key);
+		if (i != m_ps.end())
+			ps = i->second;
+	}
+
+	if (ps != 0 && !pending)
+	{
+		m_async_ps.pending.insert(sel.key);
+		m_async_ps.queue->Push(sel.key);
+	}
+
+	return ps;
 }
 
 void GSDeviceOGL::SelfShaderTestRun(const std::string& dir, const std::string& file, const PSSelector& sel, int& nb_shader)
@@ -1261,6 +1929,7 @@ GSTexture* GSDeviceOGL::CopyOffscreen(GSTexture* src, const GSVector4& sRect, in
 
 	// StretchRect will read an old target. However, the memory cache might contains
 	// invalid data (for example due to SW blending).
+	FlushBatch();
 	glTextureBarrier();
 
 	StretchRect(src, sRect, dst, dRect, m_convert.ps[ps_shader]);
@@ -1280,7 +1949,11 @@ void GSDeviceOGL::CopyRectConv(GSTexture* sTex, GSTexture* dTex, const GSVector4
 
 	GL_PUSH(format("CopyRectConv from %d to %d", sid, did).c_str());
 
+	FlushBatch();
+
 	dTex->CommitRegion(GSVector2i(r.z, r.w));
+	// The content changes (drop any pending download)
+	static_cast<GSTextureOGL*>(dTex)->WasAttached();
 
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_read);
 
@@ -1305,11 +1978,15 @@ void GSDeviceOGL::CopyRect(GSTexture* sTex, GSTexture* dTex, const GSVector4i& r
 
 	GL_PUSH("CopyRect from %d to %d", sid, did);
 
+	FlushBatch();
+
 #ifdef ENABLE_OGL_DEBUG
 	PSSetShaderResource(6, sTex);
 #endif
 
 	dTex->CommitRegion(GSVector2i(r.z, r.w));
+	// The content changes (drop any pending download)
+	static_cast<GSTextureOGL*>(dTex)->WasAttached();
 
 	ASSERT(GLExtension::Has("GL_ARB_copy_image") && glCopyImageSubData);
 	glCopyImageSubData(sid, GL_TEXTURE_2D,
@@ -1358,6 +2035,8 @@ void GSDeviceOGL::StretchRect(GSTexture* sTex, const GSVector4& sRect, GSTexture
 
 	GL_PUSH("StretchRect from %d to %d", sTex->GetID(), dTex->GetID());
 
+	FlushBatch();
+
 	// ************************************
 	// Init
 	// ************************************
@@ -1448,6 +2127,8 @@ void GSDeviceOGL::StretchRect(GSTexture* sTex, const GSVector4& sRect, GSTexture
 
 void GSDeviceOGL::RenderOsd(GSTexture* dt)
 {
+	FlushBatch();
+
 	BeginScene();
 
 	m_shader->BindPipeline(m_convert.ps[ShaderConvert_OSD]);
@@ -1481,6 +2162,8 @@ void GSDeviceOGL::DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex,
 {
 	GL_PUSH("DoMerge");
 
+	FlushBatch();
+
 	GSVector4 full_r(0.0f, 0.0f, 1.0f, 1.0f);
 	bool feedback_write_2 = PMODE.EN2 && sTex[2] != nullptr && EXTBUF.FBIN == 1;
 	bool feedback_write_1 = PMODE.EN1 && sTex[2] != nullptr && EXTBUF.FBIN == 0;
@@ -1539,10 +2222,12 @@ void GSDeviceOGL::DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex,
 		StretchRect(dTex, full_r, sTex[2], dRect[0], ShaderConvert_YUV);
 }
 
-void GSDeviceOGL::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset)
+void GSDeviceOGL::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset, int fx)
 {
 	GL_PUSH("DoInterlace");
 
+	FlushBatch();
+
 	OMSetColorMaskState();
 
 	GSVector4 s = GSVector4(dTex->GetSize());
@@ -1557,17 +2242,17 @@ void GSDeviceOGL::DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool
 
 	m_interlace.cb->cache_upload(&cb);
 
-	StretchRect(sTex, sRect, dTex, dRect, m_interlace.ps[shader], linear);
+	StretchRect(sTex, sRect, dTex, dRect, m_interlace.ps[fx][shader], linear);
 }
 
-void GSDeviceOGL::DoFXAA(GSTexture* sTex, GSTexture* dTex)
+bool GSDeviceOGL::DoFXAA(GSTexture* sTex, GSTexture* dTex)
 {
 	// Lazy compile
 	if (!m_fxaa.ps)
 	{
 		if (!GLLoader::found_GL_ARB_gpu_shader5) // GL4.0 extension
 		{
-			return;
+			return false;
 		}
 
 		std::string fxaa_macro = "#define FXAA_GLSL_130 1\n";
@@ -1590,16 +2275,20 @@ void GSDeviceOGL::DoFXAA(GSTexture* sTex, GSTexture* dTex)
 	GSVector4 dRect(0, 0, s.x, s.y);
 
 	StretchRect(sTex, sRect, dTex, dRect, m_fxaa.ps, true);
+
+	return true;
 }
 
-void GSDeviceOGL::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
+bool GSDeviceOGL::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 {
+	FlushBatch();
+
 	// Lazy compile
 	if (!m_shaderfx.ps)
 	{
 		if (!GLLoader::found_GL_ARB_gpu_shader5) // GL4.0 extension
 		{
-			return;
+			return false;
 		}
 
 		std::string config_name(theApp.GetConfigS("shaderfx_conf"));
@@ -1617,7 +2306,7 @@ void GSDeviceOGL::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 		if (!fshader.good())
 		{
 			fprintf(stderr, "Error failed to load '%s'. External Shader will be disabled !\n", shader_name.c_str());
-			return;
+			return false;
 		}
 		shader << fshader.rdbuf();
 
@@ -1645,26 +2334,16 @@ void GSDeviceOGL::DoExternalFX(GSTexture* sTex, GSTexture* dTex)
 	m_shaderfx.cb->cache_upload(&cb);
 
 	StretchRect(sTex, sRect, dTex, dRect, m_shaderfx.ps, true);
-}
 
-void GSDeviceOGL::DoShadeBoost(GSTexture* sTex, GSTexture* dTex)
-{
-	GL_PUSH("DoShadeBoost");
-
-	OMSetColorMaskState();
-
-	GSVector2i s = dTex->GetSize();
-
-	GSVector4 sRect(0, 0, 1, 1);
-	GSVector4 dRect(0, 0, s.x, s.y);
-
-	StretchRect(sTex, sRect, dTex, dRect, m_shadeboost.ps, true);
+	return true;
 }
 
 void GSDeviceOGL::SetupDATE(GSTexture* rt, GSTexture* ds, const GSVertexPT1* vertices, bool datm)
 {
 	GL_PUSH("DATE First Pass");
 
+	FlushBatch();
+
 	// sfex3 (after the capcom logo), vf4 (first menu fading in), ffxii shadows, rumble roses shadows, persona4 shadows
 
 	BeginScene();
@@ -1710,16 +2389,46 @@ void GSDeviceOGL::EndScene()
 
 void GSDeviceOGL::IASetVertexBuffer(const void* vertices, size_t count)
 {
+	// A wrap (or a new fenced chunk) would protect the buffer before the batch is drawn
+	if (m_batch.draws && !m_va->CanAppendVB(count))
+		FlushBatch();
+
 	m_va->UploadVB(vertices, count);
+	m_base_vertex = m_va->GetVBStart();
 }
 
 void GSDeviceOGL::IASetIndexBuffer(const void* index, size_t count)
 {
+	if (m_batch.draws)
+	{
+		const size_t vb_start = m_va->GetVBStart();
+
+		if (vb_start >= m_batch.vb_start && m_va->CanAppendIB(count))
+		{
+			// Rebase the indices on the batch vertices so the draw can be appended to it
+			const uint32 delta = (uint32)(vb_start - m_batch.vb_start);
+			const uint32* src = (const uint32*)index;
+			uint32* dst = (uint32*)m_va->MapIB(count);
+
+			for (size_t i = 0; i < count; i++)
+				dst[i] = src[i] + delta;
+
+			m_va->UnmapIB();
+			m_base_vertex = m_batch.vb_start;
+			return;
+		}
+
+		FlushBatch();
+	}
+
 	m_va->UploadIB(index, count);
 }
 
 void GSDeviceOGL::IASetPrimitiveTopology(GLenum topology)
 {
+	if (m_batch.draws && m_batch.topology != topology)
+		FlushBatch();
+
 	m_va->SetTopology(topology);
 }
 
@@ -1730,9 +2439,9 @@ void GSDeviceOGL::PSSetShaderResource(int i, GSTexture* sr)
 	if (sr)
 	{
 		GLuint id = static_cast<GSTextureOGL*>(sr)->GetID();
-		if (GLState::tex_unit[i] != id)
+		if (GLState::Changed(GLState::tex_unit[i], id))
 		{
-			GLState::tex_unit[i] = id;
+			FlushBatch();
 			glBindTextureUnit(i, id);
 		}
 	}
@@ -1746,9 +2455,9 @@ void GSDeviceOGL::PSSetShaderResources(GSTexture* sr0, GSTexture* sr1)
 
 void GSDeviceOGL::PSSetSamplerState(GLuint ss)
 {
-	if (GLState::ps_ss != ss)
+	if (GLState::Changed(GLState::ps_ss[0], ss))
 	{
-		GLState::ps_ss = ss;
+		FlushBatch();
 		glBindSampler(0, ss);
 	}
 }
@@ -1766,9 +2475,9 @@ void GSDeviceOGL::OMAttachRt(GSTextureOGL* rt)
 		id = 0;
 	}
 
-	if (GLState::rt != id)
+	if (GLState::Changed(GLState::rt, id))
 	{
-		GLState::rt = id;
+		FlushBatch();
 		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, id, 0);
 	}
 }
@@ -1786,33 +2495,37 @@ void GSDeviceOGL::OMAttachDs(GSTextureOGL* ds)
 		id = 0;
 	}
 
-	if (GLState::ds != id)
+	if (GLState::Changed(GLState::ds, id))
 	{
-		GLState::ds = id;
+		FlushBatch();
 		glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, id, 0);
 	}
 }
 
 void GSDeviceOGL::OMSetFBO(GLuint fbo)
 {
-	if (GLState::fbo != fbo)
+	if (GLState::Changed(GLState::fbo, fbo))
 	{
-		GLState::fbo = fbo;
+		FlushBatch();
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
 	}
 }
 
 void GSDeviceOGL::OMSetDepthStencilState(GSDepthStencilOGL* dss)
 {
+	if (m_batch.draws && m_batch.dss != dss)
+		FlushBatch();
+	m_batch.dss = dss;
+
 	dss->SetupDepth();
 	dss->SetupStencil();
 }
 
 void GSDeviceOGL::OMSetColorMaskState(OMColorMaskSelector sel)
 {
-	if (sel.wrgba != GLState::wrgba)
+	if (GLState::Changed(GLState::wrgba, (uint32)sel.wrgba))
 	{
-		GLState::wrgba = sel.wrgba;
+		FlushBatch();
 
 		glColorMaski(0, sel.wr, sel.wg, sel.wb, sel.wa);
 	}
@@ -1822,15 +2535,15 @@ void GSDeviceOGL::OMSetBlendState(uint8 blend_index, uint8 blend_factor, bool is
 {
 	if (blend_index)
 	{
-		if (!GLState::blend)
+		if (GLState::Changed(GLState::blend, true))
 		{
-			GLState::blend = true;
+			FlushBatch();
 			glEnable(GL_BLEND);
 		}
 
-		if (is_blend_constant && GLState::bf != blend_factor)
+		if (is_blend_constant && GLState::Changed(GLState::bf, blend_factor))
 		{
-			GLState::bf = blend_factor;
+			FlushBatch();
 			float bf = (float)blend_factor / 128.0f;
 			glBlendColor(bf, bf, bf, bf);
 		}
@@ -1842,24 +2555,26 @@ void GSDeviceOGL::OMSetBlendState(uint8 blend_index, uint8 blend_factor, bool is
 			b.dst = GL_ONE;
 		}
 
-		if (GLState::eq_RGB != b.op)
+		if (GLState::Changed(GLState::eq_RGB, b.op))
 		{
-			GLState::eq_RGB = b.op;
+			FlushBatch();
 			glBlendEquationSeparate(b.op, GL_FUNC_ADD);
 		}
 
-		if (GLState::f_sRGB != b.src || GLState::f_dRGB != b.dst)
+		// Note: evaluate both, the shadow copies must be kept in sync
+		const bool src = GLState::Changed(GLState::f_sRGB, b.src);
+		const bool dst = GLState::Changed(GLState::f_dRGB, b.dst);
+		if (src || dst)
 		{
-			GLState::f_sRGB = b.src;
-			GLState::f_dRGB = b.dst;
+			FlushBatch();
 			glBlendFuncSeparate(b.src, b.dst, GL_ONE, GL_ZERO);
 		}
 	}
 	else
 	{
-		if (GLState::blend)
+		if (GLState::Changed(GLState::blend, false))
 		{
-			GLState::blend = false;
+			FlushBatch();
 			glDisable(GL_BLEND);
 		}
 	}
@@ -1896,18 +2611,18 @@ void GSDeviceOGL::OMSetRenderTargets(GSTexture* rt, GSTexture* ds, const GSVecto
 
 
 	GSVector2i size = rt ? rt->GetSize() : ds ? ds->GetSize() : GLState::viewport;
-	if (GLState::viewport != size)
+	if (GLState::Changed(GLState::viewport, size))
 	{
-		GLState::viewport = size;
+		FlushBatch();
 		// FIXME ViewportIndexedf or ViewportIndexedfv (GL4.1)
 		glViewportIndexedf(0, 0, 0, GLfloat(size.x), GLfloat(size.y));
 	}
 
 	GSVector4i r = scissor ? *scissor : GSVector4i(size).zwxy();
 
-	if (!GLState::scissor.eq(r))
+	if (GLState::Changed(GLState::scissor, r))
 	{
-		GLState::scissor = r;
+		FlushBatch();
 		// FIXME ScissorIndexedv (GL4.1)
 		glScissorIndexed(0, r.x, r.y, r.width(), r.height());
 	}
@@ -1918,17 +2633,21 @@ void GSDeviceOGL::SetupCB(const VSConstantBuffer* vs_cb, const PSConstantBuffer*
 	GL_PUSH("UBO");
 	if (m_vs_cb_cache.Update(vs_cb))
 	{
+		FlushBatch();
 		m_vs_cb->upload(vs_cb);
 	}
 
 	if (m_ps_cb_cache.Update(ps_cb))
 	{
+		FlushBatch();
 		m_ps_cb->upload(ps_cb);
 	}
 }
 
 void GSDeviceOGL::SetupCBMisc(const GSVector4i& channel)
 {
+	FlushBatch();
+
 	m_misc_cb_cache.ChannelShuffle = channel;
 	m_convert.cb->cache_upload(&m_misc_cb_cache);
 }
@@ -1936,12 +2655,27 @@ void GSDeviceOGL::SetupCBMisc(const GSVector4i& channel)
 void GSDeviceOGL::SetupPipeline(const VSSelector& vsel, const GSSelector& gsel, const PSSelector& psel)
 {
 	GLuint ps;
+
+	if (m_async_ps.queue)
+	{
+		PollAsyncPS();
+		WarmAsyncPS();
+	}
+
 	auto i = m_ps.find(psel);
 
 	if (i == m_ps.end())
 	{
-		ps = CompilePS(psel);
-		m_ps[psel] = ps;
+		// The draw can't be skipped. While the worker compiles the shader it is drawn
+		// with a close one, otherwise the shader is compiled here and PollAsyncPS
+		// drops the late result of the worker.
+		ps = m_async_ps.queue ? GetFallbackPS(psel) : 0;
+
+		if (ps == 0)
+		{
+			ps = CompilePS(psel);
+			m_ps[psel] = ps;
+		}
 	}
 	else
 	{
@@ -2001,10 +2735,20 @@ void GSDeviceOGL::SetupPipeline(const VSSelector& vsel, const GSSelector& gsel,
 #endif
 	}
 
+	const GLuint vs = m_vs[vsel];
+	const GLuint gs = m_gs[gsel];
+
+	if (m_batch.draws && (m_batch.vs != vs || m_batch.gs != gs || m_batch.ps != ps))
+		FlushBatch();
+
+	m_batch.vs = vs;
+	m_batch.gs = gs;
+	m_batch.ps = ps;
+
 	if (GLLoader::buggy_sso_dual_src)
-		m_shader->BindProgram(m_vs[vsel], m_gs[gsel], ps);
+		m_shader->BindProgram(vs, gs, ps);
 	else
-		m_shader->BindPipeline(m_vs[vsel], m_gs[gsel], ps);
+		m_shader->BindPipeline(vs, gs, ps);
 }
 
 void GSDeviceOGL::SetupSampler(PSSamplerSelector ssel)
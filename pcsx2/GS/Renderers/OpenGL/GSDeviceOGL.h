@@ -22,6 +22,7 @@
 #include "GSUniformBufferOGL.h"
 #include "GSShaderOGL.h"
 #include "GLState.h"
+#include "GS/GSThread_CXX11.h"
 
 #ifdef ENABLE_OGL_DEBUG_MEM_BW
 extern uint64 g_real_texture_upload_byte;
@@ -65,9 +66,8 @@ public:
 
 	void SetupDepth()
 	{
-		if (GLState::depth != m_depth_enable)
+		if (GLState::Changed(GLState::depth, m_depth_enable))
 		{
-			GLState::depth = m_depth_enable;
 			if (m_depth_enable)
 				glEnable(GL_DEPTH_TEST);
 			else
@@ -76,14 +76,12 @@ public:
 
 		if (m_depth_enable)
 		{
-			if (GLState::depth_func != m_depth_func)
+			if (GLState::Changed(GLState::depth_func, m_depth_func))
 			{
-				GLState::depth_func = m_depth_func;
 				glDepthFunc(m_depth_func);
 			}
-			if (GLState::depth_mask != m_depth_mask)
+			if (GLState::Changed(GLState::depth_mask, m_depth_mask))
 			{
-				GLState::depth_mask = m_depth_mask;
 				glDepthMask((GLboolean)m_depth_mask);
 			}
 		}
@@ -91,9 +89,8 @@ public:
 
 	void SetupStencil()
 	{
-		if (GLState::stencil != m_stencil_enable)
+		if (GLState::Changed(GLState::stencil, m_stencil_enable))
 		{
-			GLState::stencil = m_stencil_enable;
 			if (m_stencil_enable)
 				glEnable(GL_STENCIL_TEST);
 			else
@@ -103,14 +100,12 @@ public:
 		if (m_stencil_enable)
 		{
 			// Note: here the mask control which bitplane is considered by the operation
-			if (GLState::stencil_func != m_stencil_func)
+			if (GLState::Changed(GLState::stencil_func, m_stencil_func))
 			{
-				GLState::stencil_func = m_stencil_func;
 				glStencilFunc(m_stencil_func, 1, 1);
 			}
-			if (GLState::stencil_pass != m_stencil_spass_dpass_op)
+			if (GLState::Changed(GLState::stencil_pass, m_stencil_spass_dpass_op))
 			{
-				GLState::stencil_pass = m_stencil_spass_dpass_op;
 				glStencilOp(GL_KEEP, GL_KEEP, m_stencil_spass_dpass_op);
 			}
 		}
@@ -460,6 +455,18 @@ public:
 		MiscConstantBuffer() { memset(this, 0, sizeof(*this)); }
 	};
 
+	// See vram_unswizzle.glsl
+	struct alignas(32) VRAMUnswizzleConstantBuffer
+	{
+		GSVector4i Rect;
+		GSVector4i Layout;
+		GSVector4i Geometry;
+		GSVector4i Tables;
+		GSVector4i Alpha;
+
+		VRAMUnswizzleConstantBuffer() { memset(this, 0, sizeof(*this)); }
+	};
+
 	static int m_shader_inst;
 	static int m_shader_reg;
 
@@ -481,6 +488,23 @@ private:
 	GLuint m_fbo_read; // frame buffer container only for reading
 
 	GSVertexBufferStateOGL* m_va; // state of the vertex buffer/array
+	GLint m_base_vertex; // base vertex of the uploaded indices
+
+	// Consecutive indexed draws issued with the same state are held back and
+	// submitted as a single draw on the next state change
+	struct
+	{
+		GLenum topology;
+		size_t vb_start;
+		size_t ib_start;
+		size_t ib_count;
+		uint32 draws;
+		GLuint vs, gs, ps; // pipeline of the last SetupPipeline
+		GSDepthStencilOGL* dss; // last depth stencil state
+	} m_batch;
+	bool m_batch_enabled;
+
+	void SubmitBatch();
 
 	struct
 	{
@@ -490,7 +514,7 @@ private:
 
 	struct
 	{
-		GLuint ps[4]; // program object
+		GLuint ps[OutputFX_Count][4]; // program object, per combination of the folded output stages
 		GSUniformBufferOGL* cb; // uniform buffer object
 	} m_interlace;
 
@@ -523,10 +547,20 @@ private:
 		GSTexture* t;
 	} m_date;
 
+	// GPU copy of the GS local memory, texture sources are then unswizzled by a
+	// compute shader instead of GSLocalMemory::ReadTexture*
 	struct
 	{
-		GLuint ps;
-	} m_shadeboost;
+		bool enabled;
+		GLuint vm;    // shader storage buffer, copy of GSLocalMemory::m_vm8
+		GLuint lut;   // shader storage buffer, block/column tables and CLUT
+		GLuint cs[2]; // color, index
+		GSUniformBufferOGL* cb;
+		uint32 dirty[MAX_PAGES / 32]; // pages of vm that must be uploaded again
+		int psm; // format of the tables currently in lut
+	} m_vram_mirror;
+
+	void CreateLocalMemoryMirror();
 
 	struct
 	{
@@ -536,6 +570,16 @@ private:
 		GLuint timer() { return timer_query[last_query]; }
 	} m_profiler;
 
+	// Timestamp pairs around the HW draws, used as a ring
+	struct
+	{
+		bool enabled;
+		uint32 head; // next timer to begin
+		uint32 tail; // oldest timer not yet resolved
+		GLuint query[2 << 12];
+		DrawTiming timing[1 << 12];
+	} m_draw_timer;
+
 	GLuint m_vs[1 << 1];
 	GLuint m_gs[1 << 3];
 	GLuint m_ps_ss[1 << 7];
@@ -543,6 +587,68 @@ private:
 	std::unordered_map<uint64, GLuint> m_ps;
 	GLuint m_apitrace;
 
+	// Asynchronous pixel shader compilation on a shared context
+	struct AsyncPS
+	{
+		uint64 sel;
+		GLuint ps;
+		GLsync fence;
+	};
+
+	struct
+	{
+		std::unique_ptr<GSJobQueue<uint64, 256>> queue;
+		void* ctx;
+		bool ctx_attached;
+		std::unordered_set<uint64> pending;
+		std::vector<uint64> warm;
+		std::mutex lock;
+		std::vector<AsyncPS> done;
+		std::atomic<int> done_count;
+	} m_async_ps;
+
+	void CreateAsyncShaderCompiler();
+	void DestroyAsyncShaderCompiler();
+	void CompileAsyncPS(uint64& sel);
+	void PollAsyncPS();
+	void WarmAsyncPS();
+	GLuint GetFallbackPS(const PSSelector& sel);
+
+	// Threaded presentation: the output is rendered in a frame of a small pool
+	// and the present thread blits the newest queued frame in the window then
+	// swaps (mailbox). The vsync wait no longer blocks the GS thread.
+	static constexpr int MAX_PRESENT_FRAMES = 4;
+
+	struct PresentJob
+	{
+		int frame; // -1 releases the present context
+		uint64 seq;
+	};
+
+	struct
+	{
+		std::unique_ptr<GSJobQueue<PresentJob, 8>> queue;
+		void* ctx;
+		bool ctx_attached;
+		GLuint fbo; // read framebuffer of the present context
+		int count; // frames of the pool (queued frames + 1)
+		int current; // frame used as backbuffer by the GS thread
+		GSTexture* frame[MAX_PRESENT_FRAMES + 1];
+		GLsync ready[MAX_PRESENT_FRAMES + 1]; // rendering done, from the GS thread
+		GLsync done[MAX_PRESENT_FRAMES + 1]; // blit done, from the present thread
+		bool busy[MAX_PRESENT_FRAMES + 1]; // protected by lock
+		std::mutex lock;
+		std::condition_variable released; // a frame isn't busy anymore
+		std::atomic<uint64> seq; // newest queued frame
+	} m_present;
+
+	void CreatePresentThread();
+	void DestroyPresentThread();
+	void CreatePresentFrames(int w, int h);
+	void DestroyPresentFrames();
+	void QueuePresent();
+	void ExecutePresent(PresentJob& job);
+
 	GLuint m_palette_ss;
 
 	GSUniformBufferOGL* m_vs_cb;
@@ -558,10 +664,9 @@ private:
 	GSTexture* FetchSurface(int type, int w, int h, int format);
 
 	void DoMerge(GSTexture* sTex[3], GSVector4* sRect, GSTexture* dTex, GSVector4* dRect, const GSRegPMODE& PMODE, const GSRegEXTBUF& EXTBUF, const GSVector4& c) final;
-	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset = 0) final;
-	void DoFXAA(GSTexture* sTex, GSTexture* dTex) final;
-	void DoShadeBoost(GSTexture* sTex, GSTexture* dTex) final;
-	void DoExternalFX(GSTexture* sTex, GSTexture* dTex) final;
+	void DoInterlace(GSTexture* sTex, GSTexture* dTex, int shader, bool linear, float yoffset, int fx) final;
+	bool DoFXAA(GSTexture* sTex, GSTexture* dTex) final;
+	bool DoExternalFX(GSTexture* sTex, GSTexture* dTex) final;
 	void RenderOsd(GSTexture* dt);
 
 	void OMAttachRt(GSTextureOGL* rt = NULL);
@@ -593,11 +698,26 @@ public:
 	inline void BeforeDraw();
 	inline void AfterDraw();
 
+	bool BatchIndexedPrimitive();
+	void FlushBatch() final
+	{
+		if (m_batch.draws)
+			SubmitBatch();
+	}
+
 	void ClearRenderTarget(GSTexture* t, const GSVector4& c) final;
 	void ClearRenderTarget(GSTexture* t, uint32 c) final;
 	void ClearDepth(GSTexture* t) final;
 	void ClearStencil(GSTexture* t, uint8 c) final;
 
+	bool HasLocalMemoryMirror() final { return m_vram_mirror.enabled; }
+
+	bool BeginDrawTimer() final;
+	void EndDrawTimer(uint64 frame, uint64 shader, uint32 rt) final;
+	void ResolveDrawTimers(std::vector<DrawTiming>& timings) final;
+	void InvalidateLocalMemoryMirror(const uint32* pages) final;
+	bool ReadLocalMemoryMirror(GSTexture* t, const GSVector4i& r, int layer, const uint8* vm, const uint32* clut, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, bool palette) final;
+
 	void InitPrimDateTexture(GSTexture* rt, const GSVector4i& area);
 	void RecycleDateTexture();
 
@@ -628,6 +748,7 @@ public:
 	void OMSetRenderTargets(GSTexture* rt, GSTexture* ds, const GSVector4i* scissor = NULL) final;
 	void OMSetColorMaskState(OMColorMaskSelector sel = OMColorMaskSelector());
 
+	virtual bool HasMipmapGeneration() { return true; }
 	virtual bool HasColorSparse() { return GLLoader::found_compatible_GL_ARB_sparse_texture2; }
 	virtual bool HasDepthSparse() { return GLLoader::found_compatible_sparse_depth; }
 
@@ -117,6 +117,9 @@ void GSRendererOGL::SetupIA(const float& sx, const float& sy)
 	dev->IASetVertexBuffer(m_vertex.buff, m_vertex.next);
 	dev->IASetIndexBuffer(m_index.buff, m_index.tail);
 	dev->IASetPrimitiveTopology(t);
+
+	m_perfmon.Put(GSPerfMon::Upload, m_vertex.next * sizeof(GSVertex) + m_index.tail * sizeof(uint32));
+	m_perfmon.Put(GSPerfMon::PboStall, PboPool::TakeStallCount());
 }
 
 void GSRendererOGL::EmulateZbuffer()
@@ -990,6 +993,10 @@ void GSRendererOGL::SendDraw()
 {
 	GSDeviceOGL* dev = (GSDeviceOGL*)m_dev;
 
+	// Barriers must see the draws held back by the batch
+	if (m_require_full_barrier || m_require_one_barrier)
+		dev->FlushBatch();
+
 	if (!m_require_full_barrier && m_require_one_barrier)
 	{
 		// Need only a single barrier
@@ -998,8 +1005,9 @@ void GSRendererOGL::SendDraw()
 	}
 	else if (!m_require_full_barrier)
 	{
-		// Don't need any barrier
-		dev->DrawIndexedPrimitive();
+		// Don't need any barrier, the draw can be appended to the previous one
+		if (dev->BatchIndexedPrimitive())
+			m_perfmon.Put(GSPerfMon::DrawMerged, 1);
 	}
 	else if (m_prim_overlap == PRIM_OVERLAP_NO)
 	{
@@ -1221,9 +1229,11 @@ void GSRendererOGL::DrawPrims(GSTexture* rt, GSTexture* ds, GSTextureCache::Sour
 	{
 		const GSVector4i dRect = ComputeBoundingBox(rtscale, rtsize);
 
+		dev->FlushBatch();
+
 		// Reduce the quantity of clean function
-		glScissor(dRect.x, dRect.y, dRect.width(), dRect.height());
-		GLState::scissor = dRect;
+		if (GLState::Changed(GLState::scissor, dRect))
+			glScissor(dRect.x, dRect.y, dRect.width(), dRect.height());
 
 		// Must be done here to avoid any GL state pertubation (clear function...)
 		// Create an r32ui image that will containt primitive ID
@@ -1568,6 +1578,12 @@ void GSRendererOGL::DrawPrims(GSTexture* rt, GSTexture* ds, GSTextureCache::Sour
 
 		dev->Recycle(hdr_rt);
 	}
+
+	// Redundant state filtering statistics
+	m_perfmon.Put(GSPerfMon::StateCall, GLState::submitted);
+	m_perfmon.Put(GSPerfMon::StateElided, GLState::elided);
+	GLState::submitted = 0;
+	GLState::elided = 0;
 }
 
 bool GSRendererOGL::IsDummyTexture() const
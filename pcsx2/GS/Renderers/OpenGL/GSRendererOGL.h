@@ -80,4 +80,6 @@ public:
 	void SendDraw();
 
 	bool IsDummyTexture() const final;
+
+	uint64 GetShaderKey() const final { return m_ps_sel.key; }
 };
@@ -16,6 +16,7 @@
 #include "PrecompiledHeader.h"
 #include "GSShaderOGL.h"
 #include "GLState.h"
+#include "SharedCache.h"
 
 #ifdef _WIN32
 #include "GS/resource.h"
@@ -23,9 +24,36 @@
 #include "GS_res.h"
 #endif
 
+// Bump it when the layout of the binary cache file changes
+static const uint32 s_binary_cache_magic = 0x42505347; // "GSPB"
+static const uint32 s_binary_cache_version = 2;
+
+// Only keep the programs used in the last sessions, and cap the file size so the
+// load time stays reasonable.
+static const uint32 s_binary_cache_max_age = 8;
+static const size_t s_binary_cache_max_size = 64 * 1024 * 1024;
+
+static uint64 HashSources(const char* const* sources, int nb, GLenum type)
+{
+	// FNV-1a, stable between sessions unlike std::hash
+	uint64 hash = 0xcbf29ce484222325ull ^ type;
+	for (int i = 0; i < nb; i++)
+	{
+		for (const char* c = sources[i]; *c; c++)
+		{
+			hash ^= static_cast<uint8>(*c);
+			hash *= 0x100000001b3ull;
+		}
+	}
+
+	return hash;
+}
+
 GSShaderOGL::GSShaderOGL(bool debug)
 	: m_pipeline(0)
 	, m_debug_shader(debug)
+	, m_binary_cache_gen(0)
+	, m_binary_cache_dirty(false)
 {
 	theApp.LoadResource(IDR_COMMON_GLSL, m_common_header);
 
@@ -36,6 +64,8 @@ GSShaderOGL::GSShaderOGL(bool debug)
 
 GSShaderOGL::~GSShaderOGL()
 {
+	SaveBinaryCache();
+
 	printf("Delete %zu Shaders, %zu Programs, %zu Pipelines\n",
 		m_shad_to_delete.size(), m_prog_to_delete.size(), m_pipe_to_delete.size());
 
@@ -87,18 +117,16 @@ void GSShaderOGL::BindProgram(GLuint vs, GLuint gs, GLuint ps)
 {
 	GLuint p = LinkProgram(vs, gs, ps);
 
-	if (GLState::program != p)
+	if (GLState::Changed(GLState::program, p))
 	{
-		GLState::program = p;
 		glUseProgram(p);
 	}
 }
 
 void GSShaderOGL::BindProgram(GLuint p)
 {
-	if (GLState::program != p)
+	if (GLState::Changed(GLState::program, p))
 	{
-		GLState::program = p;
 		glUseProgram(p);
 	}
 }
@@ -107,15 +135,13 @@ void GSShaderOGL::BindPipeline(GLuint vs, GLuint gs, GLuint ps)
 {
 	BindPipeline(m_pipeline);
 
-	if (GLState::vs != vs)
+	if (GLState::Changed(GLState::vs, vs))
 	{
-		GLState::vs = vs;
 		glUseProgramStages(m_pipeline, GL_VERTEX_SHADER_BIT, vs);
 	}
 
-	if (GLState::gs != gs)
+	if (GLState::Changed(GLState::gs, gs))
 	{
-		GLState::gs = gs;
 		glUseProgramStages(m_pipeline, GL_GEOMETRY_SHADER_BIT, gs);
 	}
 
@@ -123,7 +149,7 @@ void GSShaderOGL::BindPipeline(GLuint vs, GLuint gs, GLuint ps)
 	// In debug always sets the program. It allow to replace the program in apitrace easily.
 	if (true)
 #else
-	if (GLState::ps != ps)
+	if (GLState::Changed(GLState::ps, ps))
 #endif
 	{
 		GLState::ps = ps;
@@ -133,15 +159,13 @@ void GSShaderOGL::BindPipeline(GLuint vs, GLuint gs, GLuint ps)
 
 void GSShaderOGL::BindPipeline(GLuint pipe)
 {
-	if (GLState::pipeline != pipe)
+	if (GLState::Changed(GLState::pipeline, pipe))
 	{
-		GLState::pipeline = pipe;
 		glBindProgramPipeline(pipe);
 	}
 
-	if (GLState::program)
+	if (GLState::Changed(GLState::program, 0u))
 	{
-		GLState::program = 0;
 		glUseProgram(0);
 	}
 }
@@ -259,6 +283,11 @@ std::string GSShaderOGL::GenGlslHeader(const std::string& entry, GLenum type, co
 		case GL_FRAGMENT_SHADER:
 			header += "#define FRAGMENT_SHADER 1\n";
 			break;
+		case GL_COMPUTE_SHADER:
+			header += "#extension GL_ARB_compute_shader: require\n";
+			header += "#extension GL_ARB_shader_storage_buffer_object: require\n";
+			header += "#define COMPUTE_SHADER 1\n";
+			break;
 		default:
 			ASSERT(0);
 	}
@@ -271,7 +300,7 @@ std::string GSShaderOGL::GenGlslHeader(const std::string& entry, GLenum type, co
 	return header;
 }
 
-GLuint GSShaderOGL::Compile(const std::string& glsl_file, const std::string& entry, GLenum type, const char* glsl_h_code, const std::string& macro_sel)
+GLuint GSShaderOGL::Compile(const std::string& glsl_file, const std::string& entry, GLenum type, const char* glsl_h_code, const std::string& macro_sel, uint64 sel)
 {
 	ASSERT(glsl_h_code != NULL);
 
@@ -288,10 +317,42 @@ GLuint GSShaderOGL::Compile(const std::string& glsl_file, const std::string& ent
 	sources[1] = m_common_header.data();
 	sources[2] = glsl_h_code;
 
-	program = glCreateShaderProgramv(type, shader_nb, sources);
+	uint64 hash = 0;
+	if (!m_binary_cache_file.empty())
+	{
+		hash = HashSources(sources, shader_nb, type);
+		program = LoadProgramBinary(hash);
+		if (program)
+		{
+			std::lock_guard<std::mutex> l(m_lock);
+			m_prog_to_delete.push_back(program);
+			return program;
+		}
+
+		// Equivalent of glCreateShaderProgramv but the binary hint must be set before the link
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, shader_nb, sources, NULL);
+		glCompileShader(shader);
+		ValidateShader(shader);
+
+		program = glCreateProgram();
+		glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glAttachShader(program, shader);
+		glLinkProgram(program);
+		glDetachShader(program, shader);
+		glDeleteShader(shader);
+	}
+	else
+	{
+		program = glCreateShaderProgramv(type, shader_nb, sources);
+	}
 
 	bool status = ValidateProgram(program);
 
+	if (hash)
+		StoreProgramBinary(hash, sel, type, program);
+
 	if (!status)
 	{
 		// print extra info
@@ -300,6 +361,7 @@ GLuint GSShaderOGL::Compile(const std::string& glsl_file, const std::string& ent
 		fprintf(stderr, "\n");
 	}
 
+	std::lock_guard<std::mutex> l(m_lock);
 	m_prog_to_delete.push_back(program);
 
 	return program;
@@ -408,3 +470,281 @@ int GSShaderOGL::DumpAsm(const std::string& file, GLuint p)
 
 	return instructions;
 }
+
+std::string GSShaderOGL::GetDriverString()
+{
+	const char* vendor = (const char*)glGetString(GL_VENDOR);
+	const char* renderer = (const char*)glGetString(GL_RENDERER);
+	const char* version = (const char*)glGetString(GL_VERSION);
+
+	return format("%s / %s / %s", vendor ? vendor : "", renderer ? renderer : "", version ? version : "");
+}
+
+GLuint GSShaderOGL::LoadProgramBinary(uint64 hash)
+{
+	std::lock_guard<std::mutex> l(m_lock);
+
+	auto it = m_binary_cache.find(hash);
+	if (it == m_binary_cache.end())
+		return 0;
+
+	ProgramBinary& bin = it->second;
+
+	GLuint p = glCreateProgram();
+	glProgramParameteri(p, GL_PROGRAM_SEPARABLE, GL_TRUE);
+	glProgramBinary(p, bin.format, bin.data.data(), bin.data.size());
+
+	// Driver is free to reject the binary (i.e. after an update). Just recompile it.
+	GLint status = 0;
+	glGetProgramiv(p, GL_LINK_STATUS, &status);
+	if (!status)
+	{
+		glDeleteProgram(p);
+		m_binary_cache.erase(it);
+		m_binary_cache_dirty = true;
+		return 0;
+	}
+
+	// Refresh it so the prune keeps it
+	if (bin.gen != m_binary_cache_gen)
+	{
+		bin.gen = m_binary_cache_gen;
+		m_binary_cache_dirty = true;
+	}
+
+	return p;
+}
+
+void GSShaderOGL::StoreProgramBinary(uint64 hash, uint64 sel, GLenum type, GLuint p)
+{
+	GLint status = 0;
+	glGetProgramiv(p, GL_LINK_STATUS, &status);
+	if (!status)
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(p, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	ProgramBinary bin;
+	bin.sel = sel;
+	bin.type = type;
+	bin.data.resize(length);
+	bin.gen = m_binary_cache_gen;
+	glGetProgramBinary(p, length, NULL, &bin.format, bin.data.data());
+
+	std::lock_guard<std::mutex> l(m_lock);
+	m_binary_cache[hash] = std::move(bin);
+	m_binary_cache_dirty = true;
+}
+
+// Returns false when the file is damaged or from another driver, a missing file is an empty cache
+bool GSShaderOGL::ReadBinaryCache(const std::string& file, const std::string& driver, std::unordered_map<uint64, ProgramBinary>& cache, uint32& gen)
+{
+	FILE* fp = fopen(file.c_str(), "rb");
+	if (!fp)
+		return true;
+
+	bool valid = true;
+
+	uint32 magic = 0, version = 0, driver_size = 0, count = 0;
+	valid &= fread(&magic, sizeof(magic), 1, fp) == 1 && magic == s_binary_cache_magic;
+	valid &= valid && fread(&version, sizeof(version), 1, fp) == 1 && version == s_binary_cache_version;
+	valid &= valid && fread(&driver_size, sizeof(driver_size), 1, fp) == 1 && driver_size == driver.size();
+
+	if (valid)
+	{
+		std::string file_driver(driver_size, '\0');
+		valid &= fread(&file_driver[0], driver_size, 1, fp) == 1 && file_driver == driver;
+	}
+
+	valid &= valid && fread(&gen, sizeof(gen), 1, fp) == 1;
+	valid &= valid && fread(&count, sizeof(count), 1, fp) == 1;
+
+	for (uint32 i = 0; valid && i < count; i++)
+	{
+		uint64 hash;
+		uint32 type, format, size;
+		ProgramBinary bin;
+
+		valid &= fread(&hash, sizeof(hash), 1, fp) == 1;
+		valid &= valid && fread(&bin.sel, sizeof(bin.sel), 1, fp) == 1;
+		valid &= valid && fread(&bin.gen, sizeof(bin.gen), 1, fp) == 1;
+		valid &= valid && fread(&type, sizeof(type), 1, fp) == 1;
+		valid &= valid && fread(&format, sizeof(format), 1, fp) == 1;
+		valid &= valid && fread(&size, sizeof(size), 1, fp) == 1;
+		if (!valid)
+			break;
+
+		bin.type = type;
+		bin.format = format;
+		bin.data.resize(size);
+		valid &= fread(bin.data.data(), size, 1, fp) == 1;
+
+		if (valid)
+			cache[hash] = std::move(bin);
+	}
+
+	fclose(fp);
+
+	return valid;
+}
+
+void GSShaderOGL::LoadBinaryCache(const std::string& file)
+{
+	m_binary_cache_file = file;
+	m_binary_cache.clear();
+	m_binary_cache_dirty = false;
+
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats == 0)
+	{
+		fprintf(stderr, "GL program binary isn't supported by the driver, shader cache disabled\n");
+		m_binary_cache_file.clear();
+		return;
+	}
+
+	uint32 gen = 0;
+	if (!ReadBinaryCache(file, GetDriverString(), m_binary_cache, gen))
+	{
+		// Different driver or corrupted file. Restart from scratch
+		fprintf(stdout, "Discard GL shader cache %s\n", file.c_str());
+		m_binary_cache.clear();
+		m_binary_cache_dirty = true;
+		return;
+	}
+
+	m_binary_cache_gen = gen + 1;
+
+	fprintf(stdout, "Loaded %zu programs from GL shader cache\n", m_binary_cache.size());
+}
+
+void GSShaderOGL::SaveBinaryCache()
+{
+	std::lock_guard<std::mutex> l(m_lock);
+
+	if (m_binary_cache_file.empty() || !m_binary_cache_dirty)
+		return;
+
+	const wxString file = fromUTF8(m_binary_cache_file);
+	const std::string driver = GetDriverString();
+
+	// Other instances may have saved their programs since the load, keep them too
+	SharedCache::FileLock lock(file);
+
+	std::unordered_map<uint64, ProgramBinary> saved;
+	uint32 gen = 0;
+	if (!lock.IsLocked() || !ReadBinaryCache(m_binary_cache_file, driver, saved, gen))
+		saved.clear();
+
+	for (const auto& it : m_binary_cache)
+	{
+		// Don't downgrade an entry that another instance used more recently
+		auto prev = saved.find(it.first);
+		if (prev == saved.end() || prev->second.gen <= it.second.gen)
+			saved[it.first] = it.second;
+	}
+
+	gen = std::max(gen, m_binary_cache_gen);
+	PruneBinaryCache(saved, gen);
+
+	std::vector<char> data;
+	auto put = [&data](const void* p, size_t size) {
+		data.insert(data.end(), static_cast<const char*>(p), static_cast<const char*>(p) + size);
+	};
+
+	const uint32 driver_size = driver.size();
+	const uint32 count = saved.size();
+
+	put(&s_binary_cache_magic, sizeof(s_binary_cache_magic));
+	put(&s_binary_cache_version, sizeof(s_binary_cache_version));
+	put(&driver_size, sizeof(driver_size));
+	put(driver.data(), driver_size);
+	put(&gen, sizeof(gen));
+	put(&count, sizeof(count));
+
+	for (const auto& it : saved)
+	{
+		const ProgramBinary& bin = it.second;
+		const uint32 type = bin.type;
+		const uint32 format = bin.format;
+		const uint32 size = bin.data.size();
+
+		put(&it.first, sizeof(it.first));
+		put(&bin.sel, sizeof(bin.sel));
+		put(&bin.gen, sizeof(bin.gen));
+		put(&type, sizeof(type));
+		put(&format, sizeof(format));
+		put(&size, sizeof(size));
+		put(bin.data.data(), size);
+	}
+
+	if (!SharedCache::ReplaceFile(file, data.data(), data.size()))
+	{
+		fprintf(stderr, "Failed to write GL shader cache %s\n", m_binary_cache_file.c_str());
+		return;
+	}
+
+	m_binary_cache_dirty = false;
+}
+
+void GSShaderOGL::PruneBinaryCache(std::unordered_map<uint64, ProgramBinary>& cache, uint32 gen)
+{
+	std::vector<std::pair<uint32, uint64>> entries; // (gen, hash)
+	entries.reserve(cache.size());
+
+	for (auto it = cache.begin(); it != cache.end();)
+	{
+		if (gen - it->second.gen > s_binary_cache_max_age)
+		{
+			it = cache.erase(it);
+		}
+		else
+		{
+			entries.emplace_back(it->second.gen, it->first);
+			++it;
+		}
+	}
+
+	// Most recently used first, drop the tail above the size limit
+	std::sort(entries.begin(), entries.end(), std::greater<std::pair<uint32, uint64>>());
+
+	size_t size = 0;
+	for (const auto& e : entries)
+	{
+		auto it = cache.find(e.second);
+		size += it->second.data.size();
+		if (size > s_binary_cache_max_size)
+			cache.erase(it);
+	}
+}
+
+// Only the tfx programs have a selector, the others are compiled at startup anyway
+std::vector<uint64> GSShaderOGL::GetCachedSelectors(GLenum type) const
+{
+	std::lock_guard<std::mutex> l(m_lock);
+
+	std::vector<uint64> sels;
+	for (const auto& it : m_binary_cache)
+	{
+		if (it.second.type == type && it.second.sel != NO_SELECTOR)
+			sels.push_back(it.second.sel);
+	}
+
+	return sels;
+}
+
+bool GSShaderOGL::HasCachedBinary(GLenum type, uint64 sel) const
+{
+	std::lock_guard<std::mutex> l(m_lock);
+
+	for (const auto& it : m_binary_cache)
+	{
+		if (it.second.type == type && it.second.sel == sel)
+			return true;
+	}
+
+	return false;
+}
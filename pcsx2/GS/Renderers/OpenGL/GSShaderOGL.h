@@ -23,10 +23,36 @@ class GSShaderOGL
 	std::unordered_map<uint32, GLuint> m_program;
 	const bool m_debug_shader;
 
+	// Compile() can be called from the async shader compilation thread
+	mutable std::mutex m_lock;
+
 	std::vector<GLuint> m_shad_to_delete;
 	std::vector<GLuint> m_prog_to_delete;
 	std::vector<GLuint> m_pipe_to_delete;
 
+	// Program binary cache. Entries are keyed by a hash of the full GLSL source
+	// (header + macros + code) and the file is only valid for the driver that wrote it.
+	// gen is the last session that used the entry, old entries are pruned on save.
+	struct ProgramBinary
+	{
+		uint64 sel;
+		uint32 gen;
+		GLenum type;
+		GLenum format;
+		std::vector<char> data;
+	};
+
+	std::unordered_map<uint64, ProgramBinary> m_binary_cache;
+	std::string m_binary_cache_file;
+	uint32 m_binary_cache_gen;
+	bool m_binary_cache_dirty;
+
+	static bool ReadBinaryCache(const std::string& file, const std::string& driver, std::unordered_map<uint64, ProgramBinary>& cache, uint32& gen);
+	static void PruneBinaryCache(std::unordered_map<uint64, ProgramBinary>& cache, uint32 gen);
+	GLuint LoadProgramBinary(uint64 hash);
+	void StoreProgramBinary(uint64 hash, uint64 sel, GLenum type, GLuint p);
+	static std::string GetDriverString();
+
 	bool ValidateShader(GLuint s);
 	bool ValidateProgram(GLuint p);
 	bool ValidatePipeline(GLuint p);
@@ -35,13 +61,16 @@ class GSShaderOGL
 	std::vector<char> m_common_header;
 
 public:
+	// Selector of the programs that aren't built from tfx.glsl (convert, merge...)
+	static const uint64 NO_SELECTOR = ~0ull;
+
 	GSShaderOGL(bool debug);
 	~GSShaderOGL();
 
 	void BindPipeline(GLuint vs, GLuint gs, GLuint ps);
 	void BindPipeline(GLuint pipe);
 
-	GLuint Compile(const std::string& glsl_file, const std::string& entry, GLenum type, const char* glsl_h_code, const std::string& macro_sel = "");
+	GLuint Compile(const std::string& glsl_file, const std::string& entry, GLenum type, const char* glsl_h_code, const std::string& macro_sel = "", uint64 sel = NO_SELECTOR);
 	GLuint LinkPipeline(const std::string& pretty_print, GLuint vs, GLuint gs, GLuint ps);
 
 	// Same as above but for not separated build
@@ -52,4 +81,9 @@ public:
 	GLuint LinkProgram(GLuint vs, GLuint gs, GLuint ps);
 
 	int DumpAsm(const std::string& file, GLuint p);
+
+	void LoadBinaryCache(const std::string& file);
+	void SaveBinaryCache();
+	std::vector<uint64> GetCachedSelectors(GLenum type) const;
+	bool HasCachedBinary(GLenum type, uint64 sel) const;
 };
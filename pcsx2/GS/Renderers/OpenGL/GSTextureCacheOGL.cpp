@@ -21,11 +21,8 @@ GSTextureCacheOGL::GSTextureCacheOGL(GSRenderer* r)
 {
 }
 
-void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
+GSTexture* GSTextureCacheOGL::CopyTargetOffscreen(Target* t, const GSVector4i& r)
 {
-	if (!t->m_dirty.empty() || r.width() == 0 || r.height() == 0)
-		return;
-
 	const GIFRegTEX0& TEX0 = t->m_TEX0;
 
 	GLuint fmt;
@@ -57,7 +54,7 @@ void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
 			break;
 
 		default:
-			return;
+			return NULL;
 	}
 
 
@@ -69,44 +66,7 @@ void GSTextureCacheOGL::Read(Target* t, const GSVector4i& r)
 
 	GSVector4 src = GSVector4(r) * GSVector4(t->m_texture->GetScale()).xyxy() / GSVector4(t->m_texture->GetSize()).xyxy();
 
-	if (GSTexture* offscreen = m_renderer->m_dev->CopyOffscreen(t->m_texture, src, r.width(), r.height(), fmt, ps_shader))
-	{
-		GSTexture::GSMap m;
-		GSVector4i r_offscreen(0, 0, r.width(), r.height());
-
-		if (offscreen->Map(m, &r_offscreen))
-		{
-			// TODO: block level write
-
-			GSOffset* off = m_renderer->m_mem.GetOffset(TEX0.TBP0, TEX0.TBW, TEX0.PSM);
-
-			switch (TEX0.PSM)
-			{
-				case PSM_PSMCT32:
-				case PSM_PSMZ32:
-					m_renderer->m_mem.WritePixel32(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT24:
-				case PSM_PSMZ24:
-					m_renderer->m_mem.WritePixel24(m.bits, m.pitch, off, r);
-					break;
-				case PSM_PSMCT16:
-				case PSM_PSMCT16S:
-				case PSM_PSMZ16:
-				case PSM_PSMZ16S:
-					m_renderer->m_mem.WritePixel16(m.bits, m.pitch, off, r);
-					break;
-
-				default:
-					ASSERT(0);
-			}
-
-			offscreen->Unmap();
-		}
-
-		// FIXME invalidate data
-		m_renderer->m_dev->Recycle(offscreen);
-	}
+	return m_renderer->m_dev->CopyOffscreen(t->m_texture, src, r.width(), r.height(), fmt, ps_shader);
 }
 
 void GSTextureCacheOGL::Read(Source* t, const GSVector4i& r)
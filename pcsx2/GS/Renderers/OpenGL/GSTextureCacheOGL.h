@@ -23,7 +23,7 @@ class GSTextureCacheOGL final : public GSTextureCache
 protected:
 	int Get8bitFormat() { return GL_R8; }
 
-	void Read(Target* t, const GSVector4i& r);
+	GSTexture* CopyTargetOffscreen(Target* t, const GSVector4i& r);
 	void Read(Source* t, const GSVector4i& r);
 
 public:
@@ -29,19 +29,24 @@ namespace PboPool
 
 	const uint32 m_pbo_size = 64 * 1024 * 1024;
 	const uint32 m_seg_size = 16 * 1024 * 1024;
+	const uint32 m_seg_count = m_pbo_size / m_seg_size;
 
 	GLuint m_buffer;
 	uptr m_offset;
 	char* m_map;
 	uint32 m_size;
-	GLsync m_fence[m_pbo_size / m_seg_size];
+	// A fence protects a segment once the transfers leave it
+	GLsync m_fence[m_seg_count];
+	// Segment that is currently written (its fence was already waited)
+	uint32 m_segment;
+	// Number of times the CPU had to wait the GPU to reuse a segment
+	uint32 m_stall_count;
 
 	// Option for buffer storage
-	// XXX: actually does I really need coherent and barrier???
-	// As far as I understand glTexSubImage2D is a client-server transfer so no need to make
-	// the value visible to the server
-	const GLbitfield common_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT;
-	const GLbitfield map_flags = common_flags | GL_MAP_FLUSH_EXPLICIT_BIT;
+	// The buffer is coherent so the CPU writes are visible to the GPU without an explicit flush.
+	// The fences are still required to not overwrite data that isn't yet consumed by the GPU.
+	const GLbitfield common_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLbitfield map_flags = common_flags;
 	const GLbitfield create_flags = common_flags | GL_CLIENT_STORAGE_BIT;
 
 	void Init()
@@ -55,6 +60,8 @@ namespace PboPool
 		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_pbo_size, NULL, create_flags);
 		m_map = (char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_pbo_size, map_flags);
 		m_offset = 0;
+		m_segment = 0;
+		m_stall_count = 0;
 
 		for (size_t i = 0; i < countof(m_fence); i++)
 		{
@@ -88,7 +95,7 @@ namespace PboPool
 
 	void Unmap()
 	{
-		glFlushMappedBufferRange(GL_PIXEL_UNPACK_BUFFER, m_offset, m_size);
+		// Nothing to do, the buffer is coherent
 	}
 
 	uptr Offset()
@@ -96,6 +103,13 @@ namespace PboPool
 		return m_offset;
 	}
 
+	uint32 TakeStallCount()
+	{
+		const uint32 count = m_stall_count;
+		m_stall_count = 0;
+		return count;
+	}
+
 	void Destroy()
 	{
 		m_map = NULL;
@@ -104,6 +118,7 @@ namespace PboPool
 		for (size_t i = 0; i < countof(m_fence); i++)
 		{
 			glDeleteSync(m_fence[i]);
+			m_fence[i] = 0;
 		}
 
 		glDeleteBuffers(1, &m_buffer);
@@ -114,43 +129,55 @@ namespace PboPool
 		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
 	}
 
-	void Sync()
+	void Fence(uint32 segment)
 	{
-		uint32 segment_current = m_offset / m_seg_size;
-		uint32 segment_next = (m_offset + m_size) / m_seg_size;
+		// The new fence is after the old one in the command stream, so it is enough to wait it
+		if (m_fence[segment])
+			glDeleteSync(m_fence[segment]);
+
+		m_fence[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
 
-		if (segment_current != segment_next)
+	void WaitSegment(uint32 segment)
+	{
+		if (!m_fence[segment])
+			return;
+
+		GLenum status = glClientWaitSync(m_fence[segment], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		// Potentially it doesn't work on AMD driver which might always return GL_CONDITION_SATISFIED
+		if (status != GL_ALREADY_SIGNALED)
 		{
-			if (segment_next >= countof(m_fence))
-			{
-				segment_next = 0;
-			}
-			// Align current transfer on the start of the segment
-			m_offset = m_seg_size * segment_next;
-
-			if (m_size > m_seg_size)
-			{
-				fprintf(stderr, "BUG: PBO Map size %u is bigger than a single segment %u. Crossing more than one fence is not supported yet, texture data may be corrupted.\n", m_size, m_seg_size);
-				// TODO Synchronize all crossed fences
-			}
+			m_stall_count++;
+			GL_PERF("GL_PIXEL_UNPACK_BUFFER: Sync Sync (%x)! Buffer too small ?", status);
+		}
 
+		glDeleteSync(m_fence[segment]);
+		m_fence[segment] = 0;
+	}
+
+	void Sync()
+	{
+		// The transfer doesn't fit at the end of the buffer, restart from the beginning
+		if (m_offset + m_size > m_pbo_size)
+		{
 			// protect the left segment
-			m_fence[segment_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-
-			// Check next segment is free
-			if (m_fence[segment_next])
-			{
-				GLenum status = glClientWaitSync(m_fence[segment_next], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
-				// Potentially it doesn't work on AMD driver which might always return GL_CONDITION_SATISFIED
-				if (status != GL_ALREADY_SIGNALED)
-				{
-					GL_PERF("GL_PIXEL_UNPACK_BUFFER: Sync Sync (%x)! Buffer too small ?", status);
-				}
-
-				glDeleteSync(m_fence[segment_next]);
-				m_fence[segment_next] = 0;
-			}
+			Fence(m_segment);
+
+			m_offset = 0;
+			m_segment = m_seg_count; // All the segments of the transfer must be checked
+		}
+
+		// Check that all the segments that will be written are free
+		uint32 segment_first = m_offset / m_seg_size;
+		uint32 segment_last = std::min<uint32>((m_offset + std::max(m_size, 1u) - 1) / m_seg_size, m_seg_count - 1);
+
+		for (uint32 s = segment_first; s <= segment_last; s++)
+		{
+			if (s != m_segment)
+				WaitSegment(s);
 		}
+
+		m_segment = segment_last;
 	}
 
 	void UnbindPbo()
@@ -160,12 +187,26 @@ namespace PboPool
 
 	void EndTransfer()
 	{
+		uint32 segment_current = m_offset / m_seg_size;
+
 		m_offset += m_size;
+
+		// protect all the segments left by the transfer (the upload command was already sent)
+		uint32 segment_next = std::min<uint32>(m_offset / m_seg_size, m_seg_count);
+
+		for (uint32 s = segment_current; s < segment_next; s++)
+		{
+			Fence(s);
+		}
+
+		if (m_offset >= m_pbo_size)
+			m_offset = 0;
 	}
 } // namespace PboPool
 
 GSTextureOGL::GSTextureOGL(int type, int w, int h, int format, GLuint fbo_read, bool mipmap)
 	: m_clean(false), m_generate_mipmap(true), m_local_buffer(nullptr), m_r_x(0), m_r_y(0), m_r_w(0), m_r_h(0), m_layer(0)
+	, m_pbo_pack_id(0), m_pbo_pack_fence(0), m_pbo_pack_valid(false), m_pbo_pack_mapped(false)
 {
 	// OpenGL didn't like dimensions of size 0
 	m_size.x = std::max(1, w);
@@ -349,6 +390,9 @@ GSTextureOGL::GSTextureOGL(int type, int w, int h, int format, GLuint fbo_read,
 
 GSTextureOGL::~GSTextureOGL()
 {
+	// A held back draw might still sample or render into the texture
+	GLState::FlushBatch();
+
 	/* Unbind the texture from our local state */
 
 	if (m_texture_id == GLState::rt)
@@ -363,6 +407,12 @@ GSTextureOGL::~GSTextureOGL()
 
 	glDeleteTextures(1, &m_texture_id);
 
+	if (m_pbo_pack_id)
+	{
+		glDeleteSync(m_pbo_pack_fence);
+		glDeleteBuffers(1, &m_pbo_pack_id);
+	}
+
 	GLState::available_vram += m_mem_usage;
 
 	if (m_local_buffer)
@@ -371,11 +421,13 @@ GSTextureOGL::~GSTextureOGL()
 
 void GSTextureOGL::Clear(const void* data)
 {
+	GLState::FlushBatch();
 	glClearTexImage(m_texture_id, GL_TEX_LEVEL_0, m_int_format, m_int_type, data);
 }
 
 void GSTextureOGL::Clear(const void* data, const GSVector4i& area)
 {
+	GLState::FlushBatch();
 	glClearTexSubImage(m_texture_id, GL_TEX_LEVEL_0, area.x, area.y, 0, area.width(), area.height(), 1, m_int_format, m_int_type, data);
 }
 
@@ -394,6 +446,8 @@ bool GSTextureOGL::Update(const GSVector4i& r, const void* data, int pitch, int
 
 	m_clean = false;
 
+	GLState::FlushBatch();
+
 	uint32 row_byte = r.width() << m_int_shift;
 	uint32 map_size = r.height() * row_byte;
 #ifdef ENABLE_OGL_DEBUG_MEM_BW
@@ -450,6 +504,74 @@ bool GSTextureOGL::Update(const GSVector4i& r, const void* data, int pitch, int
 	return true;
 }
 
+bool GSTextureOGL::UpdateBatch(const GSUpload* uploads, int count)
+{
+	ASSERT(m_type != GSTexture::DepthStencil && m_type != GSTexture::Offscreen);
+
+	// Every rect keeps the 64 bytes alignment of a single transfer inside the shared map
+	uint32 map_size = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (uploads[i].layer < m_max_layer)
+			map_size += ((uploads[i].r.height() * (uploads[i].r.width() << m_int_shift)) + 63) & ~0x3F;
+	}
+
+	if (map_size == 0)
+		return true;
+
+	// Don't let a single transfer hold several segments of the pool
+	if (count == 1 || map_size > PboPool::m_seg_size)
+		return GSTexture::UpdateBatch(uploads, count);
+
+	m_clean = false;
+
+	GLState::FlushBatch();
+
+#ifdef ENABLE_OGL_DEBUG_MEM_BW
+	g_real_texture_upload_byte += map_size;
+#endif
+
+	GL_PUSH("Upload Texture %d (%d rects)", m_texture_id, count);
+
+	char* map = PboPool::Map(map_size);
+	uptr offset = PboPool::Offset();
+
+	for (int i = 0; i < count; i++)
+	{
+		const GSUpload& u = uploads[i];
+
+		if (u.layer >= m_max_layer)
+			continue;
+
+		uint32 row_byte = u.r.width() << m_int_shift;
+		uint32 size = ((u.r.height() * row_byte) + 63) & ~0x3F;
+		const char* src = (const char*)u.data;
+		char* dst = map;
+
+		for (int h = 0; h < u.r.height(); h++)
+		{
+			memcpy(dst, src, row_byte);
+			dst += row_byte;
+			src += u.pitch;
+		}
+
+		glTextureSubImage2D(m_texture_id, u.layer, u.r.x, u.r.y, u.r.width(), u.r.height(), m_int_format, m_int_type, (const void*)offset);
+
+		map += size;
+		offset += size;
+	}
+
+	PboPool::Unmap();
+
+	PboPool::UnbindPbo();
+
+	PboPool::EndTransfer();
+
+	m_generate_mipmap = true;
+
+	return true;
+}
+
 bool GSTextureOGL::Map(GSMap& m, const GSVector4i* _r, int layer)
 {
 	if (layer >= m_max_layer)
@@ -463,7 +585,30 @@ bool GSTextureOGL::Map(GSMap& m, const GSVector4i* _r, int layer)
 	uint32 row_byte = r.width() << m_int_shift;
 	m.pitch = row_byte;
 
-	if (m_type == GSTexture::Offscreen)
+	if (m_type == GSTexture::Offscreen && m_pbo_pack_valid && r.eq(GSVector4i(0, 0, m_size.x, m_size.y)))
+	{
+		// The data was downloaded by StartDownload, only wait the end of the transfer
+		if (m_pbo_pack_fence)
+		{
+			glClientWaitSync(m_pbo_pack_fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+			glDeleteSync(m_pbo_pack_fence);
+			m_pbo_pack_fence = 0;
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo_pack_id);
+		m.bits = (uint8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, r.height() * row_byte, GL_MAP_READ_BIT);
+
+		if (!m.bits)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			return false;
+		}
+
+		m_pbo_pack_mapped = true;
+
+		return true;
+	}
+	else if (m_type == GSTexture::Offscreen)
 	{
 		// The fastest way will be to use a PBO to read the data asynchronously. Unfortunately GS
 		// architecture is waiting the data right now.
@@ -475,6 +620,8 @@ bool GSTextureOGL::Map(GSMap& m, const GSVector4i* _r, int layer)
 		glGetTextureSubImage(m_texture_id, GL_TEX_LEVEL_0, r.x, r.y, 0, r.width(), r.height(), 1, m_int_format, m_int_type, m_size.x * m_size.y * 4, m_local_buffer);
 #else
 
+		GLState::FlushBatch();
+
 		// Bind the texture to the read framebuffer to avoid any disturbance
 		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_read);
 		glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture_id, 0);
@@ -521,11 +668,19 @@ bool GSTextureOGL::Map(GSMap& m, const GSVector4i* _r, int layer)
 
 void GSTextureOGL::Unmap()
 {
-	if (m_type == GSTexture::Texture || m_type == GSTexture::RenderTarget)
+	if (m_pbo_pack_mapped)
+	{
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		m_pbo_pack_mapped = false;
+	}
+	else if (m_type == GSTexture::Texture || m_type == GSTexture::RenderTarget)
 	{
 
 		PboPool::Unmap();
 
+		GLState::FlushBatch();
+
 		glTextureSubImage2D(m_texture_id, m_layer, m_r_x, m_r_y, m_r_w, m_r_h, m_int_format, m_int_type, (const void*)PboPool::Offset());
 
 		// FIXME OGL4: investigate, only 1 unpack buffer always bound
@@ -539,10 +694,67 @@ void GSTextureOGL::Unmap()
 	}
 }
 
+void GSTextureOGL::StartDownload()
+{
+	if (m_type != GSTexture::Offscreen)
+		return;
+
+	GLState::FlushBatch();
+
+	GL_PUSH("Download Offscreen %d", m_texture_id);
+
+	const uint32 size = (m_size.x * m_size.y) << m_int_shift;
+
+	if (m_pbo_pack_id == 0)
+	{
+		glGenBuffers(1, &m_pbo_pack_id);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo_pack_id);
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+	}
+	else
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo_pack_id);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo_read);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture_id, 0);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1u << m_int_shift);
+
+	// The copy runs asynchronously into the PBO
+	glReadPixels(0, 0, m_size.x, m_size.y, m_int_format, m_int_type, (void*)0);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glDeleteSync(m_pbo_pack_fence);
+	m_pbo_pack_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_pbo_pack_valid = true;
+}
+
+bool GSTextureOGL::IsDownloadReady()
+{
+	if (!m_pbo_pack_fence)
+		return true;
+
+	// Zero timeout, only flush the fence so it is eventually signaled
+	GLenum status = glClientWaitSync(m_pbo_pack_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+void GSTextureOGL::DiscardDownload()
+{
+	glDeleteSync(m_pbo_pack_fence);
+	m_pbo_pack_fence = 0;
+	m_pbo_pack_valid = false;
+}
+
 void GSTextureOGL::GenerateMipmap()
 {
 	if (m_generate_mipmap && m_max_layer > 1)
 	{
+		GLState::FlushBatch();
 		glGenerateTextureMipmap(m_texture_id);
 		m_generate_mipmap = false;
 	}
@@ -550,6 +762,8 @@ void GSTextureOGL::GenerateMipmap()
 
 void GSTextureOGL::CommitPages(const GSVector2i& region, bool commit)
 {
+	GLState::FlushBatch();
+
 	GLState::available_vram += m_mem_usage;
 
 	if (commit)
@@ -588,6 +802,8 @@ void GSTextureOGL::CommitPages(const GSVector2i& region, bool commit)
 
 bool GSTextureOGL::Save(const std::string& fn)
 {
+	GLState::FlushBatch();
+
 	// Collect the texture data
 	uint32 pitch = 4 * m_committed_size.x;
 	uint32 buf_size = pitch * m_committed_size.y * 2; // Note *2 for security (depth/stencil)
@@ -646,7 +862,7 @@ bool GSTextureOGL::Save(const std::string& fn)
 	}
 
 	int compression = theApp.GetConfigI("png_compression_level");
-	return GSPng::Save(fmt, fn, image.get(), m_committed_size.x, m_committed_size.y, pitch, compression);
+	return GSPng::SaveAsync(fmt, fn, image.get(), m_committed_size.x, m_committed_size.y, pitch, compression);
 }
 
 uint32 GSTextureOGL::GetMemUsage()
@@ -28,6 +28,11 @@ namespace PboPool
 	inline void Unmap();
 	inline uptr Offset();
 	inline void EndTransfer();
+	inline void Fence(uint32 segment);
+	inline void WaitSegment(uint32 segment);
+
+	// Stalls since the previous call
+	uint32 TakeStallCount();
 
 	void Init();
 	void Destroy();
@@ -59,13 +64,24 @@ private:
 	// Allow to track size of allocated memory
 	uint32 m_mem_usage;
 
+	// Asynchronous download of an offscreen texture
+	GLuint m_pbo_pack_id;
+	GLsync m_pbo_pack_fence;
+	bool m_pbo_pack_valid;
+	bool m_pbo_pack_mapped;
+
+	void DiscardDownload();
+
 public:
 	explicit GSTextureOGL(int type, int w, int h, int format, GLuint fbo_read, bool mipmap);
 	virtual ~GSTextureOGL();
 
 	bool Update(const GSVector4i& r, const void* data, int pitch, int layer = 0) final;
+	bool UpdateBatch(const GSUpload* uploads, int count) final;
 	bool Map(GSMap& m, const GSVector4i* r = NULL, int layer = 0) final;
 	void Unmap() final;
+	void StartDownload() final;
+	bool IsDownloadReady() final;
 	void GenerateMipmap() final;
 	bool Save(const std::string& fn) final;
 
@@ -74,7 +90,12 @@ public:
 
 	uint32 GetID() final { return m_texture_id; }
 	bool HasBeenCleaned() { return m_clean; }
-	void WasAttached() { m_clean = false; }
+	void WasAttached()
+	{
+		m_clean = false;
+		if (m_pbo_pack_valid)
+			DiscardDownload();
+	}
 	void WasCleaned() { m_clean = true; }
 
 	void Clear(const void* data);
@@ -44,9 +44,8 @@ public:
 
 	void bind()
 	{
-		if (GLState::ubo != m_buffer)
+		if (GLState::Changed(GLState::ubo, m_buffer))
 		{
-			GLState::ubo = m_buffer;
 			glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
 		}
 	}
@@ -60,8 +59,11 @@ public:
 	{
 		// From the opengl manpage:
 		// glBindBufferBase also binds buffer to the generic buffer binding point specified by target
-		GLState::ubo = m_buffer;
-		glBindBufferBase(GL_UNIFORM_BUFFER, m_index, m_buffer);
+		if (GLState::ChangedUBO(m_index, m_buffer))
+		{
+			GLState::ubo = m_buffer;
+			glBindBufferBase(GL_UNIFORM_BUFFER, m_index, m_buffer);
+		}
 	}
 
 	void upload(const void* src)
@@ -114,9 +116,8 @@ public:
 
 	void bind()
 	{
-		if (GLState::ubo != m_buffer)
+		if (GLState::Changed(GLState::ubo, m_buffer))
 		{
-			GLState::ubo = m_buffer;
 			glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
 		}
 	}
@@ -217,7 +217,25 @@ public:
 		glDrawElementsBaseVertex(mode, count, GL_UNSIGNED_INT, (void*)((m_start + offset) * STRIDE), basevertex);
 	}
 
+	void DrawRange(GLenum mode, GLint basevertex, size_t start, size_t count)
+	{
+		glDrawElementsBaseVertex(mode, count, GL_UNSIGNED_INT, (void*)(start * STRIDE), basevertex);
+	}
+
+	// True when count elements can be mapped right after the current ones
+	// without wrapping or crossing a fenced chunk
+	bool CanAppend(size_t count)
+	{
+		size_t start = m_start + m_count;
+
+		if (count > m_limit - start)
+			return false;
+
+		return ((start * STRIDE) >> m_quarter_shift) == (((start + count) * STRIDE) >> m_quarter_shift);
+	}
+
 	size_t GetStart() { return m_start; }
+	size_t GetCount() { return m_count; }
 };
 
 class GSVertexBufferStateOGL
@@ -297,7 +315,21 @@ public:
 
 	void DrawIndexedPrimitive(int offset, int count) { m_ib->Draw(m_topology, m_vb->GetStart(), offset, count); }
 
+	void DrawIndexedPrimitive(GLint basevertex) { m_ib->Draw(m_topology, basevertex); }
+
+	void DrawIndexedPrimitive(GLint basevertex, int offset, int count) { m_ib->Draw(m_topology, basevertex, offset, count); }
+
+	void DrawIndexedRange(GLenum topology, GLint basevertex, size_t start, size_t count) { m_ib->DrawRange(topology, basevertex, start, count); }
+
 	void SetTopology(GLenum topology) { m_topology = topology; }
+	GLenum GetTopology() { return m_topology; }
+
+	size_t GetVBStart() { return m_vb->GetStart(); }
+	size_t GetIBStart() { return m_ib->GetStart(); }
+	size_t GetIBCount() { return m_ib->GetCount(); }
+
+	bool CanAppendVB(size_t count) { return m_vb->CanAppend(count); }
+	bool CanAppendIB(size_t count) { return m_ib->CanAppend(count); }
 
 	void* MapVB(size_t count)
 	{
@@ -342,6 +374,9 @@ public:
 		}
 	}
 
+	void* MapIB(size_t count) { return m_ib->map(count); }
+	void UnmapIB() { m_ib->unmap(); }
+
 	void UploadIB(const void* index, size_t count)
 	{
 		while (true)
@@ -83,24 +83,29 @@ void GSDrawScanline::BeginDraw(const GSRasterizerData* data)
 		m_dr = NULL;
 	}
 
+	m_sp = m_sp_map[GetSetupPrimSelector(m_global.sel)];
+}
+
+GSScanlineSelector GSDrawScanline::GetSetupPrimSelector(const GSScanlineSelector& global)
+{
 	// doesn't need all bits => less functions generated
 
 	GSScanlineSelector sel;
 
 	sel.key = 0;
 
-	sel.iip = m_global.sel.iip;
-	sel.tfx = m_global.sel.tfx;
-	sel.tcc = m_global.sel.tcc;
-	sel.fst = m_global.sel.fst;
-	sel.fge = m_global.sel.fge;
-	sel.prim = m_global.sel.prim;
-	sel.fb = m_global.sel.fb;
-	sel.zb = m_global.sel.zb;
-	sel.zoverflow = m_global.sel.zoverflow;
-	sel.notest = m_global.sel.notest;
-
-	m_sp = m_sp_map[sel];
+	sel.iip = global.iip;
+	sel.tfx = global.tfx;
+	sel.tcc = global.tcc;
+	sel.fst = global.fst;
+	sel.fge = global.fge;
+	sel.prim = global.prim;
+	sel.fb = global.fb;
+	sel.zb = global.zb;
+	sel.zoverflow = global.zoverflow;
+	sel.notest = global.notest;
+
+	return sel;
 }
 
 void GSDrawScanline::EndDraw(uint64 frame, uint64 ticks, int actual, int total)
@@ -108,6 +113,61 @@ void GSDrawScanline::EndDraw(uint64 frame, uint64 ticks, int actual, int total)
 	m_ds_map.UpdateStats(frame, ticks, actual, total);
 }
 
+uint32 GSDrawScanline::GetZMin(const GSVector4i& r) const
+{
+	ASSERT((r.left & 3) == 0 && (r.right & 3) == 0);
+
+	// Same addressing and masking as the depth test of the scanline
+
+	const GSVector4i mask(0xffffffff >> (m_global.sel.zpsm * 8));
+
+	GSVector4i zmin = GSVector4i::xffffffff();
+
+	for (int y = r.top; y < r.bottom; y++)
+	{
+		const GSVector2i* RESTRICT za_offset = &m_global.fzbc[r.left >> 2];
+
+		int za_base = m_global.fzbr[y].y;
+
+		for (int x = r.left; x < r.right; x += 4, za_offset++)
+		{
+			int za = za_base + za_offset->y;
+
+			GSVector4i zd = GSVector4i::load((uint8*)m_global.vm + za * 2, (uint8*)m_global.vm + za * 2 + 16);
+
+			zmin = zmin.min_u32(zd & mask);
+		}
+	}
+
+	zmin = zmin.min_u32(zmin.zwxy());
+	zmin = zmin.min_u32(zmin.yxwz());
+
+	return (uint32)zmin.extract32<0>();
+}
+
+void GSDrawScanline::GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const
+{
+	m_ds_map.GetUsedKeys(ds);
+	m_sp_map.GetUsedKeys(sp);
+}
+
+void GSDrawScanline::GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset)
+{
+	m_ds_map.GetStats(stats, reset);
+}
+
+void GSDrawScanline::Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm)
+{
+	// The local memory address is the only global value baked into the code
+	m_global.vm = vm;
+
+	for (uint64 key : sp)
+		m_sp_map.Prewarm(key);
+
+	for (uint64 key : ds)
+		m_ds_map.Prewarm(key);
+}
+
 #ifndef ENABLE_JIT_RASTERIZER
 
 void GSDrawScanline::SetupPrim(const GSVertexSW* vertex, const uint32* index, const GSVertexSW& dscan)
@@ -80,8 +80,17 @@ public:
 
 #endif
 
+	// The setup only depends on a few bits of the scanline selector
+	static GSScanlineSelector GetSetupPrimSelector(const GSScanlineSelector& sel);
+
 	void PrintStats()
 	{
 		m_ds_map.PrintStats();
 	}
+
+	uint32 GetZMin(const GSVector4i& r) const;
+
+	void GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const;
+	void GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset);
+	void Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm);
 };
@@ -165,7 +165,12 @@ void GSDrawScanlineCodeGenerator::alltrue(const Xmm& test)
 
 void GSDrawScanlineCodeGenerator::blend(const Xmm& a, const Xmm& b, const Xmm& mask)
 {
-	if (m_cpu.has(Xbyak::util::Cpu::tAVX))
+	if (m_cpu.has(Xbyak::util::Cpu::tAVX512VL))
+	{
+		// a = mask ? b : a, bitwise
+		vpternlogd(a, b, mask, 0xd8);
+	}
+	else if (m_cpu.has(Xbyak::util::Cpu::tAVX))
 	{
 		vpand(b, mask);
 		vpandn(mask, a);
@@ -34,11 +34,13 @@ static int compute_best_thread_height(int threads)
 		return 4;
 }
 
-GSRasterizer::GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon)
+GSRasterizer::GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon, bool tiled)
 	: m_perfmon(perfmon)
 	, m_ds(ds)
 	, m_id(id)
-	, m_threads(threads)
+	, m_threads(tiled ? 1 : threads)
+	, m_owner(id)
+	, m_tile_threads(tiled ? threads : 0)
 {
 	memset(&m_pixels, 0, sizeof(m_pixels));
 
@@ -47,16 +49,38 @@ GSRasterizer::GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* pe
 	m_edge.buff = (GSVertexSW*)vmalloc(sizeof(GSVertexSW) * 2048, false);
 	m_edge.count = 0;
 
+	// A tile must not be shared with another thread, in either mode
+
+	m_hiz.enabled = theApp.GetConfigB("sw_hiz");
+	m_hiz.height_shift = tiled ? 4 : std::min(m_thread_height, 4);
+	m_hiz.key = 0;
+	m_hiz.epoch = 0;
+	m_hiz.zlimit = 0;
+	m_hiz.greater = false;
+	m_hiz.test = false;
+	m_hiz.zref = 0;
+
+	if (m_hiz.enabled)
+	{
+		size_t tiles = (2048 >> HiZWidthShift) * (2048 >> m_hiz.height_shift);
+
+		m_hiz.zmin.resize(tiles);
+		m_hiz.dirty.resize(tiles, 1);
+	}
+
 	int rows = (2048 >> m_thread_height) + 16;
 	m_scanline = (uint8*)_aligned_malloc(rows, 64);
+	m_owner_scanline = m_scanline;
 
 	int row = 0;
 
+	// In tile mode every scanline is ours, the scissor of the tile does the clipping
+
 	while (row < rows)
 	{
-		for (int i = 0; i < threads; i++, row++)
+		for (int i = 0; i < m_threads; i++, row++)
 		{
-			m_scanline[row] = i == id ? 1 : 0;
+			m_scanline[row] = tiled || i == id ? 1 : 0;
 		}
 	}
 }
@@ -75,7 +99,7 @@ bool GSRasterizer::IsOneOfMyScanlines(int top) const
 {
 	ASSERT(top >= 0 && top < 2048);
 
-	return m_scanline[top >> m_thread_height] != 0;
+	return m_owner_scanline[top >> m_thread_height] != 0;
 }
 
 bool GSRasterizer::IsOneOfMyScanlines(int top, int bottom) const
@@ -87,7 +111,7 @@ bool GSRasterizer::IsOneOfMyScanlines(int top, int bottom) const
 
 	while (top < bottom)
 	{
-		if (m_scanline[top++])
+		if (m_owner_scanline[top++])
 		{
 			return true;
 		}
@@ -100,9 +124,9 @@ int GSRasterizer::FindMyNextScanline(int top) const
 {
 	int i = top >> m_thread_height;
 
-	if (m_scanline[i] == 0)
+	if (m_owner_scanline[i] == 0)
 	{
-		while (m_scanline[++i] == 0)
+		while (m_owner_scanline[++i] == 0)
 			;
 
 		top = i << m_thread_height;
@@ -142,6 +166,132 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	m_ds->BeginDraw(data);
 
+	if (m_hiz.enabled)
+	{
+		BeginHiZ(data);
+	}
+
+	if (m_tile_threads > 0)
+	{
+		DrawTiles(data);
+	}
+	else
+	{
+		DrawPrims(data);
+	}
+
+#if _M_SSE >= 0x501
+	_mm256_zeroupper();
+#endif
+
+	data->pixels = m_pixels.actual;
+
+	uint64 ticks = __rdtsc() - data->start;
+
+	m_pixels.sum += m_pixels.actual;
+
+	m_ds->EndDraw(data->frame, ticks, m_pixels.actual, m_pixels.total);
+}
+
+void GSRasterizer::Draw(GSRasterizerData* data, const GSRasterizer* owner)
+{
+	// Draw the share of another rasterizer, for a stolen job
+
+	m_owner = owner->m_id;
+	m_owner_scanline = owner->m_scanline;
+
+	Draw(data);
+
+	m_owner = m_id;
+	m_owner_scanline = m_scanline;
+}
+
+void GSRasterizer::BeginHiZ(const GSRasterizerData* data)
+{
+	m_hiz.test = false;
+
+	if (data->hiz.epoch != m_hiz.epoch || (data->hiz.key != m_hiz.key && data->hiz.key != 0))
+	{
+		memset(m_hiz.dirty.data(), 1, m_hiz.dirty.size());
+
+		m_hiz.epoch = data->hiz.epoch;
+	}
+
+	if (data->hiz.key == 0)
+		return;
+
+	m_hiz.key = data->hiz.key;
+
+	GSVector4i r = data->bbox.rintersect(data->scissor);
+
+	if (r.rempty())
+		return;
+
+	if (data->hiz.zwrite)
+	{
+		int columns = 2048 >> HiZWidthShift;
+
+		int left = r.left >> HiZWidthShift;
+		int right = ((r.right - 1) >> HiZWidthShift) + 1;
+
+		for (int ty = r.top >> m_hiz.height_shift, ty_end = (r.bottom - 1) >> m_hiz.height_shift; ty <= ty_end; ty++)
+		{
+			memset(&m_hiz.dirty[ty * columns + left], 1, right - left);
+		}
+	}
+
+	if (data->hiz.ztst != 0 && data->primclass == GS_TRIANGLE_CLASS)
+	{
+		m_hiz.zlimit = data->hiz.zmax;
+		m_hiz.greater = data->hiz.ztst == ZTST_GREATER;
+		m_hiz.test = true;
+	}
+}
+
+void GSRasterizer::SetHiZTriangle(const GSVertexSW* vertex, const GSRasterizerTriangle& t)
+{
+	// The float z of the vertices is rounded and interpolated, leave a margin
+
+	float z = std::max(std::max(vertex[t.i[0]].p.z, vertex[t.i[1]].p.z), vertex[t.i[2]].p.z);
+
+	uint64 zmax = std::min<uint64>((uint64)(std::max(z, 0.0f) * (1.0 + 1.0 / 65536)) + 16, m_hiz.zlimit);
+
+	m_hiz.zref = m_hiz.greater ? zmax : zmax + 1;
+}
+
+bool GSRasterizer::IsHiddenSpan(int left, int right, int top)
+{
+	int columns = 2048 >> HiZWidthShift;
+	int ty = top >> m_hiz.height_shift;
+
+	for (int tx = left >> HiZWidthShift, tx_end = (right - 1) >> HiZWidthShift; tx <= tx_end; tx++)
+	{
+		int i = ty * columns + tx;
+
+		if (m_hiz.dirty[i])
+		{
+			GSVector4i r(tx << HiZWidthShift, ty << m_hiz.height_shift, (tx + 1) << HiZWidthShift, (ty + 1) << m_hiz.height_shift);
+
+			m_hiz.zmin[i] = m_ds->GetZMin(r);
+			m_hiz.dirty[i] = 0;
+		}
+
+		if (m_hiz.zmin[i] < m_hiz.zref)
+			return false;
+	}
+
+	return true;
+}
+
+void GSRasterizer::SetScissor(const GSVector4i& scissor)
+{
+	m_scissor = scissor;
+	m_fscissor_x = GSVector4(scissor).xzxz();
+	m_fscissor_y = GSVector4(scissor).ywyw();
+}
+
+void GSRasterizer::DrawPrims(const GSRasterizerData* data)
+{
 	const GSVertexSW* vertex = data->vertex;
 	const GSVertexSW* vertex_end = data->vertex + data->vertex_count;
 
@@ -152,9 +302,7 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 	bool scissor_test = !data->bbox.eq(data->bbox.rintersect(data->scissor));
 
-	m_scissor = data->scissor;
-	m_fscissor_x = GSVector4(data->scissor).xzxz();
-	m_fscissor_y = GSVector4(data->scissor).ywyw();
+	SetScissor(data->scissor);
 
 	switch (data->primclass)
 	{
@@ -194,7 +342,17 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 
 		case GS_TRIANGLE_CLASS:
 
-			if (index != NULL)
+			if (data->setup != NULL)
+			{
+				const GSRasterizerTriangle* RESTRICT t = data->setup;
+				const GSRasterizerTriangle* RESTRICT t_end = t + (index != NULL ? data->index_count : data->vertex_count) / 3;
+
+				do
+				{
+					DrawTriangle(vertex, *t);
+				} while (++t < t_end);
+			}
+			else if (index != NULL)
 			{
 				do
 				{
@@ -237,18 +395,143 @@ void GSRasterizer::Draw(GSRasterizerData* data)
 		default:
 			__assume(0);
 	}
+}
 
-#if _M_SSE >= 0x501
-	_mm256_zeroupper();
-#endif
+void GSRasterizer::DrawTiles(const GSRasterizerData* data)
+{
+	GSVector4i r = data->bbox.rintersect(data->scissor);
 
-	data->pixels = m_pixels.actual;
+	if (r.rempty())
+		return;
 
-	uint64 ticks = __rdtsc() - data->start;
+	// Collect the tiles of the draw owned by this thread
 
-	m_pixels.sum += m_pixels.actual;
+	GSVector4i tr(
+		r.left >> TileWidthShift,
+		r.top >> TileHeightShift,
+		((r.right - 1) >> TileWidthShift) + 1,
+		((r.bottom - 1) >> TileHeightShift) + 1);
 
-	m_ds->EndDraw(data->frame, ticks, m_pixels.actual, m_pixels.total);
+	int columns = tr.width();
+	int count = 0;
+
+	m_tile_slot.assign(columns * tr.height(), -1);
+
+	for (int ty = tr.top; ty < tr.bottom; ty++)
+	{
+		for (int tx = tr.left; tx < tr.right; tx++)
+		{
+			if (GetTileOwner(tx, ty, m_tile_threads) != m_owner)
+				continue;
+
+			if (count == (int)m_tiles.size())
+				m_tiles.emplace_back();
+
+			Tile& tile = m_tiles[count];
+
+			tile.rect = GSVector4i(
+				tx << TileWidthShift,
+				ty << TileHeightShift,
+				(tx + 1) << TileWidthShift,
+				(ty + 1) << TileHeightShift).rintersect(data->scissor);
+			tile.prims.clear();
+
+			m_tile_slot[(ty - tr.top) * columns + (tx - tr.left)] = count++;
+		}
+	}
+
+	if (count == 0)
+		return;
+
+	if (data->primclass == GS_POINT_CLASS)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			SetScissor(m_tiles[i].rect);
+
+			DrawPoint<true>(data->vertex, data->vertex_count, data->index, data->index_count);
+		}
+
+		return;
+	}
+
+	// Bin the primitives by their bounding box, one pixel larger for the edges
+
+	int n = data->primclass == GS_TRIANGLE_CLASS ? 3 : 2;
+	int prims = (data->index != NULL ? data->index_count : data->vertex_count) / n;
+
+	uint32 tmp_index[] = {0, 1, 2};
+
+	for (int i = 0; i < prims; i++)
+	{
+		const GSVertexSW* vertex = data->index != NULL ? data->vertex : &data->vertex[i * n];
+		const uint32* index = data->index != NULL ? &data->index[i * n] : tmp_index;
+
+		GSVector4 pmin = vertex[index[0]].p;
+		GSVector4 pmax = pmin;
+
+		for (int j = 1; j < n; j++)
+		{
+			pmin = pmin.min(vertex[index[j]].p);
+			pmax = pmax.max(vertex[index[j]].p);
+		}
+
+		GSVector4i b = GSVector4i(pmin.xyxy(pmax).floor()) + GSVector4i(-1, -1, 1, 1);
+
+		int left = std::max<int>(b.left >> TileWidthShift, tr.left);
+		int top = std::max<int>(b.top >> TileHeightShift, tr.top);
+		int right = std::min<int>(b.right >> TileWidthShift, tr.right - 1);
+		int bottom = std::min<int>(b.bottom >> TileHeightShift, tr.bottom - 1);
+
+		for (int ty = top; ty <= bottom; ty++)
+		{
+			for (int tx = left; tx <= right; tx++)
+			{
+				int slot = m_tile_slot[(ty - tr.top) * columns + (tx - tr.left)];
+
+				if (slot >= 0)
+				{
+					m_tiles[slot].prims.push_back(i);
+				}
+			}
+		}
+	}
+
+	// Draw the bins, a tile has a single owner so the primitive order is kept
+
+	for (int k = 0; k < count; k++)
+	{
+		const Tile& tile = m_tiles[k];
+
+		if (tile.prims.empty())
+			continue;
+
+		SetScissor(tile.rect);
+
+		for (uint32 i : tile.prims)
+		{
+			const GSVertexSW* vertex = data->index != NULL ? data->vertex : &data->vertex[i * n];
+			const uint32* index = data->index != NULL ? &data->index[i * n] : tmp_index;
+
+			switch (data->primclass)
+			{
+				case GS_LINE_CLASS:
+					DrawLine(vertex, index);
+					break;
+				case GS_TRIANGLE_CLASS:
+					if (data->setup != NULL)
+						DrawTriangle(data->vertex, data->setup[i]);
+					else
+						DrawTriangle(vertex, index);
+					break;
+				case GS_SPRITE_CLASS:
+					DrawSprite(vertex, index);
+					break;
+				default:
+					__assume(0);
+			}
+		}
+	}
 }
 
 template <bool scissor_test>
@@ -412,19 +695,17 @@ static const uint8 s_ysort[8][4] =
 
 #if _M_SSE >= 0x501
 
-void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
+bool GSRasterizer::SetupTriangle(const GSVertexSW* vertex, const uint32* index, GSRasterizerTriangle& t)
 {
 	GSVertexSW2 dv[3];
-	GSVertexSW2 edge;
 	GSVertexSW2 dedge;
-	GSVertexSW2 dscan;
 
 	GSVector4 y0011 = vertex[index[0]].p.yyyy(vertex[index[1]].p);
 	GSVector4 y1221 = vertex[index[1]].p.yyyy(vertex[index[2]].p).xzzx();
 
 	int m1 = (y0011 > y1221).mask() & 7;
 
-	int i[3];
+	uint32* i = t.i;
 
 	i[0] = index[s_ysort[m1][0]];
 	i[1] = index[s_ysort[m1][1]];
@@ -446,12 +727,9 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	// if(i == 4) => y0 < y1 == y2
 
 	if (m1 == 7) // y0 == y1 == y2
-		return;
+		return false;
 
-	GSVector4 tbf = y0011.xzxz(y1221).ceil();
-	GSVector4 tbmax = tbf.max(m_fscissor_y);
-	GSVector4 tbmin = tbf.min(m_fscissor_y);
-	GSVector4i tb = GSVector4i(tbmax.xzyw(tbmin)); // max(y0, t) max(y1, t) min(y1, b) min(y2, b)
+	t.tbf = y0011.xzxz(y1221).ceil();
 
 	dv[0] = v1 - v0;
 	dv[1] = v2 - v0;
@@ -466,7 +744,7 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	int m2 = cross.upl(cross == GSVector4::zero()).mask();
 
 	if (m2 & 2)
-		return;
+		return false;
 
 	m2 &= 1;
 
@@ -489,64 +767,41 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	dedge = dv[0] * dxy01c.zzzz() - dv[1] * dxy01c.xxxx();
 	*/
 
-	dscan.p = dv[1].p * _dxy01c.yyyy().extract<0>() - dv[0].p * _dxy01c.wwww().extract<0>();
-	dscan.tc = dv[1].tc * _dxy01c.yyyy() - dv[0].tc * _dxy01c.wwww();
+	t.dscan.p = dv[1].p * _dxy01c.yyyy().extract<0>() - dv[0].p * _dxy01c.wwww().extract<0>();
+	t.dscan.tc = dv[1].tc * _dxy01c.yyyy() - dv[0].tc * _dxy01c.wwww();
 
 	dedge.p = dv[0].p * _dxy01c.zzzz().extract<0>() - dv[1].p * _dxy01c.xxxx().extract<0>();
 	dedge.tc = dv[0].tc * _dxy01c.zzzz() - dv[1].tc * _dxy01c.xxxx();
 
-	if (m1 & 1)
-	{
-		if (tb.y < tb.w)
-		{
-			edge = _v[i[1 - m2]];
-
-			edge.p = edge.p.insert32<0, 1>(vertex[i[m2]].p);
-			dedge.p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
+	t.flat = (m1 & 1) != 0;
 
-			DrawTriangleSection(tb.x, tb.w, edge, dedge, dscan, vertex[i[1 - m2]].p);
-		}
+	if (t.flat)
+	{
+		t.ev[1] = i[1 - m2];
+		t.edge[1] = vertex[i[1 - m2]].p.insert32<0, 1>(vertex[i[m2]].p);
 	}
 	else
 	{
-		if (tb.x < tb.z)
-		{
-			edge = v0;
-
-			edge.p = edge.p.xxzw();
-			dedge.p = ddx[m2].xyzw(dedge.p);
-
-			DrawTriangleSection(tb.x, tb.z, edge, dedge, dscan, v0.p);
-		}
-
-		if (tb.y < tb.w)
-		{
-			edge = v1;
+		t.ev[0] = i[0];
+		t.edge[0] = v0.p.xxzw();
+		t.dedge[0].p = ddx[m2].xyzw(dedge.p);
+		t.dedge[0].tc = dedge.tc;
 
-			edge.p = (v0.p.xxxx() + ddx[m2] * dv[0].p.yyyy()).xyzw(edge.p);
-			dedge.p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
-
-			DrawTriangleSection(tb.y, tb.w, edge, dedge, dscan, v1.p);
-		}
+		t.ev[1] = i[1];
+		t.edge[1] = (v0.p.xxxx() + ddx[m2] * dv[0].p.yyyy()).xyzw(v1.p);
 	}
 
-	Flush(vertex, index, (GSVertexSW&)dscan);
+	t.dedge[1].p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
+	t.dedge[1].tc = dedge.tc;
 
-	if (m_ds->HasEdge())
-	{
-		GSVector4 a = dx.abs() < dy.abs();       // |dx| <= |dy|
-		GSVector4 b = dx < GSVector4::zero();    // dx < 0
-		GSVector4 c = cross < GSVector4::zero(); // longest.p.x < 0
+	GSVector4 a = dx.abs() < dy.abs();       // |dx| <= |dy|
+	GSVector4 b = dx < GSVector4::zero();    // dx < 0
+	GSVector4 c = cross < GSVector4::zero(); // longest.p.x < 0
 
-		int orientation = a.mask();
-		int side = ((a | b) ^ c).mask() ^ 2; // evil
+	t.orientation = a.mask();
+	t.side = ((a | b) ^ c).mask() ^ 2; // evil
 
-		DrawEdge((GSVertexSW&)v0, (GSVertexSW&)v1, (GSVertexSW&)dv[0], orientation & 1, side & 1);
-		DrawEdge((GSVertexSW&)v0, (GSVertexSW&)v2, (GSVertexSW&)dv[1], orientation & 2, side & 2);
-		DrawEdge((GSVertexSW&)v1, (GSVertexSW&)v2, (GSVertexSW&)dv[2], orientation & 4, side & 4);
-
-		Flush(vertex, index, GSVertexSW::zero(), true);
-	}
+	return true;
 }
 
 void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW2& edge, const GSVertexSW2& dedge, const GSVertexSW2& dscan, const GSVector4& p0)
@@ -578,7 +833,7 @@ void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW2& edge, c
 
 		int pixels = right - left;
 
-		if (pixels > 0)
+		if (pixels > 0 && !(m_hiz.test && IsHiddenSpan(left, right, top)))
 		{
 			scan.tc = edge.tc + dedge.tc * dy;
 
@@ -603,19 +858,17 @@ void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW2& edge, c
 
 #else
 
-void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
+bool GSRasterizer::SetupTriangle(const GSVertexSW* vertex, const uint32* index, GSRasterizerTriangle& t)
 {
 	GSVertexSW dv[3];
-	GSVertexSW edge;
 	GSVertexSW dedge;
-	GSVertexSW dscan;
 
 	GSVector4 y0011 = vertex[index[0]].p.yyyy(vertex[index[1]].p);
 	GSVector4 y1221 = vertex[index[1]].p.yyyy(vertex[index[2]].p).xzzx();
 
 	int m1 = (y0011 > y1221).mask() & 7;
 
-	int i[3];
+	uint32* i = t.i;
 
 	i[0] = index[s_ysort[m1][0]];
 	i[1] = index[s_ysort[m1][1]];
@@ -635,12 +888,9 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	// if(i == 4) => y0 < y1 == y2
 
 	if (m1 == 7)
-		return; // y0 == y1 == y2
+		return false; // y0 == y1 == y2
 
-	GSVector4 tbf = y0011.xzxz(y1221).ceil();
-	GSVector4 tbmax = tbf.max(m_fscissor_y);
-	GSVector4 tbmin = tbf.min(m_fscissor_y);
-	GSVector4i tb = GSVector4i(tbmax.xzyw(tbmin)); // max(y0, t) max(y1, t) min(y1, b) min(y2, b)
+	t.tbf = y0011.xzxz(y1221).ceil();
 
 	dv[0] = v1 - v0;
 	dv[1] = v2 - v0;
@@ -655,7 +905,7 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	int m2 = cross.upl(cross == GSVector4::zero()).mask();
 
 	if (m2 & 2)
-		return;
+		return false;
 
 	m2 &= 1;
 
@@ -678,66 +928,43 @@ void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
 	dedge = dv[0] * dxy01c.zzzz() - dv[1] * dxy01c.xxxx();
 	*/
 
-	dscan.p = dv[1].p * dxy01c.yyyy() - dv[0].p * dxy01c.wwww();
-	dscan.t = dv[1].t * dxy01c.yyyy() - dv[0].t * dxy01c.wwww();
-	dscan.c = dv[1].c * dxy01c.yyyy() - dv[0].c * dxy01c.wwww();
+	t.dscan.p = dv[1].p * dxy01c.yyyy() - dv[0].p * dxy01c.wwww();
+	t.dscan.t = dv[1].t * dxy01c.yyyy() - dv[0].t * dxy01c.wwww();
+	t.dscan.c = dv[1].c * dxy01c.yyyy() - dv[0].c * dxy01c.wwww();
 
 	dedge.p = dv[0].p * dxy01c.zzzz() - dv[1].p * dxy01c.xxxx();
 	dedge.t = dv[0].t * dxy01c.zzzz() - dv[1].t * dxy01c.xxxx();
 	dedge.c = dv[0].c * dxy01c.zzzz() - dv[1].c * dxy01c.xxxx();
 
-	if (m1 & 1)
-	{
-		if (tb.y < tb.w)
-		{
-			edge = vertex[i[1 - m2]];
-
-			edge.p = edge.p.insert32<0, 1>(vertex[i[m2]].p);
-			dedge.p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
+	t.flat = (m1 & 1) != 0;
 
-			DrawTriangleSection(tb.x, tb.w, edge, dedge, dscan, vertex[i[1 - m2]].p);
-		}
+	if (t.flat)
+	{
+		t.ev[1] = i[1 - m2];
+		t.edge[1] = vertex[i[1 - m2]].p.insert32<0, 1>(vertex[i[m2]].p);
 	}
 	else
 	{
-		if (tb.x < tb.z)
-		{
-			edge = v0;
-
-			edge.p = edge.p.xxzw();
-			dedge.p = ddx[m2].xyzw(dedge.p);
-
-			DrawTriangleSection(tb.x, tb.z, edge, dedge, dscan, v0.p);
-		}
-
-		if (tb.y < tb.w)
-		{
-			edge = v1;
+		t.ev[0] = i[0];
+		t.edge[0] = v0.p.xxzw();
+		t.dedge[0] = dedge;
+		t.dedge[0].p = ddx[m2].xyzw(dedge.p);
 
-			edge.p = (v0.p.xxxx() + ddx[m2] * dv[0].p.yyyy()).xyzw(edge.p);
-			dedge.p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
-
-			DrawTriangleSection(tb.y, tb.w, edge, dedge, dscan, v1.p);
-		}
+		t.ev[1] = i[1];
+		t.edge[1] = (v0.p.xxxx() + ddx[m2] * dv[0].p.yyyy()).xyzw(v1.p);
 	}
 
-	Flush(vertex, index, dscan);
-
-	if (m_ds->HasEdge())
-	{
-		GSVector4 a = dx.abs() < dy.abs();       // |dx| <= |dy|
-		GSVector4 b = dx < GSVector4::zero();    // dx < 0
-		GSVector4 c = cross < GSVector4::zero(); // longest.p.x < 0
+	t.dedge[1] = dedge;
+	t.dedge[1].p = ddx[2 - (m2 << 1)].yzzw(dedge.p);
 
-		int orientation = a.mask();
-		int side = ((a | b) ^ c).mask() ^ 2; // evil
+	GSVector4 a = dx.abs() < dy.abs();       // |dx| <= |dy|
+	GSVector4 b = dx < GSVector4::zero();    // dx < 0
+	GSVector4 c = cross < GSVector4::zero(); // longest.p.x < 0
 
-		DrawEdge(v0, v1, dv[0], orientation & 1, side & 1);
-		DrawEdge(v0, v2, dv[1], orientation & 2, side & 2);
-		DrawEdge(v1, v2, dv[2], orientation & 4, side & 4);
+	t.orientation = a.mask();
+	t.side = ((a | b) ^ c).mask() ^ 2; // evil
 
-		Flush(vertex, index, GSVertexSW::zero(), true);
-	}
+	return true;
 }
 
 void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW& edge, const GSVertexSW& dedge, const GSVertexSW& dscan, const GSVector4& p0)
@@ -769,7 +996,7 @@ void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW& edge, co
 
 		int pixels = right - left;
 
-		if (pixels > 0)
+		if (pixels > 0 && !(m_hiz.test && IsHiddenSpan(left, right, top)))
 		{
 			scan.t = edge.t + dedge.t * dy;
 			scan.c = edge.c + dedge.c * dy;
@@ -796,6 +1023,113 @@ void GSRasterizer::DrawTriangleSection(int top, int bottom, GSVertexSW& edge, co
 
 #endif
 
+void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const uint32* index)
+{
+	GSRasterizerTriangle t;
+
+	t.index[0] = index[0];
+	t.index[1] = index[1];
+	t.index[2] = index[2];
+
+	t.valid = SetupTriangle(vertex, index, t);
+
+	DrawTriangle(vertex, t);
+}
+
+void GSRasterizer::DrawTriangle(const GSVertexSW* vertex, const GSRasterizerTriangle& t)
+{
+	typedef GSRasterizerTriangle::Vertex Vertex;
+
+	if (!t.valid)
+		return;
+
+	if (m_hiz.test)
+	{
+		SetHiZTriangle(vertex, t);
+	}
+
+	const Vertex* _v = (const Vertex*)vertex;
+
+	GSVector4 tbmax = t.tbf.max(m_fscissor_y);
+	GSVector4 tbmin = t.tbf.min(m_fscissor_y);
+	GSVector4i tb = GSVector4i(tbmax.xzyw(tbmin)); // max(y0, t) max(y1, t) min(y1, b) min(y2, b)
+
+	Vertex edge;
+
+	if (!t.flat && tb.x < tb.z)
+	{
+		edge = _v[t.ev[0]];
+		edge.p = t.edge[0];
+
+		DrawTriangleSection(tb.x, tb.z, edge, t.dedge[0], t.dscan, _v[t.ev[0]].p);
+	}
+
+	int top = t.flat ? tb.x : tb.y;
+
+	if (top < tb.w)
+	{
+		edge = _v[t.ev[1]];
+		edge.p = t.edge[1];
+
+		DrawTriangleSection(top, tb.w, edge, t.dedge[1], t.dscan, _v[t.ev[1]].p);
+	}
+
+	Flush(vertex, t.index, (const GSVertexSW&)t.dscan);
+
+	if (m_ds->HasEdge())
+	{
+		const Vertex& v0 = _v[t.i[0]];
+		const Vertex& v1 = _v[t.i[1]];
+		const Vertex& v2 = _v[t.i[2]];
+
+		Vertex dv[3];
+
+		dv[0] = v1 - v0;
+		dv[1] = v2 - v0;
+		dv[2] = v2 - v1;
+
+		DrawEdge((const GSVertexSW&)v0, (const GSVertexSW&)v1, (const GSVertexSW&)dv[0], t.orientation & 1, t.side & 1);
+		DrawEdge((const GSVertexSW&)v0, (const GSVertexSW&)v2, (const GSVertexSW&)dv[1], t.orientation & 2, t.side & 2);
+		DrawEdge((const GSVertexSW&)v1, (const GSVertexSW&)v2, (const GSVertexSW&)dv[2], t.orientation & 4, t.side & 4);
+
+		Flush(vertex, t.index, GSVertexSW::zero(), true);
+	}
+}
+
+void GSRasterizer::SetupTriangles(GSRasterizerData* data)
+{
+	int count = (data->index != NULL ? data->index_count : data->vertex_count) / 3;
+
+	if (count == 0)
+		return;
+
+	GSRasterizerTriangle* RESTRICT t = (GSRasterizerTriangle*)_aligned_malloc(sizeof(GSRasterizerTriangle) * count, 32);
+
+	for (int k = 0; k < count; k++)
+	{
+		// Without an index buffer the vertices are simply in order
+
+		if (data->index != NULL)
+		{
+			memcpy(t[k].index, &data->index[k * 3], sizeof(t[k].index));
+		}
+		else
+		{
+			t[k].index[0] = k * 3 + 0;
+			t[k].index[1] = k * 3 + 1;
+			t[k].index[2] = k * 3 + 2;
+		}
+
+		t[k].valid = SetupTriangle(data->vertex, t[k].index, t[k]);
+	}
+
+	data->setup = t;
+
+#if _M_SSE >= 0x501
+	_mm256_zeroupper();
+#endif
+}
+
 void GSRasterizer::DrawSprite(const GSVertexSW* vertex, const uint32* index)
 {
 	const GSVertexSW& v0 = vertex[index[0]];
@@ -1168,9 +1502,48 @@ void GSRasterizer::DrawEdge(int pixels, int left, int top, const GSVertexSW& sca
 
 GSRasterizerList::GSRasterizerList(int threads, GSPerfMon* perfmon)
 	: m_perfmon(perfmon)
+	, m_job_count(0)
+	, m_pending(0)
+	, m_steals(0)
+	, m_exit(false)
 {
 	m_thread_height = compute_best_thread_height(threads);
 
+	// Tile binning hasn't been measured against the scanline interleaving yet (see
+	// GSBenchmark), it stays opt-in until it has been.
+	m_tiled = threads > 1 && theApp.GetConfigB("extrathreads_tiles");
+	m_steal = !theApp.GetConfigB("sw_hiz"); // the HiZ tiles of a rasterizer are private to its thread
+	m_tile_queued.resize(threads);
+	m_owners.reserve(threads);
+
+	m_jobs.reset(new DrawJob[MaxJobs]);
+
+	if (theApp.GetConfigB("extrathreads_setup"))
+	{
+		m_setup = std::make_unique<GSJobQueue<std::shared_ptr<GSRasterizerData>, 256>>([this](std::shared_ptr<GSRasterizerData>& item)
+		{
+			if (item->primclass == GS_TRIANGLE_CLASS)
+			{
+				GSRasterizer::SetupTriangles(item.get());
+			}
+
+			QueueJob(item);
+
+			item.reset();
+		});
+	}
+
+	for (int i = 0; i < threads; i++)
+	{
+		Worker* w = new Worker();
+
+		w->running_count = 0;
+		w->wake = false;
+		w->idle = false;
+
+		m_workers.push_back(std::unique_ptr<Worker>(w));
+	}
+
 	int rows = (2048 >> m_thread_height) + 16;
 	m_scanline = (uint8*)_aligned_malloc(rows, 64);
 
@@ -1187,48 +1560,316 @@ GSRasterizerList::GSRasterizerList(int threads, GSPerfMon* perfmon)
 
 GSRasterizerList::~GSRasterizerList()
 {
+	Sync();
+
+	m_setup.reset();
+
+	for (auto& w : m_workers)
+	{
+		{
+			std::lock_guard<std::mutex> l(w->lock);
+			m_exit = true;
+		}
+
+		w->notempty.notify_one();
+	}
+
+	for (auto& w : m_workers)
+	{
+		if (w->thread.joinable())
+			w->thread.join();
+	}
+
 	_aligned_free(m_scanline);
 }
 
+void GSRasterizerList::Start()
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->thread = std::thread(&GSRasterizerList::ThreadProc, this, (int)i);
+	}
+}
+
+void GSRasterizerList::ThreadProc(int id)
+{
+	Worker& w = *m_workers[id];
+
+	if (EmuConfig.Speedhacks.threadPinning)
+		Threading::ApplyWorkerAffinity(id);
+
+	int threads = (int)m_workers.size();
+
+	while (true)
+	{
+		int owner = id;
+
+		DrawJob* job = Pop(id, false);
+
+		for (int i = 1; i < threads && job == NULL; i++)
+		{
+			owner = (id + i) % threads;
+
+			job = Pop(owner, true);
+		}
+
+		if (job == NULL)
+		{
+			std::unique_lock<std::mutex> l(w.lock);
+
+			w.idle = true;
+
+			while (!m_exit && !w.wake && !IsRunnable(w))
+				w.notempty.wait(l);
+
+			w.idle = false;
+			w.wake = false;
+
+			if (m_exit)
+				return;
+
+			continue;
+		}
+
+		if (owner == id)
+		{
+			m_r[id]->Draw(job->data.get());
+		}
+		else
+		{
+			m_r[id]->Draw(job->data.get(), m_r[owner].get());
+
+			m_steals++;
+		}
+
+		Finish(owner, job);
+	}
+}
+
+bool GSRasterizerList::IsRunnable(const Worker& w) const
+{
+	if (w.queue.empty() || w.running_count >= 2)
+		return false;
+
+	const GSVector4i& r = w.queue.front()->rect;
+
+	for (int i = 0; i < w.running_count; i++)
+	{
+		if (!w.running[i]->rect.rintersect(r).rempty())
+			return false;
+	}
+
+	return true;
+}
+
+void GSRasterizerList::Push(int owner, DrawJob* job)
+{
+	Worker& w = *m_workers[owner];
+
+	size_t size;
+
+	{
+		std::lock_guard<std::mutex> l(w.lock);
+
+		w.queue.push_back(job);
+
+		size = w.queue.size();
+	}
+
+	w.notempty.notify_one();
+
+	if (size < 2 || !m_steal)
+		return;
+
+	// The owner has a backlog, wake up an idle sibling to steal from it
+
+	for (size_t i = 1; i < m_workers.size(); i++)
+	{
+		Worker& idle = *m_workers[(owner + i) % m_workers.size()];
+
+		if (idle.idle)
+		{
+			{
+				std::lock_guard<std::mutex> l(idle.lock);
+
+				idle.wake = true;
+			}
+
+			idle.notempty.notify_one();
+
+			break;
+		}
+	}
+}
+
+GSRasterizerList::DrawJob* GSRasterizerList::Pop(int owner, bool steal)
+{
+	Worker& w = *m_workers[owner];
+
+	std::lock_guard<std::mutex> l(w.lock);
+
+	// Only steal from a busy owner, an idle one takes its jobs itself
+
+	if (steal && (w.running_count != 1 || !m_steal))
+		return NULL;
+
+	if (!IsRunnable(w))
+		return NULL;
+
+	DrawJob* job = w.queue.front();
+
+	w.queue.pop_front();
+
+	w.running[w.running_count++] = job;
+
+	return job;
+}
+
+void GSRasterizerList::Finish(int owner, DrawJob* job)
+{
+	Worker& w = *m_workers[owner];
+
+	{
+		std::lock_guard<std::mutex> l(w.lock);
+
+		if (w.running[0] == job)
+			w.running[0] = w.running[1];
+
+		w.running_count--;
+
+		// The owner may wait for this job to draw an overlapping one
+		if (!w.queue.empty())
+			w.notempty.notify_one();
+	}
+
+	if (--job->owners == 0)
+		job->data.reset();
+
+	if (--m_pending == 0)
+	{
+		std::lock_guard<std::mutex> l(m_sync_lock);
+
+		m_sync.notify_all();
+	}
+}
+
 void GSRasterizerList::Queue(const std::shared_ptr<GSRasterizerData>& data)
+{
+	if (m_setup)
+	{
+		m_setup->Push(data);
+	}
+	else
+	{
+		QueueJob(data);
+	}
+}
+
+void GSRasterizerList::QueueJob(const std::shared_ptr<GSRasterizerData>& data)
 {
 	GSVector4i r = data->bbox.rintersect(data->scissor);
 
 	ASSERT(r.top >= 0 && r.top < 2048 && r.bottom >= 0 && r.bottom < 2048);
 
-	int top = r.top >> m_thread_height;
-	int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + m_workers.size());
+	int threads = (int)m_workers.size();
 
-	while (top < bottom)
+	m_owners.clear();
+
+	if (m_tiled)
 	{
-		m_workers[m_scanline[top++]]->Push(data);
+		// Every owner of one of its tiles draws it
+
+		if (r.rempty())
+			return;
+
+		memset(m_tile_queued.data(), 0, threads);
+
+		for (int ty = r.top >> GSRasterizer::TileHeightShift; ty <= (r.bottom - 1) >> GSRasterizer::TileHeightShift && (int)m_owners.size() < threads; ty++)
+		{
+			for (int tx = r.left >> GSRasterizer::TileWidthShift; tx <= (r.right - 1) >> GSRasterizer::TileWidthShift; tx++)
+			{
+				int i = GSRasterizer::GetTileOwner(tx, ty, threads);
+
+				if (m_tile_queued[i] == 0)
+				{
+					m_tile_queued[i] = 1;
+
+					m_owners.push_back(i);
+				}
+			}
+		}
+	}
+	else
+	{
+		int top = r.top >> m_thread_height;
+		int bottom = std::min<int>((r.bottom + (1 << m_thread_height) - 1) >> m_thread_height, top + threads);
+
+		while (top < bottom)
+		{
+			m_owners.push_back(m_scanline[top++]);
+		}
+	}
+
+	if (m_owners.empty())
+		return;
+
+	// Every previous job is done, their records can be reused
+
+	if (m_pending == 0)
+	{
+		m_job_count = 0;
+	}
+	else if (m_job_count == MaxJobs)
+	{
+		WaitPending();
+
+		m_job_count = 0;
+	}
+
+	DrawJob* job = &m_jobs[m_job_count++];
+
+	job->data = data;
+	job->rect = r;
+	job->owners = (int)m_owners.size();
+
+	m_pending += (int)m_owners.size();
+
+	for (int i : m_owners)
+	{
+		Push(i, job);
 	}
 }
 
+void GSRasterizerList::WaitPending()
+{
+	std::unique_lock<std::mutex> l(m_sync_lock);
+
+	while (m_pending > 0)
+		m_sync.wait(l);
+}
+
 void GSRasterizerList::Sync()
 {
 	if (!IsSynced())
 	{
-		for (size_t i = 0; i < m_workers.size(); i++)
+		if (m_setup)
 		{
-			m_workers[i]->Wait();
+			m_setup->Wait();
 		}
 
+		WaitPending();
+
 		m_perfmon->Put(GSPerfMon::SyncPoint, 1);
 	}
+
+	m_job_count = 0;
+
+	m_perfmon->Put(GSPerfMon::WorkSteal, m_steals.exchange(0));
 }
 
 bool GSRasterizerList::IsSynced() const
 {
-	for (size_t i = 0; i < m_workers.size(); i++)
-	{
-		if (!m_workers[i]->IsEmpty())
-		{
-			return false;
-		}
-	}
-
-	return true;
+	return m_pending == 0 && (!m_setup || m_setup->IsEmpty());
 }
 
 int GSRasterizerList::GetPixels(bool reset)
@@ -1242,3 +1883,28 @@ int GSRasterizerList::GetPixels(bool reset)
 
 	return pixels;
 }
+
+void GSRasterizerList::GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const
+{
+	for (const auto& r : m_r)
+	{
+		r->GetUsedSelectors(ds, sp);
+	}
+}
+
+void GSRasterizerList::GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset)
+{
+	for (const auto& r : m_r)
+	{
+		r->GetSelectorStats(stats, reset);
+	}
+}
+
+void GSRasterizerList::Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm)
+{
+	// Every rasterizer has its own functions, they point at its local data
+	for (const auto& r : m_r)
+	{
+		r->Prewarm(ds, sp, vm);
+	}
+}
@@ -22,6 +22,28 @@
 #include "GS/GSPerfMon.h"
 #include "GS/GSThread_CXX11.h"
 
+// The part of the triangle setup that depends neither on the scissor nor on the
+// scanlines of a thread, it can be computed once and read by every worker.
+struct alignas(32) GSRasterizerTriangle
+{
+#if _M_SSE >= 0x501
+	typedef GSVertexSW2 Vertex;
+#else
+	typedef GSVertexSW Vertex;
+#endif
+
+	Vertex dscan;
+	Vertex dedge[2]; // upper and lower section
+	GSVector4 edge[2]; // start of the sections, the vertex ev[] gives the rest
+	GSVector4 tbf; // y0 y1 y1 y2, rounded up
+	uint32 index[3]; // as drawn, for SetupPrim
+	uint32 i[3]; // sorted by y
+	uint32 ev[2];
+	int orientation, side; // of the edges, for the AA1 pass
+	bool valid;
+	bool flat; // y0 == y1, only the lower section
+};
+
 class alignas(32) GSRasterizerData : public GSAlignedClass<32>
 {
 	static int s_counter;
@@ -35,6 +57,15 @@ public:
 	int vertex_count;
 	uint32* index;
 	int index_count;
+	GSRasterizerTriangle* setup; // one per triangle when the setup stage did it
+	struct
+	{
+		uint32 key; // z buffer in use, 0 if none
+		uint32 epoch; // changes when the z buffer was written outside of z writes
+		uint32 zmax; // largest value of the format
+		int ztst; // GEQUAL or GREATER when spans may be rejected, 0 otherwise
+		bool zwrite;
+	} hiz;
 	uint64 frame;
 	uint64 start;
 	int pixels;
@@ -49,6 +80,8 @@ public:
 		, vertex_count(0)
 		, index(NULL)
 		, index_count(0)
+		, setup(NULL)
+		, hiz()
 		, frame(0)
 		, start(0)
 		, pixels(0)
@@ -60,6 +93,9 @@ public:
 	{
 		if (buff != NULL)
 			_aligned_free(buff);
+
+		if (setup != NULL)
+			_aligned_free(setup);
 	}
 };
 
@@ -107,6 +143,13 @@ public:
 
 	virtual void PrintStats() = 0;
 
+	// Smallest z of the current z buffer in r, the left and right sides must be multiples of 4
+	virtual uint32 GetZMin(const GSVector4i& r) const = 0;
+
+	virtual void GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const = 0;
+	virtual void GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset) = 0;
+	virtual void Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm) = 0;
+
 	__forceinline bool HasEdge() const { return m_de != NULL; }
 	__forceinline bool IsSolidRect() const { return m_dr != NULL; }
 };
@@ -121,10 +164,25 @@ public:
 	virtual bool IsSynced() const = 0;
 	virtual int GetPixels(bool reset = true) = 0;
 	virtual void PrintStats() = 0;
+
+	// JIT selectors, must be called while synced
+	virtual void GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const = 0;
+	virtual void GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset) = 0;
+	virtual void Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm) = 0;
 };
 
 class alignas(32) GSRasterizer : public IRasterizer
 {
+public:
+	// Screen tiles of the binning mode, one page of a 32 bits format
+	enum
+	{
+		TileWidthShift = 6,
+		TileHeightShift = 5
+	};
+
+	static __forceinline int GetTileOwner(int tx, int ty, int threads) { return (tx + ty) % threads; }
+
 protected:
 	GSPerfMon* m_perfmon;
 	IDrawScanline* m_ds;
@@ -132,20 +190,60 @@ protected:
 	int m_threads;
 	int m_thread_height;
 	uint8* m_scanline;
+	int m_owner; // the rasterizer whose scanlines or tiles are drawn
+	const uint8* m_owner_scanline;
 	GSVector4i m_scissor;
 	GSVector4 m_fscissor_x;
 	GSVector4 m_fscissor_y;
 	struct { GSVertexSW* buff; int count; } m_edge;
 	struct { int sum, actual, total; } m_pixels;
 
+	struct Tile
+	{
+		GSVector4i rect;
+		std::vector<uint32> prims;
+	};
+
+	int m_tile_threads; // 0 when the screen is split by scanlines
+	std::vector<Tile> m_tiles;
+	std::vector<int> m_tile_slot;
+
+	// Lower bound of the z buffer by tiles of our own scanlines. A tile is read back
+	// from memory when a span needs it after a z write made it dirty, every pixel of
+	// a span below all of its tiles fails the depth test.
+	enum { HiZWidthShift = 5 };
+
+	struct
+	{
+		std::vector<uint32> zmin;
+		std::vector<uint8> dirty;
+		uint32 key;
+		uint32 epoch;
+		int height_shift;
+		uint32 zlimit;
+		bool enabled;
+		bool greater;
+		bool test;
+		uint64 zref; // spans are hidden where the tiles are at least this
+	} m_hiz;
+
+	void BeginHiZ(const GSRasterizerData* data);
+	void SetHiZTriangle(const GSVertexSW* vertex, const GSRasterizerTriangle& t);
+	__forceinline bool IsHiddenSpan(int left, int right, int top);
+
 	typedef void (GSRasterizer::*DrawPrimPtr)(const GSVertexSW* v, int count);
 
 	template <bool scissor_test>
 	void DrawPoint(const GSVertexSW* vertex, int vertex_count, const uint32* index, int index_count);
 	void DrawLine(const GSVertexSW* vertex, const uint32* index);
 	void DrawTriangle(const GSVertexSW* vertex, const uint32* index);
+	void DrawTriangle(const GSVertexSW* vertex, const GSRasterizerTriangle& t);
 	void DrawSprite(const GSVertexSW* vertex, const uint32* index);
 
+	void SetScissor(const GSVector4i& scissor);
+	void DrawPrims(const GSRasterizerData* data);
+	void DrawTiles(const GSRasterizerData* data);
+
 #if _M_SSE >= 0x501
 	__forceinline void DrawTriangleSection(int top, int bottom, GSVertexSW2& edge, const GSVertexSW2& dedge, const GSVertexSW2& dscan, const GSVector4& p0);
 #else
@@ -161,7 +259,7 @@ protected:
 	__forceinline void DrawEdge(int pixels, int left, int top, const GSVertexSW& scan);
 
 public:
-	GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon);
+	GSRasterizer(IDrawScanline* ds, int id, int threads, GSPerfMon* perfmon, bool tiled = false);
 	virtual ~GSRasterizer();
 
 	__forceinline bool IsOneOfMyScanlines(int top) const;
@@ -169,6 +267,10 @@ public:
 	__forceinline int FindMyNextScanline(int top) const;
 
 	void Draw(GSRasterizerData* data);
+	void Draw(GSRasterizerData* data, const GSRasterizer* owner);
+
+	static bool SetupTriangle(const GSVertexSW* vertex, const uint32* index, GSRasterizerTriangle& t);
+	static void SetupTriangles(GSRasterizerData* data);
 
 	// IRasterizer
 
@@ -177,22 +279,73 @@ public:
 	bool IsSynced() const { return true; }
 	int GetPixels(bool reset);
 	void PrintStats() { m_ds->PrintStats(); }
+	void GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const { m_ds->GetUsedSelectors(ds, sp); }
+	void GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset) { m_ds->GetSelectorStats(stats, reset); }
+	void Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm) { m_ds->Prewarm(ds, sp, vm); }
 };
 
 class GSRasterizerList : public IRasterizer
 {
 protected:
-	using GSWorker = GSJobQueue<std::shared_ptr<GSRasterizerData>, 65536>;
+	enum { MaxJobs = 65536 };
+
+	// A queued draw, shared by the workers owning a part of it. The records are
+	// recycled once every worker is idle, the data itself is released by the
+	// last worker since it holds the pages in use.
+	struct DrawJob
+	{
+		std::shared_ptr<GSRasterizerData> data;
+		GSVector4i rect;
+		std::atomic<int> owners;
+	};
+
+	// The jobs of one rasterizer. An idle worker may steal the front job when
+	// it doesn't overlap the one the owner is drawing, then both draw distinct
+	// pixels and the order of the draws is kept.
+	struct Worker
+	{
+		std::thread thread;
+		std::mutex lock;
+		std::condition_variable notempty;
+		std::deque<DrawJob*> queue;
+		DrawJob* running[2];
+		int running_count;
+		bool wake;
+		std::atomic<bool> idle;
+	};
 
 	GSPerfMon* m_perfmon;
-	// Worker threads depend on the rasterizers, so don't change the order.
 	std::vector<std::unique_ptr<GSRasterizer>> m_r;
-	std::vector<std::unique_ptr<GSWorker>> m_workers;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::unique_ptr<DrawJob[]> m_jobs;
+	int m_job_count;
+	std::atomic<int> m_pending;
+	std::atomic<int> m_steals;
+	std::mutex m_sync_lock;
+	std::condition_variable m_sync;
+	bool m_exit;
 	uint8* m_scanline;
 	int m_thread_height;
+	bool m_tiled;
+	bool m_steal;
+	std::vector<uint8> m_tile_queued;
+	std::vector<int> m_owners;
+
+	// Sets up the triangles of a draw ahead of the workers, then queues it
+	std::unique_ptr<GSJobQueue<std::shared_ptr<GSRasterizerData>, 256>> m_setup;
 
 	GSRasterizerList(int threads, GSPerfMon* perfmon);
 
+	void QueueJob(const std::shared_ptr<GSRasterizerData>& data);
+	void WaitPending();
+
+	void Start();
+	void ThreadProc(int id);
+	bool IsRunnable(const Worker& w) const;
+	void Push(int owner, DrawJob* job);
+	DrawJob* Pop(int owner, bool steal);
+	void Finish(int owner, DrawJob* job);
+
 public:
 	virtual ~GSRasterizerList();
 
@@ -210,12 +363,12 @@ public:
 
 		for (int i = 0; i < threads; i++)
 		{
-			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), i, threads, perfmon)));
-			auto& r = *rl->m_r[i];
-			rl->m_workers.push_back(std::unique_ptr<GSWorker>(new GSWorker(
-				[&r](std::shared_ptr<GSRasterizerData>& item) { r.Draw(item.get()); })));
+			rl->m_r.push_back(std::unique_ptr<GSRasterizer>(new GSRasterizer(new DS(), i, threads, perfmon, rl->m_tiled)));
 		}
 
+		// The workers steal from each other, start them once every rasterizer exists
+		rl->Start();
+
 		return rl;
 	}
 
@@ -226,4 +379,7 @@ public:
 	bool IsSynced() const;
 	int GetPixels(bool reset);
 	void PrintStats() {}
+	void GetUsedSelectors(std::set<uint64>& ds, std::set<uint64>& sp) const;
+	void GetSelectorStats(std::map<uint64, GSFunctionStats>& stats, bool reset);
+	void Prewarm(const std::set<uint64>& ds, const std::set<uint64>& sp, void* vm);
 };
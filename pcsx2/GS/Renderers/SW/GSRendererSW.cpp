@@ -36,6 +36,15 @@ GSRendererSW::GSRendererSW(int threads)
 
 	m_rl = GSRasterizerList::Create<GSDrawScanline>(threads, &m_perfmon);
 
+	m_jit_crc = 0;
+	m_jit_profiling = theApp.GetConfigB("sw_jit_profile");
+
+	m_hiz = theApp.GetConfigB("sw_hiz");
+	m_hiz_key = 0;
+	m_hiz_epoch = 0;
+
+	memset(m_hiz_pages, 0, sizeof(m_hiz_pages));
+
 	m_output = (uint8*)_aligned_malloc(1024 * 1024 * sizeof(uint32), 32);
 
 	for (uint32 i = 0; i < countof(m_fzb_pages); i++)
@@ -75,6 +84,12 @@ GSRendererSW::GSRendererSW(int threads)
 
 GSRendererSW::~GSRendererSW()
 {
+	WaitPrewarm();
+
+	m_rl->Sync();
+
+	SaveJITSelectors();
+
 	delete m_tc;
 
 	for (size_t i = 0; i < countof(m_texture); i++)
@@ -96,7 +111,304 @@ void GSRendererSW::Reset()
 	GSRenderer::Reset();
 }
 
-void GSRendererSW::VSync(int field)
+void GSRendererSW::SetGameCRC(uint32 crc, int options)
+{
+	GSRenderer::SetGameCRC(crc, options);
+
+	bool prewarm = theApp.GetConfigB("sw_jit_prewarm");
+
+	if (crc == m_jit_crc || !prewarm && !m_jit_profiling)
+		return;
+
+	// The workers must be idle, the prewarm thread fills their function maps
+
+	WaitPrewarm();
+
+	Sync(8);
+
+	SaveJITSelectors();
+
+	m_jit_crc = crc;
+
+	LoadJITSelectors();
+
+	if (prewarm && (!m_jit_ds.empty() || !m_jit_sp.empty()))
+	{
+		m_jit_prewarm = std::thread([this]() { m_rl->Prewarm(m_jit_ds, m_jit_sp, m_mem.m_vm8); });
+	}
+}
+
+void GSRendererSW::WaitPrewarm()
+{
+	if (m_jit_prewarm.joinable())
+	{
+		m_jit_prewarm.join();
+	}
+}
+
+static const uint32 s_jit_selectors_magic = 0x534a5347; // GSJS
+static const uint32 s_jit_selectors_version = 1;
+static const size_t s_jit_selectors_max = 4096;
+static const size_t s_jit_selectors_hot = 64;
+
+void GSRendererSW::LoadJITSelectors()
+{
+	m_jit_ds.clear();
+	m_jit_sp.clear();
+
+	if (m_jit_crc == 0)
+		return;
+
+	LoadJITProfile();
+
+	if (!theApp.GetConfigB("sw_jit_prewarm"))
+		return;
+
+	FILE* fp = px_fopen(theApp.GetCachePath(format("GS_SW_jit_%08X.bin", m_jit_crc).c_str()), "rb");
+
+	if (!fp)
+		return;
+
+	uint32 magic = 0, version = 0;
+	bool valid = fread(&magic, sizeof(magic), 1, fp) == 1 && magic == s_jit_selectors_magic;
+	valid &= valid && fread(&version, sizeof(version), 1, fp) == 1 && version == s_jit_selectors_version;
+
+	for (std::set<uint64>* keys : {&m_jit_ds, &m_jit_sp})
+	{
+		uint32 count = 0;
+		valid &= valid && fread(&count, sizeof(count), 1, fp) == 1 && count <= s_jit_selectors_max;
+
+		for (uint32 i = 0; valid && i < count; i++)
+		{
+			uint64 key;
+			valid &= fread(&key, sizeof(key), 1, fp) == 1;
+
+			if (valid)
+				keys->insert(key);
+		}
+	}
+
+	fclose(fp);
+
+	if (!valid)
+	{
+		fprintf(stderr, "GS: invalid JIT selector list for %08X, ignored\n", m_jit_crc);
+
+		m_jit_ds.clear();
+		m_jit_sp.clear();
+	}
+
+	// The hottest selectors of the profile are compiled even if the list lost them
+
+	std::vector<std::pair<uint64, uint64>> hot;
+
+	for (const auto& i : m_jit_profile)
+		hot.push_back(std::make_pair(i.second.ticks, i.first));
+
+	std::sort(hot.rbegin(), hot.rend());
+
+	for (size_t i = 0; i < hot.size() && i < s_jit_selectors_hot; i++)
+	{
+		m_jit_ds.insert(hot[i].second);
+		m_jit_sp.insert(GSDrawScanline::GetSetupPrimSelector(hot[i].second));
+	}
+}
+
+void GSRendererSW::SaveJITSelectors()
+{
+	SaveJITProfile();
+
+	if (m_jit_crc == 0 || !theApp.GetConfigB("sw_jit_prewarm"))
+		return;
+
+	std::set<uint64> ds, sp;
+
+	m_rl->GetUsedSelectors(ds, sp);
+
+	if (ds.empty() && sp.empty())
+		return;
+
+	// Keep the selectors of the previous runs while the list stays small
+
+	if (ds.size() + m_jit_ds.size() <= s_jit_selectors_max && sp.size() + m_jit_sp.size() <= s_jit_selectors_max)
+	{
+		ds.insert(m_jit_ds.begin(), m_jit_ds.end());
+		sp.insert(m_jit_sp.begin(), m_jit_sp.end());
+	}
+
+	FILE* fp = px_fopen(theApp.GetCachePath(format("GS_SW_jit_%08X.bin", m_jit_crc).c_str()), "wb");
+
+	if (!fp)
+		return;
+
+	fwrite(&s_jit_selectors_magic, sizeof(s_jit_selectors_magic), 1, fp);
+	fwrite(&s_jit_selectors_version, sizeof(s_jit_selectors_version), 1, fp);
+
+	for (const std::set<uint64>* keys : {&ds, &sp})
+	{
+		uint32 count = (uint32)std::min<size_t>(keys->size(), s_jit_selectors_max);
+
+		fwrite(&count, sizeof(count), 1, fp);
+
+		for (uint64 key : *keys)
+		{
+			if (count-- == 0)
+				break;
+
+			fwrite(&key, sizeof(key), 1, fp);
+		}
+	}
+
+	fclose(fp);
+}
+
+// GS_SW_jit_<crc>.csv holds the cost of every scanline selector, GS_SW_jit_<crc>_features.csv
+// breaks it down by the value of each selector field. Ticks are rdtsc cycles of the draws.
+
+void GSRendererSW::LoadJITProfile()
+{
+	m_jit_profile.clear();
+
+	if (!m_jit_profiling)
+		return;
+
+	FILE* fp = px_fopen(theApp.GetCachePath(format("GS_SW_jit_%08X.csv", m_jit_crc).c_str()), "r");
+
+	if (!fp)
+		return;
+
+	char line[256];
+
+	while (fgets(line, sizeof(line), fp) && m_jit_profile.size() < s_jit_selectors_max)
+	{
+		unsigned long long key;
+		GSFunctionStats s;
+
+		if (sscanf(line, "%llx,%llu,%llu,%llu,%llu", &key, &s.frames, &s.ticks, &s.actual, &s.total) == 5)
+		{
+			m_jit_profile[key] = s;
+		}
+	}
+
+	fclose(fp);
+}
+
+void GSRendererSW::SaveJITProfile()
+{
+	if (!m_jit_profiling)
+		return;
+
+	std::map<uint64, GSFunctionStats> stats;
+
+	m_rl->GetSelectorStats(stats, true);
+
+	if (m_jit_crc == 0 || stats.empty())
+		return;
+
+	for (const auto& i : stats)
+	{
+		GSFunctionStats& s = m_jit_profile[i.first];
+
+		s.frames += i.second.frames;
+		s.ticks += i.second.ticks;
+		s.actual += i.second.actual;
+		s.total += i.second.total;
+	}
+
+	uint64 ticks = 0;
+
+	for (const auto& i : m_jit_profile)
+		ticks += i.second.ticks;
+
+	if (ticks == 0)
+		return;
+
+	if (FILE* fp = px_fopen(theApp.GetCachePath(format("GS_SW_jit_%08X.csv", m_jit_crc).c_str()), "w"))
+	{
+		fprintf(fp, "key,frames,ticks,pixels,visited,ticks_per_pixel,share\n");
+
+		for (const auto& i : m_jit_profile)
+		{
+			const GSFunctionStats& s = i.second;
+
+			fprintf(fp, "%016llx,%llu,%llu,%llu,%llu,%.2f,%.4f\n",
+				(unsigned long long)i.first, s.frames, s.ticks, s.actual, s.total,
+				s.actual ? (double)s.ticks / s.actual : 0.0, (double)s.ticks / ticks);
+		}
+
+		fclose(fp);
+	}
+
+	// Cost of each value of the selector fields, summed over the selectors using it
+
+	#define JIT_FEATURE(f) {#f, [](const GSScanlineSelector& sel) -> uint32 { return sel.f; }}
+
+	static const struct
+	{
+		const char* name;
+		uint32 (*get)(const GSScanlineSelector& sel);
+	} s_features[] =
+	{
+		JIT_FEATURE(fpsm), JIT_FEATURE(zpsm), JIT_FEATURE(ztst), JIT_FEATURE(atst),
+		JIT_FEATURE(afail), JIT_FEATURE(iip), JIT_FEATURE(tfx), JIT_FEATURE(tcc),
+		JIT_FEATURE(fst), JIT_FEATURE(ltf), JIT_FEATURE(tlu), JIT_FEATURE(fge),
+		JIT_FEATURE(date), JIT_FEATURE(abe), JIT_FEATURE(ababcd), JIT_FEATURE(pabe),
+		JIT_FEATURE(aa1), JIT_FEATURE(fwrite), JIT_FEATURE(ftest), JIT_FEATURE(rfb),
+		JIT_FEATURE(zwrite), JIT_FEATURE(ztest), JIT_FEATURE(zoverflow), JIT_FEATURE(zclamp),
+		JIT_FEATURE(wms), JIT_FEATURE(wmt), JIT_FEATURE(datm), JIT_FEATURE(colclamp),
+		JIT_FEATURE(fba), JIT_FEATURE(dthe), JIT_FEATURE(prim), JIT_FEATURE(edge),
+		JIT_FEATURE(tw), JIT_FEATURE(lcm), JIT_FEATURE(mmin), JIT_FEATURE(notest),
+	};
+
+	#undef JIT_FEATURE
+
+	struct FeatureCost
+	{
+		uint64 ticks, actual;
+		uint32 feature, value, selectors;
+
+		bool operator<(const FeatureCost& c) const { return ticks > c.ticks; }
+	};
+
+	std::vector<FeatureCost> costs;
+
+	for (uint32 feature = 0; feature < countof(s_features); feature++)
+	{
+		std::map<uint32, FeatureCost> values;
+
+		for (const auto& i : m_jit_profile)
+		{
+			uint32 value = s_features[feature].get(GSScanlineSelector(i.first));
+
+			FeatureCost& c = values.emplace(value, FeatureCost{0, 0, feature, value, 0}).first->second;
+
+			c.ticks += i.second.ticks;
+			c.actual += i.second.actual;
+			c.selectors++;
+		}
+
+		for (const auto& i : values)
+			costs.push_back(i.second);
+	}
+
+	std::stable_sort(costs.begin(), costs.end());
+
+	if (FILE* fp = px_fopen(theApp.GetCachePath(format("GS_SW_jit_%08X_features.csv", m_jit_crc).c_str()), "w"))
+	{
+		fprintf(fp, "feature,value,selectors,ticks,pixels,ticks_per_pixel,share\n");
+
+		for (const FeatureCost& c : costs)
+		{
+			fprintf(fp, "%s,%u,%u,%llu,%llu,%.2f,%.4f\n",
+				s_features[c.feature].name, c.value, c.selectors, c.ticks, c.actual,
+				c.actual ? (double)c.ticks / c.actual : 0.0, (double)c.ticks / ticks);
+		}
+
+		fclose(fp);
+	}
+}
+
+void GSRendererSW::VSync(int field, bool present)
 {
 	Sync(0); // IncAge might delete a cached texture in use
 
@@ -133,7 +445,7 @@ void GSRendererSW::VSync(int field)
 	//
 	*/
 
-	GSRenderer::VSync(field);
+	GSRenderer::VSync(field, present);
 
 	m_tc->IncAge();
 
@@ -440,6 +752,11 @@ void GSRendererSW::Draw()
 
 	sd->UsePages(fb_pages, m_context->offset.fb->psm, zb_pages, m_context->offset.zb->psm);
 
+	if (m_hiz)
+	{
+		UpdateHiZ(sd, fb_pages, zb_pages);
+	}
+
 	//
 
 	if (s_dump)
@@ -546,6 +863,8 @@ void GSRendererSW::Queue(std::shared_ptr<GSRasterizerData>& item)
 {
 	SharedData* sd = (SharedData*)item.get();
 
+	WaitPrewarm();
+
 	if (sd->m_syncpoint == SharedData::SyncSource)
 	{
 		Sync(4);
@@ -661,6 +980,11 @@ void GSRendererSW::InvalidateVideoMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 	}
 
 	m_tc->InvalidatePages(m_tmp_pages, off->psm); // if texture update runs on a thread and Sync(5) happens then this must come later
+
+	if (m_hiz)
+	{
+		InvalidateHiZ(m_tmp_pages);
+	}
 }
 
 void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GSVector4i& r, bool clut)
@@ -689,6 +1013,58 @@ void GSRendererSW::InvalidateLocalMem(const GIFRegBITBLTBUF& BITBLTBUF, const GS
 	}
 }
 
+void GSRendererSW::UpdateHiZ(SharedData* sd, const uint32* fb_pages, const uint32* zb_pages)
+{
+	const GSScanlineGlobalData& gd = sd->global;
+
+	if (zb_pages != NULL)
+	{
+		uint32 key = m_context->ZBUF.Block() | (m_context->ZBUF.PSM << 16) | (m_context->FRAME.FBW << 24);
+
+		if (key != m_hiz_key)
+		{
+			m_hiz_key = key;
+			m_hiz_epoch++;
+
+			memset(m_hiz_pages, 0, sizeof(m_hiz_pages));
+		}
+
+		for (const uint32* p = zb_pages; *p != GSOffset::EOP; p++)
+		{
+			m_hiz_pages[*p] = 1;
+		}
+	}
+
+	// Drawing into the z buffer as a frame buffer, its own depth test can't be trusted
+
+	bool aliased = fb_pages != NULL && gd.sel.fwrite && InvalidateHiZ(fb_pages);
+
+	sd->hiz.epoch = m_hiz_epoch;
+
+	if (zb_pages != NULL)
+	{
+		sd->hiz.key = m_hiz_key;
+		sd->hiz.zmax = 0xffffffff >> (gd.sel.zpsm * 8);
+		sd->hiz.ztst = gd.sel.ztest && !gd.sel.zoverflow && !aliased ? gd.sel.ztst : 0;
+		sd->hiz.zwrite = gd.sel.zwrite;
+	}
+}
+
+bool GSRendererSW::InvalidateHiZ(const uint32* pages)
+{
+	for (const uint32* p = pages; *p != GSOffset::EOP; p++)
+	{
+		if (m_hiz_pages[*p])
+		{
+			m_hiz_epoch++;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void GSRendererSW::UsePages(const uint32* pages, const int type)
 {
 	for (const uint32* p = pages; *p != GSOffset::EOP; p++)
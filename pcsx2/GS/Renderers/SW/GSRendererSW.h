@@ -78,8 +78,35 @@ protected:
 	std::atomic<uint16> m_tex_pages[512];
 	uint32 m_tmp_pages[512 + 1];
 
+	// JIT selectors of the game, generated ahead of the first draw
+	uint32 m_jit_crc;
+	std::set<uint64> m_jit_ds;
+	std::set<uint64> m_jit_sp;
+	std::thread m_jit_prewarm;
+
+	// Cost of the scanline selectors of the game, over every profiled run
+	bool m_jit_profiling;
+	std::map<uint64, GSFunctionStats> m_jit_profile;
+
+	// The pages of the z buffer the rasterizers keep HiZ tiles for, a write to
+	// them by anything else than a z write starts a new epoch
+	bool m_hiz;
+	uint32 m_hiz_key;
+	uint32 m_hiz_epoch;
+	uint8 m_hiz_pages[512];
+
+	void UpdateHiZ(SharedData* sd, const uint32* fb_pages, const uint32* zb_pages);
+	bool InvalidateHiZ(const uint32* pages);
+
+	void WaitPrewarm();
+	void LoadJITSelectors();
+	void SaveJITSelectors();
+	void LoadJITProfile();
+	void SaveJITProfile();
+
 	void Reset();
-	void VSync(int field);
+	void SetGameCRC(uint32 crc, int options);
+	void VSync(int field, bool present);
 	void ResetDevice();
 	GSTexture* GetOutput(int i, int& y_offset);
 	GSTexture* GetFeedbackOutput();
@@ -19,11 +19,29 @@
 GSTextureCacheSW::GSTextureCacheSW(GSState* state)
 	: m_state(state)
 {
+	const GSLocalMemory* mem = &state->m_mem;
+	const int threads = std::max(theApp.GetConfigI("texture_unswizzle_threads"), 0);
+
+	for (int i = 0; i < threads; i++)
+	{
+		m_decode_workers.push_back(std::unique_ptr<DecodeWorker>(new DecodeWorker(
+			[mem](DecodeJob& job) { ReadBlocks(*mem, job); })));
+	}
 }
 
 GSTextureCacheSW::~GSTextureCacheSW()
 {
 	RemoveAll();
+
+	m_decode_workers.clear();
+}
+
+void GSTextureCacheSW::ReadBlocks(const GSLocalMemory& mem, const DecodeJob& job)
+{
+	for (const DecodeBlock* RESTRICT b = job.begin; b < job.end; b++)
+	{
+		(mem.*job.rtxb)(b->bp, job.dst + b->offset, job.pitch, job.TEXA);
+	}
 }
 
 GSTextureCacheSW::Texture* GSTextureCacheSW::Lookup(const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA, uint32 tw0)
@@ -58,7 +76,7 @@ GSTextureCacheSW::Texture* GSTextureCacheSW::Lookup(const GIFRegTEX0& TEX0, cons
 	}
 
 	// Lookup miss
-	Texture* t = new Texture(m_state, tw0, TEX0, TEXA);
+	Texture* t = new Texture(this, m_state, tw0, TEX0, TEXA);
 
 	m_textures.insert(t);
 
@@ -141,8 +159,9 @@ void GSTextureCacheSW::IncAge()
 
 //
 
-GSTextureCacheSW::Texture::Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
-	: m_state(state)
+GSTextureCacheSW::Texture::Texture(GSTextureCacheSW* cache, GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA)
+	: m_cache(cache)
+	, m_state(state)
 	, m_buff(NULL)
 	, m_tw(tw0)
 	, m_age(0)
@@ -223,9 +242,14 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 
 	GSLocalMemory& mem = m_state->m_mem;
 
+	std::vector<DecodeBlock>& decode_blocks = m_cache->m_decode_blocks;
+	const auto& decode_workers = m_cache->m_decode_workers;
+
 	const GSOffset* RESTRICT off = m_offset;
 
-	uint32 blocks = 0;
+	uint8* buff = (uint8*)m_buff;
+
+	decode_blocks.clear();
 
 	GSLocalMemory::readTextureBlock rtxbP = psm.rtxbP;
 
@@ -259,9 +283,7 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					decode_blocks.push_back({block, (uint32)(&dst[x << shift] - buff)});
 				}
 			}
 		}
@@ -283,16 +305,53 @@ bool GSTextureCacheSW::Texture::Update(const GSVector4i& rect)
 				{
 					m_valid[row] |= col;
 
-					(mem.*rtxbP)(block, &dst[x << shift], pitch, m_TEXA);
-
-					blocks++;
+					decode_blocks.push_back({block, (uint32)(&dst[x << shift] - buff)});
 				}
 			}
 		}
 	}
 
+	uint32 blocks = (uint32)decode_blocks.size();
+
 	if (blocks > 0)
 	{
+		DecodeJob job;
+
+		job.rtxb = rtxbP;
+		job.begin = decode_blocks.data();
+		job.end = job.begin + blocks;
+		job.dst = buff;
+		job.pitch = pitch;
+		job.TEXA = m_TEXA;
+
+		// Small updates aren't worth the synchronization, the last part is decoded on this thread
+
+		const uint32 workers = (uint32)decode_workers.size();
+
+		const DecodeBlock* end = job.end;
+
+		if (workers > 0 && blocks >= 128)
+		{
+			const uint32 count = blocks / (workers + 1);
+
+			for (uint32 i = 0; i < workers; i++, job.begin += count)
+			{
+				job.end = job.begin + count;
+
+				decode_workers[i]->Push(job);
+			}
+
+			job.end = end;
+		}
+
+		ReadBlocks(mem, job);
+
+		if (workers > 0 && blocks >= 128)
+		{
+			for (auto& worker : decode_workers)
+				worker->Wait();
+		}
+
 		m_state->m_perfmon.Put(GSPerfMon::Unswizzle, bs.x * bs.y * blocks << shift);
 	}
 
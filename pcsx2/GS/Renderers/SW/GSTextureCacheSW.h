@@ -17,6 +17,7 @@
 
 #include "GS/Renderers/Common/GSRenderer.h"
 #include "GS/Renderers/Common/GSFastList.h"
+#include "GS/GSThread_CXX11.h"
 
 class GSTextureCacheSW
 {
@@ -24,6 +25,7 @@ public:
 	class Texture
 	{
 	public:
+		GSTextureCacheSW* m_cache;
 		GSState* m_state;
 		GSOffset* m_offset;
 		GIFRegTEX0 m_TEX0;
@@ -43,7 +45,7 @@ public:
 		// fast mode: each uint32 bits map to the 32 blocks of that page
 		// repeating mode: 1 bpp image of the texture tiles (8x8), also having 512 elements is just a coincidence (worst case: (1024*1024)/(8*8)/(sizeof(uint32)*8))
 
-		Texture(GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
+		Texture(GSTextureCacheSW* cache, GSState* state, uint32 tw0, const GIFRegTEX0& TEX0, const GIFRegTEXA& TEXA);
 		virtual ~Texture();
 
 		bool Update(const GSVector4i& r);
@@ -51,6 +53,30 @@ public:
 	};
 
 protected:
+	struct DecodeBlock
+	{
+		uint32 bp;
+		uint32 offset;
+	};
+
+	struct DecodeJob
+	{
+		GSLocalMemory::readTextureBlock rtxb;
+		const DecodeBlock* begin;
+		const DecodeBlock* end;
+		uint8* dst;
+		int pitch;
+		GIFRegTEXA TEXA;
+	};
+
+	using DecodeWorker = GSJobQueue<DecodeJob, 64>;
+
+	std::vector<std::unique_ptr<DecodeWorker>> m_decode_workers;
+	// Blocks of the texture being updated, shared by the updates to keep the allocation
+	std::vector<DecodeBlock> m_decode_blocks;
+
+	static void ReadBlocks(const GSLocalMemory& mem, const DecodeJob& job);
+
 	GSState* m_state;
 	std::unordered_set<Texture*> m_textures;
 	std::array<FastList<Texture*>, MAX_PAGES> m_map;
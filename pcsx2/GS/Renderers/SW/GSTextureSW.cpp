@@ -87,5 +87,5 @@ bool GSTextureSW::Save(const std::string& fn)
 	GSPng::Format fmt = GSPng::RGB_PNG;
 #endif
 	int compression = theApp.GetConfigI("png_compression_level");
-	return GSPng::Save(fmt, fn, static_cast<uint8*>(m_data), m_size.x, m_size.y, m_pitch, compression);
+	return GSPng::SaveAsync(fmt, fn, static_cast<uint8*>(m_data), m_size.x, m_size.y, m_pitch, compression);
 }
@@ -97,6 +97,7 @@ enum
 	IDR_TFX_VGS_GLSL,
 	IDR_TFX_FS_GLSL,
 	IDR_TFX_CL,
+	IDR_VRAM_UNSWIZZLE_GLSL,
 	// fonts
 	IDR_FONT_ROBOTO,
 };
@@ -90,6 +90,19 @@ public:
 	virtual void DetachContext() = 0;
 	virtual void* GetProcAddress(const char* name, bool opt = false) = 0;
 
+	// Extra context which shares its objects with the main one (i.e. to compile
+	// shaders on a worker thread). Return nullptr if unsupported.
+	virtual void* CreateSharedContext() { return nullptr; }
+	virtual bool AttachSharedContext(void* ctx) { return false; }
+	virtual void DetachSharedContext() {}
+	virtual void DestroySharedContext(void* ctx) {}
+
+	// Presentation on another thread: the window surface is made current with
+	// a shared context on the calling thread. The main context must release
+	// the surface first (DetachSurface), it keeps rendering in FBOs.
+	virtual bool AttachPresentContext(void* ctx) { return false; }
+	virtual bool DetachSurface() { return true; }
+
 	virtual void Show() = 0;
 	virtual void Hide() = 0;
 	virtual void HideFrame() = 0;
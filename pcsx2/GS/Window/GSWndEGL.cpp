@@ -60,7 +60,7 @@ int GSWndEGL::SelectPlatform()
 
 
 GSWndEGL::GSWndEGL(int platform)
-	: m_native_window(nullptr), m_platform(platform)
+	: m_native_window(nullptr), m_platform(platform), m_surface_detached(false)
 {
 }
 
@@ -94,6 +94,7 @@ void GSWndEGL::CreateContext(int major, int minor)
 	BindAPI();
 
 	eglChooseConfig(m_eglDisplay, attrList, &eglConfig, 1, &numConfigs);
+	m_eglConfig = eglConfig;
 	if (numConfigs == 0)
 	{
 		fprintf(stderr, "EGL: Failed to get a frame buffer config! (0x%x)\n", eglGetError());
@@ -108,6 +109,7 @@ void GSWndEGL::CreateContext(int major, int minor)
 	}
 
 	m_eglContext = eglCreateContext(m_eglDisplay, eglConfig, EGL_NO_CONTEXT, contextAttribs);
+	m_eglContextAttribs.assign(contextAttribs, contextAttribs + countof(contextAttribs));
 	EGLint status = eglGetError();
 	if (status == EGL_BAD_ATTRIBUTE || status == EGL_BAD_MATCH)
 	{
@@ -115,6 +117,7 @@ void GSWndEGL::CreateContext(int major, int minor)
 		// Note: Intel gives an EGL_BAD_MATCH. I don't know why but let's by stubborn and retry.
 		fprintf(stderr, "EGL: warning your driver doesn't support advance openGL context attributes\n");
 		m_eglContext = eglCreateContext(m_eglDisplay, eglConfig, EGL_NO_CONTEXT, NullContextAttribs);
+		m_eglContextAttribs.assign(NullContextAttribs, NullContextAttribs + countof(NullContextAttribs));
 		status = eglGetError();
 	}
 	if (m_eglContext == EGL_NO_CONTEXT)
@@ -139,7 +142,10 @@ void GSWndEGL::AttachContext()
 		BindAPI();
 
 		//fprintf(stderr, "Attach the context\n");
-		eglMakeCurrent(m_eglDisplay, m_eglSurface, m_eglSurface, m_eglContext);
+		if (m_surface_detached)
+			eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, m_eglContext);
+		else
+			eglMakeCurrent(m_eglDisplay, m_eglSurface, m_eglSurface, m_eglContext);
 		m_ctx_attached = true;
 	}
 }
@@ -154,6 +160,64 @@ void GSWndEGL::DetachContext()
 	}
 }
 
+void* GSWndEGL::CreateSharedContext()
+{
+	// The shared context doesn't have any surface
+	const char* extensions = eglQueryString(m_eglDisplay, EGL_EXTENSIONS);
+	if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context"))
+	{
+		fprintf(stderr, "EGL: surfaceless context isn't supported\n");
+		return nullptr;
+	}
+
+	EGLContext ctx = eglCreateContext(m_eglDisplay, m_eglConfig, m_eglContext, m_eglContextAttribs.data());
+	if (ctx == EGL_NO_CONTEXT)
+	{
+		fprintf(stderr, "EGL: Failed to create a shared context (0x%x)\n", eglGetError());
+		return nullptr;
+	}
+
+	return ctx;
+}
+
+bool GSWndEGL::AttachSharedContext(void* ctx)
+{
+	// API is bound per thread
+	BindAPI();
+
+	return eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)ctx);
+}
+
+void GSWndEGL::DetachSharedContext()
+{
+	eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void GSWndEGL::DestroySharedContext(void* ctx)
+{
+	eglDestroyContext(m_eglDisplay, (EGLContext)ctx);
+}
+
+bool GSWndEGL::AttachPresentContext(void* ctx)
+{
+	BindAPI();
+
+	return eglMakeCurrent(m_eglDisplay, m_eglSurface, m_eglSurface, (EGLContext)ctx);
+}
+
+bool GSWndEGL::DetachSurface()
+{
+	// A surface can only be current on a single thread
+	if (!eglMakeCurrent(m_eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, m_eglContext))
+	{
+		fprintf(stderr, "EGL: Failed to release the window surface (0x%x)\n", eglGetError());
+		return false;
+	}
+
+	m_surface_detached = true;
+	return true;
+}
+
 void GSWndEGL::PopulateWndGlFunction()
 {
 }
@@ -192,6 +256,7 @@ void GSWndEGL::Detach()
 
 	eglDestroySurface(m_eglDisplay, m_eglSurface);
 	m_eglSurface = nullptr;
+	m_surface_detached = false;
 
 	CloseEGLDisplay();
 
@@ -29,8 +29,11 @@ class GSWndEGL : public GSWndGL
 	EGLDisplay m_eglDisplay;
 	EGLSurface m_eglSurface;
 	EGLContext m_eglContext;
+	EGLConfig m_eglConfig;
+	std::vector<EGLint> m_eglContextAttribs;
 
 	int m_platform;
+	bool m_surface_detached; // the surface is current on the present thread
 
 	void PopulateWndGlFunction();
 	void CreateContext(int major, int minor);
@@ -62,6 +65,13 @@ public:
 	void DetachContext() final;
 	void* GetProcAddress(const char* name, bool opt = false) final;
 
+	void* CreateSharedContext() final;
+	bool AttachSharedContext(void* ctx) final;
+	void DetachSharedContext() final;
+	void DestroySharedContext(void* ctx) final;
+	bool AttachPresentContext(void* ctx) final;
+	bool DetachSurface() final;
+
 	void Flip() final;
 
 	// Deprecated API
@@ -118,9 +118,44 @@ void GSWndWGL::CreateContext(int major, int minor)
 		win_error(L"Failed to create a 3.x context with compatible flags");
 
 	m_context = context30;
+	m_context_attribs.assign(context_attribs, context_attribs + countof(context_attribs));
 	fprintf(stdout, "3.x GL context successfully created\n");
 }
 
+void* GSWndWGL::CreateSharedContext()
+{
+	PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB = (PFNWGLCREATECONTEXTATTRIBSARBPROC)wglGetProcAddress("wglCreateContextAttribsARB");
+	if (!wglCreateContextAttribsARB)
+		return nullptr;
+
+	HGLRC ctx = wglCreateContextAttribsARB(m_NativeDisplay, m_context, m_context_attribs.data());
+	if (!ctx)
+		fprintf(stderr, "Failed to create a shared GL context\n");
+
+	return ctx;
+}
+
+bool GSWndWGL::AttachSharedContext(void* ctx)
+{
+	return wglMakeCurrent(m_NativeDisplay, (HGLRC)ctx);
+}
+
+void GSWndWGL::DetachSharedContext()
+{
+	wglMakeCurrent(NULL, NULL);
+}
+
+void GSWndWGL::DestroySharedContext(void* ctx)
+{
+	wglDeleteContext((HGLRC)ctx);
+}
+
+bool GSWndWGL::AttachPresentContext(void* ctx)
+{
+	// A device context can be current on several threads, nothing to release
+	return wglMakeCurrent(m_NativeDisplay, (HGLRC)ctx);
+}
+
 void GSWndWGL::AttachContext()
 {
 	if (!IsContextAttached())
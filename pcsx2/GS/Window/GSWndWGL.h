@@ -22,6 +22,7 @@ class GSWndWGL : public GSWndGL
 	HWND  m_NativeWindow;
 	HDC   m_NativeDisplay;
 	HGLRC m_context;
+	std::vector<int> m_context_attribs;
 	bool  m_has_late_vsync;
 
 	PFNWGLSWAPINTERVALEXTPROC m_swapinterval;
@@ -54,6 +55,12 @@ public:
 	void DetachContext();
 	void* GetProcAddress(const char* name, bool opt);
 
+	void* CreateSharedContext();
+	bool AttachSharedContext(void* ctx);
+	void DetachSharedContext();
+	void DestroySharedContext(void* ctx);
+	bool AttachPresentContext(void* ctx);
+
 	void Show();
 	void Hide();
 	void HideFrame();
@@ -9,6 +9,11 @@ in SHADER
 
 #ifdef FRAGMENT_SHADER
 
+#ifndef PS_SHADEBOOST
+#define PS_SHADEBOOST 0
+#define PS_LUMA 0
+#endif
+
 layout(std140, binding = 11) uniform cb11
 {
     vec2 ZrH;
@@ -17,6 +22,55 @@ layout(std140, binding = 11) uniform cb11
 
 layout(location = 0) out vec4 SV_Target0;
 
+#if PS_SHADEBOOST
+/*
+** Contrast, saturation, brightness
+** Code of this function is from TGM's shader pack
+** http://irrlicht.sourceforge.net/phpBB2/viewtopic.php?t=21057
+** TGM's author comment about the license (included in the previous link)
+** "do with it, what you want! its total free!
+** (but would be nice, if you say that you used my shaders  :wink: ) but not necessary"
+*/
+
+// For all settings: 1.0 = 100% 0.5=50% 1.5 = 150%
+vec4 ContrastSaturationBrightness(vec4 color)
+{
+    const float sat = SB_SATURATION / 50.0;
+    const float brt = SB_BRIGHTNESS / 50.0;
+    const float con = SB_CONTRAST / 50.0;
+
+    // Increase or decrease these values to adjust r, g and b color channels separately
+    const float AvgLumR = 0.5;
+    const float AvgLumG = 0.5;
+    const float AvgLumB = 0.5;
+
+    const vec3 LumCoeff = vec3(0.2125, 0.7154, 0.0721);
+
+    vec3 AvgLumin = vec3(AvgLumR, AvgLumG, AvgLumB);
+    vec3 brtColor = color.rgb * brt;
+    float dot_intensity = dot(brtColor, LumCoeff);
+    vec3 intensity = vec3(dot_intensity, dot_intensity, dot_intensity);
+    vec3 satColor = mix(intensity, brtColor, sat);
+    vec3 conColor = mix(AvgLumin, satColor, con);
+
+    color.rgb = conColor;
+    return color;
+}
+#endif
+
+// The output stages that follow the deinterlacing in the same pass
+vec4 ps_output(vec4 c)
+{
+#if PS_SHADEBOOST
+    c = ContrastSaturationBrightness(c);
+#endif
+#if PS_LUMA
+    // FXAA and the external shader read the luma in alpha
+    c.a = dot(c.rgb, vec3(0.299, 0.587, 0.114));
+#endif
+    return c;
+}
+
 // TODO ensure that clip (discard) is < 0 and not <= 0 ???
 void ps_main0()
 {
@@ -26,7 +80,7 @@ void ps_main0()
     // see: http://www.opengl.org/wiki/GLSL_Sampler#Non-uniform_flow_control
     vec4 c = texture(TextureSampler, PSin.t);
 
-    SV_Target0 = c;
+    SV_Target0 = ps_output(c);
 }
 
 void ps_main1()
@@ -37,7 +91,7 @@ void ps_main1()
     // see: http://www.opengl.org/wiki/GLSL_Sampler#Non-uniform_flow_control
     vec4 c = texture(TextureSampler, PSin.t);
 
-    SV_Target0 = c;
+    SV_Target0 = ps_output(c);
 }
 
 void ps_main2()
@@ -46,12 +100,12 @@ void ps_main2()
     vec4 c1 = texture(TextureSampler, PSin.t);
     vec4 c2 = texture(TextureSampler, PSin.t + ZrH);
 
-    SV_Target0 = (c0 + c1 * 2.0f + c2) / 4.0f;
+    SV_Target0 = ps_output((c0 + c1 * 2.0f + c2) / 4.0f);
 }
 
 void ps_main3()
 {
-    SV_Target0 = texture(TextureSampler, PSin.t);
+    SV_Target0 = ps_output(texture(TextureSampler, PSin.t));
 }
 
 #endif
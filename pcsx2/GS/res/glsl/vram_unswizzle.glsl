@@ -0,0 +1,113 @@
+//#version 430 // Keep it for editor detection
+
+// Builds a texture source from the GPU copy of the GS local memory. This is
+// the GLSL equivalent of GSLocalMemory::ReadTexture*: block/column swizzle
+// and optionally the CLUT lookup.
+
+#ifdef COMPUTE_SHADER
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(std140, binding = 23) uniform cb23
+{
+    ivec4 Rect;      // destination rect (texels)
+    uvec4 Layout;    // bp, page count by row, bits per pixel, address shift of a block
+    uvec4 Geometry;  // page width/height shift, block width/height shift
+    uvec4 Tables;    // block table offset, column table offset, value shift, value mask
+    uvec4 Alpha;     // TA0, TA1, AEM, output mode
+};
+
+layout(std430, binding = 0) readonly buffer VRAM
+{
+    uint vm[];
+};
+
+// Block and column tables of the format followed by the 256 entries CLUT
+#define CLUT_OFFSET 544u
+
+layout(std430, binding = 1) readonly buffer LUT
+{
+    uint lut[];
+};
+
+#if PS_INDEX
+layout(binding = 3, r8) uniform writeonly image2D img;
+#else
+layout(binding = 3, rgba8) uniform writeonly image2D img;
+#endif
+
+uint fetch(uint x, uint y)
+{
+    uint pw = Geometry.x;
+    uint ph = Geometry.y;
+    uint bws = Geometry.z;
+    uint bhs = Geometry.w;
+
+    uint page = (y >> ph) * Layout.y + (x >> pw);
+    uint bx = (x >> bws) & ((1u << (pw - bws)) - 1u);
+    uint by = (y >> bhs) & ((1u << (ph - bhs)) - 1u);
+
+    uint block = Layout.x + page * 32u + lut[Tables.x + (by << (pw - bws)) + bx];
+    uint col = lut[Tables.y + ((y & ((1u << bhs) - 1u)) << bws) + (x & ((1u << bws) - 1u))];
+
+    uint addr = ((block & 0x3fffu) << Layout.w) + col;
+
+    uint v;
+    if (Layout.z == 32u)
+        v = vm[addr];
+    else if (Layout.z == 16u)
+        v = vm[addr >> 1] >> ((addr & 1u) << 4);
+    else if (Layout.z == 8u)
+        v = vm[addr >> 2] >> ((addr & 3u) << 3);
+    else
+        v = vm[addr >> 3] >> ((addr & 7u) << 2);
+
+    return (v >> Tables.z) & Tables.w;
+}
+
+vec4 unpack(uint c)
+{
+    return vec4(uvec4(c, c >> 8, c >> 16, c >> 24) & 0xffu) / 255.0f;
+}
+
+void cs_main()
+{
+    ivec2 p = Rect.xy + ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(p, Rect.zw)))
+        return;
+
+    uint v = fetch(uint(p.x), uint(p.y));
+
+#if PS_INDEX
+    imageStore(img, p, vec4(float(v) / 255.0f));
+#else
+    uint c;
+    if (Alpha.w == 1u)
+    {
+        // CLUT (already expanded to 32 bits on the CPU)
+        c = lut[CLUT_OFFSET + v];
+    }
+    else if (Alpha.w == 2u)
+    {
+        // PSMCT24
+        c = v & 0xffffffu;
+        c |= (Alpha.z != 0u && c == 0u) ? 0u : (Alpha.x << 24);
+    }
+    else if (Alpha.w == 3u)
+    {
+        // PSMCT16/PSMCT16S
+        c = ((v & 0x1fu) << 3) | ((v & 0x3e0u) << 6) | ((v & 0x7c00u) << 9);
+        if (Alpha.z == 0u || v != 0u)
+            c |= (((v & 0x8000u) != 0u) ? Alpha.y : Alpha.x) << 24;
+    }
+    else
+    {
+        c = v;
+    }
+
+    imageStore(img, p, unpack(c));
+#endif
+}
+
+#endif
@@ -1,5 +1,10 @@
 #ifdef SHADER_MODEL // make safe to include in resource file to enforce dependency
 
+#ifndef PS_SHADEBOOST
+#define PS_SHADEBOOST 0
+#define PS_LUMA 0
+#endif
+
 Texture2D Texture;
 SamplerState Sampler;
 
@@ -15,18 +20,63 @@ struct PS_INPUT
 	float2 t : TEXCOORD0;
 };
 
+#if PS_SHADEBOOST
+/*
+** Contrast, saturation, brightness
+** Code of this function is from TGM's shader pack
+** http://irrlicht.sourceforge.net/phpBB2/viewtopic.php?t=21057
+*/
+
+// For all settings: 1.0 = 100% 0.5=50% 1.5 = 150% 
+float4 ContrastSaturationBrightness(float4 color) // Ported to HLSL
+{
+	const float sat = SB_SATURATION / 50.0;
+	const float brt = SB_BRIGHTNESS / 50.0;
+	const float con = SB_CONTRAST / 50.0;
+	
+	// Increase or decrease these values to adjust r, g and b color channels separately
+	const float AvgLumR = 0.5;
+	const float AvgLumG = 0.5;
+	const float AvgLumB = 0.5;
+	
+	const float3 LumCoeff = float3(0.2125, 0.7154, 0.0721);
+	
+	float3 AvgLumin = float3(AvgLumR, AvgLumG, AvgLumB);
+	float3 brtColor = color.rgb * brt;
+	float3 intensity = dot(brtColor, LumCoeff);
+	float3 satColor = lerp(intensity, brtColor, sat);
+	float3 conColor = lerp(AvgLumin, satColor, con);
+
+	color.rgb = conColor;	
+	return color;
+}
+#endif
+
+// The output stages that follow the deinterlacing in the same pass
+float4 ps_output(float4 c)
+{
+#if PS_SHADEBOOST
+	c = ContrastSaturationBrightness(c);
+#endif
+#if PS_LUMA
+	// FXAA and the external shader read the luma in alpha
+	c.a = dot(c.rgb, float3(0.299, 0.587, 0.114));
+#endif
+	return c;
+}
+
 float4 ps_main0(PS_INPUT input) : SV_Target0
 {
 	clip(frac(input.t.y * hH) - 0.5);
 
-	return Texture.Sample(Sampler, input.t);
+	return ps_output(Texture.Sample(Sampler, input.t));
 }
 
 float4 ps_main1(PS_INPUT input) : SV_Target0
 {
 	clip(0.5 - frac(input.t.y * hH));
 
-	return Texture.Sample(Sampler, input.t);
+	return ps_output(Texture.Sample(Sampler, input.t));
 }
 
 float4 ps_main2(PS_INPUT input) : SV_Target0
@@ -35,11 +85,11 @@ float4 ps_main2(PS_INPUT input) : SV_Target0
 	float4 c1 = Texture.Sample(Sampler, input.t);
 	float4 c2 = Texture.Sample(Sampler, input.t + ZrH);
 
-	return (c0 + c1 * 2 + c2) / 4;
+	return ps_output((c0 + c1 * 2 + c2) / 4);
 }
 
 float4 ps_main3(PS_INPUT input) : SV_Target0
 {
-	return Texture.Sample(Sampler, input.t);
+	return ps_output(Texture.Sample(Sampler, input.t));
 }
 #endif
@@ -145,25 +145,24 @@
 #define IDR_INTERLACE_FX                10003
 #define IDR_FXAA_FX                     10004
 #define IDD_SHADER                      10006
-#define IDR_SHADEBOOST_FX               10007
 #define IDR_TFX_CL                      10008
 #define IDD_HACKS                       10009
 #define IDD_OSD                         10010
 #define IDR_CONVERT_GLSL                10011
 #define IDR_INTERLACE_GLSL              10012
 #define IDR_MERGE_GLSL                  10013
-#define IDR_SHADEBOOST_GLSL             10014
 #define IDR_COMMON_GLSL                 10015
 #define IDR_TFX_VGS_GLSL                10016
 #define IDR_TFX_FS_GLSL                 10017
 #define IDR_FONT_ROBOTO                 10018
+#define IDR_VRAM_UNSWIZZLE_GLSL         10019
 #define IDC_STATIC                      -1
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        10019
+#define _APS_NEXT_RESOURCE_VALUE        10020
 #define _APS_NEXT_COMMAND_VALUE         32771
 #define _APS_NEXT_CONTROL_VALUE         2194
 #define _APS_NEXT_SYMED_VALUE           5000
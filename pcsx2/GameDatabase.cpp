@@ -22,6 +22,8 @@
 #include "yaml-cpp/yaml.h"
 #include <fstream>
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 
 std::string strToLower(std::string str)
 {
@@ -186,6 +188,34 @@ GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::findGame(const std::string s
 {
 	std::string serialLower = strToLower(serial);
 	Console.WriteLn(fmt::format("[GameDB] Searching for '{}' in GameDB", serialLower));
+	if (!cache.empty())
+	{
+		const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(cache.data());
+		const CacheIndex* begin = reinterpret_cast<const CacheIndex*>(cache.data() + header.index);
+		const CacheIndex* end = begin + header.count;
+		const CacheIndex* found = std::lower_bound(begin, end, serialLower, [this](const CacheIndex& index, const std::string& key) {
+			return std::strcmp(cacheString(index.serial), key.c_str()) < 0;
+		});
+
+		GameDatabaseSchema::GameEntry entry;
+		if (found != end && serialLower == cacheString(found->serial))
+		{
+			if (entryFromCache(found->entry, entry))
+			{
+				Console.WriteLn(fmt::format("[GameDB] Found '{}' in GameDB", serialLower));
+				return entry;
+			}
+			Console.Error(fmt::format("[GameDB] Cached entry for '{}' is damaged", serialLower));
+		}
+		else
+		{
+			Console.Error(fmt::format("[GameDB] Could not find '{}' in GameDB", serialLower));
+		}
+		entry = GameDatabaseSchema::GameEntry();
+		entry.isValid = false;
+		return entry;
+	}
+
 	if (gameDb.count(serialLower) == 1)
 	{
 		Console.WriteLn(fmt::format("[GameDB] Found '{}' in GameDB", serialLower));
@@ -200,21 +230,29 @@ GameDatabaseSchema::GameEntry YamlGameDatabaseImpl::findGame(const std::string s
 
 int YamlGameDatabaseImpl::numGames()
 {
+	if (!cache.empty())
+		return reinterpret_cast<const CacheHeader*>(cache.data())->count;
 	return gameDb.size();
 }
 
 bool YamlGameDatabaseImpl::initDatabase(std::ifstream& stream)
 {
+	if (!stream)
+	{
+		Console.Error("[GameDB] Unable to open GameDB file.");
+		return false;
+	}
+	return initDatabase(std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+}
+
+bool YamlGameDatabaseImpl::initDatabase(const std::string& yaml)
+{
+	cache.clear();
 	try
 	{
-		if (!stream)
-		{
-			Console.Error("[GameDB] Unable to open GameDB file.");
-			return false;
-		}
 		// yaml-cpp has memory leak issues if you persist and modify a YAML::Node
 		// convert to a map and throw it away instead!
-		YAML::Node data = YAML::Load(stream);
+		YAML::Node data = YAML::Load(yaml);
 		for (const auto& entry : data)
 		{
 			// we don't want to throw away the entire GameDB file if a single entry is made incorrectly,
@@ -247,3 +285,202 @@ bool YamlGameDatabaseImpl::initDatabase(std::ifstream& stream)
 
 	return true;
 }
+
+// --------------------------------------------------------------------------------------
+//  Binary cache
+// --------------------------------------------------------------------------------------
+// Layout: the header, the index sorted by serial, the entries as u32 words, and the string
+// table. Strings are referenced by their offset into the string table and deduplicated.
+// An entry is made of name, region, compat, the round and clamp modes, then the counted
+// lists of game fixes, speed hacks (name, value), memcard filters and patches (crc, author,
+// counted lines).
+
+static const u32 CacheMagic = 0x43424447; // GDBC
+static const u32 CacheVersion = 1;
+
+u64 YamlGameDatabaseImpl::hashYaml(const std::string& yaml)
+{
+	// The gamefix and speedhack lists decide which of the yaml's entries are dropped, so
+	// a build with different lists doesn't reuse the cache either.
+	u64 hash = 14695981039346656037ull ^ (CacheVersion | (GamefixId_COUNT << 8) | (SpeedhackId_COUNT << 16));
+	for (const char c : yaml)
+		hash = (hash ^ static_cast<u8>(c)) * 1099511628211ull;
+	return hash;
+}
+
+const char* YamlGameDatabaseImpl::cacheString(u32 offset) const
+{
+	const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(cache.data());
+	// The string table ends in a terminator, checked when the cache was loaded
+	if (offset >= header.stringsSize)
+		return "";
+	return reinterpret_cast<const char*>(cache.data() + header.strings + offset);
+}
+
+bool YamlGameDatabaseImpl::entryFromCache(u32 offset, GameDatabaseSchema::GameEntry& entry) const
+{
+	const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(cache.data());
+	const u32* pos = reinterpret_cast<const u32*>(cache.data() + offset);
+	const u32* end = reinterpret_cast<const u32*>(cache.data() + header.strings);
+	bool ok = true;
+	auto read = [&]() -> u32 {
+		if (pos >= end)
+		{
+			ok = false;
+			return 0;
+		}
+		return *pos++;
+	};
+	// Counts can't be larger than what's left of the entries
+	auto readCount = [&]() -> u32 {
+		const u32 count = read();
+		if (count > static_cast<u32>(end - pos))
+		{
+			ok = false;
+			return 0;
+		}
+		return count;
+	};
+
+	entry.name = cacheString(read());
+	entry.region = cacheString(read());
+	entry.compat = static_cast<GameDatabaseSchema::Compatibility>(static_cast<s32>(read()));
+	entry.eeRoundMode = static_cast<GameDatabaseSchema::RoundMode>(static_cast<s32>(read()));
+	entry.vuRoundMode = static_cast<GameDatabaseSchema::RoundMode>(static_cast<s32>(read()));
+	entry.eeClampMode = static_cast<GameDatabaseSchema::ClampMode>(static_cast<s32>(read()));
+	entry.vuClampMode = static_cast<GameDatabaseSchema::ClampMode>(static_cast<s32>(read()));
+	entry.isValid = read() != 0;
+
+	for (u32 i = readCount(); i > 0; i--)
+		entry.gameFixes.push_back(cacheString(read()));
+	for (u32 i = readCount(); i > 0; i--)
+	{
+		const char* speedHack = cacheString(read());
+		entry.speedHacks[speedHack] = static_cast<s32>(read());
+	}
+	for (u32 i = readCount(); i > 0; i--)
+		entry.memcardFilters.push_back(cacheString(read()));
+	for (u32 i = readCount(); i > 0; i--)
+	{
+		GameDatabaseSchema::Patch& patch = entry.patches[cacheString(read())];
+		patch.author = cacheString(read());
+		for (u32 line = readCount(); line > 0; line--)
+			patch.patchLines.push_back(cacheString(read()));
+	}
+	return ok;
+}
+
+bool YamlGameDatabaseImpl::initDatabaseFromCache(std::ifstream& stream, u64 yamlHash)
+{
+	cache.clear();
+	if (!stream)
+		return false;
+
+	CacheHeader header;
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CacheMagic ||
+		header.version != CacheVersion || header.hash != yamlHash)
+		return false;
+
+	stream.seekg(0, std::ios::end);
+	const u64 size = stream.tellg();
+	// Everything has to add up to the file, which also catches caches cut short while being written
+	if (header.index != sizeof(CacheHeader) || header.strings < header.index + u64(header.count) * sizeof(CacheIndex) ||
+		(header.strings % sizeof(u32)) != 0 || header.stringsSize == 0 || u64(header.strings) + header.stringsSize != size)
+		return false;
+
+	std::vector<u8> data(size);
+	stream.seekg(0);
+	if (!stream.read(reinterpret_cast<char*>(data.data()), size) || data.back() != '\0')
+		return false;
+
+	const CacheIndex* index = reinterpret_cast<const CacheIndex*>(data.data() + header.index);
+	for (u32 i = 0; i < header.count; i++)
+	{
+		if (index[i].entry < header.index + header.count * sizeof(CacheIndex) || index[i].entry >= header.strings ||
+			(index[i].entry % sizeof(u32)) != 0)
+			return false;
+	}
+
+	cache = std::move(data);
+	gameDb.clear();
+	return true;
+}
+
+bool YamlGameDatabaseImpl::saveCache(std::ostream& stream, u64 yamlHash) const
+{
+	if (!stream || gameDb.empty())
+		return false;
+
+	std::string strings;
+	std::unordered_map<std::string, u32> stringOffsets;
+	auto addString = [&](const std::string& str) -> u32 {
+		const auto it = stringOffsets.find(str);
+		if (it != stringOffsets.end())
+			return it->second;
+		const u32 offset = strings.size();
+		strings.append(str.c_str(), str.size() + 1);
+		stringOffsets.emplace(str, offset);
+		return offset;
+	};
+
+	std::vector<std::string> serials;
+	serials.reserve(gameDb.size());
+	for (const auto& entry : gameDb)
+		serials.push_back(entry.first);
+	std::sort(serials.begin(), serials.end());
+
+	std::vector<CacheIndex> index;
+	std::vector<u32> entries;
+	const u32 entriesStart = sizeof(CacheHeader) + serials.size() * sizeof(CacheIndex);
+	for (const std::string& serial : serials)
+	{
+		const GameDatabaseSchema::GameEntry& entry = gameDb.at(serial);
+		index.push_back({addString(serial), static_cast<u32>(entriesStart + entries.size() * sizeof(u32))});
+
+		entries.push_back(addString(entry.name));
+		entries.push_back(addString(entry.region));
+		entries.push_back(enum_cast(entry.compat));
+		entries.push_back(enum_cast(entry.eeRoundMode));
+		entries.push_back(enum_cast(entry.vuRoundMode));
+		entries.push_back(enum_cast(entry.eeClampMode));
+		entries.push_back(enum_cast(entry.vuClampMode));
+		entries.push_back(entry.isValid);
+
+		entries.push_back(entry.gameFixes.size());
+		for (const std::string& fix : entry.gameFixes)
+			entries.push_back(addString(fix));
+		entries.push_back(entry.speedHacks.size());
+		for (const auto& speedHack : entry.speedHacks)
+		{
+			entries.push_back(addString(speedHack.first));
+			entries.push_back(speedHack.second);
+		}
+		entries.push_back(entry.memcardFilters.size());
+		for (const std::string& filter : entry.memcardFilters)
+			entries.push_back(addString(filter));
+		entries.push_back(entry.patches.size());
+		for (const auto& patch : entry.patches)
+		{
+			entries.push_back(addString(patch.first));
+			entries.push_back(addString(patch.second.author));
+			entries.push_back(patch.second.patchLines.size());
+			for (const std::string& line : patch.second.patchLines)
+				entries.push_back(addString(line));
+		}
+	}
+
+	CacheHeader header;
+	header.magic = CacheMagic;
+	header.version = CacheVersion;
+	header.hash = yamlHash;
+	header.count = serials.size();
+	header.index = sizeof(CacheHeader);
+	header.strings = entriesStart + entries.size() * sizeof(u32);
+	header.stringsSize = strings.size();
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(CacheIndex));
+	stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(u32));
+	stream.write(strings.data(), strings.size());
+	return static_cast<bool>(stream);
+}
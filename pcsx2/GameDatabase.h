@@ -98,9 +98,37 @@ public:
 	GameDatabaseSchema::GameEntry findGame(const std::string serial) override;
 	int numGames() override;
 
+	bool initDatabase(const std::string& yaml);
+	// The binary cache is a serial sorted index over a string table, which is looked up with a
+	// binary search instead of parsing the yaml. It's only used when it was built from a yaml
+	// file with the same hash (see hashYaml), otherwise initDatabaseFromCache returns false.
+	bool initDatabaseFromCache(std::ifstream& stream, u64 yamlHash);
+	bool saveCache(std::ostream& stream, u64 yamlHash) const;
+	static u64 hashYaml(const std::string& yaml);
+
 private:
+	struct CacheHeader
+	{
+		u32 magic;
+		u32 version;
+		u64 hash;
+		u32 count;
+		u32 index;
+		u32 strings;
+		u32 stringsSize;
+	};
+
+	struct CacheIndex
+	{
+		u32 serial;
+		u32 entry;
+	};
+
 	std::unordered_map<std::string, GameDatabaseSchema::GameEntry> gameDb;
+	std::vector<u8> cache;
 	GameDatabaseSchema::GameEntry entryFromYaml(const std::string serial, const YAML::Node& node);
+	bool entryFromCache(u32 offset, GameDatabaseSchema::GameEntry& entry) const;
+	const char* cacheString(u32 offset) const;
 
 	std::vector<std::string> convertMultiLineStringToVector(const std::string multiLineString);
 };
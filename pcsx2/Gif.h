@@ -17,6 +17,7 @@
 
 #define COPY_GS_PACKET_TO_MTGS 0
 #define PRINT_GIF_PACKET 0
+#define COALESCE_GS_PACKET_SIZE 0x10000 // Max bytes of contiguous GS packets merged into one MTGS command (0 = off)
 
 //#define GUNIT_LOG DevCon.WriteLn
 #define GUNIT_LOG(...) do {} while(0)
@@ -202,6 +202,8 @@ void Gif_FinishIRQ()
 // Used in MTVU mode... MTVU will later complete a real packet
 void Gif_AddGSPacketMTVU(GS_Packet& gsPack, GIF_PATH path)
 {
+	Gif_FlushCoalescedGSPacket();
+	gifUnit.coalesce.packetsOut.fetch_add(1, std::memory_order_relaxed);
 	GetMTGS().SendSimpleGSPacket(GS_RINGTYPE_MTVU_GSPACKET, 0, 0, path);
 }
 
@@ -219,19 +221,49 @@ void Gif_AddCompletedGSPacket(GS_Packet& gsPack, GIF_PATH path)
 	{
 		pxAssertDev(!gsPack.readAmount, "Gif Unit - gsPack.readAmount only valid for MTVU path 1!");
 		gifUnit.gifPath[path].readAmount.fetch_add(gsPack.size);
-		GetMTGS().SendSimpleGSPacket(GS_RINGTYPE_GSPACKET, gsPack.offset, gsPack.size, path);
+		gifUnit.coalesce.packetsIn.fetch_add(1, std::memory_order_relaxed);
+
+		// The packet data stays in the path buffer until the MTGS reads it, so a packet
+		// starting where the held back one ends can be sent along with it
+		GS_Packet& pend = gifUnit.coalesce.pack;
+		if (pend.size && (gifUnit.coalesce.path != path || pend.offset + pend.size != gsPack.offset ||
+						  pend.size + gsPack.size > COALESCE_GS_PACKET_SIZE))
+			Gif_FlushCoalescedGSPacket();
+		if (!pend.size)
+		{
+			pend.offset = gsPack.offset;
+			gifUnit.coalesce.path = path;
+		}
+		pend.size += gsPack.size;
+		if (!COALESCE_GS_PACKET_SIZE)
+			Gif_FlushCoalescedGSPacket();
 	}
 }
 
+// Sends the held back GS packets, needs to be done before anything else
+// is sent to the MTGS or waits on it
+void Gif_FlushCoalescedGSPacket()
+{
+	GS_Packet& pend = gifUnit.coalesce.pack;
+	if (!pend.size)
+		return;
+	gifUnit.coalesce.packetsOut.fetch_add(1, std::memory_order_relaxed);
+	GetMTGS().SendSimpleGSPacket(GS_RINGTYPE_GSPACKET, pend.offset, pend.size, gifUnit.coalesce.path);
+	pend.size = 0;
+}
+
 void Gif_AddBlankGSPacket(u32 size, GIF_PATH path)
 {
 	//DevCon.WriteLn("Adding Blank Gif Packet [size=%x]", size);
+	Gif_FlushCoalescedGSPacket();
 	gifUnit.gifPath[path].readAmount.fetch_add(size);
 	GetMTGS().SendSimpleGSPacket(GS_RINGTYPE_GSPACKET, ~0u, size, path);
 }
 
 void Gif_MTGS_Wait(bool isMTVU)
 {
+	if (!isMTVU) // The MTVU thread never holds back packets
+		Gif_FlushCoalescedGSPacket();
 	GetMTGS().WaitGS(false, true, isMTVU);
 }
 
@@ -32,6 +32,7 @@ extern bool Gif_HandlerAD_Debug(u8* pMem);
 extern void Gif_AddBlankGSPacket(u32 size, GIF_PATH path);
 extern void Gif_AddGSPacketMTVU(GS_Packet& gsPack, GIF_PATH path);
 extern void Gif_AddCompletedGSPacket(GS_Packet& gsPack, GIF_PATH path);
+extern void Gif_FlushCoalescedGSPacket();
 extern void Gif_ParsePacket(u8* data, u32 size, GIF_PATH path);
 extern void Gif_ParsePacket(GS_Packet& gsPack, GIF_PATH path);
 
@@ -170,14 +171,30 @@ static __fi void incTag(u32& offset, u32& size, u32 incAmount)
 	offset += incAmount;
 }
 
+// Completed GS packets held back on the EE thread, so that contiguous packets
+// of the same path are sent to the MTGS as a single ring command
+struct Gif_Coalesce
+{
+	GS_Packet pack;              // Merged packets not sent yet
+	GIF_PATH path;               // Path of the merged packets
+	std::atomic<u32> packetsIn;  // GS packets completed by the gif unit
+	std::atomic<u32> packetsOut; // GS packet commands sent to the MTGS
+	Gif_Coalesce() { Reset(); }
+	void Reset()
+	{
+		pack.Reset();
+		path = GIF_PATH_1;
+	}
+};
+
 struct Gif_Path_MTVU
 {
 	u32 fakePackets; // Fake packets pending to be sent to MTGS
 	GS_Packet fakePacket;
-	// Set a size based on MTGS but keep a factor 2 to avoid too waste to much
-	// memory overhead. Note the struct is instantied 3 times (for each gif
-	// path)
-	ringbuffer_base<GS_Packet, RingBufferSize / 2> gsPackQueue;
+	// Set a size based on the default MTGS ring but keep a factor 2 to avoid
+	// too waste to much memory overhead. Note the struct is instantied 3 times
+	// (for each gif path). A larger ring only makes the EE wait here instead.
+	ringbuffer_base<GS_Packet, (1 << RingBufferSizeFactorDefault) / 2> gsPackQueue;
 	Gif_Path_MTVU() { Reset(); }
 	void Reset()
 	{
@@ -496,6 +513,7 @@ struct Gif_Unit
 	Gif_Path gifPath[3];
 	GS_SIGNAL gsSIGNAL; // Stalling Signal
 	GS_FINISH gsFINISH; // Finish Signal
+	Gif_Coalesce coalesce;
 	tGIF_STAT& stat;
 	GIF_TRANSFER_TYPE lastTranType; // Last Transfer Type
 
@@ -517,6 +535,7 @@ struct Gif_Unit
 		ResetRegs();
 		gsSIGNAL.Reset();
 		gsFINISH.Reset();
+		coalesce.Reset();
 		gifPath[0].Reset(softReset);
 		gifPath[1].Reset(softReset);
 		gifPath[2].Reset(softReset);
@@ -585,6 +604,7 @@ struct Gif_Unit
 			{ // This is on the MTVU thread
 				path1.CopyGSPacketData(pMem, size, aligned);
 				path1.ExecuteGSPacketMTVU();
+				coalesce.packetsIn.fetch_add(1, std::memory_order_relaxed); // Merged per vu1 program
 				return size;
 			}
 			if (tranType == GIF_TRANS_MTVU)
@@ -688,6 +708,7 @@ struct Gif_Unit
 			path.gsPack.offset = path.curOffset;
 			path.gsPack.size = 0;
 		}
+		Gif_FlushCoalescedGSPacket();
 	}
 
 	// Processes gif packets and performs path arbitration
@@ -784,6 +805,7 @@ struct Gif_Unit
 		{
 			FlushToMTGS();
 		}
+		Gif_FlushCoalescedGSPacket();
 
 		Gif_FinishIRQ();
 
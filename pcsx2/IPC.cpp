@@ -30,8 +30,12 @@
 #define read_portable(a, b, c) (read(a, b, c))
 #define write_portable(a, b, c) (write(a, b, c))
 #define close_portable(a) (close(a))
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <unistd.h>
 #endif
 
 #include "Common.h"
@@ -44,6 +48,7 @@
 
 SocketIPC::SocketIPC(SysCoreThread* vm, unsigned int slot)
 	: pxThread("IPC_Socket")
+	, m_slot(slot)
 {
 #ifdef _WIN32
 	WSADATA wsa;
@@ -128,6 +133,239 @@ SocketIPC::SocketIPC(SysCoreThread* vm, unsigned int slot)
 	Start();
 }
 
+// Batched and block accesses read pages that are plain memory directly instead of going
+// through memRead for every value.  Pages behind a vtlb handler, like hardware registers
+// or memcheck watches, still go through memRead/memWrite so they behave like single accesses.
+static void ReadValue(u32 address, u8 width, char* dest)
+{
+	if ((address & (width - 1)) == 0)
+	{
+		if (const void* ptr = vtlb_GetVirtPtr(address))
+		{
+			memcpy(dest, ptr, width);
+			return;
+		}
+	}
+
+	switch (width)
+	{
+		case 1:
+		{
+			const u8 res = memRead8(address);
+			memcpy(dest, &res, 1);
+			break;
+		}
+		case 2:
+		{
+			const u16 res = memRead16(address);
+			memcpy(dest, &res, 2);
+			break;
+		}
+		case 4:
+		{
+			const u32 res = memRead32(address);
+			memcpy(dest, &res, 4);
+			break;
+		}
+		default:
+		{
+			u64 res = 0;
+			memRead64(address, &res);
+			memcpy(dest, &res, 8);
+			break;
+		}
+	}
+}
+
+static void ReadBlock(u32 address, u32 size, char* dest)
+{
+	while (size > 0)
+	{
+		const u32 chunk = std::min(size, 0x1000 - (address & 0xFFF));
+		if (const void* ptr = vtlb_GetVirtPtr(address))
+			memcpy(dest, ptr, chunk);
+		else
+		{
+			for (u32 i = 0; i < chunk; i++)
+				dest[i] = memRead8(address + i);
+		}
+		address += chunk;
+		dest += chunk;
+		size -= chunk;
+	}
+}
+
+static void WriteBlock(u32 address, u32 size, const char* src)
+{
+	while (size > 0)
+	{
+		const u32 chunk = std::min(size, 0x1000 - (address & 0xFFF));
+		if (void* ptr = vtlb_GetVirtPtr(address))
+			memcpy(ptr, src, chunk);
+		else
+		{
+			for (u32 i = 0; i < chunk; i++)
+				memWrite8(address + i, src[i]);
+		}
+		address += chunk;
+		src += chunk;
+		size -= chunk;
+	}
+}
+
+std::string SocketIPC::SharedName(const char* kind)
+{
+#ifdef _WIN32
+	std::string name = IPC_EMULATOR_NAME ".";
+#else
+	std::string name = "/" IPC_EMULATOR_NAME ".";
+#endif
+	name += kind;
+	if (m_slot != IPC_DEFAULT_SLOT)
+		name += "." + std::to_string(m_slot);
+	return name;
+}
+
+size_t SocketIPC::Subscribe(const std::vector<SharedRange>& ranges)
+{
+	Unsubscribe();
+
+	u64 frame_size = 8;
+	for (const SharedRange& range : ranges)
+		frame_size += range.size;
+	if (frame_size > MAX_SHARED_FRAME_SIZE + 8)
+		return 0;
+
+	const u32 slot_size = (u32)((frame_size + 63) & ~63);
+	const u32 data_offset = (u32)((sizeof(SharedFrameHeader) + ranges.size() * sizeof(SharedRange) + 63) & ~63);
+	const size_t size = data_offset + (size_t)slot_size * SHARED_FRAME_SLOTS;
+	const std::string name = SharedName("shm");
+	void* map;
+
+#ifdef _WIN32
+	m_shared_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((u64)size >> 32), (DWORD)size, name.c_str());
+	if (m_shared_mapping == NULL)
+		return 0;
+	map = MapViewOfFile(m_shared_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (map == NULL)
+	{
+		CloseHandle(m_shared_mapping);
+		m_shared_mapping = NULL;
+		return 0;
+	}
+	m_shared_signal = CreateEventA(NULL, FALSE, FALSE, SharedName("sig").c_str());
+#else
+	const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (fd < 0)
+		return 0;
+	if (ftruncate(fd, size) != 0)
+	{
+		close(fd);
+		shm_unlink(name.c_str());
+		return 0;
+	}
+	map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		shm_unlink(name.c_str());
+		return 0;
+	}
+	sem_t* sem = sem_open(SharedName("sig").c_str(), O_CREAT, 0600, 0);
+	m_shared_signal = sem == SEM_FAILED ? nullptr : sem;
+#endif
+
+	// the object may still hold a previous subscription
+	u8* base = static_cast<u8*>(map);
+	memset(base, 0, data_offset);
+	for (u32 i = 0; i < SHARED_FRAME_SLOTS; i++)
+		memset(base + data_offset + i * slot_size, 0, 8);
+	memcpy(base + sizeof(SharedFrameHeader), ranges.data(), ranges.size() * sizeof(SharedRange));
+
+	m_shared_header = static_cast<SharedFrameHeader*>(map);
+	m_shared_header->version = 1;
+	m_shared_header->slot_count = SHARED_FRAME_SLOTS;
+	m_shared_header->slot_size = slot_size;
+	m_shared_header->range_count = (u32)ranges.size();
+	m_shared_header->data_offset = data_offset;
+	m_shared_header->frame.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_shared_header->magic = SHARED_FRAME_MAGIC;
+
+	m_shared_ranges = ranges;
+	m_shared_size = size;
+	m_shared_slot_size = slot_size;
+	m_shared_data_offset = data_offset;
+	m_shared_frame = 0;
+	return size;
+}
+
+void SocketIPC::Unsubscribe()
+{
+	if (m_shared_header == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_shared_header);
+	CloseHandle(m_shared_mapping);
+	if (m_shared_signal != NULL)
+		CloseHandle(m_shared_signal);
+	m_shared_mapping = NULL;
+	m_shared_signal = NULL;
+#else
+	munmap(m_shared_header, m_shared_size);
+	shm_unlink(SharedName("shm").c_str());
+	if (m_shared_signal != nullptr)
+	{
+		sem_close(static_cast<sem_t*>(m_shared_signal));
+		sem_unlink(SharedName("sig").c_str());
+	}
+	m_shared_signal = nullptr;
+#endif
+
+	m_shared_header = nullptr;
+	m_shared_ranges.clear();
+	m_shared_size = 0;
+}
+
+void SocketIPC::Vsync()
+{
+	// skip the frame rather than stalling the vm while the subscription changes
+	std::unique_lock<std::mutex> lock(m_shared_lock, std::try_to_lock);
+	if (!lock.owns_lock() || m_shared_header == nullptr)
+		return;
+
+	// the layout fields in shared memory belong to the client as well, so our own copies are used
+	const u64 frame = ++m_shared_frame;
+	u8* slot = reinterpret_cast<u8*>(m_shared_header) + m_shared_data_offset + (frame % SHARED_FRAME_SLOTS) * m_shared_slot_size;
+	std::atomic<u64>* slot_frame = reinterpret_cast<std::atomic<u64>*>(slot);
+
+	slot_frame->store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	char* dest = reinterpret_cast<char*>(slot + 8);
+	for (const SharedRange& range : m_shared_ranges)
+	{
+		ReadBlock(range.address, range.size, dest);
+		dest += range.size;
+	}
+	slot_frame->store(frame, std::memory_order_release);
+	m_shared_header->frame.store(frame, std::memory_order_release);
+
+	// a single wakeup is left pending however many frames the client missed
+#ifdef _WIN32
+	if (m_shared_signal != NULL)
+		SetEvent(m_shared_signal);
+#else
+	if (m_shared_signal != nullptr)
+	{
+		sem_t* sem = static_cast<sem_t*>(m_shared_signal);
+		int value;
+		if (sem_getvalue(sem, &value) != 0 || value <= 0)
+			sem_post(sem);
+	}
+#endif
+}
+
 char* SocketIPC::MakeOkIPC(char* ret_buffer, uint32_t size = 5)
 {
 	ToArray<uint32_t>(ret_buffer, size, 0);
@@ -241,6 +479,10 @@ void SocketIPC::ExecuteTaskInThread()
 SocketIPC::~SocketIPC()
 {
 	m_end = true;
+	{
+		std::lock_guard<std::mutex> lock(m_shared_lock);
+		Unsubscribe();
+	}
 #ifdef _WIN32
 	WSACleanup();
 #else
@@ -482,6 +724,104 @@ SocketIPC::IPCBuffer SocketIPC::ParseCommand(char* buf, char* ret_buffer, u32 bu
 				ret_cnt += 4;
 				break;
 			}
+			//         MsgReadBatch  count (4 byte)
+			//         |             |           count * (address (4 byte), width (1 byte))
+			//         |             |           |
+			// format: XX            NN NN NN NN YY YY YY YY WW ...
+			// reply:  the values packed back to back, each one width bytes
+			case MsgReadBatch:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 count = FromArray<u32>(&buf[buf_cnt], 0);
+				buf_cnt += 4;
+				if ((u64)count * 5 > buf_size - buf_cnt)
+					goto error;
+				for (u32 i = 0; i < count; i++)
+				{
+					const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+					const u8 width = FromArray<u8>(&buf[buf_cnt], 4);
+					if ((width != 1 && width != 2 && width != 4 && width != 8) ||
+						!SafetyChecks(buf_cnt, 5, ret_cnt, width, buf_size))
+						goto error;
+					ReadValue(a, width, &ret_buffer[ret_cnt]);
+					ret_cnt += width;
+					buf_cnt += 5;
+				}
+				break;
+			}
+			// format: XX YY YY YY YY (address) SS SS SS SS (size)
+			// reply:  size bytes of memory
+			case MsgReadBlock:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size >= MAX_IPC_RETURN_SIZE || !SafetyChecks(buf_cnt, 8, ret_cnt, size, buf_size))
+					goto error;
+				ReadBlock(a, size, &ret_buffer[ret_cnt]);
+				ret_cnt += size;
+				buf_cnt += 8;
+				break;
+			}
+			// format: XX YY YY YY YY (address) SS SS SS SS (size) followed by size bytes of data
+			case MsgWriteBlock:
+			{
+				if (!m_vm->HasActiveMachine())
+					goto error;
+				if (!SafetyChecks(buf_cnt, 8, ret_cnt, 0, buf_size))
+					goto error;
+				const u32 a = FromArray<u32>(&buf[buf_cnt], 0);
+				const u32 size = FromArray<u32>(&buf[buf_cnt], 4);
+				if (size >= MAX_IPC_SIZE || !SafetyChecks(buf_cnt, 8 + size, ret_cnt, 0, buf_size))
+					goto error;
+				WriteBlock(a, size, &buf[buf_cnt + 8]);
+				buf_cnt += 8 + size;
+				break;
+			}
+			//         MsgSubscribe  count (4 byte)
+			//         |             |           count * (address (4 byte), size (4 byte))
+			//         |             |           |
+			// format: XX            NN NN NN NN YY YY YY YY SS SS SS SS ...
+			// reply:  size of the shared memory object (4 byte)
+			// replaces any previous subscription, see SharedFrameHeader for the layout
+			case MsgSubscribe:
+			{
+				if (!SafetyChecks(buf_cnt, 4, ret_cnt, 4, buf_size))
+					goto error;
+				const u32 count = FromArray<u32>(&buf[buf_cnt], 0);
+				buf_cnt += 4;
+				if ((u64)count * 8 > buf_size - buf_cnt)
+					goto error;
+				std::vector<SharedRange> ranges(count);
+				for (u32 i = 0; i < count; i++)
+				{
+					ranges[i].address = FromArray<u32>(&buf[buf_cnt], 0);
+					ranges[i].size = FromArray<u32>(&buf[buf_cnt], 4);
+					buf_cnt += 8;
+				}
+				size_t size;
+				{
+					std::lock_guard<std::mutex> lock(m_shared_lock);
+					size = Subscribe(ranges);
+				}
+				if (size == 0)
+					goto error;
+				ToArray(ret_buffer, (u32)size, ret_cnt);
+				ret_cnt += 4;
+				break;
+			}
+			case MsgUnsubscribe:
+			{
+				std::lock_guard<std::mutex> lock(m_shared_lock);
+				Unsubscribe();
+				break;
+			}
 			default:
 			{
 			error:
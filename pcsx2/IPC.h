@@ -27,7 +27,10 @@
 
 #include "Utilities/PersistentThread.h"
 #include "System/SysThreads.h"
+#include <atomic>
+#include <mutex>
 #include <string>
+#include <vector>
 #ifdef _WIN32
 #include <WinSock2.h>
 #include <windows.h>
@@ -105,6 +108,11 @@ protected:
 		MsgUUID = 0xD,          /**< Returns the game UUID. */
 		MsgGameVersion = 0xE,   /**< Returns the game verion. */
 		MsgStatus = 0xF,        /**< Returns the emulator status. */
+		MsgReadBatch = 0x10,    /**< Reads a list of 8, 16, 32 or 64 bit values in one reply. */
+		MsgReadBlock = 0x11,    /**< Reads a contiguous block of memory. */
+		MsgWriteBlock = 0x12,   /**< Writes a contiguous block of memory. */
+		MsgSubscribe = 0x13,    /**< Copies memory ranges to shared memory every frame. */
+		MsgUnsubscribe = 0x14,  /**< Stops the shared memory copies. */
 		MsgUnimplemented = 0xFF /**< Unimplemented IPC message. */
 	};
 
@@ -141,6 +149,69 @@ protected:
 		IPC_FAIL = 0xFF /**< IPC command failed to complete. */
 	};
 
+	/**
+	 * Shared memory frame header.
+	 * After MsgSubscribe, the shared memory object named after the slot
+	 * (/pcsx2.shm, or /pcsx2.shm.<slot> for other slots; without the
+	 * leading slash on Windows) starts with this header, followed by
+	 * range_count (address, size) pairs and slot_count frame slots at
+	 * data_offset.  Every frame slot starts with the 8 byte frame number it
+	 * holds, followed by the ranges packed back to back.  Once per vsync the
+	 * ranges are copied into slot frame % slot_count, then frame is updated
+	 * and the client is woken up through the named semaphore (an event on
+	 * Windows) pcsx2.sig with the same slot suffix.  A slot's frame number is
+	 * 0 while it's being written and set last, so a reader can check it
+	 * again after copying.
+	 */
+	struct SharedFrameHeader
+	{
+		u32 magic;       /**< SHARED_FRAME_MAGIC. */
+		u32 version;     /**< Layout version, currently 1. */
+		u32 slot_count;  /**< Number of frame slots in the ring. */
+		u32 slot_size;   /**< Size of a frame slot, frame number included. */
+		u32 range_count; /**< Number of subscribed ranges. */
+		u32 data_offset; /**< Offset of the first frame slot. */
+		std::atomic<u64> frame; /**< Last frame copied, 0 before the first one. */
+	};
+
+#define SHARED_FRAME_MAGIC 0x4D485350 // "PSHM"
+#define SHARED_FRAME_SLOTS 4
+	/**
+	 * Maximum memory subscribed to through MsgSubscribe, per frame.
+	 */
+#define MAX_SHARED_FRAME_SIZE (32 * 1024 * 1024)
+
+	struct SharedRange
+	{
+		u32 address;
+		u32 size;
+	};
+
+	// the subscription, guarded by m_shared_lock as it's used by the vm thread
+	std::mutex m_shared_lock;
+	std::vector<SharedRange> m_shared_ranges;
+	SharedFrameHeader* m_shared_header = nullptr;
+	size_t m_shared_size = 0;
+	u32 m_shared_slot_size = 0;
+	u32 m_shared_data_offset = 0;
+	u64 m_shared_frame = 0;
+#ifdef _WIN32
+	HANDLE m_shared_mapping = NULL;
+	HANDLE m_shared_signal = NULL;
+#else
+	void* m_shared_signal = nullptr;
+#endif
+
+	unsigned int m_slot;
+
+	/**
+	 * Maps the shared memory object for the given ranges.
+	 * return value: size of the mapping, 0 if it failed.
+	 */
+	size_t Subscribe(const std::vector<SharedRange>& ranges);
+	void Unsubscribe();
+	std::string SharedName(const char* kind);
+
 	// handle to the main vm thread
 	SysCoreThread* m_vm;
 
@@ -221,4 +292,10 @@ public:
 	SocketIPC(SysCoreThread* vm, unsigned int slot = IPC_DEFAULT_SLOT);
 	virtual ~SocketIPC();
 
+	/**
+	 * Copies the subscribed ranges to shared memory, called by the vm
+	 * thread once per vsync.
+	 */
+	void Vsync();
+
 }; // class SocketIPC
@@ -18,6 +18,8 @@
 
 #include "IPU.h"
 #include "IPUdma.h"
+#include "IPUthread.h"
+#include "IPUconv.h"
 #include "yuv2rgb.h"
 #include "mpeg2lib/Mpeg.h"
 
@@ -56,7 +58,9 @@ void tIPU_cmd::clear()
 	current = 0xffffffff;
 }
 
-__fi void IPUProcessInterrupt()
+// Runs the current command as far as the data allows, on the EE thread or the IPU thread
+// (THREAD_IPU), whichever the IPU state belongs to
+void IPURun()
 {
 	if (ipuRegs.ctrl.BUSY) // && (g_BP.FP || g_BP.IFC || (ipu1ch.chcr.STR && ipu1ch.qwc > 0)))
 		IPUWorker();
@@ -69,11 +73,22 @@ __fi void IPUProcessInterrupt()
 	}
 }
 
+__fi void IPUProcessInterrupt()
+{
+	if (THREAD_IPU || ipuThread.IsBusy())
+		ipuThread.Kick();
+	else
+		IPURun();
+}
+
 /////////////////////////////////////////////////////////
 // Register accesses (run on EE thread)
 
 void ipuReset()
 {
+	ipuThread.Wait();
+	ipuThread.Reset();
+
 	memzero(ipuRegs);
 	memzero(g_BP);
 	memzero(decoder);
@@ -104,6 +119,10 @@ void SaveStateBase::ipuFreeze()
 	// Get a report of the status of the ipu variables when saving and loading savestates.
 	//ReportIPU();
 	FreezeTag("IPU");
+
+	// The data queued to and from the IPU thread, it stays in the queues
+	ipuThread.Freeze(*this);
+
 	Freeze(ipu_fifo);
 
 	Freeze(g_BP);
@@ -197,7 +216,26 @@ __fi u32 ipuRead32(u32 mem)
 	pxAssert((mem & ~0xff) == 0x10002000);
 	mem &= 0xff;	// ipu repeats every 0x100
 
-	IPUProcessInterrupt();
+	// Once stopped, the IPU thread leaves the IPU state to the EE
+	if (ipuThread.IsBusy())
+	{
+		// Games poll IPU_CTRL for the end of the command, let the thread decode meanwhile
+		if (mem == ipumsk(IPU_CTRL))
+		{
+			ipuThread.Poll();
+
+			tIPU_CTRL ctrl = ipuRegs.ctrl;
+			ctrl.IFC = std::min<u32>(8, g_BP.IFC + ipuThread.FeedCount());
+			ctrl.OFC = std::min<u32>(8, ctrl.OFC + ipuThread.DrainCount());
+			ctrl.CBP = coded_block_pattern;
+			ctrl.BUSY = 1;
+			return ctrl._u32;
+		}
+
+		ipuThread.Wait();
+	}
+
+	IPURun();
 
 	switch (mem)
 	{
@@ -213,13 +251,16 @@ __fi u32 ipuRead32(u32 mem)
 
 		ipucase(IPU_CTRL): // IPU_CTRL
 		{
-			ipuRegs.ctrl.IFC = g_BP.IFC;
+			ipuRegs.ctrl.IFC = std::min<u32>(8, g_BP.IFC + ipuThread.FeedCount());
 			ipuRegs.ctrl.CBP = coded_block_pattern;
 
 			if (!ipuRegs.ctrl.BUSY)
 				IPU_LOG("read32: IPU_CTRL=0x%08X", ipuRegs.ctrl._u32);
 
-			return ipuRegs.ctrl._u32;
+			// The data queued by the thread counts as in the output FIFO
+			tIPU_CTRL ctrl = ipuRegs.ctrl;
+			ctrl.OFC = std::min<u32>(8, ctrl.OFC + ipuThread.DrainCount());
+			return ctrl._u32;
 		}
 
 		ipucase(IPU_BP): // IPU_BP
@@ -227,7 +268,7 @@ __fi u32 ipuRead32(u32 mem)
 			pxAssume(g_BP.FP <= 2);
 			
 			ipuRegs.ipubp = g_BP.BP & 0x7f;
-			ipuRegs.ipubp |= g_BP.IFC << 8;
+			ipuRegs.ipubp |= std::min<u32>(8, g_BP.IFC + ipuThread.FeedCount()) << 8;
 			ipuRegs.ipubp |= g_BP.FP << 16;
 
 			IPU_LOG("read32: IPU_BP=0x%08X", ipuRegs.ipubp);
@@ -249,7 +290,11 @@ __fi u64 ipuRead64(u32 mem)
 	pxAssert((mem & ~0xff) == 0x10002000);
 	mem &= 0xff;	// ipu repeats every 0x100
 
-	IPUProcessInterrupt();
+	// Once stopped, the IPU thread leaves the IPU state to the EE
+	if (ipuThread.IsBusy())
+		ipuThread.Wait();
+
+	IPURun();
 
 	switch (mem)
 	{
@@ -313,13 +358,16 @@ __fi bool ipuWrite32(u32 mem, u32 value)
 	{
 		ipucase(IPU_CMD): // IPU_CMD
 			IPU_LOG("write32: IPU_CMD=0x%08X", value);
+			ipuThread.Hold();
 			IPUCMD_WRITE(value);
+			ipuThread.Release();
 			IPUProcessInterrupt();
 		return false;
 
 		ipucase(IPU_CTRL): // IPU_CTRL
             // CTRL = the first 16 bits of ctrl [0x8000ffff], + value for the next 16 bits,
             // minus the reserved bits. (18-19; 27-29) [0x47f30000]
+			ipuThread.Hold();
 			ipuRegs.ctrl.write(value);
 			if (ipuRegs.ctrl.IDP == 3)
 			{
@@ -328,6 +376,7 @@ __fi bool ipuWrite32(u32 mem, u32 value)
 			}
 
 			if (ipuRegs.ctrl.RST) ipuSoftReset(); // RESET
+			ipuThread.Release();
 
 			IPU_LOG("write32: IPU_CTRL=0x%08X", value);
 		return false;
@@ -349,7 +398,9 @@ __fi bool ipuWrite64(u32 mem, u64 value)
 	{
 		ipucase(IPU_CMD):
 			IPU_LOG("write64: IPU_CMD=0x%08X", value);
+			ipuThread.Hold();
 			IPUCMD_WRITE((u32)value);
+			ipuThread.Release();
 			IPUProcessInterrupt();
 		return false;
 	}
@@ -669,64 +720,14 @@ static void ipuSETTH(u32 val)
 // --------------------------------------------------------------------------------------
 __fi void ipu_csc(macroblock_8& mb8, macroblock_rgb32& rgb32, int sgn)
 {
-	int i;
-	u8* p = (u8*)&rgb32;
-
 	yuv2rgb();
-
-	if (s_thresh[0] > 0)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			if ((p[0] < s_thresh[0]) && (p[1] < s_thresh[0]) && (p[2] < s_thresh[0]))
-				*(u32*)p = 0;
-			else if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
-				p[3] = 0x40;
-		}
-	}
-	else if (s_thresh[1] > 0)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			if ((p[0] < s_thresh[1]) && (p[1] < s_thresh[1]) && (p[2] < s_thresh[1]))
-				p[3] = 0x40;
-		}
-	}
-	if (sgn)
-	{
-		for (i = 0; i < 16*16; i++, p += 4)
-		{
-			*(u32*)p ^= 0x808080;
-		}
-	}
+	ipu_csc_thresh_sse4(reinterpret_cast<u32*>(&rgb32), s_thresh[0], s_thresh[1], sgn);
 }
 
 __fi void ipu_vq(macroblock_rgb16& rgb16, u8* indx4)
 {
-	const auto closest_index = [&](int i, int j) {
-		u8 index = 0;
-		int min_distance = std::numeric_limits<int>::max();
-		for (u8 k = 0; k < 16; ++k)
-		{
-			const int dr = rgb16.c[i][j].r - vqclut[k].r;
-			const int dg = rgb16.c[i][j].g - vqclut[k].g;
-			const int db = rgb16.c[i][j].b - vqclut[k].b;
-			const int distance = dr * dr + dg * dg + db * db;
-
-			// XXX: If two distances are the same which index is used?
-			if (min_distance > distance)
-			{
-				index = k;
-				min_distance = distance;
-			}
-		}
-
-		return index;
-	};
-
-	for (int i = 0; i < 16; ++i)
-		for (int j = 0; j < 8; ++j)
-			indx4[i * 8 + j] = closest_index(i, 2 * j + 1) << 4 | closest_index(i, 2 * j);
+	static_assert(sizeof(rgb16_t) == sizeof(u16), "the clut is read as raw RGB16");
+	ipu_vq_sse4(reinterpret_cast<const u16*>(&rgb16), reinterpret_cast<const u16*>(vqclut), indx4);
 }
 
 
@@ -1004,6 +1005,15 @@ __noinline void IPUWorker()
 	// success
 	ipuRegs.ctrl.BUSY = 0;
 	//ipu_cmd.current = 0xffffffff;
+
+	// The EE raises them for the IPU thread
+	if (ipuThread.IsWorker())
+	{
+		ipuThread.Post(IPU_Thread::Event_Intc);
+		ipuThread.Post(IPU_Thread::Event_ToIPU);
+		return;
+	}
+
 	hwIntcIrq(INTC_IPU);
 
 	// Fill the FIFO ready for the next command
@@ -296,6 +296,7 @@ extern bool ipuWrite64(u32 mem,u64 value);
 extern void IPUCMD_WRITE(u32 val);
 extern void ipuSoftReset();
 extern void IPUProcessInterrupt();
+extern void IPURun();
 
 extern u8 getBits64(u8 *address, bool advance);
 extern u8 getBits32(u8 *address, bool advance);
@@ -17,6 +17,7 @@
 #include "Common.h"
 #include "IPU.h"
 #include "IPU/IPUdma.h"
+#include "IPU/IPUthread.h"
 #include "mpeg2lib/Mpeg.h"
 
 __aligned16 IPU_Fifo ipu_fifo;
@@ -38,6 +39,7 @@ void IPU_Fifo_Input::clear()
 	ipuRegs.ctrl.IFC = 0;
 	readpos = 0;
 	writepos = 0;
+	ipuThread.ClearFeed();
 }
 
 void IPU_Fifo_Output::clear()
@@ -46,6 +48,7 @@ void IPU_Fifo_Output::clear()
 	ipuRegs.ctrl.OFC = 0;
 	readpos = 0;
 	writepos = 0;
+	ipuThread.ClearDrain();
 }
 
 void IPU_Fifo::clear()
@@ -87,8 +90,11 @@ int IPU_Fifo_Input::read(void *value)
 	// wait until enough data to ensure proper streaming.
 	if (g_BP.IFC < 3)
 	{
+		// The IPU thread asks the EE for the DMA
+		ipuThread.Refill();
+
 		// IPU FIFO is empty and DMA is waiting so lets tell the DMA we are ready to put data in the FIFO
-		if(cpuRegs.eCycle[4] == 0x9999)
+		if(!ipuThread.IsWorker() && cpuRegs.eCycle[4] == 0x9999)
 		{
 			CPU_INT( DMAC_TO_IPU, 32 );
 		}
@@ -108,6 +114,17 @@ int IPU_Fifo_Output::write(const u32 *value, uint size)
 {
 	pxAssertMsg(size>0, "Invalid size==0 when calling IPU_Fifo_Output::write");
 
+	// The IPU thread queues its output for the EE, after any that is queued already
+	if (ipuThread.IsWorker() || ipuThread.DrainCount())
+	{
+		uint queued = ipuThread.Produce(value, size);
+		if (queued && ipuThread.IsWorker())
+			ipuThread.Post(IPU_Thread::Event_FromIPU);
+		else if (queued && ipu0ch.chcr.STR)
+			IPU_INT_FROM(64);
+		return queued;
+	}
+
 	uint origsize = size;
 	/*do {*/
 		//IPU0dma();
@@ -130,9 +147,30 @@ int IPU_Fifo_Output::write(const u32 *value, uint size)
 	return origsize - size;
 }
 
+uint IPU_Fifo_Output::available() const
+{
+	return ipuRegs.ctrl.OFC + ipuThread.DrainCount();
+}
+
 void IPU_Fifo_Output::read(void *value, uint size)
 {
-	pxAssert(ipuRegs.ctrl.OFC >= size);
+	pxAssert(available() >= size);
+
+	// The FIFO holds the older data
+	if (size > ipuRegs.ctrl.OFC)
+	{
+		uint fifo = ipuRegs.ctrl.OFC;
+		if (fifo)
+			read(value, fifo);
+		ipuThread.Consume((u128*)value + fifo, size - fifo);
+		ipuThread.Kick();
+		return;
+	}
+
+	// IPU_CTRL is shared with the running thread
+	if (ipuThread.IsBusy())
+		ipuThread.Wait();
+
 	ipuRegs.ctrl.OFC -= size;
 	
 	// Zeroing the read data is not needed, since the ringbuffer design will never read back
@@ -152,7 +190,7 @@ void IPU_Fifo_Output::read(void *value, uint size)
 
 void __fastcall ReadFIFO_IPUout(mem128_t* out)
 {
-	if (!pxAssertDev( ipuRegs.ctrl.OFC > 0, "Attempted read from IPUout's FIFO, but the FIFO is empty!" )) return;
+	if (!pxAssertDev( ipu_fifo.out.available() > 0, "Attempted read from IPUout's FIFO, but the FIFO is empty!" )) return;
 	ipu_fifo.out.read(out, 1);
 
 	// Games should always check the fifo before reading from it -- so if the FIFO has no data
@@ -163,6 +201,14 @@ void __fastcall WriteFIFO_IPUin(const mem128_t* value)
 {
 	IPU_LOG( "WriteFIFO/IPUin <- %ls", WX_STR(value->ToString()) );
 
+	// The IPU thread takes the data from its feed, after any that is queued already
+	if (ipuThread.IsActive())
+	{
+		ipuThread.Feed((u32*)value, 1);
+		ipuThread.Kick();
+		return;
+	}
+
 	//committing every 16 bytes
 	if( ipu_fifo.in.write((u32*)value, 1) == 0 )
 	{
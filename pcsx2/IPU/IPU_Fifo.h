@@ -38,6 +38,8 @@ struct IPU_Fifo_Output
 
 	// returns number of qw read
 	int write(const u32 * value, uint size);
+	// qwords to read, with the ones queued by the IPU thread
+	uint available() const;
 	void read(void *value, uint size);
 	void clear();
 	wxString desc() const;
@@ -0,0 +1,109 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// SSE4.1 passes of the CSC and PACK commands on a macroblock, used by ipu_csc and
+// ipu_vq. They work on the raw pixels and only depend on the common headers so that
+// tests/ctest/ipu can check them against the C versions.
+
+#pragma once
+
+#include "Pcsx2Defs.h"
+
+// Applies the SETTH thresholds and the sign flip (SGN) to the 16x16 RGBA32 pixels
+// of rgba32: a pixel whose r, g and b are below thresh0 is cleared, else below thresh1
+// its alpha becomes 0x40.
+static __fi void ipu_csc_thresh_sse4(u32* rgba32, u16 thresh0, u16 thresh1, int sgn)
+{
+	const bool thresh = thresh0 || thresh1;
+	if (!thresh && !sgn)
+		return;
+
+	const __m128i vthresh0 = _mm_set1_epi32(thresh0);
+	const __m128i vthresh1 = _mm_set1_epi32(thresh1);
+	const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+	const __m128i alpha_40 = _mm_set1_epi32(0x40000000);
+	const __m128i sign = _mm_set1_epi32(sgn ? 0x808080 : 0);
+
+	__m128i* p = reinterpret_cast<__m128i*>(rgba32);
+	for (int i = 0; i < 16 * 16 / 4; ++i)
+	{
+		__m128i rgba = _mm_load_si128(p + i);
+
+		if (thresh)
+		{
+			// The pixel is below a threshold when max(r, g, b) is
+			__m128i max = _mm_max_epu8(rgba, _mm_srli_epi32(rgba, 8));
+			max = _mm_max_epu8(max, _mm_srli_epi32(rgba, 16));
+			max = _mm_and_si128(max, _mm_set1_epi32(0xff));
+
+			const __m128i below0 = _mm_cmpgt_epi32(vthresh0, max);
+			const __m128i below1 = _mm_and_si128(_mm_cmpgt_epi32(vthresh1, max), alpha_mask);
+
+			rgba = _mm_blendv_epi8(rgba, alpha_40, below1);
+			rgba = _mm_andnot_si128(below0, rgba);
+		}
+
+		_mm_store_si128(p + i, _mm_xor_si128(rgba, sign));
+	}
+}
+
+// Replaces the 16x16 RGB16 pixels of rgb16 by the index of the closest entry of the
+// 16 colour clut (in the same format), two indexes per byte of indx4.
+static __fi void ipu_vq_sse4(const u16* rgb16, const u16* clut, u8* indx4)
+{
+	const __m128i mask = _mm_set1_epi16(0x1f);
+
+	__m128i clut_r[16], clut_g[16], clut_b[16];
+	for (int k = 0; k < 16; ++k)
+	{
+		clut_r[k] = _mm_set1_epi16(clut[k] & 0x1f);
+		clut_g[k] = _mm_set1_epi16((clut[k] >> 5) & 0x1f);
+		clut_b[k] = _mm_set1_epi16((clut[k] >> 10) & 0x1f);
+	}
+
+	const auto closest_index = [&](__m128i rgb) {
+		const __m128i r = _mm_and_si128(rgb, mask);
+		const __m128i g = _mm_and_si128(_mm_srli_epi16(rgb, 5), mask);
+		const __m128i b = _mm_and_si128(_mm_srli_epi16(rgb, 10), mask);
+
+		// The distances fit 16 bits (3 * 31 * 31)
+		__m128i index = _mm_setzero_si128();
+		__m128i min_distance = _mm_set1_epi16(0x7fff);
+		for (int k = 0; k < 16; ++k)
+		{
+			const __m128i dr = _mm_sub_epi16(r, clut_r[k]);
+			const __m128i dg = _mm_sub_epi16(g, clut_g[k]);
+			const __m128i db = _mm_sub_epi16(b, clut_b[k]);
+			const __m128i distance = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(dr, dr), _mm_mullo_epi16(dg, dg)), _mm_mullo_epi16(db, db));
+
+			// XXX: If two distances are the same which index is used? (the first one here)
+			const __m128i closer = _mm_cmpgt_epi16(min_distance, distance);
+			min_distance = _mm_min_epi16(min_distance, distance);
+			index = _mm_blendv_epi8(index, _mm_set1_epi16(k), closer);
+		}
+
+		// Two indexes per byte, the even pixel in the low nibble
+		return _mm_and_si128(_mm_or_si128(index, _mm_srli_epi32(index, 12)), _mm_set1_epi32(0xff));
+	};
+
+	// Two rows (32 pixels) per 16 bytes of indx4
+	for (int i = 0; i < 16; i += 2)
+	{
+		const __m128i* row = reinterpret_cast<const __m128i*>(rgb16 + i * 16);
+		const __m128i lo = _mm_packus_epi32(closest_index(_mm_load_si128(row + 0)), closest_index(_mm_load_si128(row + 1)));
+		const __m128i hi = _mm_packus_epi32(closest_index(_mm_load_si128(row + 2)), closest_index(_mm_load_si128(row + 3)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(indx4 + i * 8), _mm_packus_epi16(lo, hi));
+	}
+}
@@ -17,6 +17,7 @@
 #include "Common.h"
 #include "IPU.h"
 #include "IPU/IPUdma.h"
+#include "IPU/IPUthread.h"
 #include "mpeg2lib/Mpeg.h"
 
 static IPUStatus IPU1Status;
@@ -86,8 +87,11 @@ static __fi int IPU1chain() {
 			return totalqwc;
 		}
 
-		//Write our data to the fifo
-		qwc = ipu_fifo.in.write(pMem, qwc);
+		//Write our data to the fifo, or to the feed of the IPU thread
+		if (ipuThread.IsActive())
+			qwc = ipuThread.Feed(pMem, qwc);
+		else
+			qwc = ipu_fifo.in.write(pMem, qwc);
 		ipu1ch.madr += qwc << 4;
 		ipu1ch.qwc -= qwc;
 		totalqwc += qwc;
@@ -190,7 +194,7 @@ int IPU1dma()
 
 void IPU0dma()
 {
-	if(!ipuRegs.ctrl.OFC) 
+	if(!ipu_fifo.out.available())
 	{
 		IPUProcessInterrupt();
 		return;
@@ -214,7 +218,7 @@ void IPU0dma()
 
 	pMem = dmaGetAddr(ipu0ch.madr, true);
 
-	readsize = std::min(ipu0ch.qwc, (u32)ipuRegs.ctrl.OFC);
+	readsize = std::min(ipu0ch.qwc, (u32)ipu_fifo.out.available());
 	ipu_fifo.out.read(pMem, readsize);
 
 	ipu0ch.madr += readsize << 4;
@@ -0,0 +1,285 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "IPU.h"
+#include "IPUdma.h"
+#include "IPUthread.h"
+#include "mpeg2lib/Mpeg.h"
+
+#include <thread>
+
+__aligned16 IPU_Thread ipuThread;
+
+thread_local bool IPU_Thread::s_worker = false;
+
+IPU_Thread::IPU_Thread()
+{
+	m_name = L"IPU";
+	m_hold = 0;
+	m_held = false;
+	Reset();
+}
+
+IPU_Thread::~IPU_Thread()
+{
+	try
+	{
+		pxThread::Cancel();
+	}
+	DESTRUCTOR_CATCHALL
+}
+
+void IPU_Thread::Reset()
+{
+	ScopedLock lock(m_mtxKick);
+
+	m_busy = false;
+	m_kicked = false;
+	m_events = 0;
+	m_feed_read = 0;
+	m_feed_write = 0;
+	m_drain_read = 0;
+	m_drain_write = 0;
+}
+
+// The thread isn't pinned, the EE, GS and VU roles of the affinity plan are taken and
+// the decoder is happy on any spare core.
+void IPU_Thread::ExecuteTaskInThread()
+{
+	s_worker = true;
+
+	PCSX2_PAGEFAULT_PROTECT
+	{
+		for (;;)
+		{
+			m_sema.WaitWithoutYield();
+
+			for (;;)
+			{
+				IPURun();
+
+				ScopedLock lock(m_mtxKick);
+				if (!m_kicked || !ipuRegs.ctrl.BUSY)
+				{
+					m_kicked = false;
+					m_busy.store(false, std::memory_order_release);
+					break;
+				}
+				m_kicked = false;
+			}
+		}
+	}
+	PCSX2_PAGEFAULT_EXCEPT;
+}
+
+void IPU_Thread::Kick()
+{
+	Poll();
+
+	if (m_hold)
+	{
+		m_held = true;
+		return;
+	}
+
+	ScopedLock lock(m_mtxKick);
+
+	if (m_busy.load(std::memory_order_relaxed))
+	{
+		m_kicked = true;
+		return;
+	}
+
+	if (!ipuRegs.ctrl.BUSY)
+		return;
+
+	if (!THREAD_IPU)
+	{
+		// Left over data of the threaded mode, the EE can run the command itself now
+		lock.Release();
+		IPURun();
+		return;
+	}
+
+	if (!IsRunning())
+		Start();
+
+	m_busy.store(true, std::memory_order_release);
+	m_sema.Post();
+}
+
+void IPU_Thread::Wait()
+{
+	for (uint spins = 0; IsBusy(); spins++)
+	{
+		if (spins < 1024)
+			Threading::SpinWait();
+		else
+			std::this_thread::yield();
+	}
+
+	Poll();
+}
+
+void IPU_Thread::RaiseEvents()
+{
+	const u32 events = m_events.exchange(0, std::memory_order_acquire);
+
+	if (events & Event_Intc)
+		hwIntcIrq(INTC_IPU);
+
+	if ((events & Event_ToIPU) && cpuRegs.eCycle[4] == 0x9999)
+		CPU_INT(DMAC_TO_IPU, 32);
+
+	if ((events & Event_FromIPU) && ipu0ch.chcr.STR && !(cpuRegs.interrupt & (1 << DMAC_FROM_IPU)))
+		IPU_INT_FROM(64);
+}
+
+void IPU_Thread::Hold()
+{
+	if (m_hold++ == 0)
+		Wait();
+}
+
+void IPU_Thread::Release()
+{
+	pxAssert(m_hold > 0);
+
+	if (--m_hold == 0 && m_held)
+	{
+		m_held = false;
+		Kick();
+	}
+}
+
+ScopedIPUHold::ScopedIPUHold() { ipuThread.Hold(); }
+ScopedIPUHold::~ScopedIPUHold() { ipuThread.Release(); }
+
+// --------------------------------------------------------------------------------------
+//  Feed (IPU1 DMA -> IPU) and Drain (IPU -> IPU0 DMA)
+// --------------------------------------------------------------------------------------
+
+u32 IPU_Thread::FeedCount() const
+{
+	return m_feed_write.load(std::memory_order_acquire) - m_feed_read.load(std::memory_order_acquire);
+}
+
+u32 IPU_Thread::DrainCount() const
+{
+	return m_drain_write.load(std::memory_order_acquire) - m_drain_read.load(std::memory_order_acquire);
+}
+
+u32 IPU_Thread::Feed(const u32* data, u32 qwc)
+{
+	const u32 pos = m_feed_write.load(std::memory_order_relaxed);
+	qwc = std::min(qwc, FeedSize - FeedCount());
+
+	for (u32 i = 0; i < qwc; i++, data += 4)
+		CopyQWC(&m_feed[(pos + i) & (FeedSize - 1)], data);
+
+	m_feed_write.store(pos + qwc, std::memory_order_release);
+	return qwc;
+}
+
+void IPU_Thread::Refill()
+{
+	u32 pos = m_feed_read.load(std::memory_order_relaxed);
+	const u32 end = m_feed_write.load(std::memory_order_acquire);
+
+	if (pos == end)
+	{
+		if (s_worker)
+			Post(Event_ToIPU);
+		return;
+	}
+
+	while (pos != end && g_BP.IFC < 8)
+	{
+		ipu_fifo.in.write((u32*)&m_feed[pos & (FeedSize - 1)], 1);
+		pos++;
+	}
+
+	m_feed_read.store(pos, std::memory_order_release);
+
+	if (s_worker && end - pos < FeedSize / 2)
+		Post(Event_ToIPU);
+}
+
+void IPU_Thread::ClearFeed()
+{
+	m_feed_read.store(m_feed_write.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+u32 IPU_Thread::Produce(const u32* data, u32 qwc)
+{
+	const u32 pos = m_drain_write.load(std::memory_order_relaxed);
+	qwc = std::min(qwc, DrainSize - DrainCount());
+
+	for (u32 i = 0; i < qwc; i++, data += 4)
+		CopyQWC(&m_drain[(pos + i) & (DrainSize - 1)], data);
+
+	m_drain_write.store(pos + qwc, std::memory_order_release);
+	return qwc;
+}
+
+u32 IPU_Thread::Consume(u128* data, u32 qwc)
+{
+	const u32 pos = m_drain_read.load(std::memory_order_relaxed);
+	qwc = std::min(qwc, DrainCount());
+
+	for (u32 i = 0; i < qwc; i++)
+		CopyQWC(&data[i], &m_drain[(pos + i) & (DrainSize - 1)]);
+
+	m_drain_read.store(pos + qwc, std::memory_order_release);
+	return qwc;
+}
+
+void IPU_Thread::ClearDrain()
+{
+	m_drain_read.store(m_drain_write.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void IPU_Thread::Freeze(SaveStateBase& state)
+{
+	pxAssert(!IsBusy());
+
+	u32 feed = FeedCount();
+	u32 drain = DrainCount();
+
+	state.Freeze(feed);
+	state.Freeze(drain);
+
+	// A loaded state starts both queues at 0
+	if (state.IsLoading())
+	{
+		Reset();
+
+		if (feed > FeedSize || drain > DrainSize)
+			throw Exception::SaveStateLoadError().SetDiagMsg(L"Corrupted IPU thread queues");
+
+		m_feed_write = feed;
+		m_drain_write = drain;
+	}
+
+	const u32 feed_pos = m_feed_read.load(std::memory_order_relaxed);
+	const u32 drain_pos = m_drain_read.load(std::memory_order_relaxed);
+
+	for (u32 i = 0; i < feed; i++)
+		state.Freeze(m_feed[(feed_pos + i) & (FeedSize - 1)]);
+	for (u32 i = 0; i < drain; i++)
+		state.Freeze(m_drain[(drain_pos + i) & (DrainSize - 1)]);
+}
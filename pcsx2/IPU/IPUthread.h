@@ -0,0 +1,131 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "System/SysThreads.h"
+
+class SaveStateBase;
+
+// Runs the IPU commands on their own thread (THREAD_IPU).
+//
+// The thread owns the IPU state (registers, FIFOs, bit stream point and decoder) while
+// it runs. IPU1 DMA queues its data to the thread (feed) and IPU0 DMA takes the decoded
+// data from it (drain) without waiting: both are single producer / single consumer rings,
+// deep enough for the thread to decode ahead of the DMAs. Everything else on the EE side
+// (register accesses, FIFO accesses through memory, resets and savestates) waits for the
+// thread to stop first, it runs until the command ends or it runs out of data or room.
+//
+// The interrupts and DMA events the IPU raises are posted by the thread, and raised by
+// the EE at its next event test or IPU access. The queued data is part of savestates.
+class IPU_Thread : public pxThread
+{
+public:
+	static const u32 FeedSize = 1024;  // qwords
+	static const u32 DrainSize = 1024; // qwords
+
+	enum Event
+	{
+		Event_Intc = 1,   // INTC_IPU
+		Event_ToIPU = 2,  // IPU1 DMA may continue
+		Event_FromIPU = 4 // IPU0 DMA has data
+	};
+
+private:
+	__aligned16 u128 m_feed[FeedSize];
+	__aligned16 u128 m_drain[DrainSize];
+
+	// Note: keep atomics on separate cache lines to avoid CPU conflict
+	__aligned(64) std::atomic<u32> m_feed_read;   // Only modified by the consumer
+	__aligned(64) std::atomic<u32> m_feed_write;  // Only modified by the EE thread
+	__aligned(64) std::atomic<u32> m_drain_read;  // Only modified by the EE thread
+	__aligned(64) std::atomic<u32> m_drain_write; // Only modified by the producer
+	__aligned(64) std::atomic<u32> m_events;
+	__aligned(64) std::atomic<bool> m_busy;       // Set by the EE, cleared by the IPU thread
+	bool m_kicked;   // The EE has given data or room to the running thread (under m_mtxKick)
+	int  m_hold;     // The EE is accessing the IPU state (EE thread)
+	bool m_held;     // A start was held back by m_hold (EE thread)
+	Mutex m_mtxKick;
+	Semaphore m_sema;
+
+	static thread_local bool s_worker; // Set on the IPU thread
+
+public:
+	IPU_Thread();
+	virtual ~IPU_Thread();
+
+	void Reset();
+
+	// Saves or loads the data of both queues, the thread must be stopped (EE thread)
+	void Freeze(SaveStateBase& state);
+
+	// Is the calling code run by the IPU thread?
+	__fi bool IsWorker() const { return s_worker; }
+	__fi bool IsBusy() const { return m_busy.load(std::memory_order_acquire); }
+
+	// Does the data go through the queues? Also set while a command started in threaded
+	// mode is still running, after the speedhack was turned off. (EE thread)
+	__fi bool IsActive() const { return THREAD_IPU || IsBusy() || FeedCount() || DrainCount(); }
+
+	// Runs the current command on the thread, or tells the running thread to carry on
+	// with it, new data or room were given to it. (EE thread)
+	void Kick();
+
+	// Waits till the thread stops, and raises the events it posted. (EE thread)
+	void Wait();
+
+	// Raises the events posted by the thread. (EE thread)
+	__fi void Poll()
+	{
+		if (m_events.load(std::memory_order_relaxed))
+			RaiseEvents();
+	}
+
+	// Posts one of the Event from the IPU thread.
+	__fi void Post(Event ev) { m_events.fetch_or(ev, std::memory_order_release); }
+
+	// Waits for the thread and keeps it stopped while the EE accesses the IPU state
+	void Hold();
+	void Release();
+
+	u32 FeedCount() const;
+	u32 DrainCount() const;
+
+	// Queues IPU1 data, returns the qwords queued (EE thread)
+	u32 Feed(const u32* data, u32 qwc);
+	// Moves the queued IPU1 data into the input FIFO, and asks for more IPU1 data once
+	// half of the feed was consumed. (IPU state owner)
+	void Refill();
+	void ClearFeed();
+
+	// Queues decoded data, returns the qwords queued (IPU state owner)
+	u32 Produce(const u32* data, u32 qwc);
+	// Takes decoded data, returns the qwords taken (EE thread)
+	u32 Consume(u128* data, u32 qwc);
+	void ClearDrain();
+
+protected:
+	void ExecuteTaskInThread();
+	void RaiseEvents();
+};
+
+// Holds the IPU thread for the scope, see IPU_Thread::Hold
+struct ScopedIPUHold
+{
+	ScopedIPUHold();
+	~ScopedIPUHold();
+};
+
+extern __aligned16 IPU_Thread ipuThread;
@@ -0,0 +1,204 @@
+/*
+ * Idct.h
+ * Copyright (C) 2000-2002 Michel Lespinasse <walken@zoy.org>
+ * Copyright (C) 1999-2000 Aaron Holtzman <aholtzma@ess.engr.uvic.ca>
+ * Modified by Florin for PCSX2 emu
+ *
+ * This file is part of mpeg2dec, a free MPEG-2 video stream decoder.
+ * See http://libmpeg2.sourceforge.net/ for updates.
+ *
+ * mpeg2dec is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * mpeg2dec is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+// The IDCT of mpeg2dec (idct.c), transforming the 8 rows or the 8 columns of a block
+// at once with SSE4.1. Every step is the integer arithmetic of the C version, so the
+// output is bit-exact with it:
+//  * BUTTERFLY (w0*d0 + w1*d1) is a pmaddwd of the interleaved coefficients
+//  * the results of the row pass are truncated to 16 bits, as stored in the block
+//  * the row shortcut (only a DC coefficient) gives the same result as the full pass
+//
+// It only depends on the common headers so that tests/ctest/ipu can check it against
+// the C version.
+
+#pragma once
+
+#include "Pcsx2Defs.h"
+
+#define W1 2841 /* 2048*sqrt (2)*cos (1*pi/16) */
+#define W2 2676 /* 2048*sqrt (2)*cos (2*pi/16) */
+#define W3 2408 /* 2048*sqrt (2)*cos (3*pi/16) */
+#define W5 1609 /* 2048*sqrt (2)*cos (5*pi/16) */
+#define W6 1108 /* 2048*sqrt (2)*cos (6*pi/16) */
+#define W7 565  /* 2048*sqrt (2)*cos (7*pi/16) */
+
+#define WPAIR(w0, w1) _mm_setr_epi16(w0, w1, w0, w1, w0, w1, w0, w1)
+
+static __fi void transpose8x8(__m128i (&v)[8])
+{
+	__m128i a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	__m128i a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	__m128i a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	__m128i a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	__m128i a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	__m128i a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	__m128i a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	__m128i a7 = _mm_unpackhi_epi16(v[6], v[7]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a2);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a2);
+	__m128i b2 = _mm_unpacklo_epi32(a1, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a1, a3);
+	__m128i b4 = _mm_unpacklo_epi32(a4, a6);
+	__m128i b5 = _mm_unpackhi_epi32(a4, a6);
+	__m128i b6 = _mm_unpacklo_epi32(a5, a7);
+	__m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// Truncates the 32 bit lanes of lo and hi to 16 bits (a s16 store of the C version)
+static __fi __m128i pack_trunc(__m128i lo, __m128i hi)
+{
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+// 1-D IDCT of 4 lanes, d02 d13 d47 d56 are the interleaved coefficient pairs
+// (d0,d2) (d1,d3) (d4,d7) (d5,d6) of them. col selects the rounding of idct_col.
+template< bool col >
+static __fi void idct_half(__m128i d02, __m128i d13, __m128i d47, __m128i d56, __m128i (&out)[8])
+{
+	const __m128i bias = _mm_set1_epi32(col ? 65536 : 128);
+	const __m128i w181 = _mm_set1_epi32(181);
+
+	__m128i t0 = _mm_add_epi32(_mm_madd_epi16(d02, WPAIR(2048,  2048)), bias);
+	__m128i t1 = _mm_add_epi32(_mm_madd_epi16(d02, WPAIR(2048, -2048)), bias);
+	__m128i t2 = _mm_madd_epi16(d13, WPAIR(W2,  W6));
+	__m128i t3 = _mm_madd_epi16(d13, WPAIR(W6, -W2));
+	__m128i a0 = _mm_add_epi32(t0, t2);
+	__m128i a1 = _mm_add_epi32(t1, t3);
+	__m128i a2 = _mm_sub_epi32(t1, t3);
+	__m128i a3 = _mm_sub_epi32(t0, t2);
+
+	t0 = _mm_madd_epi16(d47, WPAIR(W1,  W7));
+	t1 = _mm_madd_epi16(d47, WPAIR(W7, -W1));
+	t2 = _mm_madd_epi16(d56, WPAIR(W3,  W5));
+	t3 = _mm_madd_epi16(d56, WPAIR(-W5, W3));
+	__m128i b0 = _mm_add_epi32(t0, t2);
+	__m128i b3 = _mm_add_epi32(t1, t3);
+	t0 = _mm_sub_epi32(t0, t2);
+	t1 = _mm_sub_epi32(t1, t3);
+	__m128i b1, b2;
+	if (col) {
+		t0 = _mm_srai_epi32(t0, 8);
+		t1 = _mm_srai_epi32(t1, 8);
+		b1 = _mm_mullo_epi32(_mm_add_epi32(t0, t1), w181);
+		b2 = _mm_mullo_epi32(_mm_sub_epi32(t0, t1), w181);
+	}
+	else {
+		b1 = _mm_srai_epi32(_mm_mullo_epi32(_mm_add_epi32(t0, t1), w181), 8);
+		b2 = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(t0, t1), w181), 8);
+	}
+
+	const int shift = col ? 17 : 8;
+	out[0] = _mm_srai_epi32(_mm_add_epi32(a0, b0), shift);
+	out[1] = _mm_srai_epi32(_mm_add_epi32(a1, b1), shift);
+	out[2] = _mm_srai_epi32(_mm_add_epi32(a2, b2), shift);
+	out[3] = _mm_srai_epi32(_mm_add_epi32(a3, b3), shift);
+	out[4] = _mm_srai_epi32(_mm_sub_epi32(a3, b3), shift);
+	out[5] = _mm_srai_epi32(_mm_sub_epi32(a2, b2), shift);
+	out[6] = _mm_srai_epi32(_mm_sub_epi32(a1, b1), shift);
+	out[7] = _mm_srai_epi32(_mm_sub_epi32(a0, b0), shift);
+}
+
+// 1-D IDCT of the 8 lanes of v, v[i] holds the coefficients i of the rows (or columns)
+template< bool col >
+static __fi void idct_pass(__m128i (&v)[8])
+{
+	__m128i lo[8], hi[8];
+	idct_half<col>(_mm_unpacklo_epi16(v[0], v[2]), _mm_unpacklo_epi16(v[1], v[3]),
+	               _mm_unpacklo_epi16(v[4], v[7]), _mm_unpacklo_epi16(v[5], v[6]), lo);
+	idct_half<col>(_mm_unpackhi_epi16(v[0], v[2]), _mm_unpackhi_epi16(v[1], v[3]),
+	               _mm_unpackhi_epi16(v[4], v[7]), _mm_unpackhi_epi16(v[5], v[6]), hi);
+	v[0] = pack_trunc(lo[0], hi[0]);
+	v[1] = pack_trunc(lo[1], hi[1]);
+	v[2] = pack_trunc(lo[2], hi[2]);
+	v[3] = pack_trunc(lo[3], hi[3]);
+	v[4] = pack_trunc(lo[4], hi[4]);
+	v[5] = pack_trunc(lo[5], hi[5]);
+	v[6] = pack_trunc(lo[6], hi[6]);
+	v[7] = pack_trunc(lo[7], hi[7]);
+}
+
+// Transforms block into rows, and clears it
+static __fi void idct(s16 * const block, __m128i (&rows)[8])
+{
+	const __m128i zero = _mm_setzero_si128();
+	for (int i = 0; i < 8; i++) {
+		rows[i] = _mm_load_si128((__m128i*)(block + 8 * i));
+		_mm_store_si128((__m128i*)(block + 8 * i), zero);
+	}
+
+	transpose8x8(rows);
+	idct_pass<false>(rows);
+	transpose8x8(rows);
+	idct_pass<true>(rows);
+}
+
+static __fi void mpeg2_idct_copy_sse4(s16 * block, u8 * dest, const int stride)
+{
+	__m128i rows[8];
+	idct(block, rows);
+
+	// In legal streams, the IDCT output should be between -384 and +384,
+	// it is clipped to 0..255 by the unsigned saturation
+	for (int i = 0; i < 8; i++)
+		_mm_storel_epi64((__m128i*)(dest + stride * i), _mm_packus_epi16(rows[i], rows[i]));
+}
+
+
+// stride = increment for dest in 16-bit units (typically either 8 [128 bits] or 16 [256 bits]).
+static __fi void mpeg2_idct_add_sse4(const int last, s16 * block, s16 * dest, const int stride)
+{
+	// on the IPU, stride is always assured to be multiples of QWC (bottom 3 bits are 0).
+
+    if (last != 129 || (block[0] & 7) == 4)
+    {
+		__m128i rows[8];
+		idct(block, rows);
+
+		for (int i = 0; i < 8; i++)
+			_mm_store_si128((__m128i*)(dest + stride * i), rows[i]);
+    }
+    else
+    {
+		s16 DC = ((int)block[0] + 4) >> 3;
+		s16 dcf[2] = { DC, DC };
+		block[0] = block[63] = 0;
+
+		__m128 dc128 = _mm_set_ps1(*(float*)dcf);
+
+		for(int i=0; i<8; ++i)
+			_mm_store_ps((float*)(dest+(stride*i)), dc128);
+    }
+}
@@ -341,6 +341,176 @@ static __fi void SATURATE(int& val)
 		val = (val >> 31) ^ 2047;
 }
 
+// Looks the DCT code at the top of a 16-bit window up in Table B-14, or in Table B-15 when b15
+// is set.  The short codes of B-14 are looked up in first (DCT.first or DCT.next).
+// Returns NULL for the invalid codes.
+static __fi const DCTtab* get_dct_tab(u16 code, bool b15, const DCTtab* first)
+{
+	if (code >= 16384 && !b15)
+		return &first[(code >> 12) - 4];
+	else if (code >= 1024)
+		return b15 ? &DCT.tab0a[(code >> 8) - 4] : &DCT.tab0[(code >> 8) - 4];
+	else if (code >= 512)
+		return b15 ? &DCT.tab1a[(code >> 6) - 8] : &DCT.tab1[(code >> 6) - 8];
+	else if (code >= 256)
+		return &DCT.tab2[(code >> 4) - 16];
+	else if (code >= 128)
+		return &DCT.tab3[(code >> 3) - 16];
+	else if (code >= 64)
+		return &DCT.tab4[(code >> 2) - 16];
+	else if (code >= 32)
+		return &DCT.tab5[(code >> 1) - 16];
+	else if (code >= 16)
+		return &DCT.tab6[code - 16];
+
+	return NULL;
+}
+
+struct DCTmultiSet
+{
+	DCTmulti b14[1 << DCT_MULTI_BITS];
+	DCTmulti b15[1 << DCT_MULTI_BITS];
+
+	DCTmultiSet()
+	{
+		build(b14, false);
+		build(b15, true);
+	}
+
+	// Decodes all the prefixes, as far as their codes are whole in DCT_MULTI_BITS bits
+	static void build(DCTmulti* table, bool b15)
+	{
+		for (uint prefix = 0; prefix < (1 << DCT_MULTI_BITS); prefix++)
+		{
+			DCTmulti& m = table[prefix];
+			memzero(m);
+
+			uint pos = 0;
+			while (m.count < 3)
+			{
+				const uint left = DCT_MULTI_BITS - pos;
+				const u16 code = (u16)(prefix << (16 - DCT_MULTI_BITS + pos));
+				const DCTtab* t = get_dct_tab(code, b15, DCT.next);
+
+				if (!t || t->run == 65 || t->len > left)
+					break;
+
+				if (t->run == 64)
+				{
+					m.eob = 1;
+					pos += t->len;
+					break;
+				}
+
+				if (t->len + 1u > left)
+					break;
+
+				m.run[m.count] = t->run;
+				m.level[m.count] = t->level;
+				m.end[m.count] = pos + t->len;
+				if (code & (0x8000 >> t->len))
+					m.sign |= 1 << m.count;
+
+				pos += t->len + 1;
+				m.count++;
+			}
+
+			m.len = pos;
+		}
+	}
+};
+
+static const DCTmultiSet DCT_multi;
+
+// Decodes the coefficients after the first one while their codes are short and the internal
+// buffer is full, several per lookup in a 64-bit window.  Returns true at the end of the
+// block, with the index of the end in last.  Returns false when the next code is for the
+// regular path (escape, long code, or not enough data buffered for the window).
+//
+// The internal buffer is refilled where the regular path would, GETWORD before each code,
+// so that the FIFO is read at the same points.
+template <bool intra>
+static __fi bool get_coeffs_multi(int& i, int& last)
+{
+	const u8 * scan = decoder.scantype ? mpeg2_scan.alt : mpeg2_scan.norm;
+	const u8 (&quant_matrix)[64] = intra ? decoder.iq : decoder.niq;
+	const int quantizer_scale = decoder.quantizer_scale;
+	const DCTmulti* table = (intra && decoder.intra_vlc_format && !decoder.mpeg1) ? DCT_multi.b15 : DCT_multi.b14;
+	s16 * dest = decoder.DCTblock;
+
+	while (g_BP.FP == 2 && g_BP.BP < 128)
+	{
+		u64 window = PEEKBITS64();
+		uint used = 0;
+
+		do
+		{
+			const DCTmulti& m = table[window >> (64 - DCT_MULTI_BITS)];
+			const uint bp = g_BP.BP;
+
+			for (uint k = 0; k < m.count; k++)
+			{
+				i += m.run[k];
+				if (i >= 64)
+				{
+					DUMPBITS(m.end[k]);
+					if (k && bp + m.end[k - 1] + 1 >= 128)
+						GETWORD();
+					last = i;
+					return true;
+				}
+
+				int val;
+				if (intra)
+				{
+					val = (m.level[k] * quantizer_scale * quant_matrix[i]) >> 4;
+					if (decoder.mpeg1)
+					{
+						/* oddification */
+						val = (val - 1) | 1;
+					}
+				}
+				else
+				{
+					val = ((2 * m.level[k] + 1) * quantizer_scale * quant_matrix[i]) >> 5;
+				}
+
+				if (m.sign & (1 << k))
+					val = -val;
+
+				SATURATE(val);
+				dest[scan[i]] = val;
+				i++;
+			}
+
+			if (!m.count && !m.eob)
+				return false;
+
+			DUMPBITS(m.len);
+
+			if (m.eob)
+			{
+				if (m.count && bp + m.end[m.count - 1] + 1 >= 128)
+					GETWORD();
+				last = i;
+				return true;
+			}
+
+			// Crossed into the second quadword
+			if (g_BP.FP < 2)
+			{
+				GETWORD();
+				break;
+			}
+
+			used += m.len;
+			window <<= m.len;
+		} while (used <= 57 - DCT_MULTI_BITS);
+	}
+
+	return false;
+}
+
 static bool get_intra_block()
 {
 	const u8 * scan = decoder.scantype ? mpeg2_scan.alt : mpeg2_scan.norm;
@@ -348,6 +518,7 @@ static bool get_intra_block()
 	int quantizer_scale = decoder.quantizer_scale;
 	s16 * dest = decoder.DCTblock;
 	u16 code; 
+	int last;
 
 	/* decode AC coefficients */
   for (int i=1 + ipu_cmd.pos[4]; ; i++)
@@ -361,61 +532,23 @@ static bool get_intra_block()
 		  return false;
 		}
 
-		code = UBITS(16);
-
-		if (code >= 16384 && (!decoder.intra_vlc_format || decoder.mpeg1))
-		{
-		  tab = &DCT.next[(code >> 12) - 4];
-		}
-		else if (code >= 1024)
+		// The short codes go several at a time
+		if (get_coeffs_multi<true>(i, last))
 		{
-			if (decoder.intra_vlc_format && !decoder.mpeg1)
-			{
-				tab = &DCT.tab0a[(code >> 8) - 4];
-			}
-			else
-			{
-				tab = &DCT.tab0[(code >> 8) - 4];
-			}
+		  ipu_cmd.pos[4] = 0;
+		  return true;
 		}
-		else if (code >= 512)
+
+		if (!GETWORD())
 		{
-			if (decoder.intra_vlc_format && !decoder.mpeg1)
-			{
-				tab = &DCT.tab1a[(code >> 6) - 8];
-			}
-			else
-			{
-				tab = &DCT.tab1[(code >> 6) - 8];
-			}
+		  ipu_cmd.pos[4] = i - 1;
+		  return false;
 		}
 
-		// [TODO] Optimization: Following codes can all be done by a single "expedited" lookup
-		// that should use a single unrolled DCT table instead of five separate tables used
-		// here.  Multiple conditional statements are very slow, while modern CPU data caches
-		// have lots of room to spare.
+		code = UBITS(16);
 
-		else if (code >= 256)
-		{
-			tab = &DCT.tab2[(code >> 4) - 16];
-		}
-		else if (code >= 128)
-		{
-			tab = &DCT.tab3[(code >> 3) - 16];
-		}
-		else if (code >= 64)
-		{
-			tab = &DCT.tab4[(code >> 2) - 16];
-		}
-		else if (code >= 32)
-		{
-			tab = &DCT.tab5[(code >> 1) - 16];
-		}
-		else if (code >= 16)
-		{
-			tab = &DCT.tab6[code - 16];
-		}
-		else
+		tab = get_dct_tab(code, decoder.intra_vlc_format && !decoder.mpeg1, DCT.next);
+		if (!tab)
 		{
 		  ipu_cmd.pos[4] = 0;
 		  return true;
@@ -519,54 +652,23 @@ static bool get_non_intra_block(int * last)
 				return false;
 			}
 
-			code = UBITS(16);
-
-			if (code >= 16384)
+			// The short codes go several at a time, the first coefficient has its own table
+			if (i && get_coeffs_multi<false>(i, *last))
 			{
-				if (i==0)
-				{
-					tab = &DCT.first[(code >> 12) - 4];
-				}
-				else
-				{			
-					tab = &DCT.next[(code >> 12)- 4];
-				}
+				ipu_cmd.pos[4] = 0;
+				return true;
 			}
-			else if (code >= 1024)
+
+			if (!GETWORD())
 			{
-				tab = &DCT.tab0[(code >> 8) - 4];
-			}
-			else if (code >= 512)
-			{		
-				tab = &DCT.tab1[(code >> 6) - 8];
+				ipu_cmd.pos[4] = i;
+				return false;
 			}
 
-			// [TODO] Optimization: Following codes can all be done by a single "expedited" lookup
-			// that should use a single unrolled DCT table instead of five separate tables used
-			// here.  Multiple conditional statements are very slow, while modern CPU data caches
-			// have lots of room to spare.
+			code = UBITS(16);
 
-			else if (code >= 256)
-			{		
-				tab = &DCT.tab2[(code >> 4) - 16];
-			}
-			else if (code >= 128)
-			{		
-				tab = &DCT.tab3[(code >> 3) - 16];
-			}
-			else if (code >= 64)
-			{		
-				tab = &DCT.tab4[(code >> 2) - 16];
-			}
-			else if (code >= 32)
-			{		
-				tab = &DCT.tab5[(code >> 1) - 16];
-			}
-			else if (code >= 16)
-			{		
-				tab = &DCT.tab6[code - 16];
-			}
-			else
+			tab = get_dct_tab(code, false, i ? DCT.next : DCT.first);
+			if (!tab)
 			{
 				ipu_cmd.pos[4] = 0;
 				return true;
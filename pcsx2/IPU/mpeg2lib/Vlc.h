@@ -52,6 +52,16 @@ static __fi u32 GETBITS(uint num)
 	return retVal;
 }
 
+// Reads a 64-bit window of the internal buffer at the bit stream point, MSB first.  With
+// FP == 2 and BP < 128 the bytes are all buffered, and the top 57 bits at least are valid.
+static __fi u64 PEEKBITS64()
+{
+	u64 window;
+	memcpy(&window, &g_BP.internal_qwc[0]._u8[g_BP.BP / 8], sizeof(window));
+
+	return BigEndian64(window) << (g_BP.BP & 7);
+}
+
 struct MBtab {
     u8 modes;
     u8 len;
@@ -83,6 +93,20 @@ struct DCTtab {
     u8 len;
 };
 
+// The short DCT codes (sign included) found in the next DCT_MULTI_BITS bits of the stream,
+// decoded by a single lookup.  See get_coeffs_multi.
+#define DCT_MULTI_BITS 10
+
+struct DCTmulti {
+    u8 count;   // coefficients, 0 if the first code is longer or an escape
+    u8 eob;     // an end of block follows them
+    u8 len;     // bits of the coefficients and end of block
+    u8 sign;    // sign bit of each coefficient
+    u8 run[3];
+    u8 level[3];
+    u8 end[3];  // bits up to the sign bit of each coefficient
+};
+
 struct MBAtab {
     u8 mba;
     u8 len;
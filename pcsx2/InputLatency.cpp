@@ -0,0 +1,166 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Common.h"
+#include "InputLatency.h"
+#include "Counters.h"
+#include "GS.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace InputLatency
+{
+	struct Frame
+	{
+		std::atomic<u32> id{0};
+		u32 frame;
+		u64 sample;
+		u64 read;
+		u64 vsync;
+	};
+
+	// Frames between the EE vsync and the GS present, at most VsyncQueueSize plus a few are in flight
+	static const uint QueueSize = 64;
+	static Frame s_queue[QueueSize];
+
+	static std::atomic<u64> s_last_sample{0};
+
+	// EE thread
+	static u32 s_next_id = 1;
+	static u64 s_sample = 0;
+	static u64 s_read = 0;
+
+	// MTGS thread
+	struct Latency
+	{
+		float sample_to_read;
+		float read_to_vsync;
+		float vsync_to_present;
+		float total;
+	};
+	static Latency s_window[Window];
+	static uint s_window_pos = 0;
+	static uint s_window_count = 0;
+
+	static float ToMs(u64 ticks)
+	{
+		return static_cast<float>(static_cast<double>(ticks) * 1000.0 / GetTickFrequency());
+	}
+
+	void Sampled()
+	{
+		if (EmuConfig.GS.InputLatencyTrace)
+			s_last_sample.store(GetCPUTicks(), std::memory_order_relaxed);
+	}
+
+	void PadRead()
+	{
+		// Only the first poll of a frame counts, later ones read the same host state
+		if (!EmuConfig.GS.InputLatencyTrace || s_read != 0)
+			return;
+
+		s_read = GetCPUTicks();
+		s_sample = std::min(s_last_sample.load(std::memory_order_relaxed), s_read);
+	}
+
+	u32 Vsync()
+	{
+		if (!EmuConfig.GS.InputLatencyTrace || s_read == 0 || s_sample == 0)
+		{
+			s_read = 0;
+			return 0;
+		}
+
+		const u32 id = s_next_id++;
+		if (s_next_id == 0)
+			s_next_id = 1;
+
+		Frame& f = s_queue[id % QueueSize];
+		f.frame = g_FrameCount;
+		f.sample = s_sample;
+		f.read = s_read;
+		f.vsync = GetCPUTicks();
+		f.id.store(id, std::memory_order_release);
+
+		s_read = 0;
+		return id;
+	}
+
+	void Presented(u32 id)
+	{
+		if (id == 0)
+			return;
+
+		const u64 present = GetCPUTicks();
+		const Frame& f = s_queue[id % QueueSize];
+		// Overwritten while the GS was that far behind, nothing sensible to record
+		if (f.id.load(std::memory_order_acquire) != id)
+			return;
+
+		Latency& l = s_window[s_window_pos];
+		l.sample_to_read = ToMs(f.read - f.sample);
+		l.read_to_vsync = ToMs(f.vsync - f.read);
+		l.vsync_to_present = ToMs(present - f.vsync);
+		l.total = ToMs(present - f.sample);
+		s_window_pos = (s_window_pos + 1) % Window;
+		s_window_count = std::min(s_window_count + 1, Window);
+
+		if (EmuConfig.GS.InputLatencyLog)
+		{
+			Console.WriteLn("Input latency: frame %u, sample->read %.2f ms, read->vsync %.2f ms, vsync->present %.2f ms, total %.2f ms",
+				f.frame, l.sample_to_read, l.read_to_vsync, l.vsync_to_present, l.total);
+		}
+	}
+
+	void Report()
+	{
+		if (!EmuConfig.GS.InputLatencyTrace || s_window_count == 0)
+			return;
+
+		// Buckets are in frames at 60 Hz
+		static const float limits[] = {16.7f, 33.3f, 50.0f, 66.7f, 83.3f};
+		u32 buckets[countof(limits) + 1] = {};
+		float totals[Window];
+		Latency sum = {};
+
+		for (uint i = 0; i < s_window_count; i++)
+		{
+			const Latency& l = s_window[i];
+			sum.sample_to_read += l.sample_to_read;
+			sum.read_to_vsync += l.read_to_vsync;
+			sum.vsync_to_present += l.vsync_to_present;
+			totals[i] = l.total;
+
+			uint bucket = 0;
+			while (bucket < countof(limits) && l.total >= limits[bucket])
+				bucket++;
+			buckets[bucket]++;
+		}
+
+		const uint n = s_window_count;
+		std::sort(totals, totals + n);
+
+		char value[256];
+		snprintf(value, sizeof(value),
+			"p50 %.1f p95 %.1f max %.1f ms (sample->read %.1f read->vsync %.1f vsync->present %.1f) [<1f %u | <2f %u | <3f %u | <4f %u | <5f %u | more %u]",
+			totals[n / 2], totals[n * 95 / 100], totals[n - 1],
+			sum.sample_to_read / n, sum.read_to_vsync / n, sum.vsync_to_present / n,
+			buckets[0], buckets[1], buckets[2], buckets[3], buckets[4], buckets[5]);
+
+		GSosdMonitor("Input latency", value, 0xffffffff);
+	}
+} // namespace InputLatency
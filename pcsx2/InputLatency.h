@@ -0,0 +1,39 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Input to photon latency tracing, enabled by GS.InputLatencyTrace.
+//
+// Each traced frame carries four timestamps: when the host last sampled the pads (PADupdate),
+// when the game first polled a pad through the SIO, the vsync that ended that frame, and when
+// the GS returned from presenting it.  The MTGS keeps the last InputLatency::Window frames and
+// shows them as the "Input latency" OSD monitor line.
+namespace InputLatency
+{
+	static const uint Window = 256;
+
+	// Host pad state refreshed, any thread.
+	extern void Sampled();
+	// The game started a pad poll, EE thread.
+	extern void PadRead();
+	// Closes the frame at vsync, EE thread.  Returns the id the MTGS hands to Presented(),
+	// 0 if the frame isn't traced.
+	extern u32 Vsync();
+	// The GS is done presenting the frame with the given id, MTGS thread.
+	extern void Presented(u32 id);
+	// Posts the OSD monitor line, MTGS thread.
+	extern void Report();
+} // namespace InputLatency
@@ -595,6 +595,15 @@ static void intClear(u32 Addr, u32 Size)
 {
 }
 
+static bool intClearLazy(u32 Addr, u32 Size)
+{
+	return false;
+}
+
+static void intSpeculate(u64 deadline)
+{
+}
+
 static void intShutdown() {
 }
 
@@ -632,6 +641,8 @@ R5900cpu intCpu =
 	intThrowException,
 	intThrowException,
 	intClear,
+	intClearLazy,
+	intSpeculate,
 
 	intGetCacheReserve,
 	intSetCacheReserve,
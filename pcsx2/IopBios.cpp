@@ -582,6 +582,89 @@ _start:
 	}
 }
 
+namespace sysclib {
+	// The memory routines run natively when the arguments stay in the IOP RAM, and
+	// are left to the MIPS code otherwise (or when the cache is isolated).
+	static u8* ram(u32 addr, u32 size, bool write)
+	{
+		addr &= 0x1fffffff;
+		if (addr >= Ps2MemSize::IopRam || size > Ps2MemSize::IopRam - addr)
+			return NULL;
+		if (write && (psxRegs.CP0.n.Status & 0x10000))
+			return NULL;
+		return iopPhysMem(addr);
+	}
+
+	static void written(u32 addr, u32 size)
+	{
+		addr &= 0x1fffffff;
+		if (size)
+			psxCpu->Clear(addr & ~3, (((addr + size + 3) & ~3) - (addr & ~3)) >> 2);
+	}
+
+	static int copy(u32 dst, u32 src, u32 size)
+	{
+		u8* d = ram(dst, size, true);
+		const u8* s = ram(src, size, false);
+		if (!d || !s)
+			return 0;
+
+		memmove(d, s, size);
+		written(dst, size);
+		return 1;
+	}
+
+	static int fill(u32 dst, u8 value, u32 size)
+	{
+		u8* d = ram(dst, size, true);
+		if (!d)
+			return 0;
+
+		memset(d, value, size);
+		written(dst, size);
+		return 1;
+	}
+
+	int memcpy_HLE()
+	{
+		if (!copy(a0, a1, a2))
+			return 0;
+		v0 = a0;
+		pc = ra;
+		return 1;
+	}
+
+	int memmove_HLE()
+	{
+		return memcpy_HLE();
+	}
+
+	int bcopy_HLE()
+	{
+		if (!copy(a1, a0, a2))
+			return 0;
+		pc = ra;
+		return 1;
+	}
+
+	int memset_HLE()
+	{
+		if (!fill(a0, a1, a2))
+			return 0;
+		v0 = a0;
+		pc = ra;
+		return 1;
+	}
+
+	int bzero_HLE()
+	{
+		if (!fill(a0, 0, a1))
+			return 0;
+		pc = ra;
+		return 1;
+	}
+}
+
 namespace loadcore {
 	void RegisterLibraryEntries_DEBUG()
 	{
@@ -672,6 +755,17 @@ irxHLE irxImportHLE(const std::string &libname, u16 index)
 		EXPORT_H(  8, lseek)
 	END_MODULE
 
+	if (EmuConfig.Speedhacks.IopHLE)
+	{
+		MODULE(sysclib)
+			EXPORT_H( 12, memcpy)
+			EXPORT_H( 13, memmove)
+			EXPORT_H( 14, memset)
+			EXPORT_H( 16, bcopy)
+			EXPORT_H( 17, bzero)
+		END_MODULE
+	}
+
 	return 0;
 }
 
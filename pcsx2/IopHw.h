@@ -326,6 +326,7 @@ extern void PSX_INT( IopEventId n, s32 ecycle);
 
 extern void psxSetNextBranch( u32 startCycle, s32 delta );
 extern void psxSetNextBranchDelta( s32 delta );
+extern void psxSetIntsDue();
 extern int iopTestCycle( u32 startCycle, s32 delta );
 extern void _iopTestInterrupts();
 
@@ -16,11 +16,25 @@
 #include "PrecompiledHeader.h"
 #include "AsyncFileReader.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Distance the kernel is asked to read ahead of sequential reads
+static const u64 WillNeedWindow = 4 * 1024 * 1024;
+
 FlatFileReader::FlatFileReader(bool shareWrite) : shareWrite(shareWrite)
 {
 	m_blocksize = 2048;
 	m_fd = -1;
 	m_aio_context = 0;
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_mappedResult = 0;
+	m_lastReadEnd = 0;
+	m_willNeedEnd = 0;
+	m_sequentialReads = 0;
+	m_adviseSequential = false;
 }
 
 FlatFileReader::~FlatFileReader(void)
@@ -36,8 +50,83 @@ bool FlatFileReader::Open(const wxString& fileName)
 	if (err) return false;
 
     m_fd = wxOpen(fileName, O_RDONLY, 0);
+	if (m_fd == -1)
+		return false;
+
+	// Map the image when it can't be truncated under us: the page cache then serves the
+	// reads, and keeps the image cached across runs. Falls back to aio if mapping fails.
+	struct stat st;
+	if (!shareWrite && fstat(m_fd, &st) == 0 && st.st_size > 0)
+	{
+		void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, m_fd, 0);
+		if (mapping != MAP_FAILED)
+		{
+			m_mapping = (u8*)mapping;
+			m_mappingSize = st.st_size;
+		}
+	}
+
+	return true;
+}
+
+// Returns the mapped data of a read (null when it's not all in the mapping), and hints
+// the kernel: read ahead of sequential reads, and don't for the seeks.
+const u8* FlatFileReader::MapRead(u64 offset, u32 bytes)
+{
+	if (!m_mapping || offset + bytes > m_mappingSize)
+		return nullptr;
+
+	if (offset == m_lastReadEnd)
+	{
+		if (++m_sequentialReads == 2 && !m_adviseSequential)
+		{
+			madvise(m_mapping, m_mappingSize, MADV_SEQUENTIAL);
+			m_adviseSequential = true;
+		}
+	}
+	else
+	{
+		m_sequentialReads = 0;
+		m_willNeedEnd = 0;
+		if (m_adviseSequential)
+		{
+			madvise(m_mapping, m_mappingSize, MADV_NORMAL);
+			m_adviseSequential = false;
+		}
+	}
+	m_lastReadEnd = offset + bytes;
+
+	if (m_adviseSequential && m_lastReadEnd + WillNeedWindow / 2 > m_willNeedEnd)
+	{
+		const u64 page = sysconf(_SC_PAGESIZE);
+		const u64 start = std::max(m_willNeedEnd, m_lastReadEnd) / page * page;
+		const u64 end = std::min(start + WillNeedWindow, m_mappingSize);
+		if (start < end)
+			madvise(m_mapping + start, end - start, MADV_WILLNEED);
+		m_willNeedEnd = end;
+	}
 
-	return (m_fd != -1);
+	return m_mapping + offset;
+}
+
+const u8* FlatFileReader::GetMappedSectors(uint sector, uint count)
+{
+	return MapRead(sector * (s64)m_blocksize + m_dataoffset, count * m_blocksize);
+}
+
+void FlatFileReader::PrefetchHint(uint sector, uint count)
+{
+	const u64 page = sysconf(_SC_PAGESIZE);
+	const u64 offset = (sector * (s64)m_blocksize + m_dataoffset) / page * page;
+	const u64 end = sector * (s64)m_blocksize + m_dataoffset + (u64)count * m_blocksize;
+
+	if (m_mapping)
+	{
+		if (offset < m_mappingSize)
+			madvise(m_mapping + offset, std::min(end, m_mappingSize) - offset, MADV_WILLNEED);
+	}
+	else
+		posix_fadvise(m_fd, offset, end - offset, POSIX_FADV_WILLNEED);
 }
 
 int FlatFileReader::ReadSync(void* pBuffer, uint sector, uint count)
@@ -53,6 +142,21 @@ void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 
 	u32 bytesToRead = count * m_blocksize;
 
+	if (m_mapping)
+	{
+		// Up to the end of the image
+		if (offset < m_mappingSize)
+			bytesToRead = std::min<u64>(bytesToRead, m_mappingSize - offset);
+		else
+			bytesToRead = 0;
+
+		const u8* src = MapRead(offset, bytesToRead);
+		if (src)
+			memcpy(pBuffer, src, bytesToRead);
+		m_mappedResult = src ? bytesToRead : -1;
+		return;
+	}
+
 	struct iocb iocb;
 	struct iocb* iocbs = &iocb;
 
@@ -62,6 +166,9 @@ void FlatFileReader::BeginRead(void* pBuffer, uint sector, uint count)
 
 int FlatFileReader::FinishRead(void)
 {
+	if (m_mapping)
+		return m_mappedResult;
+
 	int min_nr = 1;
 	int max_nr = 1;
 	struct io_event events[max_nr];
@@ -84,6 +191,14 @@ void FlatFileReader::CancelRead(void)
 
 void FlatFileReader::Close(void)
 {
+	if (m_mapping)
+		munmap(m_mapping, m_mappingSize);
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_lastReadEnd = 0;
+	m_willNeedEnd = 0;
+	m_sequentialReads = 0;
+	m_adviseSequential = false;
 
 	if (m_fd != -1) close(m_fd);
 
@@ -20,8 +20,12 @@
 #include <wx/datetime.h>
 
 #include "GS.h"
+#include "Counters.h"
 #include "Gif_Unit.h"
 #include "MTVU.h"
+#include "InputLatency.h"
+#include "Timeline.h"
+#include "SPU2/spu2.h"
 #include "Elfheader.h"
 #include "App.h"
 #include "gui/Dialogs/ModalPopups.h"
@@ -51,6 +55,8 @@ using namespace Threading;
 // =====================================================================================================
 
 __aligned(32) MTGS_BufferedData RingBuffer;
+uint RingBufferSize = 0;
+uint RingBufferMask = 0;
 extern bool renderswitch;
 std::atomic_bool init_gspanel = true;
 
@@ -123,10 +129,63 @@ void SysMtgsThread::OnStart()
 	m_SignalRingPosition = 0;
 
 	m_CopyDataTally = 0;
+	m_CopyDataTicks = 0;
+
+	for (auto& count : m_StallCount)
+		count = 0;
+	m_StallTime = 0;
+	m_StallReportFrame = 0;
+	m_VsyncWaitTime = 0;
+	m_IdleTime = 0;
+	m_VsyncPostSeq = 0;
+	m_PresentTail = 0;
+	m_LastVblank = 0;
+
+	AllocRingBuffer();
 
 	_parent::OnStart();
 }
 
+// The ring is reserved at its largest size once, from the host memory map, and only the
+// pages of the configured size are committed.
+void SysMtgsThread::AllocRingBuffer()
+{
+	// Can't return regions to the bump allocator
+	static u128* reserve = nullptr;
+	static uint committed = 0;
+
+	const uint factor = std::min(std::max((uint)EmuConfig.GS.RingBufferSizeFactor, RingBufferSizeFactorMin), RingBufferSizeFactorMax);
+	const uint size = 1u << factor;
+
+	if (!reserve)
+		reserve = (u128*)GetVmMemory().BumpAllocator().Alloc(sizeof(u128) << RingBufferSizeFactorMax);
+
+	if (!reserve)
+		throw Exception::OutOfMemory(L"MTGS Ring Buffer");
+
+	if (size > committed)
+	{
+		if (!HostSys::MmapCommitPtr(reserve + committed, (size - committed) * sizeof(u128), PageProtectionMode().Read().Write()))
+		{
+			throw Exception::OutOfMemory(L"MTGS Ring Buffer")
+				.SetDiagMsg(pxsFmt("(%u megs)", (uint)(size * sizeof(u128) / _1mb)));
+		}
+	}
+	else if (size < committed)
+	{
+		HostSys::MmapResetPtr(reserve + size, (committed - size) * sizeof(u128));
+	}
+
+	if (size != committed)
+		DevCon.WriteLn("MTGS: %u MB ring buffer", (uint)(size * sizeof(u128) / _1mb));
+
+	committed = size;
+
+	RingBuffer.m_Ring = reserve;
+	RingBufferSize = size;
+	RingBufferMask = size - 1;
+}
+
 SysMtgsThread::~SysMtgsThread()
 {
 	try
@@ -160,6 +219,21 @@ void SysMtgsThread::ResetGS()
 	SetEvent();
 }
 
+union PacketTagType
+{
+	struct
+	{
+		u32 command;
+		u32 data[3];
+	};
+	struct
+	{
+		u32 _command;
+		u32 _data[1];
+		uptr pointer;
+	};
+};
+
 struct RingCmdPacket_Vsync
 {
 	u8 regset1[0x0f0];
@@ -168,7 +242,7 @@ struct RingCmdPacket_Vsync
 	GSRegSIGBLID siglblid;
 };
 
-void SysMtgsThread::PostVsyncStart()
+void SysMtgsThread::PostVsyncStart(bool present, bool output)
 {
 	// Optimization note: Typically regset1 isn't needed.  The regs in that area are typically
 	// changed infrequently, usually during video mode changes.  However, on modern systems the
@@ -177,6 +251,12 @@ void SysMtgsThread::PostVsyncStart()
 
 	uint packsize = sizeof(RingCmdPacket_Vsync) / 16;
 	PrepDataPacket(GS_RINGTYPE_VSYNC, packsize);
+	// 1: hidden run-ahead frame, 2: frame without any output in the max throughput mode,
+	// above: the m_VsyncPostTicks slot of the vsync
+	const uint slot = m_VsyncPostSeq++ % VsyncPostSlots;
+	m_VsyncPostTicks[slot] = GetCPUTicks();
+	((PacketTagType&)RingBuffer[m_packet_startpos]).data[1] = !present | (!output << 1) | (slot << 2);
+	((PacketTagType&)RingBuffer[m_packet_startpos]).data[2] = InputLatency::Vsync();
 	MemCopy_WrappedDest((u128*)PS2MEM_GS, RingBuffer.m_Ring, m_packet_writepos, RingBufferSize, 0xf);
 
 	u32* remainder = (u32*)GetDataPacketPtr();
@@ -214,24 +294,11 @@ void SysMtgsThread::PostVsyncStart()
 	// So let's ensure the ring doesn't sleep
 	m_sem_event.Post();
 
+	const u64 start = GetCPUTicks();
 	m_sem_Vsync.WaitNoCancel();
+	m_VsyncWaitTime.fetch_add((GetCPUTicks() - start) * 1000000 / GetTickFrequency(), std::memory_order_relaxed);
 }
 
-union PacketTagType
-{
-	struct
-	{
-		u32 command;
-		u32 data[3];
-	};
-	struct
-	{
-		u32 _command;
-		u32 _data[1];
-		uptr pointer;
-	};
-};
-
 static void dummyIrqCallback()
 {
 	// dummy, because MTGS doesn't need this mess!
@@ -311,6 +378,9 @@ void SysMtgsThread::ExecuteTaskInThread()
 
 	RingBufferLock busy(*this);
 
+	if (EmuConfig.Speedhacks.threadPinning)
+		Threading::ApplyThreadAffinity(Threading::ThreadRole_GS);
+
 	while (true)
 	{
 		busy.Release();
@@ -319,10 +389,14 @@ void SysMtgsThread::ExecuteTaskInThread()
 		// is very optimized (only 1 instruction test in most cases), so no point in trying
 		// to avoid it.
 
+		const u64 idle_start = GetCPUTicks();
 		m_sem_event.WaitWithoutYield();
 		StateCheckInThread();
+		m_IdleTime += (GetCPUTicks() - idle_start) * 1000000 / GetTickFrequency();
 		busy.Acquire();
 
+		TIMELINE_SCOPE("MTGS packets");
+
 		// note: m_ReadPos is intentionally not volatile, because it should only
 		// ever be modified by this thread.
 		while (m_ReadPos.load(std::memory_order_relaxed) != m_WritePos.load(std::memory_order_acquire))
@@ -444,7 +518,12 @@ void SysMtgsThread::ExecuteTaskInThread()
 					vu1Thread.KickStart(true);
 					busy.PartialRelease();
 					// Wait for MTVU to complete vu1 program
-					vu1Thread.semaXGkick.WaitWithoutYield();
+					const u64 xgkick = GetCPUTicks();
+					{
+						TIMELINE_SCOPE("MTGS xgkick wait");
+						vu1Thread.semaXGkick.WaitWithoutYield();
+					}
+					vu1Thread.RecordWait(VU_Thread::WaitXGkick, xgkick);
 					busy.PartialAcquire();
 					Gif_Path& path = gifUnit.gifPath[GIF_PATH_1];
 					GS_Packet gsPack = path.GetGSPacketMTVU(); // Get vu1 program's xgkick packet(s)
@@ -464,7 +543,7 @@ void SysMtgsThread::ExecuteTaskInThread()
 							const int qsize = tag.data[0];
 							ringposinc += qsize;
 
-							MTGS_LOG("(MTGS Packet Read) ringtype=Vsync, field=%u, skip=%s", !!(((u32&)RingBuffer.Regs[0x1000]) & 0x2000) ? 0 : 1, tag.data[1] ? "true" : "false");
+							MTGS_LOG("(MTGS Packet Read) ringtype=Vsync, field=%u, skip=%s", !!(((u32&)RingBuffer.Regs[0x1000]) & 0x2000) ? 0 : 1, (tag.data[1] & 3) ? "true" : "false");
 
 							// Mail in the important GS registers.
 							// This seemingly obtuse system is needed in order to handle cases where the vsync data wraps
@@ -479,13 +558,30 @@ void SysMtgsThread::ExecuteTaskInThread()
 							((GSRegSIGBLID&)RingBuffer.Regs[0x1080]) = (GSRegSIGBLID&)remainder[2];
 
 							// CSR & 0x2000; is the pageflip id.
-							GSvsync(((u32&)RingBuffer.Regs[0x1000]) & 0x2000);
+							GSsetOutputSkip(tag.data[1] & 2);
+							{
+								TIMELINE_SCOPE("GS vsync");
+								GSvsync(((u32&)RingBuffer.Regs[0x1000]) & 0x2000, !(tag.data[1] & 3));
+							}
+							RecordPresent(tag.data[1]);
 							gsFrameSkip();
+							InputLatency::Presented(tag.data[2]);
 
 							m_QueuedFrameCount.fetch_sub(1);
 							if (m_VsyncSignalListener.exchange(false))
 								m_sem_Vsync.Post();
 
+							if ((++m_StallReportFrame & 0x1f) == 0)
+							{
+								ReportStalls();
+								ReportPackets();
+								SPU2reportLatency();
+								InputLatency::Report();
+								frameLimitReportPacing();
+								if (THREAD_VU1)
+									vu1Thread.ReportWaits();
+							}
+
 							// Do not StateCheckInThread() here
 							// Otherwise we could pause while there's still data in the queue
 							// Which could make the MTVU thread wait forever for it to empty
@@ -624,6 +720,31 @@ void SysMtgsThread::OnCleanupInThread()
 	_parent::OnCleanupInThread();
 }
 
+// Spins with a pause based backoff until done() is true or the SpinWaitBudget runs out.
+// Most waits on the MTGS end within microseconds, a kernel wait costs more than that.
+template <typename F>
+static bool SpinWaitFor(F done)
+{
+	const int budget = EmuConfig.GS.SpinWaitBudget;
+
+	if (budget <= 0)
+		return false;
+
+	const u64 end = GetCPUTicks() + GetTickFrequency() * budget / 1000000;
+
+	for (uint pauses = 1;; pauses = std::min(pauses * 2, 64u))
+	{
+		if (done())
+			return true;
+
+		for (uint i = 0; i < pauses; i++)
+			Threading::SpinWait();
+
+		if (GetCPUTicks() >= end)
+			return done();
+	}
+}
+
 // Waits for the GS to empty out the entire ring buffer contents.
 // If syncRegs, then writes pcsx2's gs regs to MTGS's internal copy
 // If weakWait, then this function is allowed to exit after MTGS finished a path1 packet
@@ -647,7 +768,13 @@ void SysMtgsThread::WaitGS(bool syncRegs, bool weakWait, bool isMTVU)
 	{
 		SetEvent();
 		RethrowException();
-		for (;;)
+
+		// The ring position alone only tells a full wait when it's done
+		const bool spun = !isMTVU && !weakWait && SpinWaitFor([&] {
+			return m_ReadPos.load(std::memory_order_acquire) == m_WritePos.load(std::memory_order_relaxed);
+		});
+
+		while (!spun)
 		{
 			if (weakWait)
 				m_mtx_RingBufferBusy2.Wait();
@@ -686,6 +813,82 @@ void SysMtgsThread::SetEvent()
 	m_CopyDataTally = 0;
 }
 
+void SysMtgsThread::RecordStall(u64 start)
+{
+	const u64 us = (GetCPUTicks() - start) * 1000000 / GetTickFrequency();
+
+	uint bucket = 0;
+	for (u64 limit = 10; bucket < StallBuckets - 1 && us >= limit; limit *= 10)
+		bucket++;
+
+	m_StallCount[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_StallTime.fetch_add(us, std::memory_order_relaxed);
+}
+
+void SysMtgsThread::RecordPresent(u32 flags)
+{
+	if (flags & 3)
+		return;
+
+	const u64 now = GetCPUTicks();
+	const u64 present = GSgetPresentTicks();
+	const u64 ready = now - present;
+
+	const s64 tail = (s64)(ready - m_VsyncPostTicks[flags >> 2]) * 1000000 / (s64)GetTickFrequency();
+	if (tail >= 0)
+	{
+		const u32 avg = m_PresentTail.load(std::memory_order_relaxed);
+		m_PresentTail.store(avg + ((s32)tail - (s32)avg) / 8, std::memory_order_relaxed);
+	}
+
+	// A flip that had to wait for a while returned at the display vblank, the others say
+	// nothing about it
+	if (EmuConfig.GS.VsyncEnable != VsyncMode::Off && present > GetTickFrequency() / 2000)
+		m_LastVblank.store(now, std::memory_order_relaxed);
+}
+
+// Stalls since the ring was allocated, to help pick the ring size of a game.
+void SysMtgsThread::ReportStalls()
+{
+	u32 count[StallBuckets];
+	u32 total = 0;
+
+	for (uint i = 0; i < StallBuckets; i++)
+		total += count[i] = m_StallCount[i].load(std::memory_order_relaxed);
+
+	char value[128];
+	snprintf(value, sizeof(value), "%u MB, %u stalls %.1f ms [<10us %u | <100us %u | <1ms %u | <10ms %u | more %u]",
+		(uint)(RingBufferSize * sizeof(u128) / _1mb), total, m_StallTime.load(std::memory_order_relaxed) / 1000.0,
+		count[0], count[1], count[2], count[3], count[4]);
+
+	GSosdMonitor("MTGS ring", value, 0xffffffff);
+}
+
+// Shows how many GS packets the gif unit merged since the last report
+void SysMtgsThread::ReportPackets()
+{
+	u32 in = gifUnit.coalesce.packetsIn.exchange(0, std::memory_order_relaxed);
+	u32 out = gifUnit.coalesce.packetsOut.exchange(0, std::memory_order_relaxed);
+
+	char value[64];
+	snprintf(value, sizeof(value), "%u -> %u packets", in, out);
+
+	GSosdMonitor("GIF merge", value, 0xffffffff);
+}
+
+// Signals the MTGS once enough data is queued, or once the oldest unsignalled packet has
+// waited for EventLatency.
+void SysMtgsThread::SetEventBatched(uint qwc)
+{
+	if (m_CopyDataTally == 0)
+		m_CopyDataTicks = GetCPUTicks();
+
+	m_CopyDataTally += qwc;
+
+	if (m_CopyDataTally > 0x2000 || GetCPUTicks() - m_CopyDataTicks > GetTickFrequency() * EmuConfig.GS.EventLatency / 1000000)
+		SetEvent();
+}
+
 u8* SysMtgsThread::GetDataPacketPtr() const
 {
 	return (u8*)&RingBuffer[m_packet_writepos & RingBufferMask];
@@ -712,9 +915,7 @@ void SysMtgsThread::SendDataPacket()
 	}
 	else if (!m_RingBufferIsBusy.load(std::memory_order_relaxed))
 	{
-		m_CopyDataTally += m_packet_size;
-		if (m_CopyDataTally > 0x2000)
-			SetEvent();
+		SetEventBatched(m_packet_size);
 	}
 
 	m_packet_size = 0;
@@ -748,6 +949,8 @@ void SysMtgsThread::GenericStall(uint size)
 
 	if (freeroom <= size)
 	{
+		const u64 start = GetCPUTicks();
+
 		// writepos will overlap readpos if we commit the data, so we need to wait until
 		// readpos is out past the end of the future write pos, or until it wraps around
 		// (in which case writepos will be >= readpos).
@@ -760,12 +963,33 @@ void SysMtgsThread::GenericStall(uint size)
 		if (somedone < size + 1)
 			somedone = size + 1;
 
+		auto HasRoom = [&] {
+			readpos = m_ReadPos.load(std::memory_order_acquire);
+
+			if (writepos < readpos)
+				freeroom = readpos - writepos;
+			else
+				freeroom = RingBufferSize - (writepos - readpos);
+
+			return freeroom > size;
+		};
+
 		// FMV Optimization: FMVs typically send *very* little data to the GS, in some cases
 		// every other frame is nothing more than a page swap.  Sleeping the EEcore is a
 		// waste of time, and we get better results using a spinwait.
 
 		if (somedone > 0x80)
 		{
+			// The GS is usually only a few packets behind, give it a chance to make room
+			// before sleeping on the ring reset signal.
+			SetEvent();
+
+			if (SpinWaitFor(HasRoom))
+			{
+				RecordStall(start);
+				return;
+			}
+
 			pxAssertDev(m_SignalRingEnable == 0, "MTGS Thread Synchronization Error");
 			m_SignalRingPosition.store(somedone, std::memory_order_release);
 
@@ -776,15 +1000,9 @@ void SysMtgsThread::GenericStall(uint size)
 				m_SignalRingEnable.store(true, std::memory_order_release);
 				SetEvent();
 				m_sem_OnRingReset.WaitWithoutYield();
-				readpos = m_ReadPos.load(std::memory_order_acquire);
 				//Console.WriteLn( Color_Blue, "(EEcore Awake) Report!\tringpos=0x%06x", readpos );
 
-				if (writepos < readpos)
-					freeroom = readpos - writepos;
-				else
-					freeroom = RingBufferSize - (writepos - readpos);
-
-				if (freeroom > size)
+				if (HasRoom())
 					break;
 			}
 
@@ -794,20 +1012,11 @@ void SysMtgsThread::GenericStall(uint size)
 		{
 			//Console.WriteLn( Color_StrongGray, "(EEcore Spin) PrepDataPacket!" );
 			SetEvent();
-			while (true)
-			{
+			while (!HasRoom())
 				SpinWait();
-				readpos = m_ReadPos.load(std::memory_order_acquire);
-
-				if (writepos < readpos)
-					freeroom = readpos - writepos;
-				else
-					freeroom = RingBufferSize - (writepos - readpos);
-
-				if (freeroom > size)
-					break;
-			}
 		}
+
+		RecordStall(start);
 	}
 }
 
@@ -848,8 +1057,8 @@ __fi void SysMtgsThread::_FinishSimplePacket()
 
 	if (EmuConfig.GS.SynchronousMTGS)
 		WaitGS();
-	else
-		++m_CopyDataTally;
+	else if (m_CopyDataTally++ == 0)
+		m_CopyDataTicks = GetCPUTicks();
 }
 
 void SysMtgsThread::SendSimplePacket(MTGS_RingCommand type, int data0, int data1, int data2)
@@ -875,9 +1084,7 @@ void SysMtgsThread::SendSimpleGSPacket(MTGS_RingCommand type, u32 offset, u32 si
 	{
 		if (!m_RingBufferIsBusy.load(std::memory_order_relaxed))
 		{
-			m_CopyDataTally += size / 16;
-			if (m_CopyDataTally > 0x2000)
-				SetEvent();
+			SetEventBatched(size / 16);
 		}
 	}
 }
@@ -18,15 +18,71 @@
 #include "MTVU.h"
 #include "newVif.h"
 #include "Gif_Unit.h"
+#include "Timeline.h"
 
 __aligned16 VU_Thread vu1Thread(CpuVU1, VU1);
+__aligned16 VU0_Thread vu0Thread;
 
 #define MTVU_ALWAYS_KICK 0
 #define MTVU_SYNC_MODE 0
 
+// Spins until done() or the budget runs out.  The budget halves after a spin that ran out,
+// and grows back up to GS.SpinWaitBudget after one that didn't, so that a wait which keeps
+// ending up in the kernel stops spinning first.
+class MTVU_SpinPolicy
+{
+	u64 m_budget = 0; // in ticks
+
+public:
+	template <typename F>
+	bool Wait(F done)
+	{
+		const u64 cap = GetTickFrequency() * std::max(EmuConfig.GS.SpinWaitBudget, 0) / 1000000;
+
+		if (cap == 0)
+			return false;
+
+		if (m_budget == 0 || m_budget > cap)
+			m_budget = cap;
+
+		const u64 start = GetCPUTicks();
+
+		for (uint pauses = 1;; pauses = std::min(pauses * 2, 64u))
+		{
+			if (done())
+			{
+				m_budget = std::min(m_budget * 2, cap);
+				return true;
+			}
+
+			for (uint i = 0; i < pauses; i++)
+				Threading::SpinWait();
+
+			if (GetCPUTicks() - start >= m_budget)
+				break;
+		}
+
+		if (done())
+			return true;
+
+		m_budget = std::max<u64>(m_budget / 2, std::max<u64>(cap / 16, 1));
+		return false;
+	}
+};
+
+static MTVU_SpinPolicy s_eeSpin; // EE thread
+static MTVU_SpinPolicy s_vuSpin; // VU thread
+static MTVU_SpinPolicy s_vu0Spin; // EE thread, waiting for VU0
+
 // Rounds up a size in bytes for size in u32's
 static __fi u32 size_u32(u32 x) { return (x + 3) >> 2; }
 
+// Size of a MTVU_VIF_UNPACK packet in front of its data (in u32's)
+static __fi u32 unpackHeaderSize(const vifStruct& _vif)
+{
+	return 1 + size_u32((uptr)&_vif.StructEnd - (uptr)&_vif.tag) + size_u32(sizeof(VIFregistersMTVU)) + 1;
+}
+
 enum MTVU_EVENT
 {
 	MTVU_VU_EXECUTE,     // Execute VU program
@@ -103,6 +159,8 @@ void VU_Thread::Reset()
 {
 	ScopedLock lock(mtxBusy);
 
+	SpillVifUnpack();
+
 	vuCycleIdx = 0;
 	isBusy = false;
 	m_ato_write_pos = 0;
@@ -114,10 +172,54 @@ void VU_Thread::Reset()
 	for (size_t i = 0; i < 4; ++i)
 		vu1Thread.vuCycles[i] = 0;
 	vu1Thread.mtvuInterrupts = 0;
+
+	for (uint i = 0; i < WaitTypes; i++)
+	{
+		for (auto& count : waitCount[i])
+			count = 0;
+		waitTime[i] = 0;
+	}
+}
+
+void VU_Thread::RecordWait(WaitType type, u64 start)
+{
+	const u64 us = (GetCPUTicks() - start) * 1000000 / GetTickFrequency();
+
+	uint bucket = 0;
+	for (u64 limit = 10; bucket < WaitBuckets - 1 && us >= limit; limit *= 10)
+		bucket++;
+
+	waitCount[type][bucket].fetch_add(1, std::memory_order_relaxed);
+	waitTime[type].fetch_add(us, std::memory_order_relaxed);
+}
+
+// Called by the MTGS thread with its own stalls
+void VU_Thread::ReportWaits()
+{
+	static const char* names[WaitTypes] = {"MTVU EE wait", "MTVU idle", "MTVU xgkick"};
+
+	for (uint type = 0; type < WaitTypes; type++)
+	{
+		u32 count[WaitBuckets];
+		u32 total = 0;
+
+		for (uint i = 0; i < WaitBuckets; i++)
+			total += count[i] = waitCount[type][i].load(std::memory_order_relaxed);
+
+		char value[128];
+		snprintf(value, sizeof(value), "%u waits %.1f ms [<10us %u | <100us %u | <1ms %u | <10ms %u | more %u]",
+			total, waitTime[type].load(std::memory_order_relaxed) / 1000.0,
+			count[0], count[1], count[2], count[3], count[4]);
+
+		GSosdMonitor(names[type], value, 0xffffffff);
+	}
 }
 
 void VU_Thread::ExecuteTaskInThread()
 {
+	if (EmuConfig.Speedhacks.threadPinning)
+		Threading::ApplyThreadAffinity(Threading::ThreadRole_VU);
+
 	PCSX2_PAGEFAULT_PROTECT
 	{
 		ExecuteRingBuffer();
@@ -127,70 +229,82 @@ void VU_Thread::ExecuteTaskInThread()
 
 void VU_Thread::ExecuteRingBuffer()
 {
+	u64 idle = GetCPUTicks();
 	for (;;)
 	{
 		semaEvent.WaitWithoutYield();
+		RecordWait(WaitIdle, idle);
 		ScopedLockBool lock(mtxBusy, isBusy);
-		while (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
+		for (;;)
 		{
-			u32 tag = Read();
-			switch (tag)
+			while (m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos())
 			{
-				case MTVU_VU_EXECUTE:
-				{
-					vuRegs.cycle = 0;
-					s32 addr = Read();
-					vifRegs.top = Read();
-					vifRegs.itop = Read();
-
-					if (addr != -1)
-						vuRegs.VI[REG_TPC].UL = addr & 0x7FF;
-					vuCPU->SetStartPC(vuRegs.VI[REG_TPC].UL << 3);
-					vuCPU->Execute(vu1RunCycles);
-					gifUnit.gifPath[GIF_PATH_1].FinishGSPacketMTVU();
-					semaXGkick.Post(); // Tell MTGS a path1 packet is complete
-					vuCycles[vuCycleIdx].store(vuRegs.cycle, std::memory_order_release);
-					vuCycleIdx = (vuCycleIdx + 1) & 3;
-					break;
-				}
-				case MTVU_VU_WRITE_MICRO:
-				{
-					u32 vu_micro_addr = Read();
-					u32 size = Read();
-					vuCPU->Clear(vu_micro_addr, size);
-					Read(&vuRegs.Micro[vu_micro_addr], size);
-					break;
-				}
-				case MTVU_VU_WRITE_DATA:
+				u32 tag = Read();
+				switch (tag)
 				{
-					u32 vu_data_addr = Read();
-					u32 size = Read();
-					Read(&vuRegs.Mem[vu_data_addr], size);
-					break;
+					case MTVU_VU_EXECUTE:
+					{
+						TIMELINE_SCOPE("VU1 program");
+						vuRegs.cycle = 0;
+						s32 addr = Read();
+						vifRegs.top = Read();
+						vifRegs.itop = Read();
+
+						if (addr != -1)
+							vuRegs.VI[REG_TPC].UL = addr & 0x7FF;
+						vuCPU->SetStartPC(vuRegs.VI[REG_TPC].UL << 3);
+						vuCPU->Execute(vu1RunCycles);
+						gifUnit.gifPath[GIF_PATH_1].FinishGSPacketMTVU();
+						semaXGkick.Post(); // Tell MTGS a path1 packet is complete
+						vuCycles[vuCycleIdx].store(vuRegs.cycle, std::memory_order_release);
+						vuCycleIdx = (vuCycleIdx + 1) & 3;
+						break;
+					}
+					case MTVU_VU_WRITE_MICRO:
+					{
+						u32 vu_micro_addr = Read();
+						u32 size = Read();
+						vuCPU->Clear(vu_micro_addr, size);
+						Read(&vuRegs.Micro[vu_micro_addr], size);
+						break;
+					}
+					case MTVU_VU_WRITE_DATA:
+					{
+						u32 vu_data_addr = Read();
+						u32 size = Read();
+						Read(&vuRegs.Mem[vu_data_addr], size);
+						break;
+					}
+					case MTVU_VIF_WRITE_COL:
+						Read(&vif.MaskCol, sizeof(vif.MaskCol));
+						break;
+					case MTVU_VIF_WRITE_ROW:
+						Read(&vif.MaskRow, sizeof(vif.MaskRow));
+						break;
+					case MTVU_VIF_UNPACK:
+					{
+						u32 vif_copy_size = (uptr)&vif.StructEnd - (uptr)&vif.tag;
+						Read(&vif.tag, vif_copy_size);
+						ReadRegs(&vifRegs);
+						u32 size = Read();
+						MTVU_Unpack(&buffer[m_read_pos], vifRegs);
+						m_read_pos += size_u32(size);
+						break;
+					}
+					case MTVU_NULL_PACKET:
+						m_read_pos = 0;
+						break;
+						jNO_DEFAULT;
 				}
-				case MTVU_VIF_WRITE_COL:
-					Read(&vif.MaskCol, sizeof(vif.MaskCol));
-					break;
-				case MTVU_VIF_WRITE_ROW:
-					Read(&vif.MaskRow, sizeof(vif.MaskRow));
-					break;
-				case MTVU_VIF_UNPACK:
-				{
-					u32 vif_copy_size = (uptr)&vif.StructEnd - (uptr)&vif.tag;
-					Read(&vif.tag, vif_copy_size);
-					ReadRegs(&vifRegs);
-					u32 size = Read();
-					MTVU_Unpack(&buffer[m_read_pos], vifRegs);
-					m_read_pos += size_u32(size);
-					break;
-				}
-				case MTVU_NULL_PACKET:
-					m_read_pos = 0;
-					break;
-					jNO_DEFAULT;
+
+				CommitReadPos();
 			}
 
-			CommitReadPos();
+			// The EE is usually not far behind, spin for its next packet before sleeping again
+			idle = GetCPUTicks();
+			if (!s_vuSpin.Wait([&] { return m_ato_read_pos.load(std::memory_order_relaxed) != GetWritePos(); }))
+				break;
+			RecordWait(WaitIdle, idle);
 		}
 	}
 }
@@ -199,19 +313,27 @@ void VU_Thread::ExecuteRingBuffer()
 // Should only be called by ReserveSpace()
 __ri void VU_Thread::WaitOnSize(s32 size)
 {
-	for (;;)
-	{
+	auto HasRoom = [&] {
 		s32 readPos = GetReadPos();
 		if (readPos <= m_write_pos)
-			break; // MTVU is reading in back of write_pos
+			return true; // MTVU is reading in back of write_pos
 		// FIXME greg: there is a bug somewhere in the queue pointer
 		// management. It creates a deadlock/corruption in SotC intro (before
 		// the first menu). I added a 4KB safety net which seem to avoid to
 		// trigger the bug.
 		// Note: a wait lock instead of a yield also helps to avoid the bug.
-		if (readPos > m_write_pos + size + _4kb)
-			break; // Enough free front space
-		{          // Let MTVU run to free up buffer space
+		return readPos > m_write_pos + size + _4kb; // Enough free front space
+	};
+
+	if (HasRoom())
+		return;
+
+	const u64 start = GetCPUTicks();
+	KickStart();
+	if (!s_eeSpin.Wait(HasRoom))
+	{
+		while (!HasRoom())
+		{ // Let MTVU run to free up buffer space
 			KickStart();
 			// Locking might trigger a full flush of the ring buffer. Yield
 			// will be more aggressive, and only flush the minimal size.
@@ -220,12 +342,15 @@ __ri void VU_Thread::WaitOnSize(s32 size)
 			std::this_thread::yield();
 		}
 	}
+	RecordWait(WaitEE, start);
 }
 
 // Makes sure theres enough room in the ring buffer
 // to write a continuous 'size * sizeof(u32)' bytes
 void VU_Thread::ReserveSpace(s32 size)
 {
+	SpillVifUnpack();
+
 	pxAssert(m_write_pos < buffer_size);
 	pxAssert(size < buffer_size);
 	pxAssert(size > 0);
@@ -423,16 +548,25 @@ bool VU_Thread::IsDone()
 void VU_Thread::WaitVU()
 {
 	MTVU_LOG("MTVU - WaitVU!");
-	for (;;)
+	if (IsDone())
+		return;
+
+	const u64 start = GetCPUTicks();
+	KickStart();
+	if (!s_eeSpin.Wait([&] { return IsDone(); }))
 	{
-		if (IsDone())
-			break;
-		//DevCon.WriteLn("WaitVU()");
-		//pxAssert(THREAD_VU1);
-		KickStart();
-		std::this_thread::yield(); // Give a chance to the MTVU thread to actually start
-		ScopedLock lock(mtxBusy);
+		for (;;)
+		{
+			if (IsDone())
+				break;
+			//DevCon.WriteLn("WaitVU()");
+			//pxAssert(THREAD_VU1);
+			KickStart();
+			std::this_thread::yield(); // Give a chance to the MTVU thread to actually start
+			ScopedLock lock(mtxBusy);
+		}
 	}
+	RecordWait(WaitEE, start);
 }
 
 void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
@@ -449,7 +583,8 @@ void VU_Thread::ExecuteVU(u32 vu_addr, u32 vif_top, u32 vif_itop)
 	KickStart();
 	u32 cycles = std::min(Get_vuCycles(), 3000u);
 	cpuRegs.cycle += cycles * EmuConfig.Speedhacks.EECycleSkip;
-	VU0.cycle += cycles * EmuConfig.Speedhacks.EECycleSkip;
+	if (!THREAD_VU0)
+		VU0.cycle += cycles * EmuConfig.Speedhacks.EECycleSkip;
 	Get_MTVUChanges();
 }
 
@@ -457,7 +592,7 @@ void VU_Thread::VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32
 {
 	MTVU_LOG("MTVU - VifUnpack!");
 	u32 vif_copy_size = (uptr)&_vif.StructEnd - (uptr)&_vif.tag;
-	ReserveSpace(1 + size_u32(vif_copy_size) + size_u32(sizeof(VIFregistersMTVU)) + 1 + size_u32(size));
+	ReserveSpace(unpackHeaderSize(_vif) + size_u32(size));
 	Write(MTVU_VIF_UNPACK);
 	Write(&_vif.tag, vif_copy_size);
 	WriteRegs(&_vifRegs);
@@ -467,6 +602,39 @@ void VU_Thread::VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32
 	KickStart();
 }
 
+u8* VU_Thread::BeginVifUnpack(u32 size, u8* spill, const u32* filled)
+{
+	MTVU_LOG("MTVU - BeginVifUnpack!");
+	const u32 header = unpackHeaderSize(vif1);
+	ReserveSpace(header + size_u32(size));
+	m_unpack_ptr    = (u8*)(GetWritePtr() + header);
+	m_unpack_spill  = spill;
+	m_unpack_filled = filled;
+	return m_unpack_ptr;
+}
+
+void VU_Thread::EndVifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u32 size)
+{
+	MTVU_LOG("MTVU - EndVifUnpack!");
+	pxAssert(m_unpack_ptr == (u8*)(GetWritePtr() + unpackHeaderSize(_vif)));
+	m_unpack_ptr = NULL;
+	Write(MTVU_VIF_UNPACK);
+	Write(&_vif.tag, (uptr)&_vif.StructEnd - (uptr)&_vif.tag);
+	WriteRegs(&_vifRegs);
+	Write(size);
+	m_write_pos += size_u32(size); // The data is already there
+	CommitWritePos();
+	KickStart();
+}
+
+void VU_Thread::SpillVifUnpack()
+{
+	if (!m_unpack_ptr)
+		return;
+	memcpy(m_unpack_spill, m_unpack_ptr, *m_unpack_filled);
+	m_unpack_ptr = NULL;
+}
+
 void VU_Thread::WriteMicroMem(u32 vu_micro_addr, void* data, u32 size)
 {
 	MTVU_LOG("MTVU - WriteMicroMem!");
@@ -510,3 +678,121 @@ void VU_Thread::WriteRow(vifStruct& _vif)
 	CommitWritePos();
 	KickStart();
 }
+
+// --------------------------------------------------------------------------------------
+//  VU0_Thread
+// --------------------------------------------------------------------------------------
+VU0_Thread::VU0_Thread()
+{
+	m_name = L"VU0";
+	Reset();
+}
+
+VU0_Thread::~VU0_Thread()
+{
+	try
+	{
+		pxThread::Cancel();
+	}
+	DESTRUCTOR_CATCHALL
+}
+
+void VU0_Thread::Reset()
+{
+	ScopedLock lock(mtxBusy);
+
+	isBusy = false;
+	isRunning = false;
+	vpuStat = 0;
+}
+
+void VU0_Thread::ExecuteTaskInThread()
+{
+	if (EmuConfig.Speedhacks.threadPinning)
+		Threading::ApplyThreadAffinity(Threading::ThreadRole_VU);
+
+	PCSX2_PAGEFAULT_PROTECT
+	{
+		for (;;)
+		{
+			semaEvent.WaitWithoutYield();
+			ScopedLock lock(mtxBusy);
+
+			// Runs until the E-bit, the EE's VPU_STAT keeps the program going meanwhile
+			while (vpuStat & 1)
+				CpuVU0->Execute(0x7fffffff);
+
+			isBusy.store(false, std::memory_order_release);
+		}
+	}
+	PCSX2_PAGEFAULT_EXCEPT;
+}
+
+void VU0_Thread::ExecuteVU()
+{
+	pxAssert(!isBusy.load(std::memory_order_relaxed));
+
+	vpuStat = VU0.VI[REG_VPU_STAT].UL & 0xff;
+	isRunning = true;
+	isBusy.store(true, std::memory_order_release);
+	semaEvent.Post();
+}
+
+bool VU0_Thread::IsDone()
+{
+	return !isBusy.load(std::memory_order_acquire);
+}
+
+void VU0_Thread::WaitVU()
+{
+	if (IsDone())
+		return;
+
+	if (!s_vu0Spin.Wait([&] { return IsDone(); }))
+	{
+		while (!IsDone())
+		{
+			// The program may be reading VU1's registers, see mVUwaitMTVU
+			if (THREAD_VU1)
+				vu1Thread.KickStart();
+			std::this_thread::yield();
+			ScopedLock lock(mtxBusy);
+		}
+	}
+}
+
+bool VU0_Thread::Sync(bool wait)
+{
+	if (!isRunning)
+	{
+		if (!THREAD_VU0 || !(VU0.VI[REG_VPU_STAT].UL & 1))
+			return true;
+		ExecuteVU();
+	}
+
+	return Finish(wait);
+}
+
+bool VU0_Thread::Finish(bool wait)
+{
+	if (!isRunning)
+		return true;
+
+	if (!IsDone())
+	{
+		if (!wait)
+			return false;
+		WaitVU();
+	}
+
+	isRunning = false;
+	VU0.VI[REG_VPU_STAT].UL = (VU0.VI[REG_VPU_STAT].UL & ~0xff) | (vpuStat & 0xff);
+
+	if (VU0.flags & VUFLAG_INTCINTERRUPT)
+	{
+		VU0.flags &= ~VUFLAG_INTCINTERRUPT;
+		hwIntcIrq(6);
+	}
+
+	return true;
+}
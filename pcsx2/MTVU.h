@@ -37,14 +37,19 @@ class VU_Thread : public pxThread {
 	__aligned(64) int  m_read_pos; // temporary read pos (local to the VU thread)
 	int  m_write_pos; // temporary write pos (local to the EE thread)
 	Mutex     mtxBusy;
-	Semaphore semaEvent;
+	LightweightSemaphore semaEvent;
 	BaseVUmicroCPU*& vuCPU;
 	VURegs&          vuRegs;
 
+	// Data of a partial vif unpack being gathered in the ring (EE thread)
+	u8*        m_unpack_ptr;    // Reserved in front of write_pos, NULL if none
+	u8*        m_unpack_spill;  // Where it goes back if something else is written to the ring
+	const u32* m_unpack_filled; // How much of it was written
+
 public:
 	__aligned16  vifStruct        vif;
 	__aligned16  VIFregisters     vifRegs;
-	Semaphore semaXGkick;
+	LightweightSemaphore semaXGkick;
 	std::atomic<unsigned int> vuCycles[4]; // Used for VU cycle stealing hack
 	u32 vuCycleIdx;  // Used for VU cycle stealing hack
 
@@ -60,6 +65,18 @@ public:
 	std::atomic<u64> gsLabel; // Used for GS Label command
 	std::atomic<u64> gsSignal; // Used for GS Signal command
 
+	// Waits of the EE on the ring (full or WaitVU), of VU1 for packets and of the MTGS for
+	// xgkicks, by duration: <10us, <100us, <1ms, <10ms and longer.  Shown in the GS OSD.
+	enum WaitType {
+		WaitEE,
+		WaitIdle,
+		WaitXGkick,
+		WaitTypes
+	};
+	static const uint WaitBuckets = 5;
+	std::atomic<u32> waitCount[WaitTypes][WaitBuckets];
+	std::atomic<u64> waitTime[WaitTypes]; // in microseconds
+
 	VU_Thread(BaseVUmicroCPU*& _vuCPU, VURegs& _vuRegs);
 	virtual ~VU_Thread();
 
@@ -80,6 +97,15 @@ public:
 
 	void VifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u8* data, u32 size);
 
+	// Lets a vif unpack split over several transfers write them straight into the ring
+	// instead of spill (size is the most it will write). Anything else written to the
+	// ring before EndVifUnpack moves the *filled bytes written so far to spill, and
+	// GetVifUnpackPtr returns NULL from then on.
+	u8*  BeginVifUnpack(u32 size, u8* spill, const u32* filled);
+	u8*  GetVifUnpackPtr() const { return m_unpack_ptr; }
+	void EndVifUnpack(vifStruct& _vif, VIFregisters& _vifRegs, u32 size);
+	void SpillVifUnpack();
+
 	// Writes to VU's Micro Memory (size in bytes)
 	void WriteMicroMem(u32 vu_micro_addr, void* data, u32 size);
 
@@ -90,6 +116,9 @@ public:
 
 	void WriteRow(vifStruct& _vif);
 
+	void RecordWait(WaitType type, u64 start);
+	void ReportWaits();
+
 protected:
 	void ExecuteTaskInThread();
 
@@ -119,3 +148,45 @@ private:
 };
 
 extern __aligned16 VU_Thread vu1Thread;
+
+// Runs the VU0 micro programs on their own thread (THREAD_VU0, microVU0 only).
+// The EE keeps the VU0 bits of VPU_STAT as they were at the start of the program until
+// it syncs with the thread, and the program writes its own to vpuStat meanwhile.
+// The EE only waits for the program at the interlocked COP2 transfers, the COP2 macro
+// ops, the next VCALLMS/MSCAL and resets; anything else picks up its results at the
+// first event test that finds it done.
+class VU0_Thread : public pxThread {
+	__aligned(64) std::atomic<bool> isBusy; // Is a program running? Set by the EE, cleared by the VU0 thread
+	__aligned(64) bool isRunning;           // Has a program been started and not synced yet? (EE thread)
+	Mutex     mtxBusy;
+	LightweightSemaphore semaEvent;
+
+public:
+	u32 vpuStat; // VPU_STAT of the running program, see mVUvpuStat
+
+	VU0_Thread();
+	virtual ~VU0_Thread();
+
+	void Reset();
+
+	// Starts VU0 at its start_pc, VPU_STAT and VU0.cycle have been set up by the EE
+	void ExecuteVU();
+
+	bool IsDone();
+
+	// Waits till the running program ends, without syncing its results
+	void WaitVU();
+
+	// Copies the results of an ended program back to VPU_STAT and raises its
+	// interrupts. Waits for it when wait is set, returns whether it had ended.
+	bool Finish(bool wait);
+
+	// Same as Finish, but first hands a program the EE started (before the thread
+	// took over, after a settings change or a state load) to the thread.
+	bool Sync(bool wait);
+
+protected:
+	void ExecuteTaskInThread();
+};
+
+extern __aligned16 VU0_Thread vu0Thread;
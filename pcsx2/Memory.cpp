@@ -36,6 +36,7 @@ BIOS
 
 #include "PrecompiledHeader.h"
 #include <wx/file.h>
+#include <atomic>
 
 #include "IopCommon.h"
 #include "GS.h"
@@ -719,8 +720,29 @@ void eeMemoryReserve::Reserve(VirtualMemoryManagerPtr allocator)
 
 void eeMemoryReserve::Commit()
 {
+	if (IsCommitted()) return;
 	_parent::Commit();
 	eeMem = (EEVM_MemoryAllocMess*)m_reserve.GetPtr();
+
+	// Back the EE memory with shared memory, so the vtlb can alias its pages into the
+	// fastmem window.  Without it the recompiler keeps using the vtlb lookups.
+	const size_t size = (sizeof(*eeMem) + __pagesize - 1) & ~(size_t)(__pagesize - 1);
+	const sptr shm = HostSys::CreateSharedMemory("pcsx2_eemem", size);
+	if (shm < 0)
+		return;
+
+	if (!HostSys::MapSharedMemory(shm, 0, eeMem, size, PageAccess_ReadWrite()))
+	{
+		HostSys::DestroySharedMemory(shm);
+		return;
+	}
+
+	// The view replaced the committed pages and their hint, shared memory only gets
+	// transparent huge pages when the host allows them for shmem
+	if (EmuConfig.UseHugePages)
+		HostSys::HintHugePages(eeMem, size);
+
+	vtlb_Fastmem_Bind(shm, eeMem, size);
 }
 
 // Resets memory mappings, unmaps TLBs, reloads bios roms, etc.
@@ -731,6 +753,10 @@ void eeMemoryReserve::Reset()
 		mmap_faultHandler = new mmap_PageFaultHandler();
 	}
 	
+	// The memory is reset with the default protection
+	mmap_StopDirtyTracking();
+	mmap_StopCopyOnWrite();
+
 	_parent::Reset();
 
 	// Note!!  Ideally the vtlb should only be initialized once, and then subsequent
@@ -854,6 +880,9 @@ void eeMemoryReserve::Reset()
 
 void eeMemoryReserve::Decommit()
 {
+	mmap_StopDirtyTracking();
+	mmap_StopCopyOnWrite();
+	vtlb_Fastmem_Unbind();
 	_parent::Decommit();
 	eeMem = NULL;
 }
@@ -905,6 +934,66 @@ struct vtlb_PageProtectionInfo
 
 static __aligned16 vtlb_PageProtectionInfo m_PageProtectInfo[Ps2MemSize::MainRam >> 12];
 
+// Dirty page tracking (incremental savestates): while it's on, the pages that weren't written
+// since it started are write protected as well.  The first write to one faults, marks it dirty
+// and unprotects it -- or invalidates its blocks as usual when the block checking has it
+// protected too.
+static bool m_DirtyTracking = false;
+static bool m_PageDirty[Ps2MemSize::MainRam >> 12];
+
+// Copy on write snapshots (background savestates): the whole EE memory is write protected, and
+// each page is copied to the snapshot by whichever comes first of the thread completing the
+// snapshot and the first write to the page.  Pages stay protected after their copy, until they
+// are written.
+enum CowPageState : u8
+{
+	CowPage_Copied = 0,
+	CowPage_Pending,
+	CowPage_Copying,
+};
+
+static u8* m_CowSnapshot = NULL;
+static std::atomic<u8> m_CowState[Ps2MemSize::MainRam >> 12];
+static bool m_CowProtected[Ps2MemSize::MainRam >> 12];
+
+// Copies the page to the snapshot, or waits for the thread copying it.
+static void mmap_CowCopyPage( uint page )
+{
+	u8 state = CowPage_Pending;
+	if (m_CowState[page].compare_exchange_strong(state, CowPage_Copying, std::memory_order_acquire))
+	{
+		memcpy(&m_CowSnapshot[page<<12], &eeMem->Main[page<<12], __pagesize);
+		m_CowState[page].store(CowPage_Copied, std::memory_order_release);
+		return;
+	}
+
+	while (m_CowState[page].load(std::memory_order_acquire) != CowPage_Copied)
+		Threading::SpinWait();
+}
+
+// Sets the access of the pages that are neither dirty nor write protected for block checking or
+// a copy on write, in runs of consecutive pages.
+static void mmap_SetCleanPagesAccess( const PageProtectionMode& mode )
+{
+	const uint pages = Ps2MemSize::MainRam >> 12;
+
+	for (uint page = 0; page < pages;)
+	{
+		if (m_PageDirty[page] || m_PageProtectInfo[page].Mode == ProtMode_Write || m_CowProtected[page])
+		{
+			page++;
+			continue;
+		}
+
+		uint end = page + 1;
+		while (end < pages && !m_PageDirty[end] && m_PageProtectInfo[end].Mode != ProtMode_Write && !m_CowProtected[end])
+			end++;
+
+		HostSys::MemProtect( &eeMem->Main[page<<12], (end - page) * __pagesize, mode );
+		page = end;
+	}
+}
+
 
 // returns:
 //  ProtMode_NotRequired - unchecked block (resides in ROM, thus is integrity is constant)
@@ -969,6 +1058,14 @@ static __fi void mmap_ClearCpuBlock( uint offset )
 		"Attempted to clear a block that is already under manual protection." );
 
 	HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+
+	// The blocks check their code when next run instead, and protect the page again.
+	if (EmuConfig.Cpu.Recompiler.LazySmcEE && Cpu->ClearLazy( m_PageProtectInfo[rampage].ReverseRamMap, 0x400 ))
+	{
+		m_PageProtectInfo[rampage].Mode = ProtMode_None;
+		return;
+	}
+
 	m_PageProtectInfo[rampage].Mode = ProtMode_Manual;
 	Cpu->Clear( m_PageProtectInfo[rampage].ReverseRamMap, 0x400 );
 }
@@ -981,6 +1078,33 @@ void mmap_PageFaultHandler::OnPageFaultEvent( const PageFaultInfo& info, bool& h
 	uptr offset = info.addr - (uptr)eeMem->Main;
 	if( offset >= Ps2MemSize::MainRam ) return;
 
+	const uint rampage = offset >> 12;
+	if( m_CowProtected[rampage] )
+	{
+		mmap_CowCopyPage( rampage );
+		m_CowProtected[rampage] = false;
+
+		// ... unless it's protected for the dirty tracking or the block checking too
+		if( !(m_DirtyTracking && !m_PageDirty[rampage]) && m_PageProtectInfo[rampage].Mode != ProtMode_Write )
+		{
+			HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+			handled = true;
+			return;
+		}
+	}
+
+	if( m_DirtyTracking && !m_PageDirty[rampage] )
+	{
+		m_PageDirty[rampage] = true;
+
+		if( m_PageProtectInfo[rampage].Mode != ProtMode_Write )
+		{
+			HostSys::MemProtect( &eeMem->Main[rampage<<12], __pagesize, PageAccess_ReadWrite() );
+			handled = true;
+			return;
+		}
+	}
+
 	mmap_ClearCpuBlock( offset );
 	handled = true;
 }
@@ -994,4 +1118,90 @@ void mmap_ResetBlockTracking()
 	//DbgCon.WriteLn( "vtlb/mmap: Block Tracking reset..." );
 	memzero( m_PageProtectInfo );
 	if (eeMem) HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadWrite() );
+
+	// ... but the pages not written since the dirty tracking started stay protected
+	if (eeMem && m_DirtyTracking) mmap_SetCleanPagesAccess( PageAccess_ReadOnly() );
+
+	// ... and so do the pages not written since a copy on write started
+	if (eeMem)
+	{
+		for (uint page = 0; page < (Ps2MemSize::MainRam >> 12); page++)
+			if (m_CowProtected[page]) HostSys::MemProtect( &eeMem->Main[page<<12], __pagesize, PageAccess_ReadOnly() );
+	}
+}
+
+// Starts tracking the pages of the EE memory written from now on.  dirty_pages are counted
+// as already written.
+void mmap_StartDirtyTracking( const u32* dirty_pages, uint count )
+{
+	pxAssert( eeMem );
+
+	// Unprotects the pages clean for a previous tracking first, since
+	// the fault handler only expects clean pages to be protected for it
+	memzero( m_PageDirty );
+	mmap_SetCleanPagesAccess( PageAccess_ReadWrite() );
+
+	for (uint i = 0; i < count; i++)
+		m_PageDirty[dirty_pages[i]] = true;
+
+	m_DirtyTracking = true;
+	mmap_SetCleanPagesAccess( PageAccess_ReadOnly() );
+}
+
+void mmap_StopDirtyTracking()
+{
+	if (!m_DirtyTracking) return;
+
+	m_DirtyTracking = false;
+	if (eeMem) mmap_SetCleanPagesAccess( PageAccess_ReadWrite() );
+}
+
+// Returns false if the tracking isn't on (it stops when the memory is reset).
+bool mmap_GetDirtyPages( std::vector<u32>& pages )
+{
+	pages.clear();
+	if (!m_DirtyTracking) return false;
+
+	for (u32 page = 0; page < (Ps2MemSize::MainRam >> 12); page++)
+		if (m_PageDirty[page]) pages.push_back(page);
+
+	return true;
+}
+
+// Starts a snapshot of the EE memory to snapshot, which the VM may write to as soon as it
+// resumes.  Call with the VM paused, and complete it with mmap_FinishCopyOnWrite before
+// reading snapshot.
+void mmap_StartCopyOnWrite( u8* snapshot )
+{
+	pxAssert( eeMem );
+
+	mmap_FinishCopyOnWrite();
+
+	m_CowSnapshot = snapshot;
+	for (auto& state : m_CowState)
+		state.store(CowPage_Pending, std::memory_order_relaxed);
+	memset( m_CowProtected, true, sizeof(m_CowProtected) );
+
+	HostSys::MemProtect( eeMem->Main, Ps2MemSize::MainRam, PageAccess_ReadOnly() );
+}
+
+// Copies the pages not copied yet by their first write.  Safe while the VM runs.
+void mmap_FinishCopyOnWrite()
+{
+	if (!m_CowSnapshot) return;
+
+	for (uint page = 0; page < (Ps2MemSize::MainRam >> 12); page++)
+		mmap_CowCopyPage(page);
+
+	m_CowSnapshot = NULL;
+}
+
+// Completes the snapshot, and forgets the protection of the pages not written since.  Only
+// for when the memory is reset or decommitted, which drops the protection anyway.
+void mmap_StopCopyOnWrite()
+{
+	if (!eeMem) return;
+
+	mmap_FinishCopyOnWrite();
+	memzero( m_CowProtected );
 }
@@ -128,6 +128,14 @@ extern vtlb_ProtectionMode mmap_GetRamPageInfo( u32 paddr );
 extern void mmap_MarkCountedRamPage( u32 paddr );
 extern void mmap_ResetBlockTracking();
 
+extern void mmap_StartDirtyTracking( const u32* dirty_pages = NULL, uint count = 0 );
+extern void mmap_StopDirtyTracking();
+extern bool mmap_GetDirtyPages( std::vector<u32>& pages );
+
+extern void mmap_StartCopyOnWrite( u8* snapshot );
+extern void mmap_FinishCopyOnWrite();
+extern void mmap_StopCopyOnWrite();
+
 #define memRead8 vtlb_memRead<mem8_t>
 #define memRead16 vtlb_memRead<mem16_t>
 #define memRead32 vtlb_memRead<mem32_t>
@@ -28,6 +28,7 @@
  **/
 void Device::DoRumble(unsigned type, unsigned pad)
 {
+	std::lock_guard<std::mutex> lock(device_manager->devices_mutex);
 	int index = uid_to_index(pad);
 	if (index >= 0)
 		device_manager->devices[index]->Rumble(type, pad);
@@ -30,28 +30,123 @@ InputDeviceManager::InputDeviceManager()
 
 InputDeviceManager::~InputDeviceManager()
 {
-	device_manager->devices.clear();
+	StopInputThread();
+	devices.clear();
 }
 
-// Needs to be moved to individual device code, as does the keyboard input.
-void PollForJoystickInput(int cpad)
+void PadStateBuffer::Publish(const std::array<s32, MAX_KEYS>& values)
 {
-	int index = Device::uid_to_index(cpad);
-	if (index < 0)
+	const u32 index = m_latest.load(std::memory_order_relaxed) ^ 1;
+	Slot& slot = m_slots[index];
+
+	const u32 seq = slot.seq.load(std::memory_order_relaxed);
+	slot.seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (u32 i = 0; i < MAX_KEYS; i++)
+		slot.values[i].store(values[i], std::memory_order_relaxed);
+
+	slot.seq.store(seq + 2, std::memory_order_release);
+	m_latest.store(index, std::memory_order_release);
+}
+
+void PadStateBuffer::Read(std::array<s32, MAX_KEYS>& values) const
+{
+	for (;;)
+	{
+		const Slot& slot = m_slots[m_latest.load(std::memory_order_acquire)];
+
+		const u32 seq = slot.seq.load(std::memory_order_acquire);
+		if (seq & 1)
+			continue;
+
+		for (u32 i = 0; i < MAX_KEYS; i++)
+			values[i] = slot.values[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.seq.load(std::memory_order_relaxed) == seq)
+			return;
+	}
+}
+
+void InputDeviceManager::StartInputThread()
+{
+#ifdef SDL_BUILD
+	if (m_input_thread_running)
 		return;
 
-	auto& gamePad = device_manager->devices[index];
+	PublishState();
+	m_input_thread_running = true;
+	m_input_thread = std::thread(&InputDeviceManager::InputThread, this);
+#endif
+}
 
-	gamePad->UpdateDeviceState();
+void InputDeviceManager::StopInputThread()
+{
+	if (!m_input_thread_running)
+		return;
+
+	m_input_thread_running = false;
+#ifdef SDL_BUILD
+	JoystickInfo::WakeEventWait();
+#endif
+	m_input_thread.join();
+}
+
+void InputDeviceManager::InputThread()
+{
+#ifdef SDL_BUILD
+	while (m_input_thread_running)
+	{
+		// Wakes up on any joystick event, the timeout only covers devices that don't generate events
+		if (JoystickInfo::WaitForEvents(100))
+			EnumerateDevices();
+
+		PublishState();
+	}
+#endif
+}
+
+void InputDeviceManager::PublishState()
+{
+	std::array<s32, MAX_KEYS> values;
+	std::lock_guard<std::mutex> lock(devices_mutex);
+
+	for (u32 cpad = 0; cpad < GAMEPAD_NUMBER; cpad++)
+	{
+		values.fill(0);
+
+		int index = Device::uid_to_index(cpad);
+		if (index >= 0)
+		{
+			auto& gamePad = devices[index];
+
+			gamePad->UpdateDeviceState();
+
+			for (u32 i = 0; i < MAX_KEYS; i++)
+				values[i] = gamePad->GetInput((gamePadValues)i);
+		}
+
+		m_pad_state[cpad].Publish(values);
+	}
+}
+
+void InputDeviceManager::CommitJoystickState(u32 cpad)
+{
+	std::array<s32, MAX_KEYS> values;
+	m_pad_state[cpad].Read(values);
+
+	g_key_status.joystick_state_acces(cpad);
 
 	for (u32 i = 0; i < MAX_KEYS; i++)
 	{
-		s32 value = gamePad->GetInput((gamePadValues)i);
-		if (value != 0)
-			g_key_status.press(cpad, i, value);
+		if (values[i] != 0)
+			g_key_status.press(cpad, i, values[i]);
 		else
 			g_key_status.release(cpad, i);
 	}
+
+	g_key_status.commit_status(cpad);
 }
 
 void InputDeviceManager::Update()
@@ -64,15 +159,9 @@ void InputDeviceManager::Update()
 	}
 	UpdateKeyboardInput();
 
-	// Get joystick state + Commit
+	// Joystick state comes from the input thread
 	for (u32 cpad = 0; cpad < GAMEPAD_NUMBER; cpad++)
-	{
-		g_key_status.joystick_state_acces(cpad);
-
-		PollForJoystickInput(cpad);
-
-		g_key_status.commit_status(cpad);
-	}
+		CommitJoystickState(cpad);
 
 	Pad::rumble_all();
 }
@@ -83,6 +172,7 @@ void InputDeviceManager::Update()
 void EnumerateDevices()
 {
 #ifdef SDL_BUILD
+	std::lock_guard<std::mutex> lock(device_manager->devices_mutex);
 	JoystickInfo::EnumerateJoysticks(device_manager->devices);
 #endif
 }
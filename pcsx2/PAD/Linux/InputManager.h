@@ -15,11 +15,38 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Global.h"
 
 class Device;
 
+/*
+ * Latest joystick values of a pad, written by the input thread and read by the emulation thread without locking.
+ * The writer alternates between two slots, and a reader retries if the writer came back to its slot while copying it.
+ */
+class PadStateBuffer
+{
+public:
+	void Publish(const std::array<s32, MAX_KEYS>& values);
+	void Read(std::array<s32, MAX_KEYS>& values) const;
+
+private:
+	struct Slot
+	{
+		std::atomic<u32> seq{0}; // odd while being written
+		std::array<std::atomic<s32>, MAX_KEYS> values{};
+	};
+
+	Slot m_slots[2];
+	std::atomic<u32> m_latest{0};
+};
+
 class InputDeviceManager
 {
 public:
@@ -27,7 +54,28 @@ public:
 	~InputDeviceManager();
 	void Update();
 
+	/*
+     * The input thread waits for joystick events and publishes the pad states as they change
+     */
+	void StartInputThread();
+	void StopInputThread();
+
+	/*
+     * Applies the latest joystick state of the pad, so a poll sees input that arrived since the last vsync
+     */
+	void CommitJoystickState(u32 cpad);
+
 	std::vector<std::unique_ptr<Device>> devices;
+	// Held by whoever uses or replaces devices while the input thread runs
+	std::mutex devices_mutex;
+
+private:
+	void InputThread();
+	void PublishState();
+
+	std::thread m_input_thread;
+	std::atomic<bool> m_input_thread_running{false};
+	PadStateBuffer m_pad_state[GAMEPAD_NUMBER];
 };
 
 extern std::unique_ptr<InputDeviceManager> device_manager;
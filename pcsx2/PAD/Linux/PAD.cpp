@@ -118,6 +118,7 @@ s32 PADopen(void* pDsp)
 
 #if defined(__unix__) || defined(__APPLE__)
 	EnumerateDevices();
+	device_manager->StartInputThread();
 #endif
 	return _PADopen(pDsp);
 }
@@ -231,6 +232,10 @@ s32 PADfreeze(FreezeAction mode, freezeData* data)
 
 u8 PADstartPoll(int pad)
 {
+#if defined(__unix__) || defined(__APPLE__)
+	if (pad >= 1 && pad <= (int)GAMEPAD_NUMBER)
+		device_manager->CommitJoystickState(pad - 1);
+#endif
 	return pad_start_poll(pad);
 }
 
@@ -242,22 +247,6 @@ u8 PADpoll(u8 value)
 // PADkeyEvent is called every vsync (return NULL if no event)
 keyEvent* PADkeyEvent()
 {
-#ifdef SDL_BUILD
-	// Take the opportunity to handle hot plugging here
-	SDL_Event events;
-	while (SDL_PollEvent(&events))
-	{
-		switch (events.type)
-		{
-			case SDL_CONTROLLERDEVICEADDED:
-			case SDL_CONTROLLERDEVICEREMOVED:
-				EnumerateDevices();
-				break;
-			default:
-				break;
-		}
-	}
-#endif
 #ifdef __unix__
 	if (g_ev_fifo.size() == 0)
 	{
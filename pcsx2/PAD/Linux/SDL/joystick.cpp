@@ -73,6 +73,44 @@ void JoystickInfo::EnumerateJoysticks(std::vector<std::unique_ptr<Device>>& vjoy
 	}
 }
 
+bool JoystickInfo::WaitForEvents(int timeoutMs)
+{
+	bool hotplug = false;
+	SDL_Event events;
+
+	// SDL failed to initialize, don't let the caller spin
+	if (!SDL_WasInit(SDL_INIT_EVENTS))
+	{
+		SDL_Delay(timeoutMs);
+		return false;
+	}
+
+	if (!SDL_WaitEventTimeout(&events, timeoutMs))
+		return false;
+
+	do
+	{
+		switch (events.type)
+		{
+			case SDL_CONTROLLERDEVICEADDED:
+			case SDL_CONTROLLERDEVICEREMOVED:
+				hotplug = true;
+				break;
+			default:
+				break;
+		}
+	} while (SDL_PollEvent(&events));
+
+	return hotplug;
+}
+
+void JoystickInfo::WakeEventWait()
+{
+	SDL_Event event = {};
+	event.type = SDL_USEREVENT;
+	SDL_PushEvent(&event);
+}
+
 void JoystickInfo::Rumble(unsigned type, unsigned pad)
 {
 	if (type >= m_effects_id.size())
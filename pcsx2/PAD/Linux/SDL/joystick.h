@@ -37,6 +37,11 @@ public:
 	// opens handles to all possible joysticks
 	static void EnumerateJoysticks(std::vector<std::unique_ptr<Device>>& vjoysticks);
 
+	// blocks until SDL has events or timeoutMs passes, returns true if a controller was added or removed
+	static bool WaitForEvents(int timeoutMs);
+	// makes a pending WaitForEvents return
+	static void WakeEventWait();
+
 	void Rumble(unsigned type, unsigned pad) override;
 
 	bool TestForce(float) override;
@@ -54,6 +54,7 @@ s32 _PADopen(void* pDsp)
 
 void _PADclose()
 {
+	device_manager->StopInputThread();
 	device_manager->devices.clear();
 }
 
@@ -29,13 +29,17 @@
 #include <wx/wfstream.h>
 #include <PathDefs.h>
 
-// This is a declaration for PatchMemory.cpp::_ApplyPatch where we're (patch.cpp)
-// the only consumer, so it's not made public via Patch.h
-// Applies a single patch line to emulation memory regardless of its "place" value.
-extern void _ApplyPatch(IniPatch* p);
+// These are declarations for PatchMemory.cpp::_CompilePatches and _ApplyCompiledPatches where
+// we're (patch.cpp) the only consumer, so they're not made public via Patch.h
+// Decodes the loaded patch lines into per place tables, which keep pointers into patches.
+extern void _CompilePatches(std::vector<IniPatch>& patches);
+// Applies the compiled patch lines with a specific place value to emulation memory.
+extern void _ApplyCompiledPatches(patch_place_type place);
 
 
 std::vector<IniPatch> Patch;
+// cleared whenever Patch changes, so the next ApplyLoadedPatches compiles it again
+static bool s_patchesCompiled = false;
 
 wxString strgametitle;
 
@@ -167,6 +171,7 @@ void inifile_process(wxTextFile& f1)
 void ForgetLoadedPatches()
 {
 	Patch.clear();
+	s_patchesCompiled = false;
 }
 
 static int _LoadPatchFiles(const wxDirName& folderName, wxString& fileSpec, const wxString& friendlyName, int& numberFoundPatchFiles)
@@ -340,6 +345,7 @@ namespace PatchFunc
 
 			iPatch.enabled = 1; // omg success!!
 			Patch.push_back(iPatch);
+			s_patchesCompiled = false;
 		}
 		catch (wxString& exmsg)
 		{
@@ -353,9 +359,10 @@ namespace PatchFunc
 // This is for applying patches directly to memory
 void ApplyLoadedPatches(patch_place_type place)
 {
-	for (auto& i : Patch)
+	if (!s_patchesCompiled)
 	{
-		if (i.placetopatch == place)
-			_ApplyPatch(&i);
+		_CompilePatches(Patch);
+		s_patchesCompiled = true;
 	}
+	_ApplyCompiledPatches(place);
 }
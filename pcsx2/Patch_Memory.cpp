@@ -383,91 +383,310 @@ void handle_extended_t(IniPatch *p)
 	}
 }
 
+namespace
+{
+	// A loaded patch line decoded once, so applying it every vsync doesn't go through the
+	// type and code switches again.
+	struct CompiledPatch
+	{
+		enum Op : u8
+		{
+			Op_Write,
+			Op_Inc,
+			Op_Dec,
+			Op_Or,
+			Op_And,
+			Op_Xor,
+			// set SkipCount to skip when the memory compares like so to value
+			Op_SkipIfNe,
+			Op_SkipIfEq,
+			Op_SkipIfGe,
+			Op_SkipIfLe,
+			// only consumes a SkipCount, like unknown codes do
+			Op_Nop,
+			// multi line codes, left to handle_extended_t
+			Op_Extended,
+		};
+
+		Op op;
+		u8 size; // in bytes
+		u8 skip;
+		bool iop;
+		bool extended; // honours the SkipCount of a previous conditional
+		u32 addr;
+		u64 value;
+		IniPatch* source;
+	};
+} // namespace
+
+static std::vector<CompiledPatch> s_compiledPatches[_PPT_END_MARKER];
+
+// Codes which set up PrevCheatType for the lines that follow them.  Those can't be decoded on
+// their own, so if a patch set contains any, all its extended codes go through handle_extended_t.
+static bool IsMultiLineCode(const IniPatch& p)
+{
+	const u32 top = p.addr >> 28;
+	return (p.addr & 0xFFFF0000) == 0x30400000 || (p.addr & 0xFFFF0000) == 0x30500000 || top == 4 || top == 5 || top == 6;
+}
+
+// Mirrors the decoding in the default case of handle_extended_t
+static void CompileExtended(const IniPatch& p, CompiledPatch& c)
+{
+	const u32 top = p.addr >> 28;
+	const u32 data = (u32)p.data;
+	c.op = CompiledPatch::Op_Nop;
+
+	if (top <= 2) // 0aaaaaaa 000000vv, 1aaaaaaa 0000vvvv, 2aaaaaaa vvvvvvvv
+	{
+		c.op = CompiledPatch::Op_Write;
+		c.size = 1 << top;
+		c.addr = p.addr & 0x0FFFFFFF;
+		c.value = data & (top == 2 ? 0xFFFFFFFF : (1u << (8 << top)) - 1);
+	}
+	else if ((p.addr & 0xFFCF0000) == 0x30000000) // 300000vv, 301000vv, 3020vvvv, 3030vvvv 0aaaaaaa
+	{
+		const bool dec = p.addr & 0x00100000;
+		c.op = dec ? CompiledPatch::Op_Dec : CompiledPatch::Op_Inc;
+		c.size = (p.addr & 0x00200000) ? 2 : 1;
+		c.addr = data;
+		c.value = p.addr & (c.size == 2 ? 0xFFFF : 0xFF);
+	}
+	else if (top == 7) // 7aaaaaaa 00t0vvvv
+	{
+		static const CompiledPatch::Op ops[3] = {CompiledPatch::Op_Or, CompiledPatch::Op_And, CompiledPatch::Op_Xor};
+		const u32 t = (data & 0x00F00000) >> 20;
+		if (t <= 5)
+		{
+			c.op = ops[t / 2];
+			c.size = (t & 1) ? 2 : 1;
+			c.addr = p.addr & 0x0FFFFFFF;
+			c.value = data & (c.size == 2 ? 0xFFFF : 0xFF);
+		}
+	}
+	else if (p.addr < 0xE0000000) // Daaaaaaa 00t0dddd
+	{
+		static const CompiledPatch::Op ops[4] = {CompiledPatch::Op_SkipIfNe, CompiledPatch::Op_SkipIfEq, CompiledPatch::Op_SkipIfGe, CompiledPatch::Op_SkipIfLe};
+		if ((data & 0xFFCF0000) == 0)
+		{
+			c.op = ops[data >> 20];
+			c.size = 2;
+			c.skip = 1;
+			c.addr = p.addr & 0x0FFFFFFF;
+			c.value = data & 0xFFFF;
+		}
+	}
+	else if (p.addr < 0xF0000000) // Ezyyvvvv taaaaaaa
+	{
+		static const CompiledPatch::Op ops[4] = {CompiledPatch::Op_SkipIfNe, CompiledPatch::Op_SkipIfEq, CompiledPatch::Op_SkipIfGe, CompiledPatch::Op_SkipIfLe};
+		const u32 z = (p.addr & 0x0F000000) >> 24;
+		if (data < 0x40000000 && z <= 1)
+		{
+			c.op = ops[data >> 28];
+			c.size = z ? 1 : 2;
+			c.skip = (p.addr & 0x00FF0000) >> 16;
+			c.addr = data & 0x0FFFFFFF;
+			c.value = p.addr & (z ? 0xFF : 0xFFFF);
+		}
+	}
+}
+
 // Only used from Patch.cpp and we don't export this in any h file.
 // Patch.cpp itself declares this prototype, so make sure to keep in sync.
-void _ApplyPatch(IniPatch *p)
+void _CompilePatches(std::vector<IniPatch>& patches)
 {
-	u64 mem = 0;
-	u64 ledata = 0;
+	bool multiLine = false;
+	for (const IniPatch& p : patches)
+		multiLine |= p.cpu == CPU_EE && p.type == EXTENDED_T && IsMultiLineCode(p);
 
-	if (p->enabled == 0) return;
+	for (auto& compiled : s_compiledPatches)
+		compiled.clear();
 
-	switch (p->cpu)
+	for (IniPatch& p : patches)
 	{
-	case CPU_EE:
-		switch (p->type)
-		{
-		case BYTE_T:
-			if (memRead8(p->addr) != (u8)p->data)
-				memWrite8(p->addr, (u8)p->data);
-			break;
-
-		case SHORT_T:
-			if (memRead16(p->addr) != (u16)p->data)
-				memWrite16(p->addr, (u16)p->data);
-			break;
-
-		case WORD_T:
-			if (memRead32(p->addr) != (u32)p->data)
-				memWrite32(p->addr, (u32)p->data);
-			break;
-
-		case DOUBLE_T:
-			memRead64(p->addr, &mem);
-			if (mem != p->data)
-				memWrite64(p->addr, &p->data);
-			break;
-
-		case EXTENDED_T:
-			handle_extended_t(p);
-			break;
-
-		case SHORT_LE_T:
-			ledata = SwapEndian(p->data, 16);
-			if (memRead16(p->addr) != (u16)ledata)
-				memWrite16(p->addr, (u16)ledata);
-			break;
-
-		case WORD_LE_T:
-			ledata = SwapEndian(p->data, 32);
-			if (memRead32(p->addr) != (u32)ledata)
-				memWrite32(p->addr, (u32)ledata);
-			break;
-
-		case DOUBLE_LE_T:
-			ledata = SwapEndian(p->data, 64);
-			memRead64(p->addr, &mem);
-			if (mem != ledata)
-				memWrite64(p->addr, ledata);
-			break;
+		if (p.enabled == 0)
+			continue;
 
-		default:
-			break;
+		CompiledPatch c = {};
+		c.op = CompiledPatch::Op_Write;
+		c.addr = p.addr;
+		c.source = &p;
+
+		if (p.cpu == CPU_IOP)
+		{
+			if (p.type != BYTE_T && p.type != SHORT_T && p.type != WORD_T)
+				continue;
+			c.iop = true;
 		}
-		break;
+		else if (p.cpu != CPU_EE)
+			continue;
+
+		switch (p.type)
+		{
+			case BYTE_T:
+				c.size = 1;
+				c.value = (u8)p.data;
+				break;
+			case SHORT_T:
+				c.size = 2;
+				c.value = (u16)p.data;
+				break;
+			case WORD_T:
+				c.size = 4;
+				c.value = (u32)p.data;
+				break;
+			case DOUBLE_T:
+				c.size = 8;
+				c.value = p.data;
+				break;
+			case SHORT_LE_T:
+				c.size = 2;
+				c.value = (u16)SwapEndian(p.data, 16);
+				break;
+			case WORD_LE_T:
+				c.size = 4;
+				c.value = (u32)SwapEndian(p.data, 32);
+				break;
+			case DOUBLE_LE_T:
+				c.size = 8;
+				c.value = SwapEndian(p.data, 64);
+				break;
+			case EXTENDED_T:
+				c.extended = true;
+				if (multiLine)
+					c.op = CompiledPatch::Op_Extended;
+				else
+					CompileExtended(p, c);
+				break;
+			default:
+				continue;
+		}
+
+		const int place = p.placetopatch;
+		if (place >= 0 && place < _PPT_END_MARKER)
+			s_compiledPatches[place].push_back(c);
+	}
+}
 
-	case CPU_IOP:
-		switch (p->type)
-		{
-		case BYTE_T:
-			if (iopMemRead8(p->addr) != (u8)p->data)
-				iopMemWrite8(p->addr, (u8)p->data);
-			break;
-		case SHORT_T:
-			if (iopMemRead16(p->addr) != (u16)p->data)
-				iopMemWrite16(p->addr, (u16)p->data);
-			break;
-		case WORD_T:
-			if (iopMemRead32(p->addr) != (u32)p->data)
-				iopMemWrite32(p->addr, (u32)p->data);
-			break;
+// Direct pointer to the EE memory at addr, or null if the page goes through a handler (or the
+// data cache is emulated).  Looked up on every application, since games can remap the TLB.
+static __fi u8* PatchHostPtr(u32 addr)
+{
+	if (CHECK_CACHE)
+		return nullptr;
+	const auto vmv = vtlb_private::vtlbdata.vmap[addr >> vtlb_private::VTLB_PAGE_BITS];
+	return vmv.isHandler(addr) ? nullptr : reinterpret_cast<u8*>(vmv.assumePtr(addr));
+}
+
+template <typename T>
+static T PatchRead(bool iop, u32 addr)
+{
+	if (iop)
+	{
+		switch (sizeof(T))
+		{
+			case 1: return iopMemRead8(addr);
+			case 2: return iopMemRead16(addr);
+			default: return iopMemRead32(addr);
+		}
+	}
+
+	switch (sizeof(T))
+	{
+		case 1: return memRead8(addr);
+		case 2: return memRead16(addr);
+		case 4: return memRead32(addr);
 		default:
-			break;
+		{
+			u64 mem;
+			memRead64(addr, &mem);
+			return (T)mem;
 		}
-		break;
+	}
+}
 
-	default:
-		break;
+template <typename T>
+static void PatchWrite(bool iop, u32 addr, T value)
+{
+	if (iop)
+	{
+		switch (sizeof(T))
+		{
+			case 1: iopMemWrite8(addr, (u8)value); break;
+			case 2: iopMemWrite16(addr, (u16)value); break;
+			default: iopMemWrite32(addr, (u32)value); break;
+		}
+		return;
+	}
+
+	switch (sizeof(T))
+	{
+		case 1: memWrite8(addr, (u8)value); break;
+		case 2: memWrite16(addr, (u16)value); break;
+		case 4: memWrite32(addr, (u32)value); break;
+		default: memWrite64(addr, (u64)value); break;
+	}
+}
+
+// Memory which already holds the result isn't written, so the recompilers don't throw away
+// the blocks in its page for nothing.
+template <typename T>
+static void ApplyCompiledPatch(const CompiledPatch& c)
+{
+	T* host = c.iop ? nullptr : reinterpret_cast<T*>(PatchHostPtr(c.addr));
+	const T mem = host ? *host : PatchRead<T>(c.iop, c.addr);
+	const T value = (T)c.value;
+	T result;
+
+	switch (c.op)
+	{
+		case CompiledPatch::Op_Write: result = value; break;
+		case CompiledPatch::Op_Inc: result = mem + value; break;
+		case CompiledPatch::Op_Dec: result = mem - value; break;
+		case CompiledPatch::Op_Or: result = mem | value; break;
+		case CompiledPatch::Op_And: result = mem & value; break;
+		case CompiledPatch::Op_Xor: result = mem ^ value; break;
+		case CompiledPatch::Op_SkipIfNe: if (mem != value) SkipCount = c.skip; return;
+		case CompiledPatch::Op_SkipIfEq: if (mem == value) SkipCount = c.skip; return;
+		case CompiledPatch::Op_SkipIfGe: if (mem >= value) SkipCount = c.skip; return;
+		case CompiledPatch::Op_SkipIfLe: if (mem <= value) SkipCount = c.skip; return;
+		default: return;
+	}
+
+	if (result == mem)
+		return;
+	if (host)
+		*host = result;
+	else
+		PatchWrite<T>(c.iop, c.addr, result);
+}
+
+// Applies the patches compiled by the last _CompilePatches with a specific place value.
+void _ApplyCompiledPatches(patch_place_type place)
+{
+	for (const CompiledPatch& c : s_compiledPatches[place])
+	{
+		if (c.op == CompiledPatch::Op_Extended)
+		{
+			handle_extended_t(c.source);
+			continue;
+		}
+
+		if (c.extended)
+		{
+			if (SkipCount > 0)
+			{
+				SkipCount--;
+				continue;
+			}
+		}
+
+		switch (c.size)
+		{
+			case 1: ApplyCompiledPatch<u8>(c); break;
+			case 2: ApplyCompiledPatch<u16>(c); break;
+			case 4: ApplyCompiledPatch<u32>(c); break;
+			case 8: ApplyCompiledPatch<u64>(c); break;
+		}
 	}
 }
 
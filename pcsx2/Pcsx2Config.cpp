@@ -38,7 +38,8 @@ void TraceLogFilters::LoadSave( IniInterface& ini )
 const wxChar* const tbl_SpeedhackNames[] =
 	{
 		L"mvuFlag",
-		L"InstantVU1"};
+		L"InstantVU1",
+		L"WaitLoop"};
 
 const __fi wxChar* EnumToString(SpeedhackId id)
 {
@@ -56,6 +57,9 @@ void Pcsx2Config::SpeedhackOptions::Set(SpeedhackId id, bool enabled)
 		case Speedhack_InstantVU1:
 			vu1Instant = enabled;
 			break;
+		case Speedhack_WaitLoop:
+			WaitLoop = enabled;
+			break;
 			jNO_DEFAULT;
 	}
 }
@@ -92,6 +96,10 @@ void Pcsx2Config::SpeedhackOptions::LoadSave(IniInterface& ini)
 	IniBitBool(vuFlagHack);
 	IniBitBool(vuThread);
 	IniBitBool(vu1Instant);
+	IniBitBool(threadPinning);
+	IniBitBool(IopHLE);
+	IniBitBool(vu0Thread);
+	IniBitBool(ipuThread);
 }
 
 void Pcsx2Config::ProfilerOptions::LoadSave( IniInterface& ini )
@@ -116,6 +124,10 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 
 	EnableEE	= true;
 	EnableEECache = false;
+	EnableFastmem = true;
+	SpeculateEE	= true;
+	LazySmcEE	= false;
+	RelaxEE		= true;
 	EnableIOP	= true;
 	EnableVU0	= true;
 	EnableVU1	= true;
@@ -129,6 +141,7 @@ Pcsx2Config::RecompilerOptions::RecompilerOptions()
 	fpuOverflow	= true;
 	//fpuExtraOverflow = false;
 	//fpuFullMode = false;
+	//fpuFusedMAdd = false;
 }
 
 void Pcsx2Config::RecompilerOptions::ApplySanityCheck()
@@ -171,8 +184,13 @@ void Pcsx2Config::RecompilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( EnableEE );
 	IniBitBool( EnableIOP );
 	IniBitBool( EnableEECache );
+	IniBitBool( EnableFastmem );
+	IniBitBool( SpeculateEE );
+	IniBitBool( LazySmcEE );
+	IniBitBool( RelaxEE );
 	IniBitBool( EnableVU0 );
 	IniBitBool( EnableVU1 );
+	IniBitBool( vuProgCache );
 
 	IniBitBool( vuOverflow );
 	IniBitBool( vuExtraOverflow );
@@ -182,6 +200,7 @@ void Pcsx2Config::RecompilerOptions::LoadSave( IniInterface& ini )
 	IniBitBool( fpuOverflow );
 	IniBitBool( fpuExtraOverflow );
 	IniBitBool( fpuFullMode );
+	IniBitBool( fpuFusedMAdd );
 
 	IniBitBool( StackFrameChecks );
 	IniBitBool( PreBlockCheckEE );
@@ -221,11 +240,18 @@ void Pcsx2Config::CpuOptions::LoadSave( IniInterface& ini )
 Pcsx2Config::GSOptions::GSOptions()
 {
 	FrameLimitEnable		= true;
+	LateLatch				= false;
 	FrameSkipEnable			= false;
+	FrameSkipAdaptive		= false;
 	VsyncEnable				= VsyncMode::Off;
 
 	SynchronousMTGS			= false;
 	VsyncQueueSize			= 2;
+	RingBufferSizeFactor	= 19;
+	SpinWaitBudget			= 50;
+	EventLatency			= 250;
+	InputLatencyTrace		= false;
+	InputLatencyLog			= false;
 
 	FramesToDraw			= 2;
 	FramesToSkip			= 2;
@@ -241,9 +267,16 @@ void Pcsx2Config::GSOptions::LoadSave( IniInterface& ini )
 
 	IniEntry( SynchronousMTGS );
 	IniEntry( VsyncQueueSize );
+	IniEntry( RingBufferSizeFactor );
+	IniEntry( SpinWaitBudget );
+	IniEntry( EventLatency );
+	IniEntry( InputLatencyTrace );
+	IniEntry( InputLatencyLog );
 
 	IniEntry( FrameLimitEnable );
+	IniEntry( LateLatch );
 	IniEntry( FrameSkipEnable );
+	IniEntry( FrameSkipAdaptive );
 	ini.EnumEntry( L"VsyncEnable", VsyncEnable, NULL, VsyncEnable );
 
 	IniEntry( LimitScalar );
@@ -256,7 +289,7 @@ void Pcsx2Config::GSOptions::LoadSave( IniInterface& ini )
 
 int Pcsx2Config::GSOptions::GetVsync() const
 {
-	if (g_LimiterMode == Limit_Turbo || !FrameLimitEnable)
+	if (g_LimiterMode == Limit_Turbo || g_LimiterMode == Limit_Throughput || !FrameLimitEnable)
 		return 0;
 
 	// D3D only support a boolean state. OpenGL waits a number of vsync
@@ -430,6 +463,12 @@ Pcsx2Config::Pcsx2Config()
 	McdFolderAutoManage = true;
 	EnablePatches = true;
 	BackupSavestate = true;
+	CdvdChdCacheMB = 64;
+	CdvdPreloadMB = 0;
+	RewindFrames = 30;
+	RewindSnapshots = 20;
+	RunAheadFrames = 1;
+	RecordingKeyframeFrames = 0;
 }
 
 void Pcsx2Config::LoadSave( IniInterface& ini )
@@ -439,6 +478,9 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( CdvdVerboseReads );
 	IniBitBool( CdvdDumpBlocks );
 	IniBitBool( CdvdShareWrite );
+	IniBitBool( CdvdPrefetchFiles );
+	IniEntry( CdvdChdCacheMB );
+	IniEntry( CdvdPreloadMB );
 	IniBitBool( EnablePatches );
 	IniBitBool( EnableCheats );
 	IniBitBool( EnableIPC );
@@ -449,8 +491,18 @@ void Pcsx2Config::LoadSave( IniInterface& ini )
 	IniBitBool( ConsoleToStdio );
 	IniBitBool( HostFs );
 	IniBitBool( FullBootConfig );
+	IniBitBool( UseHugePages );
+	IniBitBool( UseBootSnapshot );
 
 	IniBitBool( BackupSavestate );
+	IniBitBool( IncrementalSavestates );
+	IniBitBool( CopyOnWriteSavestates );
+	IniBitBool( EnableRewind );
+	IniEntry( RewindFrames );
+	IniEntry( RewindSnapshots );
+	IniBitBool( EnableRunAhead );
+	IniEntry( RunAheadFrames );
+	IniEntry( RecordingKeyframeFrames );
 	IniBitBool( McdEnableEjection );
 	IniBitBool( McdFolderAutoManage );
 	IniBitBool( MultitapPort0_Enabled );
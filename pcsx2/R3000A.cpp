@@ -65,6 +65,7 @@ void psxReset()
 	iopBreak = 0;
 	iopCycleEE = -1;
 	g_iopNextEventCycle = psxRegs.cycle + 4;
+	psxSetIntsDue();
 
 	psxHwReset();
 	PSXCLK = 36864000;
@@ -127,6 +128,20 @@ __fi void psxSetNextBranchDelta( s32 delta )
 	psxSetNextBranch( psxRegs.cycle, delta );
 }
 
+// Earliest deadline of the events pending in psxRegs.interrupt, see s_nextIntCycle of the EE.
+static u32 s_iopNextIntCycle = 0;
+
+static __fi void psxSetNextInt( u32 startCycle, s32 delta )
+{
+	if( (int)(s_iopNextIntCycle - startCycle) > delta )
+		s_iopNextIntCycle = startCycle + delta;
+}
+
+void psxSetIntsDue()
+{
+	s_iopNextIntCycle = psxRegs.cycle;
+}
+
 __fi int psxTestCycle( u32 startCycle, s32 delta )
 {
 	// typecast the conditional to signed so that things don't explode
@@ -146,6 +161,7 @@ __fi void PSX_INT( IopEventId n, s32 ecycle )
 	psxRegs.sCycle[n] = psxRegs.cycle;
 	psxRegs.eCycle[n] = ecycle;
 
+	psxSetNextInt( psxRegs.cycle, ecycle );
 	psxSetNextBranchDelta( ecycle );
 
 	if( iopCycleEE < 0 )
@@ -168,16 +184,24 @@ static __fi void IopTestEvent( IopEventId n, void (*callback)() )
 		callback();
 	}
 	else
+	{
+		psxSetNextInt( psxRegs.sCycle[n], psxRegs.eCycle[n] );
 		psxSetNextBranch( psxRegs.sCycle[n], psxRegs.eCycle[n] );
+	}
 }
 
 static __fi void _psxTestInterrupts()
 {
+	// IopTestEvent and PSX_INT bring it back to the earliest of the events left pending.
+	s_iopNextIntCycle = psxRegs.cycle + 0x7fffffff;
+
+
 	IopTestEvent(IopEvt_SIF0,		sif0Interrupt);	// SIF0
 	IopTestEvent(IopEvt_SIF1,		sif1Interrupt);	// SIF1
 	IopTestEvent(IopEvt_SIF2,		sif2Interrupt);	// SIF2
 	// Originally controlled by a preprocessor define, now PSX dependent.
 	if (psxHu32(HW_ICFG) & (1 << 3)) IopTestEvent(IopEvt_SIO, sioInterruptR);
+	else if (psxRegs.interrupt & (1 << IopEvt_SIO)) psxSetNextInt(psxRegs.sCycle[IopEvt_SIO], psxRegs.eCycle[IopEvt_SIO]);
 	IopTestEvent(IopEvt_CdvdRead,	cdvdReadInterrupt);
 
 	// Profile-guided Optimization (sorta)
@@ -214,9 +238,14 @@ __ri void iopEventTest()
 
 	if (psxRegs.interrupt)
 	{
-		iopEventTestIsActive = true;
-		_psxTestInterrupts();
-		iopEventTestIsActive = false;
+		if (psxTestCycle(s_iopNextIntCycle, 0))
+		{
+			iopEventTestIsActive = true;
+			_psxTestInterrupts();
+			iopEventTestIsActive = false;
+		}
+		else
+			psxSetNextBranch(s_iopNextIntCycle, 0);
 	}
 
 	if( (psxHu32(0x1078) != 0) && ((psxHu32(0x1070) & psxHu32(0x1074)) != 0) )
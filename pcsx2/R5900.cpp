@@ -29,6 +29,7 @@
 
 #include "Hardware.h"
 #include "IPU/IPUdma.h"
+#include "IPU/IPUthread.h"
 
 #include "Elfheader.h"
 #include "CDVD/CDVD.h"
@@ -56,6 +57,7 @@ bool g_GameLoading; // EELOAD has been called to load the game
 static const uint eeWaitCycles = 3072;
 
 bool eeEventTestIsActive = false;
+bool eeMemcheckBreak = false;
 
 u32 g_eeloadMain = 0, g_eeloadExec = 0, g_osdsys_str = 0;
 
@@ -90,6 +92,7 @@ void cpuReset()
 	fpuRegs.fprc[31]		= 0x01000001; // fpu Status/Control
 
 	g_nextEventCycle = cpuRegs.cycle + 4;
+	cpuSetIntsDue();
 	EEsCycle = 0;
 	EEoCycle = cpuRegs.cycle;
 
@@ -243,6 +246,22 @@ __fi void cpuSetNextEventDelta( s32 delta )
 	cpuSetNextEvent( cpuRegs.cycle, delta );
 }
 
+// Earliest deadline of the events pending in cpuRegs.interrupt.  The event test only goes
+// through them once it has passed, instead of testing every pending event every time.
+static u32 s_nextIntCycle = 0;
+
+static __fi void cpuSetNextInt( u32 startCycle, s32 delta )
+{
+	if( (int)(s_nextIntCycle - startCycle) > delta )
+		s_nextIntCycle = startCycle + delta;
+}
+
+// makes the next event test go through all of the pending events (reset, state loads).
+void cpuSetIntsDue()
+{
+	s_nextIntCycle = cpuRegs.cycle;
+}
+
 // tests the cpu cycle against the given start and delta values.
 // Returns true if the delta time has passed.
 __fi int cpuTestCycle( u32 startCycle, s32 delta )
@@ -275,7 +294,10 @@ static __fi void TESTINT( u8 n, void (*callback)() )
 		callback();
 	}
 	else
+	{
+		cpuSetNextInt( cpuRegs.sCycle[n], cpuRegs.eCycle[n] );
 		cpuSetNextEvent( cpuRegs.sCycle[n], cpuRegs.eCycle[n] );
+	}
 }
 
 // [TODO] move this function to LegacyDmac.cpp, and remove most of the DMAC-related headers from
@@ -287,6 +309,17 @@ static __fi void _cpuTestInterrupts()
 		//Console.Write("DMAC Disabled or suspended");
 		return;
 	}
+
+	// Nothing due yet, just keep the event test on the earliest deadline.
+	// (The BIOS runs all of the DMAs instantly, see TESTINT)
+	if (g_GameStarted && (int)(cpuRegs.cycle - s_nextIntCycle) < 0)
+	{
+		cpuSetNextEvent( s_nextIntCycle, 0 );
+		return;
+	}
+
+	// TESTINT and CPU_INT bring it back to the earliest of the events left pending.
+	s_nextIntCycle = cpuRegs.cycle + 0x7fffffff;
 	/* These are 'pcsx2 interrupts', they handle asynchronous stuff
 	   that depends on the cycle timings */
 
@@ -398,6 +431,9 @@ __fi void _cpuEventTest_Shared()
 	// These are basically just DMAC-related events, which also piggy-back the same bits as
 	// the PS2's own DMA channel IRQs and IRQ Masks.
 
+	// The IPU thread's interrupts and DMA requests
+	ipuThread.Poll();
+
 	// This is a BIOS hack because the coding in the BIOS is terrible but the bug is masked by Data Cache
 	// where a DMA buffer is overwritten without waiting for the transfer to end, which causes the fonts to get all messed up
 	// so to fix it, we run all the DMA's instantly when in the BIOS.
@@ -524,6 +560,7 @@ __fi void CPU_INT( EE_EventType n, s32 ecycle)
 	cpuRegs.interrupt|= 1 << n;
 	cpuRegs.sCycle[n] = cpuRegs.cycle;
 	cpuRegs.eCycle[n] = ecycle;
+	cpuSetNextInt( cpuRegs.cycle, ecycle );
 
 	// Interrupt is happening soon: make sure both EE and IOP are aware.
 
@@ -605,6 +642,10 @@ int ParseArgumentString(u32 arg_block)
 // Called from recompilers; __fastcall define is mandatory.
 void __fastcall eeloadHook()
 {
+	// The first call, before anything depends on the game; fast boots snapshot the machine here
+	if (!cpuRegs.GPR.n.a0.SD[0] && !g_GameStarted)
+		GetCoreThread().EeloadStartingInThread();
+
 	const wxString &elf_override = GetCoreThread().GetElfOverride();
 
 	if (!elf_override.IsEmpty())
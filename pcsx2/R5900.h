@@ -391,6 +391,23 @@ struct R5900cpu
 	//   doesn't matter if we're stripping it out soon. ;)
 	//
 	void (*Clear)(u32 Addr, u32 Size);
+
+	// Lazy alternative of Clear for the write protection of recompiled code: the code in
+	// the range is checked for changes when it's next executed, and only cleared if it did.
+	// Returns false if the range must be cleared (and protected manually) instead.
+	//
+	// Thread Affinity Rule:
+	//   Must be called on the same thread as Execute (from the page fault handler).
+	//
+	bool (*ClearLazy)(u32 Addr, u32 Size);
+
+	// Uses idle time of the host (the frame limiter's sleep) to compile code the CPU is
+	// predicted to reach, until the deadline in CPU ticks.  No-op for interpreters.
+	//
+	// Thread Affinity:
+	//   Must be called on the same thread as Execute, from the event test.
+	//
+	void (*Speculate)(u64 deadline);
 	
 	uint (*GetCacheReserve)();
 	void (*SetCacheReserve)( uint reserveInMegs );
@@ -445,6 +462,7 @@ extern void cpuSetNextEvent( u32 startCycle, s32 delta );
 extern void cpuSetNextEventDelta( s32 delta );
 extern int  cpuTestCycle( u32 startCycle, s32 delta );
 extern void cpuSetEvent();
+extern void cpuSetIntsDue();
 
 extern void _cpuEventTest_Shared();		// for internal use by the Dynarecs and Ints inside R5900:
 
@@ -456,6 +474,9 @@ extern void cpuTestTIMRInts();
 int isMemcheckNeeded(u32 pc);
 int isBreakpointNeeded(u32 addr);
 
+// set by a memcheck hit in recompiled code, which leaves the recompiler at the next event test
+extern bool eeMemcheckBreak;
+
 ////////////////////////////////////////////////////////////////////
 // Exception Codes
 
@@ -27,6 +27,8 @@
 #include "InputRecordingControls.h"
 #include "Utilities/InputRecordingLogger.h"
 
+#include <wx/numdlg.h>
+
 #endif
 
 void SaveStateBase::InputRecordingFreeze()
@@ -443,6 +445,19 @@ void InputRecording::GoToFirstFrame(wxWindow* parent)
 		SetToReplayMode();
 }
 
+void InputRecording::GoToFrame(wxWindow* parent)
+{
+	const long frame = wxGetNumberFromUser(_("Enter the frame to go to"), _("Frame"), _("Go to Frame"),
+		std::max<s32>(frameCounter, 0), 0, inputRecordingData.GetTotalFrames(), parent);
+	if (frame < 0)
+		return;
+
+	// The frames up to the target are replayed, not recorded over
+	if (IsRecording())
+		SetToReplayMode();
+	RecordingKeyframes_Seek(frame);
+}
+
 wxString InputRecording::resolveGameName()
 {
 	// Code loosely taken from AppCoreThread::_ApplySettings to resolve the Game Name
@@ -96,6 +96,9 @@ public:
 	// Resets emulation to the beginning of a recording
 	// Calls a file dialog if it fails to locate the base savestate
 	void GoToFirstFrame(wxWindow* parent);
+	// Goes to a frame of the recording chosen by the user, from the last keyframe before it
+	// if there is one (see RecordingKeyframeFrames in the emulation settings)
+	void GoToFrame(wxWindow* parent);
 	// Resets a recording if the base savestate could not be loaded at the start
 	void FailedSavestate();
 
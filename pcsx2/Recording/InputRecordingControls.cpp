@@ -42,6 +42,12 @@ void InputRecordingControls::CheckPauseStatus()
 	{
 		g_InputRecording.IncrementFrameCounter();
 
+		if (seekTarget >= 0 && g_InputRecording.GetFrameCounter() >= seekTarget)
+		{
+			seekTarget = -1;
+			pauseEmulation = true;
+		}
+
 		if (switchToReplay)
 		{
 			g_InputRecording.SetToReplayMode();
@@ -108,6 +114,22 @@ void InputRecordingControls::setFrameAdvanceAmount(int amount)
 	frames_per_frame_advance = amount;
 }
 
+void InputRecordingControls::SeekTo(s32 frame)
+{
+	frameAdvancing = false;
+	if (g_InputRecording.GetFrameCounter() >= frame)
+	{
+		seekTarget = -1;
+		pauseEmulation = true;
+		resumeEmulation = false;
+	}
+	else
+	{
+		seekTarget = frame;
+		Resume();
+	}
+}
+
 bool InputRecordingControls::IsFrameAdvancing()
 {
 	return frameAdvancing;
@@ -47,6 +47,9 @@ public:
 	// Resume emulation (incase the emulation is currently paused) and pause after a single frame has passed
 	void FrameAdvance();
 	void setFrameAdvanceAmount(int amount);
+	// Resume emulation and pause once the recording reaches the given frame, or stay paused if
+	// it's already there.  Used after loading a keyframe, to replay the frames up to the target
+	void SeekTo(s32 frame);
 	// Returns true if emulation is currently set up to frame advance.
 	bool IsFrameAdvancing();
 	// Returns true if the input recording has been paused, which can occur:
@@ -80,6 +83,8 @@ private:
 	bool frameAdvancing = false;
 	u32 frame_advance_frame_counter = 0;
 	u32 frames_per_frame_advance = 1;
+	// The frame to pause at after a SeekTo, or -1
+	s32 seekTarget = -1;
 	// Indicates if we intend to call CoreThread.PauseSelf() on the current or next available vsync
 	bool pauseEmulation = false;
 	// Indicates if we intend to call CoreThread.Resume() when the next pcsx2 App event is handled
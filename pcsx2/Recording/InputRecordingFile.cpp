@@ -58,12 +58,82 @@ bool InputRecordingFile::Close()
 	{
 		return false;
 	}
+
+	{
+		std::lock_guard<std::mutex> lock(dataLock);
+		writerQuit = true;
+	}
+	writerWake.notify_all();
+	if (writerThread.joinable())
+		writerThread.join();
+
+	if (!Flush())
+		inputRec::consoleLog("Failed to write the input recording file");
 	fclose(recordingFile);
 	recordingFile = nullptr;
 	filename = "";
+	frameData.clear();
+	frameData.shrink_to_fit();
 	return true;
 }
 
+bool InputRecordingFile::Flush()
+{
+	std::vector<u8> chunk;
+	size_t begin;
+	bool counters;
+	u32 frames, undos;
+	{
+		std::lock_guard<std::mutex> lock(dataLock);
+		begin = dirtyBegin;
+		if (dirtyBegin < dirtyEnd)
+			chunk.assign(frameData.begin() + dirtyBegin, frameData.begin() + dirtyEnd);
+		counters = countersDirty;
+		frames = totalFrames;
+		undos = undoCount;
+		dirtyBegin = SIZE_MAX;
+		dirtyEnd = 0;
+		countersDirty = false;
+	}
+
+	if (chunk.empty() && !counters)
+		return true;
+
+	std::lock_guard<std::mutex> lock(fileLock);
+	if (recordingFile == nullptr)
+		return false;
+
+	bool ok = true;
+	if (!chunk.empty())
+		ok = fseek(recordingFile, getRecordingBlockSeekPoint(0) + begin, SEEK_SET) == 0 &&
+			fwrite(chunk.data(), chunk.size(), 1, recordingFile) == 1;
+	// the undo count follows the total frames
+	if (counters)
+		ok = fseek(recordingFile, seekpointTotalFrames, SEEK_SET) == 0 &&
+			fwrite(&frames, 4, 1, recordingFile) == 1 && fwrite(&undos, 4, 1, recordingFile) == 1 && ok;
+	return fflush(recordingFile) == 0 && ok;
+}
+
+void InputRecordingFile::writer()
+{
+	SetNameOfCurrentThread("Input Recording Writer");
+
+	std::unique_lock<std::mutex> lock(dataLock);
+	while (!writerQuit)
+	{
+		writerWake.wait_for(lock, writerInterval, [this] {
+			return writerQuit || (dirtyBegin < dirtyEnd && dirtyEnd - dirtyBegin >= writerChunkSize);
+		});
+		if (writerQuit)
+			break;
+
+		lock.unlock();
+		if (!Flush())
+			inputRec::consoleLog("Failed to write the input recording file");
+		lock.lock();
+	}
+}
+
 const wxString &InputRecordingFile::GetFilename()
 {
 	return filename;
@@ -91,13 +161,9 @@ bool InputRecordingFile::FromSaveState()
 
 void InputRecordingFile::IncrementUndoCount()
 {
+	std::lock_guard<std::mutex> lock(dataLock);
 	undoCount++;
-	if (recordingFile == nullptr)
-	{
-		return;
-	}
-	fseek(recordingFile, seekpointUndoCount, SEEK_SET);
-	fwrite(&undoCount, 4, 1, recordingFile);
+	countersDirty = recordingFile != nullptr;
 }
 
 bool InputRecordingFile::open(const wxString path, bool newRecording)
@@ -110,14 +176,18 @@ bool InputRecordingFile::open(const wxString path, bool newRecording)
 			totalFrames = 0;
 			undoCount = 0;
 			header.Init();
+			writerQuit = false;
+			writerThread = std::thread(&InputRecordingFile::writer, this);
 			return true;
 		}
 	}
 	else if ((recordingFile = wxFopen(path, L"rb+")) != nullptr)
 	{
-		if (verifyRecordingFileHeader())
+		if (verifyRecordingFileHeader() && loadFrameData())
 		{
 			filename = path;
+			writerQuit = false;
+			writerThread = std::thread(&InputRecordingFile::writer, this);
 			return true;
 		}
 		Close();
@@ -148,12 +218,13 @@ bool InputRecordingFile::ReadKeyBuffer(u8 &result, const uint &frame, const uint
 		return false;
 	}
 
-	long seek = getRecordingBlockSeekPoint(frame) + controllerInputBytes * port + bufIndex;
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fread(&result, 1, 1, recordingFile) != 1)
+	const size_t offset = static_cast<size_t>(frame) * inputBytesPerFrame + controllerInputBytes * port + bufIndex;
+	if (offset >= frameData.size())
 	{
 		return false;
 	}
 
+	result = frameData[offset];
 	return true;
 }
 
@@ -163,9 +234,9 @@ void InputRecordingFile::SetTotalFrames(long frame)
 	{
 		return;
 	}
+	std::lock_guard<std::mutex> lock(dataLock);
 	totalFrames = frame;
-	fseek(recordingFile, seekpointTotalFrames, SEEK_SET);
-	fwrite(&totalFrames, 4, 1, recordingFile);
+	countersDirty = true;
 }
 
 bool InputRecordingFile::WriteHeader()
@@ -174,6 +245,7 @@ bool InputRecordingFile::WriteHeader()
 	{
 		return false;
 	}
+	std::lock_guard<std::mutex> lock(fileLock);
 	rewind(recordingFile);
 	if (fwrite(&header, sizeof(InputRecordingFileHeader), 1, recordingFile) != 1
 		|| fwrite(&totalFrames, 4, 1, recordingFile) != 1
@@ -192,14 +264,20 @@ bool InputRecordingFile::WriteKeyBuffer(const uint &frame, const uint port, cons
 		return false;
 	}
 
-	long seek = getRecordingBlockSeekPoint(frame) + 18 * port + bufIndex;
-
-	if (fseek(recordingFile, seek, SEEK_SET) != 0 || fwrite(&buf, 1, 1, recordingFile) != 1)
+	const size_t offset = static_cast<size_t>(frame) * inputBytesPerFrame + controllerInputBytes * port + bufIndex;
+	bool wake;
 	{
-		return false;
+		std::lock_guard<std::mutex> lock(dataLock);
+		if (offset >= frameData.size())
+			frameData.resize((static_cast<size_t>(frame) + 1) * inputBytesPerFrame);
+		frameData[offset] = buf;
+		dirtyBegin = std::min(dirtyBegin, offset);
+		dirtyEnd = std::max(dirtyEnd, offset + 1);
+		wake = dirtyEnd - dirtyBegin >= writerChunkSize;
 	}
 
-	fflush(recordingFile);
+	if (wake)
+		writerWake.notify_one();
 	return true;
 }
 
@@ -208,6 +286,23 @@ long InputRecordingFile::getRecordingBlockSeekPoint(const long &frame)
 	return headerSize + sizeof(bool) + frame * inputBytesPerFrame;
 }
 
+bool InputRecordingFile::loadFrameData()
+{
+	const long start = getRecordingBlockSeekPoint(0);
+	if (fseek(recordingFile, 0, SEEK_END) != 0)
+	{
+		return false;
+	}
+	const long end = ftell(recordingFile);
+
+	frameData.resize(end > start ? end - start : 0);
+	if (frameData.empty())
+	{
+		return true;
+	}
+	return fseek(recordingFile, start, SEEK_SET) == 0 && fread(frameData.data(), frameData.size(), 1, recordingFile) == 1;
+}
+
 bool InputRecordingFile::verifyRecordingFileHeader()
 {
 	if (recordingFile == nullptr)
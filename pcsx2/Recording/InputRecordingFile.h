@@ -21,6 +21,12 @@
 
 #include "PadData.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 // NOTE / TODOs for Version 2
 // - Move fromSavestate, undoCount, and total frames into the header
 
@@ -47,6 +53,10 @@ struct InputRecordingSavestate
 };
 
 // Handles all operations on the input recording file
+//
+// The input data of all frames is kept in memory, so that reading and writing it from the
+// emulation thread never touches the file.  A writer thread puts the changed bytes and the
+// header counters into the file in chunks, at least every second, and Close writes the rest.
 class InputRecordingFile
 {
 public:
@@ -80,6 +90,8 @@ public:
 	void SetTotalFrames(long frames);
 	// Persist the input recording file header's current state to the file
 	bool WriteHeader();
+	// Writes the frames and counters changed since the last flush to the file
+	bool Flush();
 	// Writes the current frame's input data to the file so it can be replayed
 	bool WriteKeyBuffer(const uint &frame, const uint port, const uint bufIndex, const u8 &buf);
 
@@ -96,11 +108,30 @@ private:
 	static const int seekpointUndoCount = sizeof(InputRecordingFileHeader) + 4;
 	static const int seekpointSaveStateHeader = seekpointUndoCount + 4;
 
+	// Changed frame bytes are flushed once they span this much, or after writerInterval
+	static const size_t writerChunkSize = 4096;
+	static constexpr std::chrono::seconds writerInterval{1};
+
 	InputRecordingFileHeader header;
 	wxString filename = "";
 	FILE* recordingFile = nullptr;
 	InputRecordingSavestate savestate;
 
+	// The input data of all frames, and the range of it changed since the last flush
+	std::vector<u8> frameData;
+	size_t dirtyBegin = SIZE_MAX;
+	size_t dirtyEnd = 0;
+	bool countersDirty = false;
+	// Guards frameData against the writer thread, which only reads it.  The emulation thread
+	// reads it without the lock, as it's the only one changing it
+	std::mutex dataLock;
+	// Guards recordingFile
+	std::mutex fileLock;
+
+	std::thread writerThread;
+	std::condition_variable writerWake;
+	bool writerQuit = false;
+
 	// An signed 32-bit frame limit is equivalent to 1.13 years of continuous 60fps footage
 	long totalFrames = 0;
 	unsigned long undoCount = 0;
@@ -109,6 +140,8 @@ private:
 	long getRecordingBlockSeekPoint(const long& frame);
 	bool open(const wxString path, bool newRecording);
 	bool verifyRecordingFileHeader();
+	bool loadFrameData();
+	void writer();
 };
 
 #endif
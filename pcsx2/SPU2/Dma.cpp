@@ -228,13 +228,23 @@ void V_Core::PlainDMAWrite(u16* pMem, u32 size)
 			GetDmaIndexChar(), size << 1, ActiveTSA, DMABits, AutoDMACtrl, Regs.ATTR & 0xffff,
 			Cores[Index].IRQEnable, Cores[Index].IRQA);
 
-	FinishDMAwrite();
+	// Streaming games keep sending large transfers. When the transfer doesn't wrap and no
+	// IRQ address is inside it, nothing can tell the chunks apart: it's copied at once, and
+	// it ends when the last chunk would have.
+	bool bulk = size > 0x100 && ActiveTSA + size <= 0x100000;
+	for (int i = 0; i < 2 && bulk; i++)
+	{
+		if (Cores[i].IRQEnable && Cores[i].IRQA > ActiveTSA && Cores[i].IRQA <= ActiveTSA + size)
+			bulk = false;
+	}
+
+	FinishDMAwrite(bulk);
 
 	if (ReadSize == 0) //DMA Finished right away so we need a DMAICounter size to trigger the interrupt
-		DMAICounter = size * 4;
+		DMAICounter = (bulk ? size - 0x100 : size) * 4;
 }
 
-void V_Core::FinishDMAwrite()
+void V_Core::FinishDMAwrite(bool bulk)
 {
 	if (DMAPtr == nullptr)
 	{
@@ -246,7 +256,7 @@ void V_Core::FinishDMAwrite()
 	else
 		DMA7LogWrite(DMAPtr, ReadSize << 1);
 
-	u32 buff1end = ActiveTSA + std::min(ReadSize, (u32)0x100 + std::abs(DMAICounter / 4));
+	u32 buff1end = ActiveTSA + (bulk ? ReadSize : std::min(ReadSize, (u32)0x100 + std::abs(DMAICounter / 4)));
 	u32 start = ActiveTSA;
 	u32 buff2end = 0;
 	if (buff1end > 0x100000)
@@ -255,16 +265,7 @@ void V_Core::FinishDMAwrite()
 		buff1end = 0x100000;
 	}
 
-	const int cacheIdxStart = ActiveTSA / pcm_WordsPerBlock;
-	const int cacheIdxEnd = (buff1end + pcm_WordsPerBlock - 1) / pcm_WordsPerBlock;
-	PcmCacheEntry* cacheLine = &pcm_cache_data[cacheIdxStart];
-	PcmCacheEntry& cacheEnd = pcm_cache_data[cacheIdxEnd];
-
-	do
-	{
-		cacheLine->Validated = false;
-		cacheLine++;
-	} while (cacheLine != &cacheEnd);
+	pcm_InvalidateRange(ActiveTSA, buff1end);
 
 	//ConLog( "* SPU2: Cache Clear Range!  TSA=0x%x, TDA=0x%x (low8=0x%x, high8=0x%x, len=0x%x)\n",
 	//	ActiveTSA, buff1end, flagTSA, flagTDA, clearLen );
@@ -283,10 +284,9 @@ void V_Core::FinishDMAwrite()
 		// second branch needs copied:
 		// It starts at the beginning of memory and moves forward to buff2end
 
-		// endpoint cache should be irrelevant, since it's almost certainly dynamic
-		// memory below 0x2800 (registers and such)
-		//const u32 endpt2 = (buff2end + roundUp) / indexer_scalar;
-		//memset( pcm_cache_flags, 0, endpt2 );
+		// usually dynamic memory below 0x2800 (registers and such), but large transfers
+		// can reach past it
+		pcm_InvalidateRange(0, buff2end);
 		TDA = buff1end;
 
 		DMAPtr += TDA - ActiveTSA;
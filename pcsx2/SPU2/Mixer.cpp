@@ -19,6 +19,9 @@
 void ADMAOutLogWrite(void* lpData, u32 ulSize);
 
 #include "interpolate_table.h"
+#include "VoiceGroup.h"
+
+static_assert(sizeof(V_VoiceGates) == 4 * sizeof(s16), "VoiceGroupSums reads the gates as 4 s16");
 
 static const s32 tbl_XA_Factor[16][2] =
 	{
@@ -134,6 +137,7 @@ PcmCacheEntry* pcm_cache_data = nullptr;
 
 int g_counter_cache_hits = 0;
 int g_counter_cache_misses = 0;
+int g_counter_cache_history_misses = 0; // misses of valid blocks entered with another history
 int g_counter_cache_ignores = 0;
 
 // LOOP/END sets the ENDX bit and sets NAX to LSA, and the voice is muted if LOOP is not set
@@ -178,6 +182,7 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 				if (!(vc.LoopFlags & XAFLAG_LOOP))
 				{
 					vc.Stop();
+					ActiveVoices[thiscore.Index] &= ~(1 << voiceidx);
 
 					if (IsDevBuild)
 					{
@@ -214,7 +219,7 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 		PcmCacheEntry& cacheLine = pcm_cache_data[cacheIdx];
 		vc.SBuffer = cacheLine.Sampledata;
 
-		if (cacheLine.Validated && vc.Prev1 == cacheLine.Prev1 && vc.Prev2 == cacheLine.Prev2)
+		if (cacheLine.Validated && (!cacheLine.Filtered || (vc.Prev1 == cacheLine.Prev1 && vc.Prev2 == cacheLine.Prev2)))
 		{
 			// Cached block!  Read from the cache directly.
 			// Make sure to propagate the prev1/prev2 ADPCM:
@@ -232,7 +237,12 @@ static __forceinline s32 GetNextDataBuffered(V_Core& thiscore, uint voiceidx)
 			// Only flag the cache if it's a non-dynamic memory range.
 			if (vc.NextA >= SPU2_DYN_MEMLINE)
 			{
+				const int id = *memptr >> 4 & 0xF;
+				if (IsDevBuild && cacheLine.Validated)
+					g_counter_cache_history_misses++;
+
 				cacheLine.Validated = true;
+				cacheLine.Filtered = tbl_XA_Factor[id][0] || tbl_XA_Factor[id][1];
 				cacheLine.Prev1 = vc.Prev1;
 				cacheLine.Prev2 = vc.Prev2;
 			}
@@ -350,6 +360,7 @@ static __forceinline void CalculateADSR(V_Core& thiscore, uint voiceidx)
 				ConLog("* SPU2: Voice Off by ADSR: %d \n", voiceidx);
 		}
 		vc.Stop();
+		ActiveVoices[thiscore.Index] &= ~(1 << voiceidx);
 	}
 
 	pxAssume(vc.ADSR.Value >= 0); // ADSR should never be negative...
@@ -439,11 +450,10 @@ __forceinline static s32 CubicInterpolate(
 	return (val + y1);
 }
 
-// Returns a 16 bit result in Value.
-// Uses standard template-style optimization techniques to statically generate five different
-// versions of this function (one for each type of interpolation).
+// Reads the samples the voice went past into PV1-PV4, and returns the interpolation
+// position between them (0.12).
 template <int InterpType>
-static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+static __forceinline s32 GetVoiceSamples(V_Core& thiscore, uint voiceidx)
 {
 	V_Voice& vc(thiscore.Voices[voiceidx]);
 
@@ -459,7 +469,18 @@ static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
 		vc.SP -= 4096;
 	}
 
-	const s32 mu = vc.SP + 4096;
+	return vc.SP + 4096;
+}
+
+// Returns a 16 bit result in Value.
+// Uses standard template-style optimization techniques to statically generate five different
+// versions of this function (one for each type of interpolation).
+template <int InterpType>
+static __forceinline s32 GetVoiceValues(V_Core& thiscore, uint voiceidx)
+{
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	const s32 mu = GetVoiceSamples<InterpType>(thiscore, voiceidx);
 
 	switch (InterpType)
 	{
@@ -644,20 +665,194 @@ static __forceinline StereoOut32 MixVoice(uint coreidx, uint voiceidx)
 
 const VoiceMixSet VoiceMixSet::Empty((StereoOut32()), (StereoOut32())); // Don't use SteroOut32::Empty because C++ doesn't make any dep/order checks on global initializers.
 
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+//                                                                                     //
+
+// The first half of MixVoice, up to the ADSR update
+template <int InterpType>
+static __forceinline void GatherVoice(uint coreidx, uint voiceidx, VoiceGroup& group, uint lane)
+{
+	V_Core& thiscore(Cores[coreidx]);
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	pxAssertMsg((vc.SCurrent <= 28) && (vc.SCurrent != 0), "Current sample should always range from 1->28");
+
+	vc.Volume.Update();
+	UpdatePitch(coreidx, voiceidx);
+
+	group.Active[lane] = vc.ADSR.Phase > 0;
+	group.VolL[lane] = vc.Volume.Left.Value;
+	group.VolR[lane] = vc.Volume.Right.Value;
+
+	if (vc.ADSR.Phase > 0)
+	{
+		if (vc.Noise)
+		{
+			group.PV1[lane] = GetNoiseValues(thiscore);
+			group.Direct[lane] = -1;
+		}
+		else
+		{
+			group.Mu[lane] = GetVoiceSamples<InterpType>(thiscore, voiceidx);
+			group.PV1[lane] = vc.PV1;
+			group.PV2[lane] = vc.PV2;
+			group.PV3[lane] = vc.PV3;
+			group.PV4[lane] = vc.PV4;
+			group.Direct[lane] = 0;
+		}
+
+		CalculateADSR(thiscore, voiceidx);
+		group.Envelope[lane] = vc.ADSR.Value;
+	}
+	else
+	{
+		while (vc.SP > 0)
+			GetNextDataDummy(thiscore, voiceidx); // Dummy is enough
+
+		group.PV1[lane] = 0;
+		group.Direct[lane] = -1;
+		group.Envelope[lane] = 0;
+	}
+
+	if (group.Direct[lane])
+	{
+		// keep the unused lanes defined, they're still interpolated
+		group.PV2[lane] = group.PV3[lane] = group.PV4[lane] = 0;
+		group.Mu[lane] = 0;
+	}
+}
+
+// A voice that is off only advances: its address still moves (IRQs, ENDX and loops) at
+// its pitch, and its output is silence.
+static __forceinline void AdvanceIdleVoice(uint coreidx, uint voiceidx)
+{
+	V_Core& thiscore(Cores[coreidx]);
+	V_Voice& vc(thiscore.Voices[voiceidx]);
+
+	vc.Volume.Update();
+	UpdatePitch(coreidx, voiceidx);
+
+	while (vc.SP > 0)
+		GetNextDataDummy(thiscore, voiceidx); // Dummy is enough
+
+	// Write-back of raw voice data (post ADSR applied)
+	if (voiceidx == 1)
+		spu2M_WriteFast(((0 == coreidx) ? 0x400 : 0xc00) + OutPos, 0);
+	else if (voiceidx == 3)
+		spu2M_WriteFast(((0 == coreidx) ? 0x600 : 0xe00) + OutPos, 0);
+}
+
+// The pitch of a modulated voice depends on the output of the previous voice for the same
+// sample: when both are in the group, the group is mixed one voice at a time.
+static __forceinline bool IsModulatedGroup(const V_Core& thiscore, uint first)
+{
+	for (uint voiceidx = first + 1; voiceidx < first + VoiceGroup::Size; ++voiceidx)
+	{
+		if (thiscore.Voices[voiceidx].Modulated)
+			return true;
+	}
+	return false;
+}
+
+template <int InterpType>
 static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
 {
 	V_Core& thiscore(Cores[coreidx]);
 
-	for (uint voiceidx = 0; voiceidx < V_Core::NumVoices; ++voiceidx)
+	VoiceGroupSums sums;
+
+	for (uint first = 0; first < V_Core::NumVoices; first += VoiceGroup::Size)
 	{
-		StereoOut32 VVal(MixVoice(coreidx, voiceidx));
+		// Most voices are off most of the time, a group without any sounding voice has
+		// nothing to mix.
+		if (!((ActiveVoices[coreidx] >> first) & ((1 << VoiceGroup::Size) - 1)))
+		{
+			for (uint voiceidx = first; voiceidx < first + VoiceGroup::Size; ++voiceidx)
+				AdvanceIdleVoice(coreidx, voiceidx);
+			continue;
+		}
+
+		if (IsModulatedGroup(thiscore, first))
+		{
+			for (uint voiceidx = first; voiceidx < first + VoiceGroup::Size; ++voiceidx)
+			{
+				StereoOut32 VVal(MixVoice(coreidx, voiceidx));
+
+				// Note: Results from MixVoice are ranged at 16 bits.
 
-		// Note: Results from MixVoice are ranged at 16 bits.
+				dest.Dry.Left += VVal.Left & thiscore.VoiceGates[voiceidx].DryL;
+				dest.Dry.Right += VVal.Right & thiscore.VoiceGates[voiceidx].DryR;
+				dest.Wet.Left += VVal.Left & thiscore.VoiceGates[voiceidx].WetL;
+				dest.Wet.Right += VVal.Right & thiscore.VoiceGates[voiceidx].WetR;
+			}
+			continue;
+		}
+
+		VoiceGroup group;
+		for (uint lane = 0; lane < VoiceGroup::Size; ++lane)
+			GatherVoice<InterpType>(coreidx, first + lane, group, lane);
+
+		const __m128i value = VoiceGroupValues<InterpType>(group);
+
+		alignas(16) s32 values[VoiceGroup::Size];
+		_mm_store_si128((__m128i*)values, value);
+
+		for (uint lane = 0; lane < VoiceGroup::Size; ++lane)
+		{
+			const uint voiceidx = first + lane;
 
-		dest.Dry.Left += VVal.Left & thiscore.VoiceGates[voiceidx].DryL;
-		dest.Dry.Right += VVal.Right & thiscore.VoiceGates[voiceidx].DryR;
-		dest.Wet.Left += VVal.Left & thiscore.VoiceGates[voiceidx].WetL;
-		dest.Wet.Right += VVal.Right & thiscore.VoiceGates[voiceidx].WetR;
+			if (group.Active[lane])
+			{
+				thiscore.Voices[voiceidx].OutX = values[lane];
+
+				if (IsDevBuild)
+					DebugCores[coreidx].Voices[voiceidx].displayPeak = std::max(DebugCores[coreidx].Voices[voiceidx].displayPeak, values[lane]);
+			}
+
+			// Write-back of raw voice data (post ADSR applied)
+			if (voiceidx == 1)
+				spu2M_WriteFast(((0 == coreidx) ? 0x400 : 0xc00) + OutPos, values[lane]);
+			else if (voiceidx == 3)
+				spu2M_WriteFast(((0 == coreidx) ? 0x600 : 0xe00) + OutPos, values[lane]);
+		}
+
+		sums.Add(group, value, &thiscore.VoiceGates[first].DryL);
+	}
+
+	s32 total[4];
+	sums.Get(total);
+
+	dest.Dry.Left += total[0];
+	dest.Dry.Right += total[1];
+	dest.Wet.Left += total[2];
+	dest.Wet.Right += total[3];
+}
+
+static __forceinline void MixCoreVoices(VoiceMixSet& dest, const uint coreidx)
+{
+	switch (Interpolation)
+	{
+		case 0:
+			MixCoreVoices<0>(dest, coreidx);
+			break;
+		case 1:
+			MixCoreVoices<1>(dest, coreidx);
+			break;
+		case 2:
+			MixCoreVoices<2>(dest, coreidx);
+			break;
+		case 3:
+			MixCoreVoices<3>(dest, coreidx);
+			break;
+		case 4:
+			MixCoreVoices<4>(dest, coreidx);
+			break;
+		case 5:
+			MixCoreVoices<5>(dest, coreidx);
+			break;
+
+			jNO_DEFAULT;
 	}
 }
 
@@ -876,6 +1071,14 @@ __forceinline
 	Ext = ApplyVolume(Ext, Cores[1].ExtVol);
 	StereoOut32 Out(Cores[1].Mix(VoiceData[1], InputData[1], Ext));
 
+	if (SndBuffer::OutputSuppressed)
+	{
+		// Nobody listens, skip straight to the AutoDMA output position
+		if (++OutPos >= 0x200)
+			OutPos = 0;
+		return;
+	}
+
 	if (PlayMode & 8)
 	{
 		// Experimental CDDA support
@@ -933,14 +1136,20 @@ __forceinline
 		{
 			p_cachestat_counter = 0;
 			if (MsgCache())
-				ConLog(" * SPU2 > CacheStats > Hits: %d  Misses: %d  Ignores: %d\n",
+			{
+				const int lookups = g_counter_cache_hits + g_counter_cache_misses;
+				ConLog(" * SPU2 > CacheStats > Hits: %d (%d%%)  Misses: %d (history: %d)  Ignores: %d\n",
 					   g_counter_cache_hits,
+					   lookups ? (int)(g_counter_cache_hits * 100LL / lookups) : 0,
 					   g_counter_cache_misses,
+					   g_counter_cache_history_misses,
 					   g_counter_cache_ignores);
+			}
 
 			g_counter_cache_hits =
 				g_counter_cache_misses =
-					g_counter_cache_ignores = 0;
+					g_counter_cache_history_misses =
+						g_counter_cache_ignores = 0;
 		}
 	}
 }
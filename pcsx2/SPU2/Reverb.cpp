@@ -93,18 +93,23 @@ static constexpr std::array<s32, NUM_TAPS> filter_coefs = {
 	-1,
 };
 
+// The filter is symmetric, the taps i and NUM_TAPS - 1 - i share their coef: both samples
+// are summed before the multiply, which halves the multiplies and gives the same result.
+
 s32 __forceinline V_Core::ReverbDownsample(bool right)
 {
+	const s32* buf = RevbDownBuf[right];
+	const u32 base = RevbSampleBufPos - NUM_TAPS;
 	s32 out = 0;
 
 	// Skipping the 0 coefs.
-	for (u32 i = 0; i < NUM_TAPS; i += 2)
+	for (u32 i = 0; i < NUM_TAPS / 2; i += 2)
 	{
-		out += RevbDownBuf[right][((RevbSampleBufPos - NUM_TAPS) + i) & 63] * filter_coefs[i];
+		out += (buf[(base + i) & 63] + buf[(base + NUM_TAPS - 1 - i) & 63]) * filter_coefs[i];
 	}
 
 	// We also skipped the middle so add that in.
-	out += RevbDownBuf[right][((RevbSampleBufPos - NUM_TAPS) + 19) & 63] * filter_coefs[19];
+	out += buf[(base + 19) & 63] * filter_coefs[19];
 
 	out >>= 15;
 	Clampify(out, (s32)INT16_MIN, (s32)INT16_MAX);
@@ -115,23 +120,26 @@ s32 __forceinline V_Core::ReverbDownsample(bool right)
 
 StereoOut32 __forceinline V_Core::ReverbUpsample(bool phase)
 {
+	const u32 base = (RevbSampleBufPos - NUM_TAPS) >> 1;
 	s32 ls = 0, rs = 0;
 
 	if (phase)
 	{
-		ls += RevbUpBuf[0][(((RevbSampleBufPos - NUM_TAPS) >> 1) + 9) & 63] * filter_coefs[19];
-		rs += RevbUpBuf[1][(((RevbSampleBufPos - NUM_TAPS) >> 1) + 9) & 63] * filter_coefs[19];
+		ls += RevbUpBuf[0][(base + 9) & 63] * filter_coefs[19];
+		rs += RevbUpBuf[1][(base + 9) & 63] * filter_coefs[19];
 	}
 	else
 	{
+		// Only the even coefs, the taps i and taps - 1 - i share theirs (see above)
+		constexpr u32 taps = (NUM_TAPS >> 1) + 1;
 
-		for (u32 i = 0; i < (NUM_TAPS >> 1) + 1; i++)
-		{
-			ls += RevbUpBuf[0][(((RevbSampleBufPos - NUM_TAPS) >> 1) + i) & 63] * filter_coefs[i * 2];
-		}
-		for (u32 i = 0; i < (NUM_TAPS >> 1) + 1; i++)
+		for (u32 i = 0; i < taps / 2; i++)
 		{
-			rs += RevbUpBuf[1][(((RevbSampleBufPos - NUM_TAPS) >> 1) + i) & 63] * filter_coefs[i * 2];
+			const u32 first = (base + i) & 63;
+			const u32 last = (base + taps - 1 - i) & 63;
+
+			ls += (RevbUpBuf[0][first] + RevbUpBuf[0][last]) * filter_coefs[i * 2];
+			rs += (RevbUpBuf[1][first] + RevbUpBuf[1][last]) * filter_coefs[i * 2];
 		}
 	}
 
@@ -231,6 +239,12 @@ StereoOut32 V_Core::DoReverb(const StereoOut32& Input)
 		_spu2mem[diff_dst] = clamp_mix(diff);
 		_spu2mem[apf1_dst] = clamp_mix(apf1);
 		_spu2mem[apf2_dst] = clamp_mix(apf2);
+
+		// The work area can be anywhere in ram, a voice could play it
+		pcm_InvalidateBlock(same_dst);
+		pcm_InvalidateBlock(diff_dst);
+		pcm_InvalidateBlock(apf1_dst);
+		pcm_InvalidateBlock(apf2_dst);
 	}
 
 	RevbUpBuf[R][(RevbSampleBufPos >> 1) & 63] = clamp_mix(out);
@@ -109,8 +109,11 @@ int FindOutputModuleById(const wchar_t* omodid)
 
 StereoOut32* SndBuffer::m_buffer;
 s32 SndBuffer::m_size;
-__aligned(4) volatile s32 SndBuffer::m_rpos;
-__aligned(4) volatile s32 SndBuffer::m_wpos;
+__aligned(64) std::atomic<s32> SndBuffer::m_rpos;
+__aligned(64) std::atomic<s32> SndBuffer::m_wpos;
+
+std::atomic<u32> SndBuffer::m_underruns;
+std::atomic<u32> SndBuffer::m_overruns;
 
 bool SndBuffer::m_underrun_freeze;
 StereoOut32* SndBuffer::sndTempBuffer = nullptr;
@@ -152,6 +155,7 @@ bool SndBuffer::CheckUnderrunStatus(int& nSamples, int& quietSampleCount)
 		nSamples = data;
 		quietSampleCount = SndOutPacketSize - data;
 		m_underrun_freeze = true;
+		m_underruns.fetch_add(1, std::memory_order_relaxed);
 
 		if (SynchMode == 0) // TimeStrech on
 			timeStretchUnderrun();
@@ -170,10 +174,17 @@ void SndBuffer::_InitFail()
 	mods[OutputModule]->Init();
 }
 
+// Samples the reader can take (reader side), at least that many (writer side).
 int SndBuffer::_GetApproximateDataInBuffer()
 {
 	// WARNING: not necessarily 100% up to date by the time it's used, but it will have to do.
-	return (m_wpos + m_size - m_rpos) % m_size;
+	return (m_wpos.load(std::memory_order_acquire) + m_size - m_rpos.load(std::memory_order_acquire)) % m_size;
+}
+
+// Room the writer can fill (writer side).
+int SndBuffer::_GetFreeSpaceInBuffer()
+{
+	return m_size - _GetApproximateDataInBuffer();
 }
 
 void SndBuffer::_WriteSamples_Internal(StereoOut32* bData, int nSamples)
@@ -181,29 +192,31 @@ void SndBuffer::_WriteSamples_Internal(StereoOut32* bData, int nSamples)
 	// WARNING: This assumes the write will NOT wrap around,
 	// and also assumes there's enough free space in the buffer.
 
-	memcpy(m_buffer + m_wpos, bData, nSamples * sizeof(StereoOut32));
-	m_wpos = (m_wpos + nSamples) % m_size;
+	const s32 wpos = m_wpos.load(std::memory_order_relaxed);
+	memcpy(m_buffer + wpos, bData, nSamples * sizeof(StereoOut32));
+	m_wpos.store((wpos + nSamples) % m_size, std::memory_order_release);
 }
 
 void SndBuffer::_DropSamples_Internal(int nSamples)
 {
-	m_rpos = (m_rpos + nSamples) % m_size;
+	m_rpos.store((m_rpos.load(std::memory_order_relaxed) + nSamples) % m_size, std::memory_order_release);
 }
 
 void SndBuffer::_ReadSamples_Internal(StereoOut32* bData, int nSamples)
 {
 	// WARNING: This assumes the read will NOT wrap around,
 	// and also assumes there's enough data in the buffer.
-	memcpy(bData, m_buffer + m_rpos, nSamples * sizeof(StereoOut32));
+	memcpy(bData, m_buffer + m_rpos.load(std::memory_order_relaxed), nSamples * sizeof(StereoOut32));
 	_DropSamples_Internal(nSamples);
 }
 
 void SndBuffer::_WriteSamples_Safe(StereoOut32* bData, int nSamples)
 {
 	// WARNING: This code assumes there's only ONE writing process.
-	if ((m_size - m_wpos) < nSamples)
+	const s32 wpos = m_wpos.load(std::memory_order_relaxed);
+	if ((m_size - wpos) < nSamples)
 	{
-		int b1 = m_size - m_wpos;
+		int b1 = m_size - wpos;
 		int b2 = nSamples - b1;
 
 		_WriteSamples_Internal(bData, b1);
@@ -218,9 +231,10 @@ void SndBuffer::_WriteSamples_Safe(StereoOut32* bData, int nSamples)
 void SndBuffer::_ReadSamples_Safe(StereoOut32* bData, int nSamples)
 {
 	// WARNING: This code assumes there's only ONE reading process.
-	if ((m_size - m_rpos) < nSamples)
+	const s32 rpos = m_rpos.load(std::memory_order_relaxed);
+	if ((m_size - rpos) < nSamples)
 	{
-		int b1 = m_size - m_rpos;
+		int b1 = m_size - rpos;
 		int b2 = nSamples - b1;
 
 		_ReadSamples_Internal(bData, b1);
@@ -260,7 +274,8 @@ void SndBuffer::ReadSamples(T* bData)
 		pxAssume(nSamples <= SndOutPacketSize);
 
 		// WARNING: This code assumes there's only ONE reading process.
-		int b1 = m_size - m_rpos;
+		const s32 rpos = m_rpos.load(std::memory_order_relaxed);
+		int b1 = m_size - rpos;
 
 		if (b1 > nSamples)
 			b1 = nSamples;
@@ -269,7 +284,7 @@ void SndBuffer::ReadSamples(T* bData)
 		{
 			// First part
 			for (int i = 0; i < b1; i++)
-				bData[i].AdjustFrom(m_buffer[i + m_rpos]);
+				bData[i].AdjustFrom(m_buffer[i + rpos]);
 
 			// Second part
 			int b2 = nSamples - b1;
@@ -280,7 +295,7 @@ void SndBuffer::ReadSamples(T* bData)
 		{
 			// First part
 			for (int i = 0; i < b1; i++)
-				bData[i].ResampleFrom(m_buffer[i + m_rpos]);
+				bData[i].ResampleFrom(m_buffer[i + rpos]);
 
 			// Second part
 			int b2 = nSamples - b1;
@@ -333,7 +348,7 @@ void SndBuffer::_WriteSamples(StereoOut32* bData, int nSamples)
 	//  The older portion of the buffer is discarded rather than incoming data,
 	//  so that the overall audio synchronization is better.
 
-	int free = m_size - _GetApproximateDataInBuffer(); // -1, but the <= handles that
+	int free = _GetFreeSpaceInBuffer(); // -1, but the <= handles that
 	if (free <= nSamples)
 	{
 // Disabled since the lock-free queue can't handle changing the read end from the write thread
@@ -361,6 +376,7 @@ void SndBuffer::_WriteSamples(StereoOut32* bData, int nSamples)
 			ConLog(" * SPU2 > Overrun Compensation (%d packets tossed)\n", comp / SndOutPacketSize );
 		lastPct = 0.0;		// normalize the timestretcher
 #else
+		m_overruns.fetch_add(1, std::memory_order_relaxed);
 		if (MsgOverruns())
 			ConLog(" * SPU2 > Overrun! 1 packet tossed)\n");
 		lastPct = 0.0; // normalize the timestretcher
@@ -385,10 +401,14 @@ void SndBuffer::Init()
 
 	m_rpos = 0;
 	m_wpos = 0;
+	m_underruns = 0;
+	m_overruns = 0;
 
 	try
 	{
-		const float latencyMS = SndOutLatencyMS * 16;
+		// The low latency mode has a smaller buffer so that the fill level can't wander
+		// far from the target before the overrun check catches it.
+		const float latencyMS = SndOutLatencyMS * (IsLowLatency() ? 4 : 16);
 		m_size = GetAlignedBufferSize((int)(latencyMS * SampleRate / 1000.0f));
 		printf("%d SampleRate: \n", SampleRate);
 		m_buffer = new StereoOut32[m_size];
@@ -430,6 +450,8 @@ int SndBuffer::m_dsp_progress = 0;
 
 int SndBuffer::m_timestretch_progress = 0;
 int SndBuffer::ssFreeze = 0;
+bool SndBuffer::OutputMuted = false;
+bool SndBuffer::OutputSuppressed = false;
 
 void SndBuffer::ClearContents()
 {
@@ -439,6 +461,9 @@ void SndBuffer::ClearContents()
 
 void SndBuffer::Write(const StereoOut32& Sample)
 {
+	if (OutputMuted)
+		return;
+
 	// Log final output to wavefile.
 	WaveDump::WriteCore(1, CoreSrc_External, Sample.DownSample());
 
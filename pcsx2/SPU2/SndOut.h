@@ -20,6 +20,10 @@
 // SndOut.
 static const int SndOutPacketSize = 64;
 
+// At this latency or below, the timestretcher runs in low latency mode: a smaller buffer,
+// a faster tempo control loop and the shortest SoundTouch sequences.
+static const int SndOutLowLatencyMS = 40;
+
 // Overall master volume shift; this is meant to be a precision value and does not affect
 // actual output volumes.  It converts SPU2 16 bit volumes to 32-bit volumes, and likewise
 // downsamples 32 bit samples to 16 bit sound driver output (this way timestretching and
@@ -578,14 +582,21 @@ private:
 	static StereoOut32* m_buffer;
 	static s32 m_size;
 
-	static __aligned(4) volatile s32 m_rpos;
-	static __aligned(4) volatile s32 m_wpos;
+	// Single producer (the mixer) / single consumer (the output module) ring, each index is
+	// only written by its own side. Note: keep them on separate cache lines to avoid CPU conflict
+	static __aligned(64) std::atomic<s32> m_rpos;
+	static __aligned(64) std::atomic<s32> m_wpos;
+
+	static std::atomic<u32> m_underruns;
+	static std::atomic<u32> m_overruns;
 
 	static float lastEmergencyAdj;
 	static float cTempo;
 	static float eTempo;
 	static int ssFreeze;
 
+	static std::atomic<int> m_latency_samples; // Measured by the timestretcher, for the OSD
+
 	static void _InitFail();
 	static bool CheckUnderrunStatus(int& nSamples, int& quietSampleCount);
 
@@ -611,9 +622,16 @@ private:
 	static void _ReadSamples_Internal(StereoOut32* bData, int nSamples);
 
 	static int _GetApproximateDataInBuffer();
+	static int _GetFreeSpaceInBuffer();
 
 public:
+	static bool OutputMuted; // Write drops the samples (set by SPU2setOutputMuted)
+	static bool OutputSuppressed; // Mix doesn't produce any output (set by SPU2setOutputSuppressed)
+
 	static void UpdateTempoChangeAsyncMixing();
+	static bool IsLowLatency();
+	// Shows the measured latency and the underrun/overrun counts on the OSD, called by the MTGS thread
+	static void ReportLatency();
 	static void Init();
 	static void Cleanup();
 	static void Write(const StereoOut32& Sample);
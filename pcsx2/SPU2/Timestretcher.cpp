@@ -16,6 +16,7 @@
 #include "PrecompiledHeader.h"
 #include "Global.h"
 #include "SoundTouch.h"
+#include "GS/GS.h"
 #include <wx/datetime.h>
 #include <algorithm>
 
@@ -35,6 +36,29 @@ float SndBuffer::lastEmergencyAdj;
 float SndBuffer::cTempo = 1;
 float SndBuffer::eTempo = 1;
 
+std::atomic<int> SndBuffer::m_latency_samples(0);
+
+bool SndBuffer::IsLowLatency()
+{
+	return SynchMode == 0 && SndOutLatencyMS <= SndOutLowLatencyMS;
+}
+
+void SndBuffer::ReportLatency()
+{
+	char value[96];
+	if (SynchMode == 0)
+	{
+		snprintf(value, sizeof(value), "%.1f ms%s, %u underruns, %u overruns", m_latency_samples.load(std::memory_order_relaxed) * 1000.0 / SampleRate,
+			IsLowLatency() ? " (low latency)" : "", m_underruns.load(std::memory_order_relaxed), m_overruns.load(std::memory_order_relaxed));
+	}
+	else
+	{
+		snprintf(value, sizeof(value), "%u underruns, %u overruns", m_underruns.load(std::memory_order_relaxed), m_overruns.load(std::memory_order_relaxed));
+	}
+
+	GSosdMonitor("SPU2 latency", value, 0xffffffff);
+}
+
 void SndBuffer::PredictDataWrite(int samples)
 {
 	m_predictData += samples;
@@ -103,11 +127,15 @@ int targetIPS = 750;
 #define AVERAGING_BUFFER_SIZE 256U
 unsigned int AVERAGING_WINDOW = 50.0 * targetIPS / 750;
 
+//Low latency mode: the buffer only holds a few ms of headroom, so the loop must react within
+//  a few packets instead of ~70ms. The dampening and hysteresis below keep it stable.
+#define LOW_LATENCY_AVERAGING_WINDOW 12U
+
 
 #define STRETCHER_RESET_THRESHOLD 5
 int gRequestStretcherReset = STRETCHER_RESET_THRESHOLD;
 //Adds a value to the running average buffer, and return the new running average.
-float addToAvg(float val)
+float addToAvg(float val, unsigned int window)
 {
 	static float avg_fullness[AVERAGING_BUFFER_SIZE];
 	static unsigned int nextAvgPos = 0;
@@ -121,7 +149,7 @@ float addToAvg(float val)
 	avg_fullness[nextAvgPos] = val;
 	nextAvgPos = (nextAvgPos + 1U) % AVERAGING_BUFFER_SIZE;
 
-	unsigned int actualWindow = std::min(available, AVERAGING_WINDOW);
+	unsigned int actualWindow = std::min(available, window);
 	unsigned int first = (nextAvgPos - actualWindow + AVERAGING_BUFFER_SIZE) % AVERAGING_BUFFER_SIZE;
 
 	// Possible optimization: if we know that actualWindow hasn't changed since
@@ -169,6 +197,11 @@ void SndBuffer::UpdateTempoChangeSoundTouch2()
 	int data = _GetApproximateDataInBuffer();
 	float bufferFullness = (float)data; ///(float)m_size;
 
+	// What a sample written now waits for before reaching the output module
+	m_latency_samples.store(data + pSoundTouch->numUnprocessedSamples() + pSoundTouch->numSamples(), std::memory_order_relaxed);
+
+	const bool lowLatency = IsLowLatency();
+
 #ifdef NEWSTRETCHER_USE_DYNAMIC_TUNING
 	{ //test current iterations/sec every 0.5s, and change algo params accordingly if different than previous IPS more than 30%
 		static long iters = 0;
@@ -193,13 +226,14 @@ void SndBuffer::UpdateTempoChangeSoundTouch2()
 #endif
 
 	//Algorithm params: (threshold params (hysteresis), etc)
+	//  The low latency mode leaves the 1:1 mode sooner, and compensates the latency faster.
 	const float hys_ok_factor = 1.04f;
-	const float hys_bad_factor = 1.2f;
-	int hys_min_ok_count = GetClamped((int)(50.0 * (float)targetIPS / 750.0), 2, 100); //consecutive iterations within hys_ok before going to 1:1 mode
-	int compensationDivider = GetClamped((int)(100.0 * (float)targetIPS / 750), 15, 150);
+	const float hys_bad_factor = lowLatency ? 1.1f : 1.2f;
+	int hys_min_ok_count = GetClamped((int)((lowLatency ? 20.0 : 50.0) * (float)targetIPS / 750.0), 2, 100); //consecutive iterations within hys_ok before going to 1:1 mode
+	int compensationDivider = GetClamped((int)((lowLatency ? 30.0 : 100.0) * (float)targetIPS / 750), lowLatency ? 5 : 15, 150);
 
 	float tempoAdjust = bufferFullness / dynamicTargetFullness;
-	float avgerage = addToAvg(tempoAdjust);
+	float avgerage = addToAvg(tempoAdjust, lowLatency ? LOW_LATENCY_AVERAGING_WINDOW : AVERAGING_WINDOW);
 	tempoAdjust = avgerage;
 
 	// Dampen the adjustment to avoid overshoots (this means the average will compensate to the other side).
@@ -251,8 +285,9 @@ void SndBuffer::UpdateTempoChangeSoundTouch2()
 
 		if (delta.GetMilliseconds() > 1000)
 		{ //report buffers state and tempo adjust every second
-			ConLog("buffers: %4d ms (%3.0f%%), tempo: %f, comp: %2.3f, iters: %d, (N-IPS:%d -> avg:%d, minokc:%d, div:%d) reset:%d\n",
-				   (int)(data / 48), (double)(100.0 * bufferFullness / baseTargetFullness), (double)tempoAdjust, (double)(dynamicTargetFullness / baseTargetFullness), iters, (int)targetIPS, AVERAGING_WINDOW, hys_min_ok_count, compensationDivider, gRequestStretcherReset);
+			ConLog("buffers: %4d ms (%3.0f%%), tempo: %f, comp: %2.3f, iters: %d, (N-IPS:%d -> avg:%d, minokc:%d, div:%d) reset:%d, underruns:%u, overruns:%u\n",
+				   (int)(data / 48), (double)(100.0 * bufferFullness / baseTargetFullness), (double)tempoAdjust, (double)(dynamicTargetFullness / baseTargetFullness), iters, (int)targetIPS, AVERAGING_WINDOW, hys_min_ok_count, compensationDivider, gRequestStretcherReset,
+				   m_underruns.load(std::memory_order_relaxed), m_overruns.load(std::memory_order_relaxed));
 			last = unow;
 			iters = 0;
 		}
@@ -526,6 +561,15 @@ void SndBuffer::soundtouchInit()
 
 	SoundtouchCfg::ApplySettings(*pSoundTouch);
 
+	// SoundTouch buffers about a sequence and a seek window of input before it outputs
+	// anything, the configured 30+20ms alone would exceed the low latency target.
+	if (IsLowLatency())
+	{
+		pSoundTouch->setSetting(SETTING_SEQUENCE_MS, 20);
+		pSoundTouch->setSetting(SETTING_SEEKWINDOW_MS, 10);
+		pSoundTouch->setSetting(SETTING_OVERLAP_MS, 5);
+	}
+
 	pSoundTouch->setTempo(1);
 
 	// some timestretch management vars:
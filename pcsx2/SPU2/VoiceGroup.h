@@ -0,0 +1,199 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The SSE4.1 stages of the voice mixing (Mixer.cpp). They only depend on the common
+// headers so that tests/ctest/spu2 can check them against the math of MixVoice.
+
+#pragma once
+
+#include "Pcsx2Defs.h"
+#include "interpolate_table.h"
+
+// Voices are mixed by groups of 4. The voice updates (pitch, sample fetch, ADSR) run one
+// voice at a time and gather the values of the sample into the lanes of a VoiceGroup.
+// The interpolation, the envelope and volumes and the gates are then applied to the 4
+// voices at once, with the same integer math as MixVoice.
+struct VoiceGroup
+{
+	static const uint Size = 4;
+
+	alignas(16) s32 PV1[Size];
+	alignas(16) s32 PV2[Size];
+	alignas(16) s32 PV3[Size];
+	alignas(16) s32 PV4[Size];
+	alignas(16) s32 Mu[Size];       // interpolation position (0.12)
+	alignas(16) s32 Direct[Size];   // -1: the value is PV1 (noise, or a voice that is off)
+	alignas(16) s32 Envelope[Size]; // ADSR.Value
+	alignas(16) s32 VolL[Size];
+	alignas(16) s32 VolR[Size];
+	bool Active[Size];
+};
+
+static __forceinline __m128i MulShr32(__m128i srcval, __m128i mulval)
+{
+	const __m128i even = _mm_srli_epi64(_mm_mul_epi32(srcval, mulval), 32);
+	const __m128i odd = _mm_mul_epi32(_mm_srli_epi64(srcval, 32), _mm_srli_epi64(mulval, 32));
+	return _mm_blend_epi16(even, odd, 0xcc);
+}
+
+static __forceinline __m128i ApplyVolume(__m128i data, __m128i volume)
+{
+	return MulShr32(_mm_slli_epi32(data, 1), volume);
+}
+
+static __forceinline __m128i MulShr12(__m128i a, __m128i mu)
+{
+	return _mm_srai_epi32(_mm_mullo_epi32(a, mu), 12);
+}
+
+template <int InterpType>
+static __forceinline __m128i InterpolateVoices(const VoiceGroup& group)
+{
+	const __m128i y0 = _mm_load_si128((const __m128i*)group.PV4);
+	const __m128i y1 = _mm_load_si128((const __m128i*)group.PV3);
+	const __m128i y2 = _mm_load_si128((const __m128i*)group.PV2);
+	const __m128i y3 = _mm_load_si128((const __m128i*)group.PV1);
+	const __m128i mu = _mm_load_si128((const __m128i*)group.Mu);
+
+	static_assert(InterpType >= 0 && InterpType <= 5, "unknown interpolation");
+
+	switch (InterpType)
+	{
+		case 0:
+			return y3;
+		case 1:
+			return _mm_sub_epi32(y3, MulShr12(_mm_sub_epi32(y2, y3), mu));
+
+		case 2: // CubicInterpolate
+		{
+			const __m128i a0 = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(y3, y2), y0), y1);
+			const __m128i a1 = _mm_sub_epi32(_mm_sub_epi32(y0, y1), a0);
+			const __m128i a2 = _mm_sub_epi32(y2, y0);
+
+			__m128i val = MulShr12(a0, mu);
+			val = MulShr12(_mm_add_epi32(val, a1), mu);
+			val = MulShr12(_mm_add_epi32(val, a2), mu);
+
+			return _mm_add_epi32(val, y1);
+		}
+		case 3: // HermiteInterpolate<16384>
+		{
+			const __m128i tension = _mm_set1_epi32(16384);
+			const __m128i m00 = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(y1, y0), tension), 16);
+			const __m128i m01 = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(y2, y1), tension), 16);
+			const __m128i m11 = _mm_srai_epi32(_mm_mullo_epi32(_mm_sub_epi32(y3, y2), tension), 16);
+			const __m128i m0 = _mm_add_epi32(m00, m01);
+			const __m128i m1 = _mm_add_epi32(m01, m11);
+
+			const __m128i y1x2 = _mm_slli_epi32(y1, 1);
+			const __m128i y2x2 = _mm_slli_epi32(y2, 1);
+			const __m128i y1x3 = _mm_add_epi32(y1x2, y1);
+			const __m128i y2x3 = _mm_add_epi32(y2x2, y2);
+
+			__m128i val = MulShr12(_mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(y1x2, m0), m1), y2x2), mu);
+			val = _mm_sub_epi32(_mm_sub_epi32(_mm_sub_epi32(val, y1x3), _mm_slli_epi32(m0, 1)), m1);
+			val = MulShr12(_mm_add_epi32(val, y2x3), mu);
+			val = MulShr12(_mm_add_epi32(val, m0), mu);
+
+			return _mm_add_epi32(val, y1);
+		}
+		case 4: // CatmullRomInterpolate
+		{
+			const __m128i y1x2 = _mm_slli_epi32(y1, 1);
+			const __m128i y1x3 = _mm_add_epi32(y1x2, y1);
+			const __m128i y2x3 = _mm_add_epi32(_mm_slli_epi32(y2, 1), y2);
+
+			const __m128i a3 = _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(y1x3, y0), y2x3), y3);
+			const __m128i a2 = _mm_sub_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(y0, 1),
+				_mm_add_epi32(_mm_slli_epi32(y1, 2), y1)), _mm_slli_epi32(y2, 2)), y3);
+			const __m128i a1 = _mm_sub_epi32(y2, y0);
+
+			__m128i val = MulShr12(a3, mu);
+			val = MulShr12(_mm_add_epi32(a2, val), mu);
+			val = MulShr12(_mm_add_epi32(a1, val), mu);
+
+			return _mm_srai_epi32(_mm_add_epi32(y1x2, val), 1);
+		}
+		case 5: // GaussianInterpolate
+		{
+			const s32 i0 = (group.Mu[0] & 0x0ff0) >> 4;
+			const s32 i1 = (group.Mu[1] & 0x0ff0) >> 4;
+			const s32 i2 = (group.Mu[2] & 0x0ff0) >> 4;
+			const s32 i3 = (group.Mu[3] & 0x0ff0) >> 4;
+			const __m128i c0 = _mm_setr_epi32(interpTable[0x0FF - i0], interpTable[0x0FF - i1], interpTable[0x0FF - i2], interpTable[0x0FF - i3]);
+			const __m128i c1 = _mm_setr_epi32(interpTable[0x1FF - i0], interpTable[0x1FF - i1], interpTable[0x1FF - i2], interpTable[0x1FF - i3]);
+			const __m128i c2 = _mm_setr_epi32(interpTable[0x100 + i0], interpTable[0x100 + i1], interpTable[0x100 + i2], interpTable[0x100 + i3]);
+			const __m128i c3 = _mm_setr_epi32(interpTable[0x000 + i0], interpTable[0x000 + i1], interpTable[0x000 + i2], interpTable[0x000 + i3]);
+
+			__m128i out = _mm_srai_epi32(_mm_mullo_epi32(c0, y0), 15);
+			out = _mm_add_epi32(out, _mm_srai_epi32(_mm_mullo_epi32(c1, y1), 15));
+			out = _mm_add_epi32(out, _mm_srai_epi32(_mm_mullo_epi32(c2, y2), 15));
+			out = _mm_add_epi32(out, _mm_srai_epi32(_mm_mullo_epi32(c3, y3), 15));
+
+			return out;
+		}
+	}
+
+	return _mm_setzero_si128(); // technically unreachable!
+}
+
+// The outputs of the 4 voices with the envelope applied, the OutX of MixVoice
+template <int InterpType>
+static __forceinline __m128i VoiceGroupValues(const VoiceGroup& group)
+{
+	__m128i value = InterpolateVoices<InterpType>(group);
+	value = _mm_blendv_epi8(value, _mm_load_si128((const __m128i*)group.PV1), _mm_load_si128((const __m128i*)group.Direct));
+
+	// Update and Apply ADSR (see MixVoice)
+	return ApplyVolume(value, _mm_load_si128((const __m128i*)group.Envelope));
+}
+
+// The dry and wet sums of the voice groups of a core
+struct VoiceGroupSums
+{
+	__m128i DryL = _mm_setzero_si128();
+	__m128i DryR = _mm_setzero_si128();
+	__m128i WetL = _mm_setzero_si128();
+	__m128i WetR = _mm_setzero_si128();
+
+	// Adds the outputs of the group through the L/R volumes and the gates of its 4 voices
+	// (the DryL, DryR, WetL, WetR of V_VoiceGates for each voice)
+	__forceinline void Add(const VoiceGroup& group, __m128i value, const s16* gates)
+	{
+		const __m128i left = ApplyVolume(value, _mm_load_si128((const __m128i*)group.VolL));
+		const __m128i right = ApplyVolume(value, _mm_load_si128((const __m128i*)group.VolR));
+
+		// The gates of 4 voices, transposed to one vector per gate
+		const __m128i gates01 = _mm_loadu_si128((const __m128i*)gates);
+		const __m128i gates23 = _mm_loadu_si128((const __m128i*)(gates + 8));
+		const __m128i gates02 = _mm_unpacklo_epi16(gates01, gates23);
+		const __m128i gates13 = _mm_unpackhi_epi16(gates01, gates23);
+		const __m128i dry = _mm_unpacklo_epi16(gates02, gates13);
+		const __m128i wet = _mm_unpackhi_epi16(gates02, gates13);
+
+		DryL = _mm_add_epi32(DryL, _mm_and_si128(left, _mm_cvtepi16_epi32(dry)));
+		DryR = _mm_add_epi32(DryR, _mm_and_si128(right, _mm_cvtepi16_epi32(_mm_srli_si128(dry, 8))));
+		WetL = _mm_add_epi32(WetL, _mm_and_si128(left, _mm_cvtepi16_epi32(wet)));
+		WetR = _mm_add_epi32(WetR, _mm_and_si128(right, _mm_cvtepi16_epi32(_mm_srli_si128(wet, 8))));
+	}
+
+	// Horizontal sums: Dry.Left, Dry.Right, Wet.Left, Wet.Right
+	__forceinline void Get(s32 (&sums)[4]) const
+	{
+		const __m128i dry_lr = _mm_hadd_epi32(DryL, DryR);
+		const __m128i wet_lr = _mm_hadd_epi32(WetL, WetR);
+		_mm_storeu_si128((__m128i*)sums, _mm_hadd_epi32(dry_lr, wet_lr));
+	}
+};
@@ -21,14 +21,183 @@
 #include "soundtouch/source/SoundStretch/WavFile.h"
 #endif
 
-static WavOutFile* _new_WavOutFile(const char* destfile)
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------------------------------------
+//  WavWriter
+// --------------------------------------------------------------------------------------
+// Writes the wave files behind the mixing: the samples are collected in blocks, and the
+// full blocks are queued to a thread that writes them to disk. The queue is bounded, the
+// mixing only waits when the disk is behind by all of the blocks (a few seconds of audio
+// for each open file).
+class WavWriter
 {
-	return new WavOutFile(destfile, 48000, 16, 2);
-}
+public:
+	static const uint BlockSize = 4096; // samples
+	static const uint MaxBlocks = 256;
+
+	struct Block
+	{
+		WavOutFile* File;
+		bool Close; // the file is closed once the block was written
+		uint Count;
+		StereoOut16 Samples[BlockSize];
+	};
+
+private:
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cond_queued; // a block was queued, or the thread must quit
+	std::condition_variable m_cond_freed;  // a block was written
+	std::deque<Block*> m_queue;
+	std::vector<Block*> m_free;
+	uint m_allocated = 0;
+	uint m_pending = 0; // queued or being written
+	uint m_files = 0;
+	bool m_quit = false;
+
+	void Run()
+	{
+		std::vector<Block*> batch;
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		for (;;)
+		{
+			m_cond_queued.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+			if (m_queue.empty())
+				break;
+
+			// Takes all of the queued blocks, they're written without holding the lock
+			batch.assign(m_queue.begin(), m_queue.end());
+			m_queue.clear();
+			lock.unlock();
+
+			for (Block* block : batch)
+			{
+				if (block->Count)
+					block->File->write((s16*)block->Samples, block->Count * 2);
+				if (block->Close)
+					delete block->File;
+			}
+
+			lock.lock();
+			m_free.insert(m_free.end(), batch.begin(), batch.end());
+			m_pending -= batch.size();
+			m_cond_freed.notify_all();
+		}
+	}
+
+public:
+	// Starts the thread with the first open file
+	void Open()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if (m_files++ == 0)
+		{
+			m_quit = false;
+			m_thread = std::thread(&WavWriter::Run, this);
+		}
+	}
+
+	// Waits till everything queued was written (the closed files are complete when the
+	// same name is opened again), and stops the thread with the last open file.
+	void Close()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond_freed.wait(lock, [this] { return m_pending == 0; });
+		if (--m_files != 0)
+			return;
+
+		m_quit = true;
+		m_cond_queued.notify_one();
+		lock.unlock();
+		m_thread.join();
+
+		for (Block* block : m_free)
+			delete block;
+		m_free.clear();
+		m_allocated = 0;
+	}
+
+	Block* Acquire(WavOutFile* file)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		Block* block;
+		if (m_free.empty() && m_allocated < MaxBlocks)
+		{
+			block = new Block;
+			m_allocated++;
+		}
+		else
+		{
+			m_cond_freed.wait(lock, [this] { return !m_free.empty(); });
+			block = m_free.back();
+			m_free.pop_back();
+		}
+
+		block->File = file;
+		block->Close = false;
+		block->Count = 0;
+		return block;
+	}
+
+	void Queue(Block* block)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_queue.push_back(block);
+		m_pending++;
+		m_cond_queued.notify_one();
+	}
+};
+
+static WavWriter s_WavWriter;
+
+// A wave file written by s_WavWriter
+class AsyncWavOutFile
+{
+	WavOutFile* m_file;
+	WavWriter::Block* m_block = nullptr;
+
+public:
+	// Throws std::runtime_error when the file can't be opened.
+	AsyncWavOutFile(const char* filename)
+		: m_file(new WavOutFile(filename, 48000, 16, 2))
+	{
+		s_WavWriter.Open();
+	}
+
+	~AsyncWavOutFile()
+	{
+		if (m_block == nullptr)
+			m_block = s_WavWriter.Acquire(m_file);
+		m_block->Close = true;
+		s_WavWriter.Queue(m_block);
+		s_WavWriter.Close();
+	}
+
+	__fi void Write(const StereoOut16& sample)
+	{
+		if (m_block == nullptr)
+			m_block = s_WavWriter.Acquire(m_file);
+
+		m_block->Samples[m_block->Count++] = sample;
+
+		if (m_block->Count == WavWriter::BlockSize)
+		{
+			s_WavWriter.Queue(m_block);
+			m_block = nullptr;
+		}
+	}
+};
 
 namespace WaveDump
 {
-	static WavOutFile* m_CoreWav[2][CoreSrc_Count];
+	static AsyncWavOutFile* m_CoreWav[2][CoreSrc_Count];
 
 	static const char* m_tbl_CoreOutputTypeNames[CoreSrc_Count] =
 		{
@@ -63,7 +232,7 @@ namespace WaveDump
 
 				try
 				{
-					m_CoreWav[cidx][srcidx] = _new_WavOutFile(wavfilename);
+					m_CoreWav[cidx][srcidx] = new AsyncWavOutFile(wavfilename);
 				}
 				catch (std::runtime_error& ex)
 				{
@@ -92,7 +261,7 @@ namespace WaveDump
 		if (!IsDevBuild)
 			return;
 		if (m_CoreWav[coreidx][src] != nullptr)
-			m_CoreWav[coreidx][src]->write((s16*)&sample, 2);
+			m_CoreWav[coreidx][src]->Write(sample);
 	}
 
 	void WriteCore(uint coreidx, CoreSourceType src, s16 left, s16 right)
@@ -107,7 +276,7 @@ using namespace Threading;
 
 bool WavRecordEnabled = false;
 
-static WavOutFile* m_wavrecord = nullptr;
+static AsyncWavOutFile* m_wavrecord = nullptr;
 static Mutex WavRecordMutex;
 
 bool RecordStart(const std::string* filename)
@@ -117,9 +286,9 @@ bool RecordStart(const std::string* filename)
 		ScopedLock lock(WavRecordMutex);
 		safe_delete(m_wavrecord);
 		if (filename)
-			m_wavrecord = new WavOutFile(filename->c_str(), 48000, 16, 2);
+			m_wavrecord = new AsyncWavOutFile(filename->c_str());
 		else
-			m_wavrecord = new WavOutFile("audio_recording.wav", 48000, 16, 2);
+			m_wavrecord = new AsyncWavOutFile("audio_recording.wav");
 		WavRecordEnabled = true;
 		return true;
 	}
@@ -146,5 +315,5 @@ void RecordWrite(const StereoOut16& sample)
 	ScopedLock lock(WavRecordMutex);
 	if (m_wavrecord == nullptr)
 		return;
-	m_wavrecord->write((s16*)&sample, 2);
+	m_wavrecord->Write(sample);
 }
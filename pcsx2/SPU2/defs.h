@@ -547,12 +547,17 @@ struct V_Core
 	void AutoDMAReadBuffer(int mode);
 	void StartADMAWrite(u16* pMem, u32 sz);
 	void PlainDMAWrite(u16* pMem, u32 sz);
-	void FinishDMAwrite();
+	void FinishDMAwrite(bool bulk = false);
 };
 
 extern V_Core Cores[2];
 extern V_SPDIF Spdif;
 
+// Voices with an ADSR phase, one bit per voice of each core: set by StartQueuedVoice,
+// cleared when the voice stops. Not part of the savestates, UpdateActiveVoices rebuilds
+// it from the voices.
+extern u32 ActiveVoices[2];
+
 // Output Buffer Writing Position (the same for all data);
 extern s16 OutPos;
 // Input Buffer Reading Position (the same for all data);
@@ -568,6 +573,7 @@ extern void SetIrqCall(int core);
 extern void SetIrqCallDMA(int core);
 extern void StartVoices(int core, u32 value);
 extern void StopVoices(int core, u32 value);
+extern void UpdateActiveVoices();
 extern void InitADSR();
 extern void CalculateADSR(V_Voice& vc);
 extern void UpdateSpdifMode();
@@ -602,9 +608,25 @@ static const int pcm_DecodedSamplesPerBlock = 28;
 struct PcmCacheEntry
 {
 	bool Validated;
+	// The block uses a prediction filter, the samples depend on the Prev1/Prev2 it was
+	// decoded with. Other blocks can be reused whatever the history of the voice is.
+	bool Filtered;
 	s16 Sampledata[pcm_DecodedSamplesPerBlock];
 	s32 Prev1;
 	s32 Prev2;
 };
 
 extern PcmCacheEntry* pcm_cache_data;
+
+// Invalidates the cached block of a SPU2 ram word (word address)
+static __forceinline void pcm_InvalidateBlock(u32 addr)
+{
+	pcm_cache_data[addr / pcm_WordsPerBlock].Validated = false;
+}
+
+// Invalidates the cached blocks of the SPU2 ram words [start, end)
+static __forceinline void pcm_InvalidateRange(u32 start, u32 end)
+{
+	for (u32 block = start / pcm_WordsPerBlock; block < (end + pcm_WordsPerBlock - 1) / pcm_WordsPerBlock; block++)
+		pcm_cache_data[block].Validated = false;
+}
@@ -539,6 +539,24 @@ void SPU2endRecording()
 		RecordStop();
 }
 
+void SPU2reportLatency()
+{
+	SndBuffer::ReportLatency();
+}
+
+void SPU2setOutputMuted(bool muted)
+{
+	SndBuffer::OutputMuted = muted;
+}
+
+void SPU2setOutputSuppressed(bool suppressed)
+{
+	if (SndBuffer::OutputSuppressed == suppressed)
+		return;
+
+	SndBuffer::OutputSuppressed = suppressed;
+}
+
 s32 SPU2freeze(FreezeAction mode, freezeData* data)
 {
 	pxAssume(data != nullptr);
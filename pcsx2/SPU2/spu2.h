@@ -35,6 +35,18 @@ u16 SPU2read(u32 mem);
 bool SPU2setupRecording(const std::string* filename);
 void SPU2endRecording();
 
+// Shows the output latency and underruns on the OSD (MTGS thread)
+void SPU2reportLatency();
+
+// Drops the mixed samples instead of outputting (or recording) them, for the frames that
+// run-ahead rolls back.  Applies from the IOP cycle of the call on.
+void SPU2setOutputMuted(bool muted);
+
+// Skips the whole output stage of the mixer (filters, timestretching and the output module)
+// for the max throughput mode.  The voices, reverb and the output written to the SPU2 memory
+// still run, since games can see those.
+void SPU2setOutputSuppressed(bool suppressed);
+
 void SPU2async(u32 cycles);
 s32 SPU2freeze(FreezeAction mode, freezeData* data);
 void SPU2configure();
@@ -102,7 +102,9 @@ s32 __fastcall SPU2Savestate::ThawIt(DataBlock& spud)
 	}
 	else
 	{
-		SndBuffer::ClearContents();
+		// Run-ahead rolls back with the output muted, what was output already stays queued
+		if (!SndBuffer::OutputMuted)
+			SndBuffer::ClearContents();
 
 		pxAssertMsg(spu2regs && _spu2mem, "Looks like PCSX2 is trying to loadstate while components are shut down.  That's a no-no!  It shouldn't crash, but the savestate will probably be corrupted.");
 
@@ -135,6 +137,8 @@ s32 __fastcall SPU2Savestate::ThawIt(DataBlock& spud)
 			}
 		}
 
+		UpdateActiveVoices();
+
 		// HACKFIX!! DMAPtr can be invalid after a savestate load, so force it to nullptr and
 		// ignore it on any pending ADMA writes.  (the DMAPtr concept used to work in old VM
 		// editions of PCSX2 with fixed addressing, but new PCSX2s have dynamic memory
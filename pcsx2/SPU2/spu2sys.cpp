@@ -26,6 +26,7 @@
 #include "IopDma.h"
 #include "IopCommon.h"
 
+#include "Timeline.h"
 #include "spu2.h" // needed until I figure out a nice solution for irqcallback dependencies.
 
 s16* spu2regs = nullptr;
@@ -35,6 +36,8 @@ V_CoreDebug DebugCores[2];
 V_Core Cores[2];
 V_SPDIF Spdif;
 
+u32 ActiveVoices[2];
+
 s16 OutPos;
 s16 InputPos;
 u32 Cycles;
@@ -86,7 +89,7 @@ __forceinline void spu2M_Write(u32 addr, s16 value)
 	if (addr >= SPU2_DYN_MEMLINE)
 	{
 		const int cacheIdx = addr / pcm_WordsPerBlock;
-		pcm_cache_data[cacheIdx].Validated = false;
+		pcm_InvalidateBlock(addr);
 
 		if (MsgToConsole() && MsgCache())
 			ConLog("* SPU2: PcmCache Block Clear at 0x%x (cacheIdx=0x%x)\n", addr, cacheIdx);
@@ -210,6 +213,7 @@ void V_Core::Init(int index)
 		Voices[v].StartA = 0x2800;
 		Voices[v].LoopStartA = 0x2800;
 	}
+	ActiveVoices[c] = 0;
 
 	DMAICounter = 0;
 	AutoDmaFree = 0;
@@ -351,6 +355,19 @@ void V_Voice::Stop()
 	ADSR.Phase = 0;
 }
 
+void UpdateActiveVoices()
+{
+	for (uint c = 0; c < 2; c++)
+	{
+		ActiveVoices[c] = 0;
+		for (uint v = 0; v < V_Core::NumVoices; v++)
+		{
+			if (Cores[c].Voices[v].ADSR.Phase > 0)
+				ActiveVoices[c] |= 1 << v;
+		}
+	}
+}
+
 uint TickInterval = 768;
 static const int SanityInterval = 4800;
 extern void UpdateDebugDialog();
@@ -371,6 +388,7 @@ __forceinline bool StartQueuedVoice(uint coreidx, uint voiceidx)
 	vc.ADSR.Releasing = false;
 	vc.ADSR.Value = 1;
 	vc.ADSR.Phase = 1;
+	ActiveVoices[coreidx] |= 1 << voiceidx;
 	vc.SCurrent = 28;
 	vc.LoopMode = 0;
 	vc.SP = 0;
@@ -414,12 +432,13 @@ __forceinline void TimeUpdate(u32 cClocks)
 	UpdateDebugDialog();
 #endif
 
-	if (SynchMode == 1) // AsyncMix on
+	if (SynchMode == 1 && !SndBuffer::OutputSuppressed) // AsyncMix on, its tempo follows a buffer that isn't fed
 		SndBuffer::UpdateTempoChangeAsyncMixing();
 	else
 		TickInterval = 768; // Reset to default, in case the user hotswitched from async to something else.
 
 	//Update Mixing Progress
+	TIMELINE_SCOPE_IF("SPU2 mix", dClocks >= TickInterval);
 	while (dClocks >= TickInterval)
 	{
 		for (int i = 0; i < 2; i++)
@@ -1558,6 +1577,7 @@ static void __fastcall RegWrite_Core(u16 value)
 					Cores[1].Voices[v].LoopStartA = 0x6FFFF;
 					Cores[1].Voices[v].Modulated = 0;
 				}
+				ActiveVoices[1] = 0;
 				return;
 			}
 			thiscore.AutoDMACtrl = value;
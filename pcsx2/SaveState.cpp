@@ -22,6 +22,7 @@
 #include "COP0.h"
 #include "VUmicro.h"
 #include "MTVU.h"
+#include "IPU/IPUthread.h"
 #include "Cache.h"
 #include "AppConfig.h"
 
@@ -32,6 +33,9 @@
 #include "SPU2/spu2.h"
 #include "gui/ConsoleLogger.h"
 
+#include <memory>
+#include <mutex>
+
 using namespace R5900;
 
 
@@ -44,8 +48,12 @@ static void PostLoadPrep()
 {
 	resetCache();
 //	WriteCP0Status(cpuRegs.CP0.n.Status.val);
+	vtlb_BeginRemap();
 	for(int i=0; i<48; i++) MapTLB(i);
+	cpuSetIntsDue();
+	psxSetIntsDue();
 	if (EmuConfig.Gamefixes.GoemonTlbHack) GoemonPreloadTlb();
+	vtlb_EndRemap();
 
 	UpdateVSyncRate();
 }
@@ -88,7 +96,7 @@ void SaveStateBase::PrepBlock( int size )
 
 	const int end = m_idx+size;
 	if( IsSaving() )
-		m_memory->MakeRoomFor( end );
+		Reserve( end );
 	else
 	{
 		if( m_memory->GetSizeInBytes() < end )
@@ -154,6 +162,8 @@ static const uint MainMemorySizeInBytes =
 SaveStateBase& SaveStateBase::FreezeMainMemory()
 {
 	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	vu0Thread.Finish(true);
+	ipuThread.Wait();
 	if (IsLoading()) PreLoadPrep();
 	else m_memory->MakeRoomFor( m_idx + MainMemorySizeInBytes );
 
@@ -178,6 +188,8 @@ SaveStateBase& SaveStateBase::FreezeMainMemory()
 SaveStateBase& SaveStateBase::FreezeInternals()
 {
 	vu1Thread.WaitVU(); // Finish VU1 just in-case...
+	vu0Thread.Finish(true);
+	ipuThread.Wait();
 	// Print this until the MTVU problem in gifPathFreeze is taken care of (rama)
 	if (THREAD_VU1) Console.Warning("MTVU speedhack is enabled, saved states may not be stable");
 	
@@ -247,14 +259,35 @@ SaveStateBase& SaveStateBase::FreezeInternals()
 // --------------------------------------------------------------------------------------
 // uncompressed to/from memory state saves implementation
 
+std::atomic<int> memSavingState::s_PeakSize( 0 );
+
 memSavingState::memSavingState( SafeArray<u8>& save_to )
 	: SaveStateBase( save_to )
 {
+	Reserve( s_PeakSize.load( std::memory_order_relaxed ) );
 }
 
 memSavingState::memSavingState( SafeArray<u8>* save_to )
 	: SaveStateBase( save_to )
 {
+	Reserve( s_PeakSize.load( std::memory_order_relaxed ) );
+}
+
+memSavingState::~memSavingState()
+{
+	int peak = s_PeakSize.load( std::memory_order_relaxed );
+	while( m_idx > peak && !s_PeakSize.compare_exchange_weak( peak, m_idx, std::memory_order_relaxed ) );
+}
+
+void memSavingState::Reserve( int size )
+{
+	const int current = m_memory->GetSizeInBytes();
+	if( size <= current ) return;
+
+	// Geometric growth, in whole realloc blocks: a state is made of many small freezes
+	const int grown = std::max( size, current + current / 2 );
+	m_memory->ExactAlloc( (grown + ReallocThreshold - 1) & ~(ReallocThreshold - 1) );
+	HostSys::HintHugePages( m_memory->GetPtr(), m_memory->GetSizeInBytes() );
 }
 
 // Saving of state data
@@ -262,8 +295,9 @@ void memSavingState::FreezeMem( void* data, int size )
 {
 	if (!size) return;
 
-	m_memory->MakeRoomFor( m_idx + size );
-	memcpy( m_memory->GetPtr(m_idx), data, size );
+	Reserve( m_idx + size );
+	// the state isn't read back soon, keep it out of the caches
+	memcpy_stream( m_memory->GetPtr(m_idx), data, size );
 	m_idx += size;
 }
 
@@ -271,8 +305,40 @@ void memSavingState::MakeRoomForData()
 {
 	pxAssertDev( m_memory, "Savestate memory/buffer pointer is null!" );
 
-	m_memory->ChunkSize = ReallocThreshold;
-	m_memory->MakeRoomFor( m_idx + MemoryBaseAllocSize );
+	Reserve( m_idx + MemoryBaseAllocSize );
+}
+
+// --------------------------------------------------------------------------------------
+//  VmStateArena  (implementations)
+// --------------------------------------------------------------------------------------
+static std::mutex s_ArenaLock;
+static std::unique_ptr<VmStateBuffer> s_ArenaSpare;
+
+VmStateBuffer* VmStateArena_Acquire( const wxChar* name )
+{
+	std::unique_ptr<VmStateBuffer> buffer;
+	{
+		std::lock_guard<std::mutex> lock( s_ArenaLock );
+		buffer = std::move( s_ArenaSpare );
+	}
+
+	if( buffer )
+		buffer->Name = name;
+	else
+		buffer.reset( new VmStateBuffer( name ) );
+
+	return buffer.release();
+}
+
+void VmStateArena_Release( VmStateBuffer* buffer )
+{
+	// Frees the smaller buffer, out of the lock
+	std::unique_ptr<VmStateBuffer> released( buffer );
+	if( !released ) return;
+
+	std::lock_guard<std::mutex> lock( s_ArenaLock );
+	if( !s_ArenaSpare || s_ArenaSpare->GetSizeInBytes() < released->GetSizeInBytes() )
+		s_ArenaSpare.swap( released );
 }
 
 // --------------------------------------------------------------------------------------
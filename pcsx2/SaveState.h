@@ -15,6 +15,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "System.h"
 #include "Utilities/Exceptions.h"
 
@@ -31,7 +33,7 @@ enum class FreezeAction
 //  the lower 16 bit value.  IF the change is breaking of all compatibility with old
 //  states, increment the upper 16 bit value, and clear the lower 16 bits to 0.
 
-static const u32 g_SaveVersion = (0x9A21 << 16) | 0x0000;
+static const u32 g_SaveVersion = (0x9A22 << 16) | 0x0000;
 
 // the freezing data between submodules and core
 // an interesting thing to note is that this dates back from before plugin
@@ -99,6 +101,8 @@ public:
 		FreezeMem( &data, sizeof( T ) - sizeOfNewStuff );
 	}
 
+	// Makes room for size bytes at the current position, when saving (asserts otherwise).
+	// The caller may then write them directly at GetBlockPtr.
 	void PrepBlock( int size );
 
 	uint GetCurrentPos() const
@@ -143,6 +147,9 @@ public:
 protected:
 	void Init( VmStateBuffer* memblock );
 
+	// Grows the buffer of a saving state to at least size bytes
+	virtual void Reserve( int size ) { m_memory->MakeRoomFor( size ); }
+
 	// Load/Save functions for the various components of our glorious emulator!
 
 	void mtvuFreeze();
@@ -179,6 +186,9 @@ protected:
 //  Saving and Loading Specialized Implementations...
 // --------------------------------------------------------------------------------------
 
+// The buffer is sized up front to the largest state saved so far, so that saves don't grow
+// it piecewise, and grows geometrically past that.  Reuse the buffer across saves (or get it
+// from VmStateArena_Acquire) to also skip the allocation and its page faults.
 class memSavingState : public SaveStateBase
 {
 	typedef SaveStateBase _parent;
@@ -187,8 +197,12 @@ protected:
 	static const int ReallocThreshold		= _1mb / 4;		// 256k reallocation block size.
 	static const int MemoryBaseAllocSize	= _8mb;			// 8 meg base alloc when PS2 main memory is excluded
 
+	static std::atomic<int> s_PeakSize;						// largest state saved so far
+
+	void Reserve( int size );
+
 public:
-	virtual ~memSavingState() = default;
+	virtual ~memSavingState();
 	memSavingState( VmStateBuffer& save_to );
 	memSavingState( VmStateBuffer* save_to );
 
@@ -214,6 +228,11 @@ public:
 };
 
 
+// Whole-state buffers for saves that hand their buffer off (to the zip thread, for one).  The
+// arena keeps the largest released buffer, allocated and faulted in, for the next save.
+extern VmStateBuffer* VmStateArena_Acquire( const wxChar* name );
+extern void VmStateArena_Release( VmStateBuffer* buffer );
+
 namespace Exception
 {
 	// Exception thrown when a corrupted or truncated savestate is encountered.
@@ -87,6 +87,49 @@ static __fi bool WriteIOPtoFifo()
 	return true;
 }
 
+// Write IOP straight to EE, while the fifo is empty and both sides are in the middle of
+// a transfer.  Same as going through the fifo, without the fifo-sized steps.
+static __fi bool WriteIOPtoEE()
+{
+	if (sif0.fifo.size != 0 || sif0.iop.counter < 4 || sif0ch.qwc <= 0 || !sif0ch.chcr.STR)
+		return false;
+
+	// Main memory only, the other destinations are left to WriteFifoToEE.
+	if (DMA_TAG(sif0ch.madr).SPR)
+		return false;
+
+	const u32 eeaddr = sif0ch.madr & 0x1ffffff0;
+	const u32 iopaddr = hw_dma9.madr & 0x1fffff;
+	if (eeaddr >= Ps2MemSize::MainRam)
+		return false;
+
+	int size = std::min((s32)sif0ch.qwc, sif0.iop.counter >> 2);
+	size = std::min(size, (int)((Ps2MemSize::MainRam - eeaddr) >> 4));
+	size = std::min(size, (int)((Ps2MemSize::IopRam - iopaddr) >> 4));
+	if (size <= 0)
+		return false;
+
+	SIF_LOG("Write IOP to EE: =========== %lX of %lX", size << 2, sif0.iop.counter);
+
+	memcpy(&eeMem->Main[eeaddr], iopPhysMem(iopaddr), size << 4);
+
+	hw_dma9.madr += size << 4;
+	sif0.iop.cycles += size << 2;
+	sif0.iop.counter -= size << 2;
+
+	sif0ch.madr += size << 4;
+	sif0.ee.cycles += size;
+	sif0ch.qwc -= size;
+
+	if (sif0ch.qwc == 0 && dmacRegs.ctrl.STS == STS_SIF0)
+	{
+		if ((sif0ch.chcr.MOD == NORMAL_MODE) || ((sif0ch.chcr.TAG >> 28) & 0x7) == TAG_CNTS)
+			dmacRegs.stadr.ADDR = sif0ch.madr;
+	}
+
+	return true;
+}
+
 // Read Fifo into an ee tag, transfer it to sif0ch, and process it.
 static __fi bool ProcessEETag()
 {
@@ -308,6 +351,9 @@ __fi void SIF0Dma()
 		//I realise this is very hacky in a way but its an easy way of checking if both are doing something
 		BusyCheck = 0;
 
+		if (sif0.iop.busy && sif0.ee.busy && WriteIOPtoEE())
+			BusyCheck++;
+
 		if (sif0.iop.counter == 0 && sif0.iop.writeJunk && sif0.fifo.sif_free() >= sif0.iop.writeJunk)
 		{
 			SIF_LOG("Writing Junk %d", sif0.iop.writeJunk);
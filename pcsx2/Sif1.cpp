@@ -79,6 +79,49 @@ static __fi bool WriteFifoToIOP()
 	return true;
 }
 
+// Write EE straight to IOP, while the fifo is empty and both sides are in the middle of
+// a transfer.  Same as going through the fifo, without the fifo-sized steps.
+static __fi bool WriteEEtoIOP()
+{
+	if (sif1.fifo.size != 0 || sif1.iop.counter < 4 || sif1ch.qwc <= 0 || !sif1ch.chcr.STR)
+		return false;
+
+	// The stall control checks every step against STADR.
+	if (dmacRegs.ctrl.STD == STD_SIF1)
+		return false;
+
+	// Main memory only, the other sources are left to WriteEEtoFifo.
+	if (DMA_TAG(sif1ch.madr).SPR)
+		return false;
+
+	const u32 eeaddr = sif1ch.madr & 0x1ffffff0;
+	const u32 iopaddr = hw_dma10.madr & 0x1fffff;
+	if (eeaddr >= Ps2MemSize::MainRam)
+		return false;
+
+	int size = std::min((s32)sif1ch.qwc, sif1.iop.counter >> 2);
+	size = std::min(size, (int)((Ps2MemSize::MainRam - eeaddr) >> 4));
+	size = std::min(size, (int)((Ps2MemSize::IopRam - iopaddr) >> 4));
+	if (size <= 0)
+		return false;
+
+	SIF_LOG("Sif 1: Write EE to IOP %04X to %08X", size << 2, HW_DMA10_MADR);
+
+	memcpy(iopPhysMem(iopaddr), &eeMem->Main[eeaddr], size << 4);
+	psxCpu->Clear(hw_dma10.madr, size << 2);
+
+	sif1ch.madr += size << 4;
+	hwDmacSrcTadrInc(sif1ch);
+	sif1.ee.cycles += size;
+	sif1ch.qwc -= size;
+
+	hw_dma10.madr += size << 4;
+	sif1.iop.cycles += size;
+	sif1.iop.counter -= size << 2;
+
+	return true;
+}
+
 // Get a tag and process it.
 static __fi bool ProcessEETag()
 {
@@ -290,6 +333,9 @@ __fi void SIF1Dma()
 		//I realise this is very hacky in a way but its an easy way of checking if both are doing something
 		BusyCheck = 0;
 
+		if (sif1.ee.busy && sif1.iop.busy && !sif1_dma_stall && WriteEEtoIOP())
+			BusyCheck++;
+
 		if (sif1.ee.busy && !sif1_dma_stall)
 		{
 			if(sif1.fifo.sif_free() > 0 || (sif1.ee.end && sif1ch.qwc == 0))
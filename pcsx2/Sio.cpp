@@ -20,6 +20,7 @@
 #include "ConsoleLogger.h"
 #include "Sio.h"
 #include "sio_internal.h"
+#include "InputLatency.h"
 #ifdef _WIN32
 #include "PAD/Windows/PAD.h"
 #else
@@ -210,6 +211,7 @@ SIO_WRITE sioWriteController(u8 data)
 		byteCnt = 0; //hope this gets only cleared on the first byte...
 		SIO_STAT_READY();
 		DEVICE_PLUGGED();
+		InputLatency::PadRead();
 		sio.buf[0] = PADstartPoll(sio.port + 1);
 		break;
 
@@ -34,6 +34,7 @@
 #include "iR5900.h"
 #include "System.h"
 #include "DebugTools/Debug.h"
+#include "AsyncLog.h"
 
 using namespace R5900;
 
@@ -52,23 +53,14 @@ void __Log(const char* fmt, ...)
 	va_start(list, fmt);
 
 	if (emuLog != NULL)
-	{
-		fputs(FastFormatAscii().WriteV(fmt, list), emuLog);
-		fputs("\n", emuLog);
-		fflush(emuLog);
-	}
+		AsyncLog::WriteLn(FastFormatAscii().WriteV(fmt, list));
 
 	va_end(list);
 }
 
 void SysTraceLog::DoWrite(const char* msg) const
 {
-	if (emuLog == NULL)
-		return;
-
-	fputs(msg, emuLog);
-	fputs("\n", emuLog);
-	fflush(emuLog);
+	AsyncLog::WriteLn(msg);
 }
 
 void SysTraceLog_EE::ApplyPrefix(FastFormatAscii& ascii) const
@@ -19,6 +19,7 @@
 #include "VUmicro.h"
 #include "newVif.h"
 #include "MTVU.h"
+#include "IPU/IPUthread.h"
 
 #include "Elfheader.h"
 
@@ -77,6 +78,9 @@ void RecompiledCodeReserve::Reset()
 
 bool RecompiledCodeReserve::Commit()
 {
+	// Code caches are only ever protected as a whole
+	m_huge_pages = EmuConfig.UseHugePages ? HugePages_Explicit : HugePages_None;
+
 	bool status = _parent::Commit();
 
 	if (IsDevBuild && m_baseptr)
@@ -250,6 +254,7 @@ void SysLogMachineCaps()
 	if( x86caps.hasAVX )							features[0].Add( L"AVX" );
 	if( x86caps.hasAVX2 )							features[0].Add( L"AVX2" );
 	if( x86caps.hasFMA)								features[0].Add( L"FMA" );
+	if( x86caps.hasAVX512F )						features[0].Add( L"AVX-512" );
 
 	if( x86caps.hasStreamingSIMD4ExtensionsA )		features[1].Add( L"SSE4a " );
 
@@ -439,6 +444,12 @@ void SysMainMemory::CommitAll()
 	DevCon.WriteLn( Color_StrongBlue, "Allocating host memory for virtual systems..." );
 	ConsoleIndentScope indent(1);
 
+	// The EE memory is protected a page at a time for the SMC, dirty and copy-on-write
+	// tracking, so it can only have the huge pages the kernel is able to split again
+	m_ee.SetHugePages(EmuConfig.UseHugePages ? HugePages_Transparent : HugePages_None);
+	m_iop.SetHugePages(EmuConfig.UseHugePages ? HugePages_Explicit : HugePages_None);
+	m_vu.SetHugePages(EmuConfig.UseHugePages ? HugePages_Explicit : HugePages_None);
+
 	m_ee.Commit();
 	m_iop.Commit();
 	m_vu.Commit();
@@ -471,6 +482,10 @@ void SysMainMemory::DecommitAll()
 	// The EE thread must be stopped here command mustn't be send
 	// to the ring. Let's call it an extra safety valve :)
 	vu1Thread.Reset();
+	vu0Thread.WaitVU();
+	vu0Thread.Reset();
+	ipuThread.Wait();
+	ipuThread.Reset();
 
 	m_ee.Decommit();
 	m_iop.Decommit();
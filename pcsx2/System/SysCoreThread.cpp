@@ -26,6 +26,7 @@
 #include "SysThreads.h"
 #include "MTVU.h"
 #include "IPC.h"
+#include "Timeline.h"
 #include "FW.h"
 #include "SPU2/spu2.h"
 #include "DEV9/DEV9.h"
@@ -50,6 +51,8 @@
 
 #include "x86emitter/x86_intrin.h"
 
+#include <future>
+
 bool g_CDVDReset = false;
 
 namespace IPCSettings
@@ -71,6 +74,10 @@ SysCoreThread::SysCoreThread()
 	m_resetVirtualMachine = true;
 
 	m_hasActiveMachine = false;
+
+	m_runAheadFrame = false;
+	m_hiddenFrame = false;
+	m_stateCheckRequested = false;
 }
 
 SysCoreThread::~SysCoreThread()
@@ -185,7 +192,7 @@ void SysCoreThread::ApplySettings(const Pcsx2Config& src)
 // --------------------------------------------------------------------------------------
 bool SysCoreThread::HasPendingStateChangeRequest() const
 {
-	return !m_hasActiveMachine || GetMTGS().HasPendingException() || _parent::HasPendingStateChangeRequest();
+	return !m_hasActiveMachine || m_stateCheckRequested || GetMTGS().HasPendingException() || _parent::HasPendingStateChangeRequest();
 }
 
 void SysCoreThread::_reset_stuff_as_needed()
@@ -242,8 +249,19 @@ void SysCoreThread::DoCpuReset()
 //
 void SysCoreThread::VsyncInThread()
 {
+	// the EE frame runs from the previous vsync to this one, the limiter wait included
+	static u64 s_frameStart = 0;
+	const u64 now = GetCPUTicks();
+	if (Timeline::IsEnabled() && s_frameStart)
+		Timeline::Record("EE frame", s_frameStart, now);
+	s_frameStart = now;
+
 	ApplyLoadedPatches(PPT_CONTINUOUSLY);
 	ApplyLoadedPatches(PPT_COMBINED_0_1);
+
+	// run-ahead frames get rolled back, subscribers only see the shown ones
+	if (m_IpcState == ON && !m_hiddenFrame)
+		m_socketIpc->Vsync();
 }
 
 void SysCoreThread::GameStartingInThread()
@@ -270,6 +288,7 @@ void SysCoreThread::GameStartingInThread()
 
 bool SysCoreThread::StateCheckInThread()
 {
+	m_stateCheckRequested = false;
 	GetMTGS().RethrowException();
 	return _parent::StateCheckInThread() && (_reset_stuff_as_needed(), true);
 }
@@ -289,6 +308,9 @@ void SysCoreThread::ExecuteTaskInThread()
 	Threading::EnableHiresScheduler(); // Note that *something* in SPU2 and GS also set the timer resolution to 1ms.
 	m_sem_event.WaitWithoutYield();
 
+	if (EmuConfig.Speedhacks.threadPinning)
+		Threading::ApplyThreadAffinity(Threading::ThreadRole_EE);
+
 	m_mxcsr_saved.bitmask = _mm_getcsr();
 
 	PCSX2_PAGEFAULT_PROTECT
@@ -316,16 +338,26 @@ void SysCoreThread::OnSuspendInThread()
 
 void SysCoreThread::OnResumeInThread(bool isSuspended)
 {
+	// The GS opens on the MTGS thread, which can take a while with shaders to compile. DEV9,
+	// FW and the memory cards don't need its window or each other, so they open on a helper
+	// thread meanwhile. SPU2, PAD and USB are given the window handle, and stay on this thread
+	// since their backends (SDL, window hooks) aren't safe to bring up concurrently.
+	GetMTGS().Resume();
+	std::future<void> devices = std::async(std::launch::async, [isSuspended]() {
+		if (isSuspended)
+			DEV9open(nullptr);
+		FWopen();
+		FileMcd_EmuOpen();
+	});
+
 	GetMTGS().WaitForOpen();
 	if (isSuspended)
-	{
-		DEV9open((void*)pDsp);
 		USBopen((void*)pDsp);
-	}
-	FWopen();
 	SPU2open((void*)pDsp);
 	PADopen((void*)pDsp);
-	FileMcd_EmuOpen();
+
+	// rethrows anything thrown on the helper thread
+	devices.get();
 }
 
 
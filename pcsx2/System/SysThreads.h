@@ -192,6 +192,12 @@ protected:
 
 	SSE_MXCSR m_mxcsr_saved;
 
+	// Run-ahead (see SysState.cpp): a frame emulated ahead of the shown one is not frame
+	// limited, and the vsync of a hidden frame is not presented.
+	bool m_runAheadFrame;
+	bool m_hiddenFrame;
+	bool m_stateCheckRequested;
+
 public:
 	explicit SysCoreThread();
 	virtual ~SysCoreThread();
@@ -207,6 +213,7 @@ public:
 	virtual bool StateCheckInThread();
 	virtual void VsyncInThread();
 	virtual void GameStartingInThread();
+	virtual void EeloadStartingInThread() {}
 
 	virtual void ApplySettings(const Pcsx2Config& src);
 
@@ -215,6 +222,18 @@ public:
 	virtual const wxString& GetElfOverride() const { return m_elf_override; }
 	virtual void SetElfOverride(const wxString& elf);
 
+	bool IsRunAheadFrame() const { return m_runAheadFrame; }
+	bool IsHiddenFrame() const { return m_hiddenFrame; }
+	void SetRunAheadFrame(bool ahead, bool hidden)
+	{
+		m_runAheadFrame = ahead;
+		m_hiddenFrame = hidden;
+	}
+
+	// Leaves the CPU execution at its next state check, so that StateCheckInThread runs
+	// even though no state change is pending. (thread affinity: the core thread)
+	void RequestStateCheckInThread() { m_stateCheckRequested = true; }
+
 protected:
 	void _reset_stuff_as_needed();
 
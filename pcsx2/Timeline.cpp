@@ -0,0 +1,152 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "Timeline.h"
+#include "Utilities/Threading.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Timeline
+{
+	std::atomic<bool> s_enabled{false};
+
+	struct Event
+	{
+		const char* name;
+		u64 begin;
+		u64 end;
+	};
+
+	struct ThreadBuffer
+	{
+		u32 id;
+		std::string name;
+		std::unique_ptr<Event[]> events{new Event[Capacity]};
+		std::atomic<u32> written{0};
+		std::atomic<bool> alive{true};
+	};
+
+	// Only taken when a thread records its first event, and by Start() and Stop()
+	static std::mutex s_lock;
+	static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+	static u32 s_next_id = 1;
+	static u64 s_start = 0;
+
+	// The buffer outlives its thread so its events still get written, Start() frees it
+	struct ThreadBufferOwner
+	{
+		ThreadBuffer* buffer = nullptr;
+
+		~ThreadBufferOwner()
+		{
+			if (buffer)
+				buffer->alive.store(false, std::memory_order_release);
+		}
+	};
+	static thread_local ThreadBufferOwner s_owner;
+
+	static ThreadBuffer* NewBuffer()
+	{
+		std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer);
+		buffer->name = Threading::pxGetCurrentThreadName().ToUTF8().data();
+
+		std::lock_guard<std::mutex> lock(s_lock);
+		buffer->id = s_next_id++;
+		s_owner.buffer = buffer.get();
+		s_buffers.push_back(std::move(buffer));
+		return s_owner.buffer;
+	}
+
+	void Record(const char* name, u64 begin, u64 end)
+	{
+		ThreadBuffer* buffer = s_owner.buffer ? s_owner.buffer : NewBuffer();
+
+		const u32 pos = buffer->written.load(std::memory_order_relaxed);
+		buffer->events[pos & (Capacity - 1)] = {name, begin, end};
+		buffer->written.store(pos + 1, std::memory_order_release);
+	}
+
+	void Start()
+	{
+		std::lock_guard<std::mutex> lock(s_lock);
+
+		s_buffers.erase(std::remove_if(s_buffers.begin(), s_buffers.end(),
+							[](const std::unique_ptr<ThreadBuffer>& buffer) { return !buffer->alive.load(std::memory_order_acquire); }),
+			s_buffers.end());
+
+		// The rings aren't cleared, the older events are skipped when writing instead
+		s_start = GetCPUTicks();
+		s_enabled.store(true, std::memory_order_relaxed);
+	}
+
+	static std::string JsonString(const char* str)
+	{
+		std::string out("\"");
+
+		for (; *str; str++)
+		{
+			if (*str == '"' || *str == '\\')
+				out += '\\';
+			out += *str;
+		}
+
+		return out + "\"";
+	}
+
+	bool Stop(const wxString& filename)
+	{
+		s_enabled.store(false, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(s_lock);
+
+		FILE* fp = wxFopen(filename, L"w");
+		if (!fp)
+			return false;
+
+		const double us = 1000000.0 / GetTickFrequency();
+
+		fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+		bool first = true;
+		for (const auto& buffer : s_buffers)
+		{
+			fprintf(fp, "%s{\"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"name\": \"thread_name\", \"args\": {\"name\": %s}}",
+				first ? "" : ",\n", buffer->id, JsonString(buffer->name.c_str()).c_str());
+			first = false;
+
+			// A thread still inside a scope may overwrite the oldest event or two while this runs
+			const u32 written = buffer->written.load(std::memory_order_acquire);
+			const u32 count = std::min(written, Capacity);
+			for (u32 pos = written - count; pos != written; pos++)
+			{
+				const Event& ev = buffer->events[pos & (Capacity - 1)];
+				if (ev.begin < s_start)
+					continue;
+
+				fprintf(fp, ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"name\": %s, \"ts\": %.3f, \"dur\": %.3f}",
+					buffer->id, JsonString(ev.name).c_str(), (ev.begin - s_start) * us, (ev.end - ev.begin) * us);
+			}
+		}
+
+		fprintf(fp, "\n]}\n");
+		fclose(fp);
+		return true;
+	}
+} // namespace Timeline
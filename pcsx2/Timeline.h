@@ -0,0 +1,69 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+
+// Whole system timeline, toggled by the Sys_TimelineToggle hotkey and written as a Chrome
+// trace (chrome://tracing, ui.perfetto.dev).
+//
+// Every thread records its scopes into a ring of its own, so recording takes no locks and
+// the newest Timeline::Capacity events of each thread are kept.  While stopped, a scope
+// costs a relaxed load and a branch.  Event names must be string literals.
+namespace Timeline
+{
+	static const uint Capacity = 1 << 17;
+
+	extern std::atomic<bool> s_enabled;
+
+	__fi bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	// Records an event of the current thread spanning the two GetCPUTicks() values
+	extern void Record(const char* name, u64 begin, u64 end);
+
+	extern void Start();
+	// Stops recording and writes the timeline, returns false if the file couldn't be written
+	extern bool Stop(const wxString& filename);
+
+	class Scope
+	{
+	public:
+		Scope(const char* name, bool active = true)
+			: m_name(name)
+			, m_begin(active && IsEnabled() ? GetCPUTicks() : 0)
+		{
+		}
+
+		~Scope()
+		{
+			if (m_begin)
+				Record(m_name, m_begin, GetCPUTicks());
+		}
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_name;
+		u64 m_begin;
+	};
+} // namespace Timeline
+
+#define TIMELINE_CONCAT_(a, b) a##b
+#define TIMELINE_CONCAT(a, b) TIMELINE_CONCAT_(a, b)
+#define TIMELINE_SCOPE(name) Timeline::Scope TIMELINE_CONCAT(timelineScope, __LINE__)(name)
+// Only records the scope when cond holds, for scopes which are mostly empty
+#define TIMELINE_SCOPE_IF(name, cond) Timeline::Scope TIMELINE_CONCAT(timelineScope, __LINE__)(name, cond)
@@ -24,7 +24,6 @@ RingBuffer::RingBuffer()
 	, m_end(0)
 	, m_capacity(0)
 	, m_data(nullptr)
-	, m_overrun(false)
 {
 }
 
@@ -45,32 +44,25 @@ void RingBuffer::reserve(size_t capacity)
 	m_data = new char[capacity];
 	memset(m_data, 0, capacity);
 	m_capacity = capacity;
+	m_begin.store(0, std::memory_order_relaxed);
+	m_end.store(0, std::memory_order_relaxed);
 }
 
 size_t RingBuffer::size() const
 {
-	size_t size = 0;
-	if (m_begin == m_end)
-	{
-		if (m_overrun)
-			size = m_capacity;
-		else
-			size = 0;
-	}
-	else if (m_begin < m_end)
-		size = m_end - m_begin; // [   b...e   ]
-	else
-		size = m_capacity - m_begin + m_end; // [...e   b...]
-
-	return size;
+	// exact for the consumer, and at worst too large for the producer, so neither side oversteps
+	const size_t begin = m_begin.load(std::memory_order_acquire);
+	return m_end.load(std::memory_order_acquire) - begin;
 }
 
 size_t RingBuffer::read(uint8_t* dst, size_t nbytes)
 {
 	size_t to_read = nbytes;
-	while (to_read > 0 && size() > 0)
+	while (to_read > 0)
 	{
 		size_t bytes = std::min(to_read, peek_read());
+		if (!bytes)
+			break;
 		memcpy(dst, front(), bytes);
 		read(bytes);
 		dst += bytes;
@@ -79,113 +71,51 @@ size_t RingBuffer::read(uint8_t* dst, size_t nbytes)
 	return nbytes - to_read;
 }
 
-void RingBuffer::write(uint8_t* src, size_t nbytes)
+size_t RingBuffer::write(const uint8_t* src, size_t nbytes)
 {
-	size_t bytes;
-	while (nbytes > 0)
+	size_t to_write = nbytes;
+	while (to_write > 0)
 	{
-		bytes = std::min(nbytes, m_capacity - m_end);
+		size_t bytes = std::min(to_write, peek_write());
+		if (!bytes)
+			break;
 		memcpy(back(), src, bytes);
 		write(bytes);
 		src += bytes;
-		nbytes -= bytes;
+		to_write -= bytes;
 	}
+	return nbytes - to_write;
 }
 
-size_t RingBuffer::peek_write(bool overwrite) const
+size_t RingBuffer::peek_write() const
 {
-	size_t peek = 0;
+	if (!m_capacity)
+		return 0;
 
-	if (overwrite)
-		return m_capacity - m_end;
-
-	if (m_end < m_begin) // [...e   b...]
-		peek = m_begin - m_end;
-	else if (m_end < m_capacity) // [   b...e   ]
-		peek = m_capacity - m_end;
-	else
-		peek = m_begin; // [   b.......e]
-
-	return peek;
+	const size_t end = m_end.load(std::memory_order_relaxed);
+	const size_t free = m_capacity - (end - m_begin.load(std::memory_order_acquire));
+	return std::min(free, m_capacity - end % m_capacity);
 }
 
 size_t RingBuffer::peek_read() const
 {
-	size_t peek = 0;
-	if (m_begin == m_end)
-	{
-		if (m_overrun)
-			peek = m_capacity - m_begin;
-		else
-			peek = 0;
-	}
-	else if (m_begin < m_end) // [   b...e   ]
-		peek = m_end - m_begin;
-	else if (m_begin < m_capacity) // [...e   b...]
-		peek = m_capacity - m_begin;
-	else
-		peek = m_end; // [...e      b]
+	if (!m_capacity)
+		return 0;
 
-	return peek;
+	const size_t begin = m_begin.load(std::memory_order_relaxed);
+	const size_t used = m_end.load(std::memory_order_acquire) - begin;
+	return std::min(used, m_capacity - begin % m_capacity);
 }
 
-/*size_t RingBuffer::write(const char *data, size_t bytes)
-{
-	size_t bytes_to_write;
-
-	if (m_end < m_begin)
-	{
-		bytes_to_write = std::min(m_begin - m_end, bytes);
-		memcpy(m_data + m_end, data, bytes_to_write);
-		m_end += bytes_to_write;
-		return bytes_to_write;
-	}
-	else
-	{
-		size_t in_bytes = bytes;
-		while (in_bytes > 0)
-		{
-			bytes_to_write = std::min(m_capacity - m_end, in_bytes);
-			if (m_end < m_begin && m_end + bytes_to_write > m_begin)
-				m_begin = (m_end + bytes_to_write + 1) % m_capacity;
-
-			memcpy(m_data + m_end, data, bytes_to_write);
-			in_bytes -= bytes_to_write;
-			m_end = (m_end + bytes_to_write) % m_capacity;
-		}
-		return bytes;
-	}
-}*/
-
 void RingBuffer::write(size_t bytes)
 {
-	//assert( bytes <= m_capacity - size() );
-
-	// push m_begin forward if m_end overlaps it
-	if ((m_end < m_begin && m_end + bytes > m_begin) ||
-		m_end + bytes > m_begin + m_capacity)
-	{
-		m_overrun = true;
-		m_begin = (m_end + bytes) % m_capacity;
-		m_end = m_begin;
-	}
-	else
-		m_end = (m_end + bytes) % m_capacity;
-
-	mLastWrite = hrc::now();
+	assert(bytes <= m_capacity - size());
+	// release, so the data is visible before the consumer sees it counted
+	m_end.store(m_end.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
 }
 
 void RingBuffer::read(size_t bytes)
 {
 	assert(bytes <= size());
-
-	m_overrun = false;
-	if ((m_begin < m_end && m_begin + bytes > m_end) ||
-		m_begin + bytes > m_end + m_capacity)
-	{
-		m_begin = m_end = 0;
-		return;
-	}
-
-	m_begin = (m_begin + bytes) % m_capacity;
+	m_begin.store(m_begin.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
 }
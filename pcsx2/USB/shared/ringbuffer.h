@@ -16,6 +16,7 @@
 #ifndef RINGBUFFER_H
 #define RINGBUFFER_H
 #include <algorithm> // for std::min
+#include <atomic>
 #include <cstdint>
 #include <chrono>
 
@@ -25,6 +26,10 @@ using us = std::chrono::microseconds;
 using ns = std::chrono::nanoseconds;
 using sec = std::chrono::seconds;
 
+// Lock-free ring for one producer and one consumer thread. Both sides work in place:
+// the producer fills back()/peek_write() and publishes with write(bytes), the consumer
+// uses front()/peek_read() and releases with read(bytes). A span stops at the end of
+// the buffer, so wrapped data takes two steps. reserve() must not race either side.
 class RingBuffer
 {
 	RingBuffer(RingBuffer&) = delete;
@@ -34,11 +39,9 @@ public:
 	RingBuffer(size_t capacity);
 	~RingBuffer();
 
-	//size_t write(const char *data, size_t bytes);
-	//size_t read(char *data, size_t bytes);
-
-	// Overwrites old data if nbytes > size()
-	void write(uint8_t* src, size_t nbytes);
+	// Producer: copies as much as fits, unread data is never overwritten
+	size_t write(const uint8_t* src, size_t nbytes);
+	// Consumer
 	size_t read(uint8_t* dst, size_t nbytes);
 
 	// just move pointers around
@@ -58,15 +61,15 @@ public:
 	}
 
 	void reserve(size_t size);
-	// if you care about old data, check how much can be written
-	// may need to call available/write twice in case write pointer wraps
-	size_t peek_write(bool overwrite = false) const;
+	// contiguous free space at back(), may need to call peek_write/write twice in case write pointer wraps
+	size_t peek_write() const;
+	// contiguous data at front()
 	size_t peek_read() const;
 
 	template <typename T>
-	size_t peek_write(bool overwrite = false) const
+	size_t peek_write() const
 	{
-		return peek_write(overwrite) / sizeof(T);
+		return peek_write() / sizeof(T);
 	}
 
 	template <typename T>
@@ -83,33 +86,27 @@ public:
 		return size() / sizeof(T);
 	}
 	size_t capacity() const { return m_capacity; }
-	char* front() { return m_data + m_begin; }
-	char* back() { return m_data + m_end; }
+	char* front() { return m_data + m_begin.load(std::memory_order_relaxed) % m_capacity; }
+	char* back() { return m_data + m_end.load(std::memory_order_relaxed) % m_capacity; }
 
 	template <typename T>
 	T* front()
 	{
-		return (T*)(m_data + m_begin);
+		return (T*)front();
 	}
 
 	template <typename T>
 	T* back()
 	{
-		return (T*)(m_data + m_end);
-	}
-
-	long long MilliSecsSinceLastWrite()
-	{
-		return std::chrono::duration_cast<ms>(hrc::now() - mLastWrite).count();
+		return (T*)back();
 	}
 
 private:
-	size_t m_begin;
-	size_t m_end;
+	// Running byte counts, only ever increased by their owning side
+	std::atomic<size_t> m_begin;
+	std::atomic<size_t> m_end;
 	size_t m_capacity;
 	char* m_data;
-	bool m_overrun;
-	hrc::time_point mLastWrite = hrc::time_point(ns(0));
 };
 
 #endif
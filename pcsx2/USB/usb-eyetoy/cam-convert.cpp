@@ -0,0 +1,185 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "cam-convert.h"
+
+#include <cstring>
+#include <smmintrin.h>
+
+namespace usb_eyetoy
+{
+	// BT.601 with 8 fractional bits: R = Y + 1.402V, G = Y - 0.344U - 0.714V, B = Y + 1.772U
+	// The SIMD path works on (x << 7) * (2 * c) >> 16, which rounds the same as (x * c) >> 8 below
+	static inline uint8_t clamp_u8(int x)
+	{
+		return (x > 255) ? 255 : ((x < 0) ? 0 : x);
+	}
+
+	static inline void yuv_to_rgb(int y, int u, int v, uint8_t* dst)
+	{
+		dst[0] = clamp_u8(y + ((359 * v) >> 8));
+		dst[1] = clamp_u8(y + ((-88 * u) >> 8) + ((-183 * v) >> 8));
+		dst[2] = clamp_u8(y + ((454 * u) >> 8));
+	}
+
+	void yuyv_to_rgb24(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		const __m128i vr = _mm_set1_epi16(359 * 2);
+		const __m128i ug = _mm_set1_epi16(-88 * 2);
+		const __m128i vg = _mm_set1_epi16(-183 * 2);
+		const __m128i ub = _mm_set1_epi16(454 * 2);
+
+		const __m128i yMask = _mm_setr_epi8(0, -1, 2, -1, 4, -1, 6, -1, 8, -1, 10, -1, 12, -1, 14, -1);
+		const __m128i uMask = _mm_setr_epi8(1, -1, 1, -1, 5, -1, 5, -1, 9, -1, 9, -1, 13, -1, 13, -1);
+		const __m128i vMask = _mm_setr_epi8(3, -1, 3, -1, 7, -1, 7, -1, 11, -1, 11, -1, 15, -1, 15, -1);
+		// Interleave the r0g0r1g1... and b0b1... vectors into 24 bytes of RGB
+		const __m128i rgLo = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+		const __m128i bLo = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+		const __m128i rgHi = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+		const __m128i bHi = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			const __m128i yuyv = _mm_loadu_si128((const __m128i*)(src + i * 2));
+			const __m128i y = _mm_shuffle_epi8(yuyv, yMask);
+			const __m128i u = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(yuyv, uMask), bias), 7);
+			const __m128i v = _mm_slli_epi16(_mm_sub_epi16(_mm_shuffle_epi8(yuyv, vMask), bias), 7);
+
+			const __m128i r = _mm_add_epi16(y, _mm_mulhi_epi16(v, vr));
+			const __m128i g = _mm_add_epi16(y, _mm_add_epi16(_mm_mulhi_epi16(u, ug), _mm_mulhi_epi16(v, vg)));
+			const __m128i b = _mm_add_epi16(y, _mm_mulhi_epi16(u, ub));
+
+			const __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, zero), _mm_packus_epi16(g, zero));
+			const __m128i b8 = _mm_packus_epi16(b, zero);
+			_mm_storeu_si128((__m128i*)(dst + i * 3), _mm_or_si128(_mm_shuffle_epi8(rg, rgLo), _mm_shuffle_epi8(b8, bLo)));
+			_mm_storel_epi64((__m128i*)(dst + i * 3 + 16), _mm_or_si128(_mm_shuffle_epi8(rg, rgHi), _mm_shuffle_epi8(b8, bHi)));
+		}
+
+		for (; i + 2 <= pixelCount; i += 2)
+		{
+			const uint8_t* s = src + i * 2;
+			const int u = s[1] - 128;
+			const int v = s[3] - 128;
+			yuv_to_rgb(s[0], u, v, dst + i * 3);
+			yuv_to_rgb(s[2], u, v, dst + i * 3 + 3);
+		}
+	}
+
+	void scale_yuyv(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth, int dstHeight)
+	{
+		// Work on pixel pairs, as 4 byte units
+		const int srcPairs = srcWidth / 2;
+		const int dstPairs = dstWidth / 2;
+		const uint32_t* src32 = (const uint32_t*)src;
+		uint32_t* dst32 = (uint32_t*)dst;
+
+		for (int y = 0; y < dstHeight; y++)
+		{
+			const uint32_t* srcRow = src32 + (y * srcHeight / dstHeight) * srcPairs;
+			uint32_t* dstRow = dst32 + y * dstPairs;
+			if (srcPairs == dstPairs)
+			{
+				memcpy(dstRow, srcRow, dstPairs * 4);
+				continue;
+			}
+			for (int x = 0; x < dstPairs; x++)
+				dstRow[x] = srcRow[x * srcPairs / dstPairs];
+		}
+	}
+
+	void bgr24_flipped_to_rgb24(const uint8_t* src, uint8_t* dst, int width, int height)
+	{
+		// Swap bytes 0 and 2 of each pixel, 5 pixels per 16 bytes loaded
+		const __m128i swap = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+		const int rowBytes = width * 3;
+
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* s = src + (height - y - 1) * rowBytes;
+			uint8_t* d = dst + y * rowBytes;
+			int x = 0;
+			// The 16th byte belongs to the next pixel, so stop a full load short of the row end
+			for (; x + 16 <= rowBytes; x += 15)
+				_mm_storeu_si128((__m128i*)(d + x), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(s + x)), swap));
+			for (; x < rowBytes; x += 3)
+			{
+				d[x + 0] = s[x + 2];
+				d[x + 1] = s[x + 1];
+				d[x + 2] = s[x + 0];
+			}
+		}
+	}
+
+	// The standard tables from the JPEG spec (K.3)
+	static const uint8_t s_dht[] = {
+		0xFF, 0xC4, 0x01, 0xA2,
+		0x00, 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+		0x10, 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d,
+		0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+		0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+		0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+		0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+		0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa,
+		0x01, 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+		0x11, 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77,
+		0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+		0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+		0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+		0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+		0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+		0xf9, 0xfa,
+	};
+
+	size_t mjpeg_to_jpeg(const uint8_t* src, size_t len, uint8_t* dst, size_t dstLen)
+	{
+		// Walk the marker segments up to the start of scan, looking for a DHT
+		size_t sos = 0;
+		size_t i = 2;
+		while (i + 4 <= len && src[i] == 0xFF)
+		{
+			const uint8_t marker = src[i + 1];
+			if (marker == 0xC4)
+				break;
+			if (marker == 0xDA)
+			{
+				sos = i;
+				break;
+			}
+			i += 2 + ((src[i + 2] << 8) | src[i + 3]);
+		}
+
+		if (sos == 0)
+		{
+			if (len > dstLen)
+				return 0;
+			memcpy(dst, src, len);
+			return len;
+		}
+
+		if (len + sizeof(s_dht) > dstLen)
+			return 0;
+		memcpy(dst, src, sos);
+		memcpy(dst + sos, s_dht, sizeof(s_dht));
+		memcpy(dst + sos + sizeof(s_dht), src + sos, len - sos);
+		return len + sizeof(s_dht);
+	}
+} // namespace usb_eyetoy
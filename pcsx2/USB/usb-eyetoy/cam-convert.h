@@ -0,0 +1,31 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace usb_eyetoy
+{
+	// Packed YUYV (4:2:2) to RGB24, pixelCount has to be even
+	void yuyv_to_rgb24(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+	// Nearest neighbour scaling that keeps YUYV pixel pairs together, both widths have to be even
+	void scale_yuyv(const uint8_t* src, int srcWidth, int srcHeight, uint8_t* dst, int dstWidth, int dstHeight);
+	// Bottom-up BGR24 as delivered by DirectShow to top-down RGB24
+	void bgr24_flipped_to_rgb24(const uint8_t* src, uint8_t* dst, int width, int height);
+	// MJPEG frames usually leave out the huffman tables, as they're always the standard ones.
+	// Copies the frame to dst and inserts the tables if needed, returns the new length or 0 if dst is too small
+	size_t mjpeg_to_jpeg(const uint8_t* src, size_t len, uint8_t* dst, size_t dstLen);
+} // namespace usb_eyetoy
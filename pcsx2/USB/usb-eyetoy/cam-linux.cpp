@@ -18,12 +18,14 @@
 #include "jpgd.h"
 #include "jpge.h"
 #include "jo_mpeg.h"
+#include "cam-convert.h"
 #include "USB/gtk.h"
 #include "Utilities/Console.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include <assert.h>
 
 #include <fcntl.h>
@@ -50,6 +52,9 @@ namespace usb_eyetoy
 		buffer_t* buffers;
 		static unsigned int n_buffers;
 		static unsigned int pixelformat;
+		// What the driver actually delivers, scaled to frame_width/height if it differs
+		static int capture_width;
+		static int capture_height;
 
 		buffer_t mpeg_buffer;
 		std::mutex mpeg_mutex;
@@ -70,82 +75,81 @@ namespace usb_eyetoy
 
 		static void store_mpeg_frame(const unsigned char* data, const unsigned int len)
 		{
+			// mpeg_buffer is allocated for 640x480 YUYV
+			if (len > 640 * 480 * 2)
+				return;
 			mpeg_mutex.lock();
 			memcpy(mpeg_buffer.start, data, len);
 			mpeg_buffer.length = len;
 			mpeg_mutex.unlock();
 		}
 
+		static void encode_jpeg(const unsigned char* rgbData, std::vector<unsigned char>& comprBuf, int& comprLen)
+		{
+			jpge::params params;
+			params.m_quality = 80;
+			params.m_subsampling = jpge::H2V1;
+			comprLen = comprBuf.size();
+			if (!jpge::compress_image_to_jpeg_file_in_memory(comprBuf.data(), comprLen, frame_width, frame_height, 3, rgbData, params))
+			{
+				comprLen = 0;
+			}
+		}
+
 		static void process_image(const unsigned char* data, int size)
 		{
+			// Kept between frames, this runs for every captured frame
+			static std::vector<unsigned char> comprBuf;
+			static std::vector<unsigned char> rgbBuf;
+			static std::vector<unsigned char> scaleBuf;
+
 			const int bytesPerPixel = 3;
-			int comprBufSize = frame_width * frame_height * bytesPerPixel;
+			size_t comprBufSize = frame_width * frame_height * bytesPerPixel;
+			comprBuf.resize(comprBufSize);
+			int comprLen = 0;
 			if (pixelformat == V4L2_PIX_FMT_YUYV)
 			{
-				unsigned char* comprBuf = (unsigned char*)calloc(1, comprBufSize);
-				int comprLen = 0;
+				if (size < capture_width * capture_height * 2)
+					return;
+
+				// The driver may not have the requested resolution
+				if (capture_width != frame_width || capture_height != frame_height)
+				{
+					scaleBuf.resize(frame_width * frame_height * 2);
+					scale_yuyv(data, capture_width, capture_height, scaleBuf.data(), frame_width, frame_height);
+					data = scaleBuf.data();
+				}
+
 				if (frame_format == format_mpeg)
 				{
-					comprLen = jo_write_mpeg(comprBuf, data, frame_width, frame_height, JO_YUYV, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_NONE);
+					comprLen = jo_write_mpeg(comprBuf.data(), data, frame_width, frame_height, JO_YUYV, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_NONE);
 				}
 				else if (frame_format == format_jpeg)
 				{
-					unsigned char* data2 = (unsigned char*)calloc(1, comprBufSize);
-					for (int y = 0; y < frame_height; y++)
-					{
-						for (int x = 0; x < frame_width; x += 2)
-						{
-							const unsigned char* src = data + (y * frame_width + x) * 2;
-							unsigned char* dst = data2 + (y * frame_width + x) * bytesPerPixel;
-
-							int y1 = (int) src[0] << 8;
-							int u  = (int) src[1] - 128;
-							int y2 = (int) src[2] << 8;
-							int v  = (int) src[3] - 128;
-
-							int r  = (y1 + (259 * v) >> 8);
-							int g  = (y1 - (88 * u) - (183 * v)) >> 8;
-							int b  = (y1 + (454 * u)) >> 8;
-							dst[0] = (r > 255) ? 255 : ((r < 0) ? 0 : r);
-							dst[1] = (g > 255) ? 255 : ((g < 0) ? 0 : g);
-							dst[2] = (b > 255) ? 255 : ((b < 0) ? 0 : b);
-
-							r = (y2 + (259 * v) >> 8);
-							g = (y2 - (88 * u) - (183 * v)) >> 8;
-							b = (y2 + (454 * u)) >> 8;
-							dst[3] = (r > 255) ? 255 : ((r < 0) ? 0 : r);
-							dst[4] = (g > 255) ? 255 : ((g < 0) ? 0 : g);
-							dst[5] = (b > 255) ? 255 : ((b < 0) ? 0 : b);
-						}
-					}
-					jpge::params params;
-					params.m_quality = 80;
-					params.m_subsampling = jpge::H2V1;
-					comprLen = comprBufSize;
-					if (!jpge::compress_image_to_jpeg_file_in_memory(comprBuf, comprLen, frame_width, frame_height, 3, data2, params))
-					{
-						comprLen = 0;
-					}
-					free(data2);
+					rgbBuf.resize(comprBufSize);
+					yuyv_to_rgb24(data, rgbBuf.data(), frame_width * frame_height);
+					encode_jpeg(rgbBuf.data(), comprBuf, comprLen);
 				}
-				store_mpeg_frame(comprBuf, comprLen);
-				free(comprBuf);
+				store_mpeg_frame(comprBuf.data(), comprLen);
 			}
-			else if (pixelformat == V4L2_PIX_FMT_JPEG)
+			else if (pixelformat == V4L2_PIX_FMT_JPEG || pixelformat == V4L2_PIX_FMT_MJPEG)
 			{
 				if (frame_format == format_mpeg)
 				{
 					int width, height, actual_comps;
 					unsigned char* rgbData = jpgd::decompress_jpeg_image_from_memory(data, size, &width, &height, &actual_comps, 3);
-					unsigned char* comprBuf = (unsigned char*)calloc(1, comprBufSize);
-					int comprLen = jo_write_mpeg(comprBuf, rgbData, frame_width, frame_height, JO_RGB24, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_NONE);
+					if (!rgbData)
+						return;
+					if (width == frame_width && height == frame_height)
+						comprLen = jo_write_mpeg(comprBuf.data(), rgbData, frame_width, frame_height, JO_RGB24, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_NONE);
 					free(rgbData);
-					store_mpeg_frame(comprBuf, comprLen);
-					free(comprBuf);
+					store_mpeg_frame(comprBuf.data(), comprLen);
 				}
 				else if (frame_format == format_jpeg)
 				{
-					store_mpeg_frame(data, size);
+					// Passed through as is, only the huffman tables MJPEG leaves out are added
+					comprLen = mjpeg_to_jpeg(data, size, comprBuf.data(), comprBuf.size());
+					store_mpeg_frame(comprBuf.data(), comprLen);
 				}
 			}
 			else
@@ -331,14 +335,31 @@ namespace usb_eyetoy
 			fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 			fmt.fmt.pix.width = frame_width;
 			fmt.fmt.pix.height = frame_height;
-			fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
 
-			if (-1 == xioctl(fd, VIDIOC_S_FMT, &fmt))
+			// Frames can go straight to the game if the camera does MJPEG at the requested size
+			bool passthrough = false;
+			if (frame_format == format_jpeg)
 			{
-				Console.Warning("Camera: %s error %d, %s", "VIDIOC_S_FMT", errno, strerror(errno));
-				return -1;
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+				passthrough = xioctl(fd, VIDIOC_S_FMT, &fmt) == 0 &&
+							  (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG || fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_JPEG) &&
+							  (int)fmt.fmt.pix.width == frame_width && (int)fmt.fmt.pix.height == frame_height;
+			}
+
+			if (!passthrough)
+			{
+				fmt.fmt.pix.width = frame_width;
+				fmt.fmt.pix.height = frame_height;
+				fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+				if (-1 == xioctl(fd, VIDIOC_S_FMT, &fmt))
+				{
+					Console.Warning("Camera: %s error %d, %s", "VIDIOC_S_FMT", errno, strerror(errno));
+					return -1;
+				}
 			}
 			pixelformat = fmt.fmt.pix.pixelformat;
+			capture_width = fmt.fmt.pix.width;
+			capture_height = fmt.fmt.pix.height;
 			Console.Warning("Camera: selected format: res=%dx%d, fmt=%c%c%c%c", fmt.fmt.pix.width, fmt.fmt.pix.height,
 					pixelformat, pixelformat >> 8, pixelformat >> 16, pixelformat >> 24);
 
@@ -20,6 +20,9 @@
 #include "cam-windows.h"
 #include "usb-eyetoy-webcam.h"
 #include "jo_mpeg.h"
+#include "cam-convert.h"
+
+#include <vector>
 
 #include "USB/Win32/Config_usb.h"
 #include "USB/Win32/resource_usb.h"
@@ -372,44 +375,38 @@ namespace usb_eyetoy
 
 		void dshow_callback(unsigned char* data, int len, int bitsperpixel)
 		{
+			// Kept between frames, this runs for every captured frame
+			static std::vector<unsigned char> comprBuf;
+			static std::vector<unsigned char> rgbBuf;
+
 			if (bitsperpixel == 24)
 			{
 				const int bytesPerPixel = 3;
-				int comprBufSize = frame_width * frame_height * bytesPerPixel;
-				unsigned char* comprBuf = (unsigned char*)calloc(1, comprBufSize);
+				size_t comprBufSize = frame_width * frame_height * bytesPerPixel;
+				if (len < (int)comprBufSize)
+					return;
+				comprBuf.resize(comprBufSize);
 				int comprLen = 0;
 				if (frame_format == format_mpeg)
 				{
-					comprLen = jo_write_mpeg(comprBuf, data, frame_width, frame_height, JO_BGR24, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_FLIP_Y);
+					comprLen = jo_write_mpeg(comprBuf.data(), data, frame_width, frame_height, JO_BGR24, mirroring_enabled ? JO_FLIP_X : JO_NONE, JO_FLIP_Y);
 				}
 				else if (frame_format == format_jpeg)
 				{
 					// flip Y - always required on windows
-					unsigned char* data2 = (unsigned char*)calloc(1, comprBufSize);
-					for (int y = 0; y < frame_height; y++)
-					{
-						for (int x = 0; x < frame_width; x++)
-						{
-							unsigned char* src = data + (y * frame_width + x) * bytesPerPixel;
-							unsigned char* dst = data2 + ((frame_height - y - 1) * frame_width + x) * bytesPerPixel;
-							dst[0] = src[2];
-							dst[1] = src[1];
-							dst[2] = src[0];
-						}
-					}
+					rgbBuf.resize(comprBufSize);
+					bgr24_flipped_to_rgb24(data, rgbBuf.data(), frame_width, frame_height);
 
 					jpge::params params;
 					params.m_quality = 80;
 					params.m_subsampling = jpge::H2V1;
 					comprLen = comprBufSize;
-					if (!jpge::compress_image_to_jpeg_file_in_memory(comprBuf, comprLen, frame_width, frame_height, 3, data2, params))
+					if (!jpge::compress_image_to_jpeg_file_in_memory(comprBuf.data(), comprLen, frame_width, frame_height, 3, rgbBuf.data(), params))
 					{
 						comprLen = 0;
 					}
-					free(data2);
 				}
-				store_mpeg_frame(comprBuf, comprLen);
-				free(comprBuf);
+				store_mpeg_frame(comprBuf.data(), comprLen);
 			}
 			else
 			{
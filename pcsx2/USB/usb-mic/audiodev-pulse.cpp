@@ -344,7 +344,7 @@ namespace usb_mic
 			else
 				mLastGetBuffer = now;
 
-			std::lock_guard<std::mutex> lk(mMutex);
+			//mOutBuffer is lock-free, so this doesn't wait for the PulseAudio callback
 			ssize_t samples_to_read = frames * GetChannels();
 			short* pDst = (short*)buff;
 			assert(samples_to_read <= mOutBuffer.size<short>());
@@ -388,7 +388,6 @@ namespace usb_mic
 			else
 				mLastGetBuffer = now;
 
-			std::lock_guard<std::mutex> lk(mMutex);
 			size_t nbytes = frames * sizeof(short) * GetChannels();
 			mInBuffer.write((uint8_t*)buff, nbytes);
 
@@ -397,7 +396,6 @@ namespace usb_mic
 
 		bool PulseAudioDevice::GetFrames(uint32_t* size)
 		{
-			std::lock_guard<std::mutex> lk(mMutex);
 			*size = mOutBuffer.size<short>() / GetChannels();
 			return true;
 		}
@@ -785,7 +783,10 @@ namespace usb_mic
 			float* pSrc = rebuf.data();
 			while (output_samples > 0)
 			{
-				size_t samples = std::min(output_samples, padev->mOutBuffer.peek_write<short>(true));
+				//Drop what doesn't fit, the game isn't keeping up
+				size_t samples = std::min(output_samples, padev->mOutBuffer.peek_write<short>());
+				if (!samples)
+					break;
 				src_float_to_short_array(pSrc, padev->mOutBuffer.back<short>(), samples);
 				padev->mOutBuffer.write<short>(samples);
 				output_samples -= samples;
@@ -369,13 +369,7 @@ namespace usb_mic
 		//TODO or just return samples count in mOutBuffer?
 		bool MMAudioDevice::GetFrames(uint32_t* size)
 		{
-			if (WaitForSingleObject(mMutex, 5000) != WAIT_OBJECT_0)
-			{
-				*size = 0;
-				return false;
-			}
 			*size = mOutBuffer.size<short>() / mDeviceChannels;
-			ReleaseMutex(mMutex);
 			return true;
 		}
 
@@ -441,6 +435,7 @@ namespace usb_mic
 						src->mInBuffer.read<float>(samples);
 					}
 
+					//Only keeps ResetBuffers() from reallocating the buffer under us, the game side doesn't lock
 					DWORD resMutex = WaitForSingleObject(src->mMutex, 30000);
 					if (resMutex != WAIT_OBJECT_0)
 					{
@@ -451,7 +446,10 @@ namespace usb_mic
 					float* pSrc = rebuf.data();
 					while (len > 0)
 					{
-						size_t samples = std::min(len, src->mOutBuffer.peek_write<short>(true));
+						//Drop what doesn't fit, the game isn't keeping up
+						size_t samples = std::min(len, src->mOutBuffer.peek_write<short>());
+						if (!samples)
+							break;
 						src_float_to_short_array(pSrc, src->mOutBuffer.back<short>(), samples);
 						src->mOutBuffer.write<short>(samples);
 						len -= samples;
@@ -615,12 +613,7 @@ namespace usb_mic
 				mThread = (HANDLE)_beginthreadex(NULL, 0, MMAudioDevice::CaptureThread, this, 0, NULL);
 			}
 
-			DWORD resMutex = WaitForSingleObject(mMutex, 1000);
-			if (resMutex != WAIT_OBJECT_0)
-			{
-				return 0;
-			}
-
+			//mOutBuffer is lock-free, so this doesn't wait for the capture thread
 			//mSamples += outFrames;
 			//mTime = GetQPCTime100NS();
 			//if (mLastTimeNS == 0) mLastTimeNS = mTime;
@@ -649,7 +642,6 @@ namespace usb_mic
 				samples_to_read -= samples;
 			}
 
-			resMutex = ReleaseMutex(mMutex);
 			return (outFrames - (samples_to_read / mDeviceChannels));
 		}
 
@@ -661,19 +653,9 @@ namespace usb_mic
 				mThread = (HANDLE)_beginthreadex(NULL, 0, MMAudioDevice::RenderThread, this, 0, NULL);
 			}
 
-			DWORD resMutex = WaitForSingleObject(mMutex, 1000);
-			if (resMutex != WAIT_OBJECT_0)
-			{
-				return 0;
-			}
-
 			size_t nbytes = inFrames * sizeof(short) * GetChannels();
 			mInBuffer.write((uint8_t*)inBuf, nbytes);
 
-			if (!ReleaseMutex(mMutex))
-			{
-			}
-
 			return inFrames;
 		}
 
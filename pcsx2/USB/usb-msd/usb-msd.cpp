@@ -11,6 +11,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "USB/qemu-usb/vl.h"
 #include "USB/qemu-usb/desc.h"
 #include "usb-msd.h"
@@ -61,6 +66,107 @@ namespace usb_msd
 		bool valid;
 	} ReqState;
 
+	// Does all image file access on a worker thread, so the USB path only ever copies memory.
+	// Reads are served from a cache of chunks that is filled ahead of sequential reads,
+	// and writes are queued and written back in order until SYNCHRONIZE CACHE flushes them.
+	class BlockIO
+	{
+	public:
+		BlockIO() = default;
+		~BlockIO() { Close(); }
+
+		BlockIO(const BlockIO&) = delete;
+		BlockIO& operator=(const BlockIO&) = delete;
+
+		bool Open(FILE* file);
+		// waits for all queued writes, the file itself is left open
+		void Close();
+		int64_t Size() const { return m_size; }
+
+		// starts reading the chunks a command will read, and the ones after it if reads are sequential
+		void Prefetch(int64_t offset, int64_t len);
+		// returns 1 if len bytes at offset were copied, 0 if they are still being read and -1 on read errors
+		int Read(int64_t offset, uint8_t* dst, size_t len);
+		// returns false without writing if too much data is still waiting to go to disk
+		bool Write(int64_t offset, const uint8_t* src, size_t len);
+		// queues a flush of the file behind everything written so far
+		void Flush();
+		// returns 0 while flushes are pending, 1 once done and -1 if a write or flush failed since the last call
+		int FlushStatus();
+		// waits until all queued work is done
+		void Drain();
+		// drops all cached data, for when the image contents may have changed under us
+		void Invalidate();
+
+	private:
+		static constexpr int64_t ChunkSize = 64 * 1024;
+		static constexpr int ChunkCount = 32;
+		static constexpr int ReadaheadChunks = 8;
+		static constexpr size_t MaxQueuedWrite = 4 * 1024 * 1024;
+
+		enum class ChunkState
+		{
+			Empty,
+			Loading,
+			Ready,
+			Failed,
+		};
+
+		struct Chunk
+		{
+			int64_t offset = -1;
+			ChunkState state = ChunkState::Empty;
+			// written while loading, the loaded data is thrown away
+			bool stale = false;
+			uint64_t last_use = 0;
+			std::vector<uint8_t> data;
+		};
+
+		struct Task
+		{
+			enum
+			{
+				Load,
+				Write,
+				Flush,
+			} type;
+			int chunk;
+			int64_t offset;
+			std::vector<uint8_t> data;
+		};
+
+		void WorkerThread();
+		// everything below expects m_mutex to be held
+		Chunk* FindChunk(int64_t offset);
+		void LoadChunk(int64_t offset);
+		void SubmitWrite();
+		void Queue(Task&& task);
+
+		FILE* m_file = nullptr;
+		int64_t m_size = 0;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_work_cv;
+		std::condition_variable m_idle_cv;
+		std::deque<Task> m_tasks;
+		bool m_busy = false;
+		bool m_quit = false;
+
+		Chunk m_chunks[ChunkCount];
+		uint64_t m_use_counter = 0;
+		int64_t m_next_read = -1;
+		int64_t m_read_chunk = -1;
+		bool m_sequential = false;
+
+		// consecutive writes are gathered here until a chunk worth is queued
+		int64_t m_write_offset = 0;
+		std::vector<uint8_t> m_write_data;
+		size_t m_queued_write = 0;
+		int m_pending_flushes = 0;
+		bool m_write_error = false;
+	};
+
 	typedef struct MSDState
 	{
 		USBDevice dev;
@@ -89,6 +195,9 @@ namespace usb_msd
 		//char fn[MAX_PATH+1]; //TODO Could use with open/close,
 		//but error recovery currently can't deal with file suddenly
 		//becoming not accessible
+		BlockIO io;
+		int64_t io_offset; // image position of the next data phase byte
+		bool flush_pending;
 		/* For async completion.  */
 		USBPacket* packet;
 
@@ -432,6 +541,312 @@ namespace usb_msd
 #endif
 	}
 
+	bool BlockIO::Open(FILE* file)
+	{
+		m_size = get_file_size(file);
+		if (m_size < 0)
+			return false;
+
+		m_file = file;
+		for (Chunk& chunk : m_chunks)
+			chunk.data.resize(ChunkSize);
+
+		m_quit = false;
+		m_thread = std::thread(&BlockIO::WorkerThread, this);
+		return true;
+	}
+
+	void BlockIO::Close()
+	{
+		if (!m_thread.joinable())
+			return;
+
+		Drain();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_work_cv.notify_one();
+		m_thread.join();
+		m_file = nullptr;
+	}
+
+	void BlockIO::WorkerThread()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		for (;;)
+		{
+			m_work_cv.wait(lock, [this] { return m_quit || !m_tasks.empty(); });
+			if (m_tasks.empty())
+				break;
+
+			Task task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+			m_busy = true;
+
+			if (task.type == Task::Load)
+			{
+				// Only this thread touches a loading chunk's data, it's safe without the lock
+				Chunk& chunk = m_chunks[task.chunk];
+				lock.unlock();
+				const size_t len = static_cast<size_t>(std::min(ChunkSize, m_size - task.offset));
+				bool ok = fseeko64(m_file, task.offset, SEEK_SET) == 0 &&
+						  fread(chunk.data.data(), 1, len, m_file) == len;
+				lock.lock();
+
+				if (chunk.stale)
+				{
+					chunk.state = ChunkState::Empty;
+					chunk.offset = -1;
+					chunk.stale = false;
+				}
+				else
+				{
+					chunk.state = ok ? ChunkState::Ready : ChunkState::Failed;
+				}
+			}
+			else if (task.type == Task::Write)
+			{
+				lock.unlock();
+				bool ok = fseeko64(m_file, task.offset, SEEK_SET) == 0 &&
+						  fwrite(task.data.data(), 1, task.data.size(), m_file) == task.data.size();
+				lock.lock();
+
+				m_queued_write -= task.data.size();
+				if (!ok)
+					m_write_error = true;
+			}
+			else
+			{
+				lock.unlock();
+				bool ok = fflush(m_file) == 0;
+				lock.lock();
+
+				m_pending_flushes--;
+				if (!ok)
+					m_write_error = true;
+			}
+
+			m_busy = false;
+			if (m_tasks.empty())
+				m_idle_cv.notify_all();
+		}
+	}
+
+	BlockIO::Chunk* BlockIO::FindChunk(int64_t offset)
+	{
+		for (Chunk& chunk : m_chunks)
+		{
+			if (chunk.offset == offset && chunk.state != ChunkState::Empty)
+				return &chunk;
+		}
+		return nullptr;
+	}
+
+	void BlockIO::LoadChunk(int64_t offset)
+	{
+		if (offset >= m_size || FindChunk(offset))
+			return;
+
+		// Reuse the least recently used chunk that isn't being loaded
+		int victim = -1;
+		for (int i = 0; i < ChunkCount; i++)
+		{
+			const Chunk& chunk = m_chunks[i];
+			if (chunk.state == ChunkState::Loading)
+				continue;
+			if (chunk.state == ChunkState::Empty)
+			{
+				victim = i;
+				break;
+			}
+			if (victim < 0 || chunk.last_use < m_chunks[victim].last_use)
+				victim = i;
+		}
+		if (victim < 0)
+			return;
+
+		// Queued loads must see writes made before them
+		SubmitWrite();
+
+		Chunk& chunk = m_chunks[victim];
+		chunk.offset = offset;
+		chunk.state = ChunkState::Loading;
+		chunk.stale = false;
+		chunk.last_use = ++m_use_counter;
+		Queue({Task::Load, victim, offset, {}});
+	}
+
+	void BlockIO::SubmitWrite()
+	{
+		if (m_write_data.empty())
+			return;
+
+		const int64_t offset = m_write_offset;
+		m_write_offset += m_write_data.size();
+		m_queued_write += m_write_data.size();
+		Queue({Task::Write, -1, offset, std::move(m_write_data)});
+		m_write_data.clear();
+	}
+
+	void BlockIO::Queue(Task&& task)
+	{
+		m_tasks.push_back(std::move(task));
+		m_work_cv.notify_one();
+	}
+
+	void BlockIO::Prefetch(int64_t offset, int64_t len)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_sequential = offset == m_next_read;
+		m_next_read = offset + len;
+		m_read_chunk = -1;
+
+		// Long commands are loaded as they're read, see Read()
+		int64_t end = std::min(offset + len, offset + ReadaheadChunks * ChunkSize);
+		if (m_sequential)
+			end += ReadaheadChunks * ChunkSize;
+
+		for (int64_t chunk = offset - offset % ChunkSize; chunk < end; chunk += ChunkSize)
+			LoadChunk(chunk);
+	}
+
+	int BlockIO::Read(int64_t offset, uint8_t* dst, size_t len)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Nothing is copied until the whole range is there, a packet is all or nothing
+		Chunk* chunks[2] = {};
+		const int64_t first = offset - offset % ChunkSize;
+		const int64_t last = (offset + len - 1) - (offset + len - 1) % ChunkSize;
+		for (int64_t pos = first, i = 0; pos <= last; pos += ChunkSize, i++)
+		{
+			Chunk* chunk = FindChunk(pos);
+			if (!chunk)
+			{
+				LoadChunk(pos);
+				return 0;
+			}
+			if (chunk->state == ChunkState::Loading)
+				return 0;
+			if (chunk->state == ChunkState::Failed)
+			{
+				// Drop it so the next command retries
+				chunk->state = ChunkState::Empty;
+				chunk->offset = -1;
+				return -1;
+			}
+			chunks[i] = chunk;
+		}
+
+		for (Chunk* chunk : chunks)
+		{
+			if (!chunk)
+				break;
+			const int64_t start = std::max(offset, chunk->offset);
+			const int64_t stop = std::min<int64_t>(offset + len, chunk->offset + ChunkSize);
+			memcpy(dst + (start - offset), chunk->data.data() + (start - chunk->offset), stop - start);
+			chunk->last_use = ++m_use_counter;
+		}
+
+		// Keep the window moving with the reads, past the end of the command only if reads are sequential
+		if (last != m_read_chunk)
+		{
+			m_read_chunk = last;
+			const int64_t ahead = last + ReadaheadChunks * ChunkSize;
+			if (m_sequential || ahead < m_next_read)
+				LoadChunk(ahead);
+		}
+
+		return 1;
+	}
+
+	bool BlockIO::Write(int64_t offset, const uint8_t* src, size_t len)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_queued_write + m_write_data.size() + len > MaxQueuedWrite)
+			return false;
+
+		// Keep cached chunks in sync, ones still loading are read again later on
+		for (Chunk& chunk : m_chunks)
+		{
+			if (chunk.state == ChunkState::Empty || chunk.offset >= offset + static_cast<int64_t>(len) ||
+				chunk.offset + ChunkSize <= offset)
+				continue;
+
+			if (chunk.state == ChunkState::Loading)
+			{
+				chunk.stale = true;
+			}
+			else if (chunk.state == ChunkState::Failed)
+			{
+				chunk.state = ChunkState::Empty;
+				chunk.offset = -1;
+			}
+			else
+			{
+				const int64_t start = std::max(offset, chunk.offset);
+				const int64_t stop = std::min<int64_t>(offset + len, chunk.offset + ChunkSize);
+				memcpy(chunk.data.data() + (start - chunk.offset), src + (start - offset), stop - start);
+			}
+		}
+
+		if (!m_write_data.empty() && m_write_offset + static_cast<int64_t>(m_write_data.size()) != offset)
+			SubmitWrite();
+		if (m_write_data.empty())
+			m_write_offset = offset;
+
+		m_write_data.insert(m_write_data.end(), src, src + len);
+		if (m_write_data.size() >= static_cast<size_t>(ChunkSize))
+			SubmitWrite();
+		return true;
+	}
+
+	void BlockIO::Flush()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		SubmitWrite();
+		m_pending_flushes++;
+		Queue({Task::Flush, -1, 0, {}});
+	}
+
+	int BlockIO::FlushStatus()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_pending_flushes > 0)
+			return 0;
+		if (m_write_error)
+		{
+			m_write_error = false;
+			return -1;
+		}
+		return 1;
+	}
+
+	void BlockIO::Drain()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		SubmitWrite();
+		m_idle_cv.wait(lock, [this] { return m_tasks.empty() && !m_busy; });
+	}
+
+	void BlockIO::Invalidate()
+	{
+		Drain();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (Chunk& chunk : m_chunks)
+		{
+			// Drain() left nothing loading
+			chunk.state = ChunkState::Empty;
+			chunk.offset = -1;
+		}
+		m_next_read = -1;
+		m_read_chunk = -1;
+	}
+
 	static void usb_msd_handle_reset(USBDevice* dev)
 	{
 		MSDState* s = (MSDState*)dev;
@@ -555,7 +970,8 @@ namespace usb_msd
 
 	static void usb_msd_copy_data(MSDState* s, USBPacket* p)
 	{
-		size_t len, file_ret;
+		size_t len;
+		int file_ret;
 		len = p->iov.size - p->actual_length;
 		//if (len > s->scsi_len)
 		//    len = s->scsi_len;
@@ -563,28 +979,36 @@ namespace usb_msd
 		if (len > sizeof(s->f.buf))
 			len = sizeof(s->f.buf);
 
-		//TODO No async reader/writer so do it right here
+		// File data goes through s->io, packets are NAKed while it isn't ready and the host retries them
 		if (s->f.tag == s->f.file_op_tag)
 		{
 			switch (s->f.mode)
 			{
 				case USB_MSDM_DATAOUT:
 					usb_packet_copy(p, s->f.buf, len);
-					if (len > 0 && (file_ret = fwrite(s->f.buf, 1, len, s->file)) < len)
+					if (len > 0 && !s->io.Write(s->io_offset, s->f.buf, len))
 					{
-						s->f.result = COMMAND_FAILED; //PHASE_ERROR;
-						set_sense(s, SENSE_CODE(WRITE_FAULT));
-						goto fail;
+						p->actual_length = 0;
+						p->status = USB_RET_NAK;
+						return;
 					}
+					s->io_offset += len;
 					break;
 				case USB_MSDM_DATAIN:
-					if ((file_ret = fread(s->f.buf, 1, p->iov.size, s->file)) < p->iov.size)
+					file_ret = len > 0 ? s->io.Read(s->io_offset, s->f.buf, len) : 1;
+					if (file_ret == 0)
+					{
+						p->status = USB_RET_NAK;
+						return;
+					}
+					else if (file_ret < 0)
 					{
 						s->f.result = COMMAND_FAILED;
 						set_sense(s, SENSE_CODE(UNRECOVERED_READ_ERROR));
 						goto fail;
 					}
 					usb_packet_copy(p, s->f.buf, len);
+					s->io_offset += len;
 					break;
 				default: //TODO
 				fail:
@@ -647,7 +1071,7 @@ namespace usb_msd
 
 				memset(s->f.buf, 0, sizeof(s->f.buf));
 
-				fsize = get_file_size(s->file);
+				fsize = s->io.Size();
 
 				if (fsize == -1) //TODO
 				{
@@ -691,18 +1115,16 @@ namespace usb_msd
 				if (xfer_len == 0) // nothing to do
 					break;
 
-				if (fseeko64(s->file, lba * LBA_BLOCK_SIZE, SEEK_SET))
+				if ((lba + xfer_len) * LBA_BLOCK_SIZE > s->io.Size())
 				{
 					s->f.result = COMMAND_FAILED;
-					//TODO use errno
-					int64_t fsize = get_file_size(s->file);
-					if ((lba + xfer_len) * LBA_BLOCK_SIZE > fsize)
-						set_sense(s, SENSE_CODE(OUT_OF_RANGE));
-					else
-						set_sense(s, SENSE_CODE(NO_SEEK_COMPLETE));
+					set_sense(s, SENSE_CODE(OUT_OF_RANGE));
 					return;
 				}
 
+				s->io_offset = lba * LBA_BLOCK_SIZE;
+				s->io.Prefetch(s->io_offset, s->f.data_len);
+
 				//memset(s->f.buf, 0, sizeof(s->f.buf));
 				//Or do actual reading in USB_MSDM_DATAIN?
 				//TODO probably dont set data_len to read length
@@ -725,19 +1147,21 @@ namespace usb_msd
 
 				if (xfer_len == 0) //nothing to do
 					break;
-				if (fseeko64(s->file, lba * LBA_BLOCK_SIZE, SEEK_SET))
+				if ((lba + xfer_len) * LBA_BLOCK_SIZE > s->io.Size())
 				{
 					s->f.result = COMMAND_FAILED;
-					//TODO use errno
-					int64_t fsize = get_file_size(s->file);
-					if ((lba + xfer_len) * LBA_BLOCK_SIZE > fsize)
-						set_sense(s, SENSE_CODE(OUT_OF_RANGE));
-					else
-						set_sense(s, SENSE_CODE(NO_SEEK_COMPLETE));
+					set_sense(s, SENSE_CODE(OUT_OF_RANGE));
 					return;
 				}
 
 				//Actual write comes with next command in USB_MSDM_DATAOUT
+				s->io_offset = lba * LBA_BLOCK_SIZE;
+				break;
+
+			case SYNCHRONIZE_CACHE:
+				// Writes are cached in s->io, the status is held back until they are on disk
+				s->io.Flush();
+				s->flush_pending = true;
 				break;
 			default:
 				s->f.result = COMMAND_FAILED;
@@ -795,6 +1219,7 @@ namespace usb_msd
 		MSDState* s = (MSDState*)dev;
 		struct usb_msd_cbw cbw;
 		uint8_t devep = p->ep->nr;
+		int flush_status;
 
 		//XXX Note for self if using async td: see qemu dev-storage.c
 		// 1.) USB_MSDM_CBW: set requested mode USB_MSDM_DATAOUT/IN and enqueue command,
@@ -863,6 +1288,8 @@ namespace usb_msd
 						{
 							usb_msd_copy_data(s, p);
 						}
+						if (p->status == USB_RET_NAK)
+							break;
 						if (le32_to_cpu(s->f.csw.residue))
 						{
 							int len = p->iov.size - p->actual_length;
@@ -914,14 +1341,21 @@ namespace usb_msd
 							goto fail;
 						}
 
-						if (false && s->f.req.valid)
-						{ // If reading/writing using something asynchronous
+						flush_status = s->flush_pending ? s->io.FlushStatus() : 1;
+						if (flush_status == 0)
+						{
 							/* still in flight */
-							s->packet = p;
-							p->status = USB_RET_ASYNC;
+							p->status = USB_RET_NAK;
 						}
 						else
 						{
+							s->flush_pending = false;
+							if (flush_status < 0)
+							{
+								s->f.result = COMMAND_FAILED;
+								set_sense(s, SENSE_CODE(WRITE_FAULT));
+							}
+
 							//TODO primarily for setting csw.sig with correct value
 							usb_msd_command_complete(s, s->f.result);
 
@@ -944,6 +1378,8 @@ namespace usb_msd
 						{
 							usb_msd_copy_data(s, p);
 						}
+						if (p->status == USB_RET_NAK)
+							break;
 						if (le32_to_cpu(s->f.csw.residue))
 						{
 							int len = p->iov.size - p->actual_length;
@@ -983,6 +1419,7 @@ namespace usb_msd
 		MSDState* s = (MSDState*)dev;
 		if (s && s->file)
 		{
+			s->io.Close();
 			fclose(s->file);
 			s->file = NULL;
 		}
@@ -1013,6 +1450,14 @@ namespace usb_msd
 			goto fail;
 		}
 
+		if (!s->io.Open(s->file))
+		{
+			Console.WriteLn("usb-msd: Could not get size of image file '%s'\n", var.c_str());
+			goto fail;
+		}
+		s->io_offset = 0;
+		s->flush_pending = false;
+
 		s->f.hash = 0;
 		s->f.last_cmd = -1;
 		s->dev.speed = USB_SPEED_FULL;
@@ -1063,6 +1508,8 @@ namespace usb_msd
 
 				tmp = (MSDState::freeze*)data;
 				s->f = *tmp;
+				s->io.Invalidate();
+				s->flush_pending = false;
 				//ReqState *req = (ReqState *)((char*)data + sizeof(MSDState::freeze));
 				//s->f.req = qemu_mallocz (sizeof(ReqState));
 				//*s->f.req = *req;
@@ -1073,6 +1520,8 @@ namespace usb_msd
 				return sizeof(MSDState::freeze); // + sizeof(ReqState);
 
 			case FreezeAction::Save:
+				// Everything the guest has written so far goes into the image before the state
+				s->io.Drain();
 				tmp = (MSDState::freeze*)data;
 				*tmp = s->f;
 				return sizeof(MSDState::freeze);
@@ -29,6 +29,7 @@
 
 #include "R5900OpcodeTables.h"
 #include "VUmicro.h"
+#include "MTVU.h"
 #include "Vif_Dma.h"
 
 #define _Ft_ _Rt_
@@ -58,6 +59,17 @@ __fi void _vu0run(bool breakOnMbit, bool addCycles) {
 
 	if (!(VU0.VI[REG_VPU_STAT].UL & 1)) return;
 
+	// The program runs on the VU0 thread, the EE stalls until its end (M-bit included)
+	if (THREAD_VU0) {
+		vu0Thread.Sync(true);
+		if (addCycles) {
+			if ((s32)(VU0.cycle - cpuRegs.cycle) > 0)
+				cpuRegs.cycle = VU0.cycle;
+			VU0.cycle = cpuRegs.cycle;
+		}
+		return;
+	}
+
 	//VU0 is ahead of the EE and M-Bit is already encountered, so no need to wait for it, just catch up the EE
 	if ((VU0.flags & VUFLAG_MFLAGSET) && breakOnMbit && VU0.cycle >= cpuRegs.cycle)
 	{
@@ -21,6 +21,7 @@
 #include "PrecompiledHeader.h"
 #include "Common.h"
 #include "VUmicro.h"
+#include "MTVU.h"
 
 #include <cmath>
 
@@ -51,5 +52,8 @@ void __fastcall vu0ExecMicro(u32 addr) {
 
 	CpuVU0->SetStartPC(VU0.VI[REG_TPC].UL << 3);
 	_vuExecMicroDebug(VU0);
-	CpuVU0->ExecuteBlock(1);
+	if (THREAD_VU0)
+		vu0Thread.ExecuteVU();
+	else
+		CpuVU0->ExecuteBlock(1);
 }
@@ -30,6 +30,14 @@ void BaseVUmicroCPU::ExecuteBlock(bool startUp) {
 		return;
 	}
 
+	if (!m_Idx && THREAD_VU0)
+	{
+		// Keep coming back until the program of the VU0 thread has ended
+		if (!vu0Thread.Sync(false))
+			cpuSetNextEventDelta(256);
+		return;
+	}
+
 	if (!(stat & test)) return;
 
 	if (startUp && s) {  // Start Executing a microprogram
@@ -64,6 +72,11 @@ void BaseVUmicroCPU::ExecuteBlockJIT(BaseVUmicroCPU* cpu) {
 	const u32& stat	= VU0.VI[REG_VPU_STAT].UL;
 	const int  test = cpu->m_Idx ? 0x100 : 1;
 
+	if (!cpu->m_Idx && THREAD_VU0) {
+		vu0Thread.Sync(false); // Picks up the results if the program already ended
+		return;
+	}
+
 	if (stat & test) {		// VU is running
 		u32 cycle = cpu->m_Idx ? VU1.cycle : VU0.cycle;
 		s32 delta = (s32)(u32)(cpuRegs.cycle - cycle);
@@ -21,6 +21,14 @@
 
 using namespace Threading;
 
+#ifdef PCSX2_ZSTD
+// Large savestate entries are compressed with zstd, in chunks compressed and decompressed in
+// parallel (thread_zstd.cpp).  They are stored as is, under their name plus ZstdEntry_Suffix.
+extern const wxChar* ZstdEntry_Suffix;
+extern bool ZstdEntry_Compress(const u8* data, size_t size, std::vector<u8>& out);
+extern bool ZstdEntry_Decompress(const u8* data, size_t size, std::vector<u8>& out);
+#endif
+
 // --------------------------------------------------------------------------------------
 //  ArchiveEntry
 // --------------------------------------------------------------------------------------
@@ -106,6 +114,11 @@ public:
 	{
 		return m_data.get();
 	}
+
+	ArchiveDataBuffer* ReleaseBuffer()
+	{
+		return m_data.release();
+	}
 	
 	u8* GetPtr( uint idx )
 	{
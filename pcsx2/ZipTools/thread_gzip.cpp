@@ -62,6 +62,23 @@ void BaseCompressThread::ExecuteTaskInThread()
 		if (!entry.GetDataSize()) continue;
 
 		wxArchiveOutputStream& woot = *(wxArchiveOutputStream*)m_gzfp->GetWxStreamBase();
+
+#ifdef PCSX2_ZSTD
+		// The memory blocks go through zstd, in parallel.  The small stuff isn't worth it.
+		static const uint ZstdMinSize = 0x10000;
+		std::vector<u8> packed;
+		if( entry.GetDataSize() >= ZstdMinSize &&
+			ZstdEntry_Compress( m_src_list->GetPtr( entry.GetDataIndex() ), entry.GetDataSize(), packed ) )
+		{
+			wxZipEntry* zentry = new wxZipEntry( entry.GetFilename() + ZstdEntry_Suffix );
+			zentry->SetMethod( wxZIP_METHOD_STORE );
+			woot.PutNextEntry( zentry );
+			m_gzfp->Write( packed.data(), packed.size() );
+			woot.CloseEntry();
+			continue;
+		}
+#endif
+
 		woot.PutNextEntry( entry.GetFilename() );
 
 		static const uint BlockSize = 0x64000;
@@ -93,6 +110,10 @@ void BaseCompressThread::OnCleanupInThread()
 	wxGetApp().DeleteThread( this );
 
 	safe_delete(m_gzfp);
+
+	// The state buffer goes back to the arena, for the next save
+	if (m_src_list)
+		VmStateArena_Release(m_src_list->ReleaseBuffer());
 	safe_delete(m_src_list);
 }
 
@@ -0,0 +1,147 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "SaveState.h"
+#include "ThreadedZipTools.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Chunked zstd entries: the data is cut in chunks compressed as independent frames, so that
+// all the cores work on them, when saving and when loading.  Layout:
+//   u32 magic, u32 chunk size, u64 data size, u32 compressed size of each chunk, the frames
+
+const wxChar* ZstdEntry_Suffix = L".zst";
+
+static const u32 ZstdEntry_Magic = 0x54535A50; // "PZST"
+static const u32 ZstdEntry_HeaderSize = 16;
+static const u32 ZstdEntry_ChunkSize = 1024 * 1024;
+static const int ZstdEntry_Level = 1;
+
+// Runs job(0) ... job(count - 1) on all the cores, the calling thread included
+template <typename Job>
+static void ZstdEntry_ParallelFor(u32 count, const Job& job)
+{
+	const u32 workers = std::min<u32>(count, std::max(1u, std::thread::hardware_concurrency()));
+	std::atomic<u32> next{0};
+
+	auto work = [&]() {
+		for (u32 i = next++; i < count; i = next++)
+			job(i);
+	};
+
+	std::vector<std::thread> threads;
+	for (u32 i = 1; i < workers; i++)
+		threads.emplace_back(work);
+	work();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+bool ZstdEntry_Compress(const u8* data, size_t size, std::vector<u8>& out)
+{
+	const u32 chunks = (size + ZstdEntry_ChunkSize - 1) / ZstdEntry_ChunkSize;
+	std::vector<std::vector<u8>> frames(chunks);
+	std::atomic<bool> failed{false};
+
+	ZstdEntry_ParallelFor(chunks, [&](u32 i) {
+		const size_t offset = (size_t)i * ZstdEntry_ChunkSize;
+		const size_t length = std::min<size_t>(ZstdEntry_ChunkSize, size - offset);
+
+		frames[i].resize(ZSTD_compressBound(length));
+		const size_t ret = ZSTD_compress(frames[i].data(), frames[i].size(), data + offset, length, ZstdEntry_Level);
+		if (ZSTD_isError(ret))
+			failed = true;
+		else
+			frames[i].resize(ret);
+	});
+
+	if (failed)
+		return false;
+
+	size_t total = ZstdEntry_HeaderSize + chunks * sizeof(u32);
+	for (const std::vector<u8>& frame : frames)
+		total += frame.size();
+
+	out.resize(total);
+	u8* ptr = out.data();
+	auto put = [&ptr](const void* src, size_t len) {
+		memcpy(ptr, src, len);
+		ptr += len;
+	};
+
+	const u64 size64 = size;
+	put(&ZstdEntry_Magic, sizeof(u32));
+	put(&ZstdEntry_ChunkSize, sizeof(u32));
+	put(&size64, sizeof(u64));
+	for (const std::vector<u8>& frame : frames)
+	{
+		const u32 length = frame.size();
+		put(&length, sizeof(u32));
+	}
+	for (const std::vector<u8>& frame : frames)
+		put(frame.data(), frame.size());
+
+	return true;
+}
+
+bool ZstdEntry_Decompress(const u8* data, size_t size, std::vector<u8>& out)
+{
+	if (size < ZstdEntry_HeaderSize)
+		return false;
+
+	u32 magic, chunkSize;
+	u64 dataSize;
+	memcpy(&magic, data, sizeof(u32));
+	memcpy(&chunkSize, data + 4, sizeof(u32));
+	memcpy(&dataSize, data + 8, sizeof(u64));
+	if (magic != ZstdEntry_Magic || !chunkSize || dataSize > 0x80000000ULL)
+		return false;
+
+	const u32 chunks = (dataSize + chunkSize - 1) / chunkSize;
+	if (size < ZstdEntry_HeaderSize + (u64)chunks * sizeof(u32))
+		return false;
+
+	// Where each frame starts
+	std::vector<size_t> offsets(chunks + 1);
+	offsets[0] = ZstdEntry_HeaderSize + chunks * sizeof(u32);
+	for (u32 i = 0; i < chunks; i++)
+	{
+		u32 length;
+		memcpy(&length, data + ZstdEntry_HeaderSize + i * sizeof(u32), sizeof(u32));
+		offsets[i + 1] = offsets[i] + length;
+	}
+	if (offsets[chunks] > size)
+		return false;
+
+	out.resize(dataSize);
+	std::atomic<bool> failed{false};
+
+	ZstdEntry_ParallelFor(chunks, [&](u32 i) {
+		const size_t offset = (size_t)i * chunkSize;
+		const size_t length = std::min<size_t>(chunkSize, dataSize - offset);
+
+		const size_t ret = ZSTD_decompress(out.data() + offset, length, data + offsets[i], offsets[i + 1] - offsets[i]);
+		if (ZSTD_isError(ret) || ret != length)
+			failed = true;
+	});
+
+	return !failed;
+}
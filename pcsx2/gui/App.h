@@ -120,6 +120,10 @@ enum MenuIdentifiers
 	MenuId_Sys_LoadStates,     // Opens load states submenu
 	MenuId_Sys_SaveStates,     // Opens save states submenu
 	MenuId_EnableBackupStates, // Checkbox to enable/disables savestates backup
+	MenuId_EnableIncrementalStates, // Checkbox to enable/disables incremental savestates
+	MenuId_EnableCopyOnWriteStates, // Checkbox to enable/disables copy-on-write savestates
+	MenuId_EnableRewind,       // Checkbox to enable/disables the rewind snapshots
+	MenuId_EnableRunAhead,     // Checkbox to enable/disables run-ahead
 	MenuId_GameSettingsSubMenu,
 	MenuId_EnablePatches,
 	MenuId_EnableCheats,
@@ -199,6 +203,7 @@ enum MenuIdentifiers
 	MenuId_Recording_Config_FrameAdvance,
 	MenuId_Recording_TogglePause,
 	MenuId_Recording_FrameAdvance,
+	MenuId_Recording_GoToFrame,
 	MenuId_Recording_ToggleRecordingMode,
 	MenuId_Recording_VirtualPad_Port0,
 	MenuId_Recording_VirtualPad_Port1,
@@ -340,6 +345,32 @@ public:
 	bool SysAutoRunElf;
 	bool SysAutoRunIrx;
 
+	// Replays this GS dump headless and exits, see GSBenchmark
+	wxString GSBenchDump;
+	wxString GSBenchRenderer;
+	wxString GSBenchJson;
+	wxString GSBenchConfig;
+	long GSBenchLoops;
+
+	// Times the GS memory swizzle of every texture format and exits, see GSBlockBenchmark
+	bool GSBlockBench;
+
+	// Times the VIF unpack recompiler and exits, see dVifBenchmark
+	bool VifBench;
+
+	// Runs the autobooted game for this many vsyncs and exits, see Benchmark.h
+	long BenchFrames;
+	wxString BenchJson;
+	wxString BenchState;
+	wxString BenchReplay;
+	long BenchSavestates;
+
+	// Times the disc image readers and the GameDB load and exits, see IOBenchmark_Run
+	bool IOBench;
+	wxString IOBenchImages;
+	wxString IOBenchJson;
+	long IOBenchSectors;
+
 	StartupOptions()
 	{
 		ForceWizard = false;
@@ -350,6 +381,14 @@ public:
 		SysAutoRunElf = false;
 		SysAutoRunIrx = false;
 		CdvdSource = CDVD_SourceType::NoDisc;
+		GSBenchRenderer = L"ogl";
+		GSBenchLoops = 1;
+		GSBlockBench = false;
+		VifBench = false;
+		BenchFrames = 0;
+		BenchSavestates = 0;
+		IOBench = false;
+		IOBenchSectors = 16384;
 	}
 };
 
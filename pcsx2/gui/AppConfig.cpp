@@ -23,6 +23,7 @@
 
 #include <wx/stdpaths.h>
 #include "DebugTools/Debug.h"
+#include "AsyncLog.h"
 #include <memory>
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -866,6 +867,8 @@ AppConfig::FramerateOptions::FramerateOptions()
 	TurboScalar				= 2.0;
 	SlomoScalar				= 0.50;
 
+	ThroughputPresentInterval	= 60;
+
 	SkipOnLimit				= false;
 	SkipOnTurbo				= false;
 }
@@ -877,6 +880,8 @@ void AppConfig::FramerateOptions::SanityCheck()
 	NominalScalar	.ConfineTo( 0.05, 10.0 );
 	TurboScalar		.ConfineTo( 0.05, 10.0 );
 	SlomoScalar		.ConfineTo( 0.05, 10.0 );
+
+	ThroughputPresentInterval = std::max(ThroughputPresentInterval, 1);
 }
 
 void AppConfig::FramerateOptions::LoadSave( IniInterface& ini )
@@ -887,6 +892,8 @@ void AppConfig::FramerateOptions::LoadSave( IniInterface& ini )
 	IniEntry( TurboScalar );
 	IniEntry( SlomoScalar );
 
+	IniEntry( ThroughputPresentInterval );
+
 	IniEntry( SkipOnLimit );
 	IniEntry( SkipOnTurbo );
 }
@@ -909,6 +916,7 @@ AppConfig::UiTemplateOptions::UiTemplateOptions()
 	LimiterTurbo		= L"Turbo";
 	LimiterSlowmo		= L"Slowmo";
 	LimiterNormal		= L"Normal";
+	LimiterThroughput	= L"Throughput";
 	OutputFrame			= L"Frame";
 	OutputField			= L"Field";
 	OutputProgressive	= L"Progressive";
@@ -928,6 +936,7 @@ void AppConfig::UiTemplateOptions::LoadSave(IniInterface& ini)
 	IniEntry(LimiterTurbo);
 	IniEntry(LimiterSlowmo);
 	IniEntry(LimiterNormal);
+	IniEntry(LimiterThroughput);
 	IniEntry(OutputFrame);
 	IniEntry(OutputField);
 	IniEntry(OutputProgressive);
@@ -1013,7 +1022,13 @@ bool AppConfig::IsOkApplyPreset(int n, bool ignoreMTVU)
 	EmuOptions.GS					= default_Pcsx2Config.GS;
 	EmuOptions.GS.FrameLimitEnable	= original_GS.FrameLimitEnable;	//Frame limiter is not modified by presets
 	EmuOptions.GS.VsyncEnable		= original_GS.VsyncEnable;
+	EmuOptions.GS.LateLatch			= original_GS.LateLatch;
 	EmuOptions.GS.VsyncQueueSize	= original_GS.VsyncQueueSize;
+	EmuOptions.GS.RingBufferSizeFactor = original_GS.RingBufferSizeFactor;
+	EmuOptions.GS.SpinWaitBudget	= original_GS.SpinWaitBudget;
+	EmuOptions.GS.EventLatency		= original_GS.EventLatency;
+	EmuOptions.GS.InputLatencyTrace	= original_GS.InputLatencyTrace;
+	EmuOptions.GS.InputLatencyLog	= original_GS.InputLatencyLog;
 
 	EmuOptions.Cpu					= default_Pcsx2Config.Cpu;
 	EmuOptions.Gamefixes			= default_Pcsx2Config.Gamefixes;
@@ -1021,6 +1036,7 @@ bool AppConfig::IsOkApplyPreset(int n, bool ignoreMTVU)
 	EmuOptions.Speedhacks.bitset	= 0; //Turn off individual hacks to make it visually clear they're not used.
 	EmuOptions.Speedhacks.vuThread	= original_SpeedHacks.vuThread;
 	EmuOptions.Speedhacks.vu1Instant= original_SpeedHacks.vu1Instant;
+	EmuOptions.Speedhacks.threadPinning = original_SpeedHacks.threadPinning;
 	EnableSpeedHacks = true;
 
 	// Actual application of current preset over the base settings which all presets use (mostly pcsx2's default values).
@@ -1088,8 +1104,7 @@ void RelocateLogfile()
 		Console.WriteLn( L"\nRelocating Logfile...\n\tFrom: %s\n\tTo  : %s\n", WX_STR(emuLogName), WX_STR(newlogname) );
 		wxGetApp().DisableDiskLogging();
 
-		fclose( emuLog );
-		emuLog = NULL;
+		AsyncLog::CloseFile();
 	}
 
 	if( emuLog == NULL )
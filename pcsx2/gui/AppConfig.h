@@ -244,6 +244,8 @@ public:
 		Fixed100	TurboScalar;
 		Fixed100	SlomoScalar;
 
+		int			ThroughputPresentInterval; // the max throughput mode shows one in this many frames
+
 		FramerateOptions();
 		
 		void LoadSave( IniInterface& conf );
@@ -269,6 +271,7 @@ public:
 		wxString LimiterTurbo;
 		wxString LimiterSlowmo;
 		wxString LimiterNormal;
+		wxString LimiterThroughput;
 		wxString OutputFrame;
 		wxString OutputField;
 		wxString OutputProgressive;
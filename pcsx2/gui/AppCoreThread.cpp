@@ -17,6 +17,7 @@
 #include "App.h"
 #include "AppSaveStates.h"
 #include "AppGameDatabase.h"
+#include "Benchmark.h"
 
 #include <wx/stdpaths.h>
 #include "fmt/core.h"
@@ -576,11 +577,33 @@ void AppCoreThread::ApplySettings(const Pcsx2Config& src)
 void AppCoreThread::DoCpuReset()
 {
 	PostCoreStatus(CoreThread_Reset);
+	Rewind_ResetInThread();
+	RunAhead_ResetInThread();
 	_parent::DoCpuReset();
+
+	if (g_SkipBiosHack && EmuConfig.UseBootSnapshot)
+	{
+		try
+		{
+			BootSnapshot_Load();
+		}
+		catch (BaseException& ex)
+		{
+			Console.Error(ex.FormatDiagnosticMessage());
+			_parent::DoCpuReset();
+		}
+		catch (std::exception& ex)
+		{
+			Console.Error(ex.what());
+			_parent::DoCpuReset();
+		}
+	}
 }
 
 void AppCoreThread::OnResumeInThread(bool isSuspended)
 {
+	// let the GS open while the disc is opened
+	GetMTGS().Resume();
 	if (m_resetCdvd)
 	{
 		CDVDsys_ChangeSource(g_Conf->CdvdSource);
@@ -592,6 +615,7 @@ void AppCoreThread::OnResumeInThread(bool isSuspended)
 		DoCDVDopen();
 
 	_parent::OnResumeInThread(isSuspended);
+	Benchmark_ResumeInThread();
 	PostCoreStatus(CoreThread_Resumed);
 }
 
@@ -609,13 +633,31 @@ void AppCoreThread::OnCleanupInThread()
 {
 	m_ExecMode = ExecMode_Closing;
 	PostCoreStatus(CoreThread_Stopped);
+	Rewind_ResetInThread();
+	RunAhead_ResetInThread();
+#ifndef DISABLE_RECORDING
+	RecordingKeyframes_ResetInThread();
+#endif
 	_parent::OnCleanupInThread();
 }
 
 void AppCoreThread::VsyncInThread()
 {
-	wxGetApp().LogicalVsync();
+	// The frames run ahead are rolled back, only the real ones poll the pad and count
+	const bool ahead = IsRunAheadFrame();
+
+	if (!ahead)
+		wxGetApp().LogicalVsync();
 	_parent::VsyncInThread();
+	if (!ahead)
+	{
+		Rewind_CaptureInThread();
+#ifndef DISABLE_RECORDING
+		RecordingKeyframes_VsyncInThread();
+#endif
+		Benchmark_VsyncInThread();
+	}
+	RunAhead_VsyncInThread();
 }
 
 void AppCoreThread::GameStartingInThread()
@@ -632,8 +674,16 @@ void AppCoreThread::GameStartingInThread()
 	_parent::GameStartingInThread();
 }
 
+void AppCoreThread::EeloadStartingInThread()
+{
+	if (g_SkipBiosHack && EmuConfig.UseBootSnapshot && !BootSnapshot_Exists())
+		BootSnapshot_Save();
+}
+
 bool AppCoreThread::StateCheckInThread()
 {
+	Benchmark_StateCheckInThread();
+	RunAhead_StateCheckInThread(SysThreadBase::HasPendingStateChangeRequest());
 	return _parent::StateCheckInThread();
 }
 
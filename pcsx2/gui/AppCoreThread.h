@@ -163,6 +163,7 @@ protected:
 	virtual void OnCleanupInThread();
 	virtual void VsyncInThread();
 	virtual void GameStartingInThread();
+	virtual void EeloadStartingInThread();
 	virtual void ExecuteTaskInThread();
 	virtual void DoCpuReset();
 };
@@ -17,22 +17,31 @@
 
 #include "App.h"
 #include "AppGameDatabase.h"
+#include "SharedCache.h"
 
 #include <wx/stdpaths.h>
 #include "fmt/core.h"
 #include <fstream>
+#include <iterator>
+#include <sstream>
 
-std::ifstream AppGameDatabase::getFileAsStream(const wxString& file)
+std::ifstream AppGameDatabase::getFileAsStream(const wxString& file, std::ios::openmode mode)
 {
 // TODO - config - refactor with std::filesystem/ghc::filesystem
 #ifdef _WIN32
-	return std::ifstream(file.wc_str());
+	return std::ifstream(file.wc_str(), mode);
 #else
-	return std::ifstream(file.c_str());
+	return std::ifstream(file.c_str(), mode);
 #endif
 }
 
-AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file)
+bool AppGameDatabase::loadCache(const wxString& file, u64 yamlHash)
+{
+	std::ifstream cacheStream = getFileAsStream(file, std::ios::binary);
+	return this->initDatabaseFromCache(cacheStream, yamlHash);
+}
+
+wxString AppGameDatabase::GetFullPath(const wxString& _file)
 {
 	// TODO - config - refactor with std::filesystem/ghc::filesystem
 
@@ -53,6 +62,12 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file)
 		file = (dir + file).GetFullPath();
 	}
 
+	return file;
+}
+
+AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file)
+{
+	const wxString file(GetFullPath(_file));
 
 	if (!wxFileExists(file))
 	{
@@ -62,17 +77,45 @@ AppGameDatabase& AppGameDatabase::LoadFromFile(const wxString& _file)
 
 	const u64 qpc_Start = GetCPUTicks();
 
-	std::ifstream fileStream = getFileAsStream(file);
-	if (!this->initDatabase(fileStream))
+	std::ifstream fileStream = getFileAsStream(file, std::ios::binary);
+	if (!fileStream)
 	{
-		Console.Error(L"[GameDB] Database could not be loaded successfully");
+		Console.Error("[GameDB] Unable to open GameDB file.");
 		return *this;
 	}
+	const std::string yaml(std::istreambuf_iterator<char>(fileStream), {});
+	const u64 yamlHash = hashYaml(yaml);
+
+	// Only parse the yaml when it changed since the cache was written. In a shared folder each
+	// yaml has its own cache, so instances running different versions don't rewrite it in turn.
+	const wxString cacheFile = SharedCache::GetPath(SharedCache::IsShared()
+		? wxsFormat(L"GameIndex_%016llx.cache", (unsigned long long)yamlHash)
+		: wxString(L"GameIndex.cache"));
+	bool fromCache = loadCache(cacheFile, yamlHash);
+	std::unique_ptr<SharedCache::FileLock> cacheLock;
+	if (!fromCache)
+	{
+		// One instance builds the cache while the others wait for it
+		cacheLock = std::make_unique<SharedCache::FileLock>(cacheFile);
+		fromCache = cacheLock->IsLocked() && loadCache(cacheFile, yamlHash);
+	}
+	if (!fromCache)
+	{
+		if (!this->initDatabase(yaml))
+		{
+			Console.Error(L"[GameDB] Database could not be loaded successfully");
+			return *this;
+		}
+		std::ostringstream cacheOut(std::ios::binary);
+		const std::string cacheData = this->saveCache(cacheOut, yamlHash) ? cacheOut.str() : std::string();
+		if (cacheData.empty() || !SharedCache::ReplaceFile(cacheFile, cacheData.data(), cacheData.size()))
+			Console.Warning(L"[GameDB] Could not write the database cache [%s]", WX_STR(cacheFile));
+	}
 
 	const u64 qpc_end = GetCPUTicks();
 
-	Console.WriteLn(fmt::format("[GameDB] {} games on record (loaded in {}ms)", this->numGames(),
-								(u32)(((qpc_end - qpc_Start) * 1000) / GetTickFrequency())));
+	Console.WriteLn(fmt::format("[GameDB] {} games on record (loaded {}in {}ms)", this->numGames(),
+								fromCache ? "from cache " : "", (u32)(((qpc_end - qpc_Start) * 1000) / GetTickFrequency())));
 
 	return *this;
 }
@@ -32,10 +32,16 @@ public:
 		DESTRUCTOR_CATCHALL
 	}
 
-	AppGameDatabase& LoadFromFile(const wxString& file = Path::Combine(PathDefs::GetProgramDataDir(), wxFileName(L"GameIndex.yaml")));
+	AppGameDatabase& LoadFromFile(const wxString& file = GetDefaultFile());
+
+	static wxString GetDefaultFile() { return Path::Combine(PathDefs::GetProgramDataDir(), wxFileName(L"GameIndex.yaml")); }
+
+	// Relative files are taken from the executable folder, whatever the install folder says
+	static wxString GetFullPath(const wxString& file);
 
 private:
-	std::ifstream getFileAsStream(const wxString& file);
+	std::ifstream getFileAsStream(const wxString& file, std::ios::openmode mode = std::ios::in);
+	bool loadCache(const wxString& file, u64 yamlHash);
 };
 
 static wxString compatToStringWX(GameDatabaseSchema::Compatibility compat)
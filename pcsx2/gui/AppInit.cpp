@@ -15,13 +15,19 @@
 
 #include "PrecompiledHeader.h"
 #include "MainFrame.h"
+#include "GSFrame.h"
 #include "AppAccelerators.h"
+#include "Benchmark.h"
 #include "ConsoleLogger.h"
 #include "MSWstuff.h"
+#include "SharedCache.h"
 #include "MTVU.h" // for thread cancellation on shutdown
+#include "IPU/IPUthread.h"
+#include "x86/newVif.h"
 
 #include "Utilities/IniInterface.h"
 #include "DebugTools/Debug.h"
+#include "AsyncLog.h"
 #include "Dialogs/ModalPopups.h"
 
 #include "Debugger/DisassemblyDialog.h"
@@ -33,6 +39,7 @@
 #include <wx/cmdline.h>
 #include <wx/intl.h>
 #include <wx/stdpaths.h>
+#include <wx/tokenzr.h>
 #include <memory>
 
 using namespace pxSizerFlags;
@@ -224,15 +231,34 @@ void Pcsx2App::OnInitCmdLine(wxCmdLineParser& parser)
 	parser.AddSwitch(wxEmptyString, L"nohacks", _("disables all speedhacks"));
 	parser.AddOption(wxEmptyString, L"gamefixes", _("use the specified comma or pipe-delimited list of gamefixes.") + fixlist, wxCMD_LINE_VAL_STRING);
 	parser.AddSwitch(wxEmptyString, L"fullboot", _("disables fast booting"));
+	parser.AddSwitch(wxEmptyString, L"throughput", _("runs as fast as possible, without audio output and showing only some frames (for automated runs)"));
 	parser.AddOption(wxEmptyString, L"gameargs", _("passes the specified space-delimited string of launch arguments to the game"), wxCMD_LINE_VAL_STRING);
 
 	parser.AddOption(wxEmptyString, L"cfgpath", _("changes the configuration file path"), wxCMD_LINE_VAL_STRING);
 	parser.AddOption(wxEmptyString, L"cfg", _("specifies the PCSX2 configuration file to use"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"sharedcache", _("keeps the caches in a folder shared by all the instances of the host"), wxCMD_LINE_VAL_STRING);
 	parser.AddSwitch(wxEmptyString, L"forcewiz", AddAppName(_("forces %s to start the First-time Wizard")));
 	parser.AddSwitch(wxEmptyString, L"portable", _("enables portable mode operation (requires admin/root access)"));
 
 	parser.AddSwitch(wxEmptyString, L"profiling", _("update options to ease profiling (debug)"));
 
+	parser.AddOption(wxEmptyString, L"gsbench", _("replays a GS dump without presenting it, reports its frame times as JSON and exits"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"gsbench-renderer", _("renderer of the GS dump replay: sw, ogl, dx11 or null (default ogl)"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"gsbench-loops", _("number of times the GS dump is replayed (default 1)"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(wxEmptyString, L"gsbench-json", _("writes the GS dump replay report to this file instead of stdout"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"gsbench-config", _("comma separated key=value GS options used by the GS dump replay, sets separated by ; are replayed in turn"), wxCMD_LINE_VAL_STRING);
+	parser.AddSwitch(wxEmptyString, L"gsbench-block", _("times the GS memory swizzle and unswizzle of every texture format, reports their GB/s as JSON to --gsbench-json or stdout and exits"));
+	parser.AddSwitch(wxEmptyString, L"vifbench", _("times the VIF unpack recompiler on every unpack type, reports its cycles per quadword and exits"));
+	parser.AddOption(wxEmptyString, L"bench-frames", _("runs the booted game for this many frames without the frame limiter, reports its frame times as JSON and exits"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(wxEmptyString, L"bench-json", _("writes the benchmark report to this file instead of stdout"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"bench-state", _("loads this savestate before the benchmark starts"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"bench-replay", _("plays this input recording during the benchmark"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"bench-savestates", _("times this many savestate saves and loads once the frames are run"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddSwitch(wxEmptyString, L"iobench", _("times the disc image readers and the GameDB load, reports them as JSON and exits"));
+	parser.AddOption(wxEmptyString, L"iobench-images", _("disc images read by --iobench, separated like the PATH entries"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(wxEmptyString, L"iobench-sectors", _("sectors read per image and read pattern (default 16384)"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(wxEmptyString, L"iobench-json", _("writes the --iobench report to this file instead of stdout"), wxCMD_LINE_VAL_STRING);
+
 	parser.SetSwitchChars(L"-");
 }
 
@@ -259,10 +285,16 @@ bool Pcsx2App::ParseOverrides(wxCmdLineParser& parser)
 		Overrides.VmSettingsFile = dest;
 	}
 
+	if (parser.Found(L"sharedcache", &dest) && !dest.IsEmpty())
+		SharedCache::SetFolder(wxDirName(dest));
+
 	Overrides.DisableSpeedhacks = parser.Found(L"nohacks");
 
 	Overrides.ProfilingMode = parser.Found(L"profiling");
 
+	if (parser.Found(L"throughput"))
+		g_LimiterMode = Limit_Throughput;
+
 	if (parser.Found(L"gamefixes", &dest))
 	{
 		Overrides.ApplyCustomGamefixes = true;
@@ -321,6 +353,32 @@ bool Pcsx2App::OnCmdLineParsed(wxCmdLineParser& parser)
 		}
 	}
 
+	parser.Found(L"gsbench", &Startup.GSBenchDump);
+	parser.Found(L"gsbench-renderer", &Startup.GSBenchRenderer);
+	parser.Found(L"gsbench-loops", &Startup.GSBenchLoops);
+	parser.Found(L"gsbench-json", &Startup.GSBenchJson);
+	parser.Found(L"gsbench-config", &Startup.GSBenchConfig);
+	Startup.GSBlockBench = parser.Found(L"gsbench-block");
+	Startup.VifBench = parser.Found(L"vifbench");
+
+	parser.Found(L"bench-frames", &Startup.BenchFrames);
+	parser.Found(L"bench-json", &Startup.BenchJson);
+	parser.Found(L"bench-state", &Startup.BenchState);
+	parser.Found(L"bench-replay", &Startup.BenchReplay);
+	parser.Found(L"bench-savestates", &Startup.BenchSavestates);
+
+	Startup.IOBench = parser.Found(L"iobench");
+	parser.Found(L"iobench-images", &Startup.IOBenchImages);
+	parser.Found(L"iobench-sectors", &Startup.IOBenchSectors);
+	parser.Found(L"iobench-json", &Startup.IOBenchJson);
+	if (Startup.BenchFrames > 0)
+	{
+		// Unattended: no frame limiter, and exiting doesn't ask anything
+		Overrides.ProfilingMode = true;
+		m_UseGUI = false;
+		m_NoGuiExitPrompt = false;
+	}
+
 	wxString game_args;
 	if (parser.Found(L"gameargs", &game_args) && !game_args.IsEmpty())
 		Startup.GameLaunchArgs = game_args;
@@ -434,6 +492,21 @@ bool Pcsx2App::OnInit()
 		SysExecutorThread.Start();
 		DetectCpuAndUserMode();
 
+		if (!Startup.GSBenchDump.IsEmpty())
+		{
+			// Headless GS dump replay, nothing else is started
+			GSBenchmark(Startup.GSBenchDump.ToUTF8(), Startup.GSBenchRenderer.ToUTF8(), Startup.GSBenchLoops, Startup.GSBenchJson.ToUTF8(), Startup.GSBenchConfig.ToUTF8());
+			CleanupOnExit();
+			return false;
+		}
+
+		if (Startup.GSBlockBench)
+		{
+			GSBlockBenchmark(Startup.GSBenchJson.ToUTF8());
+			CleanupOnExit();
+			return false;
+		}
+
 		//   Set Manual Exit Handling
 		// ----------------------------
 		// PCSX2 has a lot of event handling logistics, so we *cannot* depend on wxWidgets automatic event
@@ -451,6 +524,59 @@ bool Pcsx2App::OnInit()
 			g_Conf->ProgLogBox.Visible = true;
 		OpenProgramLog();
 		AllocateCoreStuffs();
+
+		if (Startup.VifBench)
+		{
+			// The VIF recompiler caches are reserved by now
+			dVifBenchmark();
+			CleanupOnExit();
+			return false;
+		}
+
+		if (Startup.IOBench)
+		{
+			IOBenchmarkOptions options;
+			options.Images = wxStringTokenize(Startup.IOBenchImages, wxPATH_SEP, wxTOKEN_STRTOK);
+			options.Sectors = Startup.IOBenchSectors;
+			options.Json = Startup.IOBenchJson;
+			IOBenchmark_Run(options);
+			CleanupOnExit();
+			return false;
+		}
+
+		if (Startup.BenchFrames > 0)
+		{
+			wxString error;
+			if (!Startup.SysAutoRun && !Startup.SysAutoRunElf)
+				error = L"nothing to boot, an iso, --elf, --usecd or --nodisc is needed";
+			else if (!Startup.BenchState.IsEmpty() && !wxFileExists(Startup.BenchState))
+				error = L"savestate " + Startup.BenchState + L" not found";
+			else if (!Startup.BenchReplay.IsEmpty() && !wxFileExists(Startup.BenchReplay))
+				error = L"input recording " + Startup.BenchReplay + L" not found";
+#ifndef DISABLE_RECORDING
+			else if (!Startup.BenchReplay.IsEmpty() && !g_Conf->EmuOptions.EnableRecordingTools)
+				error = L"input recordings need the recording tools to be enabled";
+#else
+			else if (!Startup.BenchReplay.IsEmpty())
+				error = L"input recordings aren't supported by this build";
+#endif
+
+			if (!error.IsEmpty())
+			{
+				Console.Error(L"Benchmark: " + error);
+				CleanupOnExit();
+				return false;
+			}
+
+			BenchmarkOptions options;
+			options.Frames = Startup.BenchFrames;
+			options.Json = Startup.BenchJson;
+			options.StateFile = Startup.BenchState;
+			options.Replay = Startup.BenchReplay;
+			options.Savestates = Startup.BenchSavestates;
+			Benchmark_Init(options);
+		}
+
 		if (m_UseGUI)
 			OpenMainFrame();
 
@@ -711,6 +837,8 @@ Pcsx2App::~Pcsx2App()
 	try
 	{
 		vu1Thread.Cancel();
+		vu0Thread.Cancel();
+		ipuThread.Cancel();
 	}
 	DESTRUCTOR_CATCHALL
 }
@@ -722,12 +850,7 @@ void Pcsx2App::CleanUp()
 	m_RecentIsoList = NULL;
 
 	DisableDiskLogging();
-
-	if (emuLog != NULL)
-	{
-		fclose(emuLog);
-		emuLog = NULL;
-	}
+	AsyncLog::CloseFile();
 
 	_parent::CleanUp();
 }
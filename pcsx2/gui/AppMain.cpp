@@ -21,6 +21,7 @@
 #include "AppSaveStates.h"
 #include "AppGameDatabase.h"
 #include "AppAccelerators.h"
+#include "InputLatency.h"
 #ifdef _WIN32
 #include "PAD/Windows/PAD.h"
 #else
@@ -494,7 +495,10 @@ void Pcsx2App::LogicalVsync()
 	}
 
 	if( (wxGetApp().GetGsFramePtr() != NULL) )
+	{
 		PADupdate(0);
+		InputLatency::Sampled();
+	}
 
 	while( const keyEvent* ev = PADkeyEvent() )
 	{
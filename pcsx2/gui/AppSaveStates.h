@@ -23,3 +23,40 @@ extern void StateCopy_SaveToFile(const wxString& file);
 extern void StateCopy_LoadFromFile(const wxString& file);
 extern void StateCopy_SaveToSlot(uint num);
 extern void StateCopy_LoadFromSlot(uint slot, bool isFromBackup = false);
+
+extern bool BootSnapshot_Exists();
+extern void BootSnapshot_Save();
+extern bool BootSnapshot_Load();
+
+extern void Rewind_CaptureInThread();
+extern void Rewind_ResetInThread();
+extern void Rewind_Step();
+
+// Timings of Savestate_BenchmarkInThread, see --bench-savestates
+struct SavestateBenchmark
+{
+	struct Codec
+	{
+		const char* name;
+		double packMs;
+		double unpackMs;
+		size_t packed;
+	};
+
+	size_t bytes = 0;
+	std::vector<double> saveMs;
+	std::vector<double> loadMs;
+	std::vector<Codec> codecs;
+};
+
+extern void Savestate_BenchmarkInThread(uint rounds, SavestateBenchmark& result);
+
+extern void RunAhead_VsyncInThread();
+extern void RunAhead_StateCheckInThread(bool stopping);
+extern void RunAhead_ResetInThread();
+
+#ifndef DISABLE_RECORDING
+extern void RecordingKeyframes_VsyncInThread();
+extern void RecordingKeyframes_ResetInThread();
+extern void RecordingKeyframes_Seek(u32 frame);
+#endif
@@ -0,0 +1,512 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "App.h"
+#include "AppGameDatabase.h"
+#include "AppSaveStates.h"
+#include "Benchmark.h"
+#include "CDVD/CDVDaccess.h"
+#include "CDVD/IsoFileFormats.h"
+#include "CpuUsageProvider.h"
+#include "GS.h"
+#include "MTVU.h"
+#include "x86/RecStats.h"
+
+#ifndef DISABLE_RECORDING
+#include "Recording/InputRecording.h"
+#endif
+
+#include <wx/ffile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+	struct BenchmarkCounters
+	{
+		AllPCSX2Threads threads;
+		u32 stalls[SysMtgsThread::StallBuckets];
+		u64 stallTime;
+		u32 waits[VU_Thread::WaitTypes][VU_Thread::WaitBuckets];
+		u64 waitTime[VU_Thread::WaitTypes];
+		GSPerfTotals gs;
+		bool hasGs;
+		// ee, iop, vu0, vu1
+		u64 recBlocks[4];
+		u64 recTicks[4];
+		u64 recBytes[4];
+
+		void Load()
+		{
+			threads.LoadWithCurrentTimes();
+
+			SysMtgsThread& mtgs = GetMTGS();
+			for (uint i = 0; i < SysMtgsThread::StallBuckets; i++)
+				stalls[i] = mtgs.m_StallCount[i].load(std::memory_order_relaxed);
+			stallTime = mtgs.m_StallTime.load(std::memory_order_relaxed);
+
+			for (uint t = 0; t < VU_Thread::WaitTypes; t++)
+			{
+				for (uint i = 0; i < VU_Thread::WaitBuckets; i++)
+					waits[t][i] = vu1Thread.waitCount[t][i].load(std::memory_order_relaxed);
+				waitTime[t] = vu1Thread.waitTime[t].load(std::memory_order_relaxed);
+			}
+
+			hasGs = GSgetPerfTotals(gs);
+
+			const RecompileStats* recs[4] = {&g_eeRecStats, &g_iopRecStats, &g_vuRecStats[0], &g_vuRecStats[1]};
+			for (uint i = 0; i < 4; i++)
+			{
+				recBlocks[i] = recs[i]->blocks.load(std::memory_order_relaxed);
+				recTicks[i] = recs[i]->ticks.load(std::memory_order_relaxed);
+				recBytes[i] = recs[i]->bytes.load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	class Benchmark
+	{
+	public:
+		enum Phase
+		{
+			Phase_Off,
+			Phase_Boot,   // waiting for the first vsync of the boot
+			Phase_Setup,  // the state or the recording is being applied
+			Phase_Warmup, // skips the vsync that resumed from the setup
+			Phase_Run,
+			Phase_Savestates, // waiting for a state check to time the savestates
+			Phase_Done,
+		};
+
+		BenchmarkOptions m_options;
+		std::atomic<int> m_phase{Phase_Off};
+
+		std::chrono::steady_clock::time_point m_init;
+		double m_bootMs = 0; // from the init to the first vsync
+
+		std::vector<double> m_frames; // in milliseconds
+		std::chrono::steady_clock::time_point m_last;
+		BenchmarkCounters m_start;
+		BenchmarkCounters m_end;
+		SavestateBenchmark m_savestates;
+
+		void Vsync();
+		void Begin();
+		void Finish();
+		void StateCheck();
+		void Report();
+		void WriteReport(const BenchmarkCounters& end);
+	};
+
+	Benchmark s_Benchmark;
+} // namespace
+
+// Runs on the main thread, both loading the state and playing a recording suspend the
+// core thread, which resumes once they are done.
+static void Benchmark_Setup()
+{
+	if (wxGetApp().Rpc_TryInvokeAsync(&Benchmark_Setup))
+		return;
+
+	const BenchmarkOptions& options = s_Benchmark.m_options;
+
+#ifndef DISABLE_RECORDING
+	if (!options.Replay.IsEmpty())
+	{
+		// Recordings made from a savestate load their own, the others reboot the game
+		if (!g_InputRecording.Play(nullptr, options.Replay))
+		{
+			Console.Error(L"Benchmark: Failed to play the input recording %s", WX_STR(options.Replay));
+			s_Benchmark.m_phase = Benchmark::Phase_Done;
+			wxGetApp().PrepForExit();
+		}
+		return;
+	}
+#endif
+
+	StateCopy_LoadFromFile(options.StateFile);
+}
+
+void Benchmark::Vsync()
+{
+	switch (m_phase)
+	{
+		case Phase_Boot:
+			m_bootMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_init).count();
+			if (m_options.StateFile.IsEmpty() && m_options.Replay.IsEmpty())
+			{
+				Begin();
+				break;
+			}
+			m_phase = Phase_Setup;
+			Benchmark_Setup();
+			break;
+
+		case Phase_Warmup:
+			Begin();
+			break;
+
+		case Phase_Run:
+		{
+			const auto now = std::chrono::steady_clock::now();
+			m_frames.push_back(std::chrono::duration<double, std::milli>(now - m_last).count());
+			m_last = now;
+
+			if (m_frames.size() >= static_cast<size_t>(m_options.Frames))
+				Finish();
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void Benchmark::Begin()
+{
+	Console.WriteLn(Color_StrongGreen, "Benchmark: Running %ld frames", m_options.Frames);
+
+	m_frames.clear();
+	m_frames.reserve(m_options.Frames);
+	m_start.Load();
+	m_last = std::chrono::steady_clock::now();
+	m_phase = Phase_Run;
+}
+
+void Benchmark::Finish()
+{
+	m_end.Load();
+
+	// Loading a state in the middle of the CPU execution would pull the code from under it
+	if (m_options.Savestates > 0)
+	{
+		m_phase = Phase_Savestates;
+		GetCoreThread().RequestStateCheckInThread();
+		return;
+	}
+
+	Report();
+}
+
+void Benchmark::StateCheck()
+{
+	Console.WriteLn(Color_StrongGreen, "Benchmark: Timing %ld savestates", m_options.Savestates);
+	Savestate_BenchmarkInThread(m_options.Savestates, m_savestates);
+	Report();
+}
+
+void Benchmark::Report()
+{
+	m_phase = Phase_Done;
+
+	WriteReport(m_end);
+
+	// Cancels the core thread, so it can't be done from in here
+	wxGetApp().PostAppMethod(&Pcsx2App::PrepForExit);
+}
+
+// "name": {"avg": ..., "min": ..., "max": ...} of the timings in milliseconds
+static void Benchmark_WriteTimes(FILE* fp, const char* name, const std::vector<double>& ms)
+{
+	if (ms.empty())
+	{
+		fprintf(fp, "\"%s\": null", name);
+		return;
+	}
+
+	double total = 0;
+	for (double t : ms)
+		total += t;
+
+	fprintf(fp, "\"%s\": {\"avg\": %.3f, \"min\": %.3f, \"max\": %.3f}", name,
+		total / ms.size(), *std::min_element(ms.begin(), ms.end()), *std::max_element(ms.begin(), ms.end()));
+}
+
+void Benchmark::WriteReport(const BenchmarkCounters& end)
+{
+	std::vector<double> sorted(m_frames);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0;
+	for (double ms : m_frames)
+		total += ms;
+
+	auto percentile = [&](double p) {
+		return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+	};
+
+	// Thread times are in thread ticks, the elapsed time in cpu ticks
+	const AllPCSX2Threads threads(end.threads - m_start.threads);
+	const double elapsed = static_cast<double>(threads.update) / GetTickFrequency();
+	const double threadTicks = static_cast<double>(GetThreadTicksPerSecond());
+	auto usage = [&](u64 ticks) {
+		return threadTicks && elapsed ? 100.0 * ticks / threadTicks / elapsed : 0.0;
+	};
+
+	const wxString& json = m_options.Json;
+	FILE* fp = json.IsEmpty() ? stdout : wxFopen(json, L"w");
+	if (!fp)
+	{
+		Console.Error(L"Benchmark: Failed to write the report to %s", WX_STR(json));
+		return;
+	}
+
+	fprintf(fp, "{\n\t\"frames\": %zu,\n\t\"seconds\": %.3f,\n\t\"fps\": %.2f,\n", m_frames.size(), elapsed, m_frames.size() / elapsed);
+	fprintf(fp, "\t\"boot_ms\": %.1f,\n", m_bootMs);
+	fprintf(fp, "\t\"frame_ms\": {\"avg\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+		total / m_frames.size(), percentile(0.5), percentile(0.9), percentile(0.99), sorted.back());
+	fprintf(fp, "\t\"cpu_pct\": {\"ee\": %.1f, \"gs\": %.1f, \"vu\": %.1f},\n", usage(threads.ee), usage(threads.gs), usage(threads.vu));
+
+	// Stall buckets are <10us, <100us, <1ms, <10ms and longer
+	fprintf(fp, "\t\"mtgs_stalls\": {\"count\": [");
+	for (uint i = 0; i < SysMtgsThread::StallBuckets; i++)
+		fprintf(fp, "%s%u", i ? ", " : "", end.stalls[i] - m_start.stalls[i]);
+	fprintf(fp, "], \"ms\": %.3f},\n", (end.stallTime - m_start.stallTime) / 1000.0);
+
+	static const char* waitNames[VU_Thread::WaitTypes] = {"ee", "idle", "xgkick"};
+	fprintf(fp, "\t\"mtvu_waits\": {");
+	for (uint t = 0; t < VU_Thread::WaitTypes; t++)
+	{
+		fprintf(fp, "%s\"%s\": {\"count\": [", t ? ", " : "", waitNames[t]);
+		for (uint i = 0; i < VU_Thread::WaitBuckets; i++)
+			fprintf(fp, "%s%u", i ? ", " : "", end.waits[t][i] - m_start.waits[t][i]);
+		fprintf(fp, "], \"ms\": %.3f}", (end.waitTime[t] - m_start.waitTime[t]) / 1000.0);
+	}
+	fprintf(fp, "}");
+
+	if (end.hasGs && m_start.hasGs)
+	{
+		fprintf(fp, ",\n\t\"renderer\": {\"frames\": %.0f, \"draw\": %.0f, \"prim\": %.0f, \"swizzle\": %.0f, \"swizzle_ms\": %.3f, \"unswizzle\": %.0f, \"fillrate\": %.0f}",
+			end.gs.frames - m_start.gs.frames, end.gs.draw - m_start.gs.draw, end.gs.prim - m_start.gs.prim,
+			end.gs.swizzle - m_start.gs.swizzle, end.gs.swizzle_ms - m_start.gs.swizzle_ms, end.gs.unswizzle - m_start.gs.unswizzle, end.gs.fillrate - m_start.gs.fillrate);
+	}
+
+	static const char* recNames[4] = {"ee", "iop", "vu0", "vu1"};
+	fprintf(fp, ",\n\t\"recompile\": {");
+	for (uint i = 0; i < 4; i++)
+	{
+		fprintf(fp, "%s\"%s\": {\"blocks\": %llu, \"ms\": %.3f, \"bytes\": %llu}", i ? ", " : "", recNames[i],
+			static_cast<unsigned long long>(end.recBlocks[i] - m_start.recBlocks[i]),
+			(end.recTicks[i] - m_start.recTicks[i]) * 1000.0 / GetTickFrequency(),
+			static_cast<unsigned long long>(end.recBytes[i] - m_start.recBytes[i]));
+	}
+	fprintf(fp, "}");
+
+	if (m_options.Savestates > 0)
+	{
+		const SavestateBenchmark& states = m_savestates;
+		const double mib = states.bytes / double(1 << 20);
+
+		fprintf(fp, ",\n\t\"savestate\": {\"rounds\": %zu, \"bytes\": %zu, ", states.saveMs.size(), states.bytes);
+		Benchmark_WriteTimes(fp, "save_ms", states.saveMs);
+		fprintf(fp, ", ");
+		Benchmark_WriteTimes(fp, "load_ms", states.loadMs);
+		fprintf(fp, ",\n\t\t\"codecs\": {");
+		for (size_t i = 0; i < states.codecs.size(); i++)
+		{
+			const SavestateBenchmark::Codec& codec = states.codecs[i];
+			fprintf(fp, "%s\"%s\": {\"packed\": %zu, \"ratio\": %.3f, \"pack_ms\": %.3f, \"pack_mib_s\": %.1f, \"unpack_ms\": %.3f, \"unpack_mib_s\": %.1f}",
+				i ? ", " : "", codec.name, codec.packed, (double)codec.packed / states.bytes,
+				codec.packMs, mib * 1000.0 / codec.packMs, codec.unpackMs, mib * 1000.0 / codec.unpackMs);
+		}
+		fprintf(fp, "}}");
+	}
+
+	fprintf(fp, "\n}\n");
+
+	if (fp != stdout)
+		fclose(fp);
+}
+
+void Benchmark_Init(const BenchmarkOptions& options)
+{
+	s_Benchmark.m_options = options;
+	s_Benchmark.m_init = std::chrono::steady_clock::now();
+	s_Benchmark.m_phase = options.Frames > 0 ? Benchmark::Phase_Boot : Benchmark::Phase_Off;
+}
+
+void Benchmark_VsyncInThread()
+{
+	if (s_Benchmark.m_phase != Benchmark::Phase_Off)
+		s_Benchmark.Vsync();
+}
+
+void Benchmark_ResumeInThread()
+{
+	int setup = Benchmark::Phase_Setup;
+	s_Benchmark.m_phase.compare_exchange_strong(setup, Benchmark::Phase_Warmup);
+}
+
+void Benchmark_StateCheckInThread()
+{
+	if (s_Benchmark.m_phase == Benchmark::Phase_Savestates)
+		s_Benchmark.StateCheck();
+}
+
+// --------------------------------------------------------------------------------------
+//  IOBenchmark
+// --------------------------------------------------------------------------------------
+// Nothing drops the file cache of the OS, the first read pattern of an image that was read
+// recently measures the decompression rather than the disk.
+
+static double IOBenchmark_Ms(u64 start)
+{
+	return (GetCPUTicks() - start) * 1000.0 / GetTickFrequency();
+}
+
+// Windows paths are full of backslashes
+static std::string IOBenchmark_JsonString(const wxString& str)
+{
+	std::string out;
+	for (const char c : std::string(str.ToUTF8()))
+	{
+		if (c == '\\' || c == '"')
+			out += '\\';
+		out += c;
+	}
+	return out;
+}
+
+// Through the read ahead of the ISO source, so the readers prefetch and map as they do in game
+static bool IOBenchmark_Read(InputIsoFile& iso, const std::vector<u32>& lsns, double& ms)
+{
+	u8 buffer[CD_FRAMESIZE_RAW];
+
+	const u64 start = GetCPUTicks();
+	for (u32 lsn : lsns)
+	{
+		iso.BeginRead2(lsn);
+		if (iso.FinishRead3(buffer, CDVD_MODE_2048) < 0)
+			return false;
+	}
+	ms = IOBenchmark_Ms(start);
+
+	return true;
+}
+
+static void IOBenchmark_Image(FILE* fp, const wxString& file, u32 sectors)
+{
+	fprintf(fp, "{\"file\": \"%s\"", IOBenchmark_JsonString(file).c_str());
+
+	InputIsoFile iso;
+	bool opened = false;
+
+	const u64 start = GetCPUTicks();
+	try
+	{
+		opened = iso.Open(file);
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error(L"Benchmark: %s", WX_STR(ex.FormatDiagnosticMessage()));
+	}
+	const double openMs = IOBenchmark_Ms(start);
+
+	if (!opened || !iso.GetBlockCount())
+	{
+		fprintf(fp, ", \"error\": \"can't open the image\"}");
+		return;
+	}
+
+	const u32 blocks = iso.GetBlockCount();
+	const u32 count = std::min(sectors, blocks);
+
+	// The random sectors are the same on every run
+	std::vector<u32> sequential(count);
+	std::vector<u32> random(count);
+	u32 seed = 0x9E3779B9u;
+	for (u32 i = 0; i < count; i++)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		sequential[i] = i;
+		random[i] = seed % blocks;
+	}
+
+	fprintf(fp, ", \"blocks\": %u, \"open_ms\": %.3f", blocks, openMs);
+
+	static const char* const names[2] = {"sequential", "random"};
+	const std::vector<u32>* patterns[2] = {&sequential, &random};
+	for (int i = 0; i < 2; i++)
+	{
+		double ms;
+		if (IOBenchmark_Read(iso, *patterns[i], ms))
+			fprintf(fp, ", \"%s\": {\"sectors\": %u, \"ms\": %.3f, \"mib_s\": %.2f}", names[i], count, ms, count * 2048.0 / (1 << 20) * 1000.0 / ms);
+		else
+			fprintf(fp, ", \"%s\": {\"error\": \"read failed\"}", names[i]);
+	}
+
+	fprintf(fp, "}");
+}
+
+void IOBenchmark_Run(const IOBenchmarkOptions& options)
+{
+	static const int GameDBLoads = 4;
+
+	FILE* fp = options.Json.IsEmpty() ? stdout : wxFopen(options.Json, L"w");
+	if (!fp)
+	{
+		Console.Error(L"Benchmark: Failed to write the report to %s", WX_STR(options.Json));
+		return;
+	}
+
+	fprintf(fp, "{\n\t\"images\": [");
+	for (size_t i = 0; i < options.Images.size(); i++)
+	{
+		Console.WriteLn(Color_StrongGreen, L"Benchmark: Reading %s", WX_STR(options.Images[i]));
+		fprintf(fp, "%s\n\t\t", i ? "," : "");
+		IOBenchmark_Image(fp, options.Images[i], static_cast<u32>(std::max(options.Sectors, 1L)));
+	}
+	fprintf(fp, "\n\t],\n");
+
+	// The first load builds the cache when it is missing, the next ones are the usual startup
+	const wxString dbFile(AppGameDatabase::GetFullPath(AppGameDatabase::GetDefaultFile()));
+	std::vector<double> loads;
+	int games = 0;
+	for (int i = 0; i < GameDBLoads; i++)
+	{
+		const u64 start = GetCPUTicks();
+		AppGameDatabase db;
+		db.LoadFromFile(dbFile);
+		loads.push_back(IOBenchmark_Ms(start));
+		games = db.numGames();
+	}
+
+	// What the first load after an update of the yaml costs
+	double parseMs = -1;
+	wxFFile yamlFile(dbFile, L"rb");
+	std::string yaml(yamlFile.IsOpened() ? yamlFile.Length() : 0, '\0');
+	if (!yaml.empty() && yamlFile.Read(&yaml[0], yaml.size()) == yaml.size())
+	{
+		const u64 start = GetCPUTicks();
+		YamlGameDatabaseImpl parsed;
+		if (parsed.initDatabase(yaml))
+			parseMs = IOBenchmark_Ms(start);
+	}
+
+	fprintf(fp, "\t\"gamedb\": {\"games\": %d, \"first_load_ms\": %.3f, ", games, loads[0]);
+	Benchmark_WriteTimes(fp, "load_ms", std::vector<double>(loads.begin() + 1, loads.end()));
+	if (parseMs >= 0)
+		fprintf(fp, ", \"parse_ms\": %.3f}\n}\n", parseMs);
+	else
+		fprintf(fp, ", \"parse_ms\": null}\n}\n");
+
+	if (fp != stdout)
+		fclose(fp);
+}
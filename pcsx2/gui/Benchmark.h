@@ -0,0 +1,47 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Scripted runs of a fixed number of vsyncs with the limiter off, see --bench-frames.
+// The state or the input recording is applied once the boot reached its first vsync,
+// the report is written as JSON when the last frame is done and PCSX2 then exits.  It also
+// has the boot time to the first vsync and, with --bench-savestates, the savestate timings.
+struct BenchmarkOptions
+{
+	long Frames = 0;
+	wxString Json;      // stdout when empty
+	wxString StateFile; // loaded before the run, optional
+	wxString Replay;    // input recording played during the run, optional
+	long Savestates = 0; // savestate save and load rounds once the frames are run
+};
+
+extern void Benchmark_Init(const BenchmarkOptions& options);
+
+extern void Benchmark_VsyncInThread();
+extern void Benchmark_ResumeInThread();
+extern void Benchmark_StateCheckInThread();
+
+// Headless timings of the disc image readers and of the GameDB load, see --iobench.  Each
+// image is opened like the ISO source does, whatever its format, then read sequentially from
+// the start and at random sectors spread over the disc.
+struct IOBenchmarkOptions
+{
+	wxArrayString Images;
+	long Sectors = 16384; // per image and read pattern
+	wxString Json;        // stdout when empty
+};
+
+extern void IOBenchmark_Run(const IOBenchmarkOptions& options);
@@ -24,6 +24,7 @@
 #include "Utilities/SafeArray.inl"
 #include "Dialogs/LogOptionsDialog.h"
 #include "DebugTools/Debug.h"
+#include "AsyncLog.h"
 
 #include <wx/textfile.h>
 
@@ -1074,11 +1075,7 @@ static void __concall ConsoleToFile_Newline()
 	if ((g_Conf) && (g_Conf->EmuOptions.ConsoleToStdio)) ConsoleWriter_Stdout.Newline();
 #endif
 
-#if defined(__unix__)
-	fputc( '\n', emuLog );
-#else
-	fputs( "\r\n", emuLog );
-#endif
+	AsyncLog::Write( wxString(), true );
 }
 
 static void __concall ConsoleToFile_DoWrite( const wxString& fmt )
@@ -1087,15 +1084,16 @@ static void __concall ConsoleToFile_DoWrite( const wxString& fmt )
 	if ((g_Conf) && (g_Conf->EmuOptions.ConsoleToStdio)) ConsoleWriter_Stdout.WriteRaw(fmt);
 #endif
 
-	px_fputs( emuLog, fmt.ToUTF8() );
+	AsyncLog::Write( fmt, false );
 }
 
 static void __concall ConsoleToFile_DoWriteLn( const wxString& fmt )
 {
-	ConsoleToFile_DoWrite( fmt );
-	ConsoleToFile_Newline();
+#if defined(__unix__)
+	if ((g_Conf) && (g_Conf->EmuOptions.ConsoleToStdio)) ConsoleWriter_Stdout.DoWriteLn(fmt);
+#endif
 
-	if (emuLog != NULL) fflush( emuLog );
+	AsyncLog::Write( fmt, true );
 }
 
 static void __concall ConsoleToFile_SetTitle( const wxString& title )
@@ -1244,17 +1242,8 @@ void Pcsx2App::DisableDiskLogging() const
 	const bool logBoxOpen = (GetProgramLog() != NULL);
 	Console_SetActiveHandler( logBoxOpen ? (IConsoleWriter&)ConsoleWriter_Window : (IConsoleWriter&)ConsoleWriter_Stdout );
 
-	// Semi-hack: It's possible, however very unlikely, that a secondary thread could attempt
-	// to write to the logfile just before we disable logging, and would thus have a pending write
-	// operation to emuLog file handle at the same time we're trying to re-initialize it.  The CRT
-	// has some guards of its own, and PCSX2 itself typically suspends the "log happy" threads
-	// when changing settings, so the chance for problems is low.  We minimize it further here
-	// by sleeping off 5ms, which should allow any pending log-to-disk events to finish up.
-	//
-	// (the most correct solution would be a mutex lock in the Disk logger itself, but for now I
-	//  am going to try and keep the logger lock-free and use this semi-hack instead).
-
-	Threading::Sleep( 5 );
+	// Text still queued by other threads is written by the log writer thread, and
+	// AsyncLog::CloseFile() writes it out before it closes the file.
 }
 
 void Pcsx2App::DisableWindowLogging() const
@@ -650,7 +650,7 @@ void Dialogs::GSDumpDialog::ProcessDumpEvent(const GSData& event, char* regs)
 		}
 		case VSync:
 		{
-			GSvsync((*((int*)(regs + 4096)) & 0x2000) > 0 ? (u8)1 : (u8)0);
+			GSvsync((*((int*)(regs + 4096)) & 0x2000) > 0 ? (u8)1 : (u8)0, true);
 			g_FrameCount++;
 			Pcsx2App* app = (Pcsx2App*)wxApp::GetInstance();
 			if (app)
@@ -783,7 +783,7 @@ void Dialogs::GSDumpDialog::GSThread::ExecuteTaskInThread()
 
 	if (GSfreeze(FreezeAction::Load, &fd))
 		GSDump::isRunning = false;
-	GSvsync(1);
+	GSvsync(1, true);
 	GSreset();
 	GSsetBaseMem((u8*)regs);
 	GSfreeze(FreezeAction::Load, &fd);
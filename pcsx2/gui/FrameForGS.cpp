@@ -22,6 +22,7 @@
 #include "GS.h"
 #include "MainFrame.h"
 #include "MSWstuff.h"
+#include "AsyncFileReader.h"
 #ifdef _WIN32
 #include "PAD/Windows/PAD.h"
 #else
@@ -65,6 +66,7 @@ void GSPanel::InitDefaultAccelerators()
 	m_Accels->Map( AAC( WXK_F3 ).Shift(),		"States_DefrostCurrentSlotBackup");
 	m_Accels->Map( AAC( WXK_F2 ),				"States_CycleSlotForward" );
 	m_Accels->Map( AAC( WXK_F2 ).Shift(),		"States_CycleSlotBackward" );
+	m_Accels->Map( AAC( WXK_BACK ),				"States_Rewind" );
 
 	m_Accels->Map( AAC( WXK_F4 ),				"Framelimiter_MasterToggle");
 	m_Accels->Map( AAC( WXK_F4 ).Shift(),		"Frameskip_Toggle");
@@ -92,6 +94,7 @@ void GSPanel::InitDefaultAccelerators()
 	m_Accels->Map( AAC( WXK_F9 ),				"Sys_RenderswitchToggle");
 
 	m_Accels->Map( AAC( WXK_F10 ),				"Sys_LoggingToggle" );
+	m_Accels->Map( AAC( WXK_F10 ).Shift(),		"Sys_TimelineToggle" );
 	m_Accels->Map( AAC( WXK_F11 ),				"Sys_FreezeGS" );
 	m_Accels->Map( AAC( WXK_F12 ),				"Sys_RecordingToggle" );
 
@@ -549,6 +552,7 @@ static const uint TitleBarUpdateMsWhenRecording = 50;
 GSFrame::GSFrame( const wxString& title)
 	: wxFrame(NULL, wxID_ANY, title, g_Conf->GSWindow.WindowPos)
 	, m_timer_UpdateTitle( this )
+	, m_preloadProgress( -1 )
 {
 	SetIcons( wxGetApp().GetIconBundle() );
 	SetBackgroundColour( *wxBLACK );
@@ -704,6 +708,15 @@ GSPanel* GSFrame::GetViewport()
 
 void GSFrame::OnUpdateTitle( wxTimerEvent& evt )
 {
+	// The main window status bar shows the progress of the iso preload
+	const int preload = PreloadingFileReader::GetProgress();
+	if (preload != m_preloadProgress)
+	{
+		m_preloadProgress = preload;
+		if (MainEmuFrame* mainFrame = wxGetApp().GetMainFramePtr())
+			mainFrame->UpdateStatusBar();
+	}
+
 	// Update the title only after the completion of at least a single Vsync, it's pointless to display the fps
 	// when there are have been no frames rendered and SMODE2 register seems to fresh start with 0 on all the bitfields which
 	// leads to the value of INT bit as 0 initially and the games are mentioned as progressive which is a bit misleading,
@@ -755,13 +768,19 @@ void GSFrame::OnUpdateTitle( wxTimerEvent& evt )
 
 	wxString limiterStr = templates.LimiterUnlimited;
 
-	if( g_Conf->EmuOptions.GS.FrameLimitEnable )
+	if( g_LimiterMode == Limit_Throughput )
+	{
+		// The speed up is the interesting figure when nothing limits the speed
+		limiterStr = templates.LimiterThroughput + pxsFmt(L" x%.2f", percentage / 100);
+	}
+	else if( g_Conf->EmuOptions.GS.FrameLimitEnable )
 	{
 		switch( g_LimiterMode )
 		{
 			case Limit_Nominal:	limiterStr = templates.LimiterNormal; break;
 			case Limit_Turbo:	limiterStr = templates.LimiterTurbo; break;
 			case Limit_Slomo:	limiterStr = templates.LimiterSlowmo; break;
+			default: break;
 		}
 	}
 
@@ -26,6 +26,7 @@ enum LimiterModeType
 	Limit_Nominal,
 	Limit_Turbo,
 	Limit_Slomo,
+	Limit_Throughput, // no limiter, vsync nor audio output, and only every Nth frame shown
 };
 
 extern LimiterModeType g_LimiterMode;
@@ -96,6 +97,7 @@ protected:
 	wxStatusBar*			m_statusbar;
 
 	CpuUsageProvider		m_CpuUsage;
+	int						m_preloadProgress;
 
 public:
 	GSFrame( const wxString& title);
@@ -33,6 +33,7 @@
 #include "DebugTools/Debug.h"
 #include "R3000A.h"
 #include "SPU2/spu2.h"
+#include "Timeline.h"
 #include "gui/Dialogs/ModalPopups.h"
 
 // renderswitch - tells GS to go into dx9 sw if "renderswitch" is set.
@@ -81,7 +82,10 @@ namespace Implementations
 		if (EmuConfig.GS.FrameSkipEnable)
 		{
 			OSDlog(Color_StrongRed, true, "(FrameSkipping) Enabled.");
-			OSDlog(Color_StrongRed, true, "  FrameDraws=%d, FrameSkips=%d", g_Conf->EmuOptions.GS.FramesToDraw, g_Conf->EmuOptions.GS.FramesToSkip);
+			if (g_Conf->EmuOptions.GS.FrameSkipAdaptive)
+				OSDlog(Color_StrongRed, true, "  Adaptive");
+			else
+				OSDlog(Color_StrongRed, true, "  FrameDraws=%d, FrameSkips=%d", g_Conf->EmuOptions.GS.FramesToDraw, g_Conf->EmuOptions.GS.FramesToSkip);
 		}
 		else
 		{
@@ -162,6 +166,25 @@ namespace Implementations
 		pauser.AllowResume();
 	}
 
+	void Framelimiter_ThroughputToggle()
+	{
+		ScopedCoreThreadPause pauser;
+		if (g_LimiterMode == Limit_Throughput)
+		{
+			g_LimiterMode = Limit_Nominal;
+			OSDlog(Color_StrongRed, true, "(FrameLimiter) Max throughput DISABLED.");
+		}
+		else
+		{
+			g_LimiterMode = Limit_Throughput;
+			OSDlog(Color_StrongRed, true, "(FrameLimiter) Max throughput ENABLED, showing 1 in %d frames.", g_Conf->Framerate.ThroughputPresentInterval);
+		}
+
+		gsUpdateFrequency(g_Conf->EmuOptions);
+
+		pauser.AllowResume();
+	}
+
 	void Framelimiter_MasterToggle()
 	{
 		ScopedCoreThreadPause pauser;
@@ -170,6 +193,7 @@ namespace Implementations
 
 		// Turbo/Slowmo don't make sense when framelimiter is toggled
 		g_LimiterMode = Limit_Nominal;
+		gsUpdateFrequency(g_Conf->EmuOptions);
 
 		pauser.AllowResume();
 	}
@@ -429,6 +453,22 @@ namespace Implementations
 #endif
 	}
 
+	void Sys_TimelineToggle()
+	{
+		if (!Timeline::IsEnabled())
+		{
+			Timeline::Start();
+			OSDlog(Color_StrongGreen, true, "Timeline recording started");
+			return;
+		}
+
+		const wxString filename(Path::Combine(g_Conf->Folders.Logs, L"timeline_" + wxDateTime::Now().Format(L"%Y-%m-%d-%H-%M-%S") + L".json"));
+		if (Timeline::Stop(filename))
+			OSDlog(Color_StrongGreen, true, "Timeline written to %s", filename.ToUTF8().data());
+		else
+			OSDlog(Color_StrongRed, true, "Failed to write the timeline to %s", filename.ToUTF8().data());
+	}
+
 	void Sys_FreezeGS()
 	{
 		// fixme : fix up gsstate mess and make it mtgs compatible -- air
@@ -696,6 +736,14 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 			false,
 		},
 
+		{
+			"States_Rewind",
+			Rewind_Step,
+			pxL("Rewind"),
+			pxL("Steps the virtual machine back to its previous rewind snapshot."),
+			false,
+		},
+
 		{
 			"States_CycleSlotForward",
 			States_CycleSlotForward,
@@ -744,6 +792,14 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 			false,
 		},
 
+		{
+			"Framelimiter_ThroughputToggle",
+			Implementations::Framelimiter_ThroughputToggle,
+			NULL,
+			NULL,
+			false,
+		},
+
 		{
 			"GSwindow_CycleAspectRatio",
 			Implementations::GSwindow_CycleAspectRatio,
@@ -818,6 +874,14 @@ static const GlobalCommandDescriptor CommandDeclarations[] =
 			false,
 		},
 
+		{
+			"Sys_TimelineToggle",
+			Implementations::Sys_TimelineToggle,
+			NULL,
+			NULL,
+			false,
+		},
+
 		{
 			"Sys_FreezeGS",
 			Implementations::Sys_FreezeGS,
@@ -1022,6 +1086,7 @@ void Pcsx2App::InitDefaultGlobalAccelerators()
 	GlobalAccels->Map(AAC(WXK_F3), "States_DefrostCurrentSlot");
 	GlobalAccels->Map(AAC(WXK_F2), "States_CycleSlotForward");
 	GlobalAccels->Map(AAC(WXK_F2).Shift(), "States_CycleSlotBackward");
+	GlobalAccels->Map(AAC(WXK_BACK), "States_Rewind");
 
 	GlobalAccels->Map(AAC(WXK_F4), "Framelimiter_MasterToggle");
 	GlobalAccels->Map(AAC(WXK_F4).Shift(), "Frameskip_Toggle");
@@ -21,6 +21,7 @@
 
 #include "Dialogs/ModalPopups.h"
 #include "IsoDropTarget.h"
+#include "AsyncFileReader.h"
 
 #include "fmt/core.h"
 #include <wx/iconbndl.h>
@@ -84,6 +85,10 @@ void MainEmuFrame::UpdateStatusBar()
 
 		if (g_Conf->CdvdSource == CDVD_SourceType::Iso)
 			temp += "Load: '" + wxFileName(g_Conf->CurrentIso).GetFullName() + "' ";
+
+		const int preload = PreloadingFileReader::GetProgress();
+		if (preload >= 0)
+			temp += wxString::Format("(Preloading %d%%) ", preload);
 	}
 
 	m_statusbar.SetStatusText(temp, 0);
@@ -253,6 +258,10 @@ void MainEmuFrame::ConnectMenus()
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_SaveStates_Click, this, MenuId_State_Save01 + 1, MenuId_State_Save01 + 10);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_SaveStateToFile_Click, this, MenuId_State_SaveToFile);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableBackupStates_Click, this, MenuId_EnableBackupStates);
+	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableIncrementalStates_Click, this, MenuId_EnableIncrementalStates);
+	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableCopyOnWriteStates_Click, this, MenuId_EnableCopyOnWriteStates);
+	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableRewind_Click, this, MenuId_EnableRewind);
+	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableRunAhead_Click, this, MenuId_EnableRunAhead);
 
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnablePatches_Click, this, MenuId_EnablePatches);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_EnableCheats_Click, this, MenuId_EnableCheats);
@@ -326,6 +335,7 @@ void MainEmuFrame::ConnectMenus()
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_Config_FrameAdvance, this, MenuId_Recording_Config_FrameAdvance);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_TogglePause_Click, this, MenuId_Recording_TogglePause);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_FrameAdvance_Click, this, MenuId_Recording_FrameAdvance);
+	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_GoToFrame_Click, this, MenuId_Recording_GoToFrame);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_ToggleRecordingMode_Click, this, MenuId_Recording_ToggleRecordingMode);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_VirtualPad_Open_Click, this, MenuId_Recording_VirtualPad_Port0);
 	Bind(wxEVT_MENU, &MainEmuFrame::Menu_Recording_VirtualPad_Open_Click, this, MenuId_Recording_VirtualPad_Port1);
@@ -417,6 +427,15 @@ void MainEmuFrame::CreatePcsx2Menu()
 	AppendShortcutToMenuOption(*sysSaveStateItem, wxGetApp().GlobalAccels->findKeycodeWithCommandId("States_FreezeCurrentSlot").toTitleizedString());
 
 	m_menuSys.Append(MenuId_EnableBackupStates, _("&Backup before save"), wxEmptyString, wxITEM_CHECK);
+	m_menuSys.Append(MenuId_EnableIncrementalStates, _("&Incremental saves"),
+		_("Saves only store the memory changed since a base state, which is kept in a separate file."), wxITEM_CHECK);
+	m_menuSys.Append(MenuId_EnableCopyOnWriteStates, _("Save in the bac&kground"),
+		_("Copies the EE memory as the game writes it while the emulation keeps running, instead of pausing it for the whole save."), wxITEM_CHECK);
+	wxMenuItem* rewindItem = m_menuSys.Append(MenuId_EnableRewind, _("&Rewind"),
+		_("Keeps snapshots of the last seconds of play in memory, to step back through with the rewind key."), wxITEM_CHECK);
+	AppendShortcutToMenuOption(*rewindItem, wxGetApp().GlobalAccels->findKeycodeWithCommandId("States_Rewind").toTitleizedString());
+	m_menuSys.Append(MenuId_EnableRunAhead, _("Run &ahead"),
+		_("Emulates frames ahead of the shown one and rolls them back, to cut the input lag of the game. Needs a fast CPU."), wxITEM_CHECK);
 
 	m_menuSys.AppendSeparator();
 
@@ -527,6 +546,7 @@ void MainEmuFrame::CreateInputRecordingMenu()
 	m_menuRecording.Append(MenuId_Recording_TogglePause, _("Toggle Pause"), _("Pause or resume emulation on the fly."))->Enable(false);
 	m_menuRecording.Append(MenuId_Recording_FrameAdvance, _("Frame Advance"), _("Advance emulation forward by a single frame at a time."))->Enable(false);
 	m_menuRecording.Append(MenuId_Recording_ToggleRecordingMode, _("Toggle Recording Mode"), _("Save/playback inputs to/from the recording file."))->Enable(false);
+	m_menuRecording.Append(MenuId_Recording_GoToFrame, _("Go to Frame..."), _("Replay the recording up to a frame, from the last keyframe before it."))->Enable(false);
 	m_menuRecording.AppendSeparator();
 
 	m_menuRecording.Append(MenuId_Recording_VirtualPad_Port0, _("Virtual Pad (Port 1)"));
@@ -819,6 +839,10 @@ void MainEmuFrame::ApplyConfigToGui(AppConfig& configToApply, int flags)
 	if (!(flags & AppConfig::APPLY_FLAG_FROM_PRESET))
 	{ //these should not be affected by presets
 		menubar.Check(MenuId_EnableBackupStates, configToApply.EmuOptions.BackupSavestate);
+		menubar.Check(MenuId_EnableIncrementalStates, configToApply.EmuOptions.IncrementalSavestates);
+		menubar.Check(MenuId_EnableCopyOnWriteStates, configToApply.EmuOptions.CopyOnWriteSavestates);
+		menubar.Check(MenuId_EnableRewind, configToApply.EmuOptions.EnableRewind);
+		menubar.Check(MenuId_EnableRunAhead, configToApply.EmuOptions.EnableRunAhead);
 		menubar.Check(MenuId_EnableCheats, configToApply.EmuOptions.EnableCheats);
 		menubar.Check(MenuId_IPC_Enable, configToApply.EmuOptions.EnableIPC);
 		menubar.Check(MenuId_EnableWideScreenPatches, configToApply.EmuOptions.EnableWideScreenPatches);
@@ -163,6 +163,10 @@ protected:
 	void Menu_IsoBrowse_Click(wxCommandEvent& event);
 	void Menu_IsoClear_Click(wxCommandEvent& event);
 	void Menu_EnableBackupStates_Click(wxCommandEvent& event);
+	void Menu_EnableIncrementalStates_Click(wxCommandEvent& event);
+	void Menu_EnableCopyOnWriteStates_Click(wxCommandEvent& event);
+	void Menu_EnableRewind_Click(wxCommandEvent& event);
+	void Menu_EnableRunAhead_Click(wxCommandEvent& event);
 	void Menu_EnablePatches_Click(wxCommandEvent& event);
 	void Menu_EnableCheats_Click(wxCommandEvent& event);
 	void Menu_IPC_Enable_Click(wxCommandEvent& event);
@@ -220,6 +224,7 @@ protected:
 	void ApplyFirstFrameStatus();
 	void Menu_Recording_TogglePause_Click(wxCommandEvent& event);
 	void Menu_Recording_FrameAdvance_Click(wxCommandEvent& event);
+	void Menu_Recording_GoToFrame_Click(wxCommandEvent& event);
 	void Menu_Recording_ToggleRecordingMode_Click(wxCommandEvent& event);
 	void Menu_Recording_VirtualPad_Open_Click(wxCommandEvent& event);
 #endif
@@ -396,10 +396,18 @@ bool MainEmuFrame::_DoSelectIsoBrowser(wxString& result)
 	const wxString isoSupportedLabel(JoinString(isoSupportedTypes, L" "));
 	const wxString isoSupportedList(JoinFiletypes(isoSupportedTypes));
 
+#ifdef PCSX2_ZSTD
+	const wxString compressedLabel(L".gz .cso .zso .chd .zst");
+	const wxString compressedList(L"*.gz;*.cso;*.zso;*.chd;*.zst");
+#else
+	const wxString compressedLabel(L".gz .cso .zso .chd");
+	const wxString compressedList(L"*.gz;*.cso;*.zso;*.chd");
+#endif
+
 	wxArrayString isoFilterTypes;
 
-	isoFilterTypes.Add(pxsFmt(_("All Supported (%s)"), WX_STR((isoSupportedLabel + L" .dump" + L" .gz" + L" .cso" + L" .chd"))));
-	isoFilterTypes.Add(isoSupportedList + L";*.dump" + L";*.gz" + L";*.cso" + L";*.chd");
+	isoFilterTypes.Add(pxsFmt(_("All Supported (%s)"), WX_STR((isoSupportedLabel + L" .dump " + compressedLabel))));
+	isoFilterTypes.Add(isoSupportedList + L";*.dump;" + compressedList);
 
 	isoFilterTypes.Add(pxsFmt(_("Disc Images (%s)"), WX_STR(isoSupportedLabel)));
 	isoFilterTypes.Add(isoSupportedList);
@@ -407,8 +415,8 @@ bool MainEmuFrame::_DoSelectIsoBrowser(wxString& result)
 	isoFilterTypes.Add(pxsFmt(_("Blockdumps (%s)"), L".dump"));
 	isoFilterTypes.Add(L"*.dump");
 
-	isoFilterTypes.Add(pxsFmt(_("Compressed (%s)"), L".gz .cso .chd"));
-	isoFilterTypes.Add(L"*.gz;*.cso;*.chd");
+	isoFilterTypes.Add(pxsFmt(_("Compressed (%s)"), WX_STR(compressedLabel)));
+	isoFilterTypes.Add(compressedList);
 
 	isoFilterTypes.Add(_("All Files (*.*)"));
 	isoFilterTypes.Add(L"*.*");
@@ -624,6 +632,34 @@ void MainEmuFrame::Menu_EnableBackupStates_Click(wxCommandEvent&)
 	AppSaveSettings();
 }
 
+void MainEmuFrame::Menu_EnableIncrementalStates_Click(wxCommandEvent&)
+{
+	g_Conf->EmuOptions.IncrementalSavestates = GetMenuBar()->IsChecked(MenuId_EnableIncrementalStates);
+	AppApplySettings();
+	AppSaveSettings();
+}
+
+void MainEmuFrame::Menu_EnableCopyOnWriteStates_Click(wxCommandEvent&)
+{
+	g_Conf->EmuOptions.CopyOnWriteSavestates = GetMenuBar()->IsChecked(MenuId_EnableCopyOnWriteStates);
+	AppApplySettings();
+	AppSaveSettings();
+}
+
+void MainEmuFrame::Menu_EnableRewind_Click(wxCommandEvent&)
+{
+	g_Conf->EmuOptions.EnableRewind = GetMenuBar()->IsChecked(MenuId_EnableRewind);
+	AppApplySettings();
+	AppSaveSettings();
+}
+
+void MainEmuFrame::Menu_EnableRunAhead_Click(wxCommandEvent&)
+{
+	g_Conf->EmuOptions.EnableRunAhead = GetMenuBar()->IsChecked(MenuId_EnableRunAhead);
+	AppApplySettings();
+	AppSaveSettings();
+}
+
 void MainEmuFrame::Menu_EnablePatches_Click(wxCommandEvent&)
 {
 	g_Conf->EmuOptions.EnablePatches = GetMenuBar()->IsChecked(MenuId_EnablePatches);
@@ -1124,6 +1160,7 @@ void MainEmuFrame::StartInputRecording()
 	m_menuRecording.FindChildItem(MenuId_Recording_New)->Enable(false);
 	m_menuRecording.FindChildItem(MenuId_Recording_Stop)->Enable(true);
 	m_menuRecording.FindChildItem(MenuId_Recording_ToggleRecordingMode)->Enable(true);
+	m_menuRecording.FindChildItem(MenuId_Recording_GoToFrame)->Enable(true);
 	ApplyFirstFrameStatus();
 }
 
@@ -1135,6 +1172,7 @@ void MainEmuFrame::StopInputRecording()
 		m_menuRecording.FindChildItem(MenuId_Recording_New)->Enable(true);
 		m_menuRecording.FindChildItem(MenuId_Recording_Stop)->Enable(false);
 		m_menuRecording.FindChildItem(MenuId_Recording_ToggleRecordingMode)->Enable(false);
+		m_menuRecording.FindChildItem(MenuId_Recording_GoToFrame)->Enable(false);
 		ApplyCDVDStatus();
 	}
 }
@@ -1151,6 +1189,12 @@ void MainEmuFrame::Menu_Recording_FrameAdvance_Click(wxCommandEvent& event)
 		g_InputRecordingControls.FrameAdvance();
 }
 
+void MainEmuFrame::Menu_Recording_GoToFrame_Click(wxCommandEvent& event)
+{
+	if (g_Conf->EmuOptions.EnableRecordingTools && g_InputRecording.IsActive())
+		g_InputRecording.GoToFrame(this);
+}
+
 void MainEmuFrame::Menu_Recording_ToggleRecordingMode_Click(wxCommandEvent& event)
 {
 	if (g_Conf->EmuOptions.EnableRecordingTools)
@@ -20,6 +20,11 @@
 #include <wx/stopwatch.h>
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 struct Component_FileMcd;
 
@@ -153,18 +158,41 @@ static bool ConvertRAWtoNoECC(wxString file_in, wxString file_out)
 // --------------------------------------------------------------------------------------
 //  FileMemoryCard
 // --------------------------------------------------------------------------------------
-// Provides thread-safe direct file IO mapping.
+// Keeps the complete contents of each card file in memory and serves all accesses from
+// there. Modified erase blocks are written back to the file on a background thread.
 //
 class FileMemoryCard
 {
 protected:
+	static const int BlockSizeRaw = 528 * 16;
+
+	struct PendingWrite
+	{
+		uint slot;
+		u32 offset; // in the file, including any header
+		std::vector<u8> data;
+	};
+
 	wxFFile m_file[8];
-	u8 m_effeffs[528 * 16];
+	std::vector<u8> m_image[8];
+	// offset of the card data in the file, non-zero for PSX cards with an emulator-specific header
+	u32 m_dataOffset[8];
+	// erase blocks of the image modified since the last write-back
+	std::vector<bool> m_dirtyBlocks[8];
+	bool m_isDirty[8];
+	u8 m_effeffs[BlockSizeRaw];
 	SafeArray<u8> m_currentdata;
 	u64 m_chksum[8];
 	bool m_ispsx[8];
 	u32 m_chkaddr;
 
+	// the write-back thread is the only one touching m_file while it runs
+	std::thread m_writeThread;
+	std::mutex m_writeMutex;
+	std::condition_variable m_writeCondition;
+	std::deque<PendingWrite> m_pendingWrites;
+	bool m_writeThreadExit;
+
 public:
 	FileMemoryCard();
 	virtual ~FileMemoryCard() = default;
@@ -183,10 +211,20 @@ public:
 	s32 EraseBlock(uint slot, u32 adr);
 	u64 GetCRC(uint slot);
 
+	// hands the blocks modified since the last call over to the write-back thread
+	void NextFrame(uint slot);
+
 protected:
 	bool Seek(wxFFile& f, u32 adr);
 	bool Create(const wxString& mcdFile, uint sizeInMB);
 
+	// returns the in-memory location of adr and clamps size to the end of the image, or nullptr if adr is out of bounds
+	u8* GetImagePointer(uint slot, u32 adr, int& size);
+	void MarkDirty(uint slot, u32 adr, int size);
+
+	void StopWriteThread();
+	void WriteThreadProc();
+
 	wxString GetDisabledMessage(uint slot) const
 	{
 		return wxsFormat(pxE(L"The PS2-slot %d has been automatically disabled.  You can correct the problem\nand re-enable it at any time using Config:Memory cards from the main menu."), slot //TODO: translate internal slot index to human-readable slot description
@@ -266,6 +304,13 @@ FileMemoryCard::FileMemoryCard()
 {
 	memset8<0xff>(m_effeffs);
 	m_chkaddr = 0;
+	m_writeThreadExit = false;
+
+	for (int slot = 0; slot < 8; ++slot)
+	{
+		m_dataOffset[slot] = 0;
+		m_isDirty[slot] = false;
+	}
 }
 
 void FileMemoryCard::Open()
@@ -348,13 +393,38 @@ void FileMemoryCard::Open()
 				wxsFormat(_("Access denied to memory card: \n\n%s\n\n"), str.c_str()) +
 				GetDisabledMessage(slot));
 		}
-		else // Load checksum
+		else // Load contents and checksum
 		{
-			m_ispsx[slot] = m_file[slot].Length() == 0x20000;
+			const wxFileOffset length = m_file[slot].Length();
+			m_image[slot].resize(length);
+			if (m_file[slot].Read(m_image[slot].data(), length) != static_cast<size_t>(length))
+			{
+				Msgbox::Alert(
+					wxsFormat(_("Could not read memory card: \n\n%s\n\n"), str.c_str()) +
+					GetDisabledMessage(slot));
+				m_file[slot].Close();
+				m_image[slot].clear();
+				continue;
+			}
+
+			// see Seek() for these
+			if (length == MCD_SIZE + 64)
+				m_dataOffset[slot] = 64;
+			else if (length == MCD_SIZE + 3904)
+				m_dataOffset[slot] = 3904;
+			else
+				m_dataOffset[slot] = 0;
+
+			m_dirtyBlocks[slot].assign((length + BlockSizeRaw - 1) / BlockSizeRaw, false);
+			m_isDirty[slot] = false;
+
+			m_ispsx[slot] = length == 0x20000;
 			m_chkaddr = 0x210;
 
-			if (!m_ispsx[slot] && !!m_file[slot].Seek(m_chkaddr))
-				m_file[slot].Read(&m_chksum[slot], 8);
+			int chksumSize = 8;
+			const u8* chksum = GetImagePointer(slot, m_chkaddr, chksumSize);
+			if (!m_ispsx[slot] && chksum && chksumSize == 8)
+				memcpy(&m_chksum[slot], chksum, 8);
 		}
 	}
 }
@@ -363,6 +433,17 @@ void FileMemoryCard::Close()
 {
 	for (int slot = 0; slot < 8; ++slot)
 	{
+		if (m_file[slot].IsOpened())
+			NextFrame(slot);
+	}
+	StopWriteThread();
+
+	for (int slot = 0; slot < 8; ++slot)
+	{
+		m_image[slot].clear();
+		m_dirtyBlocks[slot].clear();
+		m_isDirty[slot] = false;
+
 		if (m_file[slot].IsOpened())
 		{
 			// Store checksum
@@ -405,6 +486,122 @@ bool FileMemoryCard::Seek(wxFFile& f, u32 adr)
 	return f.Seek(adr + offset);
 }
 
+u8* FileMemoryCard::GetImagePointer(uint slot, u32 adr, int& size)
+{
+	const u64 pos = static_cast<u64>(adr) + m_dataOffset[slot];
+	if (pos >= m_image[slot].size() || size < 0)
+		return nullptr;
+
+	size = static_cast<int>(std::min<u64>(size, m_image[slot].size() - pos));
+	return &m_image[slot][pos];
+}
+
+void FileMemoryCard::MarkDirty(uint slot, u32 adr, int size)
+{
+	if (size <= 0)
+		return;
+
+	const u32 pos = adr + m_dataOffset[slot];
+	for (u32 block = pos / BlockSizeRaw; block <= (pos + size - 1) / BlockSizeRaw; ++block)
+		m_dirtyBlocks[slot][block] = true;
+	m_isDirty[slot] = true;
+}
+
+void FileMemoryCard::NextFrame(uint slot)
+{
+	if (!m_isDirty[slot])
+		return;
+
+	std::vector<bool>& dirty = m_dirtyBlocks[slot];
+	const u32 blockCount = dirty.size();
+
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+
+		// merge neighbouring blocks into a single write, they usually come in runs when a game saves
+		for (u32 block = 0; block < blockCount;)
+		{
+			if (!dirty[block])
+			{
+				++block;
+				continue;
+			}
+
+			u32 end = block;
+			while (end < blockCount && dirty[end])
+				dirty[end++] = false;
+
+			const u32 start = block * BlockSizeRaw;
+			const u32 length = std::min<u32>(end * BlockSizeRaw, m_image[slot].size()) - start;
+			PendingWrite write;
+			write.slot = slot;
+			write.offset = start;
+			write.data.assign(m_image[slot].begin() + start, m_image[slot].begin() + start + length);
+			m_pendingWrites.push_back(std::move(write));
+
+			block = end;
+		}
+
+		if (!m_writeThread.joinable())
+		{
+			m_writeThreadExit = false;
+			m_writeThread = std::thread(&FileMemoryCard::WriteThreadProc, this);
+		}
+	}
+
+	m_isDirty[slot] = false;
+	m_writeCondition.notify_one();
+}
+
+void FileMemoryCard::StopWriteThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_writeMutex);
+		if (!m_writeThread.joinable())
+			return;
+		m_writeThreadExit = true;
+	}
+
+	// the queue is drained before the thread exits
+	m_writeCondition.notify_one();
+	m_writeThread.join();
+	m_writeThread = std::thread();
+}
+
+void FileMemoryCard::WriteThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_writeMutex);
+
+	for (;;)
+	{
+		m_writeCondition.wait(lock, [this] { return !m_pendingWrites.empty() || m_writeThreadExit; });
+		if (m_pendingWrites.empty())
+			break;
+
+		std::deque<PendingWrite> writes;
+		writes.swap(m_pendingWrites);
+		lock.unlock();
+
+		// writes are applied in the order they were made, and each batch is flushed
+		// before the next one so the file never holds newer data without the older
+		bool written[8] = {};
+		for (const PendingWrite& write : writes)
+		{
+			wxFFile& mcfp(m_file[write.slot]);
+			if (!mcfp.Seek(write.offset) || mcfp.Write(write.data.data(), write.data.size()) != write.data.size())
+				Console.Error("(FileMcd) Failed to write memory card data. (%d) [%08X]", write.slot, write.offset);
+			written[write.slot] = true;
+		}
+		for (int slot = 0; slot < 8; ++slot)
+		{
+			if (written[slot])
+				m_file[slot].Flush();
+		}
+
+		lock.lock();
+	}
+}
+
 // returns FALSE if an error occurred (either permission denied or disk full)
 bool FileMemoryCard::Create(const wxString& mcdFile, uint sizeInMB)
 {
@@ -436,7 +633,7 @@ void FileMemoryCard::GetSizeInfo(uint slot, McdSizeInfo& outways)
 	outways.Xor = 18;                     // 0x12, XOR 02 00 00 10
 
 	if (pxAssert(m_file[slot].IsOpened()))
-		outways.McdSizeInSectors = m_file[slot].Length() / (outways.SectorSize + outways.EraseBlockSizeInSectors);
+		outways.McdSizeInSectors = m_image[slot].size() / (outways.SectorSize + outways.EraseBlockSizeInSectors);
 	else
 		outways.McdSizeInSectors = 0x4000;
 
@@ -458,9 +655,11 @@ s32 FileMemoryCard::Read(uint slot, u8* dest, u32 adr, int size)
 		memset(dest, 0, size);
 		return 1;
 	}
-	if (!Seek(mcfp, adr))
+	const u8* src = GetImagePointer(slot, adr, size);
+	if (!src)
 		return 0;
-	return mcfp.Read(dest, size) != 0;
+	memcpy(dest, src, size);
+	return size != 0;
 }
 
 s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
@@ -473,6 +672,11 @@ s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 		return 1;
 	}
 
+	int available = size;
+	u8* dest = GetImagePointer(slot, adr, available);
+	if (!dest || available != size)
+		return 0;
+
 	if (m_ispsx[slot])
 	{
 		m_currentdata.MakeRoomFor(size);
@@ -481,10 +685,8 @@ s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 	}
 	else
 	{
-		if (!Seek(mcfp, adr))
-			return 0;
 		m_currentdata.MakeRoomFor(size);
-		mcfp.Read(m_currentdata.GetPtr(), size);
+		memcpy(m_currentdata.GetPtr(), dest, size);
 
 
 		for (int i = 0; i < size; i++)
@@ -507,27 +709,20 @@ s32 FileMemoryCard::Save(uint slot, const u8* src, u32 adr, int size)
 		}
 	}
 
-	if (!Seek(mcfp, adr))
-		return 0;
+	memcpy(dest, m_currentdata.GetPtr(), size);
+	MarkDirty(slot, adr, size);
 
-	int status = mcfp.Write(m_currentdata.GetPtr(), size);
+	static auto last = std::chrono::time_point<std::chrono::system_clock>();
 
-	if (status)
+	std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - last;
+	if (elapsed > std::chrono::seconds(5))
 	{
-		static auto last = std::chrono::time_point<std::chrono::system_clock>();
-
-		std::chrono::duration<float> elapsed = std::chrono::system_clock::now() - last;
-		if (elapsed > std::chrono::seconds(5))
-		{
-			wxString name, ext;
-			wxFileName::SplitPath(m_file[slot].GetName(), NULL, NULL, &name, &ext);
-			OSDlog(Color_StrongYellow, true, "Memory Card %s written.", (const char*)(name + "." + ext).c_str());
-			last = std::chrono::system_clock::now();
-		}
-		return 1;
+		wxString name, ext;
+		wxFileName::SplitPath(m_file[slot].GetName(), NULL, NULL, &name, &ext);
+		OSDlog(Color_StrongYellow, true, "Memory Card %s written.", (const char*)(name + "." + ext).c_str());
+		last = std::chrono::system_clock::now();
 	}
-
-	return 0;
+	return 1;
 }
 
 s32 FileMemoryCard::EraseBlock(uint slot, u32 adr)
@@ -540,9 +735,13 @@ s32 FileMemoryCard::EraseBlock(uint slot, u32 adr)
 		return 1;
 	}
 
-	if (!Seek(mcfp, adr))
+	int size = sizeof(m_effeffs);
+	u8* dest = GetImagePointer(slot, adr, size);
+	if (!dest)
 		return 0;
-	return mcfp.Write(m_effeffs, sizeof(m_effeffs)) != 0;
+	memcpy(dest, m_effeffs, size);
+	MarkDirty(slot, adr, size);
+	return 1;
 }
 
 u64 FileMemoryCard::GetCRC(uint slot)
@@ -555,17 +754,15 @@ u64 FileMemoryCard::GetCRC(uint slot)
 
 	if (m_ispsx[slot])
 	{
-		if (!Seek(mcfp, 0))
-			return 0;
-
-		// Process the file in 4k chunks.  Speeds things up significantly.
+		// Process the file in 4k chunks, like this used to be read from the file.
 
 		u64 buffer[528 * 8]; // use 528 (sector size), ensures even divisibility
 
-		const uint filesize = mcfp.Length() / sizeof(buffer);
-		for (uint i = filesize; i; --i)
+		const uint filesize = m_image[slot].size() / sizeof(buffer);
+		const u8* src = m_image[slot].data() + m_dataOffset[slot];
+		for (uint i = filesize; i; --i, src += sizeof(buffer))
 		{
-			mcfp.Read(&buffer, sizeof(buffer));
+			memcpy(buffer, src, std::min<size_t>(sizeof(buffer), m_image[slot].data() + m_image[slot].size() - src));
 			for (uint t = 0; t < ArraySize(buffer); ++t)
 				retval ^= buffer[t];
 		}
@@ -741,9 +938,9 @@ void FileMcd_NextFrame(uint port, uint slot)
 	const uint combinedSlot = FileMcd_ConvertToSlot(port, slot);
 	switch (g_Conf->Mcd[combinedSlot].Type)
 	{
-		//case MemoryCardType::MemoryCard_File:
-		//	Mcd::impl.NextFrame( combinedSlot );
-		//	break;
+		case MemoryCardType::MemoryCard_File:
+			Mcd::impl.NextFrame(combinedSlot);
+			break;
 		case MemoryCardType::MemoryCard_Folder:
 			Mcd::implFolder.NextFrame(combinedSlot);
 			break;
@@ -62,6 +62,14 @@ FolderMemoryCard::FolderMemoryCard()
 	m_timeLastWritten = 0;
 	m_filteringEnabled = false;
 	m_filteringString = L"";
+	m_flushRequested = false;
+	m_flushThreadExit = false;
+	m_fileEntryClusterIndexValid = false;
+}
+
+FolderMemoryCard::~FolderMemoryCard()
+{
+	StopFlushThread();
 }
 
 void FolderMemoryCard::InitializeInternalData()
@@ -75,6 +83,9 @@ void FolderMemoryCard::InitializeInternalData()
 	m_oldDataCache.clear();
 	m_lastAccessedFile.CloseAll();
 	m_fileMetadataQuickAccess.clear();
+	m_fileDataClusterIndex.clear();
+	m_fileEntryClusterIndex.clear();
+	m_fileEntryClusterIndexValid = false;
 	m_timeLastWritten = 0;
 	m_isEnabled = false;
 	m_framesUntilFlush = 0;
@@ -96,6 +107,9 @@ void FolderMemoryCard::Open(const bool enableFiltering, const wxString& filter)
 
 void FolderMemoryCard::Open(const wxString& fullPath, const AppConfig::McdOptions& mcdOptions, const u32 sizeInClusters, const bool enableFiltering, const wxString& filter, bool simulateFileWrites)
 {
+	StopFlushThread();
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	InitializeInternalData();
 	m_performFileWrites = !simulateFileWrites;
 
@@ -148,6 +162,9 @@ void FolderMemoryCard::Open(const wxString& fullPath, const AppConfig::McdOption
 
 void FolderMemoryCard::Close(bool flush)
 {
+	StopFlushThread();
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	if (!m_isEnabled)
 	{
 		return;
@@ -162,6 +179,9 @@ void FolderMemoryCard::Close(bool flush)
 	m_oldDataCache.clear();
 	m_lastAccessedFile.CloseAll();
 	m_fileMetadataQuickAccess.clear();
+	m_fileDataClusterIndex.clear();
+	m_fileEntryClusterIndex.clear();
+	m_fileEntryClusterIndexValid = false;
 }
 
 bool FolderMemoryCard::ReIndex(bool enableFiltering, const wxString& filter)
@@ -218,6 +238,7 @@ void FolderMemoryCard::LoadMemoryCardData(const u32 sizeInClusters, const bool e
 		CreateRootDir();
 		MemoryCardFileEntry* const rootDirEntry = &m_fileEntryDict[m_superBlock.data.rootdir_cluster].entries[0];
 		AddFolder(rootDirEntry, m_folderName.GetPath(), nullptr, enableFiltering, filter);
+		RebuildFileEntryClusterIndex();
 
 #ifdef DEBUG_WRITE_FOLDER_CARD_IN_MEMORY_TO_FILE_ON_CHANGE
 		WriteToFile(m_folderName.GetFullPath().RemoveLast() + L"-debug_" + wxDateTime::Now().Format(L"%Y-%m-%d-%H-%M-%S") + L"_load.ps2");
@@ -518,13 +539,14 @@ bool FolderMemoryCard::AddFile(MemoryCardFileEntry* const dirEntry, const wxStri
 	wxFileName relativeFilePath(dirPath, fileEntry.m_fileName);
 	relativeFilePath.MakeRelativeTo(m_folderName.GetPath());
 
+	// only the size is needed here, the contents are read on first access of their clusters
 	wxFileName fileInfo(dirPath, fileEntry.m_fileName);
-	wxFFile file(fileInfo.GetFullPath(), L"rb");
-	if (file.IsOpened())
+	const wxULongLong fileInfoSize = fileInfo.GetSize();
+	if (fileInfoSize != wxInvalidSize)
 	{
 		// make sure we have enough space on the memcard to hold the data
 		const u32 clusterSize = m_superBlock.data.pages_per_cluster * m_superBlock.data.page_len;
-		const u32 filesize = file.Length();
+		const u32 filesize = fileInfoSize.GetLo();
 		const u32 countClusters = (filesize % clusterSize) != 0 ? (filesize / clusterSize + 1) : (filesize / clusterSize);
 		const u32 newNeededClusters = (dirEntry->entry.data.length % 2) == 0 ? countClusters + 1 : countClusters;
 		if (newNeededClusters > GetAmountFreeDataClusters())
@@ -580,14 +602,8 @@ bool FolderMemoryCard::AddFile(MemoryCardFileEntry* const dirEntry, const wxStri
 			newFileEntry->entry.data.cluster = MemoryCardFileEntry::EmptyFileCluster;
 		}
 
-		file.Close();
-
-		MemoryCardFileMetadataReference* fileRef = AddFileEntryToMetadataQuickAccess(newFileEntry, parent);
-		if (fileRef != nullptr)
-		{
-			// acquire a handle on the file so nothing else can change the file contents while the memory card is open
-			m_lastAccessedFile.ReOpen(m_folderName, fileRef);
-		}
+		// the file handle is acquired by FileAccessHelper once the game actually accesses the file
+		AddFileEntryToMetadataQuickAccess(newFileEntry, parent);
 
 		// and finally, increase file count in the directory entry
 		dirEntry->entry.data.length++;
@@ -643,7 +659,7 @@ u32 FolderMemoryCard::CalculateRequiredClustersOfDirectory(const wxString& dirPa
 
 MemoryCardFileMetadataReference* FolderMemoryCard::AddDirEntryToMetadataQuickAccess(MemoryCardFileEntry* const entry, MemoryCardFileMetadataReference* const parent)
 {
-	MemoryCardFileMetadataReference* ref = &m_fileMetadataQuickAccess[entry->entry.data.cluster];
+	MemoryCardFileMetadataReference* ref = GetMetadataQuickAccessRef(entry->entry.data.cluster);
 	ref->parent = parent;
 	ref->entry = entry;
 	ref->consecutiveCluster = 0xFFFFFFFFu;
@@ -664,7 +680,7 @@ MemoryCardFileMetadataReference* FolderMemoryCard::AddFileEntryToMetadataQuickAc
 	u32 clusterNumber = 0;
 	do
 	{
-		MemoryCardFileMetadataReference* ref = &m_fileMetadataQuickAccess[fileCluster & NextDataClusterMask];
+		MemoryCardFileMetadataReference* ref = GetMetadataQuickAccessRef(fileCluster & NextDataClusterMask);
 		ref->parent = parent;
 		ref->entry = entry;
 		ref->consecutiveCluster = clusterNumber;
@@ -674,6 +690,20 @@ MemoryCardFileMetadataReference* FolderMemoryCard::AddFileEntryToMetadataQuickAc
 	return &m_fileMetadataQuickAccess[firstFileCluster & NextDataClusterMask];
 }
 
+MemoryCardFileMetadataReference* FolderMemoryCard::GetMetadataQuickAccessRef(const u32 cluster)
+{
+	MemoryCardFileMetadataReference* ref = &m_fileMetadataQuickAccess[cluster];
+	if (cluster < MaxFatClusters)
+	{
+		if (cluster >= m_fileDataClusterIndex.size())
+		{
+			m_fileDataClusterIndex.resize(cluster + 1, nullptr);
+		}
+		m_fileDataClusterIndex[cluster] = ref;
+	}
+	return ref;
+}
+
 s32 FolderMemoryCard::IsPresent() const
 {
 	return m_isEnabled;
@@ -757,6 +787,12 @@ u8* FolderMemoryCard::GetSystemBlockPointer(const u32 adr)
 
 u8* FolderMemoryCard::GetFileEntryPointer(const u32 searchCluster, const u32 entryNumber, const u32 offset)
 {
+	if (m_fileEntryClusterIndexValid)
+	{
+		MemoryCardFileEntryCluster* ptr = searchCluster < m_fileEntryClusterIndex.size() ? m_fileEntryClusterIndex[searchCluster] : nullptr;
+		return ptr != nullptr ? &ptr->entries[entryNumber].entry.raw[offset] : nullptr;
+	}
+
 	const u32 fileCount = m_fileEntryDict[m_superBlock.data.rootdir_cluster].entries[0].entry.data.length;
 	MemoryCardFileEntryCluster* ptr = GetFileEntryCluster(m_superBlock.data.rootdir_cluster, searchCluster, fileCount);
 	if (ptr != nullptr)
@@ -809,6 +845,45 @@ MemoryCardFileEntryCluster* FolderMemoryCard::GetFileEntryCluster(const u32 curr
 	return nullptr;
 }
 
+void FolderMemoryCard::RebuildFileEntryClusterIndex()
+{
+	m_fileEntryClusterIndex.assign(std::min<u32>(m_superBlock.data.alloc_end, MaxFatClusters), nullptr);
+	m_fileEntryClusterIndexValid = true;
+
+	const u32 rootDirCluster = m_superBlock.data.rootdir_cluster;
+	IndexFileEntryClusters(rootDirCluster, m_fileEntryDict[rootDirCluster].entries[0].entry.data.length);
+}
+
+void FolderMemoryCard::IndexFileEntryClusters(const u32 currentCluster, const u32 fileCount)
+{
+	// stop at clusters outside of the card and at ones we've already seen, in case the directory structure is corrupted
+	if (currentCluster >= m_fileEntryClusterIndex.size() || m_fileEntryClusterIndex[currentCluster] != nullptr)
+	{
+		return;
+	}
+
+	MemoryCardFileEntryCluster* const entries = &m_fileEntryDict[currentCluster];
+	m_fileEntryClusterIndex[currentCluster] = entries;
+
+	// index other clusters of this directory
+	const u32 nextCluster = m_fat.data[0][0][currentCluster] & NextDataClusterMask;
+	if (nextCluster != LastDataCluster)
+	{
+		IndexFileEntryClusters(nextCluster, fileCount - 2);
+	}
+
+	// and subdirectories
+	const u32 filesInThisCluster = std::min(fileCount, 2u);
+	for (unsigned int i = 0; i < filesInThisCluster; ++i)
+	{
+		const MemoryCardFileEntry* const entry = &entries->entries[i];
+		if (entry->IsValid() && entry->IsUsed() && entry->IsDir() && !entry->IsDotDir())
+		{
+			IndexFileEntryClusters(entry->entry.data.cluster, entry->entry.data.length);
+		}
+	}
+}
+
 // This method is actually unused since the introduction of m_fileMetadataQuickAccess.
 // I'll leave it here anyway though to show how you traverse the file system.
 MemoryCardFileEntry* FolderMemoryCard::GetFileEntryFromFileDataCluster(const u32 currentCluster, const u32 searchCluster, wxFileName* fileName, const size_t originalDirCount, u32* outClusterNumber)
@@ -878,11 +953,11 @@ bool FolderMemoryCard::ReadFromFile(u8* dest, u32 adr, u32 dataLength)
 	}
 
 	// figure out which file to read from
-	auto it = m_fileMetadataQuickAccess.find(fatCluster);
-	if (it != m_fileMetadataQuickAccess.end())
+	MemoryCardFileMetadataReference* const fileRef = FindMetadataQuickAccessRef(fatCluster);
+	if (fileRef != nullptr)
 	{
-		const u32 clusterNumber = it->second.consecutiveCluster;
-		wxFFile* file = m_lastAccessedFile.ReOpen(m_folderName, &it->second);
+		const u32 clusterNumber = fileRef->consecutiveCluster;
+		wxFFile* file = m_lastAccessedFile.ReOpen(m_folderName, fileRef);
 		if (file->IsOpened())
 		{
 			const u32 clusterOffset = (page % 2) * PageSize + offset;
@@ -909,6 +984,8 @@ bool FolderMemoryCard::ReadFromFile(u8* dest, u32 adr, u32 dataLength)
 
 s32 FolderMemoryCard::Read(u8* dest, u32 adr, int size)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	//const u32 block = adr / BlockSizeRaw;
 	const u32 page = adr / PageSizeRaw;
 	const u32 offset = adr % PageSizeRaw;
@@ -986,6 +1063,8 @@ void FolderMemoryCard::ReadDataWithoutCache(u8* const dest, const u32 adr, const
 
 s32 FolderMemoryCard::Save(const u8* src, u32 adr, int size)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	//const u32 block = adr / BlockSizeRaw;
 	//const u32 cluster = adr / ClusterSizeRaw;
 	const u32 page = adr / PageSizeRaw;
@@ -1032,9 +1111,65 @@ s32 FolderMemoryCard::Save(const u8* src, u32 adr, int size)
 
 void FolderMemoryCard::NextFrame()
 {
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	if (m_framesUntilFlush > 0 && --m_framesUntilFlush == 0)
 	{
-		Flush();
+		RequestFlush();
+	}
+}
+
+void FolderMemoryCard::RequestFlush()
+{
+	std::lock_guard<std::mutex> lock(m_flushMutex);
+
+	if (!m_flushThread.joinable())
+	{
+		m_flushThreadExit = false;
+		m_flushThread = std::thread(&FolderMemoryCard::FlushThreadProc, this);
+	}
+
+	m_flushRequested = true;
+	m_flushCondition.notify_one();
+}
+
+void FolderMemoryCard::StopFlushThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_flushMutex);
+		if (!m_flushThread.joinable())
+		{
+			return;
+		}
+		m_flushThreadExit = true;
+		m_flushCondition.notify_one();
+	}
+
+	// a pending request is still handled by the thread before it exits
+	m_flushThread.join();
+	m_flushThread = std::thread();
+}
+
+void FolderMemoryCard::FlushThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_flushMutex);
+
+	for (;;)
+	{
+		m_flushCondition.wait(lock, [this] { return m_flushRequested || m_flushThreadExit; });
+		if (!m_flushRequested)
+		{
+			break;
+		}
+		m_flushRequested = false;
+
+		// writes that arrive while the flush is running wait for it and get picked up by the next request
+		lock.unlock();
+		{
+			std::lock_guard<std::recursive_mutex> cardLock(m_cardMutex);
+			Flush();
+		}
+		lock.lock();
 	}
 }
 
@@ -1059,6 +1194,9 @@ void FolderMemoryCard::Flush()
 		CopyEntryDictIntoTree(&oldFileEntryTree, m_superBlock.data.rootdir_cluster, m_fileEntryDict[m_superBlock.data.rootdir_cluster].entries[0].entry.data.length);
 	}
 
+	// the flush rewrites the FAT and file entries, so fall back to searching the directory tree until it's done
+	m_fileEntryClusterIndexValid = false;
+
 	// first write the superblock if necessary
 	FlushSuperBlock();
 	if (!IsFormatted())
@@ -1072,6 +1210,7 @@ void FolderMemoryCard::Flush()
 	if (m_backupBlock2.programmedBlock != 0xFFFFFFFFu)
 	{
 		Console.Warning(L"(FolderMcd) Aborting flush of slot %u, emulation was interrupted during save process!", m_slot);
+		RebuildFileEntryClusterIndex();
 		return;
 	}
 
@@ -1103,6 +1242,7 @@ void FolderMemoryCard::Flush()
 
 	// then all directory and file entries
 	FlushFileEntries();
+	RebuildFileEntryClusterIndex();
 
 	// Now we have the new file system, compare it to the old one and "delete" any files that were in it before but aren't anymore.
 	FlushDeletedFilesAndRemoveUnchangedDataFromCache(oldFileEntryTree);
@@ -1455,15 +1595,15 @@ bool FolderMemoryCard::WriteToFile(const u8* src, u32 adr, u32 dataLength)
 	}
 
 	// figure out which file to write to
-	auto it = m_fileMetadataQuickAccess.find(fatCluster);
-	if (it != m_fileMetadataQuickAccess.end())
+	MemoryCardFileMetadataReference* const fileRef = FindMetadataQuickAccessRef(fatCluster);
+	if (fileRef != nullptr)
 	{
-		const MemoryCardFileEntry* const entry = it->second.entry;
-		const u32 clusterNumber = it->second.consecutiveCluster;
+		const MemoryCardFileEntry* const entry = fileRef->entry;
+		const u32 clusterNumber = fileRef->consecutiveCluster;
 
 		if (m_performFileWrites)
 		{
-			wxFFile* file = m_lastAccessedFile.ReOpen(m_folderName, &it->second, true);
+			wxFFile* file = m_lastAccessedFile.ReOpen(m_folderName, fileRef, true);
 			if (file->IsOpened())
 			{
 				const u32 clusterOffset = (page % 2) * PageSize + offset;
@@ -1571,6 +1711,8 @@ const MemoryCardFileEntry* FolderMemoryCard::FindEquivalent(const MemoryCardFile
 
 s32 FolderMemoryCard::EraseBlock(u32 adr)
 {
+	std::lock_guard<std::recursive_mutex> lock(m_cardMutex);
+
 	const u32 block = adr / BlockSizeRaw;
 
 	u8 eraseData[PageSize];
@@ -18,7 +18,10 @@
 #include <wx/file.h>
 #include <wx/dir.h>
 #include <wx/ffile.h>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "AppConfig.h"
@@ -311,6 +314,9 @@ public:
 
 	static const int FramesAfterWriteUntilFlush = 2;
 
+	// amount of clusters addressable by the FAT
+	static const u32 MaxFatClusters = IndirectFatClusterCount * (ClusterSize / 4) * (ClusterSize / 4);
+
 protected:
 	union superBlockUnion
 	{
@@ -338,6 +344,12 @@ protected:
 	std::map<u32, MemoryCardFileEntryCluster> m_fileEntryDict;
 	// quick-access map of related file entry metadata for each memory card FAT cluster that contains file data
 	std::map<u32, MemoryCardFileMetadataReference> m_fileMetadataQuickAccess;
+	// flat view of m_fileMetadataQuickAccess indexed by FAT cluster, so page accesses don't have to search the map
+	std::vector<MemoryCardFileMetadataReference*> m_fileDataClusterIndex;
+	// file entry cluster for each FAT cluster that holds directory entries, as found by GetFileEntryCluster()
+	// rebuilt after each change to m_fileEntryDict, the directory tree is searched instead while it's invalid
+	std::vector<MemoryCardFileEntryCluster*> m_fileEntryClusterIndex;
+	bool m_fileEntryClusterIndexValid;
 
 	// holds a copy of modified pages of the memory card before they're flushed to the file system
 	std::map<u32, MemoryCardPage> m_cache;
@@ -354,6 +366,18 @@ protected:
 	// remembers and keeps the last accessed file open for further access
 	FileAccessHelper m_lastAccessedFile;
 
+	// guards all card data against concurrent access from the flush thread
+	std::recursive_mutex m_cardMutex;
+
+	// writes changes to the file system in the background so the emulation doesn't stall on disk I/O,
+	// started on the first flush and stopped when the card is closed
+	std::thread m_flushThread;
+	std::mutex m_flushMutex;
+	std::condition_variable m_flushCondition;
+	// set by NextFrame(), any requests made while a flush is still pending are merged into that one
+	bool m_flushRequested;
+	bool m_flushThreadExit;
+
 	// path to the folder that contains the files of this memory card
 	wxFileName m_folderName;
 
@@ -371,7 +395,7 @@ protected:
 
 public:
 	FolderMemoryCard();
-	virtual ~FolderMemoryCard() = default;
+	virtual ~FolderMemoryCard();
 
 	void Lock();
 	void Unlock();
@@ -445,6 +469,11 @@ protected:
 	// - fileCount: the number of files left in the directory currently traversed
 	MemoryCardFileEntryCluster* GetFileEntryCluster(const u32 currentCluster, const u32 searchCluster, const u32 fileCount);
 
+	// fills m_fileEntryClusterIndex with every file entry cluster reachable from the root directory
+	void RebuildFileEntryClusterIndex();
+	// recursive worker method of the above, traverses the directory tree the same way GetFileEntryCluster does
+	void IndexFileEntryClusters(const u32 currentCluster, const u32 fileCount);
+
 	// returns file entry of the file at the given searchCluster
 	// the passed fileName will be filled with a path to the file being accessed
 	// returns nullptr if searchCluster contains no file
@@ -518,6 +547,15 @@ protected:
 	// creates a reference to a directory entry, so it can be passed as parent to other files/directories
 	MemoryCardFileMetadataReference* AddDirEntryToMetadataQuickAccess(MemoryCardFileEntry* const entry, MemoryCardFileMetadataReference* const parent);
 
+	// returns the quick-access reference of the given FAT cluster, creating it if it doesn't exist yet
+	MemoryCardFileMetadataReference* GetMetadataQuickAccessRef(const u32 cluster);
+
+	// returns the quick-access reference of the given FAT cluster, or nullptr if there is none
+	MemoryCardFileMetadataReference* FindMetadataQuickAccessRef(const u32 cluster) const
+	{
+		return cluster < m_fileDataClusterIndex.size() ? m_fileDataClusterIndex[cluster] : nullptr;
+	}
+
 
 	// read data from the memory card, ignoring the cache
 	// do NOT attempt to read ECC with this method, it will not work
@@ -531,6 +569,12 @@ protected:
 	// flush the whole cache to the internal data and/or host file system
 	void Flush();
 
+	// hand a flush over to the background thread, starting it if necessary
+	void RequestFlush();
+	// waits for a running flush to finish and stops the background thread
+	void StopFlushThread();
+	void FlushThreadProc();
+
 	// flush a single page of the cache to the internal data and/or host file system
 	bool FlushPage(const u32 page);
 
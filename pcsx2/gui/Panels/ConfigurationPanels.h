@@ -189,7 +189,6 @@ namespace Panels
 
 	protected:
 		void OnRestoreDefaults(wxCommandEvent& evt);
-		void EECache_Event(wxCommandEvent& evt);
 	};
 
 	class CpuPanelVU : public BaseApplicableConfigPanel_SpecificConfig
@@ -220,6 +219,7 @@ namespace Panels
 	protected:
 		wxSpinCtrl* m_spin_FramesToSkip;
 		wxSpinCtrl* m_spin_FramesToDraw;
+		pxCheckBox* m_check_Adaptive;
 
 		pxRadioPanel* m_radio_SkipMode;
 
@@ -340,9 +340,13 @@ namespace Panels
 		pxCheckBox* m_check_intc;
 		pxCheckBox* m_check_waitloop;
 		pxCheckBox* m_check_fastCDVD;
+		pxCheckBox* m_check_iopHLE;
+		pxCheckBox* m_check_ipuThread;
+		pxCheckBox* m_check_threadPinning;
 		pxCheckBox* m_check_vuFlagHack;
 		pxCheckBox* m_check_vuThread;
 		pxCheckBox* m_check_vu1Instant;
+		pxCheckBox* m_check_vu0Thread;
 
 	public:
 		virtual ~SpeedHacksPanel() = default;
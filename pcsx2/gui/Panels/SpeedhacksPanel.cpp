@@ -175,6 +175,9 @@ Panels::SpeedHacksPanel::SpeedHacksPanel( wxWindow* parent )
 	m_check_vu1Instant = new pxCheckBox(vuHacksPanel, _("Instant VU1 (without MTVU only)"),
 		_("Good Speedup and High Compatibility; may cause some graphical errors"));
 
+	m_check_vu0Thread = new pxCheckBox(vuHacksPanel, _("Threaded microVU0 (experimental)"),
+		_("Speedup for games with long VU0 programs; may cause hanging or bad physics... [Not Recommended]"));
+
 	m_check_vuFlagHack->SetToolTip( pxEt( L"Updates Status Flags only on blocks which will read them, instead of all the time. This is safe most of the time."
 	) );
 
@@ -184,6 +187,9 @@ Panels::SpeedHacksPanel::SpeedHacksPanel( wxWindow* parent )
 	m_check_vu1Instant->SetToolTip(pxEt(L"Runs VU1 instantly (when MTVU is disabled). Provides a modest speed improvement. This is safe for most games, but a few games may exhibit graphical errors."
 	));
 
+	m_check_vu0Thread->SetToolTip(pxEt(L"Runs the VU0 micro programs on their own thread (microVU0-only). The EE only waits for them at the COP2 instructions that interlock with VU0, so games that read VU0 data memory or registers without an interlock may see partial results."
+	));
+
 	// ------------------------------------------------------------------------
 	// All other hacks Section:
 
@@ -198,6 +204,15 @@ Panels::SpeedHacksPanel::SpeedHacksPanel( wxWindow* parent )
 	m_check_fastCDVD = new pxCheckBox( miscHacksPanel, _("Enable fast CDVD"),
 		_("Fast disc access, less loading times. [Not Recommended]") );
 
+	m_check_iopHLE = new pxCheckBox( miscHacksPanel, _("Enable IOP library HLE"),
+		_("Runs the IOP memory copy and fill routines natively, faster loading screens.") );
+
+	m_check_ipuThread = new pxCheckBox( miscHacksPanel, _("Threaded IPU (experimental)"),
+		_("Speedup for games with CPU heavy videos; may cause video hanging... [Not Recommended]") );
+
+	m_check_threadPinning = new pxCheckBox( miscHacksPanel, _("Pin emulator threads to CPU cores"),
+		_("Keeps the EE, GS, VU and software renderer threads on separate cores of one cache domain.") );
+
 
 	m_check_intc->SetToolTip( pxEt( L"This hack works best for games that use the INTC Status register to wait for vsyncs, which includes primarily non-3D RPG titles. Games that do not use this method of vsync will see little or no speedup from this hack."
 	) );
@@ -208,6 +223,15 @@ Panels::SpeedHacksPanel::SpeedHacksPanel( wxWindow* parent )
 	m_check_fastCDVD->SetToolTip( pxEt( L"Check HDLoader compatibility lists for known games that have issues with this (often marked as needing 'mode 1' or 'slow DVD')."
 	) );
 
+	m_check_iopHLE->SetToolTip( pxEt( L"Replaces the memcpy, memmove, memset, bcopy and bzero routines of the IOP sysclib module by native code.  The IOP doesn't spend any cycle in them anymore, which may upset the timing of some games."
+	) );
+
+	m_check_ipuThread->SetToolTip( pxEt( L"Decodes the MPEG videos on their own thread, ahead of the DMA reading the pictures back.  Savestates taken while a video plays may lose the data the thread had queued."
+	) );
+
+	m_check_threadPinning->SetToolTip( wxString(pxEt( L"Stops the EE, GS and VU threads from migrating between cores and sharing an L3 cache with another socket or CCX.  Mostly useful on multi-socket and multi-CCX CPUs; takes effect the next time the emulation threads are started."
+	)) + L"\n\n" + Threading::GetThreadAffinityPlan().ToString() );
+
 
 	*m_eeRateSliderPanel += m_slider_eeRate | sliderFlags;
 	*m_eeRateSliderPanel += m_msg_eeRate | sliderFlags;
@@ -218,10 +242,14 @@ Panels::SpeedHacksPanel::SpeedHacksPanel( wxWindow* parent )
 	*vuHacksPanel += m_check_vuFlagHack | StdExpand();
 	*vuHacksPanel += m_check_vuThread | StdExpand();
 	*vuHacksPanel += m_check_vu1Instant | StdExpand();
+	*vuHacksPanel += m_check_vu0Thread | StdExpand();
 
 	*miscHacksPanel += m_check_intc | StdExpand();
 	*miscHacksPanel += m_check_waitloop | StdExpand();
 	*miscHacksPanel += m_check_fastCDVD | StdExpand();
+	*miscHacksPanel += m_check_iopHLE | StdExpand();
+	*miscHacksPanel += m_check_ipuThread | StdExpand();
+	*miscHacksPanel += m_check_threadPinning | StdExpand();
 
 	s_table = new wxFlexGridSizer( 3, 2, 0, 0 );
 	s_table->Add(m_eeRateSliderPanel, StdExpand());
@@ -265,9 +293,13 @@ void Panels::SpeedHacksPanel::EnableStuff( AppConfig* configToUse )
 
 	// checkboxes
 	m_check_vuFlagHack->Enable(HacksEnabledAndNoPreset);
+	m_check_vu0Thread->Enable(HacksEnabledAndNoPreset);
 	m_check_intc->Enable(HacksEnabledAndNoPreset);
 	m_check_waitloop->Enable(HacksEnabledAndNoPreset);
 	m_check_fastCDVD->Enable(HacksEnabledAndNoPreset);
+	m_check_iopHLE->Enable(HacksEnabledAndNoPreset);
+	m_check_ipuThread->Enable(HacksEnabledAndNoPreset);
+	m_check_threadPinning->Enable(hacksEnabled && Threading::GetThreadAffinityPlan().valid);
 
 	// Grayout MTVU on safest preset
 	m_check_vuThread->Enable(hacksEnabled && (!hasPreset || configToUse->PresetIndex != 0));
@@ -306,8 +338,12 @@ void Panels::SpeedHacksPanel::ApplyConfigToGui( AppConfig& configToApply, int fl
 	m_check_intc->SetValue(opts.IntcStat);
 	m_check_waitloop->SetValue(opts.WaitLoop);
 	m_check_fastCDVD->SetValue(opts.fastCDVD);
+	m_check_iopHLE->SetValue(opts.IopHLE);
+	m_check_ipuThread->SetValue(opts.ipuThread);
+	m_check_threadPinning->SetValue(opts.threadPinning);
 	m_check_vuThread->SetValue(opts.vuThread);
 	m_check_vu1Instant->SetValue(opts.vu1Instant);
+	m_check_vu0Thread->SetValue(opts.vu0Thread);
 
 	// Then, lock(gray out)/unlock the widgets as necessary.
 	EnableStuff( &configToApply );
@@ -326,10 +362,14 @@ void Panels::SpeedHacksPanel::Apply()
 
 	opts.WaitLoop			= m_check_waitloop->GetValue();
 	opts.fastCDVD			= m_check_fastCDVD->GetValue();
+	opts.IopHLE				= m_check_iopHLE->GetValue();
+	opts.ipuThread			= m_check_ipuThread->GetValue();
+	opts.threadPinning		= m_check_threadPinning->GetValue();
 	opts.IntcStat			= m_check_intc->GetValue();
 	opts.vuFlagHack			= m_check_vuFlagHack->GetValue();
 	opts.vuThread			= m_check_vuThread->GetValue();
 	opts.vu1Instant			= m_check_vu1Instant->GetValue();
+	opts.vu0Thread			= m_check_vu0Thread->GetValue();
 
 	// If the user has a command line override specified, we need to disable it
 	// so that their changes take effect
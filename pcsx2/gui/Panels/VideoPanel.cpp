@@ -200,6 +200,10 @@ Panels::FrameSkipPanel::FrameSkipPanel( wxWindow* parent )
 	m_spin_FramesToDraw = new wxSpinCtrl(this);
 	m_spin_FramesToSkip = new wxSpinCtrl(this);
 
+	m_check_Adaptive = new pxCheckBox(this, _("Adaptive"),
+		_("Skips only while the GS can't keep up, instead of the fixed pattern below."));
+	m_check_Adaptive->SetToolTip(pxEt(L"Frames are skipped only when the GS thread is what holds back emulation speed, and only as many as needed to reach full speed. Frames to Draw and Frames to Skip are ignored."));
+
 	// Set tooltips for spinners.
 
 
@@ -207,6 +211,7 @@ Panels::FrameSkipPanel::FrameSkipPanel( wxWindow* parent )
 	// Sizers and Layouts
 
 	*this += m_radio_SkipMode;
+	*this += m_check_Adaptive | StdExpand();
 
 	wxFlexGridSizer& s_spins( *new wxFlexGridSizer( 4 ) );
 	//s_spins.AddGrowableCol( 0 );
@@ -247,6 +252,7 @@ void Panels::FrameSkipPanel::ApplyConfigToGui( AppConfig& configToApply, int fla
 	m_spin_FramesToDraw->Enable(!configToApply.EnablePresets);
 	m_spin_FramesToSkip->SetValue( gsconf.FramesToSkip );
 	m_spin_FramesToSkip->Enable(!configToApply.EnablePresets);
+	m_check_Adaptive->SetValue( gsconf.FrameSkipAdaptive );
 
 	this->Enable(!configToApply.EnablePresets);
 }
@@ -259,6 +265,7 @@ void Panels::FrameSkipPanel::Apply()
 
 	gsconf.FramesToDraw = m_spin_FramesToDraw->GetValue();
 	gsconf.FramesToSkip = m_spin_FramesToSkip->GetValue();
+	gsconf.FrameSkipAdaptive = m_check_Adaptive->GetValue();
 
 	switch( m_radio_SkipMode->GetSelection() )
 	{
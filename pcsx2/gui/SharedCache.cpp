@@ -0,0 +1,155 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PrecompiledHeader.h"
+#include "SharedCache.h"
+#include "AppConfig.h"
+
+#include <wx/utils.h>
+
+#ifdef _WIN32
+#include "Utilities/RedtapeWindows.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+static wxDirName s_folder;
+
+void SharedCache::SetFolder(const wxDirName& folder)
+{
+	s_folder = folder;
+
+	if (!s_folder.Exists() && !s_folder.Mkdir())
+	{
+		Console.Error(L"(SharedCache) Can't create %s, the caches stay in the settings folder", WX_STR(s_folder.ToString()));
+		s_folder.Clear();
+		return;
+	}
+
+	Console.WriteLn(L"(SharedCache) Using %s", WX_STR(s_folder.ToString()));
+}
+
+bool SharedCache::IsShared()
+{
+	return s_folder.IsOk() && !s_folder.ToString().IsEmpty();
+}
+
+wxString SharedCache::GetPath(const wxString& file)
+{
+	const wxDirName& folder = IsShared() ? s_folder : GetSettingsFolder();
+	return folder.Combine(wxFileName(file)).GetFullPath();
+}
+
+bool SharedCache::ReplaceFile(const wxString& path, const void* data, size_t size)
+{
+	// Unique per process, two instances never write the same temporary file
+	const wxString tmp = path + wxString::Format(L".%lu.tmp", wxGetProcessId());
+
+#ifdef _WIN32
+	FILE* fp = _wfopen(tmp.wc_str(), L"wb");
+#else
+	FILE* fp = fopen(tmp.ToUTF8(), "wb");
+#endif
+	if (!fp)
+		return false;
+
+	const bool written = fwrite(data, size, 1, fp) == 1;
+	const bool closed = fclose(fp) == 0;
+
+	if (written && closed)
+	{
+#ifdef _WIN32
+		if (MoveFileExW(tmp.wc_str(), path.wc_str(), MOVEFILE_REPLACE_EXISTING))
+			return true;
+#else
+		if (rename(tmp.ToUTF8(), path.ToUTF8()) == 0)
+			return true;
+#endif
+	}
+
+	wxRemoveFile(tmp);
+	return false;
+}
+
+// --------------------------------------------------------------------------------------
+//  SharedCache::FileLock
+// --------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+
+SharedCache::FileLock::FileLock(const wxString& path)
+	: m_locked(false)
+{
+	const wxString lock = path + L".lock";
+	HANDLE handle = CreateFileW(lock.wc_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	m_handle = handle;
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return;
+
+	OVERLAPPED ov = {};
+	m_locked = LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &ov) != 0;
+}
+
+SharedCache::FileLock::~FileLock()
+{
+	HANDLE handle = m_handle;
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return;
+
+	if (m_locked)
+	{
+		OVERLAPPED ov = {};
+		UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &ov);
+	}
+
+	CloseHandle(handle);
+}
+
+#else
+
+SharedCache::FileLock::FileLock(const wxString& path)
+	: m_locked(false)
+{
+	const wxString lock = path + L".lock";
+	m_fd = open(lock.ToUTF8(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+
+	if (m_fd < 0)
+		return;
+
+	while (flock(m_fd, LOCK_EX) != 0)
+	{
+		if (errno != EINTR)
+			return;
+	}
+
+	m_locked = true;
+}
+
+SharedCache::FileLock::~FileLock()
+{
+	if (m_fd < 0)
+		return;
+
+	// Closing the descriptor releases the lock
+	close(m_fd);
+}
+
+#endif
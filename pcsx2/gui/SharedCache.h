@@ -0,0 +1,57 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Utilities/Path.h"
+
+// --------------------------------------------------------------------------------------
+//  SharedCache
+// --------------------------------------------------------------------------------------
+// Caches that are only derived from immutable inputs (GameDB index, GL program binaries,
+// ...) can live in a folder shared by all the instances of a host (--sharedcache).  The
+// files are named after a hash of their inputs, and are always replaced as a whole so a
+// reader sees either the old or the new file.  Rewrites that merge the content of other
+// instances are done under a FileLock.
+namespace SharedCache
+{
+	extern void SetFolder(const wxDirName& folder);
+	extern bool IsShared();
+
+	// Path of a cache file, in the shared folder when there is one, else in the settings folder
+	extern wxString GetPath(const wxString& file);
+
+	// Writes the file next to path then renames it over path
+	extern bool ReplaceFile(const wxString& path, const void* data, size_t size);
+
+	// Exclusive lock on "<path>.lock" held across processes.  The lock file is left behind,
+	// removing it would race with the next locker.
+	class FileLock
+	{
+	public:
+		FileLock(const wxString& path);
+		~FileLock();
+
+		bool IsLocked() const { return m_locked; }
+
+	private:
+#ifdef _WIN32
+		void* m_handle;
+#else
+		int m_fd;
+#endif
+		bool m_locked;
+	};
+} // namespace SharedCache
@@ -20,6 +20,9 @@
 #include "System/SysThreads.h"
 #include "SaveState.h"
 #include "VUmicro.h"
+#include "Elfheader.h"
+#include "MTVU.h"
+#include "ps2/BiosTools.h"
 
 #include "ZipTools/ThreadedZipTools.h"
 #include "Utilities/pxStreams.h"
@@ -34,10 +37,28 @@
 #include "ConsoleLogger.h"
 
 #include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/ffile.h>
+#include <wx/dir.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#ifdef PCSX2_ZSTD
+#include <zstd.h>
+#endif
+#include <zlib.h>
 
 #include "Patch.h"
 
+#ifndef DISABLE_RECORDING
+#include "Recording/InputRecording.h"
+#include "Recording/InputRecordingControls.h"
+#endif
+
 // Used to hold the current state backup (fullcopy of PS2 memory and subcomponents states).
 //static VmStateBuffer state_buffer( L"Public Savestate Buffer" );
 
@@ -53,8 +74,16 @@ struct SysState_Component
 
 int SysState_MTGSFreeze(FreezeAction mode, freezeData* fP)
 {
-	ScopedCoreThreadPause paused_core;
 	MTGS_FreezeData sstate = {fP, 0};
+
+	// The boot snapshot is frozen by the core thread itself, which can't pause itself
+	if (GetCoreThread().IsSelf())
+	{
+		GetMTGS().Freeze(mode, sstate);
+		return sstate.retval;
+	}
+
+	ScopedCoreThreadPause paused_core;
 	GetMTGS().Freeze(mode, sstate);
 	paused_core.AllowResume();
 	return sstate.retval;
@@ -147,7 +176,6 @@ public:
 	virtual void FreezeOut(SaveStateBase& writer) const;
 	virtual bool IsRequired() const { return true; }
 
-protected:
 	virtual u8* GetDataPtr() const = 0;
 	virtual uint GetDataSize() const = 0;
 };
@@ -372,6 +400,193 @@ static void CheckVersion(pxInputStream& thr)
 			.SetUserMsg(_("Cannot load this savestate. The state is an unsupported version."));
 };
 
+// Matches the entry of a savestate component, whichever way it was compressed
+static bool StateEntry_Is(const wxZipEntry& entry, const wxString& name)
+{
+	if (entry.GetName().CmpNoCase(name) == 0)
+		return true;
+#ifdef PCSX2_ZSTD
+	return entry.GetName().CmpNoCase(name + ZstdEntry_Suffix) == 0;
+#else
+	return false;
+#endif
+}
+
+// Opens the entry, and returns the stream to read it from: the archive itself, or a stream
+// over the data of a zstd entry, decompressed to data.
+static pxInputStream& StateEntry_Open(pxInputStream& reader, wxZipEntry& entry, std::vector<u8>& data, std::unique_ptr<pxInputStream>& unpacked)
+{
+	((wxZipInputStream*)reader.GetWxStreamBase())->OpenEntry(entry);
+
+#ifdef PCSX2_ZSTD
+	if (entry.GetName().Lower().EndsWith(ZstdEntry_Suffix))
+	{
+		std::vector<u8> packed(entry.GetSize());
+		reader.Read(packed.data(), packed.size());
+		if (!ZstdEntry_Decompress(packed.data(), packed.size(), data))
+			throw Exception::SaveStateLoadError(reader.GetStreamName())
+				.SetDiagMsg(pxsFmt(L"The savestate entry '%s' is corrupted.", WX_STR(entry.GetName())));
+
+		unpacked.reset(new pxInputStream(reader.GetStreamName(), new wxMemoryInputStream(data.data(), data.size())));
+		return *unpacked;
+	}
+#endif
+
+	return reader;
+}
+
+// --------------------------------------------------------------------------------------
+//  Incremental savestates
+// --------------------------------------------------------------------------------------
+// With incremental saves, the EE memory of a savestate is only the pages written since a
+// base (see mmap_StartDirtyTracking), the EE memory when the tracking started, which is kept
+// in a separate file of the savestates folder.  Saves made while there is no usable base
+// (first save of the session, too many pages written) are full states, and start a new base.
+// The base and the deltas identify it with their EntryFilename_IncrementalBase.
+
+static const wxChar* EntryFilename_IncrementalBase = L"PCSX2 Incremental Base.id";
+static const wxChar* EntryFilename_EmotionMemoryDelta = L"eeMemory.delta";
+
+// Past this, saving a full state and a new base is cheaper to load than a delta
+static const uint IncrementalMaxDeltaPages = (Ps2MemSize::MainRam >> 12) / 2;
+
+static u64 s_IncrementalBaseId = 0; // 0 without a base
+static wxString s_IncrementalBaseFile;
+
+static wxString IncrementalBase_GetFilename(u64 id)
+{
+	wxString serialName(DiscSerial);
+	if (serialName.IsEmpty())
+		serialName = L"BIOS";
+
+	return (g_Conf->Folders.Savestates +
+			pxsFmt(L"%s (%08X).base.%08X%08X.p2s", WX_STR(serialName), ElfCRC, (u32)(id >> 32), (u32)id))
+		.GetFullPath();
+}
+
+static void IncrementalBase_FreezeOutId(memSavingState& saveme, ArchiveEntryList& list, u64 id, const wxString& file)
+{
+	const uint startpos = saveme.GetCurrentPos();
+	const wxCharBuffer name(wxFileName(file).GetFullName().ToUTF8());
+	u32 length = strlen(name.data());
+
+	saveme.Freeze(id);
+	saveme.Freeze(length);
+	saveme.FreezeMem(const_cast<char*>(name.data()), length);
+
+	list.Add(ArchiveEntry(EntryFilename_IncrementalBase)
+				 .SetDataIndex(startpos)
+				 .SetDataSize(saveme.GetCurrentPos() - startpos));
+}
+
+static bool IncrementalBase_ReadId(pxInputStream& reader, u64& id, wxString& name)
+{
+	u32 length = 0;
+	reader.Read(id);
+	reader.Read(length);
+	if (length == 0 || length > 1024)
+		return false;
+
+	std::vector<char> buffer(length);
+	reader.Read(buffer.data(), length);
+	name = wxString::FromUTF8(buffer.data(), length);
+	return id != 0;
+}
+
+// Reads the base id of a savestate or base file, returns false if it has none.
+static bool IncrementalBase_ReadIdFromFile(const wxString& file, u64& id, wxString& name)
+{
+	try
+	{
+		std::unique_ptr<wxFFileInputStream> woot(new wxFFileInputStream(file));
+		if (!woot->IsOk())
+			return false;
+
+		pxInputStream reader(file, new wxZipInputStream(woot.release()));
+		wxZipInputStream* gzreader = (wxZipInputStream*)reader.GetWxStreamBase();
+
+		while (std::unique_ptr<wxZipEntry> entry{gzreader->GetNextEntry()})
+		{
+			if (entry->GetName().CmpNoCase(EntryFilename_IncrementalBase) == 0)
+				return IncrementalBase_ReadId(reader, id, name);
+		}
+	}
+	catch (Exception::BaseException&)
+	{
+	}
+
+	return false;
+}
+
+// Stored as the page count, the page numbers, then the pages.
+static void IncrementalDelta_FreezeOut(memSavingState& saveme, std::vector<u32>& pages)
+{
+	u32 count = pages.size();
+	saveme.Freeze(count);
+	if (count)
+		saveme.FreezeMem(pages.data(), count * sizeof(u32));
+
+	for (u32 page : pages)
+		saveme.FreezeMem(&eeMem->Main[page << 12], __pagesize);
+}
+
+static void IncrementalDelta_FreezeIn(pxInputStream& reader)
+{
+	const u32 maxPages = Ps2MemSize::MainRam >> 12;
+	u32 count = 0;
+	reader.Read(count);
+	if (count > maxPages)
+		throw Exception::SaveStateLoadError(reader.GetStreamName())
+			.SetDiagMsg(L"The EE memory delta of the savestate is corrupted.");
+
+	std::vector<u32> pages(count);
+	if (count)
+		reader.Read(pages.data(), count * sizeof(u32));
+
+	for (u32 page : pages)
+	{
+		if (page >= maxPages)
+			throw Exception::SaveStateLoadError(reader.GetStreamName())
+				.SetDiagMsg(L"The EE memory delta of the savestate is corrupted.");
+
+		reader.Read(&eeMem->Main[page << 12], __pagesize);
+	}
+
+	// The memory is the base again, plus these pages
+	mmap_StartDirtyTracking(pages.data(), count);
+}
+
+// Loads the EE memory of a base file.
+static void IncrementalBase_FreezeIn(const wxString& file)
+{
+	std::unique_ptr<wxFFileInputStream> woot(new wxFFileInputStream(file));
+	if (!woot->IsOk())
+		throw Exception::CannotCreateStream(file).SetDiagMsg(L"Cannot open file for reading.");
+
+	pxInputStream reader(file, new wxZipInputStream(woot.release()));
+	wxZipInputStream* gzreader = (wxZipInputStream*)reader.GetWxStreamBase();
+
+	while (std::unique_ptr<wxZipEntry> entry{gzreader->GetNextEntry()})
+	{
+		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+		{
+			if (dynamic_cast<const SavestateEntry_EmotionMemory*>(SavestateEntries[i].get()) &&
+				StateEntry_Is(*entry, SavestateEntries[i]->GetFilename()))
+			{
+				std::vector<u8> data;
+				std::unique_ptr<pxInputStream> unpacked;
+				SavestateEntries[i]->FreezeIn(StateEntry_Open(reader, *entry, data, unpacked));
+				return;
+			}
+		}
+	}
+
+	throw Exception::SaveStateLoadError(file)
+		.SetDiagMsg(L"The base of the incremental savestate has no EE memory.");
+}
+
+static void IncrementalBase_Start();
+
 // --------------------------------------------------------------------------------------
 //  SysExecEvent_DownloadState
 // --------------------------------------------------------------------------------------
@@ -417,15 +632,59 @@ protected:
 		internals.SetDataSize(saveme.GetCurrentPos() - internals.GetDataIndex());
 		m_dest_list->Add(internals);
 
+		// Incremental saves are deltas while the base is usable, and full states with a new base otherwise
+		std::vector<u32> dirty;
+		const bool incremental = EmuConfig.IncrementalSavestates;
+		const bool delta = incremental && s_IncrementalBaseId &&
+						   s_IncrementalBaseFile == IncrementalBase_GetFilename(s_IncrementalBaseId) &&
+						   mmap_GetDirtyPages(dirty) && dirty.size() <= IncrementalMaxDeltaPages;
+
+		// With copy on write, the EE memory only gets its room in the state here.  Its pages are
+		// copied when the VM first writes them, or by the zip for the others.
+		const bool cow = EmuConfig.CopyOnWriteSavestates && !delta;
+		uint cowpos = 0;
+
 		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
 		{
 			uint startpos = saveme.GetCurrentPos();
+			if (delta && dynamic_cast<const SavestateEntry_EmotionMemory*>(SavestateEntries[i].get()))
+			{
+				IncrementalDelta_FreezeOut(saveme, dirty);
+				m_dest_list->Add(ArchiveEntry(EntryFilename_EmotionMemoryDelta)
+									 .SetDataIndex(startpos)
+									 .SetDataSize(saveme.GetCurrentPos() - startpos));
+				continue;
+			}
+
+			if (cow && dynamic_cast<const SavestateEntry_EmotionMemory*>(SavestateEntries[i].get()))
+			{
+				saveme.PrepBlock(sizeof(eeMem->Main));
+				saveme.CommitBlock(sizeof(eeMem->Main));
+				cowpos = startpos;
+				m_dest_list->Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
+									 .SetDataIndex(startpos)
+									 .SetDataSize(sizeof(eeMem->Main)));
+				continue;
+			}
+
 			SavestateEntries[i]->FreezeOut(saveme);
 			m_dest_list->Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
 								 .SetDataIndex(startpos)
 								 .SetDataSize(saveme.GetCurrentPos() - startpos));
 		}
 
+		if (delta)
+		{
+			IncrementalBase_FreezeOutId(saveme, *m_dest_list, s_IncrementalBaseId, s_IncrementalBaseFile);
+			Console.Indent().WriteLn(Color_StrongGreen, L"Incremental save: %u pages of EE memory changed since the base.", (uint)dirty.size());
+		}
+		else if (incremental)
+			IncrementalBase_Start();
+
+		// Last, since the buffer doesn't move anymore
+		if (cow)
+			mmap_StartCopyOnWrite(m_dest_list->GetBuffer()->GetPtr(cowpos));
+
 		UI_EnableStateActions();
 		paused_core.AllowResume();
 	}
@@ -501,6 +760,9 @@ protected:
 		// Provisionals for scoped cleanup, in case of exception:
 		std::unique_ptr<ArchiveEntryList> elist(m_src_list);
 
+		// Completes the EE memory of a copy on write download, and before the list can go away
+		mmap_FinishCopyOnWrite();
+
 		wxString tempfile(m_filename + L".tmp");
 
 		wxFFileOutputStream* woot = new wxFFileOutputStream(tempfile);
@@ -552,6 +814,61 @@ protected:
 	}
 };
 
+// --------------------------------------------------------------------------------------
+//  SysExecEvent_CleanupIncrementalBases
+// --------------------------------------------------------------------------------------
+// Deletes the base files of the game that no savestate uses anymore, except the current one.
+//
+class SysExecEvent_CleanupIncrementalBases : public SysExecEvent
+{
+public:
+	wxString GetEventName() const { return L"VM_CleanupIncrementalBases"; }
+
+	virtual ~SysExecEvent_CleanupIncrementalBases() = default;
+	SysExecEvent_CleanupIncrementalBases* Clone() const { return new SysExecEvent_CleanupIncrementalBases(*this); }
+
+protected:
+	void InvokeEvent()
+	{
+		// Waits for the savestates being written, which may use a base
+		ScopedLock lock(mtx_CompressToDisk);
+
+		const wxFileName current(s_IncrementalBaseFile);
+		const wxString prefix(current.GetFullName().BeforeLast(L')') + L").");
+
+		wxArrayString files;
+		wxDir::GetAllFiles(current.GetPath(), &files, prefix + L"*", wxDIR_FILES);
+
+		std::unordered_set<std::wstring> used;
+		std::vector<wxString> bases;
+		for (const wxString& file : files)
+		{
+			const wxString name(wxFileName(file).GetFullName());
+			if (name.StartsWith(prefix + L"base."))
+			{
+				if (name.EndsWith(L".p2s"))
+					bases.push_back(file);
+				continue;
+			}
+
+			u64 id;
+			wxString base;
+			if (IncrementalBase_ReadIdFromFile(file, id, base))
+				used.insert(base.ToStdWstring());
+		}
+
+		for (const wxString& file : bases)
+		{
+			const wxString name(wxFileName(file).GetFullName());
+			if (name == current.GetFullName() || used.count(name.ToStdWstring()))
+				continue;
+
+			Console.WriteLn(L"Deleting the unused incremental base %s", WX_STR(name));
+			wxRemoveFile(file);
+		}
+	}
+};
+
 // --------------------------------------------------------------------------------------
 //  SysExecEvent_UnzipFromDisk
 // --------------------------------------------------------------------------------------
@@ -608,6 +925,12 @@ protected:
 		std::unique_ptr<wxZipEntry> foundInternal;
 		std::unique_ptr<wxZipEntry> foundEntry[ArraySize(SavestateEntries)];
 
+		// Incremental saves have the EE memory written since their base instead
+		std::unique_ptr<wxZipEntry> foundDelta;
+		bool foundBaseId = false;
+		u64 baseId = 0;
+		wxString baseName;
+
 		while (true)
 		{
 			Threading::pxTestCancel();
@@ -624,13 +947,25 @@ protected:
 				continue;
 			}
 
-			if (entry->GetName().CmpNoCase(EntryFilename_InternalStructures) == 0)
+			if (StateEntry_Is(*entry, EntryFilename_InternalStructures))
 			{
 				DevCon.WriteLn(Color_Green, L" ... found '%s'", EntryFilename_InternalStructures);
 				foundInternal = std::move(entry);
 				continue;
 			}
 
+			if (entry->GetName().CmpNoCase(EntryFilename_IncrementalBase) == 0)
+			{
+				foundBaseId = IncrementalBase_ReadId(*reader, baseId, baseName);
+				continue;
+			}
+
+			if (StateEntry_Is(*entry, EntryFilename_EmotionMemoryDelta))
+			{
+				foundDelta = std::move(entry);
+				continue;
+			}
+
 			// No point in finding screenshots when loading states -- the screenshots are
 			// only useful for the UI savestate browser.
 			/*if (entry->GetName().CmpNoCase(EntryFilename_Screenshot) == 0)
@@ -640,7 +975,7 @@ protected:
 
 			for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
 			{
-				if (entry->GetName().CmpNoCase(SavestateEntries[i]->GetFilename()) == 0)
+				if (StateEntry_Is(*entry, SavestateEntries[i]->GetFilename()))
 				{
 					DevCon.WriteLn(Color_Green, L" ... found '%s'", WX_STR(SavestateEntries[i]->GetFilename()));
 					foundEntry[i] = std::move(entry);
@@ -657,6 +992,19 @@ protected:
 				.SetUserMsg(_("This file is not a valid PCSX2 savestate.  See the logfile for details."));
 		}
 
+		wxString baseFile;
+		if (foundDelta)
+		{
+			u64 id = 0;
+			wxString name;
+			baseFile = wxFileName(m_filename).GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR) + baseName;
+
+			if (!foundBaseId || !IncrementalBase_ReadIdFromFile(baseFile, id, name) || id != baseId)
+				throw Exception::SaveStateLoadError(m_filename)
+					.SetDiagMsg(pxsFmt(L"The base of the incremental savestate is missing or was replaced: %s", WX_STR(baseFile)))
+					.SetUserMsg(_("This savestate cannot be loaded: it was saved incrementally, and the file with its base state is missing."));
+		}
+
 		// Log any parts and pieces that are missing, and then generate an exception.
 		bool throwIt = false;
 		for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
@@ -664,6 +1012,9 @@ protected:
 			if (foundEntry[i])
 				continue;
 
+			if (foundDelta && dynamic_cast<const SavestateEntry_EmotionMemory*>(SavestateEntries[i].get()))
+				continue;
+
 			if (SavestateEntries[i]->IsRequired())
 			{
 				throwIt = true;
@@ -691,22 +1042,1164 @@ protected:
 
 			Threading::pxTestCancel();
 
-			gzreader->OpenEntry(*foundEntry[i]);
-			SavestateEntries[i]->FreezeIn(*reader);
+			std::vector<u8> data;
+			std::unique_ptr<pxInputStream> unpacked;
+			SavestateEntries[i]->FreezeIn(StateEntry_Open(*reader, *foundEntry[i], data, unpacked));
+		}
+
+		if (foundDelta)
+		{
+			IncrementalBase_FreezeIn(baseFile);
+
+			std::vector<u8> data;
+			std::unique_ptr<pxInputStream> unpacked;
+			IncrementalDelta_FreezeIn(StateEntry_Open(*reader, *foundDelta, data, unpacked));
+
+			// Later saves can go on with the same base
+			s_IncrementalBaseId = baseId;
+			s_IncrementalBaseFile = baseFile;
 		}
 
 		// Load all the internal data
 
-		gzreader->OpenEntry(*foundInternal);
+		std::vector<u8> data;
+		std::unique_ptr<pxInputStream> unpacked;
+		pxInputStream& internals = StateEntry_Open(*reader, *foundInternal, data, unpacked);
 
-		VmStateBuffer buffer(foundInternal->GetSize(), L"StateBuffer_UnzipFromDisk"); // start with an 8 meg buffer to avoid frequent reallocation.
-		reader->Read(buffer.GetPtr(), foundInternal->GetSize());
+		VmStateBuffer buffer(internals.Length(), L"StateBuffer_UnzipFromDisk"); // start with an 8 meg buffer to avoid frequent reallocation.
+		internals.Read(buffer.GetPtr(), internals.Length());
 
 		memLoadingState(buffer).FreezeBios().FreezeInternals();
 		GetCoreThread().Resume(); // force resume regardless of emulation state earlier.
 	}
 };
 
+// Called by the download of a full state, with the core paused: saves its EE memory as a
+// new base, and starts tracking the pages written since.
+static void IncrementalBase_Start()
+{
+	u64 id = std::chrono::system_clock::now().time_since_epoch().count() ^ ((u64)GetCPUTicks() << 32);
+	if (!id)
+		id = 1;
+
+	const wxString file(IncrementalBase_GetFilename(id));
+
+	std::unique_ptr<ArchiveEntryList> list(new ArchiveEntryList(VmStateArena_Acquire(L"Incremental Base")));
+	memSavingState saveme(list->GetBuffer());
+
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		if (!dynamic_cast<const SavestateEntry_EmotionMemory*>(SavestateEntries[i].get()))
+			continue;
+
+		const uint startpos = saveme.GetCurrentPos();
+		SavestateEntries[i]->FreezeOut(saveme);
+		list->Add(ArchiveEntry(SavestateEntries[i]->GetFilename())
+					  .SetDataIndex(startpos)
+					  .SetDataSize(saveme.GetCurrentPos() - startpos));
+	}
+	IncrementalBase_FreezeOutId(saveme, *list, id, file);
+
+	mmap_StartDirtyTracking();
+	s_IncrementalBaseId = id;
+	s_IncrementalBaseFile = file;
+
+	Console.Indent().WriteLn(Color_StrongGreen, L"Incremental saves: new base %s", WX_STR(file));
+
+	GetSysExecutorThread().PostEvent(new SysExecEvent_ZipToDisk(list.release(), file));
+	GetSysExecutorThread().PostEvent(new SysExecEvent_CleanupIncrementalBases());
+}
+
+// =====================================================================================================
+//  Raw snapshots
+// =====================================================================================================
+// The machine, uncompressed: the internal structures, then the savestate entries, one after the
+// other.  The size of each part goes to sizes.
+
+static const uint RawSnapshotParts = ArraySize(SavestateEntries) + 1;
+
+static void RawSnapshot_FreezeOut(memSavingState& saveme, u32* sizes)
+{
+	saveme.FreezeBios();
+	saveme.FreezeInternals();
+	sizes[0] = saveme.GetCurrentPos();
+
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		uint startpos = saveme.GetCurrentPos();
+		SavestateEntries[i]->FreezeOut(saveme);
+		sizes[i + 1] = saveme.GetCurrentPos() - startpos;
+	}
+}
+
+static void RawSnapshot_FreezeIn(const wxString& name, const u8* data, const u32* sizes)
+{
+	SysClearExecutionCache();
+
+	uint pos = sizes[0];
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		pxInputStream reader(name, new wxMemoryInputStream(data + pos, sizes[i + 1]));
+		SavestateEntries[i]->FreezeIn(reader);
+		pos += sizes[i + 1];
+	}
+
+	VmStateBuffer internals(sizes[0], L"RawSnapshot");
+	memcpy(internals.GetPtr(), data, sizes[0]);
+	memLoadingState(internals).FreezeBios().FreezeInternals();
+}
+
+// =====================================================================================================
+//  Boot snapshot
+// =====================================================================================================
+// On fast boots, the machine is saved when the BIOS starts EELOAD, and later boots restore it
+// instead of running the BIOS again.  The file is a raw snapshot, behind the sizes of its
+// parts.  The snapshot is frozen and restored by the core thread itself, at a block boundary
+// (see eeloadHook).
+//
+// Anything the BIOS boot depends on is part of the file name: the BIOS, the emulation
+// settings, and the ELF to boot (the IOP probes the disc while the BIOS runs).
+
+static wxString BootSnapshot_GetFilename()
+{
+	wxString elfname(GetCoreThread().GetElfOverride());
+	if (elfname.IsEmpty())
+		GetPS2ElfName(elfname);
+
+	u32 key = 2166136261u;
+	auto hash = [&key](const void* data, size_t size)
+	{
+		for (size_t i = 0; i < size; i++)
+			key = (key ^ ((const u8*)data)[i]) * 16777619u;
+	};
+
+	hash(&g_SaveVersion, sizeof(g_SaveVersion));
+	hash(&EmuConfig.bitset, sizeof(EmuConfig.bitset));
+	hash(&EmuConfig.Cpu.Recompiler.bitset, sizeof(EmuConfig.Cpu.Recompiler.bitset));
+	hash(&EmuConfig.Cpu.sseMXCSR.bitmask, sizeof(EmuConfig.Cpu.sseMXCSR.bitmask));
+	hash(&EmuConfig.Cpu.sseVUMXCSR.bitmask, sizeof(EmuConfig.Cpu.sseVUMXCSR.bitmask));
+	hash(&EmuConfig.Gamefixes.bitset, sizeof(EmuConfig.Gamefixes.bitset));
+	hash(&EmuConfig.Speedhacks.bitset, sizeof(EmuConfig.Speedhacks.bitset));
+	hash(&EmuConfig.Speedhacks.EECycleRate, sizeof(EmuConfig.Speedhacks.EECycleRate));
+	hash(&EmuConfig.Speedhacks.EECycleSkip, sizeof(EmuConfig.Speedhacks.EECycleSkip));
+
+	const wxCharBuffer name(elfname.ToUTF8());
+	hash(name.data(), strlen(name.data()));
+
+	return (g_Conf->Folders.Savestates + pxsFmt(L"BOOT (%08X) %08X.p2b", BiosChecksum, key)).GetFullPath();
+}
+
+bool BootSnapshot_Exists()
+{
+	return wxFileExists(BootSnapshot_GetFilename());
+}
+
+void BootSnapshot_Save()
+{
+	const wxString file(BootSnapshot_GetFilename());
+
+	VmStateBuffer buffer(L"BootSnapshot");
+	memSavingState saveme(buffer);
+	u32 sizes[RawSnapshotParts];
+	RawSnapshot_FreezeOut(saveme, sizes);
+
+	const wxString tempfile(file + L".tmp");
+	wxFFile fp(tempfile, L"wb");
+	if (!fp.IsOpened())
+		return;
+
+	const u32 header[2] = {g_SaveVersion, ArraySize(sizes)};
+	bool ok = fp.Write(header, sizeof(header)) == sizeof(header);
+	ok = ok && fp.Write(sizes, sizeof(sizes)) == sizeof(sizes);
+	ok = ok && fp.Write(buffer.GetPtr(), saveme.GetCurrentPos()) == (size_t)saveme.GetCurrentPos();
+	ok = fp.Close() && ok;
+
+	if (ok && wxRenameFile(tempfile, file, true))
+		Console.WriteLn(Color_StrongGreen, L"Saved the boot snapshot to %s", WX_STR(file));
+	else
+		wxRemoveFile(tempfile);
+}
+
+// Returns false, with the machine untouched, if there is no usable snapshot.  Throws if
+// the snapshot is damaged past the point where the machine can be left as it was.
+bool BootSnapshot_Load()
+{
+	const wxString file(BootSnapshot_GetFilename());
+	if (!wxFileExists(file))
+		return false;
+
+	wxFFile fp(file, L"rb");
+	u32 header[2];
+	u32 sizes[RawSnapshotParts];
+
+	if (!fp.IsOpened() || fp.Read(header, sizeof(header)) != sizeof(header) ||
+		header[0] != g_SaveVersion || header[1] != ArraySize(sizes) ||
+		fp.Read(sizes, sizeof(sizes)) != sizeof(sizes))
+	{
+		Console.Warning(L"Boot snapshot %s is out of date, booting the BIOS.", WX_STR(file));
+		return false;
+	}
+
+	size_t total = 0;
+	for (u32 size : sizes)
+		total += size;
+
+	VmStateBuffer data(total, L"BootSnapshot");
+	if (fp.Read(data.GetPtr(), total) != total)
+	{
+		Console.Warning(L"Boot snapshot %s is truncated, booting the BIOS.", WX_STR(file));
+		return false;
+	}
+
+	RawSnapshot_FreezeIn(file, data.GetPtr(), sizes);
+
+	// The snapshot is taken at the entry of the EELOAD main function
+	g_eeloadMain = cpuRegs.pc;
+
+	Console.WriteLn(Color_StrongGreen, L"Booting from the boot snapshot %s", WX_STR(file));
+	return true;
+}
+
+// =====================================================================================================
+//  Savestate benchmark
+// =====================================================================================================
+// Saves and loads the running machine as raw snapshots, the work of a savestate less the
+// archive, then times the archive compression backends on the snapshot.  The machine is
+// loaded back as it was saved, so the game goes on afterwards.  Runs on the core thread, at
+// a state check, like the run-ahead restores.
+
+static double SavestateBenchmark_Ms(u64 start)
+{
+	return (GetCPUTicks() - start) * 1000.0 / GetTickFrequency();
+}
+
+void Savestate_BenchmarkInThread(uint rounds, SavestateBenchmark& result)
+{
+	VmStateBuffer buffer(L"Savestate Benchmark");
+	u32 sizes[RawSnapshotParts];
+
+	result = SavestateBenchmark();
+
+	try
+	{
+		for (uint i = 0; i < rounds; i++)
+		{
+			memSavingState saveme(buffer);
+			u64 start = GetCPUTicks();
+			RawSnapshot_FreezeOut(saveme, sizes);
+			result.saveMs.push_back(SavestateBenchmark_Ms(start));
+			result.bytes = saveme.GetCurrentPos();
+
+			start = GetCPUTicks();
+			RawSnapshot_FreezeIn(L"Savestate Benchmark", buffer.GetPtr(), sizes);
+			result.loadMs.push_back(SavestateBenchmark_Ms(start));
+		}
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error(L"Benchmark: savestate round failed: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		return;
+	}
+
+	if (!result.bytes)
+		return;
+
+	const u8* data = buffer.GetPtr();
+	const size_t size = result.bytes;
+	std::vector<u8> packed;
+	std::vector<u8> unpacked;
+
+	// The archive entries are deflated at the default level of wxZipOutputStream
+	uLongf length = compressBound(size);
+	packed.resize(length);
+	u64 start = GetCPUTicks();
+	if (compress2(packed.data(), &length, data, size, Z_DEFAULT_COMPRESSION) == Z_OK)
+	{
+		const double packMs = SavestateBenchmark_Ms(start);
+		uLongf unlength = size;
+		unpacked.resize(size);
+		start = GetCPUTicks();
+		if (uncompress(unpacked.data(), &unlength, packed.data(), length) == Z_OK && unlength == size)
+			result.codecs.push_back({"deflate", packMs, SavestateBenchmark_Ms(start), length});
+	}
+
+#ifdef PCSX2_ZSTD
+	start = GetCPUTicks();
+	if (ZstdEntry_Compress(data, size, packed))
+	{
+		const double packMs = SavestateBenchmark_Ms(start);
+		start = GetCPUTicks();
+		if (ZstdEntry_Decompress(packed.data(), packed.size(), unpacked) && unpacked.size() == size)
+			result.codecs.push_back({"zstd", packMs, SavestateBenchmark_Ms(start), packed.size()});
+	}
+#endif
+}
+
+// =====================================================================================================
+//  Rewind
+// =====================================================================================================
+// Every RewindFrames vsyncs, the core thread saves the machine as a raw snapshot, into a buffer
+// left over from earlier captures, so that the capture is copies only.  A worker thread then
+// packs the snapshot the capture replaces as the newest: XOR'd against the newer one, it is mostly
+// zeros, and compresses to a small fraction of its size.  Stepping back loads the newest snapshot,
+// and rebuilds the one before it from its delta.
+
+struct RewindSnapshot
+{
+	u32 sizes[RawSnapshotParts];
+	u32 length;
+	std::vector<u8> packed; // compressed XOR against the next newer snapshot
+};
+
+static bool Rewind_Pack(const u8* data, size_t size, std::vector<u8>& out)
+{
+#ifdef PCSX2_ZSTD
+	out.resize(ZSTD_compressBound(size));
+	const size_t packed = ZSTD_compress(out.data(), out.size(), data, size, 1);
+	if (ZSTD_isError(packed))
+		return false;
+#else
+	uLongf packed = compressBound(size);
+	out.resize(packed);
+	if (compress2(out.data(), &packed, data, size, Z_BEST_SPEED) != Z_OK)
+		return false;
+#endif
+
+	out.resize(packed);
+	out.shrink_to_fit();
+	return true;
+}
+
+static bool Rewind_Unpack(const std::vector<u8>& packed, u8* data, size_t size)
+{
+#ifdef PCSX2_ZSTD
+	return ZSTD_decompress(data, size, packed.data(), packed.size()) == size;
+#else
+	uLongf length = size;
+	return uncompress(data, &length, packed.data(), packed.size()) == Z_OK && length == size;
+#endif
+}
+
+static void Rewind_Xor(u8* dest, const u8* src, size_t size)
+{
+	size_t i = 0;
+	for (; i + sizeof(u64) <= size; i += sizeof(u64))
+	{
+		u64 a, b;
+		memcpy(&a, dest + i, sizeof(a));
+		memcpy(&b, src + i, sizeof(b));
+		a ^= b;
+		memcpy(dest + i, &a, sizeof(a));
+	}
+	for (; i < size; i++)
+		dest[i] ^= src[i];
+}
+
+class RewindBuffer
+{
+protected:
+	std::mutex m_lock;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+	bool m_quit = false;
+	bool m_packing = false;
+
+	// The newest snapshot, the capture waiting for the worker, and a buffer for the next capture
+	std::unique_ptr<VmStateBuffer> m_head;
+	std::unique_ptr<VmStateBuffer> m_pending;
+	std::unique_ptr<VmStateBuffer> m_spare;
+	u32 m_headSizes[RawSnapshotParts];
+	u32 m_pendingSizes[RawSnapshotParts];
+	u32 m_headLength = 0;
+	u32 m_pendingLength = 0;
+
+	std::deque<RewindSnapshot> m_older; // oldest first
+	uint m_vsyncs = 0;
+
+public:
+	virtual ~RewindBuffer() { Reset(); }
+
+	bool IsActive() const { return m_thread.joinable(); }
+
+	void Capture();
+	bool Step();
+	void Reset();
+
+protected:
+	void WorkerThread();
+};
+
+static RewindBuffer s_Rewind;
+
+// Called by the core thread, at every vsync.
+void RewindBuffer::Capture()
+{
+	if (++m_vsyncs < std::max<u32>(EmuConfig.RewindFrames, 1))
+		return;
+	m_vsyncs = 0;
+
+	std::unique_ptr<VmStateBuffer> buffer;
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+
+		// Skips the capture when the worker is behind, rather than hold up the game
+		if (m_pending)
+			return;
+
+		buffer = std::move(m_spare);
+		if (!m_thread.joinable())
+		{
+			m_quit = false;
+			m_thread = std::thread(&RewindBuffer::WorkerThread, this);
+		}
+	}
+
+	if (!buffer)
+		buffer.reset(new VmStateBuffer(L"Rewind Snapshot"));
+
+	u32 sizes[RawSnapshotParts];
+	memSavingState saveme(*buffer);
+
+	try
+	{
+		RawSnapshot_FreezeOut(saveme, sizes);
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error(L"Rewind: cannot capture the machine: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_spare = std::move(buffer);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_pending = std::move(buffer);
+	memcpy(m_pendingSizes, sizes, sizeof(sizes));
+	m_pendingLength = saveme.GetCurrentPos();
+	m_cond.notify_all();
+}
+
+void RewindBuffer::WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	while (true)
+	{
+		m_cond.wait(lock, [this] { return m_quit || m_pending; });
+		if (m_quit)
+			return;
+
+		std::unique_ptr<VmStateBuffer> older(std::move(m_head));
+		RewindSnapshot snapshot;
+		memcpy(snapshot.sizes, m_headSizes, sizeof(snapshot.sizes));
+		snapshot.length = m_headLength;
+
+		m_head = std::move(m_pending);
+		memcpy(m_headSizes, m_pendingSizes, sizeof(m_headSizes));
+		m_headLength = m_pendingLength;
+
+		if (!older)
+		{
+			m_cond.notify_all();
+			continue;
+		}
+
+		// The head stays as is while packing: Step waits for the worker, and captures only
+		// touch the pending and spare buffers.
+		m_packing = true;
+		lock.unlock();
+
+		Rewind_Xor(older->GetPtr(), m_head->GetPtr(), std::min(snapshot.length, m_headLength));
+		const bool packed = Rewind_Pack(older->GetPtr(), snapshot.length, snapshot.packed);
+
+		lock.lock();
+		m_packing = false;
+		m_spare = std::move(older);
+
+		// Older snapshots can't be rebuilt without this one
+		if (!packed)
+		{
+			Console.Error("Rewind: cannot compress a snapshot, dropping the older ones.");
+			m_older.clear();
+		}
+		else
+		{
+			m_older.push_back(std::move(snapshot));
+			while (m_older.size() + 1 > std::max<u32>(EmuConfig.RewindSnapshots, 1))
+				m_older.pop_front();
+		}
+
+		m_cond.notify_all();
+	}
+}
+
+// Called with the core thread paused: loads the newest snapshot, and makes the one before it the
+// newest, so that the next step goes further back.  The oldest snapshot stays, once reached.
+bool RewindBuffer::Step()
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_cond.wait(lock, [this] { return !m_pending && !m_packing; });
+
+	if (!m_head)
+		return false;
+
+	RawSnapshot_FreezeIn(L"Rewind", m_head->GetPtr(), m_headSizes);
+	m_vsyncs = 0;
+
+	if (m_older.empty())
+		return true;
+
+	const RewindSnapshot& snapshot = m_older.back();
+	std::unique_ptr<VmStateBuffer> raw(std::move(m_spare));
+	if (!raw)
+		raw.reset(new VmStateBuffer(L"Rewind Snapshot"));
+	raw->MakeRoomFor(snapshot.length);
+
+	if (Rewind_Unpack(snapshot.packed, raw->GetPtr(), snapshot.length))
+	{
+		Rewind_Xor(raw->GetPtr(), m_head->GetPtr(), std::min(snapshot.length, m_headLength));
+		memcpy(m_headSizes, snapshot.sizes, sizeof(m_headSizes));
+		m_headLength = snapshot.length;
+		m_spare = std::move(m_head);
+		m_head = std::move(raw);
+		m_older.pop_back();
+	}
+	else
+	{
+		Console.Error("Rewind: a snapshot is corrupted, dropping the older ones.");
+		m_spare = std::move(raw);
+		m_older.clear();
+	}
+
+	return true;
+}
+
+void RewindBuffer::Reset()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_quit = true;
+		m_cond.notify_all();
+	}
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+	m_head.reset();
+	m_pending.reset();
+	m_spare.reset();
+	m_older.clear();
+	m_vsyncs = 0;
+}
+
+class SysExecEvent_Rewind : public SysExecEvent
+{
+public:
+	wxString GetEventName() const { return L"VM_Rewind"; }
+
+	virtual ~SysExecEvent_Rewind() = default;
+	SysExecEvent_Rewind* Clone() const { return new SysExecEvent_Rewind(*this); }
+
+protected:
+	void InvokeEvent()
+	{
+		ScopedCoreThreadPause paused_core;
+
+		if (SysHasValidState())
+		{
+			PatchesVerboseReset();
+			if (s_Rewind.Step())
+				OSDlog(Color_StrongGreen, true, "Rewound %u frames", EmuConfig.RewindFrames);
+			else
+				Console.WriteLn("Rewind: there is no snapshot yet.");
+		}
+
+		paused_core.AllowResume();
+	}
+};
+
+void Rewind_CaptureInThread()
+{
+	if (EmuConfig.EnableRewind)
+		s_Rewind.Capture();
+	else if (s_Rewind.IsActive())
+		s_Rewind.Reset();
+}
+
+void Rewind_ResetInThread()
+{
+	s_Rewind.Reset();
+}
+
+void Rewind_Step()
+{
+	if (EmuConfig.EnableRewind)
+		GetSysExecutorThread().PostEvent(new SysExecEvent_Rewind());
+}
+
+// =====================================================================================================
+//  Run-ahead
+// =====================================================================================================
+// Games react to the pad a frame or more after they read it.  Run-ahead hides that lag: at
+// each frame boundary the core thread saves the machine, emulates RunAheadFrames frames ahead
+// with the audio muted, and presents the last of them.  It then restores the machine and
+// emulates the next frame for real, with the audio but without presenting it.  Every frame
+// shown costs RunAheadFrames + 1 emulated frames, and a raw snapshot plus a restore.
+//
+// The boundaries are the state checks right after the vsyncs (see RunAhead_VsyncInThread),
+// out of the CPU execution.
+
+class RunAheadState
+{
+protected:
+	enum Phase
+	{
+		Phase_Off,   // frames are emulated and shown as usual
+		Phase_Ahead, // emulating the frames ahead of the saved machine
+		Phase_Real,  // emulating the frame after the saved machine, for real
+	};
+
+	Phase m_phase = Phase_Off;
+	uint m_remaining = 0; // frames left to run ahead
+	bool m_boundary = false;
+	bool m_failed = false;
+
+	std::unique_ptr<VmStateBuffer> m_state;
+	u32 m_sizes[RawSnapshotParts];
+	tlbs m_tlb[ArraySize(tlb)];
+
+public:
+	bool IsActive() const { return m_phase != Phase_Off; }
+
+	void Vsync();
+	void StateCheck(bool stopping);
+	void Reset();
+
+protected:
+	void Save();
+	void Restore();
+};
+
+static RunAheadState s_RunAhead;
+
+// Copies back the pages of a memory entry that changed since the snapshot.  The recompilers
+// drop the code of those pages: the EE ones on the write protection of the code, the others
+// through their Clear callbacks.
+static void RunAhead_RestoreMemory(u8* dest, const u8* src, uint size)
+{
+	for (uint offset = 0; offset < size; offset += __pagesize)
+	{
+		const uint len = std::min<uint>(__pagesize, size - offset);
+		if (memcmp(dest + offset, src + offset, len) == 0)
+			continue;
+
+		memcpy(dest + offset, src + offset, len);
+
+		if (dest == iopMem->Main)
+			psxCpu->Clear(offset, len / 4);
+		else if (dest == eeMem->Scratch)
+			Cpu->Clear(0x70000000 + offset, len / 4);
+		else if (dest == vuRegs[0].Micro)
+			CpuVU0->Clear(offset, len);
+		else if (dest == vuRegs[1].Micro)
+			CpuVU1->Clear(offset, len);
+	}
+}
+
+// Called by the core thread at every vsync, before the vsync is posted to the GS.
+void RunAheadState::Vsync()
+{
+	if (m_failed)
+		return;
+
+	if (m_phase == Phase_Ahead && --m_remaining > 0)
+		return;
+
+	// Only the last frame run ahead is presented
+	if (m_phase == Phase_Ahead)
+		GetCoreThread().SetRunAheadFrame(true, false);
+
+	m_boundary = true;
+	GetCoreThread().RequestStateCheckInThread();
+}
+
+void RunAheadState::StateCheck(bool stopping)
+{
+	if (m_phase == Phase_Ahead && (m_boundary || stopping))
+	{
+		// Pauses and savestates get the real machine, not the one ahead
+		Restore();
+		m_phase = Phase_Real;
+		GetCoreThread().SetRunAheadFrame(false, true);
+		SPU2setOutputMuted(false);
+	}
+	else if (m_boundary && !stopping)
+	{
+		if (!EmuConfig.EnableRunAhead || m_failed)
+		{
+			if (m_phase != Phase_Off)
+				Reset();
+		}
+		else
+		{
+			Save();
+		}
+	}
+
+	m_boundary = false;
+}
+
+void RunAheadState::Save()
+{
+	if (!m_state)
+		m_state.reset(new VmStateBuffer(L"RunAhead Snapshot"));
+
+	memSavingState saveme(*m_state);
+
+	try
+	{
+		RawSnapshot_FreezeOut(saveme, m_sizes);
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error(L"Run-ahead: cannot save the machine, disabled till the next reset: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		Reset();
+		m_failed = true;
+		return;
+	}
+
+	memcpy(m_tlb, tlb, sizeof(tlb));
+
+	m_phase = Phase_Ahead;
+	m_remaining = std::max<u32>(EmuConfig.RunAheadFrames, 1);
+	GetCoreThread().SetRunAheadFrame(true, true);
+	SPU2setOutputMuted(true);
+}
+
+// Unlike the other loads, the restore happens every frame, so it can't afford to recompile
+// everything: only the memory pages that changed are copied back.
+void RunAheadState::Restore()
+{
+	vu0Thread.WaitVU();
+	vu1Thread.WaitVU();
+
+	// A TLB remap changes what the recompiled code maps to, not just the code in a page
+	const bool remapped = memcmp(m_tlb, tlb, sizeof(tlb)) != 0;
+
+	uint pos = m_sizes[0];
+	for (uint i = 0; i < ArraySize(SavestateEntries); ++i)
+	{
+		const u8* data = m_state->GetPtr(pos);
+
+		if (const MemorySavestateEntry* memory = dynamic_cast<const MemorySavestateEntry*>(SavestateEntries[i].get()))
+		{
+			RunAhead_RestoreMemory(memory->GetDataPtr(), data, std::min<uint>(memory->GetDataSize(), m_sizes[i + 1]));
+		}
+		else
+		{
+			pxInputStream reader(L"RunAhead", new wxMemoryInputStream(data, m_sizes[i + 1]));
+			SavestateEntries[i]->FreezeIn(reader);
+		}
+
+		pos += m_sizes[i + 1];
+	}
+
+	// The internal structures lead the snapshot
+	memLoadingState(*m_state).FreezeBios().FreezeInternals();
+
+	if (remapped)
+		SysClearExecutionCache();
+}
+
+void RunAheadState::Reset()
+{
+	if (m_phase != Phase_Off)
+		SPU2setOutputMuted(false);
+
+	GetCoreThread().SetRunAheadFrame(false, false);
+	m_state.reset();
+	m_phase = Phase_Off;
+	m_remaining = 0;
+	m_boundary = false;
+	m_failed = false;
+}
+
+void RunAhead_VsyncInThread()
+{
+	if (EmuConfig.EnableRunAhead || s_RunAhead.IsActive())
+		s_RunAhead.Vsync();
+}
+
+void RunAhead_StateCheckInThread(bool stopping)
+{
+	s_RunAhead.StateCheck(stopping);
+}
+
+void RunAhead_ResetInThread()
+{
+	s_RunAhead.Reset();
+}
+
+#ifndef DISABLE_RECORDING
+// =====================================================================================================
+//  Input recording keyframes
+// =====================================================================================================
+// Every RecordingKeyframeFrames frames of an input recording, the core thread saves the machine as
+// a raw snapshot, and a worker thread compresses it like the rewind snapshots and appends it to a
+// file next to the recording.  Going to a frame then loads the last keyframe before it, and replays
+// at most RecordingKeyframeFrames frames.  The recording keeps the inputs of each frame at a fixed
+// offset and grows at its end, which is why the keyframes live in a file of their own.
+//
+// The file is a header, then the keyframes in frame order, each behind a record with its frame and
+// sizes.  Only the first count keyframes of the header are valid: recording over a frame drops the
+// keyframes after it, since they no longer match the inputs.
+
+struct KeyframeFileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 parts;
+	u32 count;
+};
+
+struct KeyframeRecord
+{
+	u32 frame;
+	u32 length;
+	u32 packed;
+	u32 sizes[RawSnapshotParts];
+};
+
+static const u32 KeyframeFileMagic = 0x4B4D3250; // P2MK
+
+class RecordingKeyframes
+{
+protected:
+	struct Keyframe
+	{
+		u32 frame;
+		wxFileOffset offset; // of the record
+	};
+
+	std::mutex m_lock;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+	bool m_quit = false;
+	bool m_writing = false;
+
+	wxString m_recording;
+	wxFFile m_file;
+	std::vector<Keyframe> m_index;
+	wxFileOffset m_end = 0; // where the next keyframe goes
+
+	// The capture waiting for the worker, and a buffer for the next one
+	std::unique_ptr<VmStateBuffer> m_pending;
+	std::unique_ptr<VmStateBuffer> m_spare;
+	KeyframeRecord m_pendingRecord;
+
+public:
+	virtual ~RecordingKeyframes() { Close(); }
+
+	void Vsync();
+	bool Seek(u32 target, s32 current, u32& frame);
+	void Close();
+
+protected:
+	void Open(const wxString& recording);
+	void Truncate(size_t count);
+	void WorkerThread();
+};
+
+static RecordingKeyframes s_RecordingKeyframes;
+
+void RecordingKeyframes::Open(const wxString& recording)
+{
+	Close();
+	m_recording = recording;
+
+	const wxString file(recording + L".keys");
+	KeyframeFileHeader header = {};
+	if (wxFileExists(file) && m_file.Open(file, L"r+b"))
+	{
+		if (m_file.Read(&header, sizeof(header)) != sizeof(header) || header.magic != KeyframeFileMagic ||
+			header.version != g_SaveVersion || header.parts != RawSnapshotParts)
+		{
+			Console.WriteLn(L"Keyframes of %s are out of date, starting over.", WX_STR(recording));
+			header.count = 0;
+		}
+
+		wxFileOffset offset = sizeof(header);
+		KeyframeRecord record;
+		while (m_index.size() < header.count && m_file.Seek(offset) && m_file.Read(&record, sizeof(record)) == sizeof(record))
+		{
+			m_index.push_back({record.frame, offset});
+			offset += sizeof(record) + record.packed;
+		}
+	}
+	else if (!m_file.Open(file, L"w+b"))
+	{
+		Console.Error(L"Cannot create the keyframes file %s", WX_STR(file));
+		return;
+	}
+
+	Truncate(m_index.size());
+	if (!m_index.empty())
+		Console.WriteLn(L"Loaded %zu keyframes of %s", m_index.size(), WX_STR(recording));
+}
+
+// Called with the worker idle
+void RecordingKeyframes::Truncate(size_t count)
+{
+	m_index.resize(count);
+	m_end = count ? m_index.back().offset : sizeof(KeyframeFileHeader);
+	if (count)
+	{
+		KeyframeRecord record;
+		m_file.Seek(m_end);
+		m_file.Read(&record, sizeof(record));
+		m_end += sizeof(record) + record.packed;
+	}
+
+	const KeyframeFileHeader header = {KeyframeFileMagic, g_SaveVersion, RawSnapshotParts, (u32)count};
+	m_file.Seek(0);
+	m_file.Write(&header, sizeof(header));
+	m_file.Flush();
+}
+
+// Called by the core thread, at every vsync.
+void RecordingKeyframes::Vsync()
+{
+	const u32 interval = EmuConfig.RecordingKeyframeFrames;
+	if (!interval || !g_InputRecording.IsActive() || g_InputRecording.GetFrameCounter() < 0)
+	{
+		if (!m_recording.IsEmpty())
+			Close();
+		return;
+	}
+
+	const wxString& recording = g_InputRecording.GetInputRecordingData().GetFilename();
+	if (recording != m_recording)
+		Open(recording);
+	if (!m_file.IsOpened())
+		return;
+
+	const u32 frame = g_InputRecording.GetFrameCounter();
+	std::unique_ptr<VmStateBuffer> buffer;
+	{
+		std::unique_lock<std::mutex> lock(m_lock);
+
+		if (g_InputRecording.IsRecording() && !m_index.empty() && m_index.back().frame >= frame)
+		{
+			m_cond.wait(lock, [this] { return !m_pending && !m_writing; });
+			size_t count = m_index.size();
+			while (count && m_index[count - 1].frame >= frame)
+				count--;
+			Truncate(count);
+		}
+
+		// Keyframes only ever go after the last one, replays past it fill them in
+		if (frame % interval || (!m_index.empty() && m_index.back().frame >= frame))
+			return;
+
+		// Skips the keyframe when the worker is behind, rather than hold up the game
+		if (m_pending)
+			return;
+
+		buffer = std::move(m_spare);
+		if (!m_thread.joinable())
+		{
+			m_quit = false;
+			m_thread = std::thread(&RecordingKeyframes::WorkerThread, this);
+		}
+	}
+
+	if (!buffer)
+		buffer.reset(new VmStateBuffer(L"Recording Keyframe"));
+
+	KeyframeRecord record = {};
+	record.frame = frame;
+	memSavingState saveme(*buffer);
+
+	try
+	{
+		RawSnapshot_FreezeOut(saveme, record.sizes);
+	}
+	catch (BaseException& ex)
+	{
+		Console.Error(L"Recording: cannot capture a keyframe: %s", WX_STR(ex.FormatDiagnosticMessage()));
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_spare = std::move(buffer);
+		return;
+	}
+
+	record.length = saveme.GetCurrentPos();
+
+	std::lock_guard<std::mutex> lock(m_lock);
+	m_pending = std::move(buffer);
+	m_pendingRecord = record;
+	m_cond.notify_all();
+}
+
+void RecordingKeyframes::WorkerThread()
+{
+	std::vector<u8> packed;
+	std::unique_lock<std::mutex> lock(m_lock);
+
+	while (true)
+	{
+		m_cond.wait(lock, [this] { return m_quit || m_pending; });
+		if (m_quit)
+			return;
+
+		std::unique_ptr<VmStateBuffer> raw(std::move(m_pending));
+		KeyframeRecord record = m_pendingRecord;
+		const wxFileOffset offset = m_end;
+		m_writing = true;
+		lock.unlock();
+
+		bool ok = Rewind_Pack(raw->GetPtr(), record.length, packed);
+		record.packed = packed.size();
+		ok = ok && m_file.Seek(offset) && m_file.Write(&record, sizeof(record)) == sizeof(record);
+		ok = ok && m_file.Write(packed.data(), packed.size()) == packed.size();
+
+		lock.lock();
+		m_writing = false;
+		m_spare = std::move(raw);
+
+		if (ok)
+		{
+			m_index.push_back({record.frame, offset});
+			m_end = offset + sizeof(record) + record.packed;
+
+			const u32 count = m_index.size();
+			m_file.Seek(offsetof(KeyframeFileHeader, count));
+			m_file.Write(&count, sizeof(count));
+			m_file.Flush();
+		}
+		else
+			Console.Error("Recording: cannot write the keyframe of frame %u.", record.frame);
+
+		m_cond.notify_all();
+	}
+}
+
+// Called with the core thread paused: loads the last keyframe at or before target.  Returns false,
+// with the machine untouched, if there is none, or if the machine at frame current is already past
+// it on the way to target.
+bool RecordingKeyframes::Seek(u32 target, s32 current, u32& frame)
+{
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_cond.wait(lock, [this] { return !m_pending && !m_writing; });
+
+	auto it = std::upper_bound(m_index.begin(), m_index.end(), target,
+		[](u32 frame, const Keyframe& keyframe) { return frame < keyframe.frame; });
+	if (!m_file.IsOpened() || it == m_index.begin())
+		return false;
+	--it;
+	if (current >= 0 && (u32)current <= target && it->frame <= (u32)current)
+		return false;
+
+	KeyframeRecord record;
+	std::vector<u8> packed;
+	if (!m_file.Seek(it->offset) || m_file.Read(&record, sizeof(record)) != sizeof(record))
+		return false;
+	packed.resize(record.packed);
+	if (m_file.Read(packed.data(), packed.size()) != packed.size())
+		return false;
+
+	std::unique_ptr<VmStateBuffer> raw(std::move(m_spare));
+	if (!raw)
+		raw.reset(new VmStateBuffer(L"Recording Keyframe"));
+	raw->MakeRoomFor(record.length);
+
+	const bool ok = Rewind_Unpack(packed, raw->GetPtr(), record.length);
+	if (ok)
+		RawSnapshot_FreezeIn(L"Recording Keyframe", raw->GetPtr(), record.sizes);
+	else
+		Console.Error("Recording: the keyframe of frame %u is corrupted.", record.frame);
+	m_spare = std::move(raw);
+
+	frame = record.frame;
+	return ok;
+}
+
+void RecordingKeyframes::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_quit = true;
+		m_cond.notify_all();
+	}
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+	m_pending.reset();
+	m_spare.reset();
+	m_index.clear();
+	m_end = 0;
+	m_file.Close();
+	m_recording.clear();
+}
+
+class SysExecEvent_RecordingSeek : public SysExecEvent
+{
+protected:
+	u32 m_target;
+
+public:
+	wxString GetEventName() const { return L"VM_RecordingSeek"; }
+
+	virtual ~SysExecEvent_RecordingSeek() = default;
+	SysExecEvent_RecordingSeek* Clone() const { return new SysExecEvent_RecordingSeek(*this); }
+
+	SysExecEvent_RecordingSeek(u32 target)
+		: m_target(target)
+	{
+	}
+
+protected:
+	void InvokeEvent()
+	{
+		ScopedCoreThreadPause paused_core;
+
+		if (SysHasValidState() && g_InputRecording.IsActive())
+		{
+			// Replays from where the machine is, when it's closer than the keyframe
+			const s32 current = g_InputRecording.GetFrameCounter();
+			u32 frame;
+			if (s_RecordingKeyframes.Seek(m_target, current, frame))
+				OSDlog(Color_StrongGreen, true, "Loaded the keyframe of frame %u", frame);
+			else if (current < 0 || (u32)current > m_target)
+			{
+				Console.WriteLn("Recording: there is no keyframe before frame %u, go to the first frame instead.", m_target);
+				paused_core.AllowResume();
+				return;
+			}
+
+			g_InputRecordingControls.SeekTo(m_target);
+		}
+
+		paused_core.AllowResume();
+	}
+};
+
+void RecordingKeyframes_VsyncInThread()
+{
+	s_RecordingKeyframes.Vsync();
+}
+
+void RecordingKeyframes_ResetInThread()
+{
+	s_RecordingKeyframes.Close();
+}
+
+void RecordingKeyframes_Seek(u32 frame)
+{
+	GetSysExecutorThread().PostEvent(new SysExecEvent_RecordingSeek(frame));
+}
+#endif
+
 // =====================================================================================================
 //  StateCopy Public Interface
 // =====================================================================================================
@@ -715,7 +2208,7 @@ void StateCopy_SaveToFile(const wxString& file)
 {
 	UI_DisableStateActions();
 
-	std::unique_ptr<ArchiveEntryList> ziplist(new ArchiveEntryList(new VmStateBuffer(L"Zippable Savestate")));
+	std::unique_ptr<ArchiveEntryList> ziplist(new ArchiveEntryList(VmStateArena_Acquire(L"Zippable Savestate")));
 
 	GetSysExecutorThread().PostEvent(new SysExecEvent_DownloadState(ziplist.get()));
 	GetSysExecutorThread().PostEvent(new SysExecEvent_ZipToDisk(ziplist.get(), file));
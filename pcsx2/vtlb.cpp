@@ -36,7 +36,9 @@
 #include "Cache.h"
 #include "R5900Exceptions.h"
 
-#include "Utilities/MemsetFast.inl"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
 
 using namespace R5900;
 using namespace vtlb_private;
@@ -55,6 +57,21 @@ static vtlbHandler UnmappedVirtHandler0;
 static vtlbHandler UnmappedVirtHandler1;
 static vtlbHandler UnmappedPhyHandler0;
 static vtlbHandler UnmappedPhyHandler1;
+static vtlbHandler WatchHandler;
+
+static sptr fastmem_shm = -1;
+static uptr fastmem_src = 0;
+static size_t fastmem_src_size = 0;
+
+static const size_t FASTMEM_WINDOW_SIZE = (size_t)_4gb + __pagesize; // guard page for reads at the very top
+
+// watched virtual pages, and the mapping they had before the watch handler took them over
+static std::unordered_map<u32, VTLBVirtual> watch_pages;
+static vtlbWatchFP* watch_callback = NULL;
+
+// Page ranges [first, end) remapped inside a vtlb_BeginRemap / vtlb_EndRemap batch.
+static int remap_depth = 0;
+static std::vector<std::pair<u32, u32>> remap_pending;
 
 vtlb_private::VTLBPhysical vtlb_private::VTLBPhysical::fromPointer(sptr ptr) {
 	pxAssertMsg(ptr >= 0, "Address too high");
@@ -78,34 +95,14 @@ vtlb_private::VTLBVirtual::VTLBVirtual(VTLBPhysical phys, u32 paddr, u32 vaddr)
 
 __inline int CheckCache(u32 addr)
 {
-	u32 mask;
-
 	if(((cpuRegs.CP0.n.Config >> 16) & 0x1) == 0) 
 	{
 		//DevCon.Warning("Data Cache Disabled! %x", cpuRegs.CP0.n.Config);
 		return false;//
 	}
 
-	for(int i = 1; i < 48; i++)
-	{
-		if (((tlb[i].EntryLo1 & 0x38) >> 3) == 0x3) {
-			mask  = tlb[i].PageMask;
-			
-			if ((addr >= tlb[i].PFN1) && (addr <= tlb[i].PFN1 + mask)) {
-				//DevCon.Warning("Yay! Cache check cache addr=%x, mask=%x, addr+mask=%x, VPN2=%x PFN0=%x", addr, mask, (addr & mask), tlb[i].VPN2, tlb[i].PFN0); 
-				return true;
-			}
-		}
-		if (((tlb[i].EntryLo0 & 0x38) >> 3) == 0x3) {
-			mask  = tlb[i].PageMask;
-			
-			if ((addr >= tlb[i].PFN0) && (addr <= tlb[i].PFN0 + mask)) {
-				//DevCon.Warning("Yay! Cache check cache addr=%x, mask=%x, addr+mask=%x, VPN2=%x PFN0=%x", addr, mask, (addr & mask), tlb[i].VPN2, tlb[i].PFN0); 
-				return true;
-			}
-		}
-	}
-	return false;
+	// The cached pages are tracked by cacheUpdatePages when the TLB is written
+	return cachePages[addr >> VTLB_PAGE_BITS];
 }
 // --------------------------------------------------------------------------------------
 // Interpreter Implementations of VTLB Memory Operations.
@@ -120,24 +117,21 @@ DataType __fastcall vtlb_memRead(u32 addr)
 
 	if (!vmv.isHandler(addr))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(addr)) 
 		{
-			if(CHECK_CACHE && CheckCache(addr)) 
+			switch( DataSize )
 			{
-				switch( DataSize )
-				{
-					case 8: 
-						return readCache8(addr);
-						break;
-					case 16: 
-						return readCache16(addr);
-						break;
-					case 32: 
-						return readCache32(addr);
-						break;
-
-					jNO_DEFAULT;
-				}
+				case 8: 
+					return readCache8(addr);
+					break;
+				case 16: 
+					return readCache16(addr);
+					break;
+				case 32: 
+					return readCache32(addr);
+					break;
+
+				jNO_DEFAULT;
 			}
 		}
 
@@ -170,12 +164,10 @@ void __fastcall vtlb_memRead64(u32 mem, mem64_t *out)
 
 	if (!vmv.isHandler(mem))
 	{
-		if (!CHECK_EEREC) {
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				*out = readCache64(mem);
-				return;
-			}
+		if(CHECK_CACHE && CheckCache(mem)) 
+		{
+			*out = readCache64(mem);
+			return;
 		}
 
 		*out = *(mem64_t*)vmv.assumePtr(mem);
@@ -194,14 +186,11 @@ void __fastcall vtlb_memRead128(u32 mem, mem128_t *out)
 
 	if (!vmv.isHandler(mem))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				out->lo = readCache64(mem);
-				out->hi = readCache64(mem+8);
-				return;
-			}
+			out->lo = readCache64(mem);
+			out->hi = readCache64(mem+8);
+			return;
 		}
 
 		CopyQWC(out,(void*)vmv.assumePtr(mem));
@@ -224,22 +213,19 @@ void __fastcall vtlb_memWrite(u32 addr, DataType data)
 
 	if (!vmv.isHandler(addr))
 	{		
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(addr)) 
 		{
-			if(CHECK_CACHE && CheckCache(addr)) 
+			switch( DataSize )
 			{
-				switch( DataSize )
-				{
-				case 8: 
-					writeCache8(addr, data);
-					return;
-				case 16:
-					writeCache16(addr, data);
-					return;
-				case 32:
-					writeCache32(addr, data);
-					return;
-				}
+			case 8: 
+				writeCache8(addr, data);
+				return;
+			case 16:
+				writeCache16(addr, data);
+				return;
+			case 32:
+				writeCache32(addr, data);
+				return;
 			}
 		}
 
@@ -260,13 +246,10 @@ void __fastcall vtlb_memWrite64(u32 mem, const mem64_t* value)
 
 	if (!vmv.isHandler(mem))
 	{		
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				writeCache64(mem, *value);
-				return;
-			}
+			writeCache64(mem, *value);
+			return;
 		}
 
 		*(mem64_t*)vmv.assumePtr(mem) = *value;
@@ -287,13 +270,10 @@ void __fastcall vtlb_memWrite128(u32 mem, const mem128_t *value)
 
 	if (!vmv.isHandler(mem))
 	{
-		if (!CHECK_EEREC) 
+		if(CHECK_CACHE && CheckCache(mem)) 
 		{
-			if(CHECK_CACHE && CheckCache(mem)) 
-			{
-				writeCache128(mem, value);
-				return;
-			}
+			writeCache128(mem, value);
+			return;
 		}
 
 		CopyQWC((void*)vmv.assumePtr(mem), value);
@@ -345,6 +325,7 @@ void __fastcall GoemonPreloadTlb()
 	// 0x3d5580 is the address of the TLB cache table
 	GoemonTlb* tlb = (GoemonTlb*)&eeMem->Main[0x3d5580];
 
+	vtlb_BeginRemap();
 	for (u32 i = 0; i < 150; i++) {
 		if (tlb[i].valid == 0x1 && tlb[i].low_add != tlb[i].high_add) {
 
@@ -362,6 +343,7 @@ void __fastcall GoemonPreloadTlb()
 			}
 		}
 	}
+	vtlb_EndRemap();
 }
 
 void __fastcall GoemonUnloadTlb(u32 key)
@@ -459,6 +441,66 @@ void __fastcall vtlbUnmappedPWriteSm(u32 addr,OperandType data)			{ vtlb_BusErro
 template<typename OperandType, u32 saddr>
 void __fastcall vtlbUnmappedPWriteLg(u32 addr,const OperandType* data)	{ vtlb_BusError(addr|saddr,1); }
 
+// --------------------------------------------------------------------------------------
+//  Memory watchpoint handlers
+// --------------------------------------------------------------------------------------
+// The watch handler is mapped with the virtual address as its physical one.  The page's own
+// mapping is put back for the duration of the access, so that cache emulation and the real
+// handlers see the vmap they expect, and the access is reported once it completed.
+
+static __fi VTLBVirtual vtlb_WatchEntry(u32 page)
+{
+	const u32 vaddr = page << VTLB_PAGE_BITS;
+	return VTLBVirtual(VTLBPhysical::fromHandler(WatchHandler), vaddr, vaddr);
+}
+
+template<typename Op>
+static __fi void vtlb_WatchAccess(u32 addr, u32 size, bool write, Op op)
+{
+	const u32 page = addr >> VTLB_PAGE_BITS;
+
+	vtlbdata.vmap[page] = watch_pages.find(page)->second;
+	op();
+	vtlbdata.vmap[page] = vtlb_WatchEntry(page);
+
+	if (watch_callback)
+		watch_callback(addr, size, write);
+}
+
+template<typename OperandType>
+static OperandType __fastcall vtlbWatchReadSm(u32 addr)
+{
+	OperandType data;
+	vtlb_WatchAccess(addr, sizeof(OperandType), false, [&] { data = vtlb_memRead<OperandType>(addr); });
+	return data;
+}
+
+template<typename OperandType>
+static void __fastcall vtlbWatchWriteSm(u32 addr, OperandType data)
+{
+	vtlb_WatchAccess(addr, sizeof(OperandType), true, [&] { vtlb_memWrite<OperandType>(addr, data); });
+}
+
+static void __fastcall vtlbWatchRead64(u32 addr, mem64_t* data)
+{
+	vtlb_WatchAccess(addr, sizeof(*data), false, [&] { vtlb_memRead64(addr, data); });
+}
+
+static void __fastcall vtlbWatchRead128(u32 addr, mem128_t* data)
+{
+	vtlb_WatchAccess(addr, sizeof(*data), false, [&] { vtlb_memRead128(addr, data); });
+}
+
+static void __fastcall vtlbWatchWrite64(u32 addr, const mem64_t* data)
+{
+	vtlb_WatchAccess(addr, sizeof(*data), true, [&] { vtlb_memWrite64(addr, data); });
+}
+
+static void __fastcall vtlbWatchWrite128(u32 addr, const mem128_t* data)
+{
+	vtlb_WatchAccess(addr, sizeof(*data), true, [&] { vtlb_memWrite128(addr, data); });
+}
+
 // --------------------------------------------------------------------------------------
 //  VTLB mapping errors
 // --------------------------------------------------------------------------------------
@@ -651,6 +693,18 @@ __fi void* vtlb_GetPhyPtr(u32 paddr)
 		return reinterpret_cast<void*>(vtlbdata.pmap[paddr>>VTLB_PAGE_BITS].assumePtr()+(paddr&VTLB_PAGE_MASK));
 }
 
+__fi void* vtlb_GetVirtPtr(u32 vaddr)
+{
+	if (vtlbdata.vmap == NULL)
+		return NULL;
+
+	const VTLBVirtual vmv = vtlbdata.vmap[vaddr>>VTLB_PAGE_BITS];
+	if (vmv.isHandler(vaddr))
+		return NULL;
+	else
+		return reinterpret_cast<void*>(vmv.assumePtr(vaddr));
+}
+
 __fi u32 vtlb_V2P(u32 vaddr)
 {
 	u32 paddr = vtlbdata.ppmap[vaddr>>VTLB_PAGE_BITS];
@@ -658,6 +712,203 @@ __fi u32 vtlb_V2P(u32 vaddr)
 	return paddr;
 }
 
+// Returns the offset in the fastmem shared memory of the given virtual page, or -1 if the
+// page isn't backed by it (handlers, memory outside of the shared block).
+static sptr vtlb_Fastmem_Offset(u32 page)
+{
+	const u32 vaddr = page << VTLB_PAGE_BITS;
+	const VTLBVirtual vmv = vtlbdata.vmap[page];
+
+	if (vmv.isHandler(vaddr))
+		return -1;
+
+	const uptr ptr = vmv.assumePtr(vaddr);
+	if (ptr < fastmem_src || ptr >= fastmem_src + fastmem_src_size)
+		return -1;
+
+	return ptr - fastmem_src;
+}
+
+// Mirrors the vmap of pages [page, page + count) into the fastmem window, coalescing
+// contiguous pages into a single mapping.
+static void vtlb_Fastmem_Update(u32 page, u32 count)
+{
+	if (!vtlbdata.fastmem)
+		return;
+
+	const u32 end = page + count;
+	while (page < end)
+	{
+		const sptr offset = vtlb_Fastmem_Offset(page);
+
+		u32 next = page + 1;
+		while (next < end)
+		{
+			const sptr expected = offset < 0 ? -1 : offset + ((sptr)(next - page) << VTLB_PAGE_BITS);
+			if (vtlb_Fastmem_Offset(next) != expected)
+				break;
+			next++;
+		}
+
+		u8* dst = vtlbdata.fastmem + ((uptr)page << VTLB_PAGE_BITS);
+		const size_t len = (size_t)(next - page) << VTLB_PAGE_BITS;
+
+		// If the view can't be mapped the pages stay inaccessible, and the recompiler loads
+		// get patched to the vtlb lookup.
+		if (offset < 0 || !HostSys::MapSharedMemory(fastmem_shm, offset, dst, len, PageAccess_ReadOnly()))
+			HostSys::MmapResetPtr(dst, len);
+
+		page = next;
+	}
+}
+
+void vtlb_Fastmem_Bind(sptr shm, void* base, size_t size)
+{
+	vtlb_Fastmem_Unbind();
+
+	void* window = HostSys::MmapReservePtr(NULL, FASTMEM_WINDOW_SIZE);
+	if (!window || window == (void*)-1)
+	{
+		Console.Warning("(vtlb) Can't reserve the fastmem window, recompiled loads use the vtlb.");
+		HostSys::DestroySharedMemory(shm);
+		return;
+	}
+
+	fastmem_shm = shm;
+	fastmem_src = (uptr)base;
+	fastmem_src_size = size;
+	vtlbdata.fastmem = (u8*)window;
+
+	if (vtlbdata.vmap)
+	{
+		vtlb_Fastmem_Update(0, VTLB_VMAP_ITEMS / 2);
+		vtlb_Fastmem_Update(VTLB_VMAP_ITEMS / 2, VTLB_VMAP_ITEMS / 2);
+	}
+}
+
+void vtlb_Fastmem_Unbind()
+{
+	if (vtlbdata.fastmem)
+	{
+		HostSys::Munmap((uptr)vtlbdata.fastmem, FASTMEM_WINDOW_SIZE);
+		vtlbdata.fastmem = NULL;
+	}
+
+	HostSys::DestroySharedMemory(fastmem_shm);
+	fastmem_shm = -1;
+	fastmem_src = 0;
+	fastmem_src_size = 0;
+}
+
+// Puts the watched pages among [page, page + count) back on the watch handler after they
+// got remapped, keeping their new mapping for the accesses.
+static void vtlb_WatchRemap(u32 page, u32 count)
+{
+	for (auto& watch : watch_pages)
+	{
+		if (watch.first - page >= count)
+			continue;
+
+		watch.second = vtlbdata.vmap[watch.first];
+		vtlbdata.vmap[watch.first] = vtlb_WatchEntry(watch.first);
+	}
+}
+
+// Refreshes the watches and the fastmem window of pages [page, page + count) after their vmap
+// entries changed, or queues them for vtlb_EndRemap while a batch is open.
+static void vtlb_Remapped(u32 page, u32 count)
+{
+	if (remap_depth > 0)
+	{
+		remap_pending.emplace_back(page, page + count);
+		return;
+	}
+
+	vtlb_WatchRemap(page, count);
+	vtlb_Fastmem_Update(page, count);
+}
+
+void vtlb_BeginRemap()
+{
+	remap_depth++;
+}
+
+void vtlb_EndRemap()
+{
+	pxAssert(remap_depth > 0);
+	if (--remap_depth > 0 || remap_pending.empty())
+		return;
+
+	// A TLB write unmaps and then maps the same pages, and neighbouring entries usually
+	// cover adjacent pages, so merge the ranges to update each page once and let the
+	// fastmem update coalesce them into as few mappings as possible.
+	std::sort(remap_pending.begin(), remap_pending.end());
+
+	u32 first = remap_pending[0].first;
+	u32 end = remap_pending[0].second;
+	for (size_t i = 1; i < remap_pending.size(); i++)
+	{
+		if (remap_pending[i].first > end)
+		{
+			vtlb_WatchRemap(first, end - first);
+			vtlb_Fastmem_Update(first, end - first);
+			first = remap_pending[i].first;
+		}
+		end = std::max(end, remap_pending[i].second);
+	}
+	vtlb_WatchRemap(first, end - first);
+	vtlb_Fastmem_Update(first, end - first);
+
+	remap_pending.clear();
+}
+
+void vtlb_SetWatchCallback(vtlbWatchFP* callback)
+{
+	watch_callback = callback;
+}
+
+// Watches all pages overlapping [vaddr, vaddr + size).  The recompilers resolve constant
+// addresses against the vmap, so their cache has to be cleared after changing the watches.
+void vtlb_Watch(u32 vaddr, u32 size)
+{
+	if (size == 0)
+		return;
+
+	const u32 first = vaddr >> VTLB_PAGE_BITS;
+	const u32 last = (vaddr + (size - 1)) >> VTLB_PAGE_BITS;
+
+	for (u32 page = first; page - first <= last - first; page++)
+	{
+		if (watch_pages.count(page))
+			continue;
+
+		// without a vmap yet the page gets its mapping when vtlb_Init sets the space up
+		if (!vtlbdata.vmap)
+		{
+			watch_pages[page] = VTLBVirtual();
+			continue;
+		}
+
+		watch_pages[page] = vtlbdata.vmap[page];
+		vtlbdata.vmap[page] = vtlb_WatchEntry(page);
+		vtlb_Fastmem_Update(page, 1);
+	}
+}
+
+void vtlb_ClearWatches()
+{
+	if (vtlbdata.vmap)
+	{
+		for (const auto& watch : watch_pages)
+		{
+			vtlbdata.vmap[watch.first] = watch.second;
+			vtlb_Fastmem_Update(watch.first, 1);
+		}
+	}
+
+	watch_pages.clear();
+}
+
 //virtual mappings
 //TODO: Add invalid paddr checks
 void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
@@ -666,6 +917,9 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 	verify(0==(paddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 page = vaddr >> VTLB_PAGE_BITS;
+	const u32 count = size >> VTLB_PAGE_BITS;
+
 	while (size > 0)
 	{
 		VTLBVirtual vmv;
@@ -688,6 +942,8 @@ void vtlb_VMap(u32 vaddr,u32 paddr,u32 size)
 		paddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_Remapped(page, count);
 }
 
 void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
@@ -695,6 +951,9 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 page = vaddr >> VTLB_PAGE_BITS;
+	const u32 count = size >> VTLB_PAGE_BITS;
+
 	uptr bu8 = (uptr)buffer;
 	while (size > 0)
 	{
@@ -703,6 +962,8 @@ void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 size)
 		bu8 += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_Remapped(page, count);
 }
 
 void vtlb_VMapUnmap(u32 vaddr,u32 size)
@@ -710,6 +971,9 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 	verify(0==(vaddr&VTLB_PAGE_MASK));
 	verify(0==(size&VTLB_PAGE_MASK) && size>0);
 
+	const u32 page = vaddr >> VTLB_PAGE_BITS;
+	const u32 count = size >> VTLB_PAGE_BITS;
+
 	while (size > 0)
 	{
 
@@ -724,6 +988,8 @@ void vtlb_VMapUnmap(u32 vaddr,u32 size)
 		vaddr += VTLB_PAGE_SIZE;
 		size -= VTLB_PAGE_SIZE;
 	}
+
+	vtlb_Remapped(page, count);
 }
 
 // vtlb_Init -- Clears vtlb handlers and memory mappings.
@@ -752,6 +1018,11 @@ void vtlb_Init()
 
 	DefaultPhyHandler = vtlb_RegisterHandler(0,0,0,0,0,0,0,0,0,0);
 
+	// The watched pages survive the reset, the unmapping below puts them back on the handler.
+	WatchHandler = vtlb_RegisterHandler(
+		vtlbWatchReadSm<mem8_t>, vtlbWatchReadSm<mem16_t>, vtlbWatchReadSm<mem32_t>, vtlbWatchRead64, vtlbWatchRead128,
+		vtlbWatchWriteSm<mem8_t>, vtlbWatchWriteSm<mem16_t>, vtlbWatchWriteSm<mem32_t>, vtlbWatchWrite64, vtlbWatchWrite128);
+
 	//done !
 
 	//Setup the initial mappings
@@ -774,7 +1045,9 @@ void vtlb_Init()
 // This function should probably be part of the COP0 rather than here in VTLB.
 void vtlb_Reset()
 {
+	vtlb_BeginRemap();
 	for(int i=0; i<48; i++) UnmapTLB(i);
+	vtlb_EndRemap();
 }
 
 void vtlb_Term()
@@ -871,7 +1144,7 @@ void VtlbMemoryReserve::Commit()
 void VtlbMemoryReserve::Reset()
 {
 	Commit();
-	memzero_sse_a(m_reserve.GetPtr(), m_reserve.GetCommittedBytes());
+	memset_stream(m_reserve.GetPtr(), 0, m_reserve.GetCommittedBytes());
 }
 
 void VtlbMemoryReserve::Decommit()
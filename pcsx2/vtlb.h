@@ -74,6 +74,8 @@ extern void vtlb_ReassignHandler( vtlbHandler rv,
 extern void vtlb_MapHandler(vtlbHandler handler,u32 start,u32 size);
 extern void vtlb_MapBlock(void* base,u32 start,u32 size,u32 blocksize=0);
 extern void* vtlb_GetPhyPtr(u32 paddr);
+// Host pointer for a virtual address, or NULL if accesses to its page go through a handler
+extern void* vtlb_GetVirtPtr(u32 vaddr);
 //extern void vtlb_Mirror(u32 new_region,u32 start,u32 size); // -> not working yet :(
 extern u32  vtlb_V2P(u32 vaddr);
 extern void vtlb_DynV2P();
@@ -83,6 +85,27 @@ extern void vtlb_VMap(u32 vaddr,u32 paddr,u32 sz);
 extern void vtlb_VMapBuffer(u32 vaddr,void* buffer,u32 sz);
 extern void vtlb_VMapUnmap(u32 vaddr,u32 sz);
 
+// batched remapping: the vmap is always updated right away, but between vtlb_BeginRemap and
+// vtlb_EndRemap the watch and fastmem updates of the remapped pages are deferred, and done once
+// for the merged page ranges when the outermost batch ends.  Close the batch before the EE
+// touches memory again.
+extern void vtlb_BeginRemap();
+extern void vtlb_EndRemap();
+
+// memory watchpoints: the watched virtual pages are remapped to a handler which performs the
+// access through the page's own mapping, and then reports it to the watch callback.  All other
+// pages keep their direct mapping, so watching costs nothing outside of the watched pages.
+typedef void __fastcall vtlbWatchFP(u32 addr, u32 size, bool write);
+
+extern void vtlb_SetWatchCallback(vtlbWatchFP* callback);
+extern void vtlb_Watch(u32 vaddr, u32 size);
+extern void vtlb_ClearWatches();
+
+// fastmem: mirrors every page the vmap points into the given shared memory at the matching
+// offset of a 4GB window (see vtlbdata.fastmem).  Takes ownership of the shared memory.
+extern void vtlb_Fastmem_Bind(sptr shm, void* base, size_t size);
+extern void vtlb_Fastmem_Unbind();
+
 //Memory functions
 
 template< typename DataType >
@@ -103,6 +126,11 @@ extern void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const );
 extern void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const );
 
+extern void vtlb_DynGenFastmemThunks();
+extern void vtlb_MapFastmemThunks();
+extern void vtlb_ResetFastmem();
+extern void vtlb_ShutdownFastmem();
+
 // --------------------------------------------------------------------------------------
 //  VtlbMemoryReserve
 // --------------------------------------------------------------------------------------
@@ -120,6 +148,8 @@ public:
 	virtual void Reset();
 	virtual void Decommit();
 
+	void SetHugePages(HugePageMode mode) { m_reserve.SetHugePages(mode); }
+
 	bool IsCommitted() const;
 };
 
@@ -252,10 +282,15 @@ namespace vtlb_private
 
 		u32* ppmap;               //4MB (allocated by vtlb_init) // PS2 virtual to PS2 physical
 
+		// 4GB host view of the PS2 virtual space, only the pages backed by direct memory are
+		// accessible.  NULL when the host can't alias memory.
+		u8* fastmem;
+
 		MapData()
 		{
 			vmap = NULL;
 			ppmap = NULL;
+			fastmem = NULL;
 		}
 	};
 
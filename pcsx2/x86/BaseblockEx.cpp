@@ -19,11 +19,9 @@
 
 BASEBLOCKEX* BaseBlocks::New(u32 startpc, uptr fnptr)
 {
-	std::pair<linkiter_t, linkiter_t> range = links.equal_range(startpc);
-	for (linkiter_t i = range.first; i != range.second; ++i)
-		*(u32*)i->second = fnptr - (i->second + 4);
-	
-	return blocks.insert(startpc, fnptr);;
+	Redirect(startpc, fnptr);
+
+	return blocks.insert(startpc, fnptr);
 }
 
 int BaseBlocks::LastIndex(u32 startpc) const
@@ -36,7 +34,7 @@ int BaseBlocks::LastIndex(u32 startpc) const
 	while(imin != imax) {
 		imid = (imin+imax+1)>>1;
 
-		if (blocks[imid].startpc > startpc)
+		if (blocks.startpc(imid) > startpc)
 			imax = imid - 1;
 		else
 			imin = imid;
@@ -74,9 +72,9 @@ void BaseBlocks::Link(u32 pc, s32* jumpptr)
 {
 	BASEBLOCKEX *targetblock = Get(pc);
 	if (targetblock && targetblock->startpc == pc)
-		*jumpptr = (s32)(targetblock->fnptr - (sptr)(jumpptr + 1));
+		*jumpptr = (s32)((targetblock->suspended ? verifier : targetblock->fnptr) - (sptr)(jumpptr + 1));
 	else
 		*jumpptr = (s32)(recompiler - (sptr)(jumpptr + 1));
-	links.insert(std::pair<u32, uptr>(pc, (uptr)jumpptr));
+	links[pc >> 12].push_back({pc, (uptr)jumpptr});
 }
 
@@ -15,7 +15,8 @@
 
 #pragma once
 
-#include <map>			// used by BaseBlockEx
+#include <unordered_map>	// used by BaseBlocks
+#include <vector>
 
 // Every potential jump point in the PS2's addressable memory has a BASEBLOCK
 // associated with it. So that means a BASEBLOCK for every 4 bytes of PS2
@@ -36,6 +37,13 @@ struct BASEBLOCKEX
 	u16  size;	 // The size in dwords (equivalent to the number of instructions)
 	u16  x86size; // The size in byte of the translated x86 instructions
 
+	// Liveness summary of the GPRs on entry (see recBlockLiveness)
+	u32  gpr_in;   // may be read before being written
+	u32  gpr_kill; // always written before being read
+
+	u64  hash; // of the code of the block, for Recompiler.LazySmcEE
+	bool suspended; // entered through the verifier until its code is checked
+
 #ifdef PCSX2_DEVBUILD
 	// Could be useful to instrument the block
 	//u32 visited; // number of times called
@@ -44,19 +52,33 @@ struct BASEBLOCKEX
 
 };
 
+// A jump to the start of a block, patched when the block is compiled, suspended or cleared
+struct BASEBLOCKLINK
+{
+	u32  pc;
+	uptr jumpptr;
+};
+
 class BaseBlockArray {
 	s32 _Reserved;
 	s32 _Size;
+	// The start pcs are also kept apart from the rest of the block info, so the searches
+	// only walk a compact array of them.
+	u32 *startpcs;
 	BASEBLOCKEX *blocks;
 
 	__fi void resize(s32 size)
 	{
 		pxAssert(size > 0);
+		u32 *newPcs = new u32[size];
 		BASEBLOCKEX *newMem = new BASEBLOCKEX[size];
 		if(blocks) {
+			memcpy(newPcs, startpcs, _Reserved * sizeof(u32));
 			memcpy(newMem, blocks, _Reserved * sizeof(BASEBLOCKEX));
+			delete[] startpcs;
 			delete[] blocks;
 		}
+		startpcs = newPcs;
 		blocks = newMem;
 		pxAssert(blocks != NULL);
 	}
@@ -70,12 +92,13 @@ public:
 	~BaseBlockArray()
 	{
 		if(blocks) {
+			delete[] startpcs;
 			delete[] blocks;
 		}
 	}
 
 	BaseBlockArray (s32 size) : _Reserved(0),
-		_Size(0), blocks(NULL)
+		_Size(0), startpcs(NULL), blocks(NULL)
 	{
 		reserve(size);
 	}
@@ -92,20 +115,22 @@ public:
 		while (imin < imax) {
 			imid = (imin+imax)>>1;
 
-			if (blocks[imid].startpc > startpc)
+			if (startpcs[imid] > startpc)
 				imax = imid;
 			else
 				imin = imid + 1;
 		}
 	
-		pxAssert(imin == _Size || blocks[imin].startpc > startpc);
+		pxAssert(imin == _Size || startpcs[imin] > startpc);
 
 		if(imin < _Size) {
 			// make a hole for a new block.
+			memmove(startpcs + imin + 1, startpcs + imin, (_Size - imin) * sizeof(u32));
 			memmove(blocks + imin + 1, blocks + imin, (_Size - imin) * sizeof(BASEBLOCKEX));
 		}
 
 		memset((blocks + imin), 0, sizeof(BASEBLOCKEX));
+		startpcs[imin] = startpc;
 		blocks[imin].startpc = startpc;
 		blocks[imin].fnptr = fnptr;
 
@@ -118,6 +143,11 @@ public:
 		return *(blocks + idx);
 	}
 
+	__fi u32 startpc(int idx) const
+	{
+		return startpcs[idx];
+	}
+
 	void clear()
 	{
 		_Size = 0;
@@ -133,6 +163,7 @@ public:
 		int range = last - first;
 
 		if(last < _Size) {
+			memmove(startpcs + first, startpcs + last, (_Size - last) * sizeof(u32));
 			memmove(blocks + first, blocks + last, (_Size - last) * sizeof(BASEBLOCKEX));
 		}
 
@@ -143,16 +174,38 @@ public:
 class BaseBlocks
 {
 protected:
-	typedef std::multimap<u32, uptr>::iterator linkiter_t;
-
-	// switch to a hash map later?
-	std::multimap<u32, uptr> links;
+	// The links are bucketed by the 4k page of their target.  The blocks of a page are
+	// usually cleared together, which then walks one short array.
+	std::unordered_map<u32, std::vector<BASEBLOCKLINK>> links;
 	uptr recompiler;
+	uptr verifier;
 	BaseBlockArray blocks;
 
+	// Points the links to the pcs from lo to hi, in the same page, at target
+	__fi void Redirect(u32 lo, u32 hi, uptr target)
+	{
+		pxAssert((lo >> 12) == (hi >> 12));
+
+		auto bucket = links.find(lo >> 12);
+		if (bucket == links.end())
+			return;
+
+		for (const BASEBLOCKLINK& link : bucket->second)
+		{
+			if (link.pc >= lo && link.pc <= hi)
+				*(u32*)link.jumpptr = target - (link.jumpptr + 4);
+		}
+	}
+
+	__fi void Redirect(u32 pc, uptr target)
+	{
+		Redirect(pc, pc, target);
+	}
+
 public:
 	BaseBlocks() :
 		recompiler(0)
+	,	verifier(0)
 	,	blocks(0x4000)
 	{
 	}
@@ -162,6 +215,11 @@ public:
 		recompiler = (uptr)recompiler_;
 	}
 
+	void SetJITVerify( void (*verifier_)() )
+	{
+		verifier = (uptr)verifier_;
+	}
+
 	BASEBLOCKEX* New(u32 startpc, uptr fnptr);
 	int LastIndex (u32 startpc) const;
 	//BASEBLOCKEX* GetByX86(uptr ip);
@@ -170,8 +228,8 @@ public:
 	{
 		int idx = LastIndex(startpc);
 
-		if ((idx == -1) || (startpc < blocks[idx].startpc) ||
-			((blocks[idx].size) && (startpc >= blocks[idx].startpc + blocks[idx].size * 4)))
+		if ((idx == -1) || (startpc < blocks.startpc(idx)) ||
+			((blocks[idx].size) && (startpc >= blocks.startpc(idx) + blocks[idx].size * 4)))
 			return -1;
 		else
 			return idx;
@@ -193,16 +251,23 @@ public:
 	__fi void Remove(int first, int last)
 	{
 		pxAssert(first <= last);
+
+		// No block but the removed ones starts between their pcs, and the links to pcs
+		// without a block already go to the recompiler.  So all the links to the pcs the
+		// range spans go back to it, one page bucket at a time.
 		int idx = first;
 		do{
-			pxAssert(idx <= last);
+			const u32 lo = blocks.startpc(idx);
+			while (idx < last && (blocks.startpc(idx + 1) >> 12) == (lo >> 12))
+				idx++;
 
-			//u32 startpc = blocks[idx].startpc;
-			std::pair<linkiter_t, linkiter_t> range = links.equal_range(blocks[idx].startpc);
-			for (linkiter_t i = range.first; i != range.second; ++i)
-				*(u32*)i->second = recompiler - (i->second + 4);
+			Redirect(lo, blocks.startpc(idx), recompiler);
+		}
+		while(idx++ < last);
 
-			if( IsDevBuild )
+		if( IsDevBuild )
+		{
+			for (idx = first; idx <= last; idx++)
 			{
 				// Clear the first instruction to 0xcc (breakpoint), as a way to assert if some
 				// static jumps get left behind to this block.  Note: Do not clear more than the
@@ -213,12 +278,24 @@ public:
 				memset( (void*)effu.fnptr, 0xcc, 1 );
 			}
 		}
-		while(idx++ < last);
 
 		// TODO: remove links from this block?
 		blocks.erase(first, last + 1);
 	}
 
+	// Sends the links to the block to the verifier, and back.
+	__fi void Suspend(BASEBLOCKEX* block)
+	{
+		block->suspended = true;
+		Redirect(block->startpc, verifier);
+	}
+
+	__fi void Resume(BASEBLOCKEX* block)
+	{
+		block->suspended = false;
+		Redirect(block->startpc, block->fnptr);
+	}
+
 	void Link(u32 pc, s32* jumpptr);
 
 	__fi void Reset()
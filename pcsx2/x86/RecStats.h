@@ -0,0 +1,67 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+
+// Time spent recompiling, and the size of the code generated, per recompiler.  The headless
+// benchmark mode reports them (see gui/Benchmark.cpp), so changes to the recompilers can be
+// measured for their compile cost on a savestate or an input recording.
+struct RecompileStats
+{
+	std::atomic<u64> blocks{0};
+	std::atomic<u64> ticks{0}; // GetCPUTicks()
+	std::atomic<u64> bytes{0};
+};
+
+extern RecompileStats g_eeRecStats;
+extern RecompileStats g_iopRecStats;
+extern RecompileStats g_vuRecStats[2];
+
+// Counts a block, and adds the time of the scope and how far codePtr moved.  Blocks compiled
+// from within another one (microVU branches) only add to the outer one's time and size.
+class RecompileStatsScope
+{
+public:
+	RecompileStatsScope(RecompileStats& stats, u8* const& codePtr)
+		: m_stats(stats)
+		, m_codePtr(codePtr)
+		, m_start(codePtr)
+		, m_begin(s_depth++ ? 0 : GetCPUTicks())
+	{
+		m_stats.blocks.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	~RecompileStatsScope()
+	{
+		if (--s_depth)
+			return;
+		m_stats.ticks.fetch_add(GetCPUTicks() - m_begin, std::memory_order_relaxed);
+		// a reset of the code cache while compiling moves the pointer back
+		if (m_codePtr > m_start)
+			m_stats.bytes.fetch_add(m_codePtr - m_start, std::memory_order_relaxed);
+	}
+
+	RecompileStatsScope(const RecompileStatsScope&) = delete;
+	RecompileStatsScope& operator=(const RecompileStatsScope&) = delete;
+
+private:
+	static inline thread_local int s_depth = 0;
+
+	RecompileStats& m_stats;
+	u8* const& m_codePtr;
+	u8* m_start;
+	u64 m_begin;
+};
@@ -225,9 +225,11 @@ void recMTC1()
 	{
 		_deleteFPtoXMMreg(_Fs_, 0);
 		xMOV(ptr32[&fpuRegs.fpr[ _Fs_ ].UL], g_cpuConstRegs[_Rt_].UL[0]);
+		FPR_SET_FINITE(_Fs_, (g_cpuConstRegs[_Rt_].UL[0] & 0x7f800000) != 0x7f800000);
 	}
 	else
 	{
+		FPR_DEL_FINITE(_Fs_);
 		int mmreg = _checkXMMreg(XMMTYPE_GPRREG, _Rt_, MODE_READ);
 
 		if( mmreg >= 0 )
@@ -346,6 +348,19 @@ __fi void fpuFloat2(int regd) { // +NaN -> +fMax, -NaN -> -fMax, +Inf -> +fMax,
 void ClampValues(int regd) {
 	fpuFloat(regd);
 }
+
+// Clamps of an operand holding the register fpr, skipped if it is known to be finite
+__fi void fpuFloat(int regd, int fpr) {
+	if (!FPR_IS_FINITE(fpr)) fpuFloat(regd);
+}
+
+__fi void fpuFloat2(int regd, int fpr) {
+	if (!FPR_IS_FINITE(fpr)) fpuFloat2(regd);
+}
+
+__fi void fpuFloat3(int regd, int fpr) {
+	if (!FPR_IS_FINITE(fpr)) fpuFloat3(regd);
+}
 //------------------------------------------------------------------
 
 
@@ -361,8 +376,10 @@ void recABS_S_xmm(int info)
 	xAND.PS(xRegisterSSE(EEREC_D), ptr[&s_pos[0]]);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
 
-	if (CHECK_FPU_OVERFLOW) // Only need to do positive clamp, since EEREC_D is positive
+	if (CHECK_FPU_OVERFLOW && !FPR_IS_FINITE(_Fs_)) // Only need to do positive clamp, since EEREC_D is positive
 		xMIN.SS(xRegisterSSE(EEREC_D), ptr[&g_maxvals[0]]);
+
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW || FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(ABS_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -535,35 +552,35 @@ int recCommutativeOp(int info, int regd, int op)
 		case PROCESS_EE_S:
 			if (regd == EEREC_S) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW  /*&& !CHECK_FPUCLAMPHACK */ || (op >= 2)) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW  /*&& !CHECK_FPUCLAMPHACK */ || (op >= 2)) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				recComOpXMM_to_XMM[op](regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				recComOpXMM_to_XMM_REV[op](regd, EEREC_S);
 			}
 			break;
 		case PROCESS_EE_T:
 			if (regd == EEREC_T) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Ft_); fpuFloat2(t0reg, _Fs_); }
 				recComOpXMM_to_XMM_REV[op](regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				recComOpXMM_to_XMM[op](regd, EEREC_T);
 			}
 			break;
 		case (PROCESS_EE_S|PROCESS_EE_T):
 			if (regd == EEREC_T) {
-				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				recComOpXMM_to_XMM_REV[op](regd, EEREC_S);
 			}
 			else {
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				recComOpXMM_to_XMM[op](regd, EEREC_T);
 			}
 			break;
@@ -571,7 +588,7 @@ int recCommutativeOp(int info, int regd, int op)
 			Console.WriteLn(Color_Magenta, "FPU: recCommutativeOp case 4");
 			xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
 			xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-			if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd); fpuFloat2(t0reg); }
+			if (CHECK_FPU_EXTRA_OVERFLOW || (op >= 2)) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 			recComOpXMM_to_XMM[op](regd, t0reg);
 			break;
 	}
@@ -590,6 +607,7 @@ void recADD_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::ADD_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
     ClampValues(recCommutativeOp(info, EEREC_D, 0));
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 	//REC_FPUOP(ADD_S);
 }
 
@@ -600,6 +618,7 @@ void recADDA_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::ADDA_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
     ClampValues(recCommutativeOp(info, EEREC_ACC, 0));
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 FPURECOMPILE_CONSTCODE(ADDA_S, XMMINFO_WRITEACC|XMMINFO_READS|XMMINFO_READT);
@@ -664,30 +683,30 @@ void recC_EQ_xmm(int info)
 
 	switch(info & (PROCESS_EE_S|PROCESS_EE_T) ) {
 		case PROCESS_EE_S:
-			fpuFloat3(EEREC_S);
+			fpuFloat3(EEREC_S, _Fs_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Ft_);
 				xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(t0reg));
 				_freeXMMreg(t0reg);
 			}
 			else xUCOMI.SS(xRegisterSSE(EEREC_S), ptr[&fpuRegs.fpr[_Ft_]]);
 			break;
 		case PROCESS_EE_T:
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_T, _Ft_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Fs_);
 				xUCOMI.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
 				_freeXMMreg(t0reg);
 			}
 			else xUCOMI.SS(xRegisterSSE(EEREC_T), ptr[&fpuRegs.fpr[_Fs_]]);
 			break;
 		case (PROCESS_EE_S|PROCESS_EE_T):
-			fpuFloat3(EEREC_S);
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_S, _Fs_);
+			fpuFloat3(EEREC_T, _Ft_);
 			xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(EEREC_T));
 			break;
 		default:
@@ -735,22 +754,22 @@ void recC_LE_xmm(int info )
 
 	switch(info & (PROCESS_EE_S|PROCESS_EE_T) ) {
 		case PROCESS_EE_S:
-			fpuFloat3(EEREC_S);
+			fpuFloat3(EEREC_S, _Fs_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Ft_);
 				xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(t0reg));
 				_freeXMMreg(t0reg);
 			}
 			else xUCOMI.SS(xRegisterSSE(EEREC_S), ptr[&fpuRegs.fpr[_Ft_]]);
 			break;
 		case PROCESS_EE_T:
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_T, _Ft_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Fs_);
 				xUCOMI.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
 				_freeXMMreg(t0reg);
 			}
@@ -767,8 +786,8 @@ void recC_LE_xmm(int info )
 			}
 			break;
 		case (PROCESS_EE_S|PROCESS_EE_T):
-			fpuFloat3(EEREC_S);
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_S, _Fs_);
+			fpuFloat3(EEREC_T, _Ft_);
 			xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(EEREC_T));
 			break;
 		default: // Untested and incorrect, but this case is never reached AFAIK (cottonvibes)
@@ -809,22 +828,22 @@ void recC_LT_xmm(int info)
 
 	switch(info & (PROCESS_EE_S|PROCESS_EE_T) ) {
 		case PROCESS_EE_S:
-			fpuFloat3(EEREC_S);
+			fpuFloat3(EEREC_S, _Fs_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Ft_);
 				xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(t0reg));
 				_freeXMMreg(t0reg);
 			}
 			else xUCOMI.SS(xRegisterSSE(EEREC_S), ptr[&fpuRegs.fpr[_Ft_]]);
 			break;
 		case PROCESS_EE_T:
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_T, _Ft_);
 			t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 			if (t0reg >= 0) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				fpuFloat3(t0reg);
+				fpuFloat3(t0reg, _Fs_);
 				xUCOMI.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
 				_freeXMMreg(t0reg);
 			}
@@ -843,8 +862,8 @@ void recC_LT_xmm(int info)
 		case (PROCESS_EE_S|PROCESS_EE_T):
 			// Clamp NaNs
 			// Note: This fixes a crash in Rule of Rose.
-			fpuFloat3(EEREC_S);
-			fpuFloat3(EEREC_T);
+			fpuFloat3(EEREC_S, _Fs_);
+			fpuFloat3(EEREC_T, _Ft_);
 			xUCOMI.SS(xRegisterSSE(EEREC_S), xRegisterSSE(EEREC_T));
 			break;
 		default:
@@ -889,6 +908,8 @@ void recCVT_S_xmm(int info)
 	else {
 		xCVTDQ2PS(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_S));
 	}
+
+	g_fpuFiniteResult = true;
 }
 
 FPURECOMPILE_CONSTCODE(CVT_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -908,7 +929,7 @@ void recCVT_W()
 
 	if( regs >= 0 )
 	{
-		if (CHECK_FPU_EXTRA_OVERFLOW) fpuFloat2(regs);
+		if (CHECK_FPU_EXTRA_OVERFLOW) fpuFloat2(regs, _Fs_);
 		xCVTTSS2SI(eax, xRegisterSSE(regs));
 		xMOVMSKPS(edx, xRegisterSSE(regs));	//extract the signs
 		xAND(edx, 1);				//keep only LSB
@@ -922,6 +943,7 @@ void recCVT_W()
 
 	//kill register allocation for dst because we write directly to fpuRegs.fpr[_Fd_]
 	_deleteFPtoXMMreg(_Fd_, 2);
+	FPR_DEL_FINITE(_Fd_);
 
 	xADD(edx, 0x7FFFFFFF);	//0x7FFFFFFF if positive, 0x8000 0000 if negative
 
@@ -975,7 +997,7 @@ void recDIVhelper1(int regd, int regt) // Sets flags
 	x86SetJ32(ajmp32);
 
 	/*--- Normal Divide ---*/
-	if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(regt); }
+	if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(regt, _Ft_); }
 	xDIV.SS(xRegisterSSE(regd), xRegisterSSE(regt));
 
 	ClampValues(regd);
@@ -987,7 +1009,7 @@ void recDIVhelper1(int regd, int regt) // Sets flags
 
 void recDIVhelper2(int regd, int regt) // Doesn't sets flags
 {
-	if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(regt); }
+	if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(regt, _Ft_); }
 	xDIV.SS(xRegisterSSE(regd), xRegisterSSE(regt));
 	ClampValues(regd);
 }
@@ -1074,6 +1096,7 @@ void recDIV_S_xmm(int info)
 	}
 	if (roundmodeFlag) xLDMXCSR (g_sseMXCSR);
 	_freeXMMreg(t0reg);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 FPURECOMPILE_CONSTCODE(DIV_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
@@ -1081,11 +1104,56 @@ FPURECOMPILE_CONSTCODE(DIV_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
 
 
 
+//------------------------------------------------------------------
+// FMA XMM (MADD/MSUB without clamping)
+//------------------------------------------------------------------
+// When enabled (Recompiler.fpuFusedMAdd, off by default) and with no clamping, the
+// accumulation is done by a single fused multiply-add: the product isn't rounded on
+// its own, and FPU_ADD_SUB's guard bit emulation is skipped. The results can differ
+// from the PS2's in the last bit, so it is an opt-in speed/accuracy trade.
+//------------------------------------------------------------------
+#define FPU_FUSED_MADD (CHECK_FPU_FUSED_MADD && x86caps.hasFMA && !CHECK_FPU_OVERFLOW)
+
+void recFMAtemp(int info, int regd, bool issub)
+{
+	const xImplSimd_FMA& fma = issub ? xVFNMADD231 : xVFMADD231;
+	int t0reg = _allocTempXMMreg(XMMT_FPS, -1);
+
+	if (info & PROCESS_EE_ACC) xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC));
+	else xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
+
+	switch(info & (PROCESS_EE_S|PROCESS_EE_T) ) {
+		case PROCESS_EE_S:
+			fma.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S), ptr[&fpuRegs.fpr[_Ft_]]);
+			break;
+		case PROCESS_EE_T:
+			fma.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T), ptr[&fpuRegs.fpr[_Fs_]]);
+			break;
+		case (PROCESS_EE_S|PROCESS_EE_T):
+			fma.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S), xRegisterSSE(EEREC_T));
+			break;
+		default:
+			xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
+			fma.SS(xRegisterSSE(t0reg), xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Ft_]]);
+			break;
+	}
+
+	xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
+	_freeXMMreg(t0reg);
+}
+//------------------------------------------------------------------
+
+
 //------------------------------------------------------------------
 // MADD XMM
 //------------------------------------------------------------------
 void recMADDtemp(int info, int regd)
 {
+	if (FPU_FUSED_MADD) {
+		recFMAtemp(info, regd, false);
+		return;
+	}
+
 	int t1reg;
 	int t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 
@@ -1093,36 +1161,36 @@ void recMADDtemp(int info, int regd)
 		case PROCESS_EE_S:
 			if(regd == EEREC_S) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(regd); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC, XMMFPU_ACC); fpuFloat(regd); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
 			else if (regd == EEREC_ACC){
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_S); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_S, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_ADD(regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(regd); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC, XMMFPU_ACC); fpuFloat(regd); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
@@ -1130,85 +1198,85 @@ void recMADDtemp(int info, int regd)
 		case PROCESS_EE_T:
 			if(regd == EEREC_T) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(t0reg, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(regd); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC, XMMFPU_ACC); fpuFloat(regd); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
 			else if (regd == EEREC_ACC){
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_T); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_T, _Ft_); fpuFloat2(t0reg, _Fs_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_ADD(regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(regd); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC, XMMFPU_ACC); fpuFloat(regd); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(EEREC_ACC); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
 			break;
 		case (PROCESS_EE_S|PROCESS_EE_T):
 			if(regd == EEREC_S) {
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC, XMMFPU_ACC); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
 			else if(regd == EEREC_T) {
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC, XMMFPU_ACC); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
 			else if(regd == EEREC_ACC) {
 				xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_ADD(regd, t0reg);
 			}
 			else {
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC, XMMFPU_ACC); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
@@ -1218,9 +1286,9 @@ void recMADDtemp(int info, int regd)
 				t1reg = _allocTempXMMreg(XMMT_FPS, -1);
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
 				xMOVSSZX(xRegisterSSE(t1reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg); fpuFloat2(t1reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg, _Fs_); fpuFloat2(t1reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(t1reg));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_ADD(regd, t0reg);
 				_freeXMMreg(t1reg);
 			}
@@ -1228,15 +1296,15 @@ void recMADDtemp(int info, int regd)
 			{
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC) {
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(EEREC_ACC, XMMFPU_ACC); }
 					FPU_ADD(regd, EEREC_ACC);
 				}
 				else {
 					xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]);
-					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+					if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 					FPU_ADD(regd, t0reg);
 				}
 			}
@@ -1245,6 +1313,7 @@ void recMADDtemp(int info, int regd)
 
      ClampValues(regd);
 	 _freeXMMreg(t0reg);
+	 g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 void recMADD_S_xmm(int info)
@@ -1275,6 +1344,7 @@ void recMAX_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::MAX_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
     recCommutativeOp(info, EEREC_D, 2);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW || (FPR_IS_FINITE(_Fs_) && FPR_IS_FINITE(_Ft_));
 }
 
 FPURECOMPILE_CONSTCODE(MAX_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
@@ -1284,6 +1354,7 @@ void recMIN_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::MIN_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
     recCommutativeOp(info, EEREC_D, 3);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW || (FPR_IS_FINITE(_Fs_) && FPR_IS_FINITE(_Ft_));
 }
 
 FPURECOMPILE_CONSTCODE(MIN_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
@@ -1298,6 +1369,8 @@ void recMOV_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::MOV_F);
 	if( info & PROCESS_EE_S ) xMOVSS(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_S));
 	else xMOVSSZX(xRegisterSSE(EEREC_D), ptr[&fpuRegs.fpr[_Fs_]]);
+
+	g_fpuFiniteResult = FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(MOV_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -1309,6 +1382,11 @@ FPURECOMPILE_CONSTCODE(MOV_S, XMMINFO_WRITED|XMMINFO_READS);
 //------------------------------------------------------------------
 void recMSUBtemp(int info, int regd)
 {
+	if (FPU_FUSED_MADD) {
+		recFMAtemp(info, regd, true);
+		return;
+	}
+
 int t1reg;
 	int t0reg = _allocTempXMMreg(XMMT_FPS, -1);
 
@@ -1316,28 +1394,28 @@ int t1reg;
 		case PROCESS_EE_S:
 			if(regd == EEREC_S) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
 			else if (regd == EEREC_ACC){
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_S); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_S, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_SUB(regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
@@ -1345,65 +1423,65 @@ int t1reg;
 		case PROCESS_EE_T:
 			if(regd == EEREC_T) {
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(t0reg, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
 			else if (regd == EEREC_ACC){
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_T); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(EEREC_T, _Ft_); fpuFloat2(t0reg, _Fs_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_SUB(regd, t0reg);
 			}
 			else {
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
 			break;
 		case (PROCESS_EE_S|PROCESS_EE_T):
 			if(regd == EEREC_S) {
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
 			else if(regd == EEREC_T) {
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_S); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Ft_); fpuFloat2(EEREC_S, _Fs_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
 			else if(regd == EEREC_ACC) {
 				xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_SUB(regd, t0reg);
 			}
 			else {
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(EEREC_S));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(EEREC_T); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(EEREC_T, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(EEREC_T));
 				if (info & PROCESS_EE_ACC) { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
@@ -1413,9 +1491,9 @@ int t1reg;
 				t1reg = _allocTempXMMreg(XMMT_FPS, -1);
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Fs_]]);
 				xMOVSSZX(xRegisterSSE(t1reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg); fpuFloat2(t1reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(t0reg, _Fs_); fpuFloat2(t1reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(t0reg), xRegisterSSE(t1reg));
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd, XMMFPU_ACC); fpuFloat(t0reg); }
 				FPU_SUB(regd, t0reg);
 				_freeXMMreg(t1reg);
 			}
@@ -1423,11 +1501,11 @@ int t1reg;
 			{
 				xMOVSSZX(xRegisterSSE(regd), ptr[&fpuRegs.fpr[_Fs_]]);
 				xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.fpr[_Ft_]]);
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd); fpuFloat2(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat2(regd, _Fs_); fpuFloat2(t0reg, _Ft_); }
 				xMUL.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 				if (info & PROCESS_EE_ACC)  { xMOVSS(xRegisterSSE(t0reg), xRegisterSSE(EEREC_ACC)); }
 				else { xMOVSSZX(xRegisterSSE(t0reg), ptr[&fpuRegs.ACC]); }
-				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg); }
+				if (CHECK_FPU_EXTRA_OVERFLOW) { fpuFloat(regd); fpuFloat(t0reg, XMMFPU_ACC); }
 				FPU_SUB(t0reg, regd);
 				xMOVSS(xRegisterSSE(regd), xRegisterSSE(t0reg));
 			}
@@ -1436,6 +1514,7 @@ int t1reg;
 
      ClampValues(regd);
 	 _freeXMMreg(t0reg);
+	 g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 
 }
 
@@ -1467,6 +1546,7 @@ void recMUL_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::MUL_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
     ClampValues(recCommutativeOp(info, EEREC_D, 1));
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 FPURECOMPILE_CONSTCODE(MUL_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
@@ -1476,6 +1556,7 @@ void recMULA_S_xmm(int info)
 	EE::Profiler.EmitOp(eeOpcode::MULA_F);
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
 	ClampValues(recCommutativeOp(info, EEREC_ACC, 1));
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 FPURECOMPILE_CONSTCODE(MULA_S, XMMINFO_WRITEACC|XMMINFO_READS|XMMINFO_READT);
@@ -1492,7 +1573,9 @@ void recNEG_S_xmm(int info) {
 
 	//xAND(ptr32[&fpuRegs.fprc[31]], ~(FPUflagO|FPUflagU)); // Clear O and U flags
 	xXOR.PS(xRegisterSSE(EEREC_D), ptr[&s_neg[0]]);
-	ClampValues(EEREC_D);
+	fpuFloat(EEREC_D, _Fs_);
+
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW || FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(NEG_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -1504,7 +1587,7 @@ FPURECOMPILE_CONSTCODE(NEG_S, XMMINFO_WRITED|XMMINFO_READS);
 //------------------------------------------------------------------
 void recSUBhelper(int regd, int regt)
 {
-	if (CHECK_FPU_EXTRA_OVERFLOW /*&& !CHECK_FPUCLAMPHACK*/) { fpuFloat2(regd); fpuFloat2(regt); }
+	if (CHECK_FPU_EXTRA_OVERFLOW /*&& !CHECK_FPUCLAMPHACK*/) { fpuFloat2(regd, _Fs_); fpuFloat2(regt, _Ft_); }
 	FPU_SUB(regd, regt);
 }
 
@@ -1555,6 +1638,7 @@ void recSUBop(int info, int regd)
 
 	ClampValues(regd);
 	_freeXMMreg(t0reg);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 void recSUB_S_xmm(int info)
@@ -1616,11 +1700,12 @@ void recSQRT_S_xmm(int info)
 	}
 	else xAND.PS(xRegisterSSE(EEREC_D), ptr[&s_pos[0]]); // Make EEREC_D Positive
 
-	if (CHECK_FPU_OVERFLOW) xMIN.SS(xRegisterSSE(EEREC_D), ptr[&g_maxvals[0]]);// Only need to do positive clamp, since EEREC_D is positive
+	if (CHECK_FPU_OVERFLOW && !FPR_IS_FINITE(_Ft_)) xMIN.SS(xRegisterSSE(EEREC_D), ptr[&g_maxvals[0]]);// Only need to do positive clamp, since EEREC_D is positive
 	xSQRT.SS(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_D));
 	if (CHECK_FPU_EXTRA_OVERFLOW) ClampValues(EEREC_D); // Shouldn't need to clamp again since SQRT of a number will always be smaller than the original number, doing it just incase :/
 
 	if (roundmodeFlag) xLDMXCSR (g_sseMXCSR);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW || FPR_IS_FINITE(_Ft_);
 }
 
 FPURECOMPILE_CONSTCODE(SQRT_S, XMMINFO_WRITED|XMMINFO_READT);
@@ -1673,8 +1758,8 @@ void recRSQRThelper1(int regd, int t0reg) // Preforms the RSQRT function when re
 	x86SetJ8(pjmp1);
 
 	if (CHECK_FPU_EXTRA_OVERFLOW) {
-		xMIN.SS(xRegisterSSE(t0reg), ptr[&g_maxvals[0]]); // Only need to do positive clamp, since t0reg is positive
-		fpuFloat2(regd);
+		if (!FPR_IS_FINITE(_Ft_)) xMIN.SS(xRegisterSSE(t0reg), ptr[&g_maxvals[0]]); // Only need to do positive clamp, since t0reg is positive
+		fpuFloat2(regd, _Fs_);
 	}
 
 	xSQRT.SS(xRegisterSSE(t0reg), xRegisterSSE(t0reg));
@@ -1691,8 +1776,8 @@ void recRSQRThelper2(int regd, int t0reg) // Preforms the RSQRT function when re
 {
 	xAND.PS(xRegisterSSE(t0reg), ptr[&s_pos[0]]); // Make t0reg Positive
 	if (CHECK_FPU_EXTRA_OVERFLOW) {
-		xMIN.SS(xRegisterSSE(t0reg), ptr[&g_maxvals[0]]); // Only need to do positive clamp, since t0reg is positive
-		fpuFloat2(regd);
+		if (!FPR_IS_FINITE(_Ft_)) xMIN.SS(xRegisterSSE(t0reg), ptr[&g_maxvals[0]]); // Only need to do positive clamp, since t0reg is positive
+		fpuFloat2(regd, _Fs_);
 	}
 	xSQRT.SS(xRegisterSSE(t0reg), xRegisterSSE(t0reg));
 	xDIV.SS(xRegisterSSE(regd), xRegisterSSE(t0reg));
@@ -1739,6 +1824,7 @@ void recRSQRT_S_xmm(int info)
 			break;
 	}
 	_freeXMMreg(t0reg);
+	g_fpuFiniteResult = CHECK_FPU_OVERFLOW;
 }
 
 FPURECOMPILE_CONSTCODE(RSQRT_S, XMMINFO_WRITED|XMMINFO_READS|XMMINFO_READT);
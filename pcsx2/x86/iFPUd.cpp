@@ -140,9 +140,16 @@ static const __aligned(32) FPUd_Globals s_const =
 
 
 // ToDouble : converts single-precision PS2 float to double-precision IEEE float
+// (a value known to be IEEE finite, see FPR_IS_FINITE, is simply converted)
 
-void ToDouble(int reg)
+void ToDouble(int reg, bool finite = false)
 {
+	if (finite)
+	{
+		xCVTSS2SD(xRegisterSSE(reg), xRegisterSSE(reg));
+		return;
+	}
+
 	xUCOMI.SS(xRegisterSSE(reg), ptr[s_const.pos_inf]); // Sets ZF if reg is equal or incomparable to pos_inf
 	u8 *to_complex = JE8(0); // Complex conversion if positive infinity or NaN
 	xUCOMI.SS(xRegisterSSE(reg), ptr[s_const.neg_inf]);
@@ -322,6 +329,8 @@ void recABS_S_xmm(int info)
 	CLEAR_OU_FLAGS;
 
 	xAND.PS(xRegisterSSE(EEREC_D), ptr[s_const.pos]);
+
+	g_fpuFiniteResult = FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(ABS_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -420,7 +429,7 @@ void FPU_MUL(int info, int regd, int sreg, int treg, bool acc)
 		x86SetJ8(noHack);
 	}
 
-	ToDouble(sreg); ToDouble(treg);
+	ToDouble(sreg, FPR_IS_FINITE(_Fs_)); ToDouble(treg, FPR_IS_FINITE(_Ft_));
 	xMUL.SD(xRegisterSSE(sreg), xRegisterSSE(treg));
 	ToPS2FPU(sreg, true, treg, acc);
 	xMOVSS(xRegisterSSE(regd), xRegisterSSE(sreg));
@@ -443,7 +452,7 @@ void recFPUOp(int info, int regd, int op, bool acc)
 	if (FPU_CORRECT_ADD_SUB)
 		FPU_ADD_SUB(sreg, treg);
 
-	ToDouble(sreg); ToDouble(treg);
+	ToDouble(sreg, FPR_IS_FINITE(_Fs_)); ToDouble(treg, FPR_IS_FINITE(_Ft_));
 
 	recFPUOpXMM_to_XMM[op](sreg, treg);
 
@@ -479,7 +488,7 @@ void recCMP(int info)
 {
 	int sreg, treg;
 	ALLOC_S(sreg); ALLOC_T(treg);
-	ToDouble(sreg); ToDouble(treg);
+	ToDouble(sreg, FPR_IS_FINITE(_Fs_)); ToDouble(treg, FPR_IS_FINITE(_Ft_));
 
 	xUCOMI.SD(xRegisterSSE(sreg), xRegisterSSE(treg));
 
@@ -548,6 +557,8 @@ void recCVT_S_xmm(int info)
 	else {
 		xCVTDQ2PS(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_S));
 	}
+
+	g_fpuFiniteResult = true;
 }
 
 FPURECOMPILE_CONSTCODE(CVT_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -572,6 +583,7 @@ void recCVT_W() //called from iFPU.cpp's recCVT_W
 
 	//kill register allocation for dst because we write directly to fpuRegs.fpr[_Fd_]
 	_deleteFPtoXMMreg(_Fd_, 2);
+	FPR_DEL_FINITE(_Fd_);
 
 	xADD(edx, 0x7FFFFFFF);	//0x7FFFFFFF if positive, 0x8000 0000 if negative
 
@@ -623,7 +635,7 @@ void recDIVhelper1(int regd, int regt) // Sets flags
 	x86SetJ32(ajmp32);
 
 	//--- Normal Divide ---
-	ToDouble(regd); ToDouble(regt);
+	ToDouble(regd, FPR_IS_FINITE(_Fs_)); ToDouble(regt, FPR_IS_FINITE(_Ft_));
 
 	xDIV.SD(xRegisterSSE(regd), xRegisterSSE(regt));
 
@@ -637,7 +649,7 @@ void recDIVhelper1(int regd, int regt) // Sets flags
 
 void recDIVhelper2(int regd, int regt) // Doesn't sets flags
 {
-	ToDouble(regd); ToDouble(regt);
+	ToDouble(regd, FPR_IS_FINITE(_Fs_)); ToDouble(regt, FPR_IS_FINITE(_Ft_));
 
 	xDIV.SD(xRegisterSSE(regd), xRegisterSSE(regt));
 
@@ -728,7 +740,7 @@ void recMaddsub(int info, int regd, int op, bool acc)
 
 	xTEST(ptr32[&fpuRegs.ACCflag], 1);
 	u8 *accovf = JNZ8(0);
-	ToDouble(treg); //else, convert
+	ToDouble(treg, FPR_IS_FINITE(XMMFPU_ACC)); //else, convert
 	u8 *operation = JMP8(0);
 
 	x86SetJ8(mulovf);
@@ -810,6 +822,9 @@ void recMINMAX(int info, bool ismin)
 	xMOVSS(xRegisterSSE(EEREC_D), xRegisterSSE(sreg));
 
 	_freeXMMreg(sreg); _freeXMMreg(treg);
+
+	// the result is one of the operands
+	g_fpuFiniteResult = FPR_IS_FINITE(_Fs_) && FPR_IS_FINITE(_Ft_);
 }
 
 void recMAX_S_xmm(int info)
@@ -837,6 +852,8 @@ void recMOV_S_xmm(int info)
 {
 	EE::Profiler.EmitOp(eeOpcode::MOV_F);
 	GET_S(EEREC_D);
+
+	g_fpuFiniteResult = FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(MOV_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -904,6 +921,8 @@ void recNEG_S_xmm(int info)
 	CLEAR_OU_FLAGS;
 
 	xXOR.PS(xRegisterSSE(EEREC_D), ptr[&s_const.neg[0]]);
+
+	g_fpuFiniteResult = FPR_IS_FINITE(_Fs_);
 }
 
 FPURECOMPILE_CONSTCODE(NEG_S, XMMINFO_WRITED|XMMINFO_READS);
@@ -974,7 +993,7 @@ void recSQRT_S_xmm(int info)
 	}
 
 
-	ToDouble(EEREC_D);
+	ToDouble(EEREC_D, FPR_IS_FINITE(_Ft_));
 
 	xSQRT.SD(xRegisterSSE(EEREC_D), xRegisterSSE(EEREC_D));
 
@@ -986,6 +1005,9 @@ void recSQRT_S_xmm(int info)
 
 	_freeX86reg(tempReg);
 	_freeXMMreg(t1reg);
+
+	// the square root of the largest PS2 value is far below the IEEE maximum
+	g_fpuFiniteResult = true;
 }
 
 FPURECOMPILE_CONSTCODE(SQRT_S, XMMINFO_WRITED|XMMINFO_READT);
@@ -1036,7 +1058,7 @@ void recRSQRThelper1(int regd, int regt) // Preforms the RSQRT function when reg
 		pjmp32 = JMP32(0);
 	x86SetJ8(pjmp1);
 
-	ToDouble(regt); ToDouble(regd);
+	ToDouble(regt, FPR_IS_FINITE(_Ft_)); ToDouble(regd, FPR_IS_FINITE(_Fs_));
 
 	xSQRT.SD(xRegisterSSE(regt), xRegisterSSE(regt));
 	xDIV.SD(xRegisterSSE(regd), xRegisterSSE(regt));
@@ -1052,7 +1074,7 @@ void recRSQRThelper2(int regd, int regt) // Preforms the RSQRT function when reg
 {
 	xAND.PS(xRegisterSSE(regt), ptr[&s_const.pos[0]]); // Make regt Positive
 
-	ToDouble(regt); ToDouble(regd);
+	ToDouble(regt, FPR_IS_FINITE(_Ft_)); ToDouble(regd, FPR_IS_FINITE(_Fs_));
 
 	xSQRT.SD(xRegisterSSE(regt), xRegisterSSE(regt));
 	xDIV.SD(xRegisterSSE(regd), xRegisterSSE(regt));
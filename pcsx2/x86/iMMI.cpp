@@ -1385,7 +1385,24 @@ void recPEXTUH()
 	_clearNeededXMMregs();
 }
 
-static __aligned16 u32 tempqw[8];
+// pshufb masks taking bytes sa..15 of rt (lo) and bytes 0..sa-1 of rs (hi)
+// into place, the funnel shift is then pshufb(rt, lo) | pshufb(rs, hi)
+static struct QFSRVShuffle
+{
+	__aligned16 u8 mask[16][2][16];
+
+	QFSRVShuffle()
+	{
+		for (int sa = 0; sa < 16; sa++)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				mask[sa][0][i] = (i + sa < 16) ? (i + sa) : 0x80;
+				mask[sa][1][i] = (i + sa < 16) ? 0x80 : (i + sa - 16);
+			}
+		}
+	}
+} s_qfsrv_shuffle;
 
 void recQFSRV()
 {
@@ -1406,13 +1423,23 @@ void recQFSRV()
 	}
 		
 	int info = eeRecompileCodeXMM( XMMINFO_READS | XMMINFO_READT | XMMINFO_WRITED );
+	int t0reg = _allocTempXMMreg(XMMT_INT, -1);
+	int t1reg = _allocTempXMMreg(XMMT_INT, -1);
 
+	// shuffle both halves in registers rather than storing them and reloading
+	// across the two stores, which misses store forwarding
 	xMOV(eax, ptr32[&cpuRegs.sa]);
-	xLEA(rcx, ptr[tempqw]);
-	xMOVDQA(ptr32[rcx], xRegisterSSE(EEREC_T));
-	xMOVDQA(ptr32[rcx+16], xRegisterSSE(EEREC_S));
-	xMOVDQU(xRegisterSSE(EEREC_D), ptr32[rax + rcx]);
+	xSHL(eax, 5);
+	xLEA(rcx, ptr[s_qfsrv_shuffle.mask]);
+	xMOVDQA(xRegisterSSE(t0reg), xRegisterSSE(EEREC_T));
+	xMOVDQA(xRegisterSSE(t1reg), xRegisterSSE(EEREC_S));
+	xPSHUF.B(xRegisterSSE(t0reg), ptr128[rax + rcx]);
+	xPSHUF.B(xRegisterSSE(t1reg), ptr128[rax + rcx + 16]);
+	xPOR(xRegisterSSE(t0reg), xRegisterSSE(t1reg));
+	xMOVDQA(xRegisterSSE(EEREC_D), xRegisterSSE(t0reg));
 
+	_freeXMMreg(t1reg);
+	_freeXMMreg(t0reg);
 	_clearNeededXMMregs();
 }
 
@@ -1845,12 +1872,63 @@ void recPMULTW()
 	_clearNeededXMMregs();
 }
 ////////////////////////////////////////////////////
+// Divides the two low words of a by the two low words of b into q.
+// The quotient of two s32 is exact once truncated from a double, and both
+// 0x80000000 / -1 and x / 0 convert to 0x80000000. The first is what the EE
+// returns, the second is patched to (a < 0) ? 1 : -1 by recPDIV_FixZero. tmp
+// is clobbered, the remainder is a - q * b in both cases.
+static void recPDIV_Quotient(int qreg, int areg, int breg, int tmpreg)
+{
+	const xRegisterSSE q(qreg), a(areg), b(breg), tmp(tmpreg);
+
+	xCVTDQ2PD(q, a);
+	xCVTDQ2PD(tmp, b);
+	xDIV.PD(q, tmp);
+	xCVTTPD2DQ(q, q);
+}
+
+static void recPDIV_FixZero(int qreg, int areg, int breg, int t0reg, int t1reg)
+{
+	const xRegisterSSE q(qreg), a(areg), b(breg), t0(t0reg), t1(t1reg);
+
+	// t0 = (b == 0), t1 = ((u32)a >> 31) * 2 - 1 where b == 0
+	xPXOR(t0, t0);
+	xPCMP.EQD(t0, b);
+	xMOVDQA(t1, a);
+	xPSRL.D(t1, 31);
+	xPADD.D(t1, t1);
+	xPADD.D(t1, t0);
+	xPAND(t1, t0);
+	xPANDN(t0, q);
+	xPOR(t0, t1);
+	xMOVDQA(q, t0);
+}
+
 void recPDIVW()
 {
 	EE::Profiler.EmitOp(eeOpcode::PDIVW);
 
-	_deleteEEreg(_Rd_, 0);
-	recCall(Interp::PDIVW);
+	int info = eeRecompileCodeXMM( XMMINFO_READS|XMMINFO_READT|XMMINFO_WRITELO|XMMINFO_WRITEHI );
+	int t0reg = _allocTempXMMreg(XMMT_INT, -1);
+	int t1reg = _allocTempXMMreg(XMMT_INT, -1);
+	int t2reg = _allocTempXMMreg(XMMT_INT, -1);
+
+	// LO = a, HI = b, the even words of rs and rt
+	xPSHUF.D(xRegisterSSE(EEREC_LO), xRegisterSSE(EEREC_S), 0x88);
+	xPSHUF.D(xRegisterSSE(EEREC_HI), xRegisterSSE(EEREC_T), 0x88);
+
+	recPDIV_Quotient(t0reg, EEREC_LO, EEREC_HI, t1reg);
+	recPDIV_FixZero(t0reg, EEREC_LO, EEREC_HI, t1reg, t2reg);
+
+	xPMUL.LD(xRegisterSSE(EEREC_HI), xRegisterSSE(t0reg));
+	xPSUB.D(xRegisterSSE(EEREC_LO), xRegisterSSE(EEREC_HI));
+	xPMOVSX.DQ(xRegisterSSE(EEREC_HI), xRegisterSSE(EEREC_LO));
+	xPMOVSX.DQ(xRegisterSSE(EEREC_LO), xRegisterSSE(t0reg));
+
+	_freeXMMreg(t2reg);
+	_freeXMMreg(t1reg);
+	_freeXMMreg(t0reg);
+	_clearNeededXMMregs();
 }
 
 ////////////////////////////////////////////////////
@@ -1858,8 +1936,31 @@ void recPDIVBW()
 {
 	EE::Profiler.EmitOp(eeOpcode::PDIVBW);
 
-	_deleteEEreg(_Rd_, 0);
-	recCall(Interp::PDIVBW); //--
+	int info = eeRecompileCodeXMM( XMMINFO_READS|XMMINFO_READT|XMMINFO_WRITELO|XMMINFO_WRITEHI );
+	int t0reg = _allocTempXMMreg(XMMT_INT, -1);
+	int t1reg = _allocTempXMMreg(XMMT_INT, -1);
+	int t2reg = _allocTempXMMreg(XMMT_INT, -1);
+
+	// LO = a, the words of rs, HI = b, the low halfword of rt
+	xMOVDQA(xRegisterSSE(EEREC_LO), xRegisterSSE(EEREC_S));
+	xPMOVSX.WD(xRegisterSSE(EEREC_HI), xRegisterSSE(EEREC_T));
+	xPSHUF.D(xRegisterSSE(EEREC_HI), xRegisterSSE(EEREC_HI), 0x00);
+
+	recPDIV_Quotient(t0reg, EEREC_LO, EEREC_HI, t1reg);
+	xPSHUF.D(xRegisterSSE(t2reg), xRegisterSSE(EEREC_LO), 0xee);
+	recPDIV_Quotient(t1reg, t2reg, EEREC_HI, t2reg);
+	xPUNPCK.LQDQ(xRegisterSSE(t0reg), xRegisterSSE(t1reg));
+	recPDIV_FixZero(t0reg, EEREC_LO, EEREC_HI, t1reg, t2reg);
+
+	xPMUL.LD(xRegisterSSE(EEREC_HI), xRegisterSSE(t0reg));
+	xPSUB.D(xRegisterSSE(EEREC_LO), xRegisterSSE(EEREC_HI));
+	xMOVDQA(xRegisterSSE(EEREC_HI), xRegisterSSE(EEREC_LO));
+	xMOVDQA(xRegisterSSE(EEREC_LO), xRegisterSSE(t0reg));
+
+	_freeXMMreg(t2reg);
+	_freeXMMreg(t1reg);
+	_freeXMMreg(t0reg);
+	_clearNeededXMMregs();
 }
 
 ////////////////////////////////////////////////////
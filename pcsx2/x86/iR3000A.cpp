@@ -38,6 +38,8 @@
 #include "AppConfig.h"
 
 #include "Utilities/Perf.h"
+#include "Timeline.h"
+#include "RecStats.h"
 #include "DebugTools/Breakpoints.h"
 
 using namespace x86Emitter;
@@ -61,6 +63,7 @@ static BASEBLOCK *recROM1 = NULL;	// also here
 static BASEBLOCK *recROM2 = NULL;   // also here
 static BaseBlocks recBlocks;
 static u8 *recPtr = NULL;
+RecompileStats g_iopRecStats;
 u32 psxpc;			// recompiler psxpc
 int psxbranch;		// set for branch
 u32 g_iopCyclePenalty;
@@ -845,12 +848,16 @@ static __fi u32 psxRecClearMem(u32 pc)
 		recBlocks.Remove(toRemoveFirst, (blockidx - 1));
 	}
 
-	blockidx=0;
-	while(BASEBLOCKEX* pexblock = recBlocks[blockidx++])
+	// Walks every block, which would make the clear linear in the blocks of the whole program
+	if (IsDevBuild)
 	{
-		if (pc >= pexblock->startpc && pc < pexblock->startpc + pexblock->size * 4) {
-			DevCon.Error("[IOP] Impossible block clearing failure");
-			pxFailDev( "[IOP] Impossible block clearing failure" );
+		blockidx=0;
+		while(BASEBLOCKEX* pexblock = recBlocks[blockidx++])
+		{
+			if (pc >= pexblock->startpc && pc < pexblock->startpc + pexblock->size * 4) {
+				DevCon.Error("[IOP] Impossible block clearing failure");
+				pxFailDev( "[IOP] Impossible block clearing failure" );
+			}
 		}
 	}
 
@@ -1244,6 +1251,8 @@ static void __fastcall  PreBlockCheck( u32 blockpc )
 
 static void __fastcall iopRecRecompile( const u32 startpc )
 {
+	TIMELINE_SCOPE("IOP recompile");
+	RecompileStatsScope stats(g_iopRecStats, recPtr);
 	u32 i;
 	u32 willbranch3 = 0;
 
@@ -1365,17 +1374,75 @@ static void __fastcall iopRecRecompile( const u32 startpc )
 
 StartRecomp:
 
+	// Same idea as the EE rec: a loop back to its own start which only reads memory and
+	// registers it doesn't write (apart from the values it loads or derives from loads) does
+	// the same thing on every iteration until an event changes what it reads, which covers
+	// the IRX modules polling a hardware register or a flag in RAM.
 	s_nBlockFF = false;
 	if (s_branchTo == startpc) {
 		s_nBlockFF = true;
+
+		u32 reads = 0, loads = 1;
+
 		for (i = startpc; i < s_nEndBlock; i += 4) {
-			if (i != s_nEndBlock - 8) {
-				switch (iopMemRead32(i)) {
-					case 0: // nop
-						break;
-					default:
-						s_nBlockFF = false;
+			if (i == s_nEndBlock - 8)
+				continue;
+			psxRegs.code = iopMemRead32(i);
+			const u32 opcode = psxRegs.code >> 26;
+			// nop
+			if (psxRegs.code == 0)
+				continue;
+			// imm arithmetic
+			else if ((opcode & 070) == 010)
+			{
+				if (loads & 1 << _Rs_) {
+					loads |= 1 << _Rt_;
+					continue;
+				}
+				else
+					reads |= 1 << _Rs_;
+				if (reads & 1 << _Rt_) {
+					s_nBlockFF = false;
+					break;
+				}
+			}
+			// common register arithmetic instructions
+			else if (opcode == 0 && (_Funct_ & 060) == 040 && (_Funct_ & 076) != 050)
+			{
+				if (loads & 1 << _Rs_ && loads & 1 << _Rt_) {
+					loads |= 1 << _Rd_;
+					continue;
+				}
+				else
+					reads |= 1 << _Rs_ | 1 << _Rt_;
+				if (reads & 1 << _Rd_) {
+					s_nBlockFF = false;
+					break;
+				}
+			}
+			// loads
+			else if ((opcode & 070) == 040 && opcode != 047)
+			{
+				if (loads & 1 << _Rs_) {
+					loads |= 1 << _Rt_;
+					continue;
 				}
+				else
+					reads |= 1 << _Rs_;
+				if (reads & 1 << _Rt_) {
+					s_nBlockFF = false;
+					break;
+				}
+			}
+			// mfc0, mfc2, cfc2
+			else if ((opcode == 020 || opcode == 022) && (_Rs_ == 0 || _Rs_ == 2))
+			{
+				loads |= 1 << _Rt_;
+			}
+			else
+			{
+				s_nBlockFF = false;
+				break;
 			}
 		}
 	}
@@ -21,6 +21,7 @@
 #include "iR3000A.h"
 #include "IopMem.h"
 #include "IopDma.h"
+#include "SPU2/spu2.h"
 
 using namespace x86Emitter;
 
@@ -633,8 +634,165 @@ REC_FUNC(SWR);
 
 using namespace x86Emitter;
 
+// Loads and stores to a constant address don't go through iopMemRead/Write: the RAM
+// and the plain hardware registers are accessed directly, and the hardware pages with
+// handlers (and the SPU2) get their handler called directly.
+static void* rpsxConstHandler(u32 addr, int bits, bool store)
+{
+	static void* const handlers[2][3][3] =
+	{
+		{
+			{ (void*)IopMemory::iopHwRead8_Page1, (void*)IopMemory::iopHwRead8_Page3, (void*)IopMemory::iopHwRead8_Page8 },
+			{ (void*)IopMemory::iopHwRead16_Page1, (void*)IopMemory::iopHwRead16_Page3, (void*)IopMemory::iopHwRead16_Page8 },
+			{ (void*)IopMemory::iopHwRead32_Page1, (void*)IopMemory::iopHwRead32_Page3, (void*)IopMemory::iopHwRead32_Page8 },
+		},
+		{
+			{ (void*)IopMemory::iopHwWrite8_Page1, (void*)IopMemory::iopHwWrite8_Page3, (void*)IopMemory::iopHwWrite8_Page8 },
+			{ (void*)IopMemory::iopHwWrite16_Page1, (void*)IopMemory::iopHwWrite16_Page3, (void*)IopMemory::iopHwWrite16_Page8 },
+			{ (void*)IopMemory::iopHwWrite32_Page1, (void*)IopMemory::iopHwWrite32_Page3, (void*)IopMemory::iopHwWrite32_Page8 },
+		},
+	};
+
+	if ((addr >> 16) == 0x1f90)
+	{
+		if (bits != 16)
+			return NULL;
+		return store ? (void*)SPU2write : (void*)SPU2read;
+	}
+
+	if ((addr >> 16) != 0x1f80)
+		return NULL;
+
+	switch (addr & 0xf000)
+	{
+		case 0x1000: return handlers[store][bits >> 4][0];
+		case 0x3000: return handlers[store][bits >> 4][1];
+		case 0x8000: return handlers[store][bits >> 4][2];
+	}
+	return NULL;
+}
+
+static bool rpsxLoadConst(int bits, bool sign)
+{
+	if (!PSX_IS_CONST1(_Rs_))
+		return false;
+
+	u32 addr = (g_psxConstRegs[_Rs_] + _Imm_) & 0x1fffffff;
+	void* handler = rpsxConstHandler(addr, bits, false);
+	void* p = NULL;
+
+	if (handler == NULL)
+	{
+		// RAM reads don't care about the cache isolation, unlike the writes
+		if ((addr >> 16) < 0x80)
+			p = iopPhysMem(addr);
+		else if ((addr >> 16) == 0x1f80)
+			p = &psxHu8(addr);
+		else
+			return false;
+	}
+
+	_psxOnWriteReg(_Rt_);
+	_psxDeleteReg(_Rt_, 0);
+
+	if (handler)
+	{
+		_psxFlushCall(FLUSH_NODESTROY);
+		xFastCall(handler, addr);
+	}
+	else if (_Rt_)
+	{
+		switch (bits)
+		{
+			case 8:
+				if (sign) xMOVSX(eax, ptr8[(u8*)p]);
+				else xMOVZX(eax, ptr8[(u8*)p]);
+				break;
+			case 16:
+				if (sign) xMOVSX(eax, ptr16[(u16*)p]);
+				else xMOVZX(eax, ptr16[(u16*)p]);
+				break;
+			case 32:
+				xMOV(eax, ptr32[(u32*)p]);
+				break;
+		}
+		xMOV(ptr32[&psxRegs.GPR.r[_Rt_]], eax);
+		return true;
+	}
+
+	if (_Rt_)
+	{
+		switch (bits)
+		{
+			case 8:
+				if (sign) xMOVSX(eax, al);
+				else xMOVZX(eax, al);
+				break;
+			case 16:
+				if (sign) xMOVSX(eax, ax);
+				else xMOVZX(eax, ax);
+				break;
+		}
+		xMOV(ptr32[&psxRegs.GPR.r[_Rt_]], eax);
+	}
+	return true;
+}
+
+static bool rpsxStoreConst(int bits)
+{
+	if (!PSX_IS_CONST1(_Rs_))
+		return false;
+
+	u32 addr = (g_psxConstRegs[_Rs_] + _Imm_) & 0x1fffffff;
+	void* handler = rpsxConstHandler(addr, bits, true);
+
+	// RAM writes are left to iopMemWrite, which checks the cache isolation and
+	// clears the recompiled blocks
+	if (handler == NULL && (addr >> 16) != 0x1f80)
+		return false;
+
+	if (handler)
+	{
+		_psxFlushCall(FLUSH_NODESTROY);
+		if (PSX_IS_CONST1(_Rt_))
+			xFastCall(handler, addr, g_psxConstRegs[_Rt_]);
+		else
+		{
+			xMOV(arg2regd, ptr32[&psxRegs.GPR.r[_Rt_]]);
+			xFastCall(handler, addr, arg2regd);
+		}
+		return true;
+	}
+
+	void* p = &psxHu8(addr);
+	if (PSX_IS_CONST1(_Rt_))
+	{
+		u32 value = g_psxConstRegs[_Rt_];
+		switch (bits)
+		{
+			case 8:  xMOV(ptr8[(u8*)p], (u8)value); break;
+			case 16: xMOV(ptr16[(u16*)p], (u16)value); break;
+			case 32: xMOV(ptr32[(u32*)p], value); break;
+		}
+	}
+	else
+	{
+		xMOV(eax, ptr32[&psxRegs.GPR.r[_Rt_]]);
+		switch (bits)
+		{
+			case 8:  xMOV(ptr8[(u8*)p], al); break;
+			case 16: xMOV(ptr16[(u16*)p], ax); break;
+			case 32: xMOV(ptr32[(u32*)p], eax); break;
+		}
+	}
+	return true;
+}
+
 static void rpsxLB()
 {
+	if (rpsxLoadConst(8, true))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxOnWriteReg(_Rt_);
 	_psxDeleteReg(_Rt_, 0);
@@ -651,6 +809,9 @@ static void rpsxLB()
 
 static void rpsxLBU()
 {
+	if (rpsxLoadConst(8, false))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxOnWriteReg(_Rt_);
 	_psxDeleteReg(_Rt_, 0);
@@ -667,6 +828,9 @@ static void rpsxLBU()
 
 static void rpsxLH()
 {
+	if (rpsxLoadConst(16, true))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxOnWriteReg(_Rt_);
 	_psxDeleteReg(_Rt_, 0);
@@ -683,6 +847,9 @@ static void rpsxLH()
 
 static void rpsxLHU()
 {
+	if (rpsxLoadConst(16, false))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxOnWriteReg(_Rt_);
 	_psxDeleteReg(_Rt_, 0);
@@ -699,6 +866,9 @@ static void rpsxLHU()
 
 static void rpsxLW()
 {
+	if (rpsxLoadConst(32, false))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxOnWriteReg(_Rt_);
 	_psxDeleteReg(_Rt_, 0);
@@ -731,6 +901,9 @@ static void rpsxLW()
 
 static void rpsxSB()
 {
+	if (rpsxStoreConst(8))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxDeleteReg(_Rt_, 1);
 
@@ -742,6 +915,9 @@ static void rpsxSB()
 
 static void rpsxSH()
 {
+	if (rpsxStoreConst(16))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxDeleteReg(_Rt_, 1);
 
@@ -753,6 +929,9 @@ static void rpsxSH()
 
 static void rpsxSW()
 {
+	if (rpsxStoreConst(32))
+		return;
+
 	_psxDeleteReg(_Rs_, 1);
 	_psxDeleteReg(_Rt_, 1);
 
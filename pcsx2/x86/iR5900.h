@@ -70,6 +70,7 @@ void LoadBranchState();
 void recompileNextInstruction(int delayslot);
 void SetBranchReg( u32 reg );
 void SetBranchImm( u32 imm );
+void recPushReturnAddress( u32 retpc );
 
 void iFlushCall(int flushtype);
 void recBranchCall( void (*func)() );
@@ -82,6 +83,13 @@ extern void recDoBranchImm( u32* jmpSkip, bool isLikely = false );
 extern void recDoBranchImm_Likely( u32* jmpSkip );
 } }
 
+// Per-block profiler (iR5900BlockProfiler.cpp)
+bool recBlockProfilerEnabled();
+void recBlockProfilerEmit( u32 startpc );
+void recBlockProfilerMap( const void* x86ptr, u32 x86size, u32 size );
+void recBlockProfilerReset();
+void recBlockProfilerShutdown();
+
 ////////////////////////////////////////////////////////////////////
 // Constant Propagation - From here to the end of the header!
 
@@ -101,6 +109,27 @@ extern void recDoBranchImm_Likely( u32* jmpSkip );
 extern __aligned16 GPR_reg64 g_cpuConstRegs[32];
 extern u32 g_cpuHasConstReg, g_cpuFlushedConstReg;
 
+////////////////////////////////////////////////////////////////////
+// FPU Range Tracking
+//
+// The bit of an FPU register (XMMFPU_ACC for ACC) is set while the register is known
+// to hold an IEEE finite value in the block, which the clamps would leave unchanged,
+// so the clamps of its operands are skipped.
+// eeFPURecompileCode sets the bit of the written register from g_fpuFiniteResult,
+// which the recompiled op sets when its result is finite.
+
+#define FPR_IS_FINITE(reg) ((g_fpuFiniteRegs >> (reg)) & 1)
+#define FPR_SET_FINITE(reg, finite) { \
+	g_fpuFiniteRegs = (g_fpuFiniteRegs & ~(1ULL<<(reg))) | ((u64)(bool)(finite)<<(reg)); \
+}
+
+#define FPR_DEL_FINITE(reg) { \
+	g_fpuFiniteRegs &= ~(1ULL<<(reg)); \
+}
+
+extern u64 g_fpuFiniteRegs;
+extern bool g_fpuFiniteResult;
+
 // gets a memory pointer to the constant reg
 u32* _eeGetConstReg(int reg);
 
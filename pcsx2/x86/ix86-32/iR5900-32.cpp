@@ -26,6 +26,8 @@
 
 #include "vtlb.h"
 #include "Dump.h"
+#include "Timeline.h"
+#include "RecStats.h"
 
 #include "System/SysThreads.h"
 #include "GS.h"
@@ -37,6 +39,7 @@
 
 #if !PCSX2_SEH
 #	include <csetjmp>
+#include <unordered_set>
 #endif
 
 
@@ -62,6 +65,8 @@ int g_branch;	         // set for branch
 
 __aligned16 GPR_reg64 g_cpuConstRegs[32] = {0};
 u32 g_cpuHasConstReg = 0, g_cpuFlushedConstReg = 0;
+u64 g_fpuFiniteRegs = 0;
+bool g_fpuFiniteResult = false;
 bool g_cpuFlushedPC, g_cpuFlushedCode, g_recompilingDelaySlot, g_maySignalException;
 
 eeProfiler EE::Profiler;
@@ -87,6 +92,7 @@ static BASEBLOCK *recROM2 = NULL;       // also here
 
 static BaseBlocks recBlocks;
 static u8* recPtr = NULL;
+RecompileStats g_eeRecStats;
 static u32 *recConstBufPtr = NULL;
 EEINST* s_pInstCache = NULL;
 static u32 s_nInstCacheSize = 0;
@@ -100,20 +106,77 @@ static bool s_nBlockFF;
 // save states for branches
 GPR_reg64 s_saveConstRegs[32];
 static u32 s_saveHasConstReg = 0, s_saveFlushedConstReg = 0;
+static u64 s_saveFiniteRegs = 0;
 static EEINST* s_psaveInstInfo = NULL;
 
 static u32 s_savenBlockCycles = 0;
 
+// Prediction of the register jumps, they hold BASEBLOCK slots rather than x86 code so
+// recClear resetting a slot to JITCompile is enough to invalidate them.
+//   Return address stack: JAL/JALR push the slot of their return address, JR $ra
+//   jumps through the popped one when its pc matches.
+//   Indirect cache: every other JR/JALR site remembers the slot of its last target.
+static const int RAS_SIZE = 16;
+alignas(16) static u32 s_ras_pc[RAS_SIZE];
+alignas(16) static BASEBLOCK* s_ras_block[RAS_SIZE];
+static u32 s_ras_top;
+
+struct IndirectCacheEntry
+{
+	u32 pc;
+	BASEBLOCK* block;
+};
+
+static const int INDIRECT_CACHE_SIZE = 0x4000;
+alignas(16) static IndirectCacheEntry s_indirect_cache[INDIRECT_CACHE_SIZE];
+static int s_indirect_cache_next = 0;
+
+// Tiering: blocks in ram count down their executions, and once hot they are thrown away and
+// recompiled as superblocks, which follow the unconditional forward jumps within the page
+// instead of ending there (constants carry over too).
+static const s32 HOT_BLOCK_THRESHOLD = 2000;
+static const int HOT_COUNTER_COUNT = 0x10000;
+alignas(16) static s32 s_hot_counters[HOT_COUNTER_COUNT];
+static int s_hot_counters_next = 0;
+static std::unordered_set<u32> s_hot_blocks;
+
+static const int MAX_SUPER_JUMPS = 4;
+static u32 s_super_jump_from[MAX_SUPER_JUMPS];
+static u32 s_super_jump_to[MAX_SUPER_JUMPS];
+static int s_nSuperJumps = 0;
+static bool s_nBlockHot = false;
+static u32 s_nStartBlock = 0;
+
+// Speculation: the static targets and fall-throughs of the compiled blocks are queued, and
+// compiled in the idle time of the frame limiter before the EE branches there (most blocks
+// of a game are first reached in a burst, e.g. a level load).
+static const int SPECULATE_QUEUE_SIZE = 64;
+static u32 s_speculate_queue[SPECULATE_QUEUE_SIZE];
+static int s_speculate_count = 0;
+
 #ifdef PCSX2_DEBUG
 static u32 dumplog = 0;
 #else
 #define dumplog 0
 #endif
 
-static void iBranchTest(u32 newpc = 0xffffffff);
+static void iBranchTest(u32 newpc = 0xffffffff, int predict = 0);
 static void ClearRecLUT(BASEBLOCK* base, int count);
+static void recResetIndirectBranches();
 static u32 scaleblockcycles();
 static void recExitExecution();
+static void recSpeculateQueue(u32 pc);
+
+// Links of the block being relaxed (Recompiler.RelaxEE), made once its code is final
+static std::vector<std::pair<u32, s32*>> s_relax_links;
+
+static void recLink(u32 pc, s32* jumpptr)
+{
+	if (x86Relax)
+		s_relax_links.push_back(std::make_pair(pc, jumpptr));
+	else
+		recBlocks.Link(pc, jumpptr);
+}
 
 void _eeFlushAllUnused()
 {
@@ -319,6 +382,7 @@ void recCall( void (*func)() )
 static void __fastcall recRecompile( const u32 startpc );
 static void __fastcall dyna_block_discard(u32 start,u32 sz);
 static void __fastcall dyna_page_reset(u32 start,u32 sz);
+static void __fastcall recVerifyBlock(u32 startpc);
 
 // Recompiled code buffer for EE recompiler dispatchers!
 static u8 __pagealigned eeRecDispatchers[__pagesize];
@@ -333,13 +397,15 @@ static DynGenFunc* EnterRecompiledCode	= NULL;
 static DynGenFunc* ExitRecompiledCode	= NULL;
 static DynGenFunc* DispatchBlockDiscard = NULL;
 static DynGenFunc* DispatchPageReset    = NULL;
+static DynGenFunc* JITVerify			= NULL;
 
 static void recEventTest()
 {
 	_cpuEventTest_Shared();
 
-	if (iopBreakpoint) {
+	if (iopBreakpoint || eeMemcheckBreak) {
 		iopBreakpoint = false;
+		eeMemcheckBreak = false;
 		recExitExecution();
 	}
 }
@@ -374,6 +440,16 @@ static DynGenFunc* _DynGen_JITCompileInBlock()
 	return (DynGenFunc*)retval;
 }
 
+// The address of the blocks of a page that got written (in LazySmcEE mode).  It checks the
+// code of the block at the current pc, which either restores it or clears it.
+static DynGenFunc* _DynGen_JITVerify()
+{
+	u8* retval = xGetAlignedCallTarget();
+	xFastCall((void*)recVerifyBlock, ptr32[&cpuRegs.pc] );
+	xJMP( (void*)DispatcherReg );
+	return (DynGenFunc*)retval;
+}
+
 // called when jumping to variable pc address
 static DynGenFunc* _DynGen_DispatcherReg()
 {
@@ -458,6 +534,7 @@ static void _DynGen_Dispatchers()
 
 	JITCompile           = _DynGen_JITCompile();
 	JITCompileInBlock    = _DynGen_JITCompileInBlock();
+	JITVerify            = _DynGen_JITVerify();
 	EnterRecompiledCode  = _DynGen_EnterRecompiledCode();
 	DispatchBlockDiscard = _DynGen_DispatchBlockDiscard();
 	DispatchPageReset    = _DynGen_DispatchPageReset();
@@ -465,6 +542,7 @@ static void _DynGen_Dispatchers()
 	HostSys::MemProtectStatic( eeRecDispatchers, PageAccess_ExecOnly() );
 
 	recBlocks.SetJITCompile( JITCompile );
+	recBlocks.SetJITVerify( JITVerify );
 
 	Perf::any.map((uptr)&eeRecDispatchers, 4096, "EE Dispatcher");
 }
@@ -585,6 +663,20 @@ static void recAlloc()
 static __aligned16 u16 manual_page[Ps2MemSize::MainRam >> 12];
 static __aligned16 u8 manual_counter[Ps2MemSize::MainRam >> 12];
 
+// LazySmcEE: a write to a protected page only sends its blocks to JITVerify, and the first
+// one to still match its hash protects the page again.  Pages written more often than the
+// limit go to manual protection, as every write costs a page fault.
+static const u8 LAZY_SMC_FAULT_LIMIT = 16;
+static __aligned16 u8 lazy_smc_faults[Ps2MemSize::MainRam >> 12];
+
+static struct
+{
+	u32 page_clears;   // writes to protected pages
+	u32 lazy_clears;   // ... of which only suspended the blocks of the page
+	u32 blocks_kept;   // suspended blocks with the same code on entry
+	u32 blocks_changed;// suspended blocks whose code had changed
+} s_smc_stats;
+
 static std::atomic<bool> eeRecIsReset(false);
 static std::atomic<bool> eeRecNeedsReset(false);
 static bool eeCpuExecuting = false;
@@ -596,7 +688,15 @@ static void recResetRaw()
 {
 	Perf::ee.reset();
 
+	if (s_smc_stats.page_clears)
+	{
+		DevCon.WriteLn("EE SMC: %u page clears (%u lazy), %u blocks kept, %u blocks changed",
+			s_smc_stats.page_clears, s_smc_stats.lazy_clears, s_smc_stats.blocks_kept, s_smc_stats.blocks_changed);
+	}
+	memzero(s_smc_stats);
+
 	EE::Profiler.Reset();
+	recBlockProfilerReset();
 
 	recAlloc();
 
@@ -618,6 +718,13 @@ static void recResetRaw()
 
 	recBlocks.Reset();
 	mmap_ResetBlockTracking();
+	memzero(lazy_smc_faults);
+	recResetIndirectBranches();
+	vtlb_ResetFastmem();
+
+	s_hot_counters_next = 0;
+	s_hot_blocks.clear();
+	s_speculate_count = 0;
 
 	x86SetPtr(*recMem);
 
@@ -631,6 +738,8 @@ static void recResetRaw()
 
 static void recShutdown()
 {
+	recBlockProfilerShutdown();
+	vtlb_ShutdownFastmem();
 	safe_delete( recMem );
 	safe_aligned_free( recRAMCopy );
 	safe_aligned_free( recLutReserve_RAM );
@@ -833,16 +942,16 @@ void recClear(u32 addr, u32 size)
 
 	upperextent = std::min(upperextent, ceiling);
 
-	for (int i = 0; pexblock = recBlocks[i]; i++) {
-		if (s_pCurBlock == PC_GETBLOCK(pexblock->startpc))
-			continue;
-		u32 blockend = pexblock->startpc + pexblock->size * 4;
-		if (pexblock->startpc >= addr && pexblock->startpc < addr + size * 4
-		 || pexblock->startpc < addr && blockend > addr) {
-			if( !IsDevBuild )
-				Console.Error( "[EE] Impossible block clearing failure" );
-			else
+	// Walks every block, which would make the clear linear in the blocks of the whole program
+	if (IsDevBuild) {
+		for (int i = 0; pexblock = recBlocks[i]; i++) {
+			if (s_pCurBlock == PC_GETBLOCK(pexblock->startpc))
+				continue;
+			u32 blockend = pexblock->startpc + pexblock->size * 4;
+			if (pexblock->startpc >= addr && pexblock->startpc < addr + size * 4
+			 || pexblock->startpc < addr && blockend > addr) {
 				pxFailDev( "[EE] Impossible block clearing failure" );
+			}
 		}
 	}
 
@@ -850,6 +959,72 @@ void recClear(u32 addr, u32 size)
 		ClearRecLUT(PC_GETBLOCK(lowerextent), upperextent - lowerextent);
 }
 
+static u64 recBlockHash(const u32* code, u32 size)
+{
+	u64 hash = 0xcbf29ce484222325ULL;
+	for (u32 i = 0; i < size; i++)
+		hash = (hash ^ code[i]) * 0x100000001b3ULL;
+	return hash;
+}
+
+// Size is in dwords (4 bytes).  Sends the blocks of the range to JITVerify instead of
+// clearing them, returns false if the range should rather be cleared.
+static bool recClearLazy(u32 addr, u32 size)
+{
+	s_smc_stats.page_clears++;
+
+	if ((addr) >= maxrecmem || !(recLUT[(addr) >> 16] + (addr & ~0xFFFFUL)))
+		return true;
+	addr = HWADDR(addr);
+
+	if (addr >= Ps2MemSize::MainRam || lazy_smc_faults[addr >> 12] >= LAZY_SMC_FAULT_LIMIT)
+		return false;
+	lazy_smc_faults[addr >> 12]++;
+	s_smc_stats.lazy_clears++;
+
+	// note: blocks reside within a single page, so none before the range reaches into it
+	int blockidx = recBlocks.LastIndex(addr + size * 4 - 4);
+	while (BASEBLOCKEX* pexblock = recBlocks[blockidx--])
+	{
+		if (pexblock->startpc < addr)
+			break;
+
+		BASEBLOCK* pblock = PC_GETBLOCK(pexblock->startpc);
+		if (pblock == s_pCurBlock || pexblock->suspended)
+			continue;
+
+		pblock->SetFnptr((uptr)JITVerify);
+		recBlocks.Suspend(pexblock);
+	}
+
+	return true;
+}
+
+static void __fastcall recVerifyBlock(u32 startpc)
+{
+	BASEBLOCK* pblock = PC_GETBLOCK(startpc);
+	BASEBLOCKEX* pexblock = recBlocks.Get(HWADDR(startpc));
+
+	if (!pexblock || pexblock->startpc != HWADDR(startpc))
+	{
+		pblock->SetFnptr((uptr)JITCompile);
+		return;
+	}
+
+	if (recBlockHash((u32*)PSM(startpc), pexblock->size) == pexblock->hash)
+	{
+		s_smc_stats.blocks_kept++;
+		pblock->SetFnptr(pexblock->fnptr);
+		recBlocks.Resume(pexblock);
+		mmap_MarkCountedRamPage(pexblock->startpc);
+	}
+	else
+	{
+		s_smc_stats.blocks_changed++;
+		recClear(pexblock->startpc, pexblock->size);
+	}
+}
+
 
 static int *s_pCode;
 
@@ -900,7 +1075,269 @@ void SetBranchReg( u32 reg )
 
 	iFlushCall(FLUSH_EVERYTHING);
 
-	iBranchTest();
+	// Goemon's TLB hack makes the pc physical, its slots aren't the dispatcher ones
+	if (EmuConfig.Gamefixes.GoemonTlbHack)
+		iBranchTest();
+	else
+		iBranchTest(0xffffffff, (reg == 31) ? 1 : 2);
+}
+
+// Must be called after the flush of the branch, it uses eax/ecx/edx
+void recPushReturnAddress(u32 retpc)
+{
+	if (EmuConfig.Gamefixes.GoemonTlbHack)
+		return;
+
+	xMOV(eax, ptr32[&s_ras_top]);
+	xADD(eax, 1);
+	xAND(eax, RAS_SIZE - 1);
+	xMOV(ptr32[&s_ras_top], eax);
+	xMOV(ptr32[xComplexAddress(rcx, s_ras_pc, rax * 4)], retpc);
+	xMOV64(rdx, (uptr)PC_GETBLOCK(retpc));
+	xMOV(ptrNative[xComplexAddress(rcx, s_ras_block, rax * wordsize)], rdx);
+}
+
+static void recResetIndirectBranches()
+{
+	// 1 is never a valid pc
+	for (int i = 0; i < RAS_SIZE; i++)
+	{
+		s_ras_pc[i] = 1;
+		s_ras_block[i] = NULL;
+	}
+	s_ras_top = 0;
+
+	for (int i = 0; i < INDIRECT_CACHE_SIZE; i++)
+	{
+		s_indirect_cache[i].pc = 1;
+		s_indirect_cache[i].block = NULL;
+	}
+	s_indirect_cache_next = 0;
+}
+
+// Jumps to cpuRegs.pc through the predicted BASEBLOCK slot, or the dispatcher
+static void iBranchIndirect(bool ret)
+{
+	if (ret)
+	{
+		// Pop the return address stack even when it mispredicts to stay in sync
+		xMOV(eax, ptr32[&s_ras_top]);
+		xLEA(ecx, ptr[rax - 1]);
+		xAND(ecx, RAS_SIZE - 1);
+		xMOV(ptr32[&s_ras_top], ecx);
+		xMOV(ecx, ptr32[&cpuRegs.pc]);
+		xCMP(ecx, ptr32[xComplexAddress(rdx, s_ras_pc, rax * 4)]);
+		xForwardJNE8 miss;
+		xMOV(rcx, ptrNative[xComplexAddress(rdx, s_ras_block, rax * wordsize)]);
+		xJMP(ptrNative[rcx]);
+		miss.SetTarget();
+		xJMP((void*)DispatcherReg);
+	}
+	else if (s_indirect_cache_next < INDIRECT_CACHE_SIZE)
+	{
+		IndirectCacheEntry* entry = &s_indirect_cache[s_indirect_cache_next++];
+
+		xMOV(eax, ptr32[&cpuRegs.pc]);
+		xCMP(eax, ptr32[&entry->pc]);
+		xForwardJNE8 miss;
+		xMOV(rcx, ptrNative[&entry->block]);
+		xJMP(ptrNative[rcx]);
+		miss.SetTarget();
+
+		// Same lookup as DispatcherReg, the slot is kept for the next time
+		xMOV(ptr32[&entry->pc], eax);
+		xMOV(ebx, eax);
+		xSHR(eax, 16);
+		xMOV(rcx, ptrNative[xComplexAddress(rcx, recLUT, rax * wordsize)]);
+		xLEA(rcx, ptr[rbx * (wordsize / 4) + rcx]);
+		xMOV(ptrNative[&entry->block], rcx);
+		xJMP(ptrNative[rcx]);
+	}
+	else
+	{
+		xJMP((void*)DispatcherReg);
+	}
+}
+
+// Gets the GPRs an instruction reads and writes.  Returns false for the instructions the
+// summary doesn't know about, which must be assumed to read everything.
+static bool recGetRegUsage(u32 code, u32& read, u32& write, bool& branch, bool& likely)
+{
+	const u32 rs = 1u << ((code >> 21) & 0x1f);
+	const u32 rt = 1u << ((code >> 16) & 0x1f);
+	const u32 rd = 1u << ((code >> 11) & 0x1f);
+	const u32 funct = code & 0x3f;
+
+	read = write = 0;
+	branch = likely = false;
+
+	switch (code >> 26)
+	{
+		case 0x00: // SPECIAL
+			switch (funct)
+			{
+				case 0x00: case 0x02: case 0x03: // SLL, SRL, SRA
+				case 0x38: case 0x3a: case 0x3b: // DSLL, DSRL, DSRA
+				case 0x3c: case 0x3e: case 0x3f: // DSLL32, DSRL32, DSRA32
+					read = rt; write = rd; return true;
+				case 0x04: case 0x06: case 0x07: // SLLV, SRLV, SRAV
+				case 0x14: case 0x16: case 0x17: // DSLLV, DSRLV, DSRAV
+					read = rs | rt; write = rd; return true;
+				case 0x08: // JR
+					read = rs; branch = true; return true;
+				case 0x09: // JALR
+					read = rs; write = rd; branch = true; return true;
+				case 0x0a: case 0x0b: // MOVZ, MOVN (rd is kept when the condition fails)
+					read = rs | rt | rd; return true;
+				case 0x10: case 0x12: // MFHI, MFLO
+					write = rd; return true;
+				case 0x11: case 0x13: case 0x29: // MTHI, MTLO, MTSA
+					read = rs; return true;
+				case 0x1a: case 0x1b: // DIV, DIVU
+					read = rs | rt; return true;
+				case 0x18: case 0x19: // MULT, MULTU (also write LO to rd)
+					read = rs | rt; write = rd; return true;
+				case 0x28: // MFSA
+					write = rd; return true;
+				case 0x30: case 0x31: case 0x32: case 0x33: case 0x34: case 0x36: // traps
+					read = rs | rt; return true;
+			}
+			if (funct >= 0x20 && funct <= 0x2f) // ADD .. DSUBU
+			{
+				read = rs | rt; write = rd; return true;
+			}
+			return false;
+
+		case 0x01: // REGIMM
+			switch ((code >> 16) & 0x1f)
+			{
+				case 0x00: case 0x01: // BLTZ, BGEZ
+					read = rs; branch = true; return true;
+				case 0x02: case 0x03: // BLTZL, BGEZL
+					read = rs; branch = likely = true; return true;
+				case 0x10: case 0x11: // BLTZAL, BGEZAL
+					read = rs; write = 1u << 31; branch = true; return true;
+				case 0x12: case 0x13: // BLTZALL, BGEZALL
+					read = rs; write = 1u << 31; branch = likely = true; return true;
+				case 0x08: case 0x09: case 0x0a: case 0x0b: case 0x0c: case 0x0e: // traps
+				case 0x18: case 0x19: // MTSAB, MTSAH
+					read = rs; return true;
+			}
+			return false;
+
+		case 0x02: // J
+			branch = true; return true;
+		case 0x03: // JAL
+			write = 1u << 31; branch = true; return true;
+		case 0x04: case 0x05: // BEQ, BNE
+			read = rs | rt; branch = true; return true;
+		case 0x06: case 0x07: // BLEZ, BGTZ
+			read = rs; branch = true; return true;
+		case 0x14: case 0x15: // BEQL, BNEL
+			read = rs | rt; branch = likely = true; return true;
+		case 0x16: case 0x17: // BLEZL, BGTZL
+			read = rs; branch = likely = true; return true;
+
+		case 0x08: case 0x09: case 0x0a: case 0x0b: // ADDI, ADDIU, SLTI, SLTIU
+		case 0x0c: case 0x0d: case 0x0e: // ANDI, ORI, XORI
+		case 0x18: case 0x19: // DADDI, DADDIU
+		case 0x1e: case 0x20: case 0x21: case 0x23: // LQ, LB, LH, LW
+		case 0x24: case 0x25: case 0x27: case 0x37: // LBU, LHU, LWU, LD
+			read = rs; write = rt; return true;
+		case 0x0f: // LUI
+			write = rt; return true;
+		case 0x1a: case 0x1b: case 0x22: case 0x26: // LDL, LDR, LWL, LWR (merge into rt)
+		case 0x1f: case 0x28: case 0x29: case 0x2a: case 0x2b: // SQ, SB, SH, SWL, SW
+		case 0x2c: case 0x2d: case 0x2e: case 0x3f: // SDL, SDR, SWR, SD
+			read = rs | rt; return true;
+		case 0x2f: case 0x31: case 0x33: case 0x36: case 0x39: case 0x3e: // CACHE, LWC1, PREF, LQC2, SWC1, SQC2
+			read = rs; return true;
+
+		case 0x10: // COP0
+			switch ((code >> 21) & 0x1f)
+			{
+				case 0x00: write = rt; return true; // MFC0
+				case 0x04: read = rt; return true; // MTC0
+			}
+			return false;
+
+		case 0x11: // COP1
+			switch ((code >> 21) & 0x1f)
+			{
+				case 0x00: case 0x02: write = rt; return true; // MFC1, CFC1
+				case 0x04: case 0x06: read = rt; return true; // MTC1, CTC1
+				case 0x08: branch = true; likely = !!(code & (1 << 17)); return true; // BC1
+				case 0x10: case 0x14: return true; // S, W
+			}
+			return false;
+
+		case 0x12: // COP2
+			switch ((code >> 21) & 0x1f)
+			{
+				case 0x01: case 0x02: write = rt; return true; // QMFC2, CFC2
+				case 0x05: case 0x06: read = rt; return true; // QMTC2, CTC2
+				case 0x08: branch = true; likely = !!(code & (1 << 17)); return true; // BC2
+			}
+			return ((code >> 21) & 0x1f) >= 0x10; // macro mode, no GPR
+	}
+
+	return false;
+}
+
+// Summarizes the GPR liveness of the straight line code from startpc to (excluding) endpc,
+// stopping after the delay slot of the first branch.  gpr_kill only ever holds registers
+// whose lower 64 bits are overwritten on every path, before any read.
+static void recBlockLiveness(u32 startpc, u32 endpc, u32& gpr_in, u32& gpr_kill)
+{
+	gpr_in = gpr_kill = 0;
+
+	bool delayslot = false, likely = false;
+	for (u32 i = startpc; i < endpc; i += 4)
+	{
+		const u32* code = (u32*)PSM(i);
+		u32 read, write;
+		bool branch, islikely;
+		if (!code || !recGetRegUsage(*code, read, write, branch, islikely))
+		{
+			gpr_in |= ~gpr_kill;
+			break;
+		}
+
+		gpr_in |= read & ~gpr_kill;
+
+		// the delay slot of a likely branch only runs when it's taken
+		if (!(delayslot && likely))
+			gpr_kill |= write & ~gpr_in;
+
+		if (delayslot)
+			break;
+
+		delayslot = branch;
+		likely = islikely;
+	}
+
+	gpr_in &= ~1u;
+	gpr_kill &= ~1u;
+}
+
+// Returns the GPRs the code at target overwrites before reading them, which a block
+// jumping there doesn't need to flush.  Only trusted when both share a protected page:
+// modifying the target then clears the block that relies on the summary too.
+static u32 recDeadOnEntry(u32 target)
+{
+	if ((HWADDR(target) ^ s_pCurBlockEx->startpc) & ~0xfff)
+		return 0;
+
+	if (mmap_GetRamPageInfo(HWADDR(target)) == ProtMode_Manual)
+		return 0;
+
+	BASEBLOCKEX* block = recBlocks.Get(HWADDR(target));
+	if (block && block->startpc == HWADDR(target))
+		return block->gpr_kill;
+
+	u32 gpr_in, gpr_kill;
+	recBlockLiveness(target, (target | 0xfff) + 1, gpr_in, gpr_kill);
+	return gpr_kill;
 }
 
 void SetBranchImm( u32 imm )
@@ -909,6 +1346,9 @@ void SetBranchImm( u32 imm )
 
 	pxAssert( imm );
 
+	// Constants that are dead at the target are dropped rather than written back
+	g_cpuFlushedConstReg |= recDeadOnEntry(imm) & g_cpuHasConstReg;
+
 	// end the current block
 	iFlushCall(FLUSH_EVERYTHING);
 	xMOV(ptr32[&cpuRegs.pc], imm);
@@ -921,6 +1361,7 @@ void SaveBranchState()
 	memcpy(s_saveConstRegs, g_cpuConstRegs, sizeof(g_cpuConstRegs));
 	s_saveHasConstReg = g_cpuHasConstReg;
 	s_saveFlushedConstReg = g_cpuFlushedConstReg;
+	s_saveFiniteRegs = g_fpuFiniteRegs;
 	s_psaveInstInfo = g_pCurInstInfo;
 
 	memcpy(s_saveXMMregs, xmmregs, sizeof(xmmregs));
@@ -933,6 +1374,7 @@ void LoadBranchState()
 	memcpy(g_cpuConstRegs, s_saveConstRegs, sizeof(g_cpuConstRegs));
 	g_cpuHasConstReg = s_saveHasConstReg;
 	g_cpuFlushedConstReg = s_saveFlushedConstReg;
+	g_fpuFiniteRegs = s_saveFiniteRegs;
 	g_pCurInstInfo = s_psaveInstInfo;
 
 	memcpy(xmmregs, s_saveXMMregs, sizeof(xmmregs));
@@ -1062,7 +1504,10 @@ u32 scaleblockcycles_clear()
 //   noDispatch - When set true, then jump to Dispatcher.  Used by the recs
 //   for blocks which perform exception checks without branching (it's enabled by
 //   setting "g_branch = 2";
-static void iBranchTest(u32 newpc)
+//
+//   predict - For register jumps, 1 predicts it with the return address stack,
+//   2 with the inline cache of the jump.
+static void iBranchTest(u32 newpc, int predict)
 {
 	// Check the Event scheduler if our "cycle target" has been reached.
 	// Equiv code to:
@@ -1086,12 +1531,21 @@ static void iBranchTest(u32 newpc)
 		xMOV(ptr[&cpuRegs.cycle], eax); // update cycles
 		xSUB(eax, ptr[&g_nextEventCycle]);
 
-		if (newpc == 0xffffffff)
-			xJS( DispatcherReg );
+		if (newpc != 0xffffffff)
+		{
+			recLink(HWADDR(newpc), xJcc32(Jcc_Signed));
+			xJMP( (void*)DispatcherEvent );
+		}
+		else if (predict)
+		{
+			xJNS( DispatcherEvent );
+			iBranchIndirect(predict == 1);
+		}
 		else
-			recBlocks.Link(HWADDR(newpc), xJcc32(Jcc_Signed));
-
-		xJMP( (void*)DispatcherEvent );
+		{
+			xJS( DispatcherReg );
+			xJMP( (void*)DispatcherEvent );
+		}
 	}
 }
 
@@ -1237,80 +1691,6 @@ void dynarecCheckBreakpoint()
 	recExitExecution();
 }
 
-void dynarecMemcheck()
-{
-	u32 pc = cpuRegs.pc;
- 	if (CBreakPoints::CheckSkipFirst(BREAKPOINT_EE, pc) != 0)
-		return;
-
-	CBreakPoints::SetBreakpointTriggered(true);
-	GetCoreThread().PauseSelfDebug();
-	recExitExecution();
-}
-
-void __fastcall dynarecMemLogcheck(u32 start, bool store)
-{
-	if (store)
-		DevCon.WriteLn("Hit store breakpoint @0x%x", start);
-	else
-		DevCon.WriteLn("Hit load breakpoint @0x%x", start);
-}
-
-void recMemcheck(u32 op, u32 bits, bool store)
-{
-	iFlushCall(FLUSH_EVERYTHING|FLUSH_PC);
-
-	// compute accessed address
-	_eeMoveGPRtoR(ecx, (op >> 21) & 0x1F);
-	if ((s16)op != 0)
-		xADD(ecx, (s16)op);
-	if (bits == 128)
-		xAND(ecx, ~0x0F);
-
-	xFastCall((void*)standardizeBreakpointAddressEE, ecx);
-	xMOV(ecx,eax);
-	xMOV(edx,eax);
-	xADD(edx,bits/8);
-
-	// ecx = access address
-	// edx = access address+size
-
-	auto checks = CBreakPoints::GetMemChecks();
-	for (size_t i = 0; i < checks.size(); i++)
-	{
-		if (checks[i].cpu != BREAKPOINT_EE)
-			continue;
-		if (checks[i].result == 0)
-			continue;
-		if ((checks[i].cond & MEMCHECK_WRITE) == 0 && store)
-			continue;
-		if ((checks[i].cond & MEMCHECK_READ) == 0 && !store)
-			continue;
-
-		// logic: memAddress < bpEnd && bpStart < memAddress+memSize
-
-		xMOV(eax,standardizeBreakpointAddress(BREAKPOINT_EE, checks[i].end));
-		xCMP(ecx,eax);				// address < end
-		xForwardJGE8 next1;			// if address >= end then goto next1
-
-		xMOV(eax,standardizeBreakpointAddress(BREAKPOINT_EE, checks[i].start));
-		xCMP(eax,edx);				// start < address+size
-		xForwardJGE8 next2;			// if start >= address+size then goto next2
-
-		// hit the breakpoint
-		if (checks[i].result & MEMCHECK_LOG) {
-			xMOV(edx, store);
-			xFastCall((void*)dynarecMemLogcheck, ecx, edx);
-		}
-		if (checks[i].result & MEMCHECK_BREAK) {
-			xFastCall((void*)dynarecMemcheck);
-		}
-
-		next1.SetTarget();
-		next2.SetTarget();
-	}
-}
-
 void encodeBreakpoint()
 {
 	if (isBreakpointNeeded(pc) != 0)
@@ -1320,34 +1700,15 @@ void encodeBreakpoint()
 	}
 }
 
-void encodeMemcheck()
+// Compiles the delay slot of a jump followed by a superblock, and carries on at its target.
+static void recSuperJump(u32 target)
 {
-	int needed = isMemcheckNeeded(pc);
-	if (needed == 0)
-		return;
-
-	u32 op = memRead32(needed == 2 ? pc+4 : pc);
-	const OPCODE& opcode = GetInstruction(op);
+	recompileNextInstruction(1);
 
-	bool store = (opcode.flags & IS_STORE) != 0;
-	switch (opcode.flags & MEMTYPE_MASK)
-	{
-	case MEMTYPE_BYTE:
-		recMemcheck(op,8,store);
-		break;
-	case MEMTYPE_HALF:
-		recMemcheck(op,16,store);
-		break;
-	case MEMTYPE_WORD:
-		recMemcheck(op,32,store);
-		break;
-	case MEMTYPE_DWORD:
-		recMemcheck(op,64,store);
-		break;
-	case MEMTYPE_QWORD:
-		recMemcheck(op,128,store);
-		break;
-	}
+	pc = target;
+	g_pCurInstInfo = s_pInstCache + (target - s_nStartBlock) / 4;
+	g_cpuFlushedPC = false;
+	g_cpuFlushedCode = false;
 }
 
 void recompileNextInstruction(int delayslot)
@@ -1355,12 +1716,9 @@ void recompileNextInstruction(int delayslot)
 	u32 i;
 	int count;
 
-	// add breakpoint
+	// add breakpoint, memchecks are handled by the vtlb watch handler
 	if (!delayslot)
-	{
 		encodeBreakpoint();
-		encodeMemcheck();
-	}
 
 	s_pCode = (int *)PSM( pc );
 	pxAssert(s_pCode);
@@ -1394,6 +1752,11 @@ void recompileNextInstruction(int delayslot)
 
 	const OPCODE& opcode = GetCurrentInstruction();
 
+	int super_jump = -1;
+	for (int j = 0; !delayslot && j < s_nSuperJumps; j++)
+		if (s_super_jump_from[j] == pc - 4)
+			super_jump = j;
+
  	//pxAssert( !(g_pCurInstInfo->info & EEINSTINFO_NOREC) );
 	//Console.Warning("opcode name = %s, it's cycles = %d\n",opcode.Name,opcode.cycles);
 	// if this instruction is a jump or a branch, exit right away
@@ -1436,10 +1799,14 @@ void recompileNextInstruction(int delayslot)
 		//If the COP0 DIE bit is disabled, cycles should be doubled.
 		s_nBlockCycles += opcode.cycles * (2 - ((cpuRegs.CP0.n.Config >> 18) & 0x1));
 		try {
-			opcode.recompile();
+			if (super_jump >= 0)
+				recSuperJump(s_super_jump_to[super_jump]);
+			else
+				opcode.recompile();
 		} catch (Exception::FailedToAllocateRegister&) {
 			// Fall back to the interpreter
 			recCall(opcode.interpret);
+			g_fpuFiniteRegs = 0;
 #if 0
 			// TODO: Free register ?
 			//	_freeXMMregs();
@@ -1720,8 +2087,48 @@ void doPlace0Patches()
     ApplyLoadedPatches(PPT_ONCE_ON_LOAD);
 }
 
+// Called by a block whose counter ran out: it gets recompiled as a superblock next time.
+static void __fastcall recPromoteBlock(u32 startpc)
+{
+	s_hot_blocks.insert(HWADDR(startpc));
+
+	BASEBLOCKEX* block = recBlocks.Get(HWADDR(startpc));
+	if (block && block->startpc == HWADDR(startpc))
+		recClear(HWADDR(startpc), std::max<u32>(block->size, 1));
+}
+
+// Decides whether the scan of a hot block goes on at the target of the unconditional
+// jump at from, rather than ending the block.  Only forward jumps within the page of the
+// block qualify: the block then still covers a single range, which keeps the page
+// protection and recClear of anything it was built from working as is.
+static bool recFollowJump(u32 from, u32 target)
+{
+	if (!s_nBlockHot || s_nSuperJumps >= MAX_SUPER_JUMPS || EmuConfig.Gamefixes.GoemonTlbHack)
+		return false;
+
+	if (target <= from + 4 || ((target ^ from) & ~0xfff))
+		return false;
+
+	if (isBreakpointNeeded(from + 4))
+		return false;
+
+	// The delay slot must be a plain instruction
+	const u32* delay = (u32*)PSM(from + 4);
+	u32 read, write;
+	bool branch, likely;
+	if (!delay || !recGetRegUsage(*delay, read, write, branch, likely) || branch)
+		return false;
+
+	s_super_jump_from[s_nSuperJumps] = from;
+	s_super_jump_to[s_nSuperJumps] = target;
+	s_nSuperJumps++;
+	return true;
+}
+
 static void __fastcall recRecompile( const u32 startpc )
 {
+	TIMELINE_SCOPE("EE recompile");
+	RecompileStatsScope stats(g_eeRecStats, recPtr);
 	u32 i = 0;
 	u32 willbranch3 = 0;
 	u32 usecop2;
@@ -1744,8 +2151,16 @@ static void __fastcall recRecompile( const u32 startpc )
 	if (eeRecNeedsReset) recResetRaw();
 
 	xSetPtr( recPtr );
+
+	// superblocks mostly are the heads of loops
+	if (s_hot_blocks.count(HWADDR(startpc)))
+		xAlignJumpTarget(32, 31);
+
 	recPtr = xGetAlignedCallTarget();
 
+	if (EmuConfig.Cpu.Recompiler.RelaxEE)
+		xRelaxBegin();
+
 	if (0x8000d618 == startpc)
 		DbgCon.WriteLn("Compiling block @ 0x%08x", startpc);
 
@@ -1771,6 +2186,8 @@ static void __fastcall recRecompile( const u32 startpc )
 
 	if (g_eeloadMain && HWADDR(startpc) == HWADDR(g_eeloadMain))
 	{
+		// linked blocks don't update the pc, the boot snapshot needs it
+		xMOV(ptr32[&cpuRegs.pc], startpc);
 		xFastCall((void*)eeloadHook);
 		if (g_SkipBiosHack)
 		{
@@ -1817,6 +2234,7 @@ static void __fastcall recRecompile( const u32 startpc )
 	s_nBlockCycles = 0;
 	pc = startpc;
 	g_cpuHasConstReg = g_cpuFlushedConstReg = 1;
+	g_fpuFiniteRegs = 0;
 	pxAssert( g_cpuConstRegs[0].UD[0] == 0 );
 
 	_initX86regs();
@@ -1843,15 +2261,32 @@ static void __fastcall recRecompile( const u32 startpc )
 		}
 	}
 
+	s_nBlockHot = s_hot_blocks.count(HWADDR(startpc)) != 0;
+	s_nSuperJumps = 0;
+	s_nStartBlock = startpc;
+
+	if (!s_nBlockHot && HWADDR(startpc) < Ps2MemSize::MainRam && s_hot_counters_next < HOT_COUNTER_COUNT)
+	{
+		s32* counter = &s_hot_counters[s_hot_counters_next++];
+		*counter = HOT_BLOCK_THRESHOLD;
+
+		xSUB(ptr32[counter], 1);
+		xForwardJNZ8 cold;
+		xFastCall((void*)recPromoteBlock, startpc);
+		xJMP((void*)DispatcherReg);
+		cold.SetTarget();
+	}
+
+	if (recBlockProfilerEnabled())
+		recBlockProfilerEmit(startpc);
+
 	// go until the next branch
 	i = startpc;
 	s_nEndBlock = 0xffffffff;
 	s_branchTo = -1;
 
 	// compile breakpoints as individual blocks
-	int n1 = isBreakpointNeeded(i);
-	int n2 = isMemcheckNeeded(i);
-	int n = std::max<int>(n1,n2);
+	int n = isBreakpointNeeded(i);
 	if (n != 0)
 	{
 		s_nEndBlock = i + n*4;
@@ -1862,7 +2297,7 @@ static void __fastcall recRecompile( const u32 startpc )
 		BASEBLOCK* pblock = PC_GETBLOCK(i);
 
 		// stop before breakpoints
-		if (isBreakpointNeeded(i) != 0 || isMemcheckNeeded(i) != 0)
+		if (isBreakpointNeeded(i) != 0)
 		{
 			s_nEndBlock = i;
 			break;
@@ -1913,6 +2348,10 @@ static void __fastcall recRecompile( const u32 startpc )
 			case 2: // J
 			case 3: // JAL
 				s_branchTo = _InstrucTarget_ << 2 | (i + 4) & 0xf0000000;
+				if (_Opcode_ == 2 && recFollowJump(i, s_branchTo)) {
+					i = s_branchTo;
+					continue;
+				}
 				s_nEndBlock = i + 8;
 				goto StartRecomp;
 
@@ -1920,6 +2359,10 @@ static void __fastcall recRecompile( const u32 startpc )
 			case 4: case 5: case 6: case 7:
 			case 20: case 21: case 22: case 23:
 				s_branchTo = _Imm_ * 4 + i + 4;
+				if (_Opcode_ == 4 && _Rs_ == _Rt_ && recFollowJump(i, s_branchTo)) { // B
+					i = s_branchTo;
+					continue;
+				}
 				if( s_branchTo > startpc && s_branchTo < i ) s_nEndBlock = s_branchTo;
 				else  s_nEndBlock = i+8;
 
@@ -1964,7 +2407,7 @@ StartRecomp:
 	// without a significant loss in cycle accuracy is with a division, but games would probably
 	// be happy with time wasting loops completing in 0 cycles and timeouts waiting forever.
 	s_nBlockFF = false;
-	if (s_branchTo == startpc) {
+	if (s_branchTo == startpc && !s_nSuperJumps) {
 		s_nBlockFF = true;
 
 		u32 reads = 0, loads = 1;
@@ -2045,6 +2488,8 @@ StartRecomp:
 			pxAssert( s_pInstCache != NULL );
 		}
 
+		recBlockLiveness(startpc, s_nEndBlock, s_pCurBlockEx->gpr_in, s_pCurBlockEx->gpr_kill);
+
 		pcur = s_pInstCache + (s_nEndBlock-startpc)/4;
 		_recClearInst(pcur);
 		pcur->info = 0;
@@ -2152,6 +2597,7 @@ StartRecomp:
 		}
 
 		memcpy(&recRAMCopy[HWADDR(startpc) / 4], PSM(startpc), pc - startpc);
+		s_pCurBlockEx->hash = recBlockHash((u32*)PSM(startpc), s_pCurBlockEx->size);
 	}
 
 	s_pCurBlock->SetFnptr((uptr)recPtr);
@@ -2197,11 +2643,24 @@ StartRecomp:
 			{
 				xMOV( ptr32[&cpuRegs.pc], pc );
 				xADD( ptr32[&cpuRegs.cycle], scaleblockcycles() );
-				recBlocks.Link( HWADDR(pc), xJcc32() );
+				recLink( HWADDR(pc), xJcc32() );
 			}
 		}
 	}
 
+	vtlb_DynGenFastmemThunks();
+
+	if (x86Relax)
+	{
+		xRelaxEnd();
+
+		for (const std::pair<u32, s32*>& link : s_relax_links)
+			recBlocks.Link(link.first, (s32*)xRelaxMap(link.second));
+		s_relax_links.clear();
+	}
+
+	vtlb_MapFastmemThunks();
+
 	pxAssert( xGetPtr() < recMem->GetPtrEnd() );
 	pxAssert( recConstBufPtr < recConstBuf + RECCONSTBUF_SIZE );
 
@@ -2215,6 +2674,7 @@ StartRecomp:
 	}
 #endif
 	Perf::ee.map(s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->startpc);
+	recBlockProfilerMap((void*)s_pCurBlockEx->fnptr, s_pCurBlockEx->x86size, s_pCurBlockEx->size);
 
 	recPtr = xGetPtr();
 
@@ -2222,6 +2682,53 @@ StartRecomp:
 
 	s_pCurBlock = NULL;
 	s_pCurBlockEx = NULL;
+
+	if (EmuConfig.Cpu.Recompiler.SpeculateEE)
+	{
+		recSpeculateQueue(s_nEndBlock);
+		if (s_branchTo != (u32)-1)
+			recSpeculateQueue(s_branchTo);
+	}
+}
+
+static bool recSpeculateTarget(u32 pc)
+{
+	if (!pc || (pc & 3) || HWADDR(pc) >= Ps2MemSize::MainRam || !PSM(pc))
+		return false;
+
+	// blocks with hooks and patches are compiled when they are reached
+	if (HWADDR(pc) == EELOAD_START || (g_eeloadMain && HWADDR(pc) == HWADDR(g_eeloadMain))
+		|| (g_eeloadExec && HWADDR(pc) == HWADDR(g_eeloadExec)) || (g_GameLoading && HWADDR(pc) == ElfEntry))
+		return false;
+
+	return PC_GETBLOCK(pc)->GetFnptr() == (uptr)JITCompile;
+}
+
+static void recSpeculateQueue(u32 pc)
+{
+	if (s_speculate_count < SPECULATE_QUEUE_SIZE && recSpeculateTarget(pc))
+		s_speculate_queue[s_speculate_count++] = pc;
+}
+
+// Called from the event test (at a vsync), so the recompiled code of the EE is still on the
+// stack: stop well before recRecompile would have to reset the code cache.
+static void recSpeculate(u64 deadline)
+{
+	const u32 code = cpuRegs.code;
+
+	while (s_speculate_count && GetCPUTicks() < deadline)
+	{
+		if (eeRecNeedsReset || !eeCpuExecuting || recPtr >= (recMem->GetPtrEnd() - _64kb * 2)
+			|| (recConstBufPtr - recConstBuf) >= RECCONSTBUF_SIZE - 128)
+			break;
+
+		const u32 pc = s_speculate_queue[--s_speculate_count];
+		if (recSpeculateTarget(pc))
+			recRecompile(pc);
+	}
+
+	// the interpreter fallbacks of the current block did read it
+	cpuRegs.code = code;
 }
 
 // The only *safe* way to throw exceptions from the context of recompiled code.
@@ -2272,6 +2779,8 @@ R5900cpu recCpu =
 	recThrowException,
 	recThrowException,
 	recClear,
+	recClearLazy,
+	recSpeculate,
 
 	recGetCacheReserve,
 	recSetCacheReserve,
@@ -0,0 +1,218 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Per-block profiler of the EE recompiler (Profiler.Enabled && Profiler.RecBlocks_EE).
+//
+// Every block counts its entries, and publishes itself as the running block on entry.
+// A sampler thread reads the running block every millisecond, so the samples of a
+// block are the host time spent in it (and in the helpers it calls) in ms.
+//
+// On reset and shutdown of the recompiler, the profile is written to:
+//  * /tmp/perf-<pid>.map, so perf can symbolize the recompiled code
+//  * /tmp/pcsx2-ee-<pid>.folded, the samples as stacks for flamegraph.pl
+//  * the console, the hottest blocks
+
+#include "PrecompiledHeader.h"
+
+#include "Common.h"
+#include "iR5900.h"
+#include "DebugTools/SymbolMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace x86Emitter;
+
+struct BlockProfile
+{
+	u64 count; // first, the block increments it through rax
+	u64 samples;
+	u32 startpc;
+	u32 size;
+	const u8* x86ptr;
+	u32 x86size;
+};
+
+static std::deque<BlockProfile> s_profiles;
+static BlockProfile* s_profile_building = NULL;
+static BlockProfile* volatile s_profile_current = NULL;
+
+static std::mutex s_profile_lock;
+static std::thread s_profile_sampler;
+static std::atomic<bool> s_profile_sampling(false);
+
+static void recBlockProfilerSample()
+{
+	while (s_profile_sampling.load(std::memory_order_relaxed))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		std::lock_guard<std::mutex> lock(s_profile_lock);
+		if (BlockProfile* p = s_profile_current)
+			p->samples++;
+	}
+}
+
+bool recBlockProfilerEnabled()
+{
+	return EmuConfig.Profiler.Enabled && EmuConfig.Profiler.RecBlocks_EE;
+}
+
+void recBlockProfilerEmit(u32 startpc)
+{
+	if (!s_profile_sampling.exchange(true))
+		s_profile_sampler = std::thread(recBlockProfilerSample);
+
+	{
+		std::lock_guard<std::mutex> lock(s_profile_lock);
+		s_profiles.push_back(BlockProfile());
+	}
+
+	BlockProfile* p = &s_profiles.back();
+	memzero(*p);
+	p->startpc = startpc;
+	s_profile_building = p;
+
+	xMOV64(rax, (uptr)p);
+	xADD(ptr64[rax], 1);
+	xMOV(ptrNative[(void*)&s_profile_current], rax);
+}
+
+void recBlockProfilerMap(const void* x86ptr, u32 x86size, u32 size)
+{
+	if (BlockProfile* p = s_profile_building)
+	{
+		p->x86ptr = (const u8*)x86ptr;
+		p->x86size = x86size;
+		p->size = size;
+		s_profile_building = NULL;
+	}
+}
+
+// Names the blocks after the function containing them, or their own label
+static std::vector<std::string> recBlockProfilerSymbols(const std::vector<const BlockProfile*>& blocks)
+{
+	std::vector<u32> pcs(blocks.size());
+	for (size_t i = 0; i < blocks.size(); i++)
+		pcs[i] = blocks[i]->startpc;
+
+	std::vector<u32> funcs(blocks.size());
+	std::vector<std::string> names(blocks.size());
+	symbolMap.Symbolize(pcs.data(), pcs.size(), ST_FUNCTION, funcs.data(), names.data());
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		if (names[i].empty())
+		{
+			char name[16];
+			snprintf(name, sizeof(name), "sub_%08x", funcs[i] != SymbolMap::INVALID_ADDRESS ? funcs[i] : pcs[i]);
+			names[i] = name;
+		}
+	}
+
+	return names;
+}
+
+static void recBlockProfilerDump()
+{
+	if (s_profiles.empty())
+		return;
+
+	char path[256];
+	std::vector<const BlockProfile*> blocks;
+	blocks.reserve(s_profiles.size());
+	for (const BlockProfile& p : s_profiles)
+	{
+		// skip the block that was cut by the reset
+		if (p.x86ptr)
+			blocks.push_back(&p);
+	}
+
+	const std::vector<std::string> names = recBlockProfilerSymbols(blocks);
+
+#ifndef _WIN32
+	snprintf(path, sizeof(path), "/tmp/perf-%d.map", getpid());
+	if (FILE* fp = fopen(path, "a"))
+	{
+		for (size_t i = 0; i < blocks.size(); i++)
+			fprintf(fp, "%zx %x EE:%s:%08x\n", (size_t)blocks[i]->x86ptr, blocks[i]->x86size, names[i].c_str(), blocks[i]->startpc);
+		fclose(fp);
+	}
+
+	snprintf(path, sizeof(path), "/tmp/pcsx2-ee-%d.folded", getpid());
+#else
+	snprintf(path, sizeof(path), "pcsx2-ee-%d.folded", getpid());
+#endif
+	if (FILE* fp = fopen(path, "a"))
+	{
+		for (size_t i = 0; i < blocks.size(); i++)
+		{
+			if (blocks[i]->samples)
+				fprintf(fp, "EE;%s;%08x %llu\n", names[i].c_str(), blocks[i]->startpc, (unsigned long long)blocks[i]->samples);
+		}
+		fclose(fp);
+	}
+
+	std::vector<size_t> order(blocks.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return blocks[a]->samples > blocks[b]->samples; });
+
+	u64 total = 0;
+	for (const BlockProfile* p : blocks)
+		total += p->samples;
+
+	if (total == 0)
+		return;
+
+	DevCon.WriteLn("EE Block Profiler: %zu blocks, %llu ms (profile in %s)", blocks.size(), (unsigned long long)total, path);
+	for (size_t i = 0; i < std::min<size_t>(order.size(), 20); i++)
+	{
+		const BlockProfile* p = blocks[order[i]];
+		if (!p->samples)
+			break;
+		DevCon.WriteLn("%6.2f%% %8llu ms %12llu entries  %08x (%3u ops)  %s", p->samples * 100.0 / total,
+			(unsigned long long)p->samples, (unsigned long long)p->count, p->startpc, p->size, names[order[i]].c_str());
+	}
+}
+
+void recBlockProfilerReset()
+{
+	std::lock_guard<std::mutex> lock(s_profile_lock);
+
+	s_profile_current = NULL;
+	s_profile_building = NULL;
+
+	recBlockProfilerDump();
+	s_profiles.clear();
+}
+
+void recBlockProfilerShutdown()
+{
+	recBlockProfilerReset();
+
+	if (s_profile_sampling.exchange(false))
+		s_profile_sampler.join();
+}
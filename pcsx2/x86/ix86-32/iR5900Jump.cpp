@@ -77,7 +77,13 @@ void recJAL()
 		xMOV(ptr32[&cpuRegs.GPR.r[31].UL[1]], 0);
 	}
 
+	u32 retpc = pc + 4;
+
 	recompileNextInstruction(1);
+
+	iFlushCall(FLUSH_EVERYTHING);
+	recPushReturnAddress(retpc);
+
 	if (EmuConfig.Gamefixes.GoemonTlbHack)
 		SetBranchImm(vtlb_V2P(newpc));
 	else
@@ -157,6 +163,12 @@ void recJALR()
 		xMOV(ptr[&cpuRegs.pc], eax);
 	}
 
+	if ( _Rd_ )
+	{
+		iFlushCall(FLUSH_EVERYTHING);
+		recPushReturnAddress(newpc);
+	}
+
 	SetBranchReg(0xffffffff);
 }
 
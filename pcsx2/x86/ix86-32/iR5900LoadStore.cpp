@@ -504,6 +504,7 @@ void recLWC1()
 	recCall(::R5900::Interpreter::OpcodeImpl::LWC1);
 #else
 	_deleteFPtoXMMreg(_Rt_, 2);
+	FPR_DEL_FINITE(_Rt_);
 
 	if (GPR_IS_CONST1(_Rs_))
 	{
@@ -719,6 +719,11 @@ void eeFPURecompileCode(R5900FNPTR_INFO xmmcode, R5900FNPTR fpucode, int xmminfo
 		pxAssert( mmregs >= 0 || mmregt >= 0 );
 	}
 
+	g_fpuFiniteResult = false;
 	xmmcode(info);
+
+	if( xmminfo & XMMINFO_WRITED ) FPR_SET_FINITE(_Fd_, g_fpuFiniteResult);
+	if( xmminfo & XMMINFO_WRITEACC ) FPR_SET_FINITE(XMMFPU_ACC, g_fpuFiniteResult);
+
 	_clearNeededXMMregs();
 }
@@ -18,10 +18,14 @@
 
 #include "Common.h"
 #include "vtlb.h"
+#include "Cache.h"
 
 #include "iCore.h"
 #include "iR5900.h"
 #include "Utilities/Perf.h"
+#include "Utilities/PageFaultSource.h"
+
+#include <unordered_map>
 
 using namespace vtlb_private;
 using namespace x86Emitter;
@@ -368,19 +372,314 @@ static void vtlb_SetWriteback(u32 *writeback)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
-//                            Dynarec Load Implementations
-void vtlb_DynGenRead64(u32 bits)
+//                            Fastmem
+//
+// Non-const loads read straight out of vtlbdata.fastmem, where only the pages backed by
+// direct memory are accessible.  A load hitting anything else (a handler, an unmapped TLB
+// page) faults; the fault handler then overwrites the faulting instruction with a jump to
+// a thunk emitted at the end of the block, which does the regular vtlb lookup and jumps
+// back.  Once patched a site stays on the vtlb path until the block is recompiled.
+
+struct FastmemSite
 {
-	pxAssume( bits == 64 || bits == 128 );
+	u8* code;		// faulting load, at least 5 bytes up to resume
+	u8* resume;
+	u32 bits;
+	bool sign;
+};
+
+static std::vector<FastmemSite> s_fastmem_pending;		// sites of the block being compiled
+static std::vector<std::pair<u8*, u8*>> s_fastmem_thunks;	// ... and their thunks
+static std::unordered_map<uptr, uptr> s_fastmem_sites;	// load -> thunk
+
+class vtlb_FastmemFaultHandler : public EventListener_PageFault
+{
+public:
+	void OnPageFaultEvent(const PageFaultInfo& info, bool& handled)
+	{
+		if (!vtlbdata.fastmem || info.addr < (uptr)vtlbdata.fastmem || info.addr - (uptr)vtlbdata.fastmem > _4gb)
+			return;
+
+		auto it = s_fastmem_sites.find(info.pc);
+		if (it == s_fastmem_sites.end())
+			return;
+
+		// Recompiled code is writable, and the faulting thread re-executes from the jmp.
+		u8* code = (u8*)it->first;
+		code[0] = 0xE9;
+		*(s32*)(code + 1) = (s32)(it->second - ((uptr)code + 5));
+
+		s_fastmem_sites.erase(it);
+		handled = true;
+	}
+};
+
+static vtlb_FastmemFaultHandler* s_fastmem_handler = NULL;
+
+static bool vtlb_FastmemEnabled()
+{
+	return vtlbdata.fastmem && s_fastmem_handler && EmuConfig.Cpu.Recompiler.EnableFastmem;
+}
+
+// Recompiled input registers:
+//   ecx - source address to read from, zero extended
+//   edx - destination buffer (64 bits)
+static void DynGen_FastmemRead(u32 bits, bool sign)
+{
+	EE::Profiler.EmitMem();
+
+	xMOV64(rax, (sptr)vtlbdata.fastmem);
+
+	u8* code = xGetPtr();
+	switch (bits)
+	{
+		case 8:
+			if (sign)
+				xMOVSX(eax, ptr8[rax + arg1reg]);
+			else
+				xMOVZX(eax, ptr8[rax + arg1reg]);
+		break;
+
+		case 16:
+			if (sign)
+				xMOVSX(eax, ptr16[rax + arg1reg]);
+			else
+				xMOVZX(eax, ptr16[rax + arg1reg]);
+		break;
+
+		case 32:
+			xMOV(eax, ptr[rax + arg1reg]);
+		break;
+
+		case 64:
+			xMOV(rax, ptr[rax + arg1reg]);
+			xMOV(ptr[arg2reg], rax);
+		break;
+
+		jNO_DEFAULT
+	}
+
+	// Room for the jmp rel32 of the patch
+	while (xGetPtr() < code + 5)
+		xNOP();
 
+	s_fastmem_pending.push_back({code, xGetPtr(), bits, sign});
+}
+
+static void DynGen_VtlbRead(u32 bits, bool sign)
+{
 	u32* writeback = DynGen_PrepRegs();
 
-	DynGen_IndirectDispatch( 0, bits );
-	DynGen_DirectRead( bits, false );
+	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
+	DynGen_DirectRead( bits, sign );
 
 	vtlb_SetWriteback(writeback);		// return target for indirect's call/ret
 }
 
+// Emits the slow path thunks of the fastmem loads of the current block.  Must be called
+// after the last exit of the block, so the thunks are only ever reached through patches.
+void vtlb_DynGenFastmemThunks()
+{
+	for (const FastmemSite& site : s_fastmem_pending)
+	{
+		s_fastmem_thunks.push_back(std::make_pair(site.code, xGetPtr()));
+
+		DynGen_VtlbRead(site.bits, site.sign);
+		xJMP(site.resume);
+	}
+
+	s_fastmem_pending.clear();
+}
+
+// Arms the sites of the current block, once its code is final (see xRelaxEnd).
+void vtlb_MapFastmemThunks()
+{
+	for (const std::pair<u8*, u8*>& thunk : s_fastmem_thunks)
+		s_fastmem_sites[(uptr)xRelaxMap(thunk.first)] = (uptr)xRelaxMap(thunk.second);
+
+	s_fastmem_thunks.clear();
+}
+
+// Forgets the fastmem sites, called whenever the recompiled code is thrown away.
+void vtlb_ResetFastmem()
+{
+	s_fastmem_pending.clear();
+	s_fastmem_thunks.clear();
+	s_fastmem_sites.clear();
+
+	if (!s_fastmem_handler && Source_PageFault)
+		s_fastmem_handler = new vtlb_FastmemFaultHandler();
+}
+
+void vtlb_ShutdownFastmem()
+{
+	s_fastmem_pending.clear();
+	s_fastmem_thunks.clear();
+	s_fastmem_sites.clear();
+	safe_delete(s_fastmem_handler);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//                            EE data cache
+//
+// With the EE cache enabled, accesses to the pages of cached TLB entries check the tags
+// of the set inline, and go straight to the cache line on a hit.  Misses call Cache.cpp,
+// which fills the line.  Everything else takes the regular path emitted by uncached.
+
+static bool vtlb_CacheEnabled()
+{
+	return CHECK_CACHE;
+}
+
+static void __fastcall vtlb_ReadCache64(u32 mem, mem64_t* out)
+{
+	*out = readCache64(mem);
+}
+
+static void __fastcall vtlb_ReadCache128(u32 mem, mem128_t* out)
+{
+	out->lo = readCache64(mem);
+	out->hi = readCache64(mem + 8);
+}
+
+static void __fastcall vtlb_WriteCache64(u32 mem, const mem64_t* value)
+{
+	writeCache64(mem, *value);
+}
+
+static void* vtlb_CacheMissHandler(int mode, u32 bits)
+{
+	switch (bits)
+	{
+		case 8:   return mode ? (void*)writeCache8  : (void*)readCache8;
+		case 16:  return mode ? (void*)writeCache16 : (void*)readCache16;
+		case 32:  return mode ? (void*)writeCache32 : (void*)readCache32;
+		case 64:  return mode ? (void*)vtlb_WriteCache64 : (void*)vtlb_ReadCache64;
+		case 128: return mode ? (void*)writeCache128 : (void*)vtlb_ReadCache128;
+		jNO_DEFAULT
+	}
+	return NULL;
+}
+
+// Recompiled input registers:
+//   ecx - address
+//   edx - data (8 to 32 bits) or data pointer (64 and 128 bits)
+// Clobbers rax, rbx and arg3.
+template <typename Uncached>
+static void DynGen_CacheCheck(int mode, u32 bits, bool sign, Uncached uncached)
+{
+	xMOV(eax, arg1regd);
+	xSHR(eax, VTLB_PAGE_BITS);
+	xCMP(ptr8[xComplexAddress(rbx, cachePages, rax)], 0);
+	xForwardJE32 uncached_page;
+	xTEST(ptr32[&cpuRegs.CP0.n.Config], 0x10000);
+	xForwardJZ32 cache_off;
+
+	// Tags hold the host pointer of the line, which handlers don't have
+	xMOV(rax, ptrNative[xComplexAddress(rbx, vtlbdata.vmap, rax*wordsize)]);
+	xADD(rax, arg1reg);
+	xForwardJS32 handler;
+
+	xAND(rax, ~0xFFF);
+	xOR(rax, CACHE_TAG_VALID);
+	xMOV(rbx, rax);
+
+	// rax = &sets[(addr >> 6) & 63]
+	xMOV(eax, arg1regd);
+	xSHR(eax, 6);
+	xAND(eax, 0x3F);
+	xLEA(eax, ptr[rax*2 + rax]);
+	xSHL(eax, 6);
+	xLoadFarAddr(arg3reg, cacheSets());
+	xADD(rax, arg3reg);
+
+	xMOV(arg3reg, ptrNative[rax]);
+	xAND(arg3reg, (s32)CACHE_TAG_MATCH);
+	xCMP(arg3reg, rbx);
+	xForwardJE8 way0;
+
+	xMOV(arg3reg, ptrNative[rax + 8]);
+	xAND(arg3reg, (s32)CACHE_TAG_MATCH);
+	xCMP(arg3reg, rbx);
+	xForwardJNE32 miss;
+
+	if (mode)
+		xOR(ptr8[rax + 8], CACHE_TAG_DIRTY);
+	xADD(rax, CACHE_SET_DATA);
+	xForwardJump8 hit;
+
+	way0.SetTarget();
+	if (mode)
+		xOR(ptr8[rax], CACHE_TAG_DIRTY);
+
+	hit.SetTarget();
+	xMOV(ebx, arg1regd);
+	xAND(ebx, 0x3F & ~(bits / 8 - 1));
+	xLEA(arg1reg, ptr[rax + rbx + CACHE_SET_DATA]);
+	if (mode)
+		DynGen_DirectWrite(bits);
+	else
+		DynGen_DirectRead(bits, sign);
+	xForwardJump32 hit_done;
+
+	miss.SetTarget();
+	xFastCall(vtlb_CacheMissHandler(mode, bits), arg1reg, arg2reg);
+	if (!mode && bits < 32)
+	{
+		if (bits == 8)
+		{
+			if (sign)
+				xMOVSX(eax, al);
+			else
+				xMOVZX(eax, al);
+		}
+		else
+		{
+			if (sign)
+				xMOVSX(eax, ax);
+			else
+				xMOVZX(eax, ax);
+		}
+	}
+	xForwardJump32 miss_done;
+
+	uncached_page.SetTarget();
+	cache_off.SetTarget();
+	handler.SetTarget();
+	uncached();
+
+	hit_done.SetTarget();
+	miss_done.SetTarget();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//                            Dynarec Load Implementations
+static void DynGen_Read64(u32 bits)
+{
+	if (bits == 64 && vtlb_FastmemEnabled())
+		DynGen_FastmemRead(bits, false);
+	else
+		DynGen_VtlbRead(bits, false);
+}
+
+void vtlb_DynGenRead64(u32 bits)
+{
+	pxAssume( bits == 64 || bits == 128 );
+
+	if (vtlb_CacheEnabled())
+		DynGen_CacheCheck(0, bits, false, [&] { DynGen_Read64(bits); });
+	else
+		DynGen_Read64(bits);
+}
+
+static void DynGen_Read32(u32 bits, bool sign)
+{
+	if (vtlb_FastmemEnabled())
+		DynGen_FastmemRead(bits, sign);
+	else
+		DynGen_VtlbRead(bits, sign);
+}
+
 // ------------------------------------------------------------------------
 // Recompiled input registers:
 //   ecx - source address to read from
@@ -389,12 +688,24 @@ void vtlb_DynGenRead32(u32 bits, bool sign)
 {
 	pxAssume( bits <= 32 );
 
-	u32* writeback = DynGen_PrepRegs();
-
-	DynGen_IndirectDispatch( 0, bits, sign && bits < 32 );
-	DynGen_DirectRead( bits, sign );
+	if (vtlb_CacheEnabled())
+		DynGen_CacheCheck(0, bits, sign, [&] { DynGen_Read32(bits, sign); });
+	else
+		DynGen_Read32(bits, sign);
+}
 
-	vtlb_SetWriteback(writeback);
+// Const addresses in cached pages take the dynamic path, so the tags are checked at
+// run time.  The arguments are already loaded, and nothing is cached in registers yet.
+static bool DynGen_CachedConst(u32 addr_const)
+{
+	if (!vtlb_CacheEnabled() || vtlbdata.vmap[addr_const >> VTLB_PAGE_BITS].isHandler(addr_const))
+		return false;
+	if (!cachePages[addr_const >> VTLB_PAGE_BITS])
+		return false;
+
+	iFlushCall(FLUSH_FULLVTLB);
+	xMOV(arg1regd, addr_const);
+	return true;
 }
 
 // ------------------------------------------------------------------------
@@ -404,6 +715,12 @@ void vtlb_DynGenRead64_Const( u32 bits, u32 addr_const )
 {
 	EE::Profiler.EmitConstMem(addr_const);
 
+	if (DynGen_CachedConst(addr_const))
+	{
+		vtlb_DynGenRead64(bits);
+		return;
+	}
+
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
@@ -450,6 +767,12 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 {
 	EE::Profiler.EmitConstMem(addr_const);
 
+	if (DynGen_CachedConst(addr_const))
+	{
+		vtlb_DynGenRead32(bits, sign);
+		return;
+	}
+
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
@@ -521,7 +844,7 @@ void vtlb_DynGenRead32_Const( u32 bits, bool sign, u32 addr_const )
 //////////////////////////////////////////////////////////////////////////////////////////
 //                            Dynarec Store Implementations
 
-void vtlb_DynGenWrite(u32 sz)
+static void DynGen_Write(u32 sz)
 {
 	u32* writeback = DynGen_PrepRegs();
 
@@ -531,6 +854,14 @@ void vtlb_DynGenWrite(u32 sz)
 	vtlb_SetWriteback(writeback);
 }
 
+void vtlb_DynGenWrite(u32 sz)
+{
+	if (vtlb_CacheEnabled())
+		DynGen_CacheCheck(1, sz, false, [&] { DynGen_Write(sz); });
+	else
+		DynGen_Write(sz);
+}
+
 
 // ------------------------------------------------------------------------
 // Generates code for a store instruction, where the address is a known constant.
@@ -540,6 +871,12 @@ void vtlb_DynGenWrite_Const( u32 bits, u32 addr_const )
 {
 	EE::Profiler.EmitConstMem(addr_const);
 
+	if (DynGen_CachedConst(addr_const))
+	{
+		vtlb_DynGenWrite(bits);
+		return;
+	}
+
 	auto vmv = vtlbdata.vmap[addr_const>>VTLB_PAGE_BITS];
 	if( !vmv.isHandler(addr_const) )
 	{
@@ -19,12 +19,16 @@
 #include "microVU.h"
 
 #include "Utilities/Perf.h"
+#include "Elfheader.h"
+#include "AppConfig.h"
+#include <wx/ffile.h>
 
 //------------------------------------------------------------------
 // Micro VU - Main Functions
 //------------------------------------------------------------------
 static u8 __pagealigned vu0_RecDispatchers[mVUdispCacheSize];
 static u8 __pagealigned vu1_RecDispatchers[mVUdispCacheSize];
+RecompileStats g_vuRecStats[2];
 
 static __fi void mVUthrowHardwareDeficiency(const wxChar* extFail, int vuIndex) {
 	throw Exception::HardwareDeficiency()
@@ -68,13 +72,13 @@ void mVUinit(microVU& mVU, uint vuIndex) {
 	if (vuIndex) mVU.dispCache = vu1_RecDispatchers;
 	else mVU.dispCache = vu0_RecDispatchers;
 
-	mVU.regAlloc.reset(new microRegAlloc(mVU.index));
+	mVU.regAlloc.reset(new microRegAlloc(mVU.index, mVU.prog.IRinfo.info, &mVU.prog.IRinfo.curPC, mVU.progMemMask / 2));
 }
 
 // Resets Rec Data
 void mVUreset(microVU& mVU, bool resetReserve) {
 
-	if (THREAD_VU1)
+	if (THREAD_VU1 && mVU.index)
 	{
 		DevCon.Warning("mVU Reset");
 		// If MTVU is toggled on during gameplay we need to flush the running VU1 program, else it gets in a mess
@@ -95,18 +99,38 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 	mVUdispatcherCD(mVU);
 	mVUemitSearch();
 
+	mVUresetProgs(mVU);
+	if (resetReserve) mVU.prog.cacheCRC = 0;
+
+	// Code of the whole micro memory is checked for flag reads at the next execution
+	mVU.flagReads		= 0;
+	mVU.flagReadsStart	= 0;
+	mVU.flagReadsEnd	= mVU.microMemSize;
+
+	HostSys::MemProtect(mVU.dispCache, mVUdispCacheSize, PageAccess_ExecOnly());
+
+	if (mVU.index) Perf::any.map((uptr)&mVU.dispCache, mVUdispCacheSize, "mVU1 Dispatcher");
+	else           Perf::any.map((uptr)&mVU.dispCache, mVUdispCacheSize, "mVU0 Dispatcher");
+}
+
+// Deletes all programs and starts over the rec-cache
+void mVUresetProgs(microVU& mVU) {
 	// Clear All Program Data
 	//memset(&mVU.prog, 0, sizeof(mVU.prog));
 	memset(&mVU.prog.lpState, 0, sizeof(mVU.prog.lpState));
 	mVU.profiler.Reset(mVU.index);
+	mVUprofileDump(mVU);
 
 	// Program Variables
 	mVU.prog.cleared	=  1;
 	mVU.prog.isSame		= -1;
 	mVU.prog.cur		= NULL;
+	mVU.prog.entered	= NULL;
 	mVU.prog.total		=  0;
 	mVU.prog.curFrame	=  0;
 
+	mVUsaveProgCache(mVU);
+
 	// Setup Dynarec Cache Limits for Each Program
 	u8* z = mVU.cache;
 	mVU.prog.x86start	= z;
@@ -127,16 +151,13 @@ void mVUreset(microVU& mVU, bool resetReserve) {
 		mVU.prog.quick[i].block = NULL;
 		mVU.prog.quick[i].prog  = NULL;
 	}
-
-	HostSys::MemProtect(mVU.dispCache, mVUdispCacheSize, PageAccess_ExecOnly());
-
-	if (mVU.index) Perf::any.map((uptr)&mVU.dispCache, mVUdispCacheSize, "mVU1 Dispatcher");
-	else           Perf::any.map((uptr)&mVU.dispCache, mVUdispCacheSize, "mVU0 Dispatcher");
 }
 
 // Free Allocated Resources
 void mVUclose(microVU& mVU) {
 
+	mVUsaveProgCache(mVU);
+	mVUprofileDump(mVU);
 	safe_delete  (mVU.cache_reserve);
 
 	// Delete Programs and Block Managers
@@ -150,14 +171,67 @@ void mVUclose(microVU& mVU) {
 	}
 }
 
+// Checks if a write to [addr, addr+size) of VU memory touches the recompiled ranges of prog
+static bool mVUrangesOverlap(const microProgram& prog, u32 addr, u32 size) {
+	for (const auto& range : *prog.ranges) {
+		if (range.end < 0) return true; // Range still being recompiled
+		if ((addr < (u32)range.end + 8) && (addr + size > (u32)range.start))
+			return true;
+	}
+	return false;
+}
+
 // Clears Block Data in specified range
+// Programs whose recompiled ranges aren't written to keep their blocks and stay
+// the quick-reference of their start PCs, they still match VU memory. Blocks are
+// chained by direct jumps, so a written program is dropped as a whole.
 __fi void mVUclear(mV, u32 addr, u32 size) {
-	if(!mVU.prog.cleared) {
+	mVU.prog.isSame = -1; // The copy of the current program no longer matches all of VU memory
+	mVU.flagReadsStart = std::min(mVU.flagReadsStart, addr);
+	mVU.flagReadsEnd   = std::min(std::max(mVU.flagReadsEnd, addr + size), mVU.microMemSize);
+	if (mVU.prog.cleared) return;
+
+	if (!mVU.prog.cur || mVUrangesOverlap(*mVU.prog.cur, addr, size)) {
 		mVU.prog.cleared = 1;		// Next execution searches/creates a new microprogram
 		memzero(mVU.prog.lpState); // Clear pipeline state
-		for(u32 i = 0; i < (mVU.progSize / 2); i++) {
-			mVU.prog.quick[i].block = NULL; // Clear current quick-reference block
-			mVU.prog.quick[i].prog  = NULL; // Clear current quick-reference prog
+	}
+	for(u32 i = 0; i < (mVU.progSize / 2); i++) {
+		microProgramQuick& quick = mVU.prog.quick[i];
+		if (quick.prog && (mVU.prog.cleared || mVUrangesOverlap(*quick.prog, addr, size))) {
+			quick.block = NULL; // Clear current quick-reference block
+			quick.prog  = NULL; // Clear current quick-reference prog
+		}
+	}
+}
+
+// Flags read by the lower instructions of data in [start, end), as the bits of needExactMatch
+static u32 mVUscanFlagReads(const u32* data, u32 start, u32 end) {
+	u32 reads = 0;
+	for (u32 pc = start & ~7; pc < end; pc += 8) {
+		if (data[pc / 4 + 1] & _Ibit_) continue; // Lower instruction is the I reg value
+		switch (data[pc / 4] >> 25) {
+			case 0x10: case 0x12: case 0x13: case 0x1c: reads |= 4; break; // FCEQ, FCAND, FCOR, FCGET
+			case 0x18: case 0x1a: case 0x1b:            reads |= 2; break; // FMEQ, FMAND, FMOR
+			case 0x14: case 0x16: case 0x17:            reads |= 1; break; // FSEQ, FSAND, FSOR
+		}
+	}
+	return reads;
+}
+
+// Where a JR/JALR goes can't be known, so the flags of its last instructions are kept
+// for the flags some code in micro memory reads (flagReads) instead of for all flags.
+// Micro memory is only written to while the VU is idle, this is called before it runs:
+// when the new code reads other flags, the blocks compiled without them are dropped.
+void mVUupdateFlagReads(microVU& mVU) {
+	if (mVU.flagReadsStart >= mVU.flagReadsEnd) return;
+	const u32 reads = mVUscanFlagReads((u32*)mVU.regs().Micro, mVU.flagReadsStart, mVU.flagReadsEnd);
+	mVU.flagReadsStart = mVU.microMemSize;
+	mVU.flagReadsEnd   = 0;
+	if (reads & ~mVU.flagReads) {
+		mVU.flagReads |= reads;
+		if (mVU.prog.total) {
+			DevCon.WriteLn(Color_Green, "microVU%d: Code reading flags [%x] was uploaded, recompiling", mVU.index, mVU.flagReads);
+			mVUresetProgs(mVU);
 		}
 	}
 }
@@ -187,6 +261,7 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 	prog->idx     = mVU.prog.total++;
 	prog->ranges  = new std::deque<microRange>();
 	prog->startPC = startPC;
+	prog->hashDirty = true;
 	mVUcacheProg(mVU, *prog); // Cache Micro Program
 	double cacheSize = (double)((uptr)mVU.prog.x86end - (uptr)mVU.prog.x86start);
 	double cacheUsed =((double)((uptr)mVU.prog.x86ptr - (uptr)mVU.prog.x86start)) / (double)_1mb;
@@ -201,9 +276,201 @@ __ri microProgram* mVUcreateProg(microVU& mVU, int startPC) {
 __ri void mVUcacheProg(microVU& mVU, microProgram& prog) {
 	if (!mVU.index)	memcpy(prog.data, mVU.regs().Micro, 0x1000);
 	else			memcpy(prog.data, mVU.regs().Micro, 0x4000);
+	prog.hashDirty = true;
 	mVUdumpProg(mVU, prog);
 }
 
+//------------------------------------------------------------------
+// Micro VU - Program Profiler (Profiler.RecBlocks_VU0/VU1)
+//------------------------------------------------------------------
+
+// Every program counts the blocks recompiled for it and the searches that ended on it.
+// When profiling, the executions started in a program and the host time they took
+// are counted too. The programs that ran are appended, before they are deleted, to:
+//  * logs/mVU<index>_<crc>.csv, one row per program of each reset of the rec-cache
+//  * logs/mVU<index>_<crc>.txt, the disassembly of their recompiled ranges
+
+bool mVUprofiling(microVU& mVU) {
+	return EmuConfig.Profiler.Enabled && (mVU.index ? EmuConfig.Profiler.RecBlocks_VU1 : EmuConfig.Profiler.RecBlocks_VU0);
+}
+
+static wxString mVUprofileFile(microVU& mVU, const wxChar* ext) {
+	return Path::Combine(g_Conf->Folders.Logs, wxsFormat(L"mVU%u_%08X.%s", mVU.index, ElfCRC, ext));
+}
+
+static void mVUprofileWrite(wxFFile& f, const char* fmt, ...) {
+	char line[512];
+	va_list list;
+	va_start(list, fmt);
+	int len = vsnprintf(line, sizeof(line), fmt, list);
+	va_end(list);
+	if (len > 0) f.Write(line, std::min<size_t>(len, sizeof(line) - 1));
+}
+
+void mVUprofileDump(microVU& mVU) {
+	std::vector<const microProgram*> progs;
+	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+		if (!mVU.prog.prog[i]) continue;
+		for (const microProgram* prog : *mVU.prog.prog[i]) {
+			if (prog->runs) progs.push_back(prog);
+		}
+	}
+	if (progs.empty() || !g_Conf) return;
+
+	std::sort(progs.begin(), progs.end(), [](const microProgram* a, const microProgram* b) { return a->runTicks > b->runTicks; });
+	const double msPerTick = 1000.0 / (double)GetTickFrequency();
+	const u32 dump = mVU.prog.profileDumps++;
+
+	g_Conf->Folders.Logs.Mkdir();
+	wxFFile csv(mVUprofileFile(mVU, L"csv"), L"a");
+	wxFFile dis(mVUprofileFile(mVU, L"txt"), L"a");
+	if (!csv.IsOpened() || !dis.IsOpened()) return;
+
+	if (!csv.Length())
+		mVUprofileWrite(csv, "reset,prog,startpc,runs,ticks,ms,compiles,searches,variants\n");
+
+	for (const microProgram* prog : progs) {
+		mVUprofileWrite(csv, "%u,%d,%04x,%llu,%llu,%.3f,%u,%u,%u\n", dump, prog->idx, prog->startPC * 8,
+			(unsigned long long)prog->runs, (unsigned long long)prog->runTicks, prog->runTicks * msPerTick,
+			prog->compiles, prog->searches, (u32)mVU.prog.prog[prog->startPC]->size());
+
+		mVUprofileWrite(dis, "[reset %u] microVU%d program %d, startpc %04x\n", dump, mVU.index, prog->idx, prog->startPC * 8);
+		for (const auto& range : *prog->ranges) {
+			if ((range.start < 0) || (range.end < 0)) continue;
+			for (u32 pc = range.start; pc < std::min<u32>(range.end + 8, mVU.microMemSize); pc += 8) {
+				const u32 upper = prog->data[pc / 4 + 1];
+				const u32 lower = prog->data[pc / 4];
+				std::string op(disVU1MicroUF(upper, pc)); // VU0 shares the instruction set
+				if (upper & _Ibit_) mVUprofileWrite(dis, "%04x: %-32s  I = %f\n", pc, op.c_str(), *(float*)&lower);
+				else                mVUprofileWrite(dis, "%04x: %-32s  %s\n",     pc, op.c_str(), disVU1MicroLF(lower, pc));
+			}
+			mVUprofileWrite(dis, "\n");
+		}
+	}
+
+	const microProgram* top = progs.front();
+	DevCon.WriteLn(mVU.index ? Color_Orange : Color_Magenta, "microVU%d Profiler: %zu programs ran, hottest [%03d] [PC=%04x] %llu runs, %.3f ms (profile in %s)",
+		mVU.index, progs.size(), top->idx, top->startPC * 8, (unsigned long long)top->runs, top->runTicks * msPerTick,
+		WX_STR(csv.GetName()));
+}
+
+//------------------------------------------------------------------
+// Micro VU - Program Cache (Recompiler.vuProgCache)
+//------------------------------------------------------------------
+
+// The microprograms of a game are kept per game CRC, with the pipeline states their blocks
+// were entered with, and recompiled when the game boots instead of at their first use.
+// The recompiled code itself isn't kept: it points to the VU registers, the dispatchers
+// and the helpers of the current process.
+
+static const u32 mVUprogCacheMagic   = 0x5055564d; // MVUP
+static const u32 mVUprogCacheVersion = 1;
+static const u32 mVUprogCacheMax     = 2048;	// programs
+static const u32 mVUprogCacheEntries = 4096;	// blocks per program
+
+static wxString mVUprogCacheFile(microVU& mVU, u32 crc) {
+	return GetSettingsFolder().Combine(wxFileName(wxsFormat(L"mVU%u_%08X.bin", mVU.index, crc))).GetFullPath();
+}
+
+void mVUsaveProgCache(microVU& mVU) {
+	if (!EmuConfig.Cpu.Recompiler.vuProgCache || !mVU.prog.cacheCRC) return;
+
+	std::vector<microProgram*> progs;
+	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+		if (!mVU.prog.prog[i]) continue;
+		for (microProgram* prog : *mVU.prog.prog[i]) {
+			if (progs.size() < mVUprogCacheMax) progs.push_back(prog);
+		}
+	}
+	if (progs.empty()) return;
+
+	wxFFile f(mVUprogCacheFile(mVU, mVU.prog.cacheCRC), L"wb");
+	if (!f.IsOpened()) return;
+
+	const u32 header[4] = { mVUprogCacheMagic, mVUprogCacheVersion, mVU.microMemSize, (u32)progs.size() };
+	f.Write(header, sizeof(header));
+
+	for (microProgram* prog : progs) {
+		std::vector<u32> pcs;
+		std::vector<microRegInfo> states;
+		for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+			if (!prog->block[i]) continue;
+			prog->block[i]->forEach([&](const microBlock& block) {
+				if (pcs.size() >= mVUprogCacheEntries) return;
+				pcs.push_back(i * 8);
+				states.push_back(block.pState);
+			});
+		}
+		const u32 progHeader[2] = { prog->startPC, (u32)pcs.size() };
+		f.Write(progHeader, sizeof(progHeader));
+		f.Write(prog->data, mVU.microMemSize);
+		f.Write(pcs.data(), pcs.size() * sizeof(u32));
+		f.Write(states.data(), states.size() * sizeof(microRegInfo));
+	}
+	DevCon.WriteLn("microVU%d: Saved %u programs to the program cache", mVU.index, (u32)progs.size());
+}
+
+// Called by the search on the thread running the VU, once per game CRC
+void mVUloadProgCache(microVU& mVU) {
+	mVU.prog.cacheCRC = ElfCRC;
+	if (!EmuConfig.Cpu.Recompiler.vuProgCache || !ElfCRC) return;
+
+	const wxString file(mVUprogCacheFile(mVU, ElfCRC));
+	if (!wxFileExists(file)) return;
+	wxFFile f(file, L"rb");
+	if (!f.IsOpened()) return;
+
+	u32 header[4];
+	if ((f.Read(header, sizeof(header)) != sizeof(header)) || (header[0] != mVUprogCacheMagic)
+		|| (header[1] != mVUprogCacheVersion) || (header[2] != mVU.microMemSize) || (header[3] > mVUprogCacheMax))
+		return;
+
+	// Programs get recompiled from VU memory, put back what was there afterwards
+	std::unique_ptr<u8[]> micro(new u8[mVU.microMemSize]);
+	memcpy(micro.get(), mVU.regs().Micro, mVU.microMemSize);
+
+	std::vector<u32> pcs;
+	std::vector<microRegInfo> states;
+	const uptr cacheHalf = ((uptr)mVU.prog.x86end - (uptr)mVU.prog.x86start) / 2;
+	u32 loaded = 0;
+	for (; loaded < header[3]; loaded++) {
+		u32 progHeader[2];
+		if ((f.Read(progHeader, sizeof(progHeader)) != sizeof(progHeader))
+			|| (progHeader[0] >= (mVU.progSize / 2)) || (progHeader[1] > mVUprogCacheEntries))
+			break;
+		pcs.resize(progHeader[1]);
+		states.resize(progHeader[1]);
+		if ((f.Read(mVU.regs().Micro, mVU.microMemSize) != mVU.microMemSize)
+			|| (f.Read(pcs.data(), pcs.size() * sizeof(u32)) != pcs.size() * sizeof(u32))
+			|| (f.Read(states.data(), states.size() * sizeof(microRegInfo)) != states.size() * sizeof(microRegInfo)))
+			break;
+
+		// Leave room in the rec-cache for the programs the game hasn't used before
+		if (((uptr)xGetPtr() - (uptr)mVU.prog.x86start) > cacheHalf)
+			break;
+
+		mVU.flagReads |= mVUscanFlagReads((u32*)mVU.regs().Micro, 0, mVU.microMemSize);
+
+		mVU.prog.cur	= mVUcreateProg(mVU, progHeader[0]);
+		mVU.prog.isSame	= 1;
+		mVU.prog.prog[progHeader[0]]->push_back(mVU.prog.cur);
+		for (size_t i = 0; i < pcs.size(); i++) {
+			if ((pcs[i] & 7) || (pcs[i] > mVU.microMemSize - 8)) continue;
+			mVUblockFetch(mVU, pcs[i], (uptr)&states[i]);
+		}
+	}
+
+	memcpy(mVU.regs().Micro, micro.get(), mVU.microMemSize);
+	mVU.prog.cleared = 1;
+	mVU.prog.isSame	 = -1;
+	mVU.prog.cur	 = NULL;
+	for (u32 i = 0; i < (mVU.progSize / 2); i++) {
+		mVU.prog.quick[i].block = NULL;
+		mVU.prog.quick[i].prog  = NULL;
+	}
+	DevCon.WriteLn("microVU%d: Recompiled %u programs from the program cache", mVU.index, loaded);
+}
+
 // Generate Hash for partial program based on compiled ranges...
 u64 mVUrangesHash(microVU& mVU, microProgram& prog) {
 	union {
@@ -240,6 +507,42 @@ void mVUprintUniqueRatio(microVU& mVU) {
 	DevCon.WriteLn("%d / %d [%3.1f%%]", v.size(), total, 100.-(double)v.size()/(double)total*100.);
 }
 
+// Hash of VU memory over the given ranges, key gets the hash of the ranges themselves
+static u64 mVUhashRanges(const std::deque<microRange>& ranges, const u32* data, u64& key) {
+	u64 hash = 0xcbf29ce484222325ULL;
+	key      = 0xcbf29ce484222325ULL;
+	for (const auto& range : ranges) {
+		key = (key ^ (u32)range.start) * 0x100000001b3ULL;
+		key = (key ^ (u32)range.end)   * 0x100000001b3ULL;
+		if ((range.start < 0) || (range.end < 0)) continue;
+		for (int i = range.start / 4; i < range.end / 4; i++) {
+			hash = (hash ^ data[i]) * 0x100000001b3ULL;
+		}
+	}
+	return hash;
+}
+
+// Checks the hash of mVU.regs().Micro over the ranges of prog against the program's own.
+// Programs recompiled over the same ranges share the hash of VU memory, seen keeps the
+// ones taken during the current search.
+struct microHashSeen {
+	u64 key, hash;
+};
+static bool mVUhashMatches(microVU& mVU, microProgram& prog, microHashSeen (&seen)[4], int& seenCount) {
+	if (prog.hashDirty) {
+		prog.rangesHash = mVUhashRanges(*prog.ranges, prog.data, prog.rangesKey);
+		prog.hashDirty  = false;
+	}
+	for (int i = 0; i < std::min(seenCount, 4); i++) {
+		if (seen[i].key == prog.rangesKey)
+			return seen[i].hash == prog.rangesHash;
+	}
+	mVU.profiler.HashProg();
+	microHashSeen& s = seen[seenCount++ & 3];
+	s.hash = mVUhashRanges(*prog.ranges, (const u32*)mVU.regs().Micro, s.key);
+	return s.hash == prog.rangesHash;
+}
+
 // Compare Cached microProgram to mVU.regs().Micro
 __fi bool mVUcmpProg(microVU& mVU, microProgram& prog, const bool cmpWholeProg) {
 	if (cmpWholeProg)
@@ -270,13 +573,26 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 	microProgramList*  list  = mVU.prog.prog [mVU.regs().start_pc/8];
 
 	if(!quick.prog) { // If null, we need to search for new program
+		if (mVU.prog.cacheCRC != ElfCRC)
+			mVUloadProgCache(mVU);
+
+		// With several candidates, only the ones whose hash matches get compared
+		const bool useHash = list->size() > 1;
+		microHashSeen seen[4];
+		int seenCount = 0;
+		mVU.profiler.SearchProg();
 		std::deque<microProgram*>::iterator it(list->begin());
 		for ( ; it != list->end(); ++it) {
+			if (useHash && !mVUhashMatches(mVU, *it[0], seen, seenCount))
+				continue;
+
+			mVU.profiler.CmpProg();
 			bool b = mVUcmpProg(mVU, *it[0], 0);
 			
 			if (b) {
 				quick.block = it[0]->block[startPC/8];
 				quick.prog  = it[0];
+				quick.prog->searches++;
 				list->erase(it);
 				list->push_front(quick.prog);
 				return mVUentryGet(mVU, quick.block, startPC, pState);
@@ -287,6 +603,7 @@ _mVUt __fi void* mVUsearchProg(u32 startPC, uptr pState) {
 		mVU.prog.cleared	= 0;
 		mVU.prog.isSame		= 1;
 		mVU.prog.cur		= mVUcreateProg(mVU, mVU.regs().start_pc/8);
+		mVU.prog.cur->searches++;
 		void* entryPoint	= mVUblockFetch(mVU,  startPC, pState);
 		quick.block			= mVU.prog.cur->block[startPC/8];
 		quick.prog			= mVU.prog.cur;
@@ -320,8 +637,10 @@ void recMicroVU0::Vsync() noexcept { mVUvsyncUpdate(microVU0); }
 void recMicroVU1::Vsync() noexcept { mVUvsyncUpdate(microVU1); }
 
 void recMicroVU0::Reserve() {
-	if (m_Reserved.exchange(1) == 0)
+	if (m_Reserved.exchange(1) == 0) {
 		mVUinit(microVU0, 0);
+		vu0Thread.Start();
+	}
 }
 void recMicroVU1::Reserve() {
 	if (m_Reserved.exchange(1) == 0) {
@@ -331,8 +650,10 @@ void recMicroVU1::Reserve() {
 }
 
 void recMicroVU0::Shutdown() noexcept {
-	if (m_Reserved.exchange(0) == 1)
+	if (m_Reserved.exchange(0) == 1) {
+		vu0Thread.WaitVU();
 		mVUclose(microVU0);
+	}
 }
 void recMicroVU1::Shutdown() noexcept {
 	if (m_Reserved.exchange(0) == 1) {
@@ -343,6 +664,7 @@ void recMicroVU1::Shutdown() noexcept {
 
 void recMicroVU0::Reset() {
 	if(!pxAssertDev(m_Reserved, "MicroVU0 CPU Provider has not been reserved prior to reset!")) return;
+	vu0Thread.Finish(true);
 	mVUreset(microVU0, true);
 }
 void recMicroVU1::Reset() {
@@ -363,14 +685,20 @@ void recMicroVU0::Execute(u32 cycles) {
 	VU0.flags &= ~VUFLAG_MFLAGSET;
 
 	if(!(VU0.VI[REG_VPU_STAT].UL & 1)) return;
+	mVUupdateFlagReads(microVU0);
 	VU0.VI[REG_TPC].UL <<= 3;
 
 	// Sometimes games spin on vu0, so be careful with this value
 	// woody hangs if too high on sVU (untested on mVU)
 	// Edit: Need to test this again, if anyone ever has a "Woody" game :p
+	const u64 ticks = mVUprofiling(microVU0) ? GetCPUTicks() : 0;
 	((mVUrecCall)microVU0.startFunct)(VU0.VI[REG_TPC].UL, cycles);
+	if (ticks && microVU0.prog.entered) {
+		microVU0.prog.entered->runs++;
+		microVU0.prog.entered->runTicks += GetCPUTicks() - ticks;
+	}
 	VU0.VI[REG_TPC].UL >>= 3;
-	if(microVU0.regs().flags & 0x4)
+	if(microVU0.regs().flags & 0x4 && !vu0Thread.IsSelf()) // else raised by vu0Thread.Finish()
 	{
 		microVU0.regs().flags &= ~0x4;
 		hwIntcIrq(6);
@@ -388,8 +716,14 @@ void recMicroVU1::Execute(u32 cycles) {
 	if (!THREAD_VU1) {
 		if(!(VU0.VI[REG_VPU_STAT].UL & 0x100)) return;
 	}
+	mVUupdateFlagReads(microVU1);
 	VU1.VI[REG_TPC].UL <<= 3;
+	const u64 ticks = mVUprofiling(microVU1) ? GetCPUTicks() : 0;
 	((mVUrecCall)microVU1.startFunct)(VU1.VI[REG_TPC].UL, cycles);
+	if (ticks && microVU1.prog.entered) {
+		microVU1.prog.entered->runs++;
+		microVU1.prog.entered->runTicks += GetCPUTicks() - ticks;
+	}
 	VU1.VI[REG_TPC].UL >>= 3;
 	if(microVU1.regs().flags & 0x4 && !THREAD_VU1)
 	{
@@ -400,6 +734,7 @@ void recMicroVU1::Execute(u32 cycles) {
 
 void recMicroVU0::Clear(u32 addr, u32 size) {
 	pxAssert(m_Reserved); // please allocate me first! :|
+	vu0Thread.WaitVU();
 	mVUclear(microVU0, addr, size);
 }
 void recMicroVU1::Clear(u32 addr, u32 size) {
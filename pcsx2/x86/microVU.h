@@ -36,6 +36,8 @@ using namespace x86Emitter;
 #include "microVU_IR.h"
 #include "microVU_Profiler.h"
 #include "Utilities/Perf.h"
+#include "Timeline.h"
+#include "RecStats.h"
 
 struct microBlockLink {
 	microBlock		block;
@@ -116,6 +118,11 @@ public:
 		}
 		return NULL;
 	}
+	template <typename F>
+	void forEach(F f) const {
+		for(microBlockLink* linkI = qBlockList; linkI != NULL; linkI = linkI->next) f(linkI->block);
+		for(microBlockLink* linkI = fBlockList; linkI != NULL; linkI = linkI->next) f(linkI->block);
+	}
 	void printInfo(int pc, bool printQuick) {
 		int listI = printQuick ? qListI : fListI;
 		if (listI < 7) return;
@@ -147,6 +154,13 @@ struct microProgram {
 	std::deque<microRange>* ranges;			   // The ranges of the microProgram that have already been recompiled
 	u32 startPC; // Start PC of this program
 	int idx;	 // Program index
+	u64 rangesHash; // Hash of data over the ranges (see mVUhashRanges)
+	u64 rangesKey;  // Hash of the ranges themselves
+	bool hashDirty; // data or ranges changed since the hashes were taken
+	u64 runs;		// Executions started in this program (counted when profiling, see mVUprofileDump)
+	u64 runTicks;	// Host ticks spent in those executions
+	u32 compiles;	// Blocks recompiled for this program
+	u32 searches;	// Program searches that ended on this program
 };
 
 typedef std::deque<microProgram*> microProgramList;
@@ -169,6 +183,9 @@ struct microProgManager {
 	u8*					x86start;			// Start of program's rec-cache
 	u8*					x86end;				// Limit of program's rec-cache
 	microRegInfo		lpState;			// Pipeline state from where program left off (useful for continuing execution)
+	u32					cacheCRC;			// Game CRC the program cache was loaded for (Recompiler.vuProgCache)
+	microProgram*		entered;			// Program the current execution started in (NULL if it was reset since)
+	u32					profileDumps;		// Number of profiles written by mVUprofileDump
 };
 
 static const uint mVUdispCacheSize	= __pagesize; // Dispatcher Cache Size (in bytes)
@@ -182,7 +199,7 @@ struct microVU {
 	__aligned16 u32 macFlag [4]; // 4 instances of mac    flag (used in execution)
 	__aligned16 u32 clipFlag[4]; // 4 instances of clip   flag (used in execution)
 	__aligned16 u32 xmmCTemp[4];	 // Backup used in mVUclamp2()
-	__aligned16 u32 xmmBackup[8][4]; // Backup for xmm0~xmm7
+	__aligned16 u32 xmmBackup[iREGCNT_XMM][4]; // Backup for xmm0~xmm7 (xmm15 on x64)
 
 	u32 index;			// VU Index (VU0 or VU1)
 	u32 cop2;			// VU is in COP2 mode?  (No/Yes)
@@ -216,6 +233,9 @@ struct microVU {
 	u32		q;			  // Holds current Q instance index
 	u32		totalCycles;  // Total Cycles that mVU is expected to run for
 	u32		cycles;		  // Cycles Counter
+	u32		flagReads;	  // Flags (1 = Status, 2 = Mac, 4 = Clip) read by any code in micro memory since the last reset
+	u32		flagReadsStart; // Span of micro memory written to since flagReads was updated
+	u32		flagReadsEnd;
 
 	VURegs& regs() const { return ::vuRegs[index]; }
 
@@ -236,6 +256,7 @@ int mVUdebugNow = 0;
 // Main Functions
 extern void  mVUclear(mV, u32, u32);
 extern void  mVUreset(microVU& mVU, bool resetReserve);
+extern void  mVUupdateFlagReads(microVU& mVU);
 extern void* mVUblockFetch(microVU& mVU, u32 startPC, uptr pState);
 _mVUt extern void* __fastcall mVUcompileJIT(u32 startPC, uptr ptr);
 
@@ -247,7 +268,12 @@ mVUop(mVUopL);
 
 // Private Functions
 extern void  mVUcacheProg (microVU& mVU, microProgram&  prog);
+extern void  mVUsaveProgCache(microVU& mVU);
+extern void  mVUloadProgCache(microVU& mVU);
 extern void  mVUdeleteProg(microVU& mVU, microProgram*& prog);
+extern void  mVUresetProgs(microVU& mVU);
+extern bool  mVUprofiling(microVU& mVU);
+extern void  mVUprofileDump(microVU& mVU);
 _mVUt extern void* mVUsearchProg(u32 startPC, uptr pState);
 extern void* __fastcall mVUexecuteVU0(u32 startPC, u32 cycles);
 extern void* __fastcall mVUexecuteVU1(u32 startPC, u32 cycles);
@@ -109,7 +109,7 @@ void mVUDTendProgram(mV, microFlagCycles* mFC, int isEbit) {
 
 	if (isEbit) { // Clear 'is busy' Flags
 		if (!mVU.index || !THREAD_VU1) {
-			xAND(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? ~0x100 : ~0x001)); // VBS0/VBS1 flag
+			xAND(ptr32[mVUvpuStat(mVU)], (isVU1 ? ~0x100 : ~0x001)); // VBS0/VBS1 flag
 		}
 		else
 			xFastCall((void*)mVUTBit);
@@ -209,7 +209,7 @@ void mVUendProgram(mV, microFlagCycles* mFC, int isEbit) {
 
 	if ((isEbit && isEbit != 3)) { // Clear 'is busy' Flags
 		if (!mVU.index || !THREAD_VU1) {
-			xAND(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? ~0x100 : ~0x001)); // VBS0/VBS1 flag
+			xAND(ptr32[mVUvpuStat(mVU)], (isVU1 ? ~0x100 : ~0x001)); // VBS0/VBS1 flag
 		}
 		else
 			xFastCall((void*)mVUEBit);
@@ -280,7 +280,7 @@ void normBranch(mV, microFlagCycles& mFC) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x400 : 0x4));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x200 : 0x2));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x200 : 0x2));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		iPC = branchAddr(mVU)/4;
@@ -294,7 +294,7 @@ void normBranch(mV, microFlagCycles& mFC) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x800 : 0x8));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x400 : 0x4));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x400 : 0x4));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		iPC = branchAddr(mVU)/4;
@@ -397,7 +397,7 @@ void condBranch(mV, microFlagCycles& mFC, int JMPcc) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x800 : 0x8));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x400 : 0x4));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x400 : 0x4));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		mVUDTendProgram(mVU, &mFC, 2);
@@ -420,7 +420,7 @@ void condBranch(mV, microFlagCycles& mFC, int JMPcc) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x400 : 0x4));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x200 : 0x2));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x200 : 0x2));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		mVUDTendProgram(mVU, &mFC, 2);
@@ -556,7 +556,7 @@ void normJump(mV, microFlagCycles& mFC) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x400 : 0x4));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x200 : 0x2));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x200 : 0x2));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		mVUDTendProgram(mVU, &mFC, 2);
@@ -570,7 +570,7 @@ void normJump(mV, microFlagCycles& mFC) {
 		xTEST(ptr32[&VU0.VI[REG_FBRST].UL], (isVU1 ? 0x800 : 0x8));
 		xForwardJump32 eJMP(Jcc_Zero);
 		if (!mVU.index || !THREAD_VU1) {
-			xOR(ptr32[&VU0.VI[REG_VPU_STAT].UL], (isVU1 ? 0x400 : 0x4));
+			xOR(ptr32[mVUvpuStat(mVU)], (isVU1 ? 0x400 : 0x4));
 			xOR(ptr32[&mVU.regs().flags], VUFLAG_INTCINTERRUPT);
 		}
 		mVUDTendProgram(mVU, &mFC, 2);
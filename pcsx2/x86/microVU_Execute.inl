@@ -142,7 +142,9 @@ _mVUt void* __fastcall mVUexecute(u32 startPC, u32 cycles) {
 	mVU.totalCycles = cycles;
 
 	xSetPtr(mVU.prog.x86ptr); // Set x86ptr to where last program left off
-	return mVUsearchProg<vuIndex>(startPC & vuLimit, (uptr)&mVU.prog.lpState); // Find and set correct program
+	void* entryPoint = mVUsearchProg<vuIndex>(startPC & vuLimit, (uptr)&mVU.prog.lpState); // Find and set correct program
+	mVU.prog.entered = mVU.prog.cur;
+	return entryPoint;
 }
 
 //------------------------------------------------------------------
@@ -165,7 +167,8 @@ _mVUt void mVUcleanUp() {
 	mVU.cycles = mVU.totalCycles - mVU.cycles;
 	mVU.regs().cycle += mVU.cycles;
 
-	if (!vuIndex || !THREAD_VU1) {
+	// The VU threads don't touch the EE's cycles
+	if (vuIndex ? !THREAD_VU1 : !THREAD_VU0) {
 		u32 cycles_passed = std::min(mVU.cycles, 3000u) * EmuConfig.Speedhacks.EECycleSkip;
 		if (cycles_passed > 0) {
 			s32 vu0_offset = VU0.cycle - cpuRegs.cycle;
@@ -175,7 +178,7 @@ _mVUt void mVUcleanUp() {
 			// So we need to adjust when VU1 skips cycles also
 			if (!vuIndex)
 				VU0.cycle = cpuRegs.cycle + vu0_offset;
-			else
+			else if (!THREAD_VU0)
 				VU0.cycle += cycles_passed;
 		}
 	}
@@ -295,7 +295,7 @@ __fi void mVUsetupFlags(mV, microFlagCycles& mFC) {
 	}															\
 	else if (branch == 5) { /*JR/JARL*/							\
 		if(sCount+found<4) {			\
-			mVUregs.needExactMatch |= 7;						\
+			mVUregs.needExactMatch |= mVU.flagReads;			\
 		}														\
 		break;													\
 	}															\
@@ -373,7 +373,7 @@ void mVUsetFlagInfo(mV) {
 		mVUregs.needExactMatch &= 0x7;
 	}
 	else { // JR/JALR
-		if (!doConstProp || !mVUlow.constJump.isValid) { mVUregs.needExactMatch |= 0x7; } 
+		if (!doConstProp || !mVUlow.constJump.isValid) { mVUregs.needExactMatch |= mVU.flagReads; } // See mVUupdateFlagReads
 		else { mVUflagPass(mVU, (mVUlow.constJump.regValue*8)&(mVU.microMemSize-8)); }
 		mVUregs.needExactMatch &= 0x7;
 	}
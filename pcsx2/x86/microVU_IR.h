@@ -198,11 +198,18 @@ struct microMapXMM {
 
 class microRegAlloc {
 protected:
-	static const int   xmmTotal = 7; // Don't allocate PQ?
+	static const int   xmmTotal = iREGCNT_XMM - 1; // Don't allocate PQ (the last xmm reg)
+	static const int   lookaheadMax = 16; // Instructions searched for the next read of a VF reg
 	microMapXMM	xmmMap[xmmTotal];
 	int			counter; // Current allocation count
 	int			index;   // VU0 or VU1
 
+	// The instructions of the block being compiled, to find which cached VF regs are read next
+	const microOp* irInfo;
+	const u32*     irPC;
+	u32            irMask;
+	bool           useLookahead;
+
 	// Helper functions to get VU regs
 	VURegs& regs()				 const	{ return ::vuRegs[index]; }
 	__fi REG_VI& getVI(uint reg) const	{ return regs().VI[reg]; }
@@ -213,40 +220,77 @@ protected:
 		if (!_XYZWss(xyzw)) xSHUF.PS(reg, reg, 0);
 	}
 	
-	int findFreeRegRec(int startIdx) {
-		for(int i = startIdx; i < xmmTotal; i++) {
-			if (!xmmMap[i].isNeeded) {
-				int x = findFreeRegRec(i+1);
-				if (x == -1) return i;
-				return ((xmmMap[i].count < xmmMap[x].count) ? i : x);
-			}
+	static bool readsVF(const microVFreg* read, int VFreg) {
+		for(int i = 0; i < 2; i++) {
+			if ((read[i].reg == VFreg) && (read[i].x | read[i].y | read[i].z | read[i].w))
+				return true;
+		}
+		return false;
+	}
+
+	static bool writesAllVF(const microVFreg& write, int VFreg) {
+		return (write.reg == VFreg) && write.x && write.y && write.z && write.w;
+	}
+
+	// Instructions until the next read of the VF reg in the block (0 = the current one).
+	// Regs that get fully overwritten first are dead, ACC and I aren't tracked by the IR.
+	int nextRead(int VFreg) const {
+		if (!useLookahead || (VFreg < 0) || (VFreg > 31)) return lookaheadMax;
+		const u32 pc = *irPC / 2;
+		for(int i = 0; i < lookaheadMax; i++) {
+			const microOp& op = irInfo[(pc + i) & irMask];
+			if (readsVF(op.uOp.VF_read, VFreg) || readsVF(op.lOp.VF_read, VFreg))
+				return i;
+			if (writesAllVF(op.uOp.VF_write, VFreg) || (!op.lOp.noWriteVF && writesAllVF(op.lOp.VF_write, VFreg)))
+				return lookaheadMax + 1;
+			if (op.isEOB) break;
 		}
-		return -1;
+		return lookaheadMax;
 	}
 
+	// Spills the reg read the furthest away, then the one that needs no write-back,
+	// then the least recently used.
 	int findFreeReg() {
 		for(int i = 0; i < xmmTotal; i++) {
 			if (!xmmMap[i].isNeeded && (xmmMap[i].VFreg < 0)) {
 				return i; // Reg is not needed and was a temp reg
 			}
 		}
-		int x = findFreeRegRec(0);
+		int x = -1, xRead = 0;
+		bool xDirty = false;
+		for(int i = 0; i < xmmTotal; i++) {
+			const microMapXMM& mapI = xmmMap[i];
+			if (mapI.isNeeded) continue;
+			const int  iRead  = nextRead(mapI.VFreg);
+			const bool iDirty = (mapI.VFreg > 0) && mapI.xyzw;
+			if ((x < 0) || (iRead > xRead) || ((iRead == xRead)
+			&& ((xDirty && !iDirty) || ((xDirty == iDirty) && (mapI.count < xmmMap[x].count))))) {
+				x = i;
+				xRead  = iRead;
+				xDirty = iDirty;
+			}
+		}
 		pxAssertDev( x >= 0, "microVU register allocation failure!" );
 		return x;
 	}
 
 public:
-	microRegAlloc(int _index) {
-		index = _index;
+	microRegAlloc(int _index, const microOp* _irInfo, const u32* _irPC, u32 _irMask) {
+		index  = _index;
+		irInfo = _irInfo;
+		irPC   = _irPC;
+		irMask = _irMask;
 		reset();
 	}
 
 	// Fully resets the regalloc by clearing all cached data
-	void reset() {
+	// lookahead: the IR holds the first pass of the block being compiled (not COP2 macro ops)
+	void reset(bool lookahead = false) {
 		for(int i = 0; i < xmmTotal; i++) {
 			clearReg(i);
 		}
 		counter = 0;
+		useLookahead = lookahead;
 	}
 
 	// Flushes all allocated registers (i.e. writes-back to memory all modified registers).
@@ -31,6 +31,8 @@ using namespace R5900::Dynarec;
 
 void setupMacroOp(int mode, const char* opName) {
 	printCOP2(opName);
+	// The VU0 thread may be compiling with the same microVU0 state
+	if (THREAD_VU0) vu0Thread.WaitVU();
 	microVU0.cop2 = 1;
 	microVU0.prog.IRinfo.curPC = 0;
 	microVU0.code = cpuRegs.code;
@@ -575,4 +577,17 @@ void recCOP2_SPEC1() {
 
 	recCOP2SPECIAL1t[_Funct_]();
 }
-void recCOP2_SPEC2() { recCOP2SPECIAL2t[(cpuRegs.code&3)|((cpuRegs.code>>4)&0x7c)](); }
\ No newline at end of file
+// With the VU0 thread, the EE syncs with a running program at the interlocked
+// transfers (COP2_Interlock), the macro ops (SPEC1 and SPEC2) and VCALLMS(R).
+// The other transfers and LQC2/SQC2 only pick up the results of an ended one.
+void recCOP2_SPEC2() {
+	if (THREAD_VU0) {
+		iFlushCall(FLUSH_EVERYTHING);
+		xTEST(ptr32[&VU0.VI[REG_VPU_STAT].UL], 0x1);
+		xForwardJZ32 skipvuidle;
+		xFastCall((void*)_vu0FinishMicro);
+		skipvuidle.SetTarget();
+	}
+
+	recCOP2SPECIAL2t[(cpuRegs.code&3)|((cpuRegs.code>>4)&0x7c)]();
+}
\ No newline at end of file
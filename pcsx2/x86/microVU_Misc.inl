@@ -127,9 +127,10 @@ void mVUmergeRegs(const xmm& dest, const xmm& src, int xyzw, bool modXYZW)
 //------------------------------------------------------------------
 
 // Backup Volatile Regs (EAX, ECX, EDX, MM0~7, XMM0~7, are all volatile according to 32bit Win/Linux ABI)
+// (XMM0~15 on x64 Linux)
 __fi void mVUbackupRegs(microVU& mVU, bool toMemory = false) {
 	if (toMemory) {
-		for(int i = 0; i < 8; i++) {
+		for(int i = 0; i < (int)iREGCNT_XMM; i++) {
 			xMOVAPS(ptr128[&mVU.xmmBackup[i][0]], xmm(i));
 		}
 	}
@@ -142,7 +143,7 @@ __fi void mVUbackupRegs(microVU& mVU, bool toMemory = false) {
 // Restore Volatile Regs
 __fi void mVUrestoreRegs(microVU& mVU, bool fromMemory = false) {
 	if (fromMemory) {
-		for(int i = 0; i < 8; i++) {
+		for(int i = 0; i < (int)iREGCNT_XMM; i++) {
 			xMOVAPS(xmm(i), ptr128[&mVU.xmmBackup[i][0]]);
 		}
 	}
@@ -163,12 +164,12 @@ public:
 
 _mVUt void __fc mVUprintRegs() {
 	microVU& mVU = mVUx;
-	for(int i = 0; i < 8; i++) {
+	for(int i = 0; i < (int)iREGCNT_XMM; i++) {
 		Console.WriteLn("xmm%d = [0x%08x,0x%08x,0x%08x,0x%08x]", i,
 			mVU.xmmBackup[i][0], mVU.xmmBackup[i][1],
 			mVU.xmmBackup[i][2], mVU.xmmBackup[i][3]);
 	}
-	for(int i = 0; i < 8; i++) {
+	for(int i = 0; i < (int)iREGCNT_XMM; i++) {
 		Console.WriteLn("xmm%d = [%f,%f,%f,%f]", i,
 			(float&)mVU.xmmBackup[i][0], (float&)mVU.xmmBackup[i][1],
 			(float&)mVU.xmmBackup[i][2], (float&)mVU.xmmBackup[i][3]);
@@ -203,8 +204,20 @@ static inline u32 branchAddr(const mV)
 	return ((((iPC + 2) + (_Imm11_ * 2)) & mVU.progMemMask) * 4);
 }
 
+// Where the compiled programs update VPU_STAT, the VU0 thread's have their own copy
+__fi u32* mVUvpuStat(const microVU& mVU)
+{
+	return (!mVU.index && THREAD_VU0) ? &vu0Thread.vpuStat : &VU0.VI[REG_VPU_STAT].UL;
+}
+
 static void __fc mVUwaitMTVU() {
 	if (IsDevBuild) DevCon.WriteLn("microVU0: Waiting on VU1 thread to access VU1 regs!");
+	if (vu0Thread.IsSelf()) {
+		// Only the EE thread may kick MTVU, it does so while waiting for VU0
+		while (!vu1Thread.IsDone())
+			std::this_thread::yield();
+		return;
+	}
 	vu1Thread.WaitVU();
 }
 
@@ -103,8 +103,14 @@ struct microProfiler {
 	static const u32 progLimit = 10000;
 	u64 opStats[opLastOpcode];
 	u32 progCount;
+	u64 progSearches; // searches for a cached microprogram
+	u64 progHashes;   // hashes of VU memory taken by the searches
+	u64 progCompares; // memcmp confirmations of a matching hash
 	int index;
 	void Reset(int _index) { memzero(*this); index = _index; }
+	void SearchProg() { progSearches++; }
+	void HashProg()   { progHashes++; }
+	void CmpProg()    { progCompares++; }
 	void EmitOp(microOpcode op) {
 		xADD(ptr32[&(((u32*)opStats)[op*2+0])], 1);
 		xADC(ptr32[&(((u32*)opStats)[op*2+1])], 0);
@@ -130,7 +136,9 @@ struct microProfiler {
 				DevCon.WriteLn("%s - [%3.4f%%][count=%u]",
 					str.c_str(), stat, (u32)count);
 			}
-			DevCon.WriteLn("Total = 0x%x%x\n\n", (u32)(u64)(total>>32),(u32)total);
+			DevCon.WriteLn("Total = 0x%x%x", (u32)(u64)(total>>32),(u32)total);
+			DevCon.WriteLn("Prog Searches = %llu, Hashes = %llu, Compares = %llu\n\n",
+				(unsigned long long)progSearches, (unsigned long long)progHashes, (unsigned long long)progCompares);
 		}
 	}
 };
@@ -139,5 +147,8 @@ struct microProfiler {
 	__fi void Reset(int _index) {}
 	__fi void EmitOp(microOpcode op) {}
 	__fi void Print() {}
+	__fi void SearchProg() {}
+	__fi void HashProg() {}
+	__fi void CmpProg() {}
 };
 #endif
@@ -35,6 +35,7 @@ extern void  dVifReserve (int idx);
 extern void  dVifReset   (int idx);
 extern void  dVifClose   (int idx);
 extern void  dVifRelease (int idx);
+extern void  dVifBenchmark();
 extern void  VifUnpackSSE_Init();
 extern void  VifUnpackSSE_Destroy();
 
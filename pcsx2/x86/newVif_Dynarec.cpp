@@ -65,6 +65,7 @@ VifUnpackSSE_Dynarec::VifUnpackSSE_Dynarec(const nVifStruct& vif_, const nVifBlo
 	doMode		= vB.mode & 3;
 	IsAligned   = vB.aligned;
 	vCL			= 0;
+	useAVX2		= x86caps.hasAVX2;
 }
 
 __fi void makeMergeMask(u32& x)
@@ -81,7 +82,12 @@ __fi void VifUnpackSSE_Dynarec::SetMasks(int cS) const {
 	u32 m3 =  ((m0 & 0xaaaaaaaa)>>1) & ~m0; //all the upper bits, so our example 0x01010000 & 0xFCFDFEFF = 0x00010000 just the cols (shifted right for maskmerge)
 	u32 m2 = (m0 & 0x55555555) & (~m0>>1); // 0x1000100 & 0xFE7EFF7F = 0x00000100 Just the row
 
-	if((m2&&doMask)||doMode) { xMOVAPS(xmmRow, ptr128[&vif.MaskRow]); MSKPATH3_LOG("Moving row");}
+	if((m2&&doMask)||doMode) {
+		// The paired unpacks add the row to both of their quadwords
+		if (useAVX2 && doMode)	xVBROADCASTI128(xmmRow.YMM(), ptr128[&vif.MaskRow]);
+		else					xMOVAPS(xmmRow, ptr128[&vif.MaskRow]);
+		MSKPATH3_LOG("Moving row");
+	}
 	if (m3&&doMask) {
 		MSKPATH3_LOG("Merging Cols");
 		xMOVAPS(xmmCol0, ptr128[&vif.MaskCol]);
@@ -154,6 +160,22 @@ void VifUnpackSSE_Dynarec::writeBackRow() const {
 	// ToDo: Do we need to write back to vifregs.rX too!? :/
 }
 
+// Unpacks the quadwords of two consecutive cycles with one 256-bit op (V4-32/16/8 only)
+void VifUnpackSSE_Dynarec::xUnpackPairAVX2(int upknum) const {
+	const xRegisterSSE ymmDest(destReg.YMM());
+
+	switch (upknum)
+	{
+		case 12: xVMOVUPS(ymmDest, ptr[srcIndirect]); break;
+		case 13: if (usn) xVPMOVZXWD(ymmDest, ptr[srcIndirect]); else xVPMOVSXWD(ymmDest, ptr[srcIndirect]); break;
+		case 14: if (usn) xVPMOVZXBD(ymmDest, ptr[srcIndirect]); else xVPMOVSXBD(ymmDest, ptr[srcIndirect]); break;
+		jNO_DEFAULT
+	}
+
+	if (doMode) xVPADDD(ymmDest, ymmDest, xmmRow.YMM());
+	xVMOVUPS(ptr[dstIndirect], ymmDest);
+}
+
 static void ShiftDisplacementWindow( xAddressVoid& addr, const xRegisterLong& modReg )
 {
 	// Shifts the displacement factor of a given indirect address, so that the address
@@ -215,6 +237,11 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 
 	pxAssume(vCL == 0);
 
+	// The masked writes merge each quadword with its own cycle's mask, and the
+	// difference/accumulate modes carry the row from one quadword to the next,
+	// so only the plain and offset (mode 1) V4 unpacks are paired.
+	useAVX2 = useAVX2 && !doMask && doMode <= 1 && upkNum >= 12 && upkNum <= 14;
+
 	// Value passed determines # of col regs we need to load
 	SetMasks(isFill ? blockSize : cycleSize);
 
@@ -227,7 +254,17 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 			ShiftDisplacementWindow( srcIndirect, arg2reg ); //Don't need to do this otherwise as we arent reading the source.
 
 
-		if (vCL < cycleSize) {
+		if (useAVX2 && vNum >= 2 && vCL + 1 < cycleSize) {
+			xUnpackPairAVX2(upkNum);
+
+			dstIndirect += 32;
+			srcIndirect += vift * 2;
+
+			vNum -= 2;
+			vCL += 2;
+			if (vCL == blockSize) vCL = 0;
+		}
+		else if (vCL < cycleSize) {
 			ModUnpack(upkNum, false);
 			xUnpack(upkNum);
 			xMovDest();
@@ -258,6 +295,7 @@ void VifUnpackSSE_Dynarec::CompileRoutine() {
 	}
 
 	if (doMode>=2) writeBackRow();
+	if (useAVX2) xVZEROUPPER();
 	xRET();
 }
 
@@ -362,3 +400,69 @@ _vifT __fi void dVifUnpack(const u8* data, bool isFill) {
 
 template void dVifUnpack<0>(const u8* data, bool isFill);
 template void dVifUnpack<1>(const u8* data, bool isFill);
+
+// Times the recompiled unpack of every (upkNum, usn, mask, mode) combination, with
+// and without the AVX2 pairing, and prints the rdtsc cycles per unpacked quadword.
+// The blocks are compiled into the VIF0 cache, which is reset before and after.
+void dVifBenchmark() {
+	static const char* const upkNames[16] = {
+		"S-32",  "S-16",  "S-8",  "",
+		"V2-32", "V2-16", "V2-8", "",
+		"V3-32", "V3-16", "V3-8", "",
+		"V4-32", "V4-16", "V4-8", "V4-5",
+	};
+	static const int qwc  = 128;
+	static const int runs = 256;
+
+	static __aligned16 u32 src[qwc * 4];
+	static __aligned16 u32 dst[qwc * 4];
+
+	nVifStruct& v = nVif[0];
+	for (int i = 0; i < qwc * 4; i++)
+		src[i] = i * 0x9E3779B9u;
+
+	dVifReset(0);
+	Console.WriteLn("VIF unpack benchmark, %d quadwords (cl = wl = 4), cycles per quadword:", qwc);
+	Console.WriteLn("  upk    usn mask mode      SSE     AVX2");
+
+	for (int upkNum = 0; upkNum < 16; upkNum++) {
+		if (nVifT[upkNum] == 0) continue;
+		for (int usn = 0; usn < 2; usn++) {
+		for (int mask = 0; mask < 2; mask++) {
+		for (int mode = 0; mode < 4; mode++) {
+			double cycles[2] = {0, 0};
+
+			for (int avx2 = 0; avx2 < (x86caps.hasAVX2 ? 2 : 1); avx2++) {
+				nVifBlock block = {};
+				block.num     = qwc;
+				block.upkType = upkNum | (mask << 4) | (usn << 5);
+				block.mask    = mask ? 0xE4E4E4E4 : 0;
+				block.mode    = mode;
+				block.cl      = 4;
+				block.wl      = 4;
+
+				xSetPtr(v.recWritePtr);
+				block.startPtr = (uptr)xGetAlignedCallTarget();
+				VifUnpackSSE_Dynarec vpu(v, block);
+				vpu.useAVX2 = !!avx2;
+				vpu.CompileRoutine();
+				v.recWritePtr = xGetPtr();
+
+				u64 best = ~0ull;
+				for (int i = 0; i < runs; i++) {
+					u64 start = __rdtsc();
+					((nVifrecCall)block.startPtr)((uptr)dst, (uptr)src);
+					best = std::min<u64>(best, __rdtsc() - start);
+				}
+				cycles[avx2] = (double)best / qwc;
+			}
+
+			if (x86caps.hasAVX2)
+				Console.WriteLn("  %-6s %3d %4d %4d %8.2f %8.2f", upkNames[upkNum], usn, mask, mode, cycles[0], cycles[1]);
+			else
+				Console.WriteLn("  %-6s %3d %4d %4d %8.2f        -", upkNames[upkNum], usn, mask, mode, cycles[0]);
+		}}}
+	}
+
+	dVifReset(0);
+}
@@ -103,13 +103,20 @@ _vifT int nVifUnpack(const u8* data) {
 	const uint ret    = std::min(vif.vifpacketsize, vif.tag.size);
 	const bool isFill = (vifRegs.cycle.cl < wl);
 	s32		   size   = ret << 2;
+
+	// With MTVU, partial transfers are gathered in its ring instead of the buffer
+	u8* gather = v.buffer;
+	if (idx) {
+		if (!THREAD_VU1) vu1Thread.SpillVifUnpack();
+		else if (v.bSize && vu1Thread.GetVifUnpackPtr()) gather = vu1Thread.GetVifUnpackPtr();
+	}
 	
 	if (ret == vif.tag.size) { // Full Transfer
 		if (v.bSize) { // Last transfer was partial
-			memcpy(&v.buffer[v.bSize], data, size);
+			memcpy(&gather[v.bSize], data, size);
 			v.bSize		+= size;
 			size        = v.bSize;
-			data		= v.buffer;
+			data		= gather;
 
 			vif.cl		= 0;
 			vifRegs.num	= (vifXRegs.code >> 16) & 0xff;		// grab NUM form the original VIFcode input.
@@ -120,6 +127,7 @@ _vifT int nVifUnpack(const u8* data) {
 			if (newVifDynaRec)	dVifUnpack<idx>(data, isFill);
 			else			   _nVifUnpack(idx, data, vifRegs.mode, isFill);
 		}
+		else if (gather != v.buffer) vu1Thread.EndVifUnpack(vif, vifRegs, (size + 4) & ~0x3);
 		else vu1Thread.VifUnpack(vif, vifRegs, (u8*)data, (size + 4) & ~0x3);
 
 		vif.pass		= 0;
@@ -129,7 +137,9 @@ _vifT int nVifUnpack(const u8* data) {
 		v.bSize			= 0;
 	}
 	else { // Partial Transfer
-		memcpy(&v.buffer[v.bSize], data, size);
+		if (idx && THREAD_VU1 && !v.bSize)
+			gather = vu1Thread.BeginVifUnpack(sizeof(v.buffer) + 4, v.buffer, &v.bSize);
+		memcpy(&gather[v.bSize], data, size);
 		v.bSize		 += size;
 		vif.tag.size -= ret;
 
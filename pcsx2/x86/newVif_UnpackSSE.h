@@ -108,6 +108,7 @@ class VifUnpackSSE_Dynarec : public VifUnpackSSE_Base
 public:
 	bool			isFill;
 	int				doMode;			// two bit value representing... something!
+	bool			useAVX2;		// unpack two quadwords per op when possible
 	
 protected:
 	const nVifStruct&	v;			// vif0 or vif1
@@ -123,6 +124,7 @@ public:
 	{
 		isFill	= src.isFill;
 		vCL		= src.vCL;
+		useAVX2	= src.useAVX2;
 	}
 
 	virtual ~VifUnpackSSE_Dynarec() = default;
@@ -137,6 +139,7 @@ protected:
 	virtual void doMaskWrite(const xRegisterSSE& regX) const;
 	void SetMasks(int cS) const;
 	void writeBackRow() const;
+	void xUnpackPairAVX2(int upknum) const;
 
 	static VifUnpackSSE_Dynarec FillingWrite( const VifUnpackSSE_Dynarec& src )
 	{
@@ -0,0 +1,126 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Correctness of LightweightSemaphore under contention, and the round trip of a thread
+// hand-off (the EE kicking the MTGS or MTVU and waiting for the answer) against Semaphore.
+// The round trip benchmark is disabled so it stays out of the default run, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=LightweightSemaphoreBench.*
+
+#include <gtest/gtest.h>
+#include "Pcsx2Defs.h"
+#include "Utilities/Threading.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Threading;
+
+TEST(LightweightSemaphore, Counts)
+{
+	LightweightSemaphore sema;
+	EXPECT_FALSE(sema.TryWait());
+
+	sema.Post();
+	sema.Post(3);
+	EXPECT_EQ(sema.Count(), 4);
+	for (int i = 0; i < 4; i++)
+		EXPECT_TRUE(sema.TryWait());
+	EXPECT_FALSE(sema.TryWait());
+
+	sema.Post(2);
+	sema.Reset();
+	EXPECT_EQ(sema.Count(), 0);
+}
+
+TEST(LightweightSemaphore, TimedWait)
+{
+	LightweightSemaphore sema;
+	EXPECT_FALSE(sema.WaitWithoutYield(wxTimeSpan(0, 0, 0, 20)));
+
+	sema.Post();
+	EXPECT_TRUE(sema.WaitWithoutYield(wxTimeSpan(0, 0, 0, 20)));
+}
+
+TEST(LightweightSemaphore, Contention)
+{
+	const int posters = 4, waiters = 4, posts = 20000;
+	LightweightSemaphore sema;
+	std::atomic<int> taken(0);
+	std::vector<std::thread> threads;
+
+	for (int i = 0; i < waiters; i++)
+	{
+		threads.emplace_back([&] {
+			for (int n = 0; n < posters * posts / waiters; n++)
+			{
+				sema.WaitWithoutYield();
+				taken.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+	for (int i = 0; i < posters; i++)
+	{
+		threads.emplace_back([&] {
+			for (int n = 0; n < posts; n++)
+				sema.Post();
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(taken.load(), posters * posts);
+	EXPECT_EQ(sema.Count(), 0);
+}
+
+// Round trips per second between two threads, each waiting for the other's post.
+template <typename Sema>
+static double PingPong(int rounds)
+{
+	Sema ping, pong;
+
+	std::thread other([&] {
+		for (int i = 0; i < rounds; i++)
+		{
+			ping.WaitWithoutYield();
+			pong.Post();
+		}
+	});
+
+	double s = 0;
+	std::thread self([&] {
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < rounds; i++)
+		{
+			ping.Post();
+			pong.WaitWithoutYield();
+		}
+		s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	});
+
+	self.join();
+	other.join();
+	return rounds / s;
+}
+
+TEST(LightweightSemaphoreBench, DISABLED_PingPong)
+{
+	const int rounds = 100000;
+
+	printf("%24s %14s\n", "", "round trips/s");
+	printf("%24s %14.0f\n", "Semaphore", PingPong<Semaphore>(rounds));
+	printf("%24s %14.0f\n", "LightweightSemaphore", PingPong<LightweightSemaphore>(rounds));
+}
@@ -0,0 +1,260 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The SSE4.1 CSC thresholds and PACK VQ search of the IPU against the C versions of
+// ipu_csc and ipu_vq they replaced, kept below as the reference. The sign pass of the
+// reference flips the macroblock, the C version flipped the 1 KB after it.
+
+#include <gtest/gtest.h>
+#include "IPU/IPUconv.h"
+#include <climits>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	void ref_csc_thresh(u32* rgba32, u16 thresh0, u16 thresh1, int sgn)
+	{
+		u8* p = reinterpret_cast<u8*>(rgba32);
+
+		if (thresh0 > 0)
+		{
+			for (int i = 0; i < 16 * 16; i++, p += 4)
+			{
+				if ((p[0] < thresh0) && (p[1] < thresh0) && (p[2] < thresh0))
+					*(u32*)p = 0;
+				else if ((p[0] < thresh1) && (p[1] < thresh1) && (p[2] < thresh1))
+					p[3] = 0x40;
+			}
+		}
+		else if (thresh1 > 0)
+		{
+			for (int i = 0; i < 16 * 16; i++, p += 4)
+			{
+				if ((p[0] < thresh1) && (p[1] < thresh1) && (p[2] < thresh1))
+					p[3] = 0x40;
+			}
+		}
+		if (sgn)
+		{
+			for (int i = 0; i < 16 * 16; i++)
+				rgba32[i] ^= 0x808080;
+		}
+	}
+
+	void ref_vq(const u16* rgb16, const u16* clut, u8* indx4)
+	{
+		const auto closest_index = [&](int i, int j) {
+			const u16 c = rgb16[i * 16 + j];
+			u8 index = 0;
+			int min_distance = INT_MAX;
+			for (u8 k = 0; k < 16; ++k)
+			{
+				const int dr = (c & 0x1f) - (clut[k] & 0x1f);
+				const int dg = ((c >> 5) & 0x1f) - ((clut[k] >> 5) & 0x1f);
+				const int db = ((c >> 10) & 0x1f) - ((clut[k] >> 10) & 0x1f);
+				const int distance = dr * dr + dg * dg + db * db;
+
+				if (min_distance > distance)
+				{
+					index = k;
+					min_distance = distance;
+				}
+			}
+
+			return index;
+		};
+
+		for (int i = 0; i < 16; ++i)
+			for (int j = 0; j < 8; ++j)
+				indx4[i * 8 + j] = closest_index(i, 2 * j + 1) << 4 | closest_index(i, 2 * j);
+	}
+
+	// A macroblock between two guard areas the size of a macroblock, an overrun of the
+	// passes changes them
+	template <typename T, size_t N>
+	struct Guarded
+	{
+		alignas(16) T data[N * 3];
+
+		Guarded() { std::memset(data, 0xcd, sizeof(data)); }
+		T* mb() { return data + N; }
+		bool GuardsIntact() const
+		{
+			for (size_t i = 0; i < sizeof(T) * N; i++)
+			{
+				if (reinterpret_cast<const u8*>(data)[i] != 0xcd ||
+					reinterpret_cast<const u8*>(data + N * 2)[i] != 0xcd)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	typedef Guarded<u32, 16 * 16> RGB32Block;
+	typedef Guarded<u16, 16 * 16> RGB16Block;
+	typedef Guarded<u8, 16 * 16 / 2> Index4Block;
+
+	void CheckCSC(const u32 (&pixels)[16 * 16], u16 thresh0, u16 thresh1, int sgn)
+	{
+		RGB32Block ref, sse;
+		std::memcpy(ref.mb(), pixels, sizeof(pixels));
+		std::memcpy(sse.mb(), pixels, sizeof(pixels));
+
+		ref_csc_thresh(ref.mb(), thresh0, thresh1, sgn);
+		ipu_csc_thresh_sse4(sse.mb(), thresh0, thresh1, sgn);
+
+		ASSERT_EQ(0, std::memcmp(ref.mb(), sse.mb(), sizeof(pixels)))
+			<< "thresh " << thresh0 << "/" << thresh1 << ", sgn " << sgn;
+		ASSERT_TRUE(sse.GuardsIntact()) << "thresh " << thresh0 << "/" << thresh1 << ", sgn " << sgn;
+	}
+
+	void CheckVQ(const u16 (&pixels)[16 * 16], const u16 (&clut)[16])
+	{
+		RGB16Block rgb16;
+		std::memcpy(rgb16.mb(), pixels, sizeof(pixels));
+
+		Index4Block ref, sse;
+		ref_vq(rgb16.mb(), clut, ref.mb());
+		ipu_vq_sse4(rgb16.mb(), clut, sse.mb());
+
+		ASSERT_EQ(0, std::memcmp(ref.mb(), sse.mb(), 16 * 16 / 2));
+		ASSERT_TRUE(sse.GuardsIntact());
+		ASSERT_TRUE(rgb16.GuardsIntact());
+	}
+} // namespace
+
+TEST(IPU_CSC, RandomMacroblocks)
+{
+	std::mt19937 rng(0xc5c);
+	std::uniform_int_distribution<u32> pixel;
+	std::uniform_int_distribution<int> thresh(0, 0x1ff);
+
+	for (int n = 0; n < 4000; n++)
+	{
+		u32 pixels[16 * 16];
+		for (u32& p : pixels)
+			p = pixel(rng);
+
+		// Dark macroblocks, where the thresholds matter
+		if (n & 1)
+		{
+			for (u32& p : pixels)
+				p &= 0xff3f3f3f;
+		}
+
+		const u16 t0 = n % 5 == 0 ? 0 : thresh(rng) >> (n & 2 ? 0 : 2);
+		const u16 t1 = n % 7 == 0 ? 0 : thresh(rng) >> (n & 2 ? 0 : 2);
+		ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, t0, t1, n & 4 ? 1 : 0));
+	}
+}
+
+TEST(IPU_CSC, ThresholdEdges)
+{
+	// Every component value against thresholds just above, at and below it
+	u32 pixels[16 * 16];
+	for (int i = 0; i < 16 * 16; i++)
+	{
+		const u32 c = i;
+		const u32 other = (i * 7) & 0xff;
+		pixels[i] = 0x80000000 | (i % 3 == 0 ? c : other) | (i % 3 == 1 ? c : other) << 8 | (i % 3 == 2 ? c : other) << 16;
+	}
+
+	for (int t : {0, 1, 0x3f, 0x80, 0xff, 0x100, 0x1ff})
+	{
+		for (int sgn : {0, 1})
+		{
+			ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, t, 0, sgn));
+			ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, 0, t, sgn));
+			ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, t, t, sgn));
+			ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, t, 0x1ff - t, sgn));
+			ASSERT_NO_FATAL_FAILURE(CheckCSC(pixels, t / 2, t, sgn));
+		}
+	}
+}
+
+// MPEG DEC with SGN=1 and thresholds set used to flip the memory after the macroblock
+TEST(IPU_CSC, SignFlipsTheMacroblock)
+{
+	u32 pixels[16 * 16];
+	for (int i = 0; i < 16 * 16; i++)
+		pixels[i] = 0xff000000 | i * 0x010101;
+
+	RGB32Block sse;
+	std::memcpy(sse.mb(), pixels, sizeof(pixels));
+	ipu_csc_thresh_sse4(sse.mb(), 0x10, 0x20, 1);
+
+	for (int i = 0; i < 16 * 16; i++)
+	{
+		const u32 expected = i < 0x10 ? 0 : i < 0x20 ? (pixels[i] & 0xffffff) | 0x40000000 : pixels[i];
+		ASSERT_EQ(expected ^ 0x808080, sse.mb()[i]) << "pixel " << i;
+	}
+	ASSERT_TRUE(sse.GuardsIntact());
+}
+
+TEST(IPU_VQ, RandomMacroblocks)
+{
+	std::mt19937 rng(0x7a9);
+	std::uniform_int_distribution<int> colour(0, 0xffff);
+	std::uniform_int_distribution<int> entry(0, 15);
+
+	for (int n = 0; n < 4000; n++)
+	{
+		u16 clut[16];
+		for (u16& c : clut)
+			c = colour(rng);
+
+		// Duplicate entries, the first one of them is the closest
+		if (n & 1)
+		{
+			for (int i = n % 5; i >= 0; i--)
+				clut[entry(rng)] = clut[entry(rng)];
+		}
+
+		u16 pixels[16 * 16];
+		for (u16& p : pixels)
+			p = n & 2 ? clut[entry(rng)] ^ (colour(rng) & 0x8421) : colour(rng);
+
+		ASSERT_NO_FATAL_FAILURE(CheckVQ(pixels, clut));
+	}
+}
+
+TEST(IPU_VQ, EdgeCluts)
+{
+	u16 pixels[16 * 16];
+	for (int i = 0; i < 16 * 16; i++)
+		pixels[i] = i * 0x0101 ^ (i & 1 ? 0x8000 : 0x7fff);
+
+	u16 clut[16];
+
+	// A single colour, every pixel gets index 0
+	for (u16 c : {0x0000, 0x7fff, 0x8000, 0xffff})
+	{
+		std::fill(std::begin(clut), std::end(clut), c);
+		ASSERT_NO_FATAL_FAILURE(CheckVQ(pixels, clut));
+	}
+
+	// The corners of the colour cube, the largest distances
+	for (int k = 0; k < 16; k++)
+		clut[k] = (k & 1 ? 0x1f : 0) | (k & 2 ? 0x3e0 : 0) | (k & 4 ? 0x7c00 : 0) | (k & 8 ? 0x8000 : 0);
+	ASSERT_NO_FATAL_FAILURE(CheckVQ(pixels, clut));
+
+	// A grey ramp with a step of 2, the odd greys are as close to two entries
+	for (int k = 0; k < 16; k++)
+		clut[k] = k * 2 * 0x421;
+	for (int i = 0; i < 16 * 16; i++)
+		pixels[i] = (i & 31) * 0x421;
+	ASSERT_NO_FATAL_FAILURE(CheckVQ(pixels, clut));
+}
@@ -0,0 +1,260 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The SSE4.1 IDCT of the IPU against the C version of mpeg2dec it replaced, which is
+// kept below as the reference. The outputs must be bit-exact.
+
+#include <gtest/gtest.h>
+#include "IPU/mpeg2lib/Idct.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	// The reference multiplies by 181 in 32 bits like the C version did, defined here as
+	// a wrapping product: extreme rows can overflow it, and pmulld wraps too.
+	int mul181(int x)
+	{
+		return static_cast<int>(static_cast<u32>(x) * 181u);
+	}
+
+	void BUTTERFLY(int& t0, int& t1, int w0, int w1, int d0, int d1)
+	{
+		int tmp = w0 * (d0 + d1);
+		t0 = tmp + (w1 - w0) * d1;
+		t1 = tmp - (w1 + w0) * d0;
+	}
+
+	void idct_row(s16* const block)
+	{
+		int d0, d1, d2, d3;
+		int a0, a1, a2, a3, b0, b1, b2, b3;
+		int t0, t1, t2, t3;
+
+		// shortcut
+		if (!(block[1] | block[2] | block[3] | block[4] | block[5] | block[6] | block[7]))
+		{
+			const s16 dc = static_cast<s16>(block[0] << 3);
+			std::fill(block, block + 8, dc);
+			return;
+		}
+
+		d0 = (block[0] << 11) + 128;
+		d1 = block[1];
+		d2 = block[2] << 11;
+		d3 = block[3];
+		t0 = d0 + d2;
+		t1 = d0 - d2;
+		BUTTERFLY(t2, t3, W6, W2, d3, d1);
+		a0 = t0 + t2;
+		a1 = t1 + t3;
+		a2 = t1 - t3;
+		a3 = t0 - t2;
+
+		d0 = block[4];
+		d1 = block[5];
+		d2 = block[6];
+		d3 = block[7];
+		BUTTERFLY(t0, t1, W7, W1, d3, d0);
+		BUTTERFLY(t2, t3, W3, W5, d1, d2);
+		b0 = t0 + t2;
+		b3 = t1 + t3;
+		t0 -= t2;
+		t1 -= t3;
+		b1 = mul181(t0 + t1) >> 8;
+		b2 = mul181(t0 - t1) >> 8;
+
+		block[0] = (a0 + b0) >> 8;
+		block[1] = (a1 + b1) >> 8;
+		block[2] = (a2 + b2) >> 8;
+		block[3] = (a3 + b3) >> 8;
+		block[4] = (a3 - b3) >> 8;
+		block[5] = (a2 - b2) >> 8;
+		block[6] = (a1 - b1) >> 8;
+		block[7] = (a0 - b0) >> 8;
+	}
+
+	void idct_col(s16* const block)
+	{
+		int d0, d1, d2, d3;
+		int a0, a1, a2, a3, b0, b1, b2, b3;
+		int t0, t1, t2, t3;
+
+		d0 = (block[8 * 0] << 11) + 65536;
+		d1 = block[8 * 1];
+		d2 = block[8 * 2] << 11;
+		d3 = block[8 * 3];
+		t0 = d0 + d2;
+		t1 = d0 - d2;
+		BUTTERFLY(t2, t3, W6, W2, d3, d1);
+		a0 = t0 + t2;
+		a1 = t1 + t3;
+		a2 = t1 - t3;
+		a3 = t0 - t2;
+
+		d0 = block[8 * 4];
+		d1 = block[8 * 5];
+		d2 = block[8 * 6];
+		d3 = block[8 * 7];
+		BUTTERFLY(t0, t1, W7, W1, d3, d0);
+		BUTTERFLY(t2, t3, W3, W5, d1, d2);
+		b0 = t0 + t2;
+		b3 = t1 + t3;
+		t0 = (t0 - t2) >> 8;
+		t1 = (t1 - t3) >> 8;
+		b1 = (t0 + t1) * 181;
+		b2 = (t0 - t1) * 181;
+
+		block[8 * 0] = (a0 + b0) >> 17;
+		block[8 * 1] = (a1 + b1) >> 17;
+		block[8 * 2] = (a2 + b2) >> 17;
+		block[8 * 3] = (a3 + b3) >> 17;
+		block[8 * 4] = (a3 - b3) >> 17;
+		block[8 * 5] = (a2 - b2) >> 17;
+		block[8 * 6] = (a1 - b1) >> 17;
+		block[8 * 7] = (a0 - b0) >> 17;
+	}
+
+	void ref_idct(s16* block)
+	{
+		for (int i = 0; i < 8; i++)
+			idct_row(block + 8 * i);
+		for (int i = 0; i < 8; i++)
+			idct_col(block + i);
+	}
+
+	// clip_lut covered -384..639, the clamp is the same there
+	void ref_idct_copy(s16* block, u8* dest, int stride)
+	{
+		ref_idct(block);
+		for (int i = 0; i < 8; i++)
+			for (int j = 0; j < 8; j++)
+				dest[stride * i + j] = static_cast<u8>(std::min(std::max<int>(block[8 * i + j], 0), 255));
+		std::fill(block, block + 64, 0);
+	}
+
+	void ref_idct_add(int last, s16* block, s16* dest, int stride)
+	{
+		if (last != 129 || (block[0] & 7) == 4)
+		{
+			ref_idct(block);
+			for (int i = 0; i < 8; i++)
+				std::memcpy(dest + stride * i, block + 8 * i, 16);
+			std::fill(block, block + 64, 0);
+		}
+		else
+		{
+			const s16 dc = (block[0] + 4) >> 3;
+			block[0] = block[63] = 0;
+			for (int i = 0; i < 8; i++)
+				std::fill(dest + stride * i, dest + stride * i + 8, dc);
+		}
+	}
+
+	// Checks both versions on a copy of block, with either stride of the decoder
+	void Check(const s16 (&block)[64], int last = 0)
+	{
+		for (int stride : {8, 16})
+		{
+			alignas(16) s16 ref_block[64], sse_block[64];
+
+			alignas(16) u8 ref_u8[16 * 8], sse_u8[16 * 8];
+			std::memcpy(ref_block, block, sizeof(block));
+			std::memcpy(sse_block, block, sizeof(block));
+			std::memset(ref_u8, 0xcd, sizeof(ref_u8));
+			std::memset(sse_u8, 0xcd, sizeof(sse_u8));
+			ref_idct_copy(ref_block, ref_u8, stride);
+			mpeg2_idct_copy_sse4(sse_block, sse_u8, stride);
+			ASSERT_EQ(0, std::memcmp(ref_u8, sse_u8, sizeof(ref_u8))) << "copy, stride " << stride;
+			ASSERT_EQ(0, std::memcmp(ref_block, sse_block, sizeof(ref_block))) << "copy, stride " << stride;
+
+			alignas(16) s16 ref_s16[16 * 8], sse_s16[16 * 8];
+			std::memcpy(ref_block, block, sizeof(block));
+			std::memcpy(sse_block, block, sizeof(block));
+			std::fill(std::begin(ref_s16), std::end(ref_s16), 0x5555);
+			std::fill(std::begin(sse_s16), std::end(sse_s16), 0x5555);
+			ref_idct_add(last, ref_block, ref_s16, stride);
+			mpeg2_idct_add_sse4(last, sse_block, sse_s16, stride);
+			ASSERT_EQ(0, std::memcmp(ref_s16, sse_s16, sizeof(ref_s16))) << "add, last " << last << ", stride " << stride;
+			ASSERT_EQ(0, std::memcmp(ref_block, sse_block, sizeof(ref_block))) << "add, last " << last << ", stride " << stride;
+		}
+	}
+} // namespace
+
+// The decoder saturates the coefficients to 12 bits
+TEST(IPU_IDCT, RandomBlocks)
+{
+	std::mt19937 rng(0x1d47);
+	std::uniform_int_distribution<int> coef(-2048, 2047);
+	std::uniform_int_distribution<int> pos(0, 63);
+
+	for (int n = 0; n < 20000; n++)
+	{
+		s16 block[64] = {};
+		if (n & 1)
+		{
+			for (s16& c : block)
+				c = coef(rng);
+		}
+		else
+		{
+			// Sparse, as most real blocks are
+			for (int i = n % 7; i >= 0; i--)
+				block[pos(rng)] = coef(rng);
+		}
+		Check(block, n % 3 ? 0 : 129);
+		if (HasFatalFailure())
+			return;
+	}
+}
+
+TEST(IPU_IDCT, EdgeBlocks)
+{
+	// Zero, and DC only, which took the row shortcut of the C version
+	for (int dc = -2048; dc <= 2047; dc++)
+	{
+		s16 block[64] = {};
+		block[0] = dc;
+		ASSERT_NO_FATAL_FAILURE(Check(block));
+		ASSERT_NO_FATAL_FAILURE(Check(block, 129));
+	}
+
+	// A single coefficient at the limits of the range and of s16
+	for (int i = 0; i < 64; i++)
+	{
+		for (int c : {-32768, -2048, -1, 1, 2047, 32767})
+		{
+			s16 block[64] = {};
+			block[i] = c;
+			ASSERT_NO_FATAL_FAILURE(Check(block));
+		}
+	}
+
+	// Saturated blocks, the worst case of the row and column sums
+	for (int c : {-32768, -2048, 2047, 32767})
+	{
+		s16 flat[64], checker[64], signs[64];
+		for (int i = 0; i < 64; i++)
+		{
+			flat[i] = c;
+			checker[i] = ((i >> 3) ^ i) & 1 ? c : -c;
+			signs[i] = (0x9669a55a3cc3f00full >> i) & 1 ? c : -c;
+		}
+		ASSERT_NO_FATAL_FAILURE(Check(flat));
+		ASSERT_NO_FATAL_FAILURE(Check(checker));
+		ASSERT_NO_FATAL_FAILURE(Check(signs));
+	}
+}
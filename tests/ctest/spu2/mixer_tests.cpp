@@ -0,0 +1,463 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The SSE4.1 voice group stages of the SPU2 mixer against the math of MixVoice, which is
+// kept below as the reference, for every interpolation mode.
+// The voices are a model of what MixCoreVoices gathers: the samples, the interpolation
+// position, the envelope, the volumes and the gates of each voice. A modulated voice
+// moves its position by the output of the previous voice, and a group where it would read
+// a voice of the same group is mixed one voice at a time, as MixCoreVoices does.
+// The benchmark is disabled so it stays out of the default run, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=SPU2MixBench.*
+
+#include <gtest/gtest.h>
+#include "SPU2/VoiceGroup.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// The products of the interpolations are 32 bits like in Mixer.cpp, defined here as
+	// wrapping: extreme samples can overflow them, and pmulld wraps too.
+	s32 Mul(s32 a, s32 b)
+	{
+		return static_cast<s32>(static_cast<u32>(a) * static_cast<u32>(b));
+	}
+
+	s32 MulShr32(s32 srcval, s32 mulval)
+	{
+		return (s64)srcval * mulval >> 32;
+	}
+
+	s32 ApplyVolume(s32 data, s32 volume)
+	{
+		return MulShr32(data << 1, volume);
+	}
+
+	s32 GaussianInterpolate(s32 pv4, s32 pv3, s32 pv2, s32 pv1, s32 i)
+	{
+		s32 out = 0;
+		out = (interpTable[0x0FF - i] * pv4) >> 15;
+		out += (interpTable[0x1FF - i] * pv3) >> 15;
+		out += (interpTable[0x100 + i] * pv2) >> 15;
+		out += (interpTable[0x000 + i] * pv1) >> 15;
+
+		return out;
+	}
+
+	template <s32 i_tension>
+	s32 HermiteInterpolate(s32 y0, s32 y1, s32 y2, s32 y3, s32 mu)
+	{
+		s32 m00 = Mul(y1 - y0, i_tension) >> 16;
+		s32 m01 = Mul(y2 - y1, i_tension) >> 16;
+		s32 m0 = m00 + m01;
+
+		s32 m10 = Mul(y2 - y1, i_tension) >> 16;
+		s32 m11 = Mul(y3 - y2, i_tension) >> 16;
+		s32 m1 = m10 + m11;
+
+		s32 val = Mul(2 * y1 + m0 + m1 - 2 * y2, mu) >> 12;
+		val = Mul(val - 3 * y1 - 2 * m0 - m1 + 3 * y2, mu) >> 12;
+		val = Mul(val + m0, mu) >> 12;
+
+		return (val + (y1));
+	}
+
+	s32 CatmullRomInterpolate(s32 y0, s32 y1, s32 y2, s32 y3, s32 mu)
+	{
+		s32 a3 = (-y0 + 3 * y1 - 3 * y2 + y3);
+		s32 a2 = (2 * y0 - 5 * y1 + 4 * y2 - y3);
+		s32 a1 = (-y0 + y2);
+		s32 a0 = (2 * y1);
+
+		s32 val = Mul(a3, mu) >> 12;
+		val = Mul(a2 + val, mu) >> 12;
+		val = Mul(a1 + val, mu) >> 12;
+
+		return (a0 + val) >> 1;
+	}
+
+	s32 CubicInterpolate(s32 y0, s32 y1, s32 y2, s32 y3, s32 mu)
+	{
+		const s32 a0 = y3 - y2 - y0 + y1;
+		const s32 a1 = y0 - y1 - a0;
+		const s32 a2 = y2 - y0;
+
+		s32 val = Mul(a0, mu) >> 12;
+		val = Mul(val + a1, mu) >> 12;
+		val = Mul(val + a2, mu) >> 12;
+
+		return (val + y1);
+	}
+
+	struct TestVoice
+	{
+		s32 PV1, PV2, PV3, PV4;
+		s32 Mu;     // before the pitch modulation
+		s32 Pitch;  // only for a modulated voice
+		s32 Envelope;
+		s32 VolL, VolR;
+		s16 Gates[4]; // DryL, DryR, WetL, WetR
+		bool Active;
+		bool Noise;
+		bool Modulated;
+	};
+
+	// UpdatePitch for a modulated voice, the position moves with the previous output
+	s32 VoiceMu(const TestVoice& vc, s32 prev_out)
+	{
+		if (!vc.Modulated)
+			return vc.Mu;
+		const s32 pitch = std::min(std::max((vc.Pitch * (32768 + prev_out)) >> 15, 0), 0x3fff);
+		return (vc.Mu + pitch) & 0xfff;
+	}
+
+	// GetVoiceValues and the second half of MixVoice
+	template <int InterpType>
+	s32 RefVoice(const TestVoice& vc, s32 mu, s32 (&sums)[4])
+	{
+		if (!vc.Active)
+			return 0;
+
+		s32 value;
+		if (vc.Noise)
+			value = vc.PV1;
+		else
+		{
+			switch (InterpType)
+			{
+				case 0: value = vc.PV1; break;
+				case 1: value = vc.PV1 - (Mul(vc.PV2 - vc.PV1, mu) >> 12); break;
+				case 2: value = CubicInterpolate(vc.PV4, vc.PV3, vc.PV2, vc.PV1, mu); break;
+				case 3: value = HermiteInterpolate<16384>(vc.PV4, vc.PV3, vc.PV2, vc.PV1, mu); break;
+				case 4: value = CatmullRomInterpolate(vc.PV4, vc.PV3, vc.PV2, vc.PV1, mu); break;
+				default: value = GaussianInterpolate(vc.PV4, vc.PV3, vc.PV2, vc.PV1, (mu & 0x0ff0) >> 4); break;
+			}
+		}
+
+		value = ApplyVolume(value, vc.Envelope);
+
+		const s32 left = ApplyVolume(value, vc.VolL);
+		const s32 right = ApplyVolume(value, vc.VolR);
+		sums[0] += left & vc.Gates[0];
+		sums[1] += right & vc.Gates[1];
+		sums[2] += left & vc.Gates[2];
+		sums[3] += right & vc.Gates[3];
+		return value;
+	}
+
+	template <int InterpType>
+	void RefMix(const std::vector<TestVoice>& voices, std::vector<s32>& out, s32 (&sums)[4])
+	{
+		for (size_t i = 0; i < voices.size(); i++)
+			out[i] = RefVoice<InterpType>(voices[i], VoiceMu(voices[i], i ? out[i - 1] : 0), sums);
+	}
+
+	// GatherVoice for the values of a voice, an off voice or the padding of the last group
+	// is silent
+	void GatherVoice(const TestVoice* vc, s32 mu, VoiceGroup& group, uint lane)
+	{
+		const bool active = vc && vc->Active;
+		group.Active[lane] = active;
+		group.VolL[lane] = vc ? vc->VolL : 0;
+		group.VolR[lane] = vc ? vc->VolR : 0;
+		group.Envelope[lane] = active ? vc->Envelope : 0;
+		group.PV1[lane] = active ? vc->PV1 : 0;
+		group.Direct[lane] = active && !vc->Noise ? 0 : -1;
+		group.PV2[lane] = group.Direct[lane] ? 0 : vc->PV2;
+		group.PV3[lane] = group.Direct[lane] ? 0 : vc->PV3;
+		group.PV4[lane] = group.Direct[lane] ? 0 : vc->PV4;
+		group.Mu[lane] = group.Direct[lane] ? 0 : mu;
+	}
+
+	// MixCoreVoices over any number of voices
+	template <int InterpType>
+	void GroupMix(const std::vector<TestVoice>& voices, std::vector<s32>& out, s32 (&sums)[4])
+	{
+		VoiceGroupSums group_sums;
+		s32 scalar_sums[4] = {};
+
+		for (size_t first = 0; first < voices.size(); first += VoiceGroup::Size)
+		{
+			const size_t count = std::min<size_t>(VoiceGroup::Size, voices.size() - first);
+
+			bool modulated = false;
+			for (size_t i = first + 1; i < first + count; i++)
+				modulated |= voices[i].Modulated;
+
+			if (modulated)
+			{
+				for (size_t i = first; i < first + count; i++)
+					out[i] = RefVoice<InterpType>(voices[i], VoiceMu(voices[i], i ? out[i - 1] : 0), scalar_sums);
+				continue;
+			}
+
+			VoiceGroup group;
+			alignas(16) s16 gates[VoiceGroup::Size * 4] = {};
+			for (uint lane = 0; lane < VoiceGroup::Size; lane++)
+			{
+				const size_t i = first + lane;
+				if (lane < count)
+				{
+					GatherVoice(&voices[i], VoiceMu(voices[i], i ? out[i - 1] : 0), group, lane);
+					std::copy(voices[i].Gates, voices[i].Gates + 4, gates + lane * 4);
+				}
+				else
+					GatherVoice(nullptr, 0, group, lane);
+			}
+
+			const __m128i value = VoiceGroupValues<InterpType>(group);
+			alignas(16) s32 values[VoiceGroup::Size];
+			_mm_store_si128((__m128i*)values, value);
+			for (uint lane = 0; lane < count; lane++)
+				out[first + lane] = group.Active[lane] ? values[lane] : 0;
+
+			group_sums.Add(group, value, gates);
+		}
+
+		s32 total[4];
+		group_sums.Get(total);
+		for (int i = 0; i < 4; i++)
+			sums[i] += total[i] + scalar_sums[i];
+	}
+
+	class VoiceGen
+	{
+	public:
+		explicit VoiceGen(u32 seed)
+			: m_rng(seed)
+		{
+		}
+
+		// extreme: samples, envelopes and volumes at the ends of their ranges
+		TestVoice Voice(bool extreme, bool modulated)
+		{
+			TestVoice vc;
+			vc.PV1 = Sample(extreme);
+			vc.PV2 = Sample(extreme);
+			vc.PV3 = Sample(extreme);
+			vc.PV4 = Sample(extreme);
+			vc.Mu = Int(0, 0xfff);
+			vc.Pitch = Int(0, 0x3fff);
+			vc.Envelope = extreme ? Pick(0, 1, 0x7fffffff) : Int(0, 0x7fffffff);
+			vc.VolL = extreme ? Pick(INT32_MIN, -1, 0x7fffffff) : Int(INT32_MIN, INT32_MAX);
+			vc.VolR = extreme ? Pick(INT32_MIN, 0, 0x7fffffff) : Int(INT32_MIN, INT32_MAX);
+			for (s16& gate : vc.Gates)
+				gate = Int(0, 1) ? -1 : 0;
+			vc.Active = Int(0, 7) != 0;
+			vc.Noise = Int(0, 7) == 0;
+			vc.Modulated = modulated;
+			return vc;
+		}
+
+		int Int(int min, int max) { return std::uniform_int_distribution<int>(min, max)(m_rng); }
+
+	private:
+		s32 Pick(s32 a, s32 b, s32 c)
+		{
+			const int i = Int(0, 2);
+			return i == 0 ? a : i == 1 ? b : c;
+		}
+
+		s32 Sample(bool extreme) { return extreme ? Pick(-32768, 0, 32767) : Int(-32768, 32767); }
+
+		std::mt19937 m_rng;
+	};
+
+	template <int InterpType>
+	void CheckMix(const std::vector<TestVoice>& voices)
+	{
+		std::vector<s32> ref_out(voices.size()), sse_out(voices.size());
+		s32 ref_sums[4] = {}, sse_sums[4] = {};
+		RefMix<InterpType>(voices, ref_out, ref_sums);
+		GroupMix<InterpType>(voices, sse_out, sse_sums);
+
+		for (size_t i = 0; i < voices.size(); i++)
+			ASSERT_EQ(ref_out[i], sse_out[i]) << "mode " << InterpType << ", voice " << i << " of " << voices.size();
+		for (int i = 0; i < 4; i++)
+			ASSERT_EQ(ref_sums[i], sse_sums[i]) << "mode " << InterpType << ", sum " << i << " of " << voices.size() << " voices";
+	}
+
+	template <int InterpType>
+	void CheckRandomCores(VoiceGen& gen, int cores, int modulation)
+	{
+		for (int n = 0; n < cores; n++)
+		{
+			// The 24 voices of a core, and counts which aren't a multiple of the group size
+			const size_t count = n % 3 ? 24 : gen.Int(1, 23);
+			const bool extreme = n % 4 == 0;
+
+			std::vector<TestVoice> voices;
+			for (size_t i = 0; i < count; i++)
+				voices.push_back(gen.Voice(extreme, i > 0 && gen.Int(0, 99) < modulation));
+
+			ASSERT_NO_FATAL_FAILURE(CheckMix<InterpType>(voices));
+		}
+	}
+} // namespace
+
+namespace
+{
+	template <int InterpType>
+	void RandomVoices()
+	{
+		VoiceGen gen(0x5b02 + InterpType);
+		CheckRandomCores<InterpType>(gen, 20000, 0);
+	}
+
+	template <int InterpType>
+	void PitchModulation()
+	{
+		VoiceGen gen(0x3d7 + InterpType);
+		CheckRandomCores<InterpType>(gen, 5000, 15);
+	}
+
+	template <int InterpType>
+	void EnvelopeEdges()
+	{
+		VoiceGen gen(0x1e + InterpType);
+		for (s32 envelope : {0, 1, 0x3fff, 0x7ffe0000, 0x7fffffff})
+		{
+			std::vector<TestVoice> voices;
+			for (int i = 0; i < 7; i++)
+			{
+				voices.push_back(gen.Voice(i & 1, false));
+				voices.back().Active = true;
+				voices.back().Envelope = envelope;
+			}
+			ASSERT_NO_FATAL_FAILURE(CheckMix<InterpType>(voices));
+		}
+	}
+} // namespace
+
+TEST(SPU2Mix, RandomVoices)
+{
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<0>());
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<1>());
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<2>());
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<3>());
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<4>());
+	ASSERT_NO_FATAL_FAILURE(RandomVoices<5>());
+}
+
+// A modulated voice reads the output of the previous voice for the same sample, from the
+// previous group or from a group mixed one voice at a time
+TEST(SPU2Mix, PitchModulation)
+{
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<0>());
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<1>());
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<2>());
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<3>());
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<4>());
+	ASSERT_NO_FATAL_FAILURE(PitchModulation<5>());
+}
+
+TEST(SPU2Mix, EnvelopeEdges)
+{
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<0>());
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<1>());
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<2>());
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<3>());
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<4>());
+	ASSERT_NO_FATAL_FAILURE(EnvelopeEdges<5>());
+}
+
+namespace
+{
+	typedef std::vector<std::vector<TestVoice>> BenchCores;
+
+	// Keeps the mixes from being optimized out
+	volatile s32 s_bench_sink;
+
+	template <typename F>
+	double NsPerCore(const BenchCores& cores, F&& mix)
+	{
+		const int rounds = 50;
+		const auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < rounds; round++)
+		{
+			for (const std::vector<TestVoice>& voices : cores)
+				mix(voices);
+		}
+		const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return s * 1e9 / (rounds * cores.size());
+	}
+
+	template <int InterpType>
+	void BenchMode(const BenchCores& cores)
+	{
+		std::vector<s32> out(24);
+		s32 sums[4] = {};
+
+		// Both paths from the voices: the groups pay for gathering the lanes
+		const double scalar = NsPerCore(cores, [&](const std::vector<TestVoice>& voices) { RefMix<InterpType>(voices, out, sums); });
+		const double gathered = NsPerCore(cores, [&](const std::vector<TestVoice>& voices) { GroupMix<InterpType>(voices, out, sums); });
+
+		// Only the vector stages, from groups gathered beforehand
+		std::vector<VoiceGroup> groups(cores.size() * 24 / VoiceGroup::Size);
+		std::vector<s16> gates(groups.size() * VoiceGroup::Size * 4);
+		for (size_t i = 0; i < cores.size() * 24; i++)
+		{
+			const TestVoice& vc = cores[i / 24][i % 24];
+			GatherVoice(&vc, vc.Mu, groups[i / VoiceGroup::Size], i % VoiceGroup::Size);
+			std::copy(vc.Gates, vc.Gates + 4, &gates[i * 4]);
+		}
+		VoiceGroupSums group_sums;
+		size_t next = 0;
+		const double stages = NsPerCore(cores, [&](const std::vector<TestVoice>&) {
+			for (size_t i = 0; i < 24 / VoiceGroup::Size; i++, next++)
+			{
+				const size_t g = next % groups.size();
+				group_sums.Add(groups[g], VoiceGroupValues<InterpType>(groups[g]), &gates[g * VoiceGroup::Size * 4]);
+			}
+		});
+
+		s32 total[4];
+		group_sums.Get(total);
+		s_bench_sink = sums[0] ^ sums[3] ^ total[0] ^ total[3];
+
+		printf("%5d %12.1f ns %12.1f ns %12.1f ns\n", InterpType, scalar, gathered, stages);
+	}
+} // namespace
+
+// The math of one sample of a core (24 voices), without the sample fetch and the ADSR
+// update which both paths do one voice at a time. MixCoreVoices gathers each lane after
+// the fetch and ADSR of its voice, the "gathered" column gathers the lanes right before
+// the stages, the worst case for the store forwarding of the lanes.
+TEST(SPU2MixBench, DISABLED_VoiceGroups)
+{
+	VoiceGen gen(0xbe7c);
+	BenchCores cores(4096);
+	for (std::vector<TestVoice>& voices : cores)
+	{
+		for (int i = 0; i < 24; i++)
+		{
+			voices.push_back(gen.Voice(false, false));
+			voices.back().Active = true;
+			voices.back().Noise = false;
+		}
+	}
+
+	printf("%5s %15s %15s %15s\n", "mode", "MixVoice", "gathered", "stages");
+	BenchMode<0>(cores);
+	BenchMode<1>(cores);
+	BenchMode<2>(cores);
+	BenchMode<3>(cores);
+	BenchMode<4>(cores);
+	BenchMode<5>(cores);
+}
@@ -0,0 +1,232 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Code size and throughput of branch relaxation, on blocks shaped like the recompilers'
+// (guest registers in memory, short conditional skips, a loop around it all), and how fast
+// the emitter itself produces such code.
+// They are disabled so they stay out of the default run, run them with
+// --gtest_also_run_disabled_tests --gtest_filter=CodegenBench.*
+
+#include <gtest/gtest.h>
+#include <x86emitter.h>
+#include "Utilities/General.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace x86Emitter;
+
+alignas(__pagesize) static u8 s_code[1 << 20];
+static u32 s_regs[32];
+static u32 s_loop;
+
+typedef u32 BenchFunc();
+
+static void EmitBenchBlock(u32 seed, int ops, int iterations)
+{
+	std::mt19937 rng(seed);
+
+	xMOV(ptr32[&s_loop], iterations);
+	u8* top = xGetPtr();
+	xMOV(eax, ptr32[&s_regs[0]]);
+
+	for (int i = 0; i < ops; i++)
+	{
+		switch (rng() % 8)
+		{
+			case 0:
+			case 1:
+				xADD(eax, ptr32[&s_regs[rng() % 32]]);
+				break;
+			case 2:
+				xXOR(ptr32[&s_regs[rng() % 32]], eax);
+				break;
+			case 3:
+				xROL(eax, 1 + rng() % 31);
+				break;
+			case 4:
+			case 5:
+			{
+				// skip over a few ops, the usual shape of a forward jump
+				xTEST(eax, 1 << (rng() % 32));
+				xForwardJZ32 skip;
+				for (u32 n = 1 + rng() % 4; n; n--)
+					xADD(ptr32[&s_regs[rng() % 32]], (int)(rng() % 1000));
+				skip.SetTarget();
+				break;
+			}
+			case 6:
+			{
+				xForwardJump32 over;
+				xMOV(ptr32[&s_regs[rng() % 32]], eax);
+				over.SetTarget();
+				break;
+			}
+			default:
+				xSUB(eax, (int)rng());
+				break;
+		}
+	}
+
+	xMOV(ptr32[&s_regs[0]], eax);
+	xSUB(ptr32[&s_loop], 1);
+	xJcc(Jcc_NotZero, top);
+	xRET();
+}
+
+static u32 RunBench(BenchFunc* func, double& ms)
+{
+	for (int i = 0; i < 32; i++)
+		s_regs[i] = i * 0x9E3779B9;
+
+	auto start = std::chrono::steady_clock::now();
+	func();
+	ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	u32 sum = 0;
+	for (int i = 0; i < 32; i++)
+		sum = sum * 31 + s_regs[i];
+	return sum;
+}
+
+TEST(CodegenBench, DISABLED_RelaxSize)
+{
+	size_t plain = 0, relaxed = 0;
+	for (u32 seed = 0; seed < 200; seed++)
+	{
+		xSetPtr(s_code);
+		EmitBenchBlock(seed, 50 + seed % 200, 1);
+		plain += xGetPtr() - s_code;
+
+		xSetPtr(s_code);
+		xRelaxBegin();
+		EmitBenchBlock(seed, 50 + seed % 200, 1);
+		xRelaxEnd();
+		relaxed += xGetPtr() - s_code;
+	}
+
+	printf("Relaxation: %zu bytes -> %zu bytes (%.1f%% smaller)\n", plain, relaxed, (plain - relaxed) * 100.0 / plain);
+	EXPECT_LT(relaxed, plain);
+}
+
+TEST(CodegenBench, DISABLED_RelaxThroughput)
+{
+	HostSys::MemProtect(s_code, sizeof(s_code), PageAccess_Any());
+
+	u8* const plain_code = s_code;
+	u8* const relaxed_code = s_code + sizeof(s_code) / 2;
+
+	double plain_ms = 0, relaxed_ms = 0;
+	for (u32 seed = 0; seed < 8; seed++)
+	{
+		xSetPtr(plain_code);
+		EmitBenchBlock(seed, 2000, 5000);
+
+		xSetPtr(relaxed_code);
+		xRelaxBegin();
+		EmitBenchBlock(seed, 2000, 5000);
+		xRelaxEnd();
+
+		double ms;
+		u32 plain = RunBench((BenchFunc*)plain_code, ms);
+		plain_ms += ms;
+		u32 relaxed = RunBench((BenchFunc*)relaxed_code, ms);
+		relaxed_ms += ms;
+
+		EXPECT_EQ(plain, relaxed) << "Relaxed code computed something else, seed " << seed;
+	}
+
+	printf("Relaxation: %.1f ms -> %.1f ms\n", plain_ms, relaxed_ms);
+	HostSys::MemProtect(s_code, sizeof(s_code), PageAccess_ReadWrite());
+}
+
+// The instruction mix of a typical block: guest register loads and stores off a base
+// register, integer and float ALU ops, and a few forward branches
+static int EmitMix(u32 seed, int ops)
+{
+	std::mt19937 rng(seed);
+	int count = 0;
+
+	for (int i = 0; i < ops; i++)
+	{
+		const int disp = (rng() % 32) * 16;
+		switch (rng() % 10)
+		{
+			case 0:
+				xMOV(eax, ptr32[rbx + disp]);
+				break;
+			case 1:
+				xADD(ptr32[rbx + disp], eax);
+				break;
+			case 2:
+				xAND(ecx, (int)rng());
+				break;
+			case 3:
+				xSHL(eax, 1 + rng() % 31);
+				break;
+			case 4:
+				xMOVAPS(xmm0, ptr128[rbx + disp]);
+				break;
+			case 5:
+				xADD.PS(xmm0, xmm1);
+				break;
+			case 6:
+				xSHUF.PS(xmm1, xmm0, rng() & 0xff);
+				break;
+			case 7:
+				xPAND(xmm1, ptr128[rbx + disp]);
+				break;
+			case 8:
+				xMOVAPS(ptr128[rbx + disp], xmm1);
+				break;
+			default:
+			{
+				xTEST(eax, eax);
+				xForwardJZ32 skip;
+				xMOV(ptr32[rbx + disp], ecx);
+				skip.SetTarget();
+				count += 2;
+				break;
+			}
+		}
+		count++;
+	}
+
+	xRET();
+	return count + 1;
+}
+
+TEST(CodegenBench, DISABLED_EmitterThroughput)
+{
+	for (int relax = 0; relax < 2; relax++)
+	{
+		size_t instrs = 0, bytes = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (u32 seed = 0; seed < 2000; seed++)
+		{
+			xSetPtr(s_code);
+			if (relax)
+				xRelaxBegin();
+			instrs += EmitMix(seed, 500);
+			if (relax)
+				xRelaxEnd();
+			bytes += xGetPtr() - s_code;
+		}
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		printf("Emitter%s: %.1f Minstr/s, %.2f bytes/instr\n", relax ? " (relaxed)" : "", instrs / ms / 1000.0, (double)bytes / instrs);
+		EXPECT_GT(bytes, instrs);
+	}
+}
@@ -153,6 +153,69 @@ TEST(CodegenTests, JmpTest)
 	CODEGEN_TEST_BOTH(xJB((char*)base - 0xFFFF), "0f 82 fb ff fe ff");
 }
 
+static void RelaxJcc()
+{
+	xRelaxBegin();
+	xForwardJZ32 skip;
+	xNOP();
+	skip.SetTarget();
+	xRelaxEnd();
+}
+
+static void RelaxJmp()
+{
+	xRelaxBegin();
+	xForwardJump32 skip;
+	xNOP();
+	skip.SetTarget();
+	xRelaxEnd();
+}
+
+static void RelaxFar()
+{
+	xRelaxBegin();
+	xForwardJZ32 skip;
+	for (int i = 0; i < 128; i++)
+		xNOP();
+	skip.SetTarget();
+	xRelaxEnd();
+}
+
+static void RelaxRip(void *base)
+{
+	xRelaxBegin();
+	xForwardJZ32 skip;
+	skip.SetTarget();
+	xMOV(eax, ptr32[base]);
+	xMOV(eax, ptr32[(u8 *)base + 0x1000]);
+	xJMP(base);
+	xRelaxEnd();
+}
+
+TEST(CodegenTests, RelaxTest)
+{
+	CODEGEN_TEST_BOTH(RelaxJcc(), "74 01 90");
+	CODEGEN_TEST_BOTH(RelaxJmp(), "eb 01 90");
+	CODEGEN_TEST_64(RelaxRip(base), "74 00 8b 05 f8 ff ff ff 8b 05 f2 0f 00 00 eb f0");
+
+	u8 code[256];
+	xSetPtr(code);
+	RelaxFar();
+	EXPECT_EQ(xGetPtr() - code, 6 + 128) << "A jump out of rel8 range was shortened";
+	EXPECT_EQ(code[0], 0x0f);
+	EXPECT_EQ(*(s32 *)(code + 2), 128);
+
+	alignas(32) u8 aligned[64];
+	for (int i = 0; i < 32; i++) {
+		xSetPtr(aligned + i);
+		xAlignJumpTarget(32, 31);
+		EXPECT_EQ((uptr)xGetPtr() & 31, 0) << "Misaligned after " << i;
+	}
+	xSetPtr(aligned + 1);
+	xAlignJumpTarget(16, 8);
+	EXPECT_EQ(xGetPtr(), aligned + 1) << "Padded past maxpadding";
+}
+
 TEST(CodegenTests, SSETest)
 {
 	CODEGEN_TEST_BOTH(xMOVAPS(xmm0, xmm1), "0f 28 c1");
@@ -162,4 +225,36 @@ TEST(CodegenTests, SSETest)
 	CODEGEN_TEST_BOTH(xBLEND.PS(xmm0, xmm1, 0x55), "66 0f 3a 0c c1 55");
 	CODEGEN_TEST_64(xBLEND.PD(xmm8, xmm9, 0xaa), "66 45 0f 3a 0d c1 aa");
 	CODEGEN_TEST_64(xEXTRACTPS(ptr32[base], xmm1, 2), "66 0f 3a 17 0d f6 ff ff ff 02");
+	CODEGEN_TEST_BOTH(xVFMADD231.SS(xmm1, xmm2, xmm3), "c4 e2 69 b9 cb");
+	CODEGEN_TEST_64(xVFMADD231.SS(xmm9, xmm10, xmm11), "c4 42 29 b9 cb");
+	CODEGEN_TEST_64(xVFNMADD231.SS(xmm0, xmm1, ptr32[base]), "c4 e2 71 bd 05 f7 ff ff ff");
+	CODEGEN_TEST_BOTH(xVFMADD231.SD(xmm1, xmm2, xmm3), "c4 e2 e9 b9 cb");
+}
+
+TEST(CodegenTests, AVX2Test)
+{
+	CODEGEN_TEST_64(xVMOVUPS(xmm0.YMM(), ptr[rsi]), "c5 fc 10 06");
+	CODEGEN_TEST_64(xVMOVUPS(ptr[rdi+0x20], xmm1.YMM()), "c5 fc 11 4f 20");
+	CODEGEN_TEST_64(xVPMOVSXBD(xmm0.YMM(), ptr[rsi]), "c4 e2 7d 21 06");
+	CODEGEN_TEST_64(xVPMOVZXBD(xmm1.YMM(), ptr[rsi+8]), "c4 e2 7d 31 4e 08");
+	CODEGEN_TEST_64(xVPMOVSXWD(xmm0.YMM(), ptr[rsi]), "c4 e2 7d 23 06");
+	CODEGEN_TEST_64(xVPMOVZXWD(xmm0.YMM(), ptr[rsi]), "c4 e2 7d 33 06");
+	CODEGEN_TEST_BOTH(xVPADDD(xmm0.YMM(), xmm0.YMM(), xmm6.YMM()), "c5 fd fe c6");
+	CODEGEN_TEST_64(xVPADDD(xmm0.YMM(), xmm1.YMM(), xmm9.YMM()), "c4 c1 75 fe c1");
+	CODEGEN_TEST_64(xVBROADCASTI128(xmm6.YMM(), ptr[rax]), "c4 e2 7d 5a 30");
+	CODEGEN_TEST_BOTH(xVZEROUPPER(), "c5 f8 77");
+}
+
+TEST(CodegenTests, MMITest)
+{
+	CODEGEN_TEST_BOTH(xPSHUF.B(xmm1, xmm2), "66 0f 38 00 ca");
+	CODEGEN_TEST_64(xPSHUF.B(xmm8, ptr128[rax+rcx+16]), "66 44 0f 38 00 44 08 10");
+	CODEGEN_TEST_BOTH(xPMUL.LD(xmm0, xmm1), "66 0f 38 40 c1");
+	CODEGEN_TEST_64(xPMUL.LD(xmm8, xmm9), "66 45 0f 38 40 c1");
+	CODEGEN_TEST_BOTH(xPMOVSX.WD(xmm0, xmm1), "66 0f 38 23 c1");
+	CODEGEN_TEST_BOTH(xCVTDQ2PD(xmm0, xmm1), "f3 0f e6 c1");
+	CODEGEN_TEST_BOTH(xCVTTPD2DQ(xmm0, xmm1), "66 0f e6 c1");
+	CODEGEN_TEST_64(xDIV.PD(xmm8, xmm1), "66 44 0f 5e c1");
+	CODEGEN_TEST_BOTH(xPCMP.EQD(xmm2, xmm3), "66 0f 76 d3");
+	CODEGEN_TEST_BOTH(xPANDN(xmm2, xmm3), "66 0f df d3");
 }
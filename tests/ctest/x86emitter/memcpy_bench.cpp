@@ -0,0 +1,120 @@
+/*  PCSX2 - PS2 Emulator for PCs
+ *  Copyright (C) 2002-2021  PCSX2 Dev Team
+ *
+ *  PCSX2 is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU Lesser General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  PCSX2 is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with PCSX2.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Correctness of the streaming copies and fills, and their throughput against memcpy and
+// memset over a range of sizes, to pick MemcpyStreamThreshold for a machine.
+// The benchmark is disabled so it stays out of the default run, run it with
+// --gtest_also_run_disabled_tests --gtest_filter=MemcpyStreamBench.*
+
+#include <gtest/gtest.h>
+#include "Pcsx2Defs.h"
+#include "Utilities/MemcpyFast.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+TEST(MemcpyStream, Copy)
+{
+	const size_t size = MemcpyStreamThreshold * 2 + 200;
+	std::vector<u8> src(size + 64), dest(size + 64);
+	for (size_t i = 0; i < src.size(); i++)
+		src[i] = (u8)(i * 131 + 7);
+
+	// sizes on both sides of the threshold, at every alignment inside a cache line
+	for (size_t len : {(size_t)0, (size_t)5, (size_t)100, MemcpyStreamThreshold - 1, MemcpyStreamThreshold + 63, size})
+	{
+		for (size_t align = 0; align < 64; align += 7)
+		{
+			std::fill(dest.begin(), dest.end(), 0xEE);
+			memcpy_stream(dest.data() + align, src.data() + 3, len);
+			ASSERT_EQ(memcmp(dest.data() + align, src.data() + 3, len), 0) << "len " << len << " align " << align;
+			if (align)
+				EXPECT_EQ(dest[align - 1], 0xEE);
+			EXPECT_EQ(dest[align + len], 0xEE);
+
+			std::fill(dest.begin(), dest.end(), 0xEE);
+			memcpy_nt(dest.data() + align, src.data() + 3, len);
+			ASSERT_EQ(memcmp(dest.data() + align, src.data() + 3, len), 0) << "len " << len << " align " << align;
+			EXPECT_EQ(dest[align + len], 0xEE);
+		}
+	}
+}
+
+TEST(MemcpyStream, Fill)
+{
+	const size_t size = MemcpyStreamThreshold * 2 + 200;
+	std::vector<u8> dest(size + 64);
+
+	for (size_t len : {(size_t)0, (size_t)5, (size_t)100, MemcpyStreamThreshold + 63, size})
+	{
+		for (size_t align = 0; align < 64; align += 13)
+		{
+			std::fill(dest.begin(), dest.end(), 0xEE);
+			memset_nt(dest.data() + align, 0x5A, len);
+			ASSERT_EQ((size_t)std::count(dest.begin() + align, dest.begin() + align + len, 0x5A), len) << "len " << len << " align " << align;
+			if (align)
+				EXPECT_EQ(dest[align - 1], 0xEE);
+			EXPECT_EQ(dest[align + len], 0xEE);
+
+			memset_stream(dest.data() + align, 0x11, len);
+			ASSERT_EQ((size_t)std::count(dest.begin() + align, dest.begin() + align + len, 0x11), len) << "len " << len << " align " << align;
+		}
+	}
+}
+
+typedef void CopyFunc(void* dest, const void* src, size_t size);
+
+static void PlainCopy(void* dest, const void* src, size_t size) { memcpy(dest, src, size); }
+static void PlainFill(void* dest, const void*, size_t size) { memset(dest, 0, size); }
+static void StreamFill(void* dest, const void*, size_t size) { memset_nt(dest, 0, size); }
+
+// Each size is repeated for about the same amount of data, between buffers which were
+// touched already so the page faults don't count.
+static double Throughput(CopyFunc* copy, u8* dest, const u8* src, size_t size)
+{
+	const size_t rounds = std::max<size_t>((1ull << 30) / size, 4);
+
+	copy(dest, src, size);
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < rounds; i++)
+		copy(dest, src, size);
+	const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return (double)size * rounds / s / (1 << 30);
+}
+
+TEST(MemcpyStreamBench, DISABLED_Threshold)
+{
+	const size_t max = 64 << 20;
+	std::unique_ptr<u8[]> src(new u8[max]), dest(new u8[max]);
+	memset(src.get(), 1, max);
+	memset(dest.get(), 2, max);
+
+	// This only shows the raw speed, without other threads competing for the caches.  The
+	// streaming stores are meant to win back the cache lines the others would have lost, so
+	// the threshold can sit somewhat below the size where they start to win here.
+	printf("Threshold is %zuK\n", MemcpyStreamThreshold >> 10);
+	printf("%10s %14s %14s %14s %14s\n", "size", "memcpy", "memcpy_nt", "memset", "memset_nt");
+	for (size_t size = 32 << 10; size <= max; size *= 2)
+	{
+		const double copy = Throughput(PlainCopy, dest.get(), src.get(), size);
+		const double copy_nt = Throughput(memcpy_nt, dest.get(), src.get(), size);
+		const double fill = Throughput(PlainFill, dest.get(), nullptr, size);
+		const double fill_nt = Throughput(StreamFill, dest.get(), nullptr, size);
+		printf("%9zuK %9.2f GB/s %9.2f GB/s %9.2f GB/s %9.2f GB/s\n", size >> 10, copy, copy_nt, fill, fill_nt);
+	}
+	EXPECT_EQ(dest[max - 1], 0);
+}